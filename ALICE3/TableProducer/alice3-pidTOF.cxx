@@ -27,6 +27,8 @@
 #include "Framework/RunningWorkflowInfo.h"
 #include "Framework/StaticFor.h"
 
+#include <array>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::pid;
@@ -129,6 +131,7 @@ struct ALICE3pidTOFTask {
   }
   void process(Trks const& tracks, Coll const&)
   {
+    constexpr int nSpecies = PID::Alpha + 1;
     tablePIDEl.reserve(tracks.size());
     tablePIDMu.reserve(tracks.size());
     tablePIDPi.reserve(tracks.size());
@@ -138,16 +141,32 @@ struct ALICE3pidTOFTask {
     tablePIDTr.reserve(tracks.size());
     tablePIDHe.reserve(tracks.size());
     tablePIDAl.reserve(tracks.size());
+    std::array<float, nSpecies> expSigma;
+    std::array<float, nSpecies> nSigma;
     for (auto const& trk : tracks) {
-      tablePIDEl(sigma<PID::Electron>(trk), nsigma<PID::Electron>(trk));
-      tablePIDMu(sigma<PID::Muon>(trk), nsigma<PID::Muon>(trk));
-      tablePIDPi(sigma<PID::Pion>(trk), nsigma<PID::Pion>(trk));
-      tablePIDKa(sigma<PID::Kaon>(trk), nsigma<PID::Kaon>(trk));
-      tablePIDPr(sigma<PID::Proton>(trk), nsigma<PID::Proton>(trk));
-      tablePIDDe(sigma<PID::Deuteron>(trk), nsigma<PID::Deuteron>(trk));
-      tablePIDTr(sigma<PID::Triton>(trk), nsigma<PID::Triton>(trk));
-      tablePIDHe(sigma<PID::Helium3>(trk), nsigma<PID::Helium3>(trk));
-      tablePIDAl(sigma<PID::Alpha>(trk), nsigma<PID::Alpha>(trk));
+      // Quantities common to all the mass hypotheses, computed once per track
+      const auto collision = trk.collision();
+      const bool hasTOF = trk.hasTOF();
+      const float p = trk.p();
+      const float sigmaP = o2::pid::tof::TOFResoALICE3MomentumReso(trk);
+      const float evTimeReso = collision.collisionTimeRes() * 1000.f;
+      const float length = trk.length();
+      const float tofExpMom = trk.tofExpMom() / o2::pid::tof::kCSPEED;
+      const float deltaT = (trk.trackTime() - collision.collisionTime()) * 1000.f;
+      static_for<0, nSpecies - 1>([&](auto i) {
+        constexpr o2::track::PID::ID id = i.value;
+        expSigma[id] = o2::pid::tof::TOFResoALICE3Param(p, sigmaP, evTimeReso, length, o2::track::pid_constants::sMasses2Z[id], resoParameters);
+        nSigma[id] = hasTOF ? (deltaT - tof::ExpTimes<Trks::iterator, id>::ComputeExpectedTime(tofExpMom, length)) / expSigma[id] : -999.f;
+      });
+      tablePIDEl(expSigma[PID::Electron], nSigma[PID::Electron]);
+      tablePIDMu(expSigma[PID::Muon], nSigma[PID::Muon]);
+      tablePIDPi(expSigma[PID::Pion], nSigma[PID::Pion]);
+      tablePIDKa(expSigma[PID::Kaon], nSigma[PID::Kaon]);
+      tablePIDPr(expSigma[PID::Proton], nSigma[PID::Proton]);
+      tablePIDDe(expSigma[PID::Deuteron], nSigma[PID::Deuteron]);
+      tablePIDTr(expSigma[PID::Triton], nSigma[PID::Triton]);
+      tablePIDHe(expSigma[PID::Helium3], nSigma[PID::Helium3]);
+      tablePIDAl(expSigma[PID::Alpha], nSigma[PID::Alpha]);
     }
   }
 };
@@ -12,6 +12,10 @@
 /// \author Nicolo' Jacazio <nicolo.jacazio@cern.ch>, CERN
 /// \author Alexander Kalweit <alexander.kalweit@cern.ch>, CERN
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 // O2 includes
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -22,6 +26,7 @@
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/TwoProngPrecheck.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -44,20 +49,32 @@ struct Alice3CDeuteron {
   Configurable<float> maxNsigmaDe{"maxNsigmaDe", 3.f, "Maximum Nsigma for deuteron"};
   Configurable<float> maxNsigmaKa{"maxNsigmaKa", 3.f, "Maximum Nsigma for kaon"};
   Configurable<float> maxNsigmaPi{"maxNsigmaPi", 3.f, "Maximum Nsigma for pion"};
+  Configurable<float> precheckMaxDZ{"precheckMaxDZ", 0.f, "Maximum z distance of the deuteron and the kaon at their crossing points in the pre-check of the pairs, 0: no z requirement, < 0: no pre-check"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads sharing the loop over the deuterons, 1: serial"};
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
-  o2::vertexing::DCAFitterN<3> fitter;
+  std::vector<o2::vertexing::DCAFitterN<3>> fitters; // one per thread
+  o2::analysis::TwoProngPrecheck precheck;           // pre-check of the (d, K) pairs, shared by the threads
 
   void init(InitContext&)
   {
 
-    fitter.setBz(magField);
-    fitter.setPropagateToPCA(true);
-    fitter.setMaxR(1.);
-    fitter.setMinParamChange(1e-3);
-    fitter.setMinRelChi2Change(0.9);
-    fitter.setMaxDZIni(1e9);
-    fitter.setMaxChi2(1e9);
-    fitter.setUseAbsDCA(true);
+    fitters.resize(std::max(1, nThreads.value));
+    for (auto& fitter : fitters) {
+      fitter.setBz(magField);
+      fitter.setPropagateToPCA(true);
+      fitter.setMaxR(1.);
+      fitter.setMinParamChange(1e-3);
+      fitter.setMinRelChi2Change(0.9);
+      fitter.setMaxDZIni(1e9);
+      fitter.setMaxChi2(1e9);
+      fitter.setUseAbsDCA(true);
+    }
+    // the fitter seeds the vertex with the crossings of the first two prongs and gives up if they
+    // do not come closer than its maximum initial distance in xy (default kept in both): same
+    // requirement on the (d, K) pairs, checked once per pair instead of once per triplet
+    precheck.setEnabled(precheckMaxDZ >= 0.f);
+    precheck.setBz(magField);
+    precheck.setMaxDZ(precheckMaxDZ);
 
     const AxisSpec axisInvMass{1000, 2.5, 4, "Inv. Mass_{c-d}"};
     const AxisSpec axisDecayRadius{2000, 0, 0.1, "Decay radius"};
@@ -172,6 +189,112 @@ struct Alice3CDeuteron {
 #undef MakeHistos
   }
 
+  /// Candidate prong, with what the triplets need from the track and its MC particle
+  struct ProngCandidate {
+    o2::track::TrackParCov trackParCov;
+    std::array<float, 2> dca{1e10f, 1e10f}; // DCA to the primary vertex in xy and z
+    float pt = 0.f;
+    float eta = 0.f;
+    float phi = 0.f;
+    int64_t index = -1;                            // global index of the track
+    int motherId = -1;                             // global index of the mother of the MC particle
+    std::array<float, 3> motherVtx{0.f, 0.f, 0.f}; // production vertex of the mother, set for the deuterons only
+    float prodX = 0.f;                             // production vertex of the MC particle in xy
+    float prodY = 0.f;
+    bool hasValidCov = true;
+    bool isCut = false; // single-prong selections failed
+  };
+
+  /// Triplet with a successful fit, with the indices of its kaon and pion in their candidate lists
+  struct TripletCandidate {
+    int kaon = -1;
+    int pion = -1;
+    std::array<float, 3> secVtx{0.f, 0.f, 0.f};
+    std::array<float, 2> chi2AtPCA{0.f, 0.f};
+    float invMass = 0.f;
+    float ptMom = 0.f;
+    float pMom = 0.f;
+    float cpa = 0.f;
+    float decayRadius = 0.f;
+    bool isSignal = false;
+    bool isCut = false;
+  };
+
+  std::vector<ProngCandidate> deuterons;
+  std::vector<ProngCandidate> kaons;
+  std::vector<ProngCandidate> pions;
+  std::vector<std::vector<TripletCandidate>> triplets; // triplets of each deuteron
+
+  /// Fits the triplets of a deuteron with all the kaons and pions, the (d, K) pairs which cannot make a vertex are skipped before the pion loop
+  void buildTriplets(o2::vertexing::DCAFitterN<3>& fitter, int iDeuteron, std::vector<TripletCandidate>& candidates)
+  {
+    candidates.clear();
+    const auto& deuteron = deuterons[iDeuteron];
+    if (!deuteron.hasValidCov) {
+      return;
+    }
+    for (int iKaon = 0; iKaon < static_cast<int>(kaons.size()); ++iKaon) {
+      const auto& kaon = kaons[iKaon];
+      if (!precheck.isCompatible(deuteron.trackParCov, kaon.trackParCov)) {
+        continue;
+      }
+      for (int iPion = 0; iPion < static_cast<int>(pions.size()); ++iPion) {
+        const auto& pion = pions[iPion];
+        if (pion.index == deuteron.index) {
+          continue;
+        }
+        const int status = fitter.process(deuteron.trackParCov, kaon.trackParCov, pion.trackParCov);
+        if (status == 0) {
+          continue;
+        }
+
+        TripletCandidate candidate;
+        candidate.kaon = iKaon;
+        candidate.pion = iPion;
+        candidate.isSignal = deuteron.motherId == kaon.motherId && deuteron.motherId == pion.motherId;
+        candidate.isCut = deuteron.isCut || kaon.isCut || pion.isCut;
+
+        TLorentzVector v1{};
+        v1.SetPtEtaPhiM(deuteron.pt, deuteron.eta, deuteron.phi, 1.8756129);
+
+        TLorentzVector v2{};
+        v2.SetPtEtaPhiM(kaon.pt, kaon.eta, kaon.phi, 0.493677);
+
+        TLorentzVector v3{};
+        v3.SetPtEtaPhiM(pion.pt, pion.eta, pion.phi, 0.139570);
+        v1 += v2;
+        v1 += v3;
+        if (v1.Pt() < minMomPt) {
+          candidate.isCut = true;
+        }
+
+        const auto& secVtx = fitter.getPCACandidate();
+        const float decay_radius = sqrt(secVtx[0] * secVtx[0] + secVtx[1] * secVtx[1] + secVtx[2] * secVtx[2]);
+        if (decay_radius < minRadius) {
+          candidate.isCut = true;
+        }
+        if (decay_radius > maxRadius) {
+          candidate.isCut = true;
+        }
+
+        const float magMom = sqrt(v1.Px() * v1.Px() + v1.Py() * v1.Py() + v1.Pz() * v1.Pz());
+        const float CPA = (v1.Px() * secVtx[0] + v1.Py() * secVtx[1] + v1.Pz() * secVtx[2]) / (decay_radius * magMom);
+        if (abs(CPA) < minCpa) {
+          candidate.isCut = true;
+        }
+
+        candidate.secVtx = {static_cast<float>(secVtx[0]), static_cast<float>(secVtx[1]), static_cast<float>(secVtx[2])};
+        candidate.chi2AtPCA = {static_cast<float>(fitter.getChi2AtPCACandidate(0)), static_cast<float>(fitter.getChi2AtPCACandidate(1))};
+        candidate.invMass = v1.M();
+        candidate.ptMom = v1.Pt();
+        candidate.pMom = v1.P();
+        candidate.cpa = CPA;
+        candidate.decayRadius = decay_radius;
+        candidates.push_back(candidate);
+      } // End loop on pions
+    }   // End loop on kaons
+  }
+
   Preslice<aod::McParticles_000> perMcCollision = aod::mcparticle::mcCollisionId;
 
   void process(const soa::Join<o2::aod::Collisions, o2::aod::McCollisionLabels>::iterator& coll,
@@ -221,225 +344,179 @@ struct Alice3CDeuteron {
     }
     histos.fill(HIST("event/multiplicity"), ntrks);
 
-    std::array<float, 2> dca1{1e10f, 1e10f};
-    std::array<float, 2> dca2{1e10f, 1e10f};
-    std::array<float, 2> dca3{1e10f, 1e10f};
-    for (const auto& track1 : tracks) {
-      const auto index1 = track1.globalIndex();
-      int ncand = 0;
-      histos.fill(HIST("event/nsigmaDe"), track1.pt(), track1.tofNSigmaDe());
+    // candidate prongs of the collision, split by PID and charge: positive deuterons, negative kaons and positive pions
+    deuterons.clear();
+    kaons.clear();
+    pions.clear();
+    std::array<float, 2> dca{1e10f, 1e10f};
+    for (const auto& track : tracks) {
+      const auto particle = track.mcParticle_as<aod::McParticles_000>();
+      histos.fill(HIST("event/nsigmaDe"), track.pt(), track.tofNSigmaDe());
+      histos.fill(HIST("event/nsigmaKa"), track.pt(), track.tofNSigmaKa());
+      histos.fill(HIST("event/nsigmaPi"), track.pt(), track.tofNSigmaPi());
+      bool isDeuteron = false;
+      bool isKaon = false;
+      bool isPion = false;
       if (usePdg) {
-        if (track1.mcParticle_as<aod::McParticles_000>().pdgCode() != 1000010020) {
-          continue;
-        }
-      } else if (abs(track1.tofNSigmaDe()) > maxNsigmaDe || track1.sign() < 0.f) {
+        isDeuteron = particle.pdgCode() == 1000010020;
+        isKaon = particle.pdgCode() == -321;
+        isPion = particle.pdgCode() == 211;
+      } else {
+        isDeuteron = abs(track.tofNSigmaDe()) <= maxNsigmaDe && track.sign() >= 0.f;
+        isKaon = abs(track.tofNSigmaKa()) <= maxNsigmaKa && track.sign() <= 0.f;
+        isPion = abs(track.tofNSigmaPi()) <= maxNsigmaPi && track.sign() >= 0.f;
+      }
+      if (!isDeuteron && !isKaon && !isPion) {
         continue;
       }
-      histos.fill(HIST("event/nsigmaDecut"), track1.pt(), track1.tofNSigmaDe());
-      if (!getTrackPar(track1).propagateParamToDCA(collPos,
-                                                   magField * 10.f, &dca1, 100.)) {
+      if (isDeuteron) {
+        histos.fill(HIST("event/nsigmaDecut"), track.pt(), track.tofNSigmaDe());
+      }
+      if (isKaon) {
+        histos.fill(HIST("event/nsigmaKacut"), track.pt(), track.tofNSigmaKa());
+      }
+      if (isPion) {
+        histos.fill(HIST("event/nsigmaPicut"), track.pt(), track.tofNSigmaPi());
+      }
+      if (!getTrackPar(track).propagateParamToDCA(collPos,
+                                                  magField * 10.f, &dca, 100.)) {
         continue;
       }
-      histos.fill(HIST("event/track1dcaxy"), dca1[0]);
-      histos.fill(HIST("event/track1dcaz"), dca1[1]);
-
-      for (const auto& track2 : tracks) {
-        const auto index2 = track2.globalIndex();
-        if (index1 == index2) {
-          continue;
-        }
-        histos.fill(HIST("event/nsigmaKa"), track2.pt(), track2.tofNSigmaKa());
-        if (usePdg) {
-          if (track2.mcParticle_as<aod::McParticles_000>().pdgCode() != -321) {
-            continue;
-          }
-        } else if (abs(track2.tofNSigmaKa()) > maxNsigmaKa || track2.sign() > 0.f) {
-          continue;
-        }
-        histos.fill(HIST("event/nsigmaKacut"), track2.pt(), track2.tofNSigmaKa());
-        if (!getTrackPar(track2).propagateParamToDCA(collPos,
-                                                     magField * 10.f, &dca2, 100.)) {
-          continue;
-        }
-
-        for (const auto& track3 : tracks) {
-
-          const auto index3 = track3.globalIndex();
-          if (index2 == index3) {
-            continue;
-          }
-          if (index1 == index3) {
-            continue;
-          }
-          histos.fill(HIST("event/nsigmaPi"), track3.pt(), track3.tofNSigmaPi());
-          if (usePdg) {
-            if (track3.mcParticle_as<aod::McParticles_000>().pdgCode() != 211) {
-              continue;
-            }
-          } else if (abs(track3.tofNSigmaPi()) > maxNsigmaPi || track3.sign() < 0.f) {
-            continue;
-          }
-          histos.fill(HIST("event/nsigmaPicut"), track3.pt(), track3.tofNSigmaPi());
-          bool iscut = false;
-          if (abs(dca1[0]) < minDca || abs(dca1[1]) < minDca) {
-            iscut = true;
-          }
-          if (abs(dca1[0]) < minDcaDeuteron || abs(dca1[1]) < minDcaDeuteron) {
-            iscut = true;
-          }
-          if (abs(dca1[0]) > maxDca || abs(dca1[1]) > maxDca) {
-            iscut = true;
-          }
-
-          if (abs(dca2[0]) < minDca || abs(dca2[1]) < minDca) {
-            iscut = true;
-          }
-          if (abs(dca2[0]) > maxDca || abs(dca2[1]) > maxDca) {
-            iscut = true;
-          }
-          if (abs(dca2[0]) < minDcaPion || abs(dca2[1]) < minDcaPion) {
-            iscut = true;
-          }
-          if (track2.pt() < minKaonPt) {
-            iscut = true;
-          }
-          if (track3.pt() < minPionPt) {
-            iscut = true;
-          }
-          if (!getTrackPar(track3).propagateParamToDCA(collPos,
-                                                       magField * 10.f, &dca3, 100.)) {
-            continue;
-          }
-
-          if (abs(dca3[0]) < minDca || abs(dca3[1]) < minDca) {
-            iscut = true;
-          }
-          if (abs(dca3[0]) > maxDca || abs(dca3[1]) > maxDca) {
-            iscut = true;
-          }
 
-          const auto mother1 = track1.mcParticle_as<aod::McParticles_000>().mother0_as<aod::McParticles_000>();
-          const auto mother2 = track2.mcParticle_as<aod::McParticles_000>().mother0_as<aod::McParticles_000>();
-          const auto mother3 = track3.mcParticle_as<aod::McParticles_000>().mother0_as<aod::McParticles_000>();
-          bool issig = true;
-          if (mother1 != mother2) {
-            issig = false;
-          }
-          if (mother1 != mother3) {
-            issig = false;
-          }
-
-          auto pc1 = getTrackParCov(track1);
-          auto pc2 = getTrackParCov(track2);
-          auto pc3 = getTrackParCov(track3);
-          if (pc1.getSigmaY2() * pc1.getSigmaZ2() - pc1.getSigmaZY() * pc1.getSigmaZY() < 0.) {
-            Printf("Track 1 has issues");
-            continue;
-          }
-          if (pc2.getSigmaY2() * pc2.getSigmaZ2() - pc2.getSigmaZY() * pc2.getSigmaZY() < 0.) {
-            Printf("Track 2 has issues");
-            continue;
-          }
-          if (pc3.getSigmaY2() * pc3.getSigmaZ2() - pc3.getSigmaZY() * pc3.getSigmaZY() < 0.) {
-            Printf("Track 3 has issues");
-            continue;
-          }
-          const int status = fitter.process(pc1, pc2, pc3);
-          if (status == 0) {
-            continue;
-          }
-
-          TLorentzVector v1{};
-          v1.SetPtEtaPhiM(track1.pt(), track1.eta(), track1.phi(), 1.8756129);
-
-          TLorentzVector v2{};
-          v2.SetPtEtaPhiM(track2.pt(), track2.eta(), track2.phi(), 0.493677);
-
-          TLorentzVector v3{};
-          v3.SetPtEtaPhiM(track3.pt(), track3.eta(), track3.phi(), 0.139570);
-          v1 += v2;
-          v1 += v3;
-          if (v1.Pt() < minMomPt) {
-            iscut = true;
-          }
+      ProngCandidate prong;
+      prong.trackParCov = getTrackParCov(track);
+      prong.dca = dca;
+      prong.pt = track.pt();
+      prong.eta = track.eta();
+      prong.phi = track.phi();
+      prong.index = track.globalIndex();
+      prong.motherId = particle.mother0Id();
+      prong.prodX = particle.vx();
+      prong.prodY = particle.vy();
+      const auto& pc = prong.trackParCov;
+      prong.hasValidCov = pc.getSigmaY2() * pc.getSigmaZ2() - pc.getSigmaZY() * pc.getSigmaZY() >= 0.;
+      if (!prong.hasValidCov) {
+        Printf("Track %lld has issues", static_cast<long long>(prong.index));
+      }
 
-          // fitter.propagateTracksToVertex();
-          const auto& secVtx = fitter.getPCACandidate();
-          const float decay_radius = sqrt(secVtx[0] * secVtx[0] + secVtx[1] * secVtx[1] + secVtx[2] * secVtx[2]);
-          if (decay_radius < minRadius) {
-            iscut = true;
-          }
-          if (decay_radius > maxRadius) {
-            iscut = true;
-          }
+      if (isDeuteron) {
+        histos.fill(HIST("event/track1dcaxy"), dca[0]);
+        histos.fill(HIST("event/track1dcaz"), dca[1]);
+        if (prong.motherId >= 0) {
+          const auto mother = particle.mother0_as<aod::McParticles_000>();
+          prong.motherVtx = {mother.vx(), mother.vy(), mother.vz()};
+        }
+        prong.isCut = abs(dca[0]) < minDca || abs(dca[1]) < minDca ||
+                      abs(dca[0]) < minDcaDeuteron || abs(dca[1]) < minDcaDeuteron ||
+                      abs(dca[0]) > maxDca || abs(dca[1]) > maxDca;
+        // the deuterons with invalid covariance are kept to count their (zero) candidates
+        deuterons.push_back(prong);
+      }
+      if (!prong.hasValidCov) {
+        continue;
+      }
+      if (isKaon) {
+        prong.isCut = abs(dca[0]) < minDca || abs(dca[1]) < minDca ||
+                      abs(dca[0]) > maxDca || abs(dca[1]) > maxDca ||
+                      abs(dca[0]) < minDcaPion || abs(dca[1]) < minDcaPion ||
+                      prong.pt < minKaonPt;
+        kaons.push_back(prong);
+      }
+      if (isPion) {
+        prong.isCut = prong.pt < minPionPt ||
+                      abs(dca[0]) < minDca || abs(dca[1]) < minDca ||
+                      abs(dca[0]) > maxDca || abs(dca[1]) > maxDca;
+        pions.push_back(prong);
+      }
+    }
 
-          const float magMom = sqrt(v1.Px() * v1.Px() + v1.Py() * v1.Py() + v1.Pz() * v1.Pz());
-          const float CPA = (v1.Px() * secVtx[0] + v1.Py() * secVtx[1] + v1.Pz() * secVtx[2]) / (decay_radius * magMom);
-          if (abs(CPA) < minCpa) {
-            iscut = true;
-          }
+    // build the triplets of each deuteron, in parallel over the deuterons if requested
+    const int nDeuterons = deuterons.size();
+    triplets.resize(nDeuterons);
+    const int nWorkers = std::max(1, std::min<int>(fitters.size(), nDeuterons));
+    auto work = [&](int worker) {
+      const int first = int64_t(nDeuterons) * worker / nWorkers;
+      const int last = int64_t(nDeuterons) * (worker + 1) / nWorkers;
+      for (int i = first; i < last; ++i) {
+        buildTriplets(fitters[worker], i, triplets[i]);
+      }
+    };
+    if (nWorkers == 1) {
+      work(0);
+    } else {
+      std::vector<std::thread> workers;
+      for (int worker = 1; worker < nWorkers; ++worker) {
+        workers.emplace_back(work, worker);
+      }
+      work(0);
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    }
 
-          const float vx = mother1.vx();
-          const float vy = mother1.vy();
-          const float vz = mother1.vz();
-          const float rmc = sqrt((secVtx[0] - vx) * (secVtx[0] - vx) + (secVtx[1] - vy) * (secVtx[1] - vy) + (secVtx[2] - vz) * (secVtx[2] - vz));
-          ncand++;
-          const float radius3xy = sqrt((track3.mcParticle_as<aod::McParticles_000>().vx() - coll.mcCollision().posX()) * (track3.mcParticle_as<aod::McParticles_000>().vx() - coll.mcCollision().posX()) +
-                                       (track3.mcParticle_as<aod::McParticles_000>().vy() - coll.mcCollision().posY()) * (track3.mcParticle_as<aod::McParticles_000>().vy() - coll.mcCollision().posY()));
-
-#define FillHistos(tag)                                                              \
-  histos.fill(HIST(tag "/cpa"), CPA);                                                \
-  histos.fill(HIST(tag "/invmass"), v1.M());                                         \
-  histos.fill(HIST(tag "/invmassVsPt"), v1.Pt(), v1.M());                            \
-  histos.fill(HIST(tag "/decayradius"), decay_radius);                               \
-  histos.fill(HIST(tag "/decayradiusResoX"), secVtx[0] - vx);                        \
-  histos.fill(HIST(tag "/decayradiusResoY"), secVtx[1] - vy);                        \
-  histos.fill(HIST(tag "/decayradiusResoZ"), secVtx[2] - vz);                        \
-  histos.fill(HIST(tag "/radius3xy"), radius3xy);                                    \
-  histos.fill(HIST(tag "/decayradiusReso"), rmc);                                    \
-  histos.fill(HIST(tag "/decaydca0"), TMath::Sqrt(fitter.getChi2AtPCACandidate(0))); \
-  histos.fill(HIST(tag "/decaydca1"), TMath::Sqrt(fitter.getChi2AtPCACandidate(1))); \
-  histos.fill(HIST(tag "/dcaxy1"), dca1[0]);                                         \
-  histos.fill(HIST(tag "/dcaz1"), dca1[1]);                                          \
-  histos.fill(HIST(tag "/dcaxy2"), dca2[0]);                                         \
-  histos.fill(HIST(tag "/dcaz2"), dca2[1]);                                          \
-  histos.fill(HIST(tag "/dcaxy3"), dca3[0]);                                         \
-  histos.fill(HIST(tag "/dcaz3"), dca3[1]);                                          \
-  histos.fill(HIST(tag "/dcaxy1xdcaxy2"), dca1[0] * dca2[0]);                        \
-  histos.fill(HIST(tag "/dcaz1xdcaz2"), dca1[1] * dca2[1]);                          \
-  histos.fill(HIST(tag "/dcaxy3xdcaxy2"), dca3[0] * dca2[0]);                        \
-  histos.fill(HIST(tag "/dcaz3xdcaz2"), dca3[1] * dca2[1]);                          \
-  histos.fill(HIST(tag "/pt1"), track1.pt());                                        \
-  histos.fill(HIST(tag "/pt2"), track2.pt());                                        \
-  histos.fill(HIST(tag "/pt3"), track3.pt());                                        \
-  histos.fill(HIST(tag "/ptmom"), v1.Pt());                                          \
-  histos.fill(HIST(tag "/pmom"), v1.P());
-
-          if (issig) {
-            FillHistos("signocut");
+    for (int i = 0; i < nDeuterons; ++i) {
+      const auto& deuteron = deuterons[i];
+      for (const auto& triplet : triplets[i]) {
+        const auto& kaon = kaons[triplet.kaon];
+        const auto& pion = pions[triplet.pion];
+        const auto& secVtx = triplet.secVtx;
+        const float vx = deuteron.motherVtx[0];
+        const float vy = deuteron.motherVtx[1];
+        const float vz = deuteron.motherVtx[2];
+        const float rmc = sqrt((secVtx[0] - vx) * (secVtx[0] - vx) + (secVtx[1] - vy) * (secVtx[1] - vy) + (secVtx[2] - vz) * (secVtx[2] - vz));
+        const float radius3xy = sqrt((pion.prodX - coll.mcCollision().posX()) * (pion.prodX - coll.mcCollision().posX()) +
+                                     (pion.prodY - coll.mcCollision().posY()) * (pion.prodY - coll.mcCollision().posY()));
+
+#define FillHistos(tag)                                                   \
+  histos.fill(HIST(tag "/cpa"), triplet.cpa);                             \
+  histos.fill(HIST(tag "/invmass"), triplet.invMass);                     \
+  histos.fill(HIST(tag "/invmassVsPt"), triplet.ptMom, triplet.invMass);  \
+  histos.fill(HIST(tag "/decayradius"), triplet.decayRadius);             \
+  histos.fill(HIST(tag "/decayradiusResoX"), secVtx[0] - vx);             \
+  histos.fill(HIST(tag "/decayradiusResoY"), secVtx[1] - vy);             \
+  histos.fill(HIST(tag "/decayradiusResoZ"), secVtx[2] - vz);             \
+  histos.fill(HIST(tag "/radius3xy"), radius3xy);                         \
+  histos.fill(HIST(tag "/decayradiusReso"), rmc);                         \
+  histos.fill(HIST(tag "/decaydca0"), TMath::Sqrt(triplet.chi2AtPCA[0])); \
+  histos.fill(HIST(tag "/decaydca1"), TMath::Sqrt(triplet.chi2AtPCA[1])); \
+  histos.fill(HIST(tag "/dcaxy1"), deuteron.dca[0]);                      \
+  histos.fill(HIST(tag "/dcaz1"), deuteron.dca[1]);                       \
+  histos.fill(HIST(tag "/dcaxy2"), kaon.dca[0]);                          \
+  histos.fill(HIST(tag "/dcaz2"), kaon.dca[1]);                           \
+  histos.fill(HIST(tag "/dcaxy3"), pion.dca[0]);                          \
+  histos.fill(HIST(tag "/dcaz3"), pion.dca[1]);                           \
+  histos.fill(HIST(tag "/dcaxy1xdcaxy2"), deuteron.dca[0] * kaon.dca[0]); \
+  histos.fill(HIST(tag "/dcaz1xdcaz2"), deuteron.dca[1] * kaon.dca[1]);   \
+  histos.fill(HIST(tag "/dcaxy3xdcaxy2"), pion.dca[0] * kaon.dca[0]);     \
+  histos.fill(HIST(tag "/dcaz3xdcaz2"), pion.dca[1] * kaon.dca[1]);       \
+  histos.fill(HIST(tag "/pt1"), deuteron.pt);                             \
+  histos.fill(HIST(tag "/pt2"), kaon.pt);                                 \
+  histos.fill(HIST(tag "/pt3"), pion.pt);                                 \
+  histos.fill(HIST(tag "/ptmom"), triplet.ptMom);                         \
+  histos.fill(HIST(tag "/pmom"), triplet.pMom);
+
+        if (triplet.isSignal) {
+          FillHistos("signocut");
+        } else {
+          FillHistos("bkgnocut");
+        }
+        if (triplet.isCut) {
+          if (triplet.isSignal) {
+            FillHistos("sigcut");
           } else {
-            FillHistos("bkgnocut");
-          }
-          if (iscut) {
-            if (issig) {
-              FillHistos("sigcut");
-            } else {
-              FillHistos("bkgcut");
-            }
-            continue;
+            FillHistos("bkgcut");
           }
+          continue;
+        }
 
-          if (issig) {
-            FillHistos("sig");
-          } else {
-            FillHistos("bkg");
-          }
+        if (triplet.isSignal) {
+          FillHistos("sig");
+        } else {
+          FillHistos("bkg");
+        }
 #undef FillHistos
-
-          // fitterCasc.getTrack(1).getPxPyPzGlo(pvecbach);
-        } // End loop on pions
-      }   // End loop on kaons
-      histos.fill(HIST("event/candperdeuteron"), ncand);
+      } // End loop on candidates
+      histos.fill(HIST("event/candperdeuteron"), triplets[i].size());
     } // End loop on deuterons
   }
 };
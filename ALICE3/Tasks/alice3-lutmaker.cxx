@@ -18,6 +18,13 @@
 #include "ReconstructionDataFormats/Track.h"
 #include "SimulationDataFormat/MCUtils.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <string_view>
+#include <vector>
+
 using namespace o2;
 using namespace framework;
 using namespace framework::expressions;
@@ -46,6 +53,7 @@ struct Alice3LutMaker {
   static constexpr int pdg = PDGs[particle];
   Configurable<bool> addQA{"add-qa", false, "Flag to use add QA plots to show the covariance matrix elements"};
   Configurable<bool> selPrim{"sel-prim", false, "If true selects primaries, if not select all particles"};
+  Configurable<bool> directLut{"direct-lut", false, "Accumulate the mean and RMS of the covariance matrix elements per (pT, eta) bin in flat arrays (LUT/ histograms) instead of filling the CovMat_ profiles"};
 
   Configurable<int> nchBins{"nch-bins", 20, "Number of multiplicity bins"};
   Configurable<float> nchMin{"nch-min", 0.5f, "Lower limit in multiplicity"};
@@ -63,6 +71,16 @@ struct Alice3LutMaker {
 
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
+  // Direct LUT accumulation: running mean and sum of squared deviations (Welford) of the covariance matrix elements,
+  // indexed by the global (pT, eta) bin of the LUT histograms
+  static constexpr int nCovElements = 15;
+  static constexpr std::string_view covNames[nCovElements] = {"cYY", "cZY", "cZZ", "cSnpY", "cSnpZ", "cSnpSnp", "cTglY", "cTglZ", "cTglSnp", "cTglTgl", "c1PtY", "c1PtZ", "c1PtSnp", "c1PtTgl", "c1Pt21Pt2"};
+  std::vector<int64_t> lutEntries;
+  std::vector<std::array<double, nCovElements>> lutMean;
+  std::vector<std::array<double, nCovElements>> lutM2;
+  std::shared_ptr<TH2> hLutEntries;
+  std::array<std::shared_ptr<TH2>, nCovElements> hLutCovariance;
+
   void init(InitContext&)
   {
     const TString commonTitle = Form(" PDG %i", pdg);
@@ -81,6 +99,17 @@ struct Alice3LutMaker {
     histos.add("pt", "pt" + commonTitle, kTH1F, {axisPt});
     histos.add("eta", "eta" + commonTitle, kTH1F, {axisEta});
 
+    if (directLut) {
+      hLutEntries = histos.add<TH2>("LUT/entries", "entries" + commonTitle, kTH2D, {axisPt, axisEta});
+      for (int i = 0; i < nCovElements; i++) {
+        hLutCovariance[i] = histos.add<TH2>(Form("LUT/%s", covNames[i].data()), covNames[i].data() + commonTitle + " (mean #pm RMS)", kTH2D, {axisPt, axisEta});
+      }
+      const int nCells = hLutEntries->GetNcells();
+      lutEntries.assign(nCells, 0);
+      lutMean.assign(nCells, {});
+      lutM2.assign(nCells, {});
+    }
+
     // Track covariance matrix quantities
     histos.add("CovMat_sigmaY", "sigmaY" + commonTitle, kTProfile2D, {axisPt, axisEta});
     histos.add("CovMat_sigmaZ", "sigmaZ" + commonTitle, kTProfile2D, {axisPt, axisEta});
@@ -185,12 +214,82 @@ struct Alice3LutMaker {
     histos.add("QA/CovMat_c1Pt21Pt2", "c1Pt21Pt2" + commonTitle, kTH3F, {axisPt, axisEta, axisc1Pt21Pt2});
   }
 
+  template <typename TrackType>
+  void fillCovarianceProfiles(const float pt, const float eta, const TrackType& track)
+  {
+    histos.fill(HIST("CovMat_sigmaY"), pt, eta, track.sigmaY());
+    histos.fill(HIST("CovMat_sigmaZ"), pt, eta, track.sigmaZ());
+    histos.fill(HIST("CovMat_sigmaSnp"), pt, eta, track.sigmaSnp());
+    histos.fill(HIST("CovMat_sigmaTgl"), pt, eta, track.sigmaTgl());
+    histos.fill(HIST("CovMat_sigma1Pt"), pt, eta, track.sigma1Pt());
+    histos.fill(HIST("CovMat_rhoZY"), pt, eta, track.rhoZY());
+    histos.fill(HIST("CovMat_rhoSnpY"), pt, eta, track.rhoSnpY());
+    histos.fill(HIST("CovMat_rhoSnpZ"), pt, eta, track.rhoSnpZ());
+    histos.fill(HIST("CovMat_rhoTglY"), pt, eta, track.rhoTglY());
+    histos.fill(HIST("CovMat_rhoTglZ"), pt, eta, track.rhoTglZ());
+    histos.fill(HIST("CovMat_rhoTglSnp"), pt, eta, track.rhoTglSnp());
+    histos.fill(HIST("CovMat_rho1PtY"), pt, eta, track.rho1PtY());
+    histos.fill(HIST("CovMat_rho1PtZ"), pt, eta, track.rho1PtZ());
+    histos.fill(HIST("CovMat_rho1PtSnp"), pt, eta, track.rho1PtSnp());
+    histos.fill(HIST("CovMat_rho1PtTgl"), pt, eta, track.rho1PtTgl());
+
+    histos.fill(HIST("CovMat_cYY"), pt, eta, track.cYY());
+    histos.fill(HIST("CovMat_cZY"), pt, eta, track.cZY());
+    histos.fill(HIST("CovMat_cZZ"), pt, eta, track.cZZ());
+    histos.fill(HIST("CovMat_cSnpY"), pt, eta, track.cSnpY());
+    histos.fill(HIST("CovMat_cSnpZ"), pt, eta, track.cSnpZ());
+    histos.fill(HIST("CovMat_cSnpSnp"), pt, eta, track.cSnpSnp());
+    histos.fill(HIST("CovMat_cTglY"), pt, eta, track.cTglY());
+    histos.fill(HIST("CovMat_cTglZ"), pt, eta, track.cTglZ());
+    histos.fill(HIST("CovMat_cTglSnp"), pt, eta, track.cTglSnp());
+    histos.fill(HIST("CovMat_cTglTgl"), pt, eta, track.cTglTgl());
+    histos.fill(HIST("CovMat_c1PtY"), pt, eta, track.c1PtY());
+    histos.fill(HIST("CovMat_c1PtZ"), pt, eta, track.c1PtZ());
+    histos.fill(HIST("CovMat_c1PtSnp"), pt, eta, track.c1PtSnp());
+    histos.fill(HIST("CovMat_c1PtTgl"), pt, eta, track.c1PtTgl());
+    histos.fill(HIST("CovMat_c1Pt21Pt2"), pt, eta, track.c1Pt21Pt2());
+  }
+
+  template <typename TrackType>
+  void accumulateLut(const float pt, const float eta, const TrackType& track)
+  {
+    const int bin = hLutEntries->FindFixBin(pt, eta);
+    const std::array<double, nCovElements> cov = {track.cYY(), track.cZY(), track.cZZ(), track.cSnpY(), track.cSnpZ(),
+                                                  track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
+                                                  track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
+    const double n = ++lutEntries[bin];
+    auto& mean = lutMean[bin];
+    auto& m2 = lutM2[bin];
+    for (int i = 0; i < nCovElements; i++) {
+      const double delta = cov[i] - mean[i];
+      mean[i] += delta / n;
+      m2[i] += delta * (cov[i] - mean[i]);
+    }
+  }
+
+  /// Copies the accumulated LUT into the output histograms: mean as bin content, RMS as bin error
+  void flushLut()
+  {
+    for (std::size_t bin = 0; bin < lutEntries.size(); bin++) {
+      const int64_t n = lutEntries[bin];
+      if (n == 0) {
+        continue;
+      }
+      hLutEntries->SetBinContent(bin, n);
+      for (int i = 0; i < nCovElements; i++) {
+        hLutCovariance[i]->SetBinContent(bin, lutMean[bin][i]);
+        hLutCovariance[i]->SetBinError(bin, std::sqrt(lutM2[bin][i] / n));
+      }
+    }
+  }
+
   void process(const o2::aod::McParticles_000& mcParticles,
                const o2::soa::Join<o2::aod::Collisions, o2::aod::McCollisionLabels>&,
                const o2::soa::Join<o2::aod::Tracks, o2::aod::TracksCov, o2::aod::McTrackLabels>& tracks,
                const o2::aod::McCollisions&)
   {
-    std::vector<int64_t> recoTracks(tracks.size());
+    std::vector<int64_t> recoTracks;
+    recoTracks.reserve(tracks.size());
     int ntrks = 0;
 
     for (const auto& track : tracks) {
@@ -202,42 +301,17 @@ struct Alice3LutMaker {
         continue;
       }
 
-      recoTracks[ntrks++] = mcParticle.globalIndex();
+      recoTracks.push_back(mcParticle.globalIndex());
+      ntrks++;
 
       histos.fill(HIST("pt"), mcParticle.pt());
       histos.fill(HIST("eta"), mcParticle.eta());
 
-      histos.fill(HIST("CovMat_sigmaY"), mcParticle.pt(), mcParticle.eta(), track.sigmaY());
-      histos.fill(HIST("CovMat_sigmaZ"), mcParticle.pt(), mcParticle.eta(), track.sigmaZ());
-      histos.fill(HIST("CovMat_sigmaSnp"), mcParticle.pt(), mcParticle.eta(), track.sigmaSnp());
-      histos.fill(HIST("CovMat_sigmaTgl"), mcParticle.pt(), mcParticle.eta(), track.sigmaTgl());
-      histos.fill(HIST("CovMat_sigma1Pt"), mcParticle.pt(), mcParticle.eta(), track.sigma1Pt());
-      histos.fill(HIST("CovMat_rhoZY"), mcParticle.pt(), mcParticle.eta(), track.rhoZY());
-      histos.fill(HIST("CovMat_rhoSnpY"), mcParticle.pt(), mcParticle.eta(), track.rhoSnpY());
-      histos.fill(HIST("CovMat_rhoSnpZ"), mcParticle.pt(), mcParticle.eta(), track.rhoSnpZ());
-      histos.fill(HIST("CovMat_rhoTglY"), mcParticle.pt(), mcParticle.eta(), track.rhoTglY());
-      histos.fill(HIST("CovMat_rhoTglZ"), mcParticle.pt(), mcParticle.eta(), track.rhoTglZ());
-      histos.fill(HIST("CovMat_rhoTglSnp"), mcParticle.pt(), mcParticle.eta(), track.rhoTglSnp());
-      histos.fill(HIST("CovMat_rho1PtY"), mcParticle.pt(), mcParticle.eta(), track.rho1PtY());
-      histos.fill(HIST("CovMat_rho1PtZ"), mcParticle.pt(), mcParticle.eta(), track.rho1PtZ());
-      histos.fill(HIST("CovMat_rho1PtSnp"), mcParticle.pt(), mcParticle.eta(), track.rho1PtSnp());
-      histos.fill(HIST("CovMat_rho1PtTgl"), mcParticle.pt(), mcParticle.eta(), track.rho1PtTgl());
-
-      histos.fill(HIST("CovMat_cYY"), mcParticle.pt(), mcParticle.eta(), track.cYY());
-      histos.fill(HIST("CovMat_cZY"), mcParticle.pt(), mcParticle.eta(), track.cZY());
-      histos.fill(HIST("CovMat_cZZ"), mcParticle.pt(), mcParticle.eta(), track.cZZ());
-      histos.fill(HIST("CovMat_cSnpY"), mcParticle.pt(), mcParticle.eta(), track.cSnpY());
-      histos.fill(HIST("CovMat_cSnpZ"), mcParticle.pt(), mcParticle.eta(), track.cSnpZ());
-      histos.fill(HIST("CovMat_cSnpSnp"), mcParticle.pt(), mcParticle.eta(), track.cSnpSnp());
-      histos.fill(HIST("CovMat_cTglY"), mcParticle.pt(), mcParticle.eta(), track.cTglY());
-      histos.fill(HIST("CovMat_cTglZ"), mcParticle.pt(), mcParticle.eta(), track.cTglZ());
-      histos.fill(HIST("CovMat_cTglSnp"), mcParticle.pt(), mcParticle.eta(), track.cTglSnp());
-      histos.fill(HIST("CovMat_cTglTgl"), mcParticle.pt(), mcParticle.eta(), track.cTglTgl());
-      histos.fill(HIST("CovMat_c1PtY"), mcParticle.pt(), mcParticle.eta(), track.c1PtY());
-      histos.fill(HIST("CovMat_c1PtZ"), mcParticle.pt(), mcParticle.eta(), track.c1PtZ());
-      histos.fill(HIST("CovMat_c1PtSnp"), mcParticle.pt(), mcParticle.eta(), track.c1PtSnp());
-      histos.fill(HIST("CovMat_c1PtTgl"), mcParticle.pt(), mcParticle.eta(), track.c1PtTgl());
-      histos.fill(HIST("CovMat_c1Pt21Pt2"), mcParticle.pt(), mcParticle.eta(), track.c1Pt21Pt2());
+      if (directLut) {
+        accumulateLut(mcParticle.pt(), mcParticle.eta(), track);
+      } else {
+        fillCovarianceProfiles(mcParticle.pt(), mcParticle.eta(), track);
+      }
 
       if (!addQA) { // Only if QA histograms are enabled
         continue;
@@ -276,6 +350,10 @@ struct Alice3LutMaker {
       histos.fill(HIST("QA/CovMat_c1Pt21Pt2"), mcParticle.pt(), mcParticle.eta(), track.c1Pt21Pt2());
     }
     histos.fill(HIST("multiplicity"), ntrks);
+    if (directLut) {
+      flushLut();
+    }
+    std::sort(recoTracks.begin(), recoTracks.end());
 
     for (const auto& mcParticle : mcParticles) {
       if (mcParticle.pdgCode() != pdg) {
@@ -285,7 +363,7 @@ struct Alice3LutMaker {
         continue;
       }
 
-      if (std::find(recoTracks.begin(), recoTracks.end(), mcParticle.globalIndex()) != recoTracks.end()) {
+      if (std::binary_search(recoTracks.begin(), recoTracks.end(), mcParticle.globalIndex())) {
         histos.fill(HIST("Efficiency"), mcParticle.pt(), mcParticle.eta(), 1.);
       } else {
         histos.fill(HIST("Efficiency"), mcParticle.pt(), mcParticle.eta(), 0.);
@@ -0,0 +1,170 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   DataFrameArena.h
+/// \brief  Bump allocator for the temporary containers of a process call
+///
+/// The memory is taken in large blocks and handed out sequentially; deallocations are no-ops and
+/// everything is released at once by reset(). After a reset the blocks are merged into one of the
+/// total size, so that after the first dataframes the temporaries of a process call are served
+/// from a single block without any call to the heap.
+///
+/// Usage:
+///   o2::analysis::DataFrameArena arena;                  // task member
+///   arena.reset();                                       // at the beginning of process
+///   o2::analysis::ArenaVector<int64_t> ids(arena);        // temporaries of the process call
+///
+/// NOTE: the containers using the arena must not outlive the process call, i.e. they must be
+/// destroyed before the next reset. Growing containers leave their old buffers in the arena
+/// until the reset, so reserve() is still worth calling when the size is known.
+///
+
+#ifndef COMMON_CORE_DATAFRAMEARENA_H_
+#define COMMON_CORE_DATAFRAMEARENA_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace o2::analysis
+{
+
+class DataFrameArena
+{
+ public:
+  /// \param blockSize Minimum size in bytes of the blocks taken from the heap
+  explicit DataFrameArena(std::size_t blockSize = 1 << 20) : mBlockSize(blockSize) {}
+  DataFrameArena(DataFrameArena const&) = delete;
+  DataFrameArena& operator=(DataFrameArena const&) = delete;
+
+  void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+  {
+    if (mBlocks.empty() || !fits(mBlocks[mCurrent], bytes, alignment)) {
+      nextBlock(bytes + alignment);
+    }
+    auto& block = mBlocks[mCurrent];
+    const uintptr_t address = (reinterpret_cast<uintptr_t>(block.data.get()) + block.offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    block.offset = address + bytes - reinterpret_cast<uintptr_t>(block.data.get());
+    mUsed += bytes;
+    mPeak = std::max(mPeak, mUsed);
+    return reinterpret_cast<void*>(address);
+  }
+
+  /// Memory is only released by reset()
+  void deallocate(void*, std::size_t) noexcept {}
+
+  /// Releases all the allocations at once
+  /// The blocks are kept, and merged into one block of the total size if more than one was needed
+  void reset()
+  {
+    if (mBlocks.size() > 1) {
+      std::size_t capacity = getCapacity();
+      mBlocks.clear();
+      mBlocks.push_back(Block(capacity));
+    }
+    for (auto& block : mBlocks) {
+      block.offset = 0;
+    }
+    mCurrent = 0;
+    mUsed = 0;
+  }
+
+  /// \return Number of bytes allocated since the last reset
+  std::size_t getUsed() const { return mUsed; }
+  /// \return Maximum number of bytes allocated between two resets
+  std::size_t getPeak() const { return mPeak; }
+  /// \return Number of bytes owned by the arena
+  std::size_t getCapacity() const
+  {
+    std::size_t capacity = 0;
+    for (const auto& block : mBlocks) {
+      capacity += block.size;
+    }
+    return capacity;
+  }
+
+ private:
+  struct Block {
+    explicit Block(std::size_t n) : data(new std::byte[n]), size(n) {}
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size;
+    std::size_t offset = 0;
+  };
+
+  static bool fits(Block const& block, std::size_t bytes, std::size_t alignment)
+  {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(block.data.get());
+    const uintptr_t address = (begin + block.offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    return address + bytes <= begin + block.size;
+  }
+
+  void nextBlock(std::size_t minSize)
+  {
+    // blocks kept from the previous dataframes are reused first
+    while (mCurrent + 1 < mBlocks.size()) {
+      mCurrent++;
+      if (mBlocks[mCurrent].size >= minSize) {
+        return;
+      }
+    }
+    mBlocks.push_back(Block(std::max(minSize, mBlockSize)));
+    mCurrent = mBlocks.size() - 1;
+  }
+
+  std::size_t mBlockSize;
+  std::vector<Block> mBlocks;
+  std::size_t mCurrent = 0; // block of the next allocation
+  std::size_t mUsed = 0;
+  std::size_t mPeak = 0;
+};
+
+/// STL allocator taking the memory from a DataFrameArena
+template <typename T>
+class ArenaAllocator
+{
+ public:
+  using value_type = T;
+
+  ArenaAllocator(DataFrameArena& arena) noexcept : mArena(&arena) {} // NOLINT: implicit, to construct the containers from the arena
+  template <typename U>
+  ArenaAllocator(ArenaAllocator<U> const& other) noexcept : mArena(other.getArena())
+  {
+  }
+
+  T* allocate(std::size_t n) { return static_cast<T*>(mArena->allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T* p, std::size_t n) noexcept { mArena->deallocate(p, n * sizeof(T)); }
+
+  DataFrameArena* getArena() const noexcept { return mArena; }
+
+  template <typename U>
+  bool operator==(ArenaAllocator<U> const& other) const noexcept
+  {
+    return mArena == other.getArena();
+  }
+  template <typename U>
+  bool operator!=(ArenaAllocator<U> const& other) const noexcept
+  {
+    return mArena != other.getArena();
+  }
+
+ private:
+  DataFrameArena* mArena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_DATAFRAMEARENA_H_
@@ -12,8 +12,157 @@
 #ifndef ANALYSIS_CORE_EVENTMIXING_H_
 #define ANALYSIS_CORE_EVENTMIXING_H_
 
+#include <cmath>
+#include <vector>
+
 namespace eventmixing
 {
+/// Find the bin of a value in a list of bin edges, with a branchless binary search
+/// The bin i covers the range [edges[i], edges[i + 1])
+/// \tparam T1 Data type of the container of the bin edges
+/// \tparam T2 Data type of the value
+/// \param edges Bin edges, in increasing order
+/// \param nEdges Number of bin edges
+/// \param value Value to look up
+/// \return Bin index, starting from 0, or -1 if the value is outside the edges (or NaN)
+template <typename T1, typename T2>
+inline int findBin(const T1& edges, int nEdges, const T2& value)
+{
+  if (nEdges < 2 || !(value >= edges[0] && value < edges[nEdges - 1])) {
+    return -1;
+  }
+  // search for the last edge lower or equal than the value, without branches in the loop
+  int base = 0;
+  int n = nEdges - 1;
+  while (n > 1) {
+    int half = n / 2;
+    base = (edges[base + half] <= value) ? base + half : base;
+    n -= half;
+  }
+  return base;
+}
+
+/// Bin edges of one mixing variable
+/// The lookup is done with arithmetic for uniform binnings and with a binary search otherwise
+class BinningAxis
+{
+ public:
+  BinningAxis() = default;
+  template <typename T>
+  explicit BinningAxis(const T& edges)
+  {
+    setEdges(edges);
+  }
+
+  /// \param edges Bin edges, in increasing order, from any container with size() and operator[]
+  template <typename T>
+  void setEdges(const T& edges)
+  {
+    mEdges.assign(edges.begin(), edges.end());
+    mUniform = false;
+    int nBins = getNBins();
+    if (nBins < 1) {
+      return;
+    }
+    float width = (mEdges[nBins] - mEdges[0]) / nBins;
+    if (!(width > 0.f)) {
+      return;
+    }
+    mUniform = true;
+    for (int i = 1; i <= nBins; i++) {
+      if (std::abs(mEdges[i] - (mEdges[0] + i * width)) > 1.e-5f * width) {
+        mUniform = false;
+        break;
+      }
+    }
+    mInvWidth = 1.f / width;
+  }
+
+  int getNBins() const { return mEdges.size() > 1 ? mEdges.size() - 1 : 0; }
+  std::vector<float> const& getEdges() const { return mEdges; }
+  bool isUniform() const { return mUniform; }
+
+  /// \return Bin index, starting from 0, or -1 if the value is outside the edges (or NaN)
+  int findBin(float value) const
+  {
+    if (!mUniform) {
+      return eventmixing::findBin(mEdges, mEdges.size(), value);
+    }
+    int nBins = getNBins();
+    if (!(value >= mEdges[0] && value < mEdges[nBins])) {
+      return -1;
+    }
+    // the rounding of the arithmetic is corrected against the actual edges
+    int bin = static_cast<int>((value - mEdges[0]) * mInvWidth);
+    bin = bin < nBins ? bin : nBins - 1;
+    if (value < mEdges[bin]) {
+      bin--;
+    } else if (value >= mEdges[bin + 1]) {
+      bin++;
+    }
+    return bin;
+  }
+
+ private:
+  std::vector<float> mEdges; // bin edges
+  bool mUniform = false;     // true if the bins have all the same width
+  float mInvWidth = 0.f;     // inverse of the bin width, for uniform binnings
+};
+
+/// Binning in N mixing variables, with the bins packed in one integer hash
+/// The hash is row-major: the first axis varies the slowest, the last one the fastest
+class MixingBinning
+{
+ public:
+  template <typename T>
+  void addAxis(const T& edges)
+  {
+    mAxes.emplace_back(edges);
+    mStrides.push_back(1);
+    for (unsigned int i = 0; i < mAxes.size() - 1; i++) {
+      mStrides[i] *= mAxes.back().getNBins();
+    }
+  }
+  void clear()
+  {
+    mAxes.clear();
+    mStrides.clear();
+  }
+
+  int getNAxes() const { return mAxes.size(); }
+  BinningAxis const& getAxis(int axis) const { return mAxes[axis]; }
+  int getNCategories() const { return mAxes.empty() ? 0 : mStrides[0] * mAxes[0].getNBins(); }
+
+  /// \param values Values of the variables
+  /// \param indices Position in values of the variable of each axis, if nullptr the values are in the order of the axes
+  /// \return Hash of the event, or -1 if any of the values is outside its binning
+  int getHash(const float* values, const int* indices = nullptr) const
+  {
+    if (mAxes.empty()) {
+      return -1;
+    }
+    int hash = 0;
+    for (unsigned int i = 0; i < mAxes.size(); i++) {
+      int bin = mAxes[i].findBin(values[indices ? indices[i] : i]);
+      if (bin < 0) {
+        return -1;
+      }
+      hash += bin * mStrides[i];
+    }
+    return hash;
+  }
+
+  /// \return Bin in the given axis of a hash computed with getHash()
+  int getBin(int axis, int hash) const
+  {
+    return (hash / mStrides[axis]) % mAxes[axis].getNBins();
+  }
+
+ private:
+  std::vector<BinningAxis> mAxes; // binning of each mixing variable
+  std::vector<int> mStrides;      // hash stride of each axis
+};
+
 /// Calculate hash for an element based on 2 properties and their bins.
 /// \tparam T1 Data type of the configurable of the z-vertex and multiplicity bins
 /// \tparam T2 Data type of the value of the z-vertex and multiplicity
@@ -25,25 +174,16 @@ namespace eventmixing
 template <typename T1, typename T2>
 static int getMixingBin(const T1& vtxBins, const T1& multBins, const T2& vtx, const T2& mult)
 {
-  // underflow
-  if (vtx < vtxBins.at(0)) {
+  // the bins are numbered from 1, -1 for underflow and overflow
+  int vtxBin = findBin(vtxBins, vtxBins.size(), vtx);
+  if (vtxBin < 0) {
     return -1;
   }
-  if (mult < multBins.at(0)) {
+  int multBin = findBin(multBins, multBins.size(), mult);
+  if (multBin < 0) {
     return -1;
   }
-
-  for (unsigned int i = 1; i < vtxBins.size(); i++) {
-    if (vtx < vtxBins.at(i)) {
-      for (unsigned int j = 1; j < multBins.size(); j++) {
-        if (mult < multBins.at(j)) {
-          return i + j * (vtxBins.size() + 1);
-        }
-      }
-    }
-  }
-  // overflow
-  return -1;
+  return (vtxBin + 1) + (multBin + 1) * (vtxBins.size() + 1);
 }
 }; // namespace eventmixing
 
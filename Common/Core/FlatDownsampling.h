@@ -0,0 +1,98 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   FlatDownsampling.h
+/// \brief  Downsampling of the tracks of the skimmed tables to a flat occupancy in (p, eta)
+///
+/// An occupancy map, i.e. the (p, eta) distribution of the candidates before the downsampling,
+/// is turned at init into a keep probability per bin, min(1, target / occupancy),
+/// so that the skims contain about the same number of tracks in all the populated bins.
+/// The tracks outside of the map or in empty bins are always kept.
+///
+/// Also provides the truncation of the mantissa of the float columns: the lowest bits
+/// are zeroed so that the columns are compressed better when the precision is not needed.
+///
+
+#ifndef COMMON_CORE_FLATDOWNSAMPLING_H_
+#define COMMON_CORE_FLATDOWNSAMPLING_H_
+
+#include <TH2.h>
+#include <TString.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace o2::analysis
+{
+
+class FlatDownsampling
+{
+ public:
+  /// Set the occupancy map
+  /// \param occupancy (p, eta) distribution of the candidates
+  /// \param target Number of candidates to keep per bin, if <= 0 the content of the least populated non-empty bin is used
+  void setMap(const TH2* occupancy, double target)
+  {
+    mProbability.reset(static_cast<TH2*>(occupancy->Clone(Form("%s_keepProbability", occupancy->GetName()))));
+    mProbability->SetDirectory(nullptr);
+    if (target <= 0.) {
+      target = -1.;
+      for (int i = 0; i < mProbability->GetNcells(); i++) {
+        const double content = mProbability->GetBinContent(i);
+        if (content > 0. && (target < 0. || content < target)) {
+          target = content;
+        }
+      }
+    }
+    for (int i = 0; i < mProbability->GetNcells(); i++) {
+      const double content = mProbability->GetBinContent(i);
+      mProbability->SetBinContent(i, content > 0. ? std::min(1., target / content) : 1.);
+    }
+  }
+
+  bool isEnabled() const { return mProbability != nullptr; }
+
+  /// Keep probability of a candidate, 1 if no map is set
+  float getProbability(float p, float eta) const
+  {
+    if (!mProbability) {
+      return 1.f;
+    }
+    return mProbability->GetBinContent(mProbability->FindFixBin(p, eta));
+  }
+
+  /// \param random Uniform random number in [0, 1)
+  bool keep(float p, float eta, float random) const { return random < getProbability(p, eta); }
+
+ private:
+  std::unique_ptr<TH2> mProbability = nullptr; /// Keep probability per (p, eta) bin
+};
+
+/// Zero the lowest bits of the mantissa of a float
+/// \param nBits Number of mantissa bits kept (0 to 23), 23 or more leaves the value unchanged
+inline float truncateMantissa(float value, int nBits)
+{
+  if (nBits >= 23 || nBits < 0) {
+    return value;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits &= ~((1u << (23 - nBits)) - 1u);
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+}
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_FLATDOWNSAMPLING_H_
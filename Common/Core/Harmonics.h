@@ -0,0 +1,90 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   Harmonics.h
+/// \brief  cos(n phi) and sin(n phi) of all the harmonics n = 0..nMax, for the Q-vector filling
+///
+/// Only cos(phi) and sin(phi) are evaluated with the math library, the higher harmonics
+/// are obtained with the angle addition formulas:
+///   cos(n phi) = cos((n - 1) phi) cos(phi) - sin((n - 1) phi) sin(phi)
+///   sin(n phi) = sin((n - 1) phi) cos(phi) + cos((n - 1) phi) sin(phi)
+/// which keep the rounding error growing only linearly with n.
+///
+
+#ifndef COMMON_CORE_HARMONICS_H_
+#define COMMON_CORE_HARMONICS_H_
+
+#include <cmath>
+
+namespace harmonics
+{
+/// Harmonics of one angle
+/// \param phi Angle
+/// \param nMax Highest harmonic
+/// \param cosN Output cos(n phi), n = 0..nMax (nMax + 1 values)
+/// \param sinN Output sin(n phi), n = 0..nMax (nMax + 1 values)
+template <typename T>
+inline void compute(T phi, int nMax, T* cosN, T* sinN)
+{
+  cosN[0] = 1;
+  sinN[0] = 0;
+  if (nMax < 1) {
+    return;
+  }
+  const T cos1 = std::cos(phi);
+  const T sin1 = std::sin(phi);
+  cosN[1] = cos1;
+  sinN[1] = sin1;
+  for (int n = 2; n <= nMax; ++n) {
+    cosN[n] = cosN[n - 1] * cos1 - sinN[n - 1] * sin1;
+    sinN[n] = sinN[n - 1] * cos1 + cosN[n - 1] * sin1;
+  }
+}
+
+/// Harmonics of a batch of angles
+/// The output is harmonic-major, so that each step of the recursion is a loop without dependencies over the angles,
+/// which the compiler vectorises
+/// \param nAngles Number of angles
+/// \param phi Angles
+/// \param nMax Highest harmonic
+/// \param cosN Output cos(n phi[i]) at [n * nAngles + i], n = 0..nMax ((nMax + 1) * nAngles values)
+/// \param sinN Output sin(n phi[i]) at [n * nAngles + i], n = 0..nMax ((nMax + 1) * nAngles values)
+template <typename T>
+inline void computeBatch(int nAngles, const T* phi, int nMax, T* cosN, T* sinN)
+{
+  for (int i = 0; i < nAngles; ++i) {
+    cosN[i] = 1;
+    sinN[i] = 0;
+  }
+  if (nMax < 1) {
+    return;
+  }
+  T* cos1 = cosN + nAngles;
+  T* sin1 = sinN + nAngles;
+  for (int i = 0; i < nAngles; ++i) {
+    cos1[i] = std::cos(phi[i]);
+    sin1[i] = std::sin(phi[i]);
+  }
+  for (int n = 2; n <= nMax; ++n) {
+    const T* cosPrev = cosN + (n - 1) * nAngles;
+    const T* sinPrev = sinN + (n - 1) * nAngles;
+    T* cosCur = cosN + n * nAngles;
+    T* sinCur = sinN + n * nAngles;
+    for (int i = 0; i < nAngles; ++i) {
+      cosCur[i] = cosPrev[i] * cos1[i] - sinPrev[i] * sin1[i];
+      sinCur[i] = sinPrev[i] * cos1[i] + cosPrev[i] * sin1[i];
+    }
+  }
+}
+} // namespace harmonics
+
+#endif // COMMON_CORE_HARMONICS_H_
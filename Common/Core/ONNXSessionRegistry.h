@@ -0,0 +1,189 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ONNXSessionRegistry.h
+/// \brief  Process-wide registry of ONNX Runtime sessions
+///
+/// All the ONNX models of a device share one Ort::Env, and each model file is
+/// loaded only once per key (model path and validity), independently of how
+/// many tasks of the same device request it.
+///
+/// The sessions can be run on a GPU execution provider (CUDA, ROCm, TensorRT)
+/// if the ONNX Runtime build provides it and the device can be initialised,
+/// otherwise they fall back to the CPU.
+///
+
+#ifndef COMMON_CORE_ONNXSESSIONREGISTRY_H_
+#define COMMON_CORE_ONNXSESSIONREGISTRY_H_
+
+#include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+/// Settings of the ONNX Runtime sessions created by the registry
+struct ONNXSessionSettings {
+  int intraOpNumThreads = 1;             // threads used to parallelise the execution within the nodes (0 = ORT default)
+  int interOpNumThreads = 1;             // threads used to parallelise the execution of the graph (0 = ORT default)
+  bool enableGraphOptimization = true;   // apply the extended graph optimisations at load time
+  bool enableMemPattern = true;          // reuse the memory allocation pattern between runs
+  std::string executionProvider = "cpu"; // cpu, cuda, rocm or tensorrt, the CPU is used if the provider is not available
+  int deviceId = 0;                      // GPU used by the GPU execution providers
+};
+
+class ONNXSessionRegistry
+{
+ public:
+  using SessionPtr = std::shared_ptr<Ort::Experimental::Session>;
+
+  ONNXSessionRegistry(ONNXSessionRegistry const&) = delete;
+  ONNXSessionRegistry& operator=(ONNXSessionRegistry const&) = delete;
+
+  /// \return the registry of the current process
+  static ONNXSessionRegistry& instance()
+  {
+    static ONNXSessionRegistry registry;
+    return registry;
+  }
+
+  /// Builds the key of a model
+  /// \param path is the CCDB (or local) path of the model
+  /// \param validFrom is the start of the validity (or the CCDB timestamp) of the model
+  /// \param validUntil is the end of the validity of the model
+  /// \return the key identifying the model in the registry
+  static std::string makeKey(std::string const& path, uint64_t validFrom = 0, uint64_t validUntil = 0)
+  {
+    return path + "@" + std::to_string(validFrom) + "-" + std::to_string(validUntil);
+  }
+
+  /// \param key is the key of the model
+  /// \return the session already loaded for the key, nullptr if none
+  SessionPtr find(std::string const& key) const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto session = mSessions.find(key);
+    return session != mSessions.end() ? session->second : nullptr;
+  }
+
+  /// Returns the session of a model, loading it from file at the first request
+  /// \param key is the key of the model, see makeKey
+  /// \param modelFile is the local file of the model, only read if the key is not registered yet
+  /// \param settings are the session settings, only used when the model is loaded
+  /// \return the shared session
+  SessionPtr getSession(std::string const& key, std::string const& modelFile, ONNXSessionSettings const& settings = ONNXSessionSettings())
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& session = mSessions[key];
+    if (!session) {
+      LOG(info) << "Loading ONNX model " << key << " from file: " << modelFile;
+      std::string modelPath = modelFile; // the experimental API takes a non-const reference
+      if (isGPUProvider(settings.executionProvider)) {
+        try {
+          auto sessionOptions = makeSessionOptions(settings);
+          if (appendExecutionProvider(sessionOptions, settings)) {
+            session = std::make_shared<Ort::Experimental::Session>(mEnv, modelPath, sessionOptions);
+            LOG(info) << "ONNX model " << key << " running on the " << settings.executionProvider << " execution provider, device " << settings.deviceId;
+          }
+        } catch (const Ort::Exception& exception) {
+          LOG(warning) << "Cannot create the session of ONNX model " << key << " on the " << settings.executionProvider << " execution provider (" << exception.what() << "), falling back to the CPU";
+        }
+      } else if (settings.executionProvider != "cpu") {
+        LOG(warning) << "Unknown ONNX Runtime execution provider " << settings.executionProvider << ", using the CPU";
+      }
+      if (!session) {
+        auto sessionOptions = makeSessionOptions(settings);
+        session = std::make_shared<Ort::Experimental::Session>(mEnv, modelPath, sessionOptions);
+      }
+    } else {
+      LOG(info) << "Reusing ONNX model " << key;
+    }
+    return session;
+  }
+
+  /// \return the ONNX Runtime environment shared by all the sessions
+  Ort::Env& getEnv() { return mEnv; }
+
+  /// Releases the sessions held by the registry, the ones still in use stay alive
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSessions.clear();
+  }
+
+ private:
+  ONNXSessionRegistry() : mEnv(ORT_LOGGING_LEVEL_WARNING, "o2physics-onnx") {}
+
+  static bool isGPUProvider(std::string const& provider) { return provider == "cuda" || provider == "rocm" || provider == "tensorrt"; }
+
+  static Ort::SessionOptions makeSessionOptions(ONNXSessionSettings const& settings)
+  {
+    Ort::SessionOptions sessionOptions;
+    sessionOptions.SetIntraOpNumThreads(settings.intraOpNumThreads);
+    sessionOptions.SetInterOpNumThreads(settings.interOpNumThreads);
+    sessionOptions.SetGraphOptimizationLevel(settings.enableGraphOptimization ? GraphOptimizationLevel::ORT_ENABLE_EXTENDED : GraphOptimizationLevel::ORT_DISABLE_ALL);
+    if (settings.enableMemPattern) {
+      sessionOptions.EnableMemPattern();
+    } else {
+      sessionOptions.DisableMemPattern();
+    }
+    return sessionOptions;
+  }
+
+  /// Adds the GPU execution provider of the settings to the session options
+  /// \return false if the provider is not part of the ONNX Runtime build, throws Ort::Exception if it cannot be initialised
+  static bool appendExecutionProvider(Ort::SessionOptions& sessionOptions, ONNXSessionSettings const& settings)
+  {
+    const std::string providerName = settings.executionProvider == "cuda" ? "CUDAExecutionProvider" : (settings.executionProvider == "rocm" ? "ROCMExecutionProvider" : "TensorrtExecutionProvider");
+    auto available = Ort::GetAvailableProviders();
+    if (std::find(available.begin(), available.end(), providerName) == available.end()) {
+      LOG(warning) << providerName << " not available in this ONNX Runtime build, falling back to the CPU";
+      return false;
+    }
+    if (settings.executionProvider == "rocm") {
+      OrtROCMProviderOptions rocmOptions{};
+      rocmOptions.device_id = settings.deviceId;
+      sessionOptions.AppendExecutionProvider_ROCM(rocmOptions);
+      return true;
+    }
+    if (settings.executionProvider == "tensorrt") {
+      OrtTensorRTProviderOptions tensorRTOptions{};
+      tensorRTOptions.device_id = settings.deviceId;
+      tensorRTOptions.trt_max_partition_iterations = 1000; // ONNX Runtime defaults, not set by the value initialisation
+      tensorRTOptions.trt_min_subgraph_size = 1;
+      tensorRTOptions.trt_max_workspace_size = 1 << 30;
+      sessionOptions.AppendExecutionProvider_TensorRT(tensorRTOptions);
+      // the nodes not supported by TensorRT go to CUDA rather than to the CPU
+    }
+    OrtCUDAProviderOptions cudaOptions{};
+    cudaOptions.device_id = settings.deviceId;
+    sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
+    return true;
+  }
+
+  Ort::Env mEnv;                                         // environment shared by all the sessions
+  mutable std::mutex mMutex;                             // protects the session map
+  std::unordered_map<std::string, SessionPtr> mSessions; // sessions by model key
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_ONNXSESSIONREGISTRY_H_
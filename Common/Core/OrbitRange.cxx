@@ -11,18 +11,87 @@
 
 //
 // Container to store minimum and maximum orbit counter
+// and the coverage of the orbits in between, as a bitmap with one bit per bin of fOrbitsPerBin orbits
 //
 
+#include <bitset>
 #include "Common/Core/OrbitRange.h"
 #include "TCollection.h"
 #include "TMath.h"
 
 ClassImp(OrbitRange)
 
-  Long64_t OrbitRange::Merge(TCollection* list)
+  void OrbitRange::SetOrbitsPerBin(uint32_t orbitsPerBin)
+{
+  if (!fCoverage.empty()) {
+    printf("Warning: the granularity of the orbit coverage cannot be changed once filled\n");
+    return;
+  }
+  fOrbitsPerBin = orbitsPerBin > 0 ? orbitsPerBin : 1;
+}
+
+void OrbitRange::ExtendCoverage(uint32_t firstWord, uint32_t lastWord)
+{
+  // Extends the bitmap to the words [firstWord, lastWord]
+  if (fCoverage.empty()) {
+    fFirstWord = firstWord;
+    fCoverage.assign(lastWord - firstWord + 1, 0);
+    return;
+  }
+  if (firstWord < fFirstWord) {
+    fCoverage.insert(fCoverage.begin(), fFirstWord - firstWord, 0);
+    fFirstWord = firstWord;
+  }
+  if (lastWord >= fFirstWord + fCoverage.size()) {
+    fCoverage.resize(lastWord - fFirstWord + 1, 0);
+  }
+}
+
+void OrbitRange::AddOrbit(uint32_t orbit)
+{
+  fMinOrbit = TMath::Min(fMinOrbit, orbit);
+  fMaxOrbit = TMath::Max(fMaxOrbit, orbit);
+  const uint32_t bin = orbit / fOrbitsPerBin;
+  const uint32_t word = bin / 64;
+  if (fCoverage.empty() || word < fFirstWord || word >= fFirstWord + fCoverage.size()) {
+    ExtendCoverage(word, word);
+  }
+  fCoverage[word - fFirstWord] |= 1ull << (bin % 64);
+}
+
+bool OrbitRange::IsCovered(uint32_t orbit) const
+{
+  const uint32_t bin = orbit / fOrbitsPerBin;
+  const uint32_t word = bin / 64;
+  if (word < fFirstWord || word >= fFirstWord + fCoverage.size()) {
+    return false;
+  }
+  return (fCoverage[word - fFirstWord] >> (bin % 64)) & 1ull;
+}
+
+ULong64_t OrbitRange::GetNCoveredBins() const
+{
+  ULong64_t count = 0;
+  for (const auto word : fCoverage) {
+    count += std::bitset<64>(word).count();
+  }
+  return count;
+}
+
+Double_t OrbitRange::GetCoveredFraction() const
+{
+  if (fMaxOrbit < fMinOrbit) {
+    return 0.;
+  }
+  const ULong64_t nBins = fMaxOrbit / fOrbitsPerBin - fMinOrbit / fOrbitsPerBin + 1;
+  return static_cast<Double_t>(GetNCoveredBins()) / nBins;
+}
+
+Long64_t OrbitRange::Merge(TCollection* list)
 {
   // Merge a list of OrbitRange objects
   // Stores minimum and maximum orbit among all merged orbit ranges
+  // and the union of their orbit coverages
   // Returns the number of merged objects (including this).
 
   if (!list) {
@@ -48,6 +117,22 @@ ClassImp(OrbitRange)
     fMinOrbit = TMath::Min(fMinOrbit, entry->GetMinOrbit());
     fMaxOrbit = TMath::Max(fMaxOrbit, entry->GetMaxOrbit());
     count++;
+    const auto& coverage = entry->GetCoverage();
+    if (coverage.empty()) {
+      continue;
+    }
+    if (fCoverage.empty()) {
+      fOrbitsPerBin = entry->GetOrbitsPerBin();
+    }
+    if (fOrbitsPerBin != entry->GetOrbitsPerBin()) {
+      printf("Warning: merging of orbit coverages with different granularities is forbidden\n");
+      continue;
+    }
+    ExtendCoverage(entry->GetFirstWord(), entry->GetFirstWord() + coverage.size() - 1);
+    ULong64_t* words = fCoverage.data() + (entry->GetFirstWord() - fFirstWord);
+    for (size_t i = 0; i < coverage.size(); i++) {
+      words[i] |= coverage[i];
+    }
   }
 
   return count + 1;
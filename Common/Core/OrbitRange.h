@@ -11,32 +11,51 @@
 
 //
 // Container to store minimum and maximum orbit counter
+// and the coverage of the orbits in between, as a bitmap with one bit per bin of fOrbitsPerBin orbits
 //
 
 #ifndef OrbitRange_H
 #define OrbitRange_H
 
+#include <vector>
 #include "TNamed.h"
 class TCollection;
 
 class OrbitRange : public TNamed
 {
  public:
-  OrbitRange(const char* name = "orbitRange") : TNamed(name, name), fRunNumber(0), fMinOrbit(0xFFFFFFFF), fMaxOrbit(0) {}
+  OrbitRange(const char* name = "orbitRange") : TNamed(name, name), fRunNumber(0), fMinOrbit(0xFFFFFFFF), fMaxOrbit(0), fOrbitsPerBin(1), fFirstWord(0) {}
   ~OrbitRange() {}
   void SetRunNumber(uint32_t runNumber) { fRunNumber = runNumber; }
   void SetMinOrbit(uint32_t orbit) { fMinOrbit = orbit; }
   void SetMaxOrbit(uint32_t orbit) { fMaxOrbit = orbit; }
+  void SetOrbitsPerBin(uint32_t orbitsPerBin);
   uint32_t GetRunNumber() { return fRunNumber; }
   uint32_t GetMinOrbit() { return fMinOrbit; }
   uint32_t GetMaxOrbit() { return fMaxOrbit; }
+  uint32_t GetOrbitsPerBin() const { return fOrbitsPerBin; }
+  uint32_t GetFirstWord() const { return fFirstWord; }
+  const std::vector<ULong64_t>& GetCoverage() const { return fCoverage; }
+
+  // Updates the minimum and maximum orbit and marks the bin of the orbit as seen
+  void AddOrbit(uint32_t orbit);
+  bool IsCovered(uint32_t orbit) const;
+  // Number of bins with at least one orbit seen
+  ULong64_t GetNCoveredBins() const;
+  // Fraction of the bins between the minimum and the maximum orbit with at least one orbit seen
+  Double_t GetCoveredFraction() const;
   Long64_t Merge(TCollection* list);
 
  private:
+  void ExtendCoverage(uint32_t firstWord, uint32_t lastWord);
+
   uint32_t fRunNumber;
   uint32_t fMinOrbit;
   uint32_t fMaxOrbit;
-  ClassDef(OrbitRange, 1)
+  uint32_t fOrbitsPerBin;            // granularity of the coverage bitmap
+  uint32_t fFirstWord;               // index of the first word of fCoverage, i.e. first bin / 64
+  std::vector<ULong64_t> fCoverage; // coverage bitmap, one bit per bin
+  ClassDef(OrbitRange, 2)
 };
 
 #endif
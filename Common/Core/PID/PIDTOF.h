@@ -27,6 +27,7 @@
 #include "Framework/Logger.h"
 #include "ReconstructionDataFormats/PID.h"
 #include "Framework/DataTypes.h"
+#include "Common/Core/PID/TOFReso.h"
 
 namespace o2::pid::tof
 {
@@ -184,11 +185,32 @@ class ExpTimes
     return std::sqrt(sigma * sigma + parameters[3] * parameters[3] / mom / mom + parameters[4] * parameters[4] + collisionTimeRes * collisionTimeRes);
   }
 
+  /// Gets the expected resolution of the t-texp-t0
+  /// Given a TOF signal and collision time resolutions
+  /// \param reso Frozen TOFReso parametrization, same result as the DetectorResponse holding the TOFReso without the virtual call
+  /// \param track Track of interest
+  /// \param tofSignal TOF signal of the track of interest
+  /// \param collisionTimeRes Collision time resolution of the track of interest
+  static float GetExpectedSigma(const TOFResoFrozen& reso, const TrackType& track, const float tofSignal, const float collisionTimeRes)
+  {
+    if (!track.hasTOF()) {
+      return defaultReturnValue;
+    }
+    const float x[4] = {track.p(), tofSignal, collisionTimeRes, mMassZ};
+    const float sigma = reso(x);
+    return sigma >= 0.f ? sigma : 0.f;
+  }
+
   /// Gets the expected resolution of the t-texp-t0
   /// \param response Detector response with parameters
   /// \param track Track of interest
   static float GetExpectedSigma(const DetectorResponse& response, const TrackType& track) { return GetExpectedSigma(response, track, track.tofSignal(), track.tofEvTime()); }
 
+  /// Gets the expected resolution of the t-texp-t0
+  /// \param reso Frozen TOFReso parametrization
+  /// \param track Track of interest
+  static float GetExpectedSigma(const TOFResoFrozen& reso, const TrackType& track) { return GetExpectedSigma(reso, track, track.tofSignal(), track.tofEvTime()); }
+
   /// Gets the expected resolution of the t-texp-t0
   /// \param parameters Detector response parameters
   /// \param track Track of interest
@@ -216,6 +238,13 @@ class ExpTimes
   /// \param track Track of interest
   static float GetSeparation(const DetectorResponse& response, const TrackType& track) { return GetSeparation(response, track, track.tofEvTime(), track.tofEvTimeErr()); }
 
+  /// Gets the number of sigmas with respect the expected time
+  /// \param reso Frozen TOFReso parametrization
+  /// \param track Track of interest
+  /// \param collisionTime Collision time
+  /// \param collisionTimeRes Collision time resolution of the track of interest
+  static float GetSeparation(const TOFResoFrozen& reso, const TrackType& track, const float collisionTime, const float collisionTimeRes) { return track.hasTOF() ? GetDelta(track, collisionTime) / GetExpectedSigma(reso, track, track.tofSignal(), collisionTimeRes) : defaultReturnValue; }
+
   /// Gets the number of sigmas with respect the expected time
   /// \param parameters Detector response parameters
   /// \param track Track of interest
@@ -252,6 +281,77 @@ class ExpTimes
   static float GetSeparationFromTrackTime(const DetectorResponse& response, const TrackType& track) { return GetSeparationFromTrackTime(response, track, track.tofEvTime(), track.tofEvTimeErr()); }
 };
 
+/// \brief Class to compute the TOF response of all the mass hypotheses of a track in one go
+/// The track quantities (momentum, length, expected momentum, measured time with respect to the event time) are read once
+/// and the expected times and resolutions are then computed in a loop over the mass hypotheses, that the compiler can vectorise.
+/// The results are the same as the ones of ExpTimes for each hypothesis.
+template <typename TrackType>
+class ExpTimesAllSpecies
+{
+ public:
+  ExpTimesAllSpecies() = default;
+  ~ExpTimesAllSpecies() = default;
+  static constexpr int kNSpecies = o2::track::PID::NIDs; /// Number of mass hypotheses, in the order of o2::track::PID
+
+  /// Gets the number of sigmas with respect the expected time of all the mass hypotheses
+  /// \param parameters Detector response parameters
+  /// \param track Track of interest
+  /// \param nSigma Output separations, as ExpTimes<TrackType, id>::GetSeparation(parameters, track)
+  /// \param expSigma Output expected resolutions if not null, as ExpTimes<TrackType, id>::GetExpectedSigma(parameters, track, track.tofSignal(), expSigmaCollisionTimeRes)
+  /// \param expSigmaCollisionTimeRes Collision time resolution used for the expSigma output
+  static void GetSeparations(const TOFResoParams& parameters, const TrackType& track, float* nSigma, float* expSigma = nullptr, const float expSigmaCollisionTimeRes = 0.f)
+  {
+    const float mom = track.p();
+    const float tofSignal = track.tofSignal();
+    const float length = track.length();
+    const float tofExpMom = track.trackType() == o2::aod::track::Run2Track ? track.tofExpMom() / kCSPEED : track.tofExpMom();
+    const float deltaSignal = tofSignal - track.tofEvTime();
+    const float collisionTimeRes2 = track.tofEvTimeErr() * track.tofEvTimeErr();
+    const float expSigmaCollisionTimeRes2 = expSigmaCollisionTimeRes * expSigmaCollisionTimeRes;
+    const float tofExpMom2 = tofExpMom * tofExpMom;
+
+    float expTime[kNSpecies];
+    float sigma2[kNSpecies]; // squared resolution without the collision time contribution
+    if (mom > 0) {
+      const float momTerm = parameters[3] * parameters[3] / mom / mom;
+      const float constTerm = parameters[4] * parameters[4];
+      for (int i = 0; i < kNSpecies; i++) {
+        const float massZ = o2::track::pid_constants::sMasses2Z[i];
+        const float massZ2 = massZ * massZ;
+        expTime[i] = length * std::sqrt(massZ2 + tofExpMom2) / (kCSPEED * tofExpMom);
+        const float dpp = parameters[0] + parameters[1] * mom + parameters[2] * massZ / mom; // mean relative pt resolution;
+        const float sigma = dpp * tofSignal / (1. + mom * mom / massZ2);
+        sigma2[i] = sigma * sigma + momTerm + constTerm;
+      }
+    } else {
+      for (int i = 0; i < kNSpecies; i++) {
+        const float massZ = o2::track::pid_constants::sMasses2Z[i];
+        expTime[i] = length * std::sqrt(massZ * massZ + tofExpMom2) / (kCSPEED * tofExpMom);
+      }
+    }
+
+    if (!track.hasTOF()) {
+      for (int i = 0; i < kNSpecies; i++) {
+        nSigma[i] = defaultReturnValue;
+      }
+    } else if (mom > 0) {
+      for (int i = 0; i < kNSpecies; i++) {
+        nSigma[i] = (deltaSignal - expTime[i]) / std::sqrt(sigma2[i] + collisionTimeRes2);
+      }
+    } else {
+      for (int i = 0; i < kNSpecies; i++) {
+        nSigma[i] = (deltaSignal - expTime[i]) / defaultReturnValue;
+      }
+    }
+    if (expSigma == nullptr) {
+      return;
+    }
+    for (int i = 0; i < kNSpecies; i++) {
+      expSigma[i] = mom > 0 ? std::sqrt(sigma2[i] + expSigmaCollisionTimeRes2) : defaultReturnValue;
+    }
+  }
+};
+
 /// \brief Class to convert the trackTime to the tofSignal used for PID
 template <typename TrackType>
 class TOFSignal
@@ -24,6 +24,8 @@
 #include "TNamed.h"
 #include "TFile.h"
 
+#include <array>
+
 #include "Framework/Logger.h"
 
 namespace o2::pid
@@ -258,6 +260,48 @@ class Parametrization : public TNamed
   ClassDefOverride(Parametrization, 1); // Container for the parametrization of the response function
 };
 
+/// \brief Parametrization with the parameters copied in a fixed-size array, evaluated without virtual call
+/// The parameters of a loaded Parametrization are frozen once (e.g. after the CCDB query), then the evaluation is inlined.
+/// \tparam Derived Class implementing `static pidvar_t Evaluate(const std::array<pidvar_t, nPar>& par, const pidvar_t* x)`
+///                 and defining the type of the corresponding Parametrization as `ParametrizationType`
+/// \tparam nPar Number of parameters of the parametrization
+template <typename Derived, int nPar>
+class FrozenParametrization
+{
+ public:
+  /// Copies the parameters of a parametrization
+  /// \param param Parametrization to freeze, it must be of type Derived::ParametrizationType with nPar parameters
+  /// \return true if the parameters were copied, otherwise the frozen parametrization must not be used
+  bool Freeze(const Parametrization& param)
+  {
+    const Parameters parameters = param.GetParameters();
+    if (!dynamic_cast<const typename Derived::ParametrizationType*>(&param) || parameters.size() != nPar) {
+      LOG(info) << "Parametrization " << param.GetName() << " cannot be frozen, using the virtual evaluation";
+      mFrozen = false;
+      return mFrozen;
+    }
+    for (int i = 0; i < nPar; i++) {
+      mPar[i] = parameters[i];
+    }
+    mFrozen = true;
+    return mFrozen;
+  }
+
+  /// \return true if the parameters were frozen
+  bool IsFrozen() const { return mFrozen; }
+
+  /// Getter for the parameters
+  const std::array<pidvar_t, nPar>& GetParameters() const { return mPar; }
+
+  /// Evaluation of the parametrization, same as the operator() of Derived::ParametrizationType
+  /// \param x array of variables to use in order to compute the return value
+  pidvar_t operator()(const pidvar_t* x) const { return Derived::Evaluate(mPar, x); }
+
+ private:
+  std::array<pidvar_t, nPar> mPar{}; /// Copy of the parameters
+  bool mFrozen = false;              /// Whether the parameters were copied
+};
+
 } // namespace o2::pid
 
 #endif // O2_FRAMEWORK_PARAMBASE_H_
@@ -21,10 +21,29 @@
 
 // O2 includes
 #include "ReconstructionDataFormats/PID.h"
+#include "Common/Core/PID/ParamBase.h"
 
 namespace o2::pid::tof
 {
 
+/// Expected value of the TOF Resolution, shared by TOFReso and TOFResoFrozen
+/// \param par Parameters of the parametrization
+/// \param x Array with the input used to compute the response, see TOFReso::operator()
+template <typename ParType>
+inline float computeTOFReso(const ParType& par, const float* x)
+{
+  const float mom = abs(x[0]);
+  if (mom <= 0) {
+    return -999;
+  }
+  const float time = x[1];
+  const float evtimereso = x[2];
+  const float mass = x[3];
+  const float dpp = par[0] + par[1] * mom + par[2] * mass / mom; // mean relative pt resolution;
+  const float sigma = dpp * time / (1. + mom * mom / (mass * mass));
+  return sqrt(sigma * sigma + par[3] * par[3] / mom / mom + par[4] * par[4] + evtimereso * evtimereso);
+}
+
 class TOFReso : public Parametrization
 {
  public:
@@ -36,22 +55,18 @@ class TOFReso : public Parametrization
   /// x[1] -> TOF signal
   /// x[2] -> event time resolution
   /// x[3] -> particle mass
-  float operator()(const float* x) const override
-  {
-    const float mom = abs(x[0]);
-    if (mom <= 0) {
-      return -999;
-    }
-    const float time = x[1];
-    const float evtimereso = x[2];
-    const float mass = x[3];
-    const float dpp = mParameters[0] + mParameters[1] * mom + mParameters[2] * mass / mom; // mean relative pt resolution;
-    const float sigma = dpp * time / (1. + mom * mom / (mass * mass));
-    return sqrt(sigma * sigma + mParameters[3] * mParameters[3] / mom / mom + mParameters[4] * mParameters[4] + evtimereso * evtimereso);
-  }
+  float operator()(const float* x) const override { return computeTOFReso(mParameters, x); }
   ClassDefOverride(TOFReso, 1);
 };
 
+/// TOFReso with the parameters frozen, for the evaluation per track and mass hypothesis without virtual call
+class TOFResoFrozen : public FrozenParametrization<TOFResoFrozen, 5>
+{
+ public:
+  using ParametrizationType = TOFReso;
+  static float Evaluate(const std::array<float, 5>& par, const float* x) { return computeTOFReso(par, x); }
+};
+
 } // namespace o2::pid::tof
 
 #endif
@@ -18,6 +18,7 @@
 #define O2_PID_TPC_RESPONSE_H_
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <cmath>
 #include "Framework/Logger.h"
@@ -82,10 +83,18 @@ class Response
   float GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const;
   /// Gets relative dEdx resolution contribution due to relative pt resolution
   float GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const;
+  /// Gets the expected signal, resolution and number of sigmas of all the mass hypotheses at once
+  template <typename CollisionType, typename TrackType>
+  void GetResponseAllSpecies(const CollisionType& collision, const TrackType& trk, float* expSignal, float* expSigma, float* nSigma, const uint32_t speciesMask = (1u << o2::track::PID::NIDs) - 1) const;
 
   void PrintAll() const;
 
  private:
+  /// Relative dEdx resolution contribution due to relative pt resolution, given the expected dEdx = BB(p / mass) * chargeFactor
+  float GetRelativeResolutiondEdx(const float p, const float mass, const float dEdx, const float chargeFactor, const float resol) const;
+  /// Resolution of the parametrisation (non-default case), given the expected dEdx and the track quantities
+  float GetParametrisedResolution(const double dEdx, const double relReso, const double tgl, const double ncl, const double signed1Pt, const double multNorm) const;
+
   std::array<float, 5> mBetheBlochParams = {0.03209809958934784, 19.9768009185791, 2.5266601063857674e-16, 2.7212300300598145, 6.080920219421387};
   std::array<float, 2> mResolutionParamsDefault = {0.07, 0.0};
   std::vector<double> mResolutionParams = {5.43799e-7, 0.053044, 0.667584, 0.0142667, 0.00235175, 1.22482, 2.3501e-7, 0.031585};
@@ -130,9 +139,7 @@ inline float Response::GetExpectedSigma(const CollisionType& collision, const Tr
     const double dEdx = o2::tpc::BetheBlochAleph((float)bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow((float)o2::track::pid_constants::sCharges[id], mChargeFactor);
     const double relReso = GetRelativeResolutiondEdx(p, mass, o2::track::pid_constants::sCharges[id], mResolutionParams[3]);
 
-    const std::vector<double> values{1.f / dEdx, track.tgl(), std::sqrt(ncl), relReso, track.signed1Pt(), collision.multTPC() / mMultNormalization};
-
-    const float reso = sqrt(pow(mResolutionParams[0], 2) * values[0] + pow(mResolutionParams[1], 2) * (values[2] * mResolutionParams[5]) * pow(values[0] / sqrt(1 + pow(values[1], 2)), mResolutionParams[2]) + values[2] * pow(values[3], 2) + pow(mResolutionParams[4] * values[4], 2) + pow(values[5] * mResolutionParams[6], 2) + pow(values[5] * (values[0] / sqrt(1 + pow(values[1], 2))) * mResolutionParams[7], 2)) * dEdx * mMIP;
+    const float reso = GetParametrisedResolution(dEdx, relReso, track.tgl(), ncl, track.signed1Pt(), collision.multTPC() / mMultNormalization);
     reso >= 0.f ? resolution = reso : resolution = -999.f;
   }
   return resolution;
@@ -171,14 +178,80 @@ inline float Response::GetSignalDelta(const TrackType& trk, const o2::track::PID
 inline float Response::GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const
 {
   const float bg = p / mass;
-  const float dEdx = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+  const float chargeFactor = std::pow(charge, mChargeFactor);
+  const float dEdx = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * chargeFactor;
+  return GetRelativeResolutiondEdx(p, mass, dEdx, chargeFactor, resol);
+}
+
+inline float Response::GetRelativeResolutiondEdx(const float p, const float mass, const float dEdx, const float chargeFactor, const float resol) const
+{
   const float deltaP = resol * std::sqrt(dEdx);
   const float bgDelta = p * (1 + deltaP) / mass;
-  const float dEdx2 = o2::tpc::BetheBlochAleph(bgDelta, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+  const float dEdx2 = o2::tpc::BetheBlochAleph(bgDelta, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * chargeFactor;
   const float deltaRel = std::abs(dEdx2 - dEdx) / dEdx;
   return deltaRel;
 }
 
+inline float Response::GetParametrisedResolution(const double dEdx, const double relReso, const double tgl, const double ncl, const double signed1Pt, const double multNorm) const
+{
+  const double values[6] = {1.f / dEdx, tgl, std::sqrt(ncl), relReso, signed1Pt, multNorm};
+  return sqrt(pow(mResolutionParams[0], 2) * values[0] + pow(mResolutionParams[1], 2) * (values[2] * mResolutionParams[5]) * pow(values[0] / sqrt(1 + pow(values[1], 2)), mResolutionParams[2]) + values[2] * pow(values[3], 2) + pow(mResolutionParams[4] * values[4], 2) + pow(values[5] * mResolutionParams[6], 2) + pow(values[5] * (values[0] / sqrt(1 + pow(values[1], 2))) * mResolutionParams[7], 2)) * dEdx * mMIP;
+}
+
+/// Gets the expected signal, resolution and number of sigmas of all the mass hypotheses at once
+/// The track quantities are read once and the Bethe-Bloch of each hypothesis is evaluated once, for both the expected signal and the resolution.
+/// The results are the same as the ones of GetExpectedSignal, GetExpectedSigma and GetNumberOfSigma. Hypotheses not in speciesMask are set to -999
+template <typename CollisionType, typename TrackType>
+inline void Response::GetResponseAllSpecies(const CollisionType& collision, const TrackType& trk, float* expSignal, float* expSigma, float* nSigma, const uint32_t speciesMask) const
+{
+  if (!trk.hasTPC()) {
+    for (int id = 0; id < o2::track::PID::NIDs; id++) {
+      expSignal[id] = -999.f;
+      expSigma[id] = -999.f;
+      nSigma[id] = -999.f;
+    }
+    return;
+  }
+  const float p = trk.tpcInnerParam();
+  const float tpcSignal = trk.tpcSignal();
+
+  // resolution inputs common to all the hypotheses
+  float defaultResolution = -999.f;
+  double ncl = 0., tgl = 0., signed1Pt = 0., multNorm = 0.;
+  if (mUseDefaultResolutionParam) {
+    const float reso = tpcSignal * mResolutionParamsDefault[0] * ((float)trk.tpcNClsFound() > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / (float)trk.tpcNClsFound()) : 1.f);
+    defaultResolution = reso >= 0.f ? reso : -999.f;
+  } else {
+    ncl = nClNorm / trk.tpcNClsFound();
+    tgl = trk.tgl();
+    signed1Pt = trk.signed1Pt();
+    multNorm = collision.multTPC() / mMultNormalization;
+  }
+
+  for (int id = 0; id < o2::track::PID::NIDs; id++) {
+    if (!(speciesMask & (1u << id))) {
+      expSignal[id] = -999.f;
+      expSigma[id] = -999.f;
+      nSigma[id] = -999.f;
+      continue;
+    }
+    const float mass = o2::track::pid_constants::sMasses[id];
+    const float chargeFactor = std::pow((float)o2::track::pid_constants::sCharges[id], mChargeFactor);
+    const float bb = o2::tpc::BetheBlochAleph(p / mass, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]);
+    const float bethe = mMIP * bb * chargeFactor;
+    expSignal[id] = bethe >= 0.f ? bethe : -999.f;
+    if (mUseDefaultResolutionParam) {
+      expSigma[id] = defaultResolution;
+    } else {
+      const float dEdx = bb * chargeFactor;
+      const double relReso = GetRelativeResolutiondEdx(p, mass, dEdx, chargeFactor, mResolutionParams[3]);
+      const float reso = GetParametrisedResolution(dEdx, relReso, tgl, ncl, signed1Pt, multNorm);
+      expSigma[id] = reso >= 0.f ? reso : -999.f;
+    }
+    nSigma[id] = (expSigma[id] < 0. || expSignal[id] < 0.) ? -999.f : (tpcSignal - expSignal[id]) / expSigma[id];
+  }
+}
+
 inline void Response::PrintAll() const
 {
   LOGP(info, "==== TPC PID response parameters: ====");
@@ -17,7 +17,9 @@
 #ifndef O2_ANALYSIS_RECODECAY_H_
 #define O2_ANALYSIS_RECODECAY_H_
 
+#include <algorithm>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 #include <array>
 #include <cmath>
@@ -451,6 +453,32 @@ class RecoDecay
     return std::sqrt(m2(args...));
   }
 
+  /// Calculates invariant masses squared of many candidates with several prong-mass hypotheses at once.
+  /// The momenta of the prongs and of the candidates are summed once for all the hypotheses and the loops over
+  /// candidates run on contiguous arrays, so that the compiler can vectorise them.
+  /// \param N  number of prongs
+  /// \param nCand  number of candidates
+  /// \param arrMom  array of N {px, py, pz} arrays of pointers to the nCand momentum components of the prongs
+  /// \param arrMassHypos  mass hypotheses, each an array of N masses (in the same order as arrMom)
+  /// \param masses2  output of nHypos * nCand invariant masses squared, masses2[iHypo * nCand + iCand]
+  template <std::size_t N, typename T, typename U>
+  static void m2Batch(std::size_t nCand, const array<array<const T*, 3>, N>& arrMom, const std::vector<array<U, N>>& arrMassHypos, T* masses2)
+  {
+    massesBatch<false>(nCand, arrMom, arrMassHypos, masses2);
+  }
+
+  /// Calculates invariant masses of many candidates with several prong-mass hypotheses at once.
+  /// \param N  number of prongs
+  /// \param nCand  number of candidates
+  /// \param arrMom  array of N {px, py, pz} arrays of pointers to the nCand momentum components of the prongs
+  /// \param arrMassHypos  mass hypotheses, each an array of N masses (in the same order as arrMom)
+  /// \param masses  output of nHypos * nCand invariant masses, masses[iHypo * nCand + iCand]
+  template <std::size_t N, typename T, typename U>
+  static void mBatch(std::size_t nCand, const array<array<const T*, 3>, N>& arrMom, const std::vector<array<U, N>>& arrMassHypos, T* masses)
+  {
+    massesBatch<true>(nCand, arrMom, arrMassHypos, masses);
+  }
+
   // Calculation of topological quantities
 
   /// Calculates impact parameter in the bending plane of the particle w.r.t. a point
@@ -521,12 +549,27 @@ class RecoDecay
     return maxNormDeltaIP;
   }
 
-  /// Adds particle mass in the list.
+  /// Returns the mass of the particles that cannot be taken from ROOT ($ROOTSYS/etc/pdg_table.txt).
+  /// \param pdg  PDG code
+  /// \return particle mass, 0 if the mass is taken from ROOT
+  static constexpr double getMassPDGFixed(int pdg)
+  {
+    switch (pdg) {
+      case 4422:        // Ξcc (wrong mass in ROOT)
+        return 3.62155; // https://pdg.lbl.gov/ (2021)
+      case 9920443:     // χc1 aka X(3872)
+        return 3.87165; // https://pdg.lbl.gov/ (2021)
+      default:
+        return 0.;
+    }
+  }
+
+  /// Adds particle mass in the list of the calling thread, if not there yet.
   /// \param pdg  PDG code
   /// \param mass  particle mass
   static void addMassPDG(int pdg, double mass)
   {
-    mListMass.push_back(std::make_tuple(pdg, mass));
+    massCache().emplace(pdg, mass);
   }
 
   /// Returns particle mass based on PDG code.
@@ -535,32 +578,19 @@ class RecoDecay
   static double getMassPDG(int pdg)
   {
     // Try to get the particle mass from the list first.
-    for (const auto& particle : mListMass) {
-      if (std::get<0>(particle) == pdg) {
-        return std::get<1>(particle);
-      }
+    auto& cache = massCache();
+    if (auto found = cache.find(pdg); found != cache.end()) {
+      return found->second;
     }
     // Get the mass of the new particle and add it in the list.
-    double mass = 0.;
-    switch (pdg) {
-      // Particles that cannot be taken from ROOT ($ROOTSYS/etc/pdg_table.txt)
-      case 4422: {      // Ξcc (wrong mass in ROOT)
-        mass = 3.62155; // https://pdg.lbl.gov/ (2021)
-        break;
-      }
-      case 9920443: {   // χc1 aka X(3872)
-        mass = 3.87165; // https://pdg.lbl.gov/ (2021)
-        break;
-      }
-      // Take the rest from ROOT.
-      default: {
-        const TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(pdg);
-        if (!particle) { // Check that it's there.
-          LOGF(fatal, "Cannot find particle mass for PDG code %i", pdg);
-          return 999.;
-        }
-        mass = particle->Mass();
+    double mass = getMassPDGFixed(pdg);
+    if (mass == 0.) { // Take the rest from ROOT.
+      const TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(pdg);
+      if (!particle) { // Check that it's there.
+        LOGF(fatal, "Cannot find particle mass for PDG code %i", pdg);
+        return 999.;
       }
+      mass = particle->Mass();
     }
     addMassPDG(pdg, mass);
     return mass;
@@ -590,15 +620,16 @@ class RecoDecay
       *sign = sgn;
     }
 
-    // vector of vectors with mother indices; each line corresponds to a "stage"
-    std::vector<std::vector<long int>> arrayIds{};
-    std::vector<long int> initVec{particle.globalIndex()};
-    arrayIds.push_back(initVec); // the first vector contains the index of the original particle
+    // mother indices of the previous and of the current "stage"
+    auto& arrayIdsPrevious = motherTreeBuffer(0);
+    auto& arrayIdsStage = motherTreeBuffer(1);
+    arrayIdsPrevious.clear();
+    arrayIdsPrevious.push_back(particle.globalIndex()); // the first stage contains the index of the original particle
 
-    while (!motherFound && arrayIds[-stage].size() > 0 && (depthMax < 0 || -stage < depthMax)) {
+    while (!motherFound && arrayIdsPrevious.size() > 0 && (depthMax < 0 || -stage < depthMax)) {
       // vector of mother indices for the current stage
-      std::vector<long int> arrayIdsStage{};
-      for (auto& iPart : arrayIds[-stage]) { // check all the particles that were the mothers at the previous stage
+      arrayIdsStage.clear();
+      for (auto& iPart : arrayIdsPrevious) { // check all the particles that were the mothers at the previous stage
         auto particleMother = particlesMC.rawIteratorAt(iPart - particlesMC.offset());
         if (particleMother.has_mothers()) {
           for (auto iMother = particleMother.mothersIds().front(); iMother <= particleMother.mothersIds().back(); ++iMother) { // loop over the mother particles of the analysed particle
@@ -628,8 +659,8 @@ class RecoDecay
           }
         }
       }
-      // add vector of mother indices for the current stage
-      arrayIds.push_back(arrayIdsStage);
+      // the mothers of the current stage are the particles to check at the next one
+      std::swap(arrayIdsPrevious, arrayIdsStage);
       stage--;
     }
     if (sign) {
@@ -647,9 +678,10 @@ class RecoDecay
   /// \param stage  decay tree level; If different from 0, the particle itself will be added in the list in case it has no daughters.
   /// \note Final state is defined as particles from arrPDGFinal plus final daughters of any other decay branch.
   /// \note Antiparticles of particles in arrPDGFinal are accepted as well.
-  template <std::size_t N, typename T>
+  /// \note The list can use any allocator, e.g. the one of a o2::analysis::DataFrameArena for the temporaries of a process call.
+  template <std::size_t N, typename T, typename Alloc>
   static void getDaughters(const T& particle,
-                           std::vector<int>* list,
+                           std::vector<int, Alloc>* list,
                            const array<int, N>& arrPDGFinal,
                            int8_t depthMax = -1,
                            int8_t stage = 0)
@@ -658,50 +690,35 @@ class RecoDecay
       //Printf("getDaughters: Error: No list!");
       return;
     }
-    bool isFinal = false;                     // Flag to indicate the end of recursion
-    if (depthMax > -1 && stage >= depthMax) { // Maximum depth has been reached (or exceeded).
-      isFinal = true;
-    }
-    // Check whether there are any daughters.
-    if (!isFinal && !particle.has_daughters()) {
-      // If the original particle has no daughters, we do nothing and exit.
-      if (stage == 0) {
-        //Printf("getDaughters: No daughters of %d", index);
-        return;
-      }
-      // If this is not the original particle, we are at the end of this branch and this particle is final.
-      isFinal = true;
-    }
-    auto PDGParticle = std::abs(particle.pdgCode());
-    // If this is not the original particle, check its PDG code.
-    if (!isFinal && stage > 0) {
-      // If the particle has daughters but is considered to be final, we label it as final.
-      for (auto PDGi : arrPDGFinal) {
-        if (PDGParticle == std::abs(PDGi)) { // Accept antiparticles.
-          isFinal = true;
-          break;
-        }
-      }
-    }
-    // If the particle is labelled as final, we add this particle in the list of final daughters and exit.
-    if (isFinal) {
-      //printf("getDaughters: ");
-      //for (int i = 0; i < stage; i++) // Indent to make the tree look nice.
-      //  printf(" ");
-      //printf("Stage %d: Adding %d (PDG %d) as final daughter.\n", stage, index, PDGParticle);
-      list->push_back(particle.globalIndex());
-      return;
-    }
-    // If we are here, we have to follow the daughter tree.
-    //printf("getDaughters: ");
-    //for (int i = 0; i < stage; i++) // Indent to make the tree look nice.
-    //  printf(" ");
-    //printf("Stage %d: %d (PDG %d) -> %d-%d\n", stage, index, PDGParticle, indexDaughterFirst, indexDaughterLast);
-    // Call itself to get daughters of daughters recursively.
-    stage++;
-    for (auto& dau : particle.template daughters_as<typename std::decay_t<T>::parent_t>()) {
-      getDaughters(dau, list, arrPDGFinal, depthMax, stage);
+    auto addDaughter = [list](int index) {
+      list->push_back(index);
+      return true;
+    };
+    collectDaughters(particle, addDaughter, arrPDGFinal, depthMax, stage);
+  }
+
+  /// Gets the indices of final-state daughters of an MC particle in a fixed-size array, without allocations.
+  /// Same definition of the final state as in getDaughters.
+  /// \param particle  MC particle
+  /// \param list  array where the indices of final-state daughters will be stored
+  /// \param arrPDGFinal  array of PDG codes of particles to be considered final if found
+  /// \param depthMax  maximum decay tree level; Daughters at this level (or beyond) will be considered final. If -1, all levels are considered.
+  /// \return number of final-state daughters stored; The search stops when the array is full, so that M means "M or more".
+  template <std::size_t M, std::size_t N, typename T>
+  static std::size_t getDaughters(const T& particle,
+                                  array<int, M>& list,
+                                  const array<int, N>& arrPDGFinal,
+                                  int8_t depthMax = -1)
+  {
+    std::size_t nDaughters = 0;
+    auto addDaughter = [&list, &nDaughters](int index) {
+      list[nDaughters++] = index;
+      return nDaughters < M;
+    };
+    if constexpr (M > 0) {
+      collectDaughters(particle, addDaughter, arrPDGFinal, depthMax, 0);
     }
+    return nDaughters;
   }
 
   /// Checks whether the reconstructed decay candidate is the expected decay.
@@ -724,9 +741,10 @@ class RecoDecay
   {
     //Printf("MC Rec: Expected mother PDG: %d", PDGMother);
     int8_t sgn = 0;                        // 1 if the expected mother is particle, -1 if antiparticle (w.r.t. PDGMother)
-    int indexMother = -1;                  // index of the mother particle
-    std::vector<int> arrAllDaughtersIndex; // vector of indices of all daughters of the mother of the first provided daughter
-    array<int, N> arrDaughtersIndex;       // array of indices of provided daughters
+    int indexMother = -1;                   // index of the mother particle
+    array<int, N + 1> arrAllDaughtersIndex; // array of indices of all daughters of the mother of the first provided daughter
+    std::size_t nAllDaughters = 0;          // number of daughters in arrAllDaughtersIndex, N + 1 if there are more than N
+    array<int, N> arrDaughtersIndex;        // array of indices of provided daughters
     if (sign) {
       *sign = sgn;
     }
@@ -760,22 +778,17 @@ class RecoDecay
           return -1;
         }
         // Get the list of actual final daughters.
-        getDaughters(particleMother, &arrAllDaughtersIndex, arrPDGDaughters, depthMax);
-        //printf("MC Rec: Mother %d has %d final daughters:", indexMother, arrAllDaughtersIndex.size());
-        //for (auto i : arrAllDaughtersIndex) {
-        //  printf(" %d", i);
-        //}
-        //printf("\n");
+        nAllDaughters = getDaughters(particleMother, arrAllDaughtersIndex, arrPDGDaughters, depthMax);
         // Check whether the number of actual final daughters is equal to the number of expected final daughters (i.e. the number of provided prongs).
-        if (arrAllDaughtersIndex.size() != N) {
-          //Printf("MC Rec: Rejected: incorrect number of final daughters: %ld (expected %ld)", arrAllDaughtersIndex.size(), N);
+        if (nAllDaughters != N) {
+          //Printf("MC Rec: Rejected: incorrect number of final daughters: %ld (expected %ld)", nAllDaughters, N);
           return -1;
         }
       }
       // Check that the daughter is in the list of final daughters.
       // (Check that the daughter is not a stepdaughter, i.e. particle pointing to the mother while not being its daughter.)
       bool isDaughterFound = false; // Is the index of this prong among the remaining expected indices of daughters?
-      for (std::size_t iD = 0; iD < arrAllDaughtersIndex.size(); ++iD) {
+      for (std::size_t iD = 0; iD < nAllDaughters; ++iD) {
         if (arrDaughtersIndex[iProng] == arrAllDaughtersIndex[iD]) {
           arrAllDaughtersIndex[iD] = -1; // Remove this index from the array of expected daughters. (Rejects twin daughters, i.e. particle considered twice as a daughter.)
           isDaughterFound = true;
@@ -866,7 +879,7 @@ class RecoDecay
     // Check the PDG codes of the decay products.
     if (N > 0) {
       //Printf("MC Gen: Checking %d daughters", N);
-      std::vector<int> arrAllDaughtersIndex; // vector of indices of all daughters
+      array<int, N + 1> arrAllDaughtersIndex; // array of indices of all daughters, N + 1 entries to detect a larger number
       // Check the daughter indices.
       if (!candidate.has_daughters()) {
         //Printf("MC Gen: Rejected: bad daughter index range: %d-%d", candidate.daughtersIds().front(), candidate.daughtersIds().back());
@@ -878,19 +891,15 @@ class RecoDecay
         return false;
       }
       // Get the list of actual final daughters.
-      getDaughters(candidate, &arrAllDaughtersIndex, arrPDGDaughters, depthMax);
-      //printf("MC Gen: Mother %ld has %ld final daughters:", candidate.globalIndex(), arrAllDaughtersIndex.size());
-      //for (auto i : arrAllDaughtersIndex) {
-      //  printf(" %d", i);
-      //}
-      //printf("\n");
+      auto nAllDaughters = getDaughters(candidate, arrAllDaughtersIndex, arrPDGDaughters, depthMax);
       // Check whether the number of final daughters is equal to the required number.
-      if (arrAllDaughtersIndex.size() != N) {
-        //Printf("MC Gen: Rejected: incorrect number of final daughters: %ld (expected %ld)", arrAllDaughtersIndex.size(), N);
+      if (nAllDaughters != N) {
+        //Printf("MC Gen: Rejected: incorrect number of final daughters: %ld (expected %ld)", nAllDaughters, N);
         return false;
       }
       // Check daughters' PDG codes.
-      for (auto indexDaughterI : arrAllDaughtersIndex) {
+      for (std::size_t iD = 0; iD < N; ++iD) {
+        auto indexDaughterI = arrAllDaughtersIndex[iD];
         auto candidateDaughterI = particlesMC.rawIteratorAt(indexDaughterI - particlesMC.offset()); // ith daughter particle
         auto PDGCandidateDaughterI = candidateDaughterI.pdgCode();                                  // PDG code of the ith daughter
         //Printf("MC Gen: Daughter %d PDG: %d", indexDaughterI, PDGCandidateDaughterI);
@@ -908,7 +917,7 @@ class RecoDecay
         }
       }
       if (listIndexDaughters) {
-        *listIndexDaughters = arrAllDaughtersIndex;
+        listIndexDaughters->assign(arrAllDaughtersIndex.begin(), arrAllDaughtersIndex.begin() + N);
       }
     }
     //Printf("MC Gen: Accepted: m: %d", candidate.globalIndex());
@@ -930,15 +939,16 @@ class RecoDecay
   {
     int stage = 0; // mother tree level (just for debugging)
 
-    // vector of vectors with mother indices; each line corresponds to a "stage"
-    std::vector<std::vector<long int>> arrayIds{};
-    std::vector<long int> initVec{particle.globalIndex()};
-    arrayIds.push_back(initVec); // the first vector contains the index of the original particle
+    // mother indices of the previous and of the current "stage"
+    auto& arrayIdsPrevious = motherTreeBuffer(0);
+    auto& arrayIdsStage = motherTreeBuffer(1);
+    arrayIdsPrevious.clear();
+    arrayIdsPrevious.push_back(particle.globalIndex()); // the first stage contains the index of the original particle
 
-    while (arrayIds[-stage].size() > 0) {
+    while (arrayIdsPrevious.size() > 0) {
       // vector of mother indices for the current stage
-      std::vector<long int> arrayIdsStage{};
-      for (auto& iPart : arrayIds[-stage]) { // check all the particles that were the mothers at the previous stage
+      arrayIdsStage.clear();
+      for (auto& iPart : arrayIdsPrevious) { // check all the particles that were the mothers at the previous stage
         auto particleMother = particlesMC.rawIteratorAt(iPart - particlesMC.offset());
         if (particleMother.has_mothers()) {
           for (auto iMother = particleMother.mothersIds().front(); iMother <= particleMother.mothersIds().back(); ++iMother) { // loop over the mother particles of the analysed particle
@@ -973,8 +983,8 @@ class RecoDecay
           }
         }
       }
-      // add vector of mother indices for the current stage
-      arrayIds.push_back(arrayIdsStage);
+      // the mothers of the current stage are the particles to check at the next one
+      std::swap(arrayIdsPrevious, arrayIdsStage);
       stage--;
     }
     if (!searchUpToQuark) {
@@ -984,9 +994,116 @@ class RecoDecay
   }
 
  private:
-  static std::vector<std::tuple<int, double>> mListMass; ///< list of particle masses in form (PDG code, mass)
-};
+  /// Follows the daughter tree of an MC particle and passes the indices of final-state daughters to addDaughter.
+  /// \param addDaughter  callable taking the index of a final-state daughter, returning false to stop the search
+  /// \return false if the search was stopped by addDaughter
+  template <std::size_t N, typename T, typename F>
+  static bool collectDaughters(const T& particle,
+                               F& addDaughter,
+                               const array<int, N>& arrPDGFinal,
+                               int8_t depthMax,
+                               int8_t stage)
+  {
+    bool isFinal = false;                     // Flag to indicate the end of recursion
+    if (depthMax > -1 && stage >= depthMax) { // Maximum depth has been reached (or exceeded).
+      isFinal = true;
+    }
+    // Check whether there are any daughters.
+    if (!isFinal && !particle.has_daughters()) {
+      // If the original particle has no daughters, we do nothing and exit.
+      if (stage == 0) {
+        //Printf("getDaughters: No daughters of %d", index);
+        return true;
+      }
+      // If this is not the original particle, we are at the end of this branch and this particle is final.
+      isFinal = true;
+    }
+    auto PDGParticle = std::abs(particle.pdgCode());
+    // If this is not the original particle, check its PDG code.
+    if (!isFinal && stage > 0) {
+      // If the particle has daughters but is considered to be final, we label it as final.
+      for (auto PDGi : arrPDGFinal) {
+        if (PDGParticle == std::abs(PDGi)) { // Accept antiparticles.
+          isFinal = true;
+          break;
+        }
+      }
+    }
+    // If the particle is labelled as final, we add this particle in the list of final daughters and exit.
+    if (isFinal) {
+      return addDaughter(particle.globalIndex());
+    }
+    // If we are here, we have to follow the daughter tree.
+    // Call itself to get daughters of daughters recursively.
+    stage++;
+    for (auto& dau : particle.template daughters_as<typename std::decay_t<T>::parent_t>()) {
+      if (!collectDaughters(dau, addDaughter, arrPDGFinal, depthMax, stage)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Kernel of m2Batch and mBatch, processing the candidates in chunks of fixed size to keep the intermediate
+  /// momenta on the stack
+  template <bool takeSqrt, std::size_t N, typename T, typename U>
+  static void massesBatch(std::size_t nCand, const array<array<const T*, 3>, N>& arrMom, const std::vector<array<U, N>>& arrMassHypos, T* out)
+  {
+    constexpr std::size_t SizeChunk = 64;
+    T momProng2[N][SizeChunk]; // momentum squared of the prongs
+    T momTotal2[SizeChunk];    // momentum squared of the candidates
+    for (std::size_t iFirst = 0; iFirst < nCand; iFirst += SizeChunk) {
+      const std::size_t nChunk = std::min(SizeChunk, nCand - iFirst);
+      for (std::size_t iCand = 0; iCand < nChunk; ++iCand) {
+        T momTotal[3]{0, 0, 0};
+        for (std::size_t iProng = 0; iProng < N; ++iProng) {
+          const T px = arrMom[iProng][0][iFirst + iCand];
+          const T py = arrMom[iProng][1][iFirst + iCand];
+          const T pz = arrMom[iProng][2][iFirst + iCand];
+          momProng2[iProng][iCand] = px * px + py * py + pz * pz;
+          momTotal[0] += px;
+          momTotal[1] += py;
+          momTotal[2] += pz;
+        }
+        momTotal2[iCand] = momTotal[0] * momTotal[0] + momTotal[1] * momTotal[1] + momTotal[2] * momTotal[2];
+      }
+      for (std::size_t iHypo = 0; iHypo < arrMassHypos.size(); ++iHypo) {
+        T mass2[N];
+        for (std::size_t iProng = 0; iProng < N; ++iProng) {
+          mass2[iProng] = static_cast<T>(arrMassHypos[iHypo][iProng]) * static_cast<T>(arrMassHypos[iHypo][iProng]);
+        }
+        T* outHypo = out + iHypo * nCand + iFirst;
+        for (std::size_t iCand = 0; iCand < nChunk; ++iCand) {
+          T energyTot{0};
+          for (std::size_t iProng = 0; iProng < N; ++iProng) {
+            energyTot += std::sqrt(momProng2[iProng][iCand] + mass2[iProng]);
+          }
+          const T invMass2 = energyTot * energyTot - momTotal2[iCand];
+          if constexpr (takeSqrt) {
+            outHypo[iCand] = std::sqrt(invMass2);
+          } else {
+            outHypo[iCand] = invMass2;
+          }
+        }
+      }
+    }
+  }
+
+  /// Buffers of mother indices for the walks up the decay tree, reused to avoid allocations at each call
+  static std::vector<long int>& motherTreeBuffer(int iBuffer)
+  {
+    thread_local std::array<std::vector<long int>, 2> buffers;
+    return buffers[iBuffer];
+  }
 
-std::vector<std::tuple<int, double>> RecoDecay::mListMass;
+  /// List of particle masses in form (PDG code, mass).
+  /// There is one list per thread, so that the lookups need no locking, and the lookup is a hash-map access
+  /// instead of a scan of all the masses requested so far.
+  static std::unordered_map<int, double>& massCache()
+  {
+    thread_local std::unordered_map<int, double> cache;
+    return cache;
+  }
+};
 
 #endif // O2_ANALYSIS_RECODECAY_H_
\ No newline at end of file
@@ -0,0 +1,164 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   RunConditions.h
+/// \brief  Run-dependent CCDB objects of a task, fetched together at the run change
+///
+/// The task registers once in init the run-dependent objects it needs (GRP, magnetic field,
+/// mean vertex, calibrations...). At the first BC of a new run all of them are fetched
+/// concurrently, one CcdbApi instance per object, and the run-change callbacks are called,
+/// so that the task does not need its own run number bookkeeping nor a CCDB call per object
+/// in the processing path. Registering the same path twice returns the same object.
+///
+/// Usage:
+///   o2::analysis::RunConditions conditions;
+///   conditions.init(ccdburl);                                                    // in init
+///   int iGrpMag = conditions.add<o2::parameters::GRPMagField>(grpmagPath);
+///   conditions.addRunChangeCallback([&](int run, uint64_t ts) { ... });
+///   conditions.update(bc);                                                       // in process
+///   auto* grpmag = conditions.get<o2::parameters::GRPMagField>(iGrpMag);
+///
+/// The objects are owned by the RunConditions and stay valid until the next run change.
+/// The CCDB local cache (ALICEO2_CCDB_LOCALCACHE) is used if set, so that the devices of a
+/// workflow do not download the same object several times.
+///
+
+#ifndef COMMON_CORE_RUNCONDITIONS_H_
+#define COMMON_CORE_RUNCONDITIONS_H_
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "CCDB/CcdbApi.h"
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+class RunConditions
+{
+ public:
+  using RunChangeCallback = std::function<void(int runNumber, uint64_t timestamp)>;
+
+  /// \param url CCDB server
+  /// \param parallel Fetch the objects concurrently, otherwise one after the other
+  void init(const std::string& url, bool parallel = true)
+  {
+    mURL = url;
+    mParallel = parallel;
+  }
+
+  /// Registers a run-dependent object
+  /// \param path CCDB path of the object
+  /// \param required If true a missing object is fatal, otherwise get() returns nullptr
+  /// \return index of the object, to be passed to get()
+  template <typename T>
+  int add(const std::string& path, bool required = true)
+  {
+    if (auto it = mIndices.find(path); it != mIndices.end()) {
+      if (mEntries[it->second].type != std::type_index(typeid(T))) {
+        LOG(fatal) << "CCDB path " << path << " registered twice with different object types";
+      }
+      mEntries[it->second].required |= required;
+      return it->second;
+    }
+    Entry entry{path, std::type_index(typeid(T)), required};
+    entry.fetch = [path](o2::ccdb::CcdbApi const& api, uint64_t timestamp) {
+      std::map<std::string, std::string> metadata;
+      return std::shared_ptr<void>(api.retrieveFromTFileAny<T>(path, metadata, timestamp));
+    };
+    mEntries.push_back(std::move(entry));
+    const int index = static_cast<int>(mEntries.size()) - 1;
+    mIndices[path] = index;
+    return index;
+  }
+
+  void addRunChangeCallback(RunChangeCallback callback) { mCallbacks.push_back(std::move(callback)); }
+
+  /// Fetches the objects and calls the callbacks if the run of the BC differs from the current one
+  /// \return true if the run changed
+  template <typename TBC>
+  bool update(TBC const& bc)
+  {
+    if (bc.runNumber() == mRunNumber) {
+      return false;
+    }
+    fetch(bc.timestamp());
+    mRunNumber = bc.runNumber();
+    for (auto& callback : mCallbacks) {
+      callback(mRunNumber, bc.timestamp());
+    }
+    return true;
+  }
+
+  /// \return object registered with index, nullptr if it is not available
+  template <typename T>
+  T* get(int index) const
+  {
+    return static_cast<T*>(mEntries[index].object.get());
+  }
+
+  int getRunNumber() const { return mRunNumber; }
+
+ private:
+  struct Entry {
+    std::string path;
+    std::type_index type;
+    bool required;
+    std::function<std::shared_ptr<void>(o2::ccdb::CcdbApi const&, uint64_t)> fetch;
+    std::shared_ptr<void> object = nullptr;
+  };
+
+  void fetch(uint64_t timestamp)
+  {
+    // the CcdbApi is not thread safe, hence one instance per object
+    while (mApis.size() < mEntries.size()) {
+      mApis.push_back(std::make_unique<o2::ccdb::CcdbApi>());
+      mApis.back()->init(mURL);
+    }
+    std::vector<std::future<std::shared_ptr<void>>> results;
+    for (std::size_t i = 0; i < mEntries.size(); i++) {
+      auto policy = mParallel ? std::launch::async : std::launch::deferred;
+      results.push_back(std::async(policy, mEntries[i].fetch, std::cref(*mApis[i]), timestamp));
+    }
+    for (std::size_t i = 0; i < mEntries.size(); i++) {
+      auto& entry = mEntries[i];
+      entry.object = results[i].get();
+      if (!entry.object) {
+        if (entry.required) {
+          LOG(fatal) << "Got nullptr from CCDB for path " << entry.path << " and timestamp " << timestamp;
+        }
+        LOG(warning) << "No CCDB object for path " << entry.path << " and timestamp " << timestamp;
+      }
+    }
+  }
+
+  std::string mURL = "http://alice-ccdb.cern.ch";
+  bool mParallel = true;
+  int mRunNumber = -1;
+  std::vector<Entry> mEntries;
+  std::map<std::string, int> mIndices;
+  std::vector<std::unique_ptr<o2::ccdb::CcdbApi>> mApis;
+  std::vector<RunChangeCallback> mCallbacks;
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_RUNCONDITIONS_H_
@@ -0,0 +1,176 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ScopeTimer.h
+/// \brief  Lightweight timing of code scopes (e.g. process functions) for the analysis tasks
+///
+/// A task owns a ScopeTimerRegistry, declares its scopes once in init and measures them with
+/// RAII ScopeTimer objects. The number of calls, the total and maximum wall time (and optionally
+/// the number of heap allocations) are accumulated per scope and can be copied into histograms
+/// of the task output or printed as JSON.
+///
+/// Usage:
+///   o2::analysis::ScopeTimerRegistry timers;
+///   int scopeProcess = timers.addScope("process");               // in init
+///   { o2::analysis::ScopeTimer t(timers, scopeProcess); ... }     // in process
+///   timers.fillHistograms(hTime.get(), hCalls.get());              // at the end of process
+///
+/// The allocation counting replaces the global operator new, so it is only compiled if
+/// O2_SCOPE_TIMER_ALLOCATION_HOOK is defined before including this header, in one translation
+/// unit of the workflow.
+///
+
+#ifndef COMMON_CORE_SCOPETIMER_H_
+#define COMMON_CORE_SCOPETIMER_H_
+
+#include <TH1.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+/// Number of heap allocations of the current thread, only incremented if the allocation hook is enabled
+inline thread_local uint64_t nAllocations = 0;
+
+class ScopeTimerRegistry
+{
+ public:
+  struct Scope {
+    std::string name;
+    uint64_t calls = 0;
+    double totalNs = 0.;
+    double maxNs = 0.;
+    uint64_t allocations = 0;
+  };
+
+  /// Declares a scope
+  /// \return index of the scope, to be passed to the ScopeTimer
+  int addScope(const std::string& name)
+  {
+    mScopes.push_back({name});
+    return static_cast<int>(mScopes.size()) - 1;
+  }
+
+  void add(int scope, double ns, uint64_t allocations)
+  {
+    auto& s = mScopes[scope];
+    s.calls++;
+    s.totalNs += ns;
+    s.maxNs = std::max(s.maxNs, ns);
+    s.allocations += allocations;
+  }
+
+  const std::vector<Scope>& getScopes() const { return mScopes; }
+
+  /// Copies the accumulated values into histograms with one bin per scope (any of them can be nullptr)
+  /// \param hTime total wall time per scope in ms
+  /// \param hCalls number of calls per scope
+  /// \param hAllocations number of heap allocations per scope
+  void fillHistograms(TH1* hTime, TH1* hCalls = nullptr, TH1* hAllocations = nullptr) const
+  {
+    for (std::size_t i = 0; i < mScopes.size(); i++) {
+      const auto& s = mScopes[i];
+      for (auto* h : {hTime, hCalls, hAllocations}) {
+        if (h != nullptr && static_cast<int>(i) < h->GetNbinsX()) {
+          h->GetXaxis()->SetBinLabel(i + 1, s.name.c_str());
+        }
+      }
+      if (hTime != nullptr) {
+        hTime->SetBinContent(i + 1, s.totalNs * 1.e-6);
+      }
+      if (hCalls != nullptr) {
+        hCalls->SetBinContent(i + 1, s.calls);
+      }
+      if (hAllocations != nullptr) {
+        hAllocations->SetBinContent(i + 1, s.allocations);
+      }
+    }
+  }
+
+  /// \return summary of all the scopes as a JSON array
+  std::string toJSON() const
+  {
+    std::string json = "[";
+    for (std::size_t i = 0; i < mScopes.size(); i++) {
+      const auto& s = mScopes[i];
+      json += (i > 0 ? ", " : "");
+      json += "{\"name\": \"" + s.name + "\", \"calls\": " + std::to_string(s.calls) +
+              ", \"totalMs\": " + std::to_string(s.totalNs * 1.e-6) +
+              ", \"meanUs\": " + std::to_string(s.calls > 0 ? s.totalNs * 1.e-3 / s.calls : 0.) +
+              ", \"maxUs\": " + std::to_string(s.maxNs * 1.e-3) +
+              ", \"allocations\": " + std::to_string(s.allocations) + "}";
+    }
+    return json + "]";
+  }
+
+  void print() const { LOG(info) << "Scope timers: " << toJSON(); }
+
+ private:
+  std::vector<Scope> mScopes;
+};
+
+/// Measures the wall time (and the allocations) between its construction and its destruction, or the call to stop()
+class ScopeTimer
+{
+ public:
+  ScopeTimer(ScopeTimerRegistry& registry, int scope) : mRegistry(registry), mScope(scope), mAllocationsStart(nAllocations), mStart(std::chrono::steady_clock::now()) {}
+  ScopeTimer(ScopeTimer const&) = delete;
+  ScopeTimer& operator=(ScopeTimer const&) = delete;
+  ~ScopeTimer() { stop(); }
+
+  /// Stops the timer, further calls have no effect
+  /// \return elapsed time in ns
+  double stop()
+  {
+    if (mStopped) {
+      return mElapsedNs;
+    }
+    mElapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - mStart).count();
+    mStopped = true;
+    mRegistry.add(mScope, mElapsedNs, nAllocations - mAllocationsStart);
+    return mElapsedNs;
+  }
+
+ private:
+  ScopeTimerRegistry& mRegistry;
+  int mScope;
+  uint64_t mAllocationsStart;
+  std::chrono::steady_clock::time_point mStart;
+  bool mStopped = false;
+  double mElapsedNs = 0.;
+};
+
+} // namespace o2::analysis
+
+#ifdef O2_SCOPE_TIMER_ALLOCATION_HOOK
+void* operator new(std::size_t size)
+{
+  o2::analysis::nAllocations++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
+
+#endif // COMMON_CORE_SCOPETIMER_H_
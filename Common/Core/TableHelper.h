@@ -19,6 +19,7 @@
 #define COMMON_CORE_TABLEHELPER_H_
 
 #include <string>
+#include <vector>
 
 #include "Framework/InitContext.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -39,6 +40,26 @@ bool isTableRequiredInWorkflow(o2::framework::InitContext& initContext, const st
   return false;
 }
 
+/// Function to check which tables of a list are required in a workflow, with a single pass over the workflow inputs
+/// @param initContext initContext of the init function
+/// @param tables names of the tables to check for
+/// @return demand mask, element i is true if tables[i] is consumed by a device of the workflow
+std::vector<bool> getTablesRequiredInWorkflow(o2::framework::InitContext& initContext, const std::vector<std::string>& tables)
+{
+  std::vector<bool> required(tables.size(), false);
+  auto& workflows = initContext.services().get<o2::framework::RunningWorkflowInfo const>();
+  for (auto const& device : workflows.devices) {
+    for (auto const& input : device.inputs) {
+      for (std::size_t i = 0; i < tables.size(); i++) {
+        if (input.matcher.binding == tables[i]) {
+          required[i] = true;
+        }
+      }
+    }
+  }
+  return required;
+}
+
 /// Function to enable or disable a configurable flag, depending on the fact that a table is needed or not
 /// @param initContext initContext of the init function
 /// @param table name of the table to check for
@@ -46,7 +67,17 @@ bool isTableRequiredInWorkflow(o2::framework::InitContext& initContext, const st
 template <typename FlagType>
 void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::string& table, FlagType& flag)
 {
-  if (isTableRequiredInWorkflow(initContext, table)) {
+  enableFlagIfTableRequired(isTableRequiredInWorkflow(initContext, table), table, flag);
+}
+
+/// Same as above, with the table demand already resolved (e.g. with getTablesRequiredInWorkflow)
+/// @param isRequired true if the table is consumed in the workflow
+/// @param table name of the table, for the log
+/// @param flag configurable flag to set, only if initially set to -1
+template <typename FlagType>
+void enableFlagIfTableRequired(const bool isRequired, const std::string& table, FlagType& flag)
+{
+  if (isRequired) {
     if (flag < 0) {
       flag.value = 1;
       LOG(info) << "Auto-enabling table: " + table;
@@ -15,6 +15,8 @@
 
 #include "Common/Core/TrackSelection.h"
 
+#include <array>
+
 bool TrackSelection::FulfillsITSHitRequirements(uint8_t itsClusterMap)
 {
   constexpr uint8_t bit = 1;
@@ -29,4 +31,67 @@ bool TrackSelection::FulfillsITSHitRequirements(uint8_t itsClusterMap)
   return true;
 }
 
+void TrackSelection::FillMasks(TrackColumns const& tracks, std::vector<uint16_t>& masks)
+{
+  const size_t n = tracks.size();
+  masks.assign(n, 0);
+
+  auto setFlags = [&](const TrackCuts& cut, auto&& passes) {
+    const int bit = static_cast<int>(cut);
+    for (size_t i = 0; i < n; i++) {
+      masks[i] |= static_cast<uint16_t>(passes(i)) << bit;
+    }
+  };
+
+  // The ITS hit requirements only depend on the cluster map, they are tabulated for all its values
+  std::array<uint8_t, 256> passesITSHits;
+  for (int itsClusterMap = 0; itsClusterMap < 256; itsClusterMap++) {
+    passesITSHits[itsClusterMap] = FulfillsITSHitRequirements(itsClusterMap);
+  }
+
+  setFlags(TrackCuts::kTrackType, [&](size_t i) { return tracks.trackType[i] == mTrackType; });
+  setFlags(TrackCuts::kPtRange, [&](size_t i) { return (tracks.pt[i] >= mMinPt) & (tracks.pt[i] <= mMaxPt); });
+  setFlags(TrackCuts::kEtaRange, [&](size_t i) { return (tracks.eta[i] >= mMinEta) & (tracks.eta[i] <= mMaxEta); });
+  setFlags(TrackCuts::kTPCNCls, [&](size_t i) { return tracks.tpcNClsFound[i] >= mMinNClustersTPC; });
+  setFlags(TrackCuts::kTPCCrossedRows, [&](size_t i) { return tracks.tpcNClsCrossedRows[i] >= mMinNCrossedRowsTPC; });
+  setFlags(TrackCuts::kTPCCrossedRowsOverNCls, [&](size_t i) { return tracks.tpcCrossedRowsOverFindableCls[i] >= mMinNCrossedRowsOverFindableClustersTPC; });
+  setFlags(TrackCuts::kTPCChi2NDF, [&](size_t i) { return tracks.tpcChi2NCl[i] <= mMaxChi2PerClusterTPC; });
+  setFlags(TrackCuts::kTPCRefit, [&](size_t i) { return !mRequireTPCRefit | (tracks.tpcRefit[i] != 0); });
+  setFlags(TrackCuts::kITSNCls, [&](size_t i) { return tracks.itsNCls[i] >= mMinNClustersITS; });
+  setFlags(TrackCuts::kITSChi2NDF, [&](size_t i) { return tracks.itsChi2NCl[i] <= mMaxChi2PerClusterITS; });
+  setFlags(TrackCuts::kITSRefit, [&](size_t i) { return !mRequireITSRefit | (tracks.itsRefit[i] != 0); });
+  setFlags(TrackCuts::kITSHits, [&](size_t i) { return passesITSHits[tracks.itsClusterMap[i]] != 0; });
+  setFlags(TrackCuts::kGoldenChi2, [&](size_t i) { return !mRequireGoldenChi2 | (tracks.goldenChi2[i] != 0); });
+  if (mMaxDcaXYPtDep) {
+    setFlags(TrackCuts::kDCAxy, [&](size_t i) { return tracks.absDcaXY[i] <= mMaxDcaXYPtDep(tracks.pt[i]); });
+  } else {
+    setFlags(TrackCuts::kDCAxy, [&](size_t i) { return tracks.absDcaXY[i] <= mMaxDcaXY; });
+  }
+  setFlags(TrackCuts::kDCAz, [&](size_t i) { return tracks.absDcaZ[i] <= mMaxDcaZ; });
+}
+
+void TrackSelection::TrackColumns::clear()
+{
+  for (auto* column : {&trackType, &tpcRefit, &itsNCls, &itsRefit, &itsClusterMap, &goldenChi2}) {
+    column->clear();
+  }
+  for (auto* column : {&pt, &eta, &tpcCrossedRowsOverFindableCls, &tpcChi2NCl, &itsChi2NCl, &absDcaXY, &absDcaZ}) {
+    column->clear();
+  }
+  tpcNClsFound.clear();
+  tpcNClsCrossedRows.clear();
+}
+
+void TrackSelection::TrackColumns::reserve(size_t n)
+{
+  for (auto* column : {&trackType, &tpcRefit, &itsNCls, &itsRefit, &itsClusterMap, &goldenChi2}) {
+    column->reserve(n);
+  }
+  for (auto* column : {&pt, &eta, &tpcCrossedRowsOverFindableCls, &tpcChi2NCl, &itsChi2NCl, &absDcaXY, &absDcaZ}) {
+    column->reserve(n);
+  }
+  tpcNClsFound.reserve(n);
+  tpcNClsCrossedRows.reserve(n);
+}
+
 const std::string TrackSelection::mCutNames[static_cast<int>(TrackSelection::TrackCuts::kNCuts)] = {"TrackType", "PtRange", "EtaRange", "TPCNCls", "TPCCrossedRows", "TPCCrossedRowsOverNCls", "TPCChi2NDF", "TPCRefit", "ITSNCls", "ITSChi2NDF", "ITSRefit", "ITSHits", "GoldenChi2", "DCAxy", "DCAz"};
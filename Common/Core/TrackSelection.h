@@ -18,6 +18,7 @@
 
 #include "Framework/Logger.h"
 #include "Framework/DataTypes.h"
+#include <cmath>
 #include <set>
 #include <vector>
 #include "Rtypes.h"
@@ -54,6 +55,70 @@ class TrackSelection
 
   static const std::string mCutNames[static_cast<int>(TrackCuts::kNCuts)];
 
+  static constexpr uint16_t kAllCutsMask = (1UL << static_cast<int>(TrackCuts::kNCuts)) - 1; // mask of a track passing all the cuts
+
+  // Variables of the tracks used by the cuts, stored in columns to evaluate each cut over many tracks at once.
+  // They do not depend on the cut values and can be shared by several selections.
+  struct TrackColumns {
+    std::vector<uint8_t> trackType;
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<int16_t> tpcNClsFound;
+    std::vector<int16_t> tpcNClsCrossedRows;
+    std::vector<float> tpcCrossedRowsOverFindableCls;
+    std::vector<float> tpcChi2NCl;
+    std::vector<uint8_t> tpcRefit; // Run 2: TPC refit flag, Run 3: has TPC
+    std::vector<uint8_t> itsNCls;
+    std::vector<float> itsChi2NCl;
+    std::vector<uint8_t> itsRefit; // Run 2: ITS refit flag, Run 3: has ITS
+    std::vector<uint8_t> itsClusterMap;
+    std::vector<uint8_t> goldenChi2; // Run 2: golden chi2 flag, Run 3: always true
+    std::vector<float> absDcaXY;
+    std::vector<float> absDcaZ;
+
+    size_t size() const { return pt.size(); }
+
+    template <typename T>
+    void fill(T const& tracks)
+    {
+      clear();
+      reserve(tracks.size());
+      for (auto const& track : tracks) {
+        push(track, track.dcaXY(), track.dcaZ());
+      }
+    }
+
+    // Appends one track, with the DCAs given explicitly, e.g. when they are computed in the same loop
+    template <typename T>
+    void push(T const& track, float dcaXY, float dcaZ)
+    {
+      const bool isRun2 = track.trackType() == o2::aod::track::Run2Track || track.trackType() == o2::aod::track::Run2Tracklet;
+      trackType.push_back(track.trackType());
+      pt.push_back(track.pt());
+      eta.push_back(track.eta());
+      tpcNClsFound.push_back(track.tpcNClsFound());
+      tpcNClsCrossedRows.push_back(track.tpcNClsCrossedRows());
+      tpcCrossedRowsOverFindableCls.push_back(track.tpcCrossedRowsOverFindableCls());
+      tpcChi2NCl.push_back(track.tpcChi2NCl());
+      tpcRefit.push_back(isRun2 ? (track.flags() & o2::aod::track::TPCrefit) != 0 : track.hasTPC());
+      itsNCls.push_back(track.itsNCls());
+      itsChi2NCl.push_back(track.itsChi2NCl());
+      itsRefit.push_back(isRun2 ? (track.flags() & o2::aod::track::ITSrefit) != 0 : track.hasITS());
+      itsClusterMap.push_back(track.itsClusterMap());
+      goldenChi2.push_back(isRun2 ? (track.flags() & o2::aod::track::GoldenChi2) != 0 : true);
+      absDcaXY.push_back(std::abs(dcaXY));
+      absDcaZ.push_back(std::abs(dcaZ));
+    }
+
+    void clear();
+    void reserve(size_t n);
+  };
+
+  // Evaluates the cuts over all the tracks of the columns, one pass per cut, and sets the bit of each passed cut
+  // in the mask of the track. The masks are the same as the ones of IsSelectedMask, and IsSelected is equivalent
+  // to mask == kAllCutsMask.
+  void FillMasks(TrackColumns const& tracks, std::vector<uint16_t>& masks);
+
   // Temporary function to check if track passes selection criteria. To be replaced by framework filters.
   template <typename T>
   bool IsSelected(T const& track)
@@ -0,0 +1,117 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   TwoProngPrecheck.h
+/// \brief  Analytic pre-check of a pair of barrel tracks before the two-prong DCA fitter
+///
+/// The two helices are projected on xy as circles with the current magnetic field. The pair is
+/// hopeless if the circles do not cross nor come closer than maxDistXY, or if at all the crossing
+/// points the z of the two tracks differ by more than maxDZ. These are the first steps of
+/// DCAFitterN<2>::process, done here on the circle parameters only, without copying and
+/// propagating the tracks, so that the iterative fit is run only for the pairs which can
+/// make a vertex.
+///
+/// Usage:
+///   o2::analysis::TwoProngPrecheck precheck;
+///   precheck.setBz(bz);                                   // at the run change, with the fitter
+///   int nCand = precheck.process(fitter, track0, track1); // 0 for the rejected pairs
+///
+
+#ifndef COMMON_CORE_TWOPRONGPRECHECK_H_
+#define COMMON_CORE_TWOPRONGPRECHECK_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "ReconstructionDataFormats/HelixHelper.h"
+
+namespace o2::analysis
+{
+
+class TwoProngPrecheck
+{
+ public:
+  /// \param bz Magnetic field in kG, as for the fitter
+  void setBz(float bz) { mBz = bz; }
+  /// \param maxDistXY Maximum distance in xy of the circles of the tracks, as DCAFitterN::setMaxDXYIni
+  void setMaxDistXY(float maxDistXY) { mMaxDistXY = maxDistXY; }
+  /// \param maxDZ Maximum z distance of the tracks at the crossing points, as DCAFitterN::setMaxDZIni, no requirement if <= 0
+  void setMaxDZ(float maxDZ) { mMaxDZ = maxDZ; }
+  /// \param enabled If false, all the pairs are compatible and process() always runs the fitter
+  void setEnabled(bool enabled) { mEnabled = enabled; }
+
+  bool isEnabled() const { return mEnabled; }
+  float getBz() const { return mBz; }
+  float getMaxDistXY() const { return mMaxDistXY; }
+  float getMaxDZ() const { return mMaxDZ; }
+
+  /// \return true if the tracks can make a two-prong vertex
+  template <typename TTrack>
+  bool isCompatible(TTrack const& track0, TTrack const& track1) const
+  {
+    if (!mEnabled) {
+      return true;
+    }
+    const o2::track::TrackAuxPar aux0(track0, mBz);
+    const o2::track::TrackAuxPar aux1(track1, mBz);
+    o2::track::CrossInfo crossing;
+    if (crossing.set(aux0, track0, aux1, track1, mMaxDistXY) == 0) {
+      return false;
+    }
+    if (mMaxDZ <= 0.f) {
+      return true;
+    }
+    for (int i = 0; i < crossing.nDCA; i++) {
+      const float dz = getZAt(track0, aux0, crossing.xDCA[i], crossing.yDCA[i]) - getZAt(track1, aux1, crossing.xDCA[i], crossing.yDCA[i]);
+      if (std::abs(dz) < mMaxDZ) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Runs the fitter for the compatible pairs only
+  /// \return number of candidates of the fitter, 0 if the pair is rejected by the pre-check
+  template <typename TFitter, typename TTrack>
+  int process(TFitter& fitter, TTrack const& track0, TTrack const& track1) const
+  {
+    if (!isCompatible(track0, track1)) {
+      return 0;
+    }
+    return fitter.process(track0, track1);
+  }
+
+ private:
+  /// \return z of the track at the point (x, y) of its circle, from the arc length in xy
+  template <typename TTrack>
+  static float getZAt(TTrack const& track, o2::track::TrackAuxPar const& aux, float x, float y)
+  {
+    const auto position = track.getXYZGlo();
+    const float dx = x - position.X();
+    const float dy = y - position.Y();
+    const float chord = std::sqrt(dx * dx + dy * dy);
+    // the arc is shorter than half a turn, forward or backward depending on the track direction at its reference point
+    const float phi = track.getPhi();
+    const float direction = dx * std::cos(phi) + dy * std::sin(phi) < 0.f ? -1.f : 1.f;
+    const float arc = aux.rC > 0.f ? 2.f * aux.rC * std::asin(std::min(1.f, chord / (2.f * aux.rC))) : chord;
+    return position.Z() + track.getTgl() * direction * arc;
+  }
+
+  bool mEnabled = true;
+  float mBz = 0.f;
+  float mMaxDistXY = 4.f; // default of DCAFitterN
+  float mMaxDZ = 4.f;     // default of DCAFitterN
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_TWOPRONGPRECHECK_H_
@@ -12,9 +12,12 @@
 #include <map>
 #include <list>
 #include <fstream>
+#include <future>
+#include <vector>
 #include <getopt.h>
 
 #include "TSystem.h"
+#include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
 #include "TList.h"
@@ -71,6 +74,8 @@ int main(int argc, char* argv[])
   std::string outputFileName("AO2D.root");
   long maxDirSize = 100000000;
   bool skipNonExistingFiles = false;
+  bool prefetch = false;
+  bool fastCopy = false;
   int exitCode = 0; // 0: success, >0: failure
 
   int option_index = 0;
@@ -80,6 +85,8 @@ int main(int argc, char* argv[])
     {"max-size", required_argument, nullptr, 2},
     {"skip-non-existing-files", no_argument, nullptr, 3},
     {"help", no_argument, nullptr, 4},
+    {"prefetch", no_argument, nullptr, 5},
+    {"fast-copy", no_argument, nullptr, 6},
     {nullptr, 0, nullptr, 0}};
 
   while (true) {
@@ -100,7 +107,13 @@ int main(int argc, char* argv[])
       printf("  --output <outputfile.root>   Target output ROOT file. Default: %s\n", outputFileName.c_str());
       printf("  --max-size <size in Bytes>   Target directory size. Default: %ld. Set to 0 if file is not self-contained.\n", maxDirSize);
       printf("  --skip-non-existing-files    Flag to allow skipping of non-existing files in the input list.\n");
+      printf("  --prefetch                   Open the next input file in the background while the current one is merged.\n");
+      printf("  --fast-copy                  Copy the trees without index columns basket by basket, without decompressing them.\n");
       return -1;
+    } else if (c == 5) {
+      prefetch = true;
+    } else if (c == 6) {
+      fastCopy = true;
     } else {
       return -2;
     }
@@ -113,6 +126,13 @@ int main(int argc, char* argv[])
   if (skipNonExistingFiles) {
     printf("  WARNING: Skipping non-existing files.\n");
   }
+  if (prefetch) {
+    printf("  Prefetching the next input file.\n");
+    ROOT::EnableThreadSafety();
+  }
+  if (fastCopy) {
+    printf("  Fast copy of the trees without index columns.\n");
+  }
 
   std::map<std::string, TTree*> trees;
   std::map<std::string, int> offsets;
@@ -125,17 +145,22 @@ int main(int argc, char* argv[])
   std::ifstream in;
   in.open(inputCollection);
   TString line;
+  std::vector<TString> inputFiles;
+  while (in.good()) {
+    in >> line;
+    if (line.Length() > 0) {
+      inputFiles.push_back(line);
+    }
+  }
+
   bool connectedToAliEn = false;
   TMap* metaData = nullptr;
   TMap* parentFiles = nullptr;
   int totalMergedDFs = 0;
   int mergedDFs = 0;
-  while (in.good() && exitCode == 0) {
-    in >> line;
-
-    if (line.Length() == 0) {
-      continue;
-    }
+  std::future<TFile*> nextInputFile; // opened in the background with --prefetch
+  for (size_t iFile = 0; iFile < inputFiles.size() && exitCode == 0; ++iFile) {
+    line = inputFiles[iFile];
 
     if (line.BeginsWith("alien:") && !connectedToAliEn) {
       printf("Connecting to AliEn...");
@@ -145,7 +170,15 @@ int main(int argc, char* argv[])
 
     printf("Processing input file: %s\n", line.Data());
 
-    auto inputFile = TFile::Open(line);
+    auto inputFile = nextInputFile.valid() ? nextInputFile.get() : TFile::Open(line);
+    if (prefetch && iFile + 1 < inputFiles.size()) {
+      if (inputFiles[iFile + 1].BeginsWith("alien:") && !connectedToAliEn) {
+        printf("Connecting to AliEn...");
+        TGrid::Connect("alien:");
+        connectedToAliEn = true; // Only try once
+      }
+      nextInputFile = std::async(std::launch::async, [](TString fileName) { return TFile::Open(fileName); }, inputFiles[iFile + 1]);
+    }
     if (!inputFile) {
       printf("Error: Could not open input file %s.\n", line.Data());
       if (skipNonExistingFiles) {
@@ -322,6 +355,14 @@ int main(int argc, char* argv[])
         }
 
         auto entries = inputTree->GetEntries();
+        if (fastCopy && indexList.empty()) {
+          // nothing to rewrite: the baskets are copied as they are
+          auto nbytes = outputTree->CopyEntries(inputTree, -1, "fast");
+          if (nbytes > 0) {
+            currentDirSize += nbytes;
+          }
+          entries = 0; // nothing left to copy entry by entry
+        }
         int minIndexOffset = unassignedIndexOffset[treeName];
         auto newMinIndexOffset = minIndexOffset;
         for (int i = 0; i < entries; i++) {
@@ -408,6 +449,13 @@ int main(int argc, char* argv[])
     inputFile->Close();
   }
 
+  if (nextInputFile.valid()) {
+    auto inputFile = nextInputFile.get();
+    if (inputFile) {
+      inputFile->Close();
+    }
+  }
+
   if (parentFiles) {
     outputFile->cd();
     parentFiles->Write("parentFiles", TObject::kSingleKey);
@@ -0,0 +1,74 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file fwdTrackUtilities.h
+/// \brief Linear propagation of forward (MFT) tracks to the z of candidate vertices
+///
+/// The MFT tracks are nearly straight, so the DCA of an ambiguous track to each of its candidate
+/// vertices is computed with the same straight line as TrackParFwd::propagateToZlinear, without
+/// building a TrackParCovFwd per track and vertex. The slopes are computed once per track and the
+/// candidates are given as arrays, so that the loop over them is vectorised by the compiler.
+
+#ifndef COMMON_CORE_FWDTRACKUTILITIES_H_
+#define COMMON_CORE_FWDTRACKUTILITIES_H_
+
+#include <cmath>
+#include <cstddef>
+
+namespace o2::analysis::fwd
+{
+
+/// Straight line of a forward track
+struct LinearFwdTrack {
+  float x = 0.f;
+  float y = 0.f;
+  float z = 0.f;
+  float dxdz = 0.f; // cos(phi) / tgl
+  float dydz = 0.f; // sin(phi) / tgl
+
+  /// \param track MFT track, with x, y, z, phi and tgl
+  template <typename T>
+  static LinearFwdTrack fromTrack(T const& track)
+  {
+    const float invTgl = 1.f / track.tgl();
+    return {track.x(), track.y(), track.z(), std::cos(track.phi()) * invTgl, std::sin(track.phi()) * invTgl};
+  }
+
+  float getXAt(float zEnd) const { return x + (zEnd - z) * dxdz; }
+  float getYAt(float zEnd) const { return y + (zEnd - z) * dydz; }
+};
+
+/// \return transverse DCA of the track to the vertex, at the z of the vertex
+inline float getDCAXY(LinearFwdTrack const& track, float vx, float vy, float vz)
+{
+  const float dcaX = track.getXAt(vz) - vx;
+  const float dcaY = track.getYAt(vz) - vy;
+  return std::sqrt(dcaX * dcaX + dcaY * dcaY);
+}
+
+/// Computes the DCAs of the track to n vertices
+/// \param vx, vy, vz positions of the vertices
+/// \param dcaX, dcaY, dcaXY output arrays of size n
+inline void getDCAs(LinearFwdTrack const& track, const float* vx, const float* vy, const float* vz, std::size_t n,
+                    float* dcaX, float* dcaY, float* dcaXY)
+{
+  for (std::size_t i = 0; i < n; i++) {
+    dcaX[i] = track.x + (vz[i] - track.z) * track.dxdz - vx[i];
+    dcaY[i] = track.y + (vz[i] - track.z) * track.dydz - vy[i];
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    dcaXY[i] = std::sqrt(dcaX[i] * dcaX[i] + dcaY[i] * dcaY[i]);
+  }
+}
+
+} // namespace o2::analysis::fwd
+
+#endif // COMMON_CORE_FWDTRACKUTILITIES_H_
@@ -21,6 +21,8 @@
 #include "ReconstructionDataFormats/Vertex.h"
 #include "Common/Core/RecoDecay.h"
 
+#include <vector>
+
 /// Extracts track parameters from a track.
 template <typename TrackPrecision = float, typename T>
 o2::track::TrackParametrization<TrackPrecision> getTrackPar(const T& track)
@@ -45,6 +47,55 @@ o2::track::TrackParametrizationWithError<TrackPrecision> getTrackParCov(const T&
   return o2::track::TrackParametrizationWithError<TrackPrecision>(track.x(), track.alpha(), std::move(arraypar), std::move(covpar));
 }
 
+/// Cache of track parameters and covariance matrices extracted from a track table.
+/// Tracks used in several candidates (e.g. V0 daughters combined with many bachelors)
+/// are converted only once. Tracks are identified by their global index, tracks outside
+/// the table given in setTracks are converted at each request.
+template <typename TrackPrecision = float>
+class TrackParCovCache
+{
+ public:
+  using TrackParCovType = o2::track::TrackParametrizationWithError<TrackPrecision>;
+
+  /// Sets the table of the cached tracks, invalidating the cache if the table changed (e.g. new dataframe or collision slice).
+  /// \param tracks  (sliced) track table
+  template <typename T>
+  void setTracks(const T& tracks)
+  {
+    const void* table = tracks.asArrowTable().get();
+    int64_t offset = tracks.size() > 0 ? tracks.begin().globalIndex() : 0;
+    if (table == mTable && offset == mOffset && static_cast<std::size_t>(tracks.size()) == mIsCached.size()) {
+      return;
+    }
+    mTable = table;
+    mOffset = offset;
+    mTrackParCovs.resize(tracks.size());
+    mIsCached.assign(tracks.size(), false);
+  }
+
+  /// Returns the track parameters and covariance matrix of a track, extracted at the first request.
+  /// \param track  track, ideally from the table given in setTracks
+  template <typename T>
+  TrackParCovType get(const T& track)
+  {
+    auto index = track.globalIndex() - mOffset;
+    if (index < 0 || static_cast<std::size_t>(index) >= mIsCached.size()) {
+      return getTrackParCov<TrackPrecision>(track);
+    }
+    if (!mIsCached[index]) {
+      mTrackParCovs[index] = getTrackParCov<TrackPrecision>(track);
+      mIsCached[index] = true;
+    }
+    return mTrackParCovs[index];
+  }
+
+ private:
+  const void* mTable = nullptr;               ///< table of the cached tracks
+  int64_t mOffset = 0;                        ///< global index of the first track of the table
+  std::vector<TrackParCovType> mTrackParCovs; ///< cached track parameters, indexed by track position in the table
+  std::vector<bool> mIsCached;                ///< whether the track parameters have been extracted
+};
+
 /// Extracts primary vertex position and covariance matrix from a collision.
 template <typename T>
 o2::dataformats::VertexBase getPrimaryVertex(const T& collision)
@@ -0,0 +1,51 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_ANALYSIS_BCFITACTIVITY_H_
+#define O2_ANALYSIS_BCFITACTIVITY_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+// Per BC collision index and FIT activity in the neighbouring BCs, produced by the bc-fit-activity task
+// One row per BC, joinable with BCs and BcSels. The FIT entries of the BC itself are given by the
+// foundFT0, foundFV0, foundFDD and foundZDC indices of BcSels.
+//
+// The activity columns are bit patterns over the BCs [globalBC - 15, globalBC + 15]: bit (deltaBC + 15)
+// is set if the BC globalBC + deltaBC passes the corresponding beam-beam or beam-gas selection of BcSels,
+// i.e. the past-future patterns of the UD candidate tables
+
+namespace o2::aod
+{
+namespace bcfitactivity
+{
+constexpr int nBCsAround = 15; // BCs considered on each side
+
+DECLARE_SOA_INDEX_COLUMN(Collision, collision); //! First collision with this BC as bc, -1 if none
+DECLARE_SOA_COLUMN(BBFT0APF, bbFT0Apf, int32_t); //! Beam-beam in FT0A in the neighbouring BCs
+DECLARE_SOA_COLUMN(BBFT0CPF, bbFT0Cpf, int32_t); //! Beam-beam in FT0C in the neighbouring BCs
+DECLARE_SOA_COLUMN(BGFT0APF, bgFT0Apf, int32_t); //! Beam-gas in FT0A in the neighbouring BCs
+DECLARE_SOA_COLUMN(BGFT0CPF, bgFT0Cpf, int32_t); //! Beam-gas in FT0C in the neighbouring BCs
+DECLARE_SOA_COLUMN(BBFV0APF, bbFV0Apf, int32_t); //! Beam-beam in V0A in the neighbouring BCs
+DECLARE_SOA_COLUMN(BGFV0APF, bgFV0Apf, int32_t); //! Beam-gas in V0A in the neighbouring BCs
+DECLARE_SOA_COLUMN(BBFDDAPF, bbFDDApf, int32_t); //! Beam-beam in FDA in the neighbouring BCs
+DECLARE_SOA_COLUMN(BBFDDCPF, bbFDDCpf, int32_t); //! Beam-beam in FDC in the neighbouring BCs
+DECLARE_SOA_COLUMN(BGFDDAPF, bgFDDApf, int32_t); //! Beam-gas in FDA in the neighbouring BCs
+DECLARE_SOA_COLUMN(BGFDDCPF, bgFDDCpf, int32_t); //! Beam-gas in FDC in the neighbouring BCs
+} // namespace bcfitactivity
+
+DECLARE_SOA_TABLE(BcFITActivities, "AOD", "BCFITACTIVITY", //! FIT activity around each BC
+                  bcfitactivity::CollisionId,
+                  bcfitactivity::BBFT0APF, bcfitactivity::BBFT0CPF, bcfitactivity::BGFT0APF, bcfitactivity::BGFT0CPF,
+                  bcfitactivity::BBFV0APF, bcfitactivity::BGFV0APF,
+                  bcfitactivity::BBFDDAPF, bcfitactivity::BBFDDCPF, bcfitactivity::BGFDDAPF, bcfitactivity::BGFDDCPF);
+using BcFITActivity = BcFITActivities::iterator;
+} // namespace o2::aod
+
+#endif // O2_ANALYSIS_BCFITACTIVITY_H_
@@ -8,11 +8,13 @@
 // In applying this license CERN does not waive the privileges and immunities
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
-#ifndef PWGMM_MULT_DATAMODEL_BESTCOLLISIONTABLE_H_
-#define PWGMM_MULT_DATAMODEL_BESTCOLLISIONTABLE_H_
+#ifndef O2_ANALYSIS_BESTCOLLISIONTABLES_H_
+#define O2_ANALYSIS_BESTCOLLISIONTABLES_H_
 
 #include "Framework/AnalysisDataModel.h"
 
+// Best collision association of the ambiguous tracks, produced by the ambiguous-track-propagation task
+
 namespace o2::aod
 {
 namespace track
@@ -61,4 +63,4 @@ DECLARE_SOA_TABLE(ReassignedTracksExtra, "AOD", "EXRETRACKS",
 
 } // namespace o2::aod
 
-#endif // PWGMM_MULT_DATAMODEL_BESTCOLLISIONTABLE_H_
+#endif // O2_ANALYSIS_BESTCOLLISIONTABLES_H_
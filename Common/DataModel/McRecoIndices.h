@@ -0,0 +1,36 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_ANALYSIS_MCRECOINDICES_H_
+#define O2_ANALYSIS_MCRECOINDICES_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+// Generated -> reconstructed indices, produced by the mc-reco-index task
+// One row per MC particle (joinable with McParticles) and one row per MC collision (joinable with McCollisions)
+
+namespace o2::aod
+{
+namespace mcrecoindex
+{
+DECLARE_SOA_ARRAY_INDEX_COLUMN(Track, track);         //! Reconstructed tracks with the MC particle as label, by increasing track index
+DECLARE_SOA_ARRAY_INDEX_COLUMN(Collision, collision); //! Reconstructed collisions with the MC collision as label, by increasing collision index
+} // namespace mcrecoindex
+
+DECLARE_SOA_TABLE(McParticleRecoTracks, "AOD", "MCPARTRECOTRK", //! Reconstructed tracks of each MC particle
+                  mcrecoindex::TrackIds);
+using McParticleRecoTrack = McParticleRecoTracks::iterator;
+
+DECLARE_SOA_TABLE(McCollisionRecoCollisions, "AOD", "MCCOLLRECOCOLL", //! Reconstructed collisions of each MC collision
+                  mcrecoindex::CollisionIds);
+using McCollisionRecoCollision = McCollisionRecoCollisions::iterator;
+} // namespace o2::aod
+
+#endif // O2_ANALYSIS_MCRECOINDICES_H_
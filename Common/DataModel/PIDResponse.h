@@ -19,6 +19,8 @@
 #ifndef COMMON_DATAMODEL_PIDRESPONSE_H_
 #define COMMON_DATAMODEL_PIDRESPONSE_H_
 
+#include <cmath>
+#include <cstdint>
 #include <experimental/type_traits>
 
 // O2 includes
@@ -31,19 +33,53 @@ namespace o2::aod
 {
 namespace pidutils
 {
+/// Binning policy of the stored (packed) PID columns, symmetric around zero
+/// \tparam binnedType Signed integer type of the stored column, its size sets the number of bins
+/// \tparam rangeX100 Upper edge of the range times 100, the values beyond it go to the overflow (underflow) bin
+/// \tparam companding If true the bins are narrower close to zero: the square root of |value| / range is binned linearly,
+///                    so that the resolution is best in the region relevant for the selections
+template <typename binnedType, int rangeX100, bool companding = false>
+struct binningPolicy {
+ public:
+  typedef binnedType binned_t;
+  static constexpr int nbins = (1 << 8 * sizeof(binned_t)) - 2;
+  static constexpr binned_t overflowBin = nbins >> 1;
+  static constexpr binned_t underflowBin = -(nbins >> 1);
+  static constexpr float binned_max = rangeX100 / 100.f;
+  static constexpr float binned_min = -binned_max;
+  static constexpr float bin_width = (binned_max - binned_min) / nbins; // for the linear binning
+  static constexpr bool isCompanded = companding;
+
+  static binned_t pack(const float& valueToBin)
+  {
+    if (valueToBin <= binned_min) {
+      return underflowBin;
+    } else if (valueToBin >= binned_max) {
+      return overflowBin;
+    }
+    float x = valueToBin / bin_width;
+    if constexpr (companding) {
+      x = std::copysign(std::sqrt(std::abs(valueToBin) / binned_max), valueToBin) * overflowBin;
+    }
+    return static_cast<binned_t>(x >= 0 ? x + 0.5f : x - 0.5f);
+  }
+
+  static float unpack(const binned_t& binned)
+  {
+    if constexpr (companding) {
+      const float x = static_cast<float>(binned) / overflowBin;
+      return std::copysign(x * x * binned_max, x);
+    } else {
+      return bin_width * static_cast<float>(binned);
+    }
+  }
+};
+
 // Function to pack a float into a binned value in table
 template <typename binningType, typename T>
 void packInTable(const float& valueToBin, T& table)
 {
-  if (valueToBin <= binningType::binned_min) {
-    table(binningType::underflowBin);
-  } else if (valueToBin >= binningType::binned_max) {
-    table(binningType::overflowBin);
-  } else if (valueToBin >= 0) {
-    table(static_cast<typename binningType::binned_t>((valueToBin / binningType::bin_width) + 0.5f));
-  } else {
-    table(static_cast<typename binningType::binned_t>((valueToBin / binningType::bin_width) - 0.5f));
-  }
+  table(binningType::pack(valueToBin));
 }
 
 // Checkers for TOF PID hypothesis availability (runtime)
@@ -478,23 +514,17 @@ DECLARE_SOA_COLUMN(TOFNSigmaHe, tofNSigmaHe, float); //! Nsigma separation with
 DECLARE_SOA_COLUMN(TOFNSigmaAl, tofNSigmaAl, float); //! Nsigma separation with the TOF detector for alpha
 } // namespace pidtof
 
+// Macro to convert the stored binned values to floats with a binning policy
+#define DEFINE_UNWRAP_BINNED_COLUMN(COLUMN, COLUMN_NAME, BINNING) \
+  DECLARE_SOA_DYNAMIC_COLUMN(COLUMN, COLUMN_NAME,                 \
+                             [](BINNING::binned_t binned) -> float { return BINNING::unpack(binned); });
+
 // Macro to convert the stored Nsigmas to floats
-#define DEFINE_UNWRAP_NSIGMA_COLUMN(COLUMN, COLUMN_NAME) \
-  DECLARE_SOA_DYNAMIC_COLUMN(COLUMN, COLUMN_NAME,        \
-                             [](binning::binned_t nsigma_binned) -> float { return binning::bin_width * static_cast<float>(nsigma_binned); });
+#define DEFINE_UNWRAP_NSIGMA_COLUMN(COLUMN, COLUMN_NAME) DEFINE_UNWRAP_BINNED_COLUMN(COLUMN, COLUMN_NAME, binning)
 
 namespace pidtof_tiny
 {
-struct binning {
- public:
-  typedef int8_t binned_t;
-  static constexpr int nbins = (1 << 8 * sizeof(binned_t)) - 2;
-  static constexpr binned_t overflowBin = nbins >> 1;
-  static constexpr binned_t underflowBin = -(nbins >> 1);
-  static constexpr float binned_max = 6.35;
-  static constexpr float binned_min = -6.35;
-  static constexpr float bin_width = (binned_max - binned_min) / nbins;
-};
+using binning = pidutils::binningPolicy<int8_t, 635>; // 8 bit in [-6.35, 6.35], bin width 0.05
 
 // NSigma with reduced size 8 bit
 DECLARE_SOA_COLUMN(TOFNSigmaStoreEl, tofNSigmaStoreEl, binning::binned_t); //! Stored binned nsigma with the TOF detector for electron
@@ -662,16 +692,7 @@ DECLARE_SOA_COLUMN(TPCNSigmaAl, tpcNSigmaAl, float); //! Nsigma separation with
 namespace pidtpc_tiny
 {
 
-struct binning {
- public:
-  typedef int8_t binned_t;
-  static constexpr int nbins = (1 << 8 * sizeof(binned_t)) - 2;
-  static constexpr binned_t overflowBin = nbins >> 1;
-  static constexpr binned_t underflowBin = -(nbins >> 1);
-  static constexpr float binned_max = 6.35;
-  static constexpr float binned_min = -6.35;
-  static constexpr float bin_width = (binned_max - binned_min) / nbins;
-};
+using binning = pidutils::binningPolicy<int8_t, 635>; // 8 bit in [-6.35, 6.35], bin width 0.05
 
 // NSigma with reduced size
 DECLARE_SOA_COLUMN(TPCNSigmaStoreEl, tpcNSigmaStoreEl, binning::binned_t); //! Stored binned nsigma with the TPC detector for electron
@@ -0,0 +1,31 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_ANALYSIS_QVECTORS_H_
+#define O2_ANALYSIS_QVECTORS_H_
+
+#include <vector>
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace qvec
+{
+// NOTE: the Q-vectors are those of the generic framework (GFW) regions of the qvectors-gfw-table producer, stored in the order of
+//       GFW::GetQvectors() and to be loaded with GFW::SetQvectors() in a GFW with the same regions
+DECLARE_SOA_COLUMN(QvecRe, qvecRe, std::vector<double>);          //! Real part of the Q-vectors of all the regions, [region][pt][harmonic][power]
+DECLARE_SOA_COLUMN(QvecIm, qvecIm, std::vector<double>);          //! Imaginary part of the Q-vectors of all the regions, [region][pt][harmonic][power]
+DECLARE_SOA_COLUMN(QvecNEntries, qvecNEntries, std::vector<int>); //! Number of tracks in each region
+} // namespace qvec
+DECLARE_SOA_TABLE(QvectorsGFW, "AOD", "QVECTORSGFW", qvec::QvecRe, qvec::QvecIm, qvec::QvecNEntries); //! GFW Q-vectors, joinable with the collisions
+using QvectorGFW = QvectorsGFW::iterator;
+} // namespace o2::aod
+
+#endif // O2_ANALYSIS_QVECTORS_H_
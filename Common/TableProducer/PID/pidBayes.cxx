@@ -16,6 +16,15 @@
 ///         Only the tables for the mass hypotheses requested are filled, the others are sent empty.
 ///
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TH1.h"
+#include "TList.h"
+
 // O2 includes
 #include "Framework/AnalysisTask.h"
 #include "Framework/HistogramRegistry.h"
@@ -41,6 +50,74 @@ void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
 
 #include "Framework/runDataProcessing.h"
 
+/// Prior probabilities of all the species tabulated in bins of pT
+/// The priors are copied from one histogram per species (all with the same binning) when they are loaded,
+/// so that the lookup of a track is a single bin search that serves all the species.
+/// Outside the range of the histograms the first and last bins are used.
+struct PriorTable {
+  bool mUniform = true;                              ///< uniform binning, the bin is computed instead of searched
+  int mNBins = 0;                                    ///< number of bins in pT, 0 if no priors are loaded
+  float mPtMin = 0.f;                                ///< lower edge of the first bin
+  float mInvBinWidth = 0.f;                          ///< inverse of the bin width, for uniform binning
+  std::vector<float> mUpEdges;                       ///< upper edges of the bins, for variable binning
+  std::vector<std::array<float, PID::NIDs>> mPriors; ///< priors of all the species in each bin
+
+  bool isSet() const { return mNBins > 0; }
+
+  /// Copies the priors from the histograms in the list, named "prior" + species (e.g. "priorPi")
+  /// Species without histogram get a prior of 1
+  void set(TList* list)
+  {
+    static constexpr const char* particles[PID::NIDs] = {"El", "Mu", "Pi", "Ka", "Pr", "De", "Tr", "He", "Al"};
+    mNBins = 0;
+    mPriors.clear();
+    mUpEdges.clear();
+    const TAxis* axis = nullptr;
+    for (int id = 0; id < PID::NIDs; id++) {
+      auto* h = list ? dynamic_cast<TH1*>(list->FindObject(Form("prior%s", particles[id]))) : nullptr;
+      if (!h) {
+        LOG(info) << "No prior histogram for " << PID::getName(id) << ", using a prior of 1";
+        continue;
+      }
+      if (!axis) {
+        axis = h->GetXaxis();
+        mNBins = axis->GetNbins();
+        mUniform = axis->GetXbins()->GetSize() == 0;
+        mPtMin = axis->GetXmin();
+        mInvBinWidth = mNBins / (axis->GetXmax() - axis->GetXmin());
+        for (int bin = 1; bin <= mNBins; bin++) {
+          mUpEdges.push_back(axis->GetBinUpEdge(bin));
+        }
+        mPriors.resize(mNBins);
+        for (auto& priors : mPriors) {
+          priors.fill(1.f);
+        }
+      } else if (h->GetXaxis()->GetNbins() != mNBins || h->GetXaxis()->GetXmin() != axis->GetXmin() || h->GetXaxis()->GetXmax() != axis->GetXmax()) {
+        LOG(fatal) << "Prior histogram for " << PID::getName(id) << " has a different binning";
+      }
+      for (int bin = 0; bin < mNBins; bin++) {
+        mPriors[bin][id] = h->GetBinContent(bin + 1);
+      }
+    }
+    if (!isSet()) {
+      LOG(fatal) << "No prior histograms found";
+    }
+    LOG(info) << "Loaded priors in " << mNBins << " bins of pT from " << mPtMin << " to " << mUpEdges.back() << " GeV/c";
+  }
+
+  /// \return the priors of all the species for the given pT
+  const std::array<float, PID::NIDs>& get(float pt) const
+  {
+    int bin = 0;
+    if (mUniform) {
+      bin = static_cast<int>((pt - mPtMin) * mInvBinWidth);
+    } else {
+      bin = std::upper_bound(mUpEdges.begin(), mUpEdges.end(), pt) - mUpEdges.begin();
+    }
+    return mPriors[std::clamp(bin, 0, mNBins - 1)];
+  }
+};
+
 struct bayesPid {
   using Trks = soa::Join<aod::Tracks, aod::TracksExtra, aod::TOFSignal, aod::TOFEvTime, aod::pidEvTimeFlags>;
   using Coll = soa::Join<aod::Collisions, aod::Mults>;
@@ -86,6 +163,8 @@ struct bayesPid {
   Configurable<std::string> ccdbPathTOF{"ccdbPathTOF", "Analysis/PID/TOF", "Path of the TOF parametrization on the CCDB"};
   Configurable<std::string> ccdbPathTPC{"ccdbPathTPC", "Analysis/PID/TPC/Response", "Path of the TPC parametrization on the CCDB"};
   Configurable<int64_t> timestamp{"ccdb-timestamp", -1, "timestamp of the object"};
+  Configurable<std::string> paramfilePriors{"param-file-priors", "", "Path to the file with the prior probabilities (TList \"Priors\" of histograms vs pT named priorEl, priorPi, ...), if empty the priors are taken from the CCDB"};
+  Configurable<std::string> ccdbPathPriors{"ccdbPathPriors", "", "Path of the prior probabilities on the CCDB, if empty (and no file is given) flat priors are used"};
 
   // Configuration flags to include and exclude particle hypotheses
   // Configurable<LabeledArray<int>> pid{"pid",
@@ -103,6 +182,7 @@ struct bayesPid {
 
   std::array<std::array<float, PID::NIDs>, kNProb> Probability; /// Probabilities for all the cases defined in ProbType
   std::vector<PID::ID> enabledSpecies;                          /// Enabled species
+  PriorTable priors;                                            /// Prior probabilities in bins of pT
 
   /// Checker of the species that are enabled and initializer of the probabilities
   template <ProbType detIndex, o2::track::PID::ID pid>
@@ -248,6 +328,33 @@ struct bayesPid {
       LOGP(info, "Loading TPC response from CCDB, using path: {} for timestamp {}", pathTPC, time);
       responseTPC.PrintAll();
     }
+    // Loading the prior probabilities
+    if (!paramfilePriors.value.empty()) {
+      LOGP(info, "Loading priors from file {}", paramfilePriors.value);
+      std::unique_ptr<TFile> f(TFile::Open(paramfilePriors.value.c_str(), "READ"));
+      if (!f || f->IsZombie()) {
+        LOGP(fatal, "Cannot open the priors file {}", paramfilePriors.value);
+      }
+      TList* list = nullptr;
+      f->GetObject("Priors", list);
+      priors.set(list);
+    } else if (!ccdbPathPriors.value.empty()) {
+      LOGP(info, "Loading priors from CCDB, using path: {} for timestamp {}", ccdbPathPriors.value, timestamp.value);
+      priors.set(ccdb->getForTimeStamp<TList>(ccdbPathPriors.value, timestamp.value));
+    } else {
+      LOG(info) << "Using flat priors";
+    }
+
+    if (doprocessStandard == doprocessFromNSigma) {
+      LOG(fatal) << "Exactly one process function between processStandard and processFromNSigma should be enabled";
+    }
+    if (doprocessFromNSigma) {
+      for (const auto enabledPid : enabledSpecies) {
+        if (enabledPid > PID::Proton) {
+          LOG(fatal) << "processFromNSigma only supports the El, Mu, Pi, Ka and Pr hypotheses, " << PID::getName(enabledPid) << " was enabled";
+        }
+      }
+    }
   }
 
   /// Computes PID probabilities for the TPC
@@ -402,6 +509,43 @@ struct bayesPid {
     LOG(debug) << "\tSum combined: " << probSum[kNDet];
   }
 
+  /// Number of species handled by processFromNSigma
+  static constexpr int kNSpeciesFromNSigma = PID::Proton + 1;
+
+  /// Computes the TPC and TOF probabilities of all the enabled species from the precomputed n-sigma,
+  /// with the same likelihoods as ComputeTPCProbability and ComputeTOFProbability
+  void ComputeProbabilitiesFromNSigma(const std::array<float, kNSpeciesFromNSigma>& tpcNSigma,
+                                      const std::array<float, kNSpeciesFromNSigma>& tofNSigma,
+                                      const std::array<float, kNSpeciesFromNSigma>& tofExpSigma,
+                                      const bool hasTOF)
+  {
+    const float flat = 1.f / enabledSpecies.size();
+    const float meanCorrFactor = 0.07 / fTOFtail;
+    for (const auto enabledPid : enabledSpecies) {
+      if (enabledDet[kTPC]) {
+        const float nsigma = tpcNSigma[enabledPid];
+        if (abs(nsigma) > fRange) { // Mismatch
+          Probability[kTPC][enabledPid] = 1.f / Probability[kTPC].size();
+        } else {
+          Probability[kTPC][enabledPid] = exp(-0.5 * nsigma * nsigma);
+        }
+      }
+      if (enabledDet[kTOF]) {
+        if (!hasTOF) {
+          Probability[kTOF][enabledPid] = flat;
+          continue;
+        }
+        const float nsigmas = tofNSigma[enabledPid] + meanCorrFactor;
+        if (nsigmas < fTOFtail) {
+          Probability[kTOF][enabledPid] = exp(-0.5 * nsigmas * nsigmas) / tofExpSigma[enabledPid];
+        } else {
+          Probability[kTOF][enabledPid] = exp(-(nsigmas - fTOFtail * 0.5) * fTOFtail) / tofExpSigma[enabledPid];
+        }
+        Probability[kTOF][enabledPid] += fgTOFmismatchProb;
+      }
+    }
+  }
+
   /// Calculate Bayesian probabilities
   void ComputeBayesProbabilities()
   {
@@ -428,18 +572,16 @@ struct bayesPid {
     }
   }
 
-  void process(Coll const& collisions, Trks const& tracks)
+  /// Prepares the memory of the enabled tables
+  void reserveTables(const int64_t size)
   {
-
-    // Check and fill enabled tables
-    auto makeTable = [&tracks](const Configurable<int>& flag, auto& table) {
+    auto makeTable = [size](const Configurable<int>& flag, auto& table) {
       if (flag.value == 1) {
-        // Prepare memory for enabled tables
-        table.reserve(tracks.size());
+        table.reserve(size);
       }
     };
 
-    tableBayes.reserve(tracks.size());
+    tableBayes.reserve(size);
     makeTable(pidEl, tablePIDEl);
     makeTable(pidMu, tablePIDMu);
     makeTable(pidPi, tablePIDPi);
@@ -449,6 +591,45 @@ struct bayesPid {
     makeTable(pidTr, tablePIDTr);
     makeTable(pidHe, tablePIDHe);
     makeTable(pidAl, tablePIDAl);
+  }
+
+  /// Fills the enabled tables with the Bayesian probabilities of the current track
+  void fillTables()
+  {
+    if (pidEl == 1) {
+      tablePIDEl(Probability[kBayesian][PID::Electron] * 100.f);
+    }
+    if (pidMu == 1) {
+      tablePIDMu(Probability[kBayesian][PID::Muon] * 100.f);
+    }
+    if (pidPi == 1) {
+      tablePIDPi(Probability[kBayesian][PID::Pion] * 100.f);
+    }
+    if (pidKa == 1) {
+      tablePIDKa(Probability[kBayesian][PID::Kaon] * 100.f);
+    }
+    if (pidPr == 1) {
+      tablePIDPr(Probability[kBayesian][PID::Proton] * 100.f);
+    }
+    if (pidDe == 1) {
+      tablePIDDe(Probability[kBayesian][PID::Deuteron] * 100.f);
+    }
+    if (pidTr == 1) {
+      tablePIDTr(Probability[kBayesian][PID::Triton] * 100.f);
+    }
+    if (pidHe == 1) {
+      tablePIDHe(Probability[kBayesian][PID::Helium3] * 100.f);
+    }
+    if (pidAl == 1) {
+      tablePIDAl(Probability[kBayesian][PID::Alpha] * 100.f);
+    }
+    const auto mostProbable = std::max_element(Probability[kBayesian].begin(), Probability[kBayesian].end());
+    tableBayes((*mostProbable) * 100.f, std::distance(Probability[kBayesian].begin(), mostProbable));
+  }
+
+  void processStandard(Coll const& collisions, Trks const& tracks)
+  {
+    reserveTables(tracks.size());
 
     for (auto const& trk : tracks) { // Loop on Tracks
 
@@ -475,39 +656,42 @@ struct bayesPid {
 
       MergeProbabilities();
 
+      if (priors.isSet()) {
+        Probability[kPrior] = priors.get(trk.pt());
+      }
       ComputeBayesProbabilities();
 
-      if (pidEl == 1) {
-        tablePIDEl(Probability[kBayesian][PID::Electron] * 100.f);
-      }
-      if (pidMu == 1) {
-        tablePIDMu(Probability[kBayesian][PID::Muon] * 100.f);
-      }
-      if (pidPi == 1) {
-        tablePIDPi(Probability[kBayesian][PID::Pion] * 100.f);
-      }
-      if (pidKa == 1) {
-        tablePIDKa(Probability[kBayesian][PID::Kaon] * 100.f);
-      }
-      if (pidPr == 1) {
-        tablePIDPr(Probability[kBayesian][PID::Proton] * 100.f);
-      }
-      if (pidDe == 1) {
-        tablePIDDe(Probability[kBayesian][PID::Deuteron] * 100.f);
-      }
-      if (pidTr == 1) {
-        tablePIDTr(Probability[kBayesian][PID::Triton] * 100.f);
-      }
-      if (pidHe == 1) {
-        tablePIDHe(Probability[kBayesian][PID::Helium3] * 100.f);
-      }
-      if (pidAl == 1) {
-        tablePIDAl(Probability[kBayesian][PID::Alpha] * 100.f);
+      fillTables();
+    }
+  }
+  PROCESS_SWITCH(bayesPid, processStandard, "Compute the detector responses of all the species for each track", true);
+
+  using TrksNSigma = soa::Join<aod::Tracks, aod::TracksExtra,
+                               aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
+                               aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
+
+  /// Computes the probabilities from the n-sigma of the TPC and TOF PID tasks instead of evaluating the responses again
+  void processFromNSigma(TrksNSigma const& tracks)
+  {
+    reserveTables(tracks.size());
+
+    for (auto const& trk : tracks) {
+      ComputeProbabilitiesFromNSigma({trk.tpcNSigmaEl(), trk.tpcNSigmaMu(), trk.tpcNSigmaPi(), trk.tpcNSigmaKa(), trk.tpcNSigmaPr()},
+                                     {trk.tofNSigmaEl(), trk.tofNSigmaMu(), trk.tofNSigmaPi(), trk.tofNSigmaKa(), trk.tofNSigmaPr()},
+                                     {trk.tofExpSigmaEl(), trk.tofExpSigmaMu(), trk.tofExpSigmaPi(), trk.tofExpSigmaKa(), trk.tofExpSigmaPr()},
+                                     trk.hasTOF());
+
+      MergeProbabilities();
+
+      if (priors.isSet()) {
+        Probability[kPrior] = priors.get(trk.pt());
       }
-      const auto mostProbable = std::max_element(Probability[kBayesian].begin(), Probability[kBayesian].end());
-      tableBayes((*mostProbable) * 100.f, std::distance(Probability[kBayesian].begin(), mostProbable));
+      ComputeBayesProbabilities();
+
+      fillTables();
     }
   }
+  PROCESS_SWITCH(bayesPid, processFromNSigma, "Compute the probabilities from the n-sigma tables of the TPC and TOF PID tasks", false);
 };
 
 struct bayesPidQa {
@@ -79,8 +79,8 @@ struct tofPid {
 
   void init(o2::framework::InitContext& initContext)
   {
-    if (doprocessWSlice == true && doprocessWoSlice == true) {
-      LOGF(fatal, "Cannot enable processWoSlice and processWSlice at the same time. Please choose one.");
+    if (int(doprocessWSlice) + int(doprocessWoSlice) + int(doprocessWoSliceFused) > 1) {
+      LOGF(fatal, "Cannot enable more than one of processWoSlice, processWSlice and processWoSliceFused at the same time. Please choose one.");
     }
 
     // Checking the tables are requested in the workflow and enabling them
@@ -296,6 +296,82 @@ struct tofPid {
     }
   }
   PROCESS_SWITCH(tofPid, processWoSlice, "Process without track slices", false);
+
+  /// Same as processWoSlice, with all the mass hypotheses of a track computed together
+  void processWoSliceFused(Trks const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const&)
+  {
+    auto reserveTable = [&tracks](const Configurable<int>& flag, auto& table) {
+      if (flag.value != 1) {
+        return;
+      }
+      table.reserve(tracks.size());
+    };
+
+    reserveTable(pidEl, tablePIDEl);
+    reserveTable(pidMu, tablePIDMu);
+    reserveTable(pidPi, tablePIDPi);
+    reserveTable(pidKa, tablePIDKa);
+    reserveTable(pidPr, tablePIDPr);
+    reserveTable(pidDe, tablePIDDe);
+    reserveTable(pidTr, tablePIDTr);
+    reserveTable(pidHe, tablePIDHe);
+    reserveTable(pidAl, tablePIDAl);
+
+    float nSigma[o2::track::PID::NIDs];
+    int lastCollisionId = -1;          // Last collision ID analysed
+    for (auto const& track : tracks) { // Loop on all tracks
+      if (!track.has_collision()) {    // Track was not assigned, cannot compute NSigma (no event time) -> filling with empty table
+        auto makeTableEmpty = [&](const Configurable<int>& flag, auto& table) {
+          if (flag.value != 1) {
+            return;
+          }
+          aod::pidutils::packInTable<aod::pidtof_tiny::binning>(-999.f,
+                                                                table);
+        };
+
+        makeTableEmpty(pidEl, tablePIDEl);
+        makeTableEmpty(pidMu, tablePIDMu);
+        makeTableEmpty(pidPi, tablePIDPi);
+        makeTableEmpty(pidKa, tablePIDKa);
+        makeTableEmpty(pidPr, tablePIDPr);
+        makeTableEmpty(pidDe, tablePIDDe);
+        makeTableEmpty(pidTr, tablePIDTr);
+        makeTableEmpty(pidHe, tablePIDHe);
+        makeTableEmpty(pidAl, tablePIDAl);
+
+        continue;
+      }
+
+      if (enableTimeDependentResponse && (track.collisionId() != lastCollisionId)) { // Time dependent calib is enabled and this is a new collision
+        lastCollisionId = track.collisionId();                                       // Cache last collision ID
+        timestamp.value = track.collision().bc_as<aod::BCsWithTimestamps>().timestamp();
+        LOG(debug) << "Updating parametrization from path '" << parametrizationPath << "' and timestamp " << timestamp.value;
+        mRespParams.SetParameters(ccdb->getForTimeStamp<o2::pid::tof::TOFResoParams>(parametrizationPath, timestamp));
+      }
+
+      o2::pid::tof::ExpTimesAllSpecies<Trks::iterator>::GetSeparations(mRespParams, track, nSigma);
+
+      // Check and fill enabled tables
+      auto makeTable = [&](const Configurable<int>& flag, auto& table, const int id) {
+        if (flag.value != 1) {
+          return;
+        }
+        aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nSigma[id],
+                                                              table);
+      };
+
+      makeTable(pidEl, tablePIDEl, PID::Electron);
+      makeTable(pidMu, tablePIDMu, PID::Muon);
+      makeTable(pidPi, tablePIDPi, PID::Pion);
+      makeTable(pidKa, tablePIDKa, PID::Kaon);
+      makeTable(pidPr, tablePIDPr, PID::Proton);
+      makeTable(pidDe, tablePIDDe, PID::Deuteron);
+      makeTable(pidTr, tablePIDTr, PID::Triton);
+      makeTable(pidHe, tablePIDHe, PID::Helium3);
+      makeTable(pidAl, tablePIDAl, PID::Alpha);
+    }
+  }
+  PROCESS_SWITCH(tofPid, processWoSliceFused, "Process without track slices, all mass hypotheses of a track together", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
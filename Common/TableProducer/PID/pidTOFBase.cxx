@@ -102,6 +102,8 @@ struct tofEventTime {
   Produces<o2::aod::TOFEvTime> tableEvTime;
   Produces<o2::aod::EvTimeTOFOnly> tableEvTimeTOFOnly;
   Produces<o2::aod::pidEvTimeFlags> tableFlags;
+  // The bias is removed per track by subtracting analytically its weight from the event time of the full sample
+  // (eventTimeContainer::removeBias), the best-hypothesis search is only run once per collision
   static constexpr bool removeTOFEvTimeBias = true; // Flag to subtract the Ev. Time bias for low multiplicity events with TOF
   static constexpr float diamond = 6.0;             // Collision diamond used in the estimation of the TOF event time
 
@@ -109,6 +111,7 @@ struct tofEventTime {
   bool enableTableTOFOnly = false;
   // Detector response and input parameters
   DetectorResponse response;
+  o2::pid::tof::TOFResoFrozen frozenReso; // parameters of the response, evaluated without virtual call if it is a TOFReso
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   Configurable<float> minMomentum{"minMomentum", 0.5f, "Minimum momentum to select track sample for TOF event time"};
   Configurable<float> maxMomentum{"maxMomentum", 2.0f, "Maximum momentum to select track sample for TOF event time"};
@@ -176,6 +179,8 @@ struct tofEventTime {
       LOG(info) << "Loading exp. sigma parametrization from CCDB, using path: " << path << " for timestamp " << timestamp.value;
       response.LoadParam(DetectorResponse::kSigma, ccdb->getForTimeStamp<Parametrization>(path, timestamp.value));
     }
+    // the resolution is evaluated for each track and mass hypothesis in the event time computation
+    frozenReso.Freeze(*response.GetParam(DetectorResponse::kSigma));
   }
 
   ///
@@ -241,7 +246,8 @@ struct tofEventTime {
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
 
       // First make table for event time
-      const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, response, diamond);
+      const auto evTimeTOF = frozenReso.IsFrozen() ? evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, frozenReso, diamond)
+                                                   : evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, response, diamond);
       int nGoodTracksForTOF = 0;
       float et = evTimeTOF.mEventTime;
       float erret = evTimeTOF.mEventTimeError;
@@ -305,7 +311,8 @@ struct tofEventTime {
       const auto& collision = t.collision_as<EvTimeCollisions>();
 
       // Compute the TOF event time
-      const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, response, diamond);
+      const auto evTimeTOF = frozenReso.IsFrozen() ? evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, frozenReso, diamond)
+                                                   : evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, response, diamond);
 
       float t0AC[2] = {.0f, 999.f};                                       // Value and error of T0A or T0C or T0AC
       float t0TOF[2] = {evTimeTOF.mEventTime, evTimeTOF.mEventTimeError}; // Value and error of TOF
@@ -318,6 +325,15 @@ struct tofEventTime {
       float errDiamond = diamond * 33.356409f;
       float weightDiamond = 1. / (errDiamond * errDiamond);
 
+      // The T0 measurement is the same for all the tracks of the collision
+      const bool hasT0 = collision.has_foundFT0();
+      const bool t0ACValid = hasT0 && collision.t0ACValid();
+      if (t0ACValid) {
+        t0AC[0] = collision.t0AC() * 1000.f;
+        t0AC[1] = collision.t0resolution() * 1000.f;
+      }
+      const float weightT0 = 1.f / (t0AC[1] * t0AC[1]);
+
       for (auto const& trk : tracksInCollision) { // Loop on Tracks
         // Reset the flag
         flags = 0;
@@ -337,17 +353,13 @@ struct tofEventTime {
           sumOfWeights += weight;
         }
 
-        if (collision.has_foundFT0()) { // T0 measurement is available
-          // const auto& ft0 = collision.foundFT0();
-          if (collision.t0ACValid()) {
-            t0AC[0] = collision.t0AC() * 1000.f;
-            t0AC[1] = collision.t0resolution() * 1000.f;
+        if (hasT0) { // T0 measurement is available
+          if (t0ACValid) {
             flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeT0AC;
           }
 
-          weight = 1.f / (t0AC[1] * t0AC[1]);
-          eventTime += t0AC[0] * weight;
-          sumOfWeights += weight;
+          eventTime += t0AC[0] * weightT0;
+          sumOfWeights += weightT0;
         }
 
         if (sumOfWeights < weightDiamond) { // avoiding sumOfWeights = 0 or worse that diamond
@@ -26,6 +26,7 @@
 // O2 includes
 #include <CCDB/BasicCCDBManager.h>
 #include "Framework/AnalysisTask.h"
+#include "Framework/HistogramRegistry.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "CCDB/CcdbApi.h"
 #include "Common/DataModel/PIDResponse.h"
@@ -33,6 +34,7 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "TableHelper.h"
+#include "Common/Core/ScopeTimer.h"
 #include "Common/TableProducer/PID/pidTPCML.h"
 #include "DPG/Tasks/AOTTrack/PID/qaPIDTPC.h"
 
@@ -71,7 +73,14 @@ struct tpcPid {
   o2::pid::tpc::Response* responseptr = nullptr;
   // Network correction for TPC PID response
   Network network;
+  std::vector<float> track_properties;   // network inputs for all tracks and mass hypotheses, reused across dataframes
+  std::vector<float> network_prediction; // network outputs for all tracks and mass hypotheses, reused across dataframes
   o2::ccdb::CcdbApi ccdbApi;
+  // Timing of the network correction
+  o2::analysis::ScopeTimerRegistry timers;
+  int scopeNetworkTotal = -1;
+  int scopeNetworkEval = -1;
+  HistogramRegistry histos{"histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   // Input parameters
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -85,7 +94,10 @@ struct tpcPid {
   Configurable<std::string> networkPathLocally{"networkPathLocally", "network.onnx", "(std::string) Path to the local .onnx file. If autofetching is enabled, then this is where the files will be downloaded"};
   Configurable<bool> enableNetworkOptimizations{"enableNetworkOptimizations", 1, "(bool) If the neural network correction is used, this enables GraphOptimizationLevel::ORT_ENABLE_EXTENDED in the ONNX session"};
   Configurable<std::string> networkPathCCDB{"networkPathCCDB", "Analysis/PID/TPC/ML", "Path on CCDB"};
+  Configurable<bool> enableTimingHistograms{"enableTimingHistograms", false, "(bool) Stores the accumulated time and number of calls of the network evaluation in histograms"};
   Configurable<int> networkSetNumThreads{"networkSetNumThreads", 0, "Especially important for running on a SLURM cluster. Sets the number of threads used for execution."};
+  Configurable<std::string> networkExecutionProvider{"networkExecutionProvider", "cpu", "(std::string) ONNX Runtime execution provider of the network: cpu, cuda, rocm or tensorrt. The CPU is used if the provider is not available"};
+  Configurable<int> networkDeviceId{"networkDeviceId", 0, "(int) GPU used by the GPU execution providers of the network"};
   // Configuration flags to include and exclude particle hypotheses
   Configurable<int> pidEl{"pid-el", -1, {"Produce PID information for the Electron mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
   Configurable<int> pidMu{"pid-mu", -1, {"Produce PID information for the Muon mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
@@ -119,6 +131,13 @@ struct tpcPid {
     enableFlag("He", pidHe);
     enableFlag("Al", pidAl);
 
+    scopeNetworkTotal = timers.addScope("network eval + overhead");
+    scopeNetworkEval = timers.addScope("network eval");
+    if (enableTimingHistograms) {
+      histos.add("timing/time", "Accumulated time;;t (ms)", kTH1D, {{2, 0, 2}});
+      histos.add("timing/calls", "Number of calls;;calls", kTH1D, {{2, 0, 2}});
+    }
+
     /// TPC PID Response
     const TString fname = paramfile.value;
     if (fname != "") { // Loading the parametrization from file
@@ -187,7 +206,9 @@ struct tpcPid {
                              strtoul(headers["Valid-From"].c_str(), NULL, 0),
                              strtoul(headers["Valid-Until"].c_str(), NULL, 0),
                              enableNetworkOptimizations.value,
-                             activeThreads);
+                             activeThreads,
+                             networkExecutionProvider.value,
+                             networkDeviceId.value);
             network = temp_net;
             network.evalNetwork(std::vector<float>(network.getInputDimensions(), 1.)); // This is an initialisation and might reduce the overhead of the model
           } else {
@@ -201,7 +222,9 @@ struct tpcPid {
           LOG(info) << "Using local file [" << networkPathLocally.value << "] for the TPC PID response correction.";
           Network temp_net(networkPathLocally.value,
                            enableNetworkOptimizations.value,
-                           activeThreads);
+                           activeThreads,
+                           networkExecutionProvider.value,
+                           networkDeviceId.value);
           network = temp_net;
           network.evalNetwork(std::vector<float>(network.getInputDimensions(), 1.)); // This is an initialisation and might reduce the overhead of the model
         }
@@ -234,12 +257,32 @@ struct tpcPid {
     reserveTable(pidHe, tablePIDHe);
     reserveTable(pidAl, tablePIDAl);
 
-    std::vector<float> network_prediction;
+    // Mass hypotheses of the enabled tables, evaluated together for each track
+    uint32_t speciesMask = 0;
+    auto enableSpecies = [&speciesMask](const Configurable<int>& flag, const o2::track::PID::ID pid) {
+      if (flag.value != 1) {
+        return;
+      }
+      speciesMask |= 1u << pid;
+    };
+    enableSpecies(pidEl, o2::track::PID::Electron);
+    enableSpecies(pidMu, o2::track::PID::Muon);
+    enableSpecies(pidPi, o2::track::PID::Pion);
+    enableSpecies(pidKa, o2::track::PID::Kaon);
+    enableSpecies(pidPr, o2::track::PID::Proton);
+    enableSpecies(pidDe, o2::track::PID::Deuteron);
+    enableSpecies(pidTr, o2::track::PID::Triton);
+    enableSpecies(pidHe, o2::track::PID::Helium3);
+    enableSpecies(pidAl, o2::track::PID::Alpha);
+    float expSignal[o2::track::PID::NIDs];
+    float expSigma[o2::track::PID::NIDs];
+    float nSigma[o2::track::PID::NIDs];
+
     const float nNclNormalization = response.GetNClNormalization();
 
     if (useNetworkCorrection) {
 
-      auto start_network_total = std::chrono::high_resolution_clock::now();
+      o2::analysis::ScopeTimer timerNetworkTotal(timers, scopeNetworkTotal);
 
       if (autofetchNetworks) {
 
@@ -261,7 +304,9 @@ struct tpcPid {
                              strtoul(headers["Valid-From"].c_str(), NULL, 0),
                              strtoul(headers["Valid-Until"].c_str(), NULL, 0),
                              enableNetworkOptimizations.value,
-                             activeThreads);
+                             activeThreads,
+                             networkExecutionProvider.value,
+                             networkDeviceId.value);
             network = temp_net;
             network.evalNetwork(std::vector<float>(network.getInputDimensions(), 1.)); // This is an initialisation and might reduce the overhead of the model
           } else {
@@ -271,50 +316,43 @@ struct tpcPid {
       }
 
       // Defining some network parameters
-      int input_dimensions = network.getInputDimensions();
-      int output_dimensions = network.getOutputDimensions();
-      const uint64_t track_prop_size = input_dimensions * tracks_size;
-      const uint64_t prediction_size = output_dimensions * tracks_size;
-
-      network_prediction = std::vector<float>(prediction_size * 9); // For each mass hypotheses
-
-      float duration_network = 0;
-
-      std::vector<float> track_properties(track_prop_size);
-      uint64_t counter_track_props = 0;
-      int loop_counter = 0;
+      const int input_dimensions = network.getInputDimensions();
+      const uint64_t species_rows = input_dimensions * tracks_size;
 
       // Filling a std::vector<float> to be evaluated by the network
-      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector
-      for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
-        for (auto const& trk : tracks) {
-          track_properties[counter_track_props] = trk.tpcInnerParam();
-          track_properties[counter_track_props + 1] = trk.tgl();
-          track_properties[counter_track_props + 2] = trk.signed1Pt();
-          track_properties[counter_track_props + 3] = o2::track::pid_constants::sMasses[i];
-          track_properties[counter_track_props + 4] = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
-          track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
-          counter_track_props += input_dimensions;
-        }
-
-        auto start_network_eval = std::chrono::high_resolution_clock::now();
-        float* output_network = network.evalNetwork(track_properties);
-        auto stop_network_eval = std::chrono::high_resolution_clock::now();
-        duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
-        for (uint64_t i = 0; i < prediction_size; i += output_dimensions) {
-          for (int j = 0; j < output_dimensions; j++) {
-            network_prediction[i + j + prediction_size * loop_counter] = output_network[i + j];
-          }
+      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector holding all the mass hypotheses,
+      // with the rows of the first hypothesis for all the tracks first, then the ones of the second, ...
+      track_properties.resize(species_rows * 9);
+      uint64_t counter_track_props = 0;
+      for (auto const& trk : tracks) {
+        const float tpcInnerParam = trk.tpcInnerParam();
+        const float tgl = trk.tgl();
+        const float signed1Pt = trk.signed1Pt();
+        const float multTPC = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
+        const float nClNorm = std::sqrt(nNclNormalization / trk.tpcNClsFound());
+        for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
+          float* row = track_properties.data() + counter_track_props + species_rows * i;
+          row[0] = tpcInnerParam;
+          row[1] = tgl;
+          row[2] = signed1Pt;
+          row[3] = o2::track::pid_constants::sMasses[i];
+          row[4] = multTPC;
+          row[5] = nClNorm;
         }
-
-        counter_track_props = 0;
-        loop_counter += 1;
+        counter_track_props += input_dimensions;
       }
-      track_properties.clear();
 
-      auto stop_network_total = std::chrono::high_resolution_clock::now();
+      // A single evaluation for all the tracks and mass hypotheses
+      o2::analysis::ScopeTimer timerNetworkEval(timers, scopeNetworkEval);
+      network.evalNetwork(track_properties, network_prediction);
+      const double duration_network = timerNetworkEval.stop();
+
+      const double duration_network_total = timerNetworkTotal.stop();
       LOG(info) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (tracks_size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
-      LOG(info) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / (tracks_size * 9) << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
+      LOG(info) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << duration_network_total / (tracks_size * 9) << "ns ; Total time (eval + overhead): " << duration_network_total / 1000000000 << " s";
+      if (enableTimingHistograms) {
+        timers.fillHistograms(histos.get<TH1>(HIST("timing/time")).get(), histos.get<TH1>(HIST("timing/calls")).get());
+      }
     }
 
     int lastCollisionId = -1; // Last collision ID analysed
@@ -327,8 +365,10 @@ struct tpcPid {
         const auto& bc = collisions.iteratorAt(trk.collisionId()).bc_as<aod::BCsWithTimestamps>();
         response.SetParameters(ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp()));
       }
+      // Expected signals, resolutions and number of sigmas of all the enabled hypotheses
+      response.GetResponseAllSpecies(collisions.iteratorAt(trk.collisionId()), trk, expSignal, expSigma, nSigma, speciesMask);
       // Check and fill enabled tables
-      auto makeTable = [&trk, &collisions, &network_prediction, &count_tracks, &tracks_size, this](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
+      auto makeTable = [&trk, &count_tracks, &tracks_size, &expSignal, &expSigma, &nSigma, this](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
         if (flag.value != 1) {
           return;
         }
@@ -338,20 +378,20 @@ struct tpcPid {
           // Here comes the application of the network. The output--dimensions of the network dtermine the application: 1: mean, 2: sigma, 3: sigma asymmetric
           // For now only the option 2: sigma will be used. The other options are kept if there would be demand later on
           if (network.getOutputDimensions() == 1) {
-            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - network_prediction[count_tracks + tracks_size * pid] * response.GetExpectedSignal(trk, pid)) / response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid), table);
+            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - network_prediction[count_tracks + tracks_size * pid] * expSignal[pid]) / expSigma[pid], table);
           } else if (network.getOutputDimensions() == 2) {
-            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[2 * (count_tracks + tracks_size * pid)]) / (network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]), table);
+            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / expSignal[pid] - network_prediction[2 * (count_tracks + tracks_size * pid)]) / (network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]), table);
           } else if (network.getOutputDimensions() == 3) {
-            if (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) >= network_prediction[3 * (count_tracks + tracks_size * pid)]) {
-              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]), table);
+            if (trk.tpcSignal() / expSignal[pid] >= network_prediction[3 * (count_tracks + tracks_size * pid)]) {
+              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / expSignal[pid] - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]), table);
             } else {
-              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]), table);
+              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / expSignal[pid] - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]), table);
             }
           } else {
             LOGF(fatal, "Network output-dimensions incompatible!");
           }
         } else {
-          aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(response.GetNumberOfSigma(collisions.iteratorAt(trk.collisionId()), trk, pid), table);
+          aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(nSigma[pid], table);
         }
       };
 
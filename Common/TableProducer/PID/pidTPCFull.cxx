@@ -71,6 +71,8 @@ struct tpcPidFull {
   o2::pid::tpc::Response* responseptr = nullptr;
   // Network correction for TPC PID response
   Network network;
+  std::vector<float> track_properties;   // network inputs for all tracks and mass hypotheses, reused across dataframes
+  std::vector<float> network_prediction; // network outputs for all tracks and mass hypotheses, reused across dataframes
   o2::ccdb::CcdbApi ccdbApi;
 
   // Input parameters
@@ -234,7 +236,26 @@ struct tpcPidFull {
     reserveTable(pidHe, tablePIDHe);
     reserveTable(pidAl, tablePIDAl);
 
-    std::vector<float> network_prediction;
+    // Mass hypotheses of the enabled tables, evaluated together for each track
+    uint32_t speciesMask = 0;
+    auto enableSpecies = [&speciesMask](const Configurable<int>& flag, const o2::track::PID::ID pid) {
+      if (flag.value != 1) {
+        return;
+      }
+      speciesMask |= 1u << pid;
+    };
+    enableSpecies(pidEl, o2::track::PID::Electron);
+    enableSpecies(pidMu, o2::track::PID::Muon);
+    enableSpecies(pidPi, o2::track::PID::Pion);
+    enableSpecies(pidKa, o2::track::PID::Kaon);
+    enableSpecies(pidPr, o2::track::PID::Proton);
+    enableSpecies(pidDe, o2::track::PID::Deuteron);
+    enableSpecies(pidTr, o2::track::PID::Triton);
+    enableSpecies(pidHe, o2::track::PID::Helium3);
+    enableSpecies(pidAl, o2::track::PID::Alpha);
+    float expSignal[o2::track::PID::NIDs];
+    float expSigma[o2::track::PID::NIDs];
+    float nSigma[o2::track::PID::NIDs];
 
     if (useNetworkCorrection) {
 
@@ -270,46 +291,40 @@ struct tpcPidFull {
       }
 
       // Defining some network parameters
-      int input_dimensions = network.getInputDimensions();
-      int output_dimensions = network.getOutputDimensions();
-      const uint64_t track_prop_size = input_dimensions * tracks_size;
-      const uint64_t prediction_size = output_dimensions * tracks_size;
-
-      network_prediction = std::vector<float>(prediction_size * 9); // For each mass hypotheses
+      const int input_dimensions = network.getInputDimensions();
+      const uint64_t species_rows = input_dimensions * tracks_size;
       const float nNclNormalization = response.GetNClNormalization();
-      float duration_network = 0;
 
-      std::vector<float> track_properties(track_prop_size);
-      uint64_t counter_track_props = 0;
-      int loop_counter = 0;
+      float duration_network = 0;
 
       // Filling a std::vector<float> to be evaluated by the network
-      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector
-      for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
-        for (auto const& trk : tracks) {
-          track_properties[counter_track_props] = trk.tpcInnerParam();
-          track_properties[counter_track_props + 1] = trk.tgl();
-          track_properties[counter_track_props + 2] = trk.signed1Pt();
-          track_properties[counter_track_props + 3] = o2::track::pid_constants::sMasses[i];
-          track_properties[counter_track_props + 4] = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
-          track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
-          counter_track_props += input_dimensions;
-        }
-
-        auto start_network_eval = std::chrono::high_resolution_clock::now();
-        float* output_network = network.evalNetwork(track_properties);
-        auto stop_network_eval = std::chrono::high_resolution_clock::now();
-        duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
-        for (uint64_t i = 0; i < prediction_size; i += output_dimensions) {
-          for (int j = 0; j < output_dimensions; j++) {
-            network_prediction[i + j + prediction_size * loop_counter] = output_network[i + j];
-          }
+      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector holding all the mass hypotheses,
+      // with the rows of the first hypothesis for all the tracks first, then the ones of the second, ...
+      track_properties.resize(species_rows * 9);
+      uint64_t counter_track_props = 0;
+      for (auto const& trk : tracks) {
+        const float tpcInnerParam = trk.tpcInnerParam();
+        const float tgl = trk.tgl();
+        const float signed1Pt = trk.signed1Pt();
+        const float multTPC = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
+        const float nClNorm = std::sqrt(nNclNormalization / trk.tpcNClsFound());
+        for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
+          float* row = track_properties.data() + counter_track_props + species_rows * i;
+          row[0] = tpcInnerParam;
+          row[1] = tgl;
+          row[2] = signed1Pt;
+          row[3] = o2::track::pid_constants::sMasses[i];
+          row[4] = multTPC;
+          row[5] = nClNorm;
         }
-
-        counter_track_props = 0;
-        loop_counter += 1;
+        counter_track_props += input_dimensions;
       }
-      track_properties.clear();
+
+      // A single evaluation for all the tracks and mass hypotheses
+      auto start_network_eval = std::chrono::high_resolution_clock::now();
+      network.evalNetwork(track_properties, network_prediction);
+      auto stop_network_eval = std::chrono::high_resolution_clock::now();
+      duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
 
       auto stop_network_total = std::chrono::high_resolution_clock::now();
       LOG(info) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (tracks_size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
@@ -326,8 +341,10 @@ struct tpcPidFull {
         const auto& bc = collisions.iteratorAt(trk.collisionId()).bc_as<aod::BCsWithTimestamps>();
         response.SetParameters(ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp()));
       }
+      // Expected signals, resolutions and number of sigmas of all the enabled hypotheses
+      response.GetResponseAllSpecies(collisions.iteratorAt(trk.collisionId()), trk, expSignal, expSigma, nSigma, speciesMask);
       // Check and fill enabled tables
-      auto makeTable = [&trk, &collisions, &network_prediction, &count_tracks, &tracks_size, this](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
+      auto makeTable = [&trk, &count_tracks, &tracks_size, &expSignal, &expSigma, &nSigma, this](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
         if (flag.value != 1) {
           return;
         }
@@ -337,25 +354,25 @@ struct tpcPidFull {
           // Here comes the application of the network. The output--dimensions of the network dtermine the application: 1: mean, 2: sigma, 3: sigma asymmetric
           // For now only the option 2: sigma will be used. The other options are kept if there would be demand later on
           if (network.getOutputDimensions() == 1) {
-            table(response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid),
-                  (trk.tpcSignal() - network_prediction[count_tracks + tracks_size * pid] * response.GetExpectedSignal(trk, pid)) / response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid));
+            table(expSigma[pid],
+                  (trk.tpcSignal() - network_prediction[count_tracks + tracks_size * pid] * expSignal[pid]) / expSigma[pid]);
           } else if (network.getOutputDimensions() == 2) {
-            table((network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]) * response.GetExpectedSignal(trk, pid),
-                  (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[2 * (count_tracks + tracks_size * pid)]) / (network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]));
+            table((network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]) * expSignal[pid],
+                  (trk.tpcSignal() / expSignal[pid] - network_prediction[2 * (count_tracks + tracks_size * pid)]) / (network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]));
           } else if (network.getOutputDimensions() == 3) {
-            if (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) >= network_prediction[3 * (count_tracks + tracks_size * pid)]) {
-              table((network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]) * response.GetExpectedSignal(trk, pid),
-                    (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]));
+            if (trk.tpcSignal() / expSignal[pid] >= network_prediction[3 * (count_tracks + tracks_size * pid)]) {
+              table((network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]) * expSignal[pid],
+                    (trk.tpcSignal() / expSignal[pid] - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]));
             } else {
-              table((network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]) * response.GetExpectedSignal(trk, pid),
-                    (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]));
+              table((network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]) * expSignal[pid],
+                    (trk.tpcSignal() / expSignal[pid] - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]));
             }
           } else {
             LOGF(fatal, "Network output-dimensions incompatible!");
           }
         } else {
-          table(response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid),
-                response.GetNumberOfSigma(collisions.iteratorAt(trk.collisionId()), trk, pid));
+          table(expSigma[pid],
+                nSigma[pid]);
         }
       };
 
@@ -21,6 +21,7 @@
 // C++ and system includes
 #include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
 #include <vector>
+#include <algorithm>
 
 // ROOT includes
 #include "TSystem.h"
@@ -28,6 +29,7 @@
 // O2 includes
 #include "Framework/Logger.h"
 #include "Common/TableProducer/PID/pidTPCML.h"
+#include "Common/Core/ONNXSessionRegistry.h"
 #include "ReconstructionDataFormats/PID.h"
 
 namespace o2::pid::tpc
@@ -44,7 +46,9 @@ std::string Network::printShape(const std::vector<int64_t>& v)
 
 Network::Network(std::string path,
                  bool enableOptimization = true,
-                 int numThreads = 0)
+                 int numThreads = 0,
+                 std::string executionProvider,
+                 int deviceId)
 {
 
   /*
@@ -54,20 +58,20 @@ Network::Network(std::string path,
     -- loadFromAlien:       bool          ; Download network from AliEn directory (true) or use local file (false)
     -- pathAlien:           std::string   ; if loadFromAlien is true, then the network will be downloaded from pathAlien
     -- enableOptimization:  bool          ; enabling optimizations for the loaded model in the session options;
+    -- executionProvider:   std::string   ; cpu, cuda, rocm or tensorrt, falling back to the CPU if not available;
+    -- deviceId:            int           ; GPU used by the GPU execution providers;
   */
 
   LOG(info) << "--- Neural Network for the TPC PID response correction ---";
 
-  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "pid-neural-network");
-  if (enableOptimization) {
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
-  }
-  if (numThreads > 0) {
-    // Setting the number of threads, potentially try: unsigned int nThreads = std::thread::hardware_concurrency();
-    sessionOptions.SetIntraOpNumThreads(numThreads);
-  }
+  o2::analysis::ONNXSessionSettings sessionSettings;
+  sessionSettings.enableGraphOptimization = enableOptimization;
+  sessionSettings.intraOpNumThreads = numThreads; // 0 lets ONNX Runtime choose the number of threads
+  sessionSettings.executionProvider = executionProvider;
+  sessionSettings.deviceId = deviceId;
 
-  mSession.reset(new Ort::Experimental::Session{*mEnv, path, sessionOptions});
+  // the session is shared with the other users of the same network in this process
+  mSession = o2::analysis::ONNXSessionRegistry::instance().getSession(o2::analysis::ONNXSessionRegistry::makeKey(path), path, sessionSettings);
 
   mInputNames = mSession->GetInputNames();
   mInputShapes = mSession->GetInputShapes();
@@ -92,7 +96,9 @@ Network::Network(std::string path,
                  uint64_t start,
                  uint64_t end,
                  bool enableOptimization = true,
-                 int numThreads = 0)
+                 int numThreads = 0,
+                 std::string executionProvider,
+                 int deviceId)
 {
 
   /*
@@ -102,20 +108,20 @@ Network::Network(std::string path,
     -- start:               uint64_t ; Timestamp validity of model (start)
     -- pathAlien:           uint64_t ; Timestamp validity of model (end)
     -- enableOptimization:  bool          ; enabling optimizations for the loaded model in the session options;
+    -- executionProvider:   std::string   ; cpu, cuda, rocm or tensorrt, falling back to the CPU if not available;
+    -- deviceId:            int           ; GPU used by the GPU execution providers;
   */
 
   LOG(info) << "--- Neural Network for the TPC PID response correction ---";
 
-  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "pid-neural-network");
-  if (enableOptimization) {
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
-  }
-  if (numThreads > 0) {
-    // Setting the number of threads, potentially try: unsigned int nThreads = std::thread::hardware_concurrency();
-    sessionOptions.SetIntraOpNumThreads(numThreads);
-  }
+  o2::analysis::ONNXSessionSettings sessionSettings;
+  sessionSettings.enableGraphOptimization = enableOptimization;
+  sessionSettings.intraOpNumThreads = numThreads; // 0 lets ONNX Runtime choose the number of threads
+  sessionSettings.executionProvider = executionProvider;
+  sessionSettings.deviceId = deviceId;
 
-  mSession.reset(new Ort::Experimental::Session{*mEnv, path, sessionOptions});
+  // the session is shared with the other users of the same network in this process
+  mSession = o2::analysis::ONNXSessionRegistry::instance().getSession(o2::analysis::ONNXSessionRegistry::makeKey(path, start, end), path, sessionSettings);
 
   mInputNames = mSession->GetInputNames();
   mInputShapes = mSession->GetInputShapes();
@@ -151,9 +157,7 @@ Network& Network::operator=(Network& inst)
     -- *this:   Network&        ; An instance with the private properties of the "inst" (input) instance;
   */
 
-  mEnv = inst.mEnv;
   mSession = inst.mSession;
-  // sessionOptions = inst.sessionOptions; // Comment (Christian): Somehow the session options throw an error when trying to copy
   mInputNames = inst.mInputNames;
   mInputShapes = inst.mInputShapes;
   mOutputNames = inst.mOutputNames;
@@ -253,4 +257,40 @@ float* Network::evalNetwork(std::vector<float> input)
 
 } // function Network::evalNetwork(std::vector<float>)
 
+void Network::evalNetwork(std::vector<float> const& input, std::vector<float>& output)
+{
+
+  /*
+ Function: Evaluating the network for a std::vector<float>, keeping the result beyond the lifetime of the output tensor
+ - Input:
+   -- input:         std::vector<float>    ; The vector which should be evaluated by the network.
+                                             The network will evaluate n inputs where n = input.size()/input_nodes with input_nodes = #(input neurons);
+   -- output:        std::vector<float>    ; The vector where the network output is copied, resized to n * output_nodes.
+                                             Its capacity is kept between calls, so it can be reused without reallocation;
+ */
+
+  int64_t size = input.size();
+  int64_t nInputs = size / mInputShapes[0][1];
+  std::vector<int64_t> input_shape{nInputs, mInputShapes[0][1]};
+  std::vector<Ort::Value> inputTensors;
+  // the tensor does not take ownership of the data, which is not modified by the inference
+  inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(const_cast<float*>(input.data()), size, input_shape));
+  output.resize(nInputs * mOutputShapes[0][1]);
+
+  try {
+
+    LOG(debug) << "Shape of input (vector): " << printShape(input_shape);
+    auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+    LOG(debug) << "Shape of output (tensor): " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+    const float* output_values = outputTensors[0].GetTensorData<float>();
+    std::copy(output_values, output_values + output.size(), output.begin());
+
+  } catch (const Ort::Exception& exception) {
+
+    LOG(error) << "Error running model inference: " << exception.what();
+    std::fill(output.begin(), output.end(), 0.f);
+  }
+
+} // function Network::evalNetwork(std::vector<float> const&, std::vector<float>&)
+
 } // namespace o2::pid::tpc
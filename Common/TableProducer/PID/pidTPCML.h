@@ -39,8 +39,8 @@ class Network
  public:
   // Constructor, destructor and copy-constructor
   Network() = default;
-  Network(std::string, bool, int);
-  Network(std::string, uint64_t, uint64_t, bool, int); // initialization with timestamps
+  Network(std::string, bool, int, std::string executionProvider = "cpu", int deviceId = 0);
+  Network(std::string, uint64_t, uint64_t, bool, int, std::string executionProvider = "cpu", int deviceId = 0); // initialization with timestamps
   ~Network() = default;
 
   // Operators
@@ -50,6 +50,7 @@ class Network
   std::vector<Ort::Value> createTensor(std::array<float, 6>) const; // create a std::vector<Ort::Value> (= ONNX tensor) for model input
   float* evalNetwork(std::vector<Ort::Value>);                      // evaluate the network on a std::vector<Ort::Value> (= ONNX tensor)
   float* evalNetwork(std::vector<float>);                           // evaluate the network on a std::vector<float>
+  void evalNetwork(std::vector<float> const&, std::vector<float>&); // evaluate the network on a std::vector<float>, copying the result in the output vector
 
   // Getters & Setters
   int getInputDimensions() const { return mInputShapes[0][1]; }
@@ -64,10 +65,8 @@ class Network
   uint64_t valid_from = 0;
   uint64_t valid_until = 0;
 
-  // Environment variables for the ONNX runtime
-  std::shared_ptr<Ort::Env> mEnv = nullptr;
+  // Session of the ONNX runtime, owned by the o2::analysis::ONNXSessionRegistry
   std::shared_ptr<Ort::Experimental::Session> mSession = nullptr;
-  Ort::SessionOptions sessionOptions;
 
   // Input & Output specifications of the loaded network
   std::vector<std::string> mInputNames;
@@ -16,7 +16,9 @@
 #include "CCDB/BasicCCDBManager.h"
 #include "CCDB/CcdbApi.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/fwdTrackUtilities.h"
 #include "Common/DataModel/TrackSelectionTables.h"
+#include "Common/DataModel/BestCollisionTables.h"
 #include "CommonConstants/GeomConstants.h"
 #include "CommonUtils/NameConf.h"
 #include "DataFormatsCalibration/MeanVertexObject.h"
@@ -36,7 +38,10 @@
 #include "Field/MagneticField.h"
 #include "TGeoGlobalMagField.h"
 
-#include "bestCollisionTable.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
 
 using SMatrix55 = ROOT::Math::SMatrix<double, 5, 5, ROOT::Math::MatRepSym<double, 5>>;
 using SMatrix5 = ROOT::Math::SVector<Double_t, 5>;
@@ -82,9 +87,43 @@ struct AmbiguousTrackPropagation {
   Configurable<std::string> mVtxPath{"mVtxPath", "GLO/Calib/MeanVertex", "Path of the mean vertex file"};
 
   Configurable<bool> produceExtra{"produceExtra", false, "Produce table with refitted track parameters"};
+  Configurable<int> maxCandidates{"maxCandidates", 0, "Maximum number of candidate vertices of an ambiguous track to propagate to, ranked by a straight-line extrapolation (0: all)"};
+  Configurable<float> candidateTolerance{"candidateTolerance", 1.f, "Only propagate to the candidate vertices whose extrapolated distance exceeds the smallest one by less than this (cm), if maxCandidates > 0"};
+
+  // extrapolated distance and index of the candidate vertices of the current ambiguous track
+  std::vector<std::pair<float, int64_t>> candidates;
 
   using ExtBCs = soa::Join<aod::BCs, aod::Timestamps, aod::MatchedBCCollisionsSparseMulti>;
 
+  // Collect the collisions of the compatible BCs of the ambiguous track, with the distance
+  // estimated by the extrapolation, and keep those to be propagated to
+  template <typename A, typename F>
+  void collectCandidates(A const& atrack, F&& distance)
+  {
+    candidates.clear();
+    auto compatibleBCs = atrack.template bc_as<ExtBCs>();
+    for (auto& bc : compatibleBCs) {
+      if (!bc.has_collisions()) {
+        continue;
+      }
+      auto collisions = bc.collisions();
+      for (auto const& collision : collisions) {
+        candidates.emplace_back(maxCandidates > 0 ? distance(collision) : 0.f, collision.globalIndex());
+      }
+    }
+    if (maxCandidates <= 0 || candidates.empty()) {
+      return;
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+    if (candidates.size() > static_cast<size_t>(maxCandidates)) {
+      candidates.resize(maxCandidates);
+    }
+    const float limit = candidates.front().first + candidateTolerance;
+    while (candidates.back().first > limit) {
+      candidates.pop_back();
+    }
+  }
+
   void init(o2::framework::InitContext& initContext)
   {
     ccdb->setURL(ccdburl);
@@ -129,7 +168,7 @@ struct AmbiguousTrackPropagation {
   using ExTracksSel = soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection>;
 
   void processCentral(ExTracksSel const&,
-                      aod::Collisions const&, ExtBCs const& bcs,
+                      aod::Collisions const& collisionsTable, ExtBCs const& bcs,
                       aod::AmbiguousTracks const& atracks)
   {
     if (bcs.size() == 0) {
@@ -160,20 +199,25 @@ struct AmbiguousTrackPropagation {
       // TPC (e.g. skipping loopers etc).
       auto trackPar = getTrackPar(track);
       if (track.x() < o2::constants::geom::XTPCInnerRef + 0.1) {
-        auto compatibleBCs = atrack.bc_as<ExtBCs>();
-        for (auto& bc : compatibleBCs) {
-          if (!bc.has_collisions()) {
-            continue;
-          }
-          auto collisions = bc.collisions();
-          for (auto const& collision : collisions) {
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackPar, 2.f, matCorr, &dcaInfo);
-            if ((std::abs(dcaInfo[0]) < std::abs(bestDCA[0])) && (std::abs(dcaInfo[1]) < std::abs(bestDCA[1]))) {
-              bestCol = collision.globalIndex();
-              bestDCA[0] = dcaInfo[0];
-              bestDCA[1] = dcaInfo[1];
-              bestTrackPar = trackPar;
-            }
+        // rank the vertices by the z distance of the straight line extrapolated to their transverse position
+        const float cosAlpha = std::cos(trackPar.getAlpha());
+        const float sinAlpha = std::sin(trackPar.getAlpha());
+        const float snp = trackPar.getSnp();
+        const float csp = std::sqrt((1.f - snp) * (1.f + snp));
+        collectCandidates(atrack, [&](auto const& collision) {
+          const float xv = collision.posX() * cosAlpha + collision.posY() * sinAlpha;
+          const float yv = -collision.posX() * sinAlpha + collision.posY() * cosAlpha;
+          const float pathXY = (xv - trackPar.getX()) * csp + (yv - trackPar.getY()) * snp;
+          return std::abs(trackPar.getZ() + trackPar.getTgl() * pathXY - collision.posZ());
+        });
+        for (auto const& candidate : candidates) {
+          auto collision = collisionsTable.iteratorAt(candidate.second);
+          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackPar, 2.f, matCorr, &dcaInfo);
+          if ((std::abs(dcaInfo[0]) < std::abs(bestDCA[0])) && (std::abs(dcaInfo[1]) < std::abs(bestDCA[1]))) {
+            bestCol = collision.globalIndex();
+            bestDCA[0] = dcaInfo[0];
+            bestDCA[1] = dcaInfo[1];
+            bestTrackPar = trackPar;
           }
         }
       }
@@ -189,7 +233,7 @@ struct AmbiguousTrackPropagation {
   PROCESS_SWITCH(AmbiguousTrackPropagation, processCentral, "Fill ReassignedTracks for central ambiguous tracks", true);
 
   void processMFT(aod::MFTTracks const&,
-                  aod::Collisions const&, ExtBCs const& bcs,
+                  aod::Collisions const& collisionsTable, ExtBCs const& bcs,
                   aod::AmbiguousMFTTracks const& atracks)
   {
 
@@ -218,25 +262,24 @@ struct AmbiguousTrackPropagation {
       SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
       o2::track::TrackParCovFwd trackPar{track.z(), tpars, tcovs, track.chi2()};
 
-      auto compatibleBCs = atrack.bc_as<ExtBCs>();
-      for (auto& bc : compatibleBCs) {
-        if (!bc.has_collisions()) {
-          continue;
-        }
-        auto collisions = bc.collisions();
-        for (auto const& collision : collisions) {
+      // rank the vertices by the transverse distance of the straight line extrapolated to their z
+      const auto line = o2::analysis::fwd::LinearFwdTrack::fromTrack(track);
+      collectCandidates(atrack, [&](auto const& collision) {
+        return o2::analysis::fwd::getDCAXY(line, collision.posX(), collision.posY(), collision.posZ());
+      });
+      for (auto const& candidate : candidates) {
+        auto collision = collisionsTable.iteratorAt(candidate.second);
 
-          trackPar.propagateToZhelix(collision.posZ(), Bz); // track parameters propagation to the position of the z vertex
+        trackPar.propagateToZhelix(collision.posZ(), Bz); // track parameters propagation to the position of the z vertex
 
-          const auto dcaX(trackPar.getX() - collision.posX());
-          const auto dcaY(trackPar.getY() - collision.posY());
-          dcaInfo = std::sqrt(dcaX * dcaX + dcaY * dcaY);
+        const auto dcaX(trackPar.getX() - collision.posX());
+        const auto dcaY(trackPar.getY() - collision.posY());
+        dcaInfo = std::sqrt(dcaX * dcaX + dcaY * dcaY);
 
-          if ((dcaInfo < bestDCA)) {
-            bestCol = collision.globalIndex();
-            bestDCA = dcaInfo;
-            bestTrackPar = trackPar;
-          }
+        if ((dcaInfo < bestDCA)) {
+          bestCol = collision.globalIndex();
+          bestDCA = dcaInfo;
+          bestTrackPar = trackPar;
         }
       }
 
@@ -257,6 +300,6 @@ struct AmbiguousTrackPropagation {
 //****************************************************************************************
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
-  WorkflowSpec workflow{adaptAnalysisTask<AmbiguousTrackPropagation>(cfgc)};
+  WorkflowSpec workflow{adaptAnalysisTask<AmbiguousTrackPropagation>(cfgc, TaskName{"ambiguous-track-propagation"})};
   return workflow;
 }
@@ -0,0 +1,124 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   bcFITActivity.cxx
+/// \brief  Task producing per BC the collision index and the FIT past-future patterns of the neighbouring BCs
+///
+/// The beam-beam and beam-gas flags of BcSels are packed once per BC, then the patterns over
+/// [globalBC - 15, globalBC + 15] are obtained with one sliding window over the BCs, which are ordered in
+/// globalBC. The consumers (e.g. the UD candidate producers) read the patterns of a BC directly instead of
+/// selecting the BCs of the window for each candidate.
+///
+/// Usage:
+///   using BCs = soa::Join<aod::BCs, aod::BcSels, aod::BcFITActivities>;
+///   auto bc = collision.bc_as<BCs>();
+///   bool hasBGFT0A = bc.bgFT0Apf() != 0;
+///
+
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+#include "Common/DataModel/BcFITActivity.h"
+#include "Common/DataModel/EventSelection.h"
+
+#include <array>
+#include <vector>
+
+using namespace o2;
+using namespace o2::framework;
+
+using BCsWithBcSels = soa::Join<aod::BCs, aod::BcSels>;
+
+struct BcFITActivity {
+  Produces<aod::BcFITActivities> bcFITActivities;
+
+  // flags of BcSels packed in the patterns, in the order of the columns
+  enum Flags {
+    kBBFT0A = 0,
+    kBBFT0C,
+    kBGFT0A,
+    kBGFT0C,
+    kBBFV0A,
+    kBGFV0A,
+    kBBFDDA,
+    kBBFDDC,
+    kBGFDDA,
+    kBGFDDC,
+    kNFlags
+  };
+
+  std::vector<uint64_t> globalBCs;
+  std::vector<uint16_t> flags;
+  std::vector<int32_t> collisionIds;
+
+  void process(BCsWithBcSels const& bcs, aod::Collisions const& collisions)
+  {
+    const int64_t nBCs = bcs.size();
+    globalBCs.resize(nBCs);
+    flags.resize(nBCs);
+    for (const auto& bc : bcs) {
+      const auto i = bc.globalIndex();
+      globalBCs[i] = bc.globalBC();
+      uint16_t bcFlags = 0;
+      auto setFlag = [&bcFlags](bool condition, int flag) { bcFlags |= condition << flag; };
+      setFlag(bc.selection()[evsel::kIsBBT0A], kBBFT0A);
+      setFlag(bc.selection()[evsel::kIsBBT0C], kBBFT0C);
+      setFlag(!bc.selection()[evsel::kNoBGT0A], kBGFT0A);
+      setFlag(!bc.selection()[evsel::kNoBGT0C], kBGFT0C);
+      setFlag(bc.selection()[evsel::kIsBBV0A], kBBFV0A);
+      setFlag(!bc.selection()[evsel::kNoBGV0A], kBGFV0A);
+      setFlag(bc.selection()[evsel::kIsBBFDA], kBBFDDA);
+      setFlag(bc.selection()[evsel::kIsBBFDC], kBBFDDC);
+      setFlag(!bc.selection()[evsel::kNoBGFDA], kBGFDDA);
+      setFlag(!bc.selection()[evsel::kNoBGFDC], kBGFDDC);
+      flags[i] = bcFlags;
+    }
+
+    collisionIds.assign(nBCs, -1);
+    for (const auto& collision : collisions) {
+      const auto bcId = collision.bcId();
+      if (bcId >= 0 && bcId < nBCs && collisionIds[bcId] < 0) {
+        collisionIds[bcId] = collision.globalIndex();
+      }
+    }
+
+    constexpr int64_t nAround = aod::bcfitactivity::nBCsAround;
+    bcFITActivities.reserve(nBCs);
+    int64_t first = 0; // first BC of the window
+    for (int64_t i = 0; i < nBCs; i++) {
+      while (globalBCs[first] + nAround < globalBCs[i]) {
+        first++;
+      }
+      std::array<int32_t, kNFlags> patterns{0};
+      for (int64_t j = first; j < nBCs && globalBCs[j] <= globalBCs[i] + nAround; j++) {
+        if (flags[j] == 0) {
+          continue;
+        }
+        const int bit = static_cast<int>(globalBCs[j] + nAround - globalBCs[i]);
+        for (int flag = 0; flag < kNFlags; flag++) {
+          if (flags[j] & (1 << flag)) {
+            patterns[flag] |= 1 << bit;
+          }
+        }
+      }
+      bcFITActivities(collisionIds[i],
+                      patterns[kBBFT0A], patterns[kBBFT0C], patterns[kBGFT0A], patterns[kBGFT0C],
+                      patterns[kBBFV0A], patterns[kBGFV0A],
+                      patterns[kBBFDDA], patterns[kBBFDDC], patterns[kBGFDDA], patterns[kBGFDDC]);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<BcFITActivity>(cfgc, TaskName{"bc-fit-activity"})};
+}
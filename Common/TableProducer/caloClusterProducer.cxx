@@ -47,6 +47,9 @@ struct caloClusterProducerTask {
   std::vector<o2::phos::Cluster> outputPHOSClusters;
   std::vector<o2::phos::TriggerRecord> outputPHOSClusterTrigRecs;
 
+  // run for which the bad map and calibration are set in the clusterizer
+  int mPHOSCalibRun = -1;
+
   void init(o2::framework::InitContext&)
   {
     ccdb->setURL(o2::base::NameConf::getCCDBServer());
@@ -77,18 +80,22 @@ struct caloClusterProducerTask {
       // clusterize
       // Fill output table
 
-      // calibration may be updated by CCDB fetcher
-      const o2::phos::BadChannelsMap* badMap = ccdb->get<o2::phos::BadChannelsMap>("PHS/Calib/BadMap");
-      const o2::phos::CalibParams* calibParams = ccdb->get<o2::phos::CalibParams>("PHS/Calib/CalibParams");
-      if (badMap) {
-        clusterizerPHOS->setBadMap(badMap);
-      } else {
-        LOG(fatal) << "Can not get PHOS Bad Map";
-      }
-      if (calibParams) {
-        clusterizerPHOS->setCalibration(calibParams);
-      } else {
-        LOG(fatal) << "Can not get PHOS calibration";
+      // calibration may be updated by CCDB fetcher, it is set in the clusterizer once per run
+      const int runNumber = bcs.size() > 0 ? bcs.begin().runNumber() : mPHOSCalibRun;
+      if (runNumber != mPHOSCalibRun || mPHOSCalibRun < 0) {
+        const o2::phos::BadChannelsMap* badMap = ccdb->get<o2::phos::BadChannelsMap>("PHS/Calib/BadMap");
+        const o2::phos::CalibParams* calibParams = ccdb->get<o2::phos::CalibParams>("PHS/Calib/CalibParams");
+        if (badMap) {
+          clusterizerPHOS->setBadMap(badMap);
+        } else {
+          LOG(fatal) << "Can not get PHOS Bad Map";
+        }
+        if (calibParams) {
+          clusterizerPHOS->setCalibration(calibParams);
+        } else {
+          LOG(fatal) << "Can not get PHOS calibration";
+        }
+        mPHOSCalibRun = runNumber;
       }
 
       phosCells.clear();
@@ -100,18 +107,24 @@ struct caloClusterProducerTask {
       outputPHOSClusterTrigRecs.clear();
 
       o2::InteractionRecord ir;
+      int64_t lastBCId = -1;
+      uint64_t globalBC = 0;
       for (auto& c : cells) {
         if (c.caloType() != kPHOS) // PHOS
           continue;
+        if (c.bcId() != lastBCId) { // the cells are grouped by BC, look up the global BC only once per BC
+          lastBCId = c.bcId();
+          globalBC = c.bc().globalBC();
+        }
         if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-          ir.setFromLong(c.bc().globalBC());
+          ir.setFromLong(globalBC);
           phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
         }
-        if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc().globalBC()) { // switch to new BC
+        if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != globalBC) { // switch to new BC
           // switch to another BC: set size and create next TriRec
           phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
           // Next event/trig rec.
-          ir.setFromLong(c.bc().globalBC());
+          ir.setFromLong(globalBC);
           phosCellTRs.emplace_back(ir, phosCells.size(), 0);
         }
         phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
@@ -136,11 +149,13 @@ struct caloClusterProducerTask {
       }
 
       // Fill output
+      clusters.reserve(outputPHOSClusters.size());
       for (auto& cluTR : outputPHOSClusterTrigRecs) {
         int firstClusterInEvent = cluTR.getFirstEntry();
         int lastClusterInEvent = firstClusterInEvent + cluTR.getNumberOfObjects();
         // find collision corresponding to current BC
-        auto clvtx = colls.begin() + (bcMap[cluTR.getBCData().toLong()]);
+        const int clusterCollId = bcMap[cluTR.getBCData().toLong()];
+        auto clvtx = colls.begin() + clusterCollId;
 
         // Extract primary vertex
         TVector3 vtx = {clvtx.posX(), clvtx.posY(), clvtx.posZ()};
@@ -181,7 +196,7 @@ struct caloClusterProducerTask {
           float lambdaShort = 0., lambdaLong = 0.;
           clu.getElipsAxis(lambdaShort, lambdaLong);
 
-          clusters(bcMap[cluTR.getBCData().toLong()], kPHOS, mom.X(), mom.Y(), mom.Z(), e,
+          clusters(clusterCollId, kPHOS, mom.X(), mom.Y(), mom.Z(), e,
                    mod, clu.getMultiplicity(), globaPos.X(), globaPos.Y(), globaPos.Z(),
                    clu.getTime(), clu.getNExMax(), lambdaShort, lambdaLong, trackdist, trackindex,
                    clu.firedTrigger(), clu.getDistanceToBadChannel());
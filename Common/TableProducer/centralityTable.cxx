@@ -21,10 +21,57 @@
 #include <CCDB/BasicCCDBManager.h>
 #include <TH1F.h>
 #include <TFormula.h>
+#include <algorithm>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
 
+/// Flat copy of a calibration histogram, built once per run
+///
+/// get(x) returns the same as GetBinContent(FindFixBin(x)) of the histogram: the bin is computed directly for a uniform
+/// binning and with a binary search over the sorted edges otherwise, the underflow and overflow bins included.
+struct CalibrationLUT {
+  bool mUniform = true;
+  int mNBins = 0;
+  double mXMin = 0.;
+  double mXMax = 0.;
+  std::vector<double> mEdges;    ///< bin edges, for a variable binning only
+  std::vector<double> mContents; ///< bin contents, from the underflow to the overflow bin
+
+  void set(TH1* h)
+  {
+    const TAxis* axis = h->GetXaxis();
+    mNBins = axis->GetNbins();
+    mXMin = axis->GetXmin();
+    mXMax = axis->GetXmax();
+    mUniform = axis->GetXbins()->GetSize() == 0;
+    mEdges.clear();
+    if (!mUniform) {
+      mEdges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + mNBins + 1);
+    }
+    mContents.resize(mNBins + 2);
+    for (int iBin = 0; iBin < mNBins + 2; iBin++) {
+      mContents[iBin] = h->GetBinContent(iBin);
+    }
+  }
+
+  double get(double x) const
+  {
+    int bin;
+    if (x < mXMin) {
+      bin = 0;
+    } else if (!(x < mXMax)) {
+      bin = mNBins + 1;
+    } else if (mUniform) {
+      bin = 1 + int(mNBins * (x - mXMin) / (mXMax - mXMin));
+    } else {
+      bin = std::upper_bound(mEdges.begin(), mEdges.end(), x) - mEdges.begin();
+    }
+    return mContents[bin];
+  }
+};
+
 struct CentralityTable {
   Produces<aod::CentRun2V0Ms> centRun2V0M;
   Produces<aod::CentRun2SPDTrks> centRun2SPDTracklets;
@@ -58,27 +105,39 @@ struct CentralityTable {
     TH1* mhVtxAmpCorrV0A = nullptr;
     TH1* mhVtxAmpCorrV0C = nullptr;
     TH1* mhMultSelCalib = nullptr;
+    CalibrationLUT mLutVtxAmpCorrV0A;
+    CalibrationLUT mLutVtxAmpCorrV0C;
+    CalibrationLUT mLutMultSelCalib;
   } Run2V0MInfo;
   struct tagRun2SPDTrackletsCalibration {
     bool mCalibrationStored = false;
     TH1* mhVtxAmpCorr = nullptr;
     TH1* mhMultSelCalib = nullptr;
+    CalibrationLUT mLutVtxAmpCorr;
+    CalibrationLUT mLutMultSelCalib;
   } Run2SPDTksInfo;
   struct tagRun2SPDClustersCalibration {
     bool mCalibrationStored = false;
     TH1* mhVtxAmpCorrCL0 = nullptr;
     TH1* mhVtxAmpCorrCL1 = nullptr;
     TH1* mhMultSelCalib = nullptr;
+    CalibrationLUT mLutVtxAmpCorrCL0;
+    CalibrationLUT mLutVtxAmpCorrCL1;
+    CalibrationLUT mLutMultSelCalib;
   } Run2SPDClsInfo;
   struct tagRun2CL0Calibration {
     bool mCalibrationStored = false;
     TH1* mhVtxAmpCorr = nullptr;
     TH1* mhMultSelCalib = nullptr;
+    CalibrationLUT mLutVtxAmpCorr;
+    CalibrationLUT mLutMultSelCalib;
   } Run2CL0Info;
   struct tagRun2CL1Calibration {
     bool mCalibrationStored = false;
     TH1* mhVtxAmpCorr = nullptr;
     TH1* mhMultSelCalib = nullptr;
+    CalibrationLUT mLutVtxAmpCorr;
+    CalibrationLUT mLutMultSelCalib;
   } Run2CL1Info;
   struct calibrationInfo {
     std::string name = "";
@@ -86,6 +145,7 @@ struct CentralityTable {
     TH1* mhMultSelCalib = nullptr;
     float mMCScalePars[6] = {0.0};
     TFormula* mMCScale = nullptr;
+    CalibrationLUT mLutMultSelCalib;
     calibrationInfo(std::string name)
       : name(name),
         mCalibrationStored(false),
@@ -184,6 +244,9 @@ struct CentralityTable {
                 LOGF(fatal, "MC Scale information from V0M for run %d not available", bc.runNumber());
               }
             }
+            Run2V0MInfo.mLutVtxAmpCorrV0A.set(Run2V0MInfo.mhVtxAmpCorrV0A);
+            Run2V0MInfo.mLutVtxAmpCorrV0C.set(Run2V0MInfo.mhVtxAmpCorrV0C);
+            Run2V0MInfo.mLutMultSelCalib.set(Run2V0MInfo.mhMultSelCalib);
             Run2V0MInfo.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from V0M for run %d corrupted", bc.runNumber());
@@ -194,6 +257,8 @@ struct CentralityTable {
           Run2SPDTksInfo.mhVtxAmpCorr = getccdb("hVtx_fnTracklets_Normalized");
           Run2SPDTksInfo.mhMultSelCalib = getccdb("hMultSelCalib_SPDTracklets");
           if ((Run2SPDTksInfo.mhVtxAmpCorr != nullptr) and (Run2SPDTksInfo.mhMultSelCalib != nullptr)) {
+            Run2SPDTksInfo.mLutVtxAmpCorr.set(Run2SPDTksInfo.mhVtxAmpCorr);
+            Run2SPDTksInfo.mLutMultSelCalib.set(Run2SPDTksInfo.mhMultSelCalib);
             Run2SPDTksInfo.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from SPD tracklets for run %d corrupted", bc.runNumber());
@@ -205,6 +270,9 @@ struct CentralityTable {
           Run2SPDClsInfo.mhVtxAmpCorrCL1 = getccdb("hVtx_fnSPDClusters1_Normalized");
           Run2SPDClsInfo.mhMultSelCalib = getccdb("hMultSelCalib_SPDClusters");
           if ((Run2SPDClsInfo.mhVtxAmpCorrCL0 != nullptr) and (Run2SPDClsInfo.mhVtxAmpCorrCL1 != nullptr) and (Run2SPDClsInfo.mhMultSelCalib != nullptr)) {
+            Run2SPDClsInfo.mLutVtxAmpCorrCL0.set(Run2SPDClsInfo.mhVtxAmpCorrCL0);
+            Run2SPDClsInfo.mLutVtxAmpCorrCL1.set(Run2SPDClsInfo.mhVtxAmpCorrCL1);
+            Run2SPDClsInfo.mLutMultSelCalib.set(Run2SPDClsInfo.mhMultSelCalib);
             Run2SPDClsInfo.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from SPD clusters for run %d corrupted", bc.runNumber());
@@ -215,6 +283,8 @@ struct CentralityTable {
           Run2CL0Info.mhVtxAmpCorr = getccdb("hVtx_fnSPDClusters0_Normalized");
           Run2CL0Info.mhMultSelCalib = getccdb("hMultSelCalib_CL0");
           if ((Run2CL0Info.mhVtxAmpCorr != nullptr) and (Run2CL0Info.mhMultSelCalib != nullptr)) {
+            Run2CL0Info.mLutVtxAmpCorr.set(Run2CL0Info.mhVtxAmpCorr);
+            Run2CL0Info.mLutMultSelCalib.set(Run2CL0Info.mhMultSelCalib);
             Run2CL0Info.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from CL0 multiplicity for run %d corrupted", bc.runNumber());
@@ -225,6 +295,8 @@ struct CentralityTable {
           Run2CL1Info.mhVtxAmpCorr = getccdb("hVtx_fnSPDClusters1_Normalized");
           Run2CL1Info.mhMultSelCalib = getccdb("hMultSelCalib_CL1");
           if ((Run2CL1Info.mhVtxAmpCorr != nullptr) and (Run2CL1Info.mhMultSelCalib != nullptr)) {
+            Run2CL1Info.mLutVtxAmpCorr.set(Run2CL1Info.mhVtxAmpCorr);
+            Run2CL1Info.mLutMultSelCalib.set(Run2CL1Info.mhMultSelCalib);
             Run2CL1Info.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from CL1 multiplicity for run %d corrupted", bc.runNumber());
@@ -250,10 +322,10 @@ struct CentralityTable {
           v0m = scaleMC(collision.multFV0M(), Run2V0MInfo.mMCScalePars);
           LOGF(debug, "Unscaled v0m: %f, scaled v0m: %f", collision.multFV0M(), v0m);
         } else {
-          v0m = collision.multFV0A() * Run2V0MInfo.mhVtxAmpCorrV0A->GetBinContent(Run2V0MInfo.mhVtxAmpCorrV0A->FindFixBin(collision.posZ())) +
-                collision.multFV0C() * Run2V0MInfo.mhVtxAmpCorrV0C->GetBinContent(Run2V0MInfo.mhVtxAmpCorrV0C->FindFixBin(collision.posZ()));
+          v0m = collision.multFV0A() * Run2V0MInfo.mLutVtxAmpCorrV0A.get(collision.posZ()) +
+                collision.multFV0C() * Run2V0MInfo.mLutVtxAmpCorrV0C.get(collision.posZ());
         }
-        cV0M = Run2V0MInfo.mhMultSelCalib->GetBinContent(Run2V0MInfo.mhMultSelCalib->FindFixBin(v0m));
+        cV0M = Run2V0MInfo.mLutMultSelCalib.get(v0m);
       }
       LOGF(debug, "centRun2V0M=%.0f", cV0M);
       // fill centrality columns
@@ -262,8 +334,8 @@ struct CentralityTable {
     if (estRun2SPDTrklets == 1) {
       float cSPD = 105.0f;
       if (Run2SPDTksInfo.mCalibrationStored) {
-        float spdm = collision.multTracklets() * Run2SPDTksInfo.mhVtxAmpCorr->GetBinContent(Run2SPDTksInfo.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cSPD = Run2SPDTksInfo.mhMultSelCalib->GetBinContent(Run2SPDTksInfo.mhMultSelCalib->FindFixBin(spdm));
+        float spdm = collision.multTracklets() * Run2SPDTksInfo.mLutVtxAmpCorr.get(collision.posZ());
+        cSPD = Run2SPDTksInfo.mLutMultSelCalib.get(spdm);
       }
       LOGF(debug, "centSPDTracklets=%.0f", cSPD);
       centRun2SPDTracklets(cSPD);
@@ -271,9 +343,9 @@ struct CentralityTable {
     if (estRun2SPDClusters == 1) {
       float cSPD = 105.0f;
       if (Run2SPDClsInfo.mCalibrationStored) {
-        float spdm = bc.spdClustersL0() * Run2SPDClsInfo.mhVtxAmpCorrCL0->GetBinContent(Run2SPDClsInfo.mhVtxAmpCorrCL0->FindFixBin(collision.posZ())) +
-                     bc.spdClustersL1() * Run2SPDClsInfo.mhVtxAmpCorrCL1->GetBinContent(Run2SPDClsInfo.mhVtxAmpCorrCL1->FindFixBin(collision.posZ()));
-        cSPD = Run2SPDClsInfo.mhMultSelCalib->GetBinContent(Run2SPDClsInfo.mhMultSelCalib->FindFixBin(spdm));
+        float spdm = bc.spdClustersL0() * Run2SPDClsInfo.mLutVtxAmpCorrCL0.get(collision.posZ()) +
+                     bc.spdClustersL1() * Run2SPDClsInfo.mLutVtxAmpCorrCL1.get(collision.posZ());
+        cSPD = Run2SPDClsInfo.mLutMultSelCalib.get(spdm);
       }
       LOGF(debug, "centSPDClusters=%.0f", cSPD);
       centRun2SPDClusters(cSPD);
@@ -281,8 +353,8 @@ struct CentralityTable {
     if (estRun2CL0 == 1) {
       float cCL0 = 105.0f;
       if (Run2CL0Info.mCalibrationStored) {
-        float cl0m = bc.spdClustersL0() * Run2CL0Info.mhVtxAmpCorr->GetBinContent(Run2CL0Info.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cCL0 = Run2CL0Info.mhMultSelCalib->GetBinContent(Run2CL0Info.mhMultSelCalib->FindFixBin(cl0m));
+        float cl0m = bc.spdClustersL0() * Run2CL0Info.mLutVtxAmpCorr.get(collision.posZ());
+        cCL0 = Run2CL0Info.mLutMultSelCalib.get(cl0m);
       }
       LOGF(debug, "centCL0=%.0f", cCL0);
       centRun2CL0(cCL0);
@@ -290,8 +362,8 @@ struct CentralityTable {
     if (estRun2CL1 == 1) {
       float cCL1 = 105.0f;
       if (Run2CL1Info.mCalibrationStored) {
-        float cl1m = bc.spdClustersL1() * Run2CL1Info.mhVtxAmpCorr->GetBinContent(Run2CL1Info.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cCL1 = Run2CL1Info.mhMultSelCalib->GetBinContent(Run2CL1Info.mhMultSelCalib->FindFixBin(cl1m));
+        float cl1m = bc.spdClustersL1() * Run2CL1Info.mLutVtxAmpCorr.get(collision.posZ());
+        cCL1 = Run2CL1Info.mLutMultSelCalib.get(cl1m);
       }
       LOGF(debug, "centCL1=%.0f", cCL1);
       centRun2CL1(cCL1);
@@ -328,6 +400,7 @@ struct CentralityTable {
                 LOGF(warning, "MC Scale information from %s for run %d not available", estimator.name.c_str(), bc.runNumber());
               }
             }
+            estimator.mLutMultSelCalib.set(estimator.mhMultSelCalib);
             estimator.mCalibrationStored = true;
           } else {
             LOGF(error, "Calibration information from %s for run %d not available", estimator.name.c_str(), bc.runNumber());
@@ -363,7 +436,7 @@ struct CentralityTable {
           scaledMultiplicity = scaleMC(multiplicity, estimator.mMCScalePars);
           LOGF(debug, "Unscaled %s multiplicity: %f, scaled %s multiplicity: %f", estimator.name.c_str(), multiplicity, estimator.name.c_str(), scaledMultiplicity);
         }
-        percentile = estimator.mhMultSelCalib->GetBinContent(estimator.mhMultSelCalib->FindFixBin(scaledMultiplicity));
+        percentile = estimator.mLutMultSelCalib.get(scaledMultiplicity);
       }
       LOGF(debug, "%s centrality/multiplicity percentile = %.0f for a zvtx eq %s value %.0f", estimator.name.c_str(), percentile, estimator.name.c_str(), scaledMultiplicity);
       table(percentile);
@@ -20,19 +20,92 @@ using namespace o2::framework;
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/TriggerAliases.h"
 #include "CCDB/BasicCCDBManager.h"
+#include "CCDB/CcdbApi.h"
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/HistogramRegistry.h"
 #include "DataFormatsFT0/Digit.h"
 #include "TH1F.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 using namespace evsel;
 
 using BCsWithRun2InfosTimestampsAndMatches = soa::Join<aod::BCs, aod::Run2BCInfos, aod::Timestamps, aod::Run2MatchedToBCSparse>;
 using BCsWithRun3Matchings = soa::Join<aod::BCs, aod::Timestamps, aod::Run3MatchedToBCSparse>;
 using BCsWithBcSels = soa::Join<aod::BCs, aod::Timestamps, aod::BcSels>;
 
+/// Event selection conditions of the current run
+///
+/// The parameters and the trigger aliases are fetched when the run changes or the timestamp leaves the
+/// validity interval of the fetched objects, and the alias-to-trigger-mask maps are flattened once,
+/// so that the loops over BCs and collisions only do bit operations.
+struct EvSelConditions {
+  int run = -1;                                                ///< run of the cached objects
+  uint64_t validFrom = 0;                                      ///< start of the common validity of the cached objects (ms)
+  uint64_t validUntil = 0;                                     ///< end of the common validity of the cached objects (ms)
+  EventSelectionParams* par = nullptr;                         ///< event selection parameters
+  std::vector<std::pair<uint32_t, uint64_t>> aliasMasks;       ///< alias and trigger mask of the first 50 classes
+  std::vector<std::pair<uint32_t, uint64_t>> aliasMasksNext50; ///< alias and trigger mask of the next 50 classes
+
+  bool isValid(int runNumber, uint64_t timestamp) const
+  {
+    return runNumber == run && timestamp >= validFrom && timestamp < validUntil;
+  }
+
+  /// Fetches the conditions valid for the given run and timestamp
+  /// \param withAliases  also fetch the trigger aliases (Run 2 only)
+  void update(o2::ccdb::BasicCCDBManager& ccdb, o2::ccdb::CcdbApi const& ccdbApi, int runNumber, uint64_t timestamp, bool withAliases)
+  {
+    run = runNumber;
+    validFrom = 0;
+    validUntil = std::numeric_limits<uint64_t>::max();
+    par = ccdb.getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", timestamp);
+    restrictValidity(ccdbApi, "EventSelection/EventSelectionParams", timestamp);
+    aliasMasks.clear();
+    aliasMasksNext50.clear();
+    if (withAliases) {
+      TriggerAliases* aliases = ccdb.getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", timestamp);
+      restrictValidity(ccdbApi, "EventSelection/TriggerAliases", timestamp);
+      aliasMasks.assign(aliases->GetAliasToTriggerMaskMap().begin(), aliases->GetAliasToTriggerMaskMap().end());
+      aliasMasksNext50.assign(aliases->GetAliasToTriggerMaskNext50Map().begin(), aliases->GetAliasToTriggerMaskNext50Map().end());
+    }
+    LOGP(info, "Event selection conditions for run {} valid in [{}, {})", run, validFrom, validUntil);
+  }
+
+  /// Fills the fired aliases from the trigger masks of a BC
+  void fillAliases(uint64_t triggerMask, uint64_t triggerMaskNext50, int32_t* alias) const
+  {
+    for (auto& al : aliasMasks) {
+      alias[al.first] |= (triggerMask & al.second) > 0;
+    }
+    for (auto& al : aliasMasksNext50) {
+      alias[al.first] |= (triggerMaskNext50 & al.second) > 0;
+    }
+  }
+
+ private:
+  /// Restricts the validity to the one of the object at path, the run number alone is used if the headers are not available
+  void restrictValidity(o2::ccdb::CcdbApi const& ccdbApi, std::string const& path, uint64_t timestamp)
+  {
+    std::map<std::string, std::string> metadata;
+    std::map<std::string, std::string> headers = ccdbApi.retrieveHeaders(path, metadata, timestamp);
+    if (headers.count("Valid-From") == 0 || headers.count("Valid-Until") == 0) {
+      LOGP(warning, "Validity of {} not found in the headers, caching it for the whole run {}", path, run);
+      return;
+    }
+    validFrom = std::max<uint64_t>(validFrom, strtoull(headers["Valid-From"].c_str(), NULL, 0));
+    validUntil = std::min<uint64_t>(validUntil, strtoull(headers["Valid-Until"].c_str(), NULL, 0));
+  }
+};
+
 struct BcSelectionTask {
   Produces<aod::BcSels> bcsel;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
+  o2::ccdb::CcdbApi ccdbApi;
+  EvSelConditions conditions;
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   void init(InitContext&)
@@ -41,6 +114,7 @@ struct BcSelectionTask {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
+    ccdbApi.init("http://alice-ccdb.cern.ch");
 
     histos.add("hCounterTVX", "", kTH1F, {{1, 0., 1.}});
   }
@@ -55,18 +129,13 @@ struct BcSelectionTask {
   {
 
     for (auto& bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      if (!conditions.isValid(bc.runNumber(), bc.timestamp())) {
+        conditions.update(*ccdb, ccdbApi, bc.runNumber(), bc.timestamp(), true);
+      }
+      EventSelectionParams* par = conditions.par;
       // fill fired aliases
       int32_t alias[kNaliases] = {0};
-      uint64_t triggerMask = bc.triggerMask();
-      for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
-        alias[al.first] |= (triggerMask & al.second) > 0;
-      }
-      uint64_t triggerMaskNext50 = bc.triggerMaskNext50();
-      for (auto& al : aliases->GetAliasToTriggerMaskNext50Map()) {
-        alias[al.first] |= (triggerMaskNext50 & al.second) > 0;
-      }
+      conditions.fillAliases(bc.triggerMask(), bc.triggerMaskNext50(), alias);
       alias[kALL] = 1;
 
       // get timing info from ZDC, FV0, FT0 and FDD
@@ -190,7 +259,10 @@ struct BcSelectionTask {
                    aod::FDDs const&)
   {
     for (auto bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
+      if (!conditions.isValid(bc.runNumber(), bc.timestamp())) {
+        conditions.update(*ccdb, ccdbApi, bc.runNumber(), bc.timestamp(), false);
+      }
+      EventSelectionParams* par = conditions.par;
 
       // TODO: fill fired aliases for run3
       int32_t alias[kNaliases] = {0};
@@ -311,6 +383,8 @@ struct EventSelectionTask {
   Partition<aod::Tracks> tracklets = (aod::track::trackType == static_cast<uint8_t>(o2::aod::track::TrackTypeEnum::Run2Tracklet));
 
   Service<o2::ccdb::BasicCCDBManager> ccdb;
+  o2::ccdb::CcdbApi ccdbApi;
+  EvSelConditions conditions;
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   void init(InitContext&)
@@ -319,6 +393,7 @@ struct EventSelectionTask {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
+    ccdbApi.init("http://alice-ccdb.cern.ch");
 
     histos.add("hColCounterAll", "", kTH1F, {{1, 0., 1.}});
     histos.add("hColCounterAcc", "", kTH1F, {{1, 0., 1.}});
@@ -327,7 +402,10 @@ struct EventSelectionTask {
   void processRun2(aod::Collision const& col, BCsWithBcSels const& bcs, aod::Tracks const& tracks)
   {
     auto bc = col.bc_as<BCsWithBcSels>();
-    EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
+    if (!conditions.isValid(bc.runNumber(), bc.timestamp())) {
+      conditions.update(*ccdb, ccdbApi, bc.runNumber(), bc.timestamp(), false);
+    }
+    EventSelectionParams* par = conditions.par;
     bool* applySelection = par->GetSelection(muonSelection);
     if (isMC) {
       applySelection[kIsBBZAC] = 0;
@@ -22,16 +22,19 @@ struct FddConverter {
 
   void process(aod::FDDs_000 const& fdd_000)
   {
+    fdd_001.reserve(fdd_000.size());
     for (auto& p : fdd_000) {
       int16_t chargeA[8] = {0u};
       int16_t chargeC[8] = {0u};
 
+      auto amplitudeA = p.amplitudeA();
+      auto amplitudeC = p.amplitudeC();
       for (int i = 0; i < 4; i++) {
-        chargeA[i] = p.amplitudeA()[i];
-        chargeA[i + 4] = p.amplitudeA()[i];
+        chargeA[i] = amplitudeA[i];
+        chargeA[i + 4] = amplitudeA[i];
 
-        chargeC[i] = p.amplitudeC()[i];
-        chargeC[i + 4] = p.amplitudeC()[i];
+        chargeC[i] = amplitudeC[i];
+        chargeC[i + 4] = amplitudeC[i];
       }
 
       fdd_001(p.bcId(), chargeA, chargeC,
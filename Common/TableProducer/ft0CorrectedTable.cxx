@@ -21,7 +21,7 @@ using namespace o2::framework;
 #include "CommonConstants/PhysicsConstants.h"
 #include "Common/DataModel/FT0Corrected.h"
 #include "DataFormatsFT0/Digit.h"
-#include <bitset>
+#include <vector>
 
 using namespace o2::aod;
 struct FT0CorrectedTable {
@@ -29,29 +29,53 @@ struct FT0CorrectedTable {
   using BCsWithMatchings = soa::Join<aod::BCs, aod::Run3MatchedToBCSparse>;
   using CollisionEvSel = soa::Join<aod::Collisions, aod::EvSels>::iterator;
 
+  // Columns gathered once per dataframe: the FT0 times and triggers of each collision are looked up
+  // through the foundFT0 index in a first pass, then all the corrected times are computed in one
+  // branch-free loop over contiguous arrays, which the compiler vectorises
+  std::vector<float> timeA;
+  std::vector<float> timeC;
+  std::vector<uint8_t> triggers;
+  std::vector<float> posZ;
+  std::vector<float> t0A;
+  std::vector<float> t0C;
+
   void process(BCsWithMatchings const& bcs, soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::FT0s const& ft0s)
   {
+    const std::size_t nCollisions = collisions.size();
+    for (auto* v : {&timeA, &timeC, &posZ, &t0A, &t0C}) {
+      v->resize(nCollisions);
+    }
+    triggers.resize(nCollisions);
+
+    std::size_t i = 0;
     for (auto& collision : collisions) {
-      float vertexPV = collision.posZ();
-      float vertex_corr = vertexPV / o2::constants::physics::LightSpeedCm2NS;
-      float t0A = 1e10;
-      float t0C = 1e10;
+      posZ[i] = collision.posZ();
       if (collision.has_foundFT0()) {
         auto ft0 = collision.foundFT0();
-        std::bitset<8> triggers = ft0.triggerMask();
-        bool ora = triggers[o2::ft0::Triggers::bitA];
-        bool orc = triggers[o2::ft0::Triggers::bitC];
-        LOGF(debug, "triggers OrA %i OrC %i ", ora, orc);
-        LOGF(debug, " T0A = %f, T0C %f, vertex_corr %f", ft0.timeA(), ft0.timeC(), vertex_corr);
-        if (ora) {
-          t0A = ft0.timeA() + vertex_corr;
-        }
-        if (orc) {
-          t0C = ft0.timeC() - vertex_corr;
-        }
+        timeA[i] = ft0.timeA();
+        timeC[i] = ft0.timeC();
+        triggers[i] = ft0.triggerMask();
+      } else {
+        timeA[i] = 0.f;
+        timeC[i] = 0.f;
+        triggers[i] = 0;
       }
-      LOGF(debug, " T0 collision time T0A = %f, T0C = %f", t0A, t0C);
-      table(t0A, t0C);
+      i++;
+    }
+
+    constexpr float invLightSpeed = 1.f / o2::constants::physics::LightSpeedCm2NS;
+    constexpr uint8_t maskA = 1 << o2::ft0::Triggers::bitA;
+    constexpr uint8_t maskC = 1 << o2::ft0::Triggers::bitC;
+    for (std::size_t j = 0; j < nCollisions; j++) {
+      const float vertexCorr = posZ[j] * invLightSpeed;
+      t0A[j] = (triggers[j] & maskA) ? timeA[j] + vertexCorr : 1e10f;
+      t0C[j] = (triggers[j] & maskC) ? timeC[j] - vertexCorr : 1e10f;
+    }
+
+    table.reserve(nCollisions);
+    for (std::size_t j = 0; j < nCollisions; j++) {
+      LOGF(debug, " T0 collision time T0A = %f, T0C = %f", t0A[j], t0C[j]);
+      table(t0A[j], t0C[j]);
     }
   }
 };
@@ -0,0 +1,121 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   mcRecoIndex.cxx
+/// \brief  Task producing the generated -> reconstructed indices of the MC particles and collisions
+///
+/// For each MC particle the list of reconstructed tracks with it as label, and for each MC collision the list
+/// of reconstructed collisions with it as label. The lists are built with a counting sort over the labels
+/// (compressed sparse rows: counts, offsets, then the indices), once per dataframe, so that the efficiency
+/// and multi-reconstruction checks do not need to build their own maps.
+///
+/// Usage:
+///   void process(soa::Join<aod::McParticles, aod::McParticleRecoTracks> const& particles, aod::Tracks const&)
+///   {
+///     for (auto& particle : particles) {
+///       if (particle.trackIds().size() > 1) { // multi-reconstructed particle
+///         for (auto& track : particle.tracks_as<aod::Tracks>()) { ... }
+///
+
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+#include "Common/DataModel/McRecoIndices.h"
+
+#include <vector>
+
+using namespace o2;
+using namespace o2::framework;
+
+/// Reverse index: positions of the rows of the source table for each target row
+/// Entries with a negative label are left out
+struct ReverseIndex {
+  std::vector<int32_t> offsets; // the source rows of target i are at [offsets[i], offsets[i + 1])
+  std::vector<int32_t> rows;
+  std::vector<int32_t> row; // buffer of the entries of one target, for the array column
+
+  template <typename TLabels>
+  void build(TLabels const& labels, int64_t nTargets)
+  {
+    offsets.assign(nTargets + 1, 0);
+    for (const auto label : labels) {
+      if (label >= 0 && label < nTargets) {
+        offsets[label + 1]++;
+      }
+    }
+    for (int64_t i = 0; i < nTargets; i++) {
+      offsets[i + 1] += offsets[i];
+    }
+    rows.resize(offsets[nTargets]);
+    // the sources are visited by increasing index, hence the entries of a target are sorted
+    std::vector<int32_t> next(offsets.begin(), offsets.end() - 1);
+    int32_t source = 0;
+    for (const auto label : labels) {
+      if (label >= 0 && label < nTargets) {
+        rows[next[label]++] = source;
+      }
+      source++;
+    }
+  }
+
+  std::vector<int32_t> const& get(int64_t target)
+  {
+    row.assign(rows.begin() + offsets[target], rows.begin() + offsets[target + 1]);
+    return row;
+  }
+};
+
+struct McRecoIndex {
+  Produces<aod::McParticleRecoTracks> particleTracks;
+  Produces<aod::McCollisionRecoCollisions> collisionCollisions;
+
+  ReverseIndex trackIndex;
+  ReverseIndex collisionIndex;
+  std::vector<int32_t> labels;
+
+  void processTracks(aod::McParticles const& mcParticles, soa::Join<aod::Tracks, aod::McTrackLabels> const& tracks)
+  {
+    labels.clear();
+    labels.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      labels.push_back(track.mcParticleId());
+    }
+    trackIndex.build(labels, mcParticles.size());
+
+    particleTracks.reserve(mcParticles.size());
+    for (int64_t i = 0; i < mcParticles.size(); i++) {
+      particleTracks(trackIndex.get(i));
+    }
+  }
+  PROCESS_SWITCH(McRecoIndex, processTracks, "Produce the reconstructed tracks of each MC particle", true);
+
+  void processCollisions(aod::McCollisions const& mcCollisions, soa::Join<aod::Collisions, aod::McCollisionLabels> const& collisions)
+  {
+    labels.clear();
+    labels.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      labels.push_back(collision.mcCollisionId());
+    }
+    collisionIndex.build(labels, mcCollisions.size());
+
+    collisionCollisions.reserve(mcCollisions.size());
+    for (int64_t i = 0; i < mcCollisions.size(); i++) {
+      collisionCollisions(collisionIndex.get(i));
+    }
+  }
+  PROCESS_SWITCH(McRecoIndex, processCollisions, "Produce the reconstructed collisions of each MC collision", true);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<McRecoIndex>(cfgc, TaskName{"mc-reco-index"})};
+}
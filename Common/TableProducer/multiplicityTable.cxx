@@ -19,7 +19,35 @@ using namespace o2::framework;
 #include <CCDB/BasicCCDBManager.h>
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/Multiplicity.h"
+#include "Common/Core/TableHelper.h"
 #include "iostream"
+#include <array>
+#include <vector>
+
+using BCsWithTimestamps = soa::Join<aod::BCs, aod::Timestamps>;
+using CollisionsWithEvSels = soa::Join<aod::Collisions, aod::EvSels>;
+using TracksWithExtra = soa::Join<aod::Tracks, aod::TracksExtra>;
+
+namespace
+{
+/// Sum of the amplitudes of a detector, with independent partial sums so that the loop can be vectorised
+template <typename TAmplitudes>
+float sumAmplitudes(TAmplitudes const& amplitudes)
+{
+  float partial[4] = {0.f, 0.f, 0.f, 0.f};
+  const int n = amplitudes.size();
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (int j = 0; j < 4; j++) {
+      partial[j] += amplitudes[i + j];
+    }
+  }
+  for (; i < n; i++) {
+    partial[0] += amplitudes[i];
+  }
+  return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+}
+} // namespace
 
 struct MultiplicityTableTaskIndexed {
   Produces<aod::Mults> mult;
@@ -34,7 +62,15 @@ struct MultiplicityTableTaskIndexed {
   Partition<soa::Join<aod::Tracks, aod::TracksExtra>> pvContribTracksEta1 = (nabs(aod::track::eta) < 1.0f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
 
   //Configurable
-  Configurable<int> doVertexZeq{"doVertexZeq", 1, "if 1: do vertex Z eq mult table"};
+  Configurable<int> doVertexZeq{"doVertexZeq", -1, "if 1: do vertex Z eq mult table, if -1: only if the MultZeqs table is required in the workflow"};
+  bool enableMultZeqTable = true; // MultZeqs is consumed in the workflow, otherwise it is sent empty
+
+  // track-based estimators of the collisions, filled in one pass over the tracks
+  enum TrackEstimator { kTPC = 0,
+                        kNContribs,
+                        kNContribsEta1,
+                        kNTrackEstimators };
+  std::vector<std::array<int, kNTrackEstimators>> trackEstimators;
 
   int mRunNumber;
   bool lCalibLoaded;
@@ -48,11 +84,15 @@ struct MultiplicityTableTaskIndexed {
 
   void init(InitContext& context)
   {
-    if (doprocessRun2 == false && doprocessRun3 == false) {
-      LOGF(fatal, "Neither processRun2 nor processRun3 enabled. Please choose one.");
+    const auto required = getTablesRequiredInWorkflow(context, {"MultZeqs"});
+    enableMultZeqTable = required[0];
+    enableFlagIfTableRequired(enableMultZeqTable, "MultZeqs", doVertexZeq);
+
+    if (doprocessRun2 == false && doprocessRun3 == false && doprocessRun3Grouped == false) {
+      LOGF(fatal, "Neither processRun2 nor processRun3 nor processRun3Grouped enabled. Please choose one.");
     }
-    if (doprocessRun2 == true && doprocessRun3 == true) {
-      LOGF(fatal, "Cannot enable processRun2 and processRun3 at the same time. Please choose one.");
+    if (int(doprocessRun2) + int(doprocessRun3) + int(doprocessRun3Grouped) > 1) {
+      LOGF(fatal, "Cannot enable more than one of processRun2, processRun3 and processRun3Grouped at the same time. Please choose one.");
     }
 
     mRunNumber = 0;
@@ -119,34 +159,9 @@ struct MultiplicityTableTaskIndexed {
   }
   PROCESS_SWITCH(MultiplicityTableTaskIndexed, processRun2, "Produce Run 2 multiplicity tables", true);
 
-  void processRun3(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksExtra> const& tracksExtra, soa::Join<aod::BCs, aod::Timestamps> const& bcs, aod::Zdcs const& zdcs, aod::FV0As const& fv0as, aod::FT0s const& ft0s, aod::FDDs const& fdds)
+  /// Loads the vertex-Z equalisation profiles once per run
+  void loadCalibration(BCsWithTimestamps::iterator const& bc)
   {
-    float multFV0A = 0.f;
-    float multFV0C = 0.f;
-    float multFT0A = 0.f;
-    float multFT0C = 0.f;
-    float multFDDA = 0.f;
-    float multFDDC = 0.f;
-    float multZNA = 0.f;
-    float multZNC = 0.f;
-    int multTracklets = 0;
-
-    float multZeqFV0A = 0.f;
-    float multZeqFT0A = 0.f;
-    float multZeqFT0C = 0.f;
-    float multZeqFDDA = 0.f;
-    float multZeqFDDC = 0.f;
-    float multZeqNContribs = 0.f;
-
-    auto tracksGrouped = tracksWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex());
-    auto pvContribsGrouped = pvContribTracks->sliceByCached(aod::track::collisionId, collision.globalIndex());
-    auto pvContribsEta1Grouped = pvContribTracksEta1->sliceByCached(aod::track::collisionId, collision.globalIndex());
-    int multTPC = tracksGrouped.size();
-    int multNContribs = pvContribsGrouped.size();
-    int multNContribsEta1 = pvContribsEta1Grouped.size();
-
-    /* check the previous run number */
-    auto bc = collision.bc_as<soa::Join<aod::BCs, aod::Timestamps>>();
     if (doVertexZeq > 0) {
       if (bc.runNumber() != mRunNumber) {
         mRunNumber = bc.runNumber(); //mark this run as at least tried
@@ -170,34 +185,46 @@ struct MultiplicityTableTaskIndexed {
         }
       }
     }
+  }
+
+  /// Computes the detector-based estimators of a Run 3 collision and fills the tables
+  template <typename TCollision>
+  void fillRun3(TCollision const& collision, int multTPC, int multNContribs, int multNContribsEta1)
+  {
+    float multFV0A = 0.f;
+    float multFV0C = 0.f;
+    float multFT0A = 0.f;
+    float multFT0C = 0.f;
+    float multFDDA = 0.f;
+    float multFDDC = 0.f;
+    float multZNA = 0.f;
+    float multZNC = 0.f;
+    int multTracklets = 0;
+
+    float multZeqFV0A = 0.f;
+    float multZeqFT0A = 0.f;
+    float multZeqFT0C = 0.f;
+    float multZeqFDDA = 0.f;
+    float multZeqFDDC = 0.f;
+    float multZeqNContribs = 0.f;
+
     // using FT0 row index from event selection task
     if (collision.has_foundFT0()) {
       auto ft0 = collision.foundFT0();
-      for (auto amplitude : ft0.amplitudeA()) {
-        multFT0A += amplitude;
-      }
-      for (auto amplitude : ft0.amplitudeC()) {
-        multFT0C += amplitude;
-      }
+      multFT0A = sumAmplitudes(ft0.amplitudeA());
+      multFT0C = sumAmplitudes(ft0.amplitudeC());
     }
     // using FDD row index from event selection task
     if (collision.has_foundFDD()) {
       auto fdd = collision.foundFDD();
-      for (auto amplitude : fdd.chargeA()) {
-        multFDDA += amplitude;
-      }
-      for (auto amplitude : fdd.chargeC()) {
-        multFDDC += amplitude;
-      }
+      multFDDA = sumAmplitudes(fdd.chargeA());
+      multFDDC = sumAmplitudes(fdd.chargeC());
     }
     // using FV0 row index from event selection task
     if (collision.has_foundFV0()) {
-      auto fv0 = collision.foundFV0();
-      for (auto amplitude : fv0.amplitude()) {
-        multFV0A += amplitude;
-      }
+      multFV0A = sumAmplitudes(collision.foundFV0().amplitude());
     }
-    if (fabs(collision.posZ()) < 15.0f && lCalibLoaded) {
+    if (enableMultZeqTable && fabs(collision.posZ()) < 15.0f && lCalibLoaded) {
       multZeqFV0A = hVtxZFV0A->Interpolate(0.0) * multFV0A / hVtxZFV0A->Interpolate(collision.posZ());
       multZeqFT0A = hVtxZFT0A->Interpolate(0.0) * multFT0A / hVtxZFT0A->Interpolate(collision.posZ());
       multZeqFT0C = hVtxZFT0C->Interpolate(0.0) * multFT0C / hVtxZFT0C->Interpolate(collision.posZ());
@@ -208,9 +235,48 @@ struct MultiplicityTableTaskIndexed {
 
     LOGF(debug, "multFV0A=%5.0f multFV0C=%5.0f multFT0A=%5.0f multFT0C=%5.0f multFDDA=%5.0f multFDDC=%5.0f multZNA=%6.0f multZNC=%6.0f multTracklets=%i multTPC=%i", multFV0A, multFV0C, multFT0A, multFT0C, multFDDA, multFDDC, multZNA, multZNC, multTracklets, multTPC);
     mult(multFV0A, multFV0C, multFT0A, multFT0C, multFDDA, multFDDC, multZNA, multZNC, multTracklets, multTPC, multNContribs, multNContribsEta1);
-    multzeq(multZeqFV0A, multZeqFT0A, multZeqFT0C, multZeqFDDA, multZeqFDDC, multZeqNContribs);
+    if (enableMultZeqTable) {
+      multzeq(multZeqFV0A, multZeqFT0A, multZeqFT0C, multZeqFDDA, multZeqFDDC, multZeqNContribs);
+    }
+  }
+
+  void processRun3(CollisionsWithEvSels::iterator const& collision, TracksWithExtra const& tracksExtra, BCsWithTimestamps const& bcs, aod::Zdcs const& zdcs, aod::FV0As const& fv0as, aod::FT0s const& ft0s, aod::FDDs const& fdds)
+  {
+    auto tracksGrouped = tracksWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex());
+    auto pvContribsGrouped = pvContribTracks->sliceByCached(aod::track::collisionId, collision.globalIndex());
+    auto pvContribsEta1Grouped = pvContribTracksEta1->sliceByCached(aod::track::collisionId, collision.globalIndex());
+
+    /* check the previous run number */
+    loadCalibration(collision.bc_as<BCsWithTimestamps>());
+    fillRun3(collision, tracksGrouped.size(), pvContribsGrouped.size(), pvContribsEta1Grouped.size());
   }
   PROCESS_SWITCH(MultiplicityTableTaskIndexed, processRun3, "Produce Run 3 multiplicity tables", false);
+
+  /// Same as processRun3, with all the track-based estimators computed in a single pass over the tracks of the dataframe
+  void processRun3Grouped(CollisionsWithEvSels const& collisions, TracksWithExtra const& tracks, BCsWithTimestamps const& bcs, aod::Zdcs const& zdcs, aod::FV0As const& fv0as, aod::FT0s const& ft0s, aod::FDDs const& fdds)
+  {
+    trackEstimators.assign(collisions.size(), {0, 0, 0});
+    for (auto& track : tracks) {
+      if (!track.has_collision()) {
+        continue;
+      }
+      auto& estimators = trackEstimators[track.collisionId()];
+      estimators[kTPC] += track.tpcNClsFindable() > 0;
+      if (track.isPVContributor()) {
+        const float absEta = fabs(track.eta());
+        estimators[kNContribs] += absEta < 0.8f;
+        estimators[kNContribsEta1] += absEta < 1.0f;
+      }
+    }
+
+    for (auto& collision : collisions) {
+      /* check the previous run number */
+      loadCalibration(collision.bc_as<BCsWithTimestamps>());
+      auto const& estimators = trackEstimators[collision.globalIndex()];
+      fillRun3(collision, estimators[kTPC], estimators[kNContribs], estimators[kNContribsEta1]);
+    }
+  }
+  PROCESS_SWITCH(MultiplicityTableTaskIndexed, processRun3Grouped, "Produce Run 3 multiplicity tables in a single pass over the tracks", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
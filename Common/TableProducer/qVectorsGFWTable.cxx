@@ -0,0 +1,148 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \brief Producer of the per-collision Q-vectors of the generic framework (GFW), shared by the flow analyses
+///        The Q-vectors of the regions refN (-cfgCutEta < eta < -cfgEtaGap), refP (cfgEtaGap < eta < cfgCutEta)
+///        and full (|eta| < cfgCutEta) are accumulated once per collision, with the efficiency and GFWWeights acceptance weights,
+///        and loaded by the consumers (e.g. dq-flow, flow-generic-framework) with GFW::SetQvectors() in a GFW with the same regions.
+///
+
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include <CCDB/BasicCCDBManager.h>
+
+#include "Common/DataModel/TrackSelectionTables.h"
+#include "Common/DataModel/Qvectors.h"
+
+#include "GFW.h"
+#include "GFWWeights.h"
+#include <TH1D.h>
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+
+struct QvectorsGFWTable {
+  Produces<aod::QvectorsGFW> qvectors;
+
+  Configurable<float> cfgCutPtMin{"cfgCutPtMin", 0.2f, "Minimal pT for tracks"};
+  Configurable<float> cfgCutPtMax{"cfgCutPtMax", 3.0f, "Maximal pT for tracks"};
+  Configurable<float> cfgCutEta{"cfgCutEta", 0.8f, "Eta range for tracks"};
+  Configurable<float> cfgEtaGap{"cfgEtaGap", 0.4f, "Inner eta edge of the refN and refP regions"};
+  Configurable<std::vector<int>> cfgPowsRef{"cfgPowsRef", {3, 0, 2, 2, 3, 3, 3}, "Number of powers of each harmonic (0, 1, ...) in the refN and refP regions"};
+  Configurable<std::vector<int>> cfgPowsFull{"cfgPowsFull", {5, 0, 4, 4, 3, 3, 3}, "Number of powers of each harmonic (0, 1, ...) in the full region"};
+  Configurable<std::string> cfgEfficiency{"cfgEfficiency", "", "CCDB path to efficiency object"};
+  Configurable<std::string> cfgAcceptance{"cfgAcceptance", "", "CCDB path to acceptance object"};
+  Configurable<bool> cfgAcceptanceLookup{"cfgAcceptanceLookup", false, "Copy the acceptance weights to a flat lookup grid when a new object is loaded"};
+
+  Service<ccdb::BasicCCDBManager> ccdb;
+  Configurable<std::string> url{"ccdb-url", "http://ccdb-test.cern.ch:8080", "url of the ccdb repository"};
+  Configurable<long> nolaterthan{"ccdb-no-later-than", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(), "latest acceptable timestamp of creation for the object"};
+
+  Filter trackFilter = (nabs(aod::track::eta) < cfgCutEta) && (aod::track::pt > cfgCutPtMin) && (aod::track::pt < cfgCutPtMax) && ((requireGlobalTrackInFilter()) || (aod::track::isGlobalTrackSDD == (uint8_t) true));
+  using MyTracks = soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>>;
+
+  TH1D* mEfficiency = nullptr;
+  GFWWeights* mAcceptance = nullptr;
+
+  GFW* fGFW = new GFW();
+  // accepted tracks of the current collision
+  std::vector<double> fBatchEta;
+  std::vector<int> fBatchPt;
+  std::vector<double> fBatchPhi;
+  std::vector<double> fBatchWeight;
+  std::vector<int> fBatchMask;
+  // Q-vectors of the current collision
+  std::vector<double> fQvecRe;
+  std::vector<double> fQvecIm;
+  std::vector<int> fQvecNEntries;
+
+  void init(InitContext const&)
+  {
+    ccdb->setURL(url.value);
+    ccdb->setCaching(true);
+    ccdb->setCreatedNotAfter(nolaterthan.value);
+
+    if (cfgEfficiency.value.empty() == false) {
+      mEfficiency = ccdb->getForTimeStamp<TH1D>(cfgEfficiency.value, nolaterthan.value);
+      if (mEfficiency) {
+        LOGF(info, "Loaded efficiency histogram %s (%p)", cfgEfficiency.value.c_str(), (void*)mEfficiency);
+      } else {
+        LOGF(fatal, "Could not load efficiency histogram from %s", cfgEfficiency.value.c_str());
+      }
+    }
+
+    std::vector<int> powsRef = cfgPowsRef;
+    std::vector<int> powsFull = cfgPowsFull;
+    fGFW->AddRegion("refN", powsRef.size(), powsRef.data(), -cfgCutEta, -cfgEtaGap, 1, 1);
+    fGFW->AddRegion("refP", powsRef.size(), powsRef.data(), cfgEtaGap, cfgCutEta, 1, 1);
+    fGFW->AddRegion("full", powsFull.size(), powsFull.data(), -cfgCutEta, cfgCutEta, 1, 2);
+    fGFW->CreateRegions();
+  }
+
+  void process(aod::Collision const& collision, aod::BCsWithTimestamps const&, MyTracks const& tracks)
+  {
+    if (cfgAcceptance.value.empty() == false) {
+      auto bc = collision.bc_as<aod::BCsWithTimestamps>();
+      GFWWeights* acceptance = ccdb->getForTimeStamp<GFWWeights>(cfgAcceptance.value, bc.timestamp());
+      if (acceptance != mAcceptance) {
+        if (acceptance) {
+          LOGF(info, "Loaded acceptance histogram from %s (%p)", cfgAcceptance.value.c_str(), (void*)acceptance);
+          if (cfgAcceptanceLookup && !acceptance->HasLookup()) {
+            acceptance->CreateLookup(); // the object is cached by the CCDB manager, so this is done once per object
+          }
+        } else {
+          LOGF(warning, "Could not load acceptance histogram from %s", cfgAcceptance.value.c_str());
+        }
+        mAcceptance = acceptance;
+      }
+    }
+
+    fGFW->Clear();
+    fBatchEta.clear();
+    fBatchPt.clear();
+    fBatchPhi.clear();
+    fBatchWeight.clear();
+    fBatchMask.clear();
+
+    float vtxz = collision.posZ();
+    for (auto& track : tracks) {
+      double weff = 1.;
+      if (mEfficiency) {
+        weff = mEfficiency->GetBinContent(mEfficiency->FindBin(track.pt()));
+        if (weff == 0) {
+          continue;
+        }
+        weff = 1. / weff;
+      }
+      double wacc = mAcceptance ? mAcceptance->GetNUA(track.phi(), track.eta(), vtxz) : 1.;
+
+      fBatchEta.push_back(track.eta());
+      fBatchPt.push_back(0);
+      fBatchPhi.push_back(track.phi());
+      fBatchWeight.push_back(wacc * weff);
+      fBatchMask.push_back(3);
+    }
+    fGFW->Fill(fBatchEta.size(), fBatchEta.data(), fBatchPt.data(), fBatchPhi.data(), fBatchWeight.data(), fBatchMask.data());
+
+    // one row per collision, also for collisions without tracks, so that the table is joinable with the collisions
+    fGFW->GetQvectors(fQvecRe, fQvecIm, fQvecNEntries);
+    qvectors(fQvecRe, fQvecIm, fQvecNEntries);
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<QvectorsGFWTable>(cfgc, TaskName{"qvectors-gfw-table"})};
+}
@@ -0,0 +1,187 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   trackExtensionSelection.cxx
+/// \brief  Task producing the TracksDCA and the TrackSelection tables in one pass over the tracks
+///
+/// Replaces the trackextension + trackselection pair of tasks: the DCAs are computed and put with
+/// the other track variables into the columns of the selection in the same loop, so that the
+/// tracks are read only once. The output tables are the same as the ones of the two tasks.
+///
+
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+#include "Common/Core/TrackSelection.h"
+#include "Common/Core/TrackSelectionDefaults.h"
+#include "Common/Core/RunConditions.h"
+#include "Common/DataModel/TrackSelectionTables.h"
+#include "Common/Core/trackUtilities.h"
+#include "ReconstructionDataFormats/DCA.h"
+#include "DetectorsBase/Propagator.h"
+#include "DetectorsBase/GeometryManager.h"
+#include "DataFormatsParameters/GRPObject.h"
+#include <CCDB/BasicCCDBManager.h>
+
+#include <array>
+#include <vector>
+
+using namespace o2;
+using namespace o2::framework;
+
+struct TrackExtensionSelection {
+  Produces<aod::TracksDCA> extendedTrackQuantities;
+  Produces<aod::TrackSelection> filterTable;
+  Service<o2::ccdb::BasicCCDBManager> ccdb;
+
+  Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
+  Configurable<std::string> lutPath{"lutPath", "GLO/Param/MatLUT", "Path of the Lut parametrization"};
+  Configurable<std::string> geoPath{"geoPath", "GLO/Config/GeometryAligned", "Path of the geometry file"};
+  Configurable<std::string> grpPath{"grpPath", "GLO/GRP/GRP", "Path of the grp file"};
+  Configurable<bool> isRun3{"isRun3", false, "temp option to enable run3 mode"};
+  Configurable<bool> compatibilityIU{"compatibilityIU", false, "compatibility option to allow the processing of tracks before the introduction of IU tracks"};
+  Configurable<int> itsMatching{"itsMatching", 0, "condition for ITS matching (0: Run2 SPD kAny, 1: Run3ITSibAny, 2: Run3ITSallAny, 3: Run3ITSall7Layers)"};
+  Configurable<float> ptMin{"ptMin", 0.1f, "Lower cut on pt for the track selected"};
+  Configurable<float> ptMax{"ptMax", 1e10f, "Upper cut on pt for the track selected"};
+  Configurable<float> etaMin{"etaMin", -0.8, "Lower cut on eta for the track selected"};
+  Configurable<float> etaMax{"etaMax", 0.8, "Upper cut on eta for the track selected"};
+
+  o2::analysis::RunConditions conditions;
+  int iGrp = -1;
+  o2::base::MatLayerCylSet* lut = nullptr;
+  float mMagField = 0.f;
+
+  TrackSelection globalTracks;
+  TrackSelection globalTracksSDD;
+
+  TrackSelection::TrackColumns trackColumns; // track variables including the DCAs computed in the same pass
+  std::vector<uint16_t> masksGlobal;
+  std::vector<uint16_t> masksSDD;
+
+  void init(InitContext&)
+  {
+    if (doprocessRun2 && doprocessRun3) {
+      LOGF(fatal, "Cannot enable processRun2 and processRun3 at the same time. Please choose one.");
+    }
+
+    ccdb->setURL(ccdburl);
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
+    if (!o2::base::GeometryManager::isGeometryLoaded()) {
+      ccdb->get<TGeoManager>(geoPath);
+    }
+
+    conditions.init(ccdburl);
+    iGrp = conditions.add<o2::parameters::GRPObject>(grpPath);
+    conditions.addRunChangeCallback([this](int run, uint64_t) {
+      auto* grpo = conditions.get<o2::parameters::GRPObject>(iGrp);
+      mMagField = grpo->getNominalL3Field();
+      if (doprocessRun3) {
+        o2::base::Propagator::initFieldFromGRP(grpo);
+        o2::base::Propagator::Instance()->setMatLUT(lut);
+      }
+      LOGF(info, "Setting magnetic field to %f kG for run %d from its GRP CCDB object", mMagField, run);
+    });
+
+    // Same selections as in the trackselection task
+    if (!isRun3 && itsMatching == 0) {
+      globalTracks = getGlobalTrackSelection(); // Run 2 SPD kAny
+    } else if (isRun3 && (itsMatching == 0 || itsMatching == 1)) {
+      globalTracks = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibAny);
+    } else if (isRun3 && itsMatching == 2) {
+      globalTracks = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSallAny);
+    } else if (isRun3 && itsMatching == 3) {
+      globalTracks = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSall7Layers);
+    } else {
+      LOG(fatal) << "TrackExtensionSelection with undefined cuts. Fix it!";
+    }
+    globalTracks.SetPtRange(ptMin, ptMax);
+    globalTracks.SetEtaRange(etaMin, etaMax);
+    if (isRun3) {
+      globalTracks.SetTrackType(compatibilityIU.value ? o2::aod::track::TrackTypeEnum::TrackIU : o2::aod::track::TrackTypeEnum::Track);
+    }
+
+    // Extra requirement on the ITS -> Run 2: asking for 1 hit SDD and no hit in SPD
+    globalTracksSDD = getGlobalTrackSelectionSDD();
+    globalTracksSDD.SetPtRange(ptMin, ptMax);
+    globalTracksSDD.SetEtaRange(etaMin, etaMax);
+  }
+
+  /// Computes the DCAs of each track, fills the TracksDCA table and the selection columns, then the selection table
+  template <bool isRun2, typename TTracks>
+  void fillTables(TTracks const& tracks)
+  {
+    o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
+
+    extendedTrackQuantities.reserve(tracks.size());
+    trackColumns.clear();
+    trackColumns.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      std::array<float, 2> dca{1e10f, 1e10f};
+      if (track.has_collision()) {
+        bool toPropagate = false;
+        if constexpr (isRun2) {
+          toPropagate = track.trackType() == o2::aod::track::TrackTypeEnum::Run2Track && track.itsChi2NCl() != 0.f && track.tpcChi2NCl() != 0.f && std::abs(track.x()) < 10.f;
+        } else {
+          toPropagate = track.trackType() == (compatibilityIU.value ? o2::aod::track::TrackTypeEnum::TrackIU : o2::aod::track::TrackTypeEnum::Track);
+        }
+        if (toPropagate) {
+          auto const& collision = track.template collision_as<aod::Collisions>();
+          conditions.update(collision.template bc_as<aod::BCsWithTimestamps>());
+          auto trackPar = getTrackPar(track);
+          if constexpr (isRun2) {
+            trackPar.propagateParamToDCA({collision.posX(), collision.posY(), collision.posZ()}, mMagField, &dca);
+          } else {
+            gpu::gpustd::array<float, 2> dcaInfo;
+            if (o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackPar, 2.f, matCorr, &dcaInfo)) {
+              dca[0] = dcaInfo[0];
+              dca[1] = dcaInfo[1];
+            }
+          }
+        }
+      }
+      extendedTrackQuantities(dca[0], dca[1]);
+      trackColumns.push(track, dca[0], dca[1]);
+    }
+
+    globalTracks.FillMasks(trackColumns, masksGlobal);
+    filterTable.reserve(tracks.size());
+    if (isRun3) {
+      for (const auto mask : masksGlobal) {
+        filterTable((uint8_t)0, mask);
+      }
+      return;
+    }
+    globalTracksSDD.FillMasks(trackColumns, masksSDD);
+    for (size_t i = 0; i < masksGlobal.size(); i++) {
+      filterTable((uint8_t)(masksSDD[i] == TrackSelection::kAllCutsMask), masksGlobal[i]);
+    }
+  }
+
+  void processRun2(aod::FullTracks const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const&)
+  {
+    fillTables<true>(tracks);
+  }
+  PROCESS_SWITCH(TrackExtensionSelection, processRun2, "Process Run2 tracks", true);
+
+  void processRun3(aod::FullTracks const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const&)
+  {
+    fillTables<false>(tracks);
+  }
+  PROCESS_SWITCH(TrackExtensionSelection, processRun3, "Process Run3 tracks", false);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<TrackExtensionSelection>(cfgc, TaskName{"track-extension-selection"})};
+}
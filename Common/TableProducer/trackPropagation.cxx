@@ -19,6 +19,7 @@
 #include "Framework/RunningWorkflowInfo.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/RunConditions.h"
 #include "ReconstructionDataFormats/DCA.h"
 #include "DetectorsBase/Propagator.h"
 #include "DetectorsBase/GeometryManager.h"
@@ -31,6 +32,12 @@
 #include "DataFormatsCalibration/MeanVertexObject.h"
 #include "CommonConstants/GeomConstants.h"
 
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 // The Run 3 AO2D stores the tracks at the point of innermost update. For a track with ITS this is the innermost (or second innermost)
 // ITS layer. For a track without ITS, this is the TPC inner wall or for loopers in the TPC even a radius beyond that.
 // In order to use the track parameters, the tracks have to be propagated to the collision vertex which is done by this task.
@@ -38,6 +45,14 @@
 //
 // This task is not needed for Run 2 converted data.
 // There are two versions of the task (see process flags), one producing also the covariance matrix and the other only the tracks table.
+//
+// With useHelix, the tracks already inside helixRadius (by default the beam pipe, so without material to cross) are propagated
+// to the DCA with the analytic helix in the constant nominal Bz, over nThreads threads. The other tracks are propagated afterwards
+// with the material corrections by the propagator, which is a singleton and is therefore used by the main thread only.
+//
+// With preselectTracks, only the tracks passing a kinematic preselection on their innermost-update parameters (the ones likely
+// to be used downstream) get the full propagation. The others are extrapolated with the analytic helix, without material corrections,
+// and keep the TrackIU type as a flag that they were not fully propagated.
 
 using namespace o2;
 using namespace o2::framework;
@@ -53,14 +68,24 @@ struct TrackPropagation {
   Produces<aod::TracksDCA> tracksDCA;
 
   Service<o2::ccdb::BasicCCDBManager> ccdb;
+  o2::analysis::RunConditions conditions;
+  int iGrpMag = -1;
+  int iMeanVertex = -1;
 
   bool fillTracksDCA = false;
-  int runNumber = -1;
+  float bz = 0.f;
+
+  /// How a track is propagated to the vertex
+  enum PropagationPath : uint8_t {
+    kNoPropagation = 0, ///< track stored at its innermost update
+    kHelix,             ///< analytic helix in constant Bz
+    kMaterial,          ///< propagator with the material corrections
+    kApproximate        ///< failed the preselection, analytic helix and TrackIU type kept
+  };
 
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
 
   const o2::dataformats::MeanVertexObject* mVtx = nullptr;
-  o2::parameters::GRPMagField* grpmag = nullptr;
   o2::base::MatLayerCylSet* lut = nullptr;
 
   Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -69,6 +94,13 @@ struct TrackPropagation {
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> mVtxPath{"mVtxPath", "GLO/Calib/MeanVertex", "Path of the mean vertex file"};
   Configurable<float> minPropagationRadius{"minPropagationDistance", o2::constants::geom::XTPCInnerRef + 0.1, "Only tracks which are at a smaller radius will be propagated, defaults to TPC inner wall"};
+  Configurable<bool> useHelix{"useHelix", false, "Propagate the tracks inside helixRadius with the analytic helix in constant Bz, without material corrections"};
+  Configurable<float> helixRadius{"helixRadius", o2::constants::geom::XBeamPipeOuterRef, "Tracks at a smaller radius are propagated with the analytic helix, defaults to the beam pipe"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads for the propagation with the analytic helix"};
+  Configurable<int> minTracksPerThread{"minTracksPerThread", 2000, "Minimum number of tracks per thread"};
+  Configurable<bool> preselectTracks{"preselectTracks", false, "Fully propagate only the tracks passing the preselection, extrapolate the others without material corrections"};
+  Configurable<float> preselectMinPt{"preselectMinPt", 0.1f, "Preselection: minimum pt at the innermost update"};
+  Configurable<float> preselectMaxEta{"preselectMaxEta", 1.5f, "Preselection: maximum |eta| at the innermost update"};
 
   void init(o2::framework::InitContext& initContext)
   {
@@ -94,19 +126,51 @@ struct TrackPropagation {
     if (!o2::base::GeometryManager::isGeometryLoaded()) {
       ccdb->get<TGeoManager>(geoPath);
     }
+
+    // the run-dependent objects are fetched together at the first BC of each run
+    conditions.init(ccdburl);
+    iGrpMag = conditions.add<o2::parameters::GRPMagField>(grpmagPath);
+    iMeanVertex = conditions.add<o2::dataformats::MeanVertexObject>(mVtxPath);
+    conditions.addRunChangeCallback([this](int run, uint64_t) {
+      auto* grpmag = conditions.get<o2::parameters::GRPMagField>(iGrpMag);
+      LOG(info) << "Setting magnetic field to current " << grpmag->getL3Current() << " A for run " << run << " from its GRPMagField CCDB object";
+      o2::base::Propagator::initFieldFromGRP(grpmag);
+      o2::base::Propagator::Instance()->setMatLUT(lut);
+      mVtx = conditions.get<o2::dataformats::MeanVertexObject>(iMeanVertex);
+      bz = o2::base::Propagator::Instance()->getNominalBz();
+    });
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
   {
-    if (runNumber == bc.runNumber()) {
-      return;
+    conditions.update(bc);
+  }
+
+  /// Sets the vertex the track is propagated to: its collision if any, otherwise the mean vertex
+  template <typename TTrack>
+  void setVertex(TTrack const& track, o2::dataformats::VertexBase& vtx)
+  {
+    if (track.has_collision()) {
+      auto const& collision = track.collision();
+      vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
+      vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+    } else {
+      vtx.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
+      vtx.setCov(mVtx->getSigmaX() * mVtx->getSigmaX(), 0.0f, mVtx->getSigmaY() * mVtx->getSigmaY(), 0.0f, 0.0f, mVtx->getSigmaZ() * mVtx->getSigmaZ());
     }
-    grpmag = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(grpmagPath, bc.timestamp());
-    LOG(info) << "Setting magnetic field to current " << grpmag->getL3Current() << " A for run " << bc.runNumber() << " from its GRPMagField CCDB object";
-    o2::base::Propagator::initFieldFromGRP(grpmag);
-    o2::base::Propagator::Instance()->setMatLUT(lut);
-    mVtx = ccdb->getForTimeStamp<o2::dataformats::MeanVertexObject>(mVtxPath, bc.timestamp());
-    runNumber = bc.runNumber();
+  }
+
+  template <typename TTrack, typename TTrackPar>
+  PropagationPath getPropagationPath(TTrack const& track, TTrackPar const& trackPar)
+  {
+    // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
+    if (track.trackType() != aod::track::TrackIU || track.x() >= minPropagationRadius) {
+      return kNoPropagation;
+    }
+    if (preselectTracks && (trackPar.getPt() < preselectMinPt || std::abs(trackPar.getEta()) > preselectMaxEta)) {
+      return kApproximate;
+    }
+    return useHelix && track.x() < helixRadius ? kHelix : kMaterial;
   }
 
   template <typename TTrack, typename TTrackPar>
@@ -116,12 +180,111 @@ struct TrackPropagation {
     tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
   }
 
+  template <typename TTrackParCov>
+  void FillTracksCov(TTrackParCov& trackParCov)
+  {
+    // TODO do we keep the rho as 0? Also the sigma's are duplicated information
+    tracksParCovPropagated(std::sqrt(trackParCov.getSigmaY2()), std::sqrt(trackParCov.getSigmaZ2()), std::sqrt(trackParCov.getSigmaSnp2()),
+                           std::sqrt(trackParCov.getSigmaTgl2()), std::sqrt(trackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    tracksParCovExtensionPropagated(trackParCov.getSigmaY2(), trackParCov.getSigmaZY(), trackParCov.getSigmaZ2(), trackParCov.getSigmaSnpY(),
+                                    trackParCov.getSigmaSnpZ(), trackParCov.getSigmaSnp2(), trackParCov.getSigmaTglY(), trackParCov.getSigmaTglZ(), trackParCov.getSigmaTglSnp(),
+                                    trackParCov.getSigmaTgl2(), trackParCov.getSigma1PtY(), trackParCov.getSigma1PtZ(), trackParCov.getSigma1PtSnp(), trackParCov.getSigma1PtTgl(),
+                                    trackParCov.getSigma1Pt2());
+  }
+
+  /// Propagates the tracks with the analytic helix (inside helixRadius or failing the preselection) or with the propagator, then fills the tables
+  template <bool withCov, typename TTracks>
+  void propagateTracks(TTracks const& tracks)
+  {
+    using TTrackPar = std::conditional_t<withCov, o2::track::TrackParCov, o2::track::TrackPar>;
+    const int nTracks = tracks.size();
+    std::vector<TTrackPar> trackPars(nTracks);
+    std::vector<std::array<float, 2>> dcas(nTracks);
+    std::vector<PropagationPath> paths(nTracks);
+
+    // propagate a track to its vertex, with the helix or with the propagator
+    auto propagate = [&](int i, bool useMaterial) {
+      auto track = tracks.iteratorAt(i);
+      o2::dataformats::VertexBase vtx;
+      setVertex(track, vtx);
+      if constexpr (withCov) {
+        o2::dataformats::DCA dcaInfoCov;
+        dcaInfoCov.set(999, 999, 999, 999, 999);
+        if (useMaterial) {
+          o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackPars[i], 2.f, matCorr, &dcaInfoCov);
+        } else {
+          trackPars[i].propagateToDCA(vtx, bz, &dcaInfoCov, 2.f);
+        }
+        dcas[i] = {dcaInfoCov.getY(), dcaInfoCov.getZ()};
+      } else {
+        gpu::gpustd::array<float, 2> dcaInfo{999, 999};
+        if (useMaterial) {
+          o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx.getXYZ(), trackPars[i], 2.f, matCorr, &dcaInfo);
+        } else {
+          trackPars[i].propagateParamToDCA(vtx.getXYZ(), bz, &dcaInfo, 2.f);
+        }
+        dcas[i] = {dcaInfo[0], dcaInfo[1]};
+      }
+    };
+
+    // contiguous ranges of tracks in parallel: the tracks for the analytic helix are propagated, the others only classified
+    const int nWorkers = std::max(1, std::min<int>(nThreads, nTracks / std::max(1, minTracksPerThread.value)));
+    auto work = [&](int worker) {
+      const int first = int64_t(nTracks) * worker / nWorkers;
+      const int last = int64_t(nTracks) * (worker + 1) / nWorkers;
+      for (int i = first; i < last; ++i) {
+        auto track = tracks.iteratorAt(i);
+        if constexpr (withCov) {
+          trackPars[i] = getTrackParCov(track);
+        } else {
+          trackPars[i] = getTrackPar(track);
+        }
+        dcas[i] = {999.f, 999.f};
+        paths[i] = getPropagationPath(track, trackPars[i]);
+        if (paths[i] == kHelix || paths[i] == kApproximate) {
+          propagate(i, false);
+        }
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int worker = 1; worker < nWorkers; ++worker) {
+      workers.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    // the propagator is not thread safe
+    for (int i = 0; i < nTracks; ++i) {
+      if (paths[i] == kMaterial) {
+        propagate(i, true);
+      }
+    }
+
+    for (int i = 0; i < nTracks; ++i) {
+      auto track = tracks.iteratorAt(i);
+      aod::track::TrackTypeEnum trackType = (paths[i] == kNoPropagation || paths[i] == kApproximate) ? (aod::track::TrackTypeEnum)track.trackType() : aod::track::Track;
+      FillTracksPar(track, trackType, trackPars[i]);
+      if (fillTracksDCA) {
+        tracksDCA(dcas[i][0], dcas[i][1]);
+      }
+      if constexpr (withCov) {
+        FillTracksCov(trackPars[i]);
+      }
+    }
+  }
+
   void processStandard(aod::StoredTracksIU const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const& bcs)
   {
     if (bcs.size() == 0) {
       return;
     }
     initCCDB(bcs.begin());
+    if (useHelix || preselectTracks) {
+      propagateTracks<false>(tracks);
+      return;
+    }
 
     gpu::gpustd::array<float, 2> dcaInfo;
 
@@ -154,6 +317,10 @@ struct TrackPropagation {
       return;
     }
     initCCDB(bcs.begin());
+    if (useHelix || preselectTracks) {
+      propagateTracks<true>(tracks);
+      return;
+    }
 
     o2::dataformats::DCA dcaInfoCov;
     o2::dataformats::VertexBase vtx;
@@ -164,29 +331,15 @@ struct TrackPropagation {
       aod::track::TrackTypeEnum trackType = (aod::track::TrackTypeEnum)track.trackType();
       // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
       if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
-        if (track.has_collision()) {
-          auto const& collision = track.collision();
-          vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
-          vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
-        } else {
-          vtx.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
-          vtx.setCov(mVtx->getSigmaX() * mVtx->getSigmaX(), 0.0f, mVtx->getSigmaY() * mVtx->getSigmaY(), 0.0f, 0.0f, mVtx->getSigmaZ() * mVtx->getSigmaZ());
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
-        }
+        setVertex(track, vtx);
+        o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
         trackType = aod::track::Track;
       }
       FillTracksPar(track, trackType, trackParCov);
       if (fillTracksDCA) {
         tracksDCA(dcaInfoCov.getY(), dcaInfoCov.getZ());
       }
-      // TODO do we keep the rho as 0? Also the sigma's are duplicated information
-      tracksParCovPropagated(std::sqrt(trackParCov.getSigmaY2()), std::sqrt(trackParCov.getSigmaZ2()), std::sqrt(trackParCov.getSigmaSnp2()),
-                             std::sqrt(trackParCov.getSigmaTgl2()), std::sqrt(trackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-      tracksParCovExtensionPropagated(trackParCov.getSigmaY2(), trackParCov.getSigmaZY(), trackParCov.getSigmaZ2(), trackParCov.getSigmaSnpY(),
-                                      trackParCov.getSigmaSnpZ(), trackParCov.getSigmaSnp2(), trackParCov.getSigmaTglY(), trackParCov.getSigmaTglZ(), trackParCov.getSigmaTglSnp(),
-                                      trackParCov.getSigmaTgl2(), trackParCov.getSigma1PtY(), trackParCov.getSigma1PtZ(), trackParCov.getSigma1PtSnp(), trackParCov.getSigma1PtTgl(),
-                                      trackParCov.getSigma1Pt2());
+      FillTracksCov(trackParCov);
     }
   }
   PROCESS_SWITCH(TrackPropagation, processCovariance, "Process with covariance", false);
@@ -49,6 +49,10 @@ struct TrackSelectionTask {
   TrackSelection globalTracks;
   TrackSelection globalTracksSDD;
 
+  TrackSelection::TrackColumns trackColumns; // track variables, shared by the selections
+  std::vector<uint16_t> masksGlobal;
+  std::vector<uint16_t> masksSDD;
+
   void init(InitContext&)
   {
     switch (itsMatching) {
@@ -97,16 +101,19 @@ struct TrackSelectionTask {
 
   void process(soa::Join<aod::FullTracks, aod::TracksDCA> const& tracks)
   {
+    // The cuts are evaluated over the columns of the track variables, one cut at a time for all the tracks
+    trackColumns.fill(tracks);
+    globalTracks.FillMasks(trackColumns, masksGlobal);
+    filterTable.reserve(tracks.size());
     if (isRun3) {
-      for (auto& track : tracks) {
-        filterTable((uint8_t)0,
-                    globalTracks.IsSelectedMask(track));
+      for (const auto mask : masksGlobal) {
+        filterTable((uint8_t)0, mask);
       }
       return;
     }
-    for (auto& track : tracks) {
-      filterTable((uint8_t)globalTracksSDD.IsSelected(track),
-                  globalTracks.IsSelectedMask(track));
+    globalTracksSDD.FillMasks(trackColumns, masksSDD);
+    for (size_t i = 0; i < masksGlobal.size(); i++) {
+      filterTable((uint8_t)(masksSDD[i] == TrackSelection::kAllCutsMask), masksGlobal[i]);
     }
   }
 };
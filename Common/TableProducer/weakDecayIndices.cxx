@@ -8,6 +8,10 @@
 // In applying this license CERN does not waive the privileges and immunities
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -33,17 +37,69 @@ struct WeakDecayIndicesV0 {
 };
 
 // NOTE These tasks have to be split because for the cascades, V0s and not V0s_000 are needed
+// The collision of each cascade is resolved from flat arrays of the collision indices of the tracks and of the V0 daughters,
+// filled once per dataframe, so that the consistency checks are independent array lookups which are done over nThreads threads.
 struct WeakDecayIndicesCascades {
   Produces<aod::Cascades_001> cascades_001;
 
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads for the resolution of the cascade collisions"};
+  Configurable<int> minCascadesPerThread{"minCascadesPerThread", 10000, "Minimum number of cascades per thread"};
+
+  std::vector<int> trackCollisions;   // collision index of each track
+  std::vector<int> v0PosTracks;       // positive daughter of each V0
+  std::vector<int> v0NegTracks;       // negative daughter of each V0
+  std::vector<int> cascadeCollisions; // collision index of each cascade
+  std::vector<uint8_t> consistent;    // cascade with consistent collision information
+
   void process(aod::V0s const& v0s, aod::Cascades_000 const& cascades, aod::Tracks const& tracks)
   {
+    trackCollisions.clear();
+    trackCollisions.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      trackCollisions.push_back(track.collisionId());
+    }
+    v0PosTracks.clear();
+    v0NegTracks.clear();
+    v0PosTracks.reserve(v0s.size());
+    v0NegTracks.reserve(v0s.size());
+    for (auto const& v0 : v0s) {
+      v0PosTracks.push_back(v0.posTrackId());
+      v0NegTracks.push_back(v0.negTrackId());
+    }
+
+    const int nCascades = cascades.size();
+    cascadeCollisions.resize(nCascades);
+    consistent.resize(nCascades);
+    const int nWorkers = std::max(1, std::min<int>(nThreads, nCascades / std::max(1, minCascadesPerThread.value)));
+    auto work = [&](int worker) {
+      const int first = int64_t(nCascades) * worker / nWorkers;
+      const int last = int64_t(nCascades) * (worker + 1) / nWorkers;
+      for (int i = first; i < last; ++i) {
+        auto cascade = cascades.iteratorAt(i);
+        const int bachelorCollision = trackCollisions[cascade.bachelorId()];
+        const int posCollision = trackCollisions[v0PosTracks[cascade.v0Id()]];
+        const int negCollision = trackCollisions[v0NegTracks[cascade.v0Id()]];
+        cascadeCollisions[i] = bachelorCollision;
+        consistent[i] = bachelorCollision == posCollision && posCollision == negCollision;
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int worker = 1; worker < nWorkers; ++worker) {
+      workers.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    cascades_001.reserve(nCascades);
     for (auto& cascade : cascades) {
-      if (cascade.bachelor().collisionId() != cascade.v0().posTrack().collisionId() || cascade.v0().posTrack().collisionId() != cascade.v0().negTrack().collisionId()) {
+      const auto i = cascade.globalIndex();
+      if (!consistent[i]) {
         LOGF(fatal, "Cascade %d has inconsistent collision information (%d, %d, %d) track ids %d %d %d", cascade.globalIndex(), cascade.bachelor().collisionId(),
              cascade.v0().posTrack().collisionId(), cascade.v0().negTrack().collisionId(), cascade.bachelorId(), cascade.v0().posTrackId(), cascade.v0().negTrackId());
       }
-      cascades_001(cascade.bachelor().collisionId(), cascade.v0Id(), cascade.bachelorId());
+      cascades_001(cascadeCollisions[i], cascade.v0Id(), cascade.bachelorId());
     }
   }
 };
@@ -10,24 +10,30 @@
 // or submit itself to any jurisdiction.
 
 // This task finds minimum and maximum orbit among all processed bcs
+// and the coverage of the orbits in between
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "CommonConstants/LHCConstants.h"
 #include "OrbitRange.h"
-#include "TMath.h"
 using namespace o2;
 using namespace o2::framework;
 
 struct OrbitRangeTask {
+  Configurable<int> orbitsPerBin{"orbitsPerBin", 32, "Number of orbits per bin of the orbit coverage (1: orbit granularity, 32: one Run 3 TF)"};
   OutputObj<OrbitRange> orbitRange{OrbitRange("orbitRange")};
+
+  void init(InitContext&)
+  {
+    orbitRange->SetOrbitsPerBin(orbitsPerBin);
+  }
+
   void process(aod::BC const& bc)
   {
     uint32_t orbit = bc.globalBC() / o2::constants::lhc::LHCMaxBunches;
     orbitRange->SetRunNumber(bc.runNumber());
-    orbitRange->SetMinOrbit(TMath::Min(orbit, orbitRange->GetMinOrbit()));
-    orbitRange->SetMaxOrbit(TMath::Max(orbit, orbitRange->GetMaxOrbit()));
+    orbitRange->AddOrbit(orbit);
   }
 };
 
@@ -16,6 +16,10 @@
 // - victor.gonzalez@cern.ch
 // - david.dobrigkeit.chinellato@cern.ch
 //
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
 #include "TList.h"
 #include "TDirectory.h"
 #include "TFile.h"
@@ -37,6 +41,8 @@ multCalibrator::multCalibrator() : TNamed(),
                                    fkPrecisionWarningThreshold(1.0),
                                    fInputFileName("AnalysisResults.root"),
                                    fOutputFileName("CCDB-objects.root"),
+                                   fRunListFileName("runs.txt"),
+                                   fNThreads(1),
                                    fCalibHists(0x0),
                                    fPrecisionHistogram(0x0)
 {
@@ -52,6 +58,8 @@ multCalibrator::multCalibrator(const char* name, const char* title) : TNamed(nam
                                                                       fkPrecisionWarningThreshold(1.0),
                                                                       fInputFileName("AnalysisResults.root"),
                                                                       fOutputFileName("CCDB-objects.root"),
+                                                                      fRunListFileName("runs.txt"),
+                                                                      fNThreads(1),
                                                                       fCalibHists(0x0),
                                                                       fPrecisionHistogram(0x0)
 {
@@ -121,6 +129,164 @@ Bool_t multCalibrator::Calibrate()
   return kTRUE;
 }
 
+//________________________________________________________________
+Bool_t multCalibrator::CalibrateRuns()
+{
+  // Batch version of Calibrate
+  //
+  // --- input : fRunListFileName, with the run numbers and their input files
+  // --- output: one file per run, containing the calibration TList
+  //
+  // The input histograms are all read first, the boundaries of all the
+  // (run, estimator) pairs are then computed over fNThreads threads
+
+  cout << "=== STARTING BATCH CALIBRATION PROCEDURE ===" << endl;
+  cout << " * Run list.......: " << fRunListFileName.Data() << endl;
+  cout << " * Threads........: " << fNThreads << endl;
+  cout << endl;
+
+  std::vector<Int_t> lRuns;
+  std::vector<TString> lFiles;
+  std::ifstream lRunList(fRunListFileName.Data());
+  Int_t lRun;
+  std::string lFile;
+  while (lRunList >> lRun >> lFile) {
+    lRuns.push_back(lRun);
+    lFiles.push_back(lFile.c_str());
+  }
+  if (lRuns.empty()) {
+    cout << "No runs found in the run list!" << endl;
+    return kFALSE;
+  }
+  if (lNDesiredBoundaries < 2) {
+    cout << "Please set the boundaries before calibrating!" << endl;
+    return kFALSE;
+  }
+
+  //Step 1: read the input histograms of all the runs
+  const Long_t lNRuns = lRuns.size();
+  std::vector<TH1D*> hRaw(lNRuns * kNCentEstim, nullptr);
+  for (Long_t ir = 0; ir < lNRuns; ir++) {
+    TFile* fileInput = TFile::Open(lFiles[ir].Data(), "READ");
+    if (!fileInput || fileInput->IsZombie()) {
+      cout << "Input file " << lFiles[ir].Data() << " of run " << lRuns[ir] << " not found!" << endl;
+      return kFALSE;
+    }
+    for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+      TH1D* h = (TH1D*)fileInput->Get(Form("multiplicity-qa/multiplicityQa/h%s", fCentEstimName[iv].Data()));
+      if (!h) {
+        cout << Form("File of run %d does not contain histogram h%s, which is necessary for calibration!", lRuns[ir], fCentEstimName[iv].Data()) << endl;
+        return kFALSE;
+      }
+      h->SetDirectory(0);
+      hRaw[ir * kNCentEstim + iv] = h;
+    }
+    fileInput->Close();
+    delete fileInput;
+  }
+  cout << "Histograms of " << lNRuns << " runs loaded! Will now calibrate..." << endl;
+
+  //Step 2: boundaries of all the (run, estimator) pairs
+  const Long_t lNJobs = hRaw.size();
+  std::vector<Double_t> lBounds(lNJobs * lNDesiredBoundaries);
+  std::vector<Double_t> lPrecision(lNJobs * lNDesiredBoundaries);
+  auto lWork = [&](Int_t lWorker, Int_t lNWorkers) {
+    for (Long_t ij = lWorker; ij < lNJobs; ij += lNWorkers)
+      ComputeBoundaries(hRaw[ij], &lBounds[ij * lNDesiredBoundaries], &lPrecision[ij * lNDesiredBoundaries]);
+  };
+  const Int_t lNWorkers = std::max(1, std::min<Int_t>(fNThreads, lNJobs));
+  std::vector<std::thread> lWorkers;
+  for (Int_t lWorker = 1; lWorker < lNWorkers; lWorker++)
+    lWorkers.emplace_back(lWork, lWorker, lNWorkers);
+  lWork(0, lNWorkers);
+  for (auto& lWorker : lWorkers)
+    lWorker.join();
+
+  //Step 3: one calibration list per run
+  TString lOutputBase = fOutputFileName;
+  if (lOutputBase.EndsWith(".root"))
+    lOutputBase.Remove(lOutputBase.Length() - 5);
+  for (Long_t ir = 0; ir < lNRuns; ir++) {
+    TList* lCalibList = new TList();
+    lCalibList->SetOwner(kTRUE);
+    for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+      const Long_t ij = ir * kNCentEstim + iv;
+      for (Long_t ii = 1; ii < lNDesiredBoundaries - 1; ii++) {
+        if (lPrecision[ij * lNDesiredBoundaries + ii] / TMath::Abs(lDesiredBoundaries[ii + 1] - lDesiredBoundaries[ii]) > fkPrecisionWarningThreshold ||
+            lPrecision[ij * lNDesiredBoundaries + ii] / TMath::Abs(lDesiredBoundaries[ii - 1] - lDesiredBoundaries[ii]) > fkPrecisionWarningThreshold) {
+          cout << Form("Run %d, estimator %s: WARNING: BINNING MAY LEAD TO IMPRECISION!", lRuns[ir], fCentEstimName[iv].Data()) << endl;
+          break;
+        }
+      }
+      TH1F* hCalib = new TH1F(Form("hCalib%s", fCentEstimName[iv].Data()), "", lNDesiredBoundaries - 1, &lBounds[ij * lNDesiredBoundaries]);
+      hCalib->SetDirectory(0);
+      hCalib->SetBinContent(0, 100.5);
+      for (Long_t ibin = 1; ibin < lNDesiredBoundaries; ibin++)
+        hCalib->SetBinContent(ibin, 0.5 * (lDesiredBoundaries[ibin] + lDesiredBoundaries[ibin - 1]));
+      lCalibList->Add(hCalib);
+    }
+    TString lOutputFileName = Form("%s_%d.root", lOutputBase.Data(), lRuns[ir]);
+    cout << "Saving calibration of run " << lRuns[ir] << " in " << lOutputFileName.Data() << endl;
+    TFile* fOut = new TFile(lOutputFileName.Data(), "RECREATE");
+    lCalibList->Write("ccdb_object", TObject::kSingleKey);
+    fOut->Close();
+    delete fOut;
+    delete lCalibList;
+  }
+  for (auto& h : hRaw)
+    delete h;
+
+  cout << "Done! Enjoy!" << endl;
+  return kTRUE;
+}
+
+//________________________________________________________________
+void multCalibrator::ComputeBoundaries(TH1D* histo, Double_t* lBounds, Double_t* lPrecision)
+{
+  //Same procedure as GetBoundaryForPercentile for all the desired boundaries,
+  //with the running count of GetBoundaryForPercentile computed once and
+  //the bin of each percentile found by binary search
+  const Double_t lPrecisionConstant = 2.0;
+  const Double_t lRawMax = GetRawMax(histo);
+  const Double_t lEntries = histo->GetEntries();
+  const Long_t lNBins = histo->GetNbinsX();
+
+  std::vector<Long_t> lCumulative(std::max(1L, lNBins), 0); //running count up to each bin (index 0 unused)
+  Long_t lCount = 0;
+  for (Long_t ibin = 1; ibin < lNBins; ibin++) {
+    lCount += histo->GetBinContent(ibin);
+    lCumulative[ibin] = lCount;
+  }
+
+  for (Long_t ii = 0; ii < lNDesiredBoundaries; ii++) {
+    const Double_t lPercentileRequested = lDesiredBoundaries[ii];
+    lPrecision[ii] = -1;
+    if (lPercentileRequested < 1e-7) {
+      lBounds[ii] = lRawMax; //safeguard
+      continue;
+    }
+    if (lPercentileRequested > 100 - 1e-7) {
+      lBounds[ii] = 0.0; //safeguard
+      continue;
+    }
+    const Double_t lPercentile = 100.0 - lPercentileRequested;
+    const Double_t lCountDesired = lPercentile * lEntries / 100;
+    auto lFound = std::lower_bound(lCumulative.begin() + 1, lCumulative.end(), lCountDesired,
+                                   [](Long_t lC, Double_t lDesired) { return lC < lDesired; });
+    if (lFound == lCumulative.end()) {
+      lBounds[ii] = 0.0;
+      continue;
+    }
+    const Long_t ibin = lFound - lCumulative.begin();
+    Double_t lWidth = histo->GetBinWidth(ibin);
+    Double_t lLeftPercentile = 100. * (*lFound - histo->GetBinContent(ibin)) / lEntries;
+    Double_t lRightPercentile = 100. * (*lFound) / lEntries;
+    lPrecision[ii] = (lRightPercentile - lLeftPercentile) / lPrecisionConstant;
+    Double_t lProportion = (lPercentile - lLeftPercentile) / (lRightPercentile - lLeftPercentile);
+    lBounds[ii] = histo->GetBinLowEdge(ibin) + lProportion * lWidth;
+  }
+}
+
 Double_t multCalibrator::GetRawMax(TH1D* histo)
 {
   //This function gets the max X value (right edge) which is filled.
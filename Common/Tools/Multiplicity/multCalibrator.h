@@ -60,6 +60,14 @@ class multCalibrator : public TNamed
   //Master Function in this Class: To be called once filenames are set
   Bool_t Calibrate();
 
+  //Batch mode: all estimators of several runs, one input file per run.
+  //The run list file contains one "<run number> <input file>" pair per line.
+  //One CCDB-ready TList (key "ccdb_object") is written per run, in
+  //<output file name>_<run number>.root
+  void SetRunListFile(TString lFile) { fRunListFileName = lFile.Data(); }
+  void SetNThreads(Int_t lNThreads) { fNThreads = lNThreads; }
+  Bool_t CalibrateRuns();
+
   //Aux function. Keep public, accessible outside as rather useful utility
   TH1F* GetCalibrationHistogram(TH1D* histoRaw, TString lHistoName = "hCalib");
 
@@ -95,12 +103,18 @@ class multCalibrator : public TNamed
   TString fInputFileName;  // Filename for TTree object for calibration purposes
   TString fBufferFileName; // Filename for TTree object (buffer file)
   TString fOutputFileName; // Filename for calibration OADB output
+  TString fRunListFileName; // Filename for the list of runs (batch mode)
+  Int_t fNThreads;          // Number of threads (batch mode)
 
   // TList object for storing histograms
   TList* fCalibHists;
 
   TH1D* fPrecisionHistogram; //for bookkeeping of precision report
 
+  //Boundaries and precisions for all the desired percentiles from a single
+  //cumulative sum (same values as GetBoundaryForPercentile), thread safe
+  void ComputeBoundaries(TH1D* histo, Double_t* lBounds, Double_t* lPrecision);
+
   ClassDef(multCalibrator, 1);
   //(this classdef is only for bookkeeping, class will not usually
   // be streamed according to current workflow except in very specific
@@ -25,6 +25,8 @@
  *
  **********************************************/
 
+#include <algorithm>
+#include <thread>
 #include "multGlauberNBDFitter.h"
 #include "TList.h"
 #include "TFile.h"
@@ -40,6 +42,7 @@ multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
                                                fNBD(0x0),
                                                fhNanc(0x0),
                                                fhNpNc(0x0),
+                                               fhV0M(0x0),
                                                ffChanged(kTRUE),
                                                fCurrentf(-1),
                                                fAncestorMode(2),
@@ -53,7 +56,11 @@ multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
                                                ff(0.8),
                                                fnorm(100),
                                                fFitOptions("R0"),
-                                               fFitNpx(5000)
+                                               fFitNpx(5000),
+                                               fFastEvaluation(kFALSE),
+                                               fNThreads(1),
+                                               fCachedPar{-1, -1, -1},
+                                               fCachedDistrib()
 {
   // Constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -80,6 +87,7 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
                                                                                   fNBD(0x0),
                                                                                   fhNanc(0x0),
                                                                                   fhNpNc(0x0),
+                                                                                  fhV0M(0x0),
                                                                                   ffChanged(kTRUE),
                                                                                   fCurrentf(-1),
                                                                                   fAncestorMode(2),
@@ -93,7 +101,11 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
                                                                                   ff(0.8),
                                                                                   fnorm(100),
                                                                                   fFitOptions("R0"),
-                                                                                  fFitNpx(5000)
+                                                                                  fFitNpx(5000),
+                                                                                  fFastEvaluation(kFALSE),
+                                                                                  fNThreads(1),
+                                                                                  fCachedPar{-1, -1, -1},
+                                                                                  fCachedDistrib()
 {
   //Named constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -176,6 +188,15 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
     fhNanc->Scale(1. / fhNanc->Integral());
   }
   //______________________________________________________
+  //Fast evaluation: read the distribution evaluated once for these parameters
+  if (fFastEvaluation && fAncestorMode == 2 && fhV0M) {
+    if (ffChanged || par[0] != fCachedPar[0] || par[1] != fCachedPar[1] || par[2] != fCachedPar[2])
+      EvaluateDistribution(par);
+    Int_t lBin = fhV0M->FindBin(lMultValue);
+    if (lBin < static_cast<Int_t>(fCachedDistrib.size()) && lMultValue == fhV0M->GetBinCenter(lBin))
+      return par[3] * fCachedDistrib[lBin];
+  }
+  //______________________________________________________
   //Actually evaluate function
   Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
   for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
@@ -197,6 +218,66 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
   return par[3] * lProbability;
 }
 
+//______________________________________________________
+void multGlauberNBDFitter::EvaluateDistribution(Double_t* par)
+//Evaluates the distribution (without normalization) at all the bin centers
+//of fhV0M in the fit range, with the ancestor distribution already filled for par[2].
+//In the logarithm of the continuous NBD of ContinuousNBD, mu/k is the same for
+//all the ancestors and log(Gamma(n+1)) is the same for all of them at a given n,
+//so that only log(Gamma(n+k)) is left per (n, ancestor) pair.
+{
+  fCachedPar[0] = par[0];
+  fCachedPar[1] = par[1];
+  fCachedPar[2] = par[2];
+  fCachedDistrib.assign(fhV0M->GetNbinsX() + 2, 0.0);
+
+  //non-empty ancestor bins, with the Nancestor-dependent terms
+  std::vector<Double_t> lCounts, lThisk, lLnGammak;
+  Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
+  for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
+    Double_t lNancestorCount = fhNanc->GetBinContent(iNanc);
+    if (lNancestorCount == 0)
+      continue;
+    Double_t lNancestors = fhNanc->GetBinCenter(iNanc);
+    lCounts.push_back(lNancestorCount);
+    lThisk.push_back(lNancestors * par[1]);
+    lLnGammak.push_back(TMath::LnGamma(lThisk.back()));
+  }
+  const Long_t lNAnc = lCounts.size();
+  const Double_t lLogMuOverK = TMath::Log(par[0] / par[1]);
+  const Double_t lLog1PlusMuOverK = TMath::Log(1.0 + par[0] / par[1]);
+
+  Double_t lLoRange, lHiRange;
+  fGlauberNBD->GetRange(lLoRange, lHiRange);
+  const Int_t lFirstBin = std::max(1, fhV0M->FindBin(lLoRange));
+  const Int_t lLastBin = std::min(fhV0M->GetNbinsX(), fhV0M->FindBin(lHiRange));
+  const Int_t lNBins = lLastBin - lFirstBin + 1;
+  if (lNBins <= 0)
+    return;
+
+  auto lEvaluate = [&](Int_t lWorker, Int_t lNWorkers) {
+    for (Int_t lBin = lFirstBin + lNBins * lWorker / lNWorkers; lBin < lFirstBin + lNBins * (lWorker + 1) / lNWorkers; lBin++) {
+      Double_t n = fhV0M->GetBinCenter(lBin);
+      if (n <= 1e-6)
+        continue;
+      Double_t lCommon = n * (lLogMuOverK - lLog1PlusMuOverK) - TMath::LnGamma(n + 1.);
+      Double_t lProbability = 0.0;
+      for (Long_t iAnc = 0; iAnc < lNAnc; iAnc++) {
+        Double_t k = lThisk[iAnc];
+        lProbability += lCounts[iAnc] * TMath::Exp(lCommon + TMath::LnGamma(n + k) - lLnGammak[iAnc] - k * lLog1PlusMuOverK);
+      }
+      fCachedDistrib[lBin] = lProbability;
+    }
+  };
+  const Int_t lNWorkers = std::max(1, std::min(fNThreads, lNBins));
+  std::vector<std::thread> lWorkers;
+  for (Int_t lWorker = 1; lWorker < lNWorkers; lWorker++)
+    lWorkers.emplace_back(lEvaluate, lWorker, lNWorkers);
+  lEvaluate(0, lNWorkers);
+  for (auto& lWorker : lWorkers)
+    lWorker.join();
+}
+
 //________________________________________________________________
 Bool_t multGlauberNBDFitter::SetNpartNcollCorrelation(TH2* hNpNc)
 {
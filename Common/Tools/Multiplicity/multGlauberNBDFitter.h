@@ -13,6 +13,7 @@
 #define MULTGLAUBERNBDFITTER_H
 
 #include <iostream>
+#include <vector>
 #include "TNamed.h"
 #include "TF1.h"
 #include "TH1.h"
@@ -72,12 +73,24 @@ class multGlauberNBDFitter : public TNamed
   void SetFitOptions(TString lOpt);
   void SetFitNpx(Long_t lNpx);
 
+  //Fast evaluation (ancestor mode 2 only): the full distribution is evaluated
+  //at the bin centers of the input histogram once per set of parameters,
+  //using lNThreads threads, and then read back by the fit function
+  void SetFastEvaluation(Bool_t lVal = kTRUE, Int_t lNThreads = 1)
+  {
+    fFastEvaluation = lVal;
+    fNThreads = lNThreads;
+  }
+
   //For ancestor mode 2
   Double_t ContinuousNBD(Double_t n, Double_t mu, Double_t k);
 
   //For estimating Npart, Ncoll in multiplicity bins
   void CalculateAvNpNc(TProfile* lNPartProf, TProfile* lNCollProf);
 
+  //Evaluates the full distribution for the fast evaluation
+  void EvaluateDistribution(Double_t* par);
+
   //void    Print(Option_t *option="") const;
 
  private:
@@ -115,6 +128,12 @@ class multGlauberNBDFitter : public TNamed
   TString fFitOptions;
   Long_t fFitNpx;
 
+  //Fast evaluation: distribution at the bin centers of fhV0M for the cached parameters
+  Bool_t fFastEvaluation;                //!
+  Int_t fNThreads;                       //!
+  Double_t fCachedPar[3];                //! mu, k, f of the cached distribution
+  std::vector<Double_t> fCachedDistrib;  //! distribution (without normalization) per bin of fhV0M
+
   ClassDef(multGlauberNBDFitter, 1);
 };
 #endif
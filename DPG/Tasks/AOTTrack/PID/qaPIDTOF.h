@@ -175,26 +175,31 @@ struct tofPidQa {
   Configurable<bool> applyRapidityCut{"applyRapidityCut", false, "Flag to apply rapidity cut"};
   Configurable<bool> enableEvTimeSplitting{"enableEvTimeSplitting", false, "Flag to enable histograms splitting depending on the Event Time used"};
 
+  // Species filled together in a single loop over the tracks by the multi-particle process functions
+  static constexpr bool isLightParticle(o2::track::PID::ID id) { return id == PID::Electron || id == PID::Pion || id == PID::Kaon || id == PID::Proton; }
+  static constexpr bool isNucleus(o2::track::PID::ID id) { return id == PID::Deuteron || id == PID::Triton || id == PID::Helium3 || id == PID::Alpha; }
+
   template <o2::track::PID::ID id>
   void initPerParticle(const AxisSpec& pAxis, const AxisSpec& ptAxis)
   {
     static_assert(id >= 0 && id <= PID::Alpha && "Particle index outside limits");
     bool enableFullHistos = false;
     int enabledProcesses = 0;
+    const bool doMultiFull = (isLightParticle(id) && doprocessFullLight) || (isNucleus(id) && doprocessFullNuclei);
     switch (id) { // Skipping disabled particles
-#define particleCase(particleId)                                 \
-  case PID::particleId:                                          \
-    if (!doprocess##particleId && !doprocessFull##particleId) {  \
-      return;                                                    \
-    }                                                            \
-    if (doprocess##particleId) {                                 \
-      enabledProcesses++;                                        \
-    }                                                            \
-    if (doprocessFull##particleId) {                             \
-      enableFullHistos = true;                                   \
-      enabledProcesses++;                                        \
-    }                                                            \
-    LOGF(info, "Enabled TOF QA for %s %s", #particleId, pT[id]); \
+#define particleCase(particleId)                                                \
+  case PID::particleId:                                                         \
+    if (!doprocess##particleId && !doprocessFull##particleId && !doMultiFull) { \
+      return;                                                                   \
+    }                                                                           \
+    if (doprocess##particleId) {                                                \
+      enabledProcesses++;                                                       \
+    }                                                                           \
+    if (doprocessFull##particleId) {                                            \
+      enableFullHistos = true;                                                  \
+      enabledProcesses++;                                                       \
+    }                                                                           \
+    LOGF(info, "Enabled TOF QA for %s %s", #particleId, pT[id]);                \
     break;
 
       particleCase(Electron);
@@ -208,6 +213,10 @@ struct tofPidQa {
       particleCase(Alpha);
 #undef particleCase
     }
+    if (doMultiFull) {
+      enableFullHistos = true;
+      enabledProcesses++;
+    }
     if (enabledProcesses != 1) {
       LOG(fatal) << "Cannot enable more than one process function per particle, check and retry!";
     }
@@ -506,112 +515,138 @@ struct tofPidQa {
 
   template <o2::track::PID::ID id, bool fillFullHistograms,
             typename TrackType>
-  void processSingleParticle(CollisionCandidate const& collision,
-                             TrackType const& tracks)
+  void fillParticleHistograms(const TrackType& t)
   {
-    if (!isEventSelected<false>(collision, tracks)) {
-      return;
-    }
-
-    for (auto t : tracks) {
-      if (!isTrackSelected<false>(collision, t)) {
-        continue;
+    if (applyRapidityCut) {
+      if (abs(t.rapidity(PID::getMass(id))) > 0.5) {
+        return;
       }
+    }
 
-      if (applyRapidityCut) {
-        if (abs(t.rapidity(PID::getMass(id))) > 0.5) {
-          continue;
+    const auto nsigma = o2::aod::pidutils::tofNSigma<id>(t);
+    histos.fill(HIST(hnsigma[id]), t.p(), nsigma);
+    histos.fill(HIST(hnsigma_pt[id]), t.pt(), nsigma);
+    if (t.sign() > 0) {
+      histos.fill(HIST(hnsigma_pt_pos[id]), t.pt(), nsigma);
+    } else {
+      histos.fill(HIST(hnsigma_pt_neg[id]), t.pt(), nsigma);
+    }
+    // Filling info split per ev. time
+    if (enableEvTimeSplitting) {
+      if (t.isEvTimeTOF() && t.isEvTimeT0AC()) { // TOF + FT0 Ev. Time
+        histos.fill(HIST(hnsigma_evtime_tofft0[id]), t.p(), nsigma);
+        histos.fill(HIST(hnsigma_pt_evtime_tofft0[id]), t.pt(), nsigma);
+        if (t.sign() > 0) {
+          histos.fill(HIST(hnsigma_pt_pos_evtime_tofft0[id]), t.pt(), nsigma);
+        } else {
+          histos.fill(HIST(hnsigma_pt_neg_evtime_tofft0[id]), t.pt(), nsigma);
+        }
+      } else if (t.isEvTimeT0AC()) { // FT0 Ev. Time
+        histos.fill(HIST(hnsigma_evtime_ft0[id]), t.p(), nsigma);
+        histos.fill(HIST(hnsigma_pt_evtime_ft0[id]), t.pt(), nsigma);
+        if (t.sign() > 0) {
+          histos.fill(HIST(hnsigma_pt_pos_evtime_ft0[id]), t.pt(), nsigma);
+        } else {
+          histos.fill(HIST(hnsigma_pt_neg_evtime_ft0[id]), t.pt(), nsigma);
+        }
+      } else if (t.isEvTimeTOF()) { // TOF Ev. Time
+        histos.fill(HIST(hnsigma_evtime_tof[id]), t.p(), nsigma);
+        histos.fill(HIST(hnsigma_pt_evtime_tof[id]), t.pt(), nsigma);
+        if (t.sign() > 0) {
+          histos.fill(HIST(hnsigma_pt_pos_evtime_tof[id]), t.pt(), nsigma);
+        } else {
+          histos.fill(HIST(hnsigma_pt_neg_evtime_tof[id]), t.pt(), nsigma);
+        }
+      } else { // No Ev. Time -> Fill Ev. Time
+        histos.fill(HIST(hnsigma_evtime_fill[id]), t.p(), nsigma);
+        histos.fill(HIST(hnsigma_pt_evtime_fill[id]), t.pt(), nsigma);
+        if (t.sign() > 0) {
+          histos.fill(HIST(hnsigma_pt_pos_evtime_fill[id]), t.pt(), nsigma);
+        } else {
+          histos.fill(HIST(hnsigma_pt_neg_evtime_fill[id]), t.pt(), nsigma);
         }
       }
-
-      const auto nsigma = o2::aod::pidutils::tofNSigma<id>(t);
-      histos.fill(HIST(hnsigma[id]), t.p(), nsigma);
-      histos.fill(HIST(hnsigma_pt[id]), t.pt(), nsigma);
+    }
+    if constexpr (fillFullHistograms) {
+      const float tof = t.tofSignal() - t.tofEvTime();
+      const auto diff = o2::aod::pidutils::tofExpSignalDiff<id>(t);
+      histos.fill(HIST(hexpected[id]), t.p(), tof - diff);
+      histos.fill(HIST(hdelta[id]), t.p(), diff);
       if (t.sign() > 0) {
-        histos.fill(HIST(hnsigma_pt_pos[id]), t.pt(), nsigma);
+        histos.fill(HIST(hdelta_pt_pos[id]), t.p(), diff);
       } else {
-        histos.fill(HIST(hnsigma_pt_neg[id]), t.pt(), nsigma);
+        histos.fill(HIST(hdelta_pt_neg[id]), t.p(), diff);
       }
       // Filling info split per ev. time
       if (enableEvTimeSplitting) {
         if (t.isEvTimeTOF() && t.isEvTimeT0AC()) { // TOF + FT0 Ev. Time
-          histos.fill(HIST(hnsigma_evtime_tofft0[id]), t.p(), nsigma);
-          histos.fill(HIST(hnsigma_pt_evtime_tofft0[id]), t.pt(), nsigma);
+          histos.fill(HIST(hdelta_evtime_tofft0[id]), t.p(), diff);
           if (t.sign() > 0) {
-            histos.fill(HIST(hnsigma_pt_pos_evtime_tofft0[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_pos_evtime_tofft0[id]), t.p(), diff);
           } else {
-            histos.fill(HIST(hnsigma_pt_neg_evtime_tofft0[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_neg_evtime_tofft0[id]), t.p(), diff);
           }
         } else if (t.isEvTimeT0AC()) { // FT0 Ev. Time
-          histos.fill(HIST(hnsigma_evtime_ft0[id]), t.p(), nsigma);
-          histos.fill(HIST(hnsigma_pt_evtime_ft0[id]), t.pt(), nsigma);
+          histos.fill(HIST(hdelta_evtime_ft0[id]), t.p(), diff);
           if (t.sign() > 0) {
-            histos.fill(HIST(hnsigma_pt_pos_evtime_ft0[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_pos_evtime_ft0[id]), t.p(), diff);
           } else {
-            histos.fill(HIST(hnsigma_pt_neg_evtime_ft0[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_neg_evtime_ft0[id]), t.p(), diff);
           }
         } else if (t.isEvTimeTOF()) { // TOF Ev. Time
-          histos.fill(HIST(hnsigma_evtime_tof[id]), t.p(), nsigma);
-          histos.fill(HIST(hnsigma_pt_evtime_tof[id]), t.pt(), nsigma);
+          histos.fill(HIST(hdelta_evtime_tof[id]), t.p(), diff);
           if (t.sign() > 0) {
-            histos.fill(HIST(hnsigma_pt_pos_evtime_tof[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_pos_evtime_tof[id]), t.p(), diff);
           } else {
-            histos.fill(HIST(hnsigma_pt_neg_evtime_tof[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_neg_evtime_tof[id]), t.p(), diff);
           }
         } else { // No Ev. Time -> Fill Ev. Time
-          histos.fill(HIST(hnsigma_evtime_fill[id]), t.p(), nsigma);
-          histos.fill(HIST(hnsigma_pt_evtime_fill[id]), t.pt(), nsigma);
+          histos.fill(HIST(hdelta_evtime_fill[id]), t.p(), diff);
           if (t.sign() > 0) {
-            histos.fill(HIST(hnsigma_pt_pos_evtime_fill[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_pos_evtime_fill[id]), t.p(), diff);
           } else {
-            histos.fill(HIST(hnsigma_pt_neg_evtime_fill[id]), t.pt(), nsigma);
+            histos.fill(HIST(hdelta_pt_neg_evtime_fill[id]), t.p(), diff);
           }
         }
       }
-      if constexpr (fillFullHistograms) {
-        const float tof = t.tofSignal() - t.tofEvTime();
-        const auto diff = o2::aod::pidutils::tofExpSignalDiff<id>(t);
-        histos.fill(HIST(hexpected[id]), t.p(), tof - diff);
-        histos.fill(HIST(hdelta[id]), t.p(), diff);
-        if (t.sign() > 0) {
-          histos.fill(HIST(hdelta_pt_pos[id]), t.p(), diff);
-        } else {
-          histos.fill(HIST(hdelta_pt_neg[id]), t.p(), diff);
-        }
-        // Filling info split per ev. time
-        if (enableEvTimeSplitting) {
-          if (t.isEvTimeTOF() && t.isEvTimeT0AC()) { // TOF + FT0 Ev. Time
-            histos.fill(HIST(hdelta_evtime_tofft0[id]), t.p(), diff);
-            if (t.sign() > 0) {
-              histos.fill(HIST(hdelta_pt_pos_evtime_tofft0[id]), t.p(), diff);
-            } else {
-              histos.fill(HIST(hdelta_pt_neg_evtime_tofft0[id]), t.p(), diff);
-            }
-          } else if (t.isEvTimeT0AC()) { // FT0 Ev. Time
-            histos.fill(HIST(hdelta_evtime_ft0[id]), t.p(), diff);
-            if (t.sign() > 0) {
-              histos.fill(HIST(hdelta_pt_pos_evtime_ft0[id]), t.p(), diff);
-            } else {
-              histos.fill(HIST(hdelta_pt_neg_evtime_ft0[id]), t.p(), diff);
-            }
-          } else if (t.isEvTimeTOF()) { // TOF Ev. Time
-            histos.fill(HIST(hdelta_evtime_tof[id]), t.p(), diff);
-            if (t.sign() > 0) {
-              histos.fill(HIST(hdelta_pt_pos_evtime_tof[id]), t.p(), diff);
-            } else {
-              histos.fill(HIST(hdelta_pt_neg_evtime_tof[id]), t.p(), diff);
-            }
-          } else { // No Ev. Time -> Fill Ev. Time
-            histos.fill(HIST(hdelta_evtime_fill[id]), t.p(), diff);
-            if (t.sign() > 0) {
-              histos.fill(HIST(hdelta_pt_pos_evtime_fill[id]), t.p(), diff);
-            } else {
-              histos.fill(HIST(hdelta_pt_neg_evtime_fill[id]), t.p(), diff);
-            }
-          }
-        }
-        histos.fill(HIST(hexpsigma[id]), t.p(), o2::aod::pidutils::tofExpSigma<id>(t));
+      histos.fill(HIST(hexpsigma[id]), t.p(), o2::aod::pidutils::tofExpSigma<id>(t));
+    }
+  }
+
+  template <o2::track::PID::ID id, bool fillFullHistograms,
+            typename TrackType>
+  void processSingleParticle(CollisionCandidate const& collision,
+                             TrackType const& tracks)
+  {
+    if (!isEventSelected<false>(collision, tracks)) {
+      return;
+    }
+
+    for (auto t : tracks) {
+      if (!isTrackSelected<false>(collision, t)) {
+        continue;
       }
+      fillParticleHistograms<id, fillFullHistograms>(t);
+    }
+  }
+
+  /// Fills the histograms of several particle species in a single pass over the tracks,
+  /// the event and track selections are evaluated once for all the species
+  template <bool fillFullHistograms,
+            o2::track::PID::ID... ids,
+            typename TrackType>
+  void processMultipleParticles(CollisionCandidate const& collision,
+                                TrackType const& tracks)
+  {
+    if (!isEventSelected<false>(collision, tracks)) {
+      return;
+    }
+
+    for (auto t : tracks) {
+      if (!isTrackSelected<false>(collision, t)) {
+        continue;
+      }
+      (fillParticleHistograms<ids, fillFullHistograms>(t), ...);
     }
   }
 
@@ -658,6 +693,25 @@ struct tofPidQa {
   makeProcessFunction(aod::pidTOFFullHe, Helium3);
   makeProcessFunction(aod::pidTOFFullAl, Alpha);
 #undef makeProcessFunction
+
+  // QA of full tables, several species per process function
+  void processFullLight(CollisionCandidate const& collision,
+                        soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection,
+                                  aod::pidEvTimeFlags, aod::TOFSignal, aod::TOFEvTime,
+                                  aod::pidTOFFullEl, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr> const& tracks)
+  {
+    processMultipleParticles<true, PID::Electron, PID::Pion, PID::Kaon, PID::Proton>(collision, tracks);
+  }
+  PROCESS_SWITCH(tofPidQa, processFullLight, "Process for the e, pi, K and p hypotheses for full TOF PID QA in a single loop", false);
+
+  void processFullNuclei(CollisionCandidate const& collision,
+                         soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection,
+                                   aod::pidEvTimeFlags, aod::TOFSignal, aod::TOFEvTime,
+                                   aod::pidTOFFullDe, aod::pidTOFFullTr, aod::pidTOFFullHe, aod::pidTOFFullAl> const& tracks)
+  {
+    processMultipleParticles<true, PID::Deuteron, PID::Triton, PID::Helium3, PID::Alpha>(collision, tracks);
+  }
+  PROCESS_SWITCH(tofPidQa, processFullNuclei, "Process for the d, t, 3He and alpha hypotheses for full TOF PID QA in a single loop", false);
 };
 
 #endif // DPG_TASKS_AOTTRACK_PID_QAPIDTOF_H_
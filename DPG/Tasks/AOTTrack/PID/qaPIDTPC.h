@@ -112,6 +112,10 @@ struct tpcPidQa {
   Configurable<bool> applyTrackCut{"applyTrackCut", false, "Flag to apply standard track cuts"};
   Configurable<bool> applyRapidityCut{"applyRapidityCut", false, "Flag to apply rapidity cut"};
 
+  // Species filled together in a single loop over the tracks by the multi-particle process functions
+  static constexpr bool isLightParticle(o2::track::PID::ID id) { return id == PID::Electron || id == PID::Pion || id == PID::Kaon || id == PID::Proton; }
+  static constexpr bool isNucleus(o2::track::PID::ID id) { return id == PID::Deuteron || id == PID::Triton || id == PID::Helium3 || id == PID::Alpha; }
+
   template <o2::track::PID::ID id>
   void initPerParticle(const AxisSpec& pAxis, const AxisSpec& ptAxis)
   {
@@ -119,25 +123,27 @@ struct tpcPidQa {
     bool enableTOFHistos = false;
     bool enableFullHistos = false;
     int enabledProcesses = 0;
+    const bool doMultiFull = (isLightParticle(id) && doprocessFullLight) || (isNucleus(id) && doprocessFullNuclei);
+    const bool doMultiFullWithTOF = (isLightParticle(id) && doprocessFullWithTOFLight) || (isNucleus(id) && doprocessFullWithTOFNuclei);
     switch (id) { // Skipping disabled particles
-#define particleCase(particleId)                                                                     \
-  case PID::particleId:                                                                              \
-    if (!doprocess##particleId && !doprocessFull##particleId && !doprocessFullWithTOF##particleId) { \
-      return;                                                                                        \
-    }                                                                                                \
-    if (doprocess##particleId) {                                                                     \
-      enabledProcesses++;                                                                            \
-    }                                                                                                \
-    if (doprocessFull##particleId) {                                                                 \
-      enableFullHistos = true;                                                                       \
-      enabledProcesses++;                                                                            \
-    }                                                                                                \
-    if (doprocessFullWithTOF##particleId) {                                                          \
-      enableFullHistos = true;                                                                       \
-      enableTOFHistos = true;                                                                        \
-      enabledProcesses++;                                                                            \
-    }                                                                                                \
-    LOGF(info, "Enabled TPC QA for %s %s", #particleId, pT[id]);                                     \
+#define particleCase(particleId)                                                                                                            \
+  case PID::particleId:                                                                                                                     \
+    if (!doprocess##particleId && !doprocessFull##particleId && !doprocessFullWithTOF##particleId && !doMultiFull && !doMultiFullWithTOF) { \
+      return;                                                                                                                               \
+    }                                                                                                                                       \
+    if (doprocess##particleId) {                                                                                                            \
+      enabledProcesses++;                                                                                                                   \
+    }                                                                                                                                       \
+    if (doprocessFull##particleId) {                                                                                                        \
+      enableFullHistos = true;                                                                                                              \
+      enabledProcesses++;                                                                                                                   \
+    }                                                                                                                                       \
+    if (doprocessFullWithTOF##particleId) {                                                                                                 \
+      enableFullHistos = true;                                                                                                              \
+      enableTOFHistos = true;                                                                                                               \
+      enabledProcesses++;                                                                                                                   \
+    }                                                                                                                                       \
+    LOGF(info, "Enabled TPC QA for %s %s", #particleId, pT[id]);                                                                            \
     break;
 
       particleCase(Electron);
@@ -151,6 +157,15 @@ struct tpcPidQa {
       particleCase(Alpha);
 #undef particleCase
     }
+    if (doMultiFull) {
+      enableFullHistos = true;
+      enabledProcesses++;
+    }
+    if (doMultiFullWithTOF) {
+      enableFullHistos = true;
+      enableTOFHistos = true;
+      enabledProcesses++;
+    }
     if (enabledProcesses != 1) {
       LOG(fatal) << "Cannot enable more than one process function per particle, check and retry!";
     }
@@ -345,6 +360,56 @@ struct tpcPidQa {
     }
   }
 
+  template <o2::track::PID::ID id, bool fillFullHistograms,
+            bool fillWithTOFHistograms,
+            typename TrackType>
+  void fillParticleHistograms(const TrackType& t)
+  {
+    if (applyRapidityCut) {
+      if (abs(t.rapidity(PID::getMass(id))) > 0.5) {
+        return;
+      }
+    }
+
+    const auto nsigma = o2::aod::pidutils::tpcNSigma<id>(t);
+    histos.fill(HIST(hnsigma[id]), t.p(), nsigma);
+    histos.fill(HIST(hnsigma_pt[id]), t.pt(), nsigma);
+    if (t.sign() > 0) {
+      histos.fill(HIST(hnsigma_pt_pos[id]), t.pt(), nsigma);
+    } else {
+      histos.fill(HIST(hnsigma_pt_neg[id]), t.pt(), nsigma);
+    }
+
+    if constexpr (fillFullHistograms) {
+      const auto& diff = o2::aod::pidutils::tpcExpSignalDiff<id>(t);
+      // Fill histograms
+      histos.fill(HIST(hexpected[id]), t.tpcInnerParam(), t.tpcSignal() - diff);
+      histos.fill(HIST(hdelta[id]), t.tpcInnerParam(), diff);
+      if (t.sign() > 0) {
+        histos.fill(HIST(hdelta_pt_pos[id]), t.pt(), diff);
+      } else {
+        histos.fill(HIST(hdelta_pt_neg[id]), t.pt(), diff);
+      }
+      histos.fill(HIST(hexpsigma[id]), t.tpcInnerParam(), o2::aod::pidutils::tpcExpSigma<id>(t));
+      if constexpr (fillWithTOFHistograms) {
+        if (std::abs(o2::aod::pidutils::tofNSigma<id>(t)) < 3.f) {
+          histos.fill(HIST(hexpected_wTOF[id]), t.tpcInnerParam(), t.tpcSignal() - diff);
+          histos.fill(HIST(hdelta_wTOF[id]), t.tpcInnerParam(), diff);
+          histos.fill(HIST(hexpsigma_wTOF[id]), t.p(), o2::aod::pidutils::tpcExpSigma<id>(t));
+        }
+      }
+    }
+    if constexpr (fillWithTOFHistograms) { // Filling nsigma (common to full and tiny)
+      const auto& nsigmatof = o2::aod::pidutils::tofNSigma<id>(t);
+      if (std::abs(nsigmatof) < 3.f) {
+        histos.fill(HIST(hnsigma_wTOF[id]), t.p(), nsigma);
+        histos.fill(HIST(hnsigma_pt_wTOF[id]), t.pt(), nsigma);
+        histos.fill(HIST(hsignal_wTOF[id]), t.tpcInnerParam(), t.tpcSignal());
+        // histos.fill(HIST("event/signedtpcsignal"), t.tpcInnerParam() * t.sign(), t.tpcSignal());
+      }
+    }
+  }
+
   template <o2::track::PID::ID id, bool fillFullHistograms,
             bool fillWithTOFHistograms,
             typename TrackType>
@@ -359,50 +424,27 @@ struct tpcPidQa {
       if (!isTrackSelected<false>(collision, t)) {
         continue;
       }
+      fillParticleHistograms<id, fillFullHistograms, fillWithTOFHistograms>(t);
+    }
+  }
 
-      if (applyRapidityCut) {
-        if (abs(t.rapidity(PID::getMass(id))) > 0.5) {
-          continue;
-        }
-      }
-
-      const auto nsigma = o2::aod::pidutils::tpcNSigma<id>(t);
-      histos.fill(HIST(hnsigma[id]), t.p(), nsigma);
-      histos.fill(HIST(hnsigma_pt[id]), t.pt(), nsigma);
-      if (t.sign() > 0) {
-        histos.fill(HIST(hnsigma_pt_pos[id]), t.pt(), nsigma);
-      } else {
-        histos.fill(HIST(hnsigma_pt_neg[id]), t.pt(), nsigma);
-      }
+  /// Fills the histograms of several particle species in a single pass over the tracks,
+  /// the event and track selections are evaluated once for all the species
+  template <bool fillFullHistograms, bool fillWithTOFHistograms,
+            o2::track::PID::ID... ids,
+            typename TrackType>
+  void processMultipleParticles(CollisionCandidate const& collision,
+                                TrackType const& tracks)
+  {
+    if (!isEventSelected<false>(collision, tracks)) {
+      return;
+    }
 
-      if constexpr (fillFullHistograms) {
-        const auto& diff = o2::aod::pidutils::tpcExpSignalDiff<id>(t);
-        // Fill histograms
-        histos.fill(HIST(hexpected[id]), t.tpcInnerParam(), t.tpcSignal() - diff);
-        histos.fill(HIST(hdelta[id]), t.tpcInnerParam(), diff);
-        if (t.sign() > 0) {
-          histos.fill(HIST(hdelta_pt_pos[id]), t.pt(), diff);
-        } else {
-          histos.fill(HIST(hdelta_pt_neg[id]), t.pt(), diff);
-        }
-        histos.fill(HIST(hexpsigma[id]), t.tpcInnerParam(), o2::aod::pidutils::tpcExpSigma<id>(t));
-        if constexpr (fillWithTOFHistograms) {
-          if (std::abs(o2::aod::pidutils::tofNSigma<id>(t)) < 3.f) {
-            histos.fill(HIST(hexpected_wTOF[id]), t.tpcInnerParam(), t.tpcSignal() - diff);
-            histos.fill(HIST(hdelta_wTOF[id]), t.tpcInnerParam(), diff);
-            histos.fill(HIST(hexpsigma_wTOF[id]), t.p(), o2::aod::pidutils::tpcExpSigma<id>(t));
-          }
-        }
-      }
-      if constexpr (fillWithTOFHistograms) { // Filling nsigma (common to full and tiny)
-        const auto& nsigmatof = o2::aod::pidutils::tofNSigma<id>(t);
-        if (std::abs(nsigmatof) < 3.f) {
-          histos.fill(HIST(hnsigma_wTOF[id]), t.p(), nsigma);
-          histos.fill(HIST(hnsigma_pt_wTOF[id]), t.pt(), nsigma);
-          histos.fill(HIST(hsignal_wTOF[id]), t.tpcInnerParam(), t.tpcSignal());
-          // histos.fill(HIST("event/signedtpcsignal"), t.tpcInnerParam() * t.sign(), t.tpcSignal());
-        }
+    for (auto t : tracks) {
+      if (!isTrackSelected<false>(collision, t)) {
+        continue;
       }
+      (fillParticleHistograms<ids, fillFullHistograms, fillWithTOFHistograms>(t), ...);
     }
   }
 
@@ -467,6 +509,41 @@ struct tpcPidQa {
   makeProcessFunction(aod::pidTPCFullHe, aod::pidTOFFullHe, Helium3);
   makeProcessFunction(aod::pidTPCFullAl, aod::pidTOFFullAl, Alpha);
 #undef makeProcessFunction
+
+  // QA of full tables, several species per process function
+  void processFullLight(CollisionCandidate const& collision,
+                        soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection,
+                                  aod::pidTPCFullEl, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr> const& tracks)
+  {
+    processMultipleParticles<true, false, PID::Electron, PID::Pion, PID::Kaon, PID::Proton>(collision, tracks);
+  }
+  PROCESS_SWITCH(tpcPidQa, processFullLight, "Process for the e, pi, K and p hypotheses for full TPC PID QA in a single loop", false);
+
+  void processFullNuclei(CollisionCandidate const& collision,
+                         soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection,
+                                   aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl> const& tracks)
+  {
+    processMultipleParticles<true, false, PID::Deuteron, PID::Triton, PID::Helium3, PID::Alpha>(collision, tracks);
+  }
+  PROCESS_SWITCH(tpcPidQa, processFullNuclei, "Process for the d, t, 3He and alpha hypotheses for full TPC PID QA in a single loop", false);
+
+  void processFullWithTOFLight(CollisionCandidate const& collision,
+                               soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection,
+                                         aod::pidTPCFullEl, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
+                                         aod::pidTOFFullEl, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr> const& tracks)
+  {
+    processMultipleParticles<true, true, PID::Electron, PID::Pion, PID::Kaon, PID::Proton>(collision, tracks);
+  }
+  PROCESS_SWITCH(tpcPidQa, processFullWithTOFLight, "Process for the e, pi, K and p hypotheses for full TPC PID QA with TOF in a single loop", false);
+
+  void processFullWithTOFNuclei(CollisionCandidate const& collision,
+                                soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection,
+                                          aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl,
+                                          aod::pidTOFFullDe, aod::pidTOFFullTr, aod::pidTOFFullHe, aod::pidTOFFullAl> const& tracks)
+  {
+    processMultipleParticles<true, true, PID::Deuteron, PID::Triton, PID::Helium3, PID::Alpha>(collision, tracks);
+  }
+  PROCESS_SWITCH(tpcPidQa, processFullWithTOFNuclei, "Process for the d, t, 3He and alpha hypotheses for full TPC PID QA with TOF in a single loop", false);
 };
 
 #endif // DPG_TASKS_AOTTRACK_PID_QAPIDTPC_H_
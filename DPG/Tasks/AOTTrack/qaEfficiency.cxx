@@ -930,10 +930,27 @@ struct QaEfficiency {
     }
   }
 
-  template <int charge, o2::track::PID::ID id, typename trackType>
-  void fillMCTrackHistograms(const trackType& track, const bool doMakeHistograms)
+  // Index of the species of the PDG code in the PDGs array, NIDs if it is not one of the identified species
+  static int speciesIndex(const int pdgCode)
+  {
+    for (int id = 0; id < o2::track::PID::NIDs; id++) {
+      if (pdgCode == PDGs[id] || pdgCode == -PDGs[id]) {
+        return id;
+      }
+    }
+    return o2::track::PID::NIDs;
+  }
+
+  // The species of the MC particle is resolved once by the caller, so that only the matching species and the unidentified ones are filled
+  template <int charge, o2::track::PID::ID id, typename trackType, typename particleType>
+  void fillMCTrackHistograms(const trackType& track, const particleType& mcParticle, const int species, const bool doMakeHistograms)
   {
     static_assert(charge == 0 || charge == 1);
+    if constexpr (id != o2::track::PID::NIDs) {
+      if (species != id) {
+        return;
+      }
+    }
     if (!doMakeHistograms) {
       return;
     }
@@ -955,7 +972,6 @@ struct QaEfficiency {
 
     constexpr int histogramIndex = id + charge * nSpecies;
     LOG(debug) << "fillMCTrackHistograms for charge '" << charge << "' and id '" << static_cast<int>(id) << "' " << particleName(charge, id) << " with index " << histogramIndex;
-    const auto mcParticle = track.mcParticle();
 
     if (!isPdgSelected<charge, id>(mcParticle)) { // Selecting PDG code
       return;
@@ -1034,9 +1050,14 @@ struct QaEfficiency {
   }
 
   template <int charge, o2::track::PID::ID id, typename particleType>
-  void fillMCParticleHistograms(const particleType& mcParticle, const bool doMakeHistograms)
+  void fillMCParticleHistograms(const particleType& mcParticle, const int species, const bool doMakeHistograms)
   {
     static_assert(charge == 0 || charge == 1);
+    if constexpr (id != o2::track::PID::NIDs) {
+      if (species != id) {
+        return;
+      }
+    }
     if (!doMakeHistograms) {
       return;
     }
@@ -1399,17 +1420,19 @@ struct QaEfficiency {
         }
         // Filling variable histograms
         histos.fill(HIST("MC/trackLength"), track.length());
+        const auto mcParticle = track.mcParticle();
+        const int species = speciesIndex(mcParticle.pdgCode());
         static_for<0, 1>([&](auto charge) {
-          fillMCTrackHistograms<charge, o2::track::PID::Electron>(track, doEl);
-          fillMCTrackHistograms<charge, o2::track::PID::Muon>(track, doMu);
-          fillMCTrackHistograms<charge, o2::track::PID::Pion>(track, doPi);
-          fillMCTrackHistograms<charge, o2::track::PID::Kaon>(track, doKa);
-          fillMCTrackHistograms<charge, o2::track::PID::Proton>(track, doPr);
-          fillMCTrackHistograms<charge, o2::track::PID::Deuteron>(track, doDe);
-          fillMCTrackHistograms<charge, o2::track::PID::Triton>(track, doTr);
-          fillMCTrackHistograms<charge, o2::track::PID::Helium3>(track, doHe);
-          fillMCTrackHistograms<charge, o2::track::PID::Alpha>(track, doAl);
-          fillMCTrackHistograms<charge, o2::track::PID::NIDs>(track, doUnId);
+          fillMCTrackHistograms<charge, o2::track::PID::Electron>(track, mcParticle, species, doEl);
+          fillMCTrackHistograms<charge, o2::track::PID::Muon>(track, mcParticle, species, doMu);
+          fillMCTrackHistograms<charge, o2::track::PID::Pion>(track, mcParticle, species, doPi);
+          fillMCTrackHistograms<charge, o2::track::PID::Kaon>(track, mcParticle, species, doKa);
+          fillMCTrackHistograms<charge, o2::track::PID::Proton>(track, mcParticle, species, doPr);
+          fillMCTrackHistograms<charge, o2::track::PID::Deuteron>(track, mcParticle, species, doDe);
+          fillMCTrackHistograms<charge, o2::track::PID::Triton>(track, mcParticle, species, doTr);
+          fillMCTrackHistograms<charge, o2::track::PID::Helium3>(track, mcParticle, species, doHe);
+          fillMCTrackHistograms<charge, o2::track::PID::Alpha>(track, mcParticle, species, doAl);
+          fillMCTrackHistograms<charge, o2::track::PID::NIDs>(track, mcParticle, species, doUnId);
         });
       }
     }
@@ -1424,17 +1447,18 @@ struct QaEfficiency {
         continue;
       }
 
+      const int species = speciesIndex(mcParticle.pdgCode());
       static_for<0, 1>([&](auto charge) {
-        fillMCParticleHistograms<charge, o2::track::PID::Electron>(mcParticle, doEl);
-        fillMCParticleHistograms<charge, o2::track::PID::Muon>(mcParticle, doMu);
-        fillMCParticleHistograms<charge, o2::track::PID::Pion>(mcParticle, doPi);
-        fillMCParticleHistograms<charge, o2::track::PID::Kaon>(mcParticle, doKa);
-        fillMCParticleHistograms<charge, o2::track::PID::Proton>(mcParticle, doPr);
-        fillMCParticleHistograms<charge, o2::track::PID::Deuteron>(mcParticle, doDe);
-        fillMCParticleHistograms<charge, o2::track::PID::Triton>(mcParticle, doTr);
-        fillMCParticleHistograms<charge, o2::track::PID::Helium3>(mcParticle, doHe);
-        fillMCParticleHistograms<charge, o2::track::PID::Alpha>(mcParticle, doAl);
-        fillMCParticleHistograms<charge, o2::track::PID::NIDs>(mcParticle, doUnId);
+        fillMCParticleHistograms<charge, o2::track::PID::Electron>(mcParticle, species, doEl);
+        fillMCParticleHistograms<charge, o2::track::PID::Muon>(mcParticle, species, doMu);
+        fillMCParticleHistograms<charge, o2::track::PID::Pion>(mcParticle, species, doPi);
+        fillMCParticleHistograms<charge, o2::track::PID::Kaon>(mcParticle, species, doKa);
+        fillMCParticleHistograms<charge, o2::track::PID::Proton>(mcParticle, species, doPr);
+        fillMCParticleHistograms<charge, o2::track::PID::Deuteron>(mcParticle, species, doDe);
+        fillMCParticleHistograms<charge, o2::track::PID::Triton>(mcParticle, species, doTr);
+        fillMCParticleHistograms<charge, o2::track::PID::Helium3>(mcParticle, species, doHe);
+        fillMCParticleHistograms<charge, o2::track::PID::Alpha>(mcParticle, species, doAl);
+        fillMCParticleHistograms<charge, o2::track::PID::NIDs>(mcParticle, species, doUnId);
       });
     }
     histos.fill(HIST("MC/eventMultiplicity"), dNdEta * 0.5f / 2.f);
@@ -71,6 +71,10 @@ struct qaEventTrack {
   Configurable<float> minPhi{"minPhi", -1.f, "Minimum phi of accepted tracks"};
   Configurable<float> maxPhi{"maxPhi", 10.f, "Maximum phi of accepted tracks"};
 
+  // options to reduce the size and the CPU cost of the QA
+  Configurable<int> nSamplingMultiDim{"nSamplingMultiDim", 1, "Fill the multi-dimensional track histograms for one collision out of N, chosen deterministically from the BC index (1 -> all collisions). The 1D histograms are always filled"};
+  Configurable<bool> useSparseMultiDim{"useSparseMultiDim", false, "Store the sparsely populated multi-dimensional track histograms (DCA, resolutions) as THnSparse"};
+
   // configurable binning of histograms
   ConfigurableAxis binsPt{"binsPt", {VARIABLE_WIDTH, 0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3, 1.4, 1.5, 2.0, 5.0, 10.0, 20.0, 50.0}, ""};
 
@@ -139,11 +143,17 @@ struct qaEventTrack {
     const AxisSpec axisDeltaPt{100, -0.5, 0.5, "#it{p}_{T, rec} - #it{p}_{T, gen}"};
     const AxisSpec axisDeltaEta{100, -0.1, 0.1, "#eta_{rec} - #eta_{gen}"};
     const AxisSpec axisDeltaPhi{100, -0.1, 0.1, "#varphi_{rec} - #varphi_{gen}"};
+    const AxisSpec axisEtaRec{180, -0.9, 0.9, "#eta_{rec}"};
+    const AxisSpec axisPhiRec{180, 0., 2 * M_PI, "#varphi_{rec}"};
+
+    // narrow distributions, with most of the bins empty
+    const HistType histTypeSparse = useSparseMultiDim ? kTHnSparseD : kTH2D;
 
     // collision
-    auto eventRecoEffHist = histos.add<TH1>("Events/recoEff", "", kTH1D, {{2, 0.5, 2.5}});
+    auto eventRecoEffHist = histos.add<TH1>("Events/recoEff", "", kTH1D, {{3, 0.5, 3.5}});
     eventRecoEffHist->GetXaxis()->SetBinLabel(1, "all");
     eventRecoEffHist->GetXaxis()->SetBinLabel(2, "selected");
+    eventRecoEffHist->GetXaxis()->SetBinLabel(3, "sampled (multi-dim.)");
     histos.add("Events/posX", "", kTH1D, {axisVertexPosX});
     histos.add("Events/posY", "", kTH1D, {axisVertexPosY});
     histos.add("Events/posZ", "", kTH1D, {axisVertexPosZ});
@@ -183,11 +193,11 @@ struct qaEventTrack {
     histos.add("Tracks/Kine/etavspt", "#eta vs #it{p}_{T}", kTH2F, {axisPt, axisEta});
     histos.add("Tracks/Kine/phivspt", "#varphi vs #it{p}_{T}", kTH2F, {axisPt, axisPhi});
     if (doprocessMC || doprocessRun2ConvertedMC) {
-      histos.add<TH2>("Tracks/Kine/resoPt", "", kTH2D, {axisDeltaPt, axisPt});
-      histos.add<TH2>("Tracks/Kine/resoEta", "", kTH2D, {axisDeltaEta, axisEta})->GetYaxis()->SetTitle("#eta_{rec}");
-      histos.add<TH2>("Tracks/Kine/resoPhi", "", kTH2D, {axisDeltaPhi, axisPhi})->GetYaxis()->SetTitle("#varphi_{rec}");
+      histos.add("Tracks/Kine/resoPt", "", histTypeSparse, {axisDeltaPt, axisPt});
+      histos.add("Tracks/Kine/resoEta", "", histTypeSparse, {axisDeltaEta, axisEtaRec});
+      histos.add("Tracks/Kine/resoPhi", "", histTypeSparse, {axisDeltaPhi, axisPhiRec});
     }
-    histos.add("Tracks/Kine/relativeResoPt", "relative #it{p}_{T} resolution;#sigma{#it{p}}/#it{p}_{T};#it{p}_{T}", kTH2D, {{axisPt, {100, 0., 0.3}}});
+    histos.add("Tracks/Kine/relativeResoPt", "relative #it{p}_{T} resolution;#sigma{#it{p}}/#it{p}_{T};#it{p}_{T}", histTypeSparse, {{axisPt, {100, 0., 0.3}}});
     histos.add("Tracks/Kine/relativeResoPtMean", "mean relative #it{p}_{T} resolution;#LT#sigma{#it{p}}/#it{p}_{T}#GT;#it{p}_{T}", kTProfile, {{axisPt}});
 
     // count filtered tracks matched to a collision
@@ -288,8 +298,8 @@ struct qaEventTrack {
     histos.add("Tracks/dcaXY", "distance of closest approach in #it{xy} plane;#it{dcaXY} [cm];", kTH1D, {{200, -0.15, 0.15}});
     histos.add("Tracks/dcaZ", "distance of closest approach in #it{z};#it{dcaZ} [cm];", kTH1D, {{200, -0.15, 0.15}});
 
-    histos.add("Tracks/dcaXYvsPt", "distance of closest approach in #it{xy} plane;#it{dcaXY} [cm];", kTH2D, {{200, -0.15, 0.15}, axisPt});
-    histos.add("Tracks/dcaZvsPt", "distance of closest approach in #it{z};#it{dcaZ} [cm];", kTH2D, {{200, -0.15, 0.15}, axisPt});
+    histos.add("Tracks/dcaXYvsPt", "distance of closest approach in #it{xy} plane;#it{dcaXY} [cm];", histTypeSparse, {{200, -0.15, 0.15}, axisPt});
+    histos.add("Tracks/dcaZvsPt", "distance of closest approach in #it{z};#it{dcaZ} [cm];", histTypeSparse, {{200, -0.15, 0.15}, axisPt});
 
     histos.add("Tracks/length", "track length in cm;#it{Length} [cm];", kTH1D, {{400, 0, 1000}});
 
@@ -433,6 +443,18 @@ struct qaEventTrack {
     return true;
   }
 
+  // Function to sample the collisions for the multi-dimensional histograms
+  // The choice depends only on the BC, so that the same collisions are sampled in all the passes and by all the wagons
+  template <typename T>
+  bool isSampledCollision(const T& collision)
+  {
+    if (nSamplingMultiDim <= 1) {
+      return true;
+    }
+    const uint64_t hash = static_cast<uint64_t>(collision.bcId()) * 0x9E3779B97F4A7C15ULL; // Fibonacci hashing
+    return ((hash >> 32) % static_cast<uint64_t>(nSamplingMultiDim)) == 0;
+  }
+
   // Function to select collisions
   template <bool doFill, typename T>
   bool isSelectedCollision(const T& collision)
@@ -526,6 +548,7 @@ struct qaEventTrack {
       LOG(fatal) << "Tables are of different size!!!!!!!!! " << tracksUnfiltered.size() << " vs " << tracksIU.size();
     }
 
+    const bool fillMultiDim = isSampledCollision(collision);
     uint64_t trackIndex = 0;
     for (const auto& trk : tracksUnfiltered) {
       if (!isSelectedTrack<false>(trk)) {
@@ -546,6 +569,9 @@ struct qaEventTrack {
       histos.fill(HIST("Tracks/IU/snp"), trkIU.snp());
       histos.fill(HIST("Tracks/IU/tgl"), trkIU.tgl());
 
+      if (!fillMultiDim) {
+        continue;
+      }
       histos.fill(HIST("Tracks/IU/deltaDCA/Pt"), trk.pt(), trkIU.pt() - trk.pt());
       histos.fill(HIST("Tracks/IU/deltaDCA/Eta"), trk.eta(), trkIU.eta() - trk.eta());
       histos.fill(HIST("Tracks/IU/deltaDCA/Phi"), trk.phi(), trkIU.phi() - trk.phi());
@@ -569,6 +595,7 @@ struct qaEventTrack {
     // LOG(info) << "===> tracksIU.size()=" << tracksIU.size() << "===> tracksDCA.size()" << tracksDCA.size();
 
     uint64_t trackIndex = 0;
+    const bool fillMultiDim = isSampledCollision(collision);
     for (const auto& trkIU : tracksIU) {
       if (!isSelectedTrack<false>(trkIU)) {
         trackIndex++;
@@ -588,6 +615,9 @@ struct qaEventTrack {
       histos.fill(HIST("Tracks/IUFiltered/snp"), trkIU.snp());
       histos.fill(HIST("Tracks/IUFiltered/tgl"), trkIU.tgl());
 
+      if (!fillMultiDim) {
+        continue;
+      }
       histos.fill(HIST("Tracks/IUFiltered/deltaDCA/Pt"), trkDCA.pt(), trkIU.pt() - trkDCA.pt());
       histos.fill(HIST("Tracks/IUFiltered/deltaDCA/Eta"), trkDCA.eta(), trkIU.eta() - trkDCA.eta());
       histos.fill(HIST("Tracks/IUFiltered/deltaDCA/Phi"), trkDCA.phi(), trkIU.phi() - trkDCA.phi());
@@ -1012,24 +1042,32 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
   histos.fill(HIST("Tracks/recoEff"), 1, tracks.tableSize());
   histos.fill(HIST("Tracks/recoEff"), 2, tracks.size());
 
+  // the multi-dimensional track histograms are filled only for the sampled collisions
+  const bool fillMultiDim = isSampledCollision(collision);
+  if (fillMultiDim) {
+    histos.fill(HIST("Events/recoEff"), 3);
+  }
+
   // unfiltered track related histograms
-  for (const auto& trackUnfiltered : tracksUnfiltered) {
-    // fill ITS variables
-    int itsNhits = 0;
-    for (unsigned int i = 0; i < 7; i++) {
-      if (trackUnfiltered.itsClusterMap() & (1 << i)) {
-        itsNhits += 1;
+  if (fillMultiDim) {
+    for (const auto& trackUnfiltered : tracksUnfiltered) {
+      // fill ITS variables
+      int itsNhits = 0;
+      for (unsigned int i = 0; i < 7; i++) {
+        if (trackUnfiltered.itsClusterMap() & (1 << i)) {
+          itsNhits += 1;
+        }
       }
-    }
-    bool trkHasITS = false;
-    for (unsigned int i = 0; i < 7; i++) {
-      if (trackUnfiltered.itsClusterMap() & (1 << i)) {
-        trkHasITS = true;
-        histos.fill(HIST("Tracks/ITS/itsHitsUnfiltered"), i, itsNhits);
+      bool trkHasITS = false;
+      for (unsigned int i = 0; i < 7; i++) {
+        if (trackUnfiltered.itsClusterMap() & (1 << i)) {
+          trkHasITS = true;
+          histos.fill(HIST("Tracks/ITS/itsHitsUnfiltered"), i, itsNhits);
+        }
+      }
+      if (!trkHasITS) {
+        histos.fill(HIST("Tracks/ITS/itsHitsUnfiltered"), -1, itsNhits);
       }
-    }
-    if (!trkHasITS) {
-      histos.fill(HIST("Tracks/ITS/itsHitsUnfiltered"), -1, itsNhits);
     }
   }
 
@@ -1042,10 +1080,12 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
     histos.fill(HIST("Tracks/Kine/pt"), track.pt());
     histos.fill(HIST("Tracks/Kine/eta"), track.eta());
     histos.fill(HIST("Tracks/Kine/phi"), track.phi());
-    histos.fill(HIST("Tracks/Kine/etavsphi"), track.eta(), track.phi());
-    histos.fill(HIST("Tracks/Kine/etavspt"), track.pt(), track.eta());
-    histos.fill(HIST("Tracks/Kine/phivspt"), track.pt(), track.phi());
-    histos.fill(HIST("Tracks/Kine/relativeResoPt"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
+    if (fillMultiDim) {
+      histos.fill(HIST("Tracks/Kine/etavsphi"), track.eta(), track.phi());
+      histos.fill(HIST("Tracks/Kine/etavspt"), track.pt(), track.eta());
+      histos.fill(HIST("Tracks/Kine/phivspt"), track.pt(), track.phi());
+      histos.fill(HIST("Tracks/Kine/relativeResoPt"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
+    }
     histos.fill(HIST("Tracks/Kine/relativeResoPtMean"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
 
     // fill track parameters
@@ -1063,28 +1103,32 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
     }
     histos.fill(HIST("Tracks/dcaXY"), track.dcaXY());
     histos.fill(HIST("Tracks/dcaZ"), track.dcaZ());
-    histos.fill(HIST("Tracks/dcaXYvsPt"), track.dcaXY(), track.pt());
-    histos.fill(HIST("Tracks/dcaZvsPt"), track.dcaZ(), track.pt());
+    if (fillMultiDim) {
+      histos.fill(HIST("Tracks/dcaXYvsPt"), track.dcaXY(), track.pt());
+      histos.fill(HIST("Tracks/dcaZvsPt"), track.dcaZ(), track.pt());
+    }
     histos.fill(HIST("Tracks/length"), track.length());
 
     // fill ITS variables
     histos.fill(HIST("Tracks/ITS/itsNCls"), track.itsNCls());
     histos.fill(HIST("Tracks/ITS/itsChi2NCl"), track.itsChi2NCl());
-    int itsNhits = 0;
-    for (unsigned int i = 0; i < 7; i++) {
-      if (track.itsClusterMap() & (1 << i)) {
-        itsNhits += 1;
+    if (fillMultiDim) {
+      int itsNhits = 0;
+      for (unsigned int i = 0; i < 7; i++) {
+        if (track.itsClusterMap() & (1 << i)) {
+          itsNhits += 1;
+        }
       }
-    }
-    bool trkHasITS = false;
-    for (unsigned int i = 0; i < 7; i++) {
-      if (track.itsClusterMap() & (1 << i)) {
-        trkHasITS = true;
-        histos.fill(HIST("Tracks/ITS/itsHits"), i, itsNhits);
+      bool trkHasITS = false;
+      for (unsigned int i = 0; i < 7; i++) {
+        if (track.itsClusterMap() & (1 << i)) {
+          trkHasITS = true;
+          histos.fill(HIST("Tracks/ITS/itsHits"), i, itsNhits);
+        }
+      }
+      if (!trkHasITS) {
+        histos.fill(HIST("Tracks/ITS/itsHits"), -1, itsNhits);
       }
-    }
-    if (!trkHasITS) {
-      histos.fill(HIST("Tracks/ITS/itsHits"), -1, itsNhits);
     }
 
     // fill TPC variables
@@ -1097,7 +1141,7 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
     histos.fill(HIST("Tracks/TPC/tpcChi2NCl"), track.tpcChi2NCl());
 
     if constexpr (IS_MC) {
-      if (track.has_mcParticle()) {
+      if (fillMultiDim && track.has_mcParticle()) {
         // resolution plots
         auto particle = track.mcParticle();
         histos.fill(HIST("Tracks/Kine/resoPt"), track.pt() - particle.pt(), track.pt());
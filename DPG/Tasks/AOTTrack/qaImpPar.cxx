@@ -37,6 +37,9 @@
 #include "DataFormatsCalibration/MeanVertexObject.h"
 #include "CommonConstants/GeomConstants.h"
 
+#include <Math/SMatrix.h>
+
+#include "algorithm"
 #include "iostream"
 #include "vector"
 #include "set"
@@ -102,6 +105,7 @@ struct QaImpactPar {
   Configurable<uint16_t> maxPVcontrib{"maxPVcontrib", 10000, "Maximum number of PV contributors"};
   Configurable<bool> removeDiamondConstraint{"removeDiamondConstraint", true, "Remove the diamond constraint for the PV refit"};
   Configurable<bool> keepAllTracksPVrefit{"keepAllTracksPVrefit", false, "Keep all tracks for PV refit (for debug)"};
+  Configurable<bool> fastPVrefit{"fastPVrefit", false, "Remove the track from the PV with a Kalman downdate of the vertex instead of a full refit (straight track at the DCA, no robust weights, mean-vertex constraint kept if used in the reconstruction)"};
   Configurable<bool> use_customITSHitMap{"use_customITSHitMap", false, "Use custom ITS hitmap selection"};
   Configurable<int> customITShitmap{"customITShitmap", 0, "Custom ITS hitmap (consider the binary representation)"};
   Configurable<int> n_customMinITShits{"n_customMinITShits", 0, "Minimum number of layers crossed by a track among those in \"customITShitmap\""};
@@ -302,6 +306,75 @@ struct QaImpactPar {
     histograms.add("MC/ptMC", "", kTH1D, {trackPtAxis});
   }
 
+  /// Fast PV refit: remove the contribution of one track from the vertex with a Kalman downdate
+  /// The track is linearised as a straight line at its point of closest approach to the vertex
+  /// \return false if the downdated vertex covariance is not positive definite
+  bool removeTrackFromVertex(const o2::dataformats::VertexBase& vtx, const float chi2, const o2::track::TrackParCov& trk, o2::dataformats::PrimaryVertex& vtxOut)
+  {
+    using SMatrix33Sym = ROOT::Math::SMatrix<double, 3, 3, ROOT::Math::MatRepSym<double, 3>>;
+    using SMatrix22Sym = ROOT::Math::SMatrix<double, 2, 2, ROOT::Math::MatRepSym<double, 2>>;
+    using SMatrix23 = ROOT::Math::SMatrix<double, 2, 3>;
+    using SVector3 = ROOT::Math::SVector<double, 3>;
+    using SVector2 = ROOT::Math::SVector<double, 2>;
+
+    SMatrix33Sym weight;
+    weight(0, 0) = vtx.getSigmaX2();
+    weight(0, 1) = vtx.getSigmaXY();
+    weight(1, 1) = vtx.getSigmaY2();
+    weight(0, 2) = vtx.getSigmaXZ();
+    weight(1, 2) = vtx.getSigmaYZ();
+    weight(2, 2) = vtx.getSigmaZ2();
+    if (!weight.InvertChol()) {
+      return false;
+    }
+    const SVector3 pos(vtx.getX(), vtx.getY(), vtx.getZ());
+
+    // track (y, z) in its local frame, as a function of the vertex position in the global frame:
+    // y = yl - ty * xl, z = zl - tz * xl with xl = cos(alpha) X + sin(alpha) Y, yl = -sin(alpha) X + cos(alpha) Y, zl = Z
+    const double cosAlpha = std::cos(trk.getAlpha());
+    const double sinAlpha = std::sin(trk.getAlpha());
+    const double csp = std::sqrt((1. - trk.getSnp()) * (1. + trk.getSnp()));
+    const double ty = trk.getSnp() / csp;
+    const double tz = trk.getTgl() / csp;
+    SMatrix23 h;
+    h(0, 0) = -sinAlpha - ty * cosAlpha;
+    h(0, 1) = cosAlpha - ty * sinAlpha;
+    h(1, 0) = -tz * cosAlpha;
+    h(1, 1) = -tz * sinAlpha;
+    h(1, 2) = 1.;
+    const SVector2 meas(trk.getY() - ty * trk.getX(), trk.getZ() - tz * trk.getX());
+    SMatrix22Sym trkCov;
+    trkCov(0, 0) = trk.getSigmaY2();
+    trkCov(0, 1) = trk.getSigmaZY();
+    trkCov(1, 1) = trk.getSigmaZ2();
+    SMatrix22Sym trkWeight = trkCov;
+    if (!trkWeight.InvertChol()) {
+      return false;
+    }
+
+    // downdate of the weight matrix and of the weighted position
+    SMatrix33Sym covOut = weight - ROOT::Math::SimilarityT(h, trkWeight);
+    const SVector3 weightedPos = weight * pos - ROOT::Math::Transpose(h) * (trkWeight * meas);
+    if (!covOut.InvertChol()) {
+      return false;
+    }
+    const SVector3 posOut = covOut * weightedPos;
+
+    // chi2 contribution of the track, from its residual to the vertex without it
+    const SVector2 residual = meas - h * posOut;
+    SMatrix22Sym residualWeight = trkCov + ROOT::Math::Similarity(h, covOut);
+    if (!residualWeight.InvertChol()) {
+      return false;
+    }
+
+    vtxOut.setX(posOut(0));
+    vtxOut.setY(posOut(1));
+    vtxOut.setZ(posOut(2));
+    vtxOut.setCov(covOut(0, 0), covOut(0, 1), covOut(1, 1), covOut(0, 2), covOut(1, 2), covOut(2, 2));
+    vtxOut.setChi2(chi2 - ROOT::Math::Similarity(residualWeight, residual));
+    return true;
+  }
+
   /// core template process function
   template <bool IS_MC, typename C, typename T, typename T_MC>
   void processReco(const C& collision, const trackTable& unfilteredTracks, const T& tracks,
@@ -535,7 +608,11 @@ struct QaImpactPar {
       bool recalc_imppar = false;
       if (doPVrefit && PVrefit_doable) {
         recalc_imppar = true;
-        auto it_trk = std::find(vec_globID_contr.begin(), vec_globID_contr.end(), track.globalIndex()); /// track global index
+        /// the contributors are sorted by global index
+        auto it_trk = std::lower_bound(vec_globID_contr.begin(), vec_globID_contr.end(), track.globalIndex()); /// track global index
+        if (it_trk != vec_globID_contr.end() && *it_trk != track.globalIndex()) {
+          it_trk = vec_globID_contr.end();
+        }
         // if( it_trk==vec_globID_contr.end() ) {
         //   /// not found: this track did not contribute to the initial PV fitting
         //   continue;
@@ -546,7 +623,10 @@ struct QaImpactPar {
           if (!keepAllTracksPVrefit) {
             vec_useTrk_PVrefit[entry] = false; /// remove the track from the PV refitting
           }
-          auto Pvtx_refitted = vertexer.refitVertex(vec_useTrk_PVrefit, Pvtx); // vertex refit
+          o2::dataformats::PrimaryVertex Pvtx_refitted;
+          if (!fastPVrefit || keepAllTracksPVrefit || !removeTrackFromVertex(Pvtx, collision.chi2(), vec_TrkContributos[entry], Pvtx_refitted)) {
+            Pvtx_refitted = vertexer.refitVertex(vec_useTrk_PVrefit, Pvtx); // vertex refit
+          }
           if (fDebug) {
             LOG(info) << "refit " << cnt << "/" << ntr << " result = " << Pvtx_refitted.asString();
           }
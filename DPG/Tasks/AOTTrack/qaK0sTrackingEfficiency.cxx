@@ -21,6 +21,7 @@
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/PIDResponse.h"
+#include "qaTrackTags.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -37,6 +38,10 @@ struct qaK0sTrackingEfficiency {
 
   void init(InitContext const&)
   {
+    if (doprocessStandard && doprocessTagged) {
+      LOGF(fatal, "Cannot enable processStandard and processTagged at the same time. Please choose one.");
+    }
+
     const AxisSpec RAxis{500, 0.f, 50.f, "#it{R} (cm)"};
     const AxisSpec pTAxis{200, 0.f, 10.f, "#it{p}_{T} (GeV/#it{c})"};
     const AxisSpec mAxis{200, 0.4f, 0.6f, "#it{m} (GeV/#it{c}^{2})"};
@@ -88,6 +93,9 @@ struct qaK0sTrackingEfficiency {
   template <typename T1, typename T2, typename C>
   bool acceptV0(const T1& v0, const T2& ntrack, const T2& ptrack, const C& collision)
   {
+    if constexpr (has_type_v<aod::dpgv0tag::HypothesisFlags, typename T1::all_columns>) {
+      return v0.hypothesisFlags() & aod::dpgv0tag::kK0s; // selection of qa-track-tag-producer
+    }
     // Apply selections on V0
     if (v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa)
       return kFALSE;
@@ -102,8 +110,9 @@ struct qaK0sTrackingEfficiency {
     return kTRUE;
   }
 
-  void process(SelectedCollisions::iterator const& collision, aod::V0Datas const& fullV0s, PIDTracks const& tracks)
-  // TODO: add centrality
+  /// Fills the histograms of the V0s of the collision, with the selections of this task or with the stored tags
+  template <typename TV0s>
+  void fillV0s(SelectedCollisions::iterator const& collision, TV0s const& fullV0s)
   {
     registry.fill(HIST("h_EventCounter"), 0.);
     if (eventSelection && !collision.sel8()) {
@@ -139,6 +148,19 @@ struct qaK0sTrackingEfficiency {
     }
   }
 
+  void processStandard(SelectedCollisions::iterator const& collision, aod::V0Datas const& fullV0s, PIDTracks const&)
+  // TODO: add centrality
+  {
+    fillV0s(collision, fullV0s);
+  }
+  PROCESS_SWITCH(qaK0sTrackingEfficiency, processStandard, "Process the V0s with the selections of this task", true);
+
+  void processTagged(SelectedCollisions::iterator const& collision, soa::Join<aod::V0Datas, aod::DPGV0Tags> const& fullV0s, PIDTracks const&)
+  {
+    fillV0s(collision, fullV0s);
+  }
+  PROCESS_SWITCH(qaK0sTrackingEfficiency, processTagged, "Process the V0s selected by qa-track-tag-producer instead of processStandard", false);
+
   void processIU(SelectedCollisions::iterator const& collision,
                  aod::V0Datas const& fullV0s,
                  PIDTracksIU const&)
@@ -20,6 +20,7 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
+#include "qaTrackTags.h"
 
 //
 // base namespaces
@@ -112,7 +113,7 @@ struct qaMatchEff {
 
     if ((!isitMC && (doprocessMC || doprocessMCNoColl)) || (isitMC && (doprocessData && doprocessDataNoColl)))
       LOGF(fatal, "Initialization set for MC and processData function flagged (or viceversa)! Fix the configuration.");
-    if ((doprocessMC && doprocessMCNoColl) || (doprocessData && doprocessDataNoColl))
+    if ((doprocessMC && doprocessMCNoColl) || (doprocessData && doprocessDataNoColl) || (doprocessDataTagged && (doprocessData || doprocessDataNoColl)))
       LOGF(fatal, "Cannot process for both without collision tag and with collision tag at the same time! Fix the configuration.");
 
     /// initialize the track selections
@@ -331,6 +332,8 @@ struct qaMatchEff {
   {
     if (!b_useTrackSelections)
       return true; // no track selections applied
+    if constexpr (has_type_v<aod::dpgtracktag::SelectionFlags, typename T::all_columns>)
+      return track.selectionFlags() & aod::dpgtracktag::kKine; // selections of qa-track-tag-producer
     if (!cutObject.IsSelected(track, TrackSelection::TrackCuts::kPtRange))
       return false;
     if (b_useTPCinnerWallPt && computePtInParamTPC(track) < ptMinCutInnerWallTPC) {
@@ -351,6 +354,8 @@ struct qaMatchEff {
   {
     if (!b_useTrackSelections)
       return true; // no track selections applied
+    if constexpr (has_type_v<aod::dpgtracktag::SelectionFlags, typename T::all_columns>)
+      return track.selectionFlags() & aod::dpgtracktag::kTPC; // selections of qa-track-tag-producer
     if (!cutObject.IsSelected(track, TrackSelection::TrackCuts::kTPCNCls))
       return false;
     if (!cutObject.IsSelected(track, TrackSelection::TrackCuts::kTPCCrossedRows))
@@ -367,6 +372,8 @@ struct qaMatchEff {
   {
     if (!b_useTrackSelections)
       return true; // no track selections applied
+    if constexpr (has_type_v<aod::dpgtracktag::SelectionFlags, typename T::all_columns>)
+      return track.selectionFlags() & aod::dpgtracktag::kITS; // selections of qa-track-tag-producer
     if (!cutObject.IsSelected(track, TrackSelection::TrackCuts::kITSChi2NDF))
       return false;
     if (!cutObject.IsSelected(track, TrackSelection::TrackCuts::kITSHits))
@@ -1062,7 +1069,9 @@ struct qaMatchEff {
   PROCESS_SWITCH(qaMatchEff, processData, "process data", true);
   //
   //
-  void processDataNoColl(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA> const& jTracks)
+  /// Fills the data histograms of the tracks, with the selections of this task or with the stored tags
+  template <typename T>
+  void fillDataNoColl(T const& jTracks)
   {
     //
     //
@@ -1147,10 +1156,20 @@ struct qaMatchEff {
     if (doDebug)
       LOGF(info, "Tracks: %d ", countData);
     //
-  } // end processDataNoColl
+  } // end fillDataNoColl
   //
+  void processDataNoColl(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA> const& jTracks)
+  {
+    fillDataNoColl(jTracks);
+  }
   PROCESS_SWITCH(qaMatchEff, processDataNoColl, "process data - no collision dependence", true);
   //
+  void processDataTagged(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::DPGTrackTags> const& jTracks)
+  {
+    fillDataNoColl(jTracks);
+  }
+  PROCESS_SWITCH(qaMatchEff, processDataTagged, "process data - no collision dependence, selections from the tags of qa-track-tag-producer", false);
+  //
   //
 }; // end of structure
 
@@ -0,0 +1,153 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   qaTrackTagProducer.cxx
+/// \brief  Producer of the track and V0 tags read by qa-match-eff and qa-k0s-tracking-efficiency
+///
+/// The selections are those of the two tasks, with the same configurable names. Once the tags are
+/// stored, the tasks are run on them with their processTagged functions and only fill histograms.
+///
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Common/Core/TrackSelection.h"
+#include "Common/DataModel/TrackSelectionTables.h"
+#include "Common/DataModel/PIDResponse.h"
+#include "PWGLF/DataModel/LFStrangenessTables.h"
+#include "qaTrackTags.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+using TagTracks = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::pidTPCFullPi>;
+
+struct QaTrackTagProducer {
+  Produces<aod::DPGTrackTags> trackTags;
+  Produces<aod::DPGV0Tags> v0Tags;
+
+  // qa-match-eff selections
+  Configurable<float> ptMinCutInnerWallTPC{"ptMinCutInnerWallTPC", 0.1f, "Minimum transverse momentum calculated at the inner wall of TPC (GeV/c)"};
+  Configurable<float> ptMinCut{"ptMinCut", 0.1f, "Minimum transverse momentum (GeV/c)"};
+  Configurable<float> ptMaxCut{"ptMaxCut", 100.f, "Maximum transverse momentum (GeV/c)"};
+  Configurable<float> etaMinCut{"etaMinCut", -2.0f, "Minimum pseudorapidity"};
+  Configurable<float> etaMaxCut{"etaMaxCut", 2.0f, "Maximum pseudorapidity"};
+  Configurable<float> dcaXYMaxCut{"dcaXYMaxCut", 1000000.0f, "Maximum dcaXY (cm)"};
+  Configurable<bool> b_useTPCinnerWallPt{"b_useTPCinnerWallPt", false, "Boolean to switch the usage of pt calculated at the inner wall of TPC on/off."};
+  Configurable<int> tpcNClusterMin{"tpcNClusterMin", 0, "Minimum number of clusters in TPC"};
+  Configurable<int> tpcNCrossedRowsMin{"tpcNCrossedRowsMin", 70, "Minimum number of crossed rows in TPC"};
+  Configurable<float> tpcNCrossedRowsOverFindableClstMin{"tpcNCrossedRowsOverFindableClstMin", 0.8f, "Minimum fracion of crossed rows over findable custers in TPC"};
+  Configurable<float> tpcChi2Max{"tpcChi2Max", 4.0f, "Maximum chi2 in TPC"};
+  Configurable<float> itsChi2Max{"itsChi2Max", 36.0f, "Maximum chi2 in ITS"};
+  Configurable<int> customITShitmap{"customITShitmap", 3, "ITS hitmap (think to the binary representation)"};
+  Configurable<int> customMinITShits{"customMinITShits", 1, "Minimum number of layers crossed by a track among those in \"customITShitmap\""};
+
+  // qa-k0s-tracking-efficiency selections
+  Configurable<double> v0cospa{"v0cospa", 0.995, "V0 CosPA"};
+  Configurable<float> rapidity{"rapidity", 0.5, "rapidity"};
+  Configurable<float> nSigTPC{"nSigTPC", 10., "nSigTPC"};
+
+  TrackSelection cutObject;
+  std::vector<uint8_t> v0Flags; // V0 flags of the tracks of the dataframe
+
+  void init(InitContext&)
+  {
+    cutObject.SetEtaRange(etaMinCut, etaMaxCut);
+    cutObject.SetPtRange(ptMinCut, ptMaxCut);
+    cutObject.SetMaxDcaXY(dcaXYMaxCut);
+    cutObject.SetMinNClustersTPC(tpcNClusterMin);
+    cutObject.SetMinNCrossedRowsTPC(tpcNCrossedRowsMin);
+    cutObject.SetMinNCrossedRowsOverFindableClustersTPC(tpcNCrossedRowsOverFindableClstMin);
+    cutObject.SetMaxChi2PerClusterTPC(tpcChi2Max);
+    cutObject.SetMaxChi2PerClusterITS(itsChi2Max);
+    std::set<uint8_t> set_customITShitmap;
+    for (int index_ITSlayer = 0; index_ITSlayer < 7; index_ITSlayer++) {
+      if ((customITShitmap & (1 << index_ITSlayer)) > 0) {
+        set_customITShitmap.insert(static_cast<uint8_t>(index_ITSlayer));
+      }
+    }
+    cutObject.SetRequireHitsInITSLayers(customMinITShits, set_customITShitmap);
+  }
+
+  /// \return bit map of the qa-match-eff selections passed by the track
+  template <typename T>
+  uint8_t getSelectionFlags(T const& track)
+  {
+    uint8_t flags = 0;
+    if (cutObject.IsSelected(track, TrackSelection::TrackCuts::kPtRange) &&
+        !(b_useTPCinnerWallPt && track.tpcInnerParam() / std::sqrt(1.f + track.tgl() * track.tgl()) < ptMinCutInnerWallTPC) &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kEtaRange) &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kDCAxy)) {
+      flags |= aod::dpgtracktag::kKine;
+    }
+    if (track.hasTPC() &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kTPCNCls) &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kTPCCrossedRows) &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kTPCCrossedRowsOverNCls) &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kTPCChi2NDF)) {
+      flags |= aod::dpgtracktag::kTPC;
+    }
+    if (track.hasITS() &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kITSChi2NDF) &&
+        cutObject.IsSelected(track, TrackSelection::TrackCuts::kITSHits)) {
+      flags |= aod::dpgtracktag::kITS;
+    }
+    return flags;
+  }
+
+  /// Same selection as acceptV0 of qa-k0s-tracking-efficiency
+  template <typename TV0, typename TTrack, typename TCollision>
+  bool isK0s(TV0 const& v0, TTrack const& ntrack, TTrack const& ptrack, TCollision const& collision)
+  {
+    if (v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa) {
+      return false;
+    }
+    if (std::abs(v0.yK0Short()) > rapidity) {
+      return false;
+    }
+    if (!ntrack.hasTPC() || !ptrack.hasTPC()) {
+      return false;
+    }
+    return ntrack.tpcNSigmaPi() <= nSigTPC && ptrack.tpcNSigmaPi() <= nSigTPC;
+  }
+
+  void process(aod::Collisions const&, aod::V0Datas const& v0s, TagTracks const& tracks)
+  {
+    v0Flags.assign(tracks.size(), 0);
+    v0Tags.reserve(v0s.size());
+    for (auto const& v0 : v0s) {
+      const auto& posTrack = v0.posTrack_as<TagTracks>();
+      const auto& negTrack = v0.negTrack_as<TagTracks>();
+      uint8_t hypotheses = 0;
+      if (isK0s(v0, negTrack, posTrack, v0.collision())) {
+        hypotheses |= aod::dpgv0tag::kK0s;
+        v0Flags[posTrack.globalIndex()] |= aod::dpgtracktag::kK0sDaughter;
+        v0Flags[negTrack.globalIndex()] |= aod::dpgtracktag::kK0sDaughter;
+      }
+      v0Tags(hypotheses);
+    }
+
+    trackTags.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      trackTags(getSelectionFlags(track), v0Flags[track.globalIndex()]);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<QaTrackTagProducer>(cfgc, TaskName{"qa-track-tag-producer"})};
+}
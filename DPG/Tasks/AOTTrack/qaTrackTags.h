@@ -0,0 +1,61 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   qaTrackTags.h
+/// \brief  Tables of the track and V0 tags of the DPG efficiency tasks
+///
+/// The tags are produced once by qa-track-tag-producer: per track the selections of qa-match-eff
+/// (kinematics, TPC, ITS) and whether it is a daughter of a selected K0s, per V0 the hypotheses it
+/// is selected for in qa-k0s-tracking-efficiency. The tables are joinable with Tracks and V0Datas,
+/// so that the efficiency tasks only fill histograms when they read them.
+///
+
+#ifndef DPG_TASKS_AOTTRACK_QATRACKTAGS_H_
+#define DPG_TASKS_AOTTRACK_QATRACKTAGS_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+
+namespace dpgtracktag
+{
+enum SelectionFlag : uint8_t {
+  kKine = 1 << 0, //! kinematic selections passed
+  kTPC = 1 << 1,  //! track with TPC, TPC selections passed
+  kITS = 1 << 2   //! track with ITS, ITS selections passed
+};
+enum V0Flag : uint8_t {
+  kK0sDaughter = 1 << 0 //! daughter of a V0 selected as K0s
+};
+DECLARE_SOA_COLUMN(SelectionFlags, selectionFlags, uint8_t); //! Bit map of SelectionFlag
+DECLARE_SOA_COLUMN(V0Flags, v0Flags, uint8_t);               //! Bit map of V0Flag
+} // namespace dpgtracktag
+
+DECLARE_SOA_TABLE(DPGTrackTags, "AOD", "DPGTRACKTAG", //! Tags of the tracks, joinable with Tracks
+                  dpgtracktag::SelectionFlags,
+                  dpgtracktag::V0Flags);
+
+namespace dpgv0tag
+{
+enum Hypothesis : uint8_t {
+  kK0s = 1 << 0 //! selected as K0s
+};
+DECLARE_SOA_COLUMN(HypothesisFlags, hypothesisFlags, uint8_t); //! Bit map of Hypothesis
+} // namespace dpgv0tag
+
+DECLARE_SOA_TABLE(DPGV0Tags, "AOD", "DPGV0TAG", //! Tags of the V0s, joinable with V0Datas
+                  dpgv0tag::HypothesisFlags);
+
+} // namespace o2::aod
+
+#endif // DPG_TASKS_AOTTRACK_QATRACKTAGS_H_
@@ -16,10 +16,15 @@
 /// \brief  Task to defined the skimmed data format for the TOF skims
 ///
 
+#include <chrono>
+#include <string>
+
+#include "CCDB/BasicCCDBManager.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 /// O2Physics
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/FlatDownsampling.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
@@ -50,8 +55,30 @@ struct tofSimsTableCreator {
   Configurable<int> applyEvSel{"applyEvSel", 2, "Flag to apply rapidity cut: 0 -> no event selection, 1 -> Run 2 event selection, 2 -> Run 3 event selection"};
   Configurable<int> applyTrkSel{"applyTrkSel", 1, "Flag to apply track selection: 0 -> no track selection, 1 -> track selection"};
   Configurable<float> fractionOfEvents{"fractionOfEvents", 0.1, "Fractions of events to keep"};
+  Configurable<std::string> ccdbUrl{"ccdb-url", "http://alice-ccdb.cern.ch", "URL of the CCDB repository"};
+  Configurable<std::string> occupancyMapPath{"occupancyMapPath", "", "CCDB path of the TH2 (p, eta) occupancy map of the tracks, used to downsample them to a flat occupancy. Empty: no track downsampling"};
+  Configurable<int64_t> occupancyMapTimestamp{"occupancyMapTimestamp", -1, "Timestamp of the occupancy map, -1: current time"};
+  Configurable<float> occupancyTarget{"occupancyTarget", -1., "Number of tracks to keep per (p, eta) bin, <= 0: content of the least populated bin"};
+  Configurable<int> nMantissaBits{"nMantissaBits", 23, "Number of mantissa bits kept in the kinematic and track-length columns (23: full precision). The time columns are always stored at full precision"};
+
+  Service<o2::ccdb::BasicCCDBManager> ccdb;
+  o2::analysis::FlatDownsampling flatDownsampling;
 
-  void init(o2::framework::InitContext& initContext) {}
+  void init(o2::framework::InitContext& initContext)
+  {
+    if (occupancyMapPath.value.empty()) {
+      return;
+    }
+    ccdb->setURL(ccdbUrl.value);
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    const int64_t timestamp = occupancyMapTimestamp.value > 0 ? occupancyMapTimestamp.value : std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const TH2* map = ccdb->getForTimeStamp<TH2>(occupancyMapPath.value, timestamp);
+    if (!map) {
+      LOG(fatal) << "Cannot find the occupancy map in " << occupancyMapPath.value;
+    }
+    flatDownsampling.setMap(map, occupancyTarget);
+  }
 
   void process(Coll::iterator const& collision,
                Trks const& tracks)
@@ -85,16 +112,20 @@ struct tofSimsTableCreator {
       evTimeT0ACErr = collision.t0resolution() * 1000.f;
     }
 
+    auto q = [this](float value) { return o2::analysis::truncateMantissa(value, nMantissaBits); };
     for (auto const& trk : tracks) {
+      if (flatDownsampling.isEnabled() && !flatDownsampling.keep(trk.p(), trk.eta(), static_cast<float>(rand()) / (static_cast<float>(RAND_MAX) + 1.f))) {
+        continue;
+      }
       tableRow(trk.collisionId(),
-               trk.p(),
-               trk.pt(),
-               trk.eta(),
-               trk.phi(),
+               q(trk.p()),
+               q(trk.pt()),
+               q(trk.eta()),
+               q(trk.phi()),
                trk.pidForTracking(),
-               trk.tofExpMom(),
-               trk.length(),
-               trk.tofChi2(),
+               q(trk.tofExpMom()),
+               q(trk.length()),
+               q(trk.tofChi2()),
                trk.tofSignal(),
                trk.evTimeTOF(),
                trk.evTimeTOFErr(),
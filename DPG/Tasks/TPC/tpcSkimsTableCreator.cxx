@@ -22,6 +22,7 @@
 #include "Framework/runDataProcessing.h"
 /// O2Physics
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/FlatDownsampling.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
@@ -30,8 +31,12 @@
 
 #include "tpcSkimsTableCreator.h"
 /// ROOT
+#include "TList.h"
 #include "TRandom3.h"
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <string>
 
 using namespace o2;
 using namespace o2::framework;
@@ -47,6 +52,9 @@ struct TreeWriterTpcV0 {
   /// Tables to be produced
   Produces<o2::aod::SkimmedTPCV0Tree> rowTPCTree;
 
+  Service<o2::ccdb::BasicCCDBManager> ccdb;
+  std::array<o2::analysis::FlatDownsampling, o2::track::PID::NIDs> flatDownsampling;
+
   /// Configurables
   Configurable<float> cutPAV0{"cutPAV0", 0., "Cut on the cos(pointing angle) of the decay"};
   Configurable<float> nSigmaTOFdautrack{"nSigmaTOFdautrack", 5., "n-sigma TOF cut on the daughter tracks. Set 0 to switch it off."};
@@ -60,6 +68,12 @@ struct TreeWriterTpcV0 {
   Configurable<float> downsamplingTsalisPions{"downsamplingTsalisPions", -1., "Downsampling factor to reduce the number of pions"};
   Configurable<float> downsamplingTsalisProtons{"downsamplingTsalisProtons", -1., "Downsampling factor to reduce the number of protons"};
   Configurable<float> downsamplingTsalisElectrons{"downsamplingTsalisElectrons", -1., "Downsampling factor to reduce the number of electrons"};
+  /// Configurables flat downsampling in (p, eta) and precision of the columns
+  Configurable<std::string> ccdbUrl{"ccdb-url", "http://alice-ccdb.cern.ch", "URL of the CCDB repository"};
+  Configurable<std::string> occupancyMapPath{"occupancyMapPath", "", "CCDB path of the TList of the (p_TPC, eta) occupancy maps, one TH2 per species named as o2::track::PID::getName(). Empty: no flat downsampling"};
+  Configurable<int64_t> occupancyMapTimestamp{"occupancyMapTimestamp", -1, "Timestamp of the occupancy maps, -1: current time"};
+  Configurable<float> occupancyTarget{"occupancyTarget", -1., "Number of tracks to keep per (p_TPC, eta) bin, <= 0: content of the least populated bin of each map"};
+  Configurable<int> nMantissaBits{"nMantissaBits", 23, "Number of mantissa bits kept in the float columns (23: full precision, 10: relative precision of 1e-3)"};
   /// Configurables kaon
   Configurable<float> invariantMassCutK0Short{"invariantMassCutK0Short", 0.5, "Mass cut for K0short"};
   Configurable<float> cutQTK0min{"cutQTK0min", 0.1075, "Minimum qt for K0short"};
@@ -260,28 +274,29 @@ struct TreeWriterTpcV0 {
     const float gammapsipair = v0.psipair();
 
     const double pseudoRndm = track.pt() * 1000. - (long)(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
-      rowTPCTree(track.tpcSignal(),
-                 1. / dEdxExp,
-                 track.tpcInnerParam(),
-                 track.tgl(),
-                 track.signed1Pt(),
-                 track.eta(),
-                 track.phi(),
-                 track.y(),
+    if (pseudoRndm < dwnSmplFactor && (!flatDownsampling[id].isEnabled() || flatDownsampling[id].keep(p, track.eta(), fRndm->Rndm()))) {
+      auto q = [this](float value) { return o2::analysis::truncateMantissa(value, nMantissaBits); };
+      rowTPCTree(q(track.tpcSignal()),
+                 q(1. / dEdxExp),
+                 q(track.tpcInnerParam()),
+                 q(track.tgl()),
+                 q(track.signed1Pt()),
+                 q(track.eta()),
+                 q(track.phi()),
+                 q(track.y()),
                  mass,
-                 bg,
-                 multTPC / 11000.,
-                 std::sqrt(nClNorm / ncl),
+                 q(bg),
+                 q(multTPC / 11000.),
+                 q(std::sqrt(nClNorm / ncl)),
                  id,
-                 nSigmaTPC,
-                 nSigmaTOF,
-                 alpha,
-                 qt,
-                 cosPA,
-                 pT,
-                 v0radius,
-                 gammapsipair);
+                 q(nSigmaTPC),
+                 q(nSigmaTOF),
+                 q(alpha),
+                 q(qt),
+                 q(cosPA),
+                 q(pT),
+                 q(v0radius),
+                 q(gammapsipair));
     }
   };
 
@@ -330,6 +345,25 @@ struct TreeWriterTpcV0 {
 
   void init(o2::framework::InitContext& initContext)
   {
+    if (occupancyMapPath.value.empty()) {
+      return;
+    }
+    ccdb->setURL(ccdbUrl.value);
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    const int64_t timestamp = occupancyMapTimestamp.value > 0 ? occupancyMapTimestamp.value : std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    TList* maps = ccdb->getForTimeStamp<TList>(occupancyMapPath.value, timestamp);
+    if (!maps) {
+      LOG(fatal) << "Cannot find the occupancy maps in " << occupancyMapPath.value;
+    }
+    for (int id = 0; id < o2::track::PID::NIDs; id++) {
+      const TH2* map = static_cast<TH2*>(maps->FindObject(o2::track::PID::getName(id)));
+      if (!map) {
+        continue;
+      }
+      LOG(info) << "Flat (p, eta) downsampling of the " << o2::track::PID::getName(id) << " with the map " << occupancyMapPath.value;
+      flatDownsampling[id].setMap(map, occupancyTarget);
+    }
   }
 
   void process(Coll::iterator const& collision, Trks const& tracks, aod::V0Datas const& v0s)
@@ -419,6 +453,15 @@ struct TreeWriterTPCTOF {
   Configurable<float> downsamplingTsalisProtons{"downsamplingTsalisProtons", -1., "Downsampling factor to reduce the number of protons"};
   Configurable<float> downsamplingTsalisKaons{"downsamplingTsalisKaons", -1., "Downsampling factor to reduce the number of kaons"};
   Configurable<float> downsamplingTsalisPions{"downsamplingTsalisPions", -1., "Downsampling factor to reduce the number of pions"};
+  /// Configurables flat downsampling in (p, eta) and precision of the columns
+  Configurable<std::string> ccdbUrl{"ccdb-url", "http://alice-ccdb.cern.ch", "URL of the CCDB repository"};
+  Configurable<std::string> occupancyMapPath{"occupancyMapPath", "", "CCDB path of the TList of the (p_TPC, eta) occupancy maps, one TH2 per species named as o2::track::PID::getName(). Empty: no flat downsampling"};
+  Configurable<int64_t> occupancyMapTimestamp{"occupancyMapTimestamp", -1, "Timestamp of the occupancy maps, -1: current time"};
+  Configurable<float> occupancyTarget{"occupancyTarget", -1., "Number of tracks to keep per (p_TPC, eta) bin, <= 0: content of the least populated bin of each map"};
+  Configurable<int> nMantissaBits{"nMantissaBits", 23, "Number of mantissa bits kept in the float columns (23: full precision, 10: relative precision of 1e-3)"};
+
+  Service<o2::ccdb::BasicCCDBManager> ccdb;
+  std::array<o2::analysis::FlatDownsampling, o2::track::PID::NIDs> flatDownsampling;
 
   double tsalisCharged(double pt, double mass, double sqrts)
   {
@@ -461,22 +504,23 @@ struct TreeWriterTPCTOF {
     const int multTPC = collision.multTPC();
 
     const double pseudoRndm = track.pt() * 1000. - (long)(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
-      rowTPCTOFTree(track.tpcSignal(),
-                    1. / dEdxExp,
-                    track.tpcInnerParam(),
-                    track.tgl(),
-                    track.signed1Pt(),
-                    track.eta(),
-                    track.phi(),
-                    track.y(),
+    if (pseudoRndm < dwnSmplFactor && (!flatDownsampling[id].isEnabled() || flatDownsampling[id].keep(p, track.eta(), fRndm->Rndm()))) {
+      auto q = [this](float value) { return o2::analysis::truncateMantissa(value, nMantissaBits); };
+      rowTPCTOFTree(q(track.tpcSignal()),
+                    q(1. / dEdxExp),
+                    q(track.tpcInnerParam()),
+                    q(track.tgl()),
+                    q(track.signed1Pt()),
+                    q(track.eta()),
+                    q(track.phi()),
+                    q(track.y()),
                     mass,
-                    bg,
-                    multTPC / 11000.,
-                    std::sqrt(nClNorm / ncl),
+                    q(bg),
+                    q(multTPC / 11000.),
+                    q(std::sqrt(nClNorm / ncl)),
                     id,
-                    nSigmaTPC,
-                    nSigmaTOF);
+                    q(nSigmaTPC),
+                    q(nSigmaTOF));
     }
   };
 
@@ -514,6 +558,25 @@ struct TreeWriterTPCTOF {
 
   void init(o2::framework::InitContext& initContext)
   {
+    if (occupancyMapPath.value.empty()) {
+      return;
+    }
+    ccdb->setURL(ccdbUrl.value);
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    const int64_t timestamp = occupancyMapTimestamp.value > 0 ? occupancyMapTimestamp.value : std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    TList* maps = ccdb->getForTimeStamp<TList>(occupancyMapPath.value, timestamp);
+    if (!maps) {
+      LOG(fatal) << "Cannot find the occupancy maps in " << occupancyMapPath.value;
+    }
+    for (int id = 0; id < o2::track::PID::NIDs; id++) {
+      const TH2* map = static_cast<TH2*>(maps->FindObject(o2::track::PID::getName(id)));
+      if (!map) {
+        continue;
+      }
+      LOG(info) << "Flat (p, eta) downsampling of the " << o2::track::PID::getName(id) << " with the map " << occupancyMapPath.value;
+      flatDownsampling[id].setMap(map, occupancyTarget);
+    }
   }
   void process(Coll::iterator const& collision, Trks const& tracks)
   {
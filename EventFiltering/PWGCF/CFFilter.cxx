@@ -34,8 +34,12 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/Multiplicity.h"
 
+#include "Math/Vector4D.h"
+
+#include <array>
 #include <string>
 #include <bitset>
+#include <vector>
 
 namespace
 {
@@ -86,6 +90,7 @@ struct CFFilter {
   Configurable<std::vector<float>> confQ3TriggerLimit{"Q3TriggerLimitC", std::vector<float>{0.6f, 0.6f, 0.6f, 0.6f}, "Q3 limit for selection"};
   Configurable<int> Q3Trigger{"Q3Trigger", 0, "Choice which trigger to run"};
   Configurable<bool> performCPR{"performCPR", true, "Perform or not the close pair rejection"};
+  Configurable<bool> pruneTriplets{"pruneTriplets", true, "Skip the triplets with a pair above the Q3 limit, which cannot pass it. The Q3 distributions are then filled only for the triplets with all pairs below the limit"};
   Configurable<float> ldeltaPhiMax{"ldeltaPhiMax", 0.010, "Max limit of delta phi"};
   Configurable<float> ldeltaEtaMax{"ldeltaEtaMax", 0.010, "Max limit of delta eta"};
 
@@ -178,6 +183,36 @@ struct CFFilter {
   float mMassProton = TDatabasePDG::Instance()->GetParticle(2212)->Mass();
   float mMassLambda = TDatabasePDG::Instance()->GetParticle(3122)->Mass();
 
+  /// Adds a particle and its four-momentum, with the energy computed as in FemtoDreamMath::getQ3
+  template <typename T, typename P>
+  void addParticle(T const& part, float mass, std::vector<P>& parts, std::vector<ROOT::Math::PxPyPzEVector>& pVecs)
+  {
+    float E = sqrt(pow(part.px(), 2) + pow(part.py(), 2) + pow(part.pz(), 2) + pow(mass, 2));
+    parts.push_back(part);
+    pVecs.emplace_back(part.px(), part.py(), part.pz(), E);
+  }
+
+  /// Fills q2[i * n2 + j] with -q_ij^2 of the pair of particles i and j of two lists, with q_ij from FemtoDreamMath::getqij
+  /// Q3^2 of a triplet is the sum of the -q_ij^2 of its three pairs, none of them negative,
+  /// so that a triplet can be below the Q3 limit only if all its pairs are
+  void fillPairQ2(std::vector<ROOT::Math::PxPyPzEVector> const& pVecs1, std::vector<ROOT::Math::PxPyPzEVector> const& pVecs2, std::vector<double>& q2)
+  {
+    const int n2 = pVecs2.size();
+    q2.resize(pVecs1.size() * n2);
+    for (size_t i1 = 0; i1 < pVecs1.size(); i1++) {
+      for (int i2 = 0; i2 < n2; i2++) {
+        q2[i1 * n2 + i2] = -FemtoDreamMath::getqij(pVecs1[i1], pVecs2[i2]).M2();
+      }
+    }
+  }
+
+  /// Q3 of a triplet from the -q_ij^2 of its pairs, same as FemtoDreamMath::getQ3
+  static float getQ3(double q12, double q23, double q31)
+  {
+    float Q32 = q12 + q23 + q31;
+    return sqrt(Q32);
+  }
+
   void process(o2::aod::FemtoDreamCollision& col, o2::aod::FemtoDreamParticles& partsFemto)
   {
     auto partsProton0 = partsProton0Part->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
@@ -215,259 +250,248 @@ struct CFFilter {
       registry.get<TH1>(HIST("fMultiplicityAfter"))->Fill(col.multV0M());
       registry.get<TH1>(HIST("fZvtxAfter"))->Fill(col.posZ());
       auto Q3TriggerLimit = (std::vector<float>)confQ3TriggerLimit;
+      const bool runPPP = (Q3Trigger == 0 || Q3Trigger == 1111 || Q3Trigger == 11);
+      const bool runPPL = (Q3Trigger == 1 || Q3Trigger == 1111 || Q3Trigger == 11);
+      const bool runPLL = (Q3Trigger == 2 || Q3Trigger == 1111);
+      const bool runLLL = (Q3Trigger == 3 || Q3Trigger == 1111);
+
+      // selected (anti)protons and (anti)lambdas, index 0 for particles and 1 for antiparticles,
+      // and the -q^2 of all their pairs, computed once and summed up to the Q3^2 of the triplets
+      using FemtoParticle = std::decay_t<decltype(partsProton0.begin())>;
+      std::array<std::vector<FemtoParticle>, 2> protons, lambdas;
+      std::array<std::vector<ROOT::Math::PxPyPzEVector>, 2> pVecProtons, pVecLambdas;
+      std::array<std::vector<double>, 2> q2PP, q2PL, q2LL;
+      for (auto const& part : partsProton0) {
+        if (isFullPIDSelectedProton(part.pidcut(), part.p())) {
+          addParticle(part, mMassProton, protons[0], pVecProtons[0]);
+        }
+      }
+      for (auto const& part : partsProton1) {
+        if (isFullPIDSelectedProton(part.pidcut(), part.p())) {
+          addParticle(part, mMassProton, protons[1], pVecProtons[1]);
+        }
+      }
+      for (auto const& part : partsLambda0) {
+        if (pairCleanerTV.isCleanPair(part, part, partsFemto)) {
+          addParticle(part, mMassLambda, lambdas[0], pVecLambdas[0]);
+        }
+      }
+      for (auto const& part : partsLambda1) {
+        if (pairCleanerTV.isCleanPair(part, part, partsFemto)) {
+          addParticle(part, mMassLambda, lambdas[1], pVecLambdas[1]);
+        }
+      }
+      for (int iCharge{0}; iCharge < 2; iCharge++) {
+        if (runPPP || runPPL) {
+          fillPairQ2(pVecProtons[iCharge], pVecProtons[iCharge], q2PP[iCharge]);
+        }
+        if (runPPL || runPLL) {
+          fillPairQ2(pVecProtons[iCharge], pVecLambdas[iCharge], q2PL[iCharge]);
+        }
+        if (runPLL || runLLL) {
+          fillPairQ2(pVecLambdas[iCharge], pVecLambdas[iCharge], q2LL[iCharge]);
+        }
+      }
+
       // __________________________________________________________________________________________________________
       // TRIGGER FOR PPP TRIPLETS
-      if (Q3Trigger == 0 || Q3Trigger == 1111 || Q3Trigger == 11) {
-        if (prot >= 3) {
-          // test default combinations options
-          for (auto& [p1, p2, p3] : combinations(partsProton0, partsProton0, partsProton0)) {
-            if (!isFullPIDSelectedProton(p1.pidcut(), p1.p()) || !isFullPIDSelectedProton(p2.pidcut(), p2.p()) || !isFullPIDSelectedProton(p3.pidcut(), p3.p())) {
-              continue;
-            }
-            // Think if pair cleaning is needed in current framework
-            // Run close pair rejection
-            if (performCPR) {
-              if (closePairRejectionTT.isClosePair(p1, p2, partsFemto, magneticField)) {
-                continue;
-              }
-              if (closePairRejectionTT.isClosePair(p1, p3, partsFemto, magneticField)) {
-                continue;
-              }
-              if (closePairRejectionTT.isClosePair(p2, p3, partsFemto, magneticField)) {
-                continue;
-              }
-            }
-            auto Q3 = FemtoDreamMath::getQ3(p1, mMassProton, p2, mMassProton, p3, mMassProton);
-            registry.get<TH1>(HIST("fSameEventPartPPP"))->Fill(Q3);
-            if (Q3 < Q3TriggerLimit.at(0)) {
-              lowQ3Triplets[0]++;
-            }
+      if (runPPP) {
+        const double maxQ2 = Q3TriggerLimit.at(0) * Q3TriggerLimit.at(0);
+        for (int iCharge{0}; iCharge < 2; iCharge++) {
+          if (iCharge == 1 && lowQ3Triplets[0] > 0) { // if at least one triplet found in particles, no need to check antiparticles
+            break;
           }
-        } // end if
-
-        if (lowQ3Triplets[0] == 0) { // Use this in final version only, for testing comment { // if at least one triplet found in particles, no need to check antiparticles
-          if (antiprot >= 3) {
-            for (auto& [p1, p2, p3] : combinations(partsProton1, partsProton1, partsProton1)) {
-
-              if (!isFullPIDSelectedProton(p1.pidcut(), p1.p()) || !isFullPIDSelectedProton(p2.pidcut(), p2.p()) || !isFullPIDSelectedProton(p3.pidcut(), p3.p())) {
+          const auto& parts = protons[iCharge];
+          const auto& q2 = q2PP[iCharge];
+          const int nParts = parts.size();
+          if (nParts < 3) {
+            continue;
+          }
+          auto hQ3 = iCharge == 0 ? registry.get<TH1>(HIST("fSameEventPartPPP")) : registry.get<TH1>(HIST("fSameEventAntiPartPPP"));
+          for (int i1{0}; i1 < nParts; i1++) {
+            for (int i2{i1 + 1}; i2 < nParts; i2++) {
+              const double q12 = q2[i1 * nParts + i2];
+              if (pruneTriplets && q12 >= maxQ2) {
                 continue;
               }
-              // Think if pair cleaning is needed in current framework
-              // Run close pair rejection
-              if (performCPR) {
-                if (closePairRejectionTT.isClosePair(p1, p2, partsFemto, magneticField)) {
+              for (int i3{i2 + 1}; i3 < nParts; i3++) {
+                const double q23 = q2[i2 * nParts + i3];
+                const double q31 = q2[i1 * nParts + i3];
+                if (pruneTriplets && (q23 >= maxQ2 || q31 >= maxQ2)) {
                   continue;
                 }
-                if (closePairRejectionTT.isClosePair(p1, p3, partsFemto, magneticField)) {
-                  continue;
+                // Think if pair cleaning is needed in current framework
+                // Run close pair rejection
+                if (performCPR) {
+                  if (closePairRejectionTT.isClosePair(parts[i1], parts[i2], partsFemto, magneticField)) {
+                    continue;
+                  }
+                  if (closePairRejectionTT.isClosePair(parts[i1], parts[i3], partsFemto, magneticField)) {
+                    continue;
+                  }
+                  if (closePairRejectionTT.isClosePair(parts[i2], parts[i3], partsFemto, magneticField)) {
+                    continue;
+                  }
                 }
-                if (closePairRejectionTT.isClosePair(p2, p3, partsFemto, magneticField)) {
-                  continue;
+                auto Q3 = getQ3(q12, q23, q31);
+                hQ3->Fill(Q3);
+                if (Q3 < Q3TriggerLimit.at(0)) {
+                  lowQ3Triplets[0]++;
                 }
               }
-              auto Q3 = FemtoDreamMath::getQ3(p1, mMassProton, p2, mMassProton, p3, mMassProton);
-              registry.get<TH1>(HIST("fSameEventAntiPartPPP"))->Fill(Q3);
-              if (Q3 < Q3TriggerLimit.at(0)) {
-                lowQ3Triplets[0]++;
-              }
             }
           }
-        } // end if
-        //}
+        }
       }
       // __________________________________________________________________________________________________________
       // TRIGGER FOR PPL TRIPLETS
-      if (Q3Trigger == 1 || Q3Trigger == 1111 || Q3Trigger == 11) {
-        if (partsLambda0.size() >= 1 && prot >= 2) {
-          for (auto& partLambda : partsLambda0) {
-            registry.get<TH1>(HIST("fPtPPL"))->Fill(partLambda.pt());
-            registry.get<TH1>(HIST("fMinvLambda"))->Fill(partLambda.mLambda());
-            if (!pairCleanerTV.isCleanPair(partLambda, partLambda, partsFemto)) {
-              continue;
-            }
-            for (auto& [p1, p2] : combinations(partsProton0, partsProton0)) {
-              if (!isFullPIDSelectedProton(p1.pidcut(), p1.p()) || !isFullPIDSelectedProton(p2.pidcut(), p2.p())) {
-                continue;
-              }
-              if (performCPR) {
-                if (closePairRejectionTT.isClosePair(p1, p2, partsFemto, magneticField)) {
-                  continue;
-                }
-                if (closePairRejectionTV0.isClosePair(p1, partLambda, partsFemto, magneticField)) {
-                  continue;
-                }
-                if (closePairRejectionTV0.isClosePair(p2, partLambda, partsFemto, magneticField)) {
-                  continue;
-                }
-              }
-              auto Q3 = FemtoDreamMath::getQ3(p1, mMassProton, p2, mMassProton, partLambda, mMassLambda);
-              registry.get<TH1>(HIST("fSameEventPartPPL"))->Fill(Q3);
-              if (Q3 < Q3TriggerLimit.at(1)) {
-                lowQ3Triplets[1]++;
-              }
-            }
+      if (runPPL) {
+        const double maxQ2 = Q3TriggerLimit.at(1) * Q3TriggerLimit.at(1);
+        for (int iCharge{0}; iCharge < 2; iCharge++) {
+          if (iCharge == 1 && lowQ3Triplets[1] > 0) { // if at least one triplet found in particles, no need to check antiparticles
+            break;
           }
-        } // end if
-
-        if (lowQ3Triplets[1] == 0) { // if at least one triplet found in particles, no need to check antiparticles
-          if (partsLambda1.size() >= 1 && antiprot >= 2) {
-            for (auto& partLambda : partsLambda1) {
+          if ((iCharge == 0 ? partsLambda0.size() : partsLambda1.size()) < 1 || protons[iCharge].size() < 2) {
+            continue;
+          }
+          if (iCharge == 0) {
+            for (auto const& partLambda : partsLambda0) {
+              registry.get<TH1>(HIST("fPtPPL"))->Fill(partLambda.pt());
+              registry.get<TH1>(HIST("fMinvLambda"))->Fill(partLambda.mLambda());
+            }
+          } else {
+            for (auto const& partLambda : partsLambda1) {
               registry.get<TH1>(HIST("fPtAntiPPL"))->Fill(partLambda.pt());
               registry.get<TH1>(HIST("fMinvAntiLambda"))->Fill(partLambda.mAntiLambda());
-              if (!pairCleanerTV.isCleanPair(partLambda, partLambda, partsFemto)) {
+            }
+          }
+          const auto& parts = protons[iCharge];
+          const auto& partsL = lambdas[iCharge];
+          const int nParts = parts.size();
+          const int nPartsL = partsL.size();
+          auto hQ3 = iCharge == 0 ? registry.get<TH1>(HIST("fSameEventPartPPL")) : registry.get<TH1>(HIST("fSameEventAntiPartPPL"));
+          for (int iL{0}; iL < nPartsL; iL++) {
+            for (int i1{0}; i1 < nParts; i1++) {
+              const double q31 = q2PL[iCharge][i1 * nPartsL + iL];
+              if (pruneTriplets && q31 >= maxQ2) {
                 continue;
               }
-              for (auto& [p1, p2] : combinations(partsProton1, partsProton1)) {
-                if (!isFullPIDSelectedProton(p1.pidcut(), p1.p()) || !isFullPIDSelectedProton(p2.pidcut(), p2.p())) {
+              for (int i2{i1 + 1}; i2 < nParts; i2++) {
+                const double q12 = q2PP[iCharge][i1 * nParts + i2];
+                const double q23 = q2PL[iCharge][i2 * nPartsL + iL];
+                if (pruneTriplets && (q12 >= maxQ2 || q23 >= maxQ2)) {
                   continue;
                 }
                 if (performCPR) {
-                  if (closePairRejectionTT.isClosePair(p1, p2, partsFemto, magneticField)) {
+                  if (closePairRejectionTT.isClosePair(parts[i1], parts[i2], partsFemto, magneticField)) {
                     continue;
                   }
-                  if (closePairRejectionTV0.isClosePair(p1, partLambda, partsFemto, magneticField)) {
+                  if (closePairRejectionTV0.isClosePair(parts[i1], partsL[iL], partsFemto, magneticField)) {
                     continue;
                   }
-                  if (closePairRejectionTV0.isClosePair(p2, partLambda, partsFemto, magneticField)) {
+                  if (closePairRejectionTV0.isClosePair(parts[i2], partsL[iL], partsFemto, magneticField)) {
                     continue;
                   }
                 }
-                auto Q3 = FemtoDreamMath::getQ3(p1, mMassProton, p2, mMassProton, partLambda, mMassLambda);
-                registry.get<TH1>(HIST("fSameEventAntiPartPPL"))->Fill(Q3);
+                auto Q3 = getQ3(q12, q23, q31);
+                hQ3->Fill(Q3);
                 if (Q3 < Q3TriggerLimit.at(1)) {
                   lowQ3Triplets[1]++;
                 }
               }
             }
-          } // end if
+          }
         }
       }
 
       // __________________________________________________________________________________________________________
       // TRIGGER FOR PLL TRIPLETS
-      if (Q3Trigger == 2 || Q3Trigger == 1111) {
-        if (partsLambda0.size() >= 2 && prot >= 1) {
-          for (auto& p1 : partsProton0) {
-            if (!isFullPIDSelectedProton(p1.pidcut(), p1.p())) {
-              continue;
-            }
-            for (auto& [partLambda1, partLambda2] : combinations(partsLambda0, partsLambda0)) {
-              // maybe implement L1-L2 no shared tracks
-              if (!pairCleanerTV.isCleanPair(partLambda1, partLambda1, partsFemto)) {
-                continue;
-              }
-              if (!pairCleanerTV.isCleanPair(partLambda2, partLambda2, partsFemto)) {
-                continue;
-              }
-
-              if (performCPR) {
-                if (closePairRejectionTV0.isClosePair(p1, partLambda1, partsFemto, magneticField)) {
-                  continue;
-                }
-                if (closePairRejectionTV0.isClosePair(p1, partLambda2, partsFemto, magneticField)) {
-                  continue;
-                }
-                // maybe implement L-L cpr
-              }
-              auto Q3 = FemtoDreamMath::getQ3(p1, mMassProton, partLambda1, mMassLambda, partLambda2, mMassLambda);
-              registry.get<TH1>(HIST("fSameEventPartPLL"))->Fill(Q3);
-              if (Q3 < Q3TriggerLimit.at(2)) {
-                lowQ3Triplets[2]++;
-              }
-            }
+      if (runPLL) {
+        const double maxQ2 = Q3TriggerLimit.at(2) * Q3TriggerLimit.at(2);
+        for (int iCharge{0}; iCharge < 2; iCharge++) {
+          if (iCharge == 1 && lowQ3Triplets[2] > 0) { // if at least one triplet found in particles, no need to check antiparticles
+            break;
           }
-        } // end if
-
-        if (lowQ3Triplets[2] == 0) { // if at least one triplet found in particles, no need to check antiparticles
-          if (partsLambda1.size() >= 2 && antiprot >= 1) {
-            for (auto& p1 : partsProton1) {
-              if (!isFullPIDSelectedProton(p1.pidcut(), p1.p())) {
+          const auto& parts = protons[iCharge];
+          const auto& partsL = lambdas[iCharge];
+          const int nParts = parts.size();
+          const int nPartsL = partsL.size();
+          if (nPartsL < 2 || nParts < 1) {
+            continue;
+          }
+          auto hQ3 = iCharge == 0 ? registry.get<TH1>(HIST("fSameEventPartPLL")) : registry.get<TH1>(HIST("fSameEventAntiPartPLL"));
+          for (int i1{0}; i1 < nParts; i1++) {
+            for (int iL1{0}; iL1 < nPartsL; iL1++) {
+              const double q12 = q2PL[iCharge][i1 * nPartsL + iL1];
+              if (pruneTriplets && q12 >= maxQ2) {
                 continue;
               }
-              for (auto& [partLambda1, partLambda2] : combinations(partsLambda1, partsLambda1)) {
+              for (int iL2{iL1 + 1}; iL2 < nPartsL; iL2++) {
                 // maybe implement L1-L2 no shared tracks
-                if (!pairCleanerTV.isCleanPair(partLambda1, partLambda1, partsFemto)) {
-                  continue;
-                }
-                if (!pairCleanerTV.isCleanPair(partLambda2, partLambda2, partsFemto)) {
+                const double q23 = q2LL[iCharge][iL1 * nPartsL + iL2];
+                const double q31 = q2PL[iCharge][i1 * nPartsL + iL2];
+                if (pruneTriplets && (q23 >= maxQ2 || q31 >= maxQ2)) {
                   continue;
                 }
-
                 if (performCPR) {
-                  if (closePairRejectionTV0.isClosePair(p1, partLambda1, partsFemto, magneticField)) {
+                  if (closePairRejectionTV0.isClosePair(parts[i1], partsL[iL1], partsFemto, magneticField)) {
                     continue;
                   }
-                  if (closePairRejectionTV0.isClosePair(p1, partLambda2, partsFemto, magneticField)) {
+                  if (closePairRejectionTV0.isClosePair(parts[i1], partsL[iL2], partsFemto, magneticField)) {
                     continue;
                   }
                   // maybe implement L-L cpr
                 }
-                auto Q3 = FemtoDreamMath::getQ3(p1, mMassProton, partLambda1, mMassLambda, partLambda2, mMassLambda);
-                registry.get<TH1>(HIST("fSameEventAntiPartPLL"))->Fill(Q3);
+                auto Q3 = getQ3(q12, q23, q31);
+                hQ3->Fill(Q3);
                 if (Q3 < Q3TriggerLimit.at(2)) {
                   lowQ3Triplets[2]++;
                 }
               }
             }
-          } // end if
+          }
         }
       }
 
       // __________________________________________________________________________________________________________
       // TRIGGER FOR LLL TRIPLETS
-      if (Q3Trigger == 3 || Q3Trigger == 1111) {
-        if (partsLambda0.size() >= 3) {
-          // test default combinations options
-          for (auto& [partLambda1, partLambda2, partLambda3] : combinations(partsLambda0, partsLambda0, partsLambda0)) {
-            if (!pairCleanerTV.isCleanPair(partLambda1, partLambda1, partsFemto)) {
-              continue;
-            }
-            if (!pairCleanerTV.isCleanPair(partLambda2, partLambda2, partsFemto)) {
-              continue;
-            }
-            if (!pairCleanerTV.isCleanPair(partLambda3, partLambda3, partsFemto)) {
-              continue;
-            }
-            // Run close pair rejection
-            if (performCPR) {
-              // check close pair rejection for L-L
-            }
-            auto Q3 = FemtoDreamMath::getQ3(partLambda1, mMassLambda, partLambda2, mMassLambda, partLambda3, mMassLambda);
-            registry.get<TH1>(HIST("fSameEventPartLLL"))->Fill(Q3);
-            if (Q3 < Q3TriggerLimit.at(3)) {
-              lowQ3Triplets[3]++;
-            }
+      if (runLLL) {
+        const double maxQ2 = Q3TriggerLimit.at(3) * Q3TriggerLimit.at(3);
+        for (int iCharge{0}; iCharge < 2; iCharge++) {
+          if (iCharge == 1 && lowQ3Triplets[3] > 0) { // if at least one triplet found in particles, no need to check antiparticles
+            break;
           }
-        } // end if
-
-        if (lowQ3Triplets[3] == 0) { // Use this in final version only, for testing comment { // if at least one triplet found in particles, no need to check antiparticles
-
-          if (partsLambda1.size() >= 3) {
-            // test default combinations options
-            for (auto& [partLambda1, partLambda2, partLambda3] : combinations(partsLambda1, partsLambda1, partsLambda1)) {
-              if (!pairCleanerTV.isCleanPair(partLambda1, partLambda1, partsFemto)) {
-                continue;
-              }
-              if (!pairCleanerTV.isCleanPair(partLambda2, partLambda2, partsFemto)) {
-                continue;
-              }
-              if (!pairCleanerTV.isCleanPair(partLambda3, partLambda3, partsFemto)) {
+          const auto& q2 = q2LL[iCharge];
+          const int nPartsL = lambdas[iCharge].size();
+          if (nPartsL < 3) {
+            continue;
+          }
+          auto hQ3 = iCharge == 0 ? registry.get<TH1>(HIST("fSameEventPartLLL")) : registry.get<TH1>(HIST("fSameEventAntiPartLLL"));
+          for (int iL1{0}; iL1 < nPartsL; iL1++) {
+            for (int iL2{iL1 + 1}; iL2 < nPartsL; iL2++) {
+              const double q12 = q2[iL1 * nPartsL + iL2];
+              if (pruneTriplets && q12 >= maxQ2) {
                 continue;
               }
-              // Run close pair rejection
-              if (performCPR) {
-                // check close pair rejection for L-L
-              }
-              auto Q3 = FemtoDreamMath::getQ3(partLambda1, mMassLambda, partLambda2, mMassLambda, partLambda3, mMassLambda);
-              registry.get<TH1>(HIST("fSameEventAntiPartLLL"))->Fill(Q3);
-              if (Q3 < Q3TriggerLimit.at(3)) {
-                lowQ3Triplets[3]++;
+              for (int iL3{iL2 + 1}; iL3 < nPartsL; iL3++) {
+                const double q23 = q2[iL2 * nPartsL + iL3];
+                const double q31 = q2[iL1 * nPartsL + iL3];
+                if (pruneTriplets && (q23 >= maxQ2 || q31 >= maxQ2)) {
+                  continue;
+                }
+                // Run close pair rejection
+                if (performCPR) {
+                  // check close pair rejection for L-L
+                }
+                auto Q3 = getQ3(q12, q23, q31);
+                hQ3->Fill(Q3);
+                if (Q3 < Q3TriggerLimit.at(3)) {
+                  lowQ3Triplets[3]++;
+                }
               }
             }
           }
-
-        } // end if
-        //}
+        }
       }
     }
 
@@ -135,10 +135,19 @@ struct HfFilter { // Main struct for HF triggers
   Configurable<std::string> mlModelPathCCDB{"mlModelPathCCDB", "Analysis/PWGHF/ML/HFTrigger/", "Path on CCDB"};
   Configurable<long> timestampCCDB{"timestampCCDB", -1, "timestamp of the ONNX file for ML model used to query in CCDB. Exceptions: > 0 for the specific timestamp, 0 gets the run dependent timestamp"};
   Configurable<bool> loadModelsFromCCDB{"loadModelsFromCCDB", false, "Flag to enable or disable the loading of models from CCDB"};
+  Configurable<int> numThreadsIntraOpML{"numThreadsIntraOpML", 1, "Number of threads used by ONNX Runtime within each node of the ML models"};
+  Configurable<int> numThreadsInterOpML{"numThreadsInterOpML", 1, "Number of threads used by ONNX Runtime across the nodes of the ML models"};
+  Configurable<bool> enableGraphOptimisationML{"enableGraphOptimisationML", true, "Flag to enable the ONNX Runtime graph optimisations of the ML models"};
+  Configurable<std::string> executionProviderML{"executionProviderML", "cpu", "ONNX Runtime execution provider of the ML models: cpu, cuda, rocm or tensorrt. The CPU is used if the provider is not available"};
+  Configurable<int> deviceIdML{"deviceIdML", 0, "GPU used by the GPU execution providers of the ML models"};
 
   // parameter for Optimisation Tree
   Configurable<bool> applyOptimisation{"applyOptimisation", false, "Flag to enable or disable optimisation"};
 
+  // lazy evaluation of the expensive triggers
+  Configurable<int> lazyTriggerCost{"lazyTriggerCost", -1, "Triggers with cost >= this value are evaluated only if the event is not selected yet (high-pT and double charm: 1, beauty and femto: 2), -1 to evaluate all triggers"};
+  o2::aod::LazyTriggerEvaluator<kNtriggersHF> lazyTriggers;
+
   // array of ONNX config and BDT thresholds
   std::array<std::string, kNCharmParticles> onnxFiles;
   std::array<LabeledArray<double>, kNCharmParticles> thresholdBDTScores;
@@ -160,14 +169,8 @@ struct HfFilter { // Main struct for HF triggers
   // ONNX
   std::array<std::shared_ptr<Ort::Experimental::Session>, kNCharmParticles> sessionML = {nullptr, nullptr, nullptr, nullptr, nullptr};
   std::array<std::vector<std::vector<int64_t>>, kNCharmParticles> inputShapesML{};
-  std::array<Ort::Env, kNCharmParticles> envML = {
-    Ort::Env{ORT_LOGGING_LEVEL_ERROR, "ml-model-d0-triggers"},
-    Ort::Env{ORT_LOGGING_LEVEL_ERROR, "ml-model-dplus-triggers"},
-    Ort::Env{ORT_LOGGING_LEVEL_ERROR, "ml-model-ds-triggers"},
-    Ort::Env{ORT_LOGGING_LEVEL_ERROR, "ml-model-lc-triggers"},
-    Ort::Env{ORT_LOGGING_LEVEL_ERROR, "ml-model-xic-triggers"}};
-  std::array<Ort::SessionOptions, kNCharmParticles> sessionOptions{Ort::SessionOptions(), Ort::SessionOptions(), Ort::SessionOptions(), Ort::SessionOptions(), Ort::SessionOptions()};
   std::array<int, kNCharmParticles> dataTypeML{};
+  o2::analysis::ONNXSessionSettings sessionSettingsML{};
 
   void init(o2::framework::InitContext&)
   {
@@ -221,10 +224,15 @@ struct HfFilter { // Main struct for HF triggers
       onnxFileXicToPiKPConf};
 
     // init ONNX runtime session
+    sessionSettingsML.intraOpNumThreads = numThreadsIntraOpML;
+    sessionSettingsML.interOpNumThreads = numThreadsInterOpML;
+    sessionSettingsML.enableGraphOptimization = enableGraphOptimisationML;
+    sessionSettingsML.executionProvider = executionProviderML.value;
+    sessionSettingsML.deviceId = deviceIdML;
     if (applyML && (!loadModelsFromCCDB || timestampCCDB != 0)) {
       for (auto iCharmPart{0}; iCharmPart < kNCharmParticles; ++iCharmPart) {
         if (onnxFiles[iCharmPart] != "") {
-          sessionML[iCharmPart].reset(InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], envML[iCharmPart], sessionOptions[iCharmPart], inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, timestampCCDB));
+          sessionML[iCharmPart] = InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], sessionSettingsML, inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, timestampCCDB);
         }
       }
     }
@@ -232,6 +240,13 @@ struct HfFilter { // Main struct for HF triggers
     if (applyOptimisation && !applyML) {
       LOG(fatal) << "Can't apply optimisation if ML is not applied.";
     }
+
+    // the candidate-track combinatorics of beauty and femto triggers are the expensive part
+    lazyTriggers.setCosts({1, 1, 2, 2, 2, 2, 1, 1, 1});
+    lazyTriggers.setLazyCostThreshold(lazyTriggerCost);
+    if (applyOptimisation && lazyTriggers.isLazy()) {
+      LOG(fatal) << "Can't apply optimisation with lazy evaluation of the triggers.";
+    }
   }
   /// Single-track cuts for bachelor track of beauty candidates
   /// \param track is a track
@@ -630,6 +645,21 @@ struct HfFilter { // Main struct for HF triggers
   Filter trackFilter = requireGlobalTrackWoDCAInFilter();
   using BigTracksPID = soa::Filtered<soa::Join<aod::BigTracksExtended, aod::TrackSelection, aod::pidTPCFullPi, aod::pidTOFFullPi, aod::pidTPCFullKa, aod::pidTOFFullKa, aod::pidTPCFullPr, aod::pidTOFFullPr>>;
 
+  /// Track quantities used in the candidate-track combinatorics, computed once per collision
+  struct TrackForCombinatorics {
+    int64_t globalIndex;
+    std::array<float, 3> pVec;
+    float signed1Pt;
+    float dcaXY;
+    float tpcNSigmaPr;
+    float tofNSigmaPr;
+    int selBeauty3P;    // isSelectedTrackForBeauty(track, kBeauty3P)
+    int selBeauty4P;    // isSelectedTrackForBeauty(track, kBeauty4P)
+    bool isProtonFemto; // isSelectedProton4Femto(track)
+  };
+  std::vector<TrackForCombinatorics> tracksComb{};
+  std::vector<int> tracksCombRegularBeauty3P{}; // positions in tracksComb of the regular bachelor tracks of 3-prong beauty candidates
+
   void process(aod::Collision const& collision,
                aod::BCsWithTimestamps const&,
                HfTrackIndexProng2withColl const& cand2Prongs,
@@ -643,7 +673,7 @@ struct HfFilter { // Main struct for HF triggers
     if (applyML && (loadModelsFromCCDB && timestampCCDB == 0) && !sessionML[kD0]) {
       for (auto iCharmPart{0}; iCharmPart < kNCharmParticles; ++iCharmPart) {
         if (onnxFiles[iCharmPart] != "") {
-          sessionML[iCharmPart].reset(InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], envML[iCharmPart], sessionOptions[iCharmPart], inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, timestampCCDB));
+          sessionML[iCharmPart] = InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], sessionSettingsML, inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, timestampCCDB);
         }
       }
     }
@@ -654,8 +684,23 @@ struct HfFilter { // Main struct for HF triggers
     bool keepEvent[kNtriggersHF]{false};
     //
 
+    // single-track selections for the bachelor tracks, evaluated once and shared by all the candidates
+    tracksComb.clear();
+    tracksCombRegularBeauty3P.clear();
+    for (const auto& track : tracks) {
+      auto selBeauty3P = isSelectedTrackForBeauty(track, kBeauty3P);
+      if (selBeauty3P == kRegular) {
+        tracksCombRegularBeauty3P.push_back(tracksComb.size());
+      }
+      tracksComb.push_back({track.globalIndex(), std::array{track.px(), track.py(), track.pz()}, track.signed1Pt(), track.dcaXY(), track.tpcNSigmaPr(), track.tofNSigmaPr(),
+                            selBeauty3P, isSelectedTrackForBeauty(track, kBeauty4P), isSelectedProton4Femto(track)});
+    }
+
     std::vector<std::vector<long>> indicesDau2Prong{};
-    for (const auto& cand2Prong : cand2Prongs) {                                        // start loop over 2 prongs
+    for (const auto& cand2Prong : cand2Prongs) { // start loop over 2 prongs
+      if (lazyTriggers.isLazy() && !lazyTriggers.isAnyNeeded(keepEvent)) {
+        break;
+      }
       if (!TESTBIT(cand2Prong.hfflag(), o2::aod::hf_cand_2prong::DecayType::D0ToPiK)) { // check if it's a D0
         continue;
       }
@@ -734,16 +779,19 @@ struct HfFilter { // Main struct for HF triggers
         indicesDau2Prong.push_back(std::vector<long>{trackPos.globalIndex(), trackNeg.globalIndex()});
       } // end multi-charm selection
 
-      for (const auto& track : tracks) { // start loop over tracks
-        if (track.globalIndex() == trackPos.globalIndex() || track.globalIndex() == trackNeg.globalIndex()) {
+      for (const auto& track : tracksComb) { // start loop over tracks
+        if (!(isBeautyTagged && lazyTriggers.isNeeded(keepEvent, kBeauty3P)) && !(isCharmTagged && lazyTriggers.isNeeded(keepEvent, kFemto2P))) {
+          break;
+        }
+        if (track.globalIndex == trackPos.globalIndex() || track.globalIndex == trackNeg.globalIndex()) {
           continue;
         }
 
-        std::array<float, 3> pVecThird = {track.px(), track.py(), track.pz()};
+        const auto& pVecThird = track.pVec;
 
-        if (!keepEvent[kBeauty3P] && isBeautyTagged) {
-          int isTrackSelected = isSelectedTrackForBeauty(track, kBeauty3P);
-          if (isTrackSelected && ((TESTBIT(selD0, 0) && track.signed1Pt() < 0) || (TESTBIT(selD0, 1) && track.signed1Pt() > 0))) {
+        if (isBeautyTagged && lazyTriggers.isNeeded(keepEvent, kBeauty3P)) {
+          int isTrackSelected = track.selBeauty3P;
+          if (isTrackSelected && ((TESTBIT(selD0, 0) && track.signed1Pt < 0) || (TESTBIT(selD0, 1) && track.signed1Pt > 0))) {
             auto massCand = RecoDecay::m(std::array{pVec2Prong, pVecThird}, std::array{massD0, massPi});
             auto pVecBeauty3Prong = RecoDecay::pVec(pVec2Prong, pVecThird);
             auto ptCand = RecoDecay::pt(pVecBeauty3Prong);
@@ -751,7 +799,7 @@ struct HfFilter { // Main struct for HF triggers
               keepEvent[kBeauty3P] = true;
               // fill optimisation tree for D0
               if (applyOptimisation) {
-                optimisationTreeBeauty(collision.globalIndex(), pdg::Code::kD0, pt2Prong, scoresToFill[0], scoresToFill[1], scoresToFill[2], track.dcaXY());
+                optimisationTreeBeauty(collision.globalIndex(), pdg::Code::kD0, pt2Prong, scoresToFill[0], scoresToFill[1], scoresToFill[2], track.dcaXY);
               }
               if (activateQA) {
                 hMassVsPtB[kBplus]->Fill(ptCand, massCand);
@@ -760,15 +808,16 @@ struct HfFilter { // Main struct for HF triggers
               if (activateQA) {
                 hMassVsPtC[kNCharmParticles]->Fill(ptCand, massCand);
               }
-              for (const auto& trackB : tracks) { // start loop over tracks
-                if (track.signed1Pt() * trackB.signed1Pt() < 0 && isSelectedTrackForBeauty(trackB, kBeauty3P) == kRegular) {
-                  std::array<float, 3> pVecFourth = {trackB.px(), trackB.py(), trackB.pz()};
+              for (const auto& iTrackB : tracksCombRegularBeauty3P) { // start loop over tracks
+                const auto& trackB = tracksComb[iTrackB];
+                if (track.signed1Pt * trackB.signed1Pt < 0) {
+                  const auto& pVecFourth = trackB.pVec;
                   auto massCandB0 = RecoDecay::m(std::array{pVec2Prong, pVecThird, pVecFourth}, std::array{massD0, massPi, massPi});
                   if (std::abs(massCandB0 - massB0) <= deltaMassB0) {
                     keepEvent[kBeauty3P] = true;
                     // fill optimisation tree for D0
                     if (applyOptimisation) {
-                      optimisationTreeBeauty(collision.globalIndex(), 413, pt2Prong, scoresToFill[0], scoresToFill[1], scoresToFill[2], track.dcaXY()); // pdgCode of D*(2010)+: 413
+                      optimisationTreeBeauty(collision.globalIndex(), 413, pt2Prong, scoresToFill[0], scoresToFill[1], scoresToFill[2], track.dcaXY); // pdgCode of D*(2010)+: 413
                     }
                     if (activateQA) {
                       auto pVecBeauty4Prong = RecoDecay::pVec(pVec2Prong, pVecThird, pVecFourth);
@@ -783,12 +832,11 @@ struct HfFilter { // Main struct for HF triggers
         } // end beauty selection
 
         // 2-prong femto
-        if (!keepEvent[kFemto2P] && isCharmTagged) {
-          bool isProton = isSelectedProton4Femto(track);
-          if (isProton) {
-            float relativeMomentum = computeRelativeMomentum(track, pVec2Prong, massD0);
+        if (isCharmTagged && lazyTriggers.isNeeded(keepEvent, kFemto2P)) {
+          if (track.isProtonFemto) {
+            float relativeMomentum = computeRelativeMomentum(track.pVec, pVec2Prong, massD0);
             if (applyOptimisation) {
-              optimisationTreeFemto(collision.globalIndex(), pdg::Code::kD0, pt2Prong, scoresToFill[0], scoresToFill[1], scoresToFill[2], relativeMomentum, track.tpcNSigmaPr(), track.tofNSigmaPr());
+              optimisationTreeFemto(collision.globalIndex(), pdg::Code::kD0, pt2Prong, scoresToFill[0], scoresToFill[1], scoresToFill[2], relativeMomentum, track.tpcNSigmaPr, track.tofNSigmaPr);
             }
             if (relativeMomentum < femtoMaxRelativeMomentum) {
               keepEvent[kFemto2P] = true;
@@ -804,6 +852,9 @@ struct HfFilter { // Main struct for HF triggers
 
     std::vector<std::vector<long>> indicesDau3Prong{};
     for (const auto& cand3Prong : cand3Prongs) { // start loop over 3 prongs
+      if (lazyTriggers.isLazy() && !lazyTriggers.isAnyNeeded(keepEvent)) {
+        break;
+      }
       std::array<int8_t, kNCharmParticles - 1> is3Prong = {
         TESTBIT(cand3Prong.hfflag(), o2::aod::hf_cand_3prong::DecayType::DplusToPiKPi),
         TESTBIT(cand3Prong.hfflag(), o2::aod::hf_cand_3prong::DecayType::DsToKKPi),
@@ -934,27 +985,30 @@ struct HfFilter { // Main struct for HF triggers
         }
       } // end high-pT selection
 
-      for (const auto& track : tracks) { // start loop over tracks
+      int charmParticleID[kNBeautyParticles - 2] = {pdg::Code::kDPlus, pdg::Code::kDS, pdg::Code::kLambdaCPlus, pdg::Code::kXiCPlus};
+      float massCharmHypos[kNBeautyParticles - 2] = {massDPlus, massDs, massLc, massXic};
+      float massBeautyHypos[kNBeautyParticles - 2] = {massB0, massBs, massLb, massXib};
+      float deltaMassHypos[kNBeautyParticles - 2] = {deltaMassB0, deltaMassBs, deltaMassLb, deltaMassXib};
 
-        if (track.globalIndex() == trackFirst.globalIndex() || track.globalIndex() == trackSecond.globalIndex() || track.globalIndex() == trackThird.globalIndex()) {
-          continue;
+      for (const auto& track : tracksComb) { // start loop over tracks
+        if (!lazyTriggers.isNeeded(keepEvent, kBeauty4P) && !lazyTriggers.isNeeded(keepEvent, kFemto3P)) {
+          break;
         }
 
-        std::array<float, 3> pVecFourth = {track.px(), track.py(), track.pz()};
+        if (track.globalIndex == trackFirst.globalIndex() || track.globalIndex == trackSecond.globalIndex() || track.globalIndex == trackThird.globalIndex()) {
+          continue;
+        }
 
-        int charmParticleID[kNBeautyParticles - 2] = {pdg::Code::kDPlus, pdg::Code::kDS, pdg::Code::kLambdaCPlus, pdg::Code::kXiCPlus};
+        const auto& pVecFourth = track.pVec;
 
-        float massCharmHypos[kNBeautyParticles - 2] = {massDPlus, massDs, massLc, massXic};
-        float massBeautyHypos[kNBeautyParticles - 2] = {massB0, massBs, massLb, massXib};
-        float deltaMassHypos[kNBeautyParticles - 2] = {deltaMassB0, deltaMassBs, deltaMassLb, deltaMassXib};
-        if (track.signed1Pt() * sign3Prong < 0 && isSelectedTrackForBeauty(track, kBeauty4P) == kRegular) {
-          for (int iHypo{0}; iHypo < kNBeautyParticles - 2 && !keepEvent[kBeauty4P]; ++iHypo) {
+        if (track.signed1Pt * sign3Prong < 0 && track.selBeauty4P == kRegular) {
+          for (int iHypo{0}; iHypo < kNBeautyParticles - 2 && lazyTriggers.isNeeded(keepEvent, kBeauty4P); ++iHypo) {
             if (isBeautyTagged[iHypo] && (TESTBIT(is3ProngInMass[iHypo], 0) || TESTBIT(is3ProngInMass[iHypo], 1))) {
               auto massCandB = RecoDecay::m(std::array{pVec3Prong, pVecFourth}, std::array{massCharmHypos[iHypo], massPi});
               if (std::abs(massCandB - massBeautyHypos[iHypo]) <= deltaMassHypos[iHypo]) {
                 keepEvent[kBeauty4P] = true;
                 if (applyOptimisation) {
-                  optimisationTreeBeauty(collision.globalIndex(), charmParticleID[iHypo], pt3Prong, scoresToFill[iHypo][0], scoresToFill[iHypo][1], scoresToFill[iHypo][2], track.dcaXY());
+                  optimisationTreeBeauty(collision.globalIndex(), charmParticleID[iHypo], pt3Prong, scoresToFill[iHypo][0], scoresToFill[iHypo][1], scoresToFill[iHypo][2], track.dcaXY);
                 }
                 if (activateQA) {
                   auto pVecBeauty4Prong = RecoDecay::pVec(pVec3Prong, pVecFourth);
@@ -967,12 +1021,12 @@ struct HfFilter { // Main struct for HF triggers
         } // end beauty selection
 
         // 3-prong femto
-        if (isSelectedProton4Femto(track)) {
-          for (int iHypo{0}; iHypo < kNCharmParticles - 1 && !keepEvent[kFemto3P]; ++iHypo) {
+        if (track.isProtonFemto) {
+          for (int iHypo{0}; iHypo < kNCharmParticles - 1 && lazyTriggers.isNeeded(keepEvent, kFemto3P); ++iHypo) {
             if (isCharmTagged[iHypo]) {
-              float relativeMomentum = computeRelativeMomentum(track, pVec3Prong, massCharmHypos[iHypo]);
+              float relativeMomentum = computeRelativeMomentum(track.pVec, pVec3Prong, massCharmHypos[iHypo]);
               if (applyOptimisation) {
-                optimisationTreeFemto(collision.globalIndex(), charmParticleID[iHypo], pt3Prong, scoresToFill[iHypo][0], scoresToFill[iHypo][1], scoresToFill[iHypo][2], relativeMomentum, track.tpcNSigmaPr(), track.tofNSigmaPr());
+                optimisationTreeFemto(collision.globalIndex(), charmParticleID[iHypo], pt3Prong, scoresToFill[iHypo][0], scoresToFill[iHypo][1], scoresToFill[iHypo][2], relativeMomentum, track.tpcNSigmaPr, track.tofNSigmaPr);
               }
               if (relativeMomentum < femtoMaxRelativeMomentum) {
                 keepEvent[kFemto3P] = true;
@@ -24,10 +24,13 @@
 #include "Framework/DataTypes.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Common/Core/RecoDecay.h"
+#include "Common/Core/ONNXSessionRegistry.h"
 
 #include <vector>
 #include <array>
 #include <string>
+#include <map>
+#include <memory>
 #include <cmath>
 
 #include "Math/Vector3D.h"
@@ -110,15 +113,13 @@ static const float massLb = RecoDecay::getMassPDG(5122);
 static const float massXib = RecoDecay::getMassPDG(5232);
 
 /// Computation of the relative momentum between particle pairs
-/// \param track is a track
-/// \param ProtonMass is the mass of a proton
+/// \param pVecTrack is the three momentum of the proton track
 /// \param CharmCandMomentum is the three momentum of a charm candidate
 /// \param CharmMass is the mass of the charm hadron
 /// \return relative momentum of pair
-template <typename T>
-float computeRelativeMomentum(const T& track, const std::array<float, 3>& CharmCandMomentum, const float& CharmMass)
+inline float computeRelativeMomentum(const std::array<float, 3>& pVecTrack, const std::array<float, 3>& CharmCandMomentum, const float& CharmMass)
 {
-  ROOT::Math::PxPyPzMVector part1(track.px(), track.py(), track.pz(), massProton);
+  ROOT::Math::PxPyPzMVector part1(pVecTrack[0], pVecTrack[1], pVecTrack[2], massProton);
   ROOT::Math::PxPyPzMVector part2(CharmCandMomentum[0], CharmCandMomentum[1], CharmCandMomentum[2], CharmMass);
 
   ROOT::Math::PxPyPzMVector trackSum = part1 + part2;
@@ -129,6 +130,17 @@ float computeRelativeMomentum(const T& track, const std::array<float, 3>& CharmC
 
   float kStar = 0.5 * trackRelK.P();
   return kStar;
+}
+
+/// Computation of the relative momentum between particle pairs
+/// \param track is a track
+/// \param CharmCandMomentum is the three momentum of a charm candidate
+/// \param CharmMass is the mass of the charm hadron
+/// \return relative momentum of pair
+template <typename T>
+float computeRelativeMomentum(const T& track, const std::array<float, 3>& CharmCandMomentum, const float& CharmMass)
+{
+  return computeRelativeMomentum(std::array{track.px(), track.py(), track.pz()}, CharmCandMomentum, CharmMass);
 } // float computeRelativeMomentum(const T& track, const std::array<float, 3>& CharmCandMomentum, const float& CharmMass)
 
 /// Computation of the number of candidates in an event that do not share daughter tracks
@@ -177,42 +189,44 @@ int computeNumberOfCandidates(std::vector<std::vector<T>> indices)
 /// Iinitialisation of ONNX session
 /// \param onnxFile is the onnx file name
 /// \param partName is the particle name
-/// \param env is the ONNX environment
-/// \param sessionOpt is the ONNX session options
+/// \param sessionSettings are the ONNX session settings (threads, graph optimisation, memory pattern)
 /// \param inputShapes is the input shape
 /// \param dataType is the data type (1=float, 11=double)
 /// \param loadModelsFromCCDB is the flag to decide whether the ONNX file is read from CCDB or not
 /// \param ccdbApi is the CCDB API
 /// \param mlModelPathCCDB is the model path in CCDB
 /// \param timestampCCDB is the CCDB timestamp
-/// \return the pointer to the ONNX Ort::Experimental::Session
-Ort::Experimental::Session* InitONNXSession(std::string& onnxFile, std::string partName, Ort::Env& env, Ort::SessionOptions& sessionOpt, std::vector<std::vector<int64_t>>& inputShapes, int& dataType, bool loadModelsFromCCDB, o2::ccdb::CcdbApi& ccdbApi, std::string mlModelPathCCDB, long timestampCCDB)
+/// \return the ONNX Ort::Experimental::Session, shared with the other users of the same model
+std::shared_ptr<Ort::Experimental::Session> InitONNXSession(std::string& onnxFile, std::string partName, o2::analysis::ONNXSessionSettings const& sessionSettings, std::vector<std::vector<int64_t>>& inputShapes, int& dataType, bool loadModelsFromCCDB, o2::ccdb::CcdbApi& ccdbApi, std::string mlModelPathCCDB, long timestampCCDB)
 {
-  // hard coded, we do not let the user change this
-  sessionOpt.SetIntraOpNumThreads(1);
-  sessionOpt.SetInterOpNumThreads(1);
-  Ort::Experimental::Session* session = nullptr;
-
-  std::map<std::string, std::string> metadata;
-  bool retrieveSuccess = true;
-  if (loadModelsFromCCDB && timestampCCDB > 0) {
-    retrieveSuccess = ccdbApi.retrieveBlob(mlModelPathCCDB + partName, ".", metadata, timestampCCDB, false, onnxFile);
-  }
-  if (retrieveSuccess) {
-    session = new Ort::Experimental::Session{env, onnxFile, sessionOpt};
-    inputShapes = session->GetInputShapes();
-    if (inputShapes[0][0] < 0) {
-      LOGF(warning, Form("Model for %s with negative input shape likely because converted with hummingbird, setting it to 1.", partName.data()));
-      inputShapes[0][0] = 1;
+  auto& sessionRegistry = o2::analysis::ONNXSessionRegistry::instance();
+  bool fromCCDB = loadModelsFromCCDB && timestampCCDB > 0;
+  auto sessionKey = fromCCDB ? o2::analysis::ONNXSessionRegistry::makeKey(mlModelPathCCDB + partName, timestampCCDB) : o2::analysis::ONNXSessionRegistry::makeKey(onnxFile);
+
+  // the model is downloaded only if it was not already loaded by another task of this process
+  auto session = sessionRegistry.find(sessionKey);
+  if (!session) {
+    std::map<std::string, std::string> metadata;
+    bool retrieveSuccess = true;
+    if (fromCCDB) {
+      retrieveSuccess = ccdbApi.retrieveBlob(mlModelPathCCDB + partName, ".", metadata, timestampCCDB, false, onnxFile);
+    }
+    if (!retrieveSuccess) {
+      LOG(fatal) << "Error encountered while fetching/loading the ML model from CCDB! Maybe the ML model doesn't exist yet for this runnumber/timestamp?";
     }
+    session = sessionRegistry.getSession(sessionKey, onnxFile, sessionSettings);
+  }
 
-    Ort::TypeInfo typeInfo = session->GetInputTypeInfo(0);
-    auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
-    dataType = tensorInfo.GetElementType();
-  } else {
-    LOG(fatal) << "Error encountered while fetching/loading the ML model from CCDB! Maybe the ML model doesn't exist yet for this runnumber/timestamp?";
+  inputShapes = session->GetInputShapes();
+  if (inputShapes[0][0] < 0) {
+    LOGF(warning, Form("Model for %s with negative input shape likely because converted with hummingbird, setting it to 1.", partName.data()));
+    inputShapes[0][0] = 1;
   }
 
+  Ort::TypeInfo typeInfo = session->GetInputTypeInfo(0);
+  auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
+  dataType = tensorInfo.GetElementType();
+
   return session;
 };
 
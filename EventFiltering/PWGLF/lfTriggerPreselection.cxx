@@ -0,0 +1,305 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+/// \brief Common preselection of the tracks and of the cascades for the LF triggers
+///
+/// The PID and topological selections of the nuclei and strangeness filters are evaluated once per track and per
+/// cascade and stored as bit masks in the LFTrackPreSels and LFCascPreSels tables, joinable with the Tracks and the
+/// CascDataExt tables. The filters only combine the bits with their event selection and trigger definitions.
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ASoAHelpers.h"
+#include "Common/Core/RecoDecay.h"
+#include "Common/DataModel/PIDResponse.h"
+#include "PWGLF/DataModel/LFStrangenessTables.h"
+
+#include "../filterTables.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+using namespace o2::aod::lftrigger;
+
+namespace
+{
+float rapidity(float pt, float eta, float m)
+{
+  return std::asinh(pt / std::hypot(m, pt) * std::sinh(eta));
+}
+
+static constexpr int nNuclei{4};
+static constexpr int nCutsPID{5};
+static constexpr std::array<float, nNuclei> masses{
+  constants::physics::MassDeuteron, constants::physics::MassTriton,
+  constants::physics::MassHelium3, constants::physics::MassAlpha};
+static constexpr std::array<int, nNuclei> charges{1, 1, 2, 2};
+static const std::vector<std::string> nucleiNames{"H2", "H3", "He3", "He4"};
+static const std::vector<std::string> cutsNames{
+  "TPCnSigmaMin", "TPCnSigmaMax", "TOFnSigmaMin", "TOFnSigmaMax", "TOFpidStartPt"};
+static constexpr float cutsPID[nNuclei][nCutsPID]{
+  {-3.f, +3.f, -4.f, +4.f, 1.0f},    /*H2*/
+  {-3.f, +3.f, -4.f, +4.f, 1.6f},    /*H3*/
+  {-5.f, +5.f, -4.f, +4.f, 14000.f}, /*He3*/
+  {-5.f, +5.f, -4.f, +4.f, 14000.f}  /*He4*/
+};
+} // namespace
+
+struct lfTriggerPreselection {
+
+  Produces<aod::LFTrackPreSels> trackPreSels;
+  Produces<aod::LFCascPreSels> cascPreSels;
+
+  // Selection criteria for nuclei
+  Configurable<float> yMin{"yMin", -0.8, "Maximum rapidity"};
+  Configurable<float> yMax{"yMax", 0.8, "Minimum rapidity"};
+  Configurable<float> yBeam{"yBeam", 0., "Beam rapidity"};
+  Configurable<LabeledArray<float>> cfgCutsPID{"nucleiCutsPID", {cutsPID[0], nNuclei, nCutsPID, nucleiNames, cutsNames}, "Nuclei PID selections"};
+
+  // Selection criteria for cascades
+  Configurable<float> v0cospa{"v0cospa", 0.97, "V0 CosPA"};
+  Configurable<float> casccospa{"casccospa", 0.995, "V0 CosPA"};
+  Configurable<float> dcav0dau{"dcav0dau", 1.5, "DCA V0 Daughters"};
+  Configurable<float> dcacascdau{"dcacascdau", 0.8, "DCA Casc Daughters"};
+  Configurable<float> dcamesontopv{"dcamesontopv", 0.04, "DCA Meson To PV"};
+  Configurable<float> dcabaryontopv{"dcabaryontopv", 0.03, "DCA Baryon To PV"};
+  Configurable<float> dcabachtopv{"dcabachtopv", 0.04, "DCA Bach To PV"};
+  Configurable<float> dcav0topv{"dcav0topv", 0.06, "DCA V0 To PV"};
+  Configurable<float> v0radius{"v0radius", 1.2, "V0 Radius"};
+  Configurable<float> v0radiusupperlimit{"v0radiusupperlimit", 1000, "V0 Radius Upper Limit"};
+  Configurable<float> cascradius{"cascradius", 0.6, "cascradius"};
+  Configurable<float> cascradiusupperlimit{"cascradiusupperlimit", 1000, "Casc Radius Upper Limit"};
+  Configurable<float> rapidityCasc{"rapidity", 2, "rapidity"};
+  Configurable<float> eta{"eta", 2, "Eta"};
+  Configurable<float> etadau{"etadau", 0.8, "EtaDaughters"};
+  Configurable<float> masslambdalimit{"masslambdalimit", 0.01, "masslambdalimit"};
+  Configurable<float> omegarej{"omegarej", 0.005, "omegarej"};
+  Configurable<float> xirej{"xirej", 0.008, "xirej"};
+  Configurable<float> ximasswindow{"ximasswindow", 0.075, "Xi Mass Window"};
+  Configurable<float> omegamasswindow{"omegamasswindow", 0.075, "Omega Mass Window"};
+  Configurable<int> properlifetimefactor{"properlifetimefactor", 5, "Proper Lifetime cut"};
+  Configurable<float> nsigmatpc{"nsigmatpc", 6, "N Sigmas TPC"};
+  Configurable<float> nsigmatof{"nsigmatof", 5, "N Sigmas TOF (OOB condition)"};
+
+  // constants
+  static constexpr float ctauxi{4.91};     // from PDG
+  static constexpr float ctauomega{2.461}; // from PDG
+  double massXi{0.};
+  double massOmega{0.};
+
+  void init(o2::framework::InitContext&)
+  {
+    massXi = RecoDecay::getMassPDG(3312);
+    massOmega = RecoDecay::getMassPDG(3334);
+  }
+
+  using TrackCandidates = soa::Join<aod::Tracks, aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl, aod::pidTOFFullDe, aod::pidTOFFullTr, aod::pidTOFFullHe, aod::pidTOFFullAl>;
+  using DaughterTracks = soa::Join<aod::Tracks, aod::pidTOFPi, aod::pidTPCPi, aod::pidTOFPr, aod::pidTPCPr, aod::pidTPCKa, aod::pidTOFKa>;
+
+  void processTracks(TrackCandidates const& tracks)
+  {
+    for (auto& track : tracks) {
+      const float nSigmaTPC[nNuclei]{
+        track.tpcNSigmaDe(), track.tpcNSigmaTr(), track.tpcNSigmaHe(), track.tpcNSigmaAl()};
+      const float nSigmaTOF[nNuclei]{
+        track.tofNSigmaDe(), track.tofNSigmaTr(), track.tofNSigmaHe(), track.tofNSigmaAl()};
+
+      uint8_t mask{0};
+      for (int iN{0}; iN < nNuclei; ++iN) {
+        float y{rapidity(track.pt() * charges[iN], track.eta(), masses[iN])};
+        if (y < yMin + yBeam || y > yMax + yBeam) {
+          continue;
+        }
+        if (nSigmaTPC[iN] < cfgCutsPID->get(iN, 0u) || nSigmaTPC[iN] > cfgCutsPID->get(iN, 1u)) {
+          continue;
+        }
+        if (track.pt() > cfgCutsPID->get(iN, 4u) && (nSigmaTOF[iN] < cfgCutsPID->get(iN, 2u) || nSigmaTOF[iN] > cfgCutsPID->get(iN, 3u))) {
+          continue;
+        }
+        mask |= BIT(kH2 + iN);
+      }
+      trackPreSels(mask);
+    }
+  }
+  PROCESS_SWITCH(lfTriggerPreselection, processTracks, "Nuclei preselection of the tracks", true);
+
+  /// Selections of a cascade, in the order of the cut flow of the strangeness filter
+  /// \return mask with the bits of the selection steps passed and of the Xi, Xi-YN and Omega candidates
+  template <bool isRun3, typename TCascade, typename TCollision>
+  uint32_t cascadeMask(TCascade const& casc, TCollision const& collision)
+  {
+    uint32_t mask{0};
+    auto v0index = casc.template v0_as<o2::aod::V0sLinked>();
+    if (!(v0index.has_v0Data())) {
+      return mask; // cascades for which V0 doesn't exist
+    }
+    mask |= BIT(kCascHasV0);
+    auto v0 = v0index.v0Data(); // de-reference index to correct v0data in case it exists
+    auto bachelor = casc.template bachelor_as<DaughterTracks>();
+    auto posdau = v0.template posTrack_as<DaughterTracks>();
+    auto negdau = v0.template negTrack_as<DaughterTracks>();
+
+    // the V0 of a positive cascade is an anti-Lambda: the meson is the positive daughter
+    const bool isPositive = casc.sign() == 1;
+    const auto& meson = isPositive ? posdau : negdau;
+    const auto& baryon = isPositive ? negdau : posdau;
+
+    if (std::abs(isPositive ? casc.dcapostopv() : casc.dcanegtopv()) < dcamesontopv) {
+      return mask;
+    }
+    mask |= BIT(kCascDCAMeson);
+    if (std::abs(isPositive ? casc.dcanegtopv() : casc.dcapostopv()) < dcabaryontopv) {
+      return mask;
+    }
+    mask |= BIT(kCascDCABaryon);
+    const bool rejectTPCMeson = std::abs(meson.tpcNSigmaPi()) > nsigmatpc;
+    const bool rejectTPCBaryon = std::abs(baryon.tpcNSigmaPr()) > nsigmatpc;
+    if (isPositive) {
+      if (rejectTPCMeson) {
+        return mask;
+      }
+      mask |= BIT(kCascTPCMeson);
+      if (rejectTPCBaryon) {
+        return mask;
+      }
+      mask |= BIT(kCascTPCBaryon);
+    } else {
+      if (rejectTPCBaryon) {
+        return mask;
+      }
+      mask |= BIT(kCascTPCBaryon);
+      if (rejectTPCMeson) {
+        return mask;
+      }
+      mask |= BIT(kCascTPCMeson);
+    }
+    if ((std::abs(meson.tofNSigmaPi()) > nsigmatof) &&
+        (std::abs(baryon.tofNSigmaPr()) > nsigmatof) &&
+        (std::abs(bachelor.tofNSigmaPi()) > nsigmatof) &&
+        (!(isRun3 && isPositive) || std::abs(bachelor.tofNSigmaKa()) > nsigmatof)) {
+      return mask;
+    }
+    mask |= BIT(kCascTOFDaughters);
+    if (std::abs(posdau.eta()) > etadau || std::abs(negdau.eta()) > etadau || std::abs(bachelor.eta()) > etadau) {
+      return mask;
+    }
+    mask |= BIT(kCascEtaDaughters);
+    if (std::abs(casc.dcabachtopv()) < dcabachtopv) {
+      return mask;
+    }
+    mask |= BIT(kCascDCABachToPV);
+    if (casc.v0radius() > v0radiusupperlimit || casc.v0radius() < v0radius) {
+      return mask;
+    }
+    mask |= BIT(kCascV0Radius);
+    if (casc.cascradius() > cascradiusupperlimit || casc.cascradius() < cascradius) {
+      return mask;
+    }
+    mask |= BIT(kCascCascRadius);
+    if (casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa) {
+      return mask;
+    }
+    mask |= BIT(kCascV0CosPA);
+    if (casc.dcaV0daughters() > dcav0dau) {
+      return mask;
+    }
+    mask |= BIT(kCascDCAV0Dau);
+    if (casc.dcacascdaughters() > dcacascdau) {
+      return mask;
+    }
+    mask |= BIT(kCascDCACascDau);
+    if (std::abs(casc.mLambda() - constants::physics::MassLambda) > masslambdalimit) {
+      return mask;
+    }
+    mask |= BIT(kCascLambdaMass);
+    if (std::abs(casc.eta()) > eta) {
+      return mask;
+    }
+    mask |= BIT(kCascEta);
+
+    // proper lifetime
+    const float xipos = std::hypot(casc.x() - collision.posX(), casc.y() - collision.posY(), casc.z() - collision.posZ());
+    const float xiptotmom = std::hypot(casc.px(), casc.py(), casc.pz());
+    const float xiproperlifetime = massXi * xipos / (xiptotmom + 1e-13);
+    const float omegaproperlifetime = massOmega * xipos / (xiptotmom + 1e-13);
+
+    const float cascCosPA = casc.casccosPA(collision.posX(), collision.posY(), collision.posZ());
+    const float dcaV0ToPV = casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ());
+    const bool passCascCosPA = cascCosPA > casccospa;
+    const bool passDCAV0ToPV = dcaV0ToPV > dcav0topv;
+    const bool passXiLifetime = xiproperlifetime < properlifetimefactor * ctauxi;
+    const bool passXiRapidity = std::abs(casc.yXi()) < rapidityCasc;
+    if (passCascCosPA) {
+      mask |= BIT(kCascCascCosPA);
+      if (passDCAV0ToPV) {
+        mask |= BIT(kCascDCAV0ToPV);
+        if (passXiLifetime) {
+          mask |= BIT(kCascXiLifetime);
+          if (passXiRapidity) {
+            mask |= BIT(kCascXiRapidity);
+          }
+        }
+      }
+    }
+
+    const bool isXiMass = (std::abs(casc.mXi() - massXi) < ximasswindow) && (std::abs(casc.mOmega() - massOmega) > omegarej);
+    const bool bachelorPi = std::abs(bachelor.tpcNSigmaPi()) < nsigmatpc;
+    if (bachelorPi && passCascCosPA && passDCAV0ToPV && isXiMass && passXiLifetime && passXiRapidity) {
+      mask |= BIT(kCascXi);
+    }
+    if (bachelorPi && (casc.cascradius() > 24.39) && isXiMass && passXiLifetime && passXiRapidity) {
+      mask |= BIT(kCascXiYN);
+    }
+    // the Run 3 selection of the Omega bachelor is the one of the pions, as in the original filter
+    const bool bachelorOmega = std::abs(isRun3 ? bachelor.tpcNSigmaPi() : bachelor.tpcNSigmaKa()) < nsigmatpc;
+    if (bachelorOmega && passCascCosPA && passDCAV0ToPV &&
+        (std::abs(casc.mOmega() - massOmega) < omegamasswindow) &&
+        (std::abs(casc.mXi() - massXi) > xirej) &&
+        (omegaproperlifetime < properlifetimefactor * ctauomega) &&
+        (std::abs(casc.yOmega()) < rapidityCasc)) {
+      mask |= BIT(kCascOmega);
+    }
+    return mask;
+  }
+
+  template <bool isRun3>
+  void fillCascades(aod::CascDataExt const& cascades)
+  {
+    for (auto& casc : cascades) {
+      cascPreSels(cascadeMask<isRun3>(casc, casc.collision()));
+    }
+  }
+
+  void processCascadesRun2(aod::Collisions const&, aod::CascDataExt const& cascades, aod::V0sLinked const&, aod::V0Datas const&, DaughterTracks const&)
+  {
+    fillCascades<false>(cascades);
+  }
+  PROCESS_SWITCH(lfTriggerPreselection, processCascadesRun2, "Cascade preselection with the Run 2 selections", false);
+
+  void processCascadesRun3(aod::Collisions const&, aod::CascDataExt const& cascades, aod::V0sLinked const&, aod::V0Datas const&, DaughterTracks const&)
+  {
+    fillCascades<true>(cascades);
+  }
+  PROCESS_SWITCH(lfTriggerPreselection, processCascadesRun3, "Cascade preselection with the Run 3 selections", true);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<lfTriggerPreselection>(cfg, TaskName{"lf-trigger-preselection"})};
+}
@@ -32,41 +32,18 @@ using namespace o2::framework::expressions;
 
 namespace
 {
-float rapidity(float pt, float eta, float m)
-{
-  return std::asinh(pt / std::hypot(m, pt) * std::sinh(eta));
-}
-
 static constexpr int nNuclei{4};
-static constexpr int nCutsPID{5};
-static constexpr std::array<float, nNuclei> masses{
-  constants::physics::MassDeuteron, constants::physics::MassTriton,
-  constants::physics::MassHelium3, constants::physics::MassAlpha};
-static constexpr std::array<int, nNuclei> charges{1, 1, 2, 2};
 static const std::vector<std::string> nucleiNames{"H2", "H3", "He3", "He4"};
-static const std::vector<std::string> cutsNames{
-  "TPCnSigmaMin", "TPCnSigmaMax", "TOFnSigmaMin", "TOFnSigmaMax", "TOFpidStartPt"};
-static constexpr float cutsPID[nNuclei][nCutsPID]{
-  {-3.f, +3.f, -4.f, +4.f, 1.0f},    /*H2*/
-  {-3.f, +3.f, -4.f, +4.f, 1.6f},    /*H3*/
-  {-5.f, +5.f, -4.f, +4.f, 14000.f}, /*He3*/
-  {-5.f, +5.f, -4.f, +4.f, 14000.f}  /*He4*/
-};
 } // namespace
 
 struct nucleiFilter {
 
   Produces<aod::NucleiFilters> tags;
 
-  Configurable<float> yMin{"yMin", -0.8, "Maximum rapidity"};
-  Configurable<float> yMax{"yMax", 0.8, "Minimum rapidity"};
-  Configurable<float> yBeam{"yBeam", 0., "Beam rapidity"};
-
+  // the rapidity and PID selections of the nuclei are in the lf-trigger-preselection task
   Configurable<float> cfgCutVertex{"cfgCutVertex", 10.0f, "Accepted z-vertex range"};
   Configurable<float> cfgCutEta{"cfgCutEta", 0.8f, "Eta range for tracks"};
 
-  Configurable<LabeledArray<float>> cfgCutsPID{"nucleiCutsPID", {cutsPID[0], nNuclei, nCutsPID, nucleiNames, cutsNames}, "Nuclei PID selections"};
-
   HistogramRegistry spectra{"spectra", {}, OutputObjHandlingPolicy::AnalysisObject, true, true};
 
   void init(o2::framework::InitContext&)
@@ -89,7 +66,7 @@ struct nucleiFilter {
 
   Filter trackFilter = (nabs(aod::track::eta) < cfgCutEta) && (requireGlobalTrackInFilter());
 
-  using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection, aod::TracksDCA, aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl, aod::pidTOFFullDe, aod::pidTOFFullTr, aod::pidTOFFullHe, aod::pidTOFFullAl>>;
+  using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection, aod::pidTPCFullHe, aod::LFTrackPreSels>>;
   void process(aod::Collisions::iterator const& collision, TrackCandidates const& tracks)
   {
     // collision process loop
@@ -100,23 +77,10 @@ struct nucleiFilter {
 
     for (auto& track : tracks) { // start loop over tracks
 
-      const float nSigmaTPC[nNuclei]{
-        track.tpcNSigmaDe(), track.tpcNSigmaTr(), track.tpcNSigmaHe(), track.tpcNSigmaAl()};
-      const float nSigmaTOF[nNuclei]{
-        track.tofNSigmaDe(), track.tofNSigmaTr(), track.tofNSigmaHe(), track.tofNSigmaAl()};
-
       for (int iN{0}; iN < nNuclei; ++iN) {
-        float y{rapidity(track.pt() * charges[iN], track.eta(), masses[iN])};
-        if (y < yMin + yBeam || y > yMax + yBeam) {
-          continue;
-        }
-        if (nSigmaTPC[iN] < cfgCutsPID->get(iN, 0u) || nSigmaTPC[iN] > cfgCutsPID->get(iN, 1u)) {
-          continue;
-        }
-        if (track.pt() > cfgCutsPID->get(iN, 4u) && (nSigmaTOF[iN] < cfgCutsPID->get(iN, 2u) || nSigmaTOF[iN] > cfgCutsPID->get(iN, 3u))) {
-          continue;
+        if (track.trackMask() & BIT(aod::lftrigger::kH2 + iN)) {
+          keepEvent[iN] = true;
         }
-        keepEvent[iN] = true;
       }
 
       //
@@ -45,6 +45,7 @@
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
+using namespace o2::aod::lftrigger;
 using std::array;
 
 struct strangenessFilter {
@@ -64,30 +65,8 @@ struct strangenessFilter {
 
   // Selection criteria for cascades
   Configurable<float> cutzvertex{"cutzvertex", 10.0f, "Accepted z-vertex range"};
-  Configurable<float> v0cospa{"v0cospa", 0.97, "V0 CosPA"}; // is it with respect to Xi decay vertex?
-  Configurable<float> casccospa{"casccospa", 0.995, "V0 CosPA"};
-  Configurable<float> dcav0dau{"dcav0dau", 1.5, "DCA V0 Daughters"};       // is it in sigmas?
-  Configurable<float> dcacascdau{"dcacascdau", 0.8, "DCA Casc Daughters"}; // is it in sigmas?
-  Configurable<float> dcamesontopv{"dcamesontopv", 0.04, "DCA Meson To PV"};
-  Configurable<float> dcabaryontopv{"dcabaryontopv", 0.03, "DCA Baryon To PV"};
-  Configurable<float> dcabachtopv{"dcabachtopv", 0.04, "DCA Bach To PV"};
-  Configurable<float> dcav0topv{"dcav0topv", 0.06, "DCA V0 To PV"};
-  Configurable<float> v0radius{"v0radius", 1.2, "V0 Radius"};
-  Configurable<float> v0radiusupperlimit{"v0radiusupperlimit", 1000, "V0 Radius Upper Limit"};
-  Configurable<float> cascradius{"cascradius", 0.6, "cascradius"};
-  Configurable<float> cascradiusupperlimit{"cascradiusupperlimit", 1000, "Casc Radius Upper Limit"};
-  Configurable<float> rapidity{"rapidity", 2, "rapidity"};
-  Configurable<float> eta{"eta", 2, "Eta"};
+  // the topological and PID selections of the cascades are in the lf-trigger-preselection task
   Configurable<float> minpt{"minpt", 0.5, "minpt"};
-  Configurable<float> etadau{"etadau", 0.8, "EtaDaughters"};
-  Configurable<float> masslambdalimit{"masslambdalimit", 0.01, "masslambdalimit"}; // 0.006 Chiara
-  Configurable<float> omegarej{"omegarej", 0.005, "omegarej"};
-  Configurable<float> xirej{"xirej", 0.008, "xirej"}; // merge the two rejection variables into one?
-  Configurable<float> ximasswindow{"ximasswindow", 0.075, "Xi Mass Window"};
-  Configurable<float> omegamasswindow{"omegamasswindow", 0.075, "Omega Mass Window"}; // merge the two windows variables into one?
-  Configurable<int> properlifetimefactor{"properlifetimefactor", 5, "Proper Lifetime cut"};
-  Configurable<float> nsigmatpc{"nsigmatpc", 6, "N Sigmas TPC"};
-  Configurable<float> nsigmatof{"nsigmatof", 5, "N Sigmas TOF (OOB condition)"};
   Configurable<bool> kint7{"kint7", 0, "Apply kINT7 event selection"};
   Configurable<bool> sel7{"sel7", 0, "Apply sel7 event selection"};
   Configurable<bool> sel8{"sel8", 0, "Apply sel8 event selection"};
@@ -201,8 +180,44 @@ struct strangenessFilter {
   using CollisionCandidates = soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>::iterator;
   using CollisionCandidatesRun3 = soa::Join<aod::Collisions, aod::EvSels>::iterator;
   using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksCov, aod::TracksExtra, aod::TracksDCA, aod::TrackSelection>>;
-  using DaughterTracks = soa::Join<aod::Tracks, aod::TracksCov, aod::TracksExtra, aod::TracksDCA, aod::TrackSelection, aod::pidTOFPi, aod::pidTPCPi, aod::pidTOFPr, aod::pidTPCPr, aod::pidTPCKa, aod::pidTOFKa>;
-  using Cascades = aod::CascDataExt;
+  using DaughterTracks = soa::Join<aod::Tracks, aod::pidTOFPi, aod::pidTOFPr, aod::pidTOFKa>;
+  using Cascades = soa::Join<aod::CascDataExt, aod::LFCascPreSels>;
+
+  /// TOF n-sigma of the daughters of the cascades passing the TPC selections, before and after the TOF selection
+  template <bool isRun3, typename TCascade>
+  void fillTOFQA(TCascade const& casc, uint32_t mask)
+  {
+    if (!(mask & BIT(kCascTPCMeson)) || !(mask & BIT(kCascTPCBaryon))) {
+      return;
+    }
+    auto v0 = casc.template v0_as<o2::aod::V0sLinked>().v0Data();
+    auto bachelor = casc.template bachelor_as<DaughterTracks>();
+    auto posdau = v0.template posTrack_as<DaughterTracks>();
+    auto negdau = v0.template negTrack_as<DaughterTracks>();
+    const bool isPositive = casc.sign() == 1;
+    const auto& meson = isPositive ? posdau : negdau;
+    const auto& baryon = isPositive ? negdau : posdau;
+
+    QAHistos.fill(HIST("hTOFnsigmaPrBefSel"), baryon.tofNSigmaPr());
+    QAHistos.fill(HIST("hTOFnsigmaV0PiBefSel"), meson.tofNSigmaPi());
+    if constexpr (isRun3) {
+      QAHistos.fill(HIST("hTOFnsigmaBachPiBefSel"), bachelor.tofNSigmaPi());
+      if (isPositive) {
+        QAHistos.fill(HIST("hTOFnsigmaBachKBefSel"), bachelor.tofNSigmaKa());
+      }
+    }
+    if (!(mask & BIT(kCascTOFDaughters))) {
+      return;
+    }
+    QAHistos.fill(HIST("hTOFnsigmaPrAfterSel"), baryon.tofNSigmaPr());
+    QAHistos.fill(HIST("hTOFnsigmaV0PiAfterSel"), meson.tofNSigmaPi());
+    if constexpr (isRun3) {
+      QAHistos.fill(HIST("hTOFnsigmaBachPiAfterSel"), bachelor.tofNSigmaPi());
+      if (isPositive) {
+        QAHistos.fill(HIST("hTOFnsigmaBachKAfterSel"), bachelor.tofNSigmaKa());
+      }
+    }
+  }
 
   ////////////////////////////////////////////////////////
   ////////// Strangeness Filter - Run 2 conv /////////////
@@ -231,15 +246,7 @@ struct strangenessFilter {
     // Is event good? [0] = Omega, [1] = high-pT hadron + Xi, [2] = 2Xi, [3] = 3Xi, [4] = 4Xi, [5] single-Xi
     bool keepEvent[6]{false};
 
-    // constants
-    const float ctauxi = 4.91;     // from PDG
-    const float ctauomega = 2.461; // from PDG
-
     // variables
-    float xipos = -1.;
-    float xiproperlifetime = -1.;
-    float omegaproperlifetime = -1.;
-    float xiptotmom = -1.;
     int xicounter = 0;
     int xicounterYN = 0;
     int omegacounter = 0;
@@ -248,133 +255,24 @@ struct strangenessFilter {
 
     for (auto& casc : fullCasc) { // loop over cascades
       triggcounterForEstimates = 0;
-      auto v0index = casc.v0_as<o2::aod::V0sLinked>();
-      if (!(v0index.has_v0Data())) {
+      const uint32_t mask = casc.cascadeMask();
+      if (!(mask & BIT(kCascHasV0))) {
         continue; // skip those cascades for which V0 doesn't exist
       }
-      auto v0 = v0index.v0Data(); // de-reference index to correct v0data in case it exists
-      auto bachelor = casc.bachelor_as<DaughterTracks>();
-      auto posdau = v0.posTrack_as<DaughterTracks>();
-      auto negdau = v0.negTrack_as<DaughterTracks>();
-
-      bool isXi = false;
-      bool isXiYN = false;
-      bool isOmega = false;
 
       // QA
       QAHistos.fill(HIST("hMassXiBefSel"), casc.mXi());
       QAHistos.fill(HIST("hMassOmegaBefSel"), casc.mOmega());
+      fillTOFQA<false>(casc, mask);
 
-      // Position
-      xipos = std::hypot(casc.x() - collision.posX(), casc.y() - collision.posY(), casc.z() - collision.posZ());
-      // Total momentum
-      xiptotmom = std::hypot(casc.px(), casc.py(), casc.pz());
-      // Proper lifetime
-      xiproperlifetime = RecoDecay::getMassPDG(3312) * xipos / (xiptotmom + 1e-13);
-      omegaproperlifetime = RecoDecay::getMassPDG(3334) * xipos / (xiptotmom + 1e-13);
-
-      if (casc.sign() == 1) {
-        if (TMath::Abs(casc.dcapostopv()) < dcamesontopv) {
-          continue;
-        };
-        if (TMath::Abs(casc.dcanegtopv()) < dcabaryontopv) {
-          continue;
-        };
-        if (TMath::Abs(posdau.tpcNSigmaPi()) > nsigmatpc) {
-          continue;
-        };
-        if (TMath::Abs(negdau.tpcNSigmaPr()) > nsigmatpc) {
-          continue;
-        };
-        QAHistos.fill(HIST("hTOFnsigmaPrBefSel"), negdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiBefSel"), posdau.tofNSigmaPi());
-        if (
-          (TMath::Abs(posdau.tofNSigmaPi()) > nsigmatof) &&
-          (TMath::Abs(negdau.tofNSigmaPr()) > nsigmatof) &&
-          (TMath::Abs(bachelor.tofNSigmaPi()) > nsigmatof)) {
-          continue;
-        };
-        QAHistos.fill(HIST("hTOFnsigmaPrAfterSel"), negdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiAfterSel"), posdau.tofNSigmaPi());
-      } else {
-        if (TMath::Abs(casc.dcanegtopv()) < dcamesontopv) {
-          continue;
-        };
-        if (TMath::Abs(casc.dcapostopv()) < dcabaryontopv) {
-          continue;
-        };
-        if (TMath::Abs(posdau.tpcNSigmaPr()) > nsigmatpc) {
-          continue;
-        };
-        if (TMath::Abs(negdau.tpcNSigmaPi()) > nsigmatpc) {
-          continue;
-        };
-        QAHistos.fill(HIST("hTOFnsigmaPrBefSel"), posdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiBefSel"), negdau.tofNSigmaPi());
-        if ( // bachelor to be fixed
-          (TMath::Abs(posdau.tofNSigmaPr()) > nsigmatof) &&
-          (TMath::Abs(negdau.tofNSigmaPi()) > nsigmatof) &&
-          (TMath::Abs(bachelor.tofNSigmaPi()) > nsigmatof)) {
-          continue;
-        };
-        QAHistos.fill(HIST("hTOFnsigmaPrAfterSel"), posdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiAfterSel"), negdau.tofNSigmaPi());
-      }
-      // these selection differ for Xi and Omegas:
-      if (TMath::Abs(posdau.eta()) > etadau) {
-        continue;
-      };
-      if (TMath::Abs(negdau.eta()) > etadau) {
-        continue;
-      };
-      if (TMath::Abs(bachelor.eta()) > etadau) {
-        continue;
-      };
-      if (TMath::Abs(casc.dcabachtopv()) < dcabachtopv) {
-        continue;
-      };
-      if (casc.v0radius() > v0radiusupperlimit || casc.v0radius() < v0radius) {
-        continue;
-      };
-      if (casc.cascradius() > cascradiusupperlimit || casc.cascradius() < cascradius) {
-        continue;
-      };
-      if (casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa) {
-        continue;
-      };
-      if (casc.dcaV0daughters() > dcav0dau) {
-        continue;
-      };
-      if (casc.dcacascdaughters() > dcacascdau) {
+      // selections common to Xi and Omegas
+      if (!(mask & BIT(kCascEta))) {
         continue;
-      };
-      if (TMath::Abs(casc.mLambda() - constants::physics::MassLambda) > masslambdalimit) {
-        continue;
-      };
-      if (TMath::Abs(casc.eta()) > eta) {
-        continue;
-      };
-
-      isXi = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpc) &&
-             (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospa) &&
-             (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
-             (TMath::Abs(casc.mXi() - RecoDecay::getMassPDG(3312)) < ximasswindow) &&
-             (TMath::Abs(casc.mOmega() - RecoDecay::getMassPDG(3334)) > omegarej) &&
-             (xiproperlifetime < properlifetimefactor * ctauxi) &&
-             (TMath::Abs(casc.yXi()) < rapidity); // add PID on bachelor
-      isXiYN = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpc) &&
-               (casc.cascradius() > 24.39) &&
-               (TMath::Abs(casc.mXi() - RecoDecay::getMassPDG(3312)) < ximasswindow) &&
-               (TMath::Abs(casc.mOmega() - RecoDecay::getMassPDG(3334)) > omegarej) &&
-               (xiproperlifetime < properlifetimefactor * ctauxi) &&
-               (TMath::Abs(casc.yXi()) < rapidity); // add PID on bachelor
-      isOmega = (TMath::Abs(bachelor.tpcNSigmaKa()) < nsigmatpc) &&
-                (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospa) &&
-                (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
-                (TMath::Abs(casc.mOmega() - RecoDecay::getMassPDG(3334)) < omegamasswindow) &&
-                (TMath::Abs(casc.mXi() - RecoDecay::getMassPDG(3312)) > xirej) &&
-                (omegaproperlifetime < properlifetimefactor * ctauomega) &&
-                (TMath::Abs(casc.yOmega()) < rapidity); // add PID on bachelor
+      }
+
+      const bool isXi = mask & BIT(kCascXi);
+      const bool isXiYN = mask & BIT(kCascXiYN);
+      const bool isOmega = mask & BIT(kCascOmega);
 
       if (isXi) {
         QAHistos.fill(HIST("hMassXiAfterSel"), casc.mXi());
@@ -509,15 +407,7 @@ struct strangenessFilter {
     // Is event good? [0] = Omega, [1] = high-pT hadron + Xi, [2] = 2Xi, [3] = 3Xi, [4] = 4Xi, [5] single-Xi
     bool keepEvent[6]{false};
 
-    // constants
-    const float ctauxi = 4.91;     // from PDG
-    const float ctauomega = 2.461; // from PDG
-
     // variables
-    float xipos = -1.;
-    float xiproperlifetime = -1.;
-    float omegaproperlifetime = -1.;
-    float xiptotmom = -1.;
     int xicounter = 0;
     int xicounterYN = 0;
     int omegacounter = 0;
@@ -528,176 +418,33 @@ struct strangenessFilter {
       triggcounterForEstimates = 0;
       hCandidate->Fill(0.5);
 
-      auto v0index = casc.v0_as<o2::aod::V0sLinked>();
-      if (!(v0index.has_v0Data())) {
+      const uint32_t mask = casc.cascadeMask();
+      if (!(mask & BIT(kCascHasV0))) {
         continue; // skip those cascades for which V0 doesn't exist
       }
-      hCandidate->Fill(1.5);
-      auto v0 = v0index.v0Data(); // de-reference index to correct v0data in case it exists
-      auto bachelor = casc.bachelor_as<DaughterTracks>();
-      auto posdau = v0.posTrack_as<DaughterTracks>();
-      auto negdau = v0.negTrack_as<DaughterTracks>();
-
-      bool isXi = false;
-      bool isXiYN = false;
-      bool isOmega = false;
+      for (int iStep{kCascHasV0}; iStep <= kCascXiRapidity; ++iStep) {
+        if (mask & BIT(iStep)) {
+          hCandidate->Fill(iStep + 0.5);
+        }
+      }
+      // the bachelor TPC PID is part of the Xi and Omega definitions, the bin follows the TOF one
+      if (mask & BIT(kCascTOFDaughters)) {
+        hCandidate->Fill(7.5);
+      }
 
       // QA
       QAHistos.fill(HIST("hMassXiBefSel"), casc.mXi());
       QAHistos.fill(HIST("hMassOmegaBefSel"), casc.mOmega());
+      fillTOFQA<true>(casc, mask);
 
-      // Position
-      xipos = std::hypot(casc.x() - collision.posX(), casc.y() - collision.posY(), casc.z() - collision.posZ());
-      // Total momentum
-      xiptotmom = std::hypot(casc.px(), casc.py(), casc.pz());
-      // Proper lifetime
-      xiproperlifetime = RecoDecay::getMassPDG(3312) * xipos / (xiptotmom + 1e-13);
-      omegaproperlifetime = RecoDecay::getMassPDG(3334) * xipos / (xiptotmom + 1e-13);
-
-      if (casc.sign() == 1) {
-        if (TMath::Abs(casc.dcapostopv()) < dcamesontopv) {
-          continue;
-        };
-        hCandidate->Fill(2.5);
-        if (TMath::Abs(casc.dcanegtopv()) < dcabaryontopv) {
-          continue;
-        };
-        hCandidate->Fill(3.5);
-        if (TMath::Abs(posdau.tpcNSigmaPi()) > nsigmatpc) {
-          continue;
-        };
-        hCandidate->Fill(4.5);
-        if (TMath::Abs(negdau.tpcNSigmaPr()) > nsigmatpc) {
-          continue;
-        };
-        hCandidate->Fill(5.5);
-        QAHistos.fill(HIST("hTOFnsigmaPrBefSel"), negdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiBefSel"), posdau.tofNSigmaPi());
-        QAHistos.fill(HIST("hTOFnsigmaBachPiBefSel"), bachelor.tofNSigmaPi());
-        QAHistos.fill(HIST("hTOFnsigmaBachKBefSel"), bachelor.tofNSigmaKa());
-        if (
-          (TMath::Abs(posdau.tofNSigmaPi()) > nsigmatof) &&
-          (TMath::Abs(negdau.tofNSigmaPr()) > nsigmatof) &&
-          (TMath::Abs(bachelor.tofNSigmaKa()) > nsigmatof) &&
-          (TMath::Abs(bachelor.tofNSigmaPi()) > nsigmatof)) {
-          continue;
-        };
-        hCandidate->Fill(6.5);
-        QAHistos.fill(HIST("hTOFnsigmaPrAfterSel"), negdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiAfterSel"), posdau.tofNSigmaPi());
-        QAHistos.fill(HIST("hTOFnsigmaBachPiAfterSel"), bachelor.tofNSigmaPi());
-        QAHistos.fill(HIST("hTOFnsigmaBachKAfterSel"), bachelor.tofNSigmaKa());
-      } else {
-        if (TMath::Abs(casc.dcanegtopv()) < dcamesontopv) {
-          continue;
-        };
-        hCandidate->Fill(2.5);
-        if (TMath::Abs(casc.dcapostopv()) < dcabaryontopv) {
-          continue;
-        };
-        hCandidate->Fill(3.5);
-        if (TMath::Abs(posdau.tpcNSigmaPr()) > nsigmatpc) {
-          continue;
-        };
-        hCandidate->Fill(5.5);
-        if (TMath::Abs(negdau.tpcNSigmaPi()) > nsigmatpc) {
-          continue;
-        };
-        hCandidate->Fill(4.5);
-        QAHistos.fill(HIST("hTOFnsigmaPrBefSel"), posdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiBefSel"), negdau.tofNSigmaPi());
-        QAHistos.fill(HIST("hTOFnsigmaBachPiBefSel"), bachelor.tofNSigmaPi());
-        if (
-          (TMath::Abs(posdau.tofNSigmaPr()) > nsigmatof) &&
-          (TMath::Abs(negdau.tofNSigmaPi()) > nsigmatof) &&
-          (TMath::Abs(bachelor.tofNSigmaPi()) > nsigmatof)) {
-          continue;
-        };
-        hCandidate->Fill(6.5);
-        QAHistos.fill(HIST("hTOFnsigmaPrAfterSel"), posdau.tofNSigmaPr());
-        QAHistos.fill(HIST("hTOFnsigmaV0PiAfterSel"), negdau.tofNSigmaPi());
-        QAHistos.fill(HIST("hTOFnsigmaBachPiAfterSel"), bachelor.tofNSigmaPi());
-      }
-      // this selection differes for Xi and Omegas:
-
-      hCandidate->Fill(7.5);
-      if (TMath::Abs(posdau.eta()) > etadau) {
-        continue;
-      };
-      if (TMath::Abs(negdau.eta()) > etadau) {
-        continue;
-      };
-      if (TMath::Abs(bachelor.eta()) > etadau) {
-        continue;
-      };
-      hCandidate->Fill(8.5);
-      if (TMath::Abs(casc.dcabachtopv()) < dcabachtopv) {
-        continue;
-      };
-      hCandidate->Fill(9.5);
-      if (casc.v0radius() > v0radiusupperlimit || casc.v0radius() < v0radius) {
-        continue;
-      };
-      hCandidate->Fill(10.5);
-      if (casc.cascradius() > cascradiusupperlimit || casc.cascradius() < cascradius) {
+      // selections common to Xi and Omegas
+      if (!(mask & BIT(kCascEta))) {
         continue;
-      }; //
-      hCandidate->Fill(11.5);
-      if (casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa) {
-        continue;
-      };
-      hCandidate->Fill(12.5);
-      if (casc.dcaV0daughters() > dcav0dau) {
-        continue;
-      };
-      hCandidate->Fill(13.5);
-      if (casc.dcacascdaughters() > dcacascdau) {
-        continue;
-      };
-      hCandidate->Fill(14.5);
-      if (TMath::Abs(casc.mLambda() - constants::physics::MassLambda) > masslambdalimit) {
-        continue;
-      };
-      hCandidate->Fill(15.5);
-      if (TMath::Abs(casc.eta()) > eta) {
-        continue;
-      };
-      hCandidate->Fill(16.5);
-
-      // TOREMOVE
-      if (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospa) {
-        hCandidate->Fill(17.5);
-        if (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) {
-          hCandidate->Fill(18.5);
-          if (xiproperlifetime < properlifetimefactor * ctauxi) {
-            hCandidate->Fill(19.5);
-            if (TMath::Abs(casc.yXi()) < rapidity) {
-              hCandidate->Fill(20.5);
-            }
-          }
-        }
       }
 
-      isXi = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpc) &&
-             (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospa) &&
-             (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
-             (TMath::Abs(casc.mXi() - RecoDecay::getMassPDG(3312)) < ximasswindow) &&
-             (TMath::Abs(casc.mOmega() - RecoDecay::getMassPDG(3334)) > omegarej) &&
-             (xiproperlifetime < properlifetimefactor * ctauxi) &&
-             (TMath::Abs(casc.yXi()) < rapidity); // add PID on bachelor
-      isXiYN = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpc) &&
-               (casc.cascradius() > 24.39) &&
-               (TMath::Abs(casc.mXi() - RecoDecay::getMassPDG(3312)) < ximasswindow) &&
-               (TMath::Abs(casc.mOmega() - RecoDecay::getMassPDG(3334)) > omegarej) &&
-               (xiproperlifetime < properlifetimefactor * ctauxi) &&
-               (TMath::Abs(casc.yXi()) < rapidity); // add PID on bachelor
-      isOmega = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpc) &&
-                (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospa) &&
-                (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
-                (TMath::Abs(casc.mOmega() - RecoDecay::getMassPDG(3334)) < omegamasswindow) &&
-                (TMath::Abs(casc.mXi() - RecoDecay::getMassPDG(3312)) > xirej) &&
-                (omegaproperlifetime < properlifetimefactor * ctauomega) &&
-                (TMath::Abs(casc.yOmega()) < rapidity); // add PID on bachelor
+      const bool isXi = mask & BIT(kCascXi);
+      const bool isXiYN = mask & BIT(kCascXiYN);
+      const bool isOmega = mask & BIT(kCascOmega);
 
       if (isXi) {
         QAHistos.fill(HIST("hMassXiAfterSel"), casc.mXi());
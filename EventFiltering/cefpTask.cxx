@@ -10,8 +10,12 @@
 // or submit itself to any jurisdiction.
 // O2 includes
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <cstdio>
+#include <limits>
+#include <numeric>
 #include <random>
 #include <string>
 #include <string_view>
@@ -262,6 +266,46 @@ struct centralEventFilterTask {
         col.second = filterOpt.get(col.first.data(), 0u);
       }
     }
+
+    // resolve once the bins, trigger bits and downscaling thresholds of the columns
+    mTriggerTables.clear();
+    for (auto& table : mDownscaling) {
+      auto& triggerTable = mTriggerTables.emplace_back();
+      triggerTable.name = table.first;
+      for (auto& column : table.second) {
+        int colBin{mScalers->GetXaxis()->FindBin(column.first.data())};
+        triggerTable.columns.push_back({column.first, colBin, BIT(colBin - 2), downscalingThreshold(column.second)});
+      }
+    }
+    mTriggerCounts.assign(nCols + 2, 0u);
+    mFilteredCounts.assign(nCols + 2, 0u);
+  }
+
+  /// Trigger column of a filter table, resolved at init
+  struct TriggerColumn {
+    std::string name;
+    int bin;              ///< bin of the column in the scaler histograms
+    uint64_t bit;         ///< bit of the column in the CEFP decisions
+    uint64_t downscaling; ///< an event is kept if a random 64 bit integer is below this threshold
+    bool keepAll() const { return downscaling == std::numeric_limits<uint64_t>::max(); }
+  };
+  struct TriggerTable {
+    std::string name;
+    std::vector<TriggerColumn> columns;
+  };
+  std::vector<TriggerTable> mTriggerTables;
+  std::vector<uint64_t> mTriggerCounts, mFilteredCounts; ///< per-bin counts of the current time frame
+
+  /// Threshold on a uniform random 64 bit integer corresponding to the keep probability
+  static uint64_t downscalingThreshold(double downscaling)
+  {
+    if (downscaling >= 1.) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    if (downscaling <= 0.) {
+      return 0u;
+    }
+    return static_cast<uint64_t>(std::ldexp(downscaling, 64));
   }
 
   void run(ProcessingContext& pc)
@@ -272,11 +316,11 @@ struct centralEventFilterTask {
     int64_t nEvents{-1};
     std::vector<uint64_t> outTrigger, outDecision;
 
-    for (auto& tableName : mDownscaling) {
-      if (!pc.inputs().isValid(tableName.first)) {
-        LOG(fatal) << tableName.first << " table is not valid.";
+    for (auto& triggerTable : mTriggerTables) {
+      if (!pc.inputs().isValid(triggerTable.name)) {
+        LOG(fatal) << triggerTable.name << " table is not valid.";
       }
-      auto tableConsumer = pc.inputs().get<TableConsumer>(tableName.first);
+      auto tableConsumer = pc.inputs().get<TableConsumer>(triggerTable.name);
       auto tablePtr{tableConsumer->asArrowTable()};
       int64_t nRows{tablePtr->num_rows()};
       nEvents = nEvents < 0 ? nRows : nEvents;
@@ -289,35 +333,44 @@ struct centralEventFilterTask {
         outTrigger.resize(nEvents, 0u);
       }
 
-      auto schema{tablePtr->schema()};
-      for (auto& colName : tableName.second) {
-        int bin{mScalers->GetXaxis()->FindBin(colName.first.data())};
-        double binCenter{mScalers->GetXaxis()->GetBinCenter(bin)};
-        uint64_t triggerBit{BIT(bin - 2)};
-        auto column{tablePtr->GetColumnByName(colName.first)};
-        double downscaling{colName.second};
-        if (column) {
-          int entry = 0;
-          for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
-            auto chunk{column->chunk(iC)};
-            auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(chunk);
-            for (int64_t iS{0}; iS < chunk->length(); ++iS) {
-              if (boolArray->Value(iS)) {
-                mScalers->Fill(binCenter);
-                outTrigger[entry] |= triggerBit;
-                if (mUniformGenerator(mGeneratorEngine) < downscaling) {
-                  mFiltered->Fill(binCenter);
-                  outDecision[entry] |= triggerBit;
-                }
-              }
-              entry++;
+      for (auto& triggerColumn : triggerTable.columns) {
+        auto column{tablePtr->GetColumnByName(triggerColumn.name)};
+        if (!column) {
+          continue;
+        }
+        int64_t entry{0};
+        uint64_t nTriggered{0}, nFiltered{0};
+        for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
+          auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(column->chunk(iC));
+          const int64_t length{boolArray->length()};
+          for (int64_t iS{0}; iS < length; ++iS, ++entry) {
+            if (!boolArray->Value(iS)) {
+              continue;
+            }
+            nTriggered++;
+            outTrigger[entry] |= triggerColumn.bit;
+            if (triggerColumn.keepAll() || mGeneratorEngine() < triggerColumn.downscaling) {
+              nFiltered++;
+              outDecision[entry] |= triggerColumn.bit;
             }
           }
         }
+        mTriggerCounts[triggerColumn.bin] += nTriggered;
+        mFilteredCounts[triggerColumn.bin] += nFiltered;
+      }
+    }
+    mTriggerCounts[1] += nEvents;
+    mFilteredCounts[1] += nEvents;
+    for (size_t iBin{1}; iBin < mTriggerCounts.size(); ++iBin) {
+      if (mTriggerCounts[iBin]) {
+        mScalers->AddBinContent(iBin, mTriggerCounts[iBin]);
+        mFiltered->AddBinContent(iBin, mFilteredCounts[iBin]);
       }
     }
-    mScalers->SetBinContent(1, mScalers->GetBinContent(1) + nEvents);
-    mFiltered->SetBinContent(1, mFiltered->GetBinContent(1) + nEvents);
+    mScalers->SetEntries(mScalers->GetEntries() + std::accumulate(mTriggerCounts.begin() + 2, mTriggerCounts.end(), uint64_t{0}));
+    mFiltered->SetEntries(mFiltered->GetEntries() + std::accumulate(mFilteredCounts.begin() + 2, mFilteredCounts.end(), uint64_t{0}));
+    std::fill(mTriggerCounts.begin(), mTriggerCounts.end(), 0u);
+    std::fill(mFilteredCounts.begin(), mFilteredCounts.end(), 0u);
 
     // Filling output table
     auto bcTabConsumer = pc.inputs().get<TableConsumer>("BCs");
@@ -335,8 +388,19 @@ struct centralEventFilterTask {
     std::unordered_map<int32_t, int64_t> triggers, decisions;
     auto GloBCId = -999.;
 
+    // global BC of each row of the BC table, flattened once instead of scanning all the chunks for each collision
+    std::vector<int32_t> gloBCs;
+    gloBCs.reserve(bcTabPtr->num_rows());
+    for (int64_t iB{0}; iB < columnGloBCId->num_chunks(); ++iB) {
+      auto GloBCArray = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(columnGloBCId->chunk(iB));
+      for (int64_t iS{0}; iS < GloBCArray->length(); ++iS) {
+        gloBCs.push_back(GloBCArray->Value(iS));
+      }
+    }
+
+    int64_t entry{0};
+    LOG(debug) << "columnBCId has " << columnBCId->num_chunks() << " chunks";
     for (int64_t iC{0}; iC < columnBCId->num_chunks(); ++iC) {
-      LOG(info) << "columnBCId has " << columnBCId->num_chunks() << " chunks";
       auto chunkBC{columnBCId->chunk(iC)};
       auto chunkCollTime{columnCollTime->chunk(iC)};
       auto chunkCollTimeRes{columnCollTimeRes->chunk(iC)};
@@ -344,14 +408,12 @@ struct centralEventFilterTask {
       auto BCArray = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(chunkBC);
       auto CollTimeArray = std::static_pointer_cast<arrow::NumericArray<arrow::DoubleType>>(chunkCollTime);
       auto CollTimeResArray = std::static_pointer_cast<arrow::NumericArray<arrow::DoubleType>>(chunkCollTimeRes);
-      for (int64_t iD{0}; iD < chunkBC->length(); ++iD) {
-        for (int64_t iB{0}; iB < columnGloBCId->num_chunks(); ++iB) {
-          auto chunkGloBC{columnGloBCId->chunk(iB)};
-          auto GloBCArray = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(chunkGloBC);
-          if (GloBCArray->Value(BCArray->Value(iD)))
-            GloBCId = GloBCArray->Value(BCArray->Value(iD));
+      for (int64_t iD{0}; iD < chunkBC->length(); ++iD, ++entry) {
+        auto bcRow{BCArray->Value(iD)};
+        if (bcRow >= 0 && bcRow < static_cast<int64_t>(gloBCs.size()) && gloBCs[bcRow]) {
+          GloBCId = gloBCs[bcRow];
         }
-        tags(BCArray->Value(iD), GloBCId, CollTimeArray->Value(iD), CollTimeResArray->Value(iD), outTrigger[iD], outDecision[iD]);
+        tags(BCArray->Value(iD), GloBCId, CollTimeArray->Value(iD), CollTimeResArray->Value(iD), outTrigger[entry], outDecision[entry]);
       }
     }
 
@@ -361,7 +423,6 @@ struct centralEventFilterTask {
   }
 
   std::mt19937_64 mGeneratorEngine;
-  std::uniform_real_distribution<double> mUniformGenerator = std::uniform_real_distribution<double>(0., 1.);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
@@ -96,11 +96,58 @@ DECLARE_SOA_COLUMN(CefpSelected, hasCefpSelected, uint64_t);      //! CEFP decis
 
 } // namespace decision
 
+namespace lftrigger
+{
+/// Bits of the track mask, nuclei candidates (rapidity and PID selections)
+enum TrackPreselection {
+  kH2 = 0,
+  kH3,
+  kHe3,
+  kHe4
+};
+
+/// Bits of the cascade mask, the selection steps have the index of the bin of the cut-flow histogram of the strangeness filter
+enum CascadePreselection {
+  kCascHasV0 = 1,        ///< the V0 of the cascade has a V0Data entry
+  kCascDCAMeson,         ///< DCA of the meson of the V0 to the PV
+  kCascDCABaryon,        ///< DCA of the baryon of the V0 to the PV
+  kCascTPCMeson,         ///< TPC PID of the meson of the V0
+  kCascTPCBaryon,        ///< TPC PID of the baryon of the V0
+  kCascTOFDaughters,     ///< TOF PID of at least one daughter
+  kCascEtaDaughters = 8, ///< pseudorapidity of the daughters
+  kCascDCABachToPV,      ///< DCA of the bachelor to the PV
+  kCascV0Radius,         ///< V0 radius
+  kCascCascRadius,       ///< cascade radius
+  kCascV0CosPA,          ///< V0 cosine of pointing angle
+  kCascDCAV0Dau,         ///< DCA between the V0 daughters
+  kCascDCACascDau,       ///< DCA between the cascade daughters
+  kCascLambdaMass,       ///< Lambda mass window
+  kCascEta,              ///< cascade pseudorapidity
+  kCascCascCosPA,        ///< cascade cosine of pointing angle
+  kCascDCAV0ToPV,        ///< DCA of the V0 to the PV, after the previous one
+  kCascXiLifetime,       ///< Xi proper lifetime, after the previous ones
+  kCascXiRapidity,       ///< Xi rapidity, after the previous ones
+  kCascXi = 24,          ///< Xi candidate
+  kCascXiYN,             ///< Xi candidate with R > 24.39 cm (YN interactions)
+  kCascOmega             ///< Omega candidate
+};
+
+DECLARE_SOA_COLUMN(TrackMask, trackMask, uint8_t);      //! nuclei candidate bits of the track
+DECLARE_SOA_COLUMN(CascadeMask, cascadeMask, uint32_t); //! selection steps passed by the cascade and Xi/Omega candidate bits
+
+} // namespace lftrigger
+
 // nuclei
 DECLARE_SOA_TABLE(NucleiFilters, "AOD", "NucleiFilters", //!
                   filtering::H2, filtering::H3, filtering::He3, filtering::He4);
 using NucleiFilter = NucleiFilters::iterator;
 
+// common preselection of the nuclei and strangeness filters, joinable with Tracks and CascDataExt
+DECLARE_SOA_TABLE(LFTrackPreSels, "AOD", "LFTrkPreSel", //!
+                  lftrigger::TrackMask);
+DECLARE_SOA_TABLE(LFCascPreSels, "AOD", "LFCascPreSel", //!
+                  lftrigger::CascadeMask);
+
 // diffraction
 DECLARE_SOA_TABLE(DiffractionFilters, "AOD", "DiffFilters", //! Diffraction filters
                   filtering::TwoPi, filtering::FourPi, filtering::TwoK, filtering::FourK);
@@ -188,6 +235,54 @@ unsigned int NumberOfColumns()
   return o2::framework::pack_size(typename T::iterator::persistent_columns_t{});
 }
 
+/// Lazy evaluation of the trigger categories of a filter
+/// Each category of the filter declares a cost (arbitrary units, larger for the more expensive combinatorics).
+/// The categories with a cost at or above the lazy threshold are evaluated only as long as the event is not
+/// selected by another category: the yes/no decision of the filter is unchanged, but their own bit is not
+/// filled for the events already kept (no per-category counting or downscaling for them).
+/// With a negative threshold (default) all the categories are evaluated.
+template <std::size_t N>
+class LazyTriggerEvaluator
+{
+ public:
+  void setCosts(std::array<int, N> const& costs) { mCosts = costs; }
+  void setLazyCostThreshold(int threshold) { mThreshold = threshold; }
+  bool isLazy() const { return mThreshold >= 0; }
+
+  /// \param decisions trigger decisions of the event so far
+  /// \return true if the category still has to be evaluated
+  bool isNeeded(const bool (&decisions)[N], int category) const
+  {
+    if (decisions[category]) {
+      return false;
+    }
+    if (mThreshold < 0 || mCosts[category] < mThreshold) {
+      return true;
+    }
+    for (std::size_t iCategory{0}; iCategory < N; ++iCategory) {
+      if (decisions[iCategory]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// \return true if at least one category still has to be evaluated
+  bool isAnyNeeded(const bool (&decisions)[N]) const
+  {
+    for (std::size_t iCategory{0}; iCategory < N; ++iCategory) {
+      if (isNeeded(decisions, iCategory)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::array<int, N> mCosts{}; ///< cost of each category
+  int mThreshold{-1};          ///< categories with cost >= threshold are evaluated lazily, disabled if negative
+};
+
 } // namespace o2::aod
 
 #endif // EVENTFILTERING_FILTERTABLES_H_
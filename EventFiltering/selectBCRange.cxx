@@ -10,6 +10,8 @@
 // or submit itself to any jurisdiction.
 // O2 includes
 
+#include <algorithm>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "CommonConstants/LHCConstants.h"
@@ -41,6 +43,9 @@ struct BCRangeSelector {
   uint64_t clast, cnew;
   o2::dataformats::bcRanges cbcrs = o2::dataformats::bcRanges("Initial list"); // ranges of compatible BCs
 
+  // global BCs of the BCs table, for the BC lookups
+  udhelpers::BCIndex bcIndex;
+
   // buffer for task output
   std::vector<o2::dataformats::IRFrame> res;
 
@@ -70,20 +75,37 @@ struct BCRangeSelector {
     }
 
     // 1. loop over collisions
+    // the collisions are ordered in time, so that the ranges of consecutive selected collisions mostly overlap:
+    // they are merged on the fly and only the disjoint ranges are added to the list
+    bcIndex.update(bcs);
+    int64_t firstBC{-1}, lastBC{-1}; // current merged range
     auto filt = fdecs.begin();
     for (auto collision : cols) {
       if (filt.hasCefpSelected()) {
 
         // get range of compatible BCs
-        auto bcRange = udhelpers::compatibleBCs(collision, nTimeRes, bcs, nMinBSs);
+        auto bcRange = udhelpers::compatibleBCs(collision, nTimeRes, bcs, bcIndex, nMinBSs);
 
         // update list of ranges
-        auto bcfirst = bcRange.rawIteratorAt(0);
-        auto bclast = bcRange.rawIteratorAt(bcRange.size());
-        cbcrs.add(bcfirst.globalIndex(), bclast.globalIndex());
+        if (bcRange.size() > 0) {
+          int64_t bcfirst = bcRange.rawIteratorAt(0).globalIndex();
+          int64_t bclast = bcRange.rawIteratorAt(bcRange.size()).globalIndex();
+          if (firstBC >= 0 && bcfirst >= firstBC && bcfirst <= lastBC) {
+            lastBC = std::max(lastBC, bclast);
+          } else {
+            if (firstBC >= 0) {
+              cbcrs.add(firstBC, lastBC);
+            }
+            firstBC = bcfirst;
+            lastBC = bclast;
+          }
+        }
       }
       filt++;
     }
+    if (firstBC >= 0) {
+      cbcrs.add(firstBC, lastBC);
+    }
 
     // 2. sort, merge, and extend ranges of compatible BCs
     cbcrs.compact(bcs, fillFac);
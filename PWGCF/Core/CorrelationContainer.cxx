@@ -15,6 +15,7 @@
 // Author: Jan Fiete Grosse-Oetringhaus
 
 #include "PWGCF/Core/CorrelationContainer.h"
+#include "PWGCF/Core/StepTHnAccumulator.h"
 #include "Framework/StepTHn.h"
 #include "Framework/Logger.h"
 #include "THnSparse.h"
@@ -30,6 +31,9 @@
 #include "Framework/HistogramSpec.h"
 #include "CommonConstants/MathConstants.h"
 
+#include <algorithm>
+#include <thread>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::constants::math;
@@ -57,7 +61,9 @@ CorrelationContainer::CorrelationContainer() : TNamed(),
                                                mSkipScaleMixedEvent(kFALSE),
                                                mCache(nullptr),
                                                mGetMultCacheOn(kFALSE),
-                                               mGetMultCache(nullptr)
+                                               mGetMultCache(nullptr),
+                                               mPairAccumulator(nullptr),
+                                               mTriggerAccumulator(nullptr)
 {
   // Default constructor
 }
@@ -84,7 +90,9 @@ CorrelationContainer::CorrelationContainer(const char* name, const char* objTitl
                                                                                                    mSkipScaleMixedEvent(kFALSE),
                                                                                                    mCache(nullptr),
                                                                                                    mGetMultCacheOn(kFALSE),
-                                                                                                   mGetMultCache(nullptr)
+                                                                                                   mGetMultCache(nullptr),
+                                                                                                   mPairAccumulator(nullptr),
+                                                                                                   mTriggerAccumulator(nullptr)
 {
   // correlationAxis has to provide a 6 length list of AxisSpec which contain:
   //   delta_eta, pt_assoc, pt_trig, multiplicity/centrality, delta_phi, vertex
@@ -139,7 +147,9 @@ CorrelationContainer::CorrelationContainer(const CorrelationContainer& c) : TNam
                                                                             mSkipScaleMixedEvent(kFALSE),
                                                                             mCache(nullptr),
                                                                             mGetMultCacheOn(kFALSE),
-                                                                            mGetMultCache(nullptr)
+                                                                            mGetMultCache(nullptr),
+                                                                            mPairAccumulator(nullptr),
+                                                                            mTriggerAccumulator(nullptr)
 {
   //
   // CorrelationContainer copy constructor
@@ -177,6 +187,11 @@ CorrelationContainer::~CorrelationContainer()
     delete mCache;
     mCache = nullptr;
   }
+
+  delete mPairAccumulator;
+  mPairAccumulator = nullptr;
+  delete mTriggerAccumulator;
+  mTriggerAccumulator = nullptr;
 }
 
 //____________________________________________________________________
@@ -235,6 +250,8 @@ Long64_t CorrelationContainer::Merge(TCollection* list)
     return 0;
   }
 
+  mergeAccumulators();
+
   if (list->IsEmpty()) {
     return 1;
   }
@@ -420,6 +437,267 @@ void CorrelationContainer::getHistsZVtxMult(CorrelationContainer::CFStep step, F
   resetBinLimits(mTriggerHist->getTHn(step), 3);
 }
 
+//____________________________________________________________________
+void CorrelationContainer::getHistsZVtxMult(CorrelationContainer::CFStep step, const std::vector<std::pair<Float_t, Float_t>>& ptTriggerRanges, std::vector<THnBase*>& trackHists, std::vector<TH2*>& eventHists, Int_t nThreads)
+{
+  // Same as getHistsZVtxMult above for several trigger pT ranges at once: the bins of the pair histogram
+  // are read once and added to the projections of all the ranges containing their trigger pT, instead of
+  // one ProjectionND per range. The bins are split over nThreads threads, each filling its own projections
+  // which are summed at the end. As reading the coordinates of a THnSparse is not thread safe, for more
+  // than one thread the pair histogram is converted to a THn (kept in the cache if setGetMultCache is on).
+  // Histograms have to be deleted by the caller of the function
+
+  THnBase* sparse = mPairHist->getTHn(step);
+  THnBase* triggerHist = mTriggerHist->getTHn(step);
+  THnBase* ownedDense = nullptr;
+  nThreads = TMath::Max(1, nThreads);
+  if (nThreads > 1 && sparse->InheritsFrom(THnSparse::Class())) {
+    if (mGetMultCacheOn) {
+      if (!mGetMultCache) {
+        mGetMultCache = changeToThn(sparse);
+      }
+      sparse = mGetMultCache;
+    } else {
+      ownedDense = changeToThn(sparse);
+      sparse = ownedDense;
+    }
+  }
+
+  // bin ranges in eta and associated pT as set by setBinLimits, all bins if no range is set
+  resetBinLimits(sparse, 6);
+  setBinLimits(sparse);
+  Int_t first[2];
+  Int_t last[2];
+  for (Int_t i = 0; i < 2; i++) {
+    TAxis* axis = sparse->GetAxis(i);
+    first[i] = axis->TestBit(TAxis::kAxisRange) ? axis->GetFirst() : 0;
+    last[i] = axis->TestBit(TAxis::kAxisRange) ? axis->GetLast() : axis->GetNbins() + 1;
+  }
+  resetBinLimits(sparse, 6);
+
+  // ranges each trigger pT bin contributes to
+  TAxis* triggerAxis = sparse->GetAxis(2);
+  std::vector<std::vector<Int_t>> rangesOfBin(triggerAxis->GetNbins() + 2);
+  for (size_t r = 0; r < ptTriggerRanges.size(); r++) {
+    Int_t firstBin = triggerAxis->FindBin(ptTriggerRanges[r].first);
+    Int_t lastBin = triggerAxis->FindBin(ptTriggerRanges[r].second);
+    LOGF(info, "Using trigger pT range %d --> %d", firstBin, lastBin);
+    for (Int_t bin = firstBin; bin <= lastBin; bin++) {
+      rangesOfBin[bin].push_back(static_cast<Int_t>(r));
+    }
+  }
+
+  // empty projections with the axes deltaphi, deltaeta, zvtx, multiplicity
+  const Int_t dimensions[] = {4, 0, 5, 3};
+  auto createProjection = [&](const char* name) {
+    Int_t nBins[4];
+    Double_t xMin[4];
+    Double_t xMax[4];
+    for (Int_t i = 0; i < 4; i++) {
+      TAxis* axis = sparse->GetAxis(dimensions[i]);
+      nBins[i] = axis->GetNbins();
+      xMin[i] = axis->GetXmin();
+      xMax[i] = axis->GetXmax();
+    }
+    THnBase* hist = new THnF(name, sparse->GetTitle(), 4, nBins, xMin, xMax);
+    for (Int_t i = 0; i < 4; i++) {
+      TAxis* axis = sparse->GetAxis(dimensions[i]);
+      if (axis->GetXbins()->GetSize() > 0) {
+        hist->GetAxis(i)->Set(axis->GetNbins(), axis->GetXbins()->GetArray());
+      }
+      hist->GetAxis(i)->SetTitle(axis->GetTitle());
+    }
+    hist->Sumw2();
+    return hist;
+  };
+
+  std::vector<std::vector<THnBase*>> threadHists(nThreads);
+  for (Int_t t = 0; t < nThreads; t++) {
+    for (size_t r = 0; r < ptTriggerRanges.size(); r++) {
+      threadHists[t].push_back(createProjection(Form("%s_proj_%d_%d", sparse->GetName(), (int)r, t)));
+    }
+  }
+
+  const Long64_t nSourceBins = sparse->GetNbins();
+  const Bool_t hasErrors = sparse->GetCalculateErrors();
+  auto sweep = [&](Int_t t) {
+    Int_t coord[6];
+    Int_t projCoord[4];
+    for (Long64_t i = nSourceBins * t / nThreads; i < nSourceBins * (t + 1) / nThreads; i++) {
+      Double_t content = sparse->GetBinContent(i, coord);
+      if (content == 0) {
+        continue;
+      }
+      if (coord[0] < first[0] || coord[0] > last[0] || coord[1] < first[1] || coord[1] > last[1]) {
+        continue;
+      }
+      const auto& ranges = rangesOfBin[coord[2]];
+      if (ranges.empty()) {
+        continue;
+      }
+      for (Int_t d = 0; d < 4; d++) {
+        projCoord[d] = coord[dimensions[d]];
+      }
+      Double_t error2 = hasErrors ? sparse->GetBinError2(i) : content;
+      for (auto r : ranges) {
+        THnBase* hist = threadHists[t][r];
+        Long64_t bin = hist->GetBin(projCoord);
+        hist->AddBinContent(bin, content);
+        hist->AddBinError2(bin, error2);
+      }
+    }
+  };
+  if (nThreads == 1) {
+    sweep(0);
+  } else {
+    std::vector<std::thread> threads;
+    for (Int_t t = 0; t < nThreads; t++) {
+      threads.emplace_back(sweep, t);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  trackHists.clear();
+  eventHists.clear();
+  for (size_t r = 0; r < ptTriggerRanges.size(); r++) {
+    THnBase* hist = threadHists[0][r];
+    for (Int_t t = 1; t < nThreads; t++) {
+      hist->Add(threadHists[t][r]);
+      delete threadHists[t][r];
+    }
+    trackHists.push_back(hist);
+
+    resetBinLimits(triggerHist, 3);
+    triggerHist->GetAxis(0)->SetRange(triggerAxis->FindBin(ptTriggerRanges[r].first), triggerAxis->FindBin(ptTriggerRanges[r].second));
+    eventHists.push_back((TH2*)triggerHist->Projection(1, 2)); // x = axis 2 (vertex) and y = axis 1 (multiplicity)
+  }
+  resetBinLimits(triggerHist, 3);
+  delete ownedDense;
+}
+
+//____________________________________________________________________
+void CorrelationContainer::fillMixedFromSingleParticleMaps(CorrelationContainer::CFStep step, THnBase* triggerMap, THnBase* associatedMap)
+{
+  // Fills the pair and trigger histograms of step with the mixed-event distribution computed from single particle maps,
+  // instead of correlating the tracks of different events: in a mixing (multiplicity, z-vtx) bin, the deltaeta-deltaphi
+  // distribution of the pairs of particles from different events is the cross-correlation of the eta-phi distributions
+  // of the trigger and associated particles summed over the events of the bin.
+  //
+  // The maps have the axes pT, multiplicity, z-vtx, eta, phi, with the multiplicity and z-vtx binning of this container.
+  // The eta and phi bin widths have to be the ones of the deltaeta and deltaphi axes; the pairs of two map bins are
+  // spread over the four pair bins around the difference of the bin centres (triangular distribution of the difference).
+  // The pairs of particles of the same event are included, a fraction 1 / (number of events in the bin) of the pairs,
+  // which is negligible for the shape of the mixed event. The correlation is computed directly: its cost only depends
+  // on the binning, not on the statistics.
+
+  const Int_t nPtTrigger = triggerMap->GetAxis(0)->GetNbins();
+  const Int_t nPtAssoc = associatedMap->GetAxis(0)->GetNbins();
+  const Int_t nMult = triggerMap->GetAxis(1)->GetNbins();
+  const Int_t nVertex = triggerMap->GetAxis(2)->GetNbins();
+  const Int_t nEta = triggerMap->GetAxis(3)->GetNbins();
+  const Int_t nPhi = triggerMap->GetAxis(4)->GetNbins();
+  if (associatedMap->GetAxis(3)->GetNbins() != nEta || associatedMap->GetAxis(4)->GetNbins() != nPhi) {
+    LOGF(error, "fillMixedFromSingleParticleMaps: trigger and associated maps have a different eta-phi binning");
+    return;
+  }
+  const Double_t etaWidth = triggerMap->GetAxis(3)->GetBinWidth(1);
+  const Double_t phiWidth = triggerMap->GetAxis(4)->GetBinWidth(1);
+  const Int_t nEtaPhi = nEta * nPhi;
+  const Int_t nDeltaEta = 2 * nEta - 1;
+
+  auto wrapDeltaPhi = [](Double_t dPhi) {
+    if (dPhi > 1.5 * PI) {
+      dPhi -= TwoPI;
+    } else if (dPhi < -PIHalf) {
+      dPhi += TwoPI;
+    }
+    return dPhi;
+  };
+
+  // eta-phi map of one (pT, multiplicity, z-vtx) bin
+  auto readMap = [&](THnBase* map, Int_t ptBin, Int_t multBin, Int_t vertexBin, std::vector<Double_t>& values) {
+    values.assign(nEtaPhi, 0.);
+    Double_t sum = 0;
+    Int_t bins[5] = {ptBin, multBin, vertexBin, 0, 0};
+    for (Int_t iEta = 0; iEta < nEta; iEta++) {
+      bins[3] = iEta + 1;
+      for (Int_t iPhi = 0; iPhi < nPhi; iPhi++) {
+        bins[4] = iPhi + 1;
+        values[iEta * nPhi + iPhi] = map->GetBinContent(bins);
+        sum += values[iEta * nPhi + iPhi];
+      }
+    }
+    return sum;
+  };
+
+  std::vector<std::vector<Double_t>> associated(nPtAssoc);
+  std::vector<Double_t> associatedSum(nPtAssoc);
+  std::vector<Double_t> trigger;
+  std::vector<Double_t> correlation(nDeltaEta * nPhi);
+
+  for (Int_t multBin = 1; multBin <= nMult; multBin++) {
+    const Double_t multiplicity = triggerMap->GetAxis(1)->GetBinCenter(multBin);
+    for (Int_t vertexBin = 1; vertexBin <= nVertex; vertexBin++) {
+      const Double_t vertex = triggerMap->GetAxis(2)->GetBinCenter(vertexBin);
+      for (Int_t ptAssocBin = 1; ptAssocBin <= nPtAssoc; ptAssocBin++) {
+        associatedSum[ptAssocBin - 1] = readMap(associatedMap, ptAssocBin, multBin, vertexBin, associated[ptAssocBin - 1]);
+      }
+      for (Int_t ptTriggerBin = 1; ptTriggerBin <= nPtTrigger; ptTriggerBin++) {
+        const Double_t triggerSum = readMap(triggerMap, ptTriggerBin, multBin, vertexBin, trigger);
+        if (triggerSum <= 0) {
+          continue;
+        }
+        const Double_t ptTrigger = triggerMap->GetAxis(0)->GetBinCenter(ptTriggerBin);
+        mTriggerHist->Fill(step, ptTrigger, multiplicity, vertex, triggerSum);
+
+        for (Int_t ptAssocBin = 1; ptAssocBin <= nPtAssoc; ptAssocBin++) {
+          if (associatedSum[ptAssocBin - 1] <= 0) {
+            continue;
+          }
+          const auto& assoc = associated[ptAssocBin - 1];
+          std::fill(correlation.begin(), correlation.end(), 0.);
+          for (Int_t iEta1 = 0; iEta1 < nEta; iEta1++) {
+            for (Int_t iEta2 = 0; iEta2 < nEta; iEta2++) {
+              Double_t* row = &correlation[(iEta1 - iEta2 + nEta - 1) * nPhi];
+              const Double_t* t = &trigger[iEta1 * nPhi];
+              const Double_t* a = &assoc[iEta2 * nPhi];
+              for (Int_t iPhi1 = 0; iPhi1 < nPhi; iPhi1++) {
+                if (t[iPhi1] == 0) {
+                  continue;
+                }
+                for (Int_t iPhi2 = 0; iPhi2 < nPhi; iPhi2++) {
+                  Int_t iDeltaPhi = iPhi1 - iPhi2;
+                  iDeltaPhi += (iDeltaPhi < 0) ? nPhi : 0;
+                  row[iDeltaPhi] += t[iPhi1] * a[iPhi2];
+                }
+              }
+            }
+          }
+
+          const Double_t ptAssoc = associatedMap->GetAxis(0)->GetBinCenter(ptAssocBin);
+          for (Int_t iDeltaEta = 0; iDeltaEta < nDeltaEta; iDeltaEta++) {
+            const Double_t deltaEta = (iDeltaEta - nEta + 1) * etaWidth;
+            for (Int_t iDeltaPhi = 0; iDeltaPhi < nPhi; iDeltaPhi++) {
+              const Double_t pairs = correlation[iDeltaEta * nPhi + iDeltaPhi];
+              if (pairs == 0) {
+                continue;
+              }
+              const Double_t deltaPhi = iDeltaPhi * phiWidth;
+              for (Double_t shiftEta : {-0.5 * etaWidth, 0.5 * etaWidth}) {
+                for (Double_t shiftPhi : {-0.5 * phiWidth, 0.5 * phiWidth}) {
+                  mPairHist->Fill(step, deltaEta + shiftEta, ptAssoc, ptTrigger, multiplicity, wrapDeltaPhi(deltaPhi + shiftPhi), vertex, 0.25 * pairs);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 TH2* CorrelationContainer::getPerTriggerYield(CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, Bool_t normalizePerTrigger)
 {
   // Calculate per trigger yield without considering mixed event
@@ -1649,3 +1927,30 @@ void CorrelationContainer::fillEvent(Float_t centrality, CFStep step)
   // Fill per-event information
   mEventCount->Fill(step, centrality);
 }
+
+StepTHnAccumulator* CorrelationContainer::getPairAccumulator(int nSlots)
+{
+  if (mPairAccumulator == nullptr) {
+    mPairAccumulator = new StepTHnAccumulator(mPairHist, nSlots);
+  }
+  return mPairAccumulator;
+}
+
+StepTHnAccumulator* CorrelationContainer::getTriggerAccumulator(int nSlots)
+{
+  if (mTriggerAccumulator == nullptr) {
+    mTriggerAccumulator = new StepTHnAccumulator(mTriggerHist, nSlots);
+  }
+  return mTriggerAccumulator;
+}
+
+void CorrelationContainer::mergeAccumulators()
+{
+  // Add the content of the accumulators to the histograms
+  if (mPairAccumulator) {
+    mPairAccumulator->merge();
+  }
+  if (mTriggerAccumulator) {
+    mTriggerAccumulator->merge();
+  }
+}
@@ -18,6 +18,9 @@
 #include "TString.h"
 #include "Framework/HistogramSpec.h"
 
+#include <utility>
+#include <vector>
+
 class TH1;
 class TH1F;
 class TH3;
@@ -30,6 +33,7 @@ class TCollection;
 class THnSparse;
 class THnBase;
 class StepTHn;
+class StepTHnAccumulator;
 
 class CorrelationContainer : public TNamed
 {
@@ -67,6 +71,12 @@ class CorrelationContainer : public TNamed
   StepTHn* getTrackHistEfficiency() { return mTrackHistEfficiency; }
   TH2F* getEventCount() { return mEventCount; }
 
+  // Accumulators in front of the pair and trigger histograms, for filling by linear bin index (possibly from several threads)
+  // They are created at the first call and their content is added to the histograms by mergeAccumulators()
+  StepTHnAccumulator* getPairAccumulator(int nSlots = 1);
+  StepTHnAccumulator* getTriggerAccumulator(int nSlots = 1);
+  void mergeAccumulators();
+
   void setPairHist(StepTHn* hist) { mPairHist = hist; }
   void setTriggerHist(StepTHn* hist) { mTriggerHist = hist; }
   void setTrackHistEfficiency(StepTHn* hist) { mTrackHistEfficiency = hist; }
@@ -74,6 +84,8 @@ class CorrelationContainer : public TNamed
   void deepCopy(CorrelationContainer* from);
 
   void getHistsZVtxMult(CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, THnBase** trackHist, TH2** eventHist);
+  void getHistsZVtxMult(CorrelationContainer::CFStep step, const std::vector<std::pair<Float_t, Float_t>>& ptTriggerRanges, std::vector<THnBase*>& trackHists, std::vector<TH2*>& eventHists, Int_t nThreads = 1);
+  void fillMixedFromSingleParticleMaps(CorrelationContainer::CFStep step, THnBase* triggerMap, THnBase* associatedMap);
   TH2* getPerTriggerYield(CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, Bool_t normalizePerTrigger = kTRUE);
   TH2* getSumOfRatios(CorrelationContainer* mixed, CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, Bool_t normalizePerTrigger = kTRUE, Int_t stepForMixed = -1, Int_t* trigger = nullptr);
   TH1* getTriggersAsFunctionOfMultiplicity(CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax);
@@ -178,6 +190,9 @@ class CorrelationContainer : public TNamed
   Bool_t mGetMultCacheOn; //! cache for getHistsZVtxMult function active
   THnBase* mGetMultCache; //! cache for getHistsZVtxMult function
 
+  StepTHnAccumulator* mPairAccumulator;    //! accumulator for mPairHist
+  StepTHnAccumulator* mTriggerAccumulator; //! accumulator for mTriggerHist
+
   ClassDef(CorrelationContainer, 2) // underlying event histogram container
 };
 
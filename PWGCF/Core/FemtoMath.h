@@ -0,0 +1,221 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoMath.h
+/// \brief Math calculations of quantities related to pairs, shared by the femtoscopy frameworks (FemtoDream, FemtoWorld)
+///
+/// FemtoDreamMath and FemtoWorldMath are aliases of FemtoMath, so that the pair kinematics and the close pair
+/// rejection kernels are written once for both frameworks.
+
+#ifndef PWGCF_CORE_FEMTOMATH_H_
+#define PWGCF_CORE_FEMTOMATH_H_
+
+#include "Math/Vector4D.h"
+#include "Math/Boost.h"
+#include "TLorentzVector.h"
+#include "TMath.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace o2::analysis::femto
+{
+
+/// \class FemtoMath
+/// \brief Container for math calculations of quantities related to pairs
+class FemtoMath
+{
+ public:
+  /// Compute the k* of a pair of particles
+  /// \tparam T type of tracks
+  /// \param part1 Particle 1
+  /// \param mass1 Mass of particle 1
+  /// \param part2 Particle 2
+  /// \param mass2 Mass of particle 2
+  template <typename T>
+  static float getkstar(const T& part1, const float mass1, const T& part2, const float mass2)
+  {
+    const ROOT::Math::PtEtaPhiMVector vecpart1(part1.pt(), part1.eta(), part1.phi(), mass1);
+    const ROOT::Math::PtEtaPhiMVector vecpart2(part2.pt(), part2.eta(), part2.phi(), mass2);
+    const ROOT::Math::PtEtaPhiMVector trackSum = vecpart1 + vecpart2;
+
+    const float beta = trackSum.Beta();
+    const float betax = beta * std::cos(trackSum.Phi()) * std::sin(trackSum.Theta());
+    const float betay = beta * std::sin(trackSum.Phi()) * std::sin(trackSum.Theta());
+    const float betaz = beta * std::cos(trackSum.Theta());
+
+    ROOT::Math::PxPyPzMVector PartOneCMS(vecpart1);
+    ROOT::Math::PxPyPzMVector PartTwoCMS(vecpart2);
+
+    const ROOT::Math::Boost boostPRF = ROOT::Math::Boost(-betax, -betay, -betaz);
+    PartOneCMS = boostPRF(PartOneCMS);
+    PartTwoCMS = boostPRF(PartTwoCMS);
+
+    const ROOT::Math::PxPyPzMVector trackRelK = PartOneCMS - PartTwoCMS;
+    return 0.5 * trackRelK.P();
+  }
+  /// Compute the qij of a pair of particles
+  /// \tparam T type of tracks
+  /// \param vecparti Particle i PxPyPzMVector
+  /// \param vecpartj Particle j PxPyPzMVector
+  // The q12 components can be calculated as:
+  //             q^mu = (p1-p2)^mu /2 - ((p1-p2)*P/(2P^2))*P^mu
+  //             where P = p1+p2
+  // Reference: https://www.annualreviews.org/doi/pdf/10.1146/annurev.nucl.55.090704.151533
+  // In the following code the above written equation will be expressed as:
+  //             q = trackDifference/2 -  scaling * trackSum
+  // where scaling is a float number:
+  //             scaling = trackDifference*trackSum/(2*trackSum^2) = ((p1-p2)*P/(2P^2))
+  // We don't use the reduced vector - no division by 2
+  template <typename T>
+  static ROOT::Math::PxPyPzEVector getqij(const T& vecparti, const T& vecpartj)
+  {
+    ROOT::Math::PxPyPzEVector trackSum = vecparti + vecpartj;
+    ROOT::Math::PxPyPzEVector trackDifference = vecparti - vecpartj;
+    float scaling = trackDifference.Dot(trackSum) / trackSum.Dot(trackSum);
+    return trackDifference - scaling * trackSum;
+  }
+
+  /// Compute the Q3 of a triplet of particles
+  /// \tparam T type of tracks
+  /// \param part1 Particle 1
+  /// \param mass1 Mass of particle 1
+  /// \param part2 Particle 2
+  /// \param mass2 Mass of particle 2
+  /// \param part3 Particle 3
+  /// \param mass3 Mass of particle 3
+  template <typename T>
+  static float getQ3(const T& part1, const float mass1, const T& part2, const float mass2, const T& part3, const float mass3)
+  {
+    float E1 = sqrt(pow(part1.px(), 2) + pow(part1.py(), 2) + pow(part1.pz(), 2) + pow(mass1, 2));
+    float E2 = sqrt(pow(part2.px(), 2) + pow(part2.py(), 2) + pow(part2.pz(), 2) + pow(mass2, 2));
+    float E3 = sqrt(pow(part3.px(), 2) + pow(part3.py(), 2) + pow(part3.pz(), 2) + pow(mass3, 2));
+
+    const ROOT::Math::PxPyPzEVector vecpart1(part1.px(), part1.py(), part1.pz(), E1);
+    const ROOT::Math::PxPyPzEVector vecpart2(part2.px(), part2.py(), part2.pz(), E2);
+    const ROOT::Math::PxPyPzEVector vecpart3(part3.px(), part3.py(), part3.pz(), E3);
+
+    ROOT::Math::PxPyPzEVector q12 = getqij(vecpart1, vecpart2);
+    ROOT::Math::PxPyPzEVector q23 = getqij(vecpart2, vecpart3);
+    ROOT::Math::PxPyPzEVector q31 = getqij(vecpart3, vecpart1);
+
+    float Q32 = q12.M2() + q23.M2() + q31.M2();
+
+    return sqrt(-Q32);
+  }
+
+  /// Compute the transverse momentum of a pair of particles
+  /// \tparam T type of tracks
+  /// \param part1 Particle 1
+  /// \param mass1 Mass of particle 1
+  /// \param part2 Particle 2
+  /// \param mass2 Mass of particle 2
+  template <typename T>
+  static float getkT(const T& part1, const float mass1, const T& part2, const float mass2)
+  {
+    const ROOT::Math::PtEtaPhiMVector vecpart1(part1.pt(), part1.eta(), part1.phi(), mass1);
+    const ROOT::Math::PtEtaPhiMVector vecpart2(part2.pt(), part2.eta(), part2.phi(), mass2);
+    const ROOT::Math::PtEtaPhiMVector trackSum = vecpart1 + vecpart2;
+    return 0.5 * trackSum.Pt();
+  }
+
+  /// Compute the transverse mass of a pair of particles
+  /// \tparam T type of tracks
+  /// \param part1 Particle 1
+  /// \param mass1 Mass of particle 1
+  /// \param part2 Particle 2
+  /// \param mass2 Mass of particle 2
+  template <typename T>
+  static float getmT(const T& part1, const float mass1, const T& part2, const float mass2)
+  {
+    return std::sqrt(std::pow(getkT(part1, mass1, part2, mass2), 2.) + std::pow(0.5 * (mass1 + mass2), 2.));
+  }
+
+  /// Compute k*, kT and mT of one particle with a set of particles at once
+  /// k* is obtained from the invariants |k*|^2 = (-q^2 + (m1^2 - m2^2)^2 / P^2) / 4, with q = p1 - p2 and P = p1 + p2,
+  /// so that no boost is needed and the loop over the second particles vectorises
+  /// \param px1 Momentum in x of particle 1
+  /// \param py1 Momentum in y of particle 1
+  /// \param pz1 Momentum in z of particle 1
+  /// \param e1 Energy of particle 1
+  /// \param mass1 Mass of particle 1
+  /// \param n Number of particles 2
+  /// \param px2 Momenta in x of particles 2
+  /// \param py2 Momenta in y of particles 2
+  /// \param pz2 Momenta in z of particles 2
+  /// \param e2 Energies of particles 2
+  /// \param mass2 Mass of particles 2
+  /// \param kstar Output k* of the n pairs
+  /// \param kT Output kT of the n pairs
+  /// \param mT Output mT of the n pairs
+  static void getPairKinematics(const float px1, const float py1, const float pz1, const float e1, const float mass1,
+                                const int n, const float* px2, const float* py2, const float* pz2, const float* e2, const float mass2,
+                                float* kstar, float* kT, float* mT)
+  {
+    const double dm2 = (double(mass1) * mass1 - double(mass2) * mass2);
+    const double mAvg2 = 0.25 * (double(mass1) + mass2) * (double(mass1) + mass2);
+    for (int j = 0; j < n; ++j) {
+      const double dx = px1 - px2[j], dy = py1 - py2[j], dz = pz1 - pz2[j], de = e1 - e2[j];
+      const double sx = px1 + px2[j], sy = py1 + py2[j], sz = pz1 + pz2[j], se = e1 + e2[j];
+      const double sumM2 = se * se - sx * sx - sy * sy - sz * sz;
+      const double kstar2 = dx * dx + dy * dy + dz * dz - de * de + dm2 * dm2 / sumM2;
+      const double kT2 = 0.25 * (sx * sx + sy * sy);
+      kstar[j] = 0.5 * std::sqrt(kstar2 > 0. ? kstar2 : 0.);
+      kT[j] = std::sqrt(kT2);
+      mT[j] = std::sqrt(kT2 + mAvg2);
+    }
+  }
+
+  /// Compute phi* of a track, its azimuthal angle at a radius in the TPC
+  /// \param phi Azimuthal angle of the track at the primary vertex
+  /// \param charge Charge of the track
+  /// \param pt Transverse momentum of the track
+  /// \param magfield Magnetic field in Tesla
+  /// \param radius Radius in cm
+  static float getPhiStar(const float phi, const float charge, const float pt, const float magfield, const float radius)
+  {
+    return phi - std::asin(0.3 * charge * 0.1 * magfield * radius * 0.01 / (2. * pt));
+  }
+
+  /// Compute the average over the radii of the difference in phi* of two tracks
+  /// \tparam N Number of radii
+  /// \param phiStarOne phi* of track 1 at the N radii
+  /// \param phiStarTwo phi* of track 2 at the N radii
+  /// \param dphi Output difference in phi* at the N radii, in [-pi, pi)
+  template <int N>
+  static float getAverageDphiStar(const float* phiStarOne, const float* phiStarTwo, float* dphi)
+  {
+    float dphiAvg = 0;
+    for (int r = 0; r < N; r++) {
+      // same as TVector2::Phi_mpi_pi, the difference being within (-3 pi, 3 pi)
+      float d = phiStarOne[r] - phiStarTwo[r];
+      d = (d >= TMath::Pi() ? d - TMath::TwoPi() : d);
+      d = (d < -TMath::Pi() ? d + TMath::TwoPi() : d);
+      dphi[r] = d;
+      dphiAvg += d;
+    }
+    return dphiAvg / (float)N;
+  }
+
+  /// Check if a pair is within the ellipse of the close pair rejection
+  /// \param deta Difference in pseudorapidity
+  /// \param dphiAvg Average difference in phi*
+  /// \param deltaEtaMax Half axis of the ellipse in pseudorapidity
+  /// \param deltaPhiMax Half axis of the ellipse in phi*
+  static bool isCloseInDetaDphiStar(const float deta, const float dphiAvg, const float deltaEtaMax, const float deltaPhiMax)
+  {
+    return pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.;
+  }
+};
+
+} // namespace o2::analysis::femto
+
+#endif // PWGCF_CORE_FEMTOMATH_H_
@@ -0,0 +1,132 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoMixingPool.h
+/// \brief Pools of events for the event mixing of the femtoscopy pair tasks (FemtoDream, FemtoWorld)
+///
+/// For each mixing bin (e.g. the bin of ColumnBinningPolicy or the hash of the femtoDreamHashTask) the last N events
+/// are kept in a ring buffer. The pools live in the analysis task, so that the mixing is not restricted to the
+/// collisions of one dataframe and the particles are not sliced again for every pair of collisions.
+
+#ifndef PWGCF_CORE_FEMTOMIXINGPOOL_H_
+#define PWGCF_CORE_FEMTOMIXINGPOOL_H_
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace o2::analysis::femto
+{
+
+/// Compact copy of a femto particle, with the accessors used by the pair containers and by the track-track close pair rejection
+struct FemtoMixingParticle {
+  float mPt;         ///< Transverse momentum
+  float mEta;        ///< Pseudorapidity
+  float mPhi;        ///< Azimuthal angle
+  uint32_t mCut;     ///< Selection bits
+  uint8_t mPartType; ///< Type of the particle
+
+  template <typename T>
+  static FemtoMixingParticle from(T const& part)
+  {
+    return {part.pt(), part.eta(), part.phi(), static_cast<uint32_t>(part.cut()), static_cast<uint8_t>(part.partType())};
+  }
+
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  float px() const { return mPt * std::cos(mPhi); }
+  float py() const { return mPt * std::sin(mPhi); }
+  float pz() const { return mPt * std::sinh(mEta); }
+  float p() const { return mPt * std::cosh(mEta); }
+  uint32_t cut() const { return mCut; }
+  uint8_t partType() const { return mPartType; }
+};
+
+/// Event stored in the pools: the selected particles of both species and the collision properties needed for the pairing
+struct FemtoMixingEvent {
+  std::vector<FemtoMixingParticle> mPartsOne; ///< Selected particles one
+  std::vector<FemtoMixingParticle> mPartsTwo; ///< Selected particles two
+  float mMagField = 0.f;                      ///< Magnetic field in Tesla
+  float mMult = 0.f;                          ///< Multiplicity
+
+  void clear()
+  {
+    mPartsOne.clear();
+    mPartsTwo.clear();
+  }
+};
+
+/// \class FemtoMixingPool
+/// \brief Ring buffer of the last events of each mixing bin
+/// \tparam TEvent Type of the stored events, needs a clear() method
+template <typename TEvent = FemtoMixingEvent>
+class FemtoMixingPool
+{
+ public:
+  /// \param depth Number of events stored per mixing bin
+  void setDepth(int depth) { mDepth = (depth > 0 ? depth : 1); }
+  int getDepth() const { return mDepth; }
+
+  /// Loop over the events stored for a mixing bin, from the oldest to the newest once the pool is full
+  template <typename F>
+  void forEach(int bin, F&& function) const
+  {
+    auto pool = mPools.find(bin);
+    if (pool == mPools.end()) {
+      return;
+    }
+    const auto& events = pool->second.mEvents;
+    const int nEvents = events.size();
+    for (int i = 0; i < nEvents; i++) {
+      function(events[(pool->second.mNext + i) % nEvents]);
+    }
+  }
+
+  /// Store an event in its mixing bin, replacing the oldest one if the bin is full
+  /// The content of the event is swapped with the replaced one, so that the allocated memory is reused,
+  /// and the event passed is cleared
+  void add(int bin, TEvent& event)
+  {
+    Pool& pool = mPools[bin];
+    if (static_cast<int>(pool.mEvents.size()) < mDepth) {
+      pool.mEvents.emplace_back();
+      std::swap(pool.mEvents.back(), event);
+    } else {
+      std::swap(pool.mEvents[pool.mNext], event);
+      pool.mNext = (pool.mNext + 1) % mDepth;
+    }
+    event.clear();
+  }
+
+  int getNEvents(int bin) const
+  {
+    auto pool = mPools.find(bin);
+    return (pool == mPools.end() ? 0 : pool->second.mEvents.size());
+  }
+
+  void clear() { mPools.clear(); }
+
+ private:
+  struct Pool {
+    std::vector<TEvent> mEvents; ///< Stored events, at most mDepth
+    int mNext = 0;               ///< Position of the oldest event once the pool is full
+  };
+
+  int mDepth = 5;                       ///< Number of events stored per mixing bin
+  std::unordered_map<int, Pool> mPools; ///< Stored events per mixing bin
+};
+
+} // namespace o2::analysis::femto
+
+#endif // PWGCF_CORE_FEMTOMIXINGPOOL_H_
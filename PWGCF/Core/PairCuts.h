@@ -12,7 +12,11 @@
 #ifndef O2_ANALYSIS_PAIRCUTS_H
 #define O2_ANALYSIS_PAIRCUTS_H
 
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "Framework/Logger.h"
 #include "Framework/HistogramRegistry.h"
@@ -53,6 +57,12 @@ class PairCuts
     mTwoTrackDistance = distance;
     mTwoTrackRadius = radius;
 
+    // radii of the dphi* scan, the same as the loop of twoTrackCut
+    mRadii.clear();
+    for (Double_t rad = mTwoTrackRadius; rad < 2.51; rad += 0.01) {
+      mRadii.push_back(rad);
+    }
+
     if (histogramRegistry != nullptr && histogramRegistry->contains(HIST("TwoTrackDistancePt_0")) == false) {
       histogramRegistry->add("TwoTrackDistancePt_0", "", {HistType::kTH3F, {{100, -0.15, 0.15, "#Delta#eta"}, {100, -0.05, 0.05, "#Delta#varphi^{*}_{min}"}, {20, 0, 10, "#Delta p_{T}"}}});
       histogramRegistry->addClone("TwoTrackDistancePt_0", "TwoTrackDistancePt_1");
@@ -65,13 +75,73 @@ class PairCuts
   template <typename T>
   bool twoTrackCut(T const& track1, T const& track2, int magField);
 
+  // Batched interface: one particle against the candidates given by their arrays
+  // On input keep[i] != 0 marks the candidates to be checked, on output it is set to 0 for the pairs to be removed.
+  // The control histograms are filled after the loop over the candidates.
+  struct Candidates {
+    int n;
+    const float* pt;
+    const float* eta;
+    const float* phi;
+    const int* sign;
+  };
+
+  template <typename T>
+  void conversionCuts(T const& track1, Candidates const& candidates, uint8_t* keep);
+
+  template <typename T>
+  void twoTrackCut(T const& track1, Candidates const& candidates, int magField, uint8_t* keep);
+
  protected:
+  struct PairParticle {
+    float mPt;
+    float mEta;
+    float mPhi;
+    int mSign;
+    float pt() const { return mPt; }
+    float eta() const { return mEta; }
+    float phi() const { return mPhi; }
+    int sign() const { return mSign; }
+  };
+
   float mCuts[ParticlesLastEntry] = {-1};
   float mTwoTrackDistance = -1; // distance below which the pair is flagged as to be removed
   float mTwoTrackRadius = 0.8f; // radius at which the two track cuts are applied
 
   HistogramRegistry* histogramRegistry = nullptr; // if set, control histograms are stored here
 
+  // Buffers of the batched interface
+  std::vector<float> mRadii;                             // radii of the dphi* scan
+  std::vector<float> mTriggerBending;                    // bending term of the first particle at each radius
+  std::vector<int> mSelected;                            // candidates passing the delta eta gate
+  bool mDeferControl = false;                            // control histogram entries are buffered instead of filled
+  std::vector<std::pair<int, float>> mControlConv;       // id, delta mass
+  std::vector<std::array<float, 3>> mControlTwoTrack[2]; // deta, dphistarmin, delta pT; before and after the cut
+
+  void fillControlConv(int id, float deltaMass)
+  {
+    if (mDeferControl) {
+      mControlConv.emplace_back(id, deltaMass);
+    } else {
+      histogramRegistry->fill(HIST("ControlConvResonances"), id, deltaMass);
+    }
+  }
+  void flushControl();
+
+  static float foldDPhiStar(float dphistar)
+  {
+    if (dphistar > PI) {
+      dphistar = TwoPI - dphistar;
+    }
+    if (dphistar < -PI) {
+      dphistar = -TwoPI - dphistar;
+    }
+    if (dphistar > PI) { // might look funny but is needed
+      dphistar = TwoPI - dphistar;
+    }
+    return dphistar;
+  }
+
   template <typename T>
   bool conversionCut(T const& track1, T const& track2, Particle conv, double cut);
 
@@ -212,7 +282,7 @@ bool PairCuts::conversionCut(T const& track1, T const& track2, Particle conv, do
   massC = getInvMassSquared(track1, massD1, track2, massD2);
 
   if (histogramRegistry != nullptr) {
-    histogramRegistry->fill(HIST("ControlConvResonances"), static_cast<int>(conv), massC - massM * massM);
+    fillControlConv(static_cast<int>(conv), massC - massM * massM);
   }
 
   if (massC > (massM - cut) * (massM - cut) && massC < (massM + cut) * (massM + cut)) {
@@ -326,17 +396,116 @@ float PairCuts::getDPhiStar(T const& track1, T const& track2, float radius, int
 
   float dphistar = phi1 - phi2 - charge1 * std::asin(0.015 * magField * radius / pt1) + charge2 * std::asin(0.015 * magField * radius / pt2);
 
-  if (dphistar > PI) {
-    dphistar = TwoPI - dphistar;
+  return foldDPhiStar(dphistar);
+}
+
+template <typename T>
+void PairCuts::conversionCuts(T const& track1, Candidates const& candidates, uint8_t* keep)
+{
+  const PairParticle particle1{track1.pt(), track1.eta(), track1.phi(), track1.sign()};
+
+  mDeferControl = true;
+  for (int i = 0; i < candidates.n; i++) {
+    // like sign pairs are never removed
+    if (!keep[i] || particle1.mSign * candidates.sign[i] > 0) {
+      continue;
+    }
+    const PairParticle particle2{candidates.pt[i], candidates.eta[i], candidates.phi[i], candidates.sign[i]};
+    if (conversionCuts(particle1, particle2)) {
+      keep[i] = 0;
+    }
+  }
+  mDeferControl = false;
+  flushControl();
+}
+
+template <typename T>
+void PairCuts::twoTrackCut(T const& track1, Candidates const& candidates, int magField, uint8_t* keep)
+{
+  // same cut as twoTrackCut for a single pair
+  // the cheap delta eta gate selects the candidates first, the dphi* scan then runs only on these, with the
+  // bending of the first particle at each radius computed once for all of them
+
+  const float eta1 = track1.eta();
+  const float phi1 = track1.phi();
+  const float pt1 = track1.pt();
+  const float kGate = mTwoTrackDistance * 2.5 * 3;
+  const float kLimit = mTwoTrackDistance * 3;
+  const auto bending = [magField](int charge, float radius, float pt) {
+    return static_cast<float>(charge * std::asin(0.015 * magField * radius / pt));
+  };
+
+  mSelected.clear();
+  for (int i = 0; i < candidates.n; i++) {
+    if (keep[i] && std::fabs(eta1 - candidates.eta[i]) < kGate) {
+      mSelected.push_back(i);
+    }
   }
-  if (dphistar < -PI) {
-    dphistar = -TwoPI - dphistar;
+  if (mSelected.empty()) {
+    return;
   }
-  if (dphistar > PI) { // might look funny but is needed
-    dphistar = TwoPI - dphistar;
+
+  const int nRadii = mRadii.size();
+  mTriggerBending.resize(nRadii);
+  for (int k = 0; k < nRadii; k++) {
+    mTriggerBending[k] = bending(track1.sign(), mRadii[k], pt1);
   }
 
-  return dphistar;
+  for (const int i : mSelected) {
+    const float deta = eta1 - candidates.eta[i];
+    const float dphi = phi1 - candidates.phi[i];
+    const int charge2 = candidates.sign[i];
+    const float pt2 = candidates.pt[i];
+
+    // check first boundaries to see if is worth to loop and find the minimum
+    const float dphistar1 = foldDPhiStar(dphi - bending(track1.sign(), mTwoTrackRadius, pt1) + bending(charge2, mTwoTrackRadius, pt2));
+    const float dphistar2 = foldDPhiStar(dphi - bending(track1.sign(), 2.5, pt1) + bending(charge2, 2.5, pt2));
+    if (!(std::fabs(dphistar1) < kLimit || std::fabs(dphistar2) < kLimit || dphistar1 * dphistar2 < 0)) {
+      continue;
+    }
+
+    float dphistarminabs = 1e5;
+    float dphistarmin = 1e5;
+    for (int k = 0; k < nRadii; k++) {
+      const float dphistar = foldDPhiStar(dphi - mTriggerBending[k] + bending(charge2, mRadii[k], pt2));
+      const float dphistarabs = std::fabs(dphistar);
+      const bool smaller = dphistarabs < dphistarminabs;
+      dphistarmin = smaller ? dphistar : dphistarmin;
+      dphistarminabs = smaller ? dphistarabs : dphistarminabs;
+    }
+
+    const bool removed = dphistarminabs < mTwoTrackDistance && std::fabs(deta) < mTwoTrackDistance;
+    if (histogramRegistry != nullptr) {
+      const std::array<float, 3> entry{deta, dphistarmin, std::fabs(pt1 - pt2)};
+      mControlTwoTrack[0].push_back(entry);
+      if (!removed) {
+        mControlTwoTrack[1].push_back(entry);
+      }
+    }
+    if (removed) {
+      keep[i] = 0;
+    }
+  }
+  flushControl();
+}
+
+inline void PairCuts::flushControl()
+{
+  if (histogramRegistry == nullptr) {
+    return;
+  }
+  for (const auto& [id, deltaMass] : mControlConv) {
+    histogramRegistry->fill(HIST("ControlConvResonances"), id, deltaMass);
+  }
+  for (const auto& entry : mControlTwoTrack[0]) {
+    histogramRegistry->fill(HIST("TwoTrackDistancePt_0"), entry[0], entry[1], entry[2]);
+  }
+  for (const auto& entry : mControlTwoTrack[1]) {
+    histogramRegistry->fill(HIST("TwoTrackDistancePt_1"), entry[0], entry[1], entry[2]);
+  }
+  mControlConv.clear();
+  mControlTwoTrack[0].clear();
+  mControlTwoTrack[1].clear();
 }
 
 #endif
@@ -0,0 +1,101 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "PWGCF/Core/StepTHnAccumulator.h"
+#include "Framework/StepTHn.h"
+#include "Framework/Logger.h"
+#include "TAxis.h"
+#include "TArray.h"
+
+StepTHnAccumulator::StepTHnAccumulator(StepTHn* target, int nSlots) : mTarget(target),
+                                                                      mNSlots(nSlots > 0 ? nSlots : 1)
+{
+  if (mTarget == nullptr) {
+    LOGF(fatal, "StepTHnAccumulator: no target histogram given");
+    return;
+  }
+
+  mNSteps = mTarget->getNSteps();
+  const int nVar = mTarget->getNVar();
+  mAxes.resize(nVar);
+  mStrides.resize(nVar);
+  mNBins = 1;
+  for (int i = nVar - 1; i >= 0; i--) {
+    TAxis* axis = mTarget->GetAxis(i);
+    std::vector<float> edges;
+    for (int bin = 1; bin <= axis->GetNbins() + 1; bin++) {
+      edges.push_back(axis->GetBinLowEdge(bin));
+    }
+    mAxes[i].setEdges(edges);
+    mStrides[i] = mNBins;
+    mNBins *= axis->GetNbins();
+  }
+  mBuffers.resize(mNSlots * mNSteps);
+
+  LOGF(info, "Created StepTHnAccumulator for %s with %d slots of %ld bins per step", mTarget->GetName(), mNSlots, mNBins);
+}
+
+int64_t StepTHnAccumulator::getBin(const float* values) const
+{
+  int64_t bin = 0;
+  for (int i = 0; i < getNVar(); i++) {
+    int axisBin = mAxes[i].findBin(values[i]);
+    if (axisBin < 0) {
+      return -1;
+    }
+    bin += axisBin * mStrides[i];
+  }
+  return bin;
+}
+
+void StepTHnAccumulator::merge()
+{
+  for (int step = 0; step < mNSteps; step++) {
+    bool filled = false;
+    bool weighted = false;
+    for (int slot = 0; slot < mNSlots; slot++) {
+      const Buffer& buffer = mBuffers[slot * mNSteps + step];
+      filled |= !buffer.mFilledBins.empty();
+      weighted |= buffer.mWeighted;
+    }
+    if (!filled) {
+      continue;
+    }
+
+    // The containers of the target are created at its first fill, with a squared weights container only for weights different from 1
+    // An entry with weight 0 creates both without changing the content
+    if (mTarget->getValues(step) == nullptr || (weighted && mTarget->getSumw2(step) == nullptr)) {
+      std::vector<double> positionAndWeight;
+      for (int i = 0; i < getNVar(); i++) {
+        positionAndWeight.push_back(mTarget->GetAxis(i)->GetBinCenter(1));
+      }
+      positionAndWeight.push_back(0.);
+      mTarget->Fill(step, positionAndWeight.size(), positionAndWeight.data());
+    }
+    TArray* values = mTarget->getValues(step);
+    TArray* sumw2 = mTarget->getSumw2(step);
+
+    for (int slot = 0; slot < mNSlots; slot++) {
+      Buffer& buffer = mBuffers[slot * mNSteps + step];
+      for (auto bin : buffer.mFilledBins) {
+        // a bin can be listed several times if it was filled with weight 0, it is reset after being added
+        values->SetAt(values->GetAt(bin) + buffer.mSumW[bin], bin);
+        if (sumw2) {
+          sumw2->SetAt(sumw2->GetAt(bin) + buffer.mSumW2[bin], bin);
+        }
+        buffer.mSumW[bin] = 0.;
+        buffer.mSumW2[bin] = 0.;
+      }
+      buffer.mFilledBins.clear();
+      buffer.mWeighted = false;
+    }
+  }
+}
@@ -0,0 +1,86 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_ANALYSIS_STEPTHNACCUMULATOR_H
+#define O2_ANALYSIS_STEPTHNACCUMULATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Common/Core/EventMixing.h"
+
+class StepTHn;
+
+// Accumulation buffers in front of a StepTHn
+//
+// The content is accumulated in dense per-slot bin buffers, filled by linear bin index, and added to the
+// StepTHn by merge(). Each thread of a parallel fill loop uses its own slot, so that no locking is needed.
+// The linear bin index follows the StepTHn convention (first axis varies the slowest, under- and overflows
+// are not stored) and can be computed per axis with findBin() and getStride(), so that the callers can
+// precompute the parts of the index which are common to many entries.
+
+class StepTHnAccumulator
+{
+ public:
+  StepTHnAccumulator(StepTHn* target, int nSlots = 1);
+
+  int getNVar() const { return mAxes.size(); }
+  int getNSlots() const { return mNSlots; }
+  StepTHn* getTarget() { return mTarget; }
+
+  // bin of the value in the given axis, starting from 0, -1 for under- and overflow
+  int findBin(int axis, float value) const { return mAxes[axis].findBin(value); }
+  int64_t getStride(int axis) const { return mStrides[axis]; }
+  // linear bin index of a set of values (one per axis), -1 if any of them is outside the axis range
+  int64_t getBin(const float* values) const;
+
+  void fill(int slot, int step, int64_t bin, float weight)
+  {
+    Buffer& buffer = getBuffer(slot, step);
+    if (buffer.mSumW2[bin] == 0) {
+      buffer.mFilledBins.push_back(bin);
+    }
+    buffer.mSumW[bin] += weight;
+    buffer.mSumW2[bin] += weight * weight;
+    buffer.mWeighted |= (weight != 1.f);
+  }
+
+  // adds the content of all slots to the target and resets them
+  void merge();
+
+ protected:
+  struct Buffer {
+    std::vector<double> mSumW;        // sum of weights per bin
+    std::vector<double> mSumW2;       // sum of squared weights per bin
+    std::vector<int64_t> mFilledBins; // bins filled since the last merge
+    bool mWeighted = false;           // at least one weight different from 1 was filled
+  };
+
+  Buffer& getBuffer(int slot, int step)
+  {
+    Buffer& buffer = mBuffers[slot * mNSteps + step];
+    if (buffer.mSumW.empty()) {
+      buffer.mSumW.resize(mNBins, 0.);
+      buffer.mSumW2.resize(mNBins, 0.);
+    }
+    return buffer;
+  }
+
+  StepTHn* mTarget = nullptr;                  // histogram into which the content is merged
+  int mNSlots = 1;                             // number of independent accumulation slots
+  int mNSteps = 0;                             // number of steps of the target
+  int64_t mNBins = 0;                          // number of bins per step (without under- and overflows)
+  std::vector<eventmixing::BinningAxis> mAxes; // binning of each axis of the target
+  std::vector<int64_t> mStrides;               // linear index stride of each axis
+  std::vector<Buffer> mBuffers;                // buffers per slot and step, allocated at the first fill
+};
+
+#endif
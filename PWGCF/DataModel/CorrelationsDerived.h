@@ -70,6 +70,14 @@ DECLARE_SOA_TABLE(CFTracks, "AOD", "CFTRACK", //! Reduced track table
                   cftrack::Pt, cftrack::Eta, cftrack::Phi,
                   cftrack::Sign, track::TrackType);
 using CFTrack = CFTracks::iterator;
+
+namespace cftriggerrange
+{
+DECLARE_SOA_COLUMN(NTriggers, nTriggers, int32_t); //! Number of tracks above the trigger pT threshold at the beginning of the tracks of the collision, -1 if the tracks are not sorted
+} // namespace cftriggerrange
+DECLARE_SOA_TABLE(CFTriggerRanges, "AOD", "CFTRIGGERRANGE", //! Trigger-eligible tracks of each reduced collision, joinable with CFCollisions
+                  cftriggerrange::NTriggers);
+using CFTriggerRange = CFTriggerRanges::iterator;
 } // namespace o2::aod
 
 #endif // O2_ANALYSIS_CFDERIVED_H
@@ -19,11 +19,15 @@
 
 #include "Framework/HistogramRegistry.h"
 #include "FemtoDreamMath.h"
+#include "FemtoDreamParticleBuffer.h"
 
 #include "Math/Vector4D.h"
 #include "TMath.h"
 #include "TDatabasePDG.h"
 
+#include <memory>
+#include <vector>
+
 using namespace o2::framework;
 
 namespace o2::analysis::femtoDream
@@ -76,16 +80,16 @@ class FemtoDreamContainer
     framework::AxisSpec mTAxis = {mTBins, "#it{m}_{T} (GeV/#it{c}^{2})"};
 
     std::string folderName = static_cast<std::string>(mFolderSuffix[mEventType]);
-    mHistogramRegistry->add((folderName + "relPairDist").c_str(), ("; " + femtoObs + "; Entries").c_str(), kTH1F, {femtoObsAxis});
-    mHistogramRegistry->add((folderName + "relPairkT").c_str(), "; #it{k}_{T} (GeV/#it{c}); Entries", kTH1F, {kTAxis});
-    mHistogramRegistry->add((folderName + "relPairkstarkT").c_str(), ("; " + femtoObs + "; #it{k}_{T} (GeV/#it{c})").c_str(), kTH2F, {femtoObsAxis, kTAxis});
-    mHistogramRegistry->add((folderName + "relPairkstarmT").c_str(), ("; " + femtoObs + "; #it{m}_{T} (GeV/#it{c}^{2})").c_str(), kTH2F, {femtoObsAxis, mTAxis});
-    mHistogramRegistry->add((folderName + "relPairkstarMult").c_str(), ("; " + femtoObs + "; Multiplicity").c_str(), kTH2F, {femtoObsAxis, multAxis});
-    mHistogramRegistry->add((folderName + "kstarPtPart1").c_str(), ("; " + femtoObs + "; #it{p} _{T} Particle 1 (GeV/#it{c})").c_str(), kTH2F, {femtoObsAxis, {375, 0., 7.5}});
-    mHistogramRegistry->add((folderName + "kstarPtPart2").c_str(), ("; " + femtoObs + "; #it{p} _{T} Particle 2 (GeV/#it{c})").c_str(), kTH2F, {femtoObsAxis, {375, 0., 7.5}});
-    mHistogramRegistry->add((folderName + "MultPtPart1").c_str(), "; #it{p} _{T} Particle 1 (GeV/#it{c}); Multiplicity", kTH2F, {{375, 0., 7.5}, multAxis});
-    mHistogramRegistry->add((folderName + "MultPtPart2").c_str(), "; #it{p} _{T} Particle 2 (GeV/#it{c}); Multiplicity", kTH2F, {{375, 0., 7.5}, multAxis});
-    mHistogramRegistry->add((folderName + "PtPart1PtPart2").c_str(), "; #it{p} _{T} Particle 1 (GeV/#it{c}); #it{p} _{T} Particle 2 (GeV/#it{c})", kTH2F, {{375, 0., 7.5}, {375, 0., 7.5}});
+    mRelPairDist = mHistogramRegistry->add<TH1>((folderName + "relPairDist").c_str(), ("; " + femtoObs + "; Entries").c_str(), kTH1F, {femtoObsAxis});
+    mRelPairkT = mHistogramRegistry->add<TH1>((folderName + "relPairkT").c_str(), "; #it{k}_{T} (GeV/#it{c}); Entries", kTH1F, {kTAxis});
+    mRelPairkstarkT = mHistogramRegistry->add<TH2>((folderName + "relPairkstarkT").c_str(), ("; " + femtoObs + "; #it{k}_{T} (GeV/#it{c})").c_str(), kTH2F, {femtoObsAxis, kTAxis});
+    mRelPairkstarmT = mHistogramRegistry->add<TH2>((folderName + "relPairkstarmT").c_str(), ("; " + femtoObs + "; #it{m}_{T} (GeV/#it{c}^{2})").c_str(), kTH2F, {femtoObsAxis, mTAxis});
+    mRelPairkstarMult = mHistogramRegistry->add<TH2>((folderName + "relPairkstarMult").c_str(), ("; " + femtoObs + "; Multiplicity").c_str(), kTH2F, {femtoObsAxis, multAxis});
+    mKstarPtPart1 = mHistogramRegistry->add<TH2>((folderName + "kstarPtPart1").c_str(), ("; " + femtoObs + "; #it{p} _{T} Particle 1 (GeV/#it{c})").c_str(), kTH2F, {femtoObsAxis, {375, 0., 7.5}});
+    mKstarPtPart2 = mHistogramRegistry->add<TH2>((folderName + "kstarPtPart2").c_str(), ("; " + femtoObs + "; #it{p} _{T} Particle 2 (GeV/#it{c})").c_str(), kTH2F, {femtoObsAxis, {375, 0., 7.5}});
+    mMultPtPart1 = mHistogramRegistry->add<TH2>((folderName + "MultPtPart1").c_str(), "; #it{p} _{T} Particle 1 (GeV/#it{c}); Multiplicity", kTH2F, {{375, 0., 7.5}, multAxis});
+    mMultPtPart2 = mHistogramRegistry->add<TH2>((folderName + "MultPtPart2").c_str(), "; #it{p} _{T} Particle 2 (GeV/#it{c}); Multiplicity", kTH2F, {{375, 0., 7.5}, multAxis});
+    mPtPart1PtPart2 = mHistogramRegistry->add<TH2>((folderName + "PtPart1PtPart2").c_str(), "; #it{p} _{T} Particle 1 (GeV/#it{c}); #it{p} _{T} Particle 2 (GeV/#it{c})", kTH2F, {{375, 0., 7.5}, {375, 0., 7.5}});
   }
 
   /// Set the PDG codes of the two particles involved
@@ -97,6 +101,11 @@ class FemtoDreamContainer
     mMassTwo = TDatabasePDG::Instance()->GetParticle(pdg2)->Mass();
   }
 
+  /// \return PDG mass of particle one
+  float getMassOne() const { return mMassOne; }
+  /// \return PDG mass of particle two
+  float getMassTwo() const { return mMassTwo; }
+
   /// Pass a pair to the container and compute all the relevant observables
   /// \tparam T type of the femtodreamparticle
   /// \param part1 Particle one
@@ -111,18 +120,60 @@ class FemtoDreamContainer
     }
     const float kT = FemtoDreamMath::getkT(part1, mMassOne, part2, mMassTwo);
     const float mT = FemtoDreamMath::getmT(part1, mMassOne, part2, mMassTwo);
+    setPair(femtoObs, kT, mT, part1.pt(), part2.pt(), mult);
+  }
 
+  /// Pass the observables of a pair to the container
+  /// \param femtoObs Femtoscopic observable of the pair
+  /// \param kT kT of the pair
+  /// \param mT mT of the pair
+  /// \param pt1 Transverse momentum of particle one
+  /// \param pt2 Transverse momentum of particle two
+  /// \param mult Multiplicity of the event
+  void setPair(const float femtoObs, const float kT, const float mT, const float pt1, const float pt2, const int mult)
+  {
     if (mHistogramRegistry) {
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("relPairDist"), femtoObs);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("relPairkT"), kT);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("relPairkstarkT"), femtoObs, kT);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("relPairkstarmT"), femtoObs, mT);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("relPairkstarMult"), femtoObs, mult);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("kstarPtPart1"), femtoObs, part1.pt());
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("kstarPtPart2"), femtoObs, part2.pt());
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("MultPtPart1"), part1.pt(), mult);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("MultPtPart2"), part2.pt(), mult);
-      mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST("PtPart1PtPart2"), part1.pt(), part2.pt());
+      mRelPairDist->Fill(femtoObs);
+      mRelPairkT->Fill(kT);
+      mRelPairkstarkT->Fill(femtoObs, kT);
+      mRelPairkstarmT->Fill(femtoObs, mT);
+      mRelPairkstarMult->Fill(femtoObs, mult);
+      mKstarPtPart1->Fill(femtoObs, pt1);
+      mKstarPtPart2->Fill(femtoObs, pt2);
+      mMultPtPart1->Fill(pt1, mult);
+      mMultPtPart2->Fill(pt2, mult);
+      mPtPart1PtPart2->Fill(pt1, pt2);
+    }
+  }
+
+  /// Pass all the pairs of one buffered particle with a range of buffered particles to the container
+  /// The pair observables are computed at once for the whole range, the pair selection is applied afterwards
+  /// \tparam F Type of the pair selection
+  /// \param partsOne Buffer of particles one, with the energies for the mass of particle one
+  /// \param iPartOne Particle one of the pairs
+  /// \param partsTwo Buffer of particles two, with the energies for the mass of particle two
+  /// \param firstPartTwo First particle two of the range, the range extending to the end of the buffer
+  /// \param mult Multiplicity of the event
+  /// \param isSelectedPair Pair selection, called with the index of particle two in its buffer
+  template <typename F>
+  void setPairs(FemtoDreamParticleBuffer const& partsOne, const int iPartOne, FemtoDreamParticleBuffer const& partsTwo, const int firstPartTwo, const int mult, F&& isSelectedPair)
+  {
+    const int nPairs = partsTwo.size() - firstPartTwo;
+    if (nPairs <= 0) {
+      return;
+    }
+    mPairKstar.resize(nPairs);
+    mPairkT.resize(nPairs);
+    mPairmT.resize(nPairs);
+    FemtoDreamMath::getPairKinematics(partsOne.mPx[iPartOne], partsOne.mPy[iPartOne], partsOne.mPz[iPartOne], partsOne.mE[iPartOne], mMassOne, nPairs,
+                                      partsTwo.mPx.data() + firstPartTwo, partsTwo.mPy.data() + firstPartTwo, partsTwo.mPz.data() + firstPartTwo, partsTwo.mE.data() + firstPartTwo, mMassTwo,
+                                      mPairKstar.data(), mPairkT.data(), mPairmT.data());
+    const float pt1 = partsOne.mPt[iPartOne];
+    for (int k = 0; k < nPairs; ++k) {
+      if (!isSelectedPair(firstPartTwo + k)) {
+        continue;
+      }
+      setPair(mPairKstar[k], mPairkT[k], mPairmT[k], pt1, partsTwo.mPt[firstPartTwo + k], mult);
     }
   }
 
@@ -133,6 +184,20 @@ class FemtoDreamContainer
   static constexpr int mEventType = eventType;                                        ///< Type of the event (same/mixed, according to femtoDreamContainer::EventType)
   float mMassOne = 0.f;                                                               ///< PDG mass of particle 1
   float mMassTwo = 0.f;                                                               ///< PDG mass of particle 2
+
+  std::shared_ptr<TH1> mRelPairDist;      ///< Femtoscopic observable
+  std::shared_ptr<TH1> mRelPairkT;        ///< kT
+  std::shared_ptr<TH2> mRelPairkstarkT;   ///< Femtoscopic observable vs kT
+  std::shared_ptr<TH2> mRelPairkstarmT;   ///< Femtoscopic observable vs mT
+  std::shared_ptr<TH2> mRelPairkstarMult; ///< Femtoscopic observable vs multiplicity
+  std::shared_ptr<TH2> mKstarPtPart1;     ///< Femtoscopic observable vs pT of particle 1
+  std::shared_ptr<TH2> mKstarPtPart2;     ///< Femtoscopic observable vs pT of particle 2
+  std::shared_ptr<TH2> mMultPtPart1;      ///< pT of particle 1 vs multiplicity
+  std::shared_ptr<TH2> mMultPtPart2;      ///< pT of particle 2 vs multiplicity
+  std::shared_ptr<TH2> mPtPart1PtPart2;   ///< pT of particle 1 vs pT of particle 2
+  std::vector<float> mPairKstar;          ///< k* of the pairs passed to setPairs()
+  std::vector<float> mPairkT;             ///< kT of the pairs passed to setPairs()
+  std::vector<float> mPairmT;             ///< mT of the pairs passed to setPairs()
 };
 
 } // namespace o2::analysis::femtoDream
@@ -18,6 +18,8 @@
 
 #include "PWGCF/DataModel/FemtoDerived.h"
 #include "Framework/HistogramRegistry.h"
+#include "FemtoDreamMath.h"
+#include "FemtoDreamParticleBuffer.h"
 #include <string>
 
 namespace o2::analysis
@@ -83,7 +85,7 @@ class FemtoDreamDetaDphiStar
       auto deta = part1.eta() - part2.eta();
       auto dphiAvg = AveragePhiStar(part1, part2, 0);
       histdetadpi[0][0]->Fill(deta, dphiAvg);
-      if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
+      if (FemtoDreamMath::isCloseInDetaDphiStar(deta, dphiAvg, deltaEtaMax, deltaPhiMax)) {
         return true;
       } else {
         histdetadpi[0][1]->Fill(deta, dphiAvg);
@@ -105,7 +107,7 @@ class FemtoDreamDetaDphiStar
         auto deta = part1.eta() - daughter.eta();
         auto dphiAvg = AveragePhiStar(part1, *daughter, i);
         histdetadpi[i][0]->Fill(deta, dphiAvg);
-        if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
+        if (FemtoDreamMath::isCloseInDetaDphiStar(deta, dphiAvg, deltaEtaMax, deltaPhiMax)) {
           pass = true;
         } else {
           histdetadpi[i][1]->Fill(deta, dphiAvg);
@@ -118,6 +120,49 @@ class FemtoDreamDetaDphiStar
     }
   }
 
+  /// Compute phi* at all the radii stored in tmpRadiiTPC for the buffered particles
+  /// phi* only depends on the single particle, so it is computed once per particle instead of once per pair
+  /// \param parts Buffer of particles, mPhiStar is filled at [particle * kNRadii + radius]
+  /// \param lmagfield Magnetic field in Tesla
+  void fillPhiStar(FemtoDreamParticleBuffer& parts, float lmagfield)
+  {
+    magfield = lmagfield;
+    parts.mPhiStar.resize(parts.size() * kNRadii);
+    for (int i = 0; i < parts.size(); i++) {
+      const float charge = getCharge(parts.mCut[i]);
+      for (int r = 0; r < kNRadii; r++) {
+        parts.mPhiStar[i * kNRadii + r] = FemtoDreamMath::getPhiStar(parts.mPhi[i], charge, parts.mPt[i], magfield, tmpRadiiTPC[r]);
+      }
+    }
+  }
+
+  ///  Check if pair is close or not, for buffered tracks with phi* from fillPhiStar()
+  /// \param partsOne Buffer of particles one
+  /// \param iPartOne Index of particle one in its buffer
+  /// \param partsTwo Buffer of particles two
+  /// \param iPartTwo Index of particle two in its buffer
+  bool isClosePair(FemtoDreamParticleBuffer const& partsOne, int iPartOne, FemtoDreamParticleBuffer const& partsTwo, int iPartTwo)
+  {
+    static_assert(mPartOneType == o2::aod::femtodreamparticle::ParticleType::kTrack && mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kTrack,
+                  "FemtoDreamDetaDphiStar: the buffered close pair rejection is only defined for kTrack,kTrack");
+    const float* phiStarOne = partsOne.mPhiStar.data() + iPartOne * kNRadii;
+    const float* phiStarTwo = partsTwo.mPhiStar.data() + iPartTwo * kNRadii;
+    const float deta = partsOne.mEta[iPartOne] - partsTwo.mEta[iPartTwo];
+    float dphi[kNRadii];
+    const float dphiAvg = FemtoDreamMath::getAverageDphiStar<kNRadii>(phiStarOne, phiStarTwo, dphi);
+    if (plotForEveryRadii) {
+      for (int r = 0; r < kNRadii; r++) {
+        histdetadpiRadii[0][r]->Fill(deta, dphi[r]);
+      }
+    }
+    histdetadpi[0][0]->Fill(deta, dphiAvg);
+    if (FemtoDreamMath::isCloseInDetaDphiStar(deta, dphiAvg, deltaEtaMax, deltaPhiMax)) {
+      return true;
+    }
+    histdetadpi[0][1]->Fill(deta, dphiAvg);
+    return false;
+  }
+
  private:
   HistogramRegistry* mHistogramRegistry = nullptr;   ///< For main output
   HistogramRegistry* mHistogramRegistryQA = nullptr; ///< For QA output
@@ -135,7 +180,8 @@ class FemtoDreamDetaDphiStar
   static constexpr o2::aod::femtodreamparticle::ParticleType mPartOneType = partOne; ///< Type of particle 1
   static constexpr o2::aod::femtodreamparticle::ParticleType mPartTwoType = partTwo; ///< Type of particle 2
 
-  static constexpr float tmpRadiiTPC[9] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
+  static constexpr int kNRadii = 9;
+  static constexpr float tmpRadiiTPC[kNRadii] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
 
   static constexpr uint32_t kSignMinusMask = 1;
   static constexpr uint32_t kSignPlusMask = 1 << 1;
@@ -149,28 +195,30 @@ class FemtoDreamDetaDphiStar
   std::array<std::array<std::shared_ptr<TH2>, 2>, 2> histdetadpi{};
   std::array<std::array<std::shared_ptr<TH2>, 9>, 2> histdetadpiRadii{};
 
-  ///  Calculate phi at all required radii stored in tmpRadiiTPC
-  /// Magnetic field to be provided in Tesla
-  template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  /// Get the charge from cutcontainer using masks
+  float getCharge(o2::aod::femtodreamparticle::cutContainerType cut)
   {
-
-    float phi0 = part.phi();
-    // Start: Get the charge from cutcontainer using masks
     float charge = 0.;
-    if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
+    if ((cut & kSignMinusMask) == kValue0 && (cut & kSignPlusMask) == kValue0) {
       charge = 0;
-    } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
+    } else if ((cut & kSignPlusMask) == kSignPlusMask) {
       charge = 1;
-    } else if ((part.cut() & kSignMinusMask) == kSignMinusMask) {
+    } else if ((cut & kSignMinusMask) == kSignMinusMask) {
       charge = -1;
     } else {
       LOG(fatal) << "FemtoDreamDetaDphiStar: Charge bits are set wrong!";
     }
-    // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+    return charge;
+  }
+
+  ///  Calculate phi at all required radii stored in tmpRadiiTPC
+  /// Magnetic field to be provided in Tesla
+  template <typename T>
+  void PhiAtRadiiTPC(const T& part, float* phiStar)
+  {
+    const float charge = getCharge(part.cut());
+    for (int r = 0; r < kNRadii; r++) {
+      phiStar[r] = FemtoDreamMath::getPhiStar(part.phi(), charge, part.pt(), magfield, tmpRadiiTPC[r]);
     }
   }
 
@@ -178,21 +226,16 @@ class FemtoDreamDetaDphiStar
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    const int num = tmpVec1.size();
-    float dPhiAvg = 0;
-    for (int i = 0; i < num; i++) {
-      float dphi = tmpVec1.at(i) - tmpVec2.at(i);
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+    float phiStar1[kNRadii], phiStar2[kNRadii], dphi[kNRadii];
+    PhiAtRadiiTPC(part1, phiStar1);
+    PhiAtRadiiTPC(part2, phiStar2);
+    const float dPhiAvg = FemtoDreamMath::getAverageDphiStar<kNRadii>(phiStar1, phiStar2, dphi);
+    if (plotForEveryRadii) {
+      for (int r = 0; r < kNRadii; r++) {
+        histdetadpiRadii[iHist][r]->Fill(part1.eta() - part2.eta(), dphi[r]);
       }
     }
-    return (dPhiAvg / (float)num);
+    return dPhiAvg;
   }
 };
 
@@ -0,0 +1,106 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoDreamParticleBuffer.h
+/// \brief FemtoDreamParticleBuffer - Structure of arrays with the kinematics of the selected particles of one collision, used for the pairing
+
+#ifndef ANALYSIS_TASKS_PWGCF_FEMTODREAM_FEMTODREAMPARTICLEBUFFER_H_
+#define ANALYSIS_TASKS_PWGCF_FEMTODREAM_FEMTODREAMPARTICLEBUFFER_H_
+
+#include "PWGCF/DataModel/FemtoDerived.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace o2::analysis::femtoDream
+{
+
+/// \class FemtoDreamParticleBuffer
+/// \brief The particles of a slice are selected and their kinematics stored once, so that the single particle
+/// selections are not repeated for every pair and the pair kinematics can be computed over contiguous arrays
+class FemtoDreamParticleBuffer
+{
+ public:
+  /// Fill the buffer from a slice of femtodreamparticles
+  /// \tparam T Type of the slice
+  /// \tparam F Type of the single particle selection
+  /// \param parts Slice of femtodreamparticles
+  /// \param mass Mass assumed for the energy
+  /// \param isSelected Single particle selection, called once per particle
+  template <typename T, typename F>
+  void fill(T const& parts, const float mass, F&& isSelected)
+  {
+    clear();
+    int position = 0;
+    for (auto const& part : parts) {
+      if (isSelected(part)) {
+        mPosition.push_back(position);
+        mIndex.push_back(part.globalIndex());
+        mPt.push_back(part.pt());
+        mEta.push_back(part.eta());
+        mPhi.push_back(part.phi());
+        mCut.push_back(part.cut());
+      }
+      ++position;
+    }
+    const int n = size();
+    mPx.resize(n);
+    mPy.resize(n);
+    mPz.resize(n);
+    mE.resize(n);
+    for (int i = 0; i < n; ++i) {
+      mPx[i] = mPt[i] * std::cos(mPhi[i]);
+      mPy[i] = mPt[i] * std::sin(mPhi[i]);
+      mPz[i] = mPt[i] * std::sinh(mEta[i]);
+      mE[i] = std::sqrt(mPx[i] * mPx[i] + mPy[i] * mPy[i] + mPz[i] * mPz[i] + mass * mass);
+    }
+  }
+
+  void clear()
+  {
+    mPosition.clear();
+    mIndex.clear();
+    mPt.clear();
+    mEta.clear();
+    mPhi.clear();
+    mCut.clear();
+  }
+
+  int size() const { return mPosition.size(); }
+
+  /// \return First buffered particle with a position in the slice larger than the given one
+  /// Used to reproduce the strictly upper index policy of the combinations within one collision
+  int firstAfter(const int position) const
+  {
+    int i = 0;
+    while (i < size() && mPosition[i] <= position) {
+      ++i;
+    }
+    return i;
+  }
+
+  std::vector<int> mPosition;                                      ///< Position of the particle in the slice
+  std::vector<int64_t> mIndex;                                     ///< Global index of the particle in the femtodreamparticle table
+  std::vector<float> mPt;                                          ///< Transverse momentum
+  std::vector<float> mEta;                                         ///< Pseudorapidity
+  std::vector<float> mPhi;                                         ///< Azimuthal angle
+  std::vector<o2::aod::femtodreamparticle::cutContainerType> mCut; ///< Selection bits of the particle
+  std::vector<float> mPx;                                          ///< Momentum in x
+  std::vector<float> mPy;                                          ///< Momentum in y
+  std::vector<float> mPz;                                          ///< Momentum in z
+  std::vector<float> mE;                                           ///< Energy for the mass given to fill()
+  std::vector<float> mPhiStar;                                     ///< phi* at the TPC radii, filled by FemtoDreamDetaDphiStar::fillPhiStar()
+};
+
+} // namespace o2::analysis::femtoDream
+
+#endif /* ANALYSIS_TASKS_PWGCF_FEMTODREAM_FEMTODREAMPARTICLEBUFFER_H_ */
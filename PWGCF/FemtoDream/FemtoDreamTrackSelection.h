@@ -25,8 +25,10 @@
 
 #include "ReconstructionDataFormats/PID.h"
 #include "Framework/HistogramRegistry.h"
+#include <array>
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 using namespace o2::framework;
 
@@ -56,6 +58,27 @@ enum TrackContainerPosition {
   kPID
 }; /// Position in the full track cut container
 
+/// Selection variables of a chunk of tracks, one column per variable, to build the cut containers of all the tracks at once
+struct TrackColumns {
+  std::array<std::vector<float>, kPIDnSigmaMax> variables; ///< Selection variables except the PID, indexed by TrackSel (kpTMax uses the column of kpTMin)
+  std::vector<std::vector<float>> pidTPC;                  ///< n_sigma TPC minus the offset, one column per PID species
+  std::vector<std::vector<float>> pidComb;                 ///< Combined TPC and TOF n_sigma, one column per PID species
+
+  size_t size() const { return variables[kSign].size(); }
+  void clear()
+  {
+    for (auto& column : variables) {
+      column.clear();
+    }
+    for (auto& column : pidTPC) {
+      column.clear();
+    }
+    for (auto& column : pidComb) {
+      column.clear();
+    }
+  }
+};
+
 } // namespace femtoDreamTrackSelection
 
 /// \class FemtoDreamTrackCuts
@@ -143,6 +166,21 @@ class FemtoDreamTrackSelection : public FemtoDreamObjectSelection<float, femtoDr
   template <typename cutContainerType, typename T>
   std::array<cutContainerType, 2> getCutContainer(T const& track);
 
+  /// Appends the selection variables of a track to the columns of a chunk of tracks
+  /// \tparam T Data type of the track
+  /// \param columns Selection variables of the chunk
+  /// \param track Track
+  template <typename T>
+  void fillColumns(femtoDreamTrackSelection::TrackColumns& columns, T const& track);
+
+  /// Obtain the bit-wise containers for the selections of a chunk of tracks, same as getCutContainer for each track
+  /// Each selection is evaluated over all the tracks of the chunk in one loop without branching, instead of one track after the other
+  /// \tparam cutContainerType Data type of the bit-wise container for the selections
+  /// \param columns Selection variables of the chunk, filled with fillColumns
+  /// \param cutContainers Output, the bit-wise containers of the tracks in the order of the columns
+  template <typename cutContainerType>
+  void getCutContainers(femtoDreamTrackSelection::TrackColumns const& columns, std::vector<std::array<cutContainerType, 2>>& cutContainers);
+
   /// Some basic QA histograms
   /// \tparam part Type of the particle for proper naming of the folders for QA
   /// \tparam tracktype Type of track (track, positive child, negative child) for proper naming of the folders for QA
@@ -211,6 +249,44 @@ class FemtoDreamTrackSelection : public FemtoDreamObjectSelection<float, femtoDr
   }
 
  private:
+  /// Sets the bit of a selection in the containers of all the tracks of a column
+  template <typename cutContainerType, typename Selected>
+  static void setBits(std::vector<float> const& column, Selected selected, std::vector<std::array<cutContainerType, 2>>& cutContainers, int position, size_t bit)
+  {
+    const size_t n = column.size();
+    const float* values = column.data();
+    auto* output = cutContainers.data();
+    for (size_t i = 0; i < n; ++i) {
+      output[i][position] |= static_cast<cutContainerType>(static_cast<cutContainerType>(selected(values[i])) << bit);
+    }
+  }
+
+  /// Same comparison as FemtoDreamSelection::isSelected, with the type of selection resolved once for the column
+  template <typename cutContainerType, typename S>
+  static void setSelectionBits(S& sel, std::vector<float> const& column, std::vector<std::array<cutContainerType, 2>>& cutContainers, int position, size_t bit)
+  {
+    const float val = sel.getSelectionValue();
+    switch (sel.getSelectionType()) {
+      case (femtoDreamSelection::kUpperLimit):
+        setBits(column, [val](float obs) { return obs < val; }, cutContainers, position, bit);
+        break;
+      case (femtoDreamSelection::kAbsUpperLimit):
+        setBits(column, [val](float obs) { return std::abs(obs) < val; }, cutContainers, position, bit);
+        break;
+      case (femtoDreamSelection::kLowerLimit):
+        setBits(column, [val](float obs) { return obs > val; }, cutContainers, position, bit);
+        break;
+      case (femtoDreamSelection::kAbsLowerLimit):
+        setBits(column, [val](float obs) { return std::abs(obs) > val; }, cutContainers, position, bit);
+        break;
+      case (femtoDreamSelection::kEqual): {
+        const double tolerance = std::abs(val * 1e-6);
+        setBits(column, [val, tolerance](float obs) { return std::abs(obs - val) < tolerance; }, cutContainers, position, bit);
+        break;
+      }
+    }
+  }
+
   bool nRejectNotPropagatedTracks;
   int nPtMinSel;
   int nPtMaxSel;
@@ -543,6 +619,59 @@ std::array<cutContainerType, 2> FemtoDreamTrackSelection::getCutContainer(T cons
   return {output, outputPID};
 }
 
+template <typename T>
+void FemtoDreamTrackSelection::fillColumns(femtoDreamTrackSelection::TrackColumns& columns, T const& track)
+{
+  auto& variables = columns.variables;
+  const float dcaXY = track.dcaXY();
+  const float dcaZ = track.dcaZ();
+  variables[femtoDreamTrackSelection::kSign].push_back(track.sign());
+  variables[femtoDreamTrackSelection::kpTMin].push_back(track.pt());
+  variables[femtoDreamTrackSelection::kEtaMax].push_back(track.eta());
+  variables[femtoDreamTrackSelection::kTPCnClsMin].push_back(track.tpcNClsFound());
+  variables[femtoDreamTrackSelection::kTPCfClsMin].push_back(track.tpcCrossedRowsOverFindableCls());
+  variables[femtoDreamTrackSelection::kTPCcRowsMin].push_back(track.tpcNClsCrossedRows());
+  variables[femtoDreamTrackSelection::kTPCsClsMax].push_back(track.tpcNClsShared());
+  variables[femtoDreamTrackSelection::kITSnClsMin].push_back(track.itsNCls());
+  variables[femtoDreamTrackSelection::kITSnClsIbMin].push_back(track.itsNClsInnerBarrel());
+  variables[femtoDreamTrackSelection::kDCAxyMax].push_back(dcaXY);
+  variables[femtoDreamTrackSelection::kDCAzMax].push_back(dcaZ);
+  variables[femtoDreamTrackSelection::kDCAMin].push_back(std::sqrt(pow(dcaXY, 2.) + pow(dcaZ, 2.)));
+
+  columns.pidTPC.resize(mPIDspecies.size());
+  columns.pidComb.resize(mPIDspecies.size());
+  for (size_t i = 0; i < mPIDspecies.size(); ++i) {
+    auto pidTPCVal = getNsigmaTPC(track, mPIDspecies[i]) - nSigmaPIDOffsetTPC;
+    auto pidTOFVal = getNsigmaTOF(track, mPIDspecies[i]) - nSigmaPIDOffsetTOF;
+    columns.pidTPC[i].push_back(pidTPCVal);
+    columns.pidComb[i].push_back(std::sqrt(pidTPCVal * pidTPCVal + pidTOFVal * pidTOFVal));
+  }
+}
+
+template <typename cutContainerType>
+void FemtoDreamTrackSelection::getCutContainers(femtoDreamTrackSelection::TrackColumns const& columns, std::vector<std::array<cutContainerType, 2>>& cutContainers)
+{
+  cutContainers.assign(columns.size(), {0, 0});
+  if (cutContainers.empty()) {
+    return;
+  }
+  /// the bits are given in the same order as in getCutContainer
+  size_t counter = 0;
+  size_t counterPID = 0;
+  for (auto& sel : mSelections) {
+    const auto selVariable = sel.getSelectionVariable();
+    if (selVariable == femtoDreamTrackSelection::kPIDnSigmaMax) {
+      for (size_t i = 0; i < mPIDspecies.size(); ++i) {
+        setSelectionBits(sel, columns.pidTPC[i], cutContainers, femtoDreamTrackSelection::kPID, counterPID++);
+        setSelectionBits(sel, columns.pidComb[i], cutContainers, femtoDreamTrackSelection::kPID, counterPID++);
+      }
+    } else {
+      const auto column = selVariable == femtoDreamTrackSelection::kpTMax ? femtoDreamTrackSelection::kpTMin : selVariable;
+      setSelectionBits(sel, columns.variables[column], cutContainers, femtoDreamTrackSelection::kCuts, counter++);
+    }
+  }
+}
+
 template <o2::aod::femtodreamparticle::ParticleType part, o2::aod::femtodreamparticle::TrackType tracktype, typename T>
 void FemtoDreamTrackSelection::fillQA(T const& track)
 {
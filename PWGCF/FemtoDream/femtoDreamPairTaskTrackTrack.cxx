@@ -21,11 +21,13 @@
 #include "Framework/StepTHn.h"
 
 #include "PWGCF/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/FemtoMixingPool.h"
 #include "FemtoDreamParticleHisto.h"
 #include "FemtoDreamEventHisto.h"
 #include "FemtoDreamPairCleaner.h"
 #include "FemtoDreamContainer.h"
 #include "FemtoDreamDetaDphiStar.h"
+#include "FemtoDreamParticleBuffer.h"
 #include "FemtoUtils.h"
 
 using namespace o2;
@@ -105,6 +107,23 @@ struct femtoDreamPairTaskTrackTrack {
   FemtoDreamContainer<femtoDreamContainer::EventType::mixed, femtoDreamContainer::Observable::kstar> mixedEventCont;
   FemtoDreamPairCleaner<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCleaner;
   FemtoDreamDetaDphiStar<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCloseRejection;
+  /// Selected particles of the collisions being paired
+  FemtoDreamParticleBuffer bufferPartsOne;
+  FemtoDreamParticleBuffer bufferPartsTwo;
+  /// Pools of events kept across dataframes for processMixedEventPool
+  struct MixingEvent {
+    FemtoDreamParticleBuffer mPartsOne;
+    FemtoDreamParticleBuffer mPartsTwo;
+    float mMagField = 0.f;
+    int mMult = 0;
+    void clear()
+    {
+      mPartsOne.clear();
+      mPartsTwo.clear();
+    }
+  };
+  o2::analysis::femto::FemtoMixingPool<MixingEvent> mixingPool;
+  MixingEvent mixingEvent;
   /// Histogram output
   HistogramRegistry qaRegistry{"TrackQA", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry resultRegistry{"Correlations", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -132,6 +151,20 @@ struct femtoDreamPairTaskTrackTrack {
 
     vPIDPartOne = ConfPIDPartOne;
     vPIDPartTwo = ConfPIDPartTwo;
+    mixingPool.setDepth(ConfNEventsMix);
+  }
+
+  /// Single particle selection of the particles one or two
+  /// \param part Particle
+  /// \param partName Row of the particle in cfgCutTable
+  /// \param vPID PID selection of the particle
+  template <typename T>
+  bool isSelectedPart(T const& part, const std::string& partName, const std::vector<int>& vPID)
+  {
+    if (part.p() > cfgCutTable->get(partName.c_str(), "MaxP") || part.pt() > cfgCutTable->get(partName.c_str(), "MaxPt")) {
+      return false;
+    }
+    return isFullPIDSelected(part.pidcut(), part.p(), cfgCutTable->get(partName.c_str(), "PIDthr"), vPID, cfgNspecies, kNsigma, cfgCutTable->get(partName.c_str(), "nSigmaTPC"), cfgCutTable->get(partName.c_str(), "nSigmaTPCTOF"));
   }
 
   /// This function processes the same event and takes care of all the histogramming
@@ -150,45 +183,39 @@ struct femtoDreamPairTaskTrackTrack {
     eventHisto.fillQA(col);
     /// Histogramming same event
     for (auto& part : groupPartsOne) {
-      if (part.p() > cfgCutTable->get("PartOne", "MaxP") || part.pt() > cfgCutTable->get("PartOne", "MaxPt")) {
-        continue;
-      }
-      if (!isFullPIDSelected(part.pidcut(), part.p(), cfgCutTable->get("PartOne", "PIDthr"), vPIDPartOne, cfgNspecies, kNsigma, cfgCutTable->get("PartOne", "nSigmaTPC"), cfgCutTable->get("PartOne", "nSigmaTPCTOF"))) {
+      if (!isSelectedPart(part, partNames[0], vPIDPartOne)) {
         continue;
       }
       trackHistoPartOne.fillQA(part);
     }
     if (!ConfIsSame) {
       for (auto& part : groupPartsTwo) {
-        if (part.p() > cfgCutTable->get("PartTwo", "MaxP") || part.pt() > cfgCutTable->get("PartTwo", "MaxPt")) {
-          continue;
-        }
-        if (!isFullPIDSelected(part.pidcut(), part.p(), cfgCutTable->get("PartTwo", "PIDthr"), vPIDPartTwo, cfgNspecies, kNsigma, cfgCutTable->get("PartTwo", "nSigmaTPC"), cfgCutTable->get("PartTwo", "nSigmaTPCTOF"))) {
+        if (!isSelectedPart(part, partNames[1], vPIDPartTwo)) {
           continue;
         }
         trackHistoPartTwo.fillQA(part);
       }
     }
     /// Now build the combinations
-    for (auto& [p1, p2] : combinations(groupPartsOne, groupPartsTwo)) {
-      if (p1.p() > cfgCutTable->get("PartOne", "MaxP") || p1.pt() > cfgCutTable->get("PartOne", "MaxPt") || p2.p() > cfgCutTable->get("PartTwo", "MaxP") || p2.pt() > cfgCutTable->get("PartTwo", "MaxPt")) {
-        continue;
-      }
-      if (!isFullPIDSelected(p1.pidcut(), p1.p(), cfgCutTable->get("PartOne", "PIDthr"), vPIDPartOne, cfgNspecies, kNsigma, cfgCutTable->get("PartOne", "nSigmaTPC"), cfgCutTable->get("PartOne", "nSigmaTPCTOF")) || !isFullPIDSelected(p2.pidcut(), p2.p(), cfgCutTable->get("PartTwo", "PIDthr"), vPIDPartTwo, cfgNspecies, kNsigma, cfgCutTable->get("PartTwo", "nSigmaTPC"), cfgCutTable->get("PartTwo", "nSigmaTPCTOF"))) {
-        continue;
-      }
-
-      if (ConfIsCPR) {
-        if (pairCloseRejection.isClosePair(p1, p2, parts, magFieldTesla)) {
-          continue;
+    /// the single particle selections are applied once per particle, the pairs are those of combinations(groupPartsOne, groupPartsTwo),
+    /// i.e. particle two comes after particle one in the collision
+    bufferPartsOne.fill(groupPartsOne, sameEventCont.getMassOne(), [&](auto const& part) { return isSelectedPart(part, partNames[0], vPIDPartOne); });
+    bufferPartsTwo.fill(groupPartsTwo, sameEventCont.getMassTwo(), [&](auto const& part) { return isSelectedPart(part, partNames[1], vPIDPartTwo); });
+    if (ConfIsCPR) {
+      pairCloseRejection.fillPhiStar(bufferPartsOne, magFieldTesla);
+      pairCloseRejection.fillPhiStar(bufferPartsTwo, magFieldTesla);
+    }
+    for (int i = 0; i < bufferPartsOne.size(); ++i) {
+      const auto& p1 = parts.iteratorAt(bufferPartsOne.mIndex[i]);
+      sameEventCont.setPairs(bufferPartsOne, i, bufferPartsTwo, bufferPartsTwo.firstAfter(bufferPartsOne.mPosition[i]), multCol, [&](int j) {
+        if (ConfIsCPR) {
+          if (pairCloseRejection.isClosePair(bufferPartsOne, i, bufferPartsTwo, j)) {
+            return false;
+          }
         }
-      }
-
-      // track cleaning
-      if (!pairCleaner.isCleanPair(p1, p2, parts)) {
-        continue;
-      }
-      sameEventCont.setPair(p1, p2, multCol);
+        // track cleaning
+        return pairCleaner.isCleanPair(p1, parts.iteratorAt(bufferPartsTwo.mIndex[j]), parts);
+      });
     }
   }
 
@@ -217,25 +244,59 @@ struct femtoDreamPairTaskTrackTrack {
       /// \todo before mixing we should check whether both collisions contain a pair of particles!
       // if (partsOne.size() == 0 || nPart2Evt1 == 0 || nPart1Evt2 == 0 || partsTwo.size() == 0 ) continue;
 
-      for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(groupPartsOne, groupPartsTwo))) {
-        if (p1.p() > cfgCutTable->get("PartOne", "MaxP") || p1.pt() > cfgCutTable->get("PartOne", "MaxPt") || p2.p() > cfgCutTable->get("PartTwo", "MaxP") || p2.pt() > cfgCutTable->get("PartTwo", "MaxPt")) {
-          continue;
-        }
-        if (!isFullPIDSelected(p1.pidcut(), p1.p(), cfgCutTable->get("PartOne", "PIDthr"), vPIDPartOne, cfgNspecies, kNsigma, cfgCutTable->get("PartOne", "nSigmaTPC"), cfgCutTable->get("PartOne", "nSigmaTPCTOF")) || !isFullPIDSelected(p2.pidcut(), p2.p(), cfgCutTable->get("PartTwo", "PIDthr"), vPIDPartTwo, cfgNspecies, kNsigma, cfgCutTable->get("PartTwo", "nSigmaTPC"), cfgCutTable->get("PartTwo", "nSigmaTPCTOF"))) {
-          continue;
-        }
-
-        if (ConfIsCPR) {
-          if (pairCloseRejection.isClosePair(p1, p2, parts, magFieldTesla1)) {
-            continue;
-          }
-        }
-        mixedEventCont.setPair(p1, p2, collision1.multNtrPV());
+      bufferPartsOne.fill(groupPartsOne, mixedEventCont.getMassOne(), [&](auto const& part) { return isSelectedPart(part, partNames[0], vPIDPartOne); });
+      bufferPartsTwo.fill(groupPartsTwo, mixedEventCont.getMassTwo(), [&](auto const& part) { return isSelectedPart(part, partNames[1], vPIDPartTwo); });
+      if (ConfIsCPR) {
+        pairCloseRejection.fillPhiStar(bufferPartsOne, magFieldTesla1);
+        pairCloseRejection.fillPhiStar(bufferPartsTwo, magFieldTesla1);
+      }
+      for (int i = 0; i < bufferPartsOne.size(); ++i) {
+        mixedEventCont.setPairs(bufferPartsOne, i, bufferPartsTwo, 0, collision1.multNtrPV(), [&](int j) {
+          return !(ConfIsCPR && pairCloseRejection.isClosePair(bufferPartsOne, i, bufferPartsTwo, j));
+        });
       }
     }
   }
 
   PROCESS_SWITCH(femtoDreamPairTaskTrackTrack, processMixedEvent, "Enable processing mixed events", true);
+
+  /// This function processes the mixed event with pools of events kept across dataframes
+  /// Each collision is mixed with the last ConfNEventsMix collisions of its mixing bin, which are stored with their selected particles,
+  /// the pairs being the same as in processMixedEvent (particle one from the older collision)
+  void processMixedEventPool(o2::aod::FemtoDreamCollision& col,
+                             o2::aod::FemtoDreamParticles& parts)
+  {
+    const int bin = colBinning.getBin({col.posZ(), col.multV0M()});
+    if (bin < 0) {
+      return;
+    }
+    auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
+    auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
+
+    mixingEvent.mPartsOne.fill(groupPartsOne, mixedEventCont.getMassOne(), [&](auto const& part) { return isSelectedPart(part, partNames[0], vPIDPartOne); });
+    mixingEvent.mPartsTwo.fill(groupPartsTwo, mixedEventCont.getMassTwo(), [&](auto const& part) { return isSelectedPart(part, partNames[1], vPIDPartTwo); });
+    mixingEvent.mMagField = col.magField();
+    mixingEvent.mMult = col.multNtrPV();
+    if (ConfIsCPR) {
+      pairCloseRejection.fillPhiStar(mixingEvent.mPartsOne, mixingEvent.mMagField);
+      pairCloseRejection.fillPhiStar(mixingEvent.mPartsTwo, mixingEvent.mMagField);
+    }
+
+    mixingPool.forEach(bin, [&](MixingEvent const& storedEvent) {
+      if (storedEvent.mMagField != mixingEvent.mMagField) {
+        return;
+      }
+      MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), bin);
+      for (int i = 0; i < storedEvent.mPartsOne.size(); ++i) {
+        mixedEventCont.setPairs(storedEvent.mPartsOne, i, mixingEvent.mPartsTwo, 0, storedEvent.mMult, [&](int j) {
+          return !(ConfIsCPR && pairCloseRejection.isClosePair(storedEvent.mPartsOne, i, mixingEvent.mPartsTwo, j));
+        });
+      }
+    });
+    mixingPool.add(bin, mixingEvent);
+  }
+
+  PROCESS_SWITCH(femtoDreamPairTaskTrackTrack, processMixedEventPool, "Enable processing mixed events with pools kept across dataframes, to be used instead of processMixedEvent", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -111,6 +111,9 @@ struct femtoDreamProducerTask {
   Configurable<bool> ConfRejectITSHitandTOFMissing{"ConfRejectITSHitandTOFMissing", false, "True: reject if neither ITS hit nor TOF timing satisfied"};
 
   FemtoDreamTrackSelection trackCuts;
+  femtoDreamTrackSelection::TrackColumns trackColumns;                                    // selection variables of the tracks of a collision
+  std::vector<std::array<aod::femtodreamparticle::cutContainerType, 2>> trackCutContainers; // bit-wise containers of the tracks of a collision
+  std::vector<bool> trackSelectedMinimal;                                                 // whether the tracks of a collision fulfill the most open selection
   Configurable<std::vector<float>> ConfTrkCharge{FemtoDreamTrackSelection::getSelectionName(femtoDreamTrackSelection::kSign, "ConfTrk"), std::vector<float>{-1, 1}, FemtoDreamTrackSelection::getSelectionHelper(femtoDreamTrackSelection::kSign, "Track selection: ")};
   Configurable<std::vector<float>> ConfTrkPtmin{FemtoDreamTrackSelection::getSelectionName(femtoDreamTrackSelection::kpTMin, "ConfTrk"), std::vector<float>{0.4f, 0.6f, 0.5f}, FemtoDreamTrackSelection::getSelectionHelper(femtoDreamTrackSelection::kpTMin, "Track selection: ")};
   Configurable<std::vector<float>> ConfTrkPtmax{FemtoDreamTrackSelection::getSelectionName(femtoDreamTrackSelection::kpTMax, "ConfTrk"), std::vector<float>{5.4f, 5.6f, 5.5f}, FemtoDreamTrackSelection::getSelectionHelper(femtoDreamTrackSelection::kpTMax, "Track selection: ")};
@@ -380,14 +383,28 @@ struct femtoDreamProducerTask {
     int childIDs[2] = {0, 0};    // these IDs are necessary to keep track of the children
     std::vector<int> tmpIDtrack; // this vector keeps track of the matching of the primary track table row <-> aod::track table global index
 
+    trackColumns.clear();
+    trackSelectedMinimal.clear();
     for (auto& track : tracks) {
       /// if the most open selection criteria are not fulfilled there is no point looking further at the track
-      if (!trackCuts.isSelectedMinimal(track)) {
+      const bool selected = trackCuts.isSelectedMinimal(track);
+      trackSelectedMinimal.push_back(selected);
+      if (!selected) {
         continue;
       }
       trackCuts.fillQA<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::TrackType::kNoChild>(track);
-      // the bit-wise container of the systematic variations is obtained
-      auto cutContainer = trackCuts.getCutContainer<aod::femtodreamparticle::cutContainerType>(track);
+      trackCuts.fillColumns(trackColumns, track);
+    }
+    // the bit-wise containers of the systematic variations are obtained for all the selected tracks at once
+    trackCuts.getCutContainers(trackColumns, trackCutContainers);
+
+    size_t iTrack = 0;
+    size_t iSelected = 0;
+    for (auto& track : tracks) {
+      if (!trackSelectedMinimal[iTrack++]) {
+        continue;
+      }
+      auto const& cutContainer = trackCutContainers[iSelected++];
 
       // now the table is filled
       outputParts(outputCollision.lastIndex(),
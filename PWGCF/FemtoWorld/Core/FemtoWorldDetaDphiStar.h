@@ -18,6 +18,7 @@
 #define FEMTOWORLDDETADPHISTAR_H_
 
 #include "PWGCF/FemtoWorld/DataModel/FemtoWorldDerived.h"
+#include "PWGCF/FemtoWorld/Core/FemtoWorldMath.h"
 
 #include "Framework/HistogramRegistry.h"
 #include <string>
@@ -87,7 +88,7 @@ class FemtoWorldDetaDphiStar
       auto deta = part1.eta() - part2.eta();
       auto dphiAvg = AveragePhiStar(part1, part2, 0);
       histdetadpi[0][0]->Fill(deta, dphiAvg);
-      if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
+      if (FemtoWorldMath::isCloseInDetaDphiStar(deta, dphiAvg, deltaEtaMax, deltaPhiMax)) {
         return true;
       } else {
         histdetadpi[0][1]->Fill(deta, dphiAvg);
@@ -109,7 +110,7 @@ class FemtoWorldDetaDphiStar
         auto deta = part1.eta() - daughter.eta();
         auto dphiAvg = AveragePhiStar(part1, *daughter, i);
         histdetadpi[i][0]->Fill(deta, dphiAvg);
-        if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
+        if (FemtoWorldMath::isCloseInDetaDphiStar(deta, dphiAvg, deltaEtaMax, deltaPhiMax)) {
           pass = true;
         } else {
           histdetadpi[i][1]->Fill(deta, dphiAvg);
@@ -142,7 +143,8 @@ class FemtoWorldDetaDphiStar
   static constexpr o2::aod::femtoworldparticle::ParticleType mPartOneType = partOne; ///< Type of particle 1
   static constexpr o2::aod::femtoworldparticle::ParticleType mPartTwoType = partTwo; ///< Type of particle 2
 
-  static constexpr float tmpRadiiTPC[9] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
+  static constexpr int kNRadii = 9;
+  static constexpr float tmpRadiiTPC[kNRadii] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
 
   static constexpr uint32_t kSignMinusMask = 1;
   static constexpr uint32_t kSignPlusMask = 1 << 1;
@@ -159,10 +161,8 @@ class FemtoWorldDetaDphiStar
   ///  Calculate phi at all required radii stored in tmpRadiiTPC
   /// Magnetic field to be provided in Tesla
   template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  void PhiAtRadiiTPC(const T& part, float* phiStar)
   {
-
-    float phi0 = part.phi();
     // Start: Get the charge from cutcontainer using masks
     float charge = 0.;
     if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
@@ -175,9 +175,8 @@ class FemtoWorldDetaDphiStar
       LOG(fatal) << "FemtoWorldDetaDphiStar: Charge bits are set wrong!";
     }
     // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+    for (int r = 0; r < kNRadii; r++) {
+      phiStar[r] = FemtoWorldMath::getPhiStar(part.phi(), charge, part.pt(), magfield, tmpRadiiTPC[r]);
     }
   }
 
@@ -185,21 +184,16 @@ class FemtoWorldDetaDphiStar
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    const int num = tmpVec1.size();
-    float dPhiAvg = 0;
-    for (int i = 0; i < num; i++) {
-      float dphi = tmpVec1.at(i) - tmpVec2.at(i);
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+    float phiStar1[kNRadii], phiStar2[kNRadii], dphi[kNRadii];
+    PhiAtRadiiTPC(part1, phiStar1);
+    PhiAtRadiiTPC(part2, phiStar2);
+    const float dPhiAvg = FemtoWorldMath::getAverageDphiStar<kNRadii>(phiStar1, phiStar2, dphi);
+    if (plotForEveryRadii) {
+      for (int r = 0; r < kNRadii; r++) {
+        histdetadpiRadii[iHist][r]->Fill(part1.eta() - part2.eta(), dphi[r]);
       }
     }
-    return (dPhiAvg / (float)num);
+    return dPhiAvg;
   }
 };
 
@@ -0,0 +1,166 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoWorldPhiBuilder.h
+/// \brief FemtoWorldPhiBuilder - Pairs the selected kaons into Phi candidates
+
+#ifndef PWGCF_FEMTOWORLD_CORE_FEMTOWORLDPHIBUILDER_H_
+#define PWGCF_FEMTOWORLD_CORE_FEMTOWORLDPHIBUILDER_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace o2::analysis::femtoWorld
+{
+namespace femtoWorldPhiBuilder
+{
+/// Selections passed by a kaon, as first or second daughter of the Phi
+enum KaonFlag : uint8_t {
+  kPartOne = 1 << 0,
+  kPartTwo = 1 << 1
+};
+} // namespace femtoWorldPhiBuilder
+
+/// \class FemtoWorldPhiBuilder
+/// \brief Builds the Phi candidates from the kaons of a collision
+/// The kaons are added once, in the order of the track table, with the selections they pass and their
+/// four-momentum stored in separate arrays. The pairs are then the ones of CombinationsStrictlyUpperIndexPolicy,
+/// with the first kaon passing the selection of the first daughter and the second one that of the second daughter.
+/// The invariant mass of all the pairs of a first kaon is computed in one loop over the arrays, before the
+/// invariant mass window, so that only the candidates inside the window go through the full Phi selection.
+/// \tparam TrackIterator Data type of the track
+template <typename TrackIterator>
+class FemtoWorldPhiBuilder
+{
+ public:
+  /// Phi candidate, with the position of the daughters in the kaon arrays
+  struct Candidate {
+    int iOne;
+    int iTwo;
+    float mass;
+  };
+
+  /// Set the mass hypotheses of the daughters
+  void setDaughterMasses(float massOne, float massTwo)
+  {
+    mMassOne = massOne;
+    mMassTwo = massTwo;
+  }
+
+  /// Set limit for the selection on the invariant mass
+  /// \param lowLimit Lower limit for the invariant mass distribution
+  /// \param upLimit Upper limit for the invariant mass distribution
+  void setInvMassLimits(float lowLimit, float upLimit)
+  {
+    mInvMassLowLimit = lowLimit;
+    mInvMassUpLimit = upLimit;
+  }
+
+  /// Remove the kaons and the candidates of the previous collision
+  void clear()
+  {
+    mTracks.clear();
+    mFlags.clear();
+    mPx.clear();
+    mPy.clear();
+    mPz.clear();
+    mEOne.clear();
+    mETwo.clear();
+    mCandidates.clear();
+  }
+
+  /// Add a kaon, in the order of the track table
+  /// \param track Track of the kaon
+  /// \param flags Bit map of femtoWorldPhiBuilder::KaonFlag, the kaon is ignored if 0
+  void addKaon(TrackIterator const& track, uint8_t flags)
+  {
+    if (flags == 0) {
+      return;
+    }
+    // same four-momentum as TLorentzVector::SetPtEtaPhiM
+    const double pt = track.pt();
+    const double px = pt * std::cos(track.phi());
+    const double py = pt * std::sin(track.phi());
+    const double pz = pt * std::sinh(track.eta());
+    const double p2 = px * px + py * py + pz * pz;
+    mTracks.push_back(track);
+    mFlags.push_back(flags);
+    mPx.push_back(px);
+    mPy.push_back(py);
+    mPz.push_back(pz);
+    mEOne.push_back(std::sqrt(p2 + static_cast<double>(mMassOne) * mMassOne));
+    mETwo.push_back(std::sqrt(p2 + static_cast<double>(mMassTwo) * mMassTwo));
+  }
+
+  /// Build the candidates inside the invariant mass window
+  /// \param fillMassQA Function called with the two daughters and the invariant mass of all the pairs, before the window
+  /// \return Candidates inside the window, in the order of the pairs
+  template <typename F>
+  std::vector<Candidate> const& buildCandidates(F&& fillMassQA)
+  {
+    const int nKaons = mTracks.size();
+    mMasses.resize(nKaons);
+    for (int iOne = 0; iOne < nKaons; ++iOne) {
+      if (!(mFlags[iOne] & femtoWorldPhiBuilder::kPartOne)) {
+        continue;
+      }
+      const double px = mPx[iOne];
+      const double py = mPy[iOne];
+      const double pz = mPz[iOne];
+      const double e = mEOne[iOne];
+      // no condition in this loop, the selection of the second daughter is applied afterwards
+      for (int iTwo = iOne + 1; iTwo < nKaons; ++iTwo) {
+        const double sumPx = px + mPx[iTwo];
+        const double sumPy = py + mPy[iTwo];
+        const double sumPz = pz + mPz[iTwo];
+        const double sumE = e + mETwo[iTwo];
+        mMasses[iTwo] = sumE * sumE - (sumPx * sumPx + sumPy * sumPy + sumPz * sumPz);
+      }
+      for (int iTwo = iOne + 1; iTwo < nKaons; ++iTwo) {
+        if (!(mFlags[iTwo] & femtoWorldPhiBuilder::kPartTwo)) {
+          continue;
+        }
+        // same as TLorentzVector::M
+        const double mass2 = mMasses[iTwo];
+        const float mass = mass2 < 0. ? -std::sqrt(-mass2) : std::sqrt(mass2);
+        fillMassQA(mTracks[iOne], mTracks[iTwo], mass);
+        if (mass < mInvMassLowLimit || mass > mInvMassUpLimit) {
+          continue;
+        }
+        mCandidates.push_back({iOne, iTwo, mass});
+      }
+    }
+    return mCandidates;
+  }
+
+  /// \return Track of the kaon at the given position of the kaon arrays
+  TrackIterator const& getTrack(int iKaon) const { return mTracks[iKaon]; }
+
+ private:
+  float mMassOne = 0.f;               ///< Mass hypothesis of the first daughter
+  float mMassTwo = 0.f;               ///< Mass hypothesis of the second daughter
+  float mInvMassLowLimit = 0.f;       ///< Lower limit of the invariant mass window
+  float mInvMassUpLimit = 0.f;        ///< Upper limit of the invariant mass window
+  std::vector<TrackIterator> mTracks; ///< Tracks of the kaons
+  std::vector<uint8_t> mFlags;        ///< Bit map of femtoWorldPhiBuilder::KaonFlag of the kaons
+  std::vector<double> mPx;            ///< Momentum x of the kaons
+  std::vector<double> mPy;            ///< Momentum y of the kaons
+  std::vector<double> mPz;            ///< Momentum z of the kaons
+  std::vector<double> mEOne;          ///< Energy of the kaons with the mass of the first daughter
+  std::vector<double> mETwo;          ///< Energy of the kaons with the mass of the second daughter
+  std::vector<double> mMasses;        ///< Squared invariant mass of the pairs of the current first daughter
+  std::vector<Candidate> mCandidates; ///< Candidates inside the invariant mass window
+};
+
+} // namespace o2::analysis::femtoWorld
+
+#endif // PWGCF_FEMTOWORLD_CORE_FEMTOWORLDPHIBUILDER_H_
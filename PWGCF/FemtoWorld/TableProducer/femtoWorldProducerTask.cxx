@@ -19,6 +19,7 @@
 #include "PWGCF/FemtoWorld/Core/FemtoWorldTrackSelection.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldV0Selection.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldPhiSelection.h"
+#include "PWGCF/FemtoWorld/Core/FemtoWorldPhiBuilder.h"
 #include "PWGCF/FemtoWorld/DataModel/FemtoWorldDerived.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldPairCleaner.h"
 
@@ -168,6 +169,7 @@ struct femtoWorldProducerTask {
   Configurable<float> ConfNsigmaTPCKaon{"ConfNsigmaTPCKaon", 5.0, "TPC Kaon Sigma for momentum < 0.4"};
   // PHI Candidates
   FemtoWorldPhiSelection PhiCuts;
+  FemtoWorldPhiBuilder<aod::FemtoFullTracks::iterator> phiBuilder; // kaons of the collision, paired into Phi candidates
   Configurable<std::vector<float>> ConfPhiSign{FemtoWorldPhiSelection::getSelectionName(femtoWorldPhiSelection::kPhiSign, "ConfPhi"), std::vector<float>{-1, 1}, FemtoWorldPhiSelection::getSelectionHelper(femtoWorldPhiSelection::kPhiSign, "Phi selection: ")};
   Configurable<std::vector<float>> ConfPhiPtMin{FemtoWorldPhiSelection::getSelectionName(femtoWorldPhiSelection::kpTPhiMin, "ConfPhi"), std::vector<float>{0.3f, 0.4f, 0.5f}, FemtoWorldPhiSelection::getSelectionHelper(femtoWorldPhiSelection::kpTPhiMin, "Phi selection: ")};
   // Configurable<std::vector<float>> ConfDCAPhiDaughMax{FemtoWorldPhiSelection::getSelectionName(femtoWorldPhiSelection::kDCAPhiDaughMax, "ConfPhi"), std::vector<float>{1.2f, 1.5f}, FemtoWorldPhiSelection::getSelectionHelper(femtoWorldPhiSelection::kDCAPhiDaughMax, "Phi selection: ")};
@@ -664,33 +666,43 @@ struct femtoWorldProducerTask {
       Configurable<float> cfgChi2TpcPart2{"cfgChi2TpcPart2", 4.0, "Chi2 / cluster for the TPC track segment for the second particle"};
       Configurable<float> cfgChi2ItsPart2{"cfgChi2ItsPart2", 36.0, "Chi2 / cluster for the ITS track segment for the second particle"};
 
-      for (auto& [p1, p2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
-        if ((p1.trackType() == o2::aod::track::TrackTypeEnum::Run2Tracklet) || (p2.trackType() == o2::aod::track::TrackTypeEnum::Run2Tracklet)) {
-          continue;
-        } else if (p1.globalIndex() == p2.globalIndex()) { // checking not to correlate same particles
-          continue;
-        } else if ((p1.pt() < cfgPtLowPart1) || (p1.pt() > cfgPtHighPart1)) { // pT cuts for part1
-          continue;
-        } else if ((p1.p() < cfgPLowPart1) || (p1.p() > cfgPHighPart1)) { // p cuts for part1
-          continue;
-        } else if ((p1.eta() < cfgEtaLowPart1) || (p1.eta() > cfgEtaHighPart1)) { // eta cuts for part1
-          continue;
-        } else if ((p2.pt() < cfgPtLowPart2) || (p2.pt() > cfgPtHighPart2)) { // pT cuts for part2
-          continue;
-        } else if ((p2.p() < cfgPLowPart2) || (p2.p() > cfgPHighPart2)) { // p cuts for part2
-          continue;
-        } else if ((p2.eta() < cfgEtaLowPart2) || (p2.eta() > cfgEtaHighPart2)) { // eta for part2
-          continue;
-        } else if (!(IsKaonNSigma(p1.p(), p1.tpcNSigmaKa(), p1.tofNSigmaKa()))) { // PID for Kaons
+      float mMassOne = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartOne)->Mass();
+      float mMassTwo = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartTwo)->Mass();
+      phiBuilder.clear();
+      phiBuilder.setDaughterMasses(mMassOne, mMassTwo);
+      phiBuilder.setInvMassLimits(ConfInvMassLowLimitPhi, ConfInvMassUpLimitPhi);
+
+      // the kaons are selected once, as first and as second daughter, for all their pairs
+      for (auto& track : tracks) {
+        if (track.trackType() == o2::aod::track::TrackTypeEnum::Run2Tracklet) {
           continue;
-        } else if (!(IsKaonNSigma(p2.p(), p2.tpcNSigmaKa(), p2.tofNSigmaKa()))) {
+        } else if (!(IsKaonNSigma(track.p(), track.tpcNSigmaKa(), track.tofNSigmaKa()))) { // PID for Kaons
           continue;
         }
+        uint8_t kaonFlags = 0;
+        if ((track.pt() >= cfgPtLowPart1) && (track.pt() <= cfgPtHighPart1) &&     // pT cuts for part1
+            (track.p() >= cfgPLowPart1) && (track.p() <= cfgPHighPart1) &&         // p cuts for part1
+            (track.eta() >= cfgEtaLowPart1) && (track.eta() <= cfgEtaHighPart1)) { // eta cuts for part1
+          kaonFlags |= femtoWorldPhiBuilder::kPartOne;
+        }
+        if ((track.pt() >= cfgPtLowPart2) && (track.pt() <= cfgPtHighPart2) &&     // pT cuts for part2
+            (track.p() >= cfgPLowPart2) && (track.p() <= cfgPHighPart2) &&         // p cuts for part2
+            (track.eta() >= cfgEtaLowPart2) && (track.eta() <= cfgEtaHighPart2)) { // eta cuts for part2
+          kaonFlags |= femtoWorldPhiBuilder::kPartTwo;
+        }
+        phiBuilder.addKaon(track, kaonFlags);
+      }
+
+      auto const& phiCandidates = phiBuilder.buildCandidates([&](auto const& p1, auto const& p2, float phiM) {
+        PhiCuts.fillPhiQAMass(col, phiM, p1, p2, ConfInvMassLowLimitPhi, ConfInvMassUpLimitPhi);
+      });
+
+      for (auto const& phiCandidate : phiCandidates) {
+        auto const& p1 = phiBuilder.getTrack(phiCandidate.iOne);
+        auto const& p2 = phiBuilder.getTrack(phiCandidate.iTwo);
 
         TLorentzVector part1Vec;
         TLorentzVector part2Vec;
-        float mMassOne = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartOne)->Mass();
-        float mMassTwo = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartTwo)->Mass();
 
         part1Vec.SetPtEtaPhiM(p1.pt(), p1.eta(), p1.phi(), mMassOne);
         part2Vec.SetPtEtaPhiM(p2.pt(), p2.eta(), p2.phi(), mMassTwo);
@@ -702,13 +714,7 @@ struct femtoWorldProducerTask {
         float phiPhi = sumVec.Phi(); // change needed
         float phiPt = sumVec.Pt();
         float phiP = sumVec.P();
-        float phiM = sumVec.M();
-
-        PhiCuts.fillPhiQAMass(col, phiM, p1, p2, ConfInvMassLowLimitPhi, ConfInvMassUpLimitPhi);
-
-        if (((phiM < ConfInvMassLowLimitPhi) || (phiM > ConfInvMassUpLimitPhi))) {
-          continue;
-        }
+        float phiM = phiCandidate.mass;
 
         PhiCuts.fillQA<aod::femtoworldparticle::ParticleType::kPhi, aod::femtoworldparticle::ParticleType::kPhiChild>(col, p1, p1, p2); ///\todo fill QA also for daughters
         auto cutContainerV0 = PhiCuts.getCutContainer<aod::femtoworldparticle::cutContainerType>(col, p1, p2);
@@ -28,6 +28,7 @@
 #include "PWGCF/FemtoWorld/Core/FemtoWorldContainer.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldDetaDphiStar.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldUtils.h"
+#include "PWGCF/Core/FemtoMixingPool.h"
 
 using namespace o2;
 using namespace o2::analysis::femtoWorld;
@@ -156,6 +157,9 @@ struct femtoWorldPairTaskTrackTrack {
   FemtoWorldContainer<femtoWorldContainer::EventType::mixed, femtoWorldContainer::Observable::kstar> mixedEventCont;
   FemtoWorldPairCleaner<aod::femtoworldparticle::ParticleType::kTrack, aod::femtoworldparticle::ParticleType::kTrack> pairCleaner;
   FemtoWorldDetaDphiStar<aod::femtoworldparticle::ParticleType::kTrack, aod::femtoworldparticle::ParticleType::kTrack> pairCloseRejection;
+  /// Pools of events kept across dataframes for processMixedEventPool
+  o2::analysis::femto::FemtoMixingPool<> mixingPool;
+  o2::analysis::femto::FemtoMixingEvent mixingEvent;
   /// Histogram output
   HistogramRegistry qaRegistry{"TrackQA", {}, OutputObjHandlingPolicy::AnalysisObject};
   // HistogramRegistry qaRegistryFail{"TrackQAFailed", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -186,6 +190,7 @@ struct femtoWorldPairTaskTrackTrack {
 
     vPIDPartOne = ConfPIDPartOne;
     vPIDPartTwo = ConfPIDPartTwo;
+    mixingPool.setDepth(ConfNEventsMix);
   }
 
   // PID
@@ -332,6 +337,53 @@ struct femtoWorldPairTaskTrackTrack {
   }
 
   PROCESS_SWITCH(femtoWorldPairTaskTrackTrack, processMixedEvent, "Enable processing mixed events", true);
+
+  /// This function processes the mixed event with pools of events kept across dataframes
+  /// Each collision is mixed with the last ConfNEventsMix collisions of its mixing bin, which are stored with compact copies of their selected particles,
+  /// the pairs being the same as in processMixedEvent (particle one from the older collision)
+  void processMixedEventPool(o2::aod::FemtoWorldCollision& col,
+                             o2::aod::FemtoWorldParticlesMerged& parts)
+  {
+    const int bin = colBinning.getBin({col.posZ(), col.multV0M()});
+    if (bin < 0) {
+      return;
+    }
+    auto groupPartsOne = partsOne->sliceByCached(aod::femtoworldparticle::femtoWorldCollisionId, col.globalIndex());
+    auto groupPartsTwo = partsTwo->sliceByCached(aod::femtoworldparticle::femtoWorldCollisionId, col.globalIndex());
+
+    for (auto& part : groupPartsOne) {
+      if (IsKaonNSigma(part.p(), part.tpcNSigmaKa(), part.tofNSigmaKa())) {
+        mixingEvent.mPartsOne.push_back(o2::analysis::femto::FemtoMixingParticle::from(part));
+      }
+    }
+    for (auto& part : groupPartsTwo) {
+      if (IsKaonNSigma(part.p(), part.tpcNSigmaKa(), part.tofNSigmaKa())) {
+        mixingEvent.mPartsTwo.push_back(o2::analysis::femto::FemtoMixingParticle::from(part));
+      }
+    }
+    mixingEvent.mMagField = col.magField();
+    mixingEvent.mMult = col.multV0M();
+
+    mixingPool.forEach(bin, [&](o2::analysis::femto::FemtoMixingEvent const& storedEvent) {
+      if (storedEvent.mMagField != mixingEvent.mMagField) {
+        return;
+      }
+      MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), bin);
+      for (auto const& p1 : storedEvent.mPartsOne) {
+        for (auto const& p2 : mixingEvent.mPartsTwo) {
+          if (ConfIsCPR) {
+            if (pairCloseRejection.isClosePair(p1, p2, parts, mixingEvent.mMagField)) {
+              continue;
+            }
+          }
+          mixedEventCont.setPair(p1, p2, storedEvent.mMult);
+        }
+      }
+    });
+    mixingPool.add(bin, mixingEvent);
+  }
+
+  PROCESS_SWITCH(femtoWorldPairTaskTrackTrack, processMixedEventPool, "Enable processing mixed events with pools kept across dataframes, to be used instead of processMixedEvent", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
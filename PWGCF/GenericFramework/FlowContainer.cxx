@@ -25,7 +25,9 @@ FlowContainer::FlowContainer() : TNamed("", ""),
                                  fXAxis(0),
                                  fNbinsPt(0),
                                  fbinsPt(0),
-                                 fPropagateErrors(kFALSE){};
+                                 fPropagateErrors(kFALSE),
+                                 fSubSums(),
+                                 fCompactSubsamples(kFALSE){};
 FlowContainer::FlowContainer(const char* name) : TNamed(name, name),
                                                  fProf(0),
                                                  fProfRand(0),
@@ -38,7 +40,9 @@ FlowContainer::FlowContainer(const char* name) : TNamed(name, name),
                                                  fXAxis(0),
                                                  fNbinsPt(0),
                                                  fbinsPt(0),
-                                                 fPropagateErrors(kFALSE){};
+                                                 fPropagateErrors(kFALSE),
+                                                 fSubSums(),
+                                                 fCompactSubsamples(kFALSE){};
 FlowContainer::~FlowContainer()
 {
   delete fProf;
@@ -66,7 +70,10 @@ void FlowContainer::Initialize(TObjArray* inputList, const o2::framework::AxisSp
   for (int i = 0; i < inputList->GetEntries(); i++)
     fProf->GetYaxis()->SetBinLabel(i + 1, inputList->At(i)->GetName());
   fProf->Sumw2();
-  if (nRandom) {
+  if (nRandom && fCompactSubsamples) {
+    fNRandom = nRandom;
+    fSubSums.assign((size_t)nRandom * fProf->GetNbinsY() * (fProf->GetNbinsX() + 2) * 4, 0.);
+  } else if (nRandom) {
     fNRandom = nRandom;
     fProfRand = new TObjArray();
     fProfRand->SetOwner(kTRUE);
@@ -91,7 +98,10 @@ void FlowContainer::Initialize(TObjArray* inputList, int nMultiBins, double Mult
   fProf->Sumw2();
   for (int i = 0; i < inputList->GetEntries(); i++)
     fProf->GetYaxis()->SetBinLabel(i + 1, inputList->At(i)->GetName());
-  if (nRandom) {
+  if (nRandom && fCompactSubsamples) {
+    fNRandom = nRandom;
+    fSubSums.assign((size_t)nRandom * fProf->GetNbinsY() * (fProf->GetNbinsX() + 2) * 4, 0.);
+  } else if (nRandom) {
     fNRandom = nRandom;
     fProfRand = new TObjArray();
     fProfRand->SetOwner(kTRUE);
@@ -142,10 +152,27 @@ int FlowContainer::FillProfile(const char* hname, double multi, double corr, dou
     printf("Could not find bin %s\n", hname);
     return -1;
   };
+  return FillProfile(yin, multi, corr, w, rn);
+};
+int FlowContainer::FillProfile(int yin, double multi, double corr, double w, double rn)
+{
+  if (!fProf)
+    return -1;
+  if (yin < 1 || yin > fProf->GetNbinsY())
+    return -1;
   fProf->Fill(multi, yin, corr, w);
   if (fNRandom) {
-    double rnind = rn * fNRandom;
-    ((TProfile2D*)fProfRand->At((int)rnind))->Fill(multi, yin, corr, w);
+    int rnind = (int)(rn * fNRandom);
+    if (fProfRand) {
+      ((TProfile2D*)fProfRand->At(rnind))->Fill(multi, yin, corr, w);
+    } else if (!fSubSums.empty()) {
+      // same sums as TProfile2D::Fill
+      double* lSums = &fSubSums[GetSubSumIndex(rnind, yin, fProf->GetXaxis()->FindBin(multi))];
+      lSums[0] += w;
+      lSums[1] += w * corr;
+      lSums[2] += w * corr * corr;
+      lSums[3] += w * w;
+    };
   };
   return 0;
 };
@@ -183,6 +210,37 @@ void FlowContainer::OverrideProfileErrors(TProfile2D* inpf)
     }
   }
 }
+void FlowContainer::CreateSubProfiles()
+{
+  if (fProfRand || fSubSums.empty() || !fProf)
+    return;
+  int nBinsX = fProf->GetNbinsX();
+  int nBinsY = fProf->GetNbinsY();
+  int nSamples = fSubSums.size() / (4 * nBinsY * (nBinsX + 2));
+  fProfRand = new TObjArray();
+  fProfRand->SetOwner(kTRUE);
+  for (int i = 0; i < nSamples; i++) {
+    TProfile2D* tarprof = (TProfile2D*)fProf->Clone(Form("%s_Rand_%i", fProf->GetName(), i));
+    tarprof->SetDirectory(0);
+    tarprof->Reset();
+    if (!tarprof->GetBinSumw2()->fArray)
+      tarprof->Sumw2();
+    double lEntries = 0;
+    for (int iy = 1; iy <= nBinsY; iy++)
+      for (int ix = 0; ix <= nBinsX + 1; ix++) {
+        const double* lSums = &fSubSums[GetSubSumIndex(i, iy, ix)];
+        int binno = tarprof->GetBin(ix, iy);
+        tarprof->SetBinEntries(binno, lSums[0]);
+        tarprof->fArray[binno] = lSums[1];
+        tarprof->GetSumw2()->fArray[binno] = lSums[2];
+        tarprof->GetBinSumw2()->fArray[binno] = lSums[3];
+        lEntries += lSums[0];
+      };
+    tarprof->SetEntries(lEntries);
+    fProfRand->Add(tarprof);
+  };
+  fSubSums.clear();
+};
 Long64_t FlowContainer::Merge(TCollection* collist)
 {
   Long64_t nmerged = 0;
@@ -197,6 +255,15 @@ Long64_t FlowContainer::Merge(TCollection* collist)
     } else
       tpro->Add(spro);
     nmerged++;
+    // Compact subsamples with the same layout are merged directly
+    if (!fProfRand && !l_FC->fProfRand && !l_FC->fSubSums.empty() && (!tpro || fSubSums.size() == l_FC->fSubSums.size())) {
+      if (fSubSums.empty())
+        fSubSums.assign(l_FC->fSubSums.size(), 0.);
+      for (size_t i = 0; i < fSubSums.size(); i++)
+        fSubSums[i] += l_FC->fSubSums[i];
+      continue;
+    };
+    GetSubProfiles(); // otherwise, the profiles of this container are needed
     TObjArray* tarr = l_FC->GetSubProfiles();
     if (!tarr)
       continue;
@@ -253,6 +320,7 @@ void FlowContainer::PickAndMerge(TFile* tfi)
     fProf->SetDirectory(0);
   } else
     tpro->Add(spro);
+  GetSubProfiles();
   TObjArray* tarr = lfc->GetSubProfiles();
   if (!tarr) {
     return;
@@ -283,7 +351,7 @@ bool FlowContainer::OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2)
 }
 bool FlowContainer::OverrideMainWithSub(int ind, bool ExcludeChosen)
 {
-  if (!fProfRand) {
+  if (!GetSubProfiles()) {
     printf("Cannot override main profile with a randomized one. Random profile array does not exist.\n");
     return kFALSE;
   };
@@ -315,7 +383,7 @@ bool FlowContainer::OverrideMainWithSub(int ind, bool ExcludeChosen)
 };
 bool FlowContainer::RandomizeProfile(int nSubsets)
 {
-  if (!fProfRand) {
+  if (!GetSubProfiles()) {
     printf("Cannot randomize profile, random array does not exist.\n");
     return kFALSE;
   };
@@ -386,44 +454,69 @@ TProfile* FlowContainer::GetCorrXXVsMulti(const char* order, int l_pti)
 };
 TProfile* FlowContainer::GetCorrXXVsPt(const char* order, double lminmulti, double lmaxmulti)
 {
-  int minm = 1;
-  int maxm = fProf->GetXaxis()->GetNbins();
+  return GetCorrXXVsPt(std::vector<TString>{order}, std::vector<std::pair<double, double>>{{lminmulti, lmaxmulti}}).front();
+};
+std::vector<TProfile*> FlowContainer::GetCorrXXVsPt(const std::vector<TString>& orders, const std::vector<std::pair<double, double>>& multiRanges)
+{
   if (!fbinsPt)
     SetXAxis();
-  if (lminmulti > 0) {
-    minm = fProf->GetXaxis()->FindBin(lminmulti + 0.001);
-    maxm = minm;
+  std::vector<std::pair<int, int>> multiBins;
+  for (const auto& multiRange : multiRanges) {
+    int minm = 1;
+    int maxm = fProf->GetXaxis()->GetNbins();
+    if (multiRange.first > 0) {
+      minm = fProf->GetXaxis()->FindBin(multiRange.first + 0.001);
+      maxm = minm;
+    };
+    if (multiRange.second > multiRange.first)
+      maxm = fProf->GetXaxis()->FindBin(multiRange.second - 0.001);
+    multiBins.push_back({minm, maxm});
   };
-  if (lmaxmulti > lminmulti)
-    maxm = fProf->GetXaxis()->FindBin(lmaxmulti - 0.001);
-  ProfileSubset* rhProfSub = new ProfileSubset(*fProf);
-  TProfile* retSubset = 0;
-  TString l_name("");
-  Ssiz_t l_pos = 0;
-  while (fIDName.Tokenize(l_name, l_pos)) {
-    TString ybl1(Form("%s%s_pt_1", l_name.Data(), order));
-    TString ybl2(Form("%s%s_pt_%i", l_name.Data(), order, fNbinsPt));
-    int ybn1 = fProf->GetYaxis()->FindBin(ybl1.Data());
-    int ybn2 = fProf->GetYaxis()->FindBin(ybl2.Data());
-    rhProfSub->GetYaxis()->SetRange(ybn1, ybn2);
-    TProfile* tempprof = rhProfSub->GetSubset(kFALSE, "tempprof", minm, maxm, fNbinsPt, fbinsPt);
-    if (!retSubset) {
-      TString profname = Form("%s_MultiB_%i_%i", order, minm, maxm);
-      retSubset = (TProfile*)tempprof->Clone(profname.Data());
-    } else
-      retSubset->Add(tempprof);
-    delete tempprof;
+  // one range per order, multi. range and name in fIDName, all projected together
+  std::vector<ProfileSubset::SubsetRange> ranges;
+  int nNames = 0;
+  for (const auto& order : orders) {
+    for (const auto& multiBin : multiBins) {
+      TString l_name("");
+      Ssiz_t l_pos = 0;
+      nNames = 0;
+      while (fIDName.Tokenize(l_name, l_pos)) {
+        TString ybl1(Form("%s%s_pt_1", l_name.Data(), order.Data()));
+        TString ybl2(Form("%s%s_pt_%i", l_name.Data(), order.Data(), fNbinsPt));
+        int ybn1 = fProf->GetYaxis()->FindBin(ybl1.Data());
+        int ybn2 = fProf->GetYaxis()->FindBin(ybl2.Data());
+        ranges.push_back({multiBin.first, multiBin.second, ybn1, ybn2});
+        nNames++;
+      };
+    };
   };
-  delete rhProfSub;
-  if (fPtRebinEdges) {
-    TString pnbu(retSubset->GetName());
-    retSubset->SetName("TempName");
-    TProfile* tempprof = (TProfile*)retSubset->Rebin(fPtRebin, pnbu.Data(), fPtRebinEdges);
-    delete retSubset;
-    retSubset = tempprof;
-  } else
-    retSubset->RebinX(fPtRebin);
-  return retSubset;
+  std::vector<TProfile*> subsets = ProfileSubset::GetSubsets(fProf, kFALSE, "tempprof", ranges, fNbinsPt, fbinsPt);
+  std::vector<TProfile*> retSubsets;
+  size_t iSubset = 0;
+  for (const auto& order : orders) {
+    for (const auto& multiBin : multiBins) {
+      TProfile* retSubset = 0;
+      for (int i = 0; i < nNames; i++) {
+        TProfile* tempprof = subsets[iSubset++];
+        if (!retSubset) {
+          TString profname = Form("%s_MultiB_%i_%i", order.Data(), multiBin.first, multiBin.second);
+          retSubset = (TProfile*)tempprof->Clone(profname.Data());
+        } else
+          retSubset->Add(tempprof);
+        delete tempprof;
+      };
+      if (fPtRebinEdges) {
+        TString pnbu(retSubset->GetName());
+        retSubset->SetName("TempName");
+        TProfile* tempprof = (TProfile*)retSubset->Rebin(fPtRebin, pnbu.Data(), fPtRebinEdges);
+        delete retSubset;
+        retSubset = tempprof;
+      } else
+        retSubset->RebinX(fPtRebin);
+      retSubsets.push_back(retSubset);
+    };
+  };
+  return retSubsets;
 };
 TH1D* FlowContainer::ProfToHist(TProfile* inpf)
 {
@@ -893,19 +986,20 @@ TProfile* FlowContainer::GetRefFlowProfile(const char* order, double m1, double
   TProfile* retpf = 0;
   TString l_name("");
   Ssiz_t l_pos = 0;
-  ProfileSubset* rhSubset = new ProfileSubset(*fProf);
-  rhSubset->GetXaxis()->SetRange(nStartBin, nStopBin);
+  std::vector<ProfileSubset::SubsetRange> ranges;
   while (fIDName.Tokenize(l_name, l_pos)) {
     l_name.Append(order);
     int ybin = fProf->GetYaxis()->FindBin(l_name.Data());
-    TProfile* tempprof = rhSubset->GetSubset(kTRUE, "tempprof", ybin, ybin, nBins, l_bins);
+    ranges.push_back({ybin, ybin, nStartBin, nStopBin});
+  };
+  for (TProfile* tempprof : ProfileSubset::GetSubsets(fProf, kTRUE, "tempprof", ranges, nBins, l_bins)) {
     if (!retpf)
       retpf = (TProfile*)tempprof->Clone("RefFlowProf");
     else
       retpf->Add(tempprof);
     delete tempprof;
   };
-  delete rhSubset;
+  delete[] l_bins;
   retpf->RebinX(nBins);
   return retpf;
 };
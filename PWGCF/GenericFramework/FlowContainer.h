@@ -27,6 +27,8 @@
 #include "TAxis.h"
 #include "ProfileSubset.h"
 #include "Framework/HistogramSpec.h"
+#include <utility>
+#include <vector>
 
 class FlowContainer : public TNamed
 {
@@ -50,6 +52,12 @@ class FlowContainer : public TNamed
   int GetNMultiBins() { return fProf->GetNbinsX(); };
   double GetMultiAtBin(int bin) { return fProf->GetXaxis()->GetBinCenter(bin); };
   int FillProfile(const char* hname, double multi, double y, double w, double rn);
+  // Same as above, with the correlator given by its index from GetCorrelatorIndex, which avoids the lookup by name
+  int FillProfile(int corrIndex, double multi, double y, double w, double rn);
+  int GetCorrelatorIndex(const char* hname) { return fProf ? fProf->GetYaxis()->FindBin(hname) : 0; };
+  // Compact subsamples: to be set before Initialize. The subsample sums (sum w, sum wy, sum wy^2, sum w^2) are kept in one array
+  // instead of one TProfile2D per subsample, and the subsample profiles are only created when first requested (GetSubProfiles, etc.)
+  void SetCompactSubsamples(bool newval) { fCompactSubsamples = newval; };
   TProfile2D* GetProfile() { return fProf; };
   void OverrideProfileErrors(TProfile2D* inpf);
   void ReadAndMerge(const char* infile);
@@ -58,7 +66,12 @@ class FlowContainer : public TNamed
   bool OverrideMainWithSub(int subind, bool ExcludeChosen);
   bool RandomizeProfile(int nSubsets = 0);
   bool CreateStatisticsProfile(StatisticsType StatType, int arg);
-  TObjArray* GetSubProfiles() { return fProfRand; };
+  TObjArray* GetSubProfiles()
+  {
+    if (!fProfRand && !fSubSums.empty())
+      CreateSubProfiles();
+    return fProfRand;
+  };
   Long64_t Merge(TCollection* collist);
   void SetIDName(TString newname); //! do not store
   void SetPtRebin(int newval) { fPtRebin = newval; };
@@ -68,6 +81,8 @@ class FlowContainer : public TNamed
   void SetPropagateErrors(bool newval) { fPropagateErrors = newval; };
   TProfile* GetCorrXXVsMulti(const char* order, int l_pti = 0);                             // pti = 0 for pt-integrated
   TProfile* GetCorrXXVsPt(const char* order, double lminmulti = -1, double lmaxmulti = -1); // 0 for multi. integrated
+  // Same as above for all the orders and multi. ranges, from a single pass over the bins of the profile; [order][multi. range], owned by the caller
+  std::vector<TProfile*> GetCorrXXVsPt(const std::vector<TString>& orders, const std::vector<std::pair<double, double>>& multiRanges);
   TH1D* GetHistCorrXXVsMulti(const char* order, int l_pti = 0);                             // pti = 0 for pt-integrated
   TH1D* GetHistCorrXXVsPt(const char* order, double lminmulti = -1, double lmaxmulti = -1); // 0 for multi. integrated
 
@@ -162,7 +177,11 @@ class FlowContainer : public TNamed
   double* fbinsPt;       //! Do not store; stored in fXAxis
   bool fPropagateErrors; //! do not store
   TProfile* GetRefFlowProfile(const char* order, double m1 = -1, double m2 = -1);
-  ClassDef(FlowContainer, 2);
+  std::vector<double> fSubSums; // Compact subsample sums, [subsample][correlator][multi. bin incl. under/overflow][sum w, sum wy, sum wy^2, sum w^2]
+  bool fCompactSubsamples;      //! do not store
+  int GetSubSumIndex(int sample, int yin, int xin) { return ((sample * fProf->GetNbinsY() + yin - 1) * (fProf->GetNbinsX() + 2) + xin) * 4; };
+  void CreateSubProfiles();
+  ClassDef(FlowContainer, 3);
 };
 
 #endif
\ No newline at end of file
@@ -10,7 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include "GFW.h"
-GFW::GFW() : fInitialized(kFALSE){};
+GFW::GFW() : fInitialized(kFALSE), fPlanEvent(1), fPlanNPt(1){};
 
 GFW::~GFW()
 {
@@ -108,6 +108,31 @@ void GFW::Fill(double eta, int ptin, double phi, double weight, int mask, double
       fCumulants.at(i).FillArray(eta, ptin, phi, weight, SecondWeight);
   };
 };
+void GFW::Fill(int nPart, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* secondWeight)
+{
+  if (!fInitialized)
+    CreateRegions();
+  if (!fInitialized)
+    return;
+  for (int i = 0; i < (int)fRegions.size(); ++i) {
+    const Region& lRegion = fRegions.at(i);
+    fBatchEta.clear();
+    fBatchPt.clear();
+    fBatchPhi.clear();
+    fBatchWeight.clear();
+    fBatchSecondWeight.clear();
+    for (int j = 0; j < nPart; ++j) {
+      if (lRegion.EtaMin < eta[j] && lRegion.EtaMax > eta[j] && (lRegion.BitMask & mask[j])) {
+        fBatchEta.push_back(eta[j]);
+        fBatchPt.push_back(ptin[j]);
+        fBatchPhi.push_back(phi[j]);
+        fBatchWeight.push_back(weight[j]);
+        fBatchSecondWeight.push_back(secondWeight ? secondWeight[j] : -1);
+      };
+    };
+    fCumulants.at(i).FillArray(fBatchEta.size(), fBatchEta.data(), fBatchPt.data(), fBatchPhi.data(), fBatchWeight.data(), fBatchSecondWeight.data());
+  };
+};
 TComplex GFW::TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant* r1, GFWCumulant* r2, GFWCumulant* r3)
 {
   TComplex part1 = r1->Vec(n1, p1, ptbin);
@@ -174,6 +199,47 @@ void GFW::Clear()
     ptr->ResetQs();
   fCalculatedNames.clear();
   fCalculatedQs.clear();
+  if (++fPlanEvent == 0) { // stamps wrapped around, invalidate all the stored values
+    fPlanStamps.assign(fPlanStamps.size(), 0);
+    fPlanEvent = 1;
+  };
+};
+void GFW::GetQvectors(vector<double>& re, vector<double>& im, vector<int>& nEntries)
+{
+  re.clear();
+  im.clear();
+  nEntries.clear();
+  if (!fInitialized)
+    CreateRegions();
+  for (auto& lCumulant : fCumulants) {
+    re.insert(re.end(), lCumulant.fQRe.begin(), lCumulant.fQRe.end());
+    im.insert(im.end(), lCumulant.fQIm.begin(), lCumulant.fQIm.end());
+    nEntries.push_back(std::max(lCumulant.GetN(), 0));
+  };
+};
+bool GFW::SetQvectors(const vector<double>& re, const vector<double>& im, const vector<int>& nEntries)
+{
+  if (!fInitialized)
+    CreateRegions();
+  Clear();
+  size_t lSize = 0;
+  for (auto& lCumulant : fCumulants)
+    lSize += lCumulant.fQRe.size();
+  if (re.size() != lSize || im.size() != lSize || nEntries.size() != fCumulants.size()) {
+    printf("Q-vectors of %zu regions and size %zu do not match the %zu regions and size %zu of this GFW!\n", nEntries.size(), re.size(), fCumulants.size(), lSize);
+    return kFALSE;
+  };
+  size_t lOffset = 0;
+  for (size_t i = 0; i < fCumulants.size(); ++i) {
+    GFWCumulant& lCumulant = fCumulants[i];
+    const size_t lCumSize = lCumulant.fQRe.size();
+    std::copy(re.begin() + lOffset, re.begin() + lOffset + lCumSize, lCumulant.fQRe.begin());
+    std::copy(im.begin() + lOffset, im.begin() + lOffset + lCumSize, lCumulant.fQIm.begin());
+    std::fill(lCumulant.fFilledPts.begin(), lCumulant.fFilledPts.end(), nEntries[i] > 0);
+    lCumulant.fNEntries = nEntries[i];
+    lOffset += lCumSize;
+  };
+  return kTRUE;
 };
 TComplex GFW::Calculate(TString config, bool SetHarmsToZero)
 {
@@ -326,7 +392,6 @@ TComplex GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero, bool
     // picking up the indecies of regions...
     int poi = corconf.Regs.at(i).at(0);
     int ref = (corconf.Regs.at(i).size() > 1) ? corconf.Regs.at(i).at(1) : corconf.Regs.at(i).at(0);
-    int ovl = corconf.Overlap.at(i);
     // and regions themselves
     GFWCumulant* qref = &fCumulants.at(ref);
     GFWCumulant* qpoi = &fCumulants.at(poi);
@@ -334,26 +399,127 @@ TComplex GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero, bool
       return TComplex(0, 0); // if REF is not filled, don't even continue. Could be redundant, but should save little CPU time
     if (!qpoi->IsPtBinFilled(ptbin))
       return TComplex(0, 0); // if POI is not filled, don't even continue. Could be redundant, but should save little CPU time
-    GFWCumulant* qovl = 0;
     // Check if in the ref. region we have enough particles (no. of particles in the region >= no of harmonics for subevent)
     int sz1 = corconf.Hars.at(i).size();
     if (poi != ref)
       sz1--;
     if (qref->GetN() < sz1)
       return TComplex(0, 0);
-    // Then, figure the overlap
-    if (ovl > -1) // if overlap is defined, then (unless it's explicitly disabled)
-      qovl = DisableOverlap ? 0 : &fCumulants.at(ovl);
-    else if (ref == poi)
-      qovl = qref; // If ref and poi are the same, then the same is for overlap. Only, when OL not explicitly defined
-    if (SetHarmsToZero)
-      for (int j = 0; j < (int)corconf.Hars.at(i).size(); j++)
-        corconf.Hars.at(i).at(j) = 0;
-    retval *= RecursiveCorr(qpoi, qref, qovl, ptbin, corconf.Hars.at(i));
+    retval *= EvaluatePlan(GetPlanNode(corconf, i, SetHarmsToZero, DisableOverlap), ptbin);
   }
   return retval;
 };
 
+void GFW::BuildPlan(const vector<CorrConfig>& configs)
+{
+  // Both the correlators and their weights (harmonics set to zero) are needed
+  for (auto& corconf : configs)
+    for (int i = 0; i < (int)corconf.Regs.size(); i++) {
+      if (corconf.Regs.at(i).size() == 0)
+        break;
+      GetPlanNode(corconf, i, kFALSE, kFALSE);
+      GetPlanNode(corconf, i, kTRUE, kFALSE);
+    };
+};
+int GFW::GetPlanNode(const CorrConfig& corconf, int subevent, bool SetHarmsToZero, bool DisableOverlap)
+{
+  int poi = corconf.Regs.at(subevent).at(0);
+  int ref = (corconf.Regs.at(subevent).size() > 1) ? corconf.Regs.at(subevent).at(1) : corconf.Regs.at(subevent).at(0);
+  int ovl = corconf.Overlap.at(subevent);
+  // Same overlap logic as in Calculate: explicit overlap (unless disabled), otherwise ref. if ref and poi are the same
+  if (ovl > -1)
+    ovl = DisableOverlap ? -1 : ovl;
+  else if (ref == poi)
+    ovl = ref;
+  fPlanHars = corconf.Hars.at(subevent);
+  if (SetHarmsToZero)
+    fPlanHars.assign(fPlanHars.size(), 0);
+  fPlanPows.assign(fPlanHars.size(), 1);
+  return GetPlanNode(poi, ref, ovl, fPlanHars, fPlanPows);
+};
+int GFW::GetPlanNode(int poi, int ref, int ovl, const vector<int>& hars, const vector<int>& pows)
+{
+  if ((pows.at(0) != 1) && ovl > -1)
+    poi = ovl; // same as in RecursiveCorr: if the power of POI is not unity, then always use overlap (if defined)
+  fPlanKey.clear();
+  fPlanKey.push_back(poi);
+  fPlanKey.push_back(ref);
+  fPlanKey.push_back(ovl);
+  fPlanKey.insert(fPlanKey.end(), hars.begin(), hars.end());
+  fPlanKey.insert(fPlanKey.end(), pows.begin(), pows.end());
+  auto lFound = fPlanIndex.find(fPlanKey);
+  if (lFound != fPlanIndex.end())
+    return lFound->second;
+  vector<int> lKey = fPlanKey; // the key buffer is overwritten by the sub-correlators
+  PlanNode lNode;
+  lNode.Poi = poi;
+  lNode.Ref = ref;
+  lNode.Ovl = ovl;
+  lNode.Hars = hars;
+  lNode.Pows = pows;
+  if (hars.size() > 2) {
+    // Same decomposition as in RecursiveCorr
+    vector<int> lHars(hars.begin(), hars.end() - 1);
+    vector<int> lPows(pows.begin(), pows.end() - 1);
+    int harlast = hars.back();
+    int powlast = pows.back();
+    lNode.Leading = GetPlanNode(poi, ref, ovl, lHars, lPows);
+    int lDegeneracy = 1;
+    for (int i = (int)lHars.size() - 1; i >= 0; i--) {
+      if (i > 2)
+        if (lHars.at(i) == lHars.at(i - 1) && lPows.at(i) == lPows.at(i - 1)) {
+          lDegeneracy++;
+          continue;
+        };
+      lHars.at(i) += harlast;
+      lPows.at(i) += powlast;
+      lNode.Subtracted.push_back(std::make_pair(GetPlanNode(poi, ref, ovl, lHars, lPows), lDegeneracy));
+      lDegeneracy = 1;
+      lHars.at(i) -= harlast;
+      lPows.at(i) -= powlast;
+    };
+  };
+  int lIndex = (int)fPlanNodes.size();
+  fPlanNodes.push_back(lNode);
+  fPlanIndex[lKey] = lIndex;
+  return lIndex;
+};
+TComplex GFW::EvaluatePlan(int node, int ptbin)
+{
+  if (ptbin >= fPlanNPt) { // new pT bin range, the stored values cannot be reused
+    fPlanNPt = ptbin + 1;
+    fPlanStamps.clear();
+  };
+  size_t lSlot = (size_t)node * fPlanNPt + ptbin;
+  if (lSlot >= fPlanStamps.size()) {
+    fPlanStamps.resize(fPlanNodes.size() * fPlanNPt, 0);
+    fPlanValues.resize(fPlanNodes.size() * fPlanNPt);
+  };
+  if (fPlanStamps[lSlot] == fPlanEvent)
+    return fPlanValues[lSlot];
+  const PlanNode& lNode = fPlanNodes[node];
+  GFWCumulant* qpoi = &fCumulants.at(lNode.Poi);
+  GFWCumulant* qref = &fCumulants.at(lNode.Ref);
+  GFWCumulant* qovl = (lNode.Ovl > -1) ? &fCumulants.at(lNode.Ovl) : 0;
+  TComplex lValue;
+  if (lNode.Hars.size() < 2)
+    lValue = qpoi->Vec(lNode.Hars.at(0), lNode.Pows.at(0), ptbin);
+  else if (lNode.Hars.size() < 3)
+    lValue = TwoRec(lNode.Hars.at(0), lNode.Hars.at(1), lNode.Pows.at(0), lNode.Pows.at(1), ptbin, qpoi, qref, qovl);
+  else {
+    lValue = EvaluatePlan(lNode.Leading, ptbin) * qref->Vec(lNode.Hars.back(), lNode.Pows.back());
+    for (auto& lSub : lNode.Subtracted) {
+      TComplex subtractVal = EvaluatePlan(lSub.first, ptbin);
+      if (lSub.second > 1)
+        subtractVal *= lSub.second;
+      lValue -= subtractVal;
+    };
+  };
+  fPlanStamps[lSlot] = fPlanEvent;
+  fPlanValues[lSlot] = lValue;
+  return lValue;
+};
+
 TComplex GFW::Calculate(int poi, vector<int> hars)
 {
   GFWCumulant* qpoi = &fCumulants.at(poi);
@@ -15,6 +15,7 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <map>
 #include "TString.h"
 #include "TObjArray.h"
 using std::vector;
@@ -69,11 +70,21 @@ class GFW
   void AddRegion(TString refName, int lNhar, int* lNparVec, double lEtaMin, double lEtaMax, int lNpT = 1, int BitMask = 1);
   int CreateRegions();
   void Fill(double eta, int ptin, double phi, double weight, int mask, double secondWeight = -1);
+  // Batched version, filling each region with the particles of the batch in its acceptance; secondWeight can be nullptr if not used
+  void Fill(int nPart, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* secondWeight = nullptr);
   void Clear(); // { for(auto ptr = fCumulants.begin(); ptr!=fCumulants.end(); ++ptr) ptr->ResetQs(); };
+  // Flat copy of the Q-vectors of all the regions, e.g. to store them in a table and to load them in another GFW with the same regions.
+  // SetQvectors() clears the GFW and returns false if the sizes do not match the regions of this GFW
+  void GetQvectors(vector<double>& re, vector<double>& im, vector<int>& nEntries);
+  bool SetQvectors(const vector<double>& re, const vector<double>& im, const vector<int>& nEntries);
   GFWCumulant GetCumulant(int index) { return fCumulants.at(index); };
   TComplex Calculate(TString config, bool SetHarmsToZero = kFALSE);
   CorrConfig GetCorrelatorConfig(TString config, TString head = "", bool ptdif = kFALSE);
   TComplex Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero, bool DisableOverlap = kFALSE);
+  // Correlator plan: the sub-correlators of the configurations are derived once, and evaluated at most once per event and pT bin.
+  // Configurations not added here are added to the plan at their first calculation. The evaluated values are reset by Clear().
+  void BuildPlan(const vector<CorrConfig>& configs);
+  int GetPlanSize() { return (int)fPlanNodes.size(); };
 
  private:
   bool fInitialized;
@@ -82,6 +93,26 @@ class GFW
   TComplex TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   TComplex RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, vector<int>& hars, vector<int>& pows); // POI, Ref. flow, overlapping region
   TComplex RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, vector<int>& hars);                    // POI, Ref. flow, overlapping region
+  // Node of the correlator plan, following the same recursion as RecursiveCorr
+  struct PlanNode {
+    int Poi, Ref, Ovl; // indices of the POI, reference and overlap cumulants (overlap is -1 if not used)
+    vector<int> Hars;
+    vector<int> Pows;
+    int Leading = -1;                       // sub-correlator multiplied by the last reference Q-vector, -1 for one- and two-particle terms
+    vector<std::pair<int, int>> Subtracted; // sub-correlators to subtract, with their degeneracy
+  };
+  vector<PlanNode> fPlanNodes;
+  std::map<vector<int>, int> fPlanIndex; // node index by (poi, ref, ovl, harmonics, powers)
+  vector<TComplex> fPlanValues;          // evaluated values, [node * fPlanNPt + ptbin]
+  vector<unsigned int> fPlanStamps;      // event in which the value was evaluated
+  unsigned int fPlanEvent;               // current event, incremented by Clear()
+  int fPlanNPt;                          // number of pT bins of the value cache
+  vector<int> fPlanHars;                 // buffers for the harmonics and powers of the requested correlators
+  vector<int> fPlanPows;
+  vector<int> fPlanKey;
+  int GetPlanNode(int poi, int ref, int ovl, const vector<int>& hars, const vector<int>& pows);
+  int GetPlanNode(const CorrConfig& corconf, int subevent, bool SetHarmsToZero, bool DisableOverlap);
+  TComplex EvaluatePlan(int node, int ptbin);
   // Deprecated and not used (for now):
   void AddRegion(Region inreg) { fRegions.push_back(inreg); };
   Region GetRegion(int index) { return fRegions.at(index); };
@@ -96,5 +127,11 @@ class GFW
   TComplex CalculateSingle(TString config);
 
   bool SetHarmonicsToZero(TString& instr);
+  // Buffers for the batched filling of one region
+  vector<double> fBatchEta;
+  vector<int> fBatchPt;
+  vector<double> fBatchPhi;
+  vector<double> fBatchWeight;
+  vector<double> fBatchSecondWeight;
 };
 #endif
\ No newline at end of file
@@ -10,20 +10,45 @@
 // or submit itself to any jurisdiction.
 
 #include "GFWCumulant.h"
+#include <algorithm>
+#include "Common/Core/Harmonics.h"
 
-GFWCumulant::GFWCumulant() : fQvector(0),
+GFWCumulant::GFWCumulant() : fQRe(),
+                             fQIm(),
+                             fPowOffset(),
+                             fPtStride(0),
                              fUsed(kBlank),
                              fNEntries(-1),
                              fN(1),
                              fPow(1),
                              fPt(1),
-                             fFilledPts(0),
+                             fFilledPts(),
                              fInitialized(kFALSE){};
 
 GFWCumulant::~GFWCumulant(){
   // printf("Destructor (?) for some reason called?\n");
   // DestroyComplexVectorArray();
 };
+void GFWCumulant::FillOne(int ptin, const double* cosN, const double* sinN, int stride, double weight, double SecondWeight)
+{
+  double* lQRe = fQRe.data() + ptin * fPtStride;
+  double* lQIm = fQIm.data() + ptin * fPtStride;
+  for (int lN = 0; lN < fN; lN++) {
+    double* lHarRe = lQRe + fPowOffset[lN];
+    double* lHarIm = lQIm + fPowOffset[lN];
+    const double lCos = cosN[lN * stride];
+    const double lSin = sinN[lN * stride];
+    // If second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
+    // this is important when POIs are a subset of REFs and have different weights than REFs
+    double lPrefactor = 1.;
+    const int lNPow = fPowVec[lN];
+    for (int lPow = 0; lPow < lNPow; lPow++) {
+      lHarRe[lPow] += lPrefactor * lCos;
+      lHarIm[lPow] += lPrefactor * lSin;
+      lPrefactor *= (SecondWeight > 0 && lPow > 0) ? SecondWeight : weight;
+    };
+  };
+};
 void GFWCumulant::FillArray(double eta, int ptin, double phi, double weight, double SecondWeight)
 {
   if (!fInitialized)
@@ -33,53 +58,49 @@ void GFWCumulant::FillArray(double eta, int ptin, double phi, double weight, dou
   else if (ptin < 0 || ptin >= fPt)
     return;
   fFilledPts[ptin] = kTRUE;
-  for (int lN = 0; lN < fN; lN++) {
-    double lSin = TMath::Sin(lN * phi); // No need to recalculate for each power
-    double lCos = TMath::Cos(lN * phi); // No need to recalculate for each power
-    for (int lPow = 0; lPow < PW(lN); lPow++) {
-      double lPrefactor = 0;
-      // Dont calculate it twice; multiplication is cheaper that power
-      // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
-      // this is important when POIs are a subset of REFs and have different weights than REFs
-      if (SecondWeight > 0 && lPow > 1)
-        lPrefactor = TMath::Power(SecondWeight, lPow - 1) * weight;
-      else
-        lPrefactor = TMath::Power(weight, lPow);
-      double qsin = lPrefactor * lSin;
-      double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow](fQvector[ptin][lN][lPow].Re() + qcos, fQvector[ptin][lN][lPow].Im() + qsin); //+=TComplex(qcos,qsin);
-    };
-  };
+  fCosBuffer.resize(std::max(fN, 1));
+  fSinBuffer.resize(std::max(fN, 1));
+  harmonics::compute(phi, fN - 1, fCosBuffer.data(), fSinBuffer.data());
+  FillOne(ptin, fCosBuffer.data(), fSinBuffer.data(), 1, weight, SecondWeight);
   Inc();
 };
+void GFWCumulant::FillArray(int nPart, const double* eta, const int* ptin, const double* phi, const double* weight, const double* SecondWeight)
+{
+  if (!fInitialized)
+    CreateComplexVectorArray(1, 1, 1);
+  // all the harmonics of the batch at once, stored as [harmonic][particle]
+  fCosBuffer.resize(std::max(fN, 1) * nPart);
+  fSinBuffer.resize(std::max(fN, 1) * nPart);
+  harmonics::computeBatch(nPart, phi, fN - 1, fCosBuffer.data(), fSinBuffer.data());
+  for (int i = 0; i < nPart; i++) {
+    int lPtBin = ptin[i];
+    if (fPt == 1)
+      lPtBin = 0;
+    else if (lPtBin < 0 || lPtBin >= fPt)
+      continue;
+    fFilledPts[lPtBin] = kTRUE;
+    FillOne(lPtBin, fCosBuffer.data() + i, fSinBuffer.data() + i, nPart, weight[i], SecondWeight ? SecondWeight[i] : -1);
+    Inc();
+  };
+};
 void GFWCumulant::ResetQs()
 {
   if (!fNEntries)
     return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
-  for (int i = 0; i < fPt; i++) {
-    fFilledPts[i] = kFALSE;
-    for (int lN = 0; lN < fN; lN++) {
-      for (int lPow = 0; lPow < PW(lN); lPow++) {
-        fQvector[i][lN][lPow](0., 0.);
-      };
-    };
-  };
+  std::fill(fFilledPts.begin(), fFilledPts.end(), kFALSE);
+  std::fill(fQRe.begin(), fQRe.end(), 0.);
+  std::fill(fQIm.begin(), fQIm.end(), 0.);
   fNEntries = 0;
 };
 void GFWCumulant::DestroyComplexVectorArray()
 {
   if (!fInitialized)
     return;
-  for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      delete[] fQvector[i][l_n];
-    };
-  };
-  for (int i = 0; i < fPt; i++) {
-    delete[] fQvector[i];
-  };
-  delete[] fQvector;
-  delete[] fFilledPts;
+  fQRe.clear();
+  fQIm.clear();
+  fPowOffset.clear();
+  fPtStride = 0;
+  fFilledPts.clear();
   fInitialized = kFALSE;
   fNEntries = -1;
 };
@@ -98,17 +119,16 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fN = N;
   fPow = 0;
   fPt = Pt;
-  fFilledPts = new bool[Pt];
+  fFilledPts.assign(Pt, kFALSE);
   fPowVec = PowVec;
-  fQvector = new TComplex**[fPt];
-  for (int i = 0; i < fPt; i++) {
-    fQvector[i] = new TComplex*[fN];
-  };
+  fPowOffset.resize(fN);
+  fPtStride = 0;
   for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      fQvector[i][l_n] = new TComplex[PW(l_n)];
-    };
+    fPowOffset[l_n] = fPtStride;
+    fPtStride += PW(l_n);
   };
+  fQRe.assign(fPt * fPtStride, 0.);
+  fQIm.assign(fPt * fPtStride, 0.);
   ResetQs();
   fInitialized = kTRUE;
 };
@@ -118,7 +138,10 @@ TComplex GFWCumulant::Vec(int n, int p, int ptbin)
     return 0;
   if (ptbin >= fPt || ptbin < 0)
     ptbin = 0;
-  if (n >= 0)
-    return fQvector[ptbin][n][p];
-  return TComplex::Conjugate(fQvector[ptbin][-n][p]);
-};
\ No newline at end of file
+  if (n >= 0) {
+    const int lIndex = ptbin * fPtStride + fPowOffset[n] + p;
+    return TComplex(fQRe[lIndex], fQIm[lIndex]);
+  }
+  const int lIndex = ptbin * fPtStride + fPowOffset[-n] + p;
+  return TComplex(fQRe[lIndex], -fQIm[lIndex]);
+};
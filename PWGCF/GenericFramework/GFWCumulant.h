@@ -15,6 +15,7 @@
 #include "TNamed.h"
 #include "TMath.h"
 #include "TAxis.h"
+#include <vector>
 using std::vector;
 class GFWCumulant
 {
@@ -23,6 +24,8 @@ class GFWCumulant
   ~GFWCumulant();
   void ResetQs();
   void FillArray(double eta, int ptin, double phi, double weight = 1, double SecondWeight = -1);
+  // Batched filling of nPart particles; SecondWeight can be nullptr if not used
+  void FillArray(int nPart, const double* eta, const int* ptin, const double* phi, const double* weight, const double* SecondWeight = nullptr);
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
@@ -34,7 +37,11 @@ class GFWCumulant
   void Inc() { fNEntries++; };
   int GetN() { return fNEntries; };
   // protected:
-  TComplex*** fQvector;
+  // Q-vectors, stored contiguously in [pt][harmonic][power] order, with separate real and imaginary parts
+  vector<double> fQRe;
+  vector<double> fQIm;
+  vector<int> fPowOffset; //! Offset of each harmonic within one pt bin
+  int fPtStride;          //! Number of Q-vectors per pt bin
   unsigned int fUsed;
   int fNEntries;
   // Q-vectors. Could be done recursively, but maybe defining each one of them explicitly is easier to read
@@ -43,7 +50,7 @@ class GFWCumulant
   int fPow;                              //! Power
   vector<int> fPowVec;                   //! Powers array
   int fPt;                               //! fPt bins
-  bool* fFilledPts;
+  vector<bool> fFilledPts;
   bool fInitialized; // Arrays are initialized
   void CreateComplexVectorArray(int N = 1, int P = 1, int Pt = 1);
   void CreateComplexVectorArrayVarPower(int N = 1, vector<int> Pvec = {1}, int Pt = 1);
@@ -51,10 +58,16 @@ class GFWCumulant
   void DestroyComplexVectorArray();
   bool IsPtBinFilled(int ptb)
   {
-    if (!fFilledPts)
+    if (fFilledPts.empty())
       return kFALSE;
     return fFilledPts[ptb];
   };
+
+ private:
+  // cosN/sinN hold the fN harmonics of the particle, separated by stride
+  void FillOne(int ptin, const double* cosN, const double* sinN, int stride, double weight, double SecondWeight);
+  vector<double> fCosBuffer; //! cos(n phi) of the particles of one batch, [harmonic][particle]
+  vector<double> fSinBuffer; //! sin(n phi) of the particles of one batch, [harmonic][particle]
 };
 
 #endif
\ No newline at end of file
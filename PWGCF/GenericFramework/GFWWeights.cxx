@@ -20,7 +20,8 @@ GFWWeights::GFWWeights() : fDataFilled(kFALSE),
                            fIntEff(0),
                            fAccInt(0),
                            fNbinsPt(0),
-                           fbinsPt(0){};
+                           fbinsPt(0),
+                           fHasLookup(kFALSE){};
 GFWWeights::~GFWWeights()
 {
   delete fW_data;
@@ -102,6 +103,8 @@ void GFWWeights::Fill(double phi, double eta, double vz, double pt, double cent,
 };
 double GFWWeights::GetWeight(double phi, double eta, double vz, double pt, double cent, int htype)
 {
+  if (htype >= 0 && htype < 3 && fLookup[htype].IsFilled())
+    return fLookup[htype].Get(htype ? pt : phi, eta, vz);
   TObjArray* tar = 0;
   const char* pf = "";
   if (htype == 0) {
@@ -131,6 +134,8 @@ double GFWWeights::GetWeight(double phi, double eta, double vz, double pt, doubl
 };
 double GFWWeights::GetNUA(double phi, double eta, double vz)
 {
+  if (fNUALookup.IsFilled())
+    return fNUALookup.Get(phi, eta, vz);
   if (!fAccInt)
     CreateNUA();
   int xind = fAccInt->GetXaxis()->FindBin(phi);
@@ -153,6 +158,48 @@ double GFWWeights::GetNUE(double pt, double eta, double vz)
     return 1. / weight;
   return 1;
 }
+bool GFWWeights::LookupGrid::Fill(TH3D* inh)
+{
+  fWeights.clear();
+  if (!inh)
+    return kFALSE;
+  TAxis* lAxes[3] = {inh->GetXaxis(), inh->GetYaxis(), inh->GetZaxis()};
+  for (int i = 0; i < 3; i++) {
+    if (lAxes[i]->IsVariableBinSize())
+      return kFALSE;
+    fN[i] = lAxes[i]->GetNbins();
+    fMin[i] = lAxes[i]->GetXmin();
+    fScale[i] = fN[i] / (lAxes[i]->GetXmax() - lAxes[i]->GetXmin());
+  };
+  fWeights.resize(fN[0] * fN[1] * fN[2]);
+  for (int ix = 0; ix < fN[0]; ix++)
+    for (int iy = 0; iy < fN[1]; iy++)
+      for (int iz = 0; iz < fN[2]; iz++) {
+        double weight = inh->GetBinContent(ix + 1, iy + 1, iz + 1);
+        fWeights[(ix * fN[1] + iy) * fN[2] + iz] = (weight != 0) ? 1. / weight : 1.;
+      };
+  return kTRUE;
+};
+void GFWWeights::CreateLookup()
+{
+  ClearLookup();
+  TObjArray* tars[3] = {fW_data, fW_mcrec, fW_mcgen};
+  const char* pfs[3] = {"data", "mcrec", "mcgen"};
+  for (int i = 0; i < 3; i++)
+    if (tars[i])
+      fLookup[i].Fill((TH3D*)tars[i]->FindObject(GetBinName(0, 0, pfs[i])));
+  if (!fAccInt && fW_data && fW_data->GetEntries() > 0)
+    CreateNUA();
+  fNUALookup.Fill(fAccInt);
+  fHasLookup = kTRUE;
+};
+void GFWWeights::ClearLookup()
+{
+  for (int i = 0; i < 3; i++)
+    fLookup[i].fWeights.clear();
+  fNUALookup.fWeights.clear();
+  fHasLookup = kFALSE;
+};
 double GFWWeights::FindMax(TH3D* inh, int& ix, int& iy, int& iz)
 {
   double maxv = inh->GetBinContent(1, 1, 1);
@@ -19,6 +19,7 @@
 #include "TFile.h"
 #include "TCollection.h"
 #include "TString.h"
+#include <vector>
 
 class GFWWeights : public TNamed
 {
@@ -51,8 +52,34 @@ class GFWWeights : public TNamed
   void OverwriteNUA();
   TH1D* GetdNdPhi();
   TH1D* GetEfficiency(double etamin, double etamax, double vzmin, double vzmax);
+  // Lookup grids: the weights of the uniformly binned histograms (and of the integrated NUA) are copied to flat arrays,
+  // GetWeight and GetNUA then use them instead of the ROOT bin lookup. To be called once the weights are final,
+  // e.g. after fetching the object for a new run. Histograms with variable binning keep the ROOT lookup.
+  void CreateLookup();
+  void ClearLookup();
+  bool HasLookup() { return fHasLookup; };
 
  private:
+  struct LookupGrid {
+    int fN[3] = {0, 0, 0};
+    double fMin[3] = {0, 0, 0};
+    double fScale[3] = {0, 0, 0}; // number of bins over axis range
+    std::vector<float> fWeights;  // 1/content (1 if empty), [x][y][z]
+    bool IsFilled() const { return !fWeights.empty(); };
+    bool Fill(TH3D* inh);
+    float Get(double x, double y, double z) const
+    {
+      int ix = (int)((x - fMin[0]) * fScale[0]);
+      int iy = (int)((y - fMin[1]) * fScale[1]);
+      int iz = (int)((z - fMin[2]) * fScale[2]);
+      // under- and overflows get weight 1, as the empty bins. Values just below the minimum are truncated to bin 0, hence the comparison to fMin
+      bool lInRange = (x >= fMin[0]) & (y >= fMin[1]) & (z >= fMin[2]) & (ix < fN[0]) & (iy < fN[1]) & (iz < fN[2]);
+      return lInRange ? fWeights[(ix * fN[1] + iy) * fN[2] + iz] : 1.f;
+    };
+  };
+  LookupGrid fLookup[3]; //! per htype
+  LookupGrid fNUALookup; //!
+  bool fHasLookup;       //!
   bool fDataFilled;
   bool fMCFilled;
   TObjArray* fW_data;
@@ -61,6 +61,80 @@ TProfile* ProfileSubset::GetSubset(bool onX, const char* name, int firstbin, int
   p1->SetEntries(p1->GetEffectiveEntries());
   return p1;
 };
+std::vector<TProfile*> ProfileSubset::GetSubsets(TProfile2D* inpf, bool onX, const char* name, const std::vector<SubsetRange>& ranges, int l_nbins, double* l_binarray)
+{
+  TString expectedName = (onX ? "_pfx" : "_pfy");
+  TString pname(name);
+  if (pname.IsNull() || name == expectedName)
+    pname = TString(inpf->GetName()) + expectedName;
+  const TAxis* outAxis = (onX ? inpf->GetXaxis() : inpf->GetYaxis());
+  const int nBinsY = inpf->GetNbinsY();
+  const double* sumWY = inpf->fArray;
+  const double* sumWY2 = inpf->GetSumw2()->fArray;
+  const bool useBinSumw2 = inpf->GetBinSumw2()->fN;
+  const double* sumW2 = inpf->GetBinSumw2()->fArray;
+  R__ASSERT(inpf->GetSumw2()->fN != 0);
+  std::vector<TProfile*> subsets;
+  std::vector<std::vector<double>> sums(ranges.size()); // [range][out. bin][sum wy, sum wy^2, sum w, sum w^2]
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    TString lname = Form("%s_%i", pname.Data(), (int)i);
+    TProfile* p1 = 0;
+    if (l_nbins)
+      p1 = new TProfile(lname, inpf->GetTitle(), l_nbins, l_binarray);
+    else
+      p1 = new TProfile(lname, inpf->GetTitle(), outAxis->GetNbins(), outAxis->GetXbins()->fArray);
+    if (useBinSumw2)
+      p1->Sumw2();
+    R__ASSERT(ranges[i].lastOut - ranges[i].firstOut + 1 == p1->GetNbinsX());
+    subsets.push_back(p1);
+    sums[i].assign(p1->fN * 4, 0.);
+  }
+  // the sums of each output bin are done in the order of the projected axis, as in the projections of GetSubset
+  for (int iy = 0; iy <= nBinsY + 1; ++iy) {
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      const SubsetRange& range = ranges[i];
+      double* lSums = sums[i].data();
+      if (onX) {
+        if (iy < range.fb || iy > range.lb)
+          continue;
+        for (int ix = range.firstOut; ix <= range.lastOut; ++ix) {
+          int binno = inpf->GetBin(ix, iy);
+          double* outSums = &lSums[(ix - range.firstOut + 1) * 4];
+          outSums[0] += sumWY[binno];
+          outSums[1] += sumWY2[binno];
+          outSums[2] += inpf->GetBinEntries(binno);
+          if (useBinSumw2)
+            outSums[3] += sumW2[binno];
+        }
+      } else {
+        if (iy < range.firstOut || iy > range.lastOut)
+          continue;
+        double* outSums = &lSums[(iy - range.firstOut + 1) * 4];
+        for (int ix = range.fb; ix <= range.lb; ++ix) {
+          int binno = inpf->GetBin(ix, iy);
+          outSums[0] += sumWY[binno];
+          outSums[1] += sumWY2[binno];
+          outSums[2] += inpf->GetBinEntries(binno);
+          if (useBinSumw2)
+            outSums[3] += sumW2[binno];
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    TProfile* p1 = subsets[i];
+    const double* lSums = sums[i].data();
+    for (int j = 0; j < p1->fN; ++j) {
+      p1->fArray[j] = lSums[j * 4];
+      p1->GetSumw2()->fArray[j] = lSums[j * 4 + 1];
+      p1->SetBinEntries(j, lSums[j * 4 + 2]);
+      if (useBinSumw2)
+        p1->GetBinSumw2()->fArray[j] = lSums[j * 4 + 3];
+    }
+    p1->SetEntries(p1->GetEffectiveEntries());
+  }
+  return subsets;
+};
 void ProfileSubset::OverrideBinContent(double x, double y, double x2, double y2, double val)
 {
   if (!fBinSumw2.fN)
@@ -15,6 +15,7 @@
 #include "TProfile.h"
 #include "TProfile2D.h"
 #include "TError.h"
+#include <vector>
 
 class ProfileSubset : public TProfile2D
 {
@@ -22,6 +23,16 @@ class ProfileSubset : public TProfile2D
   ProfileSubset(TProfile2D& inpf) : TProfile2D(inpf){};
   ~ProfileSubset(){};
   TProfile* GetSubset(bool onx, const char* name, int fb, int lb, int l_nbins = 0, double* l_binarray = 0);
+  // Range of a subset: bins fb to lb of the projected axis are summed, for the bins firstOut to lastOut of the output axis
+  struct SubsetRange {
+    int fb;
+    int lb;
+    int firstOut;
+    int lastOut;
+  };
+  // Same subsets as GetSubset with the output axis range set to [firstOut, lastOut], for all the ranges in one pass over the bin arrays of
+  // inpf. No copy nor 2D projection of the profile is made. The subsets are named name_<index of the range> and owned by the caller
+  static std::vector<TProfile*> GetSubsets(TProfile2D* inpf, bool onx, const char* name, const std::vector<SubsetRange>& ranges, int l_nbins = 0, double* l_binarray = 0);
   void OverrideBinContent(double x, double y, double x2, double y2, double val);
   void OverrideBinContent(double x, double y, double x2, double y2, TProfile2D* sourceProf);
   bool OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2);
@@ -334,19 +334,21 @@ TComplex JFFlucAnalysis::Q(int n, int p)
 {
   // Return QvectorQC
   // Q{-n, p} = Q{n, p}*
-  return n >= 0 ? QvectorQC[n][p] : C(QvectorQC[-n][p]);
+  JQVectors<kNQH, nKL>::Complex q = fQvectors.Q(n, p);
+  return TComplex(q.real(), q.imag());
 }
 
 TComplex JFFlucAnalysis::Two(int n1, int n2)
 {
   // two-particle correlation <exp[i(n1*phi1 + n2*phi2)]>
-  return Q(n1, 1) * Q(n2, 1) - Q(n1 + n2, 2);
+  JQVectors<kNQH, nKL>::Complex c = fQvectors.Two(n1, n2);
+  return TComplex(c.real(), c.imag());
 }
 
 TComplex JFFlucAnalysis::Four(int n1, int n2, int n3, int n4)
 {
-
-  return Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4, 1) - Q(n1 + n2, 2) * Q(n3, 1) * Q(n4, 1) - Q(n2, 1) * Q(n1 + n3, 2) * Q(n4, 1) - Q(n1, 1) * Q(n2 + n3, 2) * Q(n4, 1) + 2. * Q(n1 + n2 + n3, 3) * Q(n4, 1) - Q(n2, 1) * Q(n3, 1) * Q(n1 + n4, 2) + Q(n2 + n3, 2) * Q(n1 + n4, 2) - Q(n1, 1) * Q(n3, 1) * Q(n2 + n4, 2) + Q(n1 + n3, 2) * Q(n2 + n4, 2) + 2. * Q(n3, 1) * Q(n1 + n2 + n4, 3) - Q(n1, 1) * Q(n2, 1) * Q(n3 + n4, 2) + Q(n1 + n2, 2) * Q(n3 + n4, 2) + 2. * Q(n2, 1) * Q(n1 + n3 + n4, 3) + 2. * Q(n1, 1) * Q(n2 + n3 + n4, 3) - 6. * Q(n1 + n2 + n3 + n4, 4);
+  JQVectors<kNQH, nKL>::Complex c = fQvectors.Four(n1, n2, n3, n4);
+  return TComplex(c.real(), c.imag());
 }
 #undef C
 
@@ -523,24 +525,26 @@ void JFFlucAnalysis::UserExec(Option_t*)
          kSubB,
          kNSub };
 
+  // all the symmetric cumulant correlators at once
+  Double_t sc4[kNH][kcNH];
+  Double_t sc2[kNH];
+  Double_t ref_four, ref_two;
+  fQvectors.SymmetricCumulants<kNH, kcNH>(sc4, sc2, ref_four, ref_two);
+
   Double_t event_weight_four = 1.0;
   Double_t event_weight_two = 1.0;
   Double_t event_weight_two_gap = 1.0;
   if (flags & kFlucEbEWeighting) {
-    event_weight_four = Four(0, 0, 0, 0).Re();
-    event_weight_two = Two(0, 0).Re();
+    event_weight_four = ref_four;
+    event_weight_two = ref_two;
     event_weight_two_gap = (QvectorQCgap[kSubA][0][1] * QvectorQCgap[kSubB][0][1]).Re();
   }
 
   for (UInt_t ih = 2; ih < kNH; ih++) {
-    for (UInt_t ihh = 2, mm = (ih < kcNH ? ih : kcNH); ihh < mm; ihh++) {
-      TComplex scfour = Four(ih, ihh, -ih, -ihh) / Four(0, 0, 0, 0).Re();
-
-      fh_SC_with_QC_4corr[ih][ihh][fCBin]->Fill(scfour.Re(), event_weight_four);
-    }
+    for (UInt_t ihh = 2, mm = (ih < kcNH ? ih : kcNH); ihh < mm; ihh++)
+      fh_SC_with_QC_4corr[ih][ihh][fCBin]->Fill(sc4[ih][ihh] / ref_four, event_weight_four);
 
-    TComplex sctwo = Two(ih, -ih) / Two(0, 0).Re();
-    fh_SC_with_QC_2corr[ih][fCBin]->Fill(sctwo.Re(), event_weight_two);
+    fh_SC_with_QC_2corr[ih][fCBin]->Fill(sc2[ih] / ref_two, event_weight_two);
 
     TComplex sctwoGap = (QvectorQCgap[kSubA][ih][1] * TComplex::Conjugate(QvectorQCgap[kSubB][ih][1])) / (QvectorQCgap[kSubA][0][1] * QvectorQCgap[kSubB][0][1]).Re();
     fh_SC_with_QC_2corr_gap[ih][fCBin]->Fill(sctwoGap.Re(), event_weight_two_gap);
@@ -17,6 +17,8 @@
 
 #include "JHistManager.h"
 #include <TComplex.h>
+#include "Common/Core/Harmonics.h"
+#include "JQVectors.h"
 
 class JFFlucAnalysis
 {
@@ -124,6 +126,7 @@ class JFFlucAnalysis
           QvectorQCgap[isub][ih][ik] = TComplex(0, 0);
       }
     } // for max harmonics
+    fQvectors.Reset();
     for (auto& track : inputInst) {
       // pt cuts already applied in task.
       if (track.eta() < -fEta_max || track.eta() > fEta_max)
@@ -133,11 +136,14 @@ class JFFlucAnalysis
       Double_t phiNUACorr = 1.0; // itrack->GetWeight(); //XXXXXX
 
       UInt_t isub = (UInt_t)(track.eta() > 0.0);
+      Double_t cosN[kNQH], sinN[kNQH];
+      harmonics::compute<Double_t>(track.phi(), kNQH - 1, cosN, sinN);
+      fQvectors.Fill(cosN, sinN, 1.0 / (phiNUACorr * effCorr));
       for (UInt_t ih = 0; ih < kNH; ih++) {
         Double_t tf = 1.0;
         TComplex q[nKL];
         for (UInt_t ik = 0; ik < nKL; ik++) {
-          q[ik] = TComplex(tf * TMath::Cos(ih * track.phi()), tf * TMath::Sin(ih * track.phi()));
+          q[ik] = TComplex(tf * cosN[ih], tf * sinN[ih]);
           QvectorQC[ih][ik] += q[ik];
 
           if (TMath::Abs(track.eta()) > fEta_min)
@@ -173,6 +179,7 @@ class JFFlucAnalysis
          kK4,
          nKL };  // order
 #define kcNH kH6 // max second dimension + 1
+#define kNQH (kNH + kcNH - 1) // harmonics of the Q-vectors needed by the symmetric cumulants, up to (kNH - 1) + (kcNH - 1)
  private:
   const Double_t* fVertex; //!
   Float_t fCent;
@@ -191,6 +198,7 @@ class JFFlucAnalysis
 
   TComplex QvectorQC[kNH][nKL];
   TComplex QvectorQCgap[2][kNH][nKL]; // ksub
+  JQVectors<kNQH, nKL> fQvectors; //! same as QvectorQC, up to the harmonics needed by the symmetric cumulants
 
   JHistManager* fHMG; //!
 
@@ -272,7 +272,9 @@ JArrayBase::JArrayBase() : JNamed("JArayBase", "", "&Dir=default&Lazy", 0),
                            fNGenerated(0),
                            fIsBinFixed(false),
                            fIsBinLocked(false),
-                           fAlg(NULL)
+                           fAlg(NULL),
+                           fStride(0),
+                           fItems(NULL)
 {
   // constrctor
 }
@@ -292,7 +294,9 @@ JArrayBase::JArrayBase(const JArrayBase& obj) : JNamed(obj.fName, obj.fTitle, ob
                                                 fNGenerated(obj.fNGenerated),
                                                 fIsBinFixed(obj.fIsBinFixed),
                                                 fIsBinLocked(obj.fIsBinLocked),
-                                                fAlg(obj.fAlg)
+                                                fAlg(obj.fAlg),
+                                                fStride(obj.fStride),
+                                                fItems(obj.fItems)
 {
   // copy constructor TODO: proper handling of pointer data members
 }
@@ -336,8 +340,22 @@ void JArrayBase::FixBin()
       RemoveOption("dir");
   }
   ClearIndex();
-  fAlg = new JArrayAlgorithmSimple(this);
+  JArrayAlgorithmSimple* alg = new JArrayAlgorithmSimple(this);
+  fAlg = alg;
   fArraySize = fAlg->BuildArray();
+  fStride = alg->DimFactor();
+  fItems = fAlg->GetArray();
+}
+//_____________________________________________________
+void* JArrayBase::BuildItemAt(int iG)
+{
+  // the item is built from the index array, as in GetItem
+  int n = iG;
+  for (int i = 0; i < Dimension(); i++) {
+    fIndex[i] = n / fStride[i];
+    n -= fIndex[i] * fStride[i];
+  }
+  return GetItem();
 }
 //_____________________________________________________
 int JArrayBase::Index(int d)
@@ -190,6 +190,15 @@ class JArrayBase : public JNamed
   void* GetItem();
   void* GetSingleItem();
 
+  // Pre-resolved access: the flat index of the bins (i0, i1, ...) is sum_d i_d * Stride(d), it can be computed once
+  // and the item is then fetched without going through the index array
+  int Stride(int d) { return fStride[d]; }
+  void* GetItemAt(int iG)
+  {
+    void* item = fItems[iG];
+    return item ? item : BuildItemAt(iG);
+  }
+
   /// void LockBin(bool is=true){}//TODO
   // bool IsBinLocked(){ return fIsBinLocked; }
 
@@ -221,6 +230,9 @@ class JArrayBase : public JNamed
   bool fIsBinFixed;
   bool fIsBinLocked;
   JArrayAlgorithm* fAlg;
+  ArrayInt fStride; // flat index stride of each dimension
+  void** fItems;    // items by flat index, owned by fAlg
+  void* BuildItemAt(int iG);
   friend class JArrayAlgorithm;
 };
 
@@ -242,6 +254,7 @@ class JArrayAlgorithm
   virtual void InitIterator() = 0;
   virtual bool Next(void*& item) = 0;
   virtual void** GetRawItem() = 0;
+  virtual void** GetArray() = 0;
   virtual void* GetPosition() = 0;
   virtual bool IsCurrentPosition(void* pos) = 0;
   virtual void SetPosition(void* pos) = 0;
@@ -266,6 +279,8 @@ class JArrayAlgorithmSimple : public JArrayAlgorithm
   virtual void SetItem(void* item);
   virtual void InitIterator() { fPos = 0; }
   virtual void** GetRawItem() { return &fArray[GlobalIndex()]; }
+  virtual void** GetArray() { return fArray; }
+  ArrayInt& DimFactor() { return fDimFactor; }
   virtual bool Next(void*& item)
   {
     item = fPos < GetEntries() ? (void*)fArray[fPos] : NULL;
@@ -361,6 +376,8 @@ class JTH1Derived : public JTH1
     fPlayer[i];
     return fPlayer;
   }
+  // Item at a flat index, see JArrayBase::Stride
+  T* At(int iG) { return static_cast<T*>(GetItemAt(iG)); }
   T* operator->() { return static_cast<T*>(GetSingleItem()); }
   operator T*() { return static_cast<T*>(GetSingleItem()); }
   // Virtual from JArrayBase
@@ -418,30 +435,32 @@ template <typename T>
 class JTH1DerivedPlayer
 {
  public:
-  JTH1DerivedPlayer(JTH1Derived<T>* cmd) : fLevel(0), fCMD(cmd){};
+  JTH1DerivedPlayer(JTH1Derived<T>* cmd) : fLevel(0), fFlatIndex(0), fCMD(cmd){};
   JTH1DerivedPlayer<T>& operator[](int i)
   {
-    if (fLevel > fCMD->Dimension()) {
+    if (fLevel >= fCMD->Dimension()) {
       JERROR("Exceed Dimension");
     }
     if (OutOf(i, 0, fCMD->SizeOf(fLevel) - 1)) {
       JERROR("wrong Index %d of %dth in %s", i, fLevel, fCMD->GetName());
     }
-    fCMD->SetIndex(i, fLevel++);
+    fFlatIndex += i * fCMD->Stride(fLevel++);
     return *this;
   }
   void Init()
   {
     fLevel = 0;
-    fCMD->ClearIndex();
+    fFlatIndex = 0;
   }
-  T* operator->() { return static_cast<T*>(fCMD->GetItem()); }
-  operator T*() { return static_cast<T*>(fCMD->GetItem()); }
-  operator TObject*() { return static_cast<TObject*>(fCMD->GetItem()); }
-  operator TH1*() { return static_cast<TH1*>(fCMD->GetItem()); }
+  T* operator->() { return static_cast<T*>(fCMD->GetItemAt(fFlatIndex)); }
+  operator T*() { return static_cast<T*>(fCMD->GetItemAt(fFlatIndex)); }
+  operator TObject*() { return static_cast<TObject*>(fCMD->GetItemAt(fFlatIndex)); }
+  operator TH1*() { return static_cast<TH1*>(fCMD->GetItemAt(fFlatIndex)); }
+  int GetFlatIndex() { return fFlatIndex; }
 
  private:
   int fLevel;
+  int fFlatIndex; // flat index of the bins given so far, the missing ones count as 0
   JTH1Derived<T>* fCMD;
 };
 
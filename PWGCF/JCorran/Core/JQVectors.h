@@ -0,0 +1,106 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   JQVectors.h
+/// \brief  Fixed size Q-vectors Q_{n,p} = sum_i w_i^p exp(i n phi_i) and the Q-cumulant correlators built from them
+///
+/// The maximum harmonic and power are template parameters, so that the Q-vectors are stored in a fixed std::array
+/// and the correlator expressions are fully inlined.
+///
+
+#ifndef JQVECTORS_H
+#define JQVECTORS_H
+
+#include <array>
+#include <complex>
+
+template <int NHarmonics, int NPowers>
+class JQVectors
+{
+ public:
+  using Complex = std::complex<double>;
+
+  void Reset() { fQ.fill(Complex(0., 0.)); }
+
+  /// Adds one particle
+  /// \param cosN cos(n phi) of the particle, n = 0..NHarmonics-1
+  /// \param sinN sin(n phi) of the particle, n = 0..NHarmonics-1
+  /// \param weight weight of the particle, raised to the power p for Q_{n,p}
+  void Fill(const double* cosN, const double* sinN, double weight)
+  {
+    for (int n = 0; n < NHarmonics; ++n) {
+      double w = 1.;
+      for (int p = 0; p < NPowers; ++p) {
+        fQ[n * NPowers + p] += Complex(w * cosN[n], w * sinN[n]);
+        w *= weight;
+      }
+    }
+  }
+
+  /// \return Q_{n,p}, using Q_{-n,p} = Q_{n,p}*; zero for |n| >= NHarmonics
+  Complex Q(int n, int p) const
+  {
+    if (n >= NHarmonics || -n >= NHarmonics) {
+      return Complex(0., 0.);
+    }
+    return n >= 0 ? fQ[n * NPowers + p] : std::conj(fQ[-n * NPowers + p]);
+  }
+
+  /// two-particle correlation <exp[i(n1*phi1 + n2*phi2)]>, not normalised
+  Complex Two(int n1, int n2) const
+  {
+    return Q(n1, 1) * Q(n2, 1) - Q(n1 + n2, 2);
+  }
+
+  /// four-particle correlation <exp[i(n1*phi1 + n2*phi2 + n3*phi3 + n4*phi4)]>, not normalised
+  Complex Four(int n1, int n2, int n3, int n4) const
+  {
+    return Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4, 1) - Q(n1 + n2, 2) * Q(n3, 1) * Q(n4, 1) - Q(n2, 1) * Q(n1 + n3, 2) * Q(n4, 1) - Q(n1, 1) * Q(n2 + n3, 2) * Q(n4, 1) + 2. * Q(n1 + n2 + n3, 3) * Q(n4, 1) - Q(n2, 1) * Q(n3, 1) * Q(n1 + n4, 2) + Q(n2 + n3, 2) * Q(n1 + n4, 2) - Q(n1, 1) * Q(n3, 1) * Q(n2 + n4, 2) + Q(n1 + n3, 2) * Q(n2 + n4, 2) + 2. * Q(n3, 1) * Q(n1 + n2 + n4, 3) - Q(n1, 1) * Q(n2, 1) * Q(n3 + n4, 2) + Q(n1 + n2, 2) * Q(n3 + n4, 2) + 2. * Q(n2, 1) * Q(n1 + n3 + n4, 3) + 2. * Q(n1, 1) * Q(n2 + n3 + n4, 3) - 6. * Q(n1 + n2 + n3 + n4, 4);
+  }
+
+  /// Symmetric cumulant correlators, in one pass sharing the common terms
+  /// \param sc4 Re Four(n, m, -n, -m) for 2 <= n < NH and 2 <= m < min(n, NM), other entries are not set
+  /// \param sc2 Re Two(n, -n) for 2 <= n < NH
+  /// \param four0 Re Four(0, 0, 0, 0)
+  /// \param two0 Re Two(0, 0)
+  template <int NH, int NM>
+  void SymmetricCumulants(double (&sc4)[NH][NM], double (&sc2)[NH], double& four0, double& two0) const
+  {
+    static_assert(NH + NM - 1 <= NHarmonics, "Q-vectors up to harmonic NH + NM - 2 are needed");
+    static_assert(NPowers > 4, "Q-vectors up to power 4 are needed");
+    const double q02 = fQ[2].real();
+    const double q04 = fQ[4].real();
+    double abs2[NH];   // |Q_{n,1}|^2
+    double cross3[NH]; // Re(Q_{n,3} Q_{n,1}*)
+    for (int n = 0; n < NH; ++n) {
+      abs2[n] = std::norm(fQ[n * NPowers + 1]);
+      cross3[n] = (fQ[n * NPowers + 3] * std::conj(fQ[n * NPowers + 1])).real();
+    }
+    two0 = abs2[0] - q02;
+    four0 = abs2[0] * abs2[0] - 2. * (fQ[2] * std::conj(fQ[1]) * std::conj(fQ[1])).real() - 2. * abs2[0] * q02 - 2. * abs2[0] * q02 + 3. * q02 * q02 + 8. * cross3[0] - 6. * q04;
+    for (int n = 2; n < NH; ++n) {
+      sc2[n] = abs2[n] - q02;
+      const Complex& qn = fQ[n * NPowers + 1];
+      for (int m = 2, mm = (n < NM ? n : NM); m < mm; ++m) {
+        const Complex& qm = fQ[m * NPowers + 1];
+        const Complex& qSum2 = fQ[(n + m) * NPowers + 2];
+        const Complex& qDiff2 = fQ[(n - m) * NPowers + 2];
+        sc4[n][m] = abs2[n] * abs2[m] - 2. * (qSum2 * std::conj(qn) * std::conj(qm)).real() - 2. * (qn * std::conj(qm) * std::conj(qDiff2)).real() - (abs2[n] + abs2[m]) * q02 + std::norm(qDiff2) + q02 * q02 + 4. * cross3[n] + 4. * cross3[m] + std::norm(qSum2) - 6. * q04;
+      }
+    }
+  }
+
+ private:
+  std::array<Complex, NHarmonics * NPowers> fQ{}; // Q_{n,p} at [n * NPowers + p]
+};
+
+#endif
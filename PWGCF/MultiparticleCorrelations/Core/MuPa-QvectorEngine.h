@@ -0,0 +1,208 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MuPa-QvectorEngine.h
+/// \brief Compile-time sized Q-vectors Q_{n,p} = sum_i w_i^p exp(i n phi_i) and the generic multiparticle correlators built from them
+///
+/// The number of harmonics, powers and the maximum order of the correlators are template parameters:
+/// the Q-vectors live in a fixed array and the generic recursion of K. Gulbrandsen is instantiated once per order,
+/// so that its depth is known to the compiler. The order requested at run time selects the instantiation.
+/// The same correlators can be computed with explicit nested loops over all particle tuples, split over threads,
+/// for the event-by-event cross-check of the Q-vector results.
+
+#ifndef PWGCF_MULTIPARTICLECORRELATIONS_CORE_MUPA_QVECTORENGINE_H_
+#define PWGCF_MULTIPARTICLECORRELATIONS_CORE_MUPA_QVECTORENGINE_H_
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "Common/Core/Harmonics.h"
+
+namespace mupa
+{
+template <int NHarmonics, int NPowers, int MaxOrder = NPowers - 1>
+class QvectorEngine
+{
+ public:
+  using Complex = std::complex<double>;
+
+  static_assert(MaxOrder < NPowers, "a correlator of order n needs the Q-vectors up to power n");
+
+  /// Fill the Q-vectors from scratch
+  /// \param nParticles Number of particles
+  /// \param phi Azimuthal angles
+  /// \param weights Particle weights
+  void Fill(int nParticles, const double* phi, const double* weights)
+  {
+    fQ.fill(Complex(0., 0.));
+    double cosN[NHarmonics], sinN[NHarmonics];
+    for (int i = 0; i < nParticles; ++i) {
+      harmonics::compute(phi[i], NHarmonics - 1, cosN, sinN);
+      for (int n = 0; n < NHarmonics; ++n) {
+        double w = 1.;
+        for (int p = 0; p < NPowers; ++p) {
+          fQ[n * NPowers + p] += Complex(w * cosN[n], w * sinN[n]);
+          w *= weights[i];
+        }
+      }
+    }
+    fWeightDone.fill(false);
+  }
+
+  /// \return Q_{n,p}, using Q_{-n,p} = Q_{n,p}*; the range is not checked, see IsComputable()
+  Complex Q(int n, int p) const
+  {
+    return n >= 0 ? fQ[n * NPowers + p] : std::conj(fQ[-n * NPowers + p]);
+  }
+
+  /// \return true if the stored Q-vectors are enough for the correlator with these harmonics
+  static bool IsComputable(int n, const int* harmonics)
+  {
+    // the recursion only needs the sums of subsets of the harmonics
+    int sumPos = 0, sumNeg = 0;
+    for (int i = 0; i < n; ++i) {
+      (harmonics[i] > 0 ? sumPos : sumNeg) += std::abs(harmonics[i]);
+    }
+    return n > 0 && n <= MaxOrder && std::max(sumPos, sumNeg) < NHarmonics;
+  }
+
+  /// Generic n-particle correlator <exp[i(n1*phi1+...+nn*phin)]>, not normalised
+  Complex Correlator(int n, const int* harmonics) const
+  {
+    std::array<int, MaxOrder> h{};
+    std::copy(harmonics, harmonics + n, h.begin());
+    return Dispatch<1>(n, h.data());
+  }
+
+  /// Normalisation of the n-particle correlators, the correlator with all harmonics equal to zero
+  /// It is the same for all the correlators of one order, so it is computed once per filling
+  double Weight(int n)
+  {
+    if (!fWeightDone[n]) {
+      std::array<int, MaxOrder> h{};
+      fWeight[n] = Dispatch<1>(n, h.data()).real();
+      fWeightDone[n] = true;
+    }
+    return fWeight[n];
+  }
+
+  /// Same correlator and its normalisation from explicit nested loops over all the tuples of distinct particles
+  /// The outer loop is split over nThreads threads
+  static void NestedLoop(int n, const int* harmonics, int nParticles, const double* phi, const double* weights, int nThreads, Complex& value, double& weight)
+  {
+    value = Complex(0., 0.);
+    weight = 0.;
+    if (n < 1 || n > nParticles) {
+      return;
+    }
+    nThreads = std::max(1, std::min(nThreads, nParticles));
+    std::vector<Complex> values(nThreads, Complex(0., 0.));
+    std::vector<double> sumWeights(nThreads, 0.);
+    auto work = [&](int thread) {
+      std::vector<char> used(nParticles, 0);
+      for (int i = thread; i < nParticles; i += nThreads) {
+        used[i] = 1;
+        NestedLoopStep(1, n, harmonics, nParticles, phi, weights, used.data(), harmonics[0] * phi[i], weights[i], values[thread], sumWeights[thread]);
+        used[i] = 0;
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < nThreads; ++t) {
+      threads.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (int t = 0; t < nThreads; ++t) {
+      value += values[t];
+      weight += sumWeights[t];
+    }
+  }
+
+ private:
+  template <int N>
+  Complex Dispatch(int n, int* harmonics) const
+  {
+    if constexpr (N < MaxOrder) {
+      if (n != N) {
+        return Dispatch<N + 1>(n, harmonics);
+      }
+    }
+    return Recursion<N>(harmonics, 1, 0);
+  }
+
+  /// Recursion of K. Gulbrandsen (gulbrand@nbi.dk) for the correlators, with the order N fixed
+  template <int N>
+  Complex Recursion(int* harmonic, int mult, int skip) const
+  {
+    constexpr int nm1 = N - 1;
+    Complex c(Q(harmonic[nm1], mult));
+    if constexpr (N == 1) {
+      return c;
+    } else {
+      c *= Recursion<nm1>(harmonic, 1, 0);
+      if (nm1 == skip) {
+        return c;
+      }
+      const int multp1 = mult + 1;
+      constexpr int nm2 = N - 2;
+      int counter1 = 0;
+      int hhold = harmonic[counter1];
+      harmonic[counter1] = harmonic[nm2];
+      harmonic[nm2] = hhold + harmonic[nm1];
+      Complex c2(Recursion<nm1>(harmonic, multp1, nm2));
+      int counter2 = N - 3;
+      while (counter2 >= skip) {
+        harmonic[nm2] = harmonic[counter1];
+        harmonic[counter1] = hhold;
+        ++counter1;
+        hhold = harmonic[counter1];
+        harmonic[counter1] = harmonic[nm2];
+        harmonic[nm2] = hhold + harmonic[nm1];
+        c2 += Recursion<nm1>(harmonic, multp1, counter2);
+        --counter2;
+      }
+      harmonic[nm2] = harmonic[counter1];
+      harmonic[counter1] = hhold;
+      return c - double(mult) * c2;
+    }
+  }
+
+  static void NestedLoopStep(int depth, int n, const int* harmonics, int nParticles, const double* phi, const double* weights, char* used,
+                             double angle, double w, Complex& value, double& weight)
+  {
+    if (depth == n) {
+      value += w * Complex(std::cos(angle), std::sin(angle));
+      weight += w;
+      return;
+    }
+    for (int i = 0; i < nParticles; ++i) {
+      if (used[i]) {
+        continue;
+      }
+      used[i] = 1;
+      NestedLoopStep(depth + 1, n, harmonics, nParticles, phi, weights, used, angle + harmonics[depth] * phi[i], w * weights[i], value, weight);
+      used[i] = 0;
+    }
+  }
+
+  std::array<Complex, NHarmonics * NPowers> fQ{}; // Q_{n,p} at [n * NPowers + p]
+  std::array<double, MaxOrder + 1> fWeight{};     // cached normalisation per order
+  std::array<bool, MaxOrder + 1> fWeightDone{};   // normalisation already computed since the last filling
+};
+} // namespace mupa
+
+#endif // PWGCF_MULTIPARTICLECORRELATIONS_CORE_MUPA_QVECTORENGINE_H_
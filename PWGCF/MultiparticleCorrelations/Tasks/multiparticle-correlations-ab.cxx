@@ -24,6 +24,7 @@ using namespace o2::framework;
 #include "Riostream.h"
 #include "TRandom3.h"
 #include <TComplex.h>
+#include "Common/Core/Harmonics.h"
 using namespace std;
 
 // *) Enums:
@@ -114,6 +115,7 @@ struct MultiparticleCorrelationsAB // this name is used in lower-case format to
     Double_t dPhi = 0.; //, dPt = 0., dEta = 0.;
     // Double_t wPhi = 1., wPt = 1., wEta = 1.;
     Double_t wToPowerP = 1.; // final particle weight raised to power p
+    Double_t dCosN[gMaxHarmonic * gMaxCorrelator + 1], dSinN[gMaxHarmonic * gMaxCorrelator + 1];
     for (auto& track : tracks) {
 
       // *) Fill particle histograms for reconstructed data before particle cuts:
@@ -131,12 +133,13 @@ struct MultiparticleCorrelationsAB // this name is used in lower-case format to
       dPhi = track.phi();
       // dPt  = track.pt();
       // dEta = track.eta();
+      harmonics::compute<Double_t>(dPhi, gMaxHarmonic * gMaxCorrelator, dCosN, dSinN); // cos(h*dPhi) and sin(h*dPhi) of all harmonics at once
       for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
         for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
           // if (fUseWeights[0]||fUseWeights[1]||fUseWeights[2]) {
           //   wToPowerP = pow(wPhi*wPt*wEta,wp);
           // }
-          qv_a.fQvector[h][wp] += TComplex(wToPowerP * TMath::Cos(h * dPhi), wToPowerP * TMath::Sin(h * dPhi));
+          qv_a.fQvector[h][wp] += TComplex(wToPowerP * dCosN[h], wToPowerP * dSinN[h]);
         } // for(Int_t wp=0;wp<gMaxCorrelator+1;wp++)
       }   // for(Int_t h=0;h<gMaxHarmonic*gMaxCorrelator+1;h++)
 
@@ -30,6 +30,7 @@
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/TrackSelectionTables.h"
+#include "PWGCF/MultiparticleCorrelations/Core/MuPa-QvectorEngine.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -448,6 +449,12 @@ struct MultiParticleCorrelationsARTask {
   // the actual value of the symmetric cumulant is computed in the post processing by parsing the output
   Configurable<std::vector<int>> cfgSC = {"SymmetricCumulants", {23, 24, 34}, "Symmetric Cumulants to be computed"};
 
+  // configurables for cross-checking the correlators with nested loops event by event
+  // the nested loops scale like M^n, so they are only run for events with few tracks
+  Configurable<bool> cfgNestedLoops = {"NestedLoops", false, "Cross-check the correlators with nested loops"};
+  Configurable<int> cfgNestedLoopsMaxMultiplicity = {"NestedLoopsMaxMultiplicity", 15, "Maximum number of tracks for running the nested loops"};
+  Configurable<int> cfgNestedLoopsThreads = {"NestedLoopsThreads", 4, "Number of threads used by the nested loops"};
+
   // declare histogram registry
   HistogramRegistry fRegistry{
     "MultiParticleCorrelationsARTask",
@@ -458,7 +465,7 @@ struct MultiParticleCorrelationsARTask {
 
   // declare objects for computing qvectors
   // global object holding the qvectors
-  std::array<std::array<TComplex, AR::MaxHarmonic>, AR::MaxPower> fQvectors;
+  mupa::QvectorEngine<AR::MaxHarmonic, AR::MaxPower> fQvectors;
   // global object holding all azimuthal angles and weights, used for computing correlators as a function of event variables
   std::vector<double> fAzimuthalAnglesAll;
   std::vector<double> fWeightsAll;
@@ -604,6 +611,9 @@ struct MultiParticleCorrelationsARTask {
             fCorrelators.end()) {
           continue;
         } else {
+          if (!decltype(fQvectors)::IsComputable(cor.size(), cor.data())) {
+            LOG(fatal) << "Correlator of order " << cor.size() << " from SC " << SC << " needs harmonics or powers beyond MaxHarmonic = " << AR::MaxHarmonic << " and MaxPower = " << AR::MaxPower;
+          }
           fCorrelators.push_back(cor);
           // use a map, so we can later figure out at which list index the correlators resides at
           fMapCorToIndex.insert({cor, Index});
@@ -807,29 +817,9 @@ struct MultiParticleCorrelationsARTask {
   }
 
   // Calculate all Q-vectors
-  void CalculateQvectors(std::vector<double> AzimuthalAngles, std::vector<double> Weights)
+  void CalculateQvectors(std::vector<double> const& AzimuthalAngles, std::vector<double> const& Weights)
   {
-    // Make sure all Q-vectors are initially zero
-    for (int h = 0; h < AR::MaxHarmonic; h++) {
-      for (int p = 0; p < AR::MaxPower; p++) {
-        fQvectors[h][p] = TComplex(0., 0.);
-      }
-    }
-    // Calculate Q-vectors for available angles and weights
-    double dPhi = 0.;
-    double wPhi = 1.;         // particle weight
-    double wPhiToPowerP = 1.; // particle weight raised to power p
-    for (std::size_t i = 0; i < AzimuthalAngles.size(); i++) {
-      dPhi = AzimuthalAngles.at(i);
-      wPhi = Weights.at(i);
-      for (int h = 0; h < AR::MaxHarmonic; h++) {
-        for (int p = 0; p < AR::MaxPower; p++) {
-          wPhiToPowerP = TMath::Power(wPhi, p);
-          fQvectors[h][p] += TComplex(wPhiToPowerP * TMath::Cos(h * dPhi),
-                                      wPhiToPowerP * TMath::Sin(h * dPhi));
-        }
-      }
-    }
+    fQvectors.Fill(AzimuthalAngles.size(), AzimuthalAngles.data(), Weights.data());
   }
 
   void FillCorrelators(double Centrality)
@@ -841,27 +831,28 @@ struct MultiParticleCorrelationsARTask {
     // compute q vectors for all angles in the event
     CalculateQvectors(fAzimuthalAnglesAll, fWeightsAll);
     int Index;
-    for (int eventDep = 0; eventDep < AR::kLAST_CorEventDep; eventDep++) {
-      for (auto correlator : fCorrelators) {
-        if (fAzimuthalAnglesAll.size() <= correlator.size()) {
-          if (cfgVerbosity.value) {
-            LOG(warning) << "BEGIN WARNING";
-            LOG(warning) << "Not enough tracks in the event to compute the correlator v_{";
-            std::for_each(correlator.begin(), correlator.end(), [](const auto& e) { LOG(warning) << e << ","; });
-            LOG(warning) << "}!";
-            LOG(warning) << "END WARNING";
-          }
-          continue;
+    for (auto const& correlator : fCorrelators) {
+      if (fAzimuthalAnglesAll.size() <= correlator.size()) {
+        if (cfgVerbosity.value) {
+          LOG(warning) << "BEGIN WARNING";
+          LOG(warning) << "Not enough tracks in the event to compute the correlator v_{";
+          std::for_each(correlator.begin(), correlator.end(), [](const auto& e) { LOG(warning) << e << ","; });
+          LOG(warning) << "}!";
+          LOG(warning) << "END WARNING";
         }
-        // get index of the correlator in fCorrelator list
-        Index = fMapCorToIndex[correlator];
-        // compute the correlator
-        ComputeCorrelator(correlator, &corr, &weight);
-        // fill the correlator depending on the event variable
-        dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kINTEGRATED))->Fill(0.5, corr, weight);
-        dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kMULDEP))->Fill(fEventDepHists[AR::kMULDEP]->FindBin(fAzimuthalAnglesAll.size()), corr, weight);
-        dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kCENDEP))->Fill(fEventDepHists[AR::kCENDEP]->FindBin(Centrality), corr, weight);
+        continue;
+      }
+      // get index of the correlator in fCorrelator list
+      Index = fMapCorToIndex[correlator];
+      // compute the correlator
+      ComputeCorrelator(correlator, &corr, &weight);
+      if (cfgNestedLoops.value) {
+        CheckWithNestedLoops(correlator, fAzimuthalAnglesAll, fWeightsAll, corr);
       }
+      // fill the correlator depending on the event variable
+      dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kINTEGRATED))->Fill(0.5, corr, weight);
+      dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kMULDEP))->Fill(fEventDepHists[AR::kMULDEP]->FindBin(fAzimuthalAnglesAll.size()), corr, weight);
+      dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kCENDEP))->Fill(fEventDepHists[AR::kCENDEP]->FindBin(Centrality), corr, weight);
     }
 
     // loop over all track variables
@@ -875,7 +866,7 @@ struct MultiParticleCorrelationsARTask {
         corr = 0.;
         weight = 1.;
         // loop over all correlators
-        for (auto correlator : fCorrelators) {
+        for (auto const& correlator : fCorrelators) {
           // check if there are enough tracks for computing the correlator
           if (fAzimuthalAnglesTrackDep[trackDep].at(bin).size() <= correlator.size()) {
             if (cfgVerbosity.value) {
@@ -892,6 +883,9 @@ struct MultiParticleCorrelationsARTask {
           Index = fMapCorToIndex[correlator];
           // compute the correlator in this bin of the track variable
           ComputeCorrelator(correlator, &corr, &weight);
+          if (cfgNestedLoops.value) {
+            CheckWithNestedLoops(correlator, fAzimuthalAnglesTrackDep[trackDep].at(bin), fWeightsTrackDep[trackDep].at(bin), corr);
+          }
           // fill it into the corresponding profile
           dynamic_cast<TProfile*>(dynamic_cast<TList*>(fCorrelatorList->At(Index))->At(AR::kLAST_CorEventDep + trackDep))->Fill(fTrackDepHists[trackDep]->GetBinCenter(bin + 1), corr, weight);
         }
@@ -899,36 +893,31 @@ struct MultiParticleCorrelationsARTask {
     }
   };
 
-  void ComputeCorrelator(std::vector<int> Correlator, double* value, double* weight)
+  void ComputeCorrelator(std::vector<int> const& Correlator, double* value, double* weight)
   {
     // compute a correlator
     // write back its value and weight into the passed pointers
-    double Value = 0., Weight = 1.;
+    // the weight only depends on the order of the correlator and is computed once per set of Q-vectors
+    double Value = 0., Weight = fQvectors.Weight(Correlator.size());
     switch (static_cast<int>(Correlator.size())) {
       case 2:
         Value = Two(Correlator.at(0), Correlator.at(1)).Re();
-        Weight = Two(0, 0).Re();
         break;
       case 3:
         Value = Three(Correlator.at(0), Correlator.at(1), Correlator.at(2)).Re();
-        Weight = Three(0, 0, 0).Re();
         break;
       case 4:
         Value = Four(Correlator.at(0), Correlator.at(1), Correlator.at(2), Correlator.at(3)).Re();
-        Weight = Four(0, 0, 0, 0).Re();
         break;
       case 5:
         Value = Five(Correlator.at(0), Correlator.at(1), Correlator.at(2), Correlator.at(3), Correlator.at(4)).Re();
-        Weight = Five(0, 0, 0, 0, 0).Re();
         break;
       case 6:
         Value = Six(Correlator.at(0), Correlator.at(1), Correlator.at(2), Correlator.at(3), Correlator.at(4), Correlator.at(5)).Re();
-        Weight = Six(0, 0, 0, 0, 0, 0).Re();
         break;
       default:
-        Value = Recursion(Correlator.size(), Correlator.data()).Re();
-        Weight =
-          Recursion(Correlator.size(), std::vector<int>(Correlator.size(), 0).data()).Re();
+        // generic recursion, instantiated for each order up to AR::MaxPower - 1
+        Value = fQvectors.Correlator(Correlator.size(), Correlator.data()).real();
     }
     // correlators are not normalized yet
     Value /= Weight;
@@ -937,16 +926,30 @@ struct MultiParticleCorrelationsARTask {
     *weight = Weight;
   }
 
-  TComplex Q(int n, int p)
+  void CheckWithNestedLoops(std::vector<int> const& Correlator, std::vector<double> const& AzimuthalAngles, std::vector<double> const& Weights, double value)
   {
-    // return Qvector from fQvectors array
-    if (n > AR::MaxHarmonic || p > AR::MaxPower) {
-      LOG(fatal) << "Harmonic " << n << ">" << AR::MaxHarmonic << "(MaxHarmonic) or the power " << p << ">" << AR::MaxPower << "(MaxPower)";
+    // compare a correlator computed with Q-vectors with the one from nested loops
+    if (static_cast<int>(AzimuthalAngles.size()) > cfgNestedLoopsMaxMultiplicity.value) {
+      return;
+    }
+    std::complex<double> nestedValue;
+    double nestedWeight = 0.;
+    mupa::QvectorEngine<AR::MaxHarmonic, AR::MaxPower>::NestedLoop(Correlator.size(), Correlator.data(), AzimuthalAngles.size(), AzimuthalAngles.data(), Weights.data(),
+                                                                   cfgNestedLoopsThreads.value, nestedValue, nestedWeight);
+    if (nestedWeight <= 0.) {
+      return;
     }
-    if (n >= 0) {
-      return fQvectors[n][p];
+    double nested = nestedValue.real() / nestedWeight;
+    if (std::abs(nested - value) > 1.e-8 * std::max(1., std::abs(nested))) {
+      LOG(fatal) << "Correlator from nested loops " << nested << " differs from the one from Q-vectors " << value << " (" << AzimuthalAngles.size() << " tracks)";
     }
-    return TComplex::Conjugate(fQvectors[-n][p]);
+  }
+
+  TComplex Q(int n, int p)
+  {
+    // return Qvector from fQvectors, the ranges of n and p are checked once for all the correlators in init
+    std::complex<double> q = fQvectors.Q(n, p);
+    return TComplex(q.real(), q.imag());
   }
 
   TComplex Two(int n1, int n2)
@@ -1253,43 +1256,6 @@ struct MultiParticleCorrelationsARTask {
     return six;
   }
 
-  TComplex Recursion(int n, int* harmonic, int mult = 1, int skip = 0)
-  {
-    // Calculate multi-particle correlators by using recursion (an improved
-    // faster version) originally developed by Kristjan Gulbrandsen
-    // (gulbrand@nbi.dk).
-    int nm1 = n - 1;
-    TComplex c(Q(harmonic[nm1], mult));
-    if (nm1 == 0)
-      return c;
-    c *= Recursion(nm1, harmonic);
-    if (nm1 == skip)
-      return c;
-    int multp1 = mult + 1;
-    int nm2 = n - 2;
-    int counter1 = 0;
-    int hhold = harmonic[counter1];
-    harmonic[counter1] = harmonic[nm2];
-    harmonic[nm2] = hhold + harmonic[nm1];
-    TComplex c2(Recursion(nm1, harmonic, multp1, nm2));
-    int counter2 = n - 3;
-    while (counter2 >= skip) {
-      harmonic[nm2] = harmonic[counter1];
-      harmonic[counter1] = hhold;
-      ++counter1;
-      hhold = harmonic[counter1];
-      harmonic[counter1] = harmonic[nm2];
-      harmonic[nm2] = hhold + harmonic[nm1];
-      c2 += Recursion(nm1, harmonic, multp1, counter2);
-      --counter2;
-    }
-    harmonic[nm2] = harmonic[counter1];
-    harmonic[counter1] = hhold;
-    if (mult == 1)
-      return c - c2;
-    return c - double(mult) * c2;
-  }
-
   using CollisionsInstance = soa::Join<aod::Collisions, aod::CentRun2V0Ms, aod::Mults>;
   using TracksInstance = soa::Join<aod::Tracks, aod::TracksDCA, aod::TracksExtra>;
 
@@ -137,6 +137,8 @@ int trkMultPos[kDptDptNoOfSpecies];  // multiplicity of positive tracks
 int trkMultNeg[kDptDptNoOfSpecies];  // multiplicity of negative tracks
 int partMultPos[kDptDptNoOfSpecies]; // multiplicity of positive particles
 int partMultNeg[kDptDptNoOfSpecies]; // multiplicity of negative particles
+
+bool skipTrackQA = false; // skip the before/after selection track QA histograms
 } // namespace o2::analysis::dptdptfilter
 
 using namespace dptdptfilter;
@@ -155,6 +157,7 @@ struct DptDptFilter {
   Configurable<int> cfgRecoIdMethod{"recoidmethod", 0, "Method for identifying reconstructed tracks: 0 No PID, 1 PID, 2 mcparticle. Default 0"};
   Configurable<o2::analysis::TrackSelectionCfg> cfgTrackSelection{"tracksel", {false, false, 0, 70, 0.8, 2.4, 3.2}, "Track selection: {useit: true/false, ongen: true/false, tpccls, tpcxrws, tpcxrfc, dcaxy, dcaz}. Default {false,0.70.0.8,2.4,3.2}"};
   Configurable<bool> cfgTraceCollId0{"tracecollid0", false, "Trace particles in collisions id 0. Default false"};
+  Configurable<bool> cfgSkipTrackQA{"skiptrackqa", false, "Skip the filling of the before/after selection track QA histograms. Default false"};
 
   OutputObj<TList> fOutput{"DptDptFilterGlobalInfo", OutputObjHandlingPolicy::AnalysisObject};
 
@@ -168,6 +171,9 @@ struct DptDptFilter {
   {
     using namespace dptdptfilter;
 
+    if (skipTrackQA) {
+      return;
+    }
     fhPB->Fill(track.p());
     fhPtB->Fill(track.pt());
     fhEtaB->Fill(track.eta());
@@ -186,6 +192,9 @@ struct DptDptFilter {
   {
     using namespace dptdptfilter;
 
+    if (skipTrackQA) {
+      return;
+    }
     /* the charged species should have been called first so avoid double counting */
     if (sp == kDptDptCharged) {
       fhEtaA->Fill(track.eta());
@@ -295,31 +304,16 @@ struct DptDptFilter {
         nsigmas[kDptDptProton] = track.tpcNSigmaPr();
       }
     }
-    float min_nsigma = 999.0f;
-    MatchRecoGenSpecies sp_min_nsigma = kWrongSpecies;
+    /* one bit per species within the n-sigma window, the track is identified */
+    /* only if exactly one species matches, otherwise it is a double match    */
+    uint32_t matches = 0;
     for (int sp = 0; sp < kDptDptNoOfSpecies; ++sp) {
-      if (nsigmas[sp] < min_nsigma) {
-        min_nsigma = nsigmas[sp];
-        sp_min_nsigma = MatchRecoGenSpecies(sp);
-      }
+      matches |= uint32_t(nsigmas[sp] < 3.0f) << sp;
     }
-    bool doublematch = false;
-    if (min_nsigma < 3.0) {
-      for (int sp = 0; (sp < kDptDptNoOfSpecies) && !doublematch; ++sp) {
-        if (sp != sp_min_nsigma) {
-          if (nsigmas[sp] < 3.0) {
-            doublematch = true;
-          }
-        }
-      }
-      if (doublematch) {
-        return kWrongSpecies;
-      } else {
-        return sp_min_nsigma;
-      }
-    } else {
+    if (matches == 0 || (matches & (matches - 1)) != 0) {
       return kWrongSpecies;
     }
+    return MatchRecoGenSpecies(__builtin_ctz(matches));
   }
 
   template <typename ParticleObject>
@@ -432,6 +426,7 @@ struct DptDptFilter {
       useOwnTrackSelection = false;
     }
     traceCollId0 = cfgTraceCollId0;
+    skipTrackQA = cfgSkipTrackQA;
 
     /* if the system type is not known at this time, we have to put the initialization somewhere else */
     fSystem = getSystemType(cfgSystem);
@@ -22,6 +22,9 @@
 #include <TH3F.h>
 #include <TDatabasePDG.h>
 
+#include <algorithm>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -53,6 +56,9 @@ struct FilterCF {
   O2_DEFINE_CONFIGURABLE(cfgVerbosity, int, 1, "Verbosity level (0 = major, 1 = per collision)")
   O2_DEFINE_CONFIGURABLE(cfgTrigger, int, 7, "Trigger choice: (0 = none, 7 = sel7, 8 = sel8)")
   O2_DEFINE_CONFIGURABLE(cfgCollisionFlags, uint16_t, aod::collision::CollisionFlagsRun2::Run2VertexerTracks, "Request collision flags if non-zero (0 = off, 1 = Run2VertexerTracks)")
+  O2_DEFINE_CONFIGURABLE(cfgSortTracks, bool, false, "Write the tracks of each collision sorted by decreasing pT, with the number of trigger-eligible tracks in CFTriggerRanges")
+  O2_DEFINE_CONFIGURABLE(cfgTriggerPtMin, float, 2.0f, "Minimal pT of the trigger-eligible tracks, when sorting the tracks")
+  O2_DEFINE_CONFIGURABLE(cfgTruncateKinematics, bool, false, "Store pT, eta and phi with reduced precision")
 
   // Filters and input definitions
   Filter collisionZVtxFilter = nabs(aod::collision::posZ) < cfgCutVertex;
@@ -69,6 +75,7 @@ struct FilterCF {
 
   Produces<aod::CFCollisions> outputCollisions;
   Produces<aod::CFTracks> outputTracks;
+  Produces<aod::CFTriggerRanges> outputTriggerRanges;
 
   Produces<aod::CFMcCollisions> outputMcCollisions;
   Produces<aod::CFMcParticles> outputMcParticles;
@@ -86,6 +93,20 @@ struct FilterCF {
     return false;
   }
 
+  struct TrackEntry {
+    float pt;
+    float eta;
+    float phi;
+    int8_t sign;
+    uint8_t trackType;
+  };
+  std::vector<TrackEntry> trackEntries; // tracks of the current collision, reused
+
+  float storedValue(float value)
+  {
+    return cfgTruncateKinematics ? truncateFloatFraction(value) : value;
+  }
+
   void processData(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CFMultiplicities>>::iterator const& collision, aod::BCsWithTimestamps const&, soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>> const& tracks)
   {
     if (cfgVerbosity > 0) {
@@ -99,6 +120,7 @@ struct FilterCF {
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     outputCollisions(-1, bc.runNumber(), collision.posZ(), collision.multiplicity(), bc.timestamp());
 
+    trackEntries.clear();
     for (auto& track : tracks) {
       uint8_t trackType = 0;
       if (track.isGlobalTrack()) {
@@ -106,12 +128,22 @@ struct FilterCF {
       } else if (track.isGlobalTrackSDD()) {
         trackType = 2;
       }
-
-      outputTracks(outputCollisions.lastIndex(), -1, track.pt(), track.eta(), track.phi(), track.sign(), trackType);
+      trackEntries.push_back({track.pt(), track.eta(), track.phi(), track.sign(), trackType});
 
       yields->Fill(collision.multiplicity(), track.pt(), track.eta());
       etaphi->Fill(collision.multiplicity(), track.eta(), track.phi());
     }
+
+    // with the sorting the trigger-eligible tracks are the first nTriggers tracks of the collision
+    int32_t nTriggers = -1;
+    if (cfgSortTracks) {
+      std::sort(trackEntries.begin(), trackEntries.end(), [](const TrackEntry& a, const TrackEntry& b) { return a.pt > b.pt; });
+      nTriggers = std::partition_point(trackEntries.begin(), trackEntries.end(), [this](const TrackEntry& t) { return t.pt > cfgTriggerPtMin; }) - trackEntries.begin();
+    }
+    for (const auto& t : trackEntries) {
+      outputTracks(outputCollisions.lastIndex(), -1, storedValue(t.pt), storedValue(t.eta), storedValue(t.phi), t.sign, t.trackType);
+    }
+    outputTriggerRanges(nTriggers);
   }
   PROCESS_SWITCH(FilterCF, processData, "Process data", true);
 
@@ -128,6 +160,7 @@ struct FilterCF {
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     // NOTE only works if we save all MC collisions...
     outputCollisions(collision.mcCollisionId(), bc.runNumber(), collision.posZ(), collision.multiplicity(), bc.timestamp());
+    outputTriggerRanges(-1); // MC tracks are kept in input order
 
     for (auto& track : tracks) {
       uint8_t trackType = 0;
@@ -282,6 +315,7 @@ struct FilterCF {
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
       // NOTE works only when we store all MC collisions (as we do here)
       outputCollisions(collision.mcCollisionId(), bc.runNumber(), collision.posZ(), collision.multiplicity(), bc.timestamp());
+      outputTriggerRanges(-1); // MC tracks are kept in input order
 
       for (auto& track : groupedTracks) {
         uint8_t trackType = 0;
@@ -25,11 +25,17 @@
 #include "PWGCF/DataModel/CorrelationsDerived.h"
 #include "PWGCF/Core/CorrelationContainer.h"
 #include "PWGCF/Core/PairCuts.h"
+#include "PWGCF/Core/StepTHnAccumulator.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "DataFormatsParameters/GRPMagField.h"
 
 #include <TH1F.h>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <deque>
+#include <map>
+#include <vector>
 #include <TDirectory.h>
 #include <THn.h>
 
@@ -75,6 +81,9 @@ struct CorrelationTask {
   O2_DEFINE_CONFIGURABLE(cfgEfficiencyAssociated, std::string, "", "CCDB path to efficiency object for associated particles")
 
   O2_DEFINE_CONFIGURABLE(cfgNoMixedEvents, int, 5, "Number of mixed events per event")
+  O2_DEFINE_CONFIGURABLE(cfgMixingPoolDepth, int, 0, "Derived data: number of events per z-vertex and multiplicity bin kept for mixing across dataframes (0 = mix within the dataframe)")
+  O2_DEFINE_CONFIGURABLE(cfgMixingPoolMaxTracks, int, 2000000, "Derived data: maximum number of tracks kept in the mixing pool over all bins")
+  O2_DEFINE_CONFIGURABLE(cfgMixingMaps, bool, false, "Derived data: fill the eta-phi maps of the trigger and associated particles per mixing bin, from which the mixed event is computed with CorrelationContainer::fillMixedFromSingleParticleMaps")
 
   O2_DEFINE_CONFIGURABLE(cfgVerbosity, int, 1, "Verbosity level (0 = major, 1 = per collision)")
 
@@ -85,6 +94,9 @@ struct CorrelationTask {
   ConfigurableAxis axisPtAssoc{"axisPtAssoc", {VARIABLE_WIDTH, 0.5, 1.0, 1.5, 2.0, 3.0, 4.0, 6.0}, "pt associated axis for histograms"};
   ConfigurableAxis axisMultiplicity{"axisMultiplicity", {VARIABLE_WIDTH, 0, 5, 10, 20, 30, 40, 50, 100.1}, "multiplicity / centrality axis for histograms"};
 
+  ConfigurableAxis axisEtaMixingMap{"axisEtaMixingMap", {16, -0.8, 0.8}, "eta axis for the mixing maps (same bin width as axisDeltaEta)"};
+  ConfigurableAxis axisPhiMixingMap{"axisPhiMixingMap", {72, 0, TwoPI}, "phi axis for the mixing maps (same bin width as axisDeltaPhi)"};
+
   ConfigurableAxis axisVertexEfficiency{"axisVertexEfficiency", {10, -10, 10}, "vertex axis for efficiency histograms"};
   ConfigurableAxis axisEtaEfficiency{"axisEtaEfficiency", {20, -1.0, 1.0}, "eta axis for efficiency histograms"};
   ConfigurableAxis axisPtEfficiency{"axisPtEfficiency", {VARIABLE_WIDTH, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.25, 1.5, 1.75, 2.0, 2.25, 2.5, 2.75, 3.0, 3.25, 3.5, 3.75, 4.0, 4.5, 5.0, 6.0, 7.0, 8.0}, "pt axis for efficiency histograms"};
@@ -106,16 +118,133 @@ struct CorrelationTask {
   OutputObj<CorrelationContainer> same{"sameEvent"};
   OutputObj<CorrelationContainer> mixed{"mixedEvent"};
 
+  // Flat copy of an efficiency map (eta, pt, multiplicity, z-vtx) looked up without the THn calls.
+  // The bins, including under- and overflow, are the ones of the map, so that the values are the same as
+  // with FindBin and GetBinContent; the multiplicity and vertex part of the index is computed once per event.
+  struct EfficiencyLookup {
+    struct Axis {
+      int nBins = 0;
+      double min = 0.;
+      double max = 0.;
+      std::vector<double> edges; // empty for fixed bin width
+      int findBin(double x) const
+      {
+        if (x < min) {
+          return 0;
+        } else if (!(x < max)) {
+          return nBins + 1;
+        } else if (edges.empty()) {
+          return 1 + int(nBins * (x - min) / (max - min));
+        }
+        return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+      }
+    };
+    std::array<Axis, 4> axes;
+    std::array<long, 4> strides;
+    std::vector<float> values;
+
+    void set(THn* eff)
+    {
+      long size = 1;
+      for (int i = 3; i >= 0; i--) {
+        TAxis* axis = eff->GetAxis(i);
+        axes[i].nBins = axis->GetNbins();
+        axes[i].min = axis->GetXmin();
+        axes[i].max = axis->GetXmax();
+        axes[i].edges.clear();
+        if (axis->GetXbins()->GetSize() > 0) {
+          axes[i].edges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetNbins() + 1);
+        }
+        strides[i] = size;
+        size *= axes[i].nBins + 2;
+      }
+      values.resize(size);
+      int bins[4];
+      for (long bin = 0; bin < size; bin++) {
+        for (int i = 0; i < 4; i++) {
+          bins[i] = (bin / strides[i]) % (axes[i].nBins + 2);
+        }
+        values[bin] = eff->GetBinContent(bins);
+      }
+    }
+    long eventOffset(float multiplicity, float posZ) const
+    {
+      return axes[2].findBin(multiplicity) * strides[2] + axes[3].findBin(posZ) * strides[3];
+    }
+    float get(long eventOffset, float eta, float pt) const
+    {
+      return values[eventOffset + axes[0].findBin(eta) * strides[0] + axes[1].findBin(pt) * strides[1]];
+    }
+  };
+
   struct Config {
     bool mPairCuts = false;
     THn* mEfficiencyTrigger = nullptr;
     THn* mEfficiencyAssociated = nullptr;
+    EfficiencyLookup mLookupTrigger;
+    EfficiencyLookup mLookupAssociated;
     bool efficiencyLoaded = false;
   } cfg;
 
+  // Particle with the accessors needed by the pair cuts, built from the particle caches
+  struct CachedParticle {
+    float mPt;
+    float mEta;
+    float mPhi;
+    int mSign;
+    float pt() const { return mPt; }
+    float eta() const { return mEta; }
+    float phi() const { return mPhi; }
+    int sign() const { return mSign; }
+  };
+
+  // Structure-of-arrays copy of the particles entering the pair loop
+  struct ParticleCache {
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> phi;
+    std::vector<float> weight; // event weight times efficiency correction
+    std::vector<int> sign;
+    std::vector<int64_t> globalIndex;
+
+    template <typename TTrack>
+    void add(TTrack const& track, float w)
+    {
+      pt.push_back(track.pt());
+      eta.push_back(track.eta());
+      phi.push_back(track.phi());
+      weight.push_back(w);
+      sign.push_back(track.sign());
+      globalIndex.push_back(track.globalIndex());
+    }
+    void clear()
+    {
+      pt.clear();
+      eta.clear();
+      phi.clear();
+      weight.clear();
+      sign.clear();
+      globalIndex.clear();
+    }
+    int size() const { return pt.size(); }
+    CachedParticle at(int i) const { return {pt[i], eta[i], phi[i], sign[i]}; }
+  };
+
   HistogramRegistry registry{"registry"};
   PairCuts mPairCuts;
 
+  // Buffers of fillCorrelations, kept to reuse their allocation
+  ParticleCache mTriggers;
+  ParticleCache mAssociated;
+  std::vector<float> mPairDeltaEta;
+  std::vector<float> mPairDeltaPhi;
+  std::vector<uint8_t> mPairAccepted;
+  std::vector<int64_t> mAssociatedBin; // part of the pair histogram bin index given by the associated particle
+
+  // Mixing pool kept across dataframes: associated particles of the last cfgMixingPoolDepth events per z-vertex and multiplicity bin
+  std::map<int, std::deque<ParticleCache>> mMixingPool;
+  long mMixingPoolTracks = 0; // number of tracks stored in the pool
+
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   using aodCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>>;
@@ -132,6 +261,13 @@ struct CorrelationTask {
     const int maxMixBin = axisMultiplicity->size() * axisVertex->size();
     registry.add("eventcount_same", "bin", {HistType::kTH1F, {{maxMixBin + 2, -2.5, -0.5 + maxMixBin, "bin"}}});
     registry.add("eventcount_mixed", "bin", {HistType::kTH1F, {{maxMixBin + 2, -2.5, -0.5 + maxMixBin, "bin"}}});
+    if (cfgMixingPoolDepth > 0) {
+      registry.add("mixingpool_occupancy", "events in the mixing pool", {HistType::kTH2F, {{maxMixBin + 2, -2.5, -0.5 + maxMixBin, "bin"}, {cfgMixingPoolDepth + 1, -0.5, cfgMixingPoolDepth + 0.5, "events in pool"}}});
+    }
+    if (cfgMixingMaps) {
+      registry.add("mixingMapTrigger", "trigger particles per mixing bin", {HistType::kTHnF, {{axisPtTrigger, "p_{T} (GeV/c)"}, {axisMultiplicity, "multiplicity / centrality"}, {axisVertex, "z-vtx (cm)"}, {axisEtaMixingMap, "#eta"}, {axisPhiMixingMap, "#varphi"}}});
+      registry.add("mixingMapAssociated", "associated particles per mixing bin", {HistType::kTHnF, {{axisPtAssoc, "p_{T} (GeV/c)"}, {axisMultiplicity, "multiplicity / centrality"}, {axisVertex, "z-vtx (cm)"}, {axisEtaMixingMap, "#eta"}, {axisPhiMixingMap, "#varphi"}}});
+    }
 
     mPairCuts.SetHistogramRegistry(&registry);
 
@@ -229,21 +365,12 @@ struct CorrelationTask {
     return true;
   }
 
-  template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
-  void fillCorrelations(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
+  // Copy the selected trigger particles into contiguous arrays, caching the efficiency corrections (too many FindBin lookups)
+  template <CorrelationContainer::CFStep step, typename TTracks>
+  void fillTriggerCache(TTracks& tracks1, float multiplicity, float posZ, float eventWeight)
   {
-    // Cache efficiency for particles (too many FindBin lookups)
-    float* efficiencyAssociated = nullptr;
-    if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-      if (cfg.mEfficiencyAssociated) {
-        efficiencyAssociated = new float[tracks2.size()];
-        int i = 0;
-        for (auto& track : tracks2) {
-          efficiencyAssociated[i++] = getEfficiencyCorrection(cfg.mEfficiencyAssociated, track.eta(), track.pt(), multiplicity, posZ);
-        }
-      }
-    }
-
+    mTriggers.clear();
+    const long effOffset = cfg.mEfficiencyTrigger ? cfg.mLookupTrigger.eventOffset(multiplicity, posZ) : 0;
     for (auto& track1 : tracks1) {
       // LOGF(info, "Track %f | %f | %f  %d %d", track1.eta(), track1.phi(), track1.pt(), track1.isGlobalTrack(), track1.isGlobalTrackSDD());
 
@@ -260,66 +387,171 @@ struct CorrelationTask {
       float triggerWeight = eventWeight;
       if constexpr (step == CorrelationContainer::kCFStepCorrected) {
         if (cfg.mEfficiencyTrigger) {
-          triggerWeight *= getEfficiencyCorrection(cfg.mEfficiencyTrigger, track1.eta(), track1.pt(), multiplicity, posZ);
+          triggerWeight *= cfg.mLookupTrigger.get(effOffset, track1.eta(), track1.pt());
         }
       }
+      mTriggers.add(track1, triggerWeight);
+    }
+  }
 
-      target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
-
-      for (auto& track2 : tracks2) {
-        if (track1.globalIndex() == track2.globalIndex()) {
-          // LOGF(info, "Track identical: %f | %f | %f || %f | %f | %f", track1.eta(), track1.phi(), track1.pt(),  track2.eta(), track2.phi(), track2.pt());
+  // Copy the selected associated particles into contiguous arrays, caching the efficiency corrections
+  template <CorrelationContainer::CFStep step, typename TTracks>
+  void fillAssociatedCache(TTracks& tracks2, float multiplicity, float posZ)
+  {
+    mAssociated.clear();
+    const long effOffset = cfg.mEfficiencyAssociated ? cfg.mLookupAssociated.eventOffset(multiplicity, posZ) : 0;
+    for (auto& track2 : tracks2) {
+      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+        if (!checkObject<step>(track2)) {
           continue;
         }
+      }
 
-        if constexpr (step <= CorrelationContainer::kCFStepTracked) {
-          if (!checkObject<step>(track2)) {
-            continue;
-          }
-        }
+      if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
+        continue;
+      }
 
-        if (cfgPtOrder != 0 && track2.pt() >= track1.pt()) {
-          continue;
+      float associatedWeight = 1.0f;
+      if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+        if (cfg.mEfficiencyAssociated) {
+          associatedWeight = cfg.mLookupAssociated.get(effOffset, track2.eta(), track2.pt());
         }
+      }
+      mAssociated.add(track2, associatedWeight);
+    }
+  }
 
-        if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
-          continue;
-        }
-        if (cfgPairCharge != 0 && cfgPairCharge * track1.sign() * track2.sign() < 0) {
-          continue;
-        }
+  // Correlate the cached trigger particles with a set of cached associated particles
+  template <CorrelationContainer::CFStep step, typename TTarget>
+  void fillPairs(TTarget target, ParticleCache const& associated, float multiplicity, float posZ, int magField)
+  {
+    const int nAssociated = associated.size();
+    mPairDeltaEta.resize(nAssociated);
+    mPairDeltaPhi.resize(nAssociated);
+    mPairAccepted.resize(nAssociated);
+
+    const float* associatedPt = associated.pt.data();
+    const float* associatedEta = associated.eta.data();
+    const float* associatedPhi = associated.phi.data();
+    const float* associatedWeight = associated.weight.data();
+    const int* associatedSign = associated.sign.data();
+    const int64_t* associatedIndex = associated.globalIndex.data();
+    float* deltaEta = mPairDeltaEta.data();
+    float* deltaPhi = mPairDeltaPhi.data();
+    uint8_t* accepted = mPairAccepted.data();
+
+    const bool ptOrder = (cfgPtOrder != 0);
+    const int pairCharge = cfgPairCharge;
+
+    // The pair histogram is filled by linear bin index through its accumulator, axes: delta eta, pT assoc, pT trig, multiplicity, delta phi, vertex
+    // The parts of the index depending only on the event, the trigger or the associated particle are computed once
+    auto accumulator = target->getPairAccumulator();
+    const int64_t strideDeltaEta = accumulator->getStride(0);
+    const int64_t strideDeltaPhi = accumulator->getStride(4);
+    int64_t eventBin = -1;
+    const int multiplicityBin = accumulator->findBin(3, multiplicity);
+    const int vertexBin = accumulator->findBin(5, posZ);
+    if (multiplicityBin >= 0 && vertexBin >= 0) {
+      eventBin = multiplicityBin * accumulator->getStride(3) + vertexBin * accumulator->getStride(5);
+    }
+    mAssociatedBin.resize(nAssociated);
+    for (int i = 0; i < nAssociated; i++) {
+      const int ptBin = accumulator->findBin(1, associatedPt[i]);
+      mAssociatedBin[i] = (ptBin < 0) ? -1 : ptBin * accumulator->getStride(1);
+    }
 
-        if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
-          if (cfg.mPairCuts && mPairCuts.conversionCuts(track1, track2)) {
-            continue;
-          }
+    for (int iTrigger = 0; iTrigger < mTriggers.size(); iTrigger++) {
+      const float pt1 = mTriggers.pt[iTrigger];
+      const float eta1 = mTriggers.eta[iTrigger];
+      const float phi1 = mTriggers.phi[iTrigger];
+      const int sign1 = mTriggers.sign[iTrigger];
+      const int64_t index1 = mTriggers.globalIndex[iTrigger];
+      const float triggerWeight = mTriggers.weight[iTrigger];
 
-          if (cfgTwoTrackCut > 0 && mPairCuts.twoTrackCut(track1, track2, magField)) {
-            continue;
-          }
-        }
+      target->getTriggerHist()->Fill(step, pt1, multiplicity, posZ, triggerWeight);
 
-        float associatedWeight = triggerWeight;
-        if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-          if (cfg.mEfficiencyAssociated) {
-            associatedWeight *= efficiencyAssociated[track2.filteredIndex()];
+      const int ptTriggerBin = accumulator->findBin(2, pt1);
+      if (eventBin < 0 || ptTriggerBin < 0) { // pairs in under- or overflow bins are not stored
+        continue;
+      }
+      const int64_t triggerBin = eventBin + ptTriggerBin * accumulator->getStride(2);
+
+      // Branchless kernel over all associated particles, which the compiler can vectorise
+      for (int i = 0; i < nAssociated; i++) {
+        float dPhi = phi1 - associatedPhi[i];
+        dPhi = (dPhi > 1.5f * PI) ? dPhi - TwoPI : dPhi;
+        dPhi = (dPhi < -PIHalf) ? dPhi + TwoPI : dPhi;
+        deltaPhi[i] = dPhi;
+        deltaEta[i] = eta1 - associatedEta[i];
+        accepted[i] = (associatedIndex[i] != index1) & (!ptOrder | (associatedPt[i] < pt1)) & (pairCharge * sign1 * associatedSign[i] >= 0) & (mAssociatedBin[i] >= 0);
+      }
+
+      // Pair cuts on all the accepted pairs of the trigger at once
+      if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+        if (cfg.mPairCuts || cfgTwoTrackCut > 0) {
+          const CachedParticle track1 = mTriggers.at(iTrigger);
+          const PairCuts::Candidates candidates{nAssociated, associatedPt, associatedEta, associatedPhi, associatedSign};
+          if (cfg.mPairCuts) {
+            mPairCuts.conversionCuts(track1, candidates, accepted);
+          }
+          if (cfgTwoTrackCut > 0) {
+            mPairCuts.twoTrackCut(track1, candidates, magField, accepted);
           }
         }
+      }
 
-        float deltaPhi = track1.phi() - track2.phi();
-        if (deltaPhi > 1.5f * PI) {
-          deltaPhi -= TwoPI;
+      for (int i = 0; i < nAssociated; i++) {
+        if (!accepted[i]) {
+          continue;
         }
-        if (deltaPhi < -PIHalf) {
-          deltaPhi += TwoPI;
+
+        const int deltaEtaBin = accumulator->findBin(0, deltaEta[i]);
+        const int deltaPhiBin = accumulator->findBin(4, deltaPhi[i]);
+        if (deltaEtaBin < 0 || deltaPhiBin < 0) {
+          continue;
         }
+        accumulator->fill(0, step, triggerBin + mAssociatedBin[i] + deltaEtaBin * strideDeltaEta + deltaPhiBin * strideDeltaPhi, triggerWeight * associatedWeight[i]);
+      }
+    }
+
+    accumulator->merge();
+  }
+
+  template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
+  void fillCorrelations(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
+  {
+    fillTriggerCache<step>(tracks1, multiplicity, posZ, eventWeight);
+    fillAssociatedCache<step>(tracks2, multiplicity, posZ);
+    fillPairs<step>(target, mAssociated, multiplicity, posZ, magField);
+  }
 
-        target->getPairHist()->Fill(step,
-                                    track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, associatedWeight);
+  // Copy associated particles from the mixing pool, with the efficiency correction for the event they are correlated with
+  void fillAssociatedCacheFromPool(ParticleCache const& stored, float multiplicity, float posZ)
+  {
+    mAssociated = stored;
+    if (cfg.mEfficiencyAssociated) {
+      const long effOffset = cfg.mLookupAssociated.eventOffset(multiplicity, posZ);
+      for (int i = 0; i < mAssociated.size(); i++) {
+        mAssociated.weight[i] = cfg.mLookupAssociated.get(effOffset, mAssociated.eta[i], mAssociated.pt[i]);
       }
     }
+  }
 
-    delete[] efficiencyAssociated;
+  // Store the cached associated particles in the mixing pool, dropping the oldest events of the bin to respect the depth and memory limits
+  void addToMixingPool(std::deque<ParticleCache>& pool)
+  {
+    const long nTracks = mAssociated.size();
+    while (!pool.empty() && (static_cast<int>(pool.size()) >= cfgMixingPoolDepth || mMixingPoolTracks + nTracks > cfgMixingPoolMaxTracks)) {
+      mMixingPoolTracks -= pool.front().size();
+      pool.pop_front();
+    }
+    if (mMixingPoolTracks + nTracks > cfgMixingPoolMaxTracks) {
+      return;
+    }
+    pool.push_back(mAssociated);
+    // the global indices are only unique within a dataframe, stored particles must never be taken as identical to a trigger
+    std::fill(pool.back().globalIndex.begin(), pool.back().globalIndex.end(), -1);
+    mMixingPoolTracks += nTracks;
   }
 
   void loadEfficiency(uint64_t timestamp)
@@ -333,6 +565,7 @@ struct CorrelationTask {
         LOGF(fatal, "Could not load efficiency histogram for trigger particles from %s", cfgEfficiencyTrigger.value.c_str());
       }
       LOGF(info, "Loaded efficiency histogram for trigger particles from %s (%p)", cfgEfficiencyTrigger.value.c_str(), (void*)cfg.mEfficiencyTrigger);
+      cfg.mLookupTrigger.set(cfg.mEfficiencyTrigger);
     }
     if (cfgEfficiencyAssociated.value.empty() == false) {
       cfg.mEfficiencyAssociated = ccdb->getForTimeStamp<THnT<float>>(cfgEfficiencyAssociated, timestamp);
@@ -340,20 +573,11 @@ struct CorrelationTask {
         LOGF(fatal, "Could not load efficiency histogram for associated particles from %s", cfgEfficiencyAssociated.value.c_str());
       }
       LOGF(info, "Loaded efficiency histogram for associated particles from %s (%p)", cfgEfficiencyAssociated.value.c_str(), (void*)cfg.mEfficiencyAssociated);
+      cfg.mLookupAssociated.set(cfg.mEfficiencyAssociated);
     }
     cfg.efficiencyLoaded = true;
   }
 
-  double getEfficiencyCorrection(THn* eff, float eta, float pt, float multiplicity, float posZ)
-  {
-    int effVars[4];
-    effVars[0] = eff->GetAxis(0)->FindBin(eta);
-    effVars[1] = eff->GetAxis(1)->FindBin(pt);
-    effVars[2] = eff->GetAxis(2)->FindBin(multiplicity);
-    effVars[3] = eff->GetAxis(3)->FindBin(posZ);
-    return eff->GetBinContent(effVars);
-  }
-
   // Version with explicit nested loop
   void processSameAOD(aodCollisions::iterator const& collision, aod::BCsWithTimestamps const&, aodTracks const& tracks)
   {
@@ -378,6 +602,19 @@ struct CorrelationTask {
   }
   PROCESS_SWITCH(CorrelationTask, processSameAOD, "Process same event on AOD", true);
 
+  // Single particle maps of the particles of the last fillCorrelations call
+  // The mixed event is obtained from them in the post-processing by correlating the maps of each mixing bin,
+  // without pairing the tracks of different events. Pair cuts, two-track cuts and the pT ordering are not applied.
+  void fillMixingMaps(float multiplicity, float posZ)
+  {
+    for (int i = 0; i < mTriggers.size(); i++) {
+      registry.fill(HIST("mixingMapTrigger"), mTriggers.pt[i], multiplicity, posZ, mTriggers.eta[i], mTriggers.phi[i], mTriggers.weight[i]);
+    }
+    for (int i = 0; i < mAssociated.size(); i++) {
+      registry.fill(HIST("mixingMapAssociated"), mAssociated.pt[i], multiplicity, posZ, mAssociated.eta[i], mAssociated.phi[i], mAssociated.weight[i]);
+    }
+  }
+
   void processSameDerived(derivedCollisions::iterator const& collision, soa::Filtered<aod::CFTracks> const& tracks)
   {
     if (cfgVerbosity > 0) {
@@ -397,6 +634,9 @@ struct CorrelationTask {
 
     same->fillEvent(multiplicity, CorrelationContainer::kCFStepReconstructed);
     fillCorrelations<CorrelationContainer::kCFStepReconstructed>(same, tracks, tracks, multiplicity, collision.posZ(), field, 1.0f);
+    if (cfgMixingMaps) {
+      fillMixingMaps(multiplicity, collision.posZ());
+    }
 
     if (cfg.mEfficiencyAssociated || cfg.mEfficiencyTrigger) {
       same->fillEvent(multiplicity, CorrelationContainer::kCFStepCorrected);
@@ -450,8 +690,14 @@ struct CorrelationTask {
 
   using BinningTypeDerived = ColumnBinningPolicy<aod::collision::PosZ, aod::cfcollision::Multiplicity>;
   BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
+  Preslice<aod::CFTracks> perCollisionDerived = aod::cftrack::cfCollisionId;
   void processMixedDerived(derivedCollisions& collisions, derivedTracks const& tracks)
   {
+    if (cfgMixingPoolDepth > 0) {
+      mixWithPool(collisions, tracks);
+      return;
+    }
+
     // Strictly upper categorised collisions, for cfgNoMixedEvents combinations per bin, skipping those in entry -1
     auto tracksTuple = std::make_tuple(tracks);
     SameKindPair<derivedCollisions, derivedTracks, BinningTypeDerived> pairs{configurableBinningDerived, cfgNoMixedEvents, -1, collisions, tracksTuple}; // -1 is the number of the bin to skip
@@ -490,6 +736,52 @@ struct CorrelationTask {
   }
   PROCESS_SWITCH(CorrelationTask, processMixedDerived, "Process mixed events on derived data", false);
 
+  // Mixing of each collision with the ones of the same bin stored in the pool, also from previous dataframes
+  void mixWithPool(derivedCollisions& collisions, derivedTracks const& tracks)
+  {
+    for (auto& collision : collisions) {
+      int bin = configurableBinningDerived.getBin({collision.posZ(), collision.multiplicity()});
+      if (bin < 0) {
+        continue;
+      }
+      auto groupedTracks = tracks.sliceBy(perCollisionDerived, collision.globalIndex());
+      auto& pool = mMixingPool[bin];
+      registry.fill(HIST("mixingpool_occupancy"), bin, pool.size());
+
+      if (cfgVerbosity > 0) {
+        LOGF(info, "processMixedDerived: Mixing collision %d (%.3f, %.3f) of bin %d with %d stored collisions", collision.globalIndex(), collision.posZ(), collision.multiplicity(), bin, pool.size());
+      }
+
+      if (!pool.empty()) {
+        loadEfficiency(collision.timestamp());
+        int field = 0;
+        if (cfgTwoTrackCut > 0) {
+          field = getMagneticField(collision.timestamp());
+        }
+        const float eventWeight = 1.0f / pool.size();
+
+        registry.fill(HIST("eventcount_mixed"), bin);
+        mixed->fillEvent(collision.multiplicity(), CorrelationContainer::kCFStepReconstructed);
+        fillTriggerCache<CorrelationContainer::kCFStepReconstructed>(groupedTracks, collision.multiplicity(), collision.posZ(), eventWeight);
+        for (auto& storedEvent : pool) {
+          fillPairs<CorrelationContainer::kCFStepReconstructed>(mixed, storedEvent, collision.multiplicity(), collision.posZ(), field);
+        }
+
+        if (cfg.mEfficiencyAssociated || cfg.mEfficiencyTrigger) {
+          mixed->fillEvent(collision.multiplicity(), CorrelationContainer::kCFStepCorrected);
+          fillTriggerCache<CorrelationContainer::kCFStepCorrected>(groupedTracks, collision.multiplicity(), collision.posZ(), eventWeight);
+          for (auto& storedEvent : pool) {
+            fillAssociatedCacheFromPool(storedEvent, collision.multiplicity(), collision.posZ());
+            fillPairs<CorrelationContainer::kCFStepCorrected>(mixed, mAssociated, collision.multiplicity(), collision.posZ(), field);
+          }
+        }
+      }
+
+      fillAssociatedCache<CorrelationContainer::kCFStepReconstructed>(groupedTracks, collision.multiplicity(), collision.posZ());
+      addToMixingPool(pool);
+    }
+  }
+
   // Version with combinations
   /*void processWithCombinations(soa::Join<aod::Collisions, aod::CentRun2V0Ms>::iterator const& collision, aod::BCsWithTimestamps const&, soa::Filtered<aod::Tracks> const& tracks)
   {
@@ -101,6 +101,9 @@ struct DptDptCorrelationsTask {
     TProfile* fhN2nw_vsC[4];         //!<! un-weighted accumulated two particle distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
     TProfile* fhSum2PtPtnw_vsC[4];   //!<! un-weighted accumulated \f${p_T}_1 {p_T}_2\f$ distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
     TProfile* fhSum2DptDptnw_vsC[4]; //!<! un-weighted accumulated \f$\sum ({p_T}_1- <{p_T}_1>) ({p_T}_2 - <{p_T}_2>) \f$ distribution vs \f$\Delta\eta,\;\Delta\phi\f$ distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
+    /* per track bin indexes for the current collision */
+    std::vector<int> fEtaIx[2]; //!<! zero based \f$\eta\f$ bin index of the tracks of the current collision, track 1 and 2
+    std::vector<int> fPhiIx[2]; //!<! zero based shifted \f$\phi\f$ bin index of the tracks of the current collision, track 1 and 2
 
     /// \enum TrackPairs
     /// \brief The track combinations hadled by the class
@@ -185,13 +188,30 @@ struct DptDptCorrelationsTask {
       phi = GetShiftedPhi(t2.phi());
       int phiix_2 = int((phi - philow) / phibinwidth);
 
+      return GetDEtaDPhiGlobalIndex(etaix_1, phiix_1, etaix_2, phiix_2);
+    }
+
+    /// \brief Returns the TH2 global index for the differential histograms
+    /// \param etaix_1 the zero based eta bin index of track one
+    /// \param phiix_1 the zero based phi bin index of track one
+    /// \param etaix_2 the zero based eta bin index of track two
+    /// \param phiix_2 the zero based phi bin index of track two
+    /// \return the globl TH2 bin for delta eta delta phi
+    ///
+    /// The global bin is computed as TH2::GetBin does, the differential
+    /// histograms having no extended axes
+    int GetDEtaDPhiGlobalIndex(int etaix_1, int phiix_1, int etaix_2, int phiix_2)
+    {
+      using namespace correlationstask;
+      using namespace o2::analysis::dptdptfilter;
+
       int deltaeta_ix = etaix_1 - etaix_2 + etabins - 1;
       int deltaphi_ix = phiix_1 - phiix_2;
       if (deltaphi_ix < 0) {
         deltaphi_ix += phibins;
       }
 
-      return fhN2_vsDEtaDPhi[kOO]->GetBin(deltaeta_ix + 1, deltaphi_ix + 1);
+      return (deltaphi_ix + 1) * (deltaetabins + 2) + (deltaeta_ix + 1);
     }
 
     void storeTrackCorrections(TH3* corrs1, TH3* corrs2)
@@ -258,10 +278,16 @@ struct DptDptCorrelationsTask {
     /// \param passedtracks filtered table with the tracks associated to the passed index
     /// \param tix index, in the singles histogram bank, for the passed filetered track table
     /// \param cmul centrality - multiplicity for the collision being analyzed
+    /// The eta and phi bin indexes of the tracks are also stored for the pair processing
     template <typename TrackListObject>
     void processTracks(TrackListObject const& passedtracks, std::vector<float>* corrs, int tix, float cmul)
     {
+      using namespace correlationstask;
+      using namespace o2::analysis::dptdptfilter;
+
       LOGF(DPTDPTLOGCOLLISIONS, "Processing %d tracks of type %d in a collision with cent/mult %f ", passedtracks.size(), tix, cmul);
+      fEtaIx[tix].resize(passedtracks.size());
+      fPhiIx[tix].resize(passedtracks.size());
 
       /* process magnitudes */
       double n1 = 0;       ///< weighted number of track 1 tracks for current collision
@@ -278,6 +304,8 @@ struct DptDptCorrelationsTask {
 
         fhN1_vsEtaPhi[tix]->Fill(track.eta(), GetShiftedPhi(track.phi()), corr);
         fhSum1Pt_vsEtaPhi[tix]->Fill(track.eta(), GetShiftedPhi(track.phi()), track.pt() * corr);
+        fEtaIx[tix][index] = int((track.eta() - etalow) / etabinwidth);
+        fPhiIx[tix][index] = int((GetShiftedPhi(track.phi()) - philow) / phibinwidth);
         index++;
       }
       fhN1_vsC[tix]->Fill(cmul, n1);
@@ -292,6 +320,8 @@ struct DptDptCorrelationsTask {
     /// \param pix index, in the track combination histogram bank, for the passed filetered track tables
     /// \param cmul centrality - multiplicity for the collision being analyzed
     /// Be aware that at least in half of the cases traks1 and trks2 will have the same content
+    /// The tracks eta and phi bin indexes are the ones stored by processTracks and the differential
+    /// histograms are accumulated directly in their bin contents storage
     template <trackpairs pix, typename TrackOneListObject, typename TrackTwoListObject>
     void processTrackPairs(TrackOneListObject const& trks1, TrackTwoListObject const& trks2, std::vector<float>* corrs1, std::vector<float>* corrs2, std::vector<float>* ptavgs1, std::vector<float>* ptavgs2, float cmul, int bfield)
     {
@@ -307,11 +337,26 @@ struct DptDptCorrelationsTask {
       double sum2DptDptnw = 0; ///< accumulated sum of not weighted number of track 1 tracks times not weighted track 2 \f$p_T\f$ for current collision
       int index1 = 0;
 
+      /* the track one and track two bin indexes for the current track combination */
+      constexpr int tix1 = (pix == kOO or pix == kOT) ? 0 : 1;
+      constexpr int tix2 = (pix == kOO or pix == kTO) ? 0 : 1;
+      const int* etaix1 = fEtaIx[tix1].data();
+      const int* phiix1 = fPhiIx[tix1].data();
+      const int* etaix2 = fEtaIx[tix2].data();
+      const int* phiix2 = fPhiIx[tix2].data();
+      /* the differential histograms bin contents, they don't track the sum of weights squared */
+      float* accN2 = fhN2_vsDEtaDPhi[pix]->GetArray();
+      float* accSum2PtPt = fhSum2PtPt_vsDEtaDPhi[pix]->GetArray();
+      float* accSum2DptDpt = fhSum2DptDpt_vsDEtaDPhi[pix]->GetArray();
+      float* accSupN1N1 = fhSupN1N1_vsDEtaDPhi[pix]->GetArray();
+      float* accSupPt1Pt1 = fhSupPt1Pt1_vsDEtaDPhi[pix]->GetArray();
+
       for (auto& track1 : trks1) {
         double ptavg_1 = (*ptavgs1)[index1];
         double corr1 = (*corrs1)[index1];
-        int index2 = 0;
+        int index2 = -1;
         for (auto& track2 : trks2) {
+          index2++;
           /* checking the same track id condition */
           if constexpr (pix == kOO or pix == kTT) {
             if (track1 == track2) {
@@ -327,11 +372,11 @@ struct DptDptCorrelationsTask {
           double dptdptw = (corr1 * track1.pt() - ptavg_1) * (corr2 * track2.pt() - ptavg_2);
 
           /* get the global bin for filling the differential histograms */
-          int globalbin = GetDEtaDPhiGlobalIndex(track1, track2);
+          int globalbin = GetDEtaDPhiGlobalIndex(etaix1[index1], phiix1[index1], etaix2[index2], phiix2[index2]);
           if ((fUseConversionCuts and fPairCuts.conversionCuts(track1, track2)) or (fUseTwoTrackCut and fPairCuts.twoTrackCut(track1, track2, bfield))) {
             /* suppress the pair */
-            fhSupN1N1_vsDEtaDPhi[pix]->AddBinContent(globalbin, corr);
-            fhSupPt1Pt1_vsDEtaDPhi[pix]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
+            accSupN1N1[globalbin] += corr;
+            accSupPt1Pt1[globalbin] += track1.pt() * track2.pt() * corr;
             n2sup += corr;
           } else {
             /* count the pair */
@@ -342,12 +387,13 @@ struct DptDptCorrelationsTask {
             sum2PtPtnw += track1.pt() * track2.pt();
             sum2DptDptnw += dptdptnw;
 
-            fhN2_vsDEtaDPhi[pix]->AddBinContent(globalbin, corr);
-            fhSum2DptDpt_vsDEtaDPhi[pix]->AddBinContent(globalbin, dptdptw);
-            fhSum2PtPt_vsDEtaDPhi[pix]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
+            accN2[globalbin] += corr;
+            accSum2DptDpt[globalbin] += dptdptw;
+            accSum2PtPt[globalbin] += track1.pt() * track2.pt() * corr;
           }
           fhN2_vsPtPt[pix]->Fill(track1.pt(), track2.pt(), corr);
         }
+        index1++;
       }
       fhN2_vsC[pix]->Fill(cmul, n2);
       fhSum2PtPt_vsC[pix]->Fill(cmul, sum2PtPt);
@@ -20,6 +20,7 @@
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/Centrality.h"
+#include "Common/DataModel/Qvectors.h"
 
 #include "GFW.h"
 #include "GFWCumulant.h"
@@ -41,8 +42,10 @@ struct GenericFramework {
   O2_DEFINE_CONFIGURABLE(cfgCutPtMax, float, 3.0f, "Maximal pT for tracks")
   O2_DEFINE_CONFIGURABLE(cfgCutEta, float, 0.8f, "Eta range for tracks")
   O2_DEFINE_CONFIGURABLE(cfgNbootstrap, int, 10, "Number of subsamples")
+  O2_DEFINE_CONFIGURABLE(cfgCompactSubsamples, bool, false, "Store the subsample sums in one array instead of one profile per subsample")
   O2_DEFINE_CONFIGURABLE(cfgEfficiency, std::string, "", "CCDB path to efficiency object")
   O2_DEFINE_CONFIGURABLE(cfgAcceptance, std::string, "", "CCDB path to acceptance object")
+  O2_DEFINE_CONFIGURABLE(cfgAcceptanceLookup, bool, false, "Copy the acceptance weights to a flat lookup grid when a new object is loaded")
 
   ConfigurableAxis axisVertex{"axisVertex", {20, -10, 10}, "vertex axis for histograms"};
   ConfigurableAxis axisPhi{"axisPhi", {60, 0.0, constants::math::TwoPI}, "phi axis for histograms"};
@@ -71,7 +74,14 @@ struct GenericFramework {
   // define global variables
   GFW* fGFW = new GFW();
   std::vector<GFW::CorrConfig> corrconfigs;
+  std::vector<int> corrIndices; // FlowContainer index of each correlator
   TRandom3* fRndm = new TRandom3(0);
+  // accepted tracks of the current collision
+  std::vector<double> fBatchEta;
+  std::vector<int> fBatchPt;
+  std::vector<double> fBatchPhi;
+  std::vector<double> fBatchWeight;
+  std::vector<int> fBatchMask;
 
   void init(InitContext const&)
   {
@@ -103,6 +113,7 @@ struct GenericFramework {
     oba->Add(new TNamed("ChSC244", "ChSC244"));   // gap case
     oba->Add(new TNamed("ChSC234", "ChSC234"));   // gap case
     fFC->SetName("FlowContainer");
+    fFC->SetCompactSubsamples(cfgCompactSubsamples);
     fFC->Initialize(oba, axisMultiplicity, cfgNbootstrap);
     delete oba;
 
@@ -120,9 +131,12 @@ struct GenericFramework {
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {4} refN {-4}", "ChGap42", kFALSE));
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {2 4} refN {-2 -4}", "ChSC244", kFALSE));
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {2 3} refN {-2 -3}", "ChSC234", kFALSE));
+    fGFW->BuildPlan(corrconfigs);
+    for (auto& corrconf : corrconfigs)
+      corrIndices.push_back(fFC->GetCorrelatorIndex(corrconf.Head.Data()));
   }
 
-  void FillFC(const GFW::CorrConfig& corrconf, const double& cent, const double& rndm)
+  void FillFC(const GFW::CorrConfig& corrconf, int corrIndex, const double& cent, const double& rndm)
   {
     double dnx, val;
     dnx = fGFW->Calculate(corrconf, 0, kTRUE).Re();
@@ -131,23 +145,34 @@ struct GenericFramework {
     if (!corrconf.pTDif) {
       val = fGFW->Calculate(corrconf, 0, kFALSE).Re() / dnx;
       if (TMath::Abs(val) < 1)
-        fFC->FillProfile(corrconf.Head.Data(), cent, val, 1, rndm);
+        fFC->FillProfile(corrIndex, cent, val, 1, rndm);
       return;
     }
     return;
   }
 
-  void process(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>>::iterator const& collision, aod::BCsWithTimestamps const&, myTracks const& tracks)
+  void fillCorrelators(float centrality)
+  {
+    float l_Random = fRndm->Rndm();
+    for (unsigned long int l_ind = 0; l_ind < corrconfigs.size(); l_ind++) {
+      FillFC(corrconfigs.at(l_ind), corrIndices.at(l_ind), centrality, l_Random);
+    };
+  }
+
+  void processTracks(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>>::iterator const& collision, aod::BCsWithTimestamps const&, myTracks const& tracks)
   {
 
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
 
     if (cfgAcceptance.value.empty() == false) {
       cfg.mAcceptance = ccdb->getForTimeStamp<GFWWeights>(cfgAcceptance.value, bc.timestamp());
-      if (cfg.mAcceptance)
+      if (cfg.mAcceptance) {
         LOGF(info, "Loaded acceptance histogram from %s (%p)", cfgAcceptance.value.c_str(), (void*)cfg.mAcceptance);
-      else
+        if (cfgAcceptanceLookup && !cfg.mAcceptance->HasLookup())
+          cfg.mAcceptance->CreateLookup(); // the object is cached by the CCDB manager, so this is done once per object
+      } else {
         LOGF(warning, "Could not load acceptance histogram from %s (%p)", cfgAcceptance.value.c_str(), (void*)cfg.mAcceptance);
+      }
     }
     if (tracks.size() < 1)
       return;
@@ -161,9 +186,15 @@ struct GenericFramework {
     const auto centrality = collision.centRun2V0M();
     if (centrality > 100)
       return;
-    float l_Random = fRndm->Rndm();
     float weff = 1, wacc = 1;
 
+    // the accepted tracks are collected and filled in one batch
+    fBatchEta.clear();
+    fBatchPt.clear();
+    fBatchPhi.clear();
+    fBatchWeight.clear();
+    fBatchMask.clear();
+
     for (auto& track : tracks) {
       registry.fill(HIST("hPhi"), track.phi());
       registry.fill(HIST("hEta"), track.eta());
@@ -180,12 +211,38 @@ struct GenericFramework {
       else
         wacc = 1;
 
-      fGFW->Fill(track.eta(), 1, track.phi(), wacc * weff, 3);
+      fBatchEta.push_back(track.eta());
+      fBatchPt.push_back(1);
+      fBatchPhi.push_back(track.phi());
+      fBatchWeight.push_back(wacc * weff);
+      fBatchMask.push_back(3);
     }
-    for (unsigned long int l_ind = 0; l_ind < corrconfigs.size(); l_ind++) {
-      FillFC(corrconfigs.at(l_ind), centrality, l_Random);
-    };
+    fGFW->Fill(fBatchEta.size(), fBatchEta.data(), fBatchPt.data(), fBatchPhi.data(), fBatchWeight.data(), fBatchMask.data());
+    fillCorrelators(centrality);
+  }
+  PROCESS_SWITCH(GenericFramework, processTracks, "Fill the GFW from the tracks", true);
+
+  // Correlators from the Q-vectors of the qvectors-gfw-table producer, which must be configured with the same track selection,
+  // efficiency and acceptance weights, eta regions and powers as this task
+  void processQvectors(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms, aod::QvectorsGFW>>::iterator const& collision)
+  {
+    if (!collision.sel7())
+      return;
+    int nTracks = 0;
+    for (auto n : collision.qvecNEntries())
+      nTracks += n;
+    if (nTracks < 1)
+      return;
+    registry.fill(HIST("hVtxZ"), collision.posZ());
+
+    const auto centrality = collision.centRun2V0M();
+    if (centrality > 100)
+      return;
+    if (!fGFW->SetQvectors(collision.qvecRe(), collision.qvecIm(), collision.qvecNEntries()))
+      LOGF(fatal, "The Q-vectors of the qvectors-gfw-table do not match the GFW regions of this task");
+    fillCorrelators(centrality);
   }
+  PROCESS_SWITCH(GenericFramework, processQvectors, "Compute the correlators from the Q-vectors of the qvectors-gfw-table", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
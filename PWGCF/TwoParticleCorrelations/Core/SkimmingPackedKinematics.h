@@ -0,0 +1,106 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef PWGCF_TWOPARTICLECORRELATIONS_CORE_SKIMMINGPACKEDKINEMATICS_H_
+#define PWGCF_TWOPARTICLECORRELATIONS_CORE_SKIMMINGPACKEDKINEMATICS_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace o2
+{
+namespace analysis
+{
+namespace PWGCF
+{
+/// \brief Quantisation of the track kinematics for the packed skimmed tracks
+///
+/// Each of pT, eta and phi is stored in 16 bits. Eta and phi are linearly quantised
+/// within their ranges, while pT is log encoded so that the relative precision is
+/// constant across the spectrum. The unpacked value is the center of the quantisation
+/// interval and values out of range are clamped to the range limits
+namespace packedkinematics
+{
+constexpr float kEtaMax = 2.0f;  ///< the packed eta range is [-kEtaMax, kEtaMax]
+constexpr float kPtMin = 0.01f;  ///< the packed pT range is [kPtMin, kPtMax] GeV/c
+constexpr float kPtMax = 100.0f; ///< the packed pT range is [kPtMin, kPtMax] GeV/c
+constexpr float kTwoPi = 6.28318530717958647692f;
+constexpr int kNSteps = 65536; ///< number of quantisation intervals for 16 bits
+
+inline uint16_t quantise(float value, float low, float width)
+{
+  float steps = (value - low) / width;
+  if (!(steps > 0.0f)) {
+    return 0;
+  }
+  if (!(steps < float(kNSteps))) {
+    return kNSteps - 1;
+  }
+  return uint16_t(steps);
+}
+
+inline uint16_t packEta(float eta)
+{
+  return quantise(eta, -kEtaMax, 2.0f * kEtaMax / kNSteps);
+}
+
+inline float unpackEta(uint16_t peta)
+{
+  return -kEtaMax + (peta + 0.5f) * (2.0f * kEtaMax / kNSteps);
+}
+
+inline uint16_t packPhi(float phi)
+{
+  /* the phi of the tracks is already within [0, 2pi) */
+  return quantise(phi, 0.0f, kTwoPi / kNSteps);
+}
+
+inline float unpackPhi(uint16_t pphi)
+{
+  return (pphi + 0.5f) * (kTwoPi / kNSteps);
+}
+
+inline uint16_t packPt(float pt)
+{
+  static const float logwidth = std::log(kPtMax / kPtMin) / kNSteps;
+  return quantise(std::log(pt > kPtMin ? pt : kPtMin), std::log(kPtMin), logwidth);
+}
+
+inline float unpackPt(uint16_t ppt)
+{
+  static const float logwidth = std::log(kPtMax / kPtMin) / kNSteps;
+  return kPtMin * std::exp((ppt + 0.5f) * logwidth);
+}
+} // namespace packedkinematics
+
+/// \brief Checks a skimmed selection mask against an analysis selection
+/// \param mask the skimmed mask of the track
+/// \param forcedmask the mandatory part of the selection, all its bits are required
+/// \param optmasks the optional parts of the selection, at least one bit of each of them is required
+/// With the packed skimmed tracks this check is done once per group of tracks
+/// sharing the same mask instead of once per track
+inline bool isMaskSelected(uint64_t mask, uint64_t forcedmask, std::vector<uint64_t> const& optmasks)
+{
+  if ((mask & forcedmask) != forcedmask) {
+    return false;
+  }
+  for (auto optmask : optmasks) {
+    if ((mask & optmask) == 0UL) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace PWGCF
+} // namespace analysis
+} // namespace o2
+
+#endif // PWGCF_TWOPARTICLECORRELATIONS_CORE_SKIMMINGPACKEDKINEMATICS_H_
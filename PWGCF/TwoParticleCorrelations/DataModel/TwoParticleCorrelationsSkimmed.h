@@ -23,6 +23,7 @@
 #include "PWGCF/TwoParticleCorrelations/Core/EventSelectionFilterAndAnalysis.h"
 #include "PWGCF/TwoParticleCorrelations/Core/TrackSelectionFilterAndAnalysis.h"
 #include "PWGCF/TwoParticleCorrelations/Core/PIDSelectionFilterAndAnalysis.h"
+#include "PWGCF/TwoParticleCorrelations/Core/SkimmingPackedKinematics.h"
 #include "Framework/runDataProcessing.h"
 
 namespace o2
@@ -97,6 +98,38 @@ namespace cfskim
 {
 DECLARE_SOA_INDEX_COLUMN(CFMCParticle, mcparticle);
 }
+namespace cfskim
+{
+DECLARE_SOA_COLUMN(PackedPt, packedpt, uint16_t);   //! The log encoded track transverse momentum
+DECLARE_SOA_COLUMN(PackedEta, packedeta, uint16_t); //! The quantised track pseudorapidity
+DECLARE_SOA_COLUMN(PackedPhi, packedphi, uint16_t); //! The quantised track azimuthal angle
+DECLARE_SOA_DYNAMIC_COLUMN(UnpackedPt, pt,          //! The track transverse momentum
+                           [](uint16_t ppt) -> float { return o2::analysis::PWGCF::packedkinematics::unpackPt(ppt); });
+DECLARE_SOA_DYNAMIC_COLUMN(UnpackedEta, eta, //! The track pseudorapidity
+                           [](uint16_t peta) -> float { return o2::analysis::PWGCF::packedkinematics::unpackEta(peta); });
+DECLARE_SOA_DYNAMIC_COLUMN(UnpackedPhi, phi, //! The track azimuthal angle
+                           [](uint16_t pphi) -> float { return o2::analysis::PWGCF::packedkinematics::unpackPhi(pphi); });
+} // namespace cfskim
+DECLARE_SOA_TABLE(CFPackedTracks, "AOD", "CFPACKEDTRACK", //! The reconstructed tracks filtered table with packed kinematics, grouped by selection mask within each collision
+                  o2::soa::Index<>,
+                  cfskim::CFCollisionId,
+                  cfskim::CFTrackFlags,
+                  cfskim::PackedPt,
+                  cfskim::PackedEta,
+                  cfskim::PackedPhi,
+                  cfskim::UnpackedPt<cfskim::PackedPt>,
+                  cfskim::UnpackedEta<cfskim::PackedEta>,
+                  cfskim::UnpackedPhi<cfskim::PackedPhi>);
+using CFPackedTrack = CFPackedTracks::iterator;
+namespace cfskim
+{
+DECLARE_SOA_SLICE_INDEX_COLUMN(CFPackedTrack, cfpackedtrack); //! The slice of packed tracks sharing the selection mask
+}
+DECLARE_SOA_TABLE(CFPackedTrackGroups, "AOD", "CFPACKTRKGROUP", //! Index of the packed tracks of each collision per selection mask
+                  cfskim::CFCollisionId,
+                  cfskim::CFTrackFlags,
+                  cfskim::CFPackedTrackIdSlice);
+using CFPackedTrackGroup = CFPackedTrackGroups::iterator;
 DECLARE_SOA_TABLE(CFMCCollisionLbls, "AOD", "CFMCCOLLISONLBL",
                   cfskim::CFMCCollisionId,
                   mccollisionlabel::McMask);
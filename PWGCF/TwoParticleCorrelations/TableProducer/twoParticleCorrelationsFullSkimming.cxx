@@ -10,6 +10,8 @@
 // or submit itself to any jurisdiction.
 
 #include <CCDB/BasicCCDBManager.h>
+#include <algorithm>
+#include <vector>
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
@@ -19,6 +21,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "PWGCF/TwoParticleCorrelations/DataModel/TwoParticleCorrelationsSkimmed.h"
 #include "PWGCF/TwoParticleCorrelations/Core/FilterAndAnalysisFramework.h"
+#include "PWGCF/TwoParticleCorrelations/Core/SkimmingPackedKinematics.h"
 #include "Framework/runDataProcessing.h"
 #include "DataFormatsParameters/GRPObject.h"
 
@@ -97,6 +100,10 @@ struct TwoParticleCorrelationsSkimming {
   Produces<aod::CFTrackPIDs> skimmtrackpid;
   Produces<aod::CFMCCollisions> skimmedgencollision;
   Produces<aod::CFMCParticles> skimmedparticles;
+  Produces<aod::CFPackedTracks> skimmedpackedtrack;
+  Produces<aod::CFPackedTrackGroups> skimmedpackedtrackgroup;
+
+  Configurable<bool> cfgPackedSkim{"packedskim", false, "Store also the accepted tracks with packed kinematics and indexed by selection mask"};
 
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
@@ -107,6 +114,43 @@ struct TwoParticleCorrelationsSkimming {
   int bfield = 0;
   HistogramRegistry historeg;
 
+  /* the accepted tracks of the current collision for the packed skimmed tables */
+  struct PackedTrack {
+    uint64_t mask;
+    uint16_t pt;
+    uint16_t eta;
+    uint16_t phi;
+  };
+  std::vector<PackedTrack> packedtracks;
+
+  template <typename Track>
+  void addPackedTrack(Track const& track, uint64_t trkmask)
+  {
+    using namespace o2::analysis::PWGCF::packedkinematics;
+    packedtracks.push_back({trkmask, packPt(track.pt()), packEta(track.eta()), packPhi(track.phi())});
+  }
+
+  /// \brief stores the packed tracks of the current collision
+  /// The tracks are stored grouped by selection mask and a group entry with the
+  /// slice of its tracks is stored for each different mask, so that the analysis
+  /// tasks test the mask once per group and only read the tracks of the accepted groups
+  void storePackedTracks(int64_t collisionIndex)
+  {
+    std::stable_sort(packedtracks.begin(), packedtracks.end(), [](PackedTrack const& a, PackedTrack const& b) { return a.mask < b.mask; });
+    size_t first = 0;
+    while (first < packedtracks.size()) {
+      int32_t firstrow = skimmedpackedtrack.lastIndex() + 1;
+      size_t last = first;
+      while (last < packedtracks.size() and packedtracks[last].mask == packedtracks[first].mask) {
+        skimmedpackedtrack(collisionIndex, packedtracks[last].mask, packedtracks[last].pt, packedtracks[last].eta, packedtracks[last].phi);
+        last++;
+      }
+      skimmedpackedtrackgroup(collisionIndex, packedtracks[first].mask, std::array<int32_t, 2>{firstrow, int32_t(skimmedpackedtrack.lastIndex())});
+      first = last;
+    }
+    packedtracks.clear();
+  }
+
   int getMagneticField(std::string ccdbpath, uint64_t timestamp)
   {
     // TODO done only once (and not per run). Will be replaced by CCDBConfigurable
@@ -231,6 +275,9 @@ struct TwoParticleCorrelationsSkimming {
         if (trkmask != 0UL) {
           skimmedtrack(skimmedcollision.lastIndex(), trkmask, track.pt(), track.eta(), track.phi());
           skimmtrackpid(pidmask);
+          if (cfgPackedSkim) {
+            addPackedTrack(track, trkmask);
+          }
           nFilteredTracks++;
         }
         if (trkmask != 0UL && nReportedTracks < 1000) {
@@ -243,6 +290,9 @@ struct TwoParticleCorrelationsSkimming {
           }
         }
       }
+      if (cfgPackedSkim) {
+        storePackedTracks(skimmedcollision.lastIndex());
+      }
       LOGF(LOGTRACKCOLLISIONS, ">> Filtered %d tracks", nFilteredTracks);
     }
   }
@@ -268,6 +318,9 @@ struct TwoParticleCorrelationsSkimming {
         if (trkmask != 0UL) {
           skimmedtrack(skimmedcollision.lastIndex(), trkmask, track.pt(), track.eta(), track.phi());
           skimmtrackpid(pidmask);
+          if (cfgPackedSkim) {
+            addPackedTrack(track, trkmask);
+          }
           nFilteredTracks++;
         }
         if (trkmask != 0UL && nReportedTracks < 1000) {
@@ -280,6 +333,9 @@ struct TwoParticleCorrelationsSkimming {
           }
         }
       }
+      if (cfgPackedSkim) {
+        storePackedTracks(skimmedcollision.lastIndex());
+      }
       LOGF(LOGTRACKCOLLISIONS, ">> Filtered %d tracks", nFilteredTracks);
     }
   }
@@ -0,0 +1,176 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "PWGDQ/Core/AnalysisCutEvaluator.h"
+
+#include <iostream>
+using namespace std;
+
+#include <TF1.h>
+
+//____________________________________________________________________________
+void AnalysisCutEvaluator::Compile(const std::vector<AnalysisCompositeCut>& cuts)
+{
+  //
+  // flatten the cut trees into the condition list and the postfix program
+  //
+  fNCuts = 0;
+  fVars.clear();
+  fSlots.clear();
+  fConditions.clear();
+  fLeaves.clear();
+  fProgram.clear();
+
+  for (auto const& cut : cuts) {
+    if (fNCuts == 32) {
+      cout << "Warning in AnalysisCutEvaluator::Compile(): Only 32 cuts can be evaluated, cut " << cut.GetName() << " is ignored" << endl;
+      break;
+    }
+    CompileComposite(cut);
+    fProgram.push_back({kStore, fNCuts});
+    fNCuts++;
+  }
+  fRow.resize(fVars.size());
+}
+
+//____________________________________________________________________________
+int AnalysisCutEvaluator::GetSlot(int var)
+{
+  //
+  // get the slot of a variable in the compact rows, adding it if needed
+  //
+  if (var < 0) {
+    return -1;
+  }
+  if (var >= static_cast<int>(fSlots.size())) {
+    fSlots.resize(var + 1, -1);
+  }
+  if (fSlots[var] < 0) {
+    fSlots[var] = fVars.size();
+    fVars.push_back(var);
+  }
+  return fSlots[var];
+}
+
+//____________________________________________________________________________
+void AnalysisCutEvaluator::CompileLeaf(const AnalysisCut& cut)
+{
+  //
+  // add the conditions of an AnalysisCut and push its decision
+  //
+  Leaf leaf = {static_cast<int>(fConditions.size()), static_cast<int>(cut.GetCuts().size())};
+  for (auto const& c : cut.GetCuts()) {
+    Condition condition = {GetSlot(c.fVar), c.fLow, c.fHigh, c.fExclude,
+                           GetSlot(c.fDepVar), c.fDepLow, c.fDepHigh, c.fDepExclude,
+                           GetSlot(c.fDepVar2), c.fDep2Low, c.fDep2High, c.fDep2Exclude,
+                           c.fFuncLow, c.fFuncHigh};
+    fConditions.push_back(condition);
+  }
+  fProgram.push_back({kPushLeaf, static_cast<int>(fLeaves.size())});
+  fLeaves.push_back(leaf);
+}
+
+//____________________________________________________________________________
+void AnalysisCutEvaluator::CompileComposite(const AnalysisCompositeCut& cut)
+{
+  //
+  // compile the sub-cuts and combine them, same order as in AnalysisCompositeCut::IsSelected()
+  //
+  for (auto const& subCut : cut.GetCutList()) {
+    CompileLeaf(subCut);
+  }
+  for (auto const& subCut : cut.GetCompositeCutList()) {
+    CompileComposite(subCut);
+  }
+  fProgram.push_back({cut.GetUseAND() ? kAnd : kOr, cut.GetNCuts()});
+}
+
+//____________________________________________________________________________
+void AnalysisCutEvaluator::EvaluateLeaves(const float* rows, int nRows)
+{
+  //
+  // evaluate all the conditions, one condition at a time over all the rows
+  //
+  const int nVars = fVars.size();
+  fLeafDecisions.assign(fLeaves.size() * nRows, 1);
+  for (unsigned int iLeaf = 0; iLeaf < fLeaves.size(); ++iLeaf) {
+    uint8_t* decisions = &fLeafDecisions[iLeaf * nRows];
+    for (int iCond = fLeaves[iLeaf].fFirstCondition; iCond < fLeaves[iLeaf].fFirstCondition + fLeaves[iLeaf].fNConditions; ++iCond) {
+      const Condition& c = fConditions[iCond];
+      for (int iRow = 0; iRow < nRows; ++iRow) {
+        const float* row = rows + iRow * nVars;
+        // the condition is applied only if the dependent variables are in (or outside, if excluded) their ranges
+        bool applies = true;
+        if (c.fDepVar >= 0) {
+          applies = ((row[c.fDepVar] > c.fDepLow && row[c.fDepVar] <= c.fDepHigh) != c.fDepExclude);
+        }
+        if (c.fDepVar2 >= 0) {
+          applies &= ((row[c.fDepVar2] > c.fDep2Low && row[c.fDepVar2] <= c.fDep2High) != c.fDep2Exclude);
+        }
+        float cutLow = (c.fFuncLow ? c.fFuncLow->Eval(row[c.fDepVar]) : c.fLow);
+        float cutHigh = (c.fFuncHigh ? c.fFuncHigh->Eval(row[c.fDepVar]) : c.fHigh);
+        bool inRange = (row[c.fVar] >= cutLow && row[c.fVar] <= cutHigh);
+        decisions[iRow] &= static_cast<uint8_t>(!applies || (inRange != c.fExclude));
+      }
+    }
+  }
+}
+
+//____________________________________________________________________________
+void AnalysisCutEvaluator::Evaluate(const float* rows, int nRows, uint32_t* decisions)
+{
+  //
+  // evaluate all the cuts on a set of compact rows
+  //
+  EvaluateLeaves(rows, nRows);
+  for (int iRow = 0; iRow < nRows; ++iRow) {
+    uint32_t decision = 0;
+    fStack.clear();
+    for (auto const& instruction : fProgram) {
+      switch (instruction.fOpCode) {
+        case kPushLeaf:
+          fStack.push_back(fLeafDecisions[instruction.fArg * nRows + iRow]);
+          break;
+        case kAnd:
+        case kOr: {
+          // an empty AND is true, an empty OR is false
+          bool isAND = (instruction.fOpCode == kAnd);
+          uint8_t result = isAND;
+          for (int i = fStack.size() - instruction.fArg; i < static_cast<int>(fStack.size()); ++i) {
+            result = (isAND ? (result & fStack[i]) : (result | fStack[i]));
+          }
+          fStack.resize(fStack.size() - instruction.fArg);
+          fStack.push_back(result);
+          break;
+        }
+        case kStore:
+          decision |= (uint32_t(fStack.back()) << instruction.fArg);
+          fStack.pop_back();
+          break;
+        default:
+          break;
+      }
+    }
+    decisions[iRow] = decision;
+  }
+}
+
+//____________________________________________________________________________
+uint32_t AnalysisCutEvaluator::Evaluate(const float* values)
+{
+  //
+  // evaluate all the cuts on a VarManager values array
+  //
+  PackValues(values, fRow.data());
+  uint32_t decision = 0;
+  Evaluate(fRow.data(), 1, &decision);
+  return decision;
+}
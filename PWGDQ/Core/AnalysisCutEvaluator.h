@@ -0,0 +1,107 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Class evaluating a list of composite cuts at once, on one or many objects
+// The cut trees are compiled into a flat list of range conditions on a compact set of variables
+//   and a postfix program combining the AnalysisCut decisions into one bit per composite cut
+//
+
+#ifndef AnalysisCutEvaluator_H
+#define AnalysisCutEvaluator_H
+
+#include "PWGDQ/Core/AnalysisCut.h"
+#include "PWGDQ/Core/AnalysisCompositeCut.h"
+
+#include <cstdint>
+#include <vector>
+
+class TF1;
+
+//_________________________________________________________________________
+class AnalysisCutEvaluator
+{
+ public:
+  AnalysisCutEvaluator() = default;
+  ~AnalysisCutEvaluator() = default;
+
+  // Compile the cuts; bit i of the decisions corresponds to cuts[i] (maximum 32 cuts)
+  // NOTE: the TF1 limits are not copied, the cuts must outlive the evaluator
+  void Compile(const std::vector<AnalysisCompositeCut>& cuts);
+
+  int GetNCuts() const { return fNCuts; }
+  // variables (in the VarManager layout) needed by the cuts, in the order of the compact rows
+  const std::vector<int>& GetVars() const { return fVars; }
+  int GetNVars() const { return fVars.size(); }
+
+  // Copy the variables needed by the cuts from a VarManager values array into a compact row of GetNVars() values
+  void PackValues(const float* values, float* row) const
+  {
+    for (unsigned int i = 0; i < fVars.size(); ++i) {
+      row[i] = values[fVars[i]];
+    }
+  }
+
+  // Evaluate all the cuts on a VarManager values array and return the bit map of the decisions
+  uint32_t Evaluate(const float* values);
+  // Evaluate all the cuts on nRows compact rows stored one after the other (row-major, GetNVars() values per row)
+  void Evaluate(const float* rows, int nRows, uint32_t* decisions);
+
+ private:
+  struct Condition {
+    int fVar;          // slot of the variable to be cut upon
+    float fLow;        // lower limit
+    float fHigh;       // upper limit
+    bool fExclude;     // if true, use the selection range for exclusion
+    int fDepVar;       // slot of the first dependent variable, -1 if not used
+    float fDepLow;     // lower limit for the first dependent var
+    float fDepHigh;    // upper limit for the first dependent var
+    bool fDepExclude;  // if true, use the first dependent variable range as exclusion
+    int fDepVar2;      // slot of the second dependent variable, -1 if not used
+    float fDep2Low;    // lower limit for the second dependent var
+    float fDep2High;   // upper limit for the second dependent var
+    bool fDep2Exclude; // if true, use the second dependent variable range as exclusion
+    TF1* fFuncLow;     // function for the lower limit cut, evaluated at the first dependent var
+    TF1* fFuncHigh;    // function for the upper limit cut, evaluated at the first dependent var
+  };
+  struct Leaf {
+    int fFirstCondition; // first condition of this AnalysisCut in fConditions
+    int fNConditions;    // number of conditions, all required
+  };
+  enum OpCodes {
+    kPushLeaf = 0, // push the decision of leaf fArg
+    kAnd,          // replace the last fArg decisions by their AND
+    kOr,           // replace the last fArg decisions by their OR
+    kStore         // pop the decision of the composite cut fArg
+  };
+  struct Instruction {
+    int fOpCode;
+    int fArg;
+  };
+
+  int GetSlot(int var);
+  void CompileLeaf(const AnalysisCut& cut);
+  void CompileComposite(const AnalysisCompositeCut& cut);
+  void EvaluateLeaves(const float* rows, int nRows);
+
+  int fNCuts = 0;                      // number of compiled composite cuts
+  std::vector<int> fVars;              // VarManager index of each slot of the compact rows
+  std::vector<int> fSlots;             // slot of each VarManager index, -1 if not used
+  std::vector<Condition> fConditions;  // range conditions of all the leaves
+  std::vector<Leaf> fLeaves;           // AnalysisCut leaves of the cut trees
+  std::vector<Instruction> fProgram;   // postfix program combining the leaf decisions
+  std::vector<uint8_t> fLeafDecisions; // decisions of the leaves, leaf-major [leaf * nRows + row]
+  std::vector<uint8_t> fStack;         // evaluation stack of the program
+  std::vector<float> fRow;             // compact row used by the single object evaluation
+};
+
+#endif
@@ -0,0 +1,217 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "PWGDQ/Core/CompactTHn.h"
+
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+#include <TCollection.h>
+#include <THn.h>
+
+ClassImp(CompactTHn);
+
+//_______________________________________________________________________________
+CompactTHn::CompactTHn() : TNamed(),
+                           fAxes(),
+                           fContent(),
+                           fSumw2(),
+                           fEntries(0.0)
+{
+  //
+  // Constructor
+  //
+}
+
+//_______________________________________________________________________________
+CompactTHn::CompactTHn(const THnBase& h) : TNamed(h.GetName(), h.GetTitle()),
+                                           fAxes(),
+                                           fContent(),
+                                           fSumw2(),
+                                           fEntries(0.0)
+{
+  //
+  // Constructor, copying the axes of a THn
+  //
+  Long64_t nbins = 1;
+  fAxes.reserve(h.GetNdimensions());
+  for (int idim = 0; idim < h.GetNdimensions(); ++idim) {
+    fAxes.emplace_back(*h.GetAxis(idim));
+    fAxes.back().SetParent(nullptr);
+    nbins *= fAxes.back().GetNbins() + 2;
+  }
+  fContent.assign(nbins, 0.0f);
+  fSumw2.assign(nbins, 0.0f);
+}
+
+//_______________________________________________________________________________
+Long64_t CompactTHn::GetBin(const int* idx) const
+{
+  //
+  // linear bin index, the last dimension runs fastest
+  //
+  Long64_t bin = 0;
+  for (std::size_t idim = 0; idim < fAxes.size(); ++idim) {
+    bin = bin * (fAxes[idim].GetNbins() + 2) + idx[idim];
+  }
+  return bin;
+}
+
+//_______________________________________________________________________________
+void CompactTHn::Fill(const double* x, double w)
+{
+  //
+  // fill the histogram; values outside the axes range go to the under- and overflow bins
+  //
+  Long64_t bin = 0;
+  for (std::size_t idim = 0; idim < fAxes.size(); ++idim) {
+    bin = bin * (fAxes[idim].GetNbins() + 2) + fAxes[idim].FindFixBin(x[idim]);
+  }
+  fContent[bin] += w;
+  fSumw2[bin] += w * w;
+  fEntries += 1.0;
+}
+
+//_______________________________________________________________________________
+bool CompactTHn::IsCompatible(const CompactTHn& other) const
+{
+  //
+  // check whether the two histograms have the same binning
+  //
+  if (fAxes.size() != other.fAxes.size() || fContent.size() != other.fContent.size()) {
+    return false;
+  }
+  for (std::size_t idim = 0; idim < fAxes.size(); ++idim) {
+    const TAxis& a = fAxes[idim];
+    const TAxis& b = other.fAxes[idim];
+    if (a.GetNbins() != b.GetNbins() || a.GetXmin() != b.GetXmin() || a.GetXmax() != b.GetXmax()) {
+      return false;
+    }
+    if (a.GetXbins()->GetSize() != b.GetXbins()->GetSize()) {
+      return false;
+    }
+    for (int i = 0; i < a.GetXbins()->GetSize(); ++i) {
+      if (a.GetXbins()->At(i) != b.GetXbins()->At(i)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//_______________________________________________________________________________
+bool CompactTHn::Add(const CompactTHn& other)
+{
+  //
+  // add the content of a histogram with the same binning
+  //
+  if (!IsCompatible(other)) {
+    cout << "Warning in CompactTHn::Add(): Histogram " << other.GetName() << " has a different binning than " << GetName()
+         << " and is not added" << endl;
+    return false;
+  }
+  float* content = fContent.data();
+  float* sumw2 = fSumw2.data();
+  const float* otherContent = other.fContent.data();
+  const float* otherSumw2 = other.fSumw2.data();
+  const std::size_t nbins = fContent.size();
+  for (std::size_t i = 0; i < nbins; ++i) {
+    content[i] += otherContent[i];
+    sumw2[i] += otherSumw2[i];
+  }
+  fEntries += other.fEntries;
+  return true;
+}
+
+//_______________________________________________________________________________
+void CompactTHn::Reset()
+{
+  //
+  // clear the content, the binning is kept
+  //
+  std::fill(fContent.begin(), fContent.end(), 0.0f);
+  std::fill(fSumw2.begin(), fSumw2.end(), 0.0f);
+  fEntries = 0.0;
+}
+
+//_______________________________________________________________________________
+Long64_t CompactTHn::Merge(TCollection* list)
+{
+  //
+  // add the histograms of the list
+  //
+  if (!list) {
+    return 0;
+  }
+  TIter next(list);
+  while (TObject* obj = next()) {
+    CompactTHn* h = dynamic_cast<CompactTHn*>(obj);
+    if (!h) {
+      cout << "Warning in CompactTHn::Merge(): Cannot merge object " << obj->GetName() << " of class " << obj->ClassName()
+           << " into " << GetName() << endl;
+      continue;
+    }
+    Add(*h);
+  }
+  return static_cast<Long64_t>(fEntries);
+}
+
+//_______________________________________________________________________________
+THnBase* CompactTHn::ToTHn(const char* name) const
+{
+  //
+  // convert into a THnF with the same axes and content
+  //
+  const int nDimensions = fAxes.size();
+  std::vector<int> nBins(nDimensions);
+  std::vector<double> xmin(nDimensions);
+  std::vector<double> xmax(nDimensions);
+  for (int idim = 0; idim < nDimensions; ++idim) {
+    nBins[idim] = fAxes[idim].GetNbins();
+    xmin[idim] = fAxes[idim].GetXmin();
+    xmax[idim] = fAxes[idim].GetXmax();
+  }
+  THnF* h = new THnF(name ? name : GetName(), GetTitle(), nDimensions, nBins.data(), xmin.data(), xmax.data());
+  for (int idim = 0; idim < nDimensions; ++idim) {
+    const TAxis& source = fAxes[idim];
+    TAxis* axis = h->GetAxis(idim);
+    if (source.GetXbins()->GetSize() > 0) {
+      axis->Set(nBins[idim], source.GetXbins()->GetArray());
+    }
+    axis->SetTitle(source.GetTitle());
+    if (source.GetLabels()) {
+      for (int ib = 1; ib <= nBins[idim]; ++ib) {
+        axis->SetBinLabel(ib, source.GetBinLabel(ib));
+      }
+    }
+  }
+  h->Sumw2();
+
+  // decode the linear bin of the compact histogram into the axis bins, the last dimension running fastest
+  std::vector<int> idx(nDimensions);
+  for (Long64_t bin = 0; bin < static_cast<Long64_t>(fContent.size()); ++bin) {
+    if (fContent[bin] == 0.0f && fSumw2[bin] == 0.0f) {
+      continue;
+    }
+    Long64_t rest = bin;
+    for (int idim = nDimensions - 1; idim >= 0; --idim) {
+      const int n = nBins[idim] + 2;
+      idx[idim] = rest % n;
+      rest /= n;
+    }
+    const Long64_t thnBin = h->GetBin(idx.data());
+    h->SetBinContent(thnBin, fContent[bin]);
+    h->SetBinError2(thnBin, fSumw2[bin]);
+  }
+  h->SetEntries(fEntries);
+  return h;
+}
@@ -0,0 +1,68 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Dense n-dimensional histogram stored as its axes plus two flat float arrays (bin contents and sum of squared weights)
+// Used by the HistogramManager instead of THnF when the compact THn output is enabled:
+//   the arrays are written as plain float buffers, which the ROOT file compression handles well for the mostly empty
+//   multi-dimensional histograms, and Merge() adds the buffers element-wise instead of iterating over the THn bins
+// ToTHn() gives back a THnF with the same axes and content for the analysis of the output
+//
+
+#ifndef CompactTHn_H
+#define CompactTHn_H
+
+#include <TNamed.h>
+#include <TAxis.h>
+
+#include <vector>
+
+class THnBase;
+class TCollection;
+
+class CompactTHn : public TNamed
+{
+
+ public:
+  CompactTHn();
+  // Copy the name, the title and the axes (binning, titles and labels) of the histogram, but not its content
+  explicit CompactTHn(const THnBase& h);
+  ~CompactTHn() override = default;
+
+  int GetNdimensions() const { return fAxes.size(); }
+  TAxis* GetAxis(int dim) { return &fAxes[dim]; }
+  Long64_t GetNbins() const { return fContent.size(); } // including the under- and overflow bins
+  double GetEntries() const { return fEntries; }
+  // Linear bin index of the axis bins idx (0 is the underflow), the last dimension runs fastest
+  Long64_t GetBin(const int* idx) const;
+  float GetBinContent(Long64_t bin) const { return fContent[bin]; }
+  float GetBinError2(Long64_t bin) const { return fSumw2[bin]; }
+
+  void Fill(const double* x, double w = 1.0);
+  bool IsCompatible(const CompactTHn& other) const;
+  // Add the content of a histogram with the same binning
+  bool Add(const CompactTHn& other);
+  void Reset();
+  // Called by hadd and by the output merging
+  Long64_t Merge(TCollection* list);
+
+  // THnF with the same axes and content, owned by the caller
+  THnBase* ToTHn(const char* name = nullptr) const;
+
+ private:
+  std::vector<TAxis> fAxes;    // axes
+  std::vector<float> fContent; // bin contents
+  std::vector<float> fSumw2;   // sum of squared weights
+  double fEntries;             // number of fills
+
+  ClassDef(CompactTHn, 1)
+};
+
+#endif
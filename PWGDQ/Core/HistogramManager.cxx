@@ -10,11 +10,16 @@
 // or submit itself to any jurisdiction.
 
 #include "PWGDQ/Core/HistogramManager.h"
+#include "PWGDQ/Core/CompactTHn.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <thread>
 using namespace std;
 
+#include <TROOT.h>
+
 #include <TObject.h>
 #include <TObjArray.h>
 #include <THashList.h>
@@ -37,7 +42,16 @@ HistogramManager::HistogramManager() : TNamed("", ""),
                                        fNVars(0),
                                        fUsedVars(nullptr),
                                        fVariablesMap(),
+                                       fClassHandles(),
+                                       fHandleClassNames(),
+                                       fFillEntries(),
+                                       fFillEntriesOutdated(false),
+                                       fShadowLists(),
+                                       fShadowFillEntries(),
+                                       fStacks(),
+                                       fStackMembers(),
                                        fUseDefaultVariableNames(false),
+                                       fUseCompactTHn(false),
                                        fBinsAllocated(0),
                                        fVariableNames(nullptr),
                                        fVariableUnits(nullptr)
@@ -53,7 +67,16 @@ HistogramManager::HistogramManager(const char* name, const char* title, const in
                                                                                               fNVars(maxNVars),
                                                                                               fUsedVars(),
                                                                                               fVariablesMap(),
+                                                                                              fClassHandles(),
+                                                                                              fHandleClassNames(),
+                                                                                              fFillEntries(),
+                                                                                              fFillEntriesOutdated(false),
+                                                                                              fShadowLists(),
+                                                                                              fShadowFillEntries(),
+                                                                                              fStacks(),
+                                                                                              fStackMembers(),
                                                                                               fUseDefaultVariableNames(kFALSE),
+                                                                                              fUseCompactTHn(kFALSE),
                                                                                               fBinsAllocated(0),
                                                                                               fVariableNames(),
                                                                                               fVariableUnits()
@@ -76,6 +99,9 @@ HistogramManager::~HistogramManager()
   // De-constructor
   //
   delete fMainList;
+  for (auto* shadow : fShadowLists) {
+    delete shadow;
+  }
   delete[] fUsedVars;
 }
 
@@ -102,6 +128,11 @@ void HistogramManager::AddHistClass(const char* histClass)
          << " because it already exists." << endl;
     return;
   }
+  if (fStackMembers.find(histClass) != fStackMembers.end()) {
+    cout << "Warning in HistogramManager::AddHistClass(): Cannot add histogram class " << histClass
+         << " because it is already a member of the stacked class " << fStackMembers[histClass].first << endl;
+    return;
+  }
   TList* hList = new TList;
   hList->SetOwner(kTRUE);
   hList->SetName(histClass);
@@ -112,6 +143,38 @@ void HistogramManager::AddHistClass(const char* histClass)
   cout << "Variable map size :: " << fVariablesMap.size() << endl;
 }
 
+//__________________________________________________________________
+void HistogramManager::AddHistClassStack(const char* stackName, const char* memberClasses)
+{
+  //
+  // Add a stacked histogram class, whose histograms are shared by the member classes
+  //
+  if (fMainList->FindObject(stackName) || fStackMembers.find(stackName) != fStackMembers.end()) {
+    cout << "Warning in HistogramManager::AddHistClassStack(): Cannot add stacked class " << stackName
+         << " because a histogram class with this name already exists." << endl;
+    return;
+  }
+  TString membersStr(memberClasses);
+  std::unique_ptr<TObjArray> arr(membersStr.Tokenize(";"));
+  std::vector<std::string> members;
+  for (int i = 0; i < arr->GetEntries(); ++i) {
+    const char* member = arr->At(i)->GetName();
+    if (fMainList->FindObject(member) || fStackMembers.find(member) != fStackMembers.end()) {
+      cout << "Warning in HistogramManager::AddHistClassStack(): Histogram class " << member
+           << " already exists and is not added to the stacked class " << stackName << endl;
+      continue;
+    }
+    fStackMembers[member] = std::make_pair(std::string(stackName), static_cast<int>(members.size()));
+    members.push_back(member);
+  }
+  if (members.empty()) {
+    cout << "Warning in HistogramManager::AddHistClassStack(): No member class for the stacked class " << stackName << endl;
+    return;
+  }
+  AddHistClass(stackName);
+  fStacks[stackName] = members;
+}
+
 //_________________________________________________________________
 void HistogramManager::AddHistogram(const char* histClass, const char* hname, const char* title, bool isProfile,
                                     int nXbins, double xmin, double xmax, int varX,
@@ -125,6 +188,28 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   //
   // TODO: replace the cout warning messages with LOG (same for all the other functions)
 
+  if (fStacks.find(histClass) != fStacks.end()) {
+    if (isProfile) {
+      cout << "Warning in HistogramManager::AddHistogram(): Profile " << hname << " cannot be added to the stacked class " << histClass << endl;
+      return;
+    }
+    int stackVars[3] = {varX, varY, varZ};
+    TArrayD stackBins[3];
+    const int nBins[3] = {nXbins, nYbins, nZbins};
+    const double mins[3] = {xmin, ymin, zmin};
+    const double maxs[3] = {xmax, ymax, zmax};
+    TString stackLabels[3] = {xLabels, yLabels, zLabels};
+    const int nDimensions = (varZ > kNothing ? 3 : (varY > kNothing ? 2 : 1));
+    for (int idim = 0; idim < nDimensions; ++idim) {
+      stackBins[idim].Set(nBins[idim] + 1);
+      for (int ib = 0; ib <= nBins[idim]; ++ib) {
+        stackBins[idim][ib] = mins[idim] + ib * (maxs[idim] - mins[idim]) / nBins[idim];
+      }
+    }
+    AddStackedHistogram(histClass, hname, title, nDimensions, stackVars, stackBins, stackLabels, varW);
+    return;
+  }
+
   // get the list to which the histogram should be added
   TList* hList = (TList*)fMainList->FindObject(histClass);
   if (!hList) {
@@ -177,11 +262,11 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   varVector.push_back(varY);
   varVector.push_back(varZ);
   varVector.push_back(varT); // variable used for profiling in case of TProfile3D
-  std::list varList = fVariablesMap[histClass];
+  std::list<std::vector<int>>& varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
-  fVariablesMap[histClass] = varList;
+  fFillEntriesOutdated = true;
 
   // create and configure histograms according to required options
   TH1* h = nullptr;
@@ -323,6 +408,25 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   // add a histogram
   //
 
+  if (fStacks.find(histClass) != fStacks.end()) {
+    if (isProfile) {
+      cout << "Warning in HistogramManager::AddHistogram(): Profile " << hname << " cannot be added to the stacked class " << histClass << endl;
+      return;
+    }
+    int stackVars[3] = {varX, varY, varZ};
+    const int nDimensions = (varZ > kNothing ? 3 : (varY > kNothing ? 2 : 1));
+    TArrayD stackBins[3] = {TArrayD(nXbins + 1, xbins), TArrayD(), TArrayD()};
+    if (nDimensions > 1) {
+      stackBins[1].Set(nYbins + 1, ybins);
+    }
+    if (nDimensions > 2) {
+      stackBins[2].Set(nZbins + 1, zbins);
+    }
+    TString stackLabels[3] = {xLabels, yLabels, zLabels};
+    AddStackedHistogram(histClass, hname, title, nDimensions, stackVars, stackBins, stackLabels, varW);
+    return;
+  }
+
   // get the list to which the histogram should be added
   TList* hList = (TList*)fMainList->FindObject(histClass);
   if (!hList) {
@@ -376,11 +480,11 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   varVector.push_back(varY);
   varVector.push_back(varZ);
   varVector.push_back(varT); // variable used for profiling in case of TProfile3D
-  std::list varList = fVariablesMap[histClass];
+  std::list<std::vector<int>>& varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
-  fVariablesMap[histClass] = varList;
+  fFillEntriesOutdated = true;
 
   TH1* h = nullptr;
   switch (dimension) {
@@ -515,6 +619,18 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   // add a multi-dimensional histogram THnF or THnFSparseF
   //
 
+  if (fStacks.find(histClass) != fStacks.end()) {
+    std::vector<TArrayD> stackBins(nDimensions);
+    for (int idim = 0; idim < nDimensions; ++idim) {
+      stackBins[idim].Set(nBins[idim] + 1);
+      for (int ib = 0; ib <= nBins[idim]; ++ib) {
+        stackBins[idim][ib] = xmin[idim] + ib * (xmax[idim] - xmin[idim]) / nBins[idim];
+      }
+    }
+    AddStackedHistogram(histClass, hname, title, nDimensions, vars, stackBins.data(), axLabels, varW);
+    return;
+  }
+
   // get the list to which the histogram should be added
   TList* hList = (TList*)fMainList->FindObject(histClass);
   if (!hList) {
@@ -544,11 +660,11 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   for (int idim = 0; idim < nDimensions; ++idim) {
     varVector.push_back(vars[idim]); // axes variables
   }
-  std::list varList = fVariablesMap[histClass];
+  std::list<std::vector<int>>& varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
-  fVariablesMap[histClass] = varList;
+  fFillEntriesOutdated = true;
 
   unsigned long int nbins = 1;
   THnBase* h = nullptr;
@@ -578,6 +694,10 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   }
   if (useSparse) {
     hList->Add((THnSparseF*)h);
+  } else if (fUseCompactTHn) {
+    // the THnF is only used to configure the axes
+    hList->Add(new CompactTHn(*h));
+    delete h;
   } else {
     hList->Add((THnF*)h);
   }
@@ -594,6 +714,11 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   // add a multi-dimensional histogram THnF or THnSparseF with equal or variable bin widths
   //
 
+  if (fStacks.find(histClass) != fStacks.end()) {
+    AddStackedHistogram(histClass, hname, title, nDimensions, vars, binLimits, axLabels, varW);
+    return;
+  }
+
   // get the list to which the histogram should be added
   TList* hList = (TList*)fMainList->FindObject(histClass);
   if (!hList) {
@@ -623,11 +748,11 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   for (int idim = 0; idim < nDimensions; ++idim) {
     varVector.push_back(vars[idim]); // axes variables
   }
-  std::list varList = fVariablesMap[histClass];
+  std::list<std::vector<int>>& varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
-  fVariablesMap[histClass] = varList;
+  fFillEntriesOutdated = true;
 
   // get the min and max for each axis
   double* xmin = new double[nDimensions];
@@ -671,137 +796,413 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   }
   if (useSparse) {
     hList->Add((THnSparseF*)h);
+  } else if (fUseCompactTHn) {
+    // the THnF is only used to configure the axes
+    hList->Add(new CompactTHn(*h));
+    delete h;
   } else {
     hList->Add((THnF*)h);
   }
   fBinsAllocated += bins;
 }
 
+//_________________________________________________________________
+void HistogramManager::AddStackedHistogram(const char* histClass, const char* hname, const char* title, int nDimensions, int* vars,
+                                           TArrayD* binLimits, TString* axLabels, int varW)
+{
+  //
+  // add a histogram to a stacked class, as a THnSparseF whose first axis runs over the member classes
+  //
+  TList* hList = (TList*)fMainList->FindObject(histClass);
+  if (hList->FindObject(hname)) {
+    cout << "Warning in HistogramManager::AddHistogram(): Histogram " << hname << " already exists" << endl;
+    return;
+  }
+  if (nDimensions + 1 > kMaxFillVars) {
+    cout << "Warning in HistogramManager::AddHistogram(): Stacked histogram " << hname << " has more than "
+         << kMaxFillVars << " dimensions and is not created" << endl;
+    return;
+  }
+  const std::vector<std::string>& members = fStacks[histClass];
+  const int nMembers = members.size();
+
+  // tokenize the title string; the user may include in it axis titles which will overwrite the defaults
+  TString titleStr(title);
+  std::unique_ptr<TObjArray> arr(titleStr.Tokenize(";"));
+
+  if (varW > kNothing) {
+    fUsedVars[varW] = kTRUE;
+  }
+
+  // encode needed variable identifiers as for a THn, the class axis having no variable
+  std::vector<int> varVector;
+  varVector.push_back(0);               // whether the histogram is a profile
+  varVector.push_back(nDimensions + 1); // number of dimensions
+  varVector.push_back(varW);            // variable used for weighting
+  varVector.push_back(kNothing);        // class axis
+  for (int idim = 0; idim < nDimensions; ++idim) {
+    varVector.push_back(vars[idim]); // axes variables
+  }
+  fVariablesMap[histClass].push_back(varVector);
+  cout << "Adding stacked histogram " << hname << endl;
+  fFillEntriesOutdated = true;
+
+  std::vector<int> nBins(nDimensions + 1);
+  std::vector<double> xmin(nDimensions + 1);
+  std::vector<double> xmax(nDimensions + 1);
+  nBins[0] = nMembers;
+  xmin[0] = -0.5;
+  xmax[0] = nMembers - 0.5;
+  for (int idim = 0; idim < nDimensions; ++idim) {
+    nBins[idim + 1] = binLimits[idim].GetSize() - 1;
+    xmin[idim + 1] = binLimits[idim][0];
+    xmax[idim + 1] = binLimits[idim][nBins[idim + 1]];
+  }
+  THnSparseF* h = new THnSparseF(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nDimensions + 1, nBins.data(), xmin.data(), xmax.data());
+  h->Sumw2();
+
+  TAxis* classAxis = h->GetAxis(0);
+  classAxis->SetTitle("class");
+  for (int i = 0; i < nMembers; ++i) {
+    classAxis->SetBinLabel(i + 1, members[i].c_str());
+  }
+  unsigned long int bins = nMembers + 2;
+  for (int idim = 0; idim < nDimensions; ++idim) {
+    bins *= (nBins[idim + 1] + 2);
+    TAxis* axis = h->GetAxis(idim + 1);
+    axis->Set(nBins[idim + 1], binLimits[idim].GetArray());
+    if (fVariableNames[vars[idim]][0]) {
+      axis->SetTitle(Form("%s %s", fVariableNames[vars[idim]].Data(),
+                          (fVariableUnits[vars[idim]][0] ? Form("(%s)", fVariableUnits[vars[idim]].Data()) : "")));
+    }
+    if (arr->At(1 + idim)) {
+      axis->SetTitle(arr->At(1 + idim)->GetName());
+    }
+    if (axLabels && !axLabels[idim].IsNull()) {
+      MakeAxisLabels(axis, axLabels[idim].Data());
+    }
+    fUsedVars[vars[idim]] = kTRUE;
+  }
+  hList->Add(h);
+  fBinsAllocated += bins;
+}
+
+//__________________________________________________________________
+int HistogramManager::GetHistClassHandle(const char* className)
+{
+  //
+  //  get the handle of a histogram class, building its fill information at the first call
+  //
+  auto handle = fClassHandles.find(className);
+  if (handle != fClassHandles.end()) {
+    return handle->second;
+  }
+  // the stacked classes are filled through their member classes
+  if (fStacks.find(className) != fStacks.end()) {
+    cout << "Warning in HistogramManager::GetHistClassHandle(): " << className << " is a stacked class, fill its member classes instead" << endl;
+    return kNothing;
+  }
+  if (!fMainList->FindObject(className) && fStackMembers.find(className) == fStackMembers.end()) {
+    return kNothing;
+  }
+  int classHandle = fFillEntries.size();
+  fClassHandles[className] = classHandle;
+  fHandleClassNames.push_back(className);
+  fFillEntries.emplace_back();
+  BuildFillEntries(classHandle);
+  return classHandle;
+}
+
+//__________________________________________________________________
+void HistogramManager::BuildFillEntries(int classHandle)
+{
+  //
+  //  build the fill information of a histogram class, for the main list and for the shadows
+  //
+  // the member classes of a stacked class are filled in the histograms of the stacked class
+  const char* className = fHandleClassNames[classHandle].c_str();
+  int stackIndex = kNothing;
+  if (auto member = fStackMembers.find(className); member != fStackMembers.end()) {
+    className = member->second.first.c_str();
+    stackIndex = member->second.second;
+  }
+  const std::list<std::vector<int>>& varList = fVariablesMap[className];
+  BuildFillEntries((TList*)fMainList->FindObject(className), varList, fFillEntries[classHandle], stackIndex);
+  for (std::size_t ishadow = 0; ishadow < fShadowLists.size(); ++ishadow) {
+    std::vector<std::vector<HistFillEntry>>& shadowEntries = fShadowFillEntries[ishadow];
+    if (static_cast<int>(shadowEntries.size()) <= classHandle) {
+      shadowEntries.resize(classHandle + 1);
+    }
+    BuildFillEntries((TList*)fShadowLists[ishadow]->FindObject(className), varList, shadowEntries[classHandle], stackIndex);
+  }
+}
+
+//__________________________________________________________________
+void HistogramManager::BuildFillEntries(TList* hList, const std::list<std::vector<int>>& varList, std::vector<HistFillEntry>& entries, int stackIndex)
+{
+  //
+  //  decode the histogram types and variable indices of a histogram list into a flat array
+  //
+  entries.clear();
+  if (!hList) {
+    return;
+  }
+  entries.reserve(varList.size());
+
+  // NOTE: the histogram list and the std::list of variables contain the same number of elements and are synchronized
+  //       (the shadow lists may be shorter, if histograms were added after their creation)
+  TIter next(hList);
+  for (auto const& varVector : varList) {
+    HistFillEntry entry;
+    entry.fHist = next();
+    if (!entry.fHist) {
+      break;
+    }
+    entry.fVarW = varVector[2];
+    entry.fStackValue = stackIndex;
+    bool isProfile = (varVector[0] == 1);
+    int nDimensionsTHn = varVector[1];
+    if (nDimensionsTHn > 0) {
+      if (nDimensionsTHn > kMaxFillVars) {
+        cout << "Warning in HistogramManager::BuildFillEntries(): Histogram " << entry.fHist->GetName() << " has more than "
+             << kMaxFillVars << " dimensions and will not be filled" << endl;
+        continue;
+      }
+      if (stackIndex > kNothing) {
+        entry.fKind = kStackedTHn;
+      } else {
+        entry.fKind = (entry.fHist->InheritsFrom(CompactTHn::Class()) ? kCompactTHn : kTHn);
+      }
+      entry.fNVars = nDimensionsTHn;
+    } else {
+      int dimension = ((TH1*)entry.fHist)->GetDimension();
+      entry.fKind = (isProfile ? kTProfile : kTH1) + dimension - 1;
+      // profiles have one extra variable, the one being averaged
+      entry.fNVars = dimension + (isProfile ? 1 : 0);
+    }
+    for (int i = 0; i < entry.fNVars; ++i) {
+      entry.fVars[i] = varVector[3 + i];
+    }
+    entries.push_back(entry);
+  }
+}
+
 //__________________________________________________________________
 void HistogramManager::FillHistClass(const char* className, Float_t* values)
 {
   //
   //  fill a class of histograms
   //
+  FillHistClass(GetHistClassHandle(className), values);
+}
 
-  // get the needed histogram list
-  TList* hList = (TList*)fMainList->FindObject(className);
-  if (!hList) {
-    // TODO: add some meaningfull error message
-    /*cout << "Warning in HistogramManager::FillHistClass(): Histogram list " << className << " not found!" << endl;
-    cout << "         Histogram list not filled" << endl; */
+//__________________________________________________________________
+void HistogramManager::FillHistClass(int classHandle, Float_t* values)
+{
+  //
+  //  fill a class of histograms using its handle
+  //
+  if (classHandle < 0 || classHandle >= static_cast<int>(fFillEntries.size())) {
     return;
   }
+  if (fFillEntriesOutdated) {
+    for (int handle = 0; handle < static_cast<int>(fFillEntries.size()); ++handle) {
+      BuildFillEntries(handle);
+    }
+    fFillEntriesOutdated = false;
+  }
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
+  FillEntries(fFillEntries[classHandle], values);
+}
 
-  TIter next(hList);
+//__________________________________________________________________
+void HistogramManager::FillHistClass(int classHandle, Float_t* values, int shadow)
+{
+  //
+  //  fill a class of histograms of a shadow, from the thread owning it
+  //  NOTE: the fill information is not rebuilt here, since it is shared by all the shadows
+  //
+  if (shadow == 0) {
+    FillHistClass(classHandle, values);
+    return;
+  }
+  if (shadow < 0 || shadow > static_cast<int>(fShadowLists.size())) {
+    return;
+  }
+  const std::vector<std::vector<HistFillEntry>>& shadowEntries = fShadowFillEntries[shadow - 1];
+  if (classHandle < 0 || classHandle >= static_cast<int>(shadowEntries.size())) {
+    return;
+  }
+  FillEntries(shadowEntries[classHandle], values);
+}
 
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
-  // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
-  //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
-  double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
-
-  // loop over the histogram and std::list
-  // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
-  for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = (varIter->at(0) == 1 ? true : false);
-    isTHn = (varIter->at(1) > 0 ? true : false);
-    if (isTHn) {
-      dimension = varIter->at(1);
-    } else {
-      dimension = ((TH1*)h)->GetDimension();
+//__________________________________________________________________
+void HistogramManager::FillEntries(const std::vector<HistFillEntry>& entries, Float_t* values)
+{
+  //
+  //  fill the histograms of a class
+  //
+  double fillValues[kMaxFillVars] = {0.0};
+  for (auto const& entry : entries) {
+    const int* vars = entry.fVars;
+    // NOTE: filling with a unit weight is equivalent to the unweighted Fill()
+    double weight = (entry.fVarW > kNothing ? values[entry.fVarW] : 1.0);
+    switch (entry.fKind) {
+      case kTH1:
+        ((TH1*)entry.fHist)->Fill(values[vars[0]], weight);
+        break;
+      case kTH2:
+        ((TH2*)entry.fHist)->Fill(values[vars[0]], values[vars[1]], weight);
+        break;
+      case kTH3:
+        ((TH3*)entry.fHist)->Fill(values[vars[0]], values[vars[1]], values[vars[2]], weight);
+        break;
+      case kTProfile:
+        ((TProfile*)entry.fHist)->Fill(values[vars[0]], values[vars[1]], weight);
+        break;
+      case kTProfile2D:
+        ((TProfile2D*)entry.fHist)->Fill(values[vars[0]], values[vars[1]], values[vars[2]], weight);
+        break;
+      case kTProfile3D:
+        ((TProfile3D*)entry.fHist)->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]], weight);
+        break;
+      case kTHn:
+        for (int i = 0; i < entry.fNVars; ++i) {
+          fillValues[i] = values[vars[i]];
+        }
+        ((THnBase*)entry.fHist)->Fill(fillValues, weight);
+        break;
+      case kCompactTHn:
+        for (int i = 0; i < entry.fNVars; ++i) {
+          fillValues[i] = values[vars[i]];
+        }
+        ((CompactTHn*)entry.fHist)->Fill(fillValues, weight);
+        break;
+      case kStackedTHn:
+        // the first axis runs over the member classes of the stacked class
+        fillValues[0] = entry.fStackValue;
+        for (int i = 1; i < entry.fNVars; ++i) {
+          fillValues[i] = values[vars[i]];
+        }
+        ((THnBase*)entry.fHist)->Fill(fillValues, weight);
+        break;
+      default:
+        break;
     }
+  } // end loop over histograms
+}
 
-    // get the various variable indices
-    varW = varIter->at(2);
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[varIter->at(3 + i)];
+//__________________________________________________________________
+void HistogramManager::CreateShadows(int nShadows)
+{
+  //
+  //  create the thread-local copies of the main histogram list
+  //
+  if (!fShadowLists.empty()) {
+    cout << "Warning in HistogramManager::CreateShadows(): Shadows already created" << endl;
+    return;
+  }
+  for (int ishadow = 0; ishadow < nShadows; ++ishadow) {
+    THashList* shadow = new THashList;
+    shadow->SetOwner(kTRUE);
+    shadow->SetName(Form("%s_shadow%d", fMainList->GetName(), ishadow + 1));
+    TIter nextClass(fMainList);
+    while (TList* hList = (TList*)nextClass()) {
+      TList* shadowList = new TList;
+      shadowList->SetOwner(kTRUE);
+      shadowList->SetName(hList->GetName());
+      TIter nextHist(hList);
+      while (TObject* obj = nextHist()) {
+        TObject* clone = obj->Clone();
+        if (clone->InheritsFrom(TH1::Class())) {
+          ((TH1*)clone)->SetDirectory(nullptr);
+          ((TH1*)clone)->Reset();
+        } else if (clone->InheritsFrom(THnBase::Class())) {
+          ((THnBase*)clone)->Reset();
+        } else if (clone->InheritsFrom(CompactTHn::Class())) {
+          ((CompactTHn*)clone)->Reset();
+        }
+        shadowList->Add(clone);
       }
-    } else {
-      varX = varIter->at(3);
-      varY = varIter->at(4);
-      varZ = varIter->at(5);
-      varT = varIter->at(6);
+      shadow->Add(shadowList);
     }
+    fShadowLists.push_back(shadow);
+  }
+  fShadowFillEntries.resize(fShadowLists.size());
+  for (int handle = 0; handle < static_cast<int>(fFillEntries.size()); ++handle) {
+    BuildFillEntries(handle);
+  }
+  fFillEntriesOutdated = false;
+}
 
-    if (!isTHn) {
-      switch (dimension) {
-        case 1:
-          if (isProfile) {
-            if (varW > kNothing) {
-              ((TProfile*)h)->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              ((TProfile*)h)->Fill(values[varX], values[varY]);
-            }
-          } else {
-            if (varW > kNothing) {
-              ((TH1F*)h)->Fill(values[varX], values[varW]);
-            } else {
-              ((TH1F*)h)->Fill(values[varX]);
-            }
-          }
-          break;
-        case 2:
-          if (isProfile) {
-            if (varW > kNothing) {
-              ((TProfile2D*)h)->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              ((TProfile2D*)h)->Fill(values[varX], values[varY], values[varZ]);
-            }
-          } else {
-            if (varW > kNothing) {
-              ((TH2F*)h)->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              ((TH2F*)h)->Fill(values[varX], values[varY]);
-            }
-          }
-          break;
-        case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              ((TProfile3D*)h)->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
-            } else {
-              ((TProfile3D*)h)->Fill(values[varX], values[varY], values[varZ], values[varT]);
-            }
-          } else {
-            if (varW > kNothing) {
-              ((TH3F*)h)->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              ((TH3F*)h)->Fill(values[varX], values[varY], values[varZ]);
-            }
-          }
-          break;
-
-        default:
-          break;
-      } // end switch
-    }   // end if(!isTHn)
-    else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          ((THnSparseF*)h)->Fill(fillValues, values[varW]);
-        } else {
-          ((THnF*)h)->Fill(fillValues, values[varW]);
-        }
-      } else {
-        if (isSparse) {
-          ((THnSparseF*)h)->Fill(fillValues);
-        } else {
-          ((THnF*)h)->Fill(fillValues);
+//__________________________________________________________________
+static void MergeHistogram(TObject* target, TObject* source)
+{
+  //
+  //  add a shadow histogram to the main one and reset it
+  //
+  if (target->InheritsFrom(TH1::Class())) {
+    ((TH1*)target)->Add((TH1*)source);
+    ((TH1*)source)->Reset();
+  } else if (target->InheritsFrom(THnBase::Class())) {
+    ((THnBase*)target)->Add((THnBase*)source);
+    ((THnBase*)source)->Reset();
+  } else if (target->InheritsFrom(CompactTHn::Class())) {
+    ((CompactTHn*)target)->Add(*(CompactTHn*)source);
+    ((CompactTHn*)source)->Reset();
+  }
+}
+
+//__________________________________________________________________
+void HistogramManager::MergeShadows(int nThreads)
+{
+  //
+  //  add the content of the shadows to the main histogram list, the histogram classes being shared among nThreads threads
+  //
+  if (fShadowLists.empty()) {
+    return;
+  }
+  // histogram lists of each class: the main one first, then the shadow ones
+  std::vector<std::vector<TList*>> classLists;
+  TIter nextClass(fMainList);
+  while (TList* hList = (TList*)nextClass()) {
+    std::vector<TList*> lists{hList};
+    for (auto* shadow : fShadowLists) {
+      if (TList* shadowList = (TList*)shadow->FindObject(hList->GetName())) {
+        lists.push_back(shadowList);
+      }
+    }
+    classLists.push_back(lists);
+  }
+
+  auto mergeClasses = [&classLists](int first, int stride) {
+    for (std::size_t iclass = first; iclass < classLists.size(); iclass += stride) {
+      const std::vector<TList*>& lists = classLists[iclass];
+      for (std::size_t ilist = 1; ilist < lists.size(); ++ilist) {
+        TIter nextTarget(lists[0]);
+        TIter nextSource(lists[ilist]);
+        TObject* target = nullptr;
+        TObject* source = nullptr;
+        while ((target = nextTarget()) && (source = nextSource())) {
+          MergeHistogram(target, source);
         }
       }
-    } // end else
-  }   // end loop over histograms
+    }
+  };
+
+  nThreads = std::max(1, std::min(nThreads, static_cast<int>(classLists.size())));
+  if (nThreads == 1) {
+    mergeClasses(0, 1);
+    return;
+  }
+  ROOT::EnableThreadSafety();
+  std::vector<std::thread> threads;
+  for (int ithread = 0; ithread < nThreads; ++ithread) {
+    threads.emplace_back(mergeClasses, ithread, nThreads);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
 }
 
 //____________________________________________________________________________________
@@ -51,6 +51,12 @@ class HistogramManager : public TNamed
 
   // Create a new histogram class
   void AddHistClass(const char* histClass);
+  // Create a stacked histogram class, holding the histograms of the classes listed in memberClasses (separated by semicolon ";")
+  // The histograms added afterwards to the stacked class are defined once and shared by all its member classes:
+  //   each one is stored as a THnSparseF with an extra first axis running over the member classes, so that only the
+  //   filled bins are allocated and there is one histogram object instead of one per class
+  // The member classes are filled as usual with FillHistClass(), using their names or handles. Profiles cannot be stacked.
+  void AddHistClassStack(const char* stackName, const char* memberClasses);
   // Create a new histogram in the class <histClass> with name <name> and title <title>
   // The type of histogram is deduced from the parameters specified by the user
   // The binning for at least one dimension needs to be specified, namely: nXbins, xmin, xmax, varX which will result in a TH1F histogram
@@ -85,6 +91,25 @@ class HistogramManager : public TNamed
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE);
 
   void FillHistClass(const char* className, float* values);
+  // Get a handle to the histogram class <className>, to be used in the hot loops with FillHistClass(int, float*)
+  // The histogram types and variable indices of the class are decoded once, when the handle is created
+  // Returns kNothing if the class does not exist
+  int GetHistClassHandle(const char* className);
+  void FillHistClass(int classHandle, float* values);
+
+  // Store the dense THn histograms defined afterwards as CompactTHn (axes plus flat float arrays) instead of THnF
+  // The output is then merged by adding the arrays, which is much faster for large multi-dimensional histograms
+  void SetUseCompactTHn(bool flag) { fUseCompactTHn = flag; }
+
+  // Thread-local copies of the histograms, for filling the same histogram classes from several threads
+  // CreateShadows() must be called once all the histograms are defined and the handles retrieved with GetHistClassHandle():
+  //   shadow 0 is the main list, the shadows 1 to nShadows are copies of it, each to be filled by a single thread
+  // MergeShadows() adds the shadows to the main list and resets them; it must be called when no thread is filling,
+  //   the histogram classes are merged in parallel by nThreads threads
+  void CreateShadows(int nShadows);
+  void FillHistClass(int classHandle, float* values, int shadow);
+  void MergeShadows(int nThreads = 1);
+  int GetNShadows() const { return fShadowLists.size(); }
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; };
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -102,8 +127,49 @@ class HistogramManager : public TNamed
   bool* fUsedVars;                                                  //! flags of used variables
   std::map<std::string, std::list<std::vector<int>>> fVariablesMap; //!  map holding identifiers for all variables needed by histograms
 
+  // precomputed fill information for the histogram class handles
+  enum HistKinds {
+    kTH1 = 0,
+    kTH2,
+    kTH3,
+    kTProfile,
+    kTProfile2D,
+    kTProfile3D,
+    kTHn,
+    kCompactTHn,
+    kStackedTHn
+  };
+  static constexpr int kMaxFillVars = 20; // maximum number of variables filled in a histogram (THn dimensions)
+  struct HistFillEntry {
+    TObject* fHist;          // histogram to be filled
+    int fKind;               // histogram kind, see HistKinds
+    int fVarW;               // variable used for weighting, kNothing if not weighted
+    int fNVars;              // number of filled variables
+    double fStackValue;      // coordinate on the class axis of stacked histograms
+    int fVars[kMaxFillVars]; // filled variables, in the order of the Fill() arguments
+  };
+  std::map<std::string, int> fClassHandles;             //! handles of the histogram classes
+  std::vector<std::string> fHandleClassNames;           //! histogram class names, indexed by handle
+  std::vector<std::vector<HistFillEntry>> fFillEntries; //! fill information of each histogram class, indexed by handle
+  bool fFillEntriesOutdated;                            //! histograms were added after the fill information was built
+
+  std::vector<THashList*> fShadowLists;                                    //! thread-local copies of the main list
+  std::vector<std::vector<std::vector<HistFillEntry>>> fShadowFillEntries; //! fill information of the shadows, indexed by shadow and handle
+
+  // stacked histogram classes
+  std::map<std::string, std::vector<std::string>> fStacks;          //! member classes of each stacked class
+  std::map<std::string, std::pair<std::string, int>> fStackMembers; //! stacked class and position of each member class
+
+  void AddStackedHistogram(const char* histClass, const char* name, const char* title, int nDimensions, int* vars,
+                           TArrayD* binLimits, TString* axLabels, int varW);
+
+  void BuildFillEntries(int classHandle);
+  void BuildFillEntries(TList* hList, const std::list<std::vector<int>>& varList, std::vector<HistFillEntry>& entries, int stackIndex = kNothing);
+  static void FillEntries(const std::vector<HistFillEntry>& entries, float* values);
+
   // various
   bool fUseDefaultVariableNames;    //! toggle the usage of default variable names and units
+  bool fUseCompactTHn;              //! create the dense THn histograms as CompactTHn
   unsigned long int fBinsAllocated; //! number of allocated bins
   TString* fVariableNames;          //! variable names
   TString* fVariableUnits;          //! variable units
@@ -24,9 +24,22 @@ namespace o2::aod
 namespace dqhistograms
 {
 void DefineHistograms(HistogramManager* hm, const char* histClass, const char* groupName, const char* subGroupName = "");
+void DefineStackedHistograms(HistogramManager* hm, const char* stackName, const char* histClasses, const char* groupName, const char* subGroupName = "");
 }
 } // namespace o2::aod
 
+void o2::aod::dqhistograms::DefineStackedHistograms(HistogramManager* hm, const char* stackName, const char* histClasses, const char* groupName, const char* subGroupName)
+{
+  //
+  // Add a predefined group of histograms once for all the histogram classes in histClasses (separated by semicolon ";")
+  // The histograms are stored in the stacked class stackName, with an extra axis running over the classes, see HistogramManager::AddHistClassStack()
+  // NOTE: Use it for classes with identical histogram sets, e.g. the same track histograms for several track cuts.
+  //       The profiles of the group are not defined, since they cannot be stacked
+  //
+  hm->AddHistClassStack(stackName, histClasses);
+  DefineHistograms(hm, stackName, groupName, subGroupName);
+}
+
 void o2::aod::dqhistograms::DefineHistograms(HistogramManager* hm, const char* histClass, const char* groupName, const char* subGroupName)
 {
   //
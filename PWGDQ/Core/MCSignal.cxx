@@ -72,3 +72,56 @@ void MCSignal::PrintConfig()
     pr.Print();
   }
 }
+
+//________________________________________________________________________________________________
+bool MCSignal::CheckProngFromAncestry(int i, bool checkSources, const MCSignalAncestry::Particle& particle)
+{
+  const MCProng& prong = fProngs[i];
+  // the history ends before the oldest generation specified for this prong
+  if (particle.nGenerations < prong.fNGenerations) {
+    return false;
+  }
+  for (int j = 0; j < prong.fNGenerations; j++) {
+    // check the PDG code
+    if (!prong.TestPDG(j, particle.pdgCodes[j])) {
+      return false;
+    }
+    // check the common ancestor (if specified)
+    if (fNProngs > 1 && fCommonAncestorIdxs[i] == j) {
+      if (i == 0) {
+        fTempAncestorLabel = particle.indices[j];
+      } else {
+        if (particle.indices[j] != fTempAncestorLabel) {
+          return false;
+        }
+      }
+    }
+  }
+
+  if (checkSources) {
+    for (int j = 0; j < prong.fNGenerations; j++) {
+      if (!prong.fSourceBits[j]) {
+        // no sources required for this generation
+        continue;
+      }
+      // check each source, with the same decision as in CheckProng()
+      uint64_t sourcesDecision = 0;
+      for (int s = 0; s < MCProng::kNSources; s++) {
+        uint64_t bit = (uint64_t(1) << s);
+        if ((prong.fSourceBits[j] & bit) && ((prong.fExcludeSource[j] & bit) != uint64_t((particle.sources[j] >> s) & 1))) {
+          sourcesDecision |= bit;
+        }
+      }
+      // no source bit is fulfilled
+      if (!sourcesDecision) {
+        return false;
+      }
+      // if fUseANDonSourceBitMap is on, request all bits
+      if (prong.fUseANDonSourceBitMap[j] && (sourcesDecision != prong.fSourceBits[j])) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
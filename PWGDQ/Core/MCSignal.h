@@ -57,6 +57,7 @@ process(aod::McParticles const& mcTracks) {
 #define MCSignal_H
 
 #include "MCProng.h"
+#include "MCSignalAncestry.h"
 #include "TNamed.h"
 
 #include <vector>
@@ -96,6 +97,19 @@ class MCSignal : public TNamed
     return CheckMC(0, checkSources, mcStack, args...);
   };
 
+  // Same decision as CheckSignal(), with the histories of the particles taken from an ancestry precomputed on the stack
+  // Prongs checked in time, particles missing from the ancestry and histories longer than the stored ones fall back to CheckSignal()
+  template <typename U, typename... T>
+  bool CheckSignalFromAncestry(bool checkSources, const MCSignalAncestry& ancestry, const U& mcStack, const T&... args)
+  {
+    // Make sure number of tracks provided is equal to the number of prongs
+    if (sizeof...(args) != fNProngs) {
+      return false;
+    }
+
+    return CheckMCFromAncestry(0, checkSources, ancestry, mcStack, args...);
+  };
+
   void PrintConfig();
 
  private:
@@ -106,6 +120,7 @@ class MCSignal : public TNamed
 
   template <typename U, typename T>
   bool CheckProng(int i, bool checkSources, const U& mcStack, const T& track);
+  bool CheckProngFromAncestry(int i, bool checkSources, const MCSignalAncestry::Particle& particle);
 
   template <typename U>
   bool CheckMC(int, bool, U)
@@ -124,6 +139,31 @@ class MCSignal : public TNamed
     }
   };
 
+  template <typename U>
+  bool CheckMCFromAncestry(int, bool, const MCSignalAncestry&, const U&)
+  {
+    return true;
+  };
+
+  template <typename U, typename T, typename... Ts>
+  bool CheckMCFromAncestry(int i, bool checkSources, const MCSignalAncestry& ancestry, const U& mcStack, const T& track, const Ts&... args)
+  {
+    // use the precomputed history if it covers all the generations of the prong, otherwise walk the stack
+    const MCSignalAncestry::Particle* particle = ancestry.Get(track.globalIndex());
+    bool decision = false;
+    if (particle != nullptr && !fProngs[i].fCheckGenerationsInTime && (!particle->truncated || fProngs[i].fNGenerations <= particle->nGenerations)) {
+      decision = CheckProngFromAncestry(i, checkSources, *particle);
+    } else {
+      decision = CheckProng(i, checkSources, mcStack, track);
+    }
+    // recursive call of CheckMCFromAncestry for all args
+    if (!decision) {
+      return false;
+    } else {
+      return CheckMCFromAncestry(i + 1, checkSources, ancestry, mcStack, args...);
+    }
+  };
+
   ClassDef(MCSignal, 1);
 };
 
@@ -0,0 +1,119 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Precomputed history (back in time) of all the particles of an MC stack, to be used with MCSignal::CheckSignalFromAncestry()
+// For each particle, the PDG code, the stack index and the MCProng::Source bit map of the particle, its mother, grand-mother, ...
+//   are stored in fixed-width arrays, following the first mother as MCSignal::CheckSignal() does.
+// The history is walked once per particle when filling, instead of once per particle, signal and prong when checking the signals.
+//
+// Example usage:
+//   MCSignalAncestry ancestry;
+//   ancestry.Fill(mcTracks);
+//   for (auto& mctrack : mcTracks) {
+//     for (auto& sig : signals) {
+//       if (sig.CheckSignalFromAncestry(true, ancestry, mcTracks, mctrack)) { ... }
+//     }
+//   }
+//
+
+#ifndef MCSignalAncestry_H
+#define MCSignalAncestry_H
+
+#include "PWGDQ/Core/MCProng.h"
+
+#include <cstdint>
+#include <vector>
+
+//_________________________________________________________________________
+class MCSignalAncestry
+{
+ public:
+  static constexpr int kMaxGenerations = 8; // longer histories are checked by walking the stack
+
+  struct Particle {
+    int nGenerations = 0;                // number of stored generations, including the particle itself
+    bool truncated = false;              // the history continues beyond kMaxGenerations
+    int pdgCodes[kMaxGenerations] = {0}; // PDG code of each generation
+    int64_t indices[kMaxGenerations];    // stack index of each generation
+    uint8_t sources[kMaxGenerations];    // MCProng::Source bit map of each generation
+  };
+
+  MCSignalAncestry() = default;
+  ~MCSignalAncestry() = default;
+
+  // Compute the history of all the particles of the stack
+  // NOTE: the stack has to be a table or a slice with consecutive indices (e.g. the particles of one MC collision)
+  template <typename U>
+  void Fill(const U& mcStack)
+  {
+    fParticles.clear();
+    fParticles.resize(mcStack.size());
+    fOffset = (mcStack.size() > 0 ? mcStack.begin().globalIndex() : 0);
+    for (auto& mcParticle : mcStack) {
+      int64_t idx = mcParticle.globalIndex() - fOffset;
+      if (idx < 0 || idx >= static_cast<int64_t>(fParticles.size())) {
+        continue;
+      }
+      Particle& particle = fParticles[idx];
+      auto currentMCParticle = mcParticle;
+      for (int j = 0; j < kMaxGenerations; j++) {
+        particle.pdgCodes[j] = currentMCParticle.pdgCode();
+        particle.indices[j] = currentMCParticle.globalIndex();
+        particle.sources[j] = GetSources(currentMCParticle);
+        particle.nGenerations++;
+        if (!currentMCParticle.has_mothers()) {
+          break;
+        }
+        if (j == kMaxGenerations - 1) {
+          particle.truncated = true;
+          break;
+        }
+        currentMCParticle = currentMCParticle.template mothers_first_as<U>();
+      }
+    }
+  }
+
+  // Return a pointer to the history of a particle, or nullptr if the particle is not in the filled stack
+  const Particle* Get(int64_t globalIndex) const
+  {
+    int64_t idx = globalIndex - fOffset;
+    if (idx < 0 || idx >= static_cast<int64_t>(fParticles.size()) || fParticles[idx].nGenerations == 0) {
+      return nullptr;
+    }
+    return &fParticles[idx];
+  }
+
+  template <typename T>
+  static uint8_t GetSources(const T& mcParticle)
+  {
+    uint8_t sources = 0;
+    if (mcParticle.isPhysicalPrimary()) {
+      sources |= (uint8_t(1) << MCProng::kPhysicalPrimary);
+    }
+    if (mcParticle.producedByGenerator()) {
+      sources |= (uint8_t(1) << MCProng::kProducedByGenerator);
+    } else {
+      sources |= (uint8_t(1) << MCProng::kProducedInTransport);
+    }
+    if (mcParticle.fromBackgroundEvent()) {
+      sources |= (uint8_t(1) << MCProng::kFromBackgroundEvent);
+    }
+    return sources;
+  }
+
+ private:
+  std::vector<Particle> fParticles; // histories, indexed by the stack index minus fOffset
+  int64_t fOffset = 0;              // stack index of the first particle
+};
+
+#endif
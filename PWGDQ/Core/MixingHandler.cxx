@@ -63,6 +63,7 @@ void MixingHandler::AddMixingVariable(int var, int nBins, float* binLims)
   varBins.Set(nBins, binLims);
   fVariableLimits.push_back(varBins);
   VarManager::SetUseVariable(var);
+  Init(); // rebuild the binning with the new variable
 }
 
 //_________________________________________________________________________
@@ -111,11 +112,10 @@ void MixingHandler::Init()
   // Initialization of pools
   //       The correct event category will be retrieved using the function FindEventCategory()
   //
-  int size = 1;
-  for (auto v : fVariableLimits) {
-    size *= (v.GetSize() - 1);
+  fBinning.clear();
+  for (auto const& v : fVariableLimits) {
+    fBinning.addAxis(std::vector<float>(v.GetArray(), v.GetArray() + v.GetSize()));
   }
-  (void)size;
   fIsInitialized = kTRUE;
 }
 
@@ -128,37 +128,12 @@ int MixingHandler::FindEventCategory(float* values)
   if (fVariables.size() == 0) {
     return -1;
   }
-  if (!fIsInitialized) {
+  if (!fIsInitialized || fBinning.getNAxes() != static_cast<int>(fVariables.size())) { // the binning is not streamed
     Init();
   }
 
-  std::vector<int> bin;
-  int iVar = 0;
-  for (auto v = fVariableLimits.begin(); v != fVariableLimits.end(); v++, iVar++) {
-    int binValue = TMath::BinarySearch((*v).GetSize(), (*v).GetArray(), values[fVariables[iVar]]);
-    bin.push_back(binValue);
-    if (bin[iVar] == -1 || bin[iVar] == (*v).GetSize() - 1) {
-      return -1; // all variables must be inside limits
-    }
-  }
-
-  int category = 0;
-  int tempCategory = 1;
-  int iv1 = 0;
-  int iv2 = 0;
-  for (auto v1 = fVariables.begin(); v1 != fVariables.end(); v1++, iv1++) {
-    tempCategory = 1;
-    iv2 = iv1;
-    for (auto v2 = v1; v2 != fVariables.end(); v2++, iv2++) {
-      if (iv2 == iv1) {
-        tempCategory *= bin[iv2];
-      } else {
-        tempCategory *= (fVariableLimits[iv2].GetSize() - 1);
-      }
-    }
-    category += tempCategory;
-  }
-  return category;
+  // the binning is packed in the same way as the categories were enumerated so far: the first variable varies the slowest
+  return fBinning.getHash(values, fVariables.data());
 }
 
 //_________________________________________________________________________
@@ -178,13 +153,10 @@ int MixingHandler::GetBinFromCategory(VarManager::Variables var, int category) c
       break;
     }
   }
+  if (tempVar == static_cast<int>(fVariables.size())) {
+    return -1;
+  }
 
   // extract the bin position in variable "var" from the category
-  int norm = 1;
-  for (int i = fVariables.size() - 1; i > tempVar; --i) {
-    norm *= (fVariableLimits[i].GetSize() - 1);
-  }
-  int truncatedCategory = category - (category % norm);
-  truncatedCategory /= norm;
-  return truncatedCategory % (fVariableLimits[tempVar].GetSize() - 1);
+  return fBinning.getBin(tempVar, category);
 }
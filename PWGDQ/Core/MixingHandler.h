@@ -24,6 +24,7 @@
 #include <TList.h>
 #include <TString.h>
 
+#include "Common/Core/EventMixing.h"
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/VarManager.h"
 
@@ -57,6 +58,7 @@ class MixingHandler : public TNamed
 
   std::vector<TArrayF> fVariableLimits;
   std::vector<int> fVariables;
+  eventmixing::MixingBinning fBinning; //! binning of the mixing variables, built in Init()
 
   ClassDef(MixingHandler, 1);
 };
@@ -0,0 +1,121 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Pool of events used for the event mixing
+// For each event category (as given by the MixingHandler), the last N events are kept in a ring buffer
+//   holding compact copies of their selected lepton candidates. The pool lives in the analysis task,
+//   so the mixing is not restricted to the events of one dataframe.
+//
+
+#ifndef MixingPool_H
+#define MixingPool_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//_________________________________________________________________________
+// Compact copy of a lepton candidate, with the accessors needed by VarManager::FillPairME() and FillPairVn()
+struct MixingTrack {
+  float fPt;
+  float fEta;
+  float fPhi;
+  int fSign;
+  uint32_t fFilter; // bit map of the passed candidate cuts
+
+  float pt() const { return fPt; }
+  float eta() const { return fEta; }
+  float phi() const { return fPhi; }
+  int sign() const { return fSign; }
+};
+
+//_________________________________________________________________________
+class MixingPool
+{
+ public:
+  struct Event {
+    std::vector<MixingTrack> fTracks; // barrel track candidates
+    std::vector<MixingTrack> fMuons;  // muon candidates
+
+    void Clear()
+    {
+      fTracks.clear();
+      fMuons.clear();
+    }
+    bool IsEmpty() const { return fTracks.empty() && fMuons.empty(); }
+  };
+
+  MixingPool() = default;
+  ~MixingPool() = default;
+
+  void SetDepth(int depth) { fDepth = (depth > 0 ? depth : 1); }
+  int GetDepth() const { return fDepth; }
+
+  // Compact copy of the selected candidates of a table, the selection bit map being provided by the filter functor
+  template <typename TTracks, typename TFilter>
+  static void Fill(TTracks const& tracks, std::vector<MixingTrack>& out, TFilter filter)
+  {
+    out.clear();
+    out.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      out.push_back({track.pt(), track.eta(), track.phi(), track.sign(), filter(track)});
+    }
+  }
+
+  // Loop over the events stored for a category
+  template <typename TFunction>
+  void ForEach(int category, TFunction function) const
+  {
+    auto bin = fBins.find(category);
+    if (bin == fBins.end()) {
+      return;
+    }
+    for (auto const& event : bin->second.fEvents) {
+      function(event);
+    }
+  }
+
+  // Store an event in its category, replacing the oldest one if the category is full
+  // NOTE: the content of the event is swapped with the replaced one, so that the allocated memory is reused
+  void Add(int category, Event& event)
+  {
+    Bin& bin = fBins[category];
+    if (static_cast<int>(bin.fEvents.size()) < fDepth) {
+      bin.fEvents.emplace_back();
+      std::swap(bin.fEvents.back(), event);
+    } else {
+      std::swap(bin.fEvents[bin.fNext], event);
+      bin.fNext = (bin.fNext + 1) % fDepth;
+    }
+    event.Clear();
+  }
+
+  int GetNEvents(int category) const
+  {
+    auto bin = fBins.find(category);
+    return (bin == fBins.end() ? 0 : bin->second.fEvents.size());
+  }
+  void Clear() { fBins.clear(); }
+
+ private:
+  struct Bin {
+    std::vector<Event> fEvents; // stored events, at most fDepth
+    int fNext = 0;              // position of the oldest event once the buffer is full
+  };
+
+  int fDepth = 100;                   // number of events stored per category
+  std::unordered_map<int, Bin> fBins; // stored events per category
+};
+
+#endif
@@ -15,6 +15,7 @@
 
 #pragma link C++ class VarManager + ;
 #pragma link C++ class HistogramManager + ;
+#pragma link C++ class CompactTHn + ;
 #pragma link C++ class MixingHandler + ;
 #pragma link C++ class AnalysisCut + ;
 #pragma link C++ class AnalysisCompositeCut + ;
@@ -12,6 +12,7 @@
 #include "PWGDQ/Core/VarManager.h"
 
 #include <cmath>
+#include <algorithm>
 
 ClassImp(VarManager);
 
@@ -21,10 +22,54 @@ bool VarManager::fgUsedVars[VarManager::kNVars] = {kFALSE};
 float VarManager::fgValues[VarManager::kNVars] = {0.0f};
 std::map<int, int> VarManager::fgRunMap;
 TString VarManager::fgRunStr = "";
-o2::vertexing::DCAFitterN<2> VarManager::fgFitterTwoProngBarrel;
-o2::vertexing::DCAFitterN<3> VarManager::fgFitterThreeProngBarrel;
-o2::vertexing::FwdDCAFitterN<2> VarManager::fgFitterTwoProngFwd;
-o2::vertexing::FwdDCAFitterN<3> VarManager::fgFitterThreeProngFwd;
+VarManager::Context VarManager::fgDefaultContext(VarManager::fgValues, VarManager::fgUsedVars);
+thread_local VarManager::Context* VarManager::fgContext = &VarManager::fgDefaultContext;
+
+//__________________________________________________________________
+VarManager::Context::Context(float* values, bool* usedVars) : fValues(values),
+                                                              fUsedVars(usedVars),
+                                                              fFillPairVertexing(false),
+                                                              fFitterTwoProngBarrel(),
+                                                              fPrecheckTwoProngBarrel(),
+                                                              fFitterThreeProngBarrel(),
+                                                              fFitterTwoProngFwd(),
+                                                              fFitterThreeProngFwd(),
+                                                              fValuesStorage(),
+                                                              fUsedVarsStorage()
+{
+  //
+  // default context, working on the static arrays
+  //
+}
+
+//__________________________________________________________________
+VarManager::Context::Context() : Context(fgDefaultContext)
+{
+  //
+  // new context, configured as the default one
+  //
+}
+
+//__________________________________________________________________
+VarManager::Context::Context(const Context& c) : fValues(nullptr),
+                                                 fUsedVars(nullptr),
+                                                 fFillPairVertexing(c.fFillPairVertexing),
+                                                 fFitterTwoProngBarrel(c.fFitterTwoProngBarrel),
+                                                 fPrecheckTwoProngBarrel(c.fPrecheckTwoProngBarrel),
+                                                 fFitterThreeProngBarrel(c.fFitterThreeProngBarrel),
+                                                 fFitterTwoProngFwd(c.fFitterTwoProngFwd),
+                                                 fFitterThreeProngFwd(c.fFitterThreeProngFwd),
+                                                 fValuesStorage(new float[kNVars]),
+                                                 fUsedVarsStorage(new bool[kNVars])
+{
+  //
+  // copy the used variables and the fitter settings of another context, with its own values array
+  //
+  fValues = fValuesStorage.get();
+  fUsedVars = fUsedVarsStorage.get();
+  std::copy(c.fValues, c.fValues + kNVars, fValues);
+  std::copy(c.fUsedVars, c.fUsedVars + kNVars, fUsedVars);
+}
 
 //__________________________________________________________________
 VarManager::VarManager() : TObject()
@@ -44,9 +89,15 @@ void VarManager::SetVariableDependencies()
   //
   // Set as used variables on which other variables calculation depends
   //
-  if (fgUsedVars[kP]) {
-    fgUsedVars[kPt] = kTRUE;
-    fgUsedVars[kEta] = kTRUE;
+  if (fgContext->fUsedVars[kP]) {
+    fgContext->fUsedVars[kPt] = kTRUE;
+    fgContext->fUsedVars[kEta] = kTRUE;
+  }
+
+  // flags of the expensive fill blocks, evaluated here once instead of in every Fill call
+  fgContext->fFillPairVertexing = false;
+  for (int var = kVertexingLxy; var <= kVertexingChi2PCA; ++var) {
+    fgContext->fFillPairVertexing |= fgContext->fUsedVars[var];
   }
 }
 
@@ -57,7 +108,7 @@ void VarManager::ResetValues(int startValue, int endValue, float* values)
   // reset all variables to an "innocent" value
   // NOTE: here we use -9999.0 as a neutral value, but depending on situation, this may not be the case
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
   for (Int_t i = startValue; i < endValue; ++i) {
     values[i] = -9999.;
@@ -95,7 +146,7 @@ void VarManager::FillEventDerived(float* values)
   //
   // Fill event-wise derived quantities (these are all quantities which can be computed just based on the values already filled in the FillEvent() function)
   //
-  if (fgUsedVars[kRunId]) {
+  if (fgContext->fUsedVars[kRunId]) {
     values[kRunId] = (fgRunMap.size() > 0 ? fgRunMap[static_cast<int>(values[kRunNo])] : 0);
   }
 }
@@ -106,7 +157,7 @@ void VarManager::FillTrackDerived(float* values)
   //
   // Fill track-wise derived quantities (these are all quantities which can be computed just based on the values already filled in the FillTrack() function)
   //
-  if (fgUsedVars[kP]) {
+  if (fgContext->fUsedVars[kP]) {
     values[kP] = values[kPt] * std::cosh(values[kEta]);
   }
 }
@@ -22,6 +22,7 @@
 #include <cmath>
 #include <iostream>
 #include <utility>
+#include <memory>
 
 #include <TObject.h>
 #include <TString.h>
@@ -35,6 +36,7 @@
 #include "ReconstructionDataFormats/Vertex.h"
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/Core/TwoProngPrecheck.h"
 #include "ReconstructionDataFormats/DCA.h"
 
 #include "Math/SMatrix.h"
@@ -90,7 +92,8 @@ class VarManager : public TObject
     Pair = BIT(17), // TODO: check whether we really need the Pair member here
     AmbiTrack = BIT(18),
     AmbiMuon = BIT(19),
-    DalitzBits = BIT(20)
+    DalitzBits = BIT(20),
+    PairKinematicsOnly = BIT(21) // FillPair computes only the pair kinematics (mass, pt, eta, phi, rapidity)
   };
 
   enum PairCandidateType {
@@ -339,7 +342,7 @@ class VarManager : public TObject
   static void SetUseVariable(int var)
   {
     if (var >= 0 && var < kNVars) {
-      fgUsedVars[var] = kTRUE;
+      fgContext->fUsedVars[var] = kTRUE;
     }
     SetVariableDependencies();
   }
@@ -347,7 +350,7 @@ class VarManager : public TObject
   {
     for (int i = 0; i < kNVars; ++i) {
       if (usedVars[i]) {
-        fgUsedVars[i] = true; // overwrite only the variables that are being used since there are more channels to modify the used variables array, independently
+        fgContext->fUsedVars[i] = true; // overwrite only the variables that are being used since there are more channels to modify the used variables array, independently
       }
     }
     SetVariableDependencies();
@@ -355,13 +358,14 @@ class VarManager : public TObject
   static void SetUseVars(const std::vector<int> usedVars)
   {
     for (auto& var : usedVars) {
-      fgUsedVars[var] = true;
+      fgContext->fUsedVars[var] = true;
     }
+    SetVariableDependencies();
   }
   static bool GetUsedVar(int var)
   {
     if (var >= 0 && var < kNVars) {
-      return fgUsedVars[var];
+      return fgContext->fUsedVars[var];
     }
     return false;
   }
@@ -380,24 +384,26 @@ class VarManager : public TObject
   // Setup the 2 prong DCAFitterN
   static void SetupTwoProngDCAFitter(float magField, bool propagateToPCA, float maxR, float maxDZIni, float minParamChange, float minRelChi2Change, bool useAbsDCA)
   {
-    fgFitterTwoProngBarrel.setBz(magField);
-    fgFitterTwoProngBarrel.setPropagateToPCA(propagateToPCA);
-    fgFitterTwoProngBarrel.setMaxR(maxR);
-    fgFitterTwoProngBarrel.setMaxDZIni(maxDZIni);
-    fgFitterTwoProngBarrel.setMinParamChange(minParamChange);
-    fgFitterTwoProngBarrel.setMinRelChi2Change(minRelChi2Change);
-    fgFitterTwoProngBarrel.setUseAbsDCA(useAbsDCA);
+    fgContext->fFitterTwoProngBarrel.setBz(magField);
+    fgContext->fFitterTwoProngBarrel.setPropagateToPCA(propagateToPCA);
+    fgContext->fFitterTwoProngBarrel.setMaxR(maxR);
+    fgContext->fFitterTwoProngBarrel.setMaxDZIni(maxDZIni);
+    fgContext->fFitterTwoProngBarrel.setMinParamChange(minParamChange);
+    fgContext->fFitterTwoProngBarrel.setMinRelChi2Change(minRelChi2Change);
+    fgContext->fFitterTwoProngBarrel.setUseAbsDCA(useAbsDCA);
+    fgContext->fPrecheckTwoProngBarrel.setBz(magField);
+    fgContext->fPrecheckTwoProngBarrel.setMaxDZ(maxDZIni);
   }
 
   // Setup the 2 prong FwdDCAFitterN
   static void SetupTwoProngFwdDCAFitter(float magField, bool propagateToPCA, float maxR, float minParamChange, float minRelChi2Change, bool useAbsDCA)
   {
-    fgFitterTwoProngFwd.setBz(magField);
-    fgFitterTwoProngFwd.setPropagateToPCA(propagateToPCA);
-    fgFitterTwoProngFwd.setMaxR(maxR);
-    fgFitterTwoProngFwd.setMinParamChange(minParamChange);
-    fgFitterTwoProngFwd.setMinRelChi2Change(minRelChi2Change);
-    fgFitterTwoProngFwd.setUseAbsDCA(useAbsDCA);
+    fgContext->fFitterTwoProngFwd.setBz(magField);
+    fgContext->fFitterTwoProngFwd.setPropagateToPCA(propagateToPCA);
+    fgContext->fFitterTwoProngFwd.setMaxR(maxR);
+    fgContext->fFitterTwoProngFwd.setMinParamChange(minParamChange);
+    fgContext->fFitterTwoProngFwd.setMinRelChi2Change(minRelChi2Change);
+    fgContext->fFitterTwoProngFwd.setUseAbsDCA(useAbsDCA);
   }
   static auto getEventPlane(int harm, float qnxa, float qnya)
   {
@@ -413,12 +419,18 @@ class VarManager : public TObject
   static void FillPair(T1 const& t1, T2 const& t2, float* values = nullptr);
   template <int pairType, typename T1, typename T2>
   static void FillPairME(T1 const& t1, T2 const& t2, float* values = nullptr);
+  template <int pairType, typename T1, typename T2>
+  static void FillPairKinematics(T1 const& t1, T2 const& t2, float* values);
   template <typename T1, typename T2>
   static void FillPairMC(T1 const& t1, T2 const& t2, float* values = nullptr, PairCandidateType pairType = kDecayToEE);
   template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
   static void FillPairVertexing(C const& collision, T const& t1, T const& t2, float* values = nullptr);
+  template <int candidateType, typename T1>
+  static void FillDileptonTrackKinematics(T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values = nullptr);
+  template <int candidateType, uint32_t fillMap, typename T1>
+  static int FitDileptonLegs(T1 const& lepton1, T1 const& lepton2);
   template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
-  static void FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values);
+  static void FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values, int procCodeDilepton = -1);
   template <typename T1, typename T2>
   static void FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float* values = nullptr, float hadronMass = 0.0f);
   template <typename C, typename A>
@@ -433,6 +445,50 @@ class VarManager : public TObject
   static float fgValues[kNVars]; // array holding all variables computed during analysis
   static void ResetValues(int startValue = 0, int endValue = kNVars, float* values = nullptr);
 
+  // State of the variable manager: values array, used variables and vertexing fitters
+  // The static functions work on the current context of the calling thread, which is the default one
+  //   (fgValues, fgUsedVars) unless a ScopedContext is active. Tasks processing collisions in parallel
+  //   hold one Context per worker thread and activate it with a ScopedContext in the worker.
+  class Context
+  {
+   public:
+    // copies the used variables and the fitter settings of the default context, so create it after the task configuration
+    Context();
+    Context(const Context& c);
+    Context& operator=(const Context& c) = delete;
+
+    float* GetValues() { return fValues; }
+
+    float* fValues;          // values computed during analysis
+    bool* fUsedVars;         // flags of the variables needed in analysis
+    bool fFillPairVertexing; // at least one of the pair vertexing variables is used, updated with the used variables
+    o2::vertexing::DCAFitterN<2> fFitterTwoProngBarrel;
+    o2::analysis::TwoProngPrecheck fPrecheckTwoProngBarrel; // same DXY and DZ requirements as the fitter, before the fit
+    o2::vertexing::DCAFitterN<3> fFitterThreeProngBarrel;
+    o2::vertexing::FwdDCAFitterN<2> fFitterTwoProngFwd;
+    o2::vertexing::FwdDCAFitterN<3> fFitterThreeProngFwd;
+
+   private:
+    friend class VarManager;
+    Context(float* values, bool* usedVars); // default context, using external arrays
+    std::unique_ptr<float[]> fValuesStorage;  // owned values, if not the default context
+    std::unique_ptr<bool[]> fUsedVarsStorage; // owned used variables, if not the default context
+  };
+
+  // Make a context the current one of the calling thread for the lifetime of this object
+  class ScopedContext
+  {
+   public:
+    explicit ScopedContext(Context& context) : fPrevious(fgContext) { fgContext = &context; }
+    ~ScopedContext() { fgContext = fPrevious; }
+    ScopedContext(const ScopedContext&) = delete;
+    ScopedContext& operator=(const ScopedContext&) = delete;
+
+   private:
+    Context* fPrevious;
+  };
+  static Context& GetContext() { return *fgContext; }
+
  private:
   static bool fgUsedVars[kNVars];        // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
   static void SetVariableDependencies(); // toggle those variables on which other used variables might depend
@@ -446,11 +502,13 @@ class VarManager : public TObject
   static TString GetRunPeriod(float runNumber);
   template <typename T, typename U, typename V>
   static auto getRotatedCovMatrixXX(const T& matrix, U phi, V theta);
+  template <typename T>
+  static o2::track::TrackParCov getTrackParCovBarrel(T const& track);
+  template <typename T>
+  static o2::track::TrackParCovFwd getTrackParCovFwd(T const& track);
 
-  static o2::vertexing::DCAFitterN<2> fgFitterTwoProngBarrel;
-  static o2::vertexing::DCAFitterN<3> fgFitterThreeProngBarrel;
-  static o2::vertexing::FwdDCAFitterN<2> fgFitterTwoProngFwd;
-  static o2::vertexing::FwdDCAFitterN<3> fgFitterThreeProngFwd;
+  static Context fgDefaultContext;        // context of the static API, using fgValues and fgUsedVars
+  static thread_local Context* fgContext; // current context of the calling thread
 
   VarManager& operator=(const VarManager& c);
   VarManager(const VarManager& c);
@@ -473,11 +531,33 @@ auto VarManager::getRotatedCovMatrixXX(const T& matrix, U phi, V theta)
          + matrix[5] * st * st;               // covZZ
 }
 
+template <typename T>
+o2::track::TrackParCov VarManager::getTrackParCovBarrel(T const& track)
+{
+  std::array<float, 5> pars = {track.y(), track.z(), track.snp(), track.tgl(), track.signed1Pt()};
+  std::array<float, 15> covs = {track.cYY(), track.cZY(), track.cZZ(), track.cSnpY(), track.cSnpZ(),
+                                track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
+                                track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
+  return o2::track::TrackParCov{track.x(), track.alpha(), pars, covs};
+}
+
+template <typename T>
+o2::track::TrackParCovFwd VarManager::getTrackParCovFwd(T const& track)
+{
+  SMatrix5 pars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
+  std::vector<double> v{track.cXX(), track.cXY(), track.cYY(), track.cPhiX(), track.cPhiY(),
+                        track.cPhiPhi(), track.cTglX(), track.cTglY(), track.cTglPhi(), track.cTglTgl(),
+                        track.c1PtX(), track.c1PtY(), track.c1PtPhi(), track.c1PtTgl(), track.c1Pt21Pt2()};
+  SMatrix55 covs(v.begin(), v.end());
+  double chi2 = track.chi2();
+  return o2::track::TrackParCovFwd{track.z(), pars, covs, chi2};
+}
+
 template <uint32_t fillMap, typename T>
 void VarManager::FillEvent(T const& event, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   if constexpr ((fillMap & BC) > 0) {
@@ -492,37 +572,37 @@ void VarManager::FillEvent(T const& event, float* values)
   if constexpr ((fillMap & Collision) > 0) {
     // TODO: trigger info from the event selection requires a separate flag
     //       so that it can be switched off independently of the rest of Collision variables (e.g. if event selection is not available)
-    if (fgUsedVars[kIsINT7]) {
+    if (fgContext->fUsedVars[kIsINT7]) {
       values[kIsINT7] = (event.alias()[kINT7] > 0);
     }
-    if (fgUsedVars[kIsEMC7]) {
+    if (fgContext->fUsedVars[kIsEMC7]) {
       values[kIsEMC7] = (event.alias()[kEMC7] > 0);
     }
-    if (fgUsedVars[kIsINT7inMUON]) {
+    if (fgContext->fUsedVars[kIsINT7inMUON]) {
       values[kIsINT7inMUON] = (event.alias()[kINT7inMUON] > 0);
     }
-    if (fgUsedVars[kIsMuonSingleLowPt7]) {
+    if (fgContext->fUsedVars[kIsMuonSingleLowPt7]) {
       values[kIsMuonSingleLowPt7] = (event.alias()[kMuonSingleLowPt7] > 0);
     }
-    if (fgUsedVars[kIsMuonSingleHighPt7]) {
+    if (fgContext->fUsedVars[kIsMuonSingleHighPt7]) {
       values[kIsMuonSingleHighPt7] = (event.alias()[kMuonSingleHighPt7] > 0);
     }
-    if (fgUsedVars[kIsMuonUnlikeLowPt7]) {
+    if (fgContext->fUsedVars[kIsMuonUnlikeLowPt7]) {
       values[kIsMuonUnlikeLowPt7] = (event.alias()[kMuonUnlikeLowPt7] > 0);
     }
-    if (fgUsedVars[kIsMuonLikeLowPt7]) {
+    if (fgContext->fUsedVars[kIsMuonLikeLowPt7]) {
       values[kIsMuonLikeLowPt7] = (event.alias()[kMuonLikeLowPt7] > 0);
     }
-    if (fgUsedVars[kIsCUP8]) {
+    if (fgContext->fUsedVars[kIsCUP8]) {
       values[kIsCUP8] = (event.alias()[kCUP8] > 0);
     }
-    if (fgUsedVars[kIsCUP9]) {
+    if (fgContext->fUsedVars[kIsCUP9]) {
       values[kIsCUP9] = (event.alias()[kCUP9] > 0);
     }
-    if (fgUsedVars[kIsMUP10]) {
+    if (fgContext->fUsedVars[kIsMUP10]) {
       values[kIsMUP10] = (event.alias()[kMUP10] > 0);
     }
-    if (fgUsedVars[kIsMUP11]) {
+    if (fgContext->fUsedVars[kIsMUP11]) {
       values[kIsMUP11] = (event.alias()[kMUP11] > 0);
     }
     values[kVtxX] = event.posX();
@@ -556,37 +636,37 @@ void VarManager::FillEvent(T const& event, float* values)
     values[kBC] = event.globalBC();
     values[kTimestamp] = event.timestamp();
     values[kCentVZERO] = event.centRun2V0M();
-    if (fgUsedVars[kIsINT7]) {
+    if (fgContext->fUsedVars[kIsINT7]) {
       values[kIsINT7] = (event.triggerAlias() & (uint32_t(1) << kINT7)) > 0;
     }
-    if (fgUsedVars[kIsEMC7]) {
+    if (fgContext->fUsedVars[kIsEMC7]) {
       values[kIsEMC7] = (event.triggerAlias() & (uint32_t(1) << kEMC7)) > 0;
     }
-    if (fgUsedVars[kIsINT7inMUON]) {
+    if (fgContext->fUsedVars[kIsINT7inMUON]) {
       values[kIsINT7inMUON] = (event.triggerAlias() & (uint32_t(1) << kINT7inMUON)) > 0;
     }
-    if (fgUsedVars[kIsMuonSingleLowPt7]) {
+    if (fgContext->fUsedVars[kIsMuonSingleLowPt7]) {
       values[kIsMuonSingleLowPt7] = (event.triggerAlias() & (uint32_t(1) << kMuonSingleLowPt7)) > 0;
     }
-    if (fgUsedVars[kIsMuonSingleHighPt7]) {
+    if (fgContext->fUsedVars[kIsMuonSingleHighPt7]) {
       values[kIsMuonSingleHighPt7] = (event.triggerAlias() & (uint32_t(1) << kMuonSingleHighPt7)) > 0;
     }
-    if (fgUsedVars[kIsMuonUnlikeLowPt7]) {
+    if (fgContext->fUsedVars[kIsMuonUnlikeLowPt7]) {
       values[kIsMuonUnlikeLowPt7] = (event.triggerAlias() & (uint32_t(1) << kMuonUnlikeLowPt7)) > 0;
     }
-    if (fgUsedVars[kIsMuonLikeLowPt7]) {
+    if (fgContext->fUsedVars[kIsMuonLikeLowPt7]) {
       values[kIsMuonLikeLowPt7] = (event.triggerAlias() & (uint32_t(1) << kMuonLikeLowPt7)) > 0;
     }
-    if (fgUsedVars[kIsCUP8]) {
+    if (fgContext->fUsedVars[kIsCUP8]) {
       values[kIsCUP8] = (event.triggerAlias() & (uint32_t(1) << kCUP8)) > 0;
     }
-    if (fgUsedVars[kIsCUP9]) {
+    if (fgContext->fUsedVars[kIsCUP9]) {
       values[kIsCUP9] = (event.triggerAlias() & (uint32_t(1) << kCUP9)) > 0;
     }
-    if (fgUsedVars[kIsMUP10]) {
+    if (fgContext->fUsedVars[kIsMUP10]) {
       values[kIsMUP10] = (event.triggerAlias() & (uint32_t(1) << kMUP10)) > 0;
     }
-    if (fgUsedVars[kIsMUP11]) {
+    if (fgContext->fUsedVars[kIsMUP11]) {
       values[kIsMUP11] = (event.triggerAlias() & (uint32_t(1) << kMUP11)) > 0;
     }
   }
@@ -654,19 +734,19 @@ template <uint32_t fillMap, typename T>
 void VarManager::FillTrack(T const& track, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   // Quantities based on the basic table (contains just kine information and filter bits)
   if constexpr ((fillMap & Track) > 0 || (fillMap & Muon) > 0 || (fillMap & ReducedTrack) > 0 || (fillMap & ReducedMuon) > 0) {
     values[kPt] = track.pt();
-    if (fgUsedVars[kPx]) {
+    if (fgContext->fUsedVars[kPx]) {
       values[kPx] = track.px();
     }
-    if (fgUsedVars[kPy]) {
+    if (fgContext->fUsedVars[kPy]) {
       values[kPy] = track.py();
     }
-    if (fgUsedVars[kPz]) {
+    if (fgContext->fUsedVars[kPz]) {
       values[kPz] = track.pz();
     }
     values[kEta] = track.eta();
@@ -694,34 +774,34 @@ void VarManager::FillTrack(T const& track, float* values)
   // Quantities based on the barrel tables
   if constexpr ((fillMap & TrackExtra) > 0 || (fillMap & ReducedTrackBarrel) > 0) {
     values[kPin] = track.tpcInnerParam();
-    if (fgUsedVars[kIsITSrefit]) {
+    if (fgContext->fUsedVars[kIsITSrefit]) {
       values[kIsITSrefit] = (track.flags() & o2::aod::track::ITSrefit) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kTrackTimeResIsRange]) {
+    if (fgContext->fUsedVars[kTrackTimeResIsRange]) {
       values[kTrackTimeResIsRange] = (track.flags() & o2::aod::track::TrackTimeResIsRange) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsTPCrefit]) {
+    if (fgContext->fUsedVars[kIsTPCrefit]) {
       values[kIsTPCrefit] = (track.flags() & o2::aod::track::TPCrefit) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kPVContributor]) {
+    if (fgContext->fUsedVars[kPVContributor]) {
       values[kPVContributor] = (track.flags() & o2::aod::track::PVContributor) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsGoldenChi2]) {
+    if (fgContext->fUsedVars[kIsGoldenChi2]) {
       values[kIsGoldenChi2] = (track.flags() & o2::aod::track::GoldenChi2) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kOrphanTrack]) {
+    if (fgContext->fUsedVars[kOrphanTrack]) {
       values[kOrphanTrack] = (track.flags() & o2::aod::track::OrphanTrack) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsSPDfirst]) {
+    if (fgContext->fUsedVars[kIsSPDfirst]) {
       values[kIsSPDfirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
     }
-    if (fgUsedVars[kIsSPDboth]) {
+    if (fgContext->fUsedVars[kIsSPDboth]) {
       values[kIsSPDboth] = (track.itsClusterMap() & uint8_t(3)) > 0;
     }
-    if (fgUsedVars[kIsSPDany]) {
+    if (fgContext->fUsedVars[kIsSPDany]) {
       values[kIsSPDany] = (track.itsClusterMap() & uint8_t(1)) || (track.itsClusterMap() & uint8_t(2));
     }
-    if (fgUsedVars[kITSClusterMap]) {
+    if (fgContext->fUsedVars[kITSClusterMap]) {
       values[kITSClusterMap] = track.itsClusterMap();
     }
     values[kITSchi2] = track.itsChi2NCl();
@@ -732,12 +812,12 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTRDPattern] = track.trdPattern();
 
     if constexpr ((fillMap & TrackExtra) > 0) {
-      if (fgUsedVars[kITSncls]) {
+      if (fgContext->fUsedVars[kITSncls]) {
         values[kITSncls] = track.itsNCls(); // dynamic column
       }
     }
     if constexpr ((fillMap & ReducedTrackBarrel) > 0) {
-      if (fgUsedVars[kITSncls]) {
+      if (fgContext->fUsedVars[kITSncls]) {
         values[kITSncls] = 0.0;
         for (int i = 0; i < 7; ++i) {
           values[kITSncls] += ((track.itsClusterMap() & (1 << i)) ? 1 : 0);
@@ -746,16 +826,16 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTrackDCAxy] = track.dcaXY();
       values[kTrackDCAz] = track.dcaZ();
       if constexpr ((fillMap & ReducedTrackBarrelCov) > 0) {
-        if (fgUsedVars[kTrackDCAsigXY]) {
+        if (fgContext->fUsedVars[kTrackDCAsigXY]) {
           values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAsigZ]) {
+        if (fgContext->fUsedVars[kTrackDCAsigZ]) {
           values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
         }
-        if (fgUsedVars[kTrackDCAresXY]) {
+        if (fgContext->fUsedVars[kTrackDCAresXY]) {
           values[kTrackDCAresXY] = std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAresZ]) {
+        if (fgContext->fUsedVars[kTrackDCAresZ]) {
           values[kTrackDCAresZ] = std::sqrt(track.cZZ());
         }
       }
@@ -767,16 +847,16 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTrackDCAxy] = track.dcaXY();
     values[kTrackDCAz] = track.dcaZ();
     if constexpr ((fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
+      if (fgContext->fUsedVars[kTrackDCAsigXY]) {
         values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAsigZ]) {
+      if (fgContext->fUsedVars[kTrackDCAsigZ]) {
         values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
       }
-      if (fgUsedVars[kTrackDCAresXY]) {
+      if (fgContext->fUsedVars[kTrackDCAresXY]) {
         values[kTrackDCAresXY] = std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAresZ]) {
+      if (fgContext->fUsedVars[kTrackDCAresZ]) {
         values[kTrackDCAresZ] = std::sqrt(track.cZZ());
       }
     }
@@ -819,7 +899,7 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTPCsignal] = track.tpcSignal();
     values[kTRDsignal] = track.trdSignal();
     values[kTOFbeta] = track.beta();
-    if (fgUsedVars[kTPCsignalRandomized] || fgUsedVars[kTPCnSigmaElRandomized] || fgUsedVars[kTPCnSigmaPiRandomized] || fgUsedVars[kTPCnSigmaPrRandomized]) {
+    if (fgContext->fUsedVars[kTPCsignalRandomized] || fgContext->fUsedVars[kTPCnSigmaElRandomized] || fgContext->fUsedVars[kTPCnSigmaPiRandomized] || fgContext->fUsedVars[kTPCnSigmaPrRandomized]) {
       // NOTE: this is needed temporarily for the study of the impact of TPC pid degradation on the quarkonium triggers in high lumi pp
       //     This study involves a degradation from a dE/dx resolution of 5% to one of 6% (20% worsening)
       //     For this we smear the dE/dx and n-sigmas using a gaus distribution with a width of 3.3%
@@ -834,7 +914,7 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTPCnSigmaPrRandomized] = values[kTPCnSigmaPr] * (1.0 + randomX);
       values[kTPCnSigmaPrRandomizedDelta] = values[kTPCnSigmaPr] * randomX;
     }
-    if (fgUsedVars[kTPCnSigmaEl_Corr] || fgUsedVars[kTPCnSigmaPi_Corr] || fgUsedVars[kTPCnSigmaPr_Corr]) {
+    if (fgContext->fUsedVars[kTPCnSigmaEl_Corr] || fgContext->fUsedVars[kTPCnSigmaPi_Corr] || fgContext->fUsedVars[kTPCnSigmaPr_Corr]) {
       values[kTPCnSigmaEl_Corr] = values[kTPCnSigmaEl] - GetTPCPostCalibMap(values[kPin], values[kEta], 0, GetRunPeriod(values[kRunNo]));
       values[kTPCnSigmaPi_Corr] = values[kTPCnSigmaPi] - GetTPCPostCalibMap(values[kPin], values[kEta], 1, GetRunPeriod(values[kRunNo]));
       values[kTPCnSigmaPr_Corr] = values[kTPCnSigmaPr] - GetTPCPostCalibMap(values[kPin], values[kEta], 2, GetRunPeriod(values[kRunNo]));
@@ -894,7 +974,12 @@ template <int pairType, uint32_t fillMap, typename T1, typename T2>
 void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
+  }
+
+  if constexpr ((fillMap & PairKinematicsOnly) > 0) {
+    FillPairKinematics<pairType>(t1, t2, values);
+    return;
   }
 
   float m1 = fgkElectronMass;
@@ -917,7 +1002,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   values[kPhi] = v12.Phi();
   values[kRap] = -v12.Rapidity();
 
-  if (fgUsedVars[kPsiPair]) {
+  if (fgContext->fUsedVars[kPsiPair]) {
     values[kDeltaPhiPair] = v1.Phi() - v2.Phi();
     double xipair = TMath::ACos((v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz()) / v1.P() / v2.P());
     values[kPsiPair] = TMath::ASin((v1.Theta() - v2.Theta()) / xipair);
@@ -929,13 +1014,13 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
   ROOT::Math::XYZVectorF zaxis{(v12.Vect()).Unit()};
 
-  if (fgUsedVars[kCosThetaHE]) {
+  if (fgContext->fUsedVars[kCosThetaHE]) {
     values[kCosThetaHE] = (t1.sign() > 0 ? zaxis.Dot(v1_CM) : zaxis.Dot(v2_CM));
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY]) {
+    if (fgContext->fUsedVars[kQuadDCAabsXY] || fgContext->fUsedVars[kQuadDCAsigXY]) {
       // Quantities based on the barrel tables
       double dca1 = t1.dcaXY();
       double dca2 = t2.dcaXY();
@@ -946,14 +1031,14 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       values[kQuadDCAsigXY] = std::sqrt((dca1sig * dca1sig + dca2sig * dca2sig) / 2);
     }
   }
-  if (fgUsedVars[kPairPhiv]) {
+  if (fgContext->fUsedVars[kPairPhiv]) {
     // cos(phiv) = w*a /|w||a|
     // with w = u x v
     // and  a = u x z / |u x z|   , unit vector perpendicular to v12 and z-direction (magnetic field)
     // u = v12 / |v12|            , the unit vector of v12
     // v = v1 x v2 / |v1 x v2|    , unit vector perpendicular to v1 and v2
 
-    float bz = fgFitterTwoProngBarrel.getBz();
+    float bz = fgContext->fFitterTwoProngBarrel.getBz();
 
     // ordering of tracks, so v1 has larger momentum
     if (v1.P() < v2.P()) {
@@ -1019,9 +1104,20 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
   // Lightweight fill function called from the innermost event mixing loop
   //
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
+  FillPairKinematics<pairType>(t1, t2, values);
+}
 
+template <int pairType, typename T1, typename T2>
+void VarManager::FillPairKinematics(T1 const& t1, T2 const& t2, float* values)
+{
+  //
+  // Mass, pt, eta, phi and rapidity of the pair computed in float directly from the legs, without 4-vector objects
+  // The mass is computed as a sum of non-negative terms, so that it is not affected by the cancellation in E^2 - p^2
+  //   m^2 = m1^2 + m2^2 + 2 (E1 E2 - p1.p2), with p1 p2 - p1.p2 = 2 pt1 pt2 (sinh^2(deta / 2) + sin^2(dphi / 2))
+  //   and E = p + d, d = m^2 / (E + p)
+  //
   float m1 = fgkElectronMass;
   float m2 = fgkElectronMass;
   if constexpr (pairType == kDecayToMuMu) {
@@ -1033,21 +1129,47 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
     m2 = fgkMuonMass;
   }
 
-  ROOT::Math::PtEtaPhiMVector v1(t1.pt(), t1.eta(), t1.phi(), m1);
-  ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), m2);
-  ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-  values[kMass] = v12.M();
-  values[kPt] = v12.Pt();
-  values[kEta] = v12.Eta();
-  values[kPhi] = v12.Phi();
-  values[kRap] = -v12.Rapidity();
+  const float pt1 = t1.pt();
+  const float pt2 = t2.pt();
+  const float eta1 = t1.eta();
+  const float eta2 = t2.eta();
+  const float phi1 = t1.phi();
+  const float phi2 = t2.phi();
+
+  const float pz1 = pt1 * std::sinh(eta1);
+  const float pz2 = pt2 * std::sinh(eta2);
+  const float p1 = pt1 * std::cosh(eta1);
+  const float p2 = pt2 * std::cosh(eta2);
+  const float e1 = std::sqrt(p1 * p1 + m1 * m1);
+  const float e2 = std::sqrt(p2 * p2 + m2 * m2);
+  const float d1 = m1 * m1 / (e1 + p1);
+  const float d2 = m2 * m2 / (e2 + p2);
+  const float sinhHalfDEta = std::sinh(0.5f * (eta1 - eta2));
+  const float sinHalfDPhi = std::sin(0.5f * (phi1 - phi2));
+  const float openingTerm = 2.f * pt1 * pt2 * (sinhHalfDEta * sinhHalfDEta + sinHalfDPhi * sinHalfDPhi);
+  const float m2Pair = m1 * m1 + m2 * m2 + 2.f * (openingTerm + p1 * d2 + p2 * d1 + d1 * d2);
+
+  const float px = pt1 * std::cos(phi1) + pt2 * std::cos(phi2);
+  const float py = pt1 * std::sin(phi1) + pt2 * std::sin(phi2);
+  const float pz = pz1 + pz2;
+  const float e = e1 + e2;
+  const float pt = std::sqrt(px * px + py * py);
+  const float mt = std::sqrt(m2Pair + pt * pt);
+
+  values[kMass] = std::sqrt(m2Pair);
+  values[kPt] = pt;
+  values[kEta] = pt > 0.f ? std::asinh(pz / pt) : (pz >= 0.f ? 1.e10f : -1.e10f);
+  values[kPhi] = std::atan2(py, px);
+  // y = log((E + pz) / mt), written with the larger of E + |pz| to avoid the cancellation in E - |pz|
+  const float rap = mt > 0.f ? std::log((e + std::abs(pz)) / mt) : 0.f;
+  values[kRap] = pz >= 0.f ? -rap : rap;
 }
 
 template <typename T1, typename T2>
 void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values, PairCandidateType pairType)
 {
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   float m1 = fgkElectronMass;
@@ -1080,8 +1202,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
   constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
 
+  // skip the secondary vertex fit if none of its variables is needed
+  if (!fgContext->fFillPairVertexing) {
+    return;
+  }
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   int procCode = 0;
@@ -1101,7 +1227,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                     t2.cSnpSnp(), t2.cTglY(), t2.cTglZ(), t2.cTglSnp(), t2.cTglTgl(),
                                     t2.c1PtY(), t2.c1PtZ(), t2.c1PtSnp(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
     o2::track::TrackParCov pars2{t2.x(), t2.alpha(), t2pars, t2covs};
-    procCode = fgFitterTwoProngBarrel.process(pars1, pars2);
+    procCode = fgContext->fPrecheckTwoProngBarrel.process(fgContext->fFitterTwoProngBarrel, pars1, pars2);
   } else if constexpr ((pairType == kDecayToMuMu) && muonHasCov) {
     // Initialize track parameters for forward
     double chi21 = t1.chi2();
@@ -1118,7 +1244,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                            t2.c1PtX(), t2.c1PtY(), t2.c1PtPhi(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
     SMatrix55 t2covs(v2.begin(), v2.end());
     o2::track::TrackParCovFwd pars2{t2.z(), t2pars, t2covs, chi22};
-    procCode = fgFitterTwoProngFwd.process(pars1, pars2);
+    procCode = fgContext->fFitterTwoProngFwd.process(pars1, pars2);
   } else {
     return;
   }
@@ -1161,12 +1287,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
     auto covMatrixPV = primaryVertex.getCov();
 
     if constexpr (pairType == kDecayToEE && trackHasCov) {
-      secondaryVertex = fgFitterTwoProngBarrel.getPCACandidate();
-      bz = fgFitterTwoProngBarrel.getBz();
-      covMatrixPCA = fgFitterTwoProngBarrel.calcPCACovMatrixFlat();
-      auto chi2PCA = fgFitterTwoProngBarrel.getChi2AtPCACandidate();
-      auto trackParVar0 = fgFitterTwoProngBarrel.getTrack(0);
-      auto trackParVar1 = fgFitterTwoProngBarrel.getTrack(1);
+      secondaryVertex = fgContext->fFitterTwoProngBarrel.getPCACandidate();
+      bz = fgContext->fFitterTwoProngBarrel.getBz();
+      covMatrixPCA = fgContext->fFitterTwoProngBarrel.calcPCACovMatrixFlat();
+      auto chi2PCA = fgContext->fFitterTwoProngBarrel.getChi2AtPCACandidate();
+      auto trackParVar0 = fgContext->fFitterTwoProngBarrel.getTrack(0);
+      auto trackParVar1 = fgContext->fFitterTwoProngBarrel.getTrack(1);
       values[kVertexingChi2PCA] = chi2PCA;
       trackParVar0.getPxPyPzGlo(pvec0);
       trackParVar1.getPxPyPzGlo(pvec1);
@@ -1177,12 +1303,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       m1 = fgkMuonMass;
       m2 = fgkMuonMass;
 
-      secondaryVertex = fgFitterTwoProngFwd.getPCACandidate();
-      bz = fgFitterTwoProngFwd.getBz();
-      covMatrixPCA = fgFitterTwoProngFwd.calcPCACovMatrixFlat();
-      auto chi2PCA = fgFitterTwoProngFwd.getChi2AtPCACandidate();
-      auto trackParVar0 = fgFitterTwoProngFwd.getTrack(0);
-      auto trackParVar1 = fgFitterTwoProngFwd.getTrack(1);
+      secondaryVertex = fgContext->fFitterTwoProngFwd.getPCACandidate();
+      bz = fgContext->fFitterTwoProngFwd.getBz();
+      covMatrixPCA = fgContext->fFitterTwoProngFwd.calcPCACovMatrixFlat();
+      auto chi2PCA = fgContext->fFitterTwoProngFwd.getChi2AtPCACandidate();
+      auto trackParVar0 = fgContext->fFitterTwoProngFwd.getTrack(0);
+      auto trackParVar1 = fgContext->fFitterTwoProngFwd.getTrack(1);
       values[kVertexingChi2PCA] = chi2PCA;
       pvec0[0] = trackParVar0.getPx();
       pvec0[1] = trackParVar0.getPy();
@@ -1225,72 +1351,22 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   }
 }
 
-template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
-void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values)
+template <int candidateType, typename T1>
+void VarManager::FillDileptonTrackKinematics(T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values)
 {
-
-  constexpr bool eventHasVtxCov = ((collFillMap & Collision) > 0 || (collFillMap & ReducedEventVtxCov) > 0);
-  constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
-  constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
+  // Kinematics of the dilepton-track triplet, cheap enough to be used for a preselection before the vertexing
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   float mtrack;
   float mlepton;
-
-  int procCode = 0;
-  int procCodeJpsi = 0;
-
-  if constexpr ((candidateType == kBcToThreeMuons) && muonHasCov) {
+  if constexpr (candidateType == kBcToThreeMuons) {
     mlepton = fgkMuonMass;
     mtrack = fgkMuonMass;
-
-    double chi21 = lepton1.chi2();
-    double chi22 = lepton2.chi2();
-    double chi23 = track.chi2();
-    SMatrix5 t1pars(lepton1.x(), lepton1.y(), lepton1.phi(), lepton1.tgl(), lepton1.signed1Pt());
-    std::vector<double> v1{lepton1.cXX(), lepton1.cXY(), lepton1.cYY(), lepton1.cPhiX(), lepton1.cPhiY(),
-                           lepton1.cPhiPhi(), lepton1.cTglX(), lepton1.cTglY(), lepton1.cTglPhi(), lepton1.cTglTgl(),
-                           lepton1.c1PtX(), lepton1.c1PtY(), lepton1.c1PtPhi(), lepton1.c1PtTgl(), lepton1.c1Pt21Pt2()};
-    SMatrix55 t1covs(v1.begin(), v1.end());
-    o2::track::TrackParCovFwd pars1{lepton1.z(), t1pars, t1covs, chi21};
-
-    SMatrix5 t2pars(lepton2.x(), lepton2.y(), lepton2.phi(), lepton2.tgl(), lepton2.signed1Pt());
-    std::vector<double> v2{lepton2.cXX(), lepton2.cXY(), lepton2.cYY(), lepton2.cPhiX(), lepton2.cPhiY(),
-                           lepton2.cPhiPhi(), lepton2.cTglX(), lepton2.cTglY(), lepton2.cTglPhi(), lepton2.cTglTgl(),
-                           lepton2.c1PtX(), lepton2.c1PtY(), lepton2.c1PtPhi(), lepton2.c1PtTgl(), lepton2.c1Pt21Pt2()};
-    SMatrix55 t2covs(v2.begin(), v2.end());
-    o2::track::TrackParCovFwd pars2{lepton2.z(), t2pars, t2covs, chi22};
-
-    SMatrix5 t3pars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-    std::vector<double> v3{track.cXX(), track.cXY(), track.cYY(), track.cPhiX(), track.cPhiY(),
-                           track.cPhiPhi(), track.cTglX(), track.cTglY(), track.cTglPhi(), track.cTglTgl(),
-                           track.c1PtX(), track.c1PtY(), track.c1PtPhi(), track.c1PtTgl(), track.c1Pt21Pt2()};
-    SMatrix55 t3covs(v3.begin(), v3.end());
-    o2::track::TrackParCovFwd pars3{track.z(), t3pars, t3covs, chi23};
-    procCode = VarManager::fgFitterThreeProngFwd.process(pars1, pars2, pars3);
-    procCodeJpsi = VarManager::fgFitterTwoProngFwd.process(pars1, pars2);
-  } else if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
+  } else if constexpr (candidateType == kBtoJpsiEEK) {
     mlepton = fgkElectronMass;
     mtrack = fgkKaonMass;
-    std::array<float, 5> lepton1pars = {lepton1.y(), lepton1.z(), lepton1.snp(), lepton1.tgl(), lepton1.signed1Pt()};
-    std::array<float, 15> lepton1covs = {lepton1.cYY(), lepton1.cZY(), lepton1.cZZ(), lepton1.cSnpY(), lepton1.cSnpZ(),
-                                         lepton1.cSnpSnp(), lepton1.cTglY(), lepton1.cTglZ(), lepton1.cTglSnp(), lepton1.cTglTgl(),
-                                         lepton1.c1PtY(), lepton1.c1PtZ(), lepton1.c1PtSnp(), lepton1.c1PtTgl(), lepton1.c1Pt21Pt2()};
-    o2::track::TrackParCov pars1{lepton1.x(), lepton1.alpha(), lepton1pars, lepton1covs};
-    std::array<float, 5> lepton2pars = {lepton2.y(), lepton2.z(), lepton2.snp(), lepton2.tgl(), lepton2.signed1Pt()};
-    std::array<float, 15> lepton2covs = {lepton2.cYY(), lepton2.cZY(), lepton2.cZZ(), lepton2.cSnpY(), lepton2.cSnpZ(),
-                                         lepton2.cSnpSnp(), lepton2.cTglY(), lepton2.cTglZ(), lepton2.cTglSnp(), lepton2.cTglTgl(),
-                                         lepton2.c1PtY(), lepton2.c1PtZ(), lepton2.c1PtSnp(), lepton2.c1PtTgl(), lepton2.c1Pt21Pt2()};
-    o2::track::TrackParCov pars2{lepton2.x(), lepton2.alpha(), lepton2pars, lepton2covs};
-    std::array<float, 5> lepton3pars = {track.y(), track.z(), track.snp(), track.tgl(), track.signed1Pt()};
-    std::array<float, 15> lepton3covs = {track.cYY(), track.cZY(), track.cZZ(), track.cSnpY(), track.cSnpZ(),
-                                         track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
-                                         track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
-    o2::track::TrackParCov pars3{track.x(), track.alpha(), lepton3pars, lepton3covs};
-    procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
-    procCodeJpsi = VarManager::fgFitterTwoProngBarrel.process(pars1, pars2);
   } else {
     return;
   }
@@ -1308,6 +1384,57 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
   values[VarManager::kPairMassDau] = v12.M();
   values[VarManager::kPairPtDau] = v12.Pt();
   values[VarManager::kPt] = track.pt();
+}
+
+template <int candidateType, uint32_t fillMap, typename T1>
+int VarManager::FitDileptonLegs(T1 const& lepton1, T1 const& lepton2)
+{
+  // Two-prong fit of the dilepton legs, which depends only on the dilepton and can be shared by all its dilepton-track combinations
+  constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
+  constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
+
+  if constexpr ((candidateType == kBcToThreeMuons) && muonHasCov) {
+    return fgContext->fFitterTwoProngFwd.process(getTrackParCovFwd(lepton1), getTrackParCovFwd(lepton2));
+  } else if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
+    return fgContext->fPrecheckTwoProngBarrel.process(fgContext->fFitterTwoProngBarrel, getTrackParCovBarrel(lepton1), getTrackParCovBarrel(lepton2));
+  }
+  return 0;
+}
+
+template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
+void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values, int procCodeDilepton)
+{
+  // NOTE: procCodeDilepton is the result of FitDileptonLegs() for this dilepton, if negative the fit of the legs is run here
+
+  constexpr bool eventHasVtxCov = ((collFillMap & Collision) > 0 || (collFillMap & ReducedEventVtxCov) > 0);
+  constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
+  constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
+  if (!values) {
+    values = fgContext->fValues;
+  }
+
+  float mtrack;
+  float mlepton;
+
+  int procCode = 0;
+  int procCodeJpsi = procCodeDilepton;
+
+  if constexpr ((candidateType == kBcToThreeMuons) && muonHasCov) {
+    mlepton = fgkMuonMass;
+    mtrack = fgkMuonMass;
+    procCode = fgContext->fFitterThreeProngFwd.process(getTrackParCovFwd(lepton1), getTrackParCovFwd(lepton2), getTrackParCovFwd(track));
+  } else if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
+    mlepton = fgkElectronMass;
+    mtrack = fgkKaonMass;
+    procCode = fgContext->fFitterThreeProngBarrel.process(getTrackParCovBarrel(lepton1), getTrackParCovBarrel(lepton2), getTrackParCovBarrel(track));
+  } else {
+    return;
+  }
+  if (procCodeJpsi < 0) {
+    procCodeJpsi = FitDileptonLegs<candidateType, fillMap>(lepton1, lepton2);
+  }
+
+  FillDileptonTrackKinematics<candidateType>(lepton1, lepton2, track, values);
 
   values[VarManager::kVertexingProcCode] = procCode;
   if (procCode == 0 || procCodeJpsi == 0) {
@@ -1339,12 +1466,17 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
     o2::dataformats::VertexBase primaryVertex = {std::move(vtxXYZ), std::move(vtxCov)};
     auto covMatrixPV = primaryVertex.getCov();
 
+    ROOT::Math::PtEtaPhiMVector v1(lepton1.pt(), lepton1.eta(), lepton1.phi(), mlepton);
+    ROOT::Math::PtEtaPhiMVector v2(lepton2.pt(), lepton2.eta(), lepton2.phi(), mlepton);
+    ROOT::Math::PtEtaPhiMVector v3(track.pt(), track.eta(), track.phi(), mtrack);
+    ROOT::Math::PtEtaPhiMVector v123 = v1 + v2 + v3;
+
     if constexpr (candidateType == kBtoJpsiEEK && trackHasCov) {
-      secondaryVertex = fgFitterThreeProngBarrel.getPCACandidate();
-      covMatrixPCA = fgFitterThreeProngBarrel.calcPCACovMatrixFlat();
+      secondaryVertex = fgContext->fFitterThreeProngBarrel.getPCACandidate();
+      covMatrixPCA = fgContext->fFitterThreeProngBarrel.calcPCACovMatrixFlat();
     } else if constexpr (candidateType == kBcToThreeMuons && muonHasCov) {
-      secondaryVertex = fgFitterThreeProngFwd.getPCACandidate();
-      covMatrixPCA = fgFitterThreeProngFwd.calcPCACovMatrixFlat();
+      secondaryVertex = fgContext->fFitterThreeProngFwd.getPCACandidate();
+      covMatrixPCA = fgContext->fFitterThreeProngFwd.calcPCACovMatrixFlat();
     }
 
     double phi = std::atan2(secondaryVertex[1] - collision.posY(), secondaryVertex[0] - collision.posX());
@@ -1381,7 +1513,7 @@ template <typename C, typename A>
 void VarManager::FillQVectorFromGFW(C const& collision, A const& compA2, A const& compB2, A const& compC2, A const& compA3, A const& compB3, A const& compC3, float normA, float normB, float normC, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   // Fill Qn vectors from generic flow framework for different eta gap A, B, C (n=2,3)
@@ -1422,7 +1554,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
 {
 
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
   float m1 = fgkElectronMass;
@@ -1454,10 +1586,10 @@ template <typename T1, typename T2>
 void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float* values, float hadronMass)
 {
   if (!values) {
-    values = fgValues;
+    values = fgContext->fValues;
   }
 
-  if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt] || fgUsedVars[kPairEta] || fgUsedVars[kPairPhi]) {
+  if (fgContext->fUsedVars[kPairMass] || fgContext->fUsedVars[kPairPt] || fgContext->fUsedVars[kPairEta] || fgContext->fUsedVars[kPairPhi]) {
     ROOT::Math::PtEtaPhiMVector v1(dilepton.pt(), dilepton.eta(), dilepton.phi(), dilepton.mass());
     ROOT::Math::PtEtaPhiMVector v2(hadron.pt(), hadron.eta(), hadron.phi(), hadronMass);
     ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
@@ -1466,7 +1598,7 @@ void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float*
     values[kPairEta] = v12.Eta();
     values[kPairPhi] = v12.Phi();
   }
-  if (fgUsedVars[kDeltaPhi]) {
+  if (fgContext->fUsedVars[kDeltaPhi]) {
     double delta = dilepton.phi() - hadron.phi();
     if (delta > 3.0 / 2.0 * M_PI) {
       delta -= 2.0 * M_PI;
@@ -1476,14 +1608,14 @@ void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float*
     }
     values[kDeltaPhi] = delta;
   }
-  if (fgUsedVars[kDeltaPhiSym]) {
+  if (fgContext->fUsedVars[kDeltaPhiSym]) {
     double delta = std::abs(dilepton.phi() - hadron.phi());
     if (delta > M_PI) {
       delta = 2 * M_PI - delta;
     }
     values[kDeltaPhiSym] = delta;
   }
-  if (fgUsedVars[kDeltaEta]) {
+  if (fgContext->fUsedVars[kDeltaEta]) {
     values[kDeltaEta] = dilepton.eta() - hadron.eta();
   }
 }
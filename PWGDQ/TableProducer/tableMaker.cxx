@@ -33,10 +33,12 @@
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include "PWGDQ/Core/AnalysisCutEvaluator.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 
 #include <iostream>
+#include <unordered_set>
 using std::cout;
 using std::endl;
 
@@ -126,6 +128,12 @@ struct TableMaker {
   std::vector<AnalysisCompositeCut> fTrackCuts; //! Barrel track cuts
   std::vector<AnalysisCompositeCut> fMuonCuts;  //! Muon track cuts
 
+  AnalysisCutEvaluator fTrackCutEvaluator;       //! all the barrel track cuts compiled into one evaluator
+  AnalysisCutEvaluator fMuonCutEvaluator;        //! all the muon cuts compiled into one evaluator
+  std::vector<float> fCutRows;                   //! compact cut variables of all the tracks (muons) of the event
+  std::vector<uint32_t> fCutDecisions;           //! cut decisions of all the tracks (muons) of the event
+  std::unordered_set<int64_t> fAmbiguousIndices; //! indices of the tracks (muons) listed in the ambiguous tracks table
+
   bool fDoDetailedQA = false; // Bool to set detailed QA true, if QA is set true
 
   // TODO: filter on TPC dedx used temporarily until electron PID will be improved
@@ -229,6 +237,8 @@ struct TableMaker {
       }
     }
 
+    fTrackCutEvaluator.Compile(fTrackCuts);
+    fMuonCutEvaluator.Compile(fMuonCuts);
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
   }
 
@@ -299,24 +309,25 @@ struct TableMaker {
       }
       trackBarrelPID.reserve(tracksBarrel.size());
 
-      // loop over tracks
-      for (auto& track : tracksBarrel) {
-        if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
-          if (fIsAmbiguous) {
-            isAmbiguous = 0;
-            for (auto& ambiTrackMid : ambiTracksMid) {
-              auto ambiTrack = ambiTrackMid.template track_as<MyBarrelTracks>();
-              auto ambiTrackWithCov = ambiTrackMid.template track_as<MyBarrelTracksWithCov>();
-              if (ambiTrack.globalIndex() == track.globalIndex() || ambiTrackWithCov.globalIndex() == track.globalIndex()) {
-                isAmbiguous = 1;
-                break;
-              }
-            }
+      // list the ambiguous tracks once, instead of looping over the ambiguous tracks table for each track
+      if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
+        fAmbiguousIndices.clear();
+        if (fIsAmbiguous) {
+          for (auto& ambiTrackMid : ambiTracksMid) {
+            fAmbiguousIndices.insert(ambiTrackMid.trackId());
           }
         }
+      }
 
-        trackFilteringTag = uint64_t(0);
-        trackTempFilterMap = uint8_t(0);
+      // first pass: fill the variables of all the tracks and evaluate all the track cuts at once
+      const int nCutVars = fTrackCutEvaluator.GetNVars();
+      fCutRows.resize(tracksBarrel.size() * nCutVars);
+      fCutDecisions.resize(tracksBarrel.size());
+      int iRow = 0;
+      for (auto& track : tracksBarrel) {
+        if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
+          isAmbiguous = (fAmbiguousIndices.count(track.globalIndex()) > 0 ? 1 : 0);
+        }
         VarManager::FillTrack<TTrackFillMap>(track);
         if (fDoDetailedQA) {
           fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
@@ -324,12 +335,29 @@ struct TableMaker {
             fHistMan->FillHistClass("Ambiguous_TrackBarrel_BeforeCuts", VarManager::fgValues);
           }
         }
+        fTrackCutEvaluator.PackValues(VarManager::fgValues, fCutRows.data() + nCutVars * iRow++);
+      }
+      fTrackCutEvaluator.Evaluate(fCutRows.data(), tracksBarrel.size(), fCutDecisions.data());
 
-        // apply track cuts and fill stats histogram
+      // second pass: write only the tracks passing at least one of the cuts
+      iRow = 0;
+      for (auto& track : tracksBarrel) {
+        trackFilteringTag = uint64_t(0);
+        trackTempFilterMap = uint8_t(fCutDecisions[iRow++]);
+        if (!trackTempFilterMap) {
+          continue;
+        }
+        if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
+          isAmbiguous = (fAmbiguousIndices.count(track.globalIndex()) > 0 ? 1 : 0);
+        }
+
+        // fill the stats histogram and the QA histograms of the passed cuts
+        if (fConfigQA) {
+          VarManager::FillTrack<TTrackFillMap>(track);
+        }
         int i = 0;
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
-            trackTempFilterMap |= (uint8_t(1) << i);
+          if (trackTempFilterMap & (uint8_t(1) << i)) {
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
               if (fIsAmbiguous && isAmbiguous == 1) {
@@ -339,9 +367,6 @@ struct TableMaker {
             ((TH1I*)fStatsList->At(1))->Fill(float(i));
           }
         }
-        if (!trackTempFilterMap) {
-          continue;
-        }
 
         // store filtering information
         if (track.isGlobalTrack()) {
@@ -401,23 +426,44 @@ struct TableMaker {
       std::map<int, int> newEntryNb;
       std::map<int, int> newMatchIndex;
 
+      // list the ambiguous muons once, instead of looping over the ambiguous tracks table for each muon
+      if constexpr ((TMuonFillMap & VarManager::ObjTypes::AmbiMuon) > 0) {
+        fAmbiguousIndices.clear();
+        if (fIsAmbiguous) {
+          for (auto& ambiTrackFwd : ambiTracksFwd) {
+            fAmbiguousIndices.insert(ambiTrackFwd.fwdtrackId());
+          }
+        }
+      }
+
+      // evaluate all the muon cuts at once, the decisions are used both for the new indices and for writing the muons
+      const int nCutVars = fMuonCutEvaluator.GetNVars();
+      fCutRows.resize(tracksMuon.size() * nCutVars);
+      fCutDecisions.resize(tracksMuon.size());
+      int iRow = 0;
       for (auto& muon : tracksMuon) {
-        trackFilteringTag = uint64_t(0);
+        if constexpr ((TMuonFillMap & VarManager::ObjTypes::AmbiMuon) > 0) {
+          isAmbiguous = (fAmbiguousIndices.count(muon.globalIndex()) > 0 ? 1 : 0);
+        }
         VarManager::FillTrack<TMuonFillMap>(muon);
+        if (fDoDetailedQA) {
+          fHistMan->FillHistClass("Muons_BeforeCuts", VarManager::fgValues);
+          if (fIsAmbiguous && isAmbiguous == 1) {
+            fHistMan->FillHistClass("Ambiguous_Muons_BeforeCuts", VarManager::fgValues);
+          }
+        }
+        fMuonCutEvaluator.PackValues(VarManager::fgValues, fCutRows.data() + nCutVars * iRow++);
+      }
+      fMuonCutEvaluator.Evaluate(fCutRows.data(), tracksMuon.size(), fCutDecisions.data());
 
+      iRow = 0;
+      for (auto& muon : tracksMuon) {
         if (muon.index() > idxPrev + 1) { // checks if some muons are filtered even before the skimming function
           nDel += muon.index() - (idxPrev + 1);
         }
         idxPrev = muon.index();
 
-        // check the cuts and filters
-        int i = 0;
-        for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues))
-            trackTempFilterMap |= (uint8_t(1) << i);
-        }
-
-        if (!trackTempFilterMap) { // does not pass the cuts
+        if (!fCutDecisions[iRow++]) { // does not pass the cuts
           nDel++;
         } else { // it passes the cuts and will be saved in the tables
           newEntryNb[muon.index()] = muon.index() - nDel;
@@ -425,35 +471,24 @@ struct TableMaker {
       }
 
       // now let's save the muons with the correct indices and matches
+      iRow = 0;
       for (auto& muon : tracksMuon) {
+        trackFilteringTag = uint64_t(0);
+        trackTempFilterMap = uint8_t(fCutDecisions[iRow++]);
+        if (!trackTempFilterMap) {
+          continue;
+        }
         if constexpr ((TMuonFillMap & VarManager::ObjTypes::AmbiMuon) > 0) {
-          if (fIsAmbiguous) {
-            isAmbiguous = 0;
-            for (auto& ambiTrackFwd : ambiTracksFwd) {
-              auto ambiMuon = ambiTrackFwd.template fwdtrack_as<MyMuons>();
-              auto ambiMuonWithCov = ambiTrackFwd.template fwdtrack_as<MyMuonsWithCov>();
-              if (ambiMuon.globalIndex() == muon.globalIndex() || ambiMuonWithCov.globalIndex() == muon.globalIndex()) {
-                isAmbiguous = 1;
-                break;
-              }
-            }
-          }
+          isAmbiguous = (fAmbiguousIndices.count(muon.globalIndex()) > 0 ? 1 : 0);
         }
-        trackFilteringTag = uint64_t(0);
-        trackTempFilterMap = uint8_t(0);
 
-        VarManager::FillTrack<TMuonFillMap>(muon);
-        if (fDoDetailedQA) {
-          fHistMan->FillHistClass("Muons_BeforeCuts", VarManager::fgValues);
-          if (fIsAmbiguous && isAmbiguous == 1) {
-            fHistMan->FillHistClass("Ambiguous_Muons_BeforeCuts", VarManager::fgValues);
-          }
+        // fill the stats histogram and the QA histograms of the passed cuts
+        if (fConfigQA) {
+          VarManager::FillTrack<TMuonFillMap>(muon);
         }
-        // apply the muon selection cuts and fill the stats histogram
         int i = 0;
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
-            trackTempFilterMap |= (uint8_t(1) << i);
+          if (trackTempFilterMap & (uint8_t(1) << i)) {
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
               if (fIsAmbiguous && isAmbiguous == 1) {
@@ -463,9 +498,6 @@ struct TableMaker {
             ((TH1I*)fStatsList->At(2))->Fill(float(i));
           }
         }
-        if (!trackTempFilterMap) {
-          continue;
-        }
         // store the cut decisions
         trackFilteringTag |= uint64_t(trackTempFilterMap); // BIT0-7:  user selection cuts
 
@@ -102,6 +102,7 @@ struct TableMakerMC {
 
   // list of MCsignal objects
   std::vector<MCSignal> fMCSignals;
+  MCSignalAncestry fMCAncestry; // histories of the MC particles of the dataframe, shared by all the MC signals
 
   OutputObj<THashList> fOutputList{"output"};
   // TODO: add statistics histograms, similar to table-maker
@@ -272,6 +273,8 @@ struct TableMakerMC {
     uint16_t mcflags = 0;
     uint64_t trackFilteringTag = 0;
     uint8_t trackTempFilterMap = 0;
+    // walk the history of each MC particle once, instead of once per MC signal
+    fMCAncestry.Fill(mcTracks);
     for (auto& collision : collisions) {
       //TODO: investigate the collisions without corresponding mcCollision
       if (!collision.has_mcCollision()) {
@@ -346,7 +349,7 @@ struct TableMakerMC {
         mcflags = 0;
         int i = 0;
         for (auto& sig : fMCSignals) {
-          if (sig.CheckSignal(true, mcTracks, mctrack)) {
+          if (sig.CheckSignalFromAncestry(true, fMCAncestry, mcTracks, mctrack)) {
             mcflags |= (uint16_t(1) << i);
           }
           i++;
@@ -443,7 +446,7 @@ struct TableMakerMC {
           int j = 0; // runs over the track cuts
           // check all the specified signals and fill histograms for MC truth matched tracks
           for (auto& sig : fMCSignals) {
-            if (sig.CheckSignal(true, mcTracks, mctrack)) {
+            if (sig.CheckSignalFromAncestry(true, fMCAncestry, mcTracks, mctrack)) {
               mcflags |= (uint16_t(1) << i);
               if (fDoDetailedQA) {
                 j = 0;
@@ -581,7 +584,7 @@ struct TableMakerMC {
           int j = 0; // runs over the track cuts
           // check all the specified signals and fill histograms for MC truth matched tracks
           for (auto& sig : fMCSignals) {
-            if (sig.CheckSignal(true, mcTracks, mctrack)) {
+            if (sig.CheckSignalFromAncestry(true, fMCAncestry, mcTracks, mctrack)) {
               mcflags |= (uint16_t(1) << i);
               if (fDoDetailedQA) {
                 fHistMan->FillHistClass(Form("Muons_BeforeCuts_%s", sig.GetName()), VarManager::fgValues); // fill the reconstructed truth BeforeCuts
@@ -29,9 +29,14 @@
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include "PWGDQ/Core/AnalysisCutEvaluator.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -70,12 +75,22 @@ struct dalitzPairing {
   OutputObj<THashList> fOutputList{"output"}; //! the histogram manager output list
   OutputObj<TList> fStatsList{"Statistics"};  //! skimming statistics
 
-  std::map<int, uint8_t> trackmap;
-  std::map<int, uint8_t> dalitzmap;
+  // selected track, with the momentum needed for the pair mass pre-filter
+  struct DalitzTrack {
+    uint8_t filterMap = 0; // track cuts passed by the track
+    float px = 0.f;
+    float py = 0.f;
+    float pz = 0.f;
+    float energy = 0.f; // in the electron mass hypothesis
+  };
+  std::vector<DalitzTrack> trackmap; // indexed by the track global index, filled per collision
+  std::vector<uint8_t> dalitzmap;    // Dalitz bits, indexed by the track global index
 
   AnalysisCompositeCut* fEventCut;
   std::vector<AnalysisCompositeCut> fTrackCuts;
   std::vector<AnalysisCompositeCut> fPairCuts;
+  AnalysisCutEvaluator fPairCutEvaluator; // all the pair cuts compiled into one evaluator
+  std::vector<float> fMaxMass;           // upper limit on the pair mass required by each pair cut, infinity if none
   int nCuts = 0;
 
   HistogramManager* fHistMan;
@@ -109,6 +124,10 @@ struct dalitzPairing {
       std::cout << "WARNING: YOU SHOULD PROVIDE THE SAME NUMBER OF TRACK AND PAIR CUTS" << std::endl;
     }
     nCuts = std::min(fTrackCuts.size(), fPairCuts.size());
+    fPairCutEvaluator.Compile(fPairCuts);
+    for (int icut = 0; icut < nCuts; icut++) {
+      fMaxMass.push_back(getMaxMass(fPairCuts.at(icut)));
+    }
 
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
     VarManager::SetDefaultVarNames();
@@ -166,6 +185,34 @@ struct dalitzPairing {
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
+  // Upper limit on the pair mass required by a cut, infinity if the cut does not always require one
+  static float getMaxMass(const AnalysisCut& cut)
+  {
+    float maxMass = std::numeric_limits<float>::infinity();
+    for (auto const& c : cut.GetCuts()) {
+      if (c.fVar == VarManager::kMass && !c.fExclude && c.fDepVar == -1 && c.fDepVar2 == -1 && c.fFuncHigh == nullptr) {
+        maxMass = std::min(maxMass, c.fHigh);
+      }
+    }
+    return maxMass;
+  }
+
+  static float getMaxMass(const AnalysisCompositeCut& cut)
+  {
+    if (cut.GetNCuts() == 0) {
+      return std::numeric_limits<float>::infinity();
+    }
+    // AND: the tightest limit of the sub-cuts, OR: the loosest one
+    float maxMass = cut.GetUseAND() ? std::numeric_limits<float>::infinity() : 0.f;
+    for (auto const& subCut : cut.GetCutList()) {
+      maxMass = cut.GetUseAND() ? std::min(maxMass, getMaxMass(subCut)) : std::max(maxMass, getMaxMass(subCut));
+    }
+    for (auto const& subCut : cut.GetCompositeCutList()) {
+      maxMass = cut.GetUseAND() ? std::min(maxMass, getMaxMass(subCut)) : std::max(maxMass, getMaxMass(subCut));
+    }
+    return maxMass;
+  }
+
   template <uint32_t TTrackFillMap, typename TTracks>
   void runTrackSelection(TTracks const& tracksBarrel)
   {
@@ -178,8 +225,13 @@ struct dalitzPairing {
           filterMap |= (uint8_t(1) << i);
         }
       }
+      DalitzTrack& dalitzTrack = trackmap[track.globalIndex()];
+      dalitzTrack.filterMap = filterMap;
       if (filterMap) {
-        trackmap[track.globalIndex()] = filterMap;
+        dalitzTrack.px = track.px();
+        dalitzTrack.py = track.py();
+        dalitzTrack.pz = track.pz();
+        dalitzTrack.energy = std::sqrt(track.p() * track.p() + fgkElectronMass * fgkElectronMass);
       }
     } // end loop over tracks
   }
@@ -193,40 +245,49 @@ struct dalitzPairing {
         continue;
       }
 
-      uint8_t twoTracksFilterMap = trackmap[track1.globalIndex()] & trackmap[track2.globalIndex()];
+      const DalitzTrack& dalitzTrack1 = trackmap[track1.globalIndex()];
+      const DalitzTrack& dalitzTrack2 = trackmap[track2.globalIndex()];
+      uint8_t twoTracksFilterMap = dalitzTrack1.filterMap & dalitzTrack2.filterMap;
+      if (!twoTracksFilterMap)
+        continue;
+
+      // mass pre-filter: drop the cuts whose mass limit is already exceeded, before filling the pair variables
+      float px = dalitzTrack1.px + dalitzTrack2.px;
+      float py = dalitzTrack1.py + dalitzTrack2.py;
+      float pz = dalitzTrack1.pz + dalitzTrack2.pz;
+      float energy = dalitzTrack1.energy + dalitzTrack2.energy;
+      float mee = std::sqrt(std::max(0.f, energy * energy - px * px - py * py - pz * pz));
+      for (int icut = 0; icut < nCuts; icut++) {
+        if (mee > fMaxMass[icut] * 1.001f + 1.e-4f) { // margin for the rounding differences wrt VarManager::FillPair
+          twoTracksFilterMap &= ~(uint8_t(1) << icut);
+        }
+      }
       if (!twoTracksFilterMap)
         continue;
 
       // pairing
       VarManager::FillPair<TPairType, TTrackFillMap>(track1, track2);
-      uint8_t track1Untagged = uint8_t(0);
-      uint8_t track2Untagged = uint8_t(0);
 
-      // Fill pair selection map and fill pair histogram
-      for (int icut = 0; icut < nCuts; icut++) {
-        if (!(twoTracksFilterMap & (uint8_t(1) << icut)))
-          continue;
-        AnalysisCompositeCut pairCut = fPairCuts.at(icut);
-        if (pairCut.IsSelected(VarManager::fgValues)) {
-          if (fQA) {
-            AnalysisCompositeCut trackCut = fTrackCuts.at(icut);
-            fHistMan->FillHistClass(Form("Pair_%s_%s", trackCut.GetName(), pairCut.GetName()), VarManager::fgValues);
-          }
+      // all the pair cuts at once
+      uint8_t pairFilterMap = twoTracksFilterMap & uint8_t(fPairCutEvaluator.Evaluate(VarManager::fgValues));
+      if (!pairFilterMap)
+        continue;
 
-          // Check if tracks were already tagged
-          bool b1 = dalitzmap[track1.globalIndex()] & (uint8_t(1) << icut);
-          if (!b1) {
-            track1Untagged |= (uint8_t(1) << icut);
-            if (fQA) {
-              ((TH1I*)fStatsList->At(0))->Fill(icut);
-            }
+      // tracks not yet tagged by these cuts
+      uint8_t track1Untagged = pairFilterMap & ~dalitzmap[track1.globalIndex()];
+      uint8_t track2Untagged = pairFilterMap & ~dalitzmap[track2.globalIndex()];
+
+      // Fill pair histograms and the statistics of the newly tagged tracks
+      if (fQA) {
+        for (int icut = 0; icut < nCuts; icut++) {
+          if (!(pairFilterMap & (uint8_t(1) << icut)))
+            continue;
+          fHistMan->FillHistClass(Form("Pair_%s_%s", fTrackCuts.at(icut).GetName(), fPairCuts.at(icut).GetName()), VarManager::fgValues);
+          if (track1Untagged & (uint8_t(1) << icut)) {
+            ((TH1I*)fStatsList->At(0))->Fill(icut);
           }
-          bool b2 = dalitzmap[track2.globalIndex()] & (uint8_t(1) << icut);
-          if (!b2) {
-            track2Untagged |= (uint8_t(1) << icut);
-            if (fQA) {
-              ((TH1I*)fStatsList->At(0))->Fill(icut);
-            }
+          if (track2Untagged & (uint8_t(1) << icut)) {
+            ((TH1I*)fStatsList->At(0))->Fill(icut);
           }
         }
       }
@@ -236,21 +297,19 @@ struct dalitzPairing {
       dalitzmap[track2.globalIndex()] |= track2Untagged;
 
       // Fill track histograms if not already tagged
-      if (fQA) {
+      if (fQA && track1Untagged) {
         VarManager::FillTrack<TTrackFillMap>(track1);
         for (int icut = 0; icut < nCuts; icut++) {
           if (track1Untagged & (uint8_t(1) << icut)) {
-            AnalysisCompositeCut trackCut = fTrackCuts.at(icut);
-            AnalysisCompositeCut pairCut = fPairCuts.at(icut);
-            fHistMan->FillHistClass(Form("TrackBarrel_%s_%s", trackCut.GetName(), pairCut.GetName()), VarManager::fgValues);
+            fHistMan->FillHistClass(Form("TrackBarrel_%s_%s", fTrackCuts.at(icut).GetName(), fPairCuts.at(icut).GetName()), VarManager::fgValues);
           }
         }
+      }
+      if (fQA && track2Untagged) {
         VarManager::FillTrack<TTrackFillMap>(track2);
         for (int icut = 0; icut < nCuts; icut++) {
           if (track2Untagged & (uint8_t(1) << icut)) {
-            AnalysisCompositeCut trackCut = fTrackCuts.at(icut);
-            AnalysisCompositeCut pairCut = fPairCuts.at(icut);
-            fHistMan->FillHistClass(Form("TrackBarrel_%s_%s", trackCut.GetName(), pairCut.GetName()), VarManager::fgValues);
+            fHistMan->FillHistClass(Form("TrackBarrel_%s_%s", fTrackCuts.at(icut).GetName(), fPairCuts.at(icut).GetName()), VarManager::fgValues);
           }
         }
       }
@@ -259,10 +318,10 @@ struct dalitzPairing {
 
   void processFullTracks(MyEvents const& collisions, soa::Filtered<MyBarrelTracks> const& filteredTracks, MyBarrelTracks const& tracks)
   {
-    dalitzmap.clear();
+    dalitzmap.assign(tracks.size(), 0);
+    trackmap.resize(tracks.size());
 
     for (auto& collision : collisions) {
-      trackmap.clear();
       VarManager::ResetValues(0, VarManager::kNBarrelTrackVariables);
       VarManager::FillEvent<gkEventFillMap>(collision);
       bool isEventSelected = fEventCut->IsSelected(VarManager::fgValues);
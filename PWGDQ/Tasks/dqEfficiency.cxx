@@ -85,6 +85,8 @@ constexpr static uint32_t gkMuonFillMapWithCov = VarManager::ObjTypes::ReducedMu
 constexpr static uint32_t gkParticleMCFillMap = VarManager::ObjTypes::ParticleMC;
 
 void DefineHistograms(HistogramManager* histMan, TString histClasses);
+// Get the handles of the histogram classes used in the pairing loops, with the same layout as the input names
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames);
 
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
@@ -501,8 +503,15 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fMuonHistNamesMCmatched;
   std::vector<std::vector<TString>> fBarrelMuonHistNames;
   std::vector<std::vector<TString>> fBarrelMuonHistNamesMCmatched;
+  std::vector<std::vector<int>> fBarrelHistHandles;
+  std::vector<std::vector<int>> fBarrelHistHandlesMCmatched;
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fMuonHistHandlesMCmatched;
+  std::vector<std::vector<int>> fBarrelMuonHistHandles;
+  std::vector<std::vector<int>> fBarrelMuonHistHandlesMCmatched;
   std::vector<MCSignal> fRecMCSignals;
   std::vector<MCSignal> fGenMCSignals;
+  MCSignalAncestry fMCAncestry; // histories of the MC particles of the MC event, shared by all the generated MC signals
 
   void init(o2::framework::InitContext& context)
   {
@@ -642,7 +651,22 @@ struct AnalysisSameEventPairing {
 
     DefineHistograms(fHistMan, histNames.Data());    // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
+    // the vertexing variables written in the dimuon tables are needed even if not used in histograms
+    if (context.mOptions.get<bool>("processDecayToMuMuVertexingSkimmed")) {
+      VarManager::SetUseVariable(VarManager::kVertexingTauz);
+      VarManager::SetUseVariable(VarManager::kVertexingLz);
+      VarManager::SetUseVariable(VarManager::kVertexingLxy);
+      VarManager::SetUseVariable(VarManager::kVertexingTauzErr);
+      VarManager::SetUseVariable(VarManager::kVertexingTauxy);
+      VarManager::SetUseVariable(VarManager::kVertexingTauxyErr);
+    }
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+    fBarrelHistHandles = GetHistClassHandles(fHistMan, fBarrelHistNames);
+    fBarrelHistHandlesMCmatched = GetHistClassHandles(fHistMan, fBarrelHistNamesMCmatched);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fMuonHistHandlesMCmatched = GetHistClassHandles(fHistMan, fMuonHistNamesMCmatched);
+    fBarrelMuonHistHandles = GetHistClassHandles(fHistMan, fBarrelMuonHistNames);
+    fBarrelMuonHistHandlesMCmatched = GetHistClassHandles(fHistMan, fBarrelMuonHistNamesMCmatched);
 
     VarManager::SetupTwoProngDCAFitter(5.0f, true, 200.0f, 4.0f, 1.0e-3f, 0.9f, true); // TODO: get these parameters from Configurables
     VarManager::SetupTwoProngFwdDCAFitter(5.0f, true, 200.0f, 1.0e-3f, 0.9f, true);
@@ -652,19 +676,17 @@ struct AnalysisSameEventPairing {
   void runPairing(TEvent const& event, TTracks1 const& tracks1, TTracks2 const& tracks2, TEventsMC const& eventsMC, TTracksMC const& tracksMC)
   {
     // establish the right histogram classes to be filled depending on TPairType (ee,mumu,emu)
-    unsigned int ncuts = fBarrelHistNames.size();
-    std::vector<std::vector<TString>> histNames = fBarrelHistNames;
-    std::vector<std::vector<TString>> histNamesMCmatched = fBarrelHistNamesMCmatched;
+    std::vector<std::vector<int>> const* histHandles = &fBarrelHistHandles;
+    std::vector<std::vector<int>> const* histHandlesMCmatched = &fBarrelHistHandlesMCmatched;
     if constexpr (TPairType == VarManager::kDecayToMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
-      histNamesMCmatched = fMuonHistNamesMCmatched;
+      histHandles = &fMuonHistHandles;
+      histHandlesMCmatched = &fMuonHistHandlesMCmatched;
     }
     if constexpr (TPairType == VarManager::kElectronMuon) {
-      ncuts = fBarrelMuonHistNames.size();
-      histNames = fBarrelMuonHistNames;
-      histNamesMCmatched = fBarrelMuonHistNamesMCmatched;
+      histHandles = &fBarrelMuonHistHandles;
+      histHandlesMCmatched = &fBarrelMuonHistHandlesMCmatched;
     }
+    unsigned int ncuts = histHandles->size();
 
     // Loop over two track combinations
     uint8_t twoTrackFilter = 0;
@@ -726,17 +748,17 @@ struct AnalysisSameEventPairing {
       for (unsigned int icut = 0; icut < ncuts; icut++) {
         if (twoTrackFilter & (uint8_t(1) << icut)) {
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass((*histHandles)[icut][0], VarManager::fgValues);
             for (unsigned int isig = 0; isig < fRecMCSignals.size(); isig++) {
               if (mcDecision & (uint32_t(1) << isig)) {
-                fHistMan->FillHistClass(histNamesMCmatched[icut][isig].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass((*histHandlesMCmatched)[icut][isig], VarManager::fgValues);
               }
             }
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][1], VarManager::fgValues);
             } else {
-              fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][2], VarManager::fgValues);
             }
           }
         }
@@ -750,6 +772,7 @@ struct AnalysisSameEventPairing {
     // loop over mc stack and fill histograms for pure MC truth signals
     // group all the MC tracks which belong to the MC event corresponding to the current reconstructed event
     // auto groupedMCTracks = tracksMC.sliceBy(aod::reducedtrackMC::reducedMCeventId, event.reducedMCevent().globalIndex());
+    fMCAncestry.Fill(groupedMCTracks);
     for (auto& mctrack : groupedMCTracks) {
       VarManager::FillTrack<gkParticleMCFillMap>(mctrack);
       // NOTE: Signals are checked here mostly based on the skimmed MC stack, so depending on the requested signal, the stack could be incomplete.
@@ -759,7 +782,7 @@ struct AnalysisSameEventPairing {
         if (sig.GetNProngs() != 1) { // NOTE: 1-prong signals required
           continue;
         }
-        if (sig.CheckSignal(false, groupedMCTracks, mctrack)) {
+        if (sig.CheckSignalFromAncestry(false, fMCAncestry, groupedMCTracks, mctrack)) {
           fHistMan->FillHistClass(Form("MCTruthGen_%s", sig.GetName()), VarManager::fgValues);
         }
       }
@@ -771,7 +794,7 @@ struct AnalysisSameEventPairing {
         continue;
       }
       for (auto& [t1, t2] : combinations(groupedMCTracks, groupedMCTracks)) {
-        if (sig.CheckSignal(false, groupedMCTracks, t1, t2)) {
+        if (sig.CheckSignalFromAncestry(false, fMCAncestry, groupedMCTracks, t1, t2)) {
           VarManager::FillPairMC(t1, t2);
           fHistMan->FillHistClass(Form("MCTruthGenPair_%s", sig.GetName()), VarManager::fgValues);
         }
@@ -872,6 +895,7 @@ struct AnalysisDileptonTrack {
   // TODO: For now this is only used to determine the position in the filter bit map for the hadron cut
   Configurable<string> fConfigTrackCuts{"cfgLeptonCuts", "", "Comma separated list of barrel track cuts"};
   Configurable<bool> fConfigFillCandidateTable{"cfgFillCandidateTable", false, "Produce a single flat tables with all relevant information dilepton-track candidates"};
+  Configurable<std::string> fConfigKinematicCut{"cfgDileptonTrackKinematicCut", "", "Cut on the dilepton-track kinematics (only kPairMass, kPairPt, kPairEta, kPairMassDau, kPairPtDau, kPt), applied before the vertexing"};
   Filter eventFilter = aod::dqanalysisflags::isEventSelected == 1;
   // Filter dileptonFilter = aod::reducedpair::mass > 2.92f && aod::reducedpair::mass < 3.16f && aod::reducedpair::sign == 0;
   // Filter dileptonFilter = aod::reducedpair::mass > 2.6f && aod::reducedpair::mass < 3.5f && aod::reducedpair::sign == 0;
@@ -892,14 +916,24 @@ struct AnalysisDileptonTrack {
 
   std::vector<MCSignal> fRecMCSignals;
   std::vector<MCSignal> fGenMCSignals;
+  MCSignalAncestry fMCAncestry; // histories of the MC particles of the MC event, shared by all the generated MC signals
 
   // NOTE: the barrel track filter is shared between the filters for dilepton electron candidates (first n-bits)
   //       and the associated hadrons (n+1 bit) --> see the barrel track selection task
   //      The current condition should be replaced when bitwise operators will become available in Filter expressions
   int fNHadronCutBit;
 
+  AnalysisCompositeCut* fKinematicCut; // preselection of the dilepton-track combinations, nullptr if not configured
+
   void init(o2::framework::InitContext& context)
   {
+    fKinematicCut = nullptr;
+    TString kinematicCutStr = fConfigKinematicCut.value;
+    if (!kinematicCutStr.IsNull()) {
+      fKinematicCut = new AnalysisCompositeCut(true);
+      fKinematicCut->AddCut(dqcuts::GetAnalysisCut(kinematicCutStr.Data()));
+    }
+
     TString sigNamesStr = fConfigMCRecSignals.value;
     std::unique_ptr<TObjArray> objRecSigArray(sigNamesStr.Tokenize(","));
     TString histNames;
@@ -1034,6 +1068,8 @@ struct AnalysisDileptonTrack {
       if (fConfigFillCandidateTable.value) {
         dileptontrackcandidatesList.reserve(1);
       }
+      // the fit of the dilepton legs is the same for all the tracks, run it only once the first combination passes the kinematic cut
+      int procCodeDilepton = -1;
       for (auto& track : tracks) {
         auto trackMC = track.reducedMCTrack();
         int index = track.globalIndex();
@@ -1043,7 +1079,17 @@ struct AnalysisDileptonTrack {
           continue;
         }
 
-        VarManager::FillDileptonTrackVertexing<TCandidateType, TEventFillMap, TTrackFillMap>(event, lepton1, lepton2, track, fValuesTrack);
+        // two-stage evaluation: the cheap kinematic variables first, the vertexing only for the combinations passing the kinematic cut
+        if (fKinematicCut) {
+          VarManager::FillDileptonTrackKinematics<TCandidateType>(lepton1, lepton2, track, fValuesTrack);
+          if (!fKinematicCut->IsSelected(fValuesTrack)) {
+            continue;
+          }
+        }
+        if (procCodeDilepton < 0) {
+          procCodeDilepton = VarManager::FitDileptonLegs<TCandidateType, TTrackFillMap>(lepton1, lepton2);
+        }
+        VarManager::FillDileptonTrackVertexing<TCandidateType, TEventFillMap, TTrackFillMap>(event, lepton1, lepton2, track, fValuesTrack, procCodeDilepton);
         fHistMan->FillHistClass("DileptonTrackInvMass", fValuesTrack);
 
         mcDecision = 0;
@@ -1075,6 +1121,7 @@ struct AnalysisDileptonTrack {
     // loop over mc stack and fill histograms for pure MC truth signals
     // group all the MC tracks which belong to the MC event corresponding to the current reconstructed event
     // auto groupedMCTracks = tracksMC.sliceBy(aod::reducedtrackMC::reducedMCeventId, event.reducedMCevent().globalIndex());
+    fMCAncestry.Fill(groupedMCTracks);
     for (auto& mctrack : groupedMCTracks) {
       VarManager::FillTrack<gkParticleMCFillMap>(mctrack);
       // NOTE: Signals are checked here mostly based on the skimmed MC stack, so depending on the requested signal, the stack could be incomplete.
@@ -1084,7 +1131,7 @@ struct AnalysisDileptonTrack {
         if (sig.GetNProngs() != 1) { // NOTE: 1-prong signals required
           continue;
         }
-        if (sig.CheckSignal(false, groupedMCTracks, mctrack)) {
+        if (sig.CheckSignalFromAncestry(false, fMCAncestry, groupedMCTracks, mctrack)) {
           fHistMan->FillHistClass(Form("MCTruthGen_%s", sig.GetName()), VarManager::fgValues);
         }
       }
@@ -1127,6 +1174,22 @@ WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
     adaptAnalysisTask<AnalysisDileptonTrack>(cfgc)};
 }
 
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames)
+{
+  //
+  // Resolve once the handles of the histogram classes, to avoid string lookups in the pairing loops
+  //
+  std::vector<std::vector<int>> handles;
+  for (auto const& names : histNames) {
+    std::vector<int> cutHandles;
+    for (auto const& name : names) {
+      cutHandles.push_back(histMan->GetHistClassHandle(name.Data()));
+    }
+    handles.push_back(cutHandles);
+  }
+  return handles;
+}
+
 void DefineHistograms(HistogramManager* histMan, TString histClasses)
 {
   //
@@ -39,6 +39,7 @@
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/Centrality.h"
+#include "Common/DataModel/Qvectors.h"
 #include <TH1F.h>
 #include <THashList.h>
 #include <TString.h>
@@ -71,6 +72,7 @@ using MyTracks = soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>>;
 
 using MyEvents = soa::Join<aod::Collisions, aod::EvSels>;
 using MyEventsWithCent = soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>;
+using MyEventsWithCentQvectors = soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms, aod::QvectorsGFW>;
 
 using MyMuons = aod::FwdTracks;
 using MyMuonsWithCov = soa::Join<aod::FwdTracks, aod::FwdTracksCov>;
@@ -285,6 +287,13 @@ struct AnalysisQvector {
     //      FillFC(corrconfigs.at(l_ind), collision.centRun2V0M(), l_Random, fillFlag, DQEventFlag);
     //    };
 
+    fillQvector(collision, tracks1.size() > 0);
+  }
+
+  // Fill the Q vector quantities and the reduced event table from the Q vectors in the GFW regions
+  template <typename TEvent>
+  void fillQvector(TEvent const& collision, bool hasTracks)
+  {
     int nentriesN = 0.0;
     int nentriesP = 0.0;
     int nentriesFull = 0.0;
@@ -295,7 +304,7 @@ struct AnalysisQvector {
     TComplex Q3vecP;
     TComplex Q3vecFull;
 
-    if (fGFW && (tracks1.size() > 0)) {
+    if (fGFW && hasTracks) {
       // Obtain the GFWCumulant where Q is calculated (index=region, with different eta gaps)
       GFWCumulant gfwCumN = fGFW->GetCumulant(0);
       GFWCumulant gfwCumP = fGFW->GetCumulant(1);
@@ -319,7 +328,7 @@ struct AnalysisQvector {
     VarManager::FillQVectorFromGFW(collision, Q2vecFull, Q2vecN, Q2vecP, Q3vecFull, Q3vecN, Q3vecP, nentriesFull, nentriesN, nentriesP);
 
     if (fConfigQA) {
-      if ((tracks1.size() > 0) && (nentriesFull * nentriesN * nentriesP != 0.0)) {
+      if (hasTracks && (nentriesFull * nentriesN * nentriesP != 0.0)) {
         fHistMan->FillHistClass("Event_BeforeCuts", VarManager::fgValues);
         if (fEventCut->IsSelected(VarManager::fgValues)) {
           fHistMan->FillHistClass("Event_AfterCuts", VarManager::fgValues);
@@ -339,6 +348,22 @@ struct AnalysisQvector {
     runFillQvector<gkEventFillMap, gkTrackFillMap>(collisions, bcs, tracks);
   }
 
+  // Process to fill Q vector in a reduced event table from the Q vectors of the qvectors-gfw-table producer,
+  // which must be configured with the same track selection, eta regions and powers as this task
+  void processBarrelQvectorFromTable(MyEventsWithCentQvectors::iterator const& collision, aod::BCs const&)
+  {
+    VarManager::ResetValues(0, VarManager::kNVars);
+    VarManager::FillEvent<gkEventFillMap>(collision);
+    if (!fGFW->SetQvectors(collision.qvecRe(), collision.qvecIm(), collision.qvecNEntries())) {
+      LOGF(fatal, "The Q vectors of the qvectors-gfw-table do not match the GFW regions of this task");
+    }
+    int nTracks = 0;
+    for (auto n : collision.qvecNEntries()) {
+      nTracks += n;
+    }
+    fillQvector(collision, nTracks > 0);
+  }
+
   // TODO: dummy function for the case when no process function is enabled
   void processDummy(MyEvents&)
   {
@@ -346,6 +371,7 @@ struct AnalysisQvector {
   }
 
   PROCESS_SWITCH(AnalysisQvector, processBarrelQvector, "Run q-vector task on barrel tracks", false);
+  PROCESS_SWITCH(AnalysisQvector, processBarrelQvectorFromTable, "Run q-vector task on the Q vectors of the qvectors-gfw-table", false);
   PROCESS_SWITCH(AnalysisQvector, processDummy, "Dummy function", false);
 };
 
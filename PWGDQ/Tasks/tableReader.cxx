@@ -13,6 +13,7 @@
 //
 #include <iostream>
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <TH1F.h>
 #include <THashList.h>
@@ -26,8 +27,10 @@
 #include "PWGDQ/Core/VarManager.h"
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/MixingHandler.h"
+#include "PWGDQ/Core/MixingPool.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include "PWGDQ/Core/AnalysisCutEvaluator.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MixingLibrary.h"
@@ -99,6 +102,8 @@ constexpr static int pairTypeEMu = VarManager::kElectronMuon;
 
 // Global function used to define needed histogram classes
 void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurable<std::string> configVar); // defines histograms for all tasks
+// Global function used to get the handles of the pair histogram classes (PM, PP, MM) defined for each cut
+std::vector<std::array<int, 3>> GetPairHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames);
 
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
@@ -113,6 +118,8 @@ struct AnalysisEventSelection {
   HistogramManager* fHistMan = nullptr;
   MixingHandler* fMixHandler = nullptr;
   AnalysisCompositeCut* fEventCut;
+  int fHistClassBeforeCuts = HistogramManager::kNothing;
+  int fHistClassAfterCuts = HistogramManager::kNothing;
 
   void init(o2::framework::InitContext&)
   {
@@ -129,6 +136,8 @@ struct AnalysisEventSelection {
       DefineHistograms(fHistMan, "Event_BeforeCuts;Event_AfterCuts;", fConfigAddEventHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                                           // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistClassBeforeCuts = fHistMan->GetHistClassHandle("Event_BeforeCuts");
+      fHistClassAfterCuts = fHistMan->GetHistClassHandle("Event_AfterCuts");
     }
 
     TString mixVarsString = fConfigMixingVariables.value;
@@ -151,11 +160,11 @@ struct AnalysisEventSelection {
     VarManager::FillEvent<TEventFillMap>(event);
     // TODO: make this condition at compile time
     if (fConfigQA) {
-      fHistMan->FillHistClass("Event_BeforeCuts", VarManager::fgValues); // automatically fill all the histograms in the class Event
+      fHistMan->FillHistClass(fHistClassBeforeCuts, VarManager::fgValues); // automatically fill all the histograms in the class Event
     }
     if (fEventCut->IsSelected(VarManager::fgValues)) {
       if (fConfigQA) {
-        fHistMan->FillHistClass("Event_AfterCuts", VarManager::fgValues);
+        fHistMan->FillHistClass(fHistClassAfterCuts, VarManager::fgValues);
       }
       eventSel(1);
     } else {
@@ -195,6 +204,11 @@ struct AnalysisTrackSelection {
 
   HistogramManager* fHistMan;
   std::vector<AnalysisCompositeCut> fTrackCuts;
+  AnalysisCutEvaluator fCutEvaluator; // all the cuts compiled into one evaluator
+  std::vector<float> fCutRows;        // compact cut variables of all the tracks in a data frame
+  std::vector<uint32_t> fCutDecisions;
+  int fHistClassBeforeCuts = HistogramManager::kNothing;
+  std::vector<int> fHistClassCuts; // histogram class handles of each cut
 
   void init(o2::framework::InitContext&)
   {
@@ -205,6 +219,7 @@ struct AnalysisTrackSelection {
         fTrackCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
       }
     }
+    fCutEvaluator.Compile(fTrackCuts);
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
 
     if (fConfigQA) {
@@ -222,6 +237,10 @@ struct AnalysisTrackSelection {
       DefineHistograms(fHistMan, histDirNames.Data(), fConfigAddTrackHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                           // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistClassBeforeCuts = fHistMan->GetHistClassHandle("TrackBarrel_BeforeCuts");
+      for (auto& cut : fTrackCuts) {
+        fHistClassCuts.push_back(fHistMan->GetHistClassHandle(Form("TrackBarrel_%s", cut.GetName())));
+      }
     }
   }
 
@@ -233,23 +252,33 @@ struct AnalysisTrackSelection {
     VarManager::FillEvent<TEventFillMap>(event);
 
     trackSel.reserve(tracks.size());
-    uint32_t filterMap = 0;
-    int iCut = 0;
 
+    if (!fConfigQA) {
+      // fill the cut variables of all the tracks and evaluate all the cuts at once
+      const int nCutVars = fCutEvaluator.GetNVars();
+      fCutRows.resize(tracks.size() * nCutVars);
+      fCutDecisions.resize(tracks.size());
+      int iRow = 0;
+      for (auto& track : tracks) {
+        VarManager::FillTrack<TTrackFillMap>(track);
+        fCutEvaluator.PackValues(VarManager::fgValues, fCutRows.data() + nCutVars * iRow++);
+      }
+      fCutEvaluator.Evaluate(fCutRows.data(), tracks.size(), fCutDecisions.data());
+      for (auto filterMap : fCutDecisions) {
+        trackSel(static_cast<int>(filterMap));
+      }
+      return;
+    }
+
+    uint32_t filterMap = 0;
     for (auto& track : tracks) {
-      filterMap = 0;
       VarManager::FillTrack<TTrackFillMap>(track);
-      if (fConfigQA) { // TODO: make this compile time
-        fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
-      }
+      fHistMan->FillHistClass(fHistClassBeforeCuts, VarManager::fgValues);
 
-      iCut = 0;
-      for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, iCut++) {
-        if ((*cut).IsSelected(VarManager::fgValues)) {
-          filterMap |= (uint32_t(1) << iCut);
-          if (fConfigQA) { // TODO: make this compile time
-            fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
-          }
+      filterMap = fCutEvaluator.Evaluate(VarManager::fgValues);
+      for (unsigned int iCut = 0; iCut < fTrackCuts.size(); iCut++) {
+        if (filterMap & (uint32_t(1) << iCut)) {
+          fHistMan->FillHistClass(fHistClassCuts[iCut], VarManager::fgValues);
         }
       }
       trackSel(static_cast<int>(filterMap));
@@ -278,6 +307,11 @@ struct AnalysisMuonSelection {
 
   HistogramManager* fHistMan;
   std::vector<AnalysisCompositeCut> fMuonCuts;
+  AnalysisCutEvaluator fCutEvaluator; // all the cuts compiled into one evaluator
+  std::vector<float> fCutRows;        // compact cut variables of all the muons in a data frame
+  std::vector<uint32_t> fCutDecisions;
+  int fHistClassBeforeCuts = HistogramManager::kNothing;
+  std::vector<int> fHistClassCuts; // histogram class handles of each cut
 
   void init(o2::framework::InitContext&)
   {
@@ -288,6 +322,7 @@ struct AnalysisMuonSelection {
         fMuonCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
       }
     }
+    fCutEvaluator.Compile(fMuonCuts);
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
 
     if (fConfigQA) {
@@ -305,6 +340,10 @@ struct AnalysisMuonSelection {
       DefineHistograms(fHistMan, histDirNames.Data(), fConfigAddMuonHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                          // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistClassBeforeCuts = fHistMan->GetHistClassHandle("TrackMuon_BeforeCuts");
+      for (auto& cut : fMuonCuts) {
+        fHistClassCuts.push_back(fHistMan->GetHistClassHandle(Form("TrackMuon_%s", cut.GetName())));
+      }
     }
   }
 
@@ -315,23 +354,33 @@ struct AnalysisMuonSelection {
     VarManager::FillEvent<TEventFillMap>(event);
 
     muonSel.reserve(muons.size());
-    uint32_t filterMap = 0;
-    int iCut = 0;
 
+    if (!fConfigQA) {
+      // fill the cut variables of all the muons and evaluate all the cuts at once
+      const int nCutVars = fCutEvaluator.GetNVars();
+      fCutRows.resize(muons.size() * nCutVars);
+      fCutDecisions.resize(muons.size());
+      int iRow = 0;
+      for (auto& muon : muons) {
+        VarManager::FillTrack<TMuonFillMap>(muon);
+        fCutEvaluator.PackValues(VarManager::fgValues, fCutRows.data() + nCutVars * iRow++);
+      }
+      fCutEvaluator.Evaluate(fCutRows.data(), muons.size(), fCutDecisions.data());
+      for (auto filterMap : fCutDecisions) {
+        muonSel(static_cast<int>(filterMap));
+      }
+      return;
+    }
+
+    uint32_t filterMap = 0;
     for (auto& muon : muons) {
-      filterMap = 0;
       VarManager::FillTrack<TMuonFillMap>(muon);
-      if (fConfigQA) { // TODO: make this compile time
-        fHistMan->FillHistClass("TrackMuon_BeforeCuts", VarManager::fgValues);
-      }
+      fHistMan->FillHistClass(fHistClassBeforeCuts, VarManager::fgValues);
 
-      iCut = 0;
-      for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, iCut++) {
-        if ((*cut).IsSelected(VarManager::fgValues)) {
-          filterMap |= (uint32_t(1) << iCut);
-          if (fConfigQA) { // TODO: make this compile time
-            fHistMan->FillHistClass(Form("TrackMuon_%s", (*cut).GetName()), VarManager::fgValues);
-          }
+      filterMap = fCutEvaluator.Evaluate(VarManager::fgValues);
+      for (unsigned int iCut = 0; iCut < fMuonCuts.size(); iCut++) {
+        if (filterMap & (uint32_t(1) << iCut)) {
+          fHistMan->FillHistClass(fHistClassCuts[iCut], VarManager::fgValues);
         }
       }
       muonSel(static_cast<int>(filterMap));
@@ -359,7 +408,7 @@ struct AnalysisEventMixing {
   // TODO: Create a configurable to specify exactly on which of the bits one should run the event mixing
   Configurable<string> fConfigTrackCuts{"cfgTrackCuts", "", "Comma separated list of barrel track cuts"};
   Configurable<string> fConfigMuonCuts{"cfgMuonCuts", "", "Comma separated list of muon cuts"};
-  Configurable<int> fConfigMixingDepth{"cfgMixingDepth", 100, "Number of Events stored for event mixing"};
+  Configurable<int> fConfigMixingDepth{"cfgMixingDepth", 100, "Number of events stored per mixing category, kept across dataframes"};
   Configurable<std::string> fConfigAddEventMixingHistogram{"cfgAddEventMixingHistogram", "", "Comma separated list of histograms"};
 
   Filter filterEventSelected = aod::dqanalysisflags::isEventSelected == 1;
@@ -373,8 +422,18 @@ struct AnalysisEventMixing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  std::vector<std::array<int, 3>> fTrackHistHandles;
+  std::vector<std::array<int, 3>> fMuonHistHandles;
+  std::vector<std::array<int, 3>> fTrackMuonHistHandles;
+
+  // Pools of events kept across dataframes, one per process function since they store different candidates
+  MixingPool fBarrelPool;
+  MixingPool fMuonPool;
+  MixingPool fBarrelMuonPool;
+  MixingPool::Event fCurrentEvent; // compact copy of the candidates of the event being mixed
 
-  NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
+  Preslice<MyBarrelTracksSelected> perEventTracks = aod::reducedtrack::reducedeventId;
+  Preslice<MyMuonTracksSelected> perEventMuons = aod::reducedmuon::reducedeventId;
 
   void init(o2::framework::InitContext& context)
   {
@@ -439,36 +498,34 @@ struct AnalysisEventMixing {
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddEventMixingHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                              // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+    fTrackHistHandles = GetPairHistClassHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetPairHistClassHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetPairHistClassHandles(fHistMan, fTrackMuonHistNames);
+
+    fBarrelPool.SetDepth(fConfigMixingDepth.value);
+    fMuonPool.SetDepth(fConfigMixingDepth.value);
+    fBarrelMuonPool.SetDepth(fConfigMixingDepth.value);
   }
 
-  template <int TPairType, typename TTracks1, typename TTracks2>
-  void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
+  template <int TPairType>
+  void runMixedPairing(std::vector<MixingTrack> const& tracks1, std::vector<MixingTrack> const& tracks2)
   {
 
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    std::vector<std::array<int, 3>> const* histHandles = &fTrackHistHandles;
+    uint32_t filterMask = fTwoTrackFilterMask;
     if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+      histHandles = &fMuonHistHandles;
+      filterMask = fTwoMuonFilterMask;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+      histHandles = &fTrackMuonHistHandles;
     }
+    unsigned int ncuts = histHandles->size();
 
     uint32_t twoTrackFilter = 0;
     for (auto& track1 : tracks1) {
       for (auto& track2 : tracks2) {
-        if constexpr (TPairType == VarManager::kDecayToEE) {
-          twoTrackFilter = uint32_t(track1.isBarrelSelected()) & uint32_t(track2.isBarrelSelected()) & fTwoTrackFilterMask;
-        }
-        if constexpr (TPairType == VarManager::kDecayToMuMu) {
-          twoTrackFilter = uint32_t(track1.isMuonSelected()) & uint32_t(track2.isMuonSelected()) & fTwoMuonFilterMask;
-        }
-        if constexpr (TPairType == VarManager::kElectronMuon) {
-          twoTrackFilter = uint32_t(track1.isBarrelSelected()) & uint32_t(track2.isMuonSelected()) & fTwoTrackFilterMask;
-        }
-
+        twoTrackFilter = track1.fFilter & track2.fFilter & filterMask;
         if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
           continue;
         }
@@ -482,12 +539,12 @@ struct AnalysisEventMixing {
         for (unsigned int icut = 0; icut < ncuts; icut++) {
           if (twoTrackFilter & (uint32_t(1) << icut)) {
             if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][0], VarManager::fgValues);
             } else {
               if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass((*histHandles)[icut][1], VarManager::fgValues);
               } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass((*histHandles)[icut][2], VarManager::fgValues);
               }
             }
           } // end if (filter bits)
@@ -497,71 +554,62 @@ struct AnalysisEventMixing {
   }
 
   // barrel-barrel and muon-muon event mixing
+  // Each event is paired with the events of the same category stored in the pool, and then added to the pool
   template <int TPairType, uint32_t TEventFillMap, typename TEvents, typename TTracks>
-  void runSameSide(TEvents& events, TTracks const& tracks)
+  void runSameSide(TEvents const& events, TTracks const& tracks)
   {
-    events.bindExternalIndices(&tracks);
-    auto tracksTuple = std::make_tuple(tracks);
-    int mixingDepth = fConfigMixingDepth.value;
-    GroupSlicer slicerTracks(events, tracksTuple);
-    for (auto& [event1, event2] : selfCombinations(hashBin, mixingDepth, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
-      auto it1 = slicerTracks.begin();
-      for (auto& slice : slicerTracks) {
-        if (slice.groupingElement().index() == event1.index()) {
-          it1 = slice;
-          break;
-        }
+    MixingPool& pool = (TPairType == pairTypeMuMu ? fMuonPool : fBarrelPool);
+    std::vector<MixingTrack>& currentTracks = (TPairType == pairTypeMuMu ? fCurrentEvent.fMuons : fCurrentEvent.fTracks);
+    for (auto& event : events) {
+      int category = event.mixingHash();
+      if (category < 0) { // event outside the mixing categories
+        continue;
       }
-      auto tracks1 = std::get<TTracks>(it1.associatedTables());
-      tracks1.bindExternalIndices(&events);
-      auto it2 = slicerTracks.begin();
-      for (auto& slice : slicerTracks) {
-        if (slice.groupingElement().index() == event2.index()) {
-          it2 = slice;
-          break;
-        }
+      if constexpr (TPairType == pairTypeMuMu) {
+        auto groupedMuons = tracks.sliceBy(perEventMuons, event.globalIndex());
+        MixingPool::Fill(groupedMuons, currentTracks, [](auto const& muon) { return uint32_t(muon.isMuonSelected()); });
+      } else {
+        auto groupedTracks = tracks.sliceBy(perEventTracks, event.globalIndex());
+        MixingPool::Fill(groupedTracks, currentTracks, [](auto const& track) { return uint32_t(track.isBarrelSelected()); });
+      }
+      if (currentTracks.empty()) { // events without candidates do not contribute to the mixing
+        continue;
       }
-      auto tracks2 = std::get<TTracks>(it2.associatedTables());
-      tracks2.bindExternalIndices(&events);
 
-      runMixedPairing<TPairType>(tracks1, tracks2);
+      VarManager::ResetValues(0, VarManager::kNVars);
+      VarManager::FillEvent<TEventFillMap>(event, VarManager::fgValues);
+      pool.ForEach(category, [&](MixingPool::Event const& storedEvent) {
+        runMixedPairing<TPairType>(currentTracks, (TPairType == pairTypeMuMu ? storedEvent.fMuons : storedEvent.fTracks));
+      });
+      pool.Add(category, fCurrentEvent);
     } // end event loop
   }
 
   // barrel-muon event mixing
   template <uint32_t TEventFillMap, typename TEvents, typename TTracks, typename TMuons>
-  void runBarrelMuon(TEvents& events, TTracks const& tracks, TMuons const& muons)
-  {
-    events.bindExternalIndices(&muons);
-    auto tracksTuple = std::make_tuple(tracks);
-    auto muonsTuple = std::make_tuple(muons);
-    GroupSlicer slicerTracks(events, tracksTuple);
-    GroupSlicer slicerMuons(events, muonsTuple);
-    for (auto& [event1, event2] : selfCombinations(hashBin, 100, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
-      auto it1 = slicerTracks.begin();
-      for (auto& slice : slicerTracks) {
-        if (slice.groupingElement().index() == event1.index()) {
-          it1 = slice;
-          break;
-        }
+  void runBarrelMuon(TEvents const& events, TTracks const& tracks, TMuons const& muons)
+  {
+    for (auto& event : events) {
+      int category = event.mixingHash();
+      if (category < 0) { // event outside the mixing categories
+        continue;
       }
-      auto tracks1 = std::get<TTracks>(it1.associatedTables());
-      tracks1.bindExternalIndices(&events);
-      auto it2 = slicerMuons.begin();
-      for (auto& slice : slicerMuons) {
-        if (slice.groupingElement().index() == event2.index()) {
-          it2 = slice;
-          break;
-        }
+      auto groupedTracks = tracks.sliceBy(perEventTracks, event.globalIndex());
+      MixingPool::Fill(groupedTracks, fCurrentEvent.fTracks, [](auto const& track) { return uint32_t(track.isBarrelSelected()); });
+      auto groupedMuons = muons.sliceBy(perEventMuons, event.globalIndex());
+      MixingPool::Fill(groupedMuons, fCurrentEvent.fMuons, [](auto const& muon) { return uint32_t(muon.isMuonSelected()); });
+      if (fCurrentEvent.IsEmpty()) { // events without candidates do not contribute to the mixing
+        continue;
       }
-      auto muons2 = std::get<TMuons>(it2.associatedTables());
-      muons2.bindExternalIndices(&events);
 
-      runMixedPairing<pairTypeEMu>(tracks1, muons2);
+      VarManager::ResetValues(0, VarManager::kNVars);
+      VarManager::FillEvent<TEventFillMap>(event, VarManager::fgValues);
+      // the barrel candidates of each event are mixed with the muons of the other one
+      fBarrelMuonPool.ForEach(category, [&](MixingPool::Event const& storedEvent) {
+        runMixedPairing<pairTypeEMu>(fCurrentEvent.fTracks, storedEvent.fMuons);
+        runMixedPairing<pairTypeEMu>(storedEvent.fTracks, fCurrentEvent.fMuons);
+      });
+      fBarrelMuonPool.Add(category, fCurrentEvent);
     } // end event loop
   }
 
@@ -629,6 +677,9 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  std::vector<std::array<int, 3>> fTrackHistHandles;
+  std::vector<std::array<int, 3>> fMuonHistHandles;
+  std::vector<std::array<int, 3>> fTrackMuonHistHandles;
 
   void init(o2::framework::InitContext& context)
   {
@@ -698,7 +749,16 @@ struct AnalysisSameEventPairing {
 
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                      // provide the list of required variables so that VarManager knows what to fill
+    // the vertexing variables written in the dimuon tables are needed even if not used in histograms
+    if (context.mOptions.get<bool>("processDecayToMuMuVertexingSkimmed")) {
+      VarManager::SetUseVariable(VarManager::kVertexingTauz);
+      VarManager::SetUseVariable(VarManager::kVertexingLz);
+      VarManager::SetUseVariable(VarManager::kVertexingLxy);
+    }
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+    fTrackHistHandles = GetPairHistClassHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetPairHistClassHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetPairHistClassHandles(fHistMan, fTrackMuonHistNames);
 
     VarManager::SetupTwoProngDCAFitter(5.0f, true, 200.0f, 4.0f, 1.0e-3f, 0.9f, true); // TODO: get these parameters from Configurables
     VarManager::SetupTwoProngFwdDCAFitter(5.0f, true, 200.0f, 1.0e-3f, 0.9f, true);
@@ -709,16 +769,14 @@ struct AnalysisSameEventPairing {
   void runSameEventPairing(TEvent const& event, TTracks1 const& tracks1, TTracks2 const& tracks2)
   {
 
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    std::vector<std::array<int, 3>> const* histHandles = &fTrackHistHandles;
     if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+      histHandles = &fMuonHistHandles;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+      histHandles = &fTrackMuonHistHandles;
     }
+    unsigned int ncuts = histHandles->size();
 
     uint32_t twoTrackFilter = 0;
     uint32_t dileptonFilterMap = 0;
@@ -765,12 +823,12 @@ struct AnalysisSameEventPairing {
       for (unsigned int icut = 0; icut < ncuts; icut++) {
         if (twoTrackFilter & (uint32_t(1) << icut)) {
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass((*histHandles)[icut][0], VarManager::fgValues);
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][1], VarManager::fgValues);
             } else {
-              fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][2], VarManager::fgValues);
             }
           }
         } // end if (filter bits)
@@ -871,6 +929,9 @@ struct AnalysisDileptonHadron {
   float* fValuesDilepton;
   float* fValuesHadron;
   HistogramManager* fHistMan;
+  int fHistClassDileptons = HistogramManager::kNothing;
+  int fHistClassInvMass = HistogramManager::kNothing;
+  int fHistClassCorrelation = HistogramManager::kNothing;
 
   // NOTE: the barrel track filter is shared between the filters for dilepton electron candidates (first n-bits)
   //       and the associated hadrons (n+1 bit) --> see the barrel track selection task
@@ -892,6 +953,9 @@ struct AnalysisDileptonHadron {
       DefineHistograms(fHistMan, "DileptonsSelected;DileptonHadronInvMass;DileptonHadronCorrelation", fConfigAddDileptonHadHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistClassDileptons = fHistMan->GetHistClassHandle("DileptonsSelected");
+      fHistClassInvMass = fHistMan->GetHistClassHandle("DileptonHadronInvMass");
+      fHistClassCorrelation = fHistMan->GetHistClassHandle("DileptonHadronCorrelation");
     }
 
     TString configCutNamesStr = fConfigTrackCuts.value;
@@ -915,7 +979,7 @@ struct AnalysisDileptonHadron {
     // loop once over dileptons for QA purposes
     for (auto dilepton : dileptons) {
       VarManager::FillTrack<fgDileptonFillMap>(dilepton, fValuesDilepton);
-      fHistMan->FillHistClass("DileptonsSelected", fValuesDilepton);
+      fHistMan->FillHistClass(fHistClassDileptons, fValuesDilepton);
       // loop over hadrons
       for (auto& hadron : tracks) {
         // TODO: Replace this with a Filter expression
@@ -924,8 +988,8 @@ struct AnalysisDileptonHadron {
         }
         // TODO: Check whether this hadron is one of the dilepton daughters!
         VarManager::FillDileptonHadron(dilepton, hadron, fValuesHadron);
-        fHistMan->FillHistClass("DileptonHadronInvMass", fValuesHadron);
-        fHistMan->FillHistClass("DileptonHadronCorrelation", fValuesHadron);
+        fHistMan->FillHistClass(fHistClassInvMass, fValuesHadron);
+        fHistMan->FillHistClass(fHistClassCorrelation, fValuesHadron);
       }
     }
   }
@@ -955,6 +1019,18 @@ WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
     adaptAnalysisTask<AnalysisDileptonHadron>(cfgc)};
 }
 
+std::vector<std::array<int, 3>> GetPairHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames)
+{
+  //
+  // Resolve once the handles of the pair histogram classes, to avoid string lookups in the pairing loops
+  //
+  std::vector<std::array<int, 3>> handles;
+  for (auto const& names : histNames) {
+    handles.push_back({histMan->GetHistClassHandle(names[0].Data()), histMan->GetHistClassHandle(names[1].Data()), histMan->GetHistClassHandle(names[2].Data())});
+  }
+  return handles;
+}
+
 void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurable<std::string> configVar)
 {
   //
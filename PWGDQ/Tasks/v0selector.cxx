@@ -18,7 +18,7 @@
 //    Please write to: daiki.sekihata@cern.ch
 //
 #include <array>
-#include <map>
+#include <vector>
 #include "Math/Vector4D.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -26,6 +26,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/TwoProngPrecheck.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -273,11 +274,17 @@ struct v0selector {
   Configurable<std::string> lutPath{"lutPath", "GLO/Param/MatLUT", "Path for LUT parametrization"};
   Configurable<std::string> geoPath{"geoPath", "GLO/Config/GeometryAligned", "Path of the geometry file"};
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
+  Configurable<float> precheckMaxDZ{"precheckMaxDZ", 10., "max z distance (cm) of the daughters at their crossing in xy to run the fitter (0: no z requirement, < 0: no analytic pre-check)"};
 
   int mRunNumber;
   float d_bz;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
+  o2::vertexing::DCAFitterN<2> fitter;     // V0 vertexing, for the V0s and the V0s of the cascades
+  o2::vertexing::DCAFitterN<2> fitterCasc; // cascade vertexing
+  std::vector<uint8_t> pidmap;             // PID bits of the tracks of the dataframe
+  o2::analysis::TwoProngPrecheck precheck; // analytic pre-check of the V0 legs before the fitter
+
   void init(InitContext& context)
   {
     mRunNumber = 0;
@@ -289,6 +296,19 @@ struct v0selector {
     if (!o2::base::GeometryManager::isGeometryLoaded()) {
       ccdb->get<TGeoManager>(geoPath);
     }
+
+    // configure the fitters once, only the magnetic field is updated when the run changes
+    for (auto* dcaFitter : {&fitter, &fitterCasc}) {
+      dcaFitter->setPropagateToPCA(true);
+      dcaFitter->setMaxR(200.);
+      dcaFitter->setMinParamChange(1e-3);
+      dcaFitter->setMinRelChi2Change(0.9);
+      dcaFitter->setMaxDZIni(1e9);
+      dcaFitter->setMaxChi2(1e9);
+      dcaFitter->setUseAbsDCA(true); // use d_UseAbsDCA once we want to use the weighted DCA
+    }
+    precheck.setEnabled(precheckMaxDZ >= 0.f);
+    precheck.setMaxDZ(precheckMaxDZ);
   }
 
   float getMagneticField(uint64_t timestamp)
@@ -317,85 +337,319 @@ struct v0selector {
       } else {
         d_bz = d_bz_input;
       }
+      fitter.setBz(d_bz); // in kG
+      fitterCasc.setBz(d_bz);
+      precheck.setBz(d_bz);
       mRunNumber = lRunNumber;
     }
   }
 
-  void process(aod::Collisions const&, aod::BCsWithTimestamps const&, FullTracksExt const& tracks, aod::V0s const& V0s, aod::Cascades const& Cascades)
+  /// Quality selection of the daughters of a V0 (from the V0s or from the V0Datas table)
+  template <typename TV0>
+  bool isSelectedV0Legs(TV0 const& V0)
   {
-    registry.fill(HIST("hEventCounter"), 0.5);
+    // if (!(V0.posTrack_as<FullTracksExt>().trackType() & o2::aod::track::TPCrefit)) {
+    //   return false;
+    // }
+    // if (!(V0.negTrack_as<FullTracksExt>().trackType() & o2::aod::track::TPCrefit)) {
+    //   return false;
+    // }
+
+    if (fabs(V0.template posTrack_as<FullTracksExt>().eta()) > 0.9) {
+      return false;
+    }
+    if (fabs(V0.template negTrack_as<FullTracksExt>().eta()) > 0.9) {
+      return false;
+    }
 
-    std::map<int, uint8_t> pidmap;
+    if (V0.template posTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
+    if (V0.template negTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
 
-    for (auto& V0 : V0s) {
-      // if (!(V0.posTrack_as<FullTracksExt>().trackType() & o2::aod::track::TPCrefit)) {
-      //   continue;
-      // }
-      // if (!(V0.negTrack_as<FullTracksExt>().trackType() & o2::aod::track::TPCrefit)) {
-      //   continue;
-      // }
+    if (V0.template posTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
+      return false;
+    }
+    if (V0.template negTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
+      return false;
+    }
 
-      // printf("V0.collisionId = %d , collision.globalIndex = %d\n",V0.collisionId(),collision.globalIndex());
+    if (fabs(V0.template posTrack_as<FullTracksExt>().dcaXY()) < dcamin) {
+      return false;
+    }
+    if (fabs(V0.template negTrack_as<FullTracksExt>().dcaXY()) < dcamin) {
+      return false;
+    }
 
-      if (fabs(V0.posTrack_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
-      if (fabs(V0.negTrack_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
+    if (fabs(V0.template posTrack_as<FullTracksExt>().dcaXY()) > dcamax) {
+      return false;
+    }
+    if (fabs(V0.template negTrack_as<FullTracksExt>().dcaXY()) > dcamax) {
+      return false;
+    }
 
-      if (V0.posTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
-      if (V0.negTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
+    if (V0.template posTrack_as<FullTracksExt>().sign() * V0.template negTrack_as<FullTracksExt>().sign() > 0) { // reject same sign pair
+      return false;
+    }
 
-      if (V0.posTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
-      if (V0.negTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
+    if (V0.template posTrack_as<FullTracksExt>().collisionId() != V0.template negTrack_as<FullTracksExt>().collisionId()) {
+      return false;
+    }
 
-      if (fabs(V0.posTrack_as<FullTracksExt>().dcaXY()) < dcamin) {
-        continue;
-      }
-      if (fabs(V0.negTrack_as<FullTracksExt>().dcaXY()) < dcamin) {
-        continue;
-      }
+    if (!V0.template posTrack_as<FullTracksExt>().has_collision() || !V0.template negTrack_as<FullTracksExt>().has_collision()) {
+      return false;
+    }
+    return true;
+  }
 
-      if (fabs(V0.posTrack_as<FullTracksExt>().dcaXY()) > dcamax) {
-        continue;
-      }
-      if (fabs(V0.negTrack_as<FullTracksExt>().dcaXY()) > dcamax) {
-        continue;
+  /// Topological and PID selection of a V0 once its vertex is known, filling the PID bits of its daughters
+  /// \param pVtx  primary vertex
+  /// \param pos  V0 decay vertex
+  /// \param pvec0,pvec1  momenta of the positive and negative daughters at the decay vertex
+  /// \param V0dca  squared distance between the daughters (chi2 at the PCA of the fitter)
+  template <typename TV0>
+  void selectV0(TV0 const& V0, const std::array<float, 3>& pVtx, const std::array<float, 3>& pos, const std::array<float, 3>& pvec0, const std::array<float, 3>& pvec1, float V0dca)
+  {
+    int cpos = V0.template posTrack_as<FullTracksExt>().sign();
+    int cneg = V0.template negTrack_as<FullTracksExt>().sign();
+
+    auto px = pvec0[0] + pvec1[0];
+    auto py = pvec0[1] + pvec1[1];
+    auto pz = pvec0[2] + pvec1[2];
+    auto pt = RecoDecay::sqrtSumOfSquares(pvec0[0] + pvec1[0], pvec0[1] + pvec1[1]);
+    auto eta = RecoDecay::eta(array{px, py, pz});
+    auto phi = RecoDecay::phi(px, py);
+
+    auto V0CosinePA = RecoDecay::cpa(pVtx, array{pos[0], pos[1], pos[2]}, array{px, py, pz});
+    auto V0radius = RecoDecay::sqrtSumOfSquares(pos[0], pos[1]);
+
+    registry.fill(HIST("hV0Pt"), pt);
+    registry.fill(HIST("hV0EtaPhi"), phi, eta);
+    registry.fill(HIST("hDCAxyPosToPV"), V0.template posTrack_as<FullTracksExt>().dcaXY());
+    registry.fill(HIST("hDCAxyNegToPV"), V0.template negTrack_as<FullTracksExt>().dcaXY());
+    registry.fill(HIST("hDCAzPosToPV"), V0.template posTrack_as<FullTracksExt>().dcaZ());
+    registry.fill(HIST("hDCAzNegToPV"), V0.template negTrack_as<FullTracksExt>().dcaZ());
+
+    registry.fill(HIST("hV0Radius"), V0radius);
+    registry.fill(HIST("hV0CosPA"), V0CosinePA);
+    registry.fill(HIST("hDCAV0Dau"), V0dca);
+
+    if (V0dca > dcav0dau) {
+      return;
+    }
+
+    if (V0CosinePA < v0cospa) {
+      return;
+    }
+
+    if (V0radius < v0Rmin || v0Rmax < V0radius) {
+      return;
+    }
+
+    float alpha = alphav0(pvec0, pvec1);
+    float qtarm = qtarmv0(pvec0, pvec1);
+    float phiv = phivv0(pvec0, pvec1, cpos, cneg, d_bz);
+    float psipair = psipairv0(pvec0, pvec1, d_bz);
+
+    registry.fill(HIST("hV0APplot"), alpha, qtarm);
+
+    float mGamma = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kElectron), RecoDecay::getMassPDG(kElectron)});
+    float mK0S = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kPiPlus)});
+    float mLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
+    float mAntiLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
+
+    int v0id = checkV0(pvec0, pvec1);
+    if (v0id < 0) {
+      // printf("This is not [Gamma/K0S/Lambda/AntiLambda] candidate.\n");
+      return;
+    }
+
+    if (v0id == kGamma) { // photon conversion
+      registry.fill(HIST("hMassGamma"), V0radius, mGamma);
+      registry.fill(HIST("hV0PhiV"), phiv, mGamma);
+      registry.fill(HIST("hV0Psi"), psipair, mGamma);
+      if (mGamma < v0max_mee && TMath::Abs(V0.template posTrack_as<FullTracksExt>().tpcNSigmaEl()) < 5 && TMath::Abs(V0.template negTrack_as<FullTracksExt>().tpcNSigmaEl()) < 5 && psipair < maxpsipair) {
+        pidmap[V0.posTrackId()] |= (uint8_t(1) << kGamma);
+        pidmap[V0.negTrackId()] |= (uint8_t(1) << kGamma);
+        registry.fill(HIST("hGammaRxy"), pos[0], pos[1]);
+        v0Gamma(V0.template negTrack_as<FullTracksExt>().collisionId(), pt, eta, phi, mGamma);
+      }
+    } else if (v0id == kK0S) { // K0S-> pi pi
+      registry.fill(HIST("hMassK0S"), V0radius, mK0S);
+      if ((0.48 < mK0S && mK0S < 0.51) && TMath::Abs(V0.template posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(V0.template negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+        pidmap[V0.posTrackId()] |= (uint8_t(1) << kK0S);
+        pidmap[V0.negTrackId()] |= (uint8_t(1) << kK0S);
+      }
+    } else if (v0id == kLambda) { // L->p + pi-
+      registry.fill(HIST("hMassLambda"), V0radius, mLambda);
+      if (v0id == kLambda && (1.110 < mLambda && mLambda < 1.120) && TMath::Abs(V0.template posTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5 && TMath::Abs(V0.template negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+        pidmap[V0.posTrackId()] |= (uint8_t(1) << kLambda);
+        pidmap[V0.negTrackId()] |= (uint8_t(1) << kLambda);
+      }
+    } else if (v0id == kAntiLambda) { // Lbar -> pbar + pi+
+      registry.fill(HIST("hMassAntiLambda"), V0radius, mAntiLambda);
+      if ((1.110 < mAntiLambda && mAntiLambda < 1.120) && TMath::Abs(V0.template posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(V0.template negTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5) {
+        pidmap[V0.posTrackId()] |= (uint8_t(1) << kAntiLambda);
+        pidmap[V0.negTrackId()] |= (uint8_t(1) << kAntiLambda);
       }
+    }
 
-      if (V0.posTrack_as<FullTracksExt>().sign() * V0.negTrack_as<FullTracksExt>().sign() > 0) { // reject same sign pair
-        continue;
+    // printf("posTrackId = %d\n",V0.posTrackId());
+    // printf("negTrackId = %d\n",V0.negTrackId());
+  }
+
+  /// Quality selection of the daughters of a cascade (from the Cascades or from the CascData table)
+  template <typename TCasc>
+  bool isSelectedCascLegs(TCasc const& casc)
+  {
+    auto v0 = casc.template v0_as<aod::V0s>();
+    if (v0.template posTrack_as<FullTracksExt>().sign() * v0.template negTrack_as<FullTracksExt>().sign() > 0) { // reject same sign pair
+      return false;
+    }
+    if (v0.template posTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
+    if (v0.template negTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
+    if (casc.template bachelor_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
+
+    if (v0.template posTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
+      return false;
+    }
+    if (v0.template negTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
+      return false;
+    }
+    if (casc.template bachelor_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
+      return false;
+    }
+
+    if (fabs(v0.template posTrack_as<FullTracksExt>().dcaXY()) < 0.05) {
+      return false;
+    }
+    if (fabs(v0.template negTrack_as<FullTracksExt>().dcaXY()) < 0.05) {
+      return false;
+    }
+    if (fabs(casc.template bachelor_as<FullTracksExt>().dcaXY()) < 0.05) {
+      return false;
+    }
+
+    if (fabs(v0.template posTrack_as<FullTracksExt>().dcaXY()) > 2.4) {
+      return false;
+    }
+    if (fabs(v0.template negTrack_as<FullTracksExt>().dcaXY()) > 2.4) {
+      return false;
+    }
+    if (fabs(casc.template bachelor_as<FullTracksExt>().dcaXY()) > 2.4) {
+      return false;
+    }
+
+    if (fabs(v0.template posTrack_as<FullTracksExt>().eta()) > 0.9) {
+      return false;
+    }
+    if (fabs(v0.template negTrack_as<FullTracksExt>().eta()) > 0.9) {
+      return false;
+    }
+    if (fabs(casc.template bachelor_as<FullTracksExt>().eta()) > 0.9) {
+      return false;
+    }
+
+    if (v0.collisionId() != casc.collisionId()) {
+      return false;
+    }
+
+    if (!v0.template posTrack_as<FullTracksExt>().has_collision() || !v0.template negTrack_as<FullTracksExt>().has_collision() || !casc.template bachelor_as<FullTracksExt>().has_collision()) {
+      return false;
+    }
+
+    if (casc.collisionId() != casc.template bachelor_as<FullTracksExt>().collision().globalIndex()) {
+      return false;
+    }
+    return true;
+  }
+
+  /// Mass and PID selection of an Omega candidate, filling the PID bit of the bachelor
+  /// \param v0id  kLambda or kAntiLambda
+  /// \param pvecpos,pvecneg,pvecbach  momenta of the positive, negative and bachelor daughters at the decay vertices
+  template <typename TCasc>
+  void selectCascade(TCasc const& casc, int v0id, const std::array<float, 3>& pvecpos, const std::array<float, 3>& pvecneg, const std::array<float, 3>& pvecv0, const std::array<float, 3>& pvecbach)
+  {
+    float mLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
+    float mAntiLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
+    float mXi = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG(kLambda0), RecoDecay::getMassPDG(kPiPlus)});
+    float mOmega = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG(kLambda0), RecoDecay::getMassPDG(kKPlus)});
+
+    // for Lambda->p + pi-
+    if (v0id == kLambda) {
+      registry.fill(HIST("hMassLambda_Casc"), mLambda);
+      if ((1.110 < mLambda && mLambda < 1.120) && TMath::Abs(casc.template v0_as<aod::V0s>().template posTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5 && TMath::Abs(casc.template v0_as<aod::V0s>().template negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+        if (casc.template bachelor_as<FullTracksExt>().sign() < 0) {
+          if (TMath::Abs(casc.template bachelor_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+            registry.fill(HIST("hMassXiMinus"), mXi);
+          }
+
+          if (TMath::Abs(mXi - 1.321) > 0.006) {
+            if (TMath::Abs(casc.template bachelor_as<FullTracksExt>().tpcNSigmaKa()) < 5) {
+              registry.fill(HIST("hMassOmegaMinus"), mOmega);
+              if (TMath::Abs(mOmega - 1.672) < 0.006) {
+                pidmap[casc.bachelorId()] |= (uint8_t(1) << kOmega);
+              }
+            }
+          }
+        }
       }
+    }
 
-      if (V0.posTrack_as<FullTracksExt>().collisionId() != V0.negTrack_as<FullTracksExt>().collisionId()) {
-        continue;
+    // for AntiLambda->pbar + pi+
+    if (v0id == kAntiLambda) {
+      registry.fill(HIST("hMassAntiLambda_Casc"), mAntiLambda);
+      if ((1.110 < mAntiLambda && mAntiLambda < 1.120) && TMath::Abs(casc.template v0_as<aod::V0s>().template posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(casc.template v0_as<aod::V0s>().template negTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5) {
+        if (casc.template bachelor_as<FullTracksExt>().sign() > 0) {
+          if (TMath::Abs(casc.template bachelor_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+            registry.fill(HIST("hMassXiPlus"), mXi);
+          }
+          if (TMath::Abs(mXi - 1.321) > 0.006) {
+            if (TMath::Abs(casc.template bachelor_as<FullTracksExt>().tpcNSigmaKa()) < 5) {
+              registry.fill(HIST("hMassOmegaPlus"), mOmega);
+              if (TMath::Abs(mOmega - 1.672) < 0.006) {
+                pidmap[casc.bachelorId()] |= (uint8_t(1) << kOmega);
+              }
+            }
+          }
+        }
       }
+    }
+  }
+
+  /// Fills the PID bits of all the tracks of the dataframe
+  template <typename TTracks>
+  void fillV0Bits(TTracks const& tracks)
+  {
+    for (auto& track : tracks) {
+      // printf("setting pidmap[%lld] = %d\n",track.globalIndex(),pidmap[track.globalIndex()]);
+      v0bits(pidmap[track.globalIndex()]);
+    } // end of track loop
+  }
+
+  /// V0 and cascade vertices fitted here from the V0 and Cascade tables
+  void processFit(aod::Collisions const&, aod::BCsWithTimestamps const&, FullTracksExt const& tracks, aod::V0s const& V0s, aod::Cascades const& Cascades)
+  {
+    registry.fill(HIST("hEventCounter"), 0.5);
+
+    pidmap.assign(tracks.size(), 0);
 
-      if (!V0.posTrack_as<FullTracksExt>().has_collision() || !V0.negTrack_as<FullTracksExt>().has_collision()) {
+    for (auto& V0 : V0s) {
+      // printf("V0.collisionId = %d , collision.globalIndex = %d\n",V0.collisionId(),collision.globalIndex());
+      if (!isSelectedV0Legs(V0)) {
         continue;
       }
       auto const& collision = V0.posTrack_as<FullTracksExt>().collision();
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
       CheckAndUpdate(bc.runNumber(), bc.timestamp());
-      // Define o2 fitter, 2-prong
-      o2::vertexing::DCAFitterN<2> fitter;
-      fitter.setBz(d_bz); // in kG
-      fitter.setPropagateToPCA(true);
-      fitter.setMaxR(200.);
-      fitter.setMinParamChange(1e-3);
-      fitter.setMinRelChi2Change(0.9);
-      fitter.setMaxDZIni(1e9);
-      fitter.setMaxChi2(1e9);
-      fitter.setUseAbsDCA(true); // use d_UseAbsDCA once we want to use the weighted DCA
 
       if (V0.collisionId() != collision.globalIndex()) {
         continue;
@@ -408,7 +662,6 @@ struct v0selector {
       std::array<float, 3> pvec1 = {0.};
 
       int cpos = V0.posTrack_as<FullTracksExt>().sign();
-      int cneg = V0.negTrack_as<FullTracksExt>().sign();
 
       auto pTrack = getTrackParCov(V0.posTrack_as<FullTracksExt>());
       auto nTrack = getTrackParCov(V0.negTrack_as<FullTracksExt>());
@@ -418,7 +671,7 @@ struct v0selector {
         pTrack = getTrackParCov(V0.negTrack_as<FullTracksExt>());
       }
 
-      int nCand = fitter.process(pTrack, nTrack);
+      int nCand = precheck.process(fitter, pTrack, nTrack);
       if (nCand != 0) {
         fitter.propagateTracksToVertex();
         const auto& vtx = fitter.getPCACandidate();
@@ -431,186 +684,19 @@ struct v0selector {
         continue;
       }
 
-      auto px = pvec0[0] + pvec1[0];
-      auto py = pvec0[1] + pvec1[1];
-      auto pz = pvec0[2] + pvec1[2];
-      auto pt = RecoDecay::sqrtSumOfSquares(pvec0[0] + pvec1[0], pvec0[1] + pvec1[1]);
-      auto eta = RecoDecay::eta(array{px, py, pz});
-      auto phi = RecoDecay::phi(px, py);
-
-      auto V0dca = fitter.getChi2AtPCACandidate(); // distance between 2 legs.
-      auto V0CosinePA = RecoDecay::cpa(pVtx, array{pos[0], pos[1], pos[2]}, array{px, py, pz});
-      auto V0radius = RecoDecay::sqrtSumOfSquares(pos[0], pos[1]);
-
-      registry.fill(HIST("hV0Pt"), pt);
-      registry.fill(HIST("hV0EtaPhi"), phi, eta);
-      registry.fill(HIST("hDCAxyPosToPV"), V0.posTrack_as<FullTracksExt>().dcaXY());
-      registry.fill(HIST("hDCAxyNegToPV"), V0.negTrack_as<FullTracksExt>().dcaXY());
-      registry.fill(HIST("hDCAzPosToPV"), V0.posTrack_as<FullTracksExt>().dcaZ());
-      registry.fill(HIST("hDCAzNegToPV"), V0.negTrack_as<FullTracksExt>().dcaZ());
-
-      registry.fill(HIST("hV0Radius"), V0radius);
-      registry.fill(HIST("hV0CosPA"), V0CosinePA);
-      registry.fill(HIST("hDCAV0Dau"), V0dca);
-
-      if (V0dca > dcav0dau) {
-        continue;
-      }
-
-      if (V0CosinePA < v0cospa) {
-        continue;
-      }
-
-      if (V0radius < v0Rmin || v0Rmax < V0radius) {
-        continue;
-      }
-
-      float alpha = alphav0(pvec0, pvec1);
-      float qtarm = qtarmv0(pvec0, pvec1);
-      float phiv = phivv0(pvec0, pvec1, cpos, cneg, d_bz);
-      float psipair = psipairv0(pvec0, pvec1, d_bz);
-
-      registry.fill(HIST("hV0APplot"), alpha, qtarm);
-
-      float mGamma = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kElectron), RecoDecay::getMassPDG(kElectron)});
-      float mK0S = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kPiPlus)});
-      float mLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
-      float mAntiLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
-
-      int v0id = checkV0(pvec0, pvec1);
-      if (v0id < 0) {
-        // printf("This is not [Gamma/K0S/Lambda/AntiLambda] candidate.\n");
-        continue;
-      }
-
-      if (v0id == kGamma) { // photon conversion
-        registry.fill(HIST("hMassGamma"), V0radius, mGamma);
-        registry.fill(HIST("hV0PhiV"), phiv, mGamma);
-        registry.fill(HIST("hV0Psi"), psipair, mGamma);
-        if (mGamma < v0max_mee && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaEl()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaEl()) < 5 && psipair < maxpsipair) {
-          pidmap[V0.posTrackId()] |= (uint8_t(1) << kGamma);
-          pidmap[V0.negTrackId()] |= (uint8_t(1) << kGamma);
-          registry.fill(HIST("hGammaRxy"), pos[0], pos[1]);
-          v0Gamma(V0.negTrack_as<FullTracksExt>().collisionId(), pt, eta, phi, mGamma);
-        }
-      } else if (v0id == kK0S) { // K0S-> pi pi
-        registry.fill(HIST("hMassK0S"), V0radius, mK0S);
-        if ((0.48 < mK0S && mK0S < 0.51) && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
-          pidmap[V0.posTrackId()] |= (uint8_t(1) << kK0S);
-          pidmap[V0.negTrackId()] |= (uint8_t(1) << kK0S);
-        }
-      } else if (v0id == kLambda) { // L->p + pi-
-        registry.fill(HIST("hMassLambda"), V0radius, mLambda);
-        if (v0id == kLambda && (1.110 < mLambda && mLambda < 1.120) && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
-          pidmap[V0.posTrackId()] |= (uint8_t(1) << kLambda);
-          pidmap[V0.negTrackId()] |= (uint8_t(1) << kLambda);
-        }
-      } else if (v0id == kAntiLambda) { // Lbar -> pbar + pi+
-        registry.fill(HIST("hMassAntiLambda"), V0radius, mAntiLambda);
-        if ((1.110 < mAntiLambda && mAntiLambda < 1.120) && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5) {
-          pidmap[V0.posTrackId()] |= (uint8_t(1) << kAntiLambda);
-          pidmap[V0.negTrackId()] |= (uint8_t(1) << kAntiLambda);
-        }
-      }
-
-      // printf("posTrackId = %d\n",V0.posTrackId());
-      // printf("negTrackId = %d\n",V0.negTrackId());
-
+      selectV0(V0, pVtx, pos, pvec0, pvec1, fitter.getChi2AtPCACandidate()); // distance between 2 legs.
     } // end of V0 loop
 
     // cascade loop
     for (auto& casc : Cascades) {
       registry.fill(HIST("hCascCandidate"), 0.5);
-      auto v0 = casc.v0_as<aod::V0s>();
-      if (v0.posTrack_as<FullTracksExt>().sign() * v0.negTrack_as<FullTracksExt>().sign() > 0) { // reject same sign pair
-        continue;
-      }
-      if (v0.posTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
-      if (v0.negTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
-      if (casc.bachelor_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
-
-      if (v0.posTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
-      if (v0.negTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
-      if (casc.bachelor_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
-
-      if (fabs(v0.posTrack_as<FullTracksExt>().dcaXY()) < 0.05) {
-        continue;
-      }
-      if (fabs(v0.negTrack_as<FullTracksExt>().dcaXY()) < 0.05) {
-        continue;
-      }
-      if (fabs(casc.bachelor_as<FullTracksExt>().dcaXY()) < 0.05) {
-        continue;
-      }
-
-      if (fabs(v0.posTrack_as<FullTracksExt>().dcaXY()) > 2.4) {
-        continue;
-      }
-      if (fabs(v0.negTrack_as<FullTracksExt>().dcaXY()) > 2.4) {
-        continue;
-      }
-      if (fabs(casc.bachelor_as<FullTracksExt>().dcaXY()) > 2.4) {
-        continue;
-      }
-
-      if (fabs(v0.posTrack_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
-      if (fabs(v0.negTrack_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
-      if (fabs(casc.bachelor_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
-
-      if (v0.collisionId() != casc.collisionId()) {
-        continue;
-      }
-
-      if (!v0.posTrack_as<FullTracksExt>().has_collision() || !v0.negTrack_as<FullTracksExt>().has_collision() || !casc.bachelor_as<FullTracksExt>().has_collision()) {
+      if (!isSelectedCascLegs(casc)) {
         continue;
       }
 
       auto const& collision = casc.bachelor_as<FullTracksExt>().collision();
-      if (casc.collisionId() != collision.globalIndex()) {
-        continue;
-      }
-
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
       CheckAndUpdate(bc.runNumber(), bc.timestamp());
-      // Define o2 fitter, 2-prong
-      o2::vertexing::DCAFitterN<2> fitterV0;
-      fitterV0.setBz(d_bz); // in kG
-      fitterV0.setPropagateToPCA(true);
-      fitterV0.setMaxR(200.);
-      fitterV0.setMinParamChange(1e-3);
-      fitterV0.setMinRelChi2Change(0.9);
-      fitterV0.setMaxDZIni(1e9);
-      fitterV0.setMaxChi2(1e9);
-      fitterV0.setUseAbsDCA(true); // use d_UseAbsDCA once we want to use the weighted DCA
-
-      // next, cascade, Omega -> LK
-      o2::vertexing::DCAFitterN<2> fitterCasc;
-      fitterCasc.setBz(d_bz); // in kG
-      fitterCasc.setPropagateToPCA(true);
-      fitterCasc.setMaxR(200.);
-      fitterCasc.setMinParamChange(1e-3);
-      fitterCasc.setMinRelChi2Change(0.9);
-      fitterCasc.setMaxDZIni(1e9);
-      fitterCasc.setMaxChi2(1e9);
-      fitterCasc.setUseAbsDCA(true);
 
       std::array<float, 3> pos = {0.};
       std::array<float, 3> pvecpos = {0.};
@@ -618,11 +704,6 @@ struct v0selector {
       std::array<float, 3> pvecbach = {0.};
 
       int cpos = casc.v0_as<aod::V0s>().posTrack_as<FullTracksExt>().sign();
-      int cneg = casc.v0_as<aod::V0s>().negTrack_as<FullTracksExt>().sign();
-
-      if (cpos * cneg > 0) { // reject same sign pair
-        continue;
-      }
 
       auto pTrack = getTrackParCov(casc.v0_as<aod::V0s>().posTrack_as<FullTracksExt>());
       auto nTrack = getTrackParCov(casc.v0_as<aod::V0s>().negTrack_as<FullTracksExt>());
@@ -633,18 +714,19 @@ struct v0selector {
         nTrack = getTrackParCov(casc.v0_as<aod::V0s>().posTrack_as<FullTracksExt>());
       }
 
-      int nCand = fitterV0.process(pTrack, nTrack);
+      // V0 of the cascade, fitted with the same settings as the V0s
+      int nCand = precheck.process(fitter, pTrack, nTrack);
       if (nCand != 0) {
-        fitterV0.propagateTracksToVertex();
+        fitter.propagateTracksToVertex();
       } else {
         continue;
       }
-      const auto& v0vtx = fitterV0.getPCACandidate();
+      const auto& v0vtx = fitter.getPCACandidate();
       for (int i = 0; i < 3; i++) {
         pos[i] = v0vtx[i];
       }
 
-      auto V0dca = fitterV0.getChi2AtPCACandidate(); // distance between 2 legs.
+      auto V0dca = fitter.getChi2AtPCACandidate(); // distance between 2 legs.
       registry.fill(HIST("hDCAV0Dau_Casc"), V0dca);
       if (V0dca > 1.5) {
         continue;
@@ -657,10 +739,10 @@ struct v0selector {
 
       // Covariance matrix calculation
       const int momInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
-      fitterV0.getTrack(0).getPxPyPzGlo(pvecpos);
-      fitterV0.getTrack(1).getPxPyPzGlo(pvecneg);
-      fitterV0.getTrack(0).getCovXYZPxPyPzGlo(cov0);
-      fitterV0.getTrack(1).getCovXYZPxPyPzGlo(cov1);
+      fitter.getTrack(0).getPxPyPzGlo(pvecpos);
+      fitter.getTrack(1).getPxPyPzGlo(pvecneg);
+      fitter.getTrack(0).getCovXYZPxPyPzGlo(cov0);
+      fitter.getTrack(1).getCovXYZPxPyPzGlo(cov1);
 
       int v0id = checkV0(pvecpos, pvecneg);
       if (v0id != kLambda && v0id != kAntiLambda) {
@@ -671,7 +753,7 @@ struct v0selector {
         int j = momInd[i];
         covV0[j] = cov0[j] + cov1[j];
       }
-      auto covVtxV0 = fitterV0.calcPCACovMatrix();
+      auto covVtxV0 = fitter.calcPCACovMatrix();
       covV0[0] = covVtxV0(0, 0);
       covV0[1] = covVtxV0(1, 0);
       covV0[2] = covVtxV0(1, 1);
@@ -688,6 +770,7 @@ struct v0selector {
         continue;
       }
 
+      // next, cascade, Omega -> LK
       auto tV0 = o2::track::TrackParCov(vertex, pvecv0, covV0, 0);
       tV0.setQ2Pt(0); // No bending, please
       int nCand2 = fitterCasc.process(tV0, bTrack);
@@ -712,59 +795,93 @@ struct v0selector {
         continue;
       }
 
-      float mLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
-      float mAntiLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
-      float mXi = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG(kLambda0), RecoDecay::getMassPDG(kPiPlus)});
-      float mOmega = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG(kLambda0), RecoDecay::getMassPDG(kKPlus)});
+      selectCascade(casc, v0id, pvecpos, pvecneg, pvecv0, pvecbach);
+    } // end of cascades loop
 
-      // for Lambda->p + pi-
-      if (v0id == kLambda) {
-        registry.fill(HIST("hMassLambda_Casc"), mLambda);
-        if ((1.110 < mLambda && mLambda < 1.120) && TMath::Abs(casc.v0_as<aod::V0s>().posTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5 && TMath::Abs(casc.v0_as<aod::V0s>().negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
-          if (casc.bachelor_as<FullTracksExt>().sign() < 0) {
-            if (TMath::Abs(casc.bachelor_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
-              registry.fill(HIST("hMassXiMinus"), mXi);
-            }
+    fillV0Bits(tracks);
+  } // end of process
+  PROCESS_SWITCH(v0selector, processFit, "Fit the V0 and cascade vertices", true);
 
-            if (TMath::Abs(mXi - 1.321) > 0.006) {
-              if (TMath::Abs(casc.bachelor_as<FullTracksExt>().tpcNSigmaKa()) < 5) {
-                registry.fill(HIST("hMassOmegaMinus"), mOmega);
-                if (TMath::Abs(mOmega - 1.672) < 0.006) {
-                  pidmap[casc.bachelorId()] |= (uint8_t(1) << kOmega);
-                }
-              }
-            }
-          }
-        }
+  /// V0 and cascade vertices taken from the V0Data and CascData tables of the strangeness builders, without refitting
+  void processStrangenessBuilders(aod::Collisions const&, aod::BCsWithTimestamps const&, FullTracksExt const& tracks, aod::V0Datas const& V0s, aod::CascData const& Cascades)
+  {
+    registry.fill(HIST("hEventCounter"), 0.5);
+
+    pidmap.assign(tracks.size(), 0);
+
+    for (auto& V0 : V0s) {
+      if (!isSelectedV0Legs(V0)) {
+        continue;
       }
+      auto const& collision = V0.posTrack_as<FullTracksExt>().collision();
+      auto bc = collision.bc_as<aod::BCsWithTimestamps>();
+      CheckAndUpdate(bc.runNumber(), bc.timestamp());
 
-      // for AntiLambda->pbar + pi+
-      if (v0id == kAntiLambda) {
-        registry.fill(HIST("hMassAntiLambda_Casc"), mAntiLambda);
-        if ((1.110 < mAntiLambda && mAntiLambda < 1.120) && TMath::Abs(casc.v0_as<aod::V0s>().posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(casc.v0_as<aod::V0s>().negTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5) {
-          if (casc.bachelor_as<FullTracksExt>().sign() > 0) {
-            if (TMath::Abs(casc.bachelor_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
-              registry.fill(HIST("hMassXiPlus"), mXi);
-            }
-            if (TMath::Abs(mXi - 1.321) > 0.006) {
-              if (TMath::Abs(casc.bachelor_as<FullTracksExt>().tpcNSigmaKa()) < 5) {
-                registry.fill(HIST("hMassOmegaPlus"), mOmega);
-                if (TMath::Abs(mOmega - 1.672) < 0.006) {
-                  pidmap[casc.bachelorId()] |= (uint8_t(1) << kOmega);
-                }
-              }
-            }
-          }
-        }
+      if (V0.collisionId() != collision.globalIndex()) {
+        continue;
       }
-    } // end of cascades loop
+      registry.fill(HIST("hV0Candidate"), 0.5);
 
-    for (auto& track : tracks) {
-      // printf("setting pidmap[%lld] = %d\n",track.globalIndex(),pidmap[track.globalIndex()]);
-      v0bits(pidmap[track.globalIndex()]);
-    } // end of track loop
+      const std::array<float, 3> pVtx = {collision.posX(), collision.posY(), collision.posZ()};
+      const std::array<float, 3> pos = {V0.x(), V0.y(), V0.z()};
+      const std::array<float, 3> pvec0 = {V0.pxpos(), V0.pypos(), V0.pzpos()};
+      const std::array<float, 3> pvec1 = {V0.pxneg(), V0.pyneg(), V0.pzneg()};
 
-  } // end of process
+      // the builders store the distance between the legs, the selections here are on its square
+      selectV0(V0, pVtx, pos, pvec0, pvec1, V0.dcaV0daughters() * V0.dcaV0daughters());
+    } // end of V0 loop
+
+    // cascade loop
+    for (auto& casc : Cascades) {
+      registry.fill(HIST("hCascCandidate"), 0.5);
+      if (!isSelectedCascLegs(casc)) {
+        continue;
+      }
+
+      auto const& collision = casc.bachelor_as<FullTracksExt>().collision();
+
+      auto V0dca = casc.dcaV0daughters() * casc.dcaV0daughters(); // distance between 2 legs.
+      registry.fill(HIST("hDCAV0Dau_Casc"), V0dca);
+      if (V0dca > 1.5) {
+        continue;
+      }
+      registry.fill(HIST("hCascCandidate"), 1.5);
+
+      const std::array<float, 3> pvecpos = {casc.pxpos(), casc.pypos(), casc.pzpos()};
+      const std::array<float, 3> pvecneg = {casc.pxneg(), casc.pyneg(), casc.pzneg()};
+      const std::array<float, 3> pvecbach = {casc.pxbach(), casc.pybach(), casc.pzbach()};
+      int v0id = checkV0(pvecpos, pvecneg);
+      if (v0id != kLambda && v0id != kAntiLambda) {
+        continue;
+      }
+
+      std::array<float, 3> pVtx = {collision.posX(), collision.posY(), collision.posZ()};
+      const std::array<float, 3> pvecv0 = {pvecpos[0] + pvecneg[0], pvecpos[1] + pvecneg[1], pvecpos[2] + pvecneg[2]};
+      auto V0CosinePA = RecoDecay::cpa(pVtx, array{casc.xlambda(), casc.ylambda(), casc.zlambda()}, pvecv0);
+      registry.fill(HIST("hV0CosPA_Casc"), V0CosinePA);
+      if (V0CosinePA < 0.97) {
+        continue;
+      }
+      registry.fill(HIST("hCascCandidate"), 2.5);
+
+      auto Cascdca = casc.dcacascdaughters() * casc.dcacascdaughters(); // distance between V0 and bachelor
+      registry.fill(HIST("hDCACascDau"), Cascdca);
+      if (Cascdca > 1.5) {
+        continue;
+      }
+
+      auto CascCosinePA = RecoDecay::cpa(pVtx, array{casc.x(), casc.y(), casc.z()}, pvecbach);
+      registry.fill(HIST("hCascCosPA"), CascCosinePA);
+      if (CascCosinePA < 0.98) {
+        continue;
+      }
+
+      selectCascade(casc, v0id, pvecpos, pvecneg, pvecv0, pvecbach);
+    } // end of cascades loop
+
+    fillV0Bits(tracks);
+  }
+  PROCESS_SWITCH(v0selector, processStrangenessBuilders, "Take the V0 and cascade vertices from the V0Data and CascData tables of the strangeness builders", false);
 };
 
 struct trackPIDQA {
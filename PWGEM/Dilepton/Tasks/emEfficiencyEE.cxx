@@ -13,6 +13,7 @@
 // Analysis task for calculating single electron and dielectron efficiency
 //
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <TMath.h>
 #include <TH1F.h>
@@ -29,9 +30,11 @@
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include "PWGDQ/Core/AnalysisCutEvaluator.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MCSignal.h"
+#include "PWGDQ/Core/MCSignalAncestry.h"
 #include "PWGDQ/Core/MCSignalLibrary.h"
 #include "PWGDQ/DataModel/ReducedInfoTables.h"
 #include "Common/DataModel/PIDResponse.h"
@@ -379,6 +382,8 @@ struct AnalysisTrackSelection {
   AnalysisCompositeCut* fTrackCutsRes;          // track cut for resolution map
   std::vector<MCSignal> fMCSignals;             // list of signals to be checked
   MCSignal* fMCSignalRes;                       // signal for res
+  AnalysisCutEvaluator fTrackCutEvaluator;      // all the track cuts compiled into one evaluator
+  MCSignalAncestry fMCAncestry;                 // histories of the MC particles of the dataframe, shared by all the MC signals
 
   // 3D histos
   std::vector<TH3D*> fHistGenPosPart;
@@ -448,6 +453,7 @@ struct AnalysisTrackSelection {
         fTrackCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
       }
     }
+    fTrackCutEvaluator.Compile(fTrackCuts);
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
     VarManager::SetDefaultVarNames();
 
@@ -654,6 +660,9 @@ struct AnalysisTrackSelection {
     std::map<uint64_t, int> fMCEventLabels;
     int fCounters = 0; //! [0] - particle counter, [1] - event counter
 
+    // histories of all the MC particles, used by the MC signals of both the generated and the reconstructed tracks
+    fMCAncestry.Fill(tracksMC);
+
     for (auto& event : events) {
       VarManager::ResetValues(0, VarManager::kNEventWiseVariables);
       VarManager::ResetValues(0, VarManager::kNMCParticleVariables);
@@ -723,7 +732,7 @@ struct AnalysisTrackSelection {
       // TODO:  Use the mcReducedFlags to select signals
       int isig = 0;
       for (auto sig = fMCSignals.begin(); sig != fMCSignals.end(); sig++, isig++) {
-        if ((*sig).CheckSignal(true, groupedMCTracks, mctrack)) {
+        if ((*sig).CheckSignalFromAncestry(true, fMCAncestry, groupedMCTracks, mctrack)) {
           if (mctrack.pdgCode() > 0) {
             dynamic_cast<TH3D*>(fHistGenNegPart.at(isig))->Fill(mctrack.pt(), mctrack.eta(), mctrack.phi());
           } else {
@@ -759,14 +768,11 @@ struct AnalysisTrackSelection {
         }
       }
 
-      // compute track selection and publish the bit map
-      int i = 0;
-      for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-        if ((*cut).IsSelected(VarManager::fgValues)) {
-          filterMap |= (uint32_t(1) << i);
-          if (fConfigQA) {
-            fHistManQA->FillHistClass(fHistNamesRecoQA[i].Data(), VarManager::fgValues);
-          }
+      // compute track selection for all the cuts at once and publish the bit map
+      filterMap = fTrackCutEvaluator.Evaluate(VarManager::fgValues);
+      if (fConfigQA) {
+        for (uint32_t bits = filterMap; bits; bits &= bits - 1) {
+          fHistManQA->FillHistClass(fHistNamesRecoQA[__builtin_ctz(bits)].Data(), VarManager::fgValues);
         }
       }
       trackSel(static_cast<int>(filterMap));
@@ -780,14 +786,14 @@ struct AnalysisTrackSelection {
       for (auto sig = fMCSignals.begin(); sig != fMCSignals.end(); sig++, isig++) {
 
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) {
-          if ((*sig).CheckSignal(true, tracksMC, track.reducedMCTrack())) {
+          if ((*sig).CheckSignalFromAncestry(true, fMCAncestry, tracksMC, track.reducedMCTrack())) {
             mcDecision |= (uint32_t(1) << isig);
           }
         }
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::Track) > 0) {
           if (track.has_mcParticle()) {
             auto mctrack = track.template mcParticle_as<aod::McParticles_001>();
-            if ((*sig).CheckSignal(true, tracksMC, mctrack)) {
+            if ((*sig).CheckSignalFromAncestry(true, fMCAncestry, tracksMC, mctrack)) {
               mcDecision |= (uint32_t(1) << isig);
             }
           }
@@ -799,81 +805,81 @@ struct AnalysisTrackSelection {
         if (!(mcDecision & (uint32_t(1) << i))) {
           continue;
         }
-        for (unsigned int j = 0; j < fTrackCuts.size(); j++) {
-          if (filterMap & (uint8_t(1) << j)) {
-            if (track.sign() < 0) {
-              dynamic_cast<TH3D*>(fHistRecNegPart.at(j * fMCSignals.size() + i))->Fill(track.pt(), track.eta(), track.phi());
-            } else {
-              dynamic_cast<TH3D*>(fHistRecPosPart.at(j * fMCSignals.size() + i))->Fill(track.pt(), track.eta(), track.phi());
-            }
+        // loop only over the cuts passed by the track
+        for (uint32_t bits = filterMap; bits; bits &= bits - 1) {
+          unsigned int j = __builtin_ctz(bits);
+          if (track.sign() < 0) {
+            dynamic_cast<TH3D*>(fHistRecNegPart.at(j * fMCSignals.size() + i))->Fill(track.pt(), track.eta(), track.phi());
+          } else {
+            dynamic_cast<TH3D*>(fHistRecPosPart.at(j * fMCSignals.size() + i))->Fill(track.pt(), track.eta(), track.phi());
+          }
 
-            if (fConfigRecWithMC) {
+          if (fConfigRecWithMC) {
 
-              Double_t mcpt = -10000.;
-              Double_t mceta = -10000.;
-              Double_t mcphi = -1000.;
+            Double_t mcpt = -10000.;
+            Double_t mceta = -10000.;
+            Double_t mcphi = -1000.;
 
-              if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) {
-                auto mctrack = track.reducedMCTrack();
+            if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) {
+              auto mctrack = track.reducedMCTrack();
+              mcpt = mctrack.pt();
+              mceta = mctrack.eta();
+              mcphi = mctrack.phi();
+            }
+            if constexpr ((TTrackFillMap & VarManager::ObjTypes::Track) > 0) {
+              if (track.has_mcParticle()) {
+                auto mctrack = track.template mcParticle_as<aod::McParticles_001>();
                 mcpt = mctrack.pt();
                 mceta = mctrack.eta();
                 mcphi = mctrack.phi();
               }
-              if constexpr ((TTrackFillMap & VarManager::ObjTypes::Track) > 0) {
-                if (track.has_mcParticle()) {
-                  auto mctrack = track.template mcParticle_as<aod::McParticles_001>();
-                  mcpt = mctrack.pt();
-                  mceta = mctrack.eta();
-                  mcphi = mctrack.phi();
-                }
-              }
+            }
 
-              if (track.sign() < 0) {
-                dynamic_cast<TH3D*>(fHistRecNegPartMC.at(j * fMCSignals.size() + i))->Fill(mcpt, mceta, mcphi);
-              } else {
-                dynamic_cast<TH3D*>(fHistRecPosPartMC.at(j * fMCSignals.size() + i))->Fill(mcpt, mceta, mcphi);
-              }
+            if (track.sign() < 0) {
+              dynamic_cast<TH3D*>(fHistRecNegPartMC.at(j * fMCSignals.size() + i))->Fill(mcpt, mceta, mcphi);
+            } else {
+              dynamic_cast<TH3D*>(fHistRecPosPartMC.at(j * fMCSignals.size() + i))->Fill(mcpt, mceta, mcphi);
             }
+          }
 
-            if (fConfigResolutionOn && (i == 0) && (j == 0)) {
+          if (fConfigResolutionOn && (i == 0) && (j == 0)) {
 
-              Double_t mcpt = -10000.;
-              Double_t mceta = -10000.;
-              Double_t mcphi = -1000.;
-              Int_t mcpdg = -10000.;
+            Double_t mcpt = -10000.;
+            Double_t mceta = -10000.;
+            Double_t mcphi = -1000.;
+            Int_t mcpdg = -10000.;
 
-              if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) {
-                auto mctrack = track.reducedMCTrack();
+            if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) {
+              auto mctrack = track.reducedMCTrack();
+              mcpt = mctrack.pt();
+              mceta = mctrack.eta();
+              mcphi = mctrack.phi();
+              mcpdg = mctrack.pdgCode();
+            }
+            if constexpr ((TTrackFillMap & VarManager::ObjTypes::Track) > 0) {
+              if (track.has_mcParticle()) {
+                auto mctrack = track.template mcParticle_as<aod::McParticles_001>();
                 mcpt = mctrack.pt();
                 mceta = mctrack.eta();
                 mcphi = mctrack.phi();
                 mcpdg = mctrack.pdgCode();
               }
-              if constexpr ((TTrackFillMap & VarManager::ObjTypes::Track) > 0) {
-                if (track.has_mcParticle()) {
-                  auto mctrack = track.template mcParticle_as<aod::McParticles_001>();
-                  mcpt = mctrack.pt();
-                  mceta = mctrack.eta();
-                  mcphi = mctrack.phi();
-                  mcpdg = mctrack.pdgCode();
-                }
-              }
-              Double_t deltaptoverpt = -1000.;
-              if (mcpt > 0.)
-                deltaptoverpt = (mcpt - track.pt()) / mcpt;
-              Double_t deltaeta = mceta - track.eta();
-              Double_t deltaphi = mcphi - track.phi();
-              dynamic_cast<TH2D*>(fHistRes.at(0))->Fill(mcpt, deltaptoverpt);
-              dynamic_cast<TH2D*>(fHistRes.at(1))->Fill(mcpt, deltaeta);
-              if (mcpdg < 0) {
-                dynamic_cast<TH2D*>(fHistRes.at(2))->Fill(mcpt, deltaphi);
-              } else {
-                dynamic_cast<TH2D*>(fHistRes.at(3))->Fill(mcpt, deltaphi);
-              }
             }
-            if (fConfigQA)
-              fHistManQA->FillHistClass(fHistNamesMCMatchedQA[j][i].Data(), VarManager::fgValues);
+            Double_t deltaptoverpt = -1000.;
+            if (mcpt > 0.)
+              deltaptoverpt = (mcpt - track.pt()) / mcpt;
+            Double_t deltaeta = mceta - track.eta();
+            Double_t deltaphi = mcphi - track.phi();
+            dynamic_cast<TH2D*>(fHistRes.at(0))->Fill(mcpt, deltaptoverpt);
+            dynamic_cast<TH2D*>(fHistRes.at(1))->Fill(mcpt, deltaeta);
+            if (mcpdg < 0) {
+              dynamic_cast<TH2D*>(fHistRes.at(2))->Fill(mcpt, deltaphi);
+            } else {
+              dynamic_cast<TH2D*>(fHistRes.at(3))->Fill(mcpt, deltaphi);
+            }
           }
+          if (fConfigQA)
+            fHistManQA->FillHistClass(fHistNamesMCMatchedQA[j][i].Data(), VarManager::fgValues);
         } // end loop over cuts
       }   // end loop over MC signals
     }     // end loop over reconstructed track belonging to the events
@@ -946,6 +952,9 @@ struct AnalysisSameEventPairing {
   // AnalysisCompositeCut* fEventCut; // Taken from event selection part
   std::vector<AnalysisCompositeCut> fTrackCuts; // list of track cuts
   std::vector<MCSignal> fMCSignals;             // list of signals with one prong to be checked: ULS 2D histos
+  MCSignalAncestry fMCAncestry;                 // histories of the MC particles of the dataframe, shared by all the MC signals
+  std::unordered_map<uint64_t, uint32_t> fPairMCDecisions; // MC signal decisions of the MC particle pairs of the event, keyed by the two MC labels
+  uint32_t fTrackCutsMask = 0;                              // bits of the track cuts configured in this task
 
   // 2D histo vectors
   std::vector<TH2D*> fHistGenPair;
@@ -990,6 +999,7 @@ struct AnalysisSameEventPairing {
         fTrackCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
       }
     }
+    fTrackCutsMask = (fTrackCuts.size() < 32 ? (uint32_t(1) << fTrackCuts.size()) - 1 : ~uint32_t(0));
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
     VarManager::SetDefaultVarNames();
 
@@ -1105,6 +1115,9 @@ struct AnalysisSameEventPairing {
     std::map<uint64_t, int> fMCEventLabels;
     int fCounters = 0; //! [0] - particle counter, [1] - event counter
 
+    // histories of all the MC particles, used by the MC signals of both the generated and the reconstructed pairs
+    fMCAncestry.Fill(tracksMC);
+
     for (auto& event : events) {
 
       if (!event.isEventSelected()) {
@@ -1155,45 +1168,54 @@ struct AnalysisSameEventPairing {
     //
     Double_t masse = 0.00051099895; // 0.5 MeV/c2 -> 0.0005 GeV/c2
 
-    for (auto& [t1, t2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(groupedMCTracks, groupedMCTracks))) {
-      // for (auto& [t1, t2] : combinations(groupedMCTracks, groupedMCTracks)) {
-
-      if ((abs(t1.pdgCode()) != 11) || (abs(t2.pdgCode()) != 11))
-        continue;
-      if (!fConfigFillLS && (t1.pdgCode() * t2.pdgCode() > 0))
-        continue; // ULS only
-
-      TLorentzVector Lvec1;
-      TLorentzVector Lvec2;
-      Lvec1.SetPtEtaPhiM(t1.pt(), t1.eta(), t1.phi(), masse);
-      Lvec2.SetPtEtaPhiM(t2.pt(), t2.eta(), t2.phi(), masse);
-      TLorentzVector LvecM = Lvec1 + Lvec2;
-      double mass = LvecM.M();
-      double pairpt = LvecM.Pt();
-      // double opangle = Lvec1.Angle(Lvec2.Vect());
-
-      // Fiducial cut
-      Bool_t genfidcut = kTRUE;
-      if ((t1.eta() > fConfigMaxEta) || (t2.eta() > fConfigMaxEta) || (t1.eta() < fConfigMinEta) || (t2.eta() < fConfigMinEta) || (t1.pt() > fConfigMaxPt) || (t2.pt() > fConfigMaxPt) || (t1.pt() < fConfigMinPt) || (t2.pt() < fConfigMinPt))
-        genfidcut = kFALSE;
-
-      int isig = 0;
-      for (auto sig = fMCSignals.begin(); sig != fMCSignals.end(); sig++, isig++) {
-        if ((*sig).CheckSignal(true, groupedMCTracks, t1, t2)) {
+    // only electrons and positrons are paired: select them once instead of testing every pair of the MC stack
+    std::vector<std::decay_t<decltype(groupedMCTracks.begin())>> electrons;
+    for (auto& mctrack : groupedMCTracks) {
+      if (abs(mctrack.pdgCode()) == 11) {
+        electrons.push_back(mctrack);
+      }
+    }
 
-          // not smeared after fiducial cuts
-          if (genfidcut) {
-            if (!fConfigFillLS) {
-              dynamic_cast<TH2D*>(fHistGenPair.at(isig))->Fill(mass, pairpt);
-            } else {
-              if (t1.pdgCode() * t2.pdgCode() < 0) {
-                dynamic_cast<TH2D*>(fHistGenPair.at(isig * 2))->Fill(mass, pairpt);
+    for (unsigned int i1 = 0; i1 < electrons.size(); i1++) {
+      auto const& t1 = electrons[i1];
+      for (unsigned int i2 = i1 + 1; i2 < electrons.size(); i2++) {
+        auto const& t2 = electrons[i2];
+
+        if (!fConfigFillLS && (t1.pdgCode() * t2.pdgCode() > 0))
+          continue; // ULS only
+
+        TLorentzVector Lvec1;
+        TLorentzVector Lvec2;
+        Lvec1.SetPtEtaPhiM(t1.pt(), t1.eta(), t1.phi(), masse);
+        Lvec2.SetPtEtaPhiM(t2.pt(), t2.eta(), t2.phi(), masse);
+        TLorentzVector LvecM = Lvec1 + Lvec2;
+        double mass = LvecM.M();
+        double pairpt = LvecM.Pt();
+        // double opangle = Lvec1.Angle(Lvec2.Vect());
+
+        // Fiducial cut
+        Bool_t genfidcut = kTRUE;
+        if ((t1.eta() > fConfigMaxEta) || (t2.eta() > fConfigMaxEta) || (t1.eta() < fConfigMinEta) || (t2.eta() < fConfigMinEta) || (t1.pt() > fConfigMaxPt) || (t2.pt() > fConfigMaxPt) || (t1.pt() < fConfigMinPt) || (t2.pt() < fConfigMinPt))
+          genfidcut = kFALSE;
+
+        int isig = 0;
+        for (auto sig = fMCSignals.begin(); sig != fMCSignals.end(); sig++, isig++) {
+          if ((*sig).CheckSignalFromAncestry(true, fMCAncestry, groupedMCTracks, t1, t2)) {
+
+            // not smeared after fiducial cuts
+            if (genfidcut) {
+              if (!fConfigFillLS) {
+                dynamic_cast<TH2D*>(fHistGenPair.at(isig))->Fill(mass, pairpt);
               } else {
-                dynamic_cast<TH2D*>(fHistGenPair.at(isig * 2 + 1))->Fill(mass, pairpt);
+                if (t1.pdgCode() * t2.pdgCode() < 0) {
+                  dynamic_cast<TH2D*>(fHistGenPair.at(isig * 2))->Fill(mass, pairpt);
+                } else {
+                  dynamic_cast<TH2D*>(fHistGenPair.at(isig * 2 + 1))->Fill(mass, pairpt);
+                }
               }
             }
+            // need to implement smeared
           }
-          // need to implement smeared
         }
       }
     } // end of true pairing loop
@@ -1206,7 +1228,8 @@ struct AnalysisSameEventPairing {
     Bool_t uls = kTRUE;
 
     // Loop over two track combinations
-    uint8_t twoTrackFilter = 0;
+    uint32_t twoTrackFilter = 0;
+    fPairMCDecisions.clear();
     // uint32_t dileptonFilterMap = 0;
     // uint32_t dileptonMcDecision = 0;
     // dileptonList.reserve(1);
@@ -1236,18 +1259,25 @@ struct AnalysisSameEventPairing {
       //
       VarManager::FillPair<VarManager::kDecayToEE, TTrackFillMap>(t1, t2);
 
-      // run MC matching for this pair
+      // run MC matching for this pair, once per pair of MC particles
       uint32_t mcDecision = 0;
-      int isig = 0;
-      for (auto sig = fMCSignals.begin(); sig != fMCSignals.end(); sig++, isig++) {
-
-        if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) { // for skimmed DQ model
-          if ((*sig).CheckSignal(true, tracksMC, t1.reducedMCTrack(), t2.reducedMCTrack())) {
-            mcDecision |= (uint32_t(1) << isig);
-          }
+      if constexpr ((TTrackFillMap & VarManager::ObjTypes::ReducedTrack) > 0) { // for skimmed DQ model
+        uint64_t pairLabel = (static_cast<uint64_t>(t1.reducedMCTrackId()) << 32) | static_cast<uint32_t>(t2.reducedMCTrackId());
+        auto cachedDecision = fPairMCDecisions.find(pairLabel);
+        if (cachedDecision != fPairMCDecisions.end()) {
+          mcDecision = cachedDecision->second;
+        } else {
+          auto mctrack1 = t1.reducedMCTrack();
+          auto mctrack2 = t2.reducedMCTrack();
+          int isig = 0;
+          for (auto sig = fMCSignals.begin(); sig != fMCSignals.end(); sig++, isig++) {
+            if ((*sig).CheckSignalFromAncestry(true, fMCAncestry, tracksMC, mctrack1, mctrack2)) {
+              mcDecision |= (uint32_t(1) << isig);
+            }
+          } // end of loop MC signals
+          fPairMCDecisions[pairLabel] = mcDecision;
         }
-
-      } // end of loop MC signals
+      }
 
       // dileptonFilterMap = twoTrackFilter;
       // dileptonMcDecision = mcDecision;
@@ -1258,16 +1288,15 @@ struct AnalysisSameEventPairing {
           continue;
         }
         if (recfidcut) {
-          for (unsigned int j = 0; j < fTrackCuts.size(); j++) {
-            if (twoTrackFilter & (uint8_t(1) << j)) {
-              if (!fConfigFillLS) {
-                dynamic_cast<TH2D*>(fHistRecPair.at(j * fMCSignals.size() + i))->Fill(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt]);
+          for (uint32_t bits = twoTrackFilter & fTrackCutsMask; bits; bits &= bits - 1) {
+            unsigned int j = __builtin_ctz(bits);
+            if (!fConfigFillLS) {
+              dynamic_cast<TH2D*>(fHistRecPair.at(j * fMCSignals.size() + i))->Fill(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt]);
+            } else {
+              if (uls) {
+                dynamic_cast<TH2D*>(fHistRecPair.at(j * (2 * fMCSignals.size()) + 2 * i))->Fill(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt]);
               } else {
-                if (uls) {
-                  dynamic_cast<TH2D*>(fHistRecPair.at(j * (2 * fMCSignals.size()) + 2 * i))->Fill(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt]);
-                } else {
-                  dynamic_cast<TH2D*>(fHistRecPair.at(j * (2 * fMCSignals.size()) + 2 * i + 1))->Fill(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt]);
-                }
+                dynamic_cast<TH2D*>(fHistRecPair.at(j * (2 * fMCSignals.size()) + 2 * i + 1))->Fill(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt]);
               }
             }
           }
@@ -1291,16 +1320,15 @@ struct AnalysisSameEventPairing {
               genfidcut = kFALSE;
           }
           if (genfidcut) {
-            for (unsigned int j = 0; j < fTrackCuts.size(); j++) {
-              if (twoTrackFilter & (uint8_t(1) << j)) {
-                if (!fConfigFillLS) {
-                  dynamic_cast<TH2D*>(fHistRecPairMC.at(j * fMCSignals.size() + i))->Fill(mass, pairpt);
+            for (uint32_t bits = twoTrackFilter & fTrackCutsMask; bits; bits &= bits - 1) {
+              unsigned int j = __builtin_ctz(bits);
+              if (!fConfigFillLS) {
+                dynamic_cast<TH2D*>(fHistRecPairMC.at(j * fMCSignals.size() + i))->Fill(mass, pairpt);
+              } else {
+                if (uls) {
+                  dynamic_cast<TH2D*>(fHistRecPairMC.at(j * (2 * fMCSignals.size()) + 2 * i))->Fill(mass, pairpt);
                 } else {
-                  if (uls) {
-                    dynamic_cast<TH2D*>(fHistRecPairMC.at(j * (2 * fMCSignals.size()) + 2 * i))->Fill(mass, pairpt);
-                  } else {
-                    dynamic_cast<TH2D*>(fHistRecPairMC.at(j * (2 * fMCSignals.size()) + 2 * i + 1))->Fill(mass, pairpt);
-                  }
+                  dynamic_cast<TH2D*>(fHistRecPairMC.at(j * (2 * fMCSignals.size()) + 2 * i + 1))->Fill(mass, pairpt);
                 }
               }
             }
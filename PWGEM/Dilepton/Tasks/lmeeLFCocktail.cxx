@@ -12,6 +12,7 @@
 //
 // Analysis task for lmee light flavour cocktail
 
+#include <algorithm>
 #include <vector>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -21,6 +22,8 @@
 #include "Math/Vector3D.h"
 #include "TFile.h"
 #include "TF1.h"
+#include "TH1.h"
+#include "TObjArray.h"
 #include "TRandom.h"
 #include "TDatabasePDG.h"
 #include "TGenPhaseSpace.h"
@@ -88,6 +91,98 @@ DECLARE_SOA_TABLE(eeTTree, "AOD", "EETTREE",
 
 } // namespace o2::aod
 
+// Smearing distributions converted once into cumulative distributions, sampled by binary search.
+// Reproduces TH1::GetRandom() (uniform within the selected bin) without going through the histogram for each particle.
+struct SmearingLUT {
+  struct Slice {
+    std::vector<double> edges; // bin edges of the distribution
+    std::vector<double> cdf;   // normalised cumulative distribution at the bin edges, empty if the distribution is empty
+  };
+
+  std::vector<double> ptEdges; // pT binning of the slices, slice i corresponds to the pT bin i, as in the resolution maps
+  std::vector<Slice> slices;
+  int lastSlice = 0;
+
+  static Slice makeSlice(const TH1* h)
+  {
+    Slice slice;
+    if (!h) {
+      return slice;
+    }
+    int nBins = h->GetNbinsX();
+    slice.edges.resize(nBins + 1);
+    for (int ibin = 1; ibin <= nBins + 1; ibin++) {
+      slice.edges[ibin - 1] = h->GetXaxis()->GetBinLowEdge(ibin);
+    }
+    slice.cdf.resize(nBins + 1, 0.);
+    for (int ibin = 1; ibin <= nBins; ibin++) {
+      slice.cdf[ibin] = slice.cdf[ibin - 1] + h->GetBinContent(ibin);
+    }
+    if (slice.cdf[nBins] <= 0.) {
+      slice.cdf.clear();
+      return slice;
+    }
+    for (auto& c : slice.cdf) {
+      c /= slice.cdf[nBins];
+    }
+    return slice;
+  }
+
+  static double sample(const Slice& slice, double u)
+  {
+    if (slice.cdf.empty()) {
+      return 0.;
+    }
+    int nBins = slice.cdf.size() - 1;
+    int ibin = std::upper_bound(slice.cdf.begin(), slice.cdf.end(), u) - slice.cdf.begin() - 1;
+    ibin = std::clamp(ibin, 0, nBins - 1);
+    double x = slice.edges[ibin];
+    double dc = slice.cdf[ibin + 1] - slice.cdf[ibin];
+    if (u > slice.cdf[ibin] && dc > 0.) {
+      x += (slice.edges[ibin + 1] - slice.edges[ibin]) * (u - slice.cdf[ibin]) / dc;
+    }
+    return x;
+  }
+
+  // arr: slices of a resolution map, the pT binning is taken from the first element of axisArr (arr itself by default)
+  void build(const TObjArray* arr, const TObjArray* axisArr = nullptr)
+  {
+    ptEdges.clear();
+    slices.clear();
+    lastSlice = 0;
+    if (!axisArr) {
+      axisArr = arr;
+    }
+    if (!arr || !axisArr || !axisArr->At(0)) {
+      return;
+    }
+    const TAxis* axis = static_cast<const TH1*>(axisArr->At(0))->GetXaxis();
+    for (int ibin = 1; ibin <= axis->GetNbins() + 1; ibin++) {
+      ptEdges.push_back(axis->GetBinLowEdge(ibin));
+    }
+    lastSlice = arr->GetLast();
+    slices.resize(lastSlice + 1);
+    for (int i = 1; i <= lastSlice; i++) {
+      slices[i] = makeSlice(static_cast<const TH1*>(arr->At(i)));
+    }
+  }
+
+  bool empty() const { return slices.empty(); }
+
+  // same bin as TAxis::FindBin(pt), with the underflow and overflow clamped to the first and last slices
+  int findSlice(double pt) const
+  {
+    int ibin = std::upper_bound(ptEdges.begin(), ptEdges.end(), pt) - ptEdges.begin();
+    return std::clamp(ibin, 1, std::max(lastSlice, 1));
+  }
+
+  double sample(double pt, double u) const
+  {
+    int ibin = findSlice(pt);
+    return ibin < static_cast<int>(slices.size()) ? sample(slices[ibin], u) : 0.;
+  }
+};
+
 struct lmeelfcocktail {
 
   Produces<aod::eeTTree> tree;
@@ -107,13 +202,17 @@ struct lmeelfcocktail {
   TObjArray* fArrResoEta;
   TObjArray* fArrResoPhi_Pos;
   TObjArray* fArrResoPhi_Neg;
+  SmearingLUT fLUTResoP, fLUTResoPt, fLUTResoEta, fLUTResoPhiPos, fLUTResoPhiNeg; // lookup tables of the resolution maps
+  std::vector<SmearingLUT::Slice> fLUTDCAtemplates;                                 // lookup tables of the DCA templates
+  double fCosMinOpAng;                                                              // cosine of the minimum opening angle
+  double fElectronMass;
 
   std::vector<std::shared_ptr<TH1>> fmee_orig, fmotherpT_orig, fphi_orig, frap_orig, fmee_orig_wALT, fmotherpT_orig_wALT, fmee, fphi, frap, fmee_wALT;
   std::vector<std::shared_ptr<TH2>> fpteevsmee_wALT, fpteevsmee_orig_wALT, fpteevsmee_orig, fpteevsmee;
 
   std::vector<double> DCATemplateEdges;
   int nbDCAtemplate;
-  TH1F** fh_DCAtemplates;
+  TH1F** fh_DCAtemplates = nullptr;
 
   Configurable<int> fCollisionSystem{"cfgCollisionSystem", 200, "set the collision system"};
   Configurable<bool> fConfigWriteTTree{"cfgWriteTTree", false, "whether tree output should be written"};
@@ -128,6 +227,7 @@ struct lmeelfcocktail {
   Configurable<float> fConfigMaxPtee{"cfgMaxPtee", 10.0, "hightest bin in pT"};
   Configurable<int> fConfigResolType{"cfgResolType", 2, "set resolution type"};
   Configurable<int> fConfigALTweight{"cfgALTweight", 1, "set alternative weighting type"};
+  Configurable<bool> fConfigUseLUT{"cfgUseLUT", false, "sample the resolution maps and DCA templates from lookup tables built at initialisation"};
   Configurable<std::string> fConfigResFileName{"cfgResFileName", "", "name of resolution file"};
   // Configurable<bool> fConfigResFileLocal{"cfgResFileLocal", false, "..."};
   Configurable<std::string> fConfigEffFileName{"cfgEffFileName", "", "name of efficiency file"};
@@ -185,6 +285,29 @@ struct lmeelfcocktail {
     GetMultHisto(TString(fConfigMultFileName), TString(fConfigMultHistPtName), TString(fConfigMultHistPt2Name), TString(fConfigMultHistMtName), TString(fConfigMultHistMt2Name));
     GetPhotonPtParametrization(TString(fConfigPhotonPtFileName), TString(fConfigPhotonPtDirName), TString(fConfigPhotonPtFuncName));
     fillKrollWada();
+
+    fCosMinOpAng = TMath::Cos(fConfigMinOpAng);
+    fElectronMass = (TDatabasePDG::Instance()->GetParticle(11))->Mass();
+    if (fConfigUseLUT) {
+      BuildLUTs();
+    }
+  }
+
+  void BuildLUTs()
+  {
+    // convert the smearing distributions into lookup tables once, instead of sampling the histograms for each particle
+    if (fConfigResolType == 1) {
+      fLUTResoP.build(fArr);
+    } else if (fConfigResolType == 2) {
+      fLUTResoPt.build(fArrResoPt);
+      fLUTResoEta.build(fArrResoEta);
+      fLUTResoPhiPos.build(fArrResoPhi_Pos);
+      fLUTResoPhiNeg.build(fArrResoPhi_Neg, fArrResoPhi_Pos); // same pT binning as the original code uses for both charges
+    }
+    fLUTDCAtemplates.clear();
+    for (int jj = 0; jj < nbDCAtemplate; jj++) {
+      fLUTDCAtemplates.push_back(SmearingLUT::makeSlice(fh_DCAtemplates ? fh_DCAtemplates[jj] : nullptr));
+    }
   }
 
   void processCocktail(aod::McCollision const&, aod::McParticles const& mcParticles)
@@ -332,7 +455,7 @@ struct lmeelfcocktail {
         fpass = false; // leg pT cut
       if (dau1.Pt() > fConfigMaxPt || dau2.Pt() > fConfigMaxPt)
         fpass = false; // leg pT cut
-      if (dau1.Vect().Unit().Dot(dau2.Vect().Unit()) > TMath::Cos(fConfigMinOpAng))
+      if (dau1.Vect().Unit().Dot(dau2.Vect().Unit()) > fCosMinOpAng)
         fpass = false; // opening angle cut
       if (TMath::Abs(dau1.Eta()) > fConfigMaxEta || TMath::Abs(dau2.Eta()) > fConfigMaxEta)
         fpass = false;
@@ -340,10 +463,10 @@ struct lmeelfcocktail {
       // get the pair DCA (based in smeared pT)
       for (int jj = 0; jj < nbDCAtemplate; jj++) { // loop over DCA templates
         if (dau1.Pt() >= DCATemplateEdges[jj] && dau1.Pt() < DCATemplateEdges[jj + 1]) {
-          fd1DCA = fh_DCAtemplates[jj]->GetRandom();
+          fd1DCA = fConfigUseLUT ? SmearingLUT::sample(fLUTDCAtemplates[jj], gRandom->Rndm()) : fh_DCAtemplates[jj]->GetRandom();
         }
         if (dau2.Pt() >= DCATemplateEdges[jj] && dau2.Pt() < DCATemplateEdges[jj + 1]) {
-          fd2DCA = fh_DCAtemplates[jj]->GetRandom();
+          fd2DCA = fConfigUseLUT ? SmearingLUT::sample(fLUTDCAtemplates[jj], gRandom->Rndm()) : fh_DCAtemplates[jj]->GetRandom();
         }
       }
       fpairDCA = sqrt((pow(fd1DCA, 2) + pow(fd2DCA, 2)) / 2);
@@ -449,7 +572,7 @@ struct lmeelfcocktail {
         Double_t VPHphi = 2.0 * TMath::ACos(-1.) * gRandom->Rndm();
         TLorentzVector beam;
         beam.SetPtEtaPhiM(VPHpT, VPHeta, VPHphi, VPHmass);
-        Double_t decaymasses[2] = {(TDatabasePDG::Instance()->GetParticle(11))->Mass(), (TDatabasePDG::Instance()->GetParticle(11))->Mass()};
+        Double_t decaymasses[2] = {fElectronMass, fElectronMass};
         TGenPhaseSpace VPHgen;
         Bool_t SetDecay;
         SetDecay = VPHgen.SetDecay(beam, 2, decaymasses);
@@ -504,7 +627,7 @@ struct lmeelfcocktail {
           fpass = false; // leg pT cut
         if (dau1.Pt() > fConfigMaxPt || dau2.Pt() > fConfigMaxPt)
           fpass = false; // leg pT cut
-        if (dau1.Vect().Unit().Dot(dau2.Vect().Unit()) > TMath::Cos(fConfigMinOpAng))
+        if (dau1.Vect().Unit().Dot(dau2.Vect().Unit()) > fCosMinOpAng)
           fpass = false; // opening angle cut
         if (TMath::Abs(dau1.Eta()) > fConfigMaxEta || TMath::Abs(dau2.Eta()) > fConfigMaxEta)
           fpass = false;
@@ -649,6 +772,17 @@ struct lmeelfcocktail {
 
     if (Run == 0) {
       resvec = vec;
+    } else if (Run == 1 && fConfigUseLUT && !fLUTResoP.empty()) {
+      // same as below, with the p slices sampled from the lookup table
+      Double_t SmearingP = p * fLUTResoP.sample(pt, gRandom->Rndm());
+      p -= SmearingP;
+      px = p * sin(theta) * cos(phi);
+      py = p * sin(theta) * sin(phi);
+      pz = p * cos(theta);
+      E = sqrt(p * p + mass * mass);
+
+      resvec.SetPxPyPzE(px, py, pz, E);
+
     } else if (Run == 1) {
       TH1D* hisSlice(nullptr);
       if (fArr) {
@@ -681,6 +815,21 @@ struct lmeelfcocktail {
 
       resvec.SetPxPyPzE(px, py, pz, E);
 
+    } else if (Run == 2 && fConfigUseLUT) {
+      // same as below, with the pt, eta and phi slices sampled from the lookup tables
+      Double_t sPt = pt - fLUTResoPt.sample(pt, gRandom->Rndm()) * pt;
+      Double_t smearing = fLUTResoEta.sample(pt, gRandom->Rndm());
+      Double_t sEta = eta - smearing;
+      if (ch > 0) {
+        smearing = fLUTResoPhiPos.sample(pt, gRandom->Rndm());
+      } else if (ch < 0) {
+        smearing = fLUTResoPhiNeg.sample(pt, gRandom->Rndm());
+      }
+      Double_t sPhi = phi - smearing;
+
+      Double_t sP = sPt * cosh(sEta);
+      resvec.SetPxPyPzE(sPt * cos(sPhi), sPt * sin(sPhi), sPt * sinh(sEta), sqrt(sP * sP + mass * mass));
+
     } else if (Run == 2) {
       // smear pt
       Int_t ptbin = reinterpret_cast<TH2D*>(fArrResoPt->At(0))->GetXaxis()->FindBin(pt);
@@ -845,7 +994,7 @@ struct lmeelfcocktail {
       LOGP(error, "Could not open DCATemplate file {}", fFileNameLocal.Data());
       return;
     }
-    fh_DCAtemplates = new TH1F*[nbDCAtemplate];
+    fh_DCAtemplates = new TH1F*[nbDCAtemplate]();
     for (int jj = 0; jj < nbDCAtemplate; jj++) {
       if (fFile->GetListOfKeys()->Contains(Form("%s%d", histname.Data(), jj + 1))) {
         fh_DCAtemplates[jj] = reinterpret_cast<TH1F*>(fFile->Get(Form("%s%d", histname.Data(), jj + 1)));
@@ -14,6 +14,7 @@
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include <TMath.h>
+#include <cmath>
 
 // todo: declare more columns in this file dynamic or expression, atm I save a lot of redundant information
 namespace o2::aod
@@ -47,6 +48,88 @@ DECLARE_SOA_TABLE(V0DaughterTracks, "AOD", "V0TRACKS",
                   pidtpc::TPCNSigmaPi,
                   track::TPCSignal);
 
+// Compact version of V0DaughterTracks: the quantities are stored in fixed-point integers (as done for the tiny PID tables)
+// and decoded by dynamic columns with the same names as in V0DaughterTracks, so that the tasks can be templated on the table
+namespace gammatrackreco_tiny
+{
+// Binning of a stored quantity: value = offset + bin_width * stored, values outside [binned_min, binned_max] are clamped
+template <typename T, int Min, int Max, int Scale, int Offset = 0>
+struct binning {
+  typedef T binned_t;
+  static constexpr float binned_min = static_cast<float>(Min) / Scale;
+  static constexpr float binned_max = static_cast<float>(Max) / Scale;
+  static constexpr float bin_width = 1.f / Scale;
+  static constexpr float offset = static_cast<float>(Offset) / Scale;
+};
+
+using binningDcaXY = binning<int16_t, -32000, 32000, 1000>; // cm, 10 um precision up to 32 cm
+using binningEta = binning<int16_t, -30000, 30000, 10000>;  // 1e-4 precision up to |eta| = 3
+using binningPhi = binning<uint16_t, 0, 62832, 10000>;      // rad, 1e-4 precision in [0, 2pi]
+using binningClsRatio = binning<uint8_t, 0, 250, 100>;      // 0.01 precision up to 2.5
+using binningTPCSignal = binning<uint16_t, 0, 65000, 50>;   // 0.02 precision up to 1300
+
+template <typename binningType>
+typename binningType::binned_t pack(float value)
+{
+  if (value <= binningType::binned_min) {
+    value = binningType::binned_min;
+  } else if (value >= binningType::binned_max) {
+    value = binningType::binned_max;
+  }
+  float stored = (value - binningType::offset) / binningType::bin_width;
+  return static_cast<typename binningType::binned_t>(stored >= 0.f ? stored + 0.5f : stored - 0.5f);
+}
+
+template <typename binningType>
+float unpack(typename binningType::binned_t stored)
+{
+  return binningType::offset + binningType::bin_width * static_cast<float>(stored);
+}
+
+DECLARE_SOA_COLUMN(DcaXYStore, dcaXYStore, binningDcaXY::binned_t);                                                    //! Stored binned DCA xy
+DECLARE_SOA_COLUMN(EtaStore, etaStore, binningEta::binned_t);                                                          //! Stored binned pseudorapidity
+DECLARE_SOA_COLUMN(PhiStore, phiStore, binningPhi::binned_t);                                                          //! Stored binned azimuthal angle
+DECLARE_SOA_COLUMN(TpcCrossedRowsOverFindableClsStore, tpcCrossedRowsOverFindableClsStore, binningClsRatio::binned_t); //! Stored binned ratio crossed rows over findable clusters
+DECLARE_SOA_COLUMN(TpcFoundOverFindableClsStore, tpcFoundOverFindableClsStore, binningClsRatio::binned_t);             //! Stored binned ratio of found over findable clusters
+DECLARE_SOA_COLUMN(TpcNClsCrossedRowsStore, tpcNClsCrossedRowsStore, uint8_t);                                         //! Stored number of crossed TPC rows
+DECLARE_SOA_COLUMN(TPCSignalStore, tpcSignalStore, binningTPCSignal::binned_t);                                        //! Stored binned TPC dE/dx
+
+DECLARE_SOA_DYNAMIC_COLUMN(DcaXY, dcaXY, [](binningDcaXY::binned_t v) -> float { return unpack<binningDcaXY>(v); });                                                       //! DCA xy in cm
+DECLARE_SOA_DYNAMIC_COLUMN(Eta, eta, [](binningEta::binned_t v) -> float { return unpack<binningEta>(v); });                                                               //! Pseudorapidity
+DECLARE_SOA_DYNAMIC_COLUMN(Phi, phi, [](binningPhi::binned_t v) -> float { return unpack<binningPhi>(v); });                                                               //! Azimuthal angle
+DECLARE_SOA_DYNAMIC_COLUMN(P, p, [](float pt, binningEta::binned_t eta) -> float { return pt * std::cosh(unpack<binningEta>(eta)); });                                     //! Total momentum in GeV/c
+DECLARE_SOA_DYNAMIC_COLUMN(TpcCrossedRowsOverFindableCls, tpcCrossedRowsOverFindableCls, [](binningClsRatio::binned_t v) -> float { return unpack<binningClsRatio>(v); }); //! Ratio crossed rows over findable clusters
+DECLARE_SOA_DYNAMIC_COLUMN(TpcFoundOverFindableCls, tpcFoundOverFindableCls, [](binningClsRatio::binned_t v) -> float { return unpack<binningClsRatio>(v); });             //! Ratio of found over findable clusters
+DECLARE_SOA_DYNAMIC_COLUMN(TpcNClsCrossedRows, tpcNClsCrossedRows, [](uint8_t v) -> float { return static_cast<float>(v); });                                              //! Number of crossed TPC rows
+DECLARE_SOA_DYNAMIC_COLUMN(TPCSignal, tpcSignal, [](binningTPCSignal::binned_t v) -> float { return unpack<binningTPCSignal>(v); });                                       //! TPC dE/dx
+} // namespace gammatrackreco_tiny
+
+DECLARE_SOA_TABLE(V0DaughterTracksTiny, "AOD", "V0TRACKSTINY",
+                  o2::soa::Index<>,
+                  v0data::V0Id,
+                  gammatrackreco_tiny::DcaXYStore,
+                  gammatrackreco_tiny::EtaStore,
+                  gammatrackreco_tiny::PhiStore,
+                  gammatrackreco::Pt,
+                  gammatrackreco::PositivelyCharged,
+                  gammatrackreco_tiny::TpcCrossedRowsOverFindableClsStore,
+                  gammatrackreco_tiny::TpcFoundOverFindableClsStore,
+                  gammatrackreco_tiny::TpcNClsCrossedRowsStore,
+                  pidtpc_tiny::TPCNSigmaStoreEl,
+                  pidtpc_tiny::TPCNSigmaStorePi,
+                  gammatrackreco_tiny::TPCSignalStore,
+                  // Dynamic columns
+                  gammatrackreco_tiny::DcaXY<gammatrackreco_tiny::DcaXYStore>,
+                  gammatrackreco_tiny::Eta<gammatrackreco_tiny::EtaStore>,
+                  gammatrackreco_tiny::Phi<gammatrackreco_tiny::PhiStore>,
+                  gammatrackreco_tiny::P<gammatrackreco::Pt, gammatrackreco_tiny::EtaStore>,
+                  gammatrackreco_tiny::TpcCrossedRowsOverFindableCls<gammatrackreco_tiny::TpcCrossedRowsOverFindableClsStore>,
+                  gammatrackreco_tiny::TpcFoundOverFindableCls<gammatrackreco_tiny::TpcFoundOverFindableClsStore>,
+                  gammatrackreco_tiny::TpcNClsCrossedRows<gammatrackreco_tiny::TpcNClsCrossedRowsStore>,
+                  pidtpc_tiny::TPCNSigmaEl<pidtpc_tiny::TPCNSigmaStoreEl>,
+                  pidtpc_tiny::TPCNSigmaPi<pidtpc_tiny::TPCNSigmaStorePi>,
+                  gammatrackreco_tiny::TPCSignal<gammatrackreco_tiny::TPCSignalStore>);
+
 namespace MCTracksTrue
 {
 DECLARE_SOA_COLUMN(SameMother, sameMother, bool); // Do the tracks have the same mother particle?
@@ -53,6 +53,7 @@
 #include "ReconstructionDataFormats/TrackFwd.h"
 #include "Common/Core/trackUtilities.h"
 
+#include <algorithm>
 #include <TMath.h> // for ATan2, Cos, Sin, Sqrt
 #include "TVector2.h"
 
@@ -72,6 +73,8 @@ struct skimmerGammaConversions {
   Configurable<std::string> url{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<int64_t> nolaterthan{"ccdb-no-later-than", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(), "latest acceptable timestamp of creation for the object"};
 
+  Configurable<bool> fTinyTables{"tinyTables", false, "write the V0 daughter tracks in the compact V0DaughterTracksTiny table instead of V0DaughterTracks"};
+
   HistogramRegistry fRegistry{
     "fRegistry",
     {
@@ -107,6 +110,7 @@ struct skimmerGammaConversions {
     {kGoodMcMother, "kGoodMcMother"}};
 
   Produces<aod::V0DaughterTracks> fFuncTableV0DaughterTracks;
+  Produces<aod::V0DaughterTracksTiny> fFuncTableV0DaughterTracksTiny;
   Produces<aod::McGammasTrue> fFuncTableMcGammasFromConfirmedV0s;
   Produces<aod::V0Recalculated> fFuncTableV0Recalculated;
   Produces<aod::V0DaughterMcParticles> fFuncTableMCTrackInformation;
@@ -167,6 +171,28 @@ struct skimmerGammaConversions {
   template <typename TV0, typename TTRACK>
   void fillTrackTable(TV0 const& theV0, TTRACK const& theTrack, bool theIsPositive)
   {
+    if (fTinyTables) {
+      using namespace o2::aod::gammatrackreco_tiny;
+      int8_t lNSigmaEl = 0, lNSigmaPi = 0;
+      auto lSetNSigmaEl = [&lNSigmaEl](int8_t theBinned) { lNSigmaEl = theBinned; };
+      auto lSetNSigmaPi = [&lNSigmaPi](int8_t theBinned) { lNSigmaPi = theBinned; };
+      o2::aod::pidutils::packInTable<o2::aod::pidtpc_tiny::binning>(theTrack.tpcNSigmaEl(), lSetNSigmaEl);
+      o2::aod::pidutils::packInTable<o2::aod::pidtpc_tiny::binning>(theTrack.tpcNSigmaPi(), lSetNSigmaPi);
+      fFuncTableV0DaughterTracksTiny(
+        theV0.v0Id(),
+        pack<binningDcaXY>(theTrack.dcaXY()),
+        pack<binningEta>(theTrack.eta()),
+        pack<binningPhi>(theTrack.phi()),
+        theTrack.pt(),
+        theIsPositive,
+        pack<binningClsRatio>(theTrack.tpcCrossedRowsOverFindableCls()),
+        pack<binningClsRatio>(theTrack.tpcFoundOverFindableCls()),
+        static_cast<uint8_t>(std::clamp<int>(theTrack.tpcNClsCrossedRows(), 0, 255)),
+        lNSigmaEl,
+        lNSigmaPi,
+        pack<binningTPCSignal>(theTrack.tpcSignal()));
+      return;
+    }
     fFuncTableV0DaughterTracks(
       theV0.v0Id(),
       theTrack.dcaXY(),
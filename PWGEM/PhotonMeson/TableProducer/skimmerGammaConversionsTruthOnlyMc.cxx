@@ -46,6 +46,10 @@ struct skimmerGammaConversionsTruthOnlyMc {
     },
   };
 
+  // the photons are selected with one scan of the PDG code column of the dataframe, then sliced per MC collision
+  Partition<aod::McParticles> fMcPhotons = aod::mcparticle::pdgCode == 22;
+  Preslice<aod::McParticles> fPerMcCollision = aod::mcparticle::mcCollisionId;
+
   void process(aod::McCollision const& theMcCollision,
                soa::SmallGroups<soa::Join<aod::McCollisionLabels,
                                           aod::Collisions>> const& theCollisions,
@@ -62,47 +66,45 @@ struct skimmerGammaConversionsTruthOnlyMc {
       registry.fill(HIST("hCollisionZ_MCRec"), lCollision.posZ());
     }
 
-    for (auto& lMcParticle : theMcParticles) {
-      if (lMcParticle.pdgCode() == 22) {
-
-        size_t lNDaughters = 0;
-        float lDaughter0Vx = -1.;
-        float lDaughter0Vy = -1.;
-        float lDaughter0Vz = -1.;
-        float lV0Radius = -1.;
-        int lastIndex0 = -1;
-        int lastIndex1 = -1;
-
-        if (lMcParticle.has_daughters()) {
-          auto lDaughters = lMcParticle.daughters_as<aod::McParticles>();
-          lNDaughters = lDaughters.size();
-          auto lDaughter0 = lDaughters.begin();
-          lDaughter0Vx = lDaughter0.vx();
-          lDaughter0Vy = lDaughter0.vy();
-          lDaughter0Vz = lDaughter0.vz();
-          lV0Radius = sqrt(pow(lDaughter0Vx, 2) + pow(lDaughter0Vy, 2));
-
-          if (lNDaughters == 2) {
-            auto lDaughter1 = lDaughters.iteratorAt(1);
-            fFuncTableMcDaughter(lDaughter0.p());
-            lastIndex0 = fFuncTableMcDaughter.lastIndex();
-            fFuncTableMcDaughter(lDaughter1.p());
-            lastIndex1 = fFuncTableMcDaughter.lastIndex();
-          }
+    auto lMcPhotons = fMcPhotons->sliceBy(fPerMcCollision, theMcCollision.globalIndex());
+    for (auto& lMcParticle : lMcPhotons) {
+      size_t lNDaughters = 0;
+      float lDaughter0Vx = -1.;
+      float lDaughter0Vy = -1.;
+      float lDaughter0Vz = -1.;
+      float lV0Radius = -1.;
+      int lastIndex0 = -1;
+      int lastIndex1 = -1;
+
+      if (lMcParticle.has_daughters()) {
+        auto lDaughters = lMcParticle.daughters_as<aod::McParticles>();
+        lNDaughters = lDaughters.size();
+        auto lDaughter0 = lDaughters.begin();
+        lDaughter0Vx = lDaughter0.vx();
+        lDaughter0Vy = lDaughter0.vy();
+        lDaughter0Vz = lDaughter0.vz();
+        lV0Radius = sqrt(pow(lDaughter0Vx, 2) + pow(lDaughter0Vy, 2));
+
+        if (lNDaughters == 2) {
+          auto lDaughter1 = lDaughters.iteratorAt(1);
+          fFuncTableMcDaughter(lDaughter0.p());
+          lastIndex0 = fFuncTableMcDaughter.lastIndex();
+          fFuncTableMcDaughter(lDaughter1.p());
+          lastIndex1 = fFuncTableMcDaughter.lastIndex();
         }
-        fFuncTableMcGammas(
-          lMcParticle.mcCollisionId(),
-          lMcParticle.globalIndex(),
-          -1, // V0Id when running in reconstructed task
-          lMcParticle.pdgCode(), lMcParticle.statusCode(), lMcParticle.flags(),
-          lMcParticle.px(), lMcParticle.py(), lMcParticle.pz(),
-          lMcParticle.vx(), lMcParticle.vy(), lMcParticle.vz(), lMcParticle.vt(),
-          lNDaughters,
-          lMcParticle.eta(), lMcParticle.phi(), lMcParticle.p(), lMcParticle.pt(), lMcParticle.y(),
-          lDaughter0Vx, lDaughter0Vy, lDaughter0Vz,
-          lV0Radius,
-          lastIndex0, lastIndex1);
       }
+      fFuncTableMcGammas(
+        lMcParticle.mcCollisionId(),
+        lMcParticle.globalIndex(),
+        -1, // V0Id when running in reconstructed task
+        lMcParticle.pdgCode(), lMcParticle.statusCode(), lMcParticle.flags(),
+        lMcParticle.px(), lMcParticle.py(), lMcParticle.pz(),
+        lMcParticle.vx(), lMcParticle.vy(), lMcParticle.vz(), lMcParticle.vt(),
+        lNDaughters,
+        lMcParticle.eta(), lMcParticle.phi(), lMcParticle.p(), lMcParticle.pt(), lMcParticle.y(),
+        lDaughter0Vx, lDaughter0Vy, lDaughter0Vz,
+        lV0Radius,
+        lastIndex0, lastIndex1);
     }
   }
 };
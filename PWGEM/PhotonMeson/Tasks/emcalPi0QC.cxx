@@ -15,6 +15,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include <math.h>
 
@@ -35,8 +36,7 @@
 
 #include "CommonDataFormat/InteractionRecord.h"
 
-#include "TLorentzVector.h"
-#include "TVector3.h"
+#include "PWGEM/PhotonMeson/Utils/photonPairing.h"
 
 // \struct Pi0QCTask
 /// \brief Simple monitoring task for EMCal clusters
@@ -56,48 +56,8 @@ using selectedClusters = o2::soa::Filtered<o2::aod::EMCALClusters>;
 using selectedCluster = o2::soa::Filtered<o2::aod::EMCALCluster>;
 using selectedAmbiguousClusters = o2::soa::Filtered<o2::aod::EMCALAmbiguousClusters>;
 using selectedAmbiguousCluster = o2::soa::Filtered<o2::aod::EMCALAmbiguousCluster>;
-
-struct Photon {
-  Photon(float eta_tmp, float phi_tmp, float energy_tmp, int clusid = 0)
-  {
-    eta = eta_tmp;
-    phi = phi_tmp;
-    energy = energy_tmp;
-    theta = 2 * std::atan2(std::exp(-eta), 1);
-    px = energy * std::sin(theta) * std::cos(phi);
-    py = energy * std::sin(theta) * std::sin(phi);
-    pz = energy * std::cos(theta);
-    pt = std::sqrt(px * px + py * py);
-    photon.SetPxPyPzE(px, py, pz, energy);
-    id = clusid;
-  }
-
-  TLorentzVector photon;
-  float pt;
-  float px;
-  float py;
-  float pz;
-  float eta;
-  float phi;
-  float energy;
-  float theta;
-  int id;
-};
-
-struct Meson {
-  Meson(Photon p1, Photon p2) : pgamma1(p1),
-                                pgamma2(p2)
-  {
-    pMeson = p1.photon + p2.photon;
-  }
-  Photon pgamma1;
-  Photon pgamma2;
-  TLorentzVector pMeson;
-
-  float getMass() const { return pMeson.M(); };
-  float getPt() const { return pMeson.Pt(); };
-  float getOpeningAngle() const { return pgamma1.photon.Angle(pgamma2.photon.Vect()); };
-};
+using o2::pwgem::photonmeson::PhotonCandidates;
+using o2::pwgem::photonmeson::PhotonMixingPool;
 
 struct Pi0QCTask {
   HistogramRegistry mHistManager{"NeutralMesonHistograms"};
@@ -116,6 +76,10 @@ struct Pi0QCTask {
   Configurable<float> mMinEnergyCut{"MinEnergyCut", 0.7, "apply min cluster energy cut"};
   Configurable<int> mMinNCellsCut{"MinNCellsCut", 1, "apply min cluster number of cell cut"};
   Configurable<std::string> mClusterDefinition{"clusterDefinition", "kV3Default", "cluster definition to be selected, e.g. V3Default"};
+  Configurable<bool> mDoMixing{"doMixing", false, "build the mixed-event background"};
+  Configurable<int> mMixingDepth{"mixingDepth", 10, "number of events per z-vertex bin kept in the mixing pool"};
+  Configurable<int> mMixingNBinsZ{"mixingNBinsZ", 10, "number of z-vertex bins of the mixing pool"};
+  Configurable<float> mMixingZMax{"mixingZMax", 10.f, "maximum |z-vertex| of the events in the mixing pool (cm)"};
   std::vector<int> mVetoBCIDs;
   std::vector<int> mSelectBCIDs;
 
@@ -126,7 +90,14 @@ struct Pi0QCTask {
   Filter clusterDefinitionSelection = o2::aod::emcalcluster::definition == static_cast<int>(clusDef);
 
   // define container for photons
-  std::vector<Photon> mPhotons;
+  PhotonCandidates mPhotons;
+  PhotonCandidates mRotatedPhotons;                                    // rotated photons of the rotation background
+  std::vector<std::pair<unsigned int, unsigned int>> mMesonCandidates; // photon indices of the same-event meson candidates
+  PhotonMixingPool mMixingPool;                                        // photons of the previous events, persistent across the data frames
+  std::vector<float> mPairBuffer;                                      // masses and pT of the pairs of one photon
+  std::shared_ptr<TH2> mHistInvMassVsPt;
+  std::shared_ptr<TH2> mHistInvMassVsPtBackground;
+  std::shared_ptr<TH2> mHistInvMassVsPtMixedBackground;
 
   /// \brief Create output histograms and initialize geometry
   void init(InitContext const&)
@@ -164,6 +135,14 @@ struct Pi0QCTask {
     // meson related histograms
     mHistManager.add("invMassVsPt", "invariant mass and pT of meson candidates", o2HistType::kTH2F, {{400, 0, 0.8}, {energyAxis}});
     mHistManager.add("invMassVsPtBackground", "invariant mass and pT of background meson candidates", o2HistType::kTH2F, {{400, 0, 0.8}, {energyAxis}});
+    mHistManager.add("invMassVsPtMixedBackground", "invariant mass and pT of mixed-event background meson candidates", o2HistType::kTH2F, {{400, 0, 0.8}, {energyAxis}});
+    // histograms filled for each photon pair, looked up once
+    mHistInvMassVsPt = mHistManager.get<TH2>(HIST("invMassVsPt"));
+    mHistInvMassVsPtBackground = mHistManager.get<TH2>(HIST("invMassVsPtBackground"));
+    mHistInvMassVsPtMixedBackground = mHistManager.get<TH2>(HIST("invMassVsPtMixedBackground"));
+    if (mDoMixing) {
+      mMixingPool.init(mMixingNBinsZ, -mMixingZMax, mMixingZMax, mMixingDepth);
+    }
 
     if (mVetoBCID->length()) {
       std::stringstream parser(mVetoBCID.value);
@@ -283,7 +262,7 @@ struct Pi0QCTask {
 
       // put clusters in photon vector
       // ToDo: At the moment, the eta and phi values are not corrected for a shift of the primary vertex! Should only be a small effect but has to be corrected
-      mPhotons.push_back(Photon(cluster.eta(), cluster.phi(), cluster.energy(), cluster.id()));
+      mPhotons.pushEtaPhiE(cluster.eta(), cluster.phi(), cluster.energy(), cluster.id());
     }
   }
 
@@ -291,65 +270,67 @@ struct Pi0QCTask {
   template <typename Clusters>
   void ProcessMesons(collisionEvSelIt const& theCollision, Clusters const& clusters, o2::aod::BCs const& bcs)
   {
+    // mixed-event background with the photons of the previous events of the same z-vertex bin
+    if (mDoMixing) {
+      int zBin = mMixingPool.getBin(theCollision.posZ());
+      mMixingPool.forEachMixedPair(zBin, mPhotons, mPairBuffer, [this](std::size_t, std::size_t, float mass, float pt) {
+        mHistInvMassVsPtMixedBackground->Fill(mass, pt);
+      });
+      mMixingPool.add(zBin, mPhotons);
+    }
+
     // if less then 2 clusters are found, skip event
     if (mPhotons.size() < 2) {
       return;
     }
 
     // loop over all photon combinations and build meson candidates
-    for (unsigned int ig1 = 0; ig1 < mPhotons.size(); ++ig1) {
-      for (unsigned int ig2 = ig1 + 1; ig2 < mPhotons.size(); ++ig2) {
-
-        // build meson from photons
-        Meson meson(mPhotons[ig1], mPhotons[ig2]);
-        mHistManager.fill(HIST("invMassVsPt"), meson.getMass(), meson.getPt());
-
-        // calculate background candidates (rotation background)
-        CalculateBackground(meson, ig1, ig2);
-      }
+    mMesonCandidates.clear();
+    o2::pwgem::photonmeson::forEachPair(mPhotons, mPairBuffer, [this](std::size_t ig1, std::size_t ig2, float mass, float pt) {
+      mHistInvMassVsPt->Fill(mass, pt);
+      mMesonCandidates.emplace_back(ig1, ig2);
+    });
+
+    // calculate background candidates (rotation background)
+    for (const auto& [ig1, ig2] : mMesonCandidates) {
+      CalculateBackground(ig1, ig2);
     }
   }
 
   /// \brief Calculate background (using rotation background method)
-  void CalculateBackground(const Meson& meson, unsigned int ig1, unsigned int ig2)
+  void CalculateBackground(unsigned int ig1, unsigned int ig2)
   {
     // if less than 3 clusters are present, skip event
     if (mPhotons.size() < 3) {
       return;
     }
-    const double rotationAngle = M_PI / 2.0; //0.78539816339; // rotaion angle 90°
 
-    TLorentzVector lvRotationPhoton1; // photon candidates which get rotated
-    TLorentzVector lvRotationPhoton2; // photon candidates which get rotated
-    TVector3 lvRotationPion;          // rotation axis
-    for (unsigned int ig3 = 0; ig3 < mPhotons.size(); ++ig3) {
+    // rotate the two photons by 90 degrees around the meson momentum: p -> k x p + k (k.p), with k the unit axis
+    float kx = mPhotons.px[ig1] + mPhotons.px[ig2];
+    float ky = mPhotons.py[ig1] + mPhotons.py[ig2];
+    float kz = mPhotons.pz[ig1] + mPhotons.pz[ig2];
+    float norm = std::sqrt(kx * kx + ky * ky + kz * kz);
+    if (norm <= 0.f) {
+      return;
+    }
+    kx /= norm;
+    ky /= norm;
+    kz /= norm;
+    mRotatedPhotons.clear();
+    for (auto ig : {ig1, ig2}) {
+      float px = mPhotons.px[ig], py = mPhotons.py[ig], pz = mPhotons.pz[ig];
+      float kp = kx * px + ky * py + kz * pz;
+      mRotatedPhotons.push(mPhotons.energy[ig], ky * pz - kz * py + kx * kp, kz * px - kx * pz + ky * kp, kx * py - ky * px + kz * kp, mPhotons.id[ig]);
+    }
+
+    // build mesons from the rotated photons and the other photons of the event
+    o2::pwgem::photonmeson::forEachPair(mRotatedPhotons, mPhotons, mPairBuffer, [this, ig1, ig2](std::size_t, std::size_t ig3, float mass, float pt) {
       // continue if photons are identical
       if (ig3 == ig1 || ig3 == ig2) {
-        continue;
+        return;
       }
-      // calculate rotation axis
-      lvRotationPion = (meson.pMeson).Vect();
-
-      // initialize photons for rotation
-      lvRotationPhoton1.SetPxPyPzE(mPhotons[ig1].px, mPhotons[ig1].py, mPhotons[ig1].pz, mPhotons[ig1].energy);
-      lvRotationPhoton2.SetPxPyPzE(mPhotons[ig2].px, mPhotons[ig2].py, mPhotons[ig2].pz, mPhotons[ig2].energy);
-
-      // rotate photons around rotation axis
-      lvRotationPhoton1.Rotate(rotationAngle, lvRotationPion);
-      lvRotationPhoton2.Rotate(rotationAngle, lvRotationPion);
-
-      // initialize Photon objects for rotated photons
-      Photon rotPhoton1(lvRotationPhoton1.Eta(), lvRotationPhoton1.Phi(), lvRotationPhoton1.E(), mPhotons[ig1].id);
-      Photon rotPhoton2(lvRotationPhoton2.Eta(), lvRotationPhoton2.Phi(), lvRotationPhoton2.E(), mPhotons[ig2].id);
-
-      // build meson from rotated photons
-      Meson mesonRotated1(rotPhoton1, mPhotons[ig3]);
-      Meson mesonRotated2(rotPhoton2, mPhotons[ig3]);
-
-      // Fill histograms
-      mHistManager.fill(HIST("invMassVsPtBackground"), mesonRotated1.getMass(), mesonRotated1.getPt());
-      mHistManager.fill(HIST("invMassVsPtBackground"), mesonRotated2.getMass(), mesonRotated2.getPt());
-    }
+      mHistInvMassVsPtBackground->Fill(mass, pt);
+    });
   }
 
   /// \brief Create binning for cluster energy/pT axis (variable bin size)
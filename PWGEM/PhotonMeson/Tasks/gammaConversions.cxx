@@ -31,6 +31,7 @@ using namespace o2::framework::expressions;
 
 using V0DatasAdditional = soa::Join<aod::V0Datas, aod::V0Recalculated>;
 using V0DaughterTracksWithMC = soa::Join<aod::V0DaughterTracks, aod::MCParticleIndex>;
+using V0DaughterTracksTinyWithMC = soa::Join<aod::V0DaughterTracksTiny, aod::MCParticleIndex>;
 
 // using collisionEvSelIt = soa::Join<aod::Collisions, aod::EvSels>::iterator;
 struct GammaConversions {
@@ -196,11 +197,17 @@ struct GammaConversions {
       }
     };
 
-    if (doprocessRec && doprocessMc) {
+    // the tiny versions run on the compact track table, otherwise they are identical
+    bool lDoProcessRec = doprocessRec || doprocessRecTiny;
+    bool lDoProcessMc = doprocessMc || doprocessMcTiny;
+    if (lDoProcessRec && lDoProcessMc) {
       LOGF(fatal, "Cannot enable doprocessRec and doprocessMc at the same time. Please choose one.");
     }
+    if ((doprocessRec && doprocessRecTiny) || (doprocessMc && doprocessMcTiny)) {
+      LOGF(fatal, "Cannot enable the process functions on V0DaughterTracks and V0DaughterTracksTiny at the same time. Please choose one.");
+    }
 
-    if (doprocessRec) {
+    if (lDoProcessRec) {
       fHistoSuffixes[0] = "Rec";
     }
 
@@ -208,16 +215,16 @@ struct GammaConversions {
       fHistogramRegistry,
       lSpecialHistoDefinitions,
       nullptr /*theSuffix*/,
-      doprocessRec /*theCheckDataOnly*/);
+      lDoProcessRec /*theCheckDataOnly*/);
 
     // do some labeling
     addLablesToHisto1D(fMyRegistry.mV0.mSpecialHistos.mContainer, "hV0Selection", fPhotonCutLabels);
-    if (doprocessMc) {
+    if (lDoProcessMc) {
       addLablesToHisto1D(fMyRegistry.mV0.mSpecialHistos.mContainer, "hV0McValidation", fV0McValidationLabels);
     }
 
     for (size_t iBARecCuts = 0; iBARecCuts < 2; ++iBARecCuts) {
-      for (size_t iMcKind = 0; iMcKind < (doprocessMc ? 4 : 1); ++iMcKind) {
+      for (size_t iMcKind = 0; iMcKind < (lDoProcessMc ? 4 : 1); ++iMcKind) {
         std::string const* lMcSuffix = &fHistoSuffixes[iMcKind];
 
         // for track and collision histos we only plot reconstructed quantities at the moment
@@ -247,7 +254,7 @@ struct GammaConversions {
                                                                                                       lMcSuffix);
         }
 
-        if (doprocessMc) {
+        if (lDoProcessMc) {
           // v0 mc rejection histos
           for (size_t iRejReason = 0; iRejReason < 2; ++iRejReason) {
             fMyRegistry.mV0.mRejectedByMc[iRejReason].mBeforeAfterRecCuts[iBARecCuts].mV0Kind[iMcKind].addHistosToOfficalRegistry(fHistogramRegistry,
@@ -600,10 +607,13 @@ struct GammaConversions {
   }
 
   Preslice<aod::V0DaughterTracks> perV0 = aod::v0data::v0Id;
+  Preslice<aod::V0DaughterTracksTiny> perV0Tiny = aod::v0data::v0Id;
 
-  void processRec(aod::Collisions::iterator const& theCollision,
-                  V0DatasAdditional const& theV0s,
-                  aod::V0DaughterTracks const& theAllTracks)
+  template <typename TTRACKS, typename TPRESLICE>
+  void runRec(aod::Collisions::iterator const& theCollision,
+              V0DatasAdditional const& theV0s,
+              TTRACKS const& theAllTracks,
+              TPRESLICE const& thePerV0)
   {
     fillTH1(fMyRegistry.mCollision.mBeforeAfterRecCuts[kBeforeRecCuts].mV0Kind[kRec].mContainer,
             "hCollisionZ",
@@ -611,7 +621,7 @@ struct GammaConversions {
 
     for (auto& lV0 : theV0s) {
 
-      auto lTwoV0Daughters = theAllTracks.sliceBy(perV0, lV0.v0Id());
+      auto lTwoV0Daughters = theAllTracks.sliceBy(thePerV0, lV0.v0Id());
       float lV0CosinePA = lV0.v0cosPA(theCollision.posX(), theCollision.posY(), theCollision.posZ());
 
       if (!processV0(lV0, lV0CosinePA, lTwoV0Daughters)) {
@@ -619,15 +629,31 @@ struct GammaConversions {
       }
     }
   }
+
+  void processRec(aod::Collisions::iterator const& theCollision,
+                  V0DatasAdditional const& theV0s,
+                  aod::V0DaughterTracks const& theAllTracks)
+  {
+    runRec(theCollision, theV0s, theAllTracks, perV0);
+  }
   PROCESS_SWITCH(GammaConversions, processRec, "process reconstructed info", true);
 
+  void processRecTiny(aod::Collisions::iterator const& theCollision,
+                      V0DatasAdditional const& theV0s,
+                      aod::V0DaughterTracksTiny const& theAllTracks)
+  {
+    runRec(theCollision, theV0s, theAllTracks, perV0Tiny);
+  }
+  PROCESS_SWITCH(GammaConversions, processRecTiny, "process reconstructed info, with the compact V0 daughter track table", false);
+
   Preslice<aod::McGammasTrue> gperV0 = aod::v0data::v0Id;
 
-  void processMc(aod::Collisions::iterator const& theCollision,
-                 V0DatasAdditional const& theV0s,
-                 V0DaughterTracksWithMC const& theAllTracks,
-                 aod::V0DaughterMcParticles const& TheAllTracksMC,
-                 aod::McGammasTrue const& theV0sTrue)
+  template <typename TTRACKS, typename TPRESLICE>
+  void runMc(aod::Collisions::iterator const& theCollision,
+             V0DatasAdditional const& theV0s,
+             TTRACKS const& theAllTracks,
+             TPRESLICE const& thePerV0,
+             aod::McGammasTrue const& theV0sTrue)
   {
     fillTH1(fMyRegistry.mCollision.mBeforeAfterRecCuts[kBeforeRecCuts].mV0Kind[kRec].mContainer,
             "hCollisionZ",
@@ -635,7 +661,7 @@ struct GammaConversions {
 
     for (auto& lV0 : theV0s) {
 
-      auto lTwoV0Daughters = theAllTracks.sliceBy(perV0, lV0.v0Id());
+      auto lTwoV0Daughters = theAllTracks.sliceBy(thePerV0, lV0.v0Id());
       float lV0CosinePA = lV0.v0cosPA(theCollision.posX(), theCollision.posY(), theCollision.posZ());
 
       // check if V0 passes rec cuts and fill beforeRecCuts,afterRecCuts [kRec]
@@ -663,8 +689,27 @@ struct GammaConversions {
                       McParticleMomentum);
     }
   }
+
+  void processMc(aod::Collisions::iterator const& theCollision,
+                 V0DatasAdditional const& theV0s,
+                 V0DaughterTracksWithMC const& theAllTracks,
+                 aod::V0DaughterMcParticles const& TheAllTracksMC,
+                 aod::McGammasTrue const& theV0sTrue)
+  {
+    runMc(theCollision, theV0s, theAllTracks, perV0, theV0sTrue);
+  }
   PROCESS_SWITCH(GammaConversions, processMc, "process reconstructed info and mc", false);
 
+  void processMcTiny(aod::Collisions::iterator const& theCollision,
+                     V0DatasAdditional const& theV0s,
+                     V0DaughterTracksTinyWithMC const& theAllTracks,
+                     aod::V0DaughterMcParticles const& TheAllTracksMC,
+                     aod::McGammasTrue const& theV0sTrue)
+  {
+    runMc(theCollision, theV0s, theAllTracks, perV0Tiny, theV0sTrue);
+  }
+  PROCESS_SWITCH(GammaConversions, processMcTiny, "process reconstructed info and mc, with the compact V0 daughter track table", false);
+
   template <typename T>
   std::shared_ptr<T> getTH(mapStringHistPtr const& theMap, std::string const& theName)
   {
@@ -0,0 +1,191 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file photonPairing.h
+/// \brief Photon-photon pairing for the neutral-meson analyses
+///
+/// The photon candidates of an event are stored as flat arrays (E, px, py, pz, identifier, flags) and the invariant
+/// mass and pT of all the pairs are computed in plain loops over these arrays, which the compiler can vectorise.
+/// A pool of photons of previous events, binned in z-vertex, provides the mixed-event pairs.
+
+#ifndef PWGEM_PHOTONMESON_UTILS_PHOTONPAIRING_H_
+#define PWGEM_PHOTONMESON_UTILS_PHOTONPAIRING_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace o2::pwgem::photonmeson
+{
+
+/// Photon candidates of one event
+struct PhotonCandidates {
+  std::vector<float> energy;
+  std::vector<float> px;
+  std::vector<float> py;
+  std::vector<float> pz;
+  std::vector<int> id;        // identifier of the candidate (e.g. cluster or V0 index)
+  std::vector<uint8_t> flags; // user bits (e.g. selections passed by the candidate)
+
+  void clear()
+  {
+    for (auto* column : {&energy, &px, &py, &pz}) {
+      column->clear();
+    }
+    id.clear();
+    flags.clear();
+  }
+
+  void reserve(std::size_t n)
+  {
+    for (auto* column : {&energy, &px, &py, &pz}) {
+      column->reserve(n);
+    }
+    id.reserve(n);
+    flags.reserve(n);
+  }
+
+  std::size_t size() const { return energy.size(); }
+
+  void push(float energyPhoton, float pxPhoton, float pyPhoton, float pzPhoton, int idPhoton = 0, uint8_t flagsPhoton = 0)
+  {
+    energy.push_back(energyPhoton);
+    px.push_back(pxPhoton);
+    py.push_back(pyPhoton);
+    pz.push_back(pzPhoton);
+    id.push_back(idPhoton);
+    flags.push_back(flagsPhoton);
+  }
+
+  /// Adds a massless photon from its direction and energy (e.g. a calorimeter cluster)
+  void pushEtaPhiE(float eta, float phi, float energyPhoton, int idPhoton = 0, uint8_t flagsPhoton = 0)
+  {
+    float pt = energyPhoton / std::cosh(eta);
+    push(energyPhoton, pt * std::cos(phi), pt * std::sin(phi), pt * std::sinh(eta), idPhoton, flagsPhoton);
+  }
+};
+
+/// Invariant mass and pT of the pairs of photon i of a with the photons [jFirst, jLast) of b
+/// \param mass,pt  output arrays of at least jLast - jFirst elements
+inline void pairKinematics(const PhotonCandidates& a, std::size_t i, const PhotonCandidates& b, std::size_t jFirst, std::size_t jLast, float* mass, float* pt)
+{
+  const float e1 = a.energy[i];
+  const float px1 = a.px[i];
+  const float py1 = a.py[i];
+  const float pz1 = a.pz[i];
+  const float* e2 = b.energy.data();
+  const float* px2 = b.px.data();
+  const float* py2 = b.py.data();
+  const float* pz2 = b.pz.data();
+  for (std::size_t j = jFirst; j < jLast; ++j) {
+    const float e = e1 + e2[j];
+    const float px = px1 + px2[j];
+    const float py = py1 + py2[j];
+    const float pz = pz1 + pz2[j];
+    const float pt2 = px * px + py * py;
+    const float m2 = e * e - pt2 - pz * pz;
+    mass[j - jFirst] = m2 > 0.f ? std::sqrt(m2) : 0.f;
+    pt[j - jFirst] = std::sqrt(pt2);
+  }
+}
+
+/// Calls f(i, j, mass, pt) for all the pairs i < j of photons of the same event
+template <typename F>
+void forEachPair(const PhotonCandidates& photons, std::vector<float>& buffer, F&& f)
+{
+  const std::size_t n = photons.size();
+  buffer.resize(2 * n);
+  for (std::size_t i = 0; i + 1 < n; ++i) {
+    const std::size_t nPairs = n - i - 1;
+    pairKinematics(photons, i, photons, i + 1, n, buffer.data(), buffer.data() + nPairs);
+    for (std::size_t k = 0; k < nPairs; ++k) {
+      f(i, i + 1 + k, buffer[k], buffer[nPairs + k]);
+    }
+  }
+}
+
+/// Calls f(i, j, mass, pt) for all the pairs of photon i of a with photon j of b
+template <typename F>
+void forEachPair(const PhotonCandidates& a, const PhotonCandidates& b, std::vector<float>& buffer, F&& f)
+{
+  const std::size_t n = b.size();
+  buffer.resize(2 * n);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    pairKinematics(a, i, b, 0, n, buffer.data(), buffer.data() + n);
+    for (std::size_t j = 0; j < n; ++j) {
+      f(i, j, buffer[j], buffer[n + j]);
+    }
+  }
+}
+
+/// Photons of the previous events, binned in z-vertex, for the event mixing
+/// NOTE: the pool is kept by the task and persists across the data frames
+class PhotonMixingPool
+{
+ public:
+  /// \param nBinsZ,zMin,zMax  binning in z-vertex
+  /// \param depth  number of events kept per bin
+  void init(int nBinsZ, float zMin, float zMax, std::size_t depth)
+  {
+    mNBinsZ = nBinsZ;
+    mZMin = zMin;
+    mZMax = zMax;
+    mDepth = depth;
+    mBins.assign(nBinsZ, {});
+  }
+
+  /// \return z-vertex bin of the event, -1 if outside the binning
+  int getBin(float z) const
+  {
+    if (mNBinsZ <= 0 || z < mZMin || z >= mZMax) {
+      return -1;
+    }
+    return static_cast<int>((z - mZMin) / (mZMax - mZMin) * mNBinsZ);
+  }
+
+  /// Calls f(i, j, mass, pt) for all the pairs of the photons of the event with the photons of the pooled events of the same bin
+  template <typename F>
+  void forEachMixedPair(int bin, const PhotonCandidates& photons, std::vector<float>& buffer, F&& f) const
+  {
+    if (bin < 0) {
+      return;
+    }
+    for (const auto& pooled : mBins[bin]) {
+      forEachPair(photons, pooled, buffer, f);
+    }
+  }
+
+  /// Adds the photons of the event to the pool, removing the oldest event of the bin if the pool is full
+  void add(int bin, const PhotonCandidates& photons)
+  {
+    if (bin < 0 || mDepth == 0 || photons.size() == 0) {
+      return;
+    }
+    auto& events = mBins[bin];
+    if (events.size() == mDepth) {
+      events.pop_front();
+    }
+    events.push_back(photons);
+  }
+
+ private:
+  int mNBinsZ = 0;
+  float mZMin = 0.f;
+  float mZMax = 0.f;
+  std::size_t mDepth = 0;
+  std::vector<std::deque<PhotonCandidates>> mBins;
+};
+
+} // namespace o2::pwgem::photonmeson
+
+#endif // PWGEM_PHOTONMESON_UTILS_PHOTONPAIRING_H_
@@ -0,0 +1,134 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HfMlApplicator.h
+/// \brief Application of ONNX ML models to the heavy-flavour candidates of a dataframe
+///
+/// The input features of all the candidates are written directly into one preallocated [nCandidates x nFeatures]
+/// tensor and the model is run once for all of them. Models exported with a fixed batch size are run candidate by
+/// candidate on the same tensor.
+
+#ifndef PWGHF_CORE_HFMLAPPLICATOR_H_
+#define PWGHF_CORE_HFMLAPPLICATOR_H_
+
+#include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Framework/Logger.h"
+#include "Common/Core/ONNXSessionRegistry.h"
+
+namespace o2::analysis
+{
+
+class HfMlApplicator
+{
+ public:
+  /// Loads the model, shared with the other users of the same file in the process
+  /// \param modelFile is the local ONNX file of the model
+  /// \param settings are the ONNX session settings (threads, graph optimisation, memory pattern)
+  void init(std::string const& modelFile, ONNXSessionSettings const& settings = ONNXSessionSettings())
+  {
+    mSession = ONNXSessionRegistry::instance().getSession(ONNXSessionRegistry::makeKey(modelFile), modelFile, settings);
+    mInputNames = mSession->GetInputNames();
+    mOutputNames = mSession->GetOutputNames();
+    auto inputShapes = mSession->GetInputShapes();
+    mNFeatures = inputShapes[0].back();
+    mDynamicBatch = inputShapes[0][0] < 0;
+    if (mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+      LOG(fatal) << "ONNX model " << modelFile << " does not take float inputs";
+    }
+    auto outputShapes = mSession->GetOutputShapes();
+    mNClasses = outputShapes.back().back() > 0 ? outputShapes.back().back() : 1;
+    LOG(info) << "ONNX model " << modelFile << ": " << mNFeatures << " input features, " << mNClasses << " output scores" << (mDynamicBatch ? ", batch inference" : "");
+  }
+
+  bool isInitialised() const { return mSession != nullptr; }
+  int getNFeatures() const { return mNFeatures; }
+  int getNClasses() const { return mNClasses; }
+
+  /// Resets the candidates, keeping the allocated tensor
+  /// \param nCandidatesMax is the expected number of candidates, to allocate the tensor once
+  void clear(std::size_t nCandidatesMax = 0)
+  {
+    mNCandidates = 0;
+    mFeatures.reserve(nCandidatesMax * mNFeatures);
+    mFeatures.clear();
+    mScores.clear();
+  }
+
+  /// Adds a candidate
+  /// \return pointer to the getNFeatures() input features of the candidate, to be filled by the caller
+  float* addCandidate()
+  {
+    mFeatures.resize((mNCandidates + 1) * mNFeatures);
+    return mFeatures.data() + mNCandidates++ * mNFeatures;
+  }
+
+  /// Runs the model on all the added candidates
+  void evaluate()
+  {
+    mScores.assign(mNCandidates * mNClasses, -1.f);
+    if (mNCandidates == 0) {
+      return;
+    }
+    if (mDynamicBatch) {
+      run(0, mNCandidates);
+    } else {
+      for (std::size_t iCand = 0; iCand < mNCandidates; ++iCand) {
+        run(iCand, 1);
+      }
+    }
+  }
+
+  /// \return output score iClass of the candidate iCand, -1 if the inference failed
+  float getScore(std::size_t iCand, int iClass) const { return mScores[iCand * mNClasses + iClass]; }
+
+ private:
+  /// Runs the model on nCand candidates starting from iCandFirst
+  void run(std::size_t iCandFirst, std::size_t nCand)
+  {
+    std::vector<int64_t> inputShape{static_cast<int64_t>(nCand), static_cast<int64_t>(mNFeatures)};
+    std::vector<Ort::Value> inputTensors;
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(mFeatures.data() + iCandFirst * mNFeatures, nCand * mNFeatures, inputShape));
+    try {
+      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+      // converted classifiers return the labels first and the scores as last output
+      const auto& scores = outputTensors.back();
+      if (scores.GetTensorTypeAndShapeInfo().GetElementCount() != nCand * mNClasses) {
+        LOG(error) << "Unexpected size of the output tensor of the ML model";
+        return;
+      }
+      const float* values = scores.GetTensorData<float>();
+      std::copy(values, values + nCand * mNClasses, mScores.begin() + iCandFirst * mNClasses);
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+    }
+  }
+
+  std::shared_ptr<Ort::Experimental::Session> mSession = nullptr;
+  std::vector<std::string> mInputNames;
+  std::vector<std::string> mOutputNames;
+  int mNFeatures{0};            // number of input features of the model
+  int mNClasses{1};             // number of output scores per candidate
+  bool mDynamicBatch{false};    // the model accepts any number of candidates per run
+  std::size_t mNCandidates{0};  // number of candidates added since clear
+  std::vector<float> mFeatures; // [nCandidates x nFeatures] input tensor, reused between dataframes
+  std::vector<float> mScores;   // [nCandidates x nClasses] output scores
+};
+
+} // namespace o2::analysis
+
+#endif // PWGHF_CORE_HFMLAPPLICATOR_H_
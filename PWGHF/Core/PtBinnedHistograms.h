@@ -0,0 +1,112 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PtBinnedHistograms.h
+/// \brief Filling of the candidate variables vs pT of the heavy-flavour tasks
+///
+/// The tasks fill one 2D histogram per variable, with the variable on x and the candidate pT on y, all with the
+/// same pT binning. Here the pT bin of the candidate is found once and the x bin of each variable is computed from
+/// the axis limits stored at init, so that the bin content is incremented directly, without the lookup of the
+/// histogram in the registry and the search of the two axes per variable.
+
+#ifndef PWGHF_CORE_PTBINNEDHISTOGRAMS_H_
+#define PWGHF_CORE_PTBINNEDHISTOGRAMS_H_
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <TH2.h>
+
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+class PtBinnedHistograms
+{
+ public:
+  /// Adds a histogram, the position in the order of the calls is the index of the variable in fill
+  /// \param hist histogram with the variable on x and the pT on y, with the pT binning of the first histogram
+  void add(std::shared_ptr<TH2> const& hist)
+  {
+    const auto* axisPt = hist->GetYaxis();
+    if (mHists.empty()) {
+      mBinsPt.resize(axisPt->GetNbins() + 1);
+      for (int iBin = 0; iBin <= axisPt->GetNbins(); ++iBin) {
+        mBinsPt[iBin] = axisPt->GetBinLowEdge(iBin + 1);
+      }
+    } else if (axisPt->GetNbins() + 1 != static_cast<int>(mBinsPt.size()) || axisPt->GetXmin() != mBinsPt.front() || axisPt->GetXmax() != mBinsPt.back()) {
+      LOGF(fatal, "Histogram %s does not have the pT binning of %s", hist->GetName(), mHists.front().hist->GetName());
+    }
+    const auto* axis = hist->GetXaxis();
+    VariableHist variable;
+    variable.hist = hist.get();
+    variable.nBins = axis->GetNbins();
+    variable.min = axis->GetXmin();
+    variable.max = axis->GetXmax();
+    // the variable bins and the errors are left to ROOT
+    variable.useFill = axis->IsVariableBinSize() || hist->GetSumw2N() > 0;
+    mHists.push_back(variable);
+    mOwners.push_back(hist);
+  }
+
+  /// Finds the pT bin of the candidate, to be called before the fill of its variables
+  void setPt(double pt)
+  {
+    mPt = pt;
+    // same bin as TAxis::FindFixBin, with the under- and overflow
+    if (pt < mBinsPt.front()) {
+      mBinPt = 0;
+    } else if (pt < mBinsPt.back()) {
+      mBinPt = std::upper_bound(mBinsPt.begin(), mBinsPt.end(), pt) - mBinsPt.begin();
+    } else {
+      mBinPt = mBinsPt.size();
+    }
+  }
+
+  /// Fills the variable of the candidate in the pT bin set by setPt
+  /// \param iVar index of the variable, in the order of add
+  void fill(int iVar, double value)
+  {
+    auto& variable = mHists[iVar];
+    if (variable.useFill) {
+      variable.hist->Fill(value, mPt);
+      return;
+    }
+    // same bin as TAxis::FindFixBin for a fixed bin size
+    int bin = 0;
+    if (!(value < variable.min)) {
+      bin = value < variable.max ? 1 + static_cast<int>(variable.nBins * (value - variable.min) / (variable.max - variable.min)) : variable.nBins + 1;
+    }
+    variable.hist->AddBinContent(bin + (variable.nBins + 2) * mBinPt);
+    variable.hist->SetEntries(variable.hist->GetEntries() + 1);
+  }
+
+ private:
+  struct VariableHist {
+    TH2* hist = nullptr;
+    int nBins = 0;        ///< number of bins of the x axis
+    double min = 0.;      ///< lower limit of the x axis
+    double max = 0.;      ///< upper limit of the x axis
+    bool useFill = false; ///< filled with TH2::Fill
+  };
+
+  std::vector<VariableHist> mHists;
+  std::vector<std::shared_ptr<TH2>> mOwners; ///< histograms kept alive with the registry
+  std::vector<double> mBinsPt;               ///< pT bin edges of the histograms
+  double mPt = 0.;                           ///< pT of the current candidate
+  int mBinPt = 0;                            ///< pT bin of the current candidate, with 0 for the underflow
+};
+
+} // namespace o2::analysis
+
+#endif // PWGHF_CORE_PTBINNEDHISTOGRAMS_H_
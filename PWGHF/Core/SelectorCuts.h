@@ -16,6 +16,8 @@
 #define HF_SELECTOR_CUTS_H_
 
 #include "Framework/Configurable.h"
+#include "Framework/Logger.h"
+#include <algorithm>
 #include <vector>
 #include <string>
 
@@ -63,6 +65,45 @@ int findBin(T1 const& binsPt, T2 value)
   return std::distance(binsPt->begin(), std::upper_bound(binsPt->begin(), binsPt->end(), value)) - 1;
 }
 
+/// Cuts per pT bin, resolved once from the bin and cut configurables.
+/// The cut values are copied into a dense row-major array and addressed by the index of the variable,
+/// so that the selection of a candidate does not look up the labels of the cut array.
+class PtBinnedCuts
+{
+ public:
+  /// Resolves the cuts
+  /// \param binsPt  pT bin edges
+  /// \param cuts  cut array with one row per pT bin
+  /// \param labels  labels of the cut variables, the position in this list is the index of the variable in get
+  template <typename TCuts>
+  void init(std::vector<double> const& binsPt, TCuts const& cuts, std::vector<std::string> const& labels)
+  {
+    mBinsPt = binsPt;
+    mNVars = labels.size();
+    const int nBins = mBinsPt.size() > 1 ? mBinsPt.size() - 1 : 0;
+    if (static_cast<int>(cuts.rows()) < nBins) {
+      LOGF(fatal, "Cut array has %d rows for %d pT bins", cuts.rows(), nBins);
+    }
+    mCuts.resize(nBins * mNVars);
+    for (int iBin = 0; iBin < nBins; ++iBin) {
+      for (int iVar = 0; iVar < mNVars; ++iVar) {
+        mCuts[iBin * mNVars + iVar] = cuts.get(iBin, labels[iVar].c_str());
+      }
+    }
+  }
+
+  /// \return index of the pT bin, -1 if outside the bins
+  int findBin(double pt) const { return o2::analysis::findBin(&mBinsPt, pt); }
+
+  /// \return cut value of the variable iVar in the pT bin iBin
+  double get(int iBin, int iVar) const { return mCuts[iBin * mNVars + iVar]; }
+
+ private:
+  std::vector<double> mBinsPt; ///< pT bin edges
+  std::vector<double> mCuts;   ///< cut values, row-major in pT bin and variable
+  int mNVars{0};               ///< number of cut variables
+};
+
 // namespace per channel
 
 namespace hf_cuts_single_track
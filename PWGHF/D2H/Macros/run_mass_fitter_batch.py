@@ -0,0 +1,80 @@
+"""
+Script to run the HFInvMassFitter steering macro (runMassFitter.C) on many configurations in parallel,
+e.g. one per cut set of a cut-variation study
+
+Each configuration is fitted in a separate ROOT process, so that every fit has its own RooFit workspace
+(RooFit is not thread safe). The macros are compiled once with ACLiC before the fits and the compiled
+libraries are then loaded by all the processes.
+
+Usage: python3 run_mass_fitter_batch.py config_massfitter_cut0.json config_massfitter_cut1.json ... -j 8
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+MACRO_DIR = os.path.dirname(os.path.abspath(__file__))
+FITTER = os.path.join(MACRO_DIR, "HFInvMassFitter.cxx")
+STEERING = os.path.join(MACRO_DIR, "runMassFitter.C")
+
+
+def root_command(config=None):
+    """
+    ROOT command loading the fitter and running the steering macro on a configuration,
+    or only compiling the macros if no configuration is given
+    """
+
+    if config is None:
+        compile_macros = f'if (!gSystem->CompileMacro("{FITTER}", "k") || !gSystem->CompileMacro("{STEERING}", "k")) gSystem->Exit(1);'
+        return ["root", "-l", "-b", "-q", "-e", compile_macros]
+    load_fitter = f'if (!gSystem->CompileMacro("{FITTER}", "k")) gSystem->Exit(1);'
+    return ["root", "-l", "-b", "-q", "-e", load_fitter, f'{STEERING}+("{config}")']
+
+
+def run_fit(config, log_dir):
+    """
+    Runs the fits of a configuration, writing the ROOT output to a log file
+    """
+
+    log_name = os.path.join(log_dir, os.path.splitext(os.path.basename(config))[0] + ".log")
+    with open(log_name, "w", encoding="utf8") as log:
+        result = subprocess.run(root_command(os.path.abspath(config)), stdout=log, stderr=subprocess.STDOUT, check=False)
+    return config, result.returncode, log_name
+
+
+def main(configs, n_jobs, log_dir):
+    """
+    Main function
+    """
+
+    os.makedirs(log_dir, exist_ok=True)
+
+    # compile once, so that the parallel processes do not rebuild the same libraries concurrently
+    if subprocess.run(root_command(), check=False).returncode != 0:
+        print("ERROR: compilation of the mass-fitter macros failed! Exit")
+        sys.exit(1)
+
+    n_failed = 0
+    with ThreadPoolExecutor(max_workers=n_jobs) as executor:
+        for config, return_code, log_name in executor.map(lambda cfg: run_fit(cfg, log_dir), configs):
+            if return_code != 0:
+                n_failed += 1
+                print(f"ERROR: fit of {config} failed (return code {return_code}), see {log_name}")
+            else:
+                print(f"Fit of {config} done")
+
+    print(f"{len(configs) - n_failed}/{len(configs)} configurations fitted")
+    if n_failed > 0:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Arguments")
+    parser.add_argument("configs", metavar="text", nargs="+", help="JSON config files of runMassFitter.C")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count(), help="number of parallel fits")
+    parser.add_argument("--logdir", metavar="text", default="logs_mass_fitter", help="directory of the log files")
+    args = parser.parse_args()
+
+    main(args.configs, args.jobs, args.logdir)
@@ -80,6 +80,34 @@ DECLARE_SOA_TABLE(HfPvRefitTrack, "AOD", "HFPVREFITTRACK", //!
                   hf_pv_refit_track::PvRefitDcaXY,
                   hf_pv_refit_track::PvRefitDcaZ);
 
+namespace hf_sel_track_store
+{
+DECLARE_SOA_COLUMN(ConfigHash, configHash, uint32_t); //! hash of the track-selection configuration
+} // namespace hf_sel_track_store
+
+// hash of the track-selection configuration used for the HfSelTrack and HfPvRefitTrack tables, one row per dataframe
+DECLARE_SOA_TABLE(HfSelTrackCfg, "AOD", "HFSELTRACKCFG", //!
+                  hf_sel_track_store::ConfigHash);
+
+// stored track selection and PV refit, to be read back instead of recomputed by the following productions on the same input
+DECLARE_SOA_TABLE(HfSelTrackStore, "AOD", "HFSELTRACKSTORE", //!
+                  hf_sel_track_store::ConfigHash,
+                  hf_sel_track::IsSelProng,
+                  hf_sel_track::PxProng,
+                  hf_sel_track::PyProng,
+                  hf_sel_track::PzProng,
+                  hf_pv_refit_track::PvRefitX,
+                  hf_pv_refit_track::PvRefitY,
+                  hf_pv_refit_track::PvRefitZ,
+                  hf_pv_refit_track::PvRefitSigmaX2,
+                  hf_pv_refit_track::PvRefitSigmaXY,
+                  hf_pv_refit_track::PvRefitSigmaY2,
+                  hf_pv_refit_track::PvRefitSigmaXZ,
+                  hf_pv_refit_track::PvRefitSigmaYZ,
+                  hf_pv_refit_track::PvRefitSigmaZ2,
+                  hf_pv_refit_track::PvRefitDcaXY,
+                  hf_pv_refit_track::PvRefitDcaZ);
+
 using BigTracks = soa::Join<Tracks, TracksCov, TracksExtra>;
 using BigTracksExtended = soa::Join<BigTracks, aod::TracksDCA>;
 using BigTracksMC = soa::Join<BigTracks, McTrackLabels>;
@@ -199,6 +227,59 @@ DECLARE_SOA_TABLE(HfPvRefit3Prong, "AOD", "HFPVREFIT3PRONG", //!
                   hf_pv_refit_cand_3prong::PvRefitSigmaYZ,
                   hf_pv_refit_cand_3prong::PvRefitSigmaZ2);
 
+// secondary-vertex fit of the skimming, stored on demand to spare the refit in the candidate creators
+namespace hf_vertex_fit
+{
+DECLARE_SOA_COLUMN(XSecondaryVertex, xSecondaryVertex, float);               //!
+DECLARE_SOA_COLUMN(YSecondaryVertex, ySecondaryVertex, float);               //!
+DECLARE_SOA_COLUMN(ZSecondaryVertex, zSecondaryVertex, float);               //!
+DECLARE_SOA_COLUMN(Chi2PCA, chi2PCA, float);                                 //! sum of (non-weighted) distances of the secondary vertex to its prongs
+DECLARE_SOA_COLUMN(SigmaSvX2, sigmaSvX2, float);                             //! covariance matrix of the secondary vertex
+DECLARE_SOA_COLUMN(SigmaSvXY, sigmaSvXY, float);                             //!
+DECLARE_SOA_COLUMN(SigmaSvY2, sigmaSvY2, float);                             //!
+DECLARE_SOA_COLUMN(SigmaSvXZ, sigmaSvXZ, float);                             //!
+DECLARE_SOA_COLUMN(SigmaSvYZ, sigmaSvYZ, float);                             //!
+DECLARE_SOA_COLUMN(SigmaSvZ2, sigmaSvZ2, float);                             //!
+DECLARE_SOA_COLUMN(PxProng0, pxProng0, float);                               //! momentum of the prong at the secondary vertex
+DECLARE_SOA_COLUMN(PyProng0, pyProng0, float);                               //!
+DECLARE_SOA_COLUMN(PzProng0, pzProng0, float);                               //!
+DECLARE_SOA_COLUMN(PxProng1, pxProng1, float);                               //!
+DECLARE_SOA_COLUMN(PyProng1, pyProng1, float);                               //!
+DECLARE_SOA_COLUMN(PzProng1, pzProng1, float);                               //!
+DECLARE_SOA_COLUMN(PxProng2, pxProng2, float);                               //!
+DECLARE_SOA_COLUMN(PyProng2, pyProng2, float);                               //!
+DECLARE_SOA_COLUMN(PzProng2, pzProng2, float);                               //!
+DECLARE_SOA_COLUMN(ImpactParameterY0, impactParameterY0, float);             //! impact parameter of the prong w.r.t. the primary vertex used in the skimming, local y
+DECLARE_SOA_COLUMN(ImpactParameterZ0, impactParameterZ0, float);             //! impact parameter of the prong, z
+DECLARE_SOA_COLUMN(ImpactParameterSigmaY20, impactParameterSigmaY20, float); //! variance of the impact parameter of the prong, local y
+DECLARE_SOA_COLUMN(ImpactParameterY1, impactParameterY1, float);             //!
+DECLARE_SOA_COLUMN(ImpactParameterZ1, impactParameterZ1, float);             //!
+DECLARE_SOA_COLUMN(ImpactParameterSigmaY21, impactParameterSigmaY21, float); //!
+DECLARE_SOA_COLUMN(ImpactParameterY2, impactParameterY2, float);             //!
+DECLARE_SOA_COLUMN(ImpactParameterZ2, impactParameterZ2, float);             //!
+DECLARE_SOA_COLUMN(ImpactParameterSigmaY22, impactParameterSigmaY22, float); //!
+} // namespace hf_vertex_fit
+
+DECLARE_SOA_TABLE(HfVertexFit2Prong, "AOD", "HFVTXFIT2PRONG", //!
+                  hf_vertex_fit::XSecondaryVertex, hf_vertex_fit::YSecondaryVertex, hf_vertex_fit::ZSecondaryVertex,
+                  hf_vertex_fit::Chi2PCA,
+                  hf_vertex_fit::SigmaSvX2, hf_vertex_fit::SigmaSvXY, hf_vertex_fit::SigmaSvY2, hf_vertex_fit::SigmaSvXZ, hf_vertex_fit::SigmaSvYZ, hf_vertex_fit::SigmaSvZ2,
+                  hf_vertex_fit::PxProng0, hf_vertex_fit::PyProng0, hf_vertex_fit::PzProng0,
+                  hf_vertex_fit::PxProng1, hf_vertex_fit::PyProng1, hf_vertex_fit::PzProng1,
+                  hf_vertex_fit::ImpactParameterY0, hf_vertex_fit::ImpactParameterZ0, hf_vertex_fit::ImpactParameterSigmaY20,
+                  hf_vertex_fit::ImpactParameterY1, hf_vertex_fit::ImpactParameterZ1, hf_vertex_fit::ImpactParameterSigmaY21);
+
+DECLARE_SOA_TABLE(HfVertexFit3Prong, "AOD", "HFVTXFIT3PRONG", //!
+                  hf_vertex_fit::XSecondaryVertex, hf_vertex_fit::YSecondaryVertex, hf_vertex_fit::ZSecondaryVertex,
+                  hf_vertex_fit::Chi2PCA,
+                  hf_vertex_fit::SigmaSvX2, hf_vertex_fit::SigmaSvXY, hf_vertex_fit::SigmaSvY2, hf_vertex_fit::SigmaSvXZ, hf_vertex_fit::SigmaSvYZ, hf_vertex_fit::SigmaSvZ2,
+                  hf_vertex_fit::PxProng0, hf_vertex_fit::PyProng0, hf_vertex_fit::PzProng0,
+                  hf_vertex_fit::PxProng1, hf_vertex_fit::PyProng1, hf_vertex_fit::PzProng1,
+                  hf_vertex_fit::PxProng2, hf_vertex_fit::PyProng2, hf_vertex_fit::PzProng2,
+                  hf_vertex_fit::ImpactParameterY0, hf_vertex_fit::ImpactParameterZ0, hf_vertex_fit::ImpactParameterSigmaY20,
+                  hf_vertex_fit::ImpactParameterY1, hf_vertex_fit::ImpactParameterZ1, hf_vertex_fit::ImpactParameterSigmaY21,
+                  hf_vertex_fit::ImpactParameterY2, hf_vertex_fit::ImpactParameterZ2, hf_vertex_fit::ImpactParameterSigmaY22);
+
 // general decay properties
 namespace hf_cand
 {
@@ -1461,6 +1542,25 @@ DECLARE_SOA_TABLE(HfCandB0McRec, "AOD", "HFCANDB0MCREC",
 DECLARE_SOA_TABLE(HfCandB0McGen, "AOD", "HFCANDB0MCGEN",
                   hf_cand_b0::FlagMcMatchGen,
                   hf_cand_b0::OriginMcGen);
+
+// generator level MC matching of all the particles to the channels of the candidate creators, joinable with McParticles
+namespace hf_mc_gen
+{
+DECLARE_SOA_COLUMN(FlagMcMatchGen2Prong, flagMcMatchGen2Prong, int8_t);         //! 2-prong decay channel, as hf_cand_2prong::FlagMcMatchGen
+DECLARE_SOA_COLUMN(FlagMcMatchGen3Prong, flagMcMatchGen3Prong, int8_t);         //! 3-prong decay channel, as hf_cand_3prong::FlagMcMatchGen
+DECLARE_SOA_COLUMN(FlagMcDecayChanGen3Prong, flagMcDecayChanGen3Prong, int8_t); //! resonant decay channel, as hf_cand_3prong::FlagMcDecayChanGen
+DECLARE_SOA_COLUMN(FlagMcMatchGenCascade, flagMcMatchGenCascade, int8_t);       //! cascade decay channel, as hf_cand_casc::FlagMcMatchGen
+DECLARE_SOA_COLUMN(FlagMcMatchGenB0, flagMcMatchGenB0, int8_t);                 //! B0 decay channel, as hf_cand_b0::FlagMcMatchGen
+DECLARE_SOA_COLUMN(OriginMcGenCharm, originMcGenCharm, int8_t);                 //! origin of the particles matched to a 2-prong or 3-prong channel
+} // namespace hf_mc_gen
+
+DECLARE_SOA_TABLE(HfMcGenFlags, "AOD", "HFMCGENFLAG", //!
+                  hf_mc_gen::FlagMcMatchGen2Prong,
+                  hf_mc_gen::FlagMcMatchGen3Prong,
+                  hf_mc_gen::FlagMcDecayChanGen3Prong,
+                  hf_mc_gen::FlagMcMatchGenCascade,
+                  hf_mc_gen::FlagMcMatchGenB0,
+                  hf_mc_gen::OriginMcGenCharm);
 } // namespace o2::aod
 
 #endif // O2_ANALYSIS_CANDIDATERECONSTRUCTIONTABLES_H_
@@ -42,6 +42,15 @@ DECLARE_SOA_TABLE(HfSelD0, "AOD", "HFSELD0", //!
                   hf_sel_candidate_d0::IsRecoCand,
                   hf_sel_candidate_d0::IsRecoPid);
 
+namespace hf_ml_d0
+{
+DECLARE_SOA_COLUMN(MlScoreBkg, mlScoreBkg, float);             //! ML score of the background class
+DECLARE_SOA_COLUMN(MlScorePrompt, mlScorePrompt, float);       //! ML score of the prompt class
+DECLARE_SOA_COLUMN(MlScoreNonPrompt, mlScoreNonPrompt, float); //! ML score of the non-prompt class
+} // namespace hf_ml_d0
+DECLARE_SOA_TABLE(HfMlD0, "AOD", "HFMLD0", //!
+                  hf_ml_d0::MlScoreBkg, hf_ml_d0::MlScorePrompt, hf_ml_d0::MlScoreNonPrompt);
+
 namespace hf_sel_candidate_d0_parametrized_pid
 {
 DECLARE_SOA_COLUMN(IsSelD0NoPid, isSelD0NoPid, int);                 //!
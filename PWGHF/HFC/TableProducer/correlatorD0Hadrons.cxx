@@ -22,6 +22,7 @@
 #include "Framework/runDataProcessing.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -30,6 +31,7 @@ using namespace o2::aod::hf_cand;
 using namespace o2::aod::hf_cand_2prong;
 using namespace o2::aod::hf_correlation_d0_hadron;
 using namespace o2::analysis::hf_cuts_d0_to_pi_k;
+using namespace o2::analysis::hf_correlations;
 using namespace o2::constants::math;
 
 ///
@@ -81,6 +83,8 @@ struct HfCorrelatorD0Hadrons {
   Configurable<double> multMax{"multMax", 10000., "maximum multiplicity accepted"};
   Configurable<double> ptSoftPionMax{"ptSoftPionMax", 3 * 800. * pow(10., -6.), "max. pT cut for soft pion identification"};
 
+  AssociatedParticles assocParticles; // associated tracks (particles) of the current collision, reused between collisions
+
   Partition<soa::Join<aod::HfCand2Prong, aod::HfSelD0>> selectedD0Candidates = aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar;
   Partition<soa::Join<aod::HfCand2Prong, aod::HfSelD0, aod::HfCand2ProngMcRec>> selectedD0candidatesMC = aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar;
 
@@ -134,6 +138,24 @@ struct HfCorrelatorD0Hadrons {
     registry.add("hCountD0TriggersGen", "D0 trigger particles - MC gen;;N of trigger D0", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
   }
 
+  /// Caches the primary tracks of the collision once, so that the pair loop of each D0 candidate only runs over them
+  /// \param applyKinematicCuts  also apply the eta and pT selections of the associated tracks
+  template <typename TTracks>
+  void fillAssocTracks(TTracks const& tracks, bool applyKinematicCuts)
+  {
+    assocParticles.clear();
+    assocParticles.reserve(tracks.size());
+    for (const auto& track : tracks) {
+      if (applyKinematicCuts && (std::abs(track.eta()) > etaTrackMax || track.pt() < ptTrackMin)) {
+        continue;
+      }
+      if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
+        continue; // Remove secondary tracks
+      }
+      assocParticles.push(track.phi(), track.eta(), track.pt(), track.px(), track.py(), track.pz(), track.energy(massPi), track.globalIndex());
+    }
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // =============================================================================  Process starts for Data ==================================================================================
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -160,6 +182,7 @@ struct HfCorrelatorD0Hadrons {
     registry.fill(HIST("hMultiplicity"), nTracks);
 
     auto selectedD0CandidatesGrouped = selectedD0Candidates->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex());
+    fillAssocTracks(tracks, false);
 
     for (auto const& candidate1 : selectedD0CandidatesGrouped) {
       if (yCandMax >= 0. && std::abs(yD0(candidate1)) > yCandMax) {
@@ -205,22 +228,22 @@ struct HfCorrelatorD0Hadrons {
       // ================================================================================= D-h correlation dedicated section =====================================================
 
       // ========================== track loop starts here ================================
-      for (const auto& track : tracks) {
-        registry.fill(HIST("hTrackCounter"), 1); // fill total no. of tracks
+      registry.fill(HIST("hTrackCounter"), 1, tracks.size()); // fill total no. of tracks
+      const auto prong0Id = candidate1.prong0Id();
+      const auto prong1Id = candidate1.prong1Id();
+      for (std::size_t iTrack = 0; iTrack < assocParticles.size(); ++iTrack) {
         // Remove D0 daughters by checking track indices
-        if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex())) {
+        if ((prong0Id == assocParticles.globalIndex[iTrack]) || (prong1Id == assocParticles.globalIndex[iTrack])) {
           continue;
         }
-        if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.)
-          continue; // Remove secondary tracks
 
         registry.fill(HIST("hTrackCounter"), 2); // fill no. of tracks before soft pion removal
 
         // ===== soft pion removal ===================================================
         double invMassDstar1 = 0., invMassDstar2 = 0.;
         bool isSoftpiD0 = false, isSoftpiD0bar = false;
-        auto pSum2 = RecoDecay::p2(candidate1.px() + track.px(), candidate1.py() + track.py(), candidate1.pz() + track.pz());
-        auto ePion = track.energy(massPi);
+        auto pSum2 = RecoDecay::p2(candidate1.px() + assocParticles.px[iTrack], candidate1.py() + assocParticles.py[iTrack], candidate1.pz() + assocParticles.pz[iTrack]);
+        auto ePion = assocParticles.energy[iTrack];
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
@@ -247,10 +270,10 @@ struct HfCorrelatorD0Hadrons {
           signalStatus += 2;
         }
 
-        entryD0HadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                          track.eta() - candidate1.eta(),
+        entryD0HadronPair(getDeltaPhi(assocParticles.phi[iTrack], candidate1.phi()),
+                          assocParticles.eta[iTrack] - candidate1.eta(),
                           candidate1.pt(),
-                          track.pt());
+                          assocParticles.pt[iTrack]);
         entryD0HadronRecoInfo(invMassD0ToPiK(candidate1), invMassD0barToKPi(candidate1), signalStatus);
 
       } // end inner loop (tracks)
@@ -285,6 +308,7 @@ struct HfCorrelatorD0Hadrons {
     registry.fill(HIST("hMultiplicity"), nTracks);
 
     auto selectedD0CandidatesGroupedMC = selectedD0candidatesMC->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex());
+    fillAssocTracks(tracks, true);
     // MC reco level
     bool flagD0 = false;
     bool flagD0bar = false;
@@ -347,28 +371,21 @@ struct HfCorrelatorD0Hadrons {
 
       // ========== track loop starts here ========================
 
-      for (const auto& track : tracks) {
-        registry.fill(HIST("hTrackCounterRec"), 1); // fill total no. of tracks
-        if (std::abs(track.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (track.pt() < ptTrackMin) {
-          continue;
-        }
+      registry.fill(HIST("hTrackCounterRec"), 1, tracks.size()); // fill total no. of tracks
+      const auto prong0Id = candidate1.prong0Id();
+      const auto prong1Id = candidate1.prong1Id();
+      for (std::size_t iTrack = 0; iTrack < assocParticles.size(); ++iTrack) {
         // Removing D0 daughters by checking track indices
-        if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex())) {
+        if ((prong0Id == assocParticles.globalIndex[iTrack]) || (prong1Id == assocParticles.globalIndex[iTrack])) {
           continue;
         }
-        if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
-          continue; // Remove secondary tracks
-        }
         registry.fill(HIST("hTrackCounterRec"), 2); // fill no. of tracks before soft pion removal
 
         // ===== soft pion removal ===================================================
         double invMassDstar1 = 0, invMassDstar2 = 0;
         bool isSoftpiD0 = false, isSoftpiD0bar = false;
-        auto pSum2 = RecoDecay::p2(candidate1.px() + track.px(), candidate1.py() + track.py(), candidate1.pz() + track.pz());
-        auto ePion = track.energy(massPi);
+        auto pSum2 = RecoDecay::p2(candidate1.px() + assocParticles.px[iTrack], candidate1.py() + assocParticles.py[iTrack], candidate1.pz() + assocParticles.pz[iTrack]);
+        auto ePion = assocParticles.energy[iTrack];
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
@@ -409,10 +426,10 @@ struct HfCorrelatorD0Hadrons {
           signalStatus += 32;
         } // background case D0bar
 
-        entryD0HadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                          track.eta() - candidate1.eta(),
+        entryD0HadronPair(getDeltaPhi(assocParticles.phi[iTrack], candidate1.phi()),
+                          assocParticles.eta[iTrack] - candidate1.eta(),
                           candidate1.pt(),
-                          track.pt());
+                          assocParticles.pt[iTrack]);
         entryD0HadronRecoInfo(invMassD0ToPiK(candidate1), invMassD0barToKPi(candidate1), signalStatus);
       } // end inner loop (Tracks)
 
@@ -429,6 +446,26 @@ struct HfCorrelatorD0Hadrons {
   {
 
     registry.fill(HIST("hEvtCountGen"), 0);
+
+    // associated particles, selected once per collision; the D* mother is only needed for the soft-pion removal of the pions
+    assocParticles.clear();
+    for (auto const& particle2 : particlesMC) {
+      if (std::abs(particle2.eta()) > etaTrackMax) {
+        continue;
+      }
+      if (particle2.pt() < ptTrackMin) {
+        continue;
+      }
+      if ((std::abs(particle2.pdgCode()) != kElectron) && (std::abs(particle2.pdgCode()) != kMuonMinus) && (std::abs(particle2.pdgCode()) != kPiPlus) && (std::abs(particle2.pdgCode()) != kKPlus) && (std::abs(particle2.pdgCode()) != kProton)) {
+        continue;
+      }
+      int indexMotherPi = -1;
+      if (std::abs(particle2.pdgCode()) == kPiPlus) {
+        indexMotherPi = RecoDecay::getMother(particlesMC, particle2, pdg::Code::kDStar, true, nullptr, 1); // last arguement 1 is written to consider immediate decay mother only
+      }
+      assocParticles.push(particle2.phi(), particle2.eta(), particle2.pt(), particle2.px(), particle2.py(), particle2.pz(), 0.f, particle2.globalIndex(), indexMotherPi);
+    }
+
     // MC gen level
     for (auto const& particle1 : particlesMC) {
       // check if the particle is D0 or D0bar (for general plot filling and selection, so both cases are fine) - NOTE: decay channel is not probed!
@@ -454,32 +491,22 @@ struct HfCorrelatorD0Hadrons {
       }
       registry.fill(HIST("hCountD0TriggersGen"), 0, particle1.pt()); // to count trigger D0 (for normalisation)
 
-      for (auto const& particle2 : particlesMC) {
-        registry.fill(HIST("hTrackCounterGen"), 1); // total no. of tracks
-        if (std::abs(particle2.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (particle2.pt() < ptTrackMin) {
-          continue;
-        }
-        if ((std::abs(particle2.pdgCode()) != kElectron) && (std::abs(particle2.pdgCode()) != kMuonMinus) && (std::abs(particle2.pdgCode()) != kPiPlus) && (std::abs(particle2.pdgCode()) != kKPlus) && (std::abs(particle2.pdgCode()) != kProton)) {
-          continue;
-        }
-
-        // ==============================soft pion removal================================
-        registry.fill(HIST("hTrackCounterGen"), 2); // fill before soft pi removal
-        // method used: indexMother = -1 by default if the mother doesn't match with given PID of the mother. We find mother of pion if it is D* and mother of D0 if it is D*. If they are both positive and they both match each other, then it is detected as a soft pion
+      registry.fill(HIST("hTrackCounterGen"), 1, particlesMC.size());    // total no. of tracks
+      registry.fill(HIST("hTrackCounterGen"), 2, assocParticles.size()); // fill before soft pi removal
+      // ==============================soft pion removal================================
+      // method used: indexMother = -1 by default if the mother doesn't match with given PID of the mother. We find mother of pion if it is D* and mother of D0 if it is D*. If they are both positive and they both match each other, then it is detected as a soft pion
+      auto indexMotherD0 = RecoDecay::getMother(particlesMC, particle1, pdg::Code::kDStar, true, nullptr, 1);
 
-        auto indexMotherPi = RecoDecay::getMother(particlesMC, particle2, pdg::Code::kDStar, true, nullptr, 1); // last arguement 1 is written to consider immediate decay mother only
-        auto indexMotherD0 = RecoDecay::getMother(particlesMC, particle1, pdg::Code::kDStar, true, nullptr, 1);
-        if (std::abs(particle2.pdgCode()) == kPiPlus && indexMotherPi >= 0 && indexMotherD0 >= 0 && indexMotherPi == indexMotherD0)
+      for (std::size_t iParticle = 0; iParticle < assocParticles.size(); ++iParticle) {
+        auto indexMotherPi = assocParticles.motherIndex[iParticle]; // -1 for the particles other than pions
+        if (indexMotherPi >= 0 && indexMotherD0 >= 0 && indexMotherPi == indexMotherD0)
           continue;
 
         registry.fill(HIST("hTrackCounterGen"), 3); // fill after soft pion removal
-        entryD0HadronPair(getDeltaPhi(particle2.phi(), particle1.phi()),
-                          particle2.eta() - particle1.eta(),
+        entryD0HadronPair(getDeltaPhi(assocParticles.phi[iParticle], particle1.phi()),
+                          assocParticles.eta[iParticle] - particle1.eta(),
                           particle1.pt(),
-                          particle2.pt());
+                          assocParticles.pt[iParticle]);
         entryD0HadronRecoInfo(massD0,
                               massD0,
                               0); // dummy info
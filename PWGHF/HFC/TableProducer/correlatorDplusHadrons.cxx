@@ -16,6 +16,7 @@
 #include "Framework/HistogramRegistry.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Framework/runDataProcessing.h"
@@ -26,6 +27,7 @@ using namespace o2::framework::expressions;
 using namespace o2::aod::hf_cand_3prong;
 using namespace o2::aod::hf_correlation_dplus_hadron;
 using namespace o2::analysis::hf_cuts_dplus_to_pi_k_pi;
+using namespace o2::analysis::hf_correlations;
 using namespace o2::constants::math;
 
 /// Returns deltaPhi value in range [-pi/2., 3.*pi/2], typically used for correlation studies
@@ -75,6 +77,8 @@ struct HfCorrelatorDplusHadrons {
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{o2::analysis::hf_cuts_dplus_to_pi_k_pi::vecBinsPt}, "pT bin limits for candidate mass plots and efficiency"};
   Configurable<std::vector<double>> efficiencyD{"efficiencyD", std::vector<double>{efficiencyDmeson_v}, "Efficiency values for Dplus meson"};
 
+  AssociatedParticles assocParticles; // associated MC particles of the current collision, reused between collisions
+
   Partition<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>> selectedDPlusCandidates = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= selectionFlagDplus;
   Partition<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi, aod::HfCand3ProngMcRec>> recoFlagDPlusCandidates = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi > 0;
 
@@ -296,6 +300,23 @@ struct HfCorrelatorDplusHadrons {
   {
     int counterDplusHadron = 0;
     registry.fill(HIST("hMCEvtCount"), 0);
+
+    // associated particles, selected once per collision instead of once per Dplus
+    assocParticles.clear();
+    for (auto& particle2 : particlesMC) {
+      if (std::abs(particle2.eta()) > etaTrackMax) {
+        continue;
+      }
+      if (particle2.pt() < ptTrackMin) {
+        continue;
+      }
+
+      if ((std::abs(particle2.pdgCode()) != 11) && (std::abs(particle2.pdgCode()) != 13) && (std::abs(particle2.pdgCode()) != 211) && (std::abs(particle2.pdgCode()) != 321) && (std::abs(particle2.pdgCode()) != 2212)) {
+        continue;
+      }
+      assocParticles.push(particle2.phi(), particle2.eta(), particle2.pt(), particle2.px(), particle2.py(), particle2.pz(), 0.f, particle2.globalIndex());
+    }
+
     // MC gen level
     for (auto& particle1 : particlesMC) {
       // check if the particle is Dplus  (for general plot filling and selection, so both cases are fine) - NOTE: decay channel is not probed!
@@ -320,21 +341,11 @@ struct HfCorrelatorDplusHadrons {
         continue;
       }
       registry.fill(HIST("hcountDplustriggersMCGen"), 0, particle1.pt()); // to count trigger Dplus for normalisation)
-      for (auto& particle2 : particlesMC) {
-        if (std::abs(particle2.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (particle2.pt() < ptTrackMin) {
-          continue;
-        }
-
-        if ((std::abs(particle2.pdgCode()) != 11) && (std::abs(particle2.pdgCode()) != 13) && (std::abs(particle2.pdgCode()) != 211) && (std::abs(particle2.pdgCode()) != 321) && (std::abs(particle2.pdgCode()) != 2212)) {
-          continue;
-        }
-        entryDplusHadronPair(getDeltaPhi(particle2.phi(), particle1.phi()),
-                             particle2.eta() - particle1.eta(),
+      for (std::size_t iParticle = 0; iParticle < assocParticles.size(); ++iParticle) {
+        entryDplusHadronPair(getDeltaPhi(assocParticles.phi[iParticle], particle1.phi()),
+                             assocParticles.eta[iParticle] - particle1.eta(),
                              particle1.pt(),
-                             particle2.pt());
+                             assocParticles.pt[iParticle]);
 
       } // end inner loop
     }   // end outer loop
@@ -19,6 +19,7 @@
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsMcGen.h"
 #include "Common/Core/trackUtilities.h"
 #include "ReconstructionDataFormats/DCA.h"
 
@@ -85,12 +86,15 @@ struct HfCandidateCreator2Prong {
       ccdb->get<TGeoManager>(ccdbPathGeo);
     }
     runNumber = 0;
+    if (doprocessRefit == doprocessSkimVertex) {
+      LOGP(fatal, "Enable exactly one of processRefit and processSkimVertex");
+    }
   }
 
-  void process(aod::Collisions const& collisions,
-               soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong> const& rowsTrackIndexProng2,
-               aod::BigTracks const& tracks,
-               aod::BCsWithTimestamps const& bcWithTimeStamps)
+  /// Builds the candidates
+  /// \tparam useSkimVertex  take the secondary-vertex fit and the impact parameters stored by the skimming instead of refitting
+  template <bool useSkimVertex, typename TRowsTrackIndex>
+  void runCreator2Prong(TRowsTrackIndex const& rowsTrackIndexProng2)
   {
     // 2-prong vertex fitter
     o2::vertexing::DCAFitterN<2> df;
@@ -125,24 +129,38 @@ struct HfCandidateCreator2Prong {
       df.setBz(bz);
 
       // reconstruct the 2-prong secondary vertex
-      if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
-        continue;
+      array<double, 3> secondaryVertex;
+      float chi2PCA;
+      array<float, 6> covMatrixPCA;
+      array<float, 3> pvec0;
+      array<float, 3> pvec1;
+      o2::track::TrackParCov trackParVar0;
+      o2::track::TrackParCov trackParVar1;
+      if constexpr (useSkimVertex) {
+        secondaryVertex = {rowTrackIndexProng2.xSecondaryVertex(), rowTrackIndexProng2.ySecondaryVertex(), rowTrackIndexProng2.zSecondaryVertex()};
+        chi2PCA = rowTrackIndexProng2.chi2PCA();
+        covMatrixPCA = {rowTrackIndexProng2.sigmaSvX2(), rowTrackIndexProng2.sigmaSvXY(), rowTrackIndexProng2.sigmaSvY2(), rowTrackIndexProng2.sigmaSvXZ(), rowTrackIndexProng2.sigmaSvYZ(), rowTrackIndexProng2.sigmaSvZ2()};
+        pvec0 = {rowTrackIndexProng2.pxProng0(), rowTrackIndexProng2.pyProng0(), rowTrackIndexProng2.pzProng0()};
+        pvec1 = {rowTrackIndexProng2.pxProng1(), rowTrackIndexProng2.pyProng1(), rowTrackIndexProng2.pzProng1()};
+      } else {
+        if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+          continue;
+        }
+        const auto& pca = df.getPCACandidate();
+        secondaryVertex = {pca[0], pca[1], pca[2]};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
+
+        // get track momenta
+        trackParVar0.getPxPyPzGlo(pvec0);
+        trackParVar1.getPxPyPzGlo(pvec1);
       }
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       hCovSVYY->Fill(covMatrixPCA[2]);
       hCovSVXZ->Fill(covMatrixPCA[3]);
       hCovSVZZ->Fill(covMatrixPCA[5]);
-      auto trackParVar0 = df.getTrack(0);
-      auto trackParVar1 = df.getTrack(1);
-
-      // get track momenta
-      array<float, 3> pvec0;
-      array<float, 3> pvec1;
-      trackParVar0.getPxPyPzGlo(pvec0);
-      trackParVar1.getPxPyPzGlo(pvec1);
 
       // get track impact parameters
       // This modifies track momenta!
@@ -170,8 +188,14 @@ struct HfCandidateCreator2Prong {
       hCovPVZZ->Fill(covMatrixPV[5]);
       o2::dataformats::DCA impactParameter0;
       o2::dataformats::DCA impactParameter1;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      if constexpr (useSkimVertex) {
+        // already propagated to the primary vertex in the skimming
+        impactParameter0.set(rowTrackIndexProng2.impactParameterY0(), rowTrackIndexProng2.impactParameterZ0(), rowTrackIndexProng2.impactParameterSigmaY20(), 0.f, 0.f);
+        impactParameter1.set(rowTrackIndexProng2.impactParameterY1(), rowTrackIndexProng2.impactParameterZ1(), rowTrackIndexProng2.impactParameterSigmaY21(), 0.f, 0.f);
+      } else {
+        trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      }
       hDcaXYProngs->Fill(track0.pt(), impactParameter0.getY() * toMicrometers);
       hDcaXYProngs->Fill(track1.pt(), impactParameter1.getY() * toMicrometers);
       hDcaZProngs->Fill(track0.pt(), impactParameter0.getZ() * toMicrometers);
@@ -207,6 +231,24 @@ struct HfCandidateCreator2Prong {
       }
     }
   }
+
+  void processRefit(aod::Collisions const& collisions,
+                    soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong> const& rowsTrackIndexProng2,
+                    aod::BigTracks const& tracks,
+                    aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2Prong<false>(rowsTrackIndexProng2);
+  }
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processRefit, "Refit the secondary vertex of the candidates", true);
+
+  void processSkimVertex(aod::Collisions const& collisions,
+                         soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong, aod::HfVertexFit2Prong> const& rowsTrackIndexProng2,
+                         aod::BigTracks const& tracks,
+                         aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2Prong<true>(rowsTrackIndexProng2);
+  }
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processSkimVertex, "Use the secondary-vertex fit of the skimming (fillVertexFit), same vertexing and doPvRefit settings needed", false);
 };
 
 /// Extends the base table with expression columns.
@@ -215,11 +257,17 @@ struct HfCandidateCreator2ProngExpressions {
   Produces<aod::HfCand2ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand2ProngMcGen> rowMcMatchGen;
 
-  void init(InitContext const&) {}
+  void init(InitContext const&)
+  {
+    if (doprocessMc && doprocessMcGenFlags) {
+      LOGF(fatal, "Only one of processMc and processMcGenFlags can be enabled");
+    }
+  }
 
-  /// Performs MC matching.
-  void processMc(aod::BigTracksMC const& tracks,
-                 aod::McParticles const& particlesMC)
+  /// Performs MC matching of the reconstructed candidates.
+  template <typename TParticles>
+  void matchRec(aod::BigTracksMC const& tracks,
+                TParticles const& particlesMC)
   {
     rowCandidateProng2->bindExternalIndices(&tracks);
 
@@ -269,34 +317,19 @@ struct HfCandidateCreator2ProngExpressions {
 
       rowMcMatchRec(flag, origin);
     }
+  }
+
+  /// Performs MC matching.
+  void processMc(aod::BigTracksMC const& tracks,
+                 aod::McParticles const& particlesMC)
+  {
+    matchRec(tracks, particlesMC);
 
     // Match generated particles.
     for (auto& particle : particlesMC) {
       // Printf("New gen. candidate");
-      flag = 0;
-      origin = 0;
-
-      // D0(bar) → π± K∓
-      // Printf("Checking D0(bar) → π± K∓");
-      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kD0, array{+kPiPlus, -kKPlus}, true, &sign)) {
-        flag = sign * (1 << DecayType::D0ToPiK);
-      }
-
-      // J/ψ → e+ e−
-      if (flag == 0) {
-        // Printf("Checking J/ψ → e+ e−");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kJPsi, array{+kElectron, -kElectron}, true)) {
-          flag = 1 << DecayType::JpsiToEE;
-        }
-      }
-
-      // J/ψ → μ+ μ−
-      if (flag == 0) {
-        // Printf("Checking J/ψ → μ+ μ−");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kJPsi, array{+kMuonPlus, -kMuonPlus}, true)) {
-          flag = 1 << DecayType::JpsiToMuMu;
-        }
-      }
+      int8_t flag = o2::analysis::hf_mc_gen::matchGen2Prong(particlesMC, particle);
+      int8_t origin = 0;
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
@@ -308,6 +341,20 @@ struct HfCandidateCreator2ProngExpressions {
   }
 
   PROCESS_SWITCH(HfCandidateCreator2ProngExpressions, processMc, "Process MC", false);
+
+  /// Performs MC matching, with the generator-level matching of hf-candidate-creator-mc-gen.
+  void processMcGenFlags(aod::BigTracksMC const& tracks,
+                         soa::Join<aod::McParticles, aod::HfMcGenFlags> const& particlesMC)
+  {
+    matchRec(tracks, particlesMC);
+
+    for (const auto& particle : particlesMC) {
+      const int8_t flag = particle.flagMcMatchGen2Prong();
+      rowMcMatchGen(flag, flag != 0 ? particle.originMcGenCharm() : 0);
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateCreator2ProngExpressions, processMcGenFlags, "Process MC, with the generator-level matching of hf-candidate-creator-mc-gen", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
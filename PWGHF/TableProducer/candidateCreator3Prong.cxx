@@ -19,6 +19,7 @@
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsMcGen.h"
 #include "Common/Core/trackUtilities.h"
 #include "ReconstructionDataFormats/DCA.h"
 
@@ -90,12 +91,15 @@ struct HfCandidateCreator3Prong {
       ccdb->get<TGeoManager>(ccdbPathGeo);
     }
     runNumber = 0;
+    if (doprocessRefit == doprocessSkimVertex) {
+      LOGP(fatal, "Enable exactly one of processRefit and processSkimVertex");
+    }
   }
 
-  void process(aod::Collisions const& collisions,
-               soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong> const& rowsTrackIndexProng3,
-               aod::BigTracks const& tracks,
-               aod::BCsWithTimestamps const& bcWithTimeStamps)
+  /// Builds the candidates
+  /// \tparam useSkimVertex  take the secondary-vertex fit and the impact parameters stored by the skimming instead of refitting
+  template <bool useSkimVertex, typename TRowsTrackIndex>
+  void runCreator3Prong(TRowsTrackIndex const& rowsTrackIndexProng3)
   {
     // 3-prong vertex fitter
     o2::vertexing::DCAFitterN<3> df;
@@ -132,27 +136,40 @@ struct HfCandidateCreator3Prong {
       df.setBz(bz);
 
       // reconstruct the 3-prong secondary vertex
-      if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
-        continue;
+      array<double, 3> secondaryVertex;
+      float chi2PCA;
+      array<float, 6> covMatrixPCA;
+      array<float, 3> pvec0;
+      array<float, 3> pvec1;
+      array<float, 3> pvec2;
+      if constexpr (useSkimVertex) {
+        secondaryVertex = {rowTrackIndexProng3.xSecondaryVertex(), rowTrackIndexProng3.ySecondaryVertex(), rowTrackIndexProng3.zSecondaryVertex()};
+        chi2PCA = rowTrackIndexProng3.chi2PCA();
+        covMatrixPCA = {rowTrackIndexProng3.sigmaSvX2(), rowTrackIndexProng3.sigmaSvXY(), rowTrackIndexProng3.sigmaSvY2(), rowTrackIndexProng3.sigmaSvXZ(), rowTrackIndexProng3.sigmaSvYZ(), rowTrackIndexProng3.sigmaSvZ2()};
+        pvec0 = {rowTrackIndexProng3.pxProng0(), rowTrackIndexProng3.pyProng0(), rowTrackIndexProng3.pzProng0()};
+        pvec1 = {rowTrackIndexProng3.pxProng1(), rowTrackIndexProng3.pyProng1(), rowTrackIndexProng3.pzProng1()};
+        pvec2 = {rowTrackIndexProng3.pxProng2(), rowTrackIndexProng3.pyProng2(), rowTrackIndexProng3.pzProng2()};
+      } else {
+        if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+          continue;
+        }
+        const auto& pca = df.getPCACandidate();
+        secondaryVertex = {pca[0], pca[1], pca[2]};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
+        trackParVar2 = df.getTrack(2);
+
+        // get track momenta
+        trackParVar0.getPxPyPzGlo(pvec0);
+        trackParVar1.getPxPyPzGlo(pvec1);
+        trackParVar2.getPxPyPzGlo(pvec2);
       }
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       hCovSVYY->Fill(covMatrixPCA[2]);
       hCovSVXZ->Fill(covMatrixPCA[3]);
       hCovSVZZ->Fill(covMatrixPCA[5]);
-      trackParVar0 = df.getTrack(0);
-      trackParVar1 = df.getTrack(1);
-      trackParVar2 = df.getTrack(2);
-
-      // get track momenta
-      array<float, 3> pvec0;
-      array<float, 3> pvec1;
-      array<float, 3> pvec2;
-      trackParVar0.getPxPyPzGlo(pvec0);
-      trackParVar1.getPxPyPzGlo(pvec1);
-      trackParVar2.getPxPyPzGlo(pvec2);
 
       // get track impact parameters
       // This modifies track momenta!
@@ -181,9 +198,16 @@ struct HfCandidateCreator3Prong {
       o2::dataformats::DCA impactParameter0;
       o2::dataformats::DCA impactParameter1;
       o2::dataformats::DCA impactParameter2;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
-      trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      if constexpr (useSkimVertex) {
+        // already propagated to the primary vertex in the skimming
+        impactParameter0.set(rowTrackIndexProng3.impactParameterY0(), rowTrackIndexProng3.impactParameterZ0(), rowTrackIndexProng3.impactParameterSigmaY20(), 0.f, 0.f);
+        impactParameter1.set(rowTrackIndexProng3.impactParameterY1(), rowTrackIndexProng3.impactParameterZ1(), rowTrackIndexProng3.impactParameterSigmaY21(), 0.f, 0.f);
+        impactParameter2.set(rowTrackIndexProng3.impactParameterY2(), rowTrackIndexProng3.impactParameterZ2(), rowTrackIndexProng3.impactParameterSigmaY22(), 0.f, 0.f);
+      } else {
+        trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+        trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      }
       hDcaXYProngs->Fill(track0.pt(), impactParameter0.getY() * toMicrometers);
       hDcaXYProngs->Fill(track1.pt(), impactParameter1.getY() * toMicrometers);
       hDcaXYProngs->Fill(track2.pt(), impactParameter2.getY() * toMicrometers);
@@ -220,6 +244,24 @@ struct HfCandidateCreator3Prong {
       }
     }
   }
+
+  void processRefit(aod::Collisions const& collisions,
+                    soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong> const& rowsTrackIndexProng3,
+                    aod::BigTracks const& tracks,
+                    aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3Prong<false>(rowsTrackIndexProng3);
+  }
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processRefit, "Refit the secondary vertex of the candidates", true);
+
+  void processSkimVertex(aod::Collisions const& collisions,
+                         soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong, aod::HfVertexFit3Prong> const& rowsTrackIndexProng3,
+                         aod::BigTracks const& tracks,
+                         aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3Prong<true>(rowsTrackIndexProng3);
+  }
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processSkimVertex, "Use the secondary-vertex fit of the skimming (fillVertexFit), same vertexing and doPvRefit settings needed", false);
 };
 
 /// Extends the base table with expression columns.
@@ -228,11 +270,17 @@ struct HfCandidateCreator3ProngExpressions {
   Produces<aod::HfCand3ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand3ProngMcGen> rowMcMatchGen;
 
-  void init(InitContext const&) {}
+  void init(InitContext const&)
+  {
+    if (doprocessMc && doprocessMcGenFlags) {
+      LOGF(fatal, "Only one of processMc and processMcGenFlags can be enabled");
+    }
+  }
 
-  /// Performs MC matching.
-  void processMc(aod::BigTracksMC const& tracks,
-                 aod::McParticles const& particlesMC)
+  /// Performs MC matching of the reconstructed candidates.
+  template <typename TParticles>
+  void matchRec(aod::BigTracksMC const& tracks,
+                TParticles const& particlesMC)
   {
     rowCandidateProng3->bindExternalIndices(&tracks);
 
@@ -320,60 +368,20 @@ struct HfCandidateCreator3ProngExpressions {
 
       rowMcMatchRec(flag, origin, swapping, channel);
     }
+  }
+
+  /// Performs MC matching.
+  void processMc(aod::BigTracksMC const& tracks,
+                 aod::McParticles const& particlesMC)
+  {
+    matchRec(tracks, particlesMC);
 
     // Match generated particles.
     for (auto& particle : particlesMC) {
       // Printf("New gen. candidate");
-      flag = 0;
-      origin = 0;
-      channel = 0;
-      arrDaughIndex.clear();
-
-      // D± → π± K∓ π±
-      // Printf("Checking D± → π± K∓ π±");
-      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kDPlus, array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-        flag = sign * (1 << DecayType::DplusToPiKPi);
-      }
-
-      // Ds± → K± K∓ π±
-      if (flag == 0) {
-        // Printf("Checking Ds± → K± K∓ π±");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kDS, array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-          flag = sign * (1 << DecayType::DsToKKPi);
-        }
-      }
-
-      // Λc± → p± K∓ π±
-      if (flag == 0) {
-        // Printf("Checking Λc± → p± K∓ π±");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kLambdaCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-          flag = sign * (1 << DecayType::LcToPKPi);
-
-          // Printf("Flagging the different Λc± → p± K∓ π± decay channels");
-          RecoDecay::getDaughters(particle, &arrDaughIndex, array{0}, 1);
-          if (arrDaughIndex.size() == 2) {
-            for (auto jProng = 0u; jProng < arrDaughIndex.size(); ++jProng) {
-              auto daughJ = particlesMC.rawIteratorAt(arrDaughIndex[jProng]);
-              arrPDGDaugh[jProng] = std::abs(daughJ.pdgCode());
-            }
-            if ((arrPDGDaugh[0] == arrPDGResonant1[0] && arrPDGDaugh[1] == arrPDGResonant1[1]) || (arrPDGDaugh[0] == arrPDGResonant1[1] && arrPDGDaugh[1] == arrPDGResonant1[0])) {
-              channel = 1;
-            } else if ((arrPDGDaugh[0] == arrPDGResonant2[0] && arrPDGDaugh[1] == arrPDGResonant2[1]) || (arrPDGDaugh[0] == arrPDGResonant2[1] && arrPDGDaugh[1] == arrPDGResonant2[0])) {
-              channel = 2;
-            } else if ((arrPDGDaugh[0] == arrPDGResonant3[0] && arrPDGDaugh[1] == arrPDGResonant3[1]) || (arrPDGDaugh[0] == arrPDGResonant3[1] && arrPDGDaugh[1] == arrPDGResonant3[0])) {
-              channel = 3;
-            }
-          }
-        }
-      }
-
-      // Ξc± → p± K∓ π±
-      if (flag == 0) {
-        // Printf("Checking Ξc± → p± K∓ π±");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kXiCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-          flag = sign * (1 << DecayType::XicToPKPi);
-        }
-      }
+      int8_t channel = 0;
+      int8_t flag = o2::analysis::hf_mc_gen::matchGen3Prong(particlesMC, particle, channel);
+      int8_t origin = 0;
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
@@ -385,6 +393,20 @@ struct HfCandidateCreator3ProngExpressions {
   }
 
   PROCESS_SWITCH(HfCandidateCreator3ProngExpressions, processMc, "Process MC", false);
+
+  /// Performs MC matching, with the generator-level matching of hf-candidate-creator-mc-gen.
+  void processMcGenFlags(aod::BigTracksMC const& tracks,
+                         soa::Join<aod::McParticles, aod::HfMcGenFlags> const& particlesMC)
+  {
+    matchRec(tracks, particlesMC);
+
+    for (const auto& particle : particlesMC) {
+      const int8_t flag = particle.flagMcMatchGen3Prong();
+      rowMcMatchGen(flag, flag != 0 ? particle.originMcGenCharm() : 0, particle.flagMcDecayChanGen3Prong());
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateCreator3ProngExpressions, processMcGenFlags, "Process MC, with the generator-level matching of hf-candidate-creator-mc-gen", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
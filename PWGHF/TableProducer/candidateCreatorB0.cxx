@@ -23,6 +23,8 @@
 #include "ReconstructionDataFormats/V0.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsBhadronCreator.h"
+#include "PWGHF/Utils/utilsMcGen.h"
 
 using namespace o2;
 using namespace o2::aod;
@@ -31,6 +33,7 @@ using namespace o2::aod::hf_cand;
 using namespace o2::aod::hf_cand_2prong;
 using namespace o2::aod::hf_cand_3prong;
 using namespace o2::aod::hf_cand_b0; // from CandidateReconstructionTables.h
+using namespace o2::analysis::hf_bhadron;
 using namespace o2::framework::expressions;
 
 /// Reconstruction of B0 candidates
@@ -48,11 +51,15 @@ struct HfCandidateCreatorB0 {
   Configurable<double> ptPionMin{"ptPionMin", 0.5, "minimum pion pT threshold (GeV/c)"};
   Configurable<int> selectionFlagD{"selectionFlagD", 1, "Selection Flag for D"};
   Configurable<double> yCandMax{"yCandMax", -1., "max. cand. rapidity"};
+  Configurable<double> invMassWindowB0{"invMassWindowB0", 1.5, "half-width of the D pi invariant-mass window applied before the B0 vertex fit (GeV/c^2), no selection if negative"};
 
   double massPi = RecoDecay::getMassPDG(kPiPlus);
   double massD = RecoDecay::getMassPDG(pdg::Code::kDMinus);
+  double massB0 = RecoDecay::getMassPDG(pdg::Code::kB0);
   double massDPi = 0.;
 
+  BachelorBuckets bachelors; // pion tracks of the collision
+
   Filter filterSelectCandidates = (aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= selectionFlagD); // FIXME
 
   OutputObj<TH1F> hMassDToPiKPi{TH1F("hMassB0ToPiKPi", "D^{#minus} candidates;inv. mass (p^{#minus} K^{#plus} #pi^{#minus}) (GeV/#it{c}^{2});entries", 500, 0., 5.)};
@@ -89,6 +96,12 @@ struct HfCandidateCreatorB0 {
     df3.setMinRelChi2Change(minRelChi2Change);
     df3.setUseAbsDCA(true);
 
+    if (dCands.size() == 0) {
+      return;
+    }
+    // select the pions once per collision
+    bachelors.fill(tracks, ptPionMin, -1.f);
+
     // loop over D candidates
     for (auto const& dCand : dCands) {
       if (!TESTBIT(dCand.hfflag(), hf_cand_3prong::DecayType::DplusToPiKPi)) {
@@ -104,189 +117,115 @@ struct HfCandidateCreatorB0 {
       auto track0 = dCand.prong0_as<aod::BigTracks>();
       auto track1 = dCand.prong1_as<aod::BigTracks>();
       auto track2 = dCand.prong2_as<aod::BigTracks>();
-      auto trackParVar0 = getTrackParCov(track0);
-      auto trackParVar1 = getTrackParCov(track1);
-      auto trackParVar2 = getTrackParCov(track2);
       auto collision = track0.collision();
 
-      // reconstruct 3-prong secondary vertex (D±)
-      if (df3.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
-        continue;
-      }
-
-      const auto& secondaryVertex = df3.getPCACandidate();
-      trackParVar0.propagateTo(secondaryVertex[0], bz);
-      trackParVar1.propagateTo(secondaryVertex[0], bz);
-      trackParVar2.propagateTo(secondaryVertex[0], bz);
-
       // D∓ → π∓ K± π∓
       array<float, 3> pVecpiK = {track0.px() + track1.px(), track0.py() + track1.py(), track0.pz() + track1.pz()};
       array<float, 3> pVecD = {pVecpiK[0] + track2.px(), pVecpiK[1] + track2.py(), pVecpiK[2] + track2.pz()};
-      auto trackParVarPiK = o2::dataformats::V0(df3.getPCACandidatePos(), pVecpiK, df3.calcPCACovMatrixFlat(),
-                                                trackParVar0, trackParVar1, {0, 0}, {0, 0});
-      auto trackParVarD = o2::dataformats::V0(df3.getPCACandidatePos(), pVecD, df3.calcPCACovMatrixFlat(),
-                                              trackParVarPiK, trackParVar2, {0, 0}, {0, 0});
+      const array<float, 3> pVecDIni = pVecD;
+
+      // the D vertex is refitted only if the candidate has at least one pion in the mass window
+      int statusDRefit = 0; // 0: not refitted yet, 1: refitted, -1: refit failed
+      o2::dataformats::V0 trackParVarD;
 
       int index0D = track0.globalIndex();
       int index1D = track1.globalIndex();
       int index2D = track2.globalIndex();
-      // int charge = track0.sign() + track1.sign() + track2.sign();
 
-      // loop on D-
-      // D- → π- K+ π-
+      // D- → π- K+ π- is combined with π+ to reconstruct B0, D+ → π+ K- π+ with π- to reconstruct B0bar
       // we don't have direct access to D sign so we use the sign of the daughters (the pion track0 here)
-      if (track0.sign() < 0) {
-        // loop over pions
-        for (auto const& trackPion : tracks) {
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin) {
-            continue;
-          }
-          // we reject pions that are D daughters
-          if (trackPion.globalIndex() == index0D || trackPion.globalIndex() == index1D || trackPion.globalIndex() == index2D) {
-            continue;
-          }
-          // we only keep pi+ to combine them with Dminus and reconstruct B0
-          if (trackPion.sign() < 0) {
-            continue;
-          }
+      for (auto const& trackPion : bachelors.get(-track0.sign())) {
+        // we reject pions that are D daughters
+        if (trackPion.globalIndex == index0D || trackPion.globalIndex == index1D || trackPion.globalIndex == index2D) {
+          continue;
+        }
 
-          hPtPion->Fill(trackPion.pt());
-          array<float, 3> pVecPion;
-          auto trackParVarPi = getTrackParCov(trackPion);
+        hPtPion->Fill(trackPion.pt);
 
-          // ---------------------------------
-          // reconstruct the 2-prong B0 vertex
-          if (df2.process(trackParVarD, trackParVarPi) == 0) {
-            continue;
-          }
+        if (!isInMassWindow(pVecDIni, massD, trackPion.pVec, massPi, massB0, invMassWindowB0)) {
+          continue;
+        }
 
-          // calculate relevant properties
-          const auto& secondaryVertexB0 = df2.getPCACandidate();
-          auto chi2PCA = df2.getChi2AtPCACandidate();
-          auto covMatrixPCA = df2.calcPCACovMatrixFlat();
-
-          df2.propagateTracksToVertex();
-          df2.getTrack(0).getPxPyPzGlo(pVecD);
-          df2.getTrack(1).getPxPyPzGlo(pVecPion);
-
-          auto primaryVertex = getPrimaryVertex(collision);
-          auto covMatrixPV = primaryVertex.getCov();
-          o2::dataformats::DCA impactParameter0;
-          o2::dataformats::DCA impactParameter1;
-          trackParVarD.propagateToDCA(primaryVertex, bz, &impactParameter0);
-          trackParVarPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
-
-          hCovSVXX->Fill(covMatrixPCA[0]);
-          hCovPVXX->Fill(covMatrixPV[0]);
-
-          // get uncertainty of the decay length
-          double phi, theta;
-          getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertexB0, phi, theta);
-          auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-          auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-          int hfFlag = BIT(hf_cand_b0::DecayType::B0ToDPi);
-
-          // fill the candidate table for the B0 here:
-          rowCandidateBase(collision.globalIndex(),
-                           collision.posX(), collision.posY(), collision.posZ(),
-                           secondaryVertexB0[0], secondaryVertexB0[1], secondaryVertexB0[2],
-                           errorDecayLength, errorDecayLengthXY,
-                           chi2PCA,
-                           pVecD[0], pVecD[1], pVecD[2],
-                           pVecPion[0], pVecPion[1], pVecPion[2],
-                           impactParameter0.getY(), impactParameter1.getY(),
-                           std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
-                           dCand.globalIndex(), trackPion.globalIndex(),
-                           hfFlag);
-
-          // calculate invariant mass
-          auto arrayMomenta = array{pVecD, pVecPion};
-          massDPi = RecoDecay::m(std::move(arrayMomenta), array{massD, massPi});
-          if (dCand.isSelDplusToPiKPi() > 0) {
-            hMassB0ToDPi->Fill(massDPi);
-          }
-        } // pi+ loop
-      }   // if D-
-
-      // loop on D+
-      // D+ → π+ K- π+
-      // we now loop on the D+
-      if (track0.sign() > 0) {
-        // loop over pions
-        for (auto const& trackPion : tracks) {
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin) {
-            continue;
-          }
-          // we reject pions that are D daughters
-          if (trackPion.globalIndex() == index0D || trackPion.globalIndex() == index1D || trackPion.globalIndex() == index2D) {
-            continue;
-          }
-          // we onnly keep pi- to combine them with D+ and reconstruct B0bar
-          if (trackPion.sign() > 0) {
-            continue;
+        if (statusDRefit == 0) {
+          auto trackParVar0 = getTrackParCov(track0);
+          auto trackParVar1 = getTrackParCov(track1);
+          auto trackParVar2 = getTrackParCov(track2);
+          // reconstruct 3-prong secondary vertex (D±)
+          statusDRefit = -1;
+          if (df3.process(trackParVar0, trackParVar1, trackParVar2) != 0) {
+            const auto& secondaryVertex = df3.getPCACandidate();
+            trackParVar0.propagateTo(secondaryVertex[0], bz);
+            trackParVar1.propagateTo(secondaryVertex[0], bz);
+            trackParVar2.propagateTo(secondaryVertex[0], bz);
+            auto trackParVarPiK = o2::dataformats::V0(df3.getPCACandidatePos(), pVecpiK, df3.calcPCACovMatrixFlat(),
+                                                      trackParVar0, trackParVar1, {0, 0}, {0, 0});
+            trackParVarD = o2::dataformats::V0(df3.getPCACandidatePos(), pVecDIni, df3.calcPCACovMatrixFlat(),
+                                               trackParVarPiK, trackParVar2, {0, 0}, {0, 0});
+            statusDRefit = 1;
           }
+        }
+        if (statusDRefit < 0) {
+          break;
+        }
 
-          hPtPion->Fill(trackPion.pt());
-          array<float, 3> pVecPion;
-          auto trackParVarPi = getTrackParCov(trackPion);
+        array<float, 3> pVecPion;
+        auto trackParVarPi = trackPion.trackParCov;
 
-          // ---------------------------------
-          // reconstruct the 2-prong B0bar vertex
-          if (df2.process(trackParVarD, trackParVarPi) == 0) {
-            continue;
-          }
+        // ---------------------------------
+        // reconstruct the 2-prong B0 vertex
+        if (df2.process(trackParVarD, trackParVarPi) == 0) {
+          continue;
+        }
 
-          // calculate relevant properties
-          const auto& secondaryVertexB0 = df2.getPCACandidate();
-          auto chi2PCA = df2.getChi2AtPCACandidate();
-          auto covMatrixPCA = df2.calcPCACovMatrixFlat();
-
-          df2.propagateTracksToVertex();
-          df2.getTrack(0).getPxPyPzGlo(pVecD);
-          df2.getTrack(1).getPxPyPzGlo(pVecPion);
-
-          auto primaryVertex = getPrimaryVertex(collision);
-          auto covMatrixPV = primaryVertex.getCov();
-          o2::dataformats::DCA impactParameter0;
-          o2::dataformats::DCA impactParameter1;
-          trackParVarD.propagateToDCA(primaryVertex, bz, &impactParameter0);
-          trackParVarPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
-
-          hCovSVXX->Fill(covMatrixPCA[0]);
-          hCovPVXX->Fill(covMatrixPV[0]);
-
-          // get uncertainty of the decay length
-          double phi, theta;
-          getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertexB0, phi, theta);
-          auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-          auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-          int hfFlag = BIT(hf_cand_b0::DecayType::B0ToDPi);
-
-          // fill the candidate table for the B0 here:
-          rowCandidateBase(collision.globalIndex(),
-                           collision.posX(), collision.posY(), collision.posZ(),
-                           secondaryVertexB0[0], secondaryVertexB0[1], secondaryVertexB0[2],
-                           errorDecayLength, errorDecayLengthXY,
-                           chi2PCA,
-                           pVecD[0], pVecD[1], pVecD[2],
-                           pVecPion[0], pVecPion[1], pVecPion[2],
-                           impactParameter0.getY(), impactParameter1.getY(),
-                           std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
-                           dCand.globalIndex(), trackPion.globalIndex(),
-                           hfFlag);
-
-          // calculate invariant mass
-          auto arrayMomenta = array{pVecD, pVecPion};
-          massDPi = RecoDecay::m(std::move(arrayMomenta), array{massD, massPi});
-          if (dCand.isSelDplusToPiKPi() > 0) {
-            hMassB0ToDPi->Fill(massDPi);
-          }
-        } // pi- loop
-      }   // if D+
+        // calculate relevant properties
+        const auto& secondaryVertexB0 = df2.getPCACandidate();
+        auto chi2PCA = df2.getChi2AtPCACandidate();
+        auto covMatrixPCA = df2.calcPCACovMatrixFlat();
+
+        df2.propagateTracksToVertex();
+        df2.getTrack(0).getPxPyPzGlo(pVecD);
+        df2.getTrack(1).getPxPyPzGlo(pVecPion);
+
+        auto primaryVertex = getPrimaryVertex(collision);
+        auto covMatrixPV = primaryVertex.getCov();
+        o2::dataformats::DCA impactParameter0;
+        o2::dataformats::DCA impactParameter1;
+        // NOTE: the D track is propagated to the DCA with a copy, so that it can be reused for the next pions
+        auto trackParVarDAtDCA = trackParVarD;
+        trackParVarDAtDCA.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVarPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
+
+        hCovSVXX->Fill(covMatrixPCA[0]);
+        hCovPVXX->Fill(covMatrixPV[0]);
+
+        // get uncertainty of the decay length
+        double phi, theta;
+        getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertexB0, phi, theta);
+        auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+        auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+        int hfFlag = BIT(hf_cand_b0::DecayType::B0ToDPi);
+
+        // fill the candidate table for the B0 here:
+        rowCandidateBase(collision.globalIndex(),
+                         collision.posX(), collision.posY(), collision.posZ(),
+                         secondaryVertexB0[0], secondaryVertexB0[1], secondaryVertexB0[2],
+                         errorDecayLength, errorDecayLengthXY,
+                         chi2PCA,
+                         pVecD[0], pVecD[1], pVecD[2],
+                         pVecPion[0], pVecPion[1], pVecPion[2],
+                         impactParameter0.getY(), impactParameter1.getY(),
+                         std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
+                         dCand.globalIndex(), trackPion.globalIndex,
+                         hfFlag);
+
+        // calculate invariant mass
+        auto arrayMomenta = array{pVecD, pVecPion};
+        massDPi = RecoDecay::m(std::move(arrayMomenta), array{massD, massPi});
+        if (dCand.isSelDplusToPiKPi() > 0) {
+          hMassB0ToDPi->Fill(massDPi);
+        }
+      } // pion loop
     }     // D loop
   }       // process
 };        // struct
@@ -303,10 +242,17 @@ struct HfCandidateCreatorB0Mc {
   Produces<aod::HfCandB0McRec> rowMcMatchRec; // table defined in CandidateReconstructionTables.h
   Produces<aod::HfCandB0McGen> rowMcMatchGen; // table defined in CandidateReconstructionTables.h
 
-  void processMc(aod::HfCandB0 const& candidates,
-                 aod::HfCand3Prong const&,
-                 aod::BigTracksMC const& tracks,
-                 aod::McParticles const& particlesMC)
+  void init(InitContext const&)
+  {
+    if (doprocessMc && doprocessMcGenFlags) {
+      LOGF(fatal, "Only one of processMc and processMcGenFlags can be enabled");
+    }
+  }
+
+  /// Performs MC matching of the reconstructed candidates.
+  template <typename TParticles>
+  void matchRec(aod::HfCandB0 const& candidates,
+                TParticles const& particlesMC)
   {
     int indexRec = -1;
     int8_t sign = 0;
@@ -344,25 +290,37 @@ struct HfCandidateCreatorB0Mc {
       }
       rowMcMatchRec(flag, origin, debug);
     }
+  }
+
+  void processMc(aod::HfCandB0 const& candidates,
+                 aod::HfCand3Prong const&,
+                 aod::BigTracksMC const& tracks,
+                 aod::McParticles const& particlesMC)
+  {
+    matchRec(candidates, particlesMC);
 
     // Match generated particles.
     for (auto const& particle : particlesMC) {
       // Printf("New gen. candidate");
-      flag = 0;
-      origin = 0;
-      // B0 → D- π+
-      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kB0, array{-int(pdg::Code::kDPlus), +kPiPlus}, true)) {
-        // Match D- -> π- K+ π-
-        auto candDMC = particlesMC.rawIteratorAt(particle.daughtersIds().front());
-        // Printf("Checking D- -> π- K+ π-");
-        if (RecoDecay::isMatchedMCGen(particlesMC, candDMC, -int(pdg::Code::kDPlus), array{-kPiPlus, +kKPlus, -kPiPlus}, true, &sign)) {
-          flag = sign * BIT(hf_cand_b0::DecayType::B0ToDPi);
-        }
-      }
-      rowMcMatchGen(flag, origin);
+      // B0 → D- π+ → (π- K+ π-) π+
+      rowMcMatchGen(o2::analysis::hf_mc_gen::matchGenB0(particlesMC, particle), 0);
     }
   }
   PROCESS_SWITCH(HfCandidateCreatorB0Mc, processMc, "Process MC", false);
+
+  /// Performs MC matching, with the generator-level matching of hf-candidate-creator-mc-gen.
+  void processMcGenFlags(aod::HfCandB0 const& candidates,
+                         aod::HfCand3Prong const&,
+                         aod::BigTracksMC const& tracks,
+                         soa::Join<aod::McParticles, aod::HfMcGenFlags> const& particlesMC)
+  {
+    matchRec(candidates, particlesMC);
+
+    for (auto const& particle : particlesMC) {
+      rowMcMatchGen(particle.flagMcMatchGenB0(), 0);
+    }
+  }
+  PROCESS_SWITCH(HfCandidateCreatorB0Mc, processMcGenFlags, "Process MC, with the generator-level matching of hf-candidate-creator-mc-gen", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
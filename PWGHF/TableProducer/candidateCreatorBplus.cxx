@@ -25,6 +25,7 @@
 #include "ReconstructionDataFormats/DCA.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "ReconstructionDataFormats/V0.h"
+#include "PWGHF/Utils/utilsBhadronCreator.h"
 
 using namespace o2;
 using namespace o2::aod;
@@ -34,6 +35,7 @@ using namespace o2::analysis;
 using namespace o2::aod::hf_cand;
 using namespace o2::aod::hf_cand_2prong;
 using namespace o2::aod::hf_cand_bplus;
+using namespace o2::analysis::hf_bhadron;
 
 void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
 {
@@ -60,6 +62,13 @@ struct HfCandidateCreatorBplus {
   Configurable<int> selectionFlagD0bar{"selectionFlagD0bar", 1, "Selection Flag for D0bar"};
   Configurable<double> yCandMax{"yCandMax", -1., "max. cand. rapidity"};
   Configurable<double> etaTrackMax{"etaTrackMax", -1, "max. bach track. pseudorapidity"};
+  Configurable<double> invMassWindowBplus{"invMassWindowBplus", 1.5, "half-width of the D0 pi invariant-mass window applied before the B vertex fit (GeV/c^2), no selection if negative"};
+
+  double massPi = RecoDecay::getMassPDG(kPiPlus);
+  double massD0 = RecoDecay::getMassPDG(pdg::Code::kD0);
+  double massBplus = RecoDecay::getMassPDG(pdg::Code::kBPlus);
+
+  BachelorBuckets bachelors; // bachelor tracks of the collision
 
   Filter filterSelectCandidates = (aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar);
 
@@ -94,6 +103,12 @@ struct HfCandidateCreatorBplus {
     df.setMinRelChi2Change(minRelChi2Change);
     df.setUseAbsDCA(useAbsDCA);
 
+    if (candidates.size() == 0) {
+      return;
+    }
+    // select the bachelor tracks once per collision
+    bachelors.fill(tracks, 0.f, etaTrackMax);
+
     // loop over pairs of track indices
     for (auto& candidate : candidates) {
       if (!(candidate.hfflag() & 1 << hf_cand_2prong::DecayType::D0ToPiK)) {
@@ -108,107 +123,101 @@ struct HfCandidateCreatorBplus {
       const std::array<float, 3> vertexD0 = {candidate.xSecondaryVertex(), candidate.ySecondaryVertex(), candidate.zSecondaryVertex()};
       const std::array<float, 3> momentumD0 = {candidate.px(), candidate.py(), candidate.pz()};
 
-      auto prong0 = candidate.prong0_as<aod::BigTracks>();
-      auto prong1 = candidate.prong1_as<aod::BigTracks>();
-      auto prong0TrackParCov = getTrackParCov(prong0);
-      auto prong1TrackParCov = getTrackParCov(prong1);
-      auto collision = prong0.collision();
-
-      // LOGF(info, "All track: %d (prong0); %d (prong1)", candidate.prong0().globalIndex(), candidate.prong1().globalIndex());
-      // LOGF(info, "All track pT: %f (prong0); %f (prong1)", prong0.pt(), prong1.pt());
-
-      // reconstruct D0 secondary vertex
-      if (df.process(prong0TrackParCov, prong1TrackParCov) == 0) {
-        continue;
-      }
-
-      prong0TrackParCov.propagateTo(candidate.xSecondaryVertex(), bz);
-      prong1TrackParCov.propagateTo(candidate.xSecondaryVertex(), bz);
-      // std::cout << df.getTrack(0).getX() << " "<< "secVx=" << candidate.xSecondaryVertex() << std::endl;
-
-      const std::array<float, 6> pCovMatrixD0 = df.calcPCACovMatrixFlat();
-      // build a D0 neutral track
-      auto trackD0 = o2::dataformats::V0(vertexD0, momentumD0, pCovMatrixD0, prong0TrackParCov, prong1TrackParCov, {0, 0}, {0, 0});
-
-      // loop over tracks for pi selection
-      // auto count = 0;
-      for (auto& track : tracks) {
-        // if(count % 100 == 0){
-        // LOGF(info, "Col: %d (cand); %d (track)", candidate.collisionId(), track.collisionId());
-        //   count++;
-        //  }
+      // the D0 vertex is refitted only if the candidate has at least one bachelor in the mass window
+      int statusD0Refit = 0; // 0: not refitted yet, 1: refitted, -1: refit failed
+      o2::dataformats::V0 trackD0;
+      auto collision = candidate.prong0_as<aod::BigTracks>().collision();
 
-        if (etaTrackMax >= 0. && std::abs(track.eta()) > etaTrackMax) {
+      // Select D0pi- and D0(bar)pi+ pairs only, loop over the bachelors of each allowed charge
+      for (const int sign : {-1, +1}) {
+        if (!((sign < 0 && candidate.isSelD0() >= selectionFlagD0) || (sign > 0 && candidate.isSelD0bar() >= selectionFlagD0bar))) {
           continue;
         }
+        for (auto const& track : bachelors.get(sign)) {
+          hEtaPi->Fill(track.eta);
 
-        hEtaPi->Fill(track.eta());
+          if (candidate.prong0Id() == track.globalIndex || candidate.prong1Id() == track.globalIndex) {
+            continue; // daughter track id and bachelor track id not the same
+          }
 
-        if (candidate.prong0Id() == track.globalIndex() || candidate.prong1Id() == track.globalIndex()) {
-          continue; // daughter track id and bachelor track id not the same
-        }
+          if (!isInMassWindow(momentumD0, massD0, track.pVec, massPi, massBplus, invMassWindowBplus)) {
+            continue;
+          }
 
-        // Select D0pi- and D0(bar)pi+ pairs only
-        if (!((candidate.isSelD0() >= selectionFlagD0 && track.sign() < 0) || (candidate.isSelD0bar() >= selectionFlagD0bar && track.sign() > 0))) {
-          // Printf("D0: %d, D0bar%d, sign: %d", candidate.isSelD0(), candidate.isSelD0bar(), track.sign());
-          continue;
-        }
+          if (statusD0Refit == 0) {
+            auto prong0TrackParCov = getTrackParCov(candidate.prong0_as<aod::BigTracks>());
+            auto prong1TrackParCov = getTrackParCov(candidate.prong1_as<aod::BigTracks>());
+            // reconstruct D0 secondary vertex
+            statusD0Refit = -1;
+            if (df.process(prong0TrackParCov, prong1TrackParCov) != 0) {
+              prong0TrackParCov.propagateTo(candidate.xSecondaryVertex(), bz);
+              prong1TrackParCov.propagateTo(candidate.xSecondaryVertex(), bz);
+              const std::array<float, 6> pCovMatrixD0 = df.calcPCACovMatrixFlat();
+              // build a D0 neutral track
+              trackD0 = o2::dataformats::V0(vertexD0, momentumD0, pCovMatrixD0, prong0TrackParCov, prong1TrackParCov, {0, 0}, {0, 0});
+              statusD0Refit = 1;
+            }
+          }
+          if (statusD0Refit < 0) {
+            break;
+          }
 
-        auto trackBach = getTrackParCov(track);
-        std::array<float, 3> pVecD0 = {0., 0., 0.};
-        std::array<float, 3> pVecBach = {0., 0., 0.};
-        std::array<float, 3> pVecBCand = {0., 0., 0.};
+          auto trackBach = track.trackParCov;
+          std::array<float, 3> pVecD0 = {0., 0., 0.};
+          std::array<float, 3> pVecBach = {0., 0., 0.};
+          std::array<float, 3> pVecBCand = {0., 0., 0.};
 
-        // find the DCA between the D0 and the bachelor track, for B+
-        if (bfitter.process(trackD0, trackBach) == 0) {
-          continue;
-        }
+          // find the DCA between the D0 and the bachelor track, for B+
+          if (bfitter.process(trackD0, trackBach) == 0) {
+            continue;
+          }
 
-        bfitter.propagateTracksToVertex();          // propagate the bachelor and D0 to the B+ vertex
-        bfitter.getTrack(0).getPxPyPzGlo(pVecD0);   // momentum of D0 at the B+ vertex
-        bfitter.getTrack(1).getPxPyPzGlo(pVecBach); // momentum of pi+ at the B+ vertex
-        const auto& BSecVertex = bfitter.getPCACandidate();
-        auto chi2PCA = bfitter.getChi2AtPCACandidate();
-        auto covMatrixPCA = bfitter.calcPCACovMatrixFlat();
-        hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
-
-        pVecBCand = RecoDecay::pVec(pVecD0, pVecBach);
-
-        // get track impact parameters
-        // This modifies track momenta!
-        auto primaryVertex = getPrimaryVertex(collision);
-        auto covMatrixPV = primaryVertex.getCov();
-        hCovPVXX->Fill(covMatrixPV[0]);
-        o2::dataformats::DCA impactParameter0;
-        o2::dataformats::DCA impactParameter1;
-
-        bfitter.getTrack(0).propagateToDCA(primaryVertex, bz, &impactParameter0);
-        bfitter.getTrack(1).propagateToDCA(primaryVertex, bz, &impactParameter1);
-
-        // get uncertainty of the decay length
-        double phi, theta;
-        getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, BSecVertex, phi, theta);
-        auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-        auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-        int hfFlag = 1 << hf_cand_bplus::DecayType::BplusToD0Pi;
-
-        // fill candidate table rows
-        rowCandidateBase(collision.globalIndex(),
-                         collision.posX(), collision.posY(), collision.posZ(),
-                         BSecVertex[0], BSecVertex[1], BSecVertex[2],
-                         errorDecayLength, errorDecayLengthXY,
-                         chi2PCA,
-                         pVecD0[0], pVecD0[1], pVecD0[2],
-                         pVecBach[0], pVecBach[1], pVecBach[2],
-                         impactParameter0.getY(), impactParameter1.getY(),
-                         std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
-                         candidate.globalIndex(), track.globalIndex(), // index D0 and bachelor
-                         hfFlag);
-      } // track loop
-    }   // D0 cand loop
-  }     // process
-};      // struct
+          bfitter.propagateTracksToVertex();          // propagate the bachelor and D0 to the B+ vertex
+          bfitter.getTrack(0).getPxPyPzGlo(pVecD0);   // momentum of D0 at the B+ vertex
+          bfitter.getTrack(1).getPxPyPzGlo(pVecBach); // momentum of pi+ at the B+ vertex
+          const auto& BSecVertex = bfitter.getPCACandidate();
+          auto chi2PCA = bfitter.getChi2AtPCACandidate();
+          auto covMatrixPCA = bfitter.calcPCACovMatrixFlat();
+          hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
+
+          pVecBCand = RecoDecay::pVec(pVecD0, pVecBach);
+
+          // get track impact parameters
+          // This modifies track momenta!
+          auto primaryVertex = getPrimaryVertex(collision);
+          auto covMatrixPV = primaryVertex.getCov();
+          hCovPVXX->Fill(covMatrixPV[0]);
+          o2::dataformats::DCA impactParameter0;
+          o2::dataformats::DCA impactParameter1;
+
+          bfitter.getTrack(0).propagateToDCA(primaryVertex, bz, &impactParameter0);
+          bfitter.getTrack(1).propagateToDCA(primaryVertex, bz, &impactParameter1);
+
+          // get uncertainty of the decay length
+          double phi, theta;
+          getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, BSecVertex, phi, theta);
+          auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+          auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+          int hfFlag = 1 << hf_cand_bplus::DecayType::BplusToD0Pi;
+
+          // fill candidate table rows
+          rowCandidateBase(collision.globalIndex(),
+                           collision.posX(), collision.posY(), collision.posZ(),
+                           BSecVertex[0], BSecVertex[1], BSecVertex[2],
+                           errorDecayLength, errorDecayLengthXY,
+                           chi2PCA,
+                           pVecD0[0], pVecD0[1], pVecD0[2],
+                           pVecBach[0], pVecBach[1], pVecBach[2],
+                           impactParameter0.getY(), impactParameter1.getY(),
+                           std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
+                           candidate.globalIndex(), track.globalIndex, // index D0 and bachelor
+                           hfFlag);
+        } // track loop
+      }   // charge loop
+    }     // D0 cand loop
+  }       // process
+};        // struct
 
 /// Extends the base table with expression columns.
 struct HfCandidateCreatorBplusExpressions {
@@ -23,6 +23,7 @@
 #include "ReconstructionDataFormats/DCA.h"
 #include "ReconstructionDataFormats/V0.h"
 #include "PWGHF/Utils/utilsDebugLcToK0sP.h"
+#include "PWGHF/Utils/utilsMcGen.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -217,13 +218,19 @@ struct HfCandidateCreatorCascadeMc {
   Configurable<std::vector<int>> indexProton{"indexProton", {717, 2810, 4393, 5442, 6769, 7793, 9002, 9789}, "indices of protons, for debug"};
 #endif
 
-  void processMc(aod::BigTracksMC const& tracks,
-                 aod::McParticles const& particlesMC)
+  void init(InitContext const&)
+  {
+    if (doprocessMc && doprocessMcGenFlags) {
+      LOGF(fatal, "Only one of processMc and processMcGenFlags can be enabled");
+    }
+  }
+
+  /// Performs MC matching of the reconstructed candidates.
+  template <typename TParticles>
+  void matchRec(aod::BigTracksMC const& tracks,
+                TParticles const& particlesMC)
   {
     int8_t sign = 0;
-    std::vector<int> arrDaughLcIndex;
-    std::array<int, 3> arrDaughLcPDG;
-    std::array<int, 3> arrDaughLcPDGRef = {2212, 211, -211};
 
     // Match reconstructed candidates.
     rowCandidateCasc->bindExternalIndices(&tracks);
@@ -263,34 +270,36 @@ struct HfCandidateCreatorCascadeMc {
       rowMcMatchRec(sign);
     }
     //}
+  }
+
+  void processMc(aod::BigTracksMC const& tracks,
+                 aod::McParticles const& particlesMC)
+  {
+    matchRec(tracks, particlesMC);
 
     // Match generated particles.
     for (auto& particle : particlesMC) {
-      // checking if I have a Lc --> K0S + p
-      RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kLambdaCPlus, array{+kProton, +kK0Short}, true, &sign, 2);
-      if (sign != 0) {
-        MY_DEBUG_MSG(sign, LOG(info) << "Lc in K0S p");
-        arrDaughLcIndex.clear();
-        // checking that the final daughters (decay depth = 3) are p, pi+, pi-
-        RecoDecay::getDaughters(particle, &arrDaughLcIndex, arrDaughLcPDGRef, 3); // best would be to check the K0S daughters
-        if (arrDaughLcIndex.size() == 3) {
-          for (std::size_t iProng = 0; iProng < arrDaughLcIndex.size(); ++iProng) {
-            auto daughI = particlesMC.rawIteratorAt(arrDaughLcIndex[iProng]);
-            arrDaughLcPDG[iProng] = daughI.pdgCode();
-          }
-          if (!(arrDaughLcPDG[0] == arrDaughLcPDGRef[0] && arrDaughLcPDG[1] == arrDaughLcPDGRef[1] && arrDaughLcPDG[2] == arrDaughLcPDGRef[2])) { // this should be the condition, first bach, then v0
-            sign = 0;
-          } else {
-            LOG(info) << "Lc --> K0S+p found in MC table";
-          }
-          MY_DEBUG_MSG(sign == 0, LOG(info) << "Pity, the three final daughters are not p, pi+, pi-, but " << arrDaughLcPDG[0] << ", " << arrDaughLcPDG[1] << ", " << arrDaughLcPDG[2]);
-        }
-      }
+      // checking if I have a Lc --> K0S + p, with the final daughters p, pi+, pi-
+      int8_t sign = o2::analysis::hf_mc_gen::matchGenCascade(particlesMC, particle);
+      MY_DEBUG_MSG(sign, LOG(info) << "Lc in K0S p");
       rowMcMatchGen(sign);
     }
   }
 
   PROCESS_SWITCH(HfCandidateCreatorCascadeMc, processMc, "Process MC data", false);
+
+  /// Performs MC matching, with the generator-level matching of hf-candidate-creator-mc-gen.
+  void processMcGenFlags(aod::BigTracksMC const& tracks,
+                         soa::Join<aod::McParticles, aod::HfMcGenFlags> const& particlesMC)
+  {
+    matchRec(tracks, particlesMC);
+
+    for (const auto& particle : particlesMC) {
+      rowMcMatchGen(particle.flagMcMatchGenCascade());
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateCreatorCascadeMc, processMcGenFlags, "Process MC data, with the generator-level matching of hf-candidate-creator-mc-gen", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -22,6 +22,7 @@
 #include "ReconstructionDataFormats/DCA.h"
 #include "ReconstructionDataFormats/V0.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsBhadronCreator.h"
 
 using namespace o2;
 using namespace o2::aod;
@@ -30,6 +31,7 @@ using namespace o2::aod::hf_cand;
 using namespace o2::aod::hf_cand_2prong;
 using namespace o2::aod::hf_cand_3prong;
 using namespace o2::aod::hf_cand_lb;
+using namespace o2::analysis::hf_bhadron;
 using namespace o2::framework::expressions;
 
 void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
@@ -55,11 +57,15 @@ struct HfCandidateCreatorLb {
   Configurable<double> ptPionMin{"ptPionMin", 0.5, "minimum pion pT threshold (GeV/c)"};
   Configurable<int> selectionFlagLc{"selectionFlagLc", 1, "Selection Flag for Lc"};
   Configurable<double> yCandMax{"yCandMax", -1., "max. cand. rapidity"};
+  Configurable<double> invMassWindowLb{"invMassWindowLb", 1.5, "half-width of the Lc pi invariant-mass window applied before the Lb vertex fit (GeV/c^2), no selection if negative"};
 
   double massPi = RecoDecay::getMassPDG(kPiMinus);
   double massLc = RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus);
+  double massLb = RecoDecay::getMassPDG(pdg::Code::kLambdaB0);
   double massLcPi = 0.;
 
+  BachelorBuckets bachelors; // pion tracks of the collision
+
   Filter filterSelectCandidates = (aod::hf_sel_candidate_lc::isSelLcToPKPi >= selectionFlagLc || aod::hf_sel_candidate_lc::isSelLcToPiKP >= selectionFlagLc);
 
   OutputObj<TH1F> hMassLcToPKPi{TH1F("hMassLcToPKPi", "#Lambda_{c}^{#plus} candidates;inv. mass (pK^{#minus} #pi^{#plus}) (GeV/#it{c}^{2});entries", 500, 0., 5.)};
@@ -96,6 +102,12 @@ struct HfCandidateCreatorLb {
     df3.setMinRelChi2Change(minRelChi2Change);
     df3.setUseAbsDCA(true);
 
+    if (lcCands.size() == 0) {
+      return;
+    }
+    // select the pions once per collision
+    bachelors.fill(tracks, ptPionMin, -1.f);
+
     // loop over Lc candidates
     for (auto& lcCand : lcCands) {
       if (!(lcCand.hfflag() & 1 << o2::aod::hf_cand_3prong::DecayType::LcToPKPi)) {
@@ -113,45 +125,55 @@ struct HfCandidateCreatorLb {
       auto track0 = lcCand.prong0_as<aod::BigTracks>();
       auto track1 = lcCand.prong1_as<aod::BigTracks>();
       auto track2 = lcCand.prong2_as<aod::BigTracks>();
-      auto trackParVar0 = getTrackParCov(track0);
-      auto trackParVar1 = getTrackParCov(track1);
-      auto trackParVar2 = getTrackParCov(track2);
       auto collision = track0.collision();
 
-      // reconstruct the 3-prong secondary vertex
-      if (df3.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
-        continue;
-      }
-      const auto& secondaryVertex = df3.getPCACandidate();
-      trackParVar0.propagateTo(secondaryVertex[0], bz);
-      trackParVar1.propagateTo(secondaryVertex[0], bz);
-      trackParVar2.propagateTo(secondaryVertex[0], bz);
-
       array<float, 3> pvecpK = {track0.px() + track1.px(), track0.py() + track1.py(), track0.pz() + track1.pz()};
       array<float, 3> pvecLc = {pvecpK[0] + track2.px(), pvecpK[1] + track2.py(), pvecpK[2] + track2.pz()};
-      auto trackpK = o2::dataformats::V0(df3.getPCACandidatePos(), pvecpK, df3.calcPCACovMatrixFlat(),
-                                         trackParVar0, trackParVar1, {0, 0}, {0, 0});
-      auto trackLc = o2::dataformats::V0(df3.getPCACandidatePos(), pvecLc, df3.calcPCACovMatrixFlat(),
-                                         trackpK, trackParVar2, {0, 0}, {0, 0});
+      const array<float, 3> pvecLcIni = pvecLc;
+
+      // the Lc vertex is refitted only if the candidate has at least one pion in the mass window
+      int statusLcRefit = 0; // 0: not refitted yet, 1: refitted, -1: refit failed
+      o2::dataformats::V0 trackLc;
 
       int index0Lc = track0.globalIndex();
       int index1Lc = track1.globalIndex();
       int index2Lc = track2.globalIndex();
       // int charge = track0.sign() + track1.sign() + track2.sign();
 
-      for (auto& trackPion : tracks) {
-        if (trackPion.pt() < ptPionMin) {
+      for (auto const& trackPion : bachelors.get(-1)) {
+        if (trackPion.globalIndex == index0Lc || trackPion.globalIndex == index1Lc || trackPion.globalIndex == index2Lc) {
           continue;
         }
-        if (trackPion.sign() > 0) {
+        hPtPion->Fill(trackPion.pt);
+
+        if (!isInMassWindow(pvecLcIni, massLc, trackPion.pVec, massPi, massLb, invMassWindowLb)) {
           continue;
         }
-        if (trackPion.globalIndex() == index0Lc || trackPion.globalIndex() == index1Lc || trackPion.globalIndex() == index2Lc) {
-          continue;
+
+        if (statusLcRefit == 0) {
+          auto trackParVar0 = getTrackParCov(track0);
+          auto trackParVar1 = getTrackParCov(track1);
+          auto trackParVar2 = getTrackParCov(track2);
+          // reconstruct the 3-prong secondary vertex
+          statusLcRefit = -1;
+          if (df3.process(trackParVar0, trackParVar1, trackParVar2) != 0) {
+            const auto& secondaryVertex = df3.getPCACandidate();
+            trackParVar0.propagateTo(secondaryVertex[0], bz);
+            trackParVar1.propagateTo(secondaryVertex[0], bz);
+            trackParVar2.propagateTo(secondaryVertex[0], bz);
+            auto trackpK = o2::dataformats::V0(df3.getPCACandidatePos(), pvecpK, df3.calcPCACovMatrixFlat(),
+                                               trackParVar0, trackParVar1, {0, 0}, {0, 0});
+            trackLc = o2::dataformats::V0(df3.getPCACandidatePos(), pvecLcIni, df3.calcPCACovMatrixFlat(),
+                                          trackpK, trackParVar2, {0, 0}, {0, 0});
+            statusLcRefit = 1;
+          }
+        }
+        if (statusLcRefit < 0) {
+          break;
         }
-        hPtPion->Fill(trackPion.pt());
+
         array<float, 3> pvecPion;
-        auto trackParVarPi = getTrackParCov(trackPion);
+        auto trackParVarPi = trackPion.trackParCov;
 
         // reconstruct the 3-prong Lc vertex
         if (df2.process(trackLc, trackParVarPi) == 0) {
@@ -171,7 +193,9 @@ struct HfCandidateCreatorLb {
         auto covMatrixPV = primaryVertex.getCov();
         o2::dataformats::DCA impactParameter0;
         o2::dataformats::DCA impactParameter1;
-        trackLc.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        // NOTE: the Lc track is propagated to the DCA with a copy, so that it can be reused for the next pions
+        auto trackLcAtDCA = trackLc;
+        trackLcAtDCA.propagateToDCA(primaryVertex, bz, &impactParameter0);
         trackParVarPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
 
         hCovSVXX->Fill(covMatrixPCA[0]);
@@ -195,7 +219,7 @@ struct HfCandidateCreatorLb {
                          pvecPion[0], pvecPion[1], pvecPion[2],
                          impactParameter0.getY(), impactParameter1.getY(),
                          std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
-                         lcCand.globalIndex(), trackPion.globalIndex(),
+                         lcCand.globalIndex(), trackPion.globalIndex,
                          hfFlag);
 
         // calculate invariant mass
@@ -0,0 +1,54 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file candidateCreatorMcGen.cxx
+/// \brief Generator-level MC matching of all the particles for the heavy-flavour candidate creators
+///
+/// The MC particles are classified once against the decay channels of the 2-prong, 3-prong, cascade and B0 creators,
+/// with their origin. The creators fill their generator-level tables from this table with their processMcGenFlags
+/// function, instead of each going through all the MC particles again.
+
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+#include "PWGHF/DataModel/CandidateReconstructionTables.h"
+#include "PWGHF/Utils/utilsMcGen.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::analysis::hf_mc_gen;
+
+/// Generator-level MC matching of all the particles
+struct HfCandidateCreatorMcGen {
+  Produces<aod::HfMcGenFlags> rowMcGenFlags;
+
+  void process(aod::McParticles const& particlesMC)
+  {
+    rowMcGenFlags.reserve(particlesMC.size());
+    for (const auto& particle : particlesMC) {
+      int8_t channel3Prong = 0;
+      const int8_t flag2Prong = matchGen2Prong(particlesMC, particle);
+      const int8_t flag3Prong = matchGen3Prong(particlesMC, particle, channel3Prong);
+      const int8_t flagCascade = matchGenCascade(particlesMC, particle);
+      const int8_t flagB0 = matchGenB0(particlesMC, particle);
+      // Check whether the particle is non-prompt (from a b quark).
+      int8_t origin = 0;
+      if (flag2Prong != 0 || flag3Prong != 0) {
+        origin = RecoDecay::getCharmHadronOrigin(particlesMC, particle);
+      }
+      rowMcGenFlags(flag2Prong, flag3Prong, channel3Prong, flagCascade, flagB0, origin);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<HfCandidateCreatorMcGen>(cfgc, TaskName{"hf-candidate-creator-mc-gen"})};
+}
@@ -20,6 +20,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "Common/Core/TrackSelectorPID.h"
+#include "PWGHF/Core/HfMlApplicator.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -29,6 +30,7 @@ using namespace o2::analysis::hf_cuts_d0_to_pi_k;
 /// Struct for applying D0 selection cuts
 struct HfCandidateSelectorD0 {
   Produces<aod::HfSelD0> hfSelD0Candidate;
+  Produces<aod::HfMlD0> hfMlD0Candidate;
 
   Configurable<double> ptCandMin{"ptCandMin", 0., "Lower bound of candidate pT"};
   Configurable<double> ptCandMax{"ptCandMax", 50., "Upper bound of candidate pT"};
@@ -45,6 +47,102 @@ struct HfCandidateSelectorD0 {
   // topological cuts
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{hf_cuts_d0_to_pi_k::vecBinsPt}, "pT bin limits"};
   Configurable<LabeledArray<double>> cuts{"cuts", {hf_cuts_d0_to_pi_k::cuts[0], nBinsPt, nCutVars, labelsPt, labelsCutVar}, "D0 candidate selection per pT bin"};
+  // cut variables used in the selections, index in the resolved cuts
+  enum CutVariable { kCutD0D0 = 0, kCutCpa, kCutCpaXY, kCutDecayLengthXYNormalised, kCutDecayLengthMin, kCutDecayLength, kCutDecayLengthXY, kCutMass, kCutPtPi, kCutPtK, kCutD0Pi, kCutD0K, kCutCosThetaStar };
+  PtBinnedCuts cutsByPt; // cuts resolved at init, to avoid the label lookup per candidate
+  // ML selection
+  Configurable<bool> applyMl{"applyMl", false, "Apply the ML model, fill the HfMlD0 table with its scores and select on the background score"};
+  Configurable<std::string> modelFileMl{"modelFileMl", "ModelHandler_onnx_D0ToKPi.onnx", "ONNX file of the multiclass ML model (background, prompt, non-prompt)"};
+  Configurable<std::vector<std::string>> namesInputFeatures{"namesInputFeatures", std::vector<std::string>{"cpa", "cpaXY", "decayLengthXYNormalised", "impactParameterProduct", "impactParameterNormalised0", "impactParameterNormalised1", "ptProng0", "ptProng1"}, "Input features of the ML model, in the order of the training"};
+  Configurable<std::vector<double>> binsPtMl{"binsPtMl", std::vector<double>{hf_cuts_bdt_multiclass::vecBinsPt}, "pT bin limits for the ML selection"};
+  Configurable<LabeledArray<double>> cutsMl{"cutsMl", {hf_cuts_bdt_multiclass::cuts[0], hf_cuts_bdt_multiclass::nBinsPt, hf_cuts_bdt_multiclass::nCutBdtScores, hf_cuts_bdt_multiclass::labelsPt, hf_cuts_bdt_multiclass::labelsCutBdt}, "ML score thresholds per pT bin, candidates with background score above BDTbkg are rejected"};
+  Configurable<int> numThreadsMl{"numThreadsMl", 1, "Number of threads used by ONNX Runtime within each node of the ML model"};
+
+  // input features the ML model can use
+  enum MlFeature { kFeatCpa = 0, kFeatCpaXY, kFeatDecayLength, kFeatDecayLengthXY, kFeatDecayLengthNormalised, kFeatDecayLengthXYNormalised, kFeatImpactParameterProduct, kFeatImpactParameter0, kFeatImpactParameter1, kFeatImpactParameterNormalised0, kFeatImpactParameterNormalised1, kFeatPtProng0, kFeatPtProng1, kFeatChi2PCA, kNMlFeatures };
+  const std::vector<std::string> mlFeatureNames{"cpa", "cpaXY", "decayLength", "decayLengthXY", "decayLengthNormalised", "decayLengthXYNormalised", "impactParameterProduct", "impactParameter0", "impactParameter1", "impactParameterNormalised0", "impactParameterNormalised1", "ptProng0", "ptProng1", "chi2PCA"};
+  std::vector<int> mlFeatures; // input features of the model, resolved at init
+  HfMlApplicator mlApplicator;
+  PtBinnedCuts cutsMlByPt;
+
+  void init(InitContext const&)
+  {
+    cutsByPt.init(binsPt.value, cuts.value, {"d0d0", "cos pointing angle", "cos pointing angle xy", "normalized decay length XY", "minimum decay length", "decay length", "decay length XY", "m", "pT Pi", "pT K", "d0pi", "d0K", "cos theta*"});
+
+    if (applyMl) {
+      for (const auto& name : namesInputFeatures.value) {
+        auto feature = std::find(mlFeatureNames.begin(), mlFeatureNames.end(), name);
+        if (feature == mlFeatureNames.end()) {
+          LOGF(fatal, "Unknown ML input feature %s", name);
+        }
+        mlFeatures.push_back(std::distance(mlFeatureNames.begin(), feature));
+      }
+      o2::analysis::ONNXSessionSettings sessionSettings{};
+      sessionSettings.intraOpNumThreads = numThreadsMl;
+      mlApplicator.init(modelFileMl.value, sessionSettings);
+      if (mlApplicator.getNFeatures() != static_cast<int>(mlFeatures.size())) {
+        LOGF(fatal, "The ML model expects %d input features, %d configured", mlApplicator.getNFeatures(), mlFeatures.size());
+      }
+      if (mlApplicator.getNClasses() != hf_cuts_bdt_multiclass::nCutBdtScores) {
+        LOGF(fatal, "The ML model returns %d scores, %d expected", mlApplicator.getNClasses(), hf_cuts_bdt_multiclass::nCutBdtScores);
+      }
+      cutsMlByPt.init(binsPtMl.value, cutsMl.value, {"BDTbkg"});
+    }
+  }
+
+  /// Writes the ML input features of a candidate
+  /// \param candidate is candidate
+  /// \param features is the row of the candidate in the input tensor
+  template <typename T>
+  void fillMlFeatures(const T& candidate, float* features)
+  {
+    for (std::size_t iFeature = 0; iFeature < mlFeatures.size(); ++iFeature) {
+      switch (mlFeatures[iFeature]) {
+        case kFeatCpa:
+          features[iFeature] = candidate.cpa();
+          break;
+        case kFeatCpaXY:
+          features[iFeature] = candidate.cpaXY();
+          break;
+        case kFeatDecayLength:
+          features[iFeature] = candidate.decayLength();
+          break;
+        case kFeatDecayLengthXY:
+          features[iFeature] = candidate.decayLengthXY();
+          break;
+        case kFeatDecayLengthNormalised:
+          features[iFeature] = candidate.decayLengthNormalised();
+          break;
+        case kFeatDecayLengthXYNormalised:
+          features[iFeature] = candidate.decayLengthXYNormalised();
+          break;
+        case kFeatImpactParameterProduct:
+          features[iFeature] = candidate.impactParameterProduct();
+          break;
+        case kFeatImpactParameter0:
+          features[iFeature] = candidate.impactParameter0();
+          break;
+        case kFeatImpactParameter1:
+          features[iFeature] = candidate.impactParameter1();
+          break;
+        case kFeatImpactParameterNormalised0:
+          features[iFeature] = candidate.impactParameterNormalised0();
+          break;
+        case kFeatImpactParameterNormalised1:
+          features[iFeature] = candidate.impactParameterNormalised1();
+          break;
+        case kFeatPtProng0:
+          features[iFeature] = candidate.ptProng0();
+          break;
+        case kFeatPtProng1:
+          features[iFeature] = candidate.ptProng1();
+          break;
+        case kFeatChi2PCA:
+          features[iFeature] = candidate.chi2PCA();
+          break;
+      }
+    }
+  }
 
   /*
   /// Selection on goodness of daughter tracks
@@ -68,7 +166,7 @@ struct HfCandidateSelectorD0 {
   bool selectionTopol(const T& candidate)
   {
     auto candpT = candidate.pt();
-    auto pTBin = findBin(binsPt, candpT);
+    auto pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
@@ -78,19 +176,19 @@ struct HfCandidateSelectorD0 {
       return false;
     }
     // product of daughter impact parameters
-    if (candidate.impactParameterProduct() > cuts->get(pTBin, "d0d0")) {
+    if (candidate.impactParameterProduct() > cutsByPt.get(pTBin, kCutD0D0)) {
       return false;
     }
     // cosine of pointing angle
-    if (candidate.cpa() < cuts->get(pTBin, "cos pointing angle")) {
+    if (candidate.cpa() < cutsByPt.get(pTBin, kCutCpa)) {
       return false;
     }
     // cosine of pointing angle XY
-    if (candidate.cpaXY() < cuts->get(pTBin, "cos pointing angle xy")) {
+    if (candidate.cpaXY() < cutsByPt.get(pTBin, kCutCpaXY)) {
       return false;
     }
     // normalised decay length in XY plane
-    if (candidate.decayLengthXYNormalised() < cuts->get(pTBin, "normalized decay length XY")) {
+    if (candidate.decayLengthXYNormalised() < cutsByPt.get(pTBin, kCutDecayLengthXYNormalised)) {
       return false;
     }
     // candidate DCA
@@ -101,14 +199,14 @@ struct HfCandidateSelectorD0 {
     if (std::abs(candidate.impactParameterNormalised0()) < 0.5 || std::abs(candidate.impactParameterNormalised1()) < 0.5) {
       return false;
     }
-    double decayLengthCut = std::min((candidate.p() * 0.0066) + 0.01, cuts->get(pTBin, "minimum decay length"));
+    double decayLengthCut = std::min((candidate.p() * 0.0066) + 0.01, cutsByPt.get(pTBin, kCutDecayLengthMin));
     if (candidate.decayLength() * candidate.decayLength() < decayLengthCut * decayLengthCut) {
       return false;
     }
-    if (candidate.decayLength() > cuts->get(pTBin, "decay length")) {
+    if (candidate.decayLength() > cutsByPt.get(pTBin, kCutDecayLength)) {
       return false;
     }
-    if (candidate.decayLengthXY() > cuts->get(pTBin, "decay length XY")) {
+    if (candidate.decayLengthXY() > cutsByPt.get(pTBin, kCutDecayLengthXY)) {
       return false;
     }
     if (candidate.decayLengthNormalised() * candidate.decayLengthNormalised() < 1.0) {
@@ -127,39 +225,39 @@ struct HfCandidateSelectorD0 {
   bool selectionTopolConjugate(const T1& candidate, const T2& trackPion, const T2& trackKaon)
   {
     auto candpT = candidate.pt();
-    auto pTBin = findBin(binsPt, candpT);
+    auto pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
 
     // invariant-mass cut
     if (trackPion.sign() > 0) {
-      if (std::abs(invMassD0ToPiK(candidate) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassD0ToPiK(candidate) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cutsByPt.get(pTBin, kCutMass)) {
         return false;
       }
     } else {
-      if (std::abs(invMassD0barToKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassD0barToKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cutsByPt.get(pTBin, kCutMass)) {
         return false;
       }
     }
 
     // cut on daughter pT
-    if (trackPion.pt() < cuts->get(pTBin, "pT Pi") || trackKaon.pt() < cuts->get(pTBin, "pT K")) {
+    if (trackPion.pt() < cutsByPt.get(pTBin, kCutPtPi) || trackKaon.pt() < cutsByPt.get(pTBin, kCutPtK)) {
       return false;
     }
 
     // cut on daughter DCA - need to add secondary vertex constraint here
-    if (std::abs(trackPion.dcaXY()) > cuts->get(pTBin, "d0pi") || std::abs(trackKaon.dcaXY()) > cuts->get(pTBin, "d0K")) {
+    if (std::abs(trackPion.dcaXY()) > cutsByPt.get(pTBin, kCutD0Pi) || std::abs(trackKaon.dcaXY()) > cutsByPt.get(pTBin, kCutD0K)) {
       return false;
     }
 
     // cut on cos(theta*)
     if (trackPion.sign() > 0) {
-      if (std::abs(cosThetaStarD0(candidate)) > cuts->get(pTBin, "cos theta*")) {
+      if (std::abs(cosThetaStarD0(candidate)) > cutsByPt.get(pTBin, kCutCosThetaStar)) {
         return false;
       }
     } else {
-      if (std::abs(cosThetaStarD0bar(candidate)) > cuts->get(pTBin, "cos theta*")) {
+      if (std::abs(cosThetaStarD0bar(candidate)) > cutsByPt.get(pTBin, kCutCosThetaStar)) {
         return false;
       }
     }
@@ -180,8 +278,25 @@ struct HfCandidateSelectorD0 {
     TrackSelectorPID selectorKaon(selectorPion);
     selectorKaon.setPDG(kKPlus);
 
+    if (applyMl) {
+      // features of all the candidates first, so that the model runs once per dataframe
+      mlApplicator.clear(candidates.size());
+      for (const auto& candidate : candidates) {
+        fillMlFeatures(candidate, mlApplicator.addCandidate());
+      }
+      mlApplicator.evaluate();
+    }
+
     // looping over 2-prong candidates
+    std::size_t iCand = 0;
     for (auto& candidate : candidates) {
+      bool isSelectedMl = true;
+      if (applyMl) {
+        hfMlD0Candidate(mlApplicator.getScore(iCand, 0), mlApplicator.getScore(iCand, 1), mlApplicator.getScore(iCand, 2));
+        auto pTBinMl = cutsMlByPt.findBin(candidate.pt());
+        isSelectedMl = pTBinMl != -1 && mlApplicator.getScore(iCand, 0) <= cutsMlByPt.get(pTBinMl, 0);
+      }
+      ++iCand;
 
       // final selection flag: 0 - rejected, 1 - accepted
       int statusD0 = 0;
@@ -262,10 +377,10 @@ struct HfCandidateSelectorD0 {
         continue;
       }
 
-      if ((pidD0 == -1 || pidD0 == 1) && topolD0) {
+      if ((pidD0 == -1 || pidD0 == 1) && topolD0 && isSelectedMl) {
         statusD0 = 1; // identified as D0
       }
-      if ((pidD0bar == -1 || pidD0bar == 1) && topolD0bar) {
+      if ((pidD0bar == -1 || pidD0bar == 1) && topolD0bar && isSelectedMl) {
         statusD0bar = 1; // identified as D0bar
       }
       statusPID = 1;
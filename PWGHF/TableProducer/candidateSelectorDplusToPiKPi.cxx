@@ -43,6 +43,14 @@ struct HfCandidateSelectorDplusToPiKPi {
   // topological cuts
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{hf_cuts_dplus_to_pi_k_pi::vecBinsPt}, "pT bin limits"};
   Configurable<LabeledArray<double>> cuts{"cuts", {hf_cuts_dplus_to_pi_k_pi::cuts[0], nBinsPt, nCutVars, labelsPt, labelsCutVar}, "Dplus candidate selection per pT bin"};
+  // cut variables used in the selections, index in the resolved cuts
+  enum CutVariable { kCutPtPi = 0, kCutPtK, kCutDeltaMass, kCutDecayLength, kCutDecayLengthXYNormalised, kCutCpa, kCutCpaXY, kCutMaxNormalisedDeltaIP };
+  PtBinnedCuts cutsByPt; // cuts resolved at init, to avoid the label lookup per candidate
+
+  void init(InitContext const&)
+  {
+    cutsByPt.init(binsPt.value, cuts.value, {"pT Pi", "pT K", "deltaM", "decay length", "normalized decay length XY", "cos pointing angle", "cos pointing angle XY", "max normalized deltaIP"});
+  }
 
   /*
   /// Selection on goodness of daughter tracks
@@ -69,7 +77,7 @@ struct HfCandidateSelectorDplusToPiKPi {
   bool selection(const T1& candidate, const T2& trackPion1, const T2& trackKaon, const T2& trackPion2)
   {
     auto candpT = candidate.pt();
-    int pTBin = findBin(binsPt, candpT);
+    int pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
@@ -78,26 +86,26 @@ struct HfCandidateSelectorDplusToPiKPi {
       return false;
     }
     // cut on daughter pT
-    if (trackPion1.pt() < cuts->get(pTBin, "pT Pi") || trackKaon.pt() < cuts->get(pTBin, "pT K") || trackPion2.pt() < cuts->get(pTBin, "pT Pi")) {
+    if (trackPion1.pt() < cutsByPt.get(pTBin, kCutPtPi) || trackKaon.pt() < cutsByPt.get(pTBin, kCutPtK) || trackPion2.pt() < cutsByPt.get(pTBin, kCutPtPi)) {
       return false;
     }
     // invariant-mass cut
-    if (std::abs(invMassDplusToPiKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kDPlus)) > cuts->get(pTBin, "deltaM")) {
+    if (std::abs(invMassDplusToPiKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kDPlus)) > cutsByPt.get(pTBin, kCutDeltaMass)) {
       return false;
     }
-    if (candidate.decayLength() < cuts->get(pTBin, "decay length")) {
+    if (candidate.decayLength() < cutsByPt.get(pTBin, kCutDecayLength)) {
       return false;
     }
-    if (candidate.decayLengthXYNormalised() < cuts->get(pTBin, "normalized decay length XY")) {
+    if (candidate.decayLengthXYNormalised() < cutsByPt.get(pTBin, kCutDecayLengthXYNormalised)) {
       return false;
     }
-    if (candidate.cpa() < cuts->get(pTBin, "cos pointing angle")) {
+    if (candidate.cpa() < cutsByPt.get(pTBin, kCutCpa)) {
       return false;
     }
-    if (candidate.cpaXY() < cuts->get(pTBin, "cos pointing angle XY")) {
+    if (candidate.cpaXY() < cutsByPt.get(pTBin, kCutCpaXY)) {
       return false;
     }
-    if (std::abs(candidate.maxNormalisedDeltaIP()) > cuts->get(pTBin, "max normalized deltaIP")) {
+    if (std::abs(candidate.maxNormalisedDeltaIP()) > cutsByPt.get(pTBin, kCutMaxNormalisedDeltaIP)) {
       return false;
     }
     return true;
@@ -42,6 +42,14 @@ struct HfCandidateSelectorDsToKKPi {
   // topological cuts
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{hf_cuts_ds_to_k_k_pi::vecBinsPt}, "pT bin limits"};
   Configurable<LabeledArray<double>> cuts{"cuts", {hf_cuts_ds_to_k_k_pi::cuts[0], nBinsPt, nCutVars, labelsPt, labelsCutVar}, "Ds candidate selection per pT bin"};
+  // cut variables used in the selections, index in the resolved cuts
+  enum CutVariable { kCutPtK = 0, kCutPtPi, kCutMass, kCutDecayLength, kCutDecayLengthXYNormalised, kCutCpa, kCutCpaXY, kCutMaxNormalisedDeltaIP };
+  PtBinnedCuts cutsByPt; // cuts resolved at init, to avoid the label lookup per candidate
+
+  void init(InitContext const&)
+  {
+    cutsByPt.init(binsPt.value, cuts.value, {"pT K", "pT Pi", "m", "decay length", "normalized decay length XY", "cos pointing angle", "cos pointing angle XY", "max normalized deltaIP"});
+  }
 
   /// Candidate selections
   /// \param candidate is candidate
@@ -53,7 +61,7 @@ struct HfCandidateSelectorDsToKKPi {
   bool selection(const T1& candidate, const T2& trackKaon1, const T2& trackKaon2, const T2& trackPion)
   {
     auto candpT = candidate.pt();
-    int pTBin = findBin(binsPt, candpT);
+    int pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
@@ -62,28 +70,28 @@ struct HfCandidateSelectorDsToKKPi {
       return false;
     }
     // cut on daughter pT
-    if (trackKaon1.pt() < cuts->get(pTBin, "pT K") || trackKaon2.pt() < cuts->get(pTBin, "pT K") || trackPion.pt() < cuts->get(pTBin, "pT Pi")) {
+    if (trackKaon1.pt() < cutsByPt.get(pTBin, kCutPtK) || trackKaon2.pt() < cutsByPt.get(pTBin, kCutPtK) || trackPion.pt() < cutsByPt.get(pTBin, kCutPtPi)) {
       return false;
     }
     // invariant-mass cut
-    if (std::abs(invMassDsToKKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kDS)) > cuts->get(pTBin, "m") && (std::abs(invMassDsToPiKK(candidate) - RecoDecay::getMassPDG(pdg::Code::kDS)) > cuts->get(pTBin, "m"))) {
+    if (std::abs(invMassDsToKKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kDS)) > cutsByPt.get(pTBin, kCutMass) && (std::abs(invMassDsToPiKK(candidate) - RecoDecay::getMassPDG(pdg::Code::kDS)) > cutsByPt.get(pTBin, kCutMass))) {
       return false;
     }
     // decay length cut
-    if (candidate.decayLength() < cuts->get(pTBin, "decay length")) {
+    if (candidate.decayLength() < cutsByPt.get(pTBin, kCutDecayLength)) {
       return false;
     }
-    if (candidate.decayLengthXYNormalised() < cuts->get(pTBin, "normalized decay length XY")) {
+    if (candidate.decayLengthXYNormalised() < cutsByPt.get(pTBin, kCutDecayLengthXYNormalised)) {
       return false;
     }
     // cos. pointing angle cut
-    if (candidate.cpa() < cuts->get(pTBin, "cos pointing angle")) {
+    if (candidate.cpa() < cutsByPt.get(pTBin, kCutCpa)) {
       return false;
     }
-    if (candidate.cpaXY() < cuts->get(pTBin, "cos pointing angle XY")) {
+    if (candidate.cpaXY() < cutsByPt.get(pTBin, kCutCpaXY)) {
       return false;
     }
-    if (std::abs(candidate.maxNormalisedDeltaIP()) > cuts->get(pTBin, "max normalized deltaIP")) {
+    if (std::abs(candidate.maxNormalisedDeltaIP()) > cutsByPt.get(pTBin, kCutMaxNormalisedDeltaIP)) {
       return false;
     }
     return true;
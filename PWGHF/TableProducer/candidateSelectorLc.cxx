@@ -51,6 +51,14 @@ struct HfCandidateSelectorLc {
   // topological cuts
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{hf_cuts_lc_to_p_k_pi::vecBinsPt}, "pT bin limits"};
   Configurable<LabeledArray<double>> cuts{"cuts", {hf_cuts_lc_to_p_k_pi::cuts[0], nBinsPt, nCutVars, labelsPt, labelsCutVar}, "Lc candidate selection per pT bin"};
+  // cut variables used in the selections, index in the resolved cuts
+  enum CutVariable { kCutCpa = 0, kCutChi2PCA, kCutDecayLength, kCutPtP, kCutPtK, kCutPtPi, kCutMass };
+  PtBinnedCuts cutsByPt; // cuts resolved at init, to avoid the label lookup per candidate
+
+  void init(InitContext const&)
+  {
+    cutsByPt.init(binsPt.value, cuts.value, {"cos pointing angle", "Chi2PCA", "decay length", "pT p", "pT K", "pT Pi", "m"});
+  }
 
   using TrksPID = soa::Join<aod::BigTracksPID, aod::pidBayesPi, aod::pidBayesKa, aod::pidBayesPr, aod::pidBayes>;
 
@@ -77,7 +85,7 @@ struct HfCandidateSelectorLc {
   {
     auto candpT = candidate.pt();
 
-    int pTBin = findBin(binsPt, candpT);
+    int pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
@@ -88,16 +96,16 @@ struct HfCandidateSelectorLc {
     }
 
     // cosine of pointing angle
-    if (candidate.cpa() <= cuts->get(pTBin, "cos pointing angle")) {
+    if (candidate.cpa() <= cutsByPt.get(pTBin, kCutCpa)) {
       return false;
     }
 
     // candidate chi2PCA
-    if (candidate.chi2PCA() > cuts->get(pTBin, "Chi2PCA")) {
+    if (candidate.chi2PCA() > cutsByPt.get(pTBin, kCutChi2PCA)) {
       return false;
     }
 
-    if (candidate.decayLength() <= cuts->get(pTBin, "decay length")) {
+    if (candidate.decayLength() <= cutsByPt.get(pTBin, kCutDecayLength)) {
       return false;
     }
     return true;
@@ -114,22 +122,22 @@ struct HfCandidateSelectorLc {
   {
 
     auto candpT = candidate.pt();
-    int pTBin = findBin(binsPt, candpT);
+    int pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
 
     // cut on daughter pT
-    if (trackProton.pt() < cuts->get(pTBin, "pT p") || trackKaon.pt() < cuts->get(pTBin, "pT K") || trackPion.pt() < cuts->get(pTBin, "pT Pi")) {
+    if (trackProton.pt() < cutsByPt.get(pTBin, kCutPtP) || trackKaon.pt() < cutsByPt.get(pTBin, kCutPtK) || trackPion.pt() < cutsByPt.get(pTBin, kCutPtPi)) {
       return false;
     }
 
     if (trackProton.globalIndex() == candidate.prong0Id()) {
-      if (std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cutsByPt.get(pTBin, kCutMass)) {
         return false;
       }
     } else {
-      if (std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cutsByPt.get(pTBin, kCutMass)) {
         return false;
       }
     }
@@ -48,6 +48,14 @@ struct HfCandidateSelectorXicToPKPi {
   Configurable<double> decayLengthXYNormalisedMin{"decayLengthXYNormalisedMin", 3., "Min. normalised decay length XY"};
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{hf_cuts_xic_to_p_k_pi::vecBinsPt}, "pT bin limits"};
   Configurable<LabeledArray<double>> cuts{"cuts", {hf_cuts_xic_to_p_k_pi::cuts[0], nBinsPt, nCutVars, labelsPt, labelsCutVar}, "Xic candidate selection per pT bin"};
+  // cut variables used in the selections, index in the resolved cuts
+  enum CutVariable { kCutCpa = 0, kCutChi2PCA, kCutDecayLength, kCutPtP, kCutPtK, kCutPtPi, kCutMass };
+  PtBinnedCuts cutsByPt; // cuts resolved at init, to avoid the label lookup per candidate
+
+  void init(InitContext const&)
+  {
+    cutsByPt.init(binsPt.value, cuts.value, {"cos pointing angle", "chi2PCA", "decay length", "pT p", "pT K", "pT Pi", "m"});
+  }
 
   /*
   /// Selection on goodness of daughter tracks
@@ -71,7 +79,7 @@ struct HfCandidateSelectorXicToPKPi {
   bool selectionTopol(const T& candidate)
   {
     auto candpT = candidate.pt();
-    int pTBin = findBin(binsPt, candpT);
+    int pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
@@ -82,17 +90,17 @@ struct HfCandidateSelectorXicToPKPi {
     }
 
     // cosine of pointing angle
-    if (candidate.cpa() <= cuts->get(pTBin, "cos pointing angle")) {
+    if (candidate.cpa() <= cutsByPt.get(pTBin, kCutCpa)) {
       return false;
     }
 
     // candidate chi2PC
-    if (candidate.chi2PCA() > cuts->get(pTBin, "chi2PCA")) {
+    if (candidate.chi2PCA() > cutsByPt.get(pTBin, kCutChi2PCA)) {
       return false;
     }
 
     // candidate decay length
-    if (candidate.decayLength() <= cuts->get(pTBin, "decay length")) {
+    if (candidate.decayLength() <= cutsByPt.get(pTBin, kCutDecayLength)) {
       return false;
     }
 
@@ -114,22 +122,22 @@ struct HfCandidateSelectorXicToPKPi {
   {
 
     auto candpT = candidate.pt();
-    int pTBin = findBin(binsPt, candpT);
+    int pTBin = cutsByPt.findBin(candpT);
     if (pTBin == -1) {
       return false;
     }
 
     // cut on daughter pT
-    if (trackProton.pt() < cuts->get(pTBin, "pT p") || trackKaon.pt() < cuts->get(pTBin, "pT K") || trackPion.pt() < cuts->get(pTBin, "pT Pi")) {
+    if (trackProton.pt() < cutsByPt.get(pTBin, kCutPtP) || trackKaon.pt() < cutsByPt.get(pTBin, kCutPtK) || trackPion.pt() < cutsByPt.get(pTBin, kCutPtPi)) {
       return false;
     }
 
     if (trackProton.globalIndex() == candidate.prong0Id()) {
-      if (std::abs(invMassXicToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kXiCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassXicToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kXiCPlus)) > cutsByPt.get(pTBin, kCutMass)) {
         return false;
       }
     } else {
-      if (std::abs(invMassXicToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kXiCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassXicToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kXiCPlus)) > cutsByPt.get(pTBin, kCutMass)) {
         return false;
       }
     }
@@ -22,11 +22,13 @@
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/TwoProngPrecheck.h"
 #include "Common/DataModel/EventSelection.h"
 //#include "Common/DataModel/Centrality.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "ReconstructionDataFormats/V0.h"
+#include "ReconstructionDataFormats/DCA.h"
 #include "PWGHF/Utils/utilsDebugLcToK0sP.h"
 #include "DetectorsVertexing/PVertexer.h"      // for PV refit
 #include "ReconstructionDataFormats/Vertex.h"  // for PV refit
@@ -38,6 +40,7 @@
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 
 #include <algorithm>
+#include <thread>
 
 using namespace o2;
 using namespace o2::framework;
@@ -74,8 +77,10 @@ void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
 {
   ConfigParamSpec optionDoMC{"doCascades", VariantType::Bool, false, {"Skim also Λc -> K0S p"}};
   ConfigParamSpec optionEvSel{"doTrigSel", VariantType::Bool, false, {"Apply trigger selection"}};
+  ConfigParamSpec optionWriteSelTrackStore{"writeSelTrackStore", VariantType::Bool, false, {"Produce the HfSelTrackStore table, to read back the track selection in the following productions"}};
   workflowOptions.push_back(optionDoMC);
   workflowOptions.push_back(optionEvSel);
+  workflowOptions.push_back(optionWriteSelTrackStore);
 }
 
 #include "Framework/runDataProcessing.h"
@@ -256,6 +261,7 @@ struct HfTrackIndexSkimCreatorTagSelCollisions {
 struct HfTrackIndexSkimCreatorTagSelTracks {
   Produces<aod::HfSelTrack> rowSelectedTrack;
   Produces<aod::HfPvRefitTrack> tabPvRefitTrack;
+  Produces<aod::HfSelTrackCfg> rowSelectedTrackCfg;
 
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<bool> doPvRefit{"doPvRefit", false, "do PV refit excluding the considered track"};
@@ -304,6 +310,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   static const int nCuts = 4;
   // array of 2-prong and 3-prong cuts
   std::array<LabeledArray<double>, 3> cutsSingleTrack;
+  // hash of the configuration of the track selection, to check a stored selection before reading it back
+  uint32_t configHash{0};
 
   // QA of PV refit
   ConfigurableAxis axisPvRefitDeltaX{"axisPvRefitDeltaX", {1000, -0.5f, 0.5f}, "DeltaX binning PV refit"};
@@ -331,6 +339,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     registry.add("hEtaCutsV0bachelor", "tracks selected for 3-prong vertexing;#it{#eta};entries", {HistType::kTH1F, {{static_cast<int>(1.2 * etaMaxTrackBach * 100), -1.2 * etaMaxTrackBach, 1.2 * etaMaxTrackBach}}});
 
     cutsSingleTrack = {cutsTrack2Prong, cutsTrack3Prong, cutsTrackBach};
+    configHash = computeConfigHash();
+    LOGF(info, "Track-selection configuration hash: %u", configHash);
     std::string cutNames[nCuts + 1] = {"selected", "rej pT", "rej eta", "rej track quality", "rej dca"};
     std::string candNames[CandidateType::NCandidateTypes] = {"2-prong", "3-prong", "bachelor"};
     for (int iCandType = 0; iCandType < CandidateType::NCandidateTypes; iCandType++) {
@@ -377,6 +387,36 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     }
   }
 
+  /// Hash (FNV-1a) of the configurables defining the track selection bits and the PV refit
+  uint32_t computeConfigHash() const
+  {
+    uint32_t hash{2166136261u};
+    auto addBytes = [&hash](const void* data, std::size_t size) {
+      const auto* bytes = static_cast<const unsigned char*>(data);
+      for (std::size_t iByte = 0; iByte < size; ++iByte) {
+        hash ^= bytes[iByte];
+        hash *= 16777619u;
+      }
+    };
+    std::vector<double> values{static_cast<double>(isRun2), static_cast<double>(doPvRefit), static_cast<double>(doCutQuality), static_cast<double>(useIsGlobalTrack), static_cast<double>(useIsGlobalTrackWoDCA), static_cast<double>(tpcNClsFoundMin),
+                               ptMinTrack2Prong, etaMaxTrack2Prong, ptMinTrack3Prong, etaMaxTrack3Prong, ptMinTrackBach, etaMaxTrackBach};
+    values.insert(values.end(), binsPtTrack->begin(), binsPtTrack->end());
+    for (const auto& cuts : cutsSingleTrack) {
+      for (std::size_t iRow = 0; iRow < cuts.rows(); ++iRow) {
+        for (std::size_t iCol = 0; iCol < cuts.cols(); ++iCol) {
+          values.push_back(cuts.get(iRow, iCol));
+        }
+      }
+    }
+    addBytes(values.data(), values.size() * sizeof(double));
+    if (doPvRefit) {
+      for (const std::string& path : {ccdbPathLut.value, ccdbPathGeo.value, ccdbPathGrp.value, ccdbPathGrpMag.value}) {
+        addBytes(path.data(), path.size());
+      }
+    }
+    return hash;
+  }
+
   /// Single-track cuts for 2-prongs or 3-prongs
   /// \param hfTrack is a track
   /// \param dca is a 2-element array with dca in transverse and longitudinal directions
@@ -576,15 +616,16 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   /// Partition for PV contributors
   Partition<MY_TYPE1> pvContributors = ((aod::track::flags & (uint32_t)aod::track::PVContributor) == (uint32_t)aod::track::PVContributor);
 
-  void process(aod::Collisions const& collisions,
-               MY_TYPE1 const& tracks,
-               aod::BCsWithTimestamps const& bcWithTimeStamps // for PV refit
+  void processCompute(aod::Collisions const& collisions,
+                      MY_TYPE1 const& tracks,
+                      aod::BCsWithTimestamps const& bcWithTimeStamps // for PV refit
 #ifdef MY_DEBUG
-               ,
-               aod::McParticles& mcParticles
+                      ,
+                      aod::McParticles& mcParticles
 #endif
   )
   {
+    rowSelectedTrackCfg(configHash);
 
     if (doPvRefit) {
       LOG(info) << ">>> number of tracks: " << tracks.size();
@@ -829,6 +870,48 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       rowSelectedTrack(statusProng, track.px(), track.py(), track.pz());
     }
   }
+  PROCESS_SWITCH(HfTrackIndexSkimCreatorTagSelTracks, processCompute, "Select the tracks and refit the PV", true);
+
+  /// Reads back the track selection and the PV refit stored by a previous production on the same input
+  void processFromStore(aod::Tracks const& tracks, aod::HfSelTrackStore const& selTracksStored)
+  {
+    rowSelectedTrackCfg(configHash);
+
+    if (selTracksStored.size() != tracks.size()) {
+      LOGF(fatal, "Stored track selection has %d rows for %d tracks", selTracksStored.size(), tracks.size());
+    }
+    if (selTracksStored.size() > 0 && selTracksStored.begin().configHash() != configHash) {
+      LOGF(fatal, "Stored track selection was produced with configuration hash %u, the current one is %u", selTracksStored.begin().configHash(), configHash);
+    }
+
+    for (const auto& selTrack : selTracksStored) {
+      rowSelectedTrack(selTrack.isSelProng(), selTrack.pxProng(), selTrack.pyProng(), selTrack.pzProng());
+      tabPvRefitTrack(selTrack.pvRefitX(), selTrack.pvRefitY(), selTrack.pvRefitZ(),
+                      selTrack.pvRefitSigmaX2(), selTrack.pvRefitSigmaXY(), selTrack.pvRefitSigmaY2(), selTrack.pvRefitSigmaXZ(), selTrack.pvRefitSigmaYZ(), selTrack.pvRefitSigmaZ2(),
+                      selTrack.pvRefitDcaXY(), selTrack.pvRefitDcaZ());
+    }
+  }
+  PROCESS_SWITCH(HfTrackIndexSkimCreatorTagSelTracks, processFromStore, "Read the track selection and the PV refit from a stored HfSelTrackStore table", false);
+};
+
+/// Copy of the track selection and of the PV refit into a single table, together with the hash of the configuration,
+/// to be saved in the derived data and read back by processFromStore of the track selection in the following productions
+struct HfTrackIndexSkimCreatorSelTrackStore {
+  Produces<aod::HfSelTrackStore> rowSelectedTrackStore;
+
+  void process(aod::HfSelTrackCfg const& selTrackCfgs, soa::Join<aod::HfSelTrack, aod::HfPvRefitTrack> const& selTracks)
+  {
+    if (selTrackCfgs.size() == 0) {
+      return;
+    }
+    const auto hash = selTrackCfgs.begin().configHash();
+    for (const auto& selTrack : selTracks) {
+      rowSelectedTrackStore(hash, selTrack.isSelProng(), selTrack.pxProng(), selTrack.pyProng(), selTrack.pzProng(),
+                            selTrack.pvRefitX(), selTrack.pvRefitY(), selTrack.pvRefitZ(),
+                            selTrack.pvRefitSigmaX2(), selTrack.pvRefitSigmaXY(), selTrack.pvRefitSigmaY2(), selTrack.pvRefitSigmaXZ(), selTrack.pvRefitSigmaYZ(), selTrack.pvRefitSigmaZ2(),
+                            selTrack.pvRefitDcaXY(), selTrack.pvRefitDcaZ());
+    }
+  }
 };
 
 //____________________________________________________________________________________________________________________________________________
@@ -841,6 +924,8 @@ struct HfTrackIndexSkimCreator {
   Produces<aod::Hf3Prongs> rowTrackIndexProng3;
   Produces<aod::HfCutStatus3Prong> rowProng3CutStatus;
   Produces<aod::HfPvRefit3Prong> rowProng3PVrefit;
+  Produces<aod::HfVertexFit2Prong> rowProng2VertexFit;
+  Produces<aod::HfVertexFit3Prong> rowProng3VertexFit;
 
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<int> do3Prong{"do3Prong", 0, "do 3 prong"};
@@ -858,6 +943,12 @@ struct HfTrackIndexSkimCreator {
   Configurable<double> maxDZIni{"maxDZIni", 4., "reject (if>0) PCA candidate if tracks DZ exceeds threshold"};
   Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
   Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations if chi2/chi2old > this"};
+  Configurable<bool> usePrecheck2Prong{"usePrecheck2Prong", true, "reject the 2-prong pairs whose helices cannot make a vertex (same DXY and DZ as the fitter) before the fit"};
+  Configurable<bool> fillVertexFit{"fillVertexFit", false, "store the secondary-vertex fit of the candidates for the candidate creators (processSkimVertex, same vertexing and doPvRefit settings needed)"};
+  // combinatorics
+  Configurable<float> maxDeltaEtaProngs{"maxDeltaEtaProngs", -1.f, "max. |delta eta| between a prong and the prong of the enclosing loop (tracks sorted in eta if > 0, < 0: disabled)"};
+  Configurable<float> maxDeltaPhiProngs{"maxDeltaPhiProngs", -1.f, "max. |delta phi| between a prong and the prong of the enclosing loop (< 0: disabled)"};
+  Configurable<int> nThreadsCombinatorics{"nThreadsCombinatorics", 1, "number of threads sharing the loop over positive tracks (> 1 not supported with PV refit)"};
   // CCDB
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> ccdbPathLut{"ccdbPathLut", "GLO/Param/MatLUT", "Path for LUT parametrization"};
@@ -913,9 +1004,42 @@ struct HfTrackIndexSkimCreator {
   Filter filterSelectCollisions = (aod::hf_sel_collision::whyRejectColl == 0);
   Filter filterSelectTracks = aod::hf_sel_track::isSelProng > 0;
 
-  // FIXME
-  // Partition<SelectedTracks> tracksPos = aod::track::signed1Pt > 0.f;
-  // Partition<SelectedTracks> tracksNeg = aod::track::signed1Pt < 0.f;
+  /// selected track with the information needed in the pairing loops, computed only once per collision
+  struct ProngCandidate {
+    SelectedTracks::iterator track;
+    o2::track::TrackParCov trackParCov;
+    float eta;
+    float phi;
+    bool isSel2Prong;
+    bool isSel3Prong;
+  };
+  std::vector<ProngCandidate> tracksPos; // positive tracks selected for 2- or 3-prong combinatorics, reused across collisions
+  std::vector<ProngCandidate> tracksNeg; // negative tracks selected for 2- or 3-prong combinatorics, reused across collisions
+
+  /// candidate found in the combinatorics, buffered before being written to the output tables
+  template <int nProngs, int nDecays>
+  struct CandidateRow {
+    std::array<int64_t, nProngs> indices;
+    int isSelected;
+    array<float, 3> pvRefitCoord;
+    array<float, 6> pvRefitCovMatrix;
+    std::array<int, nDecays> cutStatus;
+    array<float, 3> secondaryVertex;
+    array<array<float, 3>, nProngs> momenta;
+    std::array<int, nDecays> whichHypo;
+    // secondary-vertex fit, filled only if fillVertexFit
+    float chi2PCA;
+    array<float, 6> covMatrixPCA;
+    array<float, nProngs> impactParameterY;
+    array<float, nProngs> impactParameterZ;
+    array<float, nProngs> impactParameterSigmaY2;
+  };
+  /// candidates found by one worker of the combinatorics
+  struct CandidateBuffer {
+    std::vector<CandidateRow<2, n2ProngDecays>> prongs2;
+    std::vector<CandidateRow<3, n3ProngDecays>> prongs3;
+  };
+  std::vector<CandidateBuffer> candidateBuffers; // one buffer per worker, reused across collisions
 
   // QA of PV refit
   ConfigurableAxis axisPvRefitDeltaX{"axisPvRefitDeltaX", {1000, -0.5f, 0.5f}, "DeltaX binning PV refit"};
@@ -975,6 +1099,10 @@ struct HfTrackIndexSkimCreator {
     cut3Prong = {cutsDplusToPiKPi, cutsLcToPKPi, cutsDsToKKPi, cutsXicToPKPi};
     pTBins3Prong = {binsPtDplusToPiKPi, binsPtLcToPKPi, binsPtDsToKKPi, binsPtXicToPKPi};
 
+    if (nThreadsCombinatorics > 1 && doPvRefit) {
+      LOGF(fatal, "PV refit not supported in multi-threaded combinatorics, set nThreadsCombinatorics to 1");
+    }
+
     // needed for PV refitting
     if (doPvRefit) {
       AxisSpec axisCollisionX{100, -20.f, 20.f, "X (cm)"};
@@ -1433,6 +1561,257 @@ struct HfTrackIndexSkimCreator {
     return;
   } /// end of performPvRefitCandProngs function
 
+  /// Configures a secondary-vertex fitter with the vertexing configurables
+  /// \param fitter DCAFitterN instance to configure
+  template <typename T>
+  void configureFitter(T& fitter)
+  {
+    fitter.setBz(o2::base::Propagator::Instance()->getNominalBz());
+    fitter.setPropagateToPCA(propagateToPCA);
+    fitter.setMaxR(maxR);
+    fitter.setMaxDZIni(maxDZIni);
+    fitter.setMinParamChange(minParamChange);
+    fitter.setMinRelChi2Change(minRelChi2Change);
+    fitter.setUseAbsDCA(useAbsDCA);
+  }
+
+  /// Converts the status of each selection into one bit map per decay channel (only filled in debug mode)
+  /// \param cutStatus status of each selection for each decay channel
+  /// \return bit maps where each selection is one bit, set to 1 if passed
+  template <std::size_t nDecays, std::size_t nCuts>
+  std::array<int, nDecays> getCutStatusBits(const bool (&cutStatus)[nDecays][nCuts])
+  {
+    std::array<int, nDecays> cutStatusBits{};
+    if (!debug) {
+      return cutStatusBits;
+    }
+    for (auto iDecay = 0u; iDecay < nDecays; iDecay++) {
+      cutStatusBits[iDecay] = BIT(nCuts) - 1;
+      for (auto iCut = 0u; iCut < nCuts; iCut++) {
+        if (!cutStatus[iDecay][iCut]) {
+          CLRBIT(cutStatusBits[iDecay], iCut);
+        }
+      }
+    }
+    return cutStatusBits;
+  }
+
+  /// Stores the secondary-vertex fit of a candidate, as used in the candidate creators
+  /// \param fitter DCA fitter holding the fit of the candidate
+  /// \param collision collision of the candidate
+  /// \param row buffered candidate, with the primary vertex (refitted or not) used in the selections
+  template <typename TFitter, typename TCollision, typename TRow>
+  void storeVertexFit(TFitter& fitter, TCollision const& collision, TRow& row)
+  {
+    row.chi2PCA = fitter.getChi2AtPCACandidate();
+    row.covMatrixPCA = fitter.calcPCACovMatrixFlat();
+    auto primaryVertex = getPrimaryVertex(collision);
+    primaryVertex.setX(row.pvRefitCoord[0]);
+    primaryVertex.setY(row.pvRefitCoord[1]);
+    primaryVertex.setZ(row.pvRefitCoord[2]);
+    primaryVertex.setSigmaX2(row.pvRefitCovMatrix[0]);
+    primaryVertex.setSigmaXY(row.pvRefitCovMatrix[1]);
+    primaryVertex.setSigmaY2(row.pvRefitCovMatrix[2]);
+    primaryVertex.setSigmaXZ(row.pvRefitCovMatrix[3]);
+    primaryVertex.setSigmaYZ(row.pvRefitCovMatrix[4]);
+    primaryVertex.setSigmaZ2(row.pvRefitCovMatrix[5]);
+    o2::dataformats::DCA impactParameter;
+    for (std::size_t iProng = 0; iProng < row.indices.size(); ++iProng) {
+      auto trackParVar = fitter.getTrack(iProng);
+      trackParVar.propagateToDCA(primaryVertex, fitter.getBz(), &impactParameter);
+      row.impactParameterY[iProng] = impactParameter.getY();
+      row.impactParameterZ[iProng] = impactParameter.getZ();
+      row.impactParameterSigmaY2[iProng] = impactParameter.getSigmaY2();
+    }
+  }
+
+  /// Writes the buffered candidates to the output tables and fills the corresponding histograms
+  /// \param buffer candidates found by one worker of the combinatorics
+  void writeCandidates(CandidateBuffer const& buffer)
+  {
+    for (const auto& row : buffer.prongs2) {
+      // fill table row
+      rowTrackIndexProng2(row.indices[0], row.indices[1], row.isSelected);
+      // fill table row with coordinates of PV refit
+      rowProng2PVrefit(row.pvRefitCoord[0], row.pvRefitCoord[1], row.pvRefitCoord[2],
+                       row.pvRefitCovMatrix[0], row.pvRefitCovMatrix[1], row.pvRefitCovMatrix[2], row.pvRefitCovMatrix[3], row.pvRefitCovMatrix[4], row.pvRefitCovMatrix[5]);
+      if (debug) {
+        rowProng2CutStatus(row.cutStatus[0], row.cutStatus[1], row.cutStatus[2]); // FIXME when we can do this by looping over n2ProngDecays
+      }
+      if (fillVertexFit) {
+        rowProng2VertexFit(row.secondaryVertex[0], row.secondaryVertex[1], row.secondaryVertex[2], row.chi2PCA,
+                           row.covMatrixPCA[0], row.covMatrixPCA[1], row.covMatrixPCA[2], row.covMatrixPCA[3], row.covMatrixPCA[4], row.covMatrixPCA[5],
+                           row.momenta[0][0], row.momenta[0][1], row.momenta[0][2],
+                           row.momenta[1][0], row.momenta[1][1], row.momenta[1][2],
+                           row.impactParameterY[0], row.impactParameterZ[0], row.impactParameterSigmaY2[0],
+                           row.impactParameterY[1], row.impactParameterZ[1], row.impactParameterSigmaY2[1]);
+      }
+
+      // fill histograms
+      if (fillHistograms) {
+        registry.fill(HIST("hVtx2ProngX"), row.secondaryVertex[0]);
+        registry.fill(HIST("hVtx2ProngY"), row.secondaryVertex[1]);
+        registry.fill(HIST("hVtx2ProngZ"), row.secondaryVertex[2]);
+        const auto& arrMom = row.momenta;
+        for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
+          if (TESTBIT(row.isSelected, iDecay2P)) {
+            if (row.whichHypo[iDecay2P] == 1 || row.whichHypo[iDecay2P] == 3) {
+              auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
+              switch (iDecay2P) {
+                case hf_cand_2prong::DecayType::D0ToPiK:
+                  registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+                  break;
+                case hf_cand_2prong::DecayType::JpsiToEE:
+                  registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
+                  break;
+                case hf_cand_2prong::DecayType::JpsiToMuMu:
+                  registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
+                  break;
+              }
+            }
+            if (row.whichHypo[iDecay2P] >= 2) {
+              auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
+              if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
+                registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    for (const auto& row : buffer.prongs3) {
+      // fill table row
+      rowTrackIndexProng3(row.indices[0], row.indices[1], row.indices[2], row.isSelected);
+      // fill table row of coordinates of PV refit
+      rowProng3PVrefit(row.pvRefitCoord[0], row.pvRefitCoord[1], row.pvRefitCoord[2],
+                       row.pvRefitCovMatrix[0], row.pvRefitCovMatrix[1], row.pvRefitCovMatrix[2], row.pvRefitCovMatrix[3], row.pvRefitCovMatrix[4], row.pvRefitCovMatrix[5]);
+      if (debug) {
+        rowProng3CutStatus(row.cutStatus[0], row.cutStatus[1], row.cutStatus[2], row.cutStatus[3]); // FIXME when we can do this by looping over n3ProngDecays
+      }
+      if (fillVertexFit) {
+        rowProng3VertexFit(row.secondaryVertex[0], row.secondaryVertex[1], row.secondaryVertex[2], row.chi2PCA,
+                           row.covMatrixPCA[0], row.covMatrixPCA[1], row.covMatrixPCA[2], row.covMatrixPCA[3], row.covMatrixPCA[4], row.covMatrixPCA[5],
+                           row.momenta[0][0], row.momenta[0][1], row.momenta[0][2],
+                           row.momenta[1][0], row.momenta[1][1], row.momenta[1][2],
+                           row.momenta[2][0], row.momenta[2][1], row.momenta[2][2],
+                           row.impactParameterY[0], row.impactParameterZ[0], row.impactParameterSigmaY2[0],
+                           row.impactParameterY[1], row.impactParameterZ[1], row.impactParameterSigmaY2[1],
+                           row.impactParameterY[2], row.impactParameterZ[2], row.impactParameterSigmaY2[2]);
+      }
+
+      // fill histograms
+      if (fillHistograms) {
+        registry.fill(HIST("hVtx3ProngX"), row.secondaryVertex[0]);
+        registry.fill(HIST("hVtx3ProngY"), row.secondaryVertex[1]);
+        registry.fill(HIST("hVtx3ProngZ"), row.secondaryVertex[2]);
+        const auto& arr3Mom = row.momenta;
+        for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
+          if (TESTBIT(row.isSelected, iDecay3P)) {
+            if (row.whichHypo[iDecay3P] == 1 || row.whichHypo[iDecay3P] == 3) {
+              auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
+              switch (iDecay3P) {
+                case hf_cand_3prong::DecayType::DplusToPiKPi:
+                  registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::DsToKKPi:
+                  registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::LcToPKPi:
+                  registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::XicToPKPi:
+                  registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                  break;
+              }
+            }
+            if (row.whichHypo[iDecay3P] >= 2) {
+              auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
+              switch (iDecay3P) {
+                case hf_cand_3prong::DecayType::DsToKKPi:
+                  registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::LcToPKPi:
+                  registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::XicToPKPi:
+                  registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                  break;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /// Splits the selected tracks of the collision in positive and negative buckets,
+  /// keeping only the tracks flagged for the 2- or 3-prong combinatorics
+  /// \param tracks tracks of the collision passing the single-track selections
+  /// \note if maxDeltaEtaProngs > 0, the buckets are sorted in eta to allow early exits in the pairing loops
+  void fillProngBuckets(SelectedTracks const& tracks)
+  {
+    tracksPos.clear();
+    tracksNeg.clear();
+    for (const auto& track : tracks) {
+      bool isSel2Prong = TESTBIT(track.isSelProng(), CandidateType::Cand2Prong);
+      bool isSel3Prong = TESTBIT(track.isSelProng(), CandidateType::Cand3Prong);
+      if (!isSel2Prong && !isSel3Prong) {
+        continue;
+      }
+      auto& bucket = track.signed1Pt() < 0 ? tracksNeg : tracksPos;
+      bucket.push_back({track, getTrackParCov(track), track.eta(), track.phi(), isSel2Prong, isSel3Prong});
+    }
+    if (maxDeltaEtaProngs > 0.f) {
+      auto compareEta = [](const ProngCandidate& a, const ProngCandidate& b) { return a.eta < b.eta; };
+      std::sort(tracksPos.begin(), tracksPos.end(), compareEta);
+      std::sort(tracksNeg.begin(), tracksNeg.end(), compareEta);
+    }
+  }
+
+  /// Finds the first track of a bucket, starting from a given position, inside the eta window around a reference prong
+  /// \param bucket eta-sorted bucket of tracks (if the eta window is enabled)
+  /// \param start first position to consider
+  /// \param etaRef pseudorapidity of the reference prong
+  /// \return position of the first track to consider in the pairing loop
+  std::size_t firstInEtaWindow(std::vector<ProngCandidate> const& bucket, std::size_t start, float etaRef)
+  {
+    if (maxDeltaEtaProngs <= 0.f || start >= bucket.size()) {
+      return start;
+    }
+    auto it = std::lower_bound(bucket.begin() + start, bucket.end(), etaRef - maxDeltaEtaProngs, [](const ProngCandidate& a, float eta) { return a.eta < eta; });
+    return std::distance(bucket.begin(), it);
+  }
+
+  /// \return true if the prong is above the eta window around the reference prong (all the following tracks of the sorted bucket are too)
+  bool isOutsideEtaWindow(float eta, float etaRef)
+  {
+    return maxDeltaEtaProngs > 0.f && eta > etaRef + maxDeltaEtaProngs;
+  }
+
+  /// \return true if the prong is outside the phi window around the reference prong
+  bool isOutsidePhiWindow(float phi, float phiRef)
+  {
+    return maxDeltaPhiProngs >= 0.f && std::abs(RecoDecay::constrainAngle(phi - phiRef, -o2::constants::math::PI)) > maxDeltaPhiProngs;
+  }
+
+  /// Fills the histograms with the number of tracks and candidates of the collision
+  /// \param nTracks number of tracks passing 2 and 3 prong selection in this collision
+  /// \param nCand2Start number of 2-prong rows before processing this collision
+  /// \param nCand3Start number of 3-prong rows before processing this collision
+  template <typename T>
+  void fillCandidateCounters(int nTracks, T nCand2Start, T nCand3Start)
+  {
+    auto nCand2 = rowTrackIndexProng2.lastIndex() - nCand2Start; // number of 2-prong candidates in this collision
+    auto nCand3 = rowTrackIndexProng3.lastIndex() - nCand3Start; // number of 3-prong candidates in this collision
+
+    registry.fill(HIST("hNTracks"), nTracks);
+    registry.fill(HIST("hNCand2Prong"), nCand2);
+    registry.fill(HIST("hNCand3Prong"), nCand3);
+    registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
+    registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+  }
+
   void process( // soa::Join<aod::Collisions, aod::CentV0Ms>::iterator const& collision, //FIXME add centrality when option for variations to the process function appears
     SelectedCollisions::iterator const& collision,
     aod::Collisions const&,
@@ -1488,650 +1867,500 @@ struct HfTrackIndexSkimCreator {
     int n2ProngBit = BIT(n2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
     int n3ProngBit = BIT(n3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
 
-    bool cutStatus2Prong[n2ProngDecays][nCuts2Prong];
-    bool cutStatus3Prong[n3ProngDecays][nCuts3Prong];
-    int nCutStatus2ProngBit = BIT(nCuts2Prong) - 1; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
-    int nCutStatus3ProngBit = BIT(nCuts3Prong) - 1; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
-
-    int whichHypo2Prong[n2ProngDecays];
-    int whichHypo3Prong[n3ProngDecays];
-
     // set the magnetic field from CCDB
     auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
     initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
 
     // 2-prong vertex fitter
     o2::vertexing::DCAFitterN<2> df2;
-    df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
-    df2.setPropagateToPCA(propagateToPCA);
-    df2.setMaxR(maxR);
-    df2.setMaxDZIni(maxDZIni);
-    df2.setMinParamChange(minParamChange);
-    df2.setMinRelChi2Change(minRelChi2Change);
-    df2.setUseAbsDCA(useAbsDCA);
+    configureFitter(df2);
+    o2::analysis::TwoProngPrecheck precheck2Prong;
+    precheck2Prong.setEnabled(usePrecheck2Prong);
+    precheck2Prong.setBz(df2.getBz());
+    precheck2Prong.setMaxDZ(maxDZIni);
 
     // 3-prong vertex fitter
     o2::vertexing::DCAFitterN<3> df3;
-    df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
-    df3.setPropagateToPCA(propagateToPCA);
-    df3.setMaxR(maxR);
-    df3.setMaxDZIni(maxDZIni);
-    df3.setMinParamChange(minParamChange);
-    df3.setMinRelChi2Change(minRelChi2Change);
-    df3.setUseAbsDCA(useAbsDCA);
+    configureFitter(df3);
 
     // used to calculate number of candidiates per event
     auto nCand2 = rowTrackIndexProng2.lastIndex();
     auto nCand3 = rowTrackIndexProng3.lastIndex();
 
-    // if there isn't at least a positive and a negative track, continue immediately
-    // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
-    //  return;
-    //}
-
-    // first loop over positive tracks
-    // for (auto trackPos1 = tracksPos.begin(); trackPos1 != tracksPos.end(); ++trackPos1) {
-    for (auto trackPos1 = tracks.begin(); trackPos1 != tracks.end(); ++trackPos1) {
-      if (trackPos1.signed1Pt() < 0) {
-        continue;
-      }
-      bool sel2ProngStatusPos = TESTBIT(trackPos1.isSelProng(), CandidateType::Cand2Prong);
-      bool sel3ProngStatusPos1 = TESTBIT(trackPos1.isSelProng(), CandidateType::Cand3Prong);
-      if (!sel2ProngStatusPos && !sel3ProngStatusPos1) {
-        continue;
-      }
+    // split the selected tracks by charge and cache their parametrisation once per collision
+    fillProngBuckets(tracks);
 
-      auto trackParVarPos1 = getTrackParCov(trackPos1);
-
-      // first loop over negative tracks
-      // for (auto trackNeg1 = tracksNeg.begin(); trackNeg1 != tracksNeg.end(); ++trackNeg1) {
-      for (auto trackNeg1 = tracks.begin(); trackNeg1 != tracks.end(); ++trackNeg1) {
-        if (trackNeg1.signed1Pt() > 0) {
-          continue;
-        }
-        bool sel2ProngStatusNeg = TESTBIT(trackNeg1.isSelProng(), CandidateType::Cand2Prong);
-        bool sel3ProngStatusNeg1 = TESTBIT(trackNeg1.isSelProng(), CandidateType::Cand3Prong);
-        if (!sel2ProngStatusNeg && !sel3ProngStatusNeg1) {
-          continue;
-        }
+    // if there isn't at least a positive and a negative track, continue immediately
+    if (tracksPos.empty() || tracksNeg.empty()) {
+      fillCandidateCounters(tracks.size(), nCand2, nCand3);
+      return;
+    }
 
-        auto trackParVarNeg1 = getTrackParCov(trackNeg1);
+    // combinatorics for the positive tracks in [iPosBegin, iPosEnd), with the given fitters and output buffer
+    auto combineProngs = [&](std::size_t iPosBegin, std::size_t iPosEnd, std::vector<ProngCandidate> const& prongsPos, std::vector<ProngCandidate> const& prongsNeg,
+                             o2::vertexing::DCAFitterN<2>& df2, o2::vertexing::DCAFitterN<3>& df3, CandidateBuffer& out) {
+      bool cutStatus2Prong[n2ProngDecays][nCuts2Prong];
+      bool cutStatus3Prong[n3ProngDecays][nCuts3Prong];
+      std::array<int, n2ProngDecays> whichHypo2Prong;
+      std::array<int, n3ProngDecays> whichHypo3Prong;
+
+      // first loop over positive tracks
+      for (auto iPos1 = iPosBegin; iPos1 < iPosEnd; ++iPos1) {
+        const auto& trackPos1 = prongsPos[iPos1].track;
+        const auto& trackParVarPos1 = prongsPos[iPos1].trackParCov;
+        bool sel2ProngStatusPos = prongsPos[iPos1].isSel2Prong;
+        bool sel3ProngStatusPos1 = prongsPos[iPos1].isSel3Prong;
+
+        // first loop over negative tracks
+        for (auto iNeg1 = firstInEtaWindow(prongsNeg, 0u, prongsPos[iPos1].eta); iNeg1 < prongsNeg.size(); ++iNeg1) {
+          if (isOutsideEtaWindow(prongsNeg[iNeg1].eta, prongsPos[iPos1].eta)) {
+            break;
+          }
+          if (isOutsidePhiWindow(prongsNeg[iNeg1].phi, prongsPos[iPos1].phi)) {
+            continue;
+          }
+          const auto& trackNeg1 = prongsNeg[iNeg1].track;
+          const auto& trackParVarNeg1 = prongsNeg[iNeg1].trackParCov;
+          bool sel2ProngStatusNeg = prongsNeg[iNeg1].isSel2Prong;
+          bool sel3ProngStatusNeg1 = prongsNeg[iNeg1].isSel3Prong;
 
-        int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
+          int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
 
-        if (debug) {
-          for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
-            for (int iCut = 0; iCut < nCuts2Prong; iCut++) {
-              cutStatus2Prong[iDecay2P][iCut] = true;
+          if (debug) {
+            for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
+              for (int iCut = 0; iCut < nCuts2Prong; iCut++) {
+                cutStatus2Prong[iDecay2P][iCut] = true;
+              }
             }
           }
-        }
 
-        // 2-prong vertex reconstruction
-        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
-
-          // 2-prong preselections
-          // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
-          is2ProngPreselected(trackPos1, trackNeg1, cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand);
-
-          // secondary vertex reconstruction and further 2-prong selections
-          if (isSelected2ProngCand > 0 && df2.process(trackParVarPos1, trackParVarNeg1) > 0) { // should it be this or > 0 or are they equivalent
-            // get secondary vertex
-            const auto& secondaryVertex2 = df2.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            df2.getTrack(0).getPxPyPzGlo(pvec0);
-            df2.getTrack(1).getPxPyPzGlo(pvec1);
-
-            /// PV refit excluding the candidate daughters, if contributors
-            array<float, 3> pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-            array<float, 6> pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-            if (doPvRefit) {
-              registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-              int nCandContr = 2;
-              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-              bool isTrackFirstContr = true;
-              bool isTrackSecondContr = true;
-              if (trackFirstIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackFirstContr = false;
-              }
-              if (trackSecondIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackSecondContr = false;
-              }
-              if (nCandContr == 2) {
-                /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                if (debug) {
-                  LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
-                }
-                performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
-              } else if (nCandContr == 1) {
-                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                if (debug) {
-                  LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+          // 2-prong vertex reconstruction
+          if (sel2ProngStatusPos && sel2ProngStatusNeg) {
+
+            // 2-prong preselections
+            // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
+            is2ProngPreselected(trackPos1, trackNeg1, cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand);
+
+            // secondary vertex reconstruction and further 2-prong selections
+            if (isSelected2ProngCand > 0 && precheck2Prong.process(df2, trackParVarPos1, trackParVarNeg1) > 0) { // should it be this or > 0 or are they equivalent
+              // get secondary vertex
+              const auto& secondaryVertex2 = df2.getPCACandidate();
+              // get track momenta
+              array<float, 3> pvec0;
+              array<float, 3> pvec1;
+              df2.getTrack(0).getPxPyPzGlo(pvec0);
+              df2.getTrack(1).getPxPyPzGlo(pvec1);
+
+              /// PV refit excluding the candidate daughters, if contributors
+              array<float, 3> pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+              array<float, 6> pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+              if (doPvRefit) {
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+                int nCandContr = 2;
+                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
+                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
+                bool isTrackFirstContr = true;
+                bool isTrackSecondContr = true;
+                if (trackFirstIt == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackFirstContr = false;
                 }
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                if (isTrackFirstContr && !isTrackSecondContr) {
-                  /// the first daughter is contributor, the second is not
-                  pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                  pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && isTrackSecondContr) {
-                  ///  the second daughter is contributor, the first is not
-                  pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                  pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                if (trackSecondIt == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackSecondContr = false;
                 }
-              } else {
-                /// 0 contributors among the HF candidate daughters
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                if (debug) {
-                  LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                if (nCandContr == 2) {
+                  /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                  if (debug) {
+                    LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
+                  }
+                  performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
+                } else if (nCandContr == 1) {
+                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                  if (debug) {
+                    LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+                  }
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
+                  if (isTrackFirstContr && !isTrackSecondContr) {
+                    /// the first daughter is contributor, the second is not
+                    pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                    pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                  } else if (!isTrackFirstContr && isTrackSecondContr) {
+                    ///  the second daughter is contributor, the first is not
+                    pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                    pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                  }
+                } else {
+                  /// 0 contributors among the HF candidate daughters
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+                  if (debug) {
+                    LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                  }
                 }
               }
-            }
-
-            auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
-            // 2-prong selections after secondary vertex
-            array<float, 3> pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
-            if (doPvRefit) {
-              pvCoord2Prong[0] = pvRefitCoord2Prong[0];
-              pvCoord2Prong[1] = pvRefitCoord2Prong[1];
-              pvCoord2Prong[2] = pvRefitCoord2Prong[2];
-            }
-            is2ProngSelected(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
-
-            if (isSelected2ProngCand > 0) {
-              // fill table row
-              rowTrackIndexProng2(trackPos1.globalIndex(),
-                                  trackNeg1.globalIndex(), isSelected2ProngCand);
-              // fill table row with coordinates of PV refit
-              rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                               pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
 
-              if (debug) {
-                int Prong2CutStatus[n2ProngDecays];
-                for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
-                  Prong2CutStatus[iDecay2P] = nCutStatus2ProngBit;
-                  for (int iCut = 0; iCut < nCuts2Prong; iCut++) {
-                    if (!cutStatus2Prong[iDecay2P][iCut]) {
-                      CLRBIT(Prong2CutStatus[iDecay2P], iCut);
-                    }
-                  }
-                }
-                rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1], Prong2CutStatus[2]); // FIXME when we can do this by looping over n2ProngDecays
+              auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
+              // 2-prong selections after secondary vertex
+              array<float, 3> pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
+              if (doPvRefit) {
+                pvCoord2Prong[0] = pvRefitCoord2Prong[0];
+                pvCoord2Prong[1] = pvRefitCoord2Prong[1];
+                pvCoord2Prong[2] = pvRefitCoord2Prong[2];
               }
+              is2ProngSelected(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
 
-              // fill histograms
-              if (fillHistograms) {
-                registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
-                registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
-                registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
-                array<array<float, 3>, 2> arrMom = {pvec0, pvec1};
-                for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
-                  if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
-                    if (whichHypo2Prong[iDecay2P] == 1 || whichHypo2Prong[iDecay2P] == 3) {
-                      auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
-                      switch (iDecay2P) {
-                        case hf_cand_2prong::DecayType::D0ToPiK:
-                          registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                          break;
-                        case hf_cand_2prong::DecayType::JpsiToEE:
-                          registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
-                          break;
-                        case hf_cand_2prong::DecayType::JpsiToMuMu:
-                          registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
-                          break;
-                      }
-                    }
-                    if (whichHypo2Prong[iDecay2P] >= 2) {
-                      auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
-                      if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
-                        registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                      }
-                    }
-                  }
+              if (isSelected2ProngCand > 0) {
+                // buffer the candidate, rows and histograms are filled once the combinatorics is over
+                out.prongs2.push_back({{trackPos1.globalIndex(), trackNeg1.globalIndex()}, isSelected2ProngCand, pvRefitCoord2Prong, pvRefitCovMatrix2Prong, getCutStatusBits(cutStatus2Prong), {static_cast<float>(secondaryVertex2[0]), static_cast<float>(secondaryVertex2[1]), static_cast<float>(secondaryVertex2[2])}, {pvec0, pvec1}, whichHypo2Prong});
+                if (fillVertexFit) {
+                  storeVertexFit(df2, collision, out.prongs2.back());
                 }
               }
             }
           }
-        }
-
-        // 3-prong vertex reconstruction
-        if (do3Prong == 1) {
-          if (!sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
-            continue;
-          }
 
-          if (tracks.size() < 2) {
-            continue;
-          }
-          // second loop over positive tracks
-          // for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracksPos.end(); ++trackPos2) {
-          for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracks.end(); ++trackPos2) {
-            if (trackPos2.signed1Pt() < 0) {
-              continue;
-            }
-            if (!TESTBIT(trackPos2.isSelProng(), CandidateType::Cand3Prong)) {
+          // 3-prong vertex reconstruction
+          if (do3Prong == 1) {
+            if (!sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
               continue;
             }
 
-            int isSelected3ProngCand = n3ProngBit;
-
-            if (debug) {
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  cutStatus3Prong[iDecay3P][iCut] = true;
-                }
+            // second loop over positive tracks
+            for (auto iPos2 = firstInEtaWindow(prongsPos, iPos1 + 1, prongsNeg[iNeg1].eta); iPos2 < prongsPos.size(); ++iPos2) {
+              if (isOutsideEtaWindow(prongsPos[iPos2].eta, prongsNeg[iNeg1].eta)) {
+                break;
               }
-            }
+              if (!prongsPos[iPos2].isSel3Prong || isOutsidePhiWindow(prongsPos[iPos2].phi, prongsNeg[iNeg1].phi)) {
+                continue;
+              }
+              const auto& trackPos2 = prongsPos[iPos2].track;
 
-            // 3-prong preselections
-            is3ProngPreselected(trackPos1, trackNeg1, trackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
-              continue;
-            }
+              int isSelected3ProngCand = n3ProngBit;
 
-            // reconstruct the 3-prong secondary vertex
-            auto trackParVarPos2 = getTrackParCov(trackPos2);
-            if (df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2) == 0) {
-              continue;
-            }
-            // get secondary vertex
-            const auto& secondaryVertex3 = df3.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            array<float, 3> pvec2;
-            df3.getTrack(0).getPxPyPzGlo(pvec0);
-            df3.getTrack(1).getPxPyPzGlo(pvec1);
-            df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-            /// PV refit excluding the candidate daughters, if contributors
-            array<float, 3> pvRefitCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-            array<float, 6> pvRefitCovMatrix3Prong2Pos1Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-            if (doPvRefit) {
-              registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-              int nCandContr = 3;
-              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-              auto it_third_trk = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos2.globalIndex());
-              bool isTrackFirstContr = true;
-              bool isTrackSecondContr = true;
-              bool isTrackThirdContr = true;
-              if (trackFirstIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackFirstContr = false;
-              }
-              if (trackSecondIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackSecondContr = false;
-              }
-              if (it_third_trk == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
+              if (debug) {
+                for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
+                  for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
+                    cutStatus3Prong[iDecay3P][iCut] = true;
+                  }
                 }
-                nCandContr--;
-                isTrackThirdContr = false;
               }
 
-              // Fill a vector with global ID of candidate daughters that are contributors
-              std::vector<int64_t> vecCandPvContributorGlobId = {};
-              if (isTrackFirstContr) {
-                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
-              }
-              if (isTrackSecondContr) {
-                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
-              }
-              if (isTrackThirdContr) {
-                vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
+              // 3-prong preselections
+              is3ProngPreselected(trackPos1, trackNeg1, trackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
+              if (!debug && isSelected3ProngCand == 0) {
+                continue;
               }
 
-              if (nCandContr == 3 || nCandContr == 2) {
-                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                if (debug) {
-                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                }
-                performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
-              } else if (nCandContr == 1) {
-                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                if (debug) {
-                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+              // reconstruct the 3-prong secondary vertex
+              const auto& trackParVarPos2 = prongsPos[iPos2].trackParCov;
+              if (df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2) == 0) {
+                continue;
+              }
+              // get secondary vertex
+              const auto& secondaryVertex3 = df3.getPCACandidate();
+              // get track momenta
+              array<float, 3> pvec0;
+              array<float, 3> pvec1;
+              array<float, 3> pvec2;
+              df3.getTrack(0).getPxPyPzGlo(pvec0);
+              df3.getTrack(1).getPxPyPzGlo(pvec1);
+              df3.getTrack(2).getPxPyPzGlo(pvec2);
+
+              /// PV refit excluding the candidate daughters, if contributors
+              array<float, 3> pvRefitCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+              array<float, 6> pvRefitCovMatrix3Prong2Pos1Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+              if (doPvRefit) {
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+                int nCandContr = 3;
+                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
+                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
+                auto it_third_trk = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos2.globalIndex());
+                bool isTrackFirstContr = true;
+                bool isTrackSecondContr = true;
+                bool isTrackThirdContr = true;
+                if (trackFirstIt == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackFirstContr = false;
                 }
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                  /// the first daughter is contributor, the second and the third are not
-                  pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                  /// the second daughter is contributor, the first and the third are not
-                  pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                  /// the third daughter is contributor, the first and the second are not
-                  pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
-                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
+                if (trackSecondIt == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackSecondContr = false;
                 }
-              } else {
-                /// 0 contributors among the HF candidate daughters
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                if (debug) {
-                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                if (it_third_trk == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackThirdContr = false;
                 }
-              }
-            }
-
-            auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
-            // 3-prong selections after secondary vertex
-            array<float, 3> pvCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()};
-            if (doPvRefit) {
-              pvCoord3Prong2Pos1Neg[0] = pvRefitCoord3Prong2Pos1Neg[0];
-              pvCoord3Prong2Pos1Neg[1] = pvRefitCoord3Prong2Pos1Neg[1];
-              pvCoord3Prong2Pos1Neg[2] = pvRefitCoord3Prong2Pos1Neg[2];
-            }
-            is3ProngSelected(pVecCandProng3Pos, secondaryVertex3, pvCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
-              continue;
-            }
-
-            // fill table row
-            rowTrackIndexProng3(trackPos1.globalIndex(),
-                                trackNeg1.globalIndex(),
-                                trackPos2.globalIndex(), isSelected3ProngCand);
-            // fill table row of coordinates of PV refit
-            rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
-                             pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
 
-            if (debug) {
-              int Prong3CutStatus[n3ProngDecays];
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  if (!cutStatus3Prong[iDecay3P][iCut]) {
-                    CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                  }
+                // Fill a vector with global ID of candidate daughters that are contributors
+                std::vector<int64_t> vecCandPvContributorGlobId = {};
+                if (isTrackFirstContr) {
+                  vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+                }
+                if (isTrackSecondContr) {
+                  vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+                }
+                if (isTrackThirdContr) {
+                  vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
                 }
-              }
-              rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over n3ProngDecays
-            }
 
-            // fill histograms
-            if (fillHistograms) {
-              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-              array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                  if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DplusToPiKPi:
-                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
+                if (nCandContr == 3 || nCandContr == 2) {
+                  /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                  if (debug) {
+                    LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
+                  }
+                  performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
+                } else if (nCandContr == 1) {
+                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                  if (debug) {
+                    LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
                   }
-                  if (whichHypo3Prong[iDecay3P] >= 2) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
+                  if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
+                    /// the first daughter is contributor, the second and the third are not
+                    pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                    pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                  } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
+                    /// the second daughter is contributor, the first and the third are not
+                    pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                    pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                  } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
+                    /// the third daughter is contributor, the first and the second are not
+                    pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
+                    pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
+                  }
+                } else {
+                  /// 0 contributors among the HF candidate daughters
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+                  if (debug) {
+                    LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                   }
                 }
               }
-            }
-          }
-
-          // second loop over negative tracks
-          // for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracksNeg.end(); ++trackNeg2) {
-          for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracks.end(); ++trackNeg2) {
-            if (trackNeg2.signed1Pt() > 0) {
-              continue;
-            }
-            if (!TESTBIT(trackNeg2.isSelProng(), CandidateType::Cand3Prong)) {
-              continue;
-            }
-
-            int isSelected3ProngCand = n3ProngBit;
 
-            if (debug) {
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  cutStatus3Prong[iDecay3P][iCut] = true;
-                }
+              auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
+              // 3-prong selections after secondary vertex
+              array<float, 3> pvCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()};
+              if (doPvRefit) {
+                pvCoord3Prong2Pos1Neg[0] = pvRefitCoord3Prong2Pos1Neg[0];
+                pvCoord3Prong2Pos1Neg[1] = pvRefitCoord3Prong2Pos1Neg[1];
+                pvCoord3Prong2Pos1Neg[2] = pvRefitCoord3Prong2Pos1Neg[2];
+              }
+              is3ProngSelected(pVecCandProng3Pos, secondaryVertex3, pvCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
+              if (!debug && isSelected3ProngCand == 0) {
+                continue;
               }
-            }
-
-            // 3-prong preselections
-            is3ProngPreselected(trackNeg1, trackPos1, trackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
-              continue;
-            }
 
-            // reconstruct the 3-prong secondary vertex
-            auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-            if (df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2) == 0) {
-              continue;
+              // buffer the candidate, rows and histograms are filled once the combinatorics is over
+              out.prongs3.push_back({{trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex()}, isSelected3ProngCand, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg, getCutStatusBits(cutStatus3Prong), {static_cast<float>(secondaryVertex3[0]), static_cast<float>(secondaryVertex3[1]), static_cast<float>(secondaryVertex3[2])}, {pvec0, pvec1, pvec2}, whichHypo3Prong});
+              if (fillVertexFit) {
+                storeVertexFit(df3, collision, out.prongs3.back());
+              }
             }
 
-            // get secondary vertex
-            const auto& secondaryVertex3 = df3.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            array<float, 3> pvec2;
-            df3.getTrack(0).getPxPyPzGlo(pvec0);
-            df3.getTrack(1).getPxPyPzGlo(pvec1);
-            df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-            /// PV refit excluding the candidate daughters, if contributors
-            array<float, 3> pvRefitCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-            array<float, 6> pvRefitCovMatrix3Prong1Pos2Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-            if (doPvRefit) {
-              registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-              int nCandContr = 3;
-              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-              auto it_third_trk = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg2.globalIndex());
-              bool isTrackFirstContr = true;
-              bool isTrackSecondContr = true;
-              bool isTrackThirdContr = true;
-              if (trackFirstIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackFirstContr = false;
+            // second loop over negative tracks
+            for (auto iNeg2 = firstInEtaWindow(prongsNeg, iNeg1 + 1, prongsPos[iPos1].eta); iNeg2 < prongsNeg.size(); ++iNeg2) {
+              if (isOutsideEtaWindow(prongsNeg[iNeg2].eta, prongsPos[iPos1].eta)) {
+                break;
               }
-              if (trackSecondIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackSecondContr = false;
+              if (!prongsNeg[iNeg2].isSel3Prong || isOutsidePhiWindow(prongsNeg[iNeg2].phi, prongsPos[iPos1].phi)) {
+                continue;
               }
-              if (it_third_trk == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
+              const auto& trackNeg2 = prongsNeg[iNeg2].track;
+
+              int isSelected3ProngCand = n3ProngBit;
+
+              if (debug) {
+                for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
+                  for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
+                    cutStatus3Prong[iDecay3P][iCut] = true;
+                  }
                 }
-                nCandContr--;
-                isTrackThirdContr = false;
               }
 
-              // Fill a vector with global ID of candidate daughters that are contributors
-              std::vector<int64_t> vecCandPvContributorGlobId = {};
-              if (isTrackFirstContr) {
-                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
-              }
-              if (isTrackSecondContr) {
-                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+              // 3-prong preselections
+              is3ProngPreselected(trackNeg1, trackPos1, trackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
+              if (!debug && isSelected3ProngCand == 0) {
+                continue;
               }
-              if (isTrackThirdContr) {
-                vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
+
+              // reconstruct the 3-prong secondary vertex
+              const auto& trackParVarNeg2 = prongsNeg[iNeg2].trackParCov;
+              if (df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2) == 0) {
+                continue;
               }
 
-              if (nCandContr == 3 || nCandContr == 2) {
-                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                if (debug) {
-                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                }
-                performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
-              } else if (nCandContr == 1) {
-                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                if (debug) {
-                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+              // get secondary vertex
+              const auto& secondaryVertex3 = df3.getPCACandidate();
+              // get track momenta
+              array<float, 3> pvec0;
+              array<float, 3> pvec1;
+              array<float, 3> pvec2;
+              df3.getTrack(0).getPxPyPzGlo(pvec0);
+              df3.getTrack(1).getPxPyPzGlo(pvec1);
+              df3.getTrack(2).getPxPyPzGlo(pvec2);
+
+              /// PV refit excluding the candidate daughters, if contributors
+              array<float, 3> pvRefitCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+              array<float, 6> pvRefitCovMatrix3Prong1Pos2Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+              if (doPvRefit) {
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+                int nCandContr = 3;
+                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
+                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
+                auto it_third_trk = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg2.globalIndex());
+                bool isTrackFirstContr = true;
+                bool isTrackSecondContr = true;
+                bool isTrackThirdContr = true;
+                if (trackFirstIt == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackFirstContr = false;
                 }
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                  /// the first daughter is contributor, the second and the third are not
-                  pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                  /// the second daughter is contributor, the first and the third are not
-                  pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                  /// the third daughter is contributor, the first and the second are not
-                  pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
-                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
+                if (trackSecondIt == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackSecondContr = false;
                 }
-              } else {
-                /// 0 contributors among the HF candidate daughters
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                if (debug) {
-                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                if (it_third_trk == vecPvContributorGlobId.end()) {
+                  /// This track did not contribute to the original PV refit
+                  if (debug) {
+                    LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
+                  }
+                  nCandContr--;
+                  isTrackThirdContr = false;
                 }
-              }
-            }
-
-            auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
-            // 3-prong selections after secondary vertex
-            array<float, 3> pvCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()};
-            if (doPvRefit) {
-              pvCoord3Prong1Pos2Neg[0] = pvRefitCoord3Prong1Pos2Neg[0];
-              pvCoord3Prong1Pos2Neg[1] = pvRefitCoord3Prong1Pos2Neg[1];
-              pvCoord3Prong1Pos2Neg[2] = pvRefitCoord3Prong1Pos2Neg[2];
-            }
-            is3ProngSelected(pVecCandProng3Neg, secondaryVertex3, pvCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
-              continue;
-            }
 
-            // fill table row
-            rowTrackIndexProng3(trackNeg1.globalIndex(),
-                                trackPos1.globalIndex(),
-                                trackNeg2.globalIndex(), isSelected3ProngCand);
-            // fill table row of coordinates of PV refit
-            rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
-                             pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
-
-            if (debug) {
-              int Prong3CutStatus[n3ProngDecays];
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  if (!cutStatus3Prong[iDecay3P][iCut]) {
-                    CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                  }
+                // Fill a vector with global ID of candidate daughters that are contributors
+                std::vector<int64_t> vecCandPvContributorGlobId = {};
+                if (isTrackFirstContr) {
+                  vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+                }
+                if (isTrackSecondContr) {
+                  vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+                }
+                if (isTrackThirdContr) {
+                  vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
                 }
-              }
-              rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over n3ProngDecays
-            }
 
-            // fill histograms
-            if (fillHistograms) {
-              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-              array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                  if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DplusToPiKPi:
-                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
+                if (nCandContr == 3 || nCandContr == 2) {
+                  /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                  if (debug) {
+                    LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
+                  }
+                  performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
+                } else if (nCandContr == 1) {
+                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                  if (debug) {
+                    LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+                  }
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
+                  if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
+                    /// the first daughter is contributor, the second and the third are not
+                    pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                    pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                  } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
+                    /// the second daughter is contributor, the first and the third are not
+                    pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                    pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                  } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
+                    /// the third daughter is contributor, the first and the second are not
+                    pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
+                    pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
                   }
-                  if (whichHypo3Prong[iDecay3P] >= 2) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
+                } else {
+                  /// 0 contributors among the HF candidate daughters
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+                  if (debug) {
+                    LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                   }
                 }
               }
+
+              auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
+              // 3-prong selections after secondary vertex
+              array<float, 3> pvCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()};
+              if (doPvRefit) {
+                pvCoord3Prong1Pos2Neg[0] = pvRefitCoord3Prong1Pos2Neg[0];
+                pvCoord3Prong1Pos2Neg[1] = pvRefitCoord3Prong1Pos2Neg[1];
+                pvCoord3Prong1Pos2Neg[2] = pvRefitCoord3Prong1Pos2Neg[2];
+              }
+              is3ProngSelected(pVecCandProng3Neg, secondaryVertex3, pvCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
+              if (!debug && isSelected3ProngCand == 0) {
+                continue;
+              }
+
+              // buffer the candidate, rows and histograms are filled once the combinatorics is over
+              out.prongs3.push_back({{trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex()}, isSelected3ProngCand, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg, getCutStatusBits(cutStatus3Prong), {static_cast<float>(secondaryVertex3[0]), static_cast<float>(secondaryVertex3[1]), static_cast<float>(secondaryVertex3[2])}, {pvec0, pvec1, pvec2}, whichHypo3Prong});
+              if (fillVertexFit) {
+                storeVertexFit(df3, collision, out.prongs3.back());
+              }
             }
           }
         }
       }
-    }
+    };
 
-    auto nTracks = tracks.size();                      // number of tracks passing 2 and 3 prong selection in this collision
-    nCand2 = rowTrackIndexProng2.lastIndex() - nCand2; // number of 2-prong candidates in this collision
-    nCand3 = rowTrackIndexProng3.lastIndex() - nCand3; // number of 3-prong candidates in this collision
+    const auto nPos = tracksPos.size();
+    const std::size_t nWorkers = nThreadsCombinatorics > 1 ? std::min<std::size_t>(nThreadsCombinatorics, nPos) : 1;
+    candidateBuffers.resize(nWorkers);
+    for (auto& buffer : candidateBuffers) {
+      buffer.prongs2.clear();
+      buffer.prongs3.clear();
+    }
+    if (nWorkers == 1) {
+      combineProngs(0, nPos, tracksPos, tracksNeg, df2, df3, candidateBuffers[0]);
+    } else {
+      // each worker gets a contiguous range of positive tracks, so that writing the buffers in worker order reproduces the serial output
+      const auto nPosPerWorker = (nPos + nWorkers - 1) / nWorkers;
+      std::vector<std::thread> workers;
+      workers.reserve(nWorkers);
+      for (std::size_t iWorker = 0; iWorker < nWorkers; ++iWorker) {
+        workers.emplace_back([&, iWorker]() {
+          // table iterators are not safe to share across threads, hence each worker uses its own copy of the buckets
+          auto prongsPos = tracksPos;
+          auto prongsNeg = tracksNeg;
+          o2::vertexing::DCAFitterN<2> df2Worker;
+          o2::vertexing::DCAFitterN<3> df3Worker;
+          configureFitter(df2Worker);
+          configureFitter(df3Worker);
+          combineProngs(std::min(nPos, iWorker * nPosPerWorker), std::min(nPos, (iWorker + 1) * nPosPerWorker), prongsPos, prongsNeg, df2Worker, df3Worker, candidateBuffers[iWorker]);
+        });
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    }
+    for (const auto& buffer : candidateBuffers) {
+      writeCandidates(buffer);
+    }
 
-    registry.fill(HIST("hNTracks"), nTracks);
-    registry.fill(HIST("hNCand2Prong"), nCand2);
-    registry.fill(HIST("hNCand3Prong"), nCand3);
-    registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
-    registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+    fillCandidateCounters(tracks.size(), nCand2, nCand3);
   }
 };
 
@@ -2199,6 +2428,8 @@ struct HfTrackIndexSkimCreatorCascades {
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
   int runNumber;
 
+  TrackParCovCache<> trackParCovCache; // V0 daughters are combined with all the bachelors of the collision
+
   double massP = RecoDecay::getMassPDG(kProton);
   double massK0s = RecoDecay::getMassPDG(kK0Short);
   double massPi = RecoDecay::getMassPDG(kPiPlus);
@@ -2257,6 +2488,8 @@ struct HfTrackIndexSkimCreatorCascades {
     // fitter.setMaxChi2(1e9);  // used in cascadeproducer.cxx, but not for the 2 prongs
     fitter.setUseAbsDCA(useAbsDCA);
 
+    trackParCovCache.setTracks(tracks);
+
     // fist we loop over the bachelor candidate
 
     // for (const auto& bach : selectedTracks) {
@@ -2286,7 +2519,7 @@ struct HfTrackIndexSkimCreatorCascades {
       }
       MY_DEBUG_MSG(isProtonFromLc, LOG(info) << "KEPT! proton from Lc with daughters " << indexBach);
 
-      auto trackBach = getTrackParCov(bach);
+      auto trackBach = trackParCovCache.get(bach);
       // now we loop over the V0s
       for (const auto& v0 : V0s) {
         MY_DEBUG_MSG(1, LOG(info) << "*** Checking next K0S");
@@ -2362,9 +2595,9 @@ struct HfTrackIndexSkimCreatorCascades {
 
         MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "KEPT! K0S from Lc with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg);
 
-        auto trackParCovV0DaughPos = getTrackParCov(trackV0DaughPos);
+        auto trackParCovV0DaughPos = trackParCovCache.get(trackV0DaughPos);
         trackParCovV0DaughPos.propagateTo(v0.posX(), o2::base::Propagator::Instance()->getNominalBz()); // propagate the track to the X closest to the V0 vertex
-        auto trackParCovV0DaughNeg = getTrackParCov(trackV0DaughNeg);
+        auto trackParCovV0DaughNeg = trackParCovCache.get(trackV0DaughNeg);
         trackParCovV0DaughNeg.propagateTo(v0.negX(), o2::base::Propagator::Instance()->getNominalBz()); // propagate the track to the X closest to the V0 vertex
         std::array<float, 3> pVecV0 = {0., 0., 0.};
         std::array<float, 3> pVecBach = {0., 0., 0.};
@@ -2432,6 +2665,10 @@ WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
   }
 
   workflow.push_back(adaptAnalysisTask<HfTrackIndexSkimCreatorTagSelTracks>(cfgc));
+  const bool writeSelTrackStore = cfgc.options().get<bool>("writeSelTrackStore");
+  if (writeSelTrackStore) {
+    workflow.push_back(adaptAnalysisTask<HfTrackIndexSkimCreatorSelTrackStore>(cfgc));
+  }
   workflow.push_back(adaptAnalysisTask<HfTrackIndexSkimCreator>(cfgc));
 
   const bool doCascades = cfgc.options().get<bool>("doCascades");
@@ -126,6 +126,39 @@ DECLARE_SOA_TABLE(HfCand2ProngFull, "AOD", "HFCAND2PFull",
                   full::E,
                   full::MCflag);
 
+// reduced set of the candidate properties, as used in the ML trainings
+DECLARE_SOA_TABLE(HfCand2ProngLite, "AOD", "HFCAND2PLite",
+                  hf_cand::Chi2PCA,
+                  full::DecayLength,
+                  full::DecayLengthXY,
+                  full::DecayLengthNormalised,
+                  full::DecayLengthXYNormalised,
+                  full::PtProng0,
+                  full::PtProng1,
+                  hf_cand::ImpactParameter0,
+                  hf_cand::ImpactParameter1,
+                  full::ImpactParameterNormalised0,
+                  full::ImpactParameterNormalised1,
+                  full::NSigTPCPi0,
+                  full::NSigTPCKa0,
+                  full::NSigTOFPi0,
+                  full::NSigTOFKa0,
+                  full::NSigTPCPi1,
+                  full::NSigTPCKa1,
+                  full::NSigTOFPi1,
+                  full::NSigTOFKa1,
+                  full::CandidateSelFlag,
+                  full::M,
+                  full::ImpactParameterProduct,
+                  full::CosThetaStar,
+                  full::Pt,
+                  full::CPA,
+                  full::CPAXY,
+                  full::Eta,
+                  full::Phi,
+                  full::Y,
+                  full::MCflag);
+
 DECLARE_SOA_TABLE(HfCand2ProngFullEvents, "AOD", "HFCAND2PFullE",
                   collision::BCId,
                   collision::NumContrib,
@@ -150,9 +183,31 @@ struct HfTreeCreatorD0ToKPi {
   Produces<o2::aod::HfCand2ProngFull> rowCandidateFull;
   Produces<o2::aod::HfCand2ProngFullEvents> rowCandidateFullEvents;
   Produces<o2::aod::HfCand2ProngFullParticles> rowCandidateFullParticles;
+  Produces<o2::aod::HfCand2ProngLite> rowCandidateLite;
+
+  Configurable<bool> fillCandidateLiteTable{"fillCandidateLiteTable", false, "Switch to fill the lite table with the candidate properties used in the ML trainings instead of the full one"};
+  Configurable<std::vector<double>> binsPtDownSample{"binsPtDownSample", std::vector<double>{0., 1000.}, "pT bin limits for the downsampling of the background candidates"};
+  Configurable<std::vector<double>> downSampleBkgFactorsPt{"downSampleBkgFactorsPt", std::vector<double>{1.}, "Fraction of the background candidates to store in each pT bin"};
 
   void init(InitContext const&)
   {
+    if (downSampleBkgFactorsPt->size() + 1 != binsPtDownSample->size()) {
+      LOGF(fatal, "%d downsampling factors given for %d pT bins", downSampleBkgFactorsPt->size(), binsPtDownSample->size() - 1);
+    }
+  }
+
+  /// Downsampling of the background candidates
+  /// \param candidate is candidate
+  /// \return true if the candidate is kept, with the fraction of its pT bin
+  template <typename T>
+  bool keepBackground(const T& candidate)
+  {
+    auto pTBin = findBin(binsPtDownSample, candidate.pt());
+    if (pTBin < 0) {
+      return true;
+    }
+    double pseudoRndm = candidate.ptProng0() * 1000. - (long)(candidate.ptProng0() * 1000);
+    return pseudoRndm < downSampleBkgFactorsPt->at(pTBin);
   }
 
   void process(aod::Collisions const& collisions,
@@ -176,8 +231,15 @@ struct HfTreeCreatorD0ToKPi {
     }
 
     // Filling candidate properties
-    rowCandidateFull.reserve(candidates.size());
+    if (fillCandidateLiteTable) {
+      rowCandidateLite.reserve(candidates.size());
+    } else {
+      rowCandidateFull.reserve(candidates.size());
+    }
     for (auto& candidate : candidates) {
+      if (std::abs(candidate.flagMcMatchRec()) != 1 << DecayType::D0ToPiK && !keepBackground(candidate)) {
+        continue;
+      }
       auto fillTable = [&](int CandFlag,
                            int FunctionSelection,
                            double FunctionInvMass,
@@ -185,7 +247,42 @@ struct HfTreeCreatorD0ToKPi {
                            double FunctionCt,
                            double FunctionY,
                            double FunctionE) {
-        if (FunctionSelection >= 1) {
+        if (FunctionSelection < 1) {
+          return;
+        }
+        if (fillCandidateLiteTable) {
+          rowCandidateLite(
+            candidate.chi2PCA(),
+            candidate.decayLength(),
+            candidate.decayLengthXY(),
+            candidate.decayLengthNormalised(),
+            candidate.decayLengthXYNormalised(),
+            candidate.ptProng0(),
+            candidate.ptProng1(),
+            candidate.impactParameter0(),
+            candidate.impactParameter1(),
+            candidate.impactParameterNormalised0(),
+            candidate.impactParameterNormalised1(),
+            candidate.prong0_as<aod::BigTracksPID>().tpcNSigmaPi(),
+            candidate.prong0_as<aod::BigTracksPID>().tpcNSigmaKa(),
+            candidate.prong0_as<aod::BigTracksPID>().tofNSigmaPi(),
+            candidate.prong0_as<aod::BigTracksPID>().tofNSigmaKa(),
+            candidate.prong1_as<aod::BigTracksPID>().tpcNSigmaPi(),
+            candidate.prong1_as<aod::BigTracksPID>().tpcNSigmaKa(),
+            candidate.prong1_as<aod::BigTracksPID>().tofNSigmaPi(),
+            candidate.prong1_as<aod::BigTracksPID>().tofNSigmaKa(),
+            1 << CandFlag,
+            FunctionInvMass,
+            candidate.impactParameterProduct(),
+            FunctionCosThetaStar,
+            candidate.pt(),
+            candidate.cpa(),
+            candidate.cpaXY(),
+            candidate.eta(),
+            candidate.phi(),
+            FunctionY,
+            candidate.flagMcMatchRec());
+        } else {
           rowCandidateFull(
             candidate.prong0_as<aod::BigTracksPID>().collision().bcId(),
             candidate.prong0_as<aod::BigTracksPID>().collision().numContrib(),
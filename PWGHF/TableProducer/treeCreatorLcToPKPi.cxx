@@ -155,6 +155,48 @@ DECLARE_SOA_TABLE(HfCand3ProngFull, "AOD", "HFCAND3PFull",
                   full::MCflag,
                   full::IsCandidateSwapped);
 
+// reduced set of the candidate properties, as used in the ML trainings
+DECLARE_SOA_TABLE(HfCand3ProngLite, "AOD", "HFCAND3PLite",
+                  hf_cand::Chi2PCA,
+                  full::DecayLength,
+                  full::DecayLengthXY,
+                  full::DecayLengthNormalised,
+                  full::DecayLengthXYNormalised,
+                  full::PtProng0,
+                  full::PtProng1,
+                  full::PtProng2,
+                  hf_cand::ImpactParameter0,
+                  hf_cand::ImpactParameter1,
+                  hf_cand::ImpactParameter2,
+                  full::NSigTPCPi0,
+                  full::NSigTPCKa0,
+                  full::NSigTPCPr0,
+                  full::NSigTOFPi0,
+                  full::NSigTOFKa0,
+                  full::NSigTOFPr0,
+                  full::NSigTPCPi1,
+                  full::NSigTPCKa1,
+                  full::NSigTPCPr1,
+                  full::NSigTOFPi1,
+                  full::NSigTOFKa1,
+                  full::NSigTOFPr1,
+                  full::NSigTPCPi2,
+                  full::NSigTPCKa2,
+                  full::NSigTPCPr2,
+                  full::NSigTOFPi2,
+                  full::NSigTOFKa2,
+                  full::NSigTOFPr2,
+                  full::CandidateSelFlag,
+                  full::M,
+                  full::Pt,
+                  full::CPA,
+                  full::CPAXY,
+                  full::Eta,
+                  full::Phi,
+                  full::Y,
+                  full::MCflag,
+                  full::IsCandidateSwapped);
+
 DECLARE_SOA_TABLE(HfCand3ProngFullEvents, "AOD", "HFCAND3PFullE",
                   collision::BCId,
                   collision::NumContrib,
@@ -179,11 +221,75 @@ struct HfTreeCreatorLcToPKPi {
   Produces<o2::aod::HfCand3ProngFull> rowCandidateFull;
   Produces<o2::aod::HfCand3ProngFullEvents> rowCandidateFullEvents;
   Produces<o2::aod::HfCand3ProngFullParticles> rowCandidateFullParticles;
+  Produces<o2::aod::HfCand3ProngLite> rowCandidateLite;
 
   Configurable<double> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of candidates to store in the tree"};
+  Configurable<bool> fillCandidateLiteTable{"fillCandidateLiteTable", false, "Switch to fill the lite table with the candidate properties used in the ML trainings instead of the full one"};
+  Configurable<std::vector<double>> binsPtDownSample{"binsPtDownSample", std::vector<double>{0., 1000.}, "pT bin limits for the downsampling of the data candidates"};
+  Configurable<std::vector<double>> downSampleBkgFactorsPt{"downSampleBkgFactorsPt", std::vector<double>{1.}, "Fraction of the data candidates to store in each pT bin (the smaller of this and downSampleBkgFactor applies)"};
 
   void init(InitContext const&)
   {
+    if (downSampleBkgFactorsPt->size() + 1 != binsPtDownSample->size()) {
+      LOGF(fatal, "%d downsampling factors given for %d pT bins", downSampleBkgFactorsPt->size(), binsPtDownSample->size() - 1);
+    }
+  }
+
+  /// Downsampling of the background candidates
+  /// \param candidate is candidate
+  /// \param pseudoRndm is the pseudo-random number of the candidate in [0, 1)
+  /// \return true if the candidate is kept, with the fraction of its pT bin
+  template <typename T>
+  bool keepBackground(const T& candidate, double pseudoRndm)
+  {
+    auto pTBin = findBin(binsPtDownSample, candidate.pt());
+    return pTBin < 0 || pseudoRndm < downSampleBkgFactorsPt->at(pTBin);
+  }
+
+  /// Fills the lite table
+  template <typename T, typename U>
+  void fillCandidateLite(const T& candidate, const U& trackPos1, const U& trackNeg, const U& trackPos2, int candFlag, float invMass, float y, int8_t mcFlag, int8_t isSwapped)
+  {
+    rowCandidateLite(
+      candidate.chi2PCA(),
+      candidate.decayLength(),
+      candidate.decayLengthXY(),
+      candidate.decayLengthNormalised(),
+      candidate.decayLengthXYNormalised(),
+      candidate.ptProng0(),
+      candidate.ptProng1(),
+      candidate.ptProng2(),
+      candidate.impactParameter0(),
+      candidate.impactParameter1(),
+      candidate.impactParameter2(),
+      trackPos1.tpcNSigmaPi(),
+      trackPos1.tpcNSigmaKa(),
+      trackPos1.tpcNSigmaPr(),
+      trackPos1.tofNSigmaPi(),
+      trackPos1.tofNSigmaKa(),
+      trackPos1.tofNSigmaPr(),
+      trackNeg.tpcNSigmaPi(),
+      trackNeg.tpcNSigmaKa(),
+      trackNeg.tpcNSigmaPr(),
+      trackNeg.tofNSigmaPi(),
+      trackNeg.tofNSigmaKa(),
+      trackNeg.tofNSigmaPr(),
+      trackPos2.tpcNSigmaPi(),
+      trackPos2.tpcNSigmaKa(),
+      trackPos2.tpcNSigmaPr(),
+      trackPos2.tofNSigmaPi(),
+      trackPos2.tofNSigmaKa(),
+      trackPos2.tofNSigmaPr(),
+      1 << candFlag,
+      invMass,
+      candidate.pt(),
+      candidate.cpa(),
+      candidate.cpaXY(),
+      candidate.eta(),
+      candidate.phi(),
+      y,
+      mcFlag,
+      isSwapped);
   }
 
   void processMc(aod::Collisions const& collisions,
@@ -207,7 +313,11 @@ struct HfTreeCreatorLcToPKPi {
     }
 
     // Filling candidate properties
-    rowCandidateFull.reserve(candidates.size());
+    if (fillCandidateLiteTable) {
+      rowCandidateLite.reserve(candidates.size());
+    } else {
+      rowCandidateFull.reserve(candidates.size());
+    }
     for (auto& candidate : candidates) {
       auto trackPos1 = candidate.prong0_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
       auto trackNeg = candidate.prong1_as<aod::BigTracksPID>();  // negative daughter (positive for the antiparticles)
@@ -220,6 +330,10 @@ struct HfTreeCreatorLcToPKPi {
                            float FunctionE) {
         double pseudoRndm = trackPos1.pt() * 1000. - (long)(trackPos1.pt() * 1000);
         if (FunctionSelection >= 1 && std::abs(candidate.flagMcMatchRec()) == 1 << DecayType::LcToPKPi && pseudoRndm < downSampleBkgFactor) {
+          if (fillCandidateLiteTable) {
+            fillCandidateLite(candidate, trackPos1, trackNeg, trackPos2, CandFlag, FunctionInvMass, FunctionY, candidate.flagMcMatchRec(), candidate.isCandidateSwapped());
+            return;
+          }
           rowCandidateFull(
             trackPos1.collision().bcId(),
             trackPos1.collision().numContrib(),
@@ -334,7 +448,11 @@ struct HfTreeCreatorLcToPKPi {
     }
 
     // Filling candidate properties
-    rowCandidateFull.reserve(candidates.size());
+    if (fillCandidateLiteTable) {
+      rowCandidateLite.reserve(candidates.size());
+    } else {
+      rowCandidateFull.reserve(candidates.size());
+    }
     for (auto& candidate : candidates) {
       auto trackPos1 = candidate.prong0_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
       auto trackNeg = candidate.prong1_as<aod::BigTracksPID>();  // negative daughter (positive for the antiparticles)
@@ -346,7 +464,11 @@ struct HfTreeCreatorLcToPKPi {
                            float FunctionY,
                            float FunctionE) {
         double pseudoRndm = trackPos1.pt() * 1000. - (long)(trackPos1.pt() * 1000);
-        if (FunctionSelection >= 1 && pseudoRndm < downSampleBkgFactor) {
+        if (FunctionSelection >= 1 && pseudoRndm < downSampleBkgFactor && keepBackground(candidate, pseudoRndm)) {
+          if (fillCandidateLiteTable) {
+            fillCandidateLite(candidate, trackPos1, trackNeg, trackPos2, CandFlag, FunctionInvMass, FunctionY, 0, 0);
+            return;
+          }
           rowCandidateFull(
             trackPos1.collision().bcId(),
             trackPos1.collision().numContrib(),
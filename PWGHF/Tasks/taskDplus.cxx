@@ -20,6 +20,7 @@
 #include "Framework/HistogramRegistry.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Core/PtBinnedHistograms.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -36,6 +37,9 @@ struct HfTaskDplus {
 
   Partition<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>> selectedDPlusCandidates = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= selectionFlagDplus;
   Partition<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi, aod::HfCand3ProngMcRec>> recoFlagDPlusCandidates = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi > 0;
+  // candidate variables vs pT, index in histsVsPt
+  enum HistVsPt { kHistMass = 0, kHistEta, kHistCt, kHistDecayLength, kHistDecayLengthXY, kHistNormalisedDecayLengthXY, kHistCPA, kHistCPAxy, kHistImpactParameterXY, kHistMaxNormalisedDeltaIP, kHistImpactParameterProngSqSum, kHistDecayLengthError, kHistDecayLengthXYError, kHistImpactParameterError, kHistD0Prong0, kHistD0Prong1, kHistD0Prong2 };
+  o2::analysis::PtBinnedHistograms histsVsPt; // histograms vs pT filled with the pT bin found once per candidate
 
   HistogramRegistry registry{
     "registry",
@@ -52,23 +56,27 @@ struct HfTaskDplus {
   void init(o2::framework::InitContext&)
   {
     auto vbins = (std::vector<double>)binsPt;
-    registry.add("hMass", "3-prong candidates;inv. mass (#pi K #pi) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{350, 1.7, 2.05}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hEta", "3-prong candidates;candidate #it{#eta};entries", {HistType::kTH2F, {{100, -2., 2.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hCt", "3-prong candidates;proper lifetime (D^{#pm}) * #it{c} (cm);entries", {HistType::kTH2F, {{120, -20., 100.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hDecayLength", "3-prong candidates;decay length (cm);entries", {HistType::kTH2F, {{200, 0., 2.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hDecayLengthXY", "3-prong candidates;decay length xy (cm);entries", {HistType::kTH2F, {{200, 0., 2.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hNormalisedDecayLengthXY", "3-prong candidates;norm. decay length xy;entries", {HistType::kTH2F, {{80, 0., 80.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hCPA", "3-prong candidates;cos. pointing angle;entries", {HistType::kTH2F, {{110, -1.1, 1.1}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hCPAxy", "3-prong candidates;cos. pointing angle xy;entries", {HistType::kTH2F, {{110, -1.1, 1.1}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hImpactParameterXY", "3-prong candidates;impact parameter xy (cm);entries", {HistType::kTH2F, {{200, -1., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hMaxNormalisedDeltaIP", "3-prong candidates;norm. IP;entries", {HistType::kTH2F, {{200, -20., 20.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hImpactParameterProngSqSum", "3-prong candidates;squared sum of prong imp. par. (cm^{2});entries", {HistType::kTH2F, {{100, 0., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hDecayLengthError", "3-prong candidates;decay length error (cm);entries", {HistType::kTH2F, {{100, 0., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hDecayLengthXYError", "3-prong candidates;decay length xy error (cm);entries", {HistType::kTH2F, {{100, 0., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hImpactParameterError", "3-prong candidates;impact parameter error (cm);entries", {HistType::kTH2F, {{100, 0., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hd0Prong0", "3-prong candidates;prong 0 DCAxy to prim. vertex (cm);entries", {HistType::kTH2F, {{100, -1., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hd0Prong1", "3-prong candidates;prong 1 DCAxy to prim. vertex (cm);entries", {HistType::kTH2F, {{100, -1., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
-    registry.add("hd0Prong2", "3-prong candidates;prong 2 DCAxy to prim. vertex (cm);entries", {HistType::kTH2F, {{100, -1., 1.}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
+    // candidate variables vs pT, filled through histsVsPt in the order of HistVsPt
+    auto addVsPt = [&](const char* name, const char* title, AxisSpec const& axis) {
+      histsVsPt.add(std::get<std::shared_ptr<TH2>>(registry.add(name, title, {HistType::kTH2F, {axis, {vbins, "#it{p}_{T} (GeV/#it{c})"}}})));
+    };
+    addVsPt("hMass", "3-prong candidates;inv. mass (#pi K #pi) (GeV/#it{c}^{2});entries", {350, 1.7, 2.05});
+    addVsPt("hEta", "3-prong candidates;candidate #it{#eta};entries", {100, -2., 2.});
+    addVsPt("hCt", "3-prong candidates;proper lifetime (D^{#pm}) * #it{c} (cm);entries", {120, -20., 100.});
+    addVsPt("hDecayLength", "3-prong candidates;decay length (cm);entries", {200, 0., 2.});
+    addVsPt("hDecayLengthXY", "3-prong candidates;decay length xy (cm);entries", {200, 0., 2.});
+    addVsPt("hNormalisedDecayLengthXY", "3-prong candidates;norm. decay length xy;entries", {80, 0., 80.});
+    addVsPt("hCPA", "3-prong candidates;cos. pointing angle;entries", {110, -1.1, 1.1});
+    addVsPt("hCPAxy", "3-prong candidates;cos. pointing angle xy;entries", {110, -1.1, 1.1});
+    addVsPt("hImpactParameterXY", "3-prong candidates;impact parameter xy (cm);entries", {200, -1., 1.});
+    addVsPt("hMaxNormalisedDeltaIP", "3-prong candidates;norm. IP;entries", {200, -20., 20.});
+    addVsPt("hImpactParameterProngSqSum", "3-prong candidates;squared sum of prong imp. par. (cm^{2});entries", {100, 0., 1.});
+    addVsPt("hDecayLengthError", "3-prong candidates;decay length error (cm);entries", {100, 0., 1.});
+    addVsPt("hDecayLengthXYError", "3-prong candidates;decay length xy error (cm);entries", {100, 0., 1.});
+    addVsPt("hImpactParameterError", "3-prong candidates;impact parameter error (cm);entries", {100, 0., 1.});
+    addVsPt("hd0Prong0", "3-prong candidates;prong 0 DCAxy to prim. vertex (cm);entries", {100, -1., 1.});
+    addVsPt("hd0Prong1", "3-prong candidates;prong 1 DCAxy to prim. vertex (cm);entries", {100, -1., 1.});
+    addVsPt("hd0Prong2", "3-prong candidates;prong 2 DCAxy to prim. vertex (cm);entries", {100, -1., 1.});
     registry.add("hPtRecSig", "3-prong candidates (matched);#it{p}_{T}^{rec.} (GeV/#it{c});entries", {HistType::kTH1F, {{vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hPtRecSigPrompt", "3-prong candidates (matched, prompt);#it{p}_{T}^{rec.} (GeV/#it{c});entries", {HistType::kTH1F, {{vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hPtRecSigNonPrompt", "3-prong candidates (matched, non-prompt);#it{p}_{T}^{rec.} (GeV/#it{c});entries", {HistType::kTH1F, {{vbins, "#it{p}_{T} (GeV/#it{c})"}}});
@@ -101,29 +109,30 @@ struct HfTaskDplus {
       if (yCandMax >= 0. && std::abs(yDplus(candidate)) > yCandMax) {
         continue;
       }
-      registry.fill(HIST("hMass"), invMassDplusToPiKPi(candidate), candidate.pt());
+      histsVsPt.setPt(candidate.pt());
+      histsVsPt.fill(kHistMass, invMassDplusToPiKPi(candidate));
       registry.fill(HIST("hPt"), candidate.pt());
-      registry.fill(HIST("hEta"), candidate.eta(), candidate.pt());
-      registry.fill(HIST("hCt"), ctDplus(candidate), candidate.pt());
-      registry.fill(HIST("hDecayLength"), candidate.decayLength(), candidate.pt());
-      registry.fill(HIST("hDecayLengthXY"), candidate.decayLengthXY(), candidate.pt());
-      registry.fill(HIST("hNormalisedDecayLengthXY"), candidate.decayLengthXYNormalised(), candidate.pt());
-      registry.fill(HIST("hCPA"), candidate.cpa(), candidate.pt());
-      registry.fill(HIST("hCPAxy"), candidate.cpaXY(), candidate.pt());
-      registry.fill(HIST("hImpactParameterXY"), candidate.impactParameterXY(), candidate.pt());
-      registry.fill(HIST("hMaxNormalisedDeltaIP"), candidate.maxNormalisedDeltaIP(), candidate.pt());
-      registry.fill(HIST("hImpactParameterProngSqSum"), candidate.impactParameterProngSqSum(), candidate.pt());
-      registry.fill(HIST("hDecayLengthError"), candidate.errorDecayLength(), candidate.pt());
-      registry.fill(HIST("hDecayLengthXYError"), candidate.errorDecayLengthXY(), candidate.pt());
-      registry.fill(HIST("hImpactParameterError"), candidate.errorImpactParameter0(), candidate.pt());
-      registry.fill(HIST("hImpactParameterError"), candidate.errorImpactParameter1(), candidate.pt());
-      registry.fill(HIST("hImpactParameterError"), candidate.errorImpactParameter2(), candidate.pt());
+      histsVsPt.fill(kHistEta, candidate.eta());
+      histsVsPt.fill(kHistCt, ctDplus(candidate));
+      histsVsPt.fill(kHistDecayLength, candidate.decayLength());
+      histsVsPt.fill(kHistDecayLengthXY, candidate.decayLengthXY());
+      histsVsPt.fill(kHistNormalisedDecayLengthXY, candidate.decayLengthXYNormalised());
+      histsVsPt.fill(kHistCPA, candidate.cpa());
+      histsVsPt.fill(kHistCPAxy, candidate.cpaXY());
+      histsVsPt.fill(kHistImpactParameterXY, candidate.impactParameterXY());
+      histsVsPt.fill(kHistMaxNormalisedDeltaIP, candidate.maxNormalisedDeltaIP());
+      histsVsPt.fill(kHistImpactParameterProngSqSum, candidate.impactParameterProngSqSum());
+      histsVsPt.fill(kHistDecayLengthError, candidate.errorDecayLength());
+      histsVsPt.fill(kHistDecayLengthXYError, candidate.errorDecayLengthXY());
+      histsVsPt.fill(kHistImpactParameterError, candidate.errorImpactParameter0());
+      histsVsPt.fill(kHistImpactParameterError, candidate.errorImpactParameter1());
+      histsVsPt.fill(kHistImpactParameterError, candidate.errorImpactParameter2());
       registry.fill(HIST("hPtProng0"), candidate.ptProng0());
       registry.fill(HIST("hPtProng1"), candidate.ptProng1());
       registry.fill(HIST("hPtProng2"), candidate.ptProng2());
-      registry.fill(HIST("hd0Prong0"), candidate.impactParameter0(), candidate.pt());
-      registry.fill(HIST("hd0Prong1"), candidate.impactParameter1(), candidate.pt());
-      registry.fill(HIST("hd0Prong2"), candidate.impactParameter2(), candidate.pt());
+      histsVsPt.fill(kHistD0Prong0, candidate.impactParameter0());
+      histsVsPt.fill(kHistD0Prong1, candidate.impactParameter1());
+      histsVsPt.fill(kHistD0Prong2, candidate.impactParameter2());
     }
   }
 
@@ -0,0 +1,100 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsBhadronCreator.h
+/// \brief Utilities shared by the B-hadron candidate creators (B± → D0 π±, B0 → D∓ π±, Λb → Λc π)
+///
+/// The bachelor tracks of a collision are selected once, split by charge and stored with their TrackParCov,
+/// so that the track parametrisation is not rebuilt for each charm-hadron candidate. A cheap invariant-mass
+/// window on the charm hadron + bachelor pair is applied before the B-vertex fit.
+
+#ifndef PWGHF_UTILS_UTILSBHADRONCREATOR_H_
+#define PWGHF_UTILS_UTILSBHADRONCREATOR_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Common/Core/RecoDecay.h"
+#include "Common/Core/trackUtilities.h"
+#include "ReconstructionDataFormats/Track.h"
+
+namespace o2::analysis::hf_bhadron
+{
+
+/// Selected bachelor track with its cached parametrisation
+struct BachelorTrack {
+  int64_t globalIndex;
+  float pt;
+  float eta;
+  std::array<float, 3> pVec;
+  o2::track::TrackParCov trackParCov;
+};
+
+/// Bachelor tracks of a collision, split by charge and sorted by decreasing pT
+class BachelorBuckets
+{
+ public:
+  /// Selects the bachelor tracks of a collision
+  /// \param tracks tracks of the collision
+  /// \param ptMin minimum pT of the bachelor tracks
+  /// \param etaMax maximum |eta| of the bachelor tracks, no selection if negative
+  template <typename T>
+  void fill(T const& tracks, float ptMin, float etaMax)
+  {
+    for (auto& bucket : mBuckets) {
+      bucket.clear();
+    }
+    for (const auto& track : tracks) {
+      if (track.pt() < ptMin) {
+        continue;
+      }
+      if (etaMax >= 0.f && std::abs(track.eta()) > etaMax) {
+        continue;
+      }
+      mBuckets[track.sign() > 0 ? 1 : 0].push_back({track.globalIndex(), track.pt(), track.eta(), {track.px(), track.py(), track.pz()}, getTrackParCov(track)});
+    }
+    for (auto& bucket : mBuckets) {
+      std::sort(bucket.begin(), bucket.end(), [](BachelorTrack const& a, BachelorTrack const& b) { return a.pt > b.pt; });
+    }
+  }
+
+  /// \param sign charge of the requested bachelor tracks
+  /// \return bachelor tracks of the given charge
+  std::vector<BachelorTrack> const& get(int sign) const { return mBuckets[sign > 0 ? 1 : 0]; }
+
+ private:
+  std::array<std::vector<BachelorTrack>, 2> mBuckets; // negative and positive tracks
+};
+
+/// Cheap invariant-mass selection of a charm hadron + bachelor pair, from the momenta before the vertex fit
+/// \param pVecCharm momentum of the charm hadron
+/// \param massCharm mass hypothesis of the charm hadron
+/// \param pVecBach momentum of the bachelor track
+/// \param massBach mass hypothesis of the bachelor track
+/// \param massB mass of the B hadron
+/// \param window half-width of the mass window, no selection if negative
+/// \return true if the pair invariant mass is within the window
+inline bool isInMassWindow(std::array<float, 3> const& pVecCharm, double massCharm, std::array<float, 3> const& pVecBach, double massBach,
+                           double massB, double window)
+{
+  if (window < 0.) {
+    return true;
+  }
+  const double mass = RecoDecay::m(std::array{pVecCharm, pVecBach}, std::array{massCharm, massBach});
+  return std::abs(mass - massB) < window;
+}
+
+} // namespace o2::analysis::hf_bhadron
+
+#endif // PWGHF_UTILS_UTILSBHADRONCREATOR_H_
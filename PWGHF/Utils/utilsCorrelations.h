@@ -0,0 +1,75 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsCorrelations.h
+/// \brief Cache of the associated particles of a collision for the HF-hadron correlators
+///
+/// The associated tracks (or MC particles) passing the trigger-independent selections are copied once per collision
+/// into flat arrays, together with the quantities needed by the pair loop, so that the loop over the trigger
+/// candidates does not re-read the tables and re-evaluate the dynamic columns for each of them.
+
+#ifndef PWGHF_UTILS_UTILSCORRELATIONS_H_
+#define PWGHF_UTILS_UTILSCORRELATIONS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace o2::analysis::hf_correlations
+{
+
+struct AssociatedParticles {
+  std::vector<float> phi;
+  std::vector<float> eta;
+  std::vector<float> pt;
+  std::vector<float> px;
+  std::vector<float> py;
+  std::vector<float> pz;
+  std::vector<float> energy;        // energy in the pion hypothesis, for the soft-pion removal
+  std::vector<int64_t> globalIndex; // index of the track, to remove the daughters of the trigger
+  std::vector<int> motherIndex;     // index of the mother used for the soft-pion removal (e.g. D*), -1 if none
+
+  void clear()
+  {
+    for (auto* column : {&phi, &eta, &pt, &px, &py, &pz, &energy}) {
+      column->clear();
+    }
+    globalIndex.clear();
+    motherIndex.clear();
+  }
+
+  void reserve(std::size_t n)
+  {
+    for (auto* column : {&phi, &eta, &pt, &px, &py, &pz, &energy}) {
+      column->reserve(n);
+    }
+    globalIndex.reserve(n);
+    motherIndex.reserve(n);
+  }
+
+  std::size_t size() const { return phi.size(); }
+
+  void push(float phiAssoc, float etaAssoc, float ptAssoc, float pxAssoc, float pyAssoc, float pzAssoc, float energyAssoc, int64_t index, int mother = -1)
+  {
+    phi.push_back(phiAssoc);
+    eta.push_back(etaAssoc);
+    pt.push_back(ptAssoc);
+    px.push_back(pxAssoc);
+    py.push_back(pyAssoc);
+    pz.push_back(pzAssoc);
+    energy.push_back(energyAssoc);
+    globalIndex.push_back(index);
+    motherIndex.push_back(mother);
+  }
+};
+
+} // namespace o2::analysis::hf_correlations
+
+#endif // PWGHF_UTILS_UTILSCORRELATIONS_H_
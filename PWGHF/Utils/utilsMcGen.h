@@ -0,0 +1,167 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsMcGen.h
+/// \brief Generator-level matching of the MC particles to the decay channels of the HF candidate creators
+///
+/// One function per creator, with the channels of its generator-level matching. The PDG code of the particle is
+/// checked first, so that only the channels of its species are tested. The functions are used by the creators and by
+/// hf-candidate-creator-mc-gen, which classifies all the MC particles once for all the creators.
+
+#ifndef PWGHF_UTILS_UTILSMCGEN_H_
+#define PWGHF_UTILS_UTILSMCGEN_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <TPDGCode.h>
+
+#include "Common/Core/RecoDecay.h"
+#include "PWGHF/Core/SelectorCuts.h"
+#include "PWGHF/DataModel/CandidateReconstructionTables.h"
+
+namespace o2::analysis::hf_mc_gen
+{
+
+/// D0(bar) → π± K∓, J/ψ → e+ e−, J/ψ → μ+ μ−
+/// \return flag of the decay channel of hf_cand_2prong::DecayType, signed for D0(bar)
+template <typename TParticles, typename TParticle>
+int8_t matchGen2Prong(TParticles const& particlesMC, TParticle const& particle)
+{
+  using namespace o2::aod::hf_cand_2prong;
+  int8_t sign = 0;
+  switch (std::abs(particle.pdgCode())) {
+    case pdg::Code::kD0:
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign)) {
+        return sign * (1 << DecayType::D0ToPiK);
+      }
+      return 0;
+    case pdg::Code::kJPsi:
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kJPsi, std::array{+kElectron, -kElectron}, true)) {
+        return 1 << DecayType::JpsiToEE;
+      }
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true)) {
+        return 1 << DecayType::JpsiToMuMu;
+      }
+      return 0;
+    default:
+      return 0;
+  }
+}
+
+/// D± → π± K∓ π±, Ds± → K± K∓ π±, Λc± → p± K∓ π±, Ξc± → p± K∓ π±
+/// \param channel resonant decay channel of the Λc± → p± K∓ π±: 1 for p K*, 2 for Δ(1232)±± K∓, 3 for Λ(1520) π±, 0 otherwise
+/// \return flag of the decay channel of hf_cand_3prong::DecayType, signed
+template <typename TParticles, typename TParticle>
+int8_t matchGen3Prong(TParticles const& particlesMC, TParticle const& particle, int8_t& channel)
+{
+  using namespace o2::aod::hf_cand_3prong;
+  int8_t sign = 0;
+  channel = 0;
+  switch (std::abs(particle.pdgCode())) {
+    case pdg::Code::kDPlus:
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        return sign * (1 << DecayType::DplusToPiKPi);
+      }
+      return 0;
+    case pdg::Code::kDS:
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        return sign * (1 << DecayType::DsToKKPi);
+      }
+      return 0;
+    case pdg::Code::kLambdaCPlus: {
+      if (!RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        return 0;
+      }
+      constexpr std::array<int, 2> arrPDGResonant1 = {kProton, 313};  // Λc± → p± K*
+      constexpr std::array<int, 2> arrPDGResonant2 = {2224, kKPlus};  // Λc± → Δ(1232)±± K∓
+      constexpr std::array<int, 2> arrPDGResonant3 = {3124, kPiPlus}; // Λc± → Λ(1520) π±
+      std::vector<int> arrDaughIndex;
+      RecoDecay::getDaughters(particle, &arrDaughIndex, std::array{0}, 1);
+      if (arrDaughIndex.size() == 2) {
+        std::array<int, 2> arrPDGDaugh;
+        for (auto jProng = 0u; jProng < arrDaughIndex.size(); ++jProng) {
+          arrPDGDaugh[jProng] = std::abs(particlesMC.rawIteratorAt(arrDaughIndex[jProng]).pdgCode());
+        }
+        auto isResonant = [&arrPDGDaugh](std::array<int, 2> const& arrPDGResonant) {
+          return (arrPDGDaugh[0] == arrPDGResonant[0] && arrPDGDaugh[1] == arrPDGResonant[1]) || (arrPDGDaugh[0] == arrPDGResonant[1] && arrPDGDaugh[1] == arrPDGResonant[0]);
+        };
+        if (isResonant(arrPDGResonant1)) {
+          channel = 1;
+        } else if (isResonant(arrPDGResonant2)) {
+          channel = 2;
+        } else if (isResonant(arrPDGResonant3)) {
+          channel = 3;
+        }
+      }
+      return sign * (1 << DecayType::LcToPKPi);
+    }
+    case pdg::Code::kXiCPlus:
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        return sign * (1 << DecayType::XicToPKPi);
+      }
+      return 0;
+    default:
+      return 0;
+  }
+}
+
+/// Λc± → K0s p±, with K0s → π+ π−
+/// \return sign of the Λc, 0 if not matched
+template <typename TParticles, typename TParticle>
+int8_t matchGenCascade(TParticles const& particlesMC, TParticle const& particle)
+{
+  if (std::abs(particle.pdgCode()) != pdg::Code::kLambdaCPlus) {
+    return 0;
+  }
+  int8_t sign = 0;
+  RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kLambdaCPlus, std::array{+kProton, +kK0Short}, true, &sign, 2);
+  if (sign != 0) {
+    // checking that the final daughters (decay depth = 3) are p, pi+, pi-
+    constexpr std::array<int, 3> arrDaughLcPDGRef = {2212, 211, -211};
+    std::vector<int> arrDaughLcIndex;
+    RecoDecay::getDaughters(particle, &arrDaughLcIndex, arrDaughLcPDGRef, 3); // best would be to check the K0S daughters
+    if (arrDaughLcIndex.size() == 3) {
+      for (std::size_t iProng = 0; iProng < arrDaughLcIndex.size(); ++iProng) {
+        if (particlesMC.rawIteratorAt(arrDaughLcIndex[iProng]).pdgCode() != arrDaughLcPDGRef[iProng]) { // this should be the condition, first bach, then v0
+          return 0;
+        }
+      }
+    }
+  }
+  return sign;
+}
+
+/// B0 → D− π+ → (π− K+ π−) π+
+/// \return flag of the decay channel of hf_cand_b0::DecayType, signed
+template <typename TParticles, typename TParticle>
+int8_t matchGenB0(TParticles const& particlesMC, TParticle const& particle)
+{
+  if (std::abs(particle.pdgCode()) != pdg::Code::kB0) {
+    return 0;
+  }
+  int8_t sign = 0;
+  if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kB0, std::array{-int(pdg::Code::kDPlus), +kPiPlus}, true)) {
+    // Match D- -> π- K+ π-
+    auto candDMC = particlesMC.rawIteratorAt(particle.daughtersIds().front());
+    if (RecoDecay::isMatchedMCGen(particlesMC, candDMC, -int(pdg::Code::kDPlus), std::array{-kPiPlus, +kKPlus, -kPiPlus}, true, &sign)) {
+      return sign * BIT(o2::aod::hf_cand_b0::DecayType::B0ToDPi);
+    }
+  }
+  return 0;
+}
+
+} // namespace o2::analysis::hf_mc_gen
+
+#endif // PWGHF_UTILS_UTILSMCGEN_H_
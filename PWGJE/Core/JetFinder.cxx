@@ -40,6 +40,9 @@ void JetFinder::setBkgE()
 {
   if (bkgSubMode == BkgSubMode::rhoAreaSub || bkgSubMode == BkgSubMode::constSub) {
     bkgE = decltype(bkgE)(new fastjet::JetMedianBackgroundEstimator(selRho, jetDefBkg, areaDefBkg));
+  } else if (bkgSubMode == BkgSubMode::rhoGridAreaSub) {
+    // median of the pt densities of rectangular patches, no clustering of the event needed
+    bkgE = decltype(bkgE)(new fastjet::GridMedianBackgroundEstimator(fastjet::RectangularGrid(bkgEtaMin, bkgEtaMax, bkgGridSize, bkgGridSize)));
   } else {
     if (bkgSubMode != BkgSubMode::none) {
       LOGF(error, "requested subtraction mode not implemented!");
@@ -51,8 +54,8 @@ void JetFinder::setBkgE()
 void JetFinder::setSub()
 {
   //if rho < 1e-6 it is set to 1e-6 in AliPhysics
-  if (bkgSubMode == BkgSubMode::rhoAreaSub) {
-    sub = decltype(sub){new fastjet::Subtractor{bkgE.get()}};
+  if (bkgSubMode == BkgSubMode::rhoAreaSub || bkgSubMode == BkgSubMode::rhoGridAreaSub) {
+    sub = useExternalRho ? decltype(sub){new fastjet::Subtractor{externalRho}} : decltype(sub){new fastjet::Subtractor{bkgE.get()}};
   } else if (bkgSubMode == BkgSubMode::constSub) { //event or jetwise
     constituentSub = decltype(constituentSub){new fastjet::contrib::ConstituentSubtractor{bkgE.get()}};
     constituentSub->set_distance_type(fastjet::contrib::ConstituentSubtractor::deltaR);
@@ -68,6 +71,24 @@ void JetFinder::setSub()
   }
 }
 
+/// Estimates the background density of the event
+/// \param inputParticles vector of input particles/tracks
+/// \param rho pt density, 0 without estimator
+/// \param rhoM mass density, 0 if not provided by the estimator
+void JetFinder::estimateRho(std::vector<fastjet::PseudoJet> const& inputParticles, double& rho, double& rhoM)
+{
+  setParams();
+  setBkgE();
+  rho = 0.;
+  rhoM = 0.;
+  if (!bkgE) {
+    return;
+  }
+  bkgE->set_particles(inputParticles);
+  rho = bkgE->rho();
+  rhoM = bkgE->has_rho_m() ? bkgE->rho_m() : 0.;
+}
+
 /// Performs jet finding
 /// \note the input particle and jet lists are passed by reference
 /// \param inputParticles vector of input particles/tracks
@@ -76,9 +97,28 @@ void JetFinder::setSub()
 fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets) //ideally find a way of passing the cluster sequence as a reeference
 {
   setParams();
-  setBkgE();
+  if (useExternalRho && (bkgSubMode == BkgSubMode::rhoAreaSub || bkgSubMode == BkgSubMode::rhoGridAreaSub)) {
+    bkgE.reset();
+    setSub();
+  } else {
+    setBkgE();
+  }
   jets.clear();
 
+  if (autoStrategy) {
+    // the ghosts are clustered together with the inputs, so they count for the choice of the strategy
+    auto nParticles = inputParticles.size() + ghostAreaSpec.n_ghosts();
+    jetDef = fastjet::JetDefinition(algorithm, jetR, recombScheme, static_cast<int>(nParticles) > nParticlesTiledMax ? fastjet::N2MinHeapTiled : fastjet::N2Tiled);
+  }
+  if (fixedGhosts) {
+    // the ghosts of the background estimation and of the jet finding are generated from the same random status in every call
+    if (ghostRandomStatus.empty()) {
+      ghostAreaSpec.get_random_status(ghostRandomStatus);
+    } else {
+      ghostAreaSpec.set_random_status(ghostRandomStatus);
+    }
+  }
+
   if (bkgE) {
     bkgE->set_particles(inputParticles);
     setSub();
@@ -91,3 +131,30 @@ fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>
   jets = selJets(jets);
   return clusterSeq;
 }
+
+/// Declusters a jet along the harder branch
+/// \param constituents constituents of the jet
+/// \param splittings splittings to be filled, starting from the widest one
+void JetFinder::findSplittings(std::vector<fastjet::PseudoJet> const& constituents, std::vector<Splitting>& splittings)
+{
+  splittings.clear();
+  if (constituents.empty()) {
+    return;
+  }
+  // no ghosts are needed for the history, and the maximum R makes sure that all the constituents end up in one jet
+  fastjet::ClusterSequence reclusterSeq(constituents, fastjet::JetDefinition(fastjet::cambridge_algorithm, fastjet::JetDefinition::max_allowable_R));
+  auto reclustered = sorted_by_pt(reclusterSeq.inclusive_jets());
+  fastjet::PseudoJet daughterSubJet = reclustered[0];
+  fastjet::PseudoJet parentSubJet1;
+  fastjet::PseudoJet parentSubJet2;
+  while (daughterSubJet.has_parents(parentSubJet1, parentSubJet2)) {
+    if (parentSubJet1.perp() < parentSubJet2.perp()) {
+      std::swap(parentSubJet1, parentSubJet2);
+    }
+    auto deltaR = parentSubJet1.delta_R(parentSubJet2);
+    splittings.push_back({static_cast<float>(parentSubJet2.perp() / (parentSubJet1.perp() + parentSubJet2.perp())),
+                          static_cast<float>(deltaR),
+                          static_cast<float>(parentSubJet2.perp() * deltaR)});
+    daughterSubJet = parentSubJet1;
+  }
+}
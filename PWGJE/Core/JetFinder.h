@@ -25,6 +25,7 @@
 #include "fastjet/AreaDefinition.hh"
 #include "fastjet/JetDefinition.hh"
 #include "fastjet/tools/JetMedianBackgroundEstimator.hh"
+#include "fastjet/tools/GridMedianBackgroundEstimator.hh"
 #include "fastjet/tools/Subtractor.hh"
 #include "fastjet/contrib/ConstituentSubtractor.hh"
 
@@ -36,11 +37,27 @@ class JetFinder
  public:
   enum class BkgSubMode { none,
                           rhoAreaSub,
-                          constSub };
+                          constSub,
+                          rhoGridAreaSub };
   BkgSubMode bkgSubMode;
 
   void setBkgSubMode(BkgSubMode bSM) { bkgSubMode = bSM; }
 
+  /// One splitting of the declustering of a jet
+  struct Splitting {
+    float z;      ///< pt fraction of the softer prong
+    float deltaR; ///< distance between the prongs
+    float kt;     ///< pt of the softer prong times the distance
+  };
+
+  /// Sets the rho used by the area subtraction instead of estimating it in findJets, e.g. the rho of the JetRhos table
+  void setExternalRho(double rho)
+  {
+    externalRho = rho;
+    useExternalRho = true;
+  }
+  void clearExternalRho() { useExternalRho = false; }
+
   /// Performs jet finding
   /// \note the input particle and jet lists are passed by reference
   /// \param inputParticles vector of input particles/tracks
@@ -76,12 +93,17 @@ class JetFinder
   float bkgPhiMax;
   float bkgEtaMin;
   float bkgEtaMax;
+  float bkgGridSize; ///< size in eta and phi of the patches of the grid-median estimator
 
   float constSubAlpha;
   float constSubRMax;
 
   bool isReclustering;
 
+  bool fixedGhosts;       ///< the same ghosts are generated in every call of findJets, i.e. in every event
+  bool autoStrategy;      ///< the clustering strategy is chosen from the number of particles (inputs and ghosts)
+  int nParticlesTiledMax; ///< with autoStrategy, N2Tiled is used up to this number of particles and N2MinHeapTiled above
+
   fastjet::JetAlgorithm algorithm;
   fastjet::RecombinationScheme recombScheme;
   fastjet::Strategy strategy;
@@ -125,9 +147,13 @@ class JetFinder
                                                                                                         bkgPhiMax(phi_Max),
                                                                                                         bkgEtaMin(eta_Min),
                                                                                                         bkgEtaMax(eta_Max),
+                                                                                                        bkgGridSize(0.5),
                                                                                                         constSubAlpha(1.0),
                                                                                                         constSubRMax(0.6),
                                                                                                         isReclustering(false),
+                                                                                                        fixedGhosts(false),
+                                                                                                        autoStrategy(false),
+                                                                                                        nParticlesTiledMax(30000),
                                                                                                         algorithm(fastjet::antikt_algorithm),
                                                                                                         recombScheme(fastjet::E_scheme),
                                                                                                         strategy(fastjet::Best),
@@ -154,6 +180,12 @@ class JetFinder
   /// Sets the background subtraction pointer
   void setSub();
 
+  /// Estimates the background density of the event with the estimator of bkgSubMode
+  /// \param inputParticles vector of input particles/tracks
+  /// \param rho pt density, 0 without estimator
+  /// \param rhoM mass density, 0 if not provided by the estimator
+  void estimateRho(std::vector<fastjet::PseudoJet> const& inputParticles, double& rho, double& rhoM);
+
   /// Performs jet finding
   /// \note the input particle and jet lists are passed by reference
   /// \param inputParticles vector of input particles/tracks
@@ -161,14 +193,22 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Declusters a jet along the harder branch, after reclustering its constituents with Cambridge/Aachen
+  /// \param constituents constituents of the jet
+  /// \param splittings splittings to be filled, starting from the widest one
+  static void findSplittings(std::vector<fastjet::PseudoJet> const& constituents, std::vector<Splitting>& splittings);
+
  private:
   // void setParams();
   // void setBkgSub();
   std::unique_ptr<fastjet::BackgroundEstimatorBase> bkgE;
   std::unique_ptr<fastjet::Subtractor> sub;
   std::unique_ptr<fastjet::contrib::ConstituentSubtractor> constituentSub;
+  std::vector<int> ghostRandomStatus; ///< status of the ghost random generator at the first call, used with fixedGhosts
+  bool useExternalRho = false;        ///< the area subtraction uses externalRho
+  double externalRho = 0.;
 
-  ClassDefNV(JetFinder, 1);
+  ClassDefNV(JetFinder, 3);
 };
 
 // does this belong here?
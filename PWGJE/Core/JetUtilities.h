@@ -17,9 +17,11 @@
 #ifndef O2_ANALYSIS_JETUTILITIES_H
 #define O2_ANALYSIS_JETUTILITIES_H
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -122,7 +124,7 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyImpl(
   const std::size_t nJetsBase = jetsBaseEta.size();
   const std::size_t nJetsTag = jetsTagEta.size();
   if (!(nJetsBase && nJetsTag)) {
-    return std::make_tuple(std::vector<int>(nJetsBase), std::vector<int>(nJetsTag));
+    return std::make_tuple(std::vector<int>(nJetsBase, -1), std::vector<int>(nJetsTag, -1));
   }
   // Require that the comparison vectors are greater than or equal to the standard collections.
   if (jetsBasePhiForMatching.size() < jetsBasePhi.size()) {
@@ -223,6 +225,147 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyImpl(
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
 
+/**
+ * Scratch buffers of MatchJetsGeometricallySorted.
+ *
+ * Kept by the caller between events, so that the matching does not allocate once the buffers have grown.
+ */
+template <typename T>
+struct GeometricMatchingBuffers {
+  std::vector<T> basePhi, baseEta, tagPhi, tagEta; // jets sorted by phi
+  std::vector<int> baseIndex, tagIndex;            // index in the input collection of the sorted jets
+  std::vector<int> closestTag, closestBase;        // closest jet in the other collection, -1 if none within the matching distance
+};
+
+/**
+ * Sorts a jet collection by phi.
+ *
+ * @param jetsPhi Jets phi
+ * @param jetsEta Jets eta
+ * @param sortedPhi Output, phi of the sorted jets
+ * @param sortedEta Output, eta of the sorted jets
+ * @param sortedIndex Output, index in the input collection of the sorted jets
+ */
+template <typename T>
+void SortJetsByPhi(const std::vector<T>& jetsPhi, const std::vector<T>& jetsEta, std::vector<T>& sortedPhi, std::vector<T>& sortedEta, std::vector<int>& sortedIndex)
+{
+  const std::size_t nJets = jetsPhi.size();
+  sortedIndex.resize(nJets);
+  std::iota(sortedIndex.begin(), sortedIndex.end(), 0);
+  std::sort(sortedIndex.begin(), sortedIndex.end(), [&jetsPhi](int a, int b) { return jetsPhi[a] < jetsPhi[b]; });
+  sortedPhi.resize(nJets);
+  sortedEta.resize(nJets);
+  for (std::size_t i = 0; i < nJets; i++) {
+    sortedPhi[i] = jetsPhi[sortedIndex[i]];
+    sortedEta[i] = jetsEta[sortedIndex[i]];
+  }
+}
+
+/**
+ * Finds the closest jet in (eta, phi) among jets sorted by phi.
+ *
+ * Only the jets in the phi window of the matching distance are checked, including the ones across the phi boundary.
+ *
+ * NOTE: Assumes, but does not validate, that 0 <= phi < 2pi.
+ *
+ * @returns Index in the input collection of the closest jet, -1 if there is no jet within the matching distance.
+ */
+template <typename T>
+int FindClosestJet(T eta, T phi, const std::vector<T>& sortedPhi, const std::vector<T>& sortedEta, const std::vector<int>& sortedIndex, double maxMatchingDistance)
+{
+  int closest = -1;
+  double closestDistance = maxMatchingDistance;
+  // jets with phi in [phiLow, phiHigh], shifted by phiShift to be compared to the phi of the jet
+  auto findInWindow = [&](double phiLow, double phiHigh, double phiShift) {
+    const auto first = std::lower_bound(sortedPhi.begin(), sortedPhi.end(), phiLow);
+    const auto last = std::upper_bound(first, sortedPhi.end(), phiHigh);
+    for (auto it = first; it != last; ++it) {
+      const std::size_t k = it - sortedPhi.begin();
+      const double dEta = eta - sortedEta[k];
+      const double dPhi = phi - (sortedPhi[k] + phiShift);
+      const double distance = std::sqrt(dEta * dEta + dPhi * dPhi);
+      if (distance < closestDistance) {
+        closestDistance = distance;
+        closest = sortedIndex[k];
+      }
+    }
+  };
+  findInWindow(phi - maxMatchingDistance, phi + maxMatchingDistance, 0.);
+  if (phi - maxMatchingDistance < 0.) {
+    findInWindow(phi - maxMatchingDistance + 2 * M_PI, 2 * M_PI, -2 * M_PI);
+  }
+  if (phi + maxMatchingDistance >= 2 * M_PI) {
+    findInWindow(0., phi + maxMatchingDistance - 2 * M_PI, 2 * M_PI);
+  }
+  return closest;
+}
+
+/**
+ * Geometrical jet matching with a sweep over the jets sorted by phi.
+ *
+ * Same matching as MatchJetsGeometrically: jets are matched within the provided matching distance and
+ * are required to match uniquely (base <-> tag). Each collection is sorted by phi once, and each jet only
+ * checks the jets of the other collection in its phi window, so that no jets need to be duplicated around
+ * the phi boundary. Apart from the growth of the buffers, nothing is allocated.
+ *
+ * NOTE: Assumes, but does not validate, that 0 <= phi < 2pi.
+ *
+ * @param jetsBasePhi Base jet collection phi.
+ * @param jetsBaseEta Base jet collection eta.
+ * @param jetsTagPhi Tag jet collection phi.
+ * @param jetsTagEta Tag jet collection eta.
+ * @param maxMatchingDistance Maximum matching distance.
+ * @param buffers Scratch buffers, kept by the caller between calls.
+ * @param baseToTagMap Output, index of the matched tag jet for each base jet, -1 if none.
+ * @param tagToBaseMap Output, index of the matched base jet for each tag jet, -1 if none.
+ */
+template <typename T>
+void MatchJetsGeometricallySorted(
+  const std::vector<T>& jetsBasePhi,
+  const std::vector<T>& jetsBaseEta,
+  const std::vector<T>& jetsTagPhi,
+  const std::vector<T>& jetsTagEta,
+  double maxMatchingDistance,
+  GeometricMatchingBuffers<T>& buffers,
+  std::vector<int>& baseToTagMap,
+  std::vector<int>& tagToBaseMap)
+{
+  const std::size_t nJetsBase = jetsBaseEta.size();
+  const std::size_t nJetsTag = jetsTagEta.size();
+  baseToTagMap.assign(nJetsBase, -1);
+  tagToBaseMap.assign(nJetsTag, -1);
+  if (!(nJetsBase && nJetsTag)) {
+    return;
+  }
+  if (jetsBasePhi.size() != jetsBaseEta.size()) {
+    throw std::invalid_argument("Base collection eta and phi sizes don't match. Check the inputs.");
+  }
+  if (jetsTagPhi.size() != jetsTagEta.size()) {
+    throw std::invalid_argument("Tag collection eta and phi sizes don't match. Check the inputs.");
+  }
+
+  SortJetsByPhi(jetsBasePhi, jetsBaseEta, buffers.basePhi, buffers.baseEta, buffers.baseIndex);
+  SortJetsByPhi(jetsTagPhi, jetsTagEta, buffers.tagPhi, buffers.tagEta, buffers.tagIndex);
+
+  buffers.closestTag.resize(nJetsBase);
+  for (std::size_t iBase = 0; iBase < nJetsBase; iBase++) {
+    buffers.closestTag[iBase] = FindClosestJet(jetsBaseEta[iBase], jetsBasePhi[iBase], buffers.tagPhi, buffers.tagEta, buffers.tagIndex, maxMatchingDistance);
+  }
+  buffers.closestBase.resize(nJetsTag);
+  for (std::size_t iTag = 0; iTag < nJetsTag; iTag++) {
+    buffers.closestBase[iTag] = FindClosestJet(jetsTagEta[iTag], jetsTagPhi[iTag], buffers.basePhi, buffers.baseEta, buffers.baseIndex, maxMatchingDistance);
+  }
+
+  // true matches: the base jet is the closest to the tag jet and vice versa
+  for (std::size_t iBase = 0; iBase < nJetsBase; iBase++) {
+    const int iTag = buffers.closestTag[iBase];
+    if (iTag > -1 && buffers.closestBase[iTag] == static_cast<int>(iBase)) {
+      baseToTagMap[iBase] = iTag;
+      tagToBaseMap[iTag] = iBase;
+    }
+  }
+}
+
 /**
  * Geometrical jet matching.
  *
@@ -253,7 +396,7 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
   const std::size_t nJetsTag = jetsTagEta.size();
   if (!(nJetsBase && nJetsTag)) {
     // There are no jets, so nothing to be done.
-    return std::make_tuple(std::vector<int>(nJetsBase), std::vector<int>(nJetsTag));
+    return std::make_tuple(std::vector<int>(nJetsBase, -1), std::vector<int>(nJetsTag, -1));
   }
   // Input sizes must match
   if (jetsBasePhi.size() != jetsBaseEta.size()) {
@@ -263,17 +406,11 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
     throw std::invalid_argument("Tag collection eta and phi sizes don't match. Check the inputs.");
   }
 
-  // To perform matching with periodic boundary conditions (ie. phi) with a KDTree, we need
-  // to duplicate data up to maxMatchingDistance in phi because phi is periodic.
-  // NOTE: vectors are modified in place to avoid copies.
-  auto&& [jetMapBaseToJetIndex, jetsBasePhiComparison, jetsBaseEtaComparison] = DuplicateJetsAroundPhiBoundary(jetsBasePhi, jetsBaseEta, maxMatchingDistance);
-  auto&& [jetMapTagToJetIndex, jetsTagPhiComparison, jetsTagEtaComparison] = DuplicateJetsAroundPhiBoundary(jetsTagPhi, jetsTagEta, maxMatchingDistance);
-
-  // Finally, perform the actual matching.
-  auto&& [baseToTagMap, tagToBaseMap] = MatchJetsGeometricallyImpl(
-    jetsBasePhi, jetsBaseEta, jetsBasePhiComparison, jetsBaseEtaComparison, jetMapBaseToJetIndex,
-    jetsTagPhi, jetsTagEta, jetsTagPhiComparison, jetsTagEtaComparison, jetMapTagToJetIndex,
-    maxMatchingDistance);
+  // The jets are matched with the sweep over phi, the k-d tree implementation (MatchJetsGeometricallyImpl) is kept
+  // for the callers providing their own duplicated jets.
+  GeometricMatchingBuffers<T> buffers;
+  std::vector<int> baseToTagMap, tagToBaseMap;
+  MatchJetsGeometricallySorted(jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta, maxMatchingDistance, buffers, baseToTagMap, tagToBaseMap);
 
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
@@ -383,6 +520,106 @@ std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchCl
   }
   return std::make_tuple(matchIndexTrack, matchIndexCluster);
 }
+
+/**
+ * Match clusters to tracks using a grid in (eta, phi).
+ *
+ * Same cluster to track matching as MatchClustersAndTracks, i.e. the maxNumberMatches closest tracks
+ * in dR < maxMatchingDistance ordered by distance, without the track to cluster map.
+ * The tracks are sorted into a grid with cells of at least maxMatchingDistance, so that only the tracks
+ * in the cell of the cluster and in the neighbouring cells are checked.
+ *
+ * @param clusterPhi cluster collection phi.
+ * @param clusterEta cluster collection eta.
+ * @param trackPhi track collection phi.
+ * @param trackEta track collection eta.
+ * @param maxMatchingDistance Maximum matching distance.
+ * @param maxNumberMatches Maximum number of matches (e.g. 5 closest).
+ *
+ * @returns cluster to track index map
+ */
+template <typename T>
+std::vector<std::vector<int>> MatchClustersToTracksInGrid(
+  const std::vector<T>& clusterPhi,
+  const std::vector<T>& clusterEta,
+  const std::vector<T>& trackPhi,
+  const std::vector<T>& trackEta,
+  double maxMatchingDistance,
+  int maxNumberMatches)
+{
+  const std::size_t nClusters = clusterEta.size();
+  const std::size_t nTracks = trackEta.size();
+  std::vector<std::vector<int>> matchIndexTrack(nClusters, std::vector<int>(maxNumberMatches, -1));
+  if (!(nClusters && nTracks) || maxMatchingDistance <= 0) {
+    return matchIndexTrack;
+  }
+  if (clusterPhi.size() != clusterEta.size()) {
+    throw std::invalid_argument("cluster collection eta and phi sizes don't match. Check the inputs.");
+  }
+  if (trackPhi.size() != trackEta.size()) {
+    throw std::invalid_argument("track collection eta and phi sizes don't match. Check the inputs.");
+  }
+
+  // Grid over the range of the tracks
+  const auto [etaMin, etaMax] = std::minmax_element(trackEta.begin(), trackEta.end());
+  const auto [phiMin, phiMax] = std::minmax_element(trackPhi.begin(), trackPhi.end());
+  const int maxNCells = 1000000;
+  double cellSize = maxMatchingDistance;
+  int nEta = 0, nPhi = 0;
+  do {
+    nEta = static_cast<int>((*etaMax - *etaMin) / cellSize) + 1;
+    nPhi = static_cast<int>((*phiMax - *phiMin) / cellSize) + 1;
+    cellSize *= 2;
+  } while (static_cast<int64_t>(nEta) * nPhi > maxNCells);
+  cellSize /= 2;
+  auto cellOf = [&](T eta, T phi, int& iEta, int& iPhi) {
+    iEta = static_cast<int>(std::floor((eta - *etaMin) / cellSize));
+    iPhi = static_cast<int>(std::floor((phi - *phiMin) / cellSize));
+  };
+
+  // Tracks sorted by cell (counting sort), the tracks of cell c are cellTracks[cellStart[c], cellStart[c + 1])
+  std::vector<int> cellStart(nEta * nPhi + 1, 0);
+  std::vector<int> trackCell(nTracks);
+  for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+    int iEta, iPhi;
+    cellOf(trackEta[iTrack], trackPhi[iTrack], iEta, iPhi);
+    trackCell[iTrack] = std::min(iEta, nEta - 1) * nPhi + std::min(iPhi, nPhi - 1);
+    cellStart[trackCell[iTrack] + 1]++;
+  }
+  std::partial_sum(cellStart.begin(), cellStart.end(), cellStart.begin());
+  std::vector<int> cellTracks(nTracks);
+  std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+  for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+    cellTracks[fill[trackCell[iTrack]]++] = iTrack;
+  }
+
+  std::vector<std::pair<T, int>> candidates;
+  for (std::size_t iCluster = 0; iCluster < nClusters; iCluster++) {
+    candidates.clear();
+    int iEta, iPhi;
+    cellOf(clusterEta[iCluster], clusterPhi[iCluster], iEta, iPhi);
+    for (int jEta = std::max(iEta - 1, 0); jEta <= std::min(iEta + 1, nEta - 1); jEta++) {
+      for (int jPhi = std::max(iPhi - 1, 0); jPhi <= std::min(iPhi + 1, nPhi - 1); jPhi++) {
+        const int cell = jEta * nPhi + jPhi;
+        for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+          const int iTrack = cellTracks[k];
+          const T dEta = clusterEta[iCluster] - trackEta[iTrack];
+          const T dPhi = clusterPhi[iCluster] - trackPhi[iTrack];
+          const T distance = std::sqrt(dEta * dEta + dPhi * dPhi);
+          if (distance < maxMatchingDistance) {
+            candidates.emplace_back(distance, iTrack);
+          }
+        }
+      }
+    }
+    const std::size_t nMatches = std::min<std::size_t>(candidates.size(), maxNumberMatches);
+    std::partial_sort(candidates.begin(), candidates.begin() + nMatches, candidates.end());
+    for (std::size_t m = 0; m < nMatches; m++) {
+      matchIndexTrack[iCluster][m] = candidates[m].second;
+    }
+  }
+  return matchIndexTrack;
+}
 }; // namespace JetUtilities
 
 #endif
@@ -105,6 +105,31 @@
                     constituentssub::Pz<constituentssub::Pt, constituentssub::Eta>, \
                     constituentssub::P<constituentssub::Pt, constituentssub::Eta>);
 
+// Defines the jet splittings table: the Cambridge/Aachen declustering of the jet along the harder branch,
+// one row per splitting, starting from the widest one.
+// NOTE: This also relies on the jet index column of the constituents namespace.
+#define JET_SPLITTINGS_TABLE_DEF(_jet_type_, _name_, _Description_)     \
+  DECLARE_SOA_TABLE(_jet_type_##Splittings, "AOD", _Description_ "SPLIT", \
+                    _name_##constituents::_jet_type_##Id,               \
+                    jetsplitting::Z,                                    \
+                    jetsplitting::DeltaR,                               \
+                    jetsplitting::Kt);
+
+// Defines the packed constituents table: the kinematics of the constituents copied per jet, sorted by decreasing pt,
+// so that the jet tasks read them contiguously instead of dereferencing the tracks of the constituent indices.
+// NOTE: This also relies on the jet index column of the constituents namespace.
+#define JET_PACKED_CONSTITUENTS_TABLE_DEF(_jet_type_, _name_, _Description_)                 \
+  DECLARE_SOA_TABLE(_jet_type_##PackedConstituents, "AOD", _Description_ "PACKED",           \
+                    _name_##constituents::_jet_type_##Id,                                    \
+                    packedconstituents::Pt,                                                  \
+                    packedconstituents::Eta,                                                 \
+                    packedconstituents::Phi,                                                 \
+                    packedconstituents::Charge,                                              \
+                    packedconstituents::Px<packedconstituents::Pt, packedconstituents::Phi>, \
+                    packedconstituents::Py<packedconstituents::Pt, packedconstituents::Phi>, \
+                    packedconstituents::Pz<packedconstituents::Pt, packedconstituents::Eta>, \
+                    packedconstituents::P<packedconstituents::Pt, packedconstituents::Eta>);
+
 namespace o2::aod
 {
 namespace jet
@@ -150,6 +175,33 @@ DECLARE_SOA_DYNAMIC_COLUMN(P, p,
                            [](float pt, float eta) -> float { return pt * std::cosh(eta); });
 } // namespace constituentssub
 
+// Packed constituents
+namespace packedconstituents
+{
+// Jet index column will be added in the macro
+DECLARE_SOA_COLUMN(Pt, pt, float);          //!
+DECLARE_SOA_COLUMN(Eta, eta, float);        //!
+DECLARE_SOA_COLUMN(Phi, phi, float);        //!
+DECLARE_SOA_COLUMN(Charge, charge, int8_t); //! 0 for the clusters and the neutral particles
+DECLARE_SOA_DYNAMIC_COLUMN(Px, px,
+                           [](float pt, float phi) -> float { return pt * std::cos(phi); });
+DECLARE_SOA_DYNAMIC_COLUMN(Py, py,
+                           [](float pt, float phi) -> float { return pt * std::sin(phi); });
+DECLARE_SOA_DYNAMIC_COLUMN(Pz, pz,
+                           [](float pt, float eta) -> float { return pt * std::sinh(eta); });
+DECLARE_SOA_DYNAMIC_COLUMN(P, p,
+                           [](float pt, float eta) -> float { return pt * std::cosh(eta); });
+} // namespace packedconstituents
+
+// Jet splittings
+namespace jetsplitting
+{
+// Jet index column will be added in the macro
+DECLARE_SOA_COLUMN(Z, z, float);           //! pt fraction of the softer prong
+DECLARE_SOA_COLUMN(DeltaR, deltaR, float); //! distance between the prongs
+DECLARE_SOA_COLUMN(Kt, kt, float);         //! pt of the softer prong times the distance
+} // namespace jetsplitting
+
 // Data jets
 // As an example, the expanded macros which are used to define the table is shown below.
 // It represents that state of the table as of June 2021.
@@ -238,6 +290,10 @@ using JetTrackConstituent = JetTrackConstituents::iterator;
 using JetClusterConstituent = JetClusterConstituents::iterator;
 JET_CONSTITUENTS_SUB_TABLE_DEF(Jet, jet, "JET");
 using JetConstituentSub = JetConstituentsSub::iterator;
+JET_SPLITTINGS_TABLE_DEF(Jet, jet, "JET");
+using JetSplitting = JetSplittings::iterator;
+JET_PACKED_CONSTITUENTS_TABLE_DEF(Jet, jet, "JET");
+using JetPackedConstituent = JetPackedConstituents::iterator;
 
 // MC Particle Level Jets
 // NOTE: Cluster constituents aren't really meaningful for particle level.
@@ -255,6 +311,10 @@ using MCParticleLevelJetTrackConstituent = MCParticleLevelJetTrackConstituents::
 using MCParticleLevelJetClusterConstituent = MCParticleLevelJetClusterConstituents::iterator;
 JET_CONSTITUENTS_SUB_TABLE_DEF(MCParticleLevelJet, mcparticleleveljet, "MCP");
 using MCParticleLevelJetConstituentSub = MCParticleLevelJetConstituentsSub::iterator;
+JET_SPLITTINGS_TABLE_DEF(MCParticleLevelJet, mcparticleleveljet, "MCP");
+using MCParticleLevelJetSplitting = MCParticleLevelJetSplittings::iterator;
+JET_PACKED_CONSTITUENTS_TABLE_DEF(MCParticleLevelJet, mcparticleleveljet, "MCP");
+using MCParticleLevelJetPackedConstituent = MCParticleLevelJetPackedConstituents::iterator;
 
 // MC Detector Level Jets
 // NOTE: The same condition as describe for particle leve jets also applies here
@@ -267,6 +327,10 @@ using MCDetectorLevelJetTrackConstituent = MCDetectorLevelJetTrackConstituents::
 using MCDetectorLevelJetClusterConstituent = MCDetectorLevelJetClusterConstituents::iterator;
 JET_CONSTITUENTS_SUB_TABLE_DEF(MCDetectorLevelJet, mcdetectorleveljet, "MCD");
 using MCDetectorLevelJetConstituentSub = MCDetectorLevelJetConstituentsSub::iterator;
+JET_SPLITTINGS_TABLE_DEF(MCDetectorLevelJet, mcdetectorleveljet, "MCD");
+using MCDetectorLevelJetSplitting = MCDetectorLevelJetSplittings::iterator;
+JET_PACKED_CONSTITUENTS_TABLE_DEF(MCDetectorLevelJet, mcdetectorleveljet, "MCD");
+using MCDetectorLevelJetPackedConstituent = MCDetectorLevelJetPackedConstituents::iterator;
 
 // Hybrid intermediate
 JET_TABLE_DEF(Collision, HybridIntermediateJet, hybridintermediatejet, "JETHYBINT");
@@ -277,6 +341,10 @@ using HybridIntermediateJetTrackConstituent = HybridIntermediateJetTrackConstitu
 using HybridIntermediateJetClusterConstituent = HybridIntermediateJetClusterConstituents::iterator;
 JET_CONSTITUENTS_SUB_TABLE_DEF(HybridIntermediateJet, hybridintermediate, "HYBINT");
 using HybridIntermediateJetConstituentSub = HybridIntermediateJetConstituentsSub::iterator;
+JET_SPLITTINGS_TABLE_DEF(HybridIntermediateJet, hybridintermediate, "HYBINT");
+using HybridIntermediateJetSplitting = HybridIntermediateJetSplittings::iterator;
+JET_PACKED_CONSTITUENTS_TABLE_DEF(HybridIntermediateJet, hybridintermediate, "HYBINT");
+using HybridIntermediateJetPackedConstituent = HybridIntermediateJetPackedConstituents::iterator;
 
 // HF jets
 JET_TABLE_DEF(Collision, HFJet, hfjet, "HFJET");
@@ -305,6 +373,16 @@ using MCDetectorLevelHFJetConstituent = MCDetectorLevelHFJetConstituents::iterat
 JET_CONSTITUENTS_SUB_TABLE_DEF(MCDetectorLevelHFJet, mcdetectorlevelhfjet, "HFMCD");
 using MCDetectorLevelHFJetConstituentSub = MCDetectorLevelHFJetConstituentsSub::iterator;
 
+// Background density of the collisions, one row per collision so that it can be joined with the Collisions table
+namespace jetrho
+{
+DECLARE_SOA_COLUMN(Rho, rho, float);   //! pt density (GeV/c per unit area)
+DECLARE_SOA_COLUMN(RhoM, rhoM, float); //! mass density (GeV/c^2 per unit area)
+} // namespace jetrho
+DECLARE_SOA_TABLE(JetRhos, "AOD", "JETRHO", //!
+                  jetrho::Rho, jetrho::RhoM);
+using JetRho = JetRhos::iterator;
+
 namespace mcdetectorlevelhfjetmatching2
 {
 DECLARE_SOA_INDEX_COLUMN(MCDetectorLevelHFJet, matchedJet);
@@ -15,6 +15,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 #include "CCDB/BasicCCDBManager.h"
 #include "Framework/runDataProcessing.h"
@@ -52,6 +54,7 @@ struct EmcalCorrectionTask {
   Configurable<int> selectedCellType{"selectedCellType", 1, "EMCAL Cell type"};
   Configurable<std::string> clusterDefinitions{"clusterDefinition", "kV3Default", "cluster definition to be selected, e.g. V3Default. Multiple definitions can be specified separated by comma"};
   Configurable<float> maxMatchingDistance{"maxMatchingDistance", 0.4f, "Max matching distance track-cluster"};
+  Configurable<bool> parallelClusterDefinitions{"parallelClusterDefinitions", false, "Run the clusterizers of the different cluster definitions in parallel threads"};
 
   // CDB service (for geometry)
   Service<o2::ccdb::BasicCCDBManager> mCcdbManager;
@@ -61,11 +64,26 @@ struct EmcalCorrectionTask {
   // So we use unique_ptr and define them below.
   std::vector<std::unique_ptr<o2::emcal::Clusterizer<o2::emcal::Cell>>> mClusterizers;
   std::vector<std::unique_ptr<o2::emcal::ClusterFactory<o2::emcal::Cell>>> mClusterFactories;
-  // Cells and clusters
+  // Cells and clusters, the buffers are kept across BCs
   std::vector<o2::emcal::Cell> mEmcalCells;
-  // map of cellId (local in BC) to global cell index in cell table in AO2D
-  std::map<int, int64_t> mCellIdToCellGlobalIndex;
-  std::vector<o2::emcal::AnalysisCluster> mAnalysisClusters;
+  // cellId (local in BC) to global cell index in cell table in AO2D
+  std::vector<int64_t> mCellIdToCellGlobalIndex;
+  // analysis clusters of each cluster definition
+  std::vector<std::vector<o2::emcal::AnalysisCluster>> mAnalysisClusters;
+
+  // Position of each tower, computed once from the geometry
+  struct TowerPosition {
+    double eta;
+    double phi; // in [0, 2pi)
+    int row;
+    int col;
+  };
+  std::vector<TowerPosition> mTowerPositions;
+
+  // Positions of the tracks of the collision for the cluster-track matching, shared by the cluster definitions
+  std::vector<double> mTrackPhi;
+  std::vector<double> mTrackEta;
+  std::vector<int64_t> mTrackGlobalIndex;
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
   // QA
@@ -126,6 +144,17 @@ struct EmcalCorrectionTask {
     if (mClusterizers.size() == 0) {
       LOG(error) << "No cluster definitions specified!";
     }
+    mAnalysisClusters.resize(mClusterizers.size());
+
+    // Tower positions for the cell QA
+    if (geometry) {
+      mTowerPositions.resize(geometry->GetNCells());
+      for (int tower = 0; tower < geometry->GetNCells(); tower++) {
+        auto etaPhi = geometry->EtaPhiFromIndex(tower);
+        auto rowCol = geometry->GlobalRowColFromIndex(tower);
+        mTowerPositions[tower] = {std::get<0>(etaPhi), TVector2::Phi_0_2pi(std::get<1>(etaPhi)), std::get<0>(rowCol), std::get<1>(rowCol)};
+      }
+    }
 
     LOG(debug) << "Completed init!";
 
@@ -151,6 +180,8 @@ struct EmcalCorrectionTask {
     // In particular, we need to filter only EMCAL cells.
     mEmcalCells.clear();
     mCellIdToCellGlobalIndex.clear();
+    mEmcalCells.reserve(cells.size());
+    mCellIdToCellGlobalIndex.reserve(cells.size());
     int c = 0;
     for (auto& cell : cells) {
       if (cell.caloType() != selectedCellType) {
@@ -164,22 +195,29 @@ struct EmcalCorrectionTask {
         cell.amplitude(),
         cell.time(),
         o2::emcal::intToChannelType(cell.cellType())));
-      mCellIdToCellGlobalIndex.insert(std::make_pair(c, cell.globalIndex()));
+      mCellIdToCellGlobalIndex.push_back(cell.globalIndex());
       LOG(debug) << "Creating map " << c << " -> " << cell.globalIndex();
       c++;
     }
     LOG(debug) << "Number of cells (CF): " << mEmcalCells.size();
 
     // Cell QA
-    // For convenience, use the clusterizer stored geometry to get the eta-phi
     for (auto& cell : mEmcalCells) {
       hCellE->Fill(cell.getEnergy());
       hCellTowerID->Fill(cell.getTower());
-      auto res = mClusterizers.at(0)->getGeometry()->EtaPhiFromIndex(cell.getTower());
-      hCellEtaPhi->Fill(std::get<0>(res), TVector2::Phi_0_2pi(std::get<1>(res)));
-      res = mClusterizers.at(0)->getGeometry()->GlobalRowColFromIndex(cell.getTower());
-      // NOTE: Reversed column and row because it's more natural for presentation.
-      hCellRowCol->Fill(std::get<1>(res), std::get<0>(res));
+      if (cell.getTower() >= 0 && cell.getTower() < static_cast<int>(mTowerPositions.size())) {
+        const auto& tower = mTowerPositions[cell.getTower()];
+        hCellEtaPhi->Fill(tower.eta, tower.phi);
+        // NOTE: Reversed column and row because it's more natural for presentation.
+        hCellRowCol->Fill(tower.col, tower.row);
+      } else {
+        // For convenience, use the clusterizer stored geometry to get the eta-phi
+        auto res = mClusterizers.at(0)->getGeometry()->EtaPhiFromIndex(cell.getTower());
+        hCellEtaPhi->Fill(std::get<0>(res), TVector2::Phi_0_2pi(std::get<1>(res)));
+        res = mClusterizers.at(0)->getGeometry()->GlobalRowColFromIndex(cell.getTower());
+        // NOTE: Reversed column and row because it's more natural for presentation.
+        hCellRowCol->Fill(std::get<1>(res), std::get<0>(res));
+      }
     }
 
     // TODO: Helpful for now, but should be removed.
@@ -192,8 +230,9 @@ struct EmcalCorrectionTask {
     // this is a test
     // Run the clusterizers
     LOG(debug) << "Running clusterizers";
-    Int_t i = 0;
-    for (auto& clusterizer : mClusterizers) {
+    // The cluster definitions are independent: each one has its own clusterizer, cluster factory and output clusters
+    auto runClusterizer = [this](size_t i) {
+      auto& clusterizer = mClusterizers[i];
       clusterizer->findClusters(mEmcalCells);
 
       auto emcalClusters = clusterizer->getFoundClusters();
@@ -202,7 +241,7 @@ struct EmcalCorrectionTask {
 
       // Convert to analysis clusters.
       // First, the cluster factory requires cluster and cell information in order to build the clusters.
-      mAnalysisClusters.clear();
+      mAnalysisClusters[i].clear();
       mClusterFactories.at(i)->reset();
       mClusterFactories.at(i)->setClustersContainer(*emcalClusters);
       mClusterFactories.at(i)->setCellsContainer(mEmcalCells);
@@ -212,10 +251,48 @@ struct EmcalCorrectionTask {
       // Convert to analysis clusters.
       for (int icl = 0; icl < mClusterFactories.at(i)->getNumberOfClusters(); icl++) {
         auto analysisCluster = mClusterFactories.at(i)->buildCluster(icl);
-        mAnalysisClusters.emplace_back(analysisCluster);
+        mAnalysisClusters[i].emplace_back(analysisCluster);
         LOG(debug) << "Cluster " << icl << ": E: " << analysisCluster.E() << ", NCells " << analysisCluster.getNCells();
       }
       LOG(debug) << "Converted to analysis clusters.";
+    };
+    if (parallelClusterDefinitions && mClusterizers.size() > 1) {
+      std::vector<std::thread> workers;
+      for (size_t i = 1; i < mClusterizers.size(); i++) {
+        workers.emplace_back(runClusterizer, i);
+      }
+      runClusterizer(0);
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    } else {
+      for (size_t i = 0; i < mClusterizers.size(); i++) {
+        runClusterizer(i);
+      }
+    }
+
+    // Store the positions of all the tracks of the collision
+    mTrackPhi.clear();
+    mTrackEta.clear();
+    mTrackGlobalIndex.clear();
+    if (collisions.size() == 1) {
+      auto groupedTracks = tracks.sliceBy(perCollision, collisions.begin().globalIndex());
+      mTrackPhi.reserve(groupedTracks.size());
+      mTrackEta.reserve(groupedTracks.size());
+      mTrackGlobalIndex.reserve(groupedTracks.size());
+      for (auto& track : groupedTracks) {
+        // TODO this actually needs to use the eta phi
+        // of track propagated to EMC surface! Will be provided centrally according to Ruben
+        // TODO only consider tracks in current emcal/dcal acceptanc
+        mTrackPhi.emplace_back(TVector2::Phi_0_2pi(track.phi()));
+        mTrackEta.emplace_back(track.eta());
+        mTrackGlobalIndex.emplace_back(track.globalIndex());
+      }
+    }
+
+    // The tables are filled in the order of the cluster definitions
+    for (size_t i = 0; i < mClusterizers.size(); i++) {
+      const auto& analysisClusters = mAnalysisClusters[i];
 
       float vx = 0, vy = 0, vz = 0;
       bool hasCollision = false;
@@ -229,26 +306,11 @@ struct EmcalCorrectionTask {
           vz = col.posZ();
           hasCollision = true;
 
-          // store positions of all tracks of collision
-          auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
-
-          std::vector<double> trackPhi;
-          std::vector<double> trackEta;
-          std::vector<int64_t> trackGlobalIndex;
-          for (auto& track : groupedTracks) {
-            // TODO this actually needs to use the eta phi
-            // of track propagated to EMC surface! Will be provided centrally according to Ruben
-            // TODO only consider tracks in current emcal/dcal acceptanc
-            trackPhi.emplace_back(TVector2::Phi_0_2pi(track.phi()));
-            trackEta.emplace_back(track.eta());
-            trackGlobalIndex.emplace_back(track.globalIndex());
-          }
-
           std::vector<double> clusterPhi;
           std::vector<double> clusterEta;
 
           // TODO one loop that could in principle be combined with the other loop to improve performance
-          for (const auto& cluster : mAnalysisClusters) {
+          for (const auto& cluster : analysisClusters) {
             // Determine the cluster eta, phi, correcting for the vertex position.
             auto pos = cluster.getGlobalPosition();
             pos = pos - math_utils::Point3D<float>{vx, vy, vz};
@@ -257,13 +319,14 @@ struct EmcalCorrectionTask {
             clusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
             clusterEta.emplace_back(pos.Eta());
           }
-          auto&& [clusterToTrackIndexMap, trackToClusterIndexMap] = JetUtilities::MatchClustersAndTracks(clusterPhi, clusterEta, trackPhi, trackEta, maxMatchingDistance, 5);
+          // only the neighbouring cells of the eta-phi grid of the tracks are checked for each cluster
+          auto clusterToTrackIndexMap = JetUtilities::MatchClustersToTracksInGrid(clusterPhi, clusterEta, mTrackPhi, mTrackEta, maxMatchingDistance, 5);
           // we found a collision, put the clusters into the none ambiguous table
-          clusters.reserve(mAnalysisClusters.size());
+          clusters.reserve(analysisClusters.size());
           int cellindex = -1;
 
           unsigned int k = 0;
-          for (const auto& cluster : mAnalysisClusters) {
+          for (const auto& cluster : analysisClusters) {
 
             // Determine the cluster eta, phi, correcting for the vertex position.
             auto pos = cluster.getGlobalPosition();
@@ -289,8 +352,8 @@ struct EmcalCorrectionTask {
             hClusterEtaPhi->Fill(pos.Eta(), TVector2::Phi_0_2pi(pos.Phi()));
             for (unsigned int iTrack = 0; iTrack < clusterToTrackIndexMap[k].size(); iTrack++) {
               if (clusterToTrackIndexMap[k][iTrack] >= 0) {
-                LOG(debug) << "Found track " << trackGlobalIndex[clusterToTrackIndexMap[k][iTrack]] << " in cluster " << cluster.getID();
-                matchedTracks(clusters.lastIndex(), trackGlobalIndex[clusterToTrackIndexMap[k][iTrack]]);
+                LOG(debug) << "Found track " << mTrackGlobalIndex[clusterToTrackIndexMap[k][iTrack]] << " in cluster " << cluster.getID();
+                matchedTracks(clusters.lastIndex(), mTrackGlobalIndex[clusterToTrackIndexMap[k][iTrack]]);
               }
             }
             k++;
@@ -305,8 +368,8 @@ struct EmcalCorrectionTask {
       // be identified.
       if (!hasCollision) { // ambiguous
         int cellindex = -1;
-        clustersAmbiguous.reserve(mAnalysisClusters.size());
-        for (const auto& cluster : mAnalysisClusters) {
+        clustersAmbiguous.reserve(analysisClusters.size());
+        for (const auto& cluster : analysisClusters) {
           auto pos = cluster.getGlobalPosition();
           pos = pos - math_utils::Point3D<float>{vx, vy, vz};
           // Normalize the vector and rescale by energy.
@@ -326,7 +389,6 @@ struct EmcalCorrectionTask {
         }
       }
       LOG(debug) << "Cluster loop done for clusterizer " << i;
-      i++;
     } // end of clusterizer loop
     LOG(debug) << "Done with process.";
   }
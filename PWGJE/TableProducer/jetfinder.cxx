@@ -13,6 +13,9 @@
 //
 // Author: Jochen Klein, Nima Zardoshti, Raymond Ehlers
 
+#include <memory>
+#include <thread>
+
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
@@ -56,12 +59,14 @@ enum class JetType_t {
   neutral = 2,
 };
 
-template <typename JetTable, typename TrackConstituentTable, typename ClusterConstituentTable, typename ConstituentSubTable>
+template <typename JetTable, typename TrackConstituentTable, typename ClusterConstituentTable, typename ConstituentSubTable, typename SplittingTable, typename PackedConstituentTable>
 struct JetFinderTask {
   Produces<JetTable> jetsTable;
   Produces<TrackConstituentTable> trackConstituentsTable;
   Produces<ClusterConstituentTable> clusterConstituentsTable;
   Produces<ConstituentSubTable> constituentsSubTable;
+  Produces<SplittingTable> splittingsTable;
+  Produces<PackedConstituentTable> packedConstituentsTable;
   OutputObj<TH2F> hJetPt{"h_jet_pt"};
   OutputObj<TH2F> hJetPhi{"h_jet_phi"};
   OutputObj<TH2F> hJetEta{"h_jet_eta"};
@@ -72,8 +77,16 @@ struct JetFinderTask {
   Configurable<float> trackEtaCut{"trackEtaCut", 0.9, "constituent eta cut"};
   Configurable<bool> DoRhoAreaSub{"DoRhoAreaSub", false, "do rho area subtraction"};
   Configurable<bool> DoConstSub{"DoConstSub", false, "do constituent subtraction"};
+  Configurable<bool> DoRhoGridAreaSub{"DoRhoGridAreaSub", false, "do rho area subtraction with the grid-median rho"};
+  Configurable<float> bkgGridSize{"bkgGridSize", 0.5, "size in eta and phi of the patches of the grid-median rho"};
   Configurable<float> jetPtMin{"jetPtMin", 10.0, "minimum jet pT"};
+  Configurable<bool> fillSplittings{"fillSplittings", false, "store the Cambridge/Aachen declustering of the jets for the substructure tasks"};
+  Configurable<bool> fillPackedConstituents{"fillPackedConstituents", false, "store the kinematics of the constituents of each jet, sorted by pt, for the jet tasks"};
   Configurable<std::vector<double>> jetR{"jetR", {0.4}, "jet resolution parameters"};
+  Configurable<bool> parallelJetR{"parallelJetR", false, "find the jets of the different resolution parameters in parallel threads (requires a thread-safe fastjet)"};
+  Configurable<bool> fixedGhosts{"fixedGhosts", false, "generate the same ghosts in every event"};
+  Configurable<bool> autoJetStrategy{"autoJetStrategy", false, "choose the fastjet strategy (N2Tiled or N2MinHeapTiled) from the number of particles"};
+  Configurable<int> nParticlesTiledMax{"nParticlesTiledMax", 30000, "with autoJetStrategy, maximum number of particles (including ghosts) clustered with N2Tiled"};
   // FIXME: This should be named jetType. However, as of Aug 2021, it doesn't appear possible
   //        to set both global and task level options. This should be resolved when workflow
   //        level customization is available
@@ -85,6 +98,19 @@ struct JetFinderTask {
   std::vector<fastjet::PseudoJet> jets;
   std::vector<fastjet::PseudoJet> inputParticles;
   JetFinder jetFinder; //should be a configurable but for now this cant be changed on hyperloop
+  std::vector<std::unique_ptr<JetFinder>> jetFindersR; // one jet finder per resolution parameter, used with parallelJetR
+
+  /// Jets found for one resolution parameter, kept until the tables are filled
+  struct JetFinderResult {
+    std::vector<fastjet::PseudoJet> jets;
+    std::vector<double> areas;
+    std::vector<std::vector<fastjet::PseudoJet>> constituents;
+  };
+  std::vector<JetFinderResult> jetFinderResults;
+  std::vector<JetFinder::Splitting> splittings;
+  std::vector<int8_t> inputCharges; // charges of the input tracks/particles, by global index from inputIndexOffset
+  int64_t inputIndexOffset = 0;
+  Service<TDatabasePDG> pdg;
   // FIXME: Once configurables support enum, ideally we can
   JetType_t _jetType;
 
@@ -98,13 +124,47 @@ struct JetFinderTask {
                                70, -0.7, 0.7, 10, 0.05, 1.05));
     hJetN.setObject(new TH2F("h_jet_n", "jet n;n constituents",
                              30, 0., 30., 10, 0.05, 1.05));
+    if (doprocessDataChargedSharedRho && DoConstSub) {
+      LOGF(fatal, "The rho of the JetRhos table is only used for the rho area subtraction, not for the constituent subtraction");
+    }
+    configureJetFinder(jetFinder);
+
+    auto jetRValues = static_cast<std::vector<double>>(jetR);
+    if (parallelJetR && jetRValues.size() > 1) {
+      if (fixedGhosts) {
+        // the ghost random generator of fastjet is shared, its status can only be reset when the radii are done in sequence
+        LOG(warning) << "fixedGhosts requested, the jets of the different resolution parameters are found in sequence";
+      } else {
+        for (auto R : jetRValues) {
+          jetFindersR.emplace_back(std::make_unique<JetFinder>());
+          configureJetFinder(*jetFindersR.back());
+          jetFindersR.back()->jetR = R;
+        }
+        jetFinderResults.resize(jetRValues.size());
+      }
+    }
+  }
+
+  void configureJetFinder(JetFinder& finder)
+  {
     if (DoRhoAreaSub) {
-      jetFinder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+      finder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
     }
     if (DoConstSub) {
-      jetFinder.setBkgSubMode(JetFinder::BkgSubMode::constSub);
+      finder.setBkgSubMode(JetFinder::BkgSubMode::constSub);
     }
-    jetFinder.jetPtMin = jetPtMin;
+    if (DoRhoGridAreaSub) {
+      finder.setBkgSubMode(JetFinder::BkgSubMode::rhoGridAreaSub);
+    }
+    if (doprocessDataChargedSharedRho && !DoRhoGridAreaSub) {
+      // the rho comes from the table, the estimator of the mode is not used
+      finder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+    }
+    finder.bkgGridSize = bkgGridSize;
+    finder.jetPtMin = jetPtMin;
+    finder.fixedGhosts = fixedGhosts;
+    finder.autoStrategy = autoJetStrategy;
+    finder.nParticlesTiledMax = nParticlesTiledMax;
   }
 
   template <typename T>
@@ -122,44 +182,117 @@ struct JetFinderTask {
 
     jets.clear();
     inputParticles.clear();
+    inputCharges.clear();
 
     return true;
   }
 
+  /// Stores the charge of an input track/particle for the packed constituents
+  /// The inputs of a collision are added by increasing global index, the first one gives the offset
+  void setInputCharge(int64_t index, int8_t charge)
+  {
+    if (inputCharges.empty()) {
+      inputIndexOffset = index;
+    }
+    const auto position = index - inputIndexOffset;
+    if (position >= static_cast<int64_t>(inputCharges.size())) {
+      inputCharges.resize(position + 1, 0);
+    }
+    inputCharges[position] = charge;
+  }
+
+  int8_t getInputCharge(int index) const
+  {
+    // clusters have negative indices
+    const auto position = index - inputIndexOffset;
+    return (index < 0 || position < 0 || position >= static_cast<int64_t>(inputCharges.size())) ? 0 : inputCharges[position];
+  }
+
+  template <typename T>
+  void fillJet(T const& collision, fastjet::PseudoJet const& jet, double area, std::vector<fastjet::PseudoJet> const& constituents, double R)
+  {
+    jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
+              jet.E(), jet.m(), area, std::round(R * 100));
+    hJetPt->Fill(jet.pt(), R);
+    hJetPhi->Fill(jet.phi(), R);
+    hJetEta->Fill(jet.eta(), R);
+    hJetN->Fill(constituents.size(), R);
+    for (const auto& constituent : constituents) { //event or jetwise
+      if (DoConstSub) {
+        // Since we're copying the consituents, we can combine the tracks and clusters together
+        // We only have to keep the uncopied versions separated due to technical constraints.
+        constituentsSubTable(jetsTable.lastIndex(), constituent.pt(), constituent.eta(), constituent.phi(),
+                             constituent.E(), constituent.m(), constituent.user_index());
+      }
+      if (constituent.user_index() < 0) {
+        // Cluster
+        // -1 to account for the convention of negative indices for clusters.
+        clusterConstituentsTable(jetsTable.lastIndex(), -1 * constituent.user_index());
+      } else {
+        // Tracks
+        trackConstituentsTable(jetsTable.lastIndex(), constituent.user_index());
+      }
+    }
+    if (fillPackedConstituents) {
+      for (const auto& constituent : sorted_by_pt(constituents)) {
+        packedConstituentsTable(jetsTable.lastIndex(), constituent.pt(), constituent.eta(), constituent.phi(), getInputCharge(constituent.user_index()));
+      }
+    }
+    if (fillSplittings) {
+      JetFinder::findSplittings(constituents, splittings);
+      for (const auto& splitting : splittings) {
+        splittingsTable(jetsTable.lastIndex(), splitting.z, splitting.deltaR, splitting.kt);
+      }
+    }
+  }
+
   template <typename T>
   void processImplementation(T const& collision)
   {
     LOG(debug) << "Process Implementation";
     // NOTE: Can't just iterate directly - we have to cast first
     auto jetRValues = static_cast<std::vector<double>>(jetR);
+    if (!jetFindersR.empty()) {
+      // The jets of each resolution parameter are found in their own thread, sharing the input particles
+      // (copied with the constituent subtraction, which replaces them). The areas and the constituents are
+      // taken while the cluster sequence exists and the tables are filled afterwards in the order of the radii.
+      auto findJetsR = [&](size_t iR) {
+        auto& result = jetFinderResults[iR];
+        result.areas.clear();
+        result.constituents.clear();
+        std::vector<fastjet::PseudoJet> subtractedParticles;
+        if (DoConstSub) {
+          subtractedParticles = inputParticles;
+        }
+        fastjet::ClusterSequenceArea clusterSeq(jetFindersR[iR]->findJets(DoConstSub ? subtractedParticles : inputParticles, result.jets));
+        for (const auto& jet : result.jets) {
+          result.areas.push_back(jet.area());
+          result.constituents.push_back(jet.constituents());
+        }
+      };
+      std::vector<std::thread> workers;
+      for (size_t iR = 1; iR < jetFindersR.size(); iR++) {
+        workers.emplace_back(findJetsR, iR);
+      }
+      findJetsR(0);
+      for (auto& worker : workers) {
+        worker.join();
+      }
+      for (size_t iR = 0; iR < jetFindersR.size(); iR++) {
+        const auto& result = jetFinderResults[iR];
+        for (size_t iJet = 0; iJet < result.jets.size(); iJet++) {
+          fillJet(collision, result.jets[iJet], result.areas[iJet], result.constituents[iJet], jetRValues[iR]);
+        }
+      }
+      return;
+    }
     for (auto R : jetRValues) {
       // Update jet finder R and find jets
       jetFinder.jetR = R;
       fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
 
       for (const auto& jet : jets) {
-        jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
-                  jet.E(), jet.m(), jet.area(), std::round(R * 100));
-        hJetPt->Fill(jet.pt(), R);
-        hJetPhi->Fill(jet.phi(), R);
-        hJetEta->Fill(jet.eta(), R);
-        hJetN->Fill(jet.constituents().size(), R);
-        for (const auto& constituent : jet.constituents()) { //event or jetwise
-          if (DoConstSub) {
-            // Since we're copying the consituents, we can combine the tracks and clusters together
-            // We only have to keep the uncopied versions separated due to technical constraints.
-            constituentsSubTable(jetsTable.lastIndex(), constituent.pt(), constituent.eta(), constituent.phi(),
-                                 constituent.E(), constituent.m(), constituent.user_index());
-          }
-          if (constituent.user_index() < 0) {
-            // Cluster
-            // -1 to account for the convention of negative indices for clusters.
-            clusterConstituentsTable(jetsTable.lastIndex(), -1 * constituent.user_index());
-          } else {
-            // Tracks
-            trackConstituentsTable(jetsTable.lastIndex(), constituent.user_index());
-          }
-        }
+        fillJet(collision, jet, jet.area(), jet.constituents(), R);
       }
     }
   }
@@ -175,6 +308,7 @@ struct JetFinderTask {
     // TODO: MC event selection?
     jets.clear();
     inputParticles.clear();
+    inputCharges.clear();
 
     // As of June 2021, how best to check for charged particles? It doesn't seem to be in
     // the McParticles table, so for now we select by PID.
@@ -198,6 +332,10 @@ struct JetFinderTask {
         fastjet::PseudoJet(
           particle.px(), particle.py(), particle.pz(), particle.e()));
       inputParticles.back().set_user_index(particle.globalIndex());
+      if (fillPackedConstituents) {
+        auto pdgParticle = pdg->GetParticle(particle.pdgCode());
+        setInputCharge(particle.globalIndex(), pdgParticle ? static_cast<int8_t>(pdgParticle->Charge() / 3) : 0);
+      }
     }
 
     processImplementation(collision);
@@ -225,6 +363,9 @@ struct JetFinderTask {
       for (auto& track : tracks) {
         fillConstituents(track, inputParticles);
         inputParticles.back().set_user_index(track.globalIndex());
+        if (fillPackedConstituents) {
+          setInputCharge(track.globalIndex(), track.sign());
+        }
       }
     }
     if (_jetType == JetType_t::full || _jetType == JetType_t::neutral) {
@@ -259,6 +400,19 @@ struct JetFinderTask {
 
   PROCESS_SWITCH(JetFinderTask, processDataCharged, "Data jet finding for charged jets", true);
 
+  void processDataChargedSharedRho(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::JetRhos>>::iterator const& collision,
+                                   soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>> const& tracks)
+  {
+    LOG(debug) << "Process data charged with the rho of the JetRhos table!";
+    jetFinder.setExternalRho(collision.rho());
+    for (auto& finder : jetFindersR) {
+      finder->setExternalRho(collision.rho());
+    }
+    processData(collision, tracks);
+  }
+
+  PROCESS_SWITCH(JetFinderTask, processDataChargedSharedRho, "Data jet finding for charged jets, area subtraction with the rho of jet-rho-producer", false);
+
   void processDataFull(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision,
                        soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>> const& tracks,
                        aod::EMCALClusters const& clusters)
@@ -270,10 +424,10 @@ struct JetFinderTask {
   PROCESS_SWITCH(JetFinderTask, processDataFull, "Data jet finding for full and neutral jets", false);
 };
 
-using JetFinderData = JetFinderTask<o2::aod::Jets, o2::aod::JetTrackConstituents, o2::aod::JetClusterConstituents, o2::aod::JetConstituentsSub>;
-using JetFinderMCParticleLevel = JetFinderTask<o2::aod::MCParticleLevelJets, o2::aod::MCParticleLevelJetTrackConstituents, o2::aod::MCParticleLevelJetClusterConstituents, o2::aod::MCParticleLevelJetConstituentsSub>;
-using JetFinderMCDetectorLevel = JetFinderTask<o2::aod::MCDetectorLevelJets, o2::aod::MCDetectorLevelJetTrackConstituents, o2::aod::MCDetectorLevelJetClusterConstituents, o2::aod::MCDetectorLevelJetConstituentsSub>;
-using JetFinderHybridIntermediate = JetFinderTask<o2::aod::HybridIntermediateJets, o2::aod::HybridIntermediateJetTrackConstituents, o2::aod::HybridIntermediateJetClusterConstituents, o2::aod::HybridIntermediateJetConstituentsSub>;
+using JetFinderData = JetFinderTask<o2::aod::Jets, o2::aod::JetTrackConstituents, o2::aod::JetClusterConstituents, o2::aod::JetConstituentsSub, o2::aod::JetSplittings, o2::aod::JetPackedConstituents>;
+using JetFinderMCParticleLevel = JetFinderTask<o2::aod::MCParticleLevelJets, o2::aod::MCParticleLevelJetTrackConstituents, o2::aod::MCParticleLevelJetClusterConstituents, o2::aod::MCParticleLevelJetConstituentsSub, o2::aod::MCParticleLevelJetSplittings, o2::aod::MCParticleLevelJetPackedConstituents>;
+using JetFinderMCDetectorLevel = JetFinderTask<o2::aod::MCDetectorLevelJets, o2::aod::MCDetectorLevelJetTrackConstituents, o2::aod::MCDetectorLevelJetClusterConstituents, o2::aod::MCDetectorLevelJetConstituentsSub, o2::aod::MCDetectorLevelJetSplittings, o2::aod::MCDetectorLevelJetPackedConstituents>;
+using JetFinderHybridIntermediate = JetFinderTask<o2::aod::HybridIntermediateJets, o2::aod::HybridIntermediateJetTrackConstituents, o2::aod::HybridIntermediateJetClusterConstituents, o2::aod::HybridIntermediateJetConstituentsSub, o2::aod::HybridIntermediateJetSplittings, o2::aod::HybridIntermediateJetPackedConstituents>;
 
 enum class JetInputData_t {
   Data,
@@ -76,10 +76,14 @@ struct JetFinderHadronRecoilTask {
                                  120, 0., 60.));
     hJetHadronDeltaPhi.setObject(new TH1F("h_jet_hadron_deltaphi", "jet #eta;#eta",
                                           40, 0.0, 4.));
+
+    if (doprocessSharedRho) {
+      jetFinder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+    }
   }
 
-  void process(aod::Collision const& collision,
-               soa::Filtered<aod::Tracks> const& tracks)
+  template <typename T, typename U>
+  void processImpl(T const& collision, U const& tracks)
   {
 
     jets.clear();
@@ -119,6 +123,21 @@ struct JetFinderHadronRecoilTask {
       }
     }
   }
+
+  void processData(aod::Collision const& collision,
+                   soa::Filtered<aod::Tracks> const& tracks)
+  {
+    processImpl(collision, tracks);
+  }
+  PROCESS_SWITCH(JetFinderHadronRecoilTask, processData, "Hadron-recoil jet finding", true);
+
+  void processSharedRho(soa::Join<aod::Collisions, aod::JetRhos>::iterator const& collision,
+                        soa::Filtered<aod::Tracks> const& tracks)
+  {
+    jetFinder.setExternalRho(collision.rho());
+    processImpl(collision, tracks);
+  }
+  PROCESS_SWITCH(JetFinderHadronRecoilTask, processSharedRho, "Hadron-recoil jet finding, area subtraction with the rho of jet-rho-producer", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -33,6 +33,9 @@
 #include "PWGJE/DataModel/Jet.h"
 #include "PWGJE/Core/JetFinder.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -65,6 +68,7 @@ struct JetFinderHFTask {
 
   std::vector<fastjet::PseudoJet> jets;
   std::vector<fastjet::PseudoJet> inputParticles;
+  std::vector<fastjet::PseudoJet> collisionParticles; // tracks of the collision, shared by its candidates
   JetFinder jetFinder;
 
   void init(InitContext const&)
@@ -79,10 +83,15 @@ struct JetFinderHFTask {
                                   100, 0., 100.));
     hD0Pt.setObject(new TH1F("h_D0_pt", "jet p_{T,D};p_{T,D} (GeV/#it{c})",
                              60, 0., 60.));
+
+    if (doprocessDataSharedRho) {
+      jetFinder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+    }
   }
 
   Configurable<int> selectionFlagD0{"selectionFlagD0", 1, "Selection Flag for D0"};
   Configurable<int> selectionFlagD0bar{"selectionFlagD0bar", 1, "Selection Flag for D0bar"};
+  Configurable<bool> shareCollisionParticles{"shareCollisionParticles", false, "build the tracks of a collision once and only replace the daughters by the candidate for each candidate"};
 
   //need enum as configurable
   enum pdgCode { pdgD0 = 421 };
@@ -91,9 +100,33 @@ struct JetFinderHFTask {
   Filter partCuts = (aod::mcparticle::pt > 0.15f && aod::mcparticle::eta > -0.9f && aod::mcparticle::eta < 0.9f);
   Filter seltrack = (aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar);
 
-  void processData(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision,
-                   soa::Filtered<aod::Tracks> const& tracks,
-                   soa::Filtered<soa::Join<aod::HfCand2Prong, aod::HfSelD0>> const& candidates)
+  template <typename T>
+  void addTrack(T const& track, std::vector<fastjet::PseudoJet>& particles)
+  {
+    auto energy = std::sqrt(track.p() * track.p() + JetFinder::mPion * JetFinder::mPion);
+    particles.emplace_back(track.px(), track.py(), track.pz(), energy);
+    particles.back().set_user_index(track.globalIndex());
+  }
+
+  /// Input particles of a candidate from the shared tracks of the collision: its daughters are removed and the candidate is added
+  /// The order of the input particles does not matter for the clustering
+  template <typename T>
+  void fillInputParticlesFromCollision(T const& candidate)
+  {
+    inputParticles = collisionParticles;
+    for (const auto daughterId : {candidate.prong0Id(), candidate.prong1Id()}) {
+      auto daughter = std::find_if(inputParticles.begin(), inputParticles.end(), [daughterId](const auto& particle) { return particle.user_index() == daughterId; });
+      if (daughter != inputParticles.end()) {
+        *daughter = inputParticles.back();
+        inputParticles.pop_back();
+      }
+    }
+    inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
+    inputParticles.back().set_user_index(1);
+  }
+
+  template <typename T, typename U, typename V>
+  void processDataImpl(T const& collision, U const& tracks, V const& candidates)
   {
     // TODO: retrieve pion mass from somewhere
     bool isHFJet;
@@ -101,20 +134,28 @@ struct JetFinderHFTask {
     if (!collision.sel8())
       return;
 
-    //this loop should be made more efficient
+    if (shareCollisionParticles) {
+      collisionParticles.clear();
+      for (auto& track : tracks) {
+        addTrack(track, collisionParticles);
+      }
+    }
+
     for (auto& candidate : candidates) {
       jets.clear();
-      inputParticles.clear();
-      for (auto& track : tracks) {
-        auto energy = std::sqrt(track.p() * track.p() + JetFinder::mPion * JetFinder::mPion);
-        if (candidate.prong0().globalIndex() == track.globalIndex() || candidate.prong1().globalIndex() == track.globalIndex()) { // is it global index?
-          continue;
+      if (shareCollisionParticles) {
+        fillInputParticlesFromCollision(candidate);
+      } else {
+        inputParticles.clear();
+        for (auto& track : tracks) {
+          if (candidate.prong0().globalIndex() == track.globalIndex() || candidate.prong1().globalIndex() == track.globalIndex()) { // is it global index?
+            continue;
+          }
+          addTrack(track, inputParticles);
         }
-        inputParticles.emplace_back(track.px(), track.py(), track.pz(), energy);
-        inputParticles.back().set_user_index(track.globalIndex());
+        inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
+        inputParticles.back().set_user_index(1);
       }
-      inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
-      inputParticles.back().set_user_index(1);
 
       fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
 
@@ -139,8 +180,25 @@ struct JetFinderHFTask {
       }
     }
   }
+
+  void processData(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision,
+                   soa::Filtered<aod::Tracks> const& tracks,
+                   soa::Filtered<soa::Join<aod::HfCand2Prong, aod::HfSelD0>> const& candidates)
+  {
+    processDataImpl(collision, tracks, candidates);
+  }
   PROCESS_SWITCH(JetFinderHFTask, processData, "HF jet finding on data", true);
 
+  // the rho of the collision is used by all its candidates
+  void processDataSharedRho(soa::Join<aod::Collisions, aod::EvSels, aod::JetRhos>::iterator const& collision,
+                            soa::Filtered<aod::Tracks> const& tracks,
+                            soa::Filtered<soa::Join<aod::HfCand2Prong, aod::HfSelD0>> const& candidates)
+  {
+    jetFinder.setExternalRho(collision.rho());
+    processDataImpl(collision, tracks, candidates);
+  }
+  PROCESS_SWITCH(JetFinderHFTask, processDataSharedRho, "HF jet finding on data, area subtraction with the rho of jet-rho-producer", false);
+
   void processMCD(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision,
                   soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::TrackSelection>> const& tracks,
                   soa::Filtered<soa::Join<aod::HfCand2Prong, aod::HfSelD0, aod::HfCand2ProngMcRec>> const& candidates)
@@ -149,27 +207,39 @@ struct JetFinderHFTask {
     // TODO: retrieve pion mass from somewhere
     bool isHFJet;
 
-    //this loop should be made more efficient
-    // TODO: should probably refine the candidate selection
-    for (auto& candidate : candidates) {
-      jets.clear();
-      inputParticles.clear();
+    if (shareCollisionParticles) {
+      collisionParticles.clear();
       for (auto& track : tracks) {
         if (!globalTracks.IsSelected(track)) {
           LOGF(info, "Rejecting track %d with track cuts", track.globalIndex());
           continue;
         }
-        if (candidate.prong0().globalIndex() == track.globalIndex() || candidate.prong1().globalIndex() == track.globalIndex()) {
-          LOGF(info, "Rejecting track %d as daughter of candidate %d", track.globalIndex(), candidate.globalIndex());
-          continue;
+        addTrack(track, collisionParticles);
+      }
+    }
+
+    // TODO: should probably refine the candidate selection
+    for (auto& candidate : candidates) {
+      jets.clear();
+      if (shareCollisionParticles) {
+        fillInputParticlesFromCollision(candidate);
+      } else {
+        inputParticles.clear();
+        for (auto& track : tracks) {
+          if (!globalTracks.IsSelected(track)) {
+            LOGF(info, "Rejecting track %d with track cuts", track.globalIndex());
+            continue;
+          }
+          if (candidate.prong0().globalIndex() == track.globalIndex() || candidate.prong1().globalIndex() == track.globalIndex()) {
+            LOGF(info, "Rejecting track %d as daughter of candidate %d", track.globalIndex(), candidate.globalIndex());
+            continue;
+          }
+          // LOGF(info, "Adding track %d with pt %g", track.globalIndex(), track.pt());
+          addTrack(track, inputParticles);
         }
-        // LOGF(info, "Adding track %d with pt %g", track.globalIndex(), track.pt());
-        auto energy = std::sqrt(track.p() * track.p() + JetFinder::mPion * JetFinder::mPion);
-        inputParticles.emplace_back(track.px(), track.py(), track.pz(), energy);
-        inputParticles.back().set_user_index(track.globalIndex());
+        inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
+        inputParticles.back().set_user_index(1);
       }
-      inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
-      inputParticles.back().set_user_index(1);
 
       fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
 
@@ -45,6 +45,12 @@ struct JetMatching {
   Produces<BaseJetCollectionMatching> jetsBaseMatching;
   Produces<TagJetCollectionMatching> jetsTagMatching;
 
+  // positions of the jets of the collision and matching buffers, kept between collisions so that nothing is allocated per event
+  std::vector<double> jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta;
+  std::vector<int> jetsBaseGlobalIndex, jetsTagGlobalIndex;
+  std::vector<int> baseToTagIndexMap, tagToBaseIndexMap;
+  JetUtilities::GeometricMatchingBuffers<double> matchingBuffers;
+
   void init(InitContext const&)
   {
   }
@@ -56,30 +62,38 @@ struct JetMatching {
     BaseJetCollection const& jetsBase,
     TagJetCollection const& jetsTag)
   {
-    std::vector<double> jetsBasePhi(jetsBase.size());
-    std::vector<double> jetsBaseEta(jetsBase.size());
-    for (auto jet : jetsBase) {
+    // The matching is done in JetUtilities::MatchJetsGeometricallySorted with a sweep over the jets sorted by phi,
+    // so each jet only looks at the jets of the other collection in its phi window. The vectors must contain exactly
+    // one entry per jet.
+    jetsBasePhi.clear();
+    jetsBaseEta.clear();
+    jetsBaseGlobalIndex.clear();
+    for (auto& jet : jetsBase) {
       jetsBasePhi.emplace_back(jet.phi());
       jetsBaseEta.emplace_back(jet.eta());
+      jetsBaseGlobalIndex.emplace_back(jet.globalIndex());
     }
-    std::vector<double> jetsTagPhi(jetsTag.size());
-    std::vector<double> jetsTagEta(jetsTag.size());
+    jetsTagPhi.clear();
+    jetsTagEta.clear();
+    jetsTagGlobalIndex.clear();
     for (auto& jet : jetsTag) {
       jetsTagPhi.emplace_back(jet.phi());
       jetsTagEta.emplace_back(jet.eta());
+      jetsTagGlobalIndex.emplace_back(jet.globalIndex());
     }
-    auto&& [baseToTagIndexMap, tagToBaseIndexMap] = JetUtilities::MatchJetsGeometrically(jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta, maxMatchingDistance);
+    JetUtilities::MatchJetsGeometricallySorted(jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta, static_cast<double>(maxMatchingDistance), matchingBuffers, baseToTagIndexMap, tagToBaseIndexMap);
 
+    // The maps hold positions in the jets of this collision, the tables store the global index of the matched jet
     unsigned int i = 0;
     for (auto& jet : jetsBase) {
       // Store results
-      jetsBaseMatching(jet.globalIndex(), baseToTagIndexMap[i]);
+      jetsBaseMatching(jet.globalIndex(), baseToTagIndexMap[i] >= 0 ? jetsTagGlobalIndex[baseToTagIndexMap[i]] : -1);
       ++i;
     }
     i = 0;
     for (auto& jet : jetsTag) {
       // Store results
-      jetsTagMatching(jet.globalIndex(), tagToBaseIndexMap[i]);
+      jetsTagMatching(jet.globalIndex(), tagToBaseIndexMap[i] >= 0 ? jetsBaseGlobalIndex[tagToBaseIndexMap[i]] : -1);
       ++i;
     }
   }
@@ -0,0 +1,83 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// jet background density task
+//
+// Estimates the background density of every collision once and stores it in the JetRhos table,
+// so that the jet finders (inclusive, HF, hadron-recoil) subtract the same rho without estimating it again.
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ASoA.h"
+#include "Common/DataModel/TrackSelectionTables.h"
+
+#include "fastjet/PseudoJet.hh"
+
+#include "PWGJE/DataModel/Jet.h"
+#include "PWGJE/Core/JetFinder.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+
+struct JetRhoProducerTask {
+  Produces<aod::JetRhos> rhoTable;
+  OutputObj<TH1F> hRho{"h_rho"};
+
+  Configurable<float> trackPtCut{"trackPtCut", 0.1, "minimum constituent pT"};
+  Configurable<float> trackEtaCut{"trackEtaCut", 0.9, "constituent eta cut"};
+  Configurable<int> bkgEstimator{"bkgEstimator", 0, "background estimator: 0 = grid median, 1 = median of the kT jets"};
+  Configurable<float> bkgGridSize{"bkgGridSize", 0.5, "size in eta and phi of the patches of the grid median"};
+  Configurable<float> jetBkgR{"jetBkgR", 0.2, "resolution parameter of the kT jets of the jet median"};
+
+  Filter trackFilter = (nabs(aod::track::eta) < trackEtaCut) && (requireGlobalTrackInFilter()) && (aod::track::pt > trackPtCut);
+
+  std::vector<fastjet::PseudoJet> inputParticles;
+  JetFinder bkgEstimation;
+
+  void init(InitContext const&)
+  {
+    hRho.setObject(new TH1F("h_rho", "background density;#rho (GeV/#it{c})", 200, 0., 200.));
+    if (bkgEstimator == 0) {
+      bkgEstimation.setBkgSubMode(JetFinder::BkgSubMode::rhoGridAreaSub);
+    } else if (bkgEstimator == 1) {
+      bkgEstimation.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+    } else {
+      LOGF(fatal, "Unknown background estimator %d", bkgEstimator.value);
+    }
+    bkgEstimation.bkgGridSize = bkgGridSize;
+    bkgEstimation.jetBkgR = jetBkgR;
+  }
+
+  // every collision gets a row, the table is joinable with the Collisions table
+  void process(aod::Collision const& collision,
+               soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>> const& tracks)
+  {
+    inputParticles.clear();
+    for (auto& track : tracks) {
+      fillConstituents(track, inputParticles);
+      inputParticles.back().set_user_index(track.globalIndex());
+    }
+    double rho = 0., rhoM = 0.;
+    if (!inputParticles.empty()) {
+      bkgEstimation.estimateRho(inputParticles, rho, rhoM);
+    }
+    rhoTable(rho, rhoM);
+    hRho->Fill(rho);
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<JetRhoProducerTask>(cfgc, TaskName{"jet-rho-producer"})};
+}
@@ -28,6 +28,13 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
+#include "CommonConstants/MathConstants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -46,20 +53,102 @@ DECLARE_SOA_COLUMN(Energy, energy, float);
 DECLARE_SOA_TABLE(JetSkim, "AOD", "JETSKIM1",
                   jetskim::CollisionId,
                   jetskim::Pt, jetskim::Eta, jetskim::Phi, jetskim::Energy);
+
+// Compact skim: pt, eta and phi quantised on 16 bit, decoded by the dynamic columns
+namespace jetskimcompact
+{
+// pt is stored as the logarithm of pt / ptMin, in [ptMin, ptMax] GeV/c, relative resolution 2.1e-4
+constexpr float ptMin = 0.01f;
+constexpr float ptMax = 10000.f;
+constexpr float logPtScale = 65535.f / 13.815511f; // 65535 / log(ptMax / ptMin)
+// eta is stored linearly in [-etaMax, etaMax], resolution 1.2e-4
+constexpr float etaMax = 4.f;
+constexpr float etaScale = 32767.f / etaMax;
+// phi is stored linearly in [0, 2pi), resolution 9.6e-5
+constexpr float phiScale = 65536.f / o2::constants::math::TwoPI;
+
+inline uint16_t encodePt(float pt)
+{
+  const float x = std::log(std::clamp(pt, ptMin, ptMax) / ptMin) * logPtScale;
+  return static_cast<uint16_t>(std::min(x + 0.5f, 65535.f));
+}
+inline float decodePt(uint16_t pt) { return ptMin * std::exp(pt / logPtScale); }
+inline int16_t encodeEta(float eta) { return static_cast<int16_t>(std::lround(std::clamp(eta, -etaMax, etaMax) * etaScale)); }
+inline float decodeEta(int16_t eta) { return eta / etaScale; }
+inline uint16_t encodePhi(float phi)
+{
+  phi = std::fmod(phi, o2::constants::math::TwoPI);
+  if (phi < 0.f) {
+    phi += o2::constants::math::TwoPI;
+  }
+  return static_cast<uint16_t>(static_cast<uint32_t>(std::lround(phi * phiScale)) & 0xFFFF); // 2pi wraps to 0
+}
+inline float decodePhi(uint16_t phi) { return phi / phiScale; }
+
+DECLARE_SOA_INDEX_COLUMN(Collision, collision);
+DECLARE_SOA_COLUMN(PtStore, ptStore, uint16_t);   //! log-encoded pt
+DECLARE_SOA_COLUMN(EtaStore, etaStore, int16_t);  //! quantised eta
+DECLARE_SOA_COLUMN(PhiStore, phiStore, uint16_t); //! quantised phi
+DECLARE_SOA_DYNAMIC_COLUMN(Pt, pt, [](uint16_t pt) -> float { return decodePt(pt); });
+DECLARE_SOA_DYNAMIC_COLUMN(Eta, eta, [](int16_t eta) -> float { return decodeEta(eta); });
+DECLARE_SOA_DYNAMIC_COLUMN(Phi, phi, [](uint16_t phi) -> float { return decodePhi(phi); });
+DECLARE_SOA_DYNAMIC_COLUMN(Energy, energy, //! energy with the pion mass hypothesis
+                           [](uint16_t pt, int16_t eta) -> float {
+                             const float p = decodePt(pt) * std::cosh(decodeEta(eta));
+                             return std::sqrt(p * p + 0.139f * 0.139f);
+                           });
+} // namespace jetskimcompact
+// The tracks of a collision are contiguous and sorted by decreasing pt, so that the jet finder input is read in one pass
+DECLARE_SOA_TABLE(JetSkimCompact, "AOD", "JETSKIMC",
+                  jetskimcompact::CollisionId,
+                  jetskimcompact::PtStore, jetskimcompact::EtaStore, jetskimcompact::PhiStore,
+                  jetskimcompact::Pt<jetskimcompact::PtStore>,
+                  jetskimcompact::Eta<jetskimcompact::EtaStore>,
+                  jetskimcompact::Phi<jetskimcompact::PhiStore>,
+                  jetskimcompact::Energy<jetskimcompact::PtStore, jetskimcompact::EtaStore>);
 } // namespace o2::aod
 
 struct JetSkimmingTask1 {
   Produces<o2::aod::JetSkim> skim;
+  Produces<o2::aod::JetSkimCompact> skimCompact;
+
+  Configurable<bool> compactSkim{"compactSkim", false, "write the compact skim (16 bit pt, eta, phi, sorted by pt) instead of the full precision one"};
 
   Filter trackCuts = aod::track::pt > 0.15f;
   float mPionSquared = 0.139 * 0.139;
 
+  std::vector<uint16_t> trackPts; // encoded kinematics of the tracks of the collision
+  std::vector<int16_t> trackEtas;
+  std::vector<uint16_t> trackPhis;
+  std::vector<int> sortedTracks; // positions of the tracks of the collision, by decreasing pt
+
   void process(aod::Collision const& collision,
                soa::Filtered<aod::Tracks> const& tracks)
   {
+    if (!compactSkim) {
+      for (auto& track : tracks) {
+        float energy = std::sqrt(track.p() * track.p() + mPionSquared);
+        skim(collision, track.pt(), track.eta(), track.phi(), energy);
+      }
+      return;
+    }
+
+    // the encoding of pt is monotonic, the tracks are sorted with their encoded pt
+    trackPts.clear();
+    trackEtas.clear();
+    trackPhis.clear();
     for (auto& track : tracks) {
-      float energy = std::sqrt(track.p() * track.p() + mPionSquared);
-      skim(collision, track.pt(), track.eta(), track.phi(), energy);
+      trackPts.push_back(aod::jetskimcompact::encodePt(track.pt()));
+      trackEtas.push_back(aod::jetskimcompact::encodeEta(track.eta()));
+      trackPhis.push_back(aod::jetskimcompact::encodePhi(track.phi()));
+    }
+    sortedTracks.resize(trackPts.size());
+    std::iota(sortedTracks.begin(), sortedTracks.end(), 0);
+    std::stable_sort(sortedTracks.begin(), sortedTracks.end(), [this](int i, int j) { return trackPts[i] > trackPts[j]; });
+
+    skimCompact.reserve(sortedTracks.size());
+    for (auto i : sortedTracks) {
+      skimCompact(collision, trackPts[i], trackEtas[i], trackPhis[i]);
     }
   }
 };
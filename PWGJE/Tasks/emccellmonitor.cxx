@@ -9,6 +9,7 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <array>
 #include <climits>
 #include <cstdlib>
 #include <map>
@@ -27,6 +28,9 @@
 #include "EMCALCalib/BadChannelMap.h"
 #include "CommonDataFormat/InteractionRecord.h"
 
+#include "TH2.h"
+#include "TProfile.h"
+
 /// \struct CellMonitor
 /// \brief Simple monitoring task for cell related quantities
 /// \author Markus Fasel <markus.fasel@cern.ch>, Oak Ridge National Laoratory
@@ -44,6 +48,12 @@
 ///
 /// The task is a direct port of PWG::EMCAL::AliEmcalCellMonitorTask from
 /// AliPhysics
+///
+/// The histograms are filled through their pointers, without the lookup in
+/// the registry for every cell. The per-cell histograms have the cell on the
+/// y axis, so that the distribution of each cell is a contiguous row of the
+/// bin array of the histogram, filled by direct indexing. The position of each
+/// cell in its supermodule is tabulated at initialization.
 struct CellMonitor {
 
   o2::framework::Configurable<double> mMinCellAmplitude{"minCellAmplitude", 0., "Minimum cell amplitude for histograms."};
@@ -59,6 +69,23 @@ struct CellMonitor {
   std::vector<int> mVetoBCIDs;
   std::vector<int> mSelectBCIDs;
 
+  TH1* mCellBCAll = nullptr;
+  TH1* mCellBCSelected = nullptr;
+  TH1* mCellFrequency = nullptr;
+  TProfile* mCellAmplitudeMean = nullptr;
+  TH2* mCellAmplitude = nullptr;
+  TH2* mCellAmplitudeCut = nullptr;
+  TH2* mCellTime = nullptr;
+  TH2* mCellTimeMain = nullptr;
+  TH2* mCellAmplitudeBC = nullptr;
+  TH2* mCellTimeBC = nullptr;
+  std::array<TH2*, 20> mCellAmplitudeSM{};
+  std::array<TH2*, 20> mCellCountSM{};
+  std::array<TH2*, 20> mCellAmplitudeTimeSM{};
+  std::vector<int> mCellSupermodule; ///< supermodule of each cell
+  std::vector<int> mCellColumn;      ///< column of each cell in its supermodule
+  std::vector<int> mCellRow;         ///< row of each cell in its supermodule
+
   /// \brief Create output histograms and initialize geometry
   void init(o2::framework::InitContext const&)
   {
@@ -87,6 +114,7 @@ struct CellMonitor {
     mHistManager.add("cellBCSelected", "Bunch crossing ID of cell (selected cells)", o2HistType::kTH1F, {{bcAxis}});
     mHistManager.add("cellMasking", "Monitoring for masked cells", o2HistType::kTH1F, {cellAxis});
     mHistManager.add("cellFrequency", "Frequency of cell firing", o2HistType::kTH1F, {cellAxis});
+    mHistManager.add("cellAmplitudeMean", "Mean amplitude per cell", o2HistType::kTProfile, {cellAxis});
     mHistManager.add("cellAmplitude", "Energy distribution per cell", o2HistType::kTH2F, {amplitudeAxis, cellAxis});
     mHistManager.add("cellAmplitudeCut", "Energy distribution per cell", o2HistType::kTH2F, {amplitudeAxis, cellAxis});
     mHistManager.add("cellTime", "Time distribution per cell", o2HistType::kTH2F, {timeAxisLarge, cellAxis});
@@ -97,9 +125,31 @@ struct CellMonitor {
     // mCellAmplitudeFractionCluster.setObject(new TH2F("cellAmplitudeFractionCluster", "Summed cell amplitude fraction in a cluster", nCells, -0.5, nCells - 0.5, 200, 0., 200.));
 
     for (int ism = 0; ism < 20; ++ism) {
-      mHistManager.add(Form("cellAmplitudeSM/cellAmpSM%d", ism), Form("Integrated cell amplitudes for SM %d", ism), o2HistType::kTH2F, {colAxis, rowAxis});
-      mHistManager.add(Form("cellCountSM/cellCountSM%d", ism), Form("Count rate per cell for SM %d; col; row", ism), o2HistType::kTH2F, {colAxis, rowAxis});
-      mHistManager.add(Form("cellAmplitudeTime/cellAmpTimeCorrSM%d", ism), Form("Correlation between cell amplitude and time in Supermodule %d", ism), o2HistType::kTH2F, {timeAxisLarge, amplitudeAxisLarge});
+      mCellAmplitudeSM[ism] = std::get<std::shared_ptr<TH2>>(mHistManager.add(Form("cellAmplitudeSM/cellAmpSM%d", ism), Form("Integrated cell amplitudes for SM %d", ism), o2HistType::kTH2F, {colAxis, rowAxis})).get();
+      mCellCountSM[ism] = std::get<std::shared_ptr<TH2>>(mHistManager.add(Form("cellCountSM/cellCountSM%d", ism), Form("Count rate per cell for SM %d; col; row", ism), o2HistType::kTH2F, {colAxis, rowAxis})).get();
+      mCellAmplitudeTimeSM[ism] = std::get<std::shared_ptr<TH2>>(mHistManager.add(Form("cellAmplitudeTime/cellAmpTimeCorrSM%d", ism), Form("Correlation between cell amplitude and time in Supermodule %d", ism), o2HistType::kTH2F, {timeAxisLarge, amplitudeAxisLarge})).get();
+    }
+    mCellBCAll = mHistManager.get<TH1>(HIST("cellBCAll")).get();
+    mCellBCSelected = mHistManager.get<TH1>(HIST("cellBCSelected")).get();
+    mCellFrequency = mHistManager.get<TH1>(HIST("cellFrequency")).get();
+    mCellAmplitudeMean = mHistManager.get<TProfile>(HIST("cellAmplitudeMean")).get();
+    mCellAmplitude = mHistManager.get<TH2>(HIST("cellAmplitude")).get();
+    mCellAmplitudeCut = mHistManager.get<TH2>(HIST("cellAmplitudeCut")).get();
+    mCellTime = mHistManager.get<TH2>(HIST("cellTime")).get();
+    mCellTimeMain = mHistManager.get<TH2>(HIST("cellTimeMain")).get();
+    mCellAmplitudeBC = mHistManager.get<TH2>(HIST("cellAmplitudeBC")).get();
+    mCellTimeBC = mHistManager.get<TH2>(HIST("celTimeBC")).get();
+
+    // position of the cells in their supermodule, instead of the geometry lookups for every cell
+    mCellSupermodule.resize(nCells);
+    mCellColumn.resize(nCells);
+    mCellRow.resize(nCells);
+    for (int cellID = 0; cellID < nCells; ++cellID) {
+      auto [supermodule, module, phiInModule, etaInModule] = mGeometry->GetCellIndex(cellID);
+      auto [row, col] = mGeometry->GetCellPhiEtaIndexInSModule(supermodule, module, phiInModule, etaInModule);
+      mCellSupermodule[cellID] = supermodule;
+      mCellColumn[cellID] = col;
+      mCellRow[cellID] = row;
     }
     if (mVetoBCID->length()) {
       std::stringstream parser(mVetoBCID.value);
@@ -140,119 +190,66 @@ struct CellMonitor {
     }
     mHistManager.fill(HIST("eventsSelected"), 1);
     mHistManager.fill(HIST("eventBCSelected"), eventIR.bc);
+    int nCellsAll = 0;  // cells in cellAmplitude
+    int nCellsCut = 0;  // cells in cellAmplitudeCut and cellTime
+    int nCellsMain = 0; // cells in cellTimeMain
     for (const auto& cell : cells) {
       // cell.cellNumber(),
       // cell.amplitude(),
       // cell.time(),
       if (cell.caloType() != 1)
         continue;
-      if (isCellMasked(cell.cellNumber()))
+      const int cellID = cell.cellNumber();
+      if (cellID < 0 || cellID >= static_cast<int>(mCellSupermodule.size()))
+        continue;
+      if (isCellMasked(cellID))
         continue;
+      const double amplitude = cell.amplitude();
+      const double celltime = cell.time();
       o2::InteractionRecord cellIR;
       cellIR.setFromLong(cell.bc().globalBC());
-      mHistManager.fill(HIST("cellBCAll"), cellIR.bc);
-      mHistManager.fill(HIST("cellBCSelected"), cellIR.bc);
-      mHistManager.fill(HIST("cellAmplitude"), cell.amplitude(), cell.cellNumber());
-      if (cell.amplitude() < mMinCellAmplitude)
+      mCellBCAll->Fill(cellIR.bc);
+      mCellBCSelected->Fill(cellIR.bc);
+      fillCellHistogram(mCellAmplitude, amplitude, cellID);
+      nCellsAll++;
+      if (amplitude < mMinCellAmplitude)
         continue;
-      mHistManager.fill(HIST("cellAmplitudeCut"), cell.amplitude(), cell.cellNumber());
-      mHistManager.fill(HIST("cellFrequency"), cell.cellNumber());
-      mHistManager.fill(HIST("cellTime"), cell.time(), cell.cellNumber());
-      if (cell.time() > mMinCellTimeMain && cell.time() < mMaxCellTimeMain) {
-        mHistManager.fill(HIST("cellTimeMain"), cell.time(), cell.cellNumber());
+      fillCellHistogram(mCellAmplitudeCut, amplitude, cellID);
+      mCellFrequency->Fill(cellID);
+      mCellAmplitudeMean->Fill(cellID, amplitude);
+      fillCellHistogram(mCellTime, celltime, cellID);
+      nCellsCut++;
+      if (celltime > mMinCellTimeMain && celltime < mMaxCellTimeMain) {
+        fillCellHistogram(mCellTimeMain, celltime, cellID);
+        nCellsMain++;
       }
 
-      mHistManager.fill(HIST("cellAmplitudeBC"), cellIR.bc, cell.amplitude());
-      mHistManager.fill(HIST("celTimeBC"), cellIR.bc, cell.time());
+      mCellAmplitudeBC->Fill(cellIR.bc, amplitude);
+      mCellTimeBC->Fill(cellIR.bc, celltime);
 
-      // Get Cell index in eta-phi of sm
-      auto [supermodule, module, phiInModule, etaInModule] = mGeometry->GetCellIndex(cell.cellNumber());
-      auto [row, col] = mGeometry->GetCellPhiEtaIndexInSModule(supermodule, module, phiInModule, etaInModule);
-
-      fillSupermoduleHistograms(supermodule, col, row, cell.amplitude(), cell.time());
+      const int supermodule = mCellSupermodule[cellID];
+      mCellAmplitudeSM[supermodule]->Fill(mCellColumn[cellID], mCellRow[cellID]);
+      mCellCountSM[supermodule]->Fill(mCellColumn[cellID], mCellRow[cellID], amplitude);
+      mCellAmplitudeTimeSM[supermodule]->Fill(celltime, amplitude);
     }
+    // the direct filling of the per-cell histograms does not count the entries
+    mCellAmplitude->SetEntries(mCellAmplitude->GetEntries() + nCellsAll);
+    mCellAmplitudeCut->SetEntries(mCellAmplitudeCut->GetEntries() + nCellsCut);
+    mCellTime->SetEntries(mCellTime->GetEntries() + nCellsCut);
+    mCellTimeMain->SetEntries(mCellTimeMain->GetEntries() + nCellsMain);
     LOG(debug) << "Processing event done";
   }
 
-  void fillSupermoduleHistograms(int supermoduleID, int col, int row, double amplitude, double celltime)
-  {
-    // workaround to have the histogram names per supermodule
-    // handled as constexpr
-    switch (supermoduleID) {
-      case 0:
-        supermoduleHistHelper<0>(col, row, amplitude, celltime);
-        break;
-      case 1:
-        supermoduleHistHelper<1>(col, row, amplitude, celltime);
-        break;
-      case 2:
-        supermoduleHistHelper<2>(col, row, amplitude, celltime);
-        break;
-      case 3:
-        supermoduleHistHelper<3>(col, row, amplitude, celltime);
-        break;
-      case 4:
-        supermoduleHistHelper<4>(col, row, amplitude, celltime);
-        break;
-      case 5:
-        supermoduleHistHelper<5>(col, row, amplitude, celltime);
-        break;
-      case 6:
-        supermoduleHistHelper<6>(col, row, amplitude, celltime);
-        break;
-      case 7:
-        supermoduleHistHelper<7>(col, row, amplitude, celltime);
-        break;
-      case 8:
-        supermoduleHistHelper<8>(col, row, amplitude, celltime);
-        break;
-      case 9:
-        supermoduleHistHelper<9>(col, row, amplitude, celltime);
-        break;
-      case 10:
-        supermoduleHistHelper<10>(col, row, amplitude, celltime);
-        break;
-      case 11:
-        supermoduleHistHelper<11>(col, row, amplitude, celltime);
-        break;
-      case 12:
-        supermoduleHistHelper<12>(col, row, amplitude, celltime);
-        break;
-      case 13:
-        supermoduleHistHelper<13>(col, row, amplitude, celltime);
-        break;
-      case 14:
-        supermoduleHistHelper<14>(col, row, amplitude, celltime);
-        break;
-      case 15:
-        supermoduleHistHelper<15>(col, row, amplitude, celltime);
-        break;
-      case 16:
-        supermoduleHistHelper<16>(col, row, amplitude, celltime);
-        break;
-      case 17:
-        supermoduleHistHelper<17>(col, row, amplitude, celltime);
-        break;
-      case 18:
-        supermoduleHistHelper<18>(col, row, amplitude, celltime);
-        break;
-      case 19:
-        supermoduleHistHelper<19>(col, row, amplitude, celltime);
-        break;
-      default:
-        break;
-    };
-  }
-
-  template <int supermoduleID>
-  void supermoduleHistHelper(int col, int row, double amplitude, double celltime)
+  /// \brief Fill a histogram with the cell ID on the y axis
+  /// \param hist Histogram to be filled
+  /// \param x Value on the x axis
+  /// \param cellID Abs. ID of the cell
+  ///
+  /// The bins of a cell are a contiguous row of the bin array, the bin of the
+  /// cell is found from its ID without searching the y axis.
+  void fillCellHistogram(TH2* hist, double x, int cellID)
   {
-    static constexpr std::string_view cellAmpHistSM[20] = {"cellAmplitudeSM/cellAmpSM0", "cellAmplitudeSM/cellAmpSM1", "cellAmplitudeSM/cellAmpSM2", "cellAmplitudeSM/cellAmpSM3", "cellAmplitudeSM/cellAmpSM4", "cellAmplitudeSM/cellAmpSM5", "cellAmplitudeSM/cellAmpSM6", "cellAmplitudeSM/cellAmpSM7", "cellAmplitudeSM/cellAmpSM8", "cellAmplitudeSM/cellAmpSM9", "cellAmplitudeSM/cellAmpSM10", "cellAmplitudeSM/cellAmpSM11", "cellAmplitudeSM/cellAmpSM12", "cellAmplitudeSM/cellAmpSM13", "cellAmplitudeSM/cellAmpSM14", "cellAmplitudeSM/cellAmpSM15", "cellAmplitudeSM/cellAmpSM16", "cellAmplitudeSM/cellAmpSM17", "cellAmplitudeSM/cellAmpSM18", "cellAmplitudeSM/cellAmpSM19"};
-    static constexpr std::string_view cellCountHistSM[20] = {"cellCountSM/cellCountSM0", "cellCountSM/cellCountSM1", "cellCountSM/cellCountSM2", "cellCountSM/cellCountSM3", "cellCountSM/cellCountSM4", "cellCountSM/cellCountSM5", "cellCountSM/cellCountSM6", "cellCountSM/cellCountSM7", "cellCountSM/cellCountSM8", "cellCountSM/cellCountSM9", "cellCountSM/cellCountSM10", "cellCountSM/cellCountSM11", "cellCountSM/cellCountSM12", "cellCountSM/cellCountSM13", "cellCountSM/cellCountSM14", "cellCountSM/cellCountSM15", "cellCountSM/cellCountSM16", "cellCountSM/cellCountSM17", "cellCountSM/cellCountSM18", "cellCountSM/cellCountSM19"};
-    static constexpr std::string_view cellAmpTimeHist[20] = {"cellAmplitudeTime/cellAmpTimeCorrSM0", "cellAmplitudeTime/cellAmpTimeCorrSM1", "cellAmplitudeTime/cellAmpTimeCorrSM2", "cellAmplitudeTime/cellAmpTimeCorrSM3", "cellAmplitudeTime/cellAmpTimeCorrSM4", "cellAmplitudeTime/cellAmpTimeCorrSM5", "cellAmplitudeTime/cellAmpTimeCorrSM6", "cellAmplitudeTime/cellAmpTimeCorrSM7", "cellAmplitudeTime/cellAmpTimeCorrSM8", "cellAmplitudeTime/cellAmpTimeCorrSM9", "cellAmplitudeTime/cellAmpTimeCorrSM10", "cellAmplitudeTime/cellAmpTimeCorrSM11", "cellAmplitudeTime/cellAmpTimeCorrSM12", "cellAmplitudeTime/cellAmpTimeCorrSM13", "cellAmplitudeTime/cellAmpTimeCorrSM14", "cellAmplitudeTime/cellAmpTimeCorrSM15", "cellAmplitudeTime/cellAmpTimeCorrSM16", "cellAmplitudeTime/cellAmpTimeCorrSM17", "cellAmplitudeTime/cellAmpTimeCorrSM18", "cellAmplitudeTime/cellAmpTimeCorrSM19"};
-    mHistManager.fill(HIST(cellAmpHistSM[supermoduleID]), col, row);
-    mHistManager.fill(HIST(cellCountHistSM[supermoduleID]), col, row, amplitude);
-    mHistManager.fill(HIST(cellAmpTimeHist[supermoduleID]), celltime, amplitude);
+    hist->AddBinContent(hist->GetXaxis()->FindFixBin(x) + (hist->GetNbinsX() + 2) * (cellID + 1));
   }
 
   /// \brief Check if a cell is masked
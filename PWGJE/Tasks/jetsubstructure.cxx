@@ -71,53 +71,109 @@ struct JetSubstructure {
 
   //Filter jetCuts = aod::jet::pt > f_jetPtMin; //how does this work?
 
-  void process(aod::Jet const& jet,
-               aod::Tracks const& tracks,
-               aod::JetTrackConstituents const& constituents,
-               aod::JetConstituentsSub const& constituentsSub)
+  int nsd;
+  float zg;
+  float rg;
+  bool softDropped;
+
+  void resetSoftDrop()
   {
-    jetConstituents.clear();
-    jetReclustered.clear();
-    if (b_DoConstSub) {
-      for (const auto& constituent : constituentsSub) {
-        fillConstituents(constituent, jetConstituents);
-      }
-    } else {
-      for (const auto& constituentIndex : constituents) {
-        auto constituent = constituentIndex.track();
-        fillConstituents(constituent, jetConstituents);
+    nsd = 0;
+    zg = -1.0;
+    rg = -1.0;
+    softDropped = false;
+  }
+
+  /// Applies the soft drop condition to the next splitting along the harder branch
+  void testSoftDrop(float z, float r)
+  {
+    if (z >= f_zCut * TMath::Power(r / f_jetR, f_beta)) {
+      if (!softDropped) {
+        zg = z;
+        rg = r;
+        hZg->Fill(zg);
+        hRg->Fill(rg);
+        softDropped = true;
       }
+      nsd++;
     }
+  }
+
+  void fillSoftDrop()
+  {
+    hNsd->Fill(nsd);
+    jetSubstructure(zg, rg, nsd);
+  }
+
+  /// Reclusters jetConstituents with Cambridge/Aachen and applies the soft drop along the harder branch
+  void reclusterAndSoftDrop()
+  {
     fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
     jetReclustered = sorted_by_pt(jetReclustered);
     fastjet::PseudoJet daughterSubJet = jetReclustered[0];
     fastjet::PseudoJet parentSubJet1;
     fastjet::PseudoJet parentSubJet2;
-    bool softDropped = false;
-    int nsd = 0.0;
-    auto zg = -1.0;
-    auto rg = -1.0;
+    resetSoftDrop();
     while (daughterSubJet.has_parents(parentSubJet1, parentSubJet2)) {
       if (parentSubJet1.perp() < parentSubJet2.perp()) {
         std::swap(parentSubJet1, parentSubJet2);
       }
       auto z = parentSubJet2.perp() / (parentSubJet1.perp() + parentSubJet2.perp());
       auto r = parentSubJet1.delta_R(parentSubJet2);
-      if (z >= f_zCut * TMath::Power(r / f_jetR, f_beta)) {
-        if (!softDropped) {
-          zg = z;
-          rg = r;
-          hZg->Fill(zg);
-          hRg->Fill(rg);
-          softDropped = true;
-        }
-        nsd++;
-      }
+      testSoftDrop(z, r);
       daughterSubJet = parentSubJet1;
     }
-    hNsd->Fill(nsd);
-    jetSubstructure(zg, rg, nsd);
+    fillSoftDrop();
+  }
+
+  void processReclustering(aod::Jet const& jet,
+                           aod::Tracks const& tracks,
+                           aod::JetTrackConstituents const& constituents,
+                           aod::JetConstituentsSub const& constituentsSub)
+  {
+    jetConstituents.clear();
+    jetReclustered.clear();
+    if (b_DoConstSub) {
+      for (const auto& constituent : constituentsSub) {
+        fillConstituents(constituent, jetConstituents);
+      }
+    } else {
+      for (const auto& constituentIndex : constituents) {
+        auto constituent = constituentIndex.track();
+        fillConstituents(constituent, jetConstituents);
+      }
+    }
+    reclusterAndSoftDrop();
+  }
+  PROCESS_SWITCH(JetSubstructure, processReclustering, "reclustering of the jet constituents", true);
+
+  // Same as processReclustering, the constituents are read from the packed table of the jet finder
+  // (fillPackedConstituents) instead of the tracks
+  void processReclusteringPacked(aod::Jet const& jet,
+                                 aod::JetPackedConstituents const& constituents)
+  {
+    jetConstituents.clear();
+    jetReclustered.clear();
+    for (const auto& constituent : constituents) {
+      fillConstituents(constituent, jetConstituents);
+    }
+    reclusterAndSoftDrop();
+  }
+  PROCESS_SWITCH(JetSubstructure, processReclusteringPacked, "reclustering of the packed jet constituents", false);
+
+  // The declustering stored by the jet finder (fillSplittings) is scanned, no reclustering is needed, so that
+  // grooming settings can be varied cheaply. The splittings of the jet finder are computed from the constituents
+  // which were clustered, i.e. the subtracted ones when the jet finder runs with constituent subtraction.
+  void processSplittings(aod::Jet const& jet,
+                         aod::JetSplittings const& splittings)
+  {
+    resetSoftDrop();
+    for (const auto& splitting : splittings) {
+      testSoftDrop(splitting.z(), splitting.deltaR());
+    }
+    fillSoftDrop();
   }
+  PROCESS_SWITCH(JetSubstructure, processSplittings, "soft drop from the splittings stored by the jet finder", false);
 };
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
@@ -0,0 +1,50 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   LFMcGenPrimaries.h
+/// \brief  Table of the generated physical primaries, for the denominators of the LF efficiencies.
+///         It is filled by lf-mc-gen-primaries in one pass over the McParticles, so that the
+///         spectra tasks run in the same train read only the primaries, with their kinematics.
+///
+
+#ifndef PWGLF_DATAMODEL_LFMCGENPRIMARIES_H_
+#define PWGLF_DATAMODEL_LFMCGENPRIMARIES_H_
+
+#include "Framework/ASoA.h"
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace lfmcgenprimary
+{
+DECLARE_SOA_INDEX_COLUMN(McCollision, mcCollision); //! MC collision of the particle
+DECLARE_SOA_INDEX_COLUMN(McParticle, mcParticle);   //! MC particle
+DECLARE_SOA_COLUMN(PdgCode, pdgCode, int);          //! PDG code
+DECLARE_SOA_COLUMN(Pt, pt, float);                  //! Transverse momentum (GeV/c)
+DECLARE_SOA_COLUMN(P, p, float);                    //! Momentum (GeV/c)
+DECLARE_SOA_COLUMN(Eta, eta, float);                //! Pseudorapidity
+DECLARE_SOA_COLUMN(Phi, phi, float);                //! Azimuthal angle
+DECLARE_SOA_COLUMN(Y, y, float);                    //! Rapidity
+} // namespace lfmcgenprimary
+
+DECLARE_SOA_TABLE(LfMcGenPrimaries, "AOD", "LFMCGENPRIM", //! Generated physical primaries, sorted by MC collision
+                  lfmcgenprimary::McCollisionId,
+                  lfmcgenprimary::McParticleId,
+                  lfmcgenprimary::PdgCode,
+                  lfmcgenprimary::Pt,
+                  lfmcgenprimary::P,
+                  lfmcgenprimary::Eta,
+                  lfmcgenprimary::Phi,
+                  lfmcgenprimary::Y);
+} // namespace o2::aod
+
+#endif // PWGLF_DATAMODEL_LFMCGENPRIMARIES_H_
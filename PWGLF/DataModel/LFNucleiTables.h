@@ -17,6 +17,7 @@
 
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
+#include "Common/DataModel/PIDResponse.h"
 
 #ifndef PWGLF_DATAMODEL_LFNUCLEITABLES_H_
 #define PWGLF_DATAMODEL_LFNUCLEITABLES_H_
@@ -128,6 +129,64 @@ DECLARE_SOA_TABLE(LfCandNucleusFull, "AOD", "LFNUCL",
                   full::TPCCrossedRowsOverFindableCls,
                   full::TPCChi2Ncl,
                   full::ITSChi2NCl);
+
+// Reduced candidate table for the nuclei analyses: only the nuclei PID hypotheses and the variables used in the selections.
+// The n-sigma are in LfCandNucleusNSigma or, quantised, in LfCandNucleusNSigmaStore, both joinable with it
+DECLARE_SOA_TABLE(LfCandNucleusLite, "AOD", "LFNUCLLITE",
+                  o2::soa::Index<>,
+                  full::LfCandNucleusFullEventId,
+                  full::DcaXY,
+                  full::DcaZ,
+                  full::HasTOF,
+                  full::TPCInnerParam,
+                  full::TPCSignal,
+                  full::Beta,
+                  full::Pt,
+                  full::Eta,
+                  full::Phi,
+                  full::Sign,
+                  full::TPCNClsCrossedRows,
+                  full::TPCChi2Ncl,
+                  full::ITSChi2NCl);
+DECLARE_SOA_TABLE(LfCandNucleusNSigma, "AOD", "LFNUCLNSIGMA",
+                  full::TPCNSigmaPr, full::TPCNSigmaDe, full::TPCNSigmaTr, full::TPCNSigmaHe, full::TPCNSigmaAl,
+                  full::TOFNSigmaPr, full::TOFNSigmaDe, full::TOFNSigmaTr, full::TOFNSigmaHe, full::TOFNSigmaAl);
+
+namespace fullStore
+{
+using binning = o2::aod::pidutils::binningPolicy<int8_t, 800, true>; // 8 bit in [-8, 8], bins narrower close to zero
+DECLARE_SOA_COLUMN(TPCNSigmaStorePr, tpcNSigmaStorePr, binning::binned_t); //! Stored binned nsigma with the TPC detector for proton
+DECLARE_SOA_COLUMN(TPCNSigmaStoreDe, tpcNSigmaStoreDe, binning::binned_t); //! Stored binned nsigma with the TPC detector for deuteron
+DECLARE_SOA_COLUMN(TPCNSigmaStoreTr, tpcNSigmaStoreTr, binning::binned_t); //! Stored binned nsigma with the TPC detector for triton
+DECLARE_SOA_COLUMN(TPCNSigmaStoreHe, tpcNSigmaStoreHe, binning::binned_t); //! Stored binned nsigma with the TPC detector for helium3
+DECLARE_SOA_COLUMN(TPCNSigmaStoreAl, tpcNSigmaStoreAl, binning::binned_t); //! Stored binned nsigma with the TPC detector for alpha
+DECLARE_SOA_COLUMN(TOFNSigmaStorePr, tofNSigmaStorePr, binning::binned_t); //! Stored binned nsigma with the TOF detector for proton
+DECLARE_SOA_COLUMN(TOFNSigmaStoreDe, tofNSigmaStoreDe, binning::binned_t); //! Stored binned nsigma with the TOF detector for deuteron
+DECLARE_SOA_COLUMN(TOFNSigmaStoreTr, tofNSigmaStoreTr, binning::binned_t); //! Stored binned nsigma with the TOF detector for triton
+DECLARE_SOA_COLUMN(TOFNSigmaStoreHe, tofNSigmaStoreHe, binning::binned_t); //! Stored binned nsigma with the TOF detector for helium3
+DECLARE_SOA_COLUMN(TOFNSigmaStoreAl, tofNSigmaStoreAl, binning::binned_t); //! Stored binned nsigma with the TOF detector for alpha
+DEFINE_UNWRAP_NSIGMA_COLUMN(TPCNSigmaPr, tpcNSigmaPr); //! Unwrapped (float) nsigma with the TPC detector for proton
+DEFINE_UNWRAP_NSIGMA_COLUMN(TPCNSigmaDe, tpcNSigmaDe); //! Unwrapped (float) nsigma with the TPC detector for deuteron
+DEFINE_UNWRAP_NSIGMA_COLUMN(TPCNSigmaTr, tpcNSigmaTr); //! Unwrapped (float) nsigma with the TPC detector for triton
+DEFINE_UNWRAP_NSIGMA_COLUMN(TPCNSigmaHe, tpcNSigmaHe); //! Unwrapped (float) nsigma with the TPC detector for helium3
+DEFINE_UNWRAP_NSIGMA_COLUMN(TPCNSigmaAl, tpcNSigmaAl); //! Unwrapped (float) nsigma with the TPC detector for alpha
+DEFINE_UNWRAP_NSIGMA_COLUMN(TOFNSigmaPr, tofNSigmaPr); //! Unwrapped (float) nsigma with the TOF detector for proton
+DEFINE_UNWRAP_NSIGMA_COLUMN(TOFNSigmaDe, tofNSigmaDe); //! Unwrapped (float) nsigma with the TOF detector for deuteron
+DEFINE_UNWRAP_NSIGMA_COLUMN(TOFNSigmaTr, tofNSigmaTr); //! Unwrapped (float) nsigma with the TOF detector for triton
+DEFINE_UNWRAP_NSIGMA_COLUMN(TOFNSigmaHe, tofNSigmaHe); //! Unwrapped (float) nsigma with the TOF detector for helium3
+DEFINE_UNWRAP_NSIGMA_COLUMN(TOFNSigmaAl, tofNSigmaAl); //! Unwrapped (float) nsigma with the TOF detector for alpha
+} // namespace fullStore
+
+DECLARE_SOA_TABLE(LfCandNucleusNSigmaStore, "AOD", "LFNUCLNSIGMAST",
+                  fullStore::TPCNSigmaStorePr, fullStore::TPCNSigmaStoreDe, fullStore::TPCNSigmaStoreTr, fullStore::TPCNSigmaStoreHe, fullStore::TPCNSigmaStoreAl,
+                  fullStore::TOFNSigmaStorePr, fullStore::TOFNSigmaStoreDe, fullStore::TOFNSigmaStoreTr, fullStore::TOFNSigmaStoreHe, fullStore::TOFNSigmaStoreAl,
+                  fullStore::TPCNSigmaPr<fullStore::TPCNSigmaStorePr>, fullStore::TPCNSigmaDe<fullStore::TPCNSigmaStoreDe>,
+                  fullStore::TPCNSigmaTr<fullStore::TPCNSigmaStoreTr>, fullStore::TPCNSigmaHe<fullStore::TPCNSigmaStoreHe>,
+                  fullStore::TPCNSigmaAl<fullStore::TPCNSigmaStoreAl>,
+                  fullStore::TOFNSigmaPr<fullStore::TOFNSigmaStorePr>, fullStore::TOFNSigmaDe<fullStore::TOFNSigmaStoreDe>,
+                  fullStore::TOFNSigmaTr<fullStore::TOFNSigmaStoreTr>, fullStore::TOFNSigmaHe<fullStore::TOFNSigmaStoreHe>,
+                  fullStore::TOFNSigmaAl<fullStore::TOFNSigmaStoreAl>);
+
 DECLARE_SOA_TABLE(LfCandNucleusMC, "AOD", "LFNUCLMC",
                   mcparticle::PdgCode,
                   full::IsPhysicalPrimary,
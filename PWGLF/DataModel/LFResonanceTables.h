@@ -97,6 +97,10 @@ DECLARE_SOA_COLUMN(TransRadius, transRadius, float);                   //! Trans
 DECLARE_SOA_COLUMN(DecayVtxX, decayVtxX, float);                       //! X position of the decay vertex
 DECLARE_SOA_COLUMN(DecayVtxY, decayVtxY, float);                       //! Y position of the decay vertex
 DECLARE_SOA_COLUMN(DecayVtxZ, decayVtxZ, float);                       //! Z position of the decay vertex
+DECLARE_SOA_COLUMN(EPi, ePi, float);                                   //! Energy under the pion mass hypothesis (GeV)
+DECLARE_SOA_COLUMN(EKa, eKa, float);                                   //! Energy under the kaon mass hypothesis (GeV)
+DECLARE_SOA_COLUMN(EPr, ePr, float);                                   //! Energy under the proton mass hypothesis (GeV)
+DECLARE_SOA_COLUMN(PIDMask, pidMask, uint8_t);                         //! Combined TPC and TOF (if available) PID selection, PDGtype bits
 // For MC
 DECLARE_SOA_COLUMN(IsPhysicalPrimary, isPhysicalPrimary, bool);
 DECLARE_SOA_COLUMN(ProducedByGenerator, producedByGenerator, bool);
@@ -128,6 +132,16 @@ DECLARE_SOA_TABLE(ResoTracks, "AOD", "RESOTRACKS",
                   o2::aod::pidtof::TOFNSigmaPr);
 using ResoTrack = ResoTracks::iterator;
 
+// Optional, joinable with ResoTracks: energies under the standard mass hypotheses and combined PID selection,
+// so that the pair loops of the resonance tasks only need to add the four-momenta
+DECLARE_SOA_TABLE(ResoTrackHypos, "AOD", "RESOTRKHYPO",
+                  resodaughter::EPi,
+                  resodaughter::EKa,
+                  resodaughter::EPr,
+                  resodaughter::PIDMask);
+using ResoTrackHypo = ResoTrackHypos::iterator;
+using ResoTracksWithHypos = soa::Join<ResoTracks, ResoTrackHypos>;
+
 DECLARE_SOA_TABLE(ResoV0s, "AOD", "RESOV0S",
                   o2::soa::Index<>,
                   resodaughter::ResoCollisionId,
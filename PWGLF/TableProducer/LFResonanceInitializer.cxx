@@ -41,6 +41,7 @@ struct reso2initializer {
 
   Produces<aod::ResoCollisions> resoCollisions;
   Produces<aod::ResoTracks> reso2trks;
+  Produces<aod::ResoTrackHypos> reso2trkhypos;
   Produces<aod::ResoV0s> reso2v0s;
   Produces<aod::ResoMCTracks> reso2mctracks;
   Produces<aod::ResoMCParents> reso2mcparents;
@@ -48,6 +49,7 @@ struct reso2initializer {
   // Configurables
   Configurable<bool> ConfIsRun3{"ConfIsRun3", false, "Running on Pilot beam"}; // Choose if running on converted data or pilot beam
   Configurable<bool> ConfStoreV0{"ConfStoreV0", true, "True: store V0s"};
+  Configurable<bool> ConfStoreMassHypotheses{"ConfStoreMassHypotheses", false, "True: store the track energies under the pi, K, p hypotheses and the combined PID mask (ResoTrackHypos, joinable with ResoTracks)"};
 
   /// Event cuts
   o2::analysis::CollisonCuts colCuts;
@@ -115,6 +117,10 @@ struct reso2initializer {
   using ResoV0s = aod::V0Datas;
   using ResoV0sMC = soa::Join<ResoV0s, aod::McV0Labels>;
 
+  const float massPi = RecoDecay::getMassPDG(kPiPlus);
+  const float massKa = RecoDecay::getMassPDG(kKPlus);
+  const float massPr = RecoDecay::getMassPDG(kProton);
+
   Preslice<soa::Filtered<ResoTracks>> tracksbyCollisionID = aod::track::collisionId;
   Preslice<ResoV0s> v0sbyCollisionID = aod::v0data::collisionId;
 
@@ -216,6 +222,17 @@ struct reso2initializer {
                 track.tofNSigmaPi(),
                 track.tofNSigmaKa(),
                 track.tofNSigmaPr());
+      if (ConfStoreMassHypotheses) {
+        // TPC selection, confirmed by TOF when the track has TOF
+        uint8_t pidMask = tpcPIDselections;
+        if (track.hasTOF())
+          pidMask &= tofPIDselections;
+        const float p2 = track.p() * track.p();
+        reso2trkhypos(std::sqrt(p2 + massPi * massPi),
+                      std::sqrt(p2 + massKa * massKa),
+                      std::sqrt(p2 + massPr * massPr),
+                      pidMask);
+      }
       if constexpr (isMC) {
         fillMCTracks(track);
       }
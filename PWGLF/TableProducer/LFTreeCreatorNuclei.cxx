@@ -38,7 +38,9 @@
 #include <TLorentzVector.h>
 #include <TMath.h>
 #include <TObjArray.h>
+#include <array>
 #include <cmath>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -49,12 +51,21 @@ struct LfTreeCreatorNuclei {
   Produces<o2::aod::LfCandNucleusFullEvents> tableEvents;
   Produces<o2::aod::LfCandNucleusFull> tableCandidate;
   Produces<o2::aod::LfCandNucleusMC> tableCandidateMC;
+  Produces<o2::aod::LfCandNucleusLite> tableCandidateLite;
+  Produces<o2::aod::LfCandNucleusNSigma> tableCandidateNSigma;
+  Produces<o2::aod::LfCandNucleusNSigmaStore> tableCandidateNSigmaStore;
 
   void init(o2::framework::InitContext&)
   {
     if (doprocessData == true && doprocessMC == true) {
       LOGF(fatal, "Cannot enable processData and processMC at the same time. Please choose one.");
     }
+    if (cfgPrefilterSpecies.value < 0 || cfgPrefilterSpecies.value >= (1 << kNSpecies)) {
+      LOGF(fatal, "Prefilter species mask %d out of range, the species are Pr, De, Tr, He, Al in the bits 0 to %d", cfgPrefilterSpecies.value, kNSpecies - 1);
+    }
+    if (cfgQuantisedNSigma && !cfgWriteLite) {
+      LOGF(fatal, "The quantised n-sigma are only written with the reduced candidate table, enable cfgWriteLite");
+    }
   }
 
   // track
@@ -67,6 +78,12 @@ struct LfTreeCreatorNuclei {
   Configurable<float> nsigmacutHigh{"nsigmacutHigh", +8.0, "Value of the Nsigma cut"};
   Configurable<int> trackSelType{"trackSelType", 0, "Option for the track cut: 0 isGlobalTrackWoDCA, 1 isGlobalTrack"};
 
+  // prefilter and output format
+  Configurable<int> cfgPrefilterSpecies{"cfgPrefilterSpecies", 0, "Bitmask of the species (1 Pr, 2 De, 4 Tr, 8 He, 16 Al) of which the candidates must be compatible with the TPC n-sigma within [nsigmacutLow, nsigmacutHigh], 0 to write all the tracks"};
+  Configurable<bool> cfgPrefilterRequireTOF{"cfgPrefilterRequireTOF", false, "Require also the TOF n-sigma of the same species within [nsigmacutLow, nsigmacutHigh] in the prefilter"};
+  Configurable<bool> cfgWriteLite{"cfgWriteLite", false, "Write the reduced candidate table LfCandNucleusLite with the n-sigma of the nuclei only, instead of LfCandNucleusFull"};
+  Configurable<bool> cfgQuantisedNSigma{"cfgQuantisedNSigma", false, "Write the n-sigma of the reduced table quantised on 8 bit (LfCandNucleusNSigmaStore) instead of as floats (LfCandNucleusNSigma)"};
+
   // events
   Configurable<float> cfgCutVertex{"cfgCutVertex", 10.0f, "Accepted z-vertex range"};
   Configurable<bool> useEvsel{"useEvsel", true, "Use sel8 for run3 Event Selection"};
@@ -87,26 +104,61 @@ struct LfTreeCreatorNuclei {
                                     aod::pidTPCFullHe, aod::pidTOFFullHe,
                                     aod::pidTPCFullAl, aod::pidTOFFullAl>;
 
-  template <bool isMC, typename TrackType, typename CollisionType>
-  void fillForOneEvent(CollisionType const& collision, TrackType const& tracks)
+  // species of the prefilter, in the order of the bits of the masks
+  enum Species { kPr = 0,
+                 kDe,
+                 kTr,
+                 kHe,
+                 kAl,
+                 kNSpecies };
+
+  std::vector<uint8_t> tpcMasks;    // per track of the collision, bit set if the TPC n-sigma of the species is within the cut
+  std::vector<uint8_t> tofMasks;    // same for TOF, 0 for the tracks without TOF
+  std::vector<uint8_t> isCandidate; // per track of the collision, passing the prefilter
+
+  uint8_t nSigmaMask(std::array<float, kNSpecies> const& nSigma)
   {
-    // Filling event properties
-    tableEvents(collision.bcId(),
-                collision.numContrib(),
-                collision.posX(),
-                collision.posY(),
-                collision.posZ(),
-                collision.multFV0M(),
-                collision.sel8(),
-                collision.bc().runNumber());
+    uint8_t mask = 0;
+    for (int i = 0; i < kNSpecies; i++) {
+      if (nSigma[i] > nsigmacutLow && nSigma[i] < nsigmacutHigh) {
+        mask |= 1 << i;
+      }
+    }
+    return mask;
+  }
 
-    // Filling candidate properties
-    tableCandidate.reserve(tracks.size());
-    if constexpr (isMC) {
-      tableCandidateMC.reserve(tracks.size());
+  /// Computes the n-sigma masks of all the tracks of the collision in one pass, then the prefilter decision of each track
+  /// \return number of tracks passing the prefilter
+  template <typename TrackType>
+  int prefilter(TrackType const& tracks)
+  {
+    const int nTracks = tracks.size();
+    tpcMasks.resize(nTracks);
+    tofMasks.resize(nTracks);
+    isCandidate.resize(nTracks);
+    int i = 0;
+    for (const auto& track : tracks) {
+      tpcMasks[i] = nSigmaMask({track.tpcNSigmaPr(), track.tpcNSigmaDe(), track.tpcNSigmaTr(), track.tpcNSigmaHe(), track.tpcNSigmaAl()});
+      tofMasks[i] = track.hasTOF() ? nSigmaMask({track.tofNSigmaPr(), track.tofNSigmaDe(), track.tofNSigmaTr(), track.tofNSigmaHe(), track.tofNSigmaAl()}) : 0;
+      i++;
+    }
+    const uint8_t species = cfgPrefilterSpecies.value;
+    int nCandidates = 0;
+    for (i = 0; i < nTracks; i++) {
+      uint8_t selected = tpcMasks[i] & species;
+      if (cfgPrefilterRequireTOF) {
+        selected &= tofMasks[i];
+      }
+      isCandidate[i] = species == 0 || selected != 0;
+      nCandidates += isCandidate[i];
     }
-    for (auto& track : tracks) {
-      // auto const& mcParticle = track.mcParticle();
+    return nCandidates;
+  }
+
+  template <typename TrackType>
+  void fillCandidate(TrackType const& track)
+  {
+    if (!cfgWriteLite) {
       tableCandidate(
         tableEvents.lastIndex(),
         track.dcaXY(),
@@ -135,6 +187,74 @@ struct LfTreeCreatorNuclei {
         track.tpcCrossedRowsOverFindableCls(),
         track.tpcChi2NCl(),
         track.itsChi2NCl());
+      return;
+    }
+    tableCandidateLite(
+      tableEvents.lastIndex(),
+      track.dcaXY(),
+      track.dcaZ(),
+      track.hasTOF(),
+      track.tpcInnerParam(),
+      track.tpcSignal(),
+      track.beta(),
+      track.pt(),
+      track.eta(),
+      track.phi(),
+      track.sign(),
+      track.tpcNClsCrossedRows(),
+      track.tpcChi2NCl(),
+      track.itsChi2NCl());
+    if (cfgQuantisedNSigma) {
+      using binning = o2::aod::fullStore::binning;
+      tableCandidateNSigmaStore(
+        binning::pack(track.tpcNSigmaPr()), binning::pack(track.tpcNSigmaDe()), binning::pack(track.tpcNSigmaTr()),
+        binning::pack(track.tpcNSigmaHe()), binning::pack(track.tpcNSigmaAl()),
+        binning::pack(track.tofNSigmaPr()), binning::pack(track.tofNSigmaDe()), binning::pack(track.tofNSigmaTr()),
+        binning::pack(track.tofNSigmaHe()), binning::pack(track.tofNSigmaAl()));
+      return;
+    }
+    tableCandidateNSigma(
+      track.tpcNSigmaPr(), track.tpcNSigmaDe(), track.tpcNSigmaTr(), track.tpcNSigmaHe(), track.tpcNSigmaAl(),
+      track.tofNSigmaPr(), track.tofNSigmaDe(), track.tofNSigmaTr(), track.tofNSigmaHe(), track.tofNSigmaAl());
+  }
+
+  template <bool isMC, typename TrackType, typename CollisionType>
+  void fillForOneEvent(CollisionType const& collision, TrackType const& tracks)
+  {
+    // Filling event properties
+    tableEvents(collision.bcId(),
+                collision.numContrib(),
+                collision.posX(),
+                collision.posY(),
+                collision.posZ(),
+                collision.multFV0M(),
+                collision.sel8(),
+                collision.bc().runNumber());
+
+    // Prefilter of the whole collision, then the candidates are written in one block with the output tables reserved to their number
+    const int nCandidates = prefilter(tracks);
+    if (nCandidates == 0) {
+      return;
+    }
+    if (!cfgWriteLite) {
+      tableCandidate.reserve(nCandidates);
+    } else {
+      tableCandidateLite.reserve(nCandidates);
+      if (cfgQuantisedNSigma) {
+        tableCandidateNSigmaStore.reserve(nCandidates);
+      } else {
+        tableCandidateNSigma.reserve(nCandidates);
+      }
+    }
+    if constexpr (isMC) {
+      tableCandidateMC.reserve(nCandidates);
+    }
+    int i = 0;
+    for (const auto& track : tracks) {
+      if (!isCandidate[i++]) {
+        continue;
+      }
+      fillCandidate(track);
 
       if constexpr (isMC) { // Filling MC reco information
         if (track.has_mcParticle()) {
@@ -46,6 +46,8 @@
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
+#include "PWGLF/Utils/trackPropagationCache.h"
+#include "PWGLF/Utils/mcMotherLookup.h"
 #include "DetectorsBase/Propagator.h"
 #include "DetectorsBase/GeometryManager.h"
 #include "DataFormatsParameters/GRPObject.h"
@@ -113,6 +115,8 @@ struct cascadeBuilder {
   float maxSnp;  // max sine phi for propagation
   float maxStep; // max step size (cm) for propagation
   o2::base::MatLayerCylSet* lut = nullptr;
+  TrackParCovCache<> trackParCovCache; // parameters of the tracks of the collision, converted once
+  o2::analysis::TrackPropagationCache legPropagationCache; // V0 legs propagated with material corrections, shared by the cascades of a V0
 
   void init(InitContext& context)
   {
@@ -172,8 +176,12 @@ struct cascadeBuilder {
   }
 
   template <class TCascTracksTo>
-  void buildCascadeTable(aod::Collision const& collision, aod::V0Datas const& v0data, aod::Cascades const& cascades, Bool_t lRun3 = kTRUE)
+  void buildCascadeTable(aod::Collision const& collision, aod::V0Datas const& v0data, aod::Cascades const& cascades, TCascTracksTo const& tracks, Bool_t lRun3 = kTRUE)
   {
+    // V0 daughters are shared by all the cascades built with the same V0
+    trackParCovCache.setTracks(tracks);
+    legPropagationCache.setPropagation(d_bz, maxSnp, maxStep);
+    legPropagationCache.clear();
 
     // Define o2 fitter, 2-prong
     o2::vertexing::DCAFitterN<2> fitterV0, fitterCasc;
@@ -294,9 +302,9 @@ struct cascadeBuilder {
       std::array<float, 3> pvecbach = {0.};
 
       // Acquire basic tracks
-      auto pTrack = getTrackParCov(posTrackCast);
-      auto nTrack = getTrackParCov(negTrackCast);
-      auto bTrack = getTrackParCov(bachTrackCast);
+      auto pTrack = trackParCovCache.get(posTrackCast);
+      auto nTrack = trackParCovCache.get(negTrackCast);
+      auto bTrack = trackParCovCache.get(bachTrackCast);
       if (bachTrackCast.signed1Pt() > 0) {
         charge = +1;
       }
@@ -310,10 +318,6 @@ struct cascadeBuilder {
         double finalXpos = fitterV0.getTrack(0).getX();
         double finalXneg = fitterV0.getTrack(1).getX();
 
-        // Rotate to desired alpha
-        pTrack.rotateParam(fitterV0.getTrack(0).getAlpha());
-        nTrack.rotateParam(fitterV0.getTrack(1).getAlpha());
-
         // Retry closer to minimum with material corrections
         o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
         if (useMatCorrType == 1)
@@ -321,8 +325,9 @@ struct cascadeBuilder {
         if (useMatCorrType == 2)
           matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
 
-        o2::base::Propagator::Instance()->propagateToX(pTrack, finalXpos, d_bz, maxSnp, maxStep, matCorr);
-        o2::base::Propagator::Instance()->propagateToX(nTrack, finalXneg, d_bz, maxSnp, maxStep, matCorr);
+        // Rotate to desired alpha and propagate, the same V0 gives the same propagations for all its cascades
+        legPropagationCache.propagateToX(posTrackCast.globalIndex(), pTrack, fitterV0.getTrack(0).getAlpha(), finalXpos, matCorr);
+        legPropagationCache.propagateToX(negTrackCast.globalIndex(), nTrack, fitterV0.getTrack(1).getAlpha(), finalXneg, matCorr);
 
         nCand = fitterV0.process(pTrack, nTrack);
         if (nCand == 0) {
@@ -428,7 +433,7 @@ struct cascadeBuilder {
     }
   }
 
-  void processRun2(aod::Collision const& collision, aod::V0sLinked const&, aod::V0Datas const& v0data, aod::Cascades const& cascades, FullTracksExt const&, aod::BCsWithTimestamps const&)
+  void processRun2(aod::Collision const& collision, aod::V0sLinked const&, aod::V0Datas const& v0data, aod::Cascades const& cascades, FullTracksExt const& tracks, aod::BCsWithTimestamps const&)
   {
     hEventCounter->Fill(0.5);
 
@@ -437,11 +442,11 @@ struct cascadeBuilder {
     initCCDB(bc);
 
     // do cascades, typecase correctly into tracks
-    buildCascadeTable<FullTracksExt>(collision, v0data, cascades, kFALSE);
+    buildCascadeTable<FullTracksExt>(collision, v0data, cascades, tracks, kFALSE);
   }
   PROCESS_SWITCH(cascadeBuilder, processRun2, "Produce Run 2 cascade tables", true);
 
-  void processRun3(aod::Collision const& collision, aod::V0sLinked const&, aod::V0Datas const& v0data, aod::Cascades const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&)
+  void processRun3(aod::Collision const& collision, aod::V0sLinked const&, aod::V0Datas const& v0data, aod::Cascades const& cascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const&)
   {
     hEventCounter->Fill(0.5);
 
@@ -450,7 +455,7 @@ struct cascadeBuilder {
     initCCDB(bc);
 
     // do cascades, typecase correctly into tracksIU (Run 3 use case)
-    buildCascadeTable<FullTracksExtIU>(collision, v0data, cascades, kTRUE);
+    buildCascadeTable<FullTracksExtIU>(collision, v0data, cascades, tracks, kTRUE);
   }
   PROCESS_SWITCH(cascadeBuilder, processRun3, "Produce Run 3 cascade tables", false);
 };
@@ -471,6 +476,8 @@ struct cascadeLabelBuilder {
     },
   };
 
+  o2::analysis::McMotherLookup mcMothers; // mothers of the MC particles of the dataframe
+
   void init(InitContext const&) {}
 
   void processDoNotBuildLabels(aod::Collision const& collision)
@@ -479,8 +486,10 @@ struct cascadeLabelBuilder {
   }
   PROCESS_SWITCH(cascadeLabelBuilder, processDoNotBuildLabels, "Do not produce MC label tables", true);
 
-  void processBuildLabels(aod::Collision const& collision, aod::CascDataExt const& casctable, aod::V0sLinked const&, aod::V0Datas const& v0table, LabeledTracks const&, aod::McParticles const&)
+  // the whole dataframe is processed at once, so that the mothers of the MC particles are stored only once
+  void processBuildLabels(aod::CascDataExt const& casctable, aod::V0sLinked const&, aod::V0Datas const& v0table, LabeledTracks const&, aod::McParticles const& particlesMC)
   {
+    mcMothers.fill(particlesMC);
     for (auto& casc : casctable) {
       float lFillVal = 0.5f; // all considered V0s
       // Loop over those that actually have the corresponding V0 associated to them
@@ -502,37 +511,26 @@ struct cascadeLabelBuilder {
       auto lPosTrack = v0data.posTrack_as<LabeledTracks>();
 
       // Association check
-      // There might be smarter ways of doing this in the future
       if (lNegTrack.has_mcParticle() && lPosTrack.has_mcParticle() && lBachTrack.has_mcParticle()) {
-        auto lMCBachTrack = lBachTrack.mcParticle_as<aod::McParticles>();
-        auto lMCNegTrack = lNegTrack.mcParticle_as<aod::McParticles>();
-        auto lMCPosTrack = lPosTrack.mcParticle_as<aod::McParticles>();
+        const int lMCNegTrack = lNegTrack.mcParticleId();
+        const int lMCPosTrack = lPosTrack.mcParticleId();
         lFillVal = 2.5f;
 
         // Step 1: check if the mother is the same, go up a level
-        if (lMCNegTrack.has_mothers() && lMCPosTrack.has_mothers()) {
+        if (mcMothers.hasMothers(lMCNegTrack) && mcMothers.hasMothers(lMCPosTrack)) {
           lFillVal = 3.5f;
-          for (auto& lNegMother : lMCNegTrack.mothers_as<aod::McParticles>()) {
-            for (auto& lPosMother : lMCPosTrack.mothers_as<aod::McParticles>()) {
-              if (lNegMother == lPosMother) {
-                // if we got to this level, it means the mother particle exists and is the same
-                // now we have to go one level up and compare to the bachelor mother too
-                lFillVal = 4.5f;
-                for (auto& lV0Mother : lNegMother.mothers_as<aod::McParticles>()) {
-                  for (auto& lBachMother : lMCBachTrack.mothers_as<aod::McParticles>()) {
-                    if (lV0Mother == lBachMother) {
-                      lLabel = lV0Mother.globalIndex();
-                      lPt = lV0Mother.pt();
-                      lPDG = lV0Mother.pdgCode();
-                      lFillVal = 5.5f; // v0s with the same mother
-                    }
-                  }
-                } // end conditional V0-bach pair
-              }   // end neg = pos mother conditional
+          if (mcMothers.getCommonMother(lMCNegTrack, lMCPosTrack) >= 0) {
+            // the V0 mother exists, now compare its mother to the bachelor mother
+            lFillVal = 4.5f;
+            lLabel = mcMothers.getCascadeMother(lMCNegTrack, lMCPosTrack, lBachTrack.mcParticleId());
+            if (lLabel >= 0) {
+              lPt = mcMothers.getPt(lLabel);
+              lPDG = mcMothers.getPdgCode(lLabel);
+              lFillVal = 5.5f; // v0s with the same mother
             }
-          } // end loop neg/pos mothers
-        }   // end conditional of mothers existing
-      }     // end association check
+          }
+        } // end conditional of mothers existing
+      }   // end association check
 
       registry.fill(HIST("hLabelCounter"), lFillVal);
 
@@ -34,6 +34,9 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -43,6 +46,7 @@
 #include "ReconstructionDataFormats/Track.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/TwoProngPrecheck.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -60,6 +64,7 @@
 #include "TPDGCode.h"
 #include "TDatabasePDG.h"
 #include "PWGHF/Utils/utilsDebugLcToK0sP.h"
+#include "PWGLF/Utils/mcMotherLookup.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -137,11 +142,14 @@ struct lambdakzeroBuilder {
   Configurable<float> v0radius{"v0radius", 5.0, "v0radius"};
   Configurable<int> useMatCorrType{"useMatCorrType", 0, "0: none, 1: TGeo, 2: LUT"};
   Configurable<int> rejDiffCollTracks{"rejDiffCollTracks", 0, "rejDiffCollTracks"};
+  Configurable<float> precheckMaxDZ{"precheckMaxDZ", 10., "max z distance (cm) of the daughters at their crossing in xy to run the fitter (0: no z requirement, < 0: no analytic pre-check)"};
   Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> grpPath{"grpPath", "GLO/GRP/GRP", "Path of the grp file"};
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> lutPath{"lutPath", "GLO/Param/MatLUT", "Path of the Lut parametrization"};
   Configurable<std::string> geoPath{"geoPath", "GLO/Config/GeometryAligned", "Path of the geometry file"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads building the V0s of a collision, 1: serial building"};
+  Configurable<int> minV0sPerThread{"minV0sPerThread", 50, "Minimum number of V0s of a collision per building thread"};
 
   // for debugging
 #ifdef MY_DEBUG
@@ -167,6 +175,14 @@ struct lambdakzeroBuilder {
       ccdb->get<TGeoManager>(geoPath);
     }
 
+    if (nThreads > 1 && useMatCorrType == 1) {
+      LOGF(warning, "The material corrections with TGeo are not thread safe, building the V0s serially; use the LUT (useMatCorrType 2) for the parallel building");
+      nThreads.value = 1;
+    }
+    if (minV0sPerThread < 1) {
+      minV0sPerThread.value = 1;
+    }
+
     if (doprocessRun3 && doprocessRun2) {
       LOGF(fatal, "processRun3 and processRun2 are both set to true; try again with only one of them set to true");
     }
@@ -210,11 +226,37 @@ struct lambdakzeroBuilder {
     mRunNumber = bc.runNumber();
   }
 
-  template <class TCascTracksTo>
-  void buildLambdaKZeroTable(aod::Collision const& collision, aod::V0s const& V0s, Bool_t lRun3 = kTRUE)
+  // V0 candidate built from one entry of the V0 table
+  // it holds everything to be stored, so that the candidates can be built
+  // concurrently and stored afterwards in the V0 table order
+  struct V0Candidate {
+    int criteria = 1;   // number of passed selection steps, i.e. the filled bins of hV0Criteria
+    int exception = -1; // filled bin of hCatchedExceptions, -1 if the fitter was not called
+    bool accepted = false;
+    int posTrackId = -1;
+    int negTrackId = -1;
+    int collisionId = -1;
+    int v0Id = -1;
+    float posX = 0.f;
+    float negX = 0.f;
+    std::array<float, 3> pos = {0.};
+    std::array<float, 3> pvec0 = {0.};
+    std::array<float, 3> pvec1 = {0.};
+    float dcaV0Daughters = 0.f;
+    float dcaPosToPV = 0.f;
+    float dcaNegToPV = 0.f;
+  };
+
+  // per thread fitters for the parallel building
+  std::vector<o2::vertexing::DCAFitterN<2>> fitters;
+  std::vector<V0Candidate> v0candidates;
+  o2::analysis::TwoProngPrecheck precheck; // analytic pre-check of the pairs before the fitter, shared by the threads
+
+  void configureFitter(o2::vertexing::DCAFitterN<2>& fitter)
   {
-    // Define o2 fitter, 2-prong
-    o2::vertexing::DCAFitterN<2> fitter;
+    precheck.setEnabled(precheckMaxDZ >= 0.f);
+    precheck.setBz(d_bz);
+    precheck.setMaxDZ(precheckMaxDZ);
     fitter.setBz(d_bz);
     fitter.setPropagateToPCA(true);
     fitter.setMaxR(200.);
@@ -224,194 +266,249 @@ struct lambdakzeroBuilder {
     fitter.setMaxChi2(1e9);
     fitter.setUseAbsDCA(d_UseAbsDCA);
     fitter.setWeightedFinalPCA(d_UseWeightedPCA);
+  }
 
-    registry.fill(HIST("hEventCounter"), 0.5);
-
-    for (auto& V0 : V0s) {
-
-      // Track preselection part
-      auto posTrackCast = V0.posTrack_as<TCascTracksTo>();
-      auto negTrackCast = V0.negTrack_as<TCascTracksTo>();
+  template <class TCascTracksTo, typename TV0>
+  void buildV0Candidate(o2::vertexing::DCAFitterN<2>& fitter, aod::Collision const& collision, TV0 const& V0, Bool_t lRun3, V0Candidate& candidate)
+  {
+    // Track preselection part
+    auto posTrackCast = V0.template posTrack_as<TCascTracksTo>();
+    auto negTrackCast = V0.template negTrack_as<TCascTracksTo>();
 
 #ifdef MY_DEBUG
-      auto labelPos = posTrackCast.mcParticleId();
-      auto labelNeg = negTrackCast.mcParticleId();
-      bool isK0SfromLc = isK0SfromLcFunc(labelPos, labelNeg, v_labelK0Spos, v_labelK0Sneg);
+    auto labelPos = posTrackCast.mcParticleId();
+    auto labelNeg = negTrackCast.mcParticleId();
+    bool isK0SfromLc = isK0SfromLcFunc(labelPos, labelNeg, v_labelK0Spos, v_labelK0Sneg);
 #endif
-      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "V0 builder: found K0S from Lc, posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
-
-      // value 0.5: any considered V0
-      registry.fill(HIST("hV0Criteria"), 0.5);
-      if (isRun2) {
-        if (!(posTrackCast.trackType() & o2::aod::track::TPCrefit) && !lRun3) {
-          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack " << labelPos << " has no TPC refit");
-          v0dataLink(-1);
-          continue; // TPC refit
-        }
-        if (!(negTrackCast.trackType() & o2::aod::track::TPCrefit) && !lRun3) {
-          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "negTrack " << labelNeg << " has no TPC refit");
-          v0dataLink(-1);
-          continue; // TPC refit
-        }
-      }
-      // Passes TPC refit
-      registry.fill(HIST("hV0Criteria"), 1.5);
-      if (posTrackCast.tpcNClsCrossedRows() < mincrossedrows) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack " << labelPos << " has " << posTrackCast.tpcNClsCrossedRows() << " crossed rows, cut at " << mincrossedrows);
-        v0dataLink(-1);
-        continue;
-      }
-      if (negTrackCast.tpcNClsCrossedRows() < mincrossedrows) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "negTrack " << labelNeg << " has " << negTrackCast.tpcNClsCrossedRows() << " crossed rows, cut at " << mincrossedrows);
-        v0dataLink(-1);
-        continue;
-      }
-      // passes crossed rows
-      registry.fill(HIST("hV0Criteria"), 2.5);
-      if (fabs(posTrackCast.dcaXY()) < dcapostopv) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack " << labelPos << " has dcaXY " << posTrackCast.dcaXY() << " , cut at " << dcanegtopv);
-        v0dataLink(-1);
-        continue;
+    MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "V0 builder: found K0S from Lc, posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
+
+    // criteria 1: any considered V0
+    if (isRun2) {
+      if (!(posTrackCast.trackType() & o2::aod::track::TPCrefit) && !lRun3) {
+        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack " << labelPos << " has no TPC refit");
+        return; // TPC refit
       }
-      if (fabs(negTrackCast.dcaXY()) < dcanegtopv) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "negTrack " << labelNeg << " has dcaXY " << negTrackCast.dcaXY() << " , cut at " << dcanegtopv);
-        v0dataLink(-1);
-        continue;
+      if (!(negTrackCast.trackType() & o2::aod::track::TPCrefit) && !lRun3) {
+        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "negTrack " << labelNeg << " has no TPC refit");
+        return; // TPC refit
       }
-      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "Filling good indices: posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
-      // passes DCAxy
-      registry.fill(HIST("hV0Criteria"), 3.5);
+    }
+    // Passes TPC refit
+    candidate.criteria++;
+    if (posTrackCast.tpcNClsCrossedRows() < mincrossedrows) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack " << labelPos << " has " << posTrackCast.tpcNClsCrossedRows() << " crossed rows, cut at " << mincrossedrows);
+      return;
+    }
+    if (negTrackCast.tpcNClsCrossedRows() < mincrossedrows) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "negTrack " << labelNeg << " has " << negTrackCast.tpcNClsCrossedRows() << " crossed rows, cut at " << mincrossedrows);
+      return;
+    }
+    // passes crossed rows
+    candidate.criteria++;
+    if (fabs(posTrackCast.dcaXY()) < dcapostopv) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack " << labelPos << " has dcaXY " << posTrackCast.dcaXY() << " , cut at " << dcanegtopv);
+      return;
+    }
+    if (fabs(negTrackCast.dcaXY()) < dcanegtopv) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "negTrack " << labelNeg << " has dcaXY " << negTrackCast.dcaXY() << " , cut at " << dcanegtopv);
+      return;
+    }
+    MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "Filling good indices: posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
+    // passes DCAxy
+    candidate.criteria++;
 
-      // Candidate building part
-      std::array<float, 3> pos = {0.};
-      std::array<float, 3> pvec0 = {0.};
-      std::array<float, 3> pvec1 = {0.};
+    // Candidate building part
+    MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "labelPos = " << labelPos << ", labelNeg = " << labelNeg);
 
-#ifdef MY_DEBUG
-      auto labelPos = posTrackCast.mcParticleId();
-      auto labelNeg = negTrackCast.mcParticleId();
-      bool isK0SfromLc = isK0SfromLcFunc(labelPos, labelNeg, v_labelK0Spos, v_labelK0Sneg);
-#endif
+    auto pTrack = getTrackParCov(posTrackCast);
+    auto nTrack = getTrackParCov(negTrackCast);
 
-      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "labelPos = " << labelPos << ", labelNeg = " << labelNeg);
+    // Require collision-ID
+    if (posTrackCast.collisionId() != negTrackCast.collisionId() && rejDiffCollTracks) {
+      return;
+    }
 
-      auto pTrack = getTrackParCov(posTrackCast);
-      auto nTrack = getTrackParCov(negTrackCast);
+    // passes diff coll check
+    candidate.criteria++;
 
-      // Require collision-ID
-      if (posTrackCast.collisionId() != negTrackCast.collisionId() && rejDiffCollTracks) {
-        v0dataLink(-1);
-        continue;
-      }
+    // hopeless pairs are not fitted
+    if (!precheck.isCompatible(pTrack, nTrack)) {
+      return;
+    }
 
-      // passes diff coll check
-      registry.fill(HIST("hV0Criteria"), 4.5);
-
-      // Act on copies for minimization
-      auto pTrackCopy = o2::track::TrackParCov(pTrack);
-      auto nTrackCopy = o2::track::TrackParCov(nTrack);
-
-      //---/---/---/
-      // Move close to minima
-      int nCand = 0;
-      try {
-        nCand = fitter.process(pTrackCopy, nTrackCopy);
-        registry.fill(HIST("hCatchedExceptions"), 0.5f);
-      } catch (...) {
-        registry.fill(HIST("hCatchedExceptions"), 1.5f);
-        LOG(error) << "Exception caught in fitter.process";
-        continue;
-      }
+    // Act on copies for minimization
+    auto pTrackCopy = o2::track::TrackParCov(pTrack);
+    auto nTrackCopy = o2::track::TrackParCov(nTrack);
+
+    //---/---/---/
+    // Move close to minima
+    int nCand = 0;
+    try {
+      nCand = fitter.process(pTrackCopy, nTrackCopy);
+      candidate.exception = 0;
+    } catch (...) {
+      candidate.exception = 1;
+      LOG(error) << "Exception caught in fitter.process";
+      return;
+    }
 
-      if (nCand == 0) {
-        v0dataLink(-1);
-        continue;
-      }
+    if (nCand == 0) {
+      return;
+    }
 
-      // passes V0 fitter minimization successfully
-      registry.fill(HIST("hV0Criteria"), 5.5);
+    // passes V0 fitter minimization successfully
+    candidate.criteria++;
 
-      double finalXpos = fitter.getTrack(0).getX();
-      double finalXneg = fitter.getTrack(1).getX();
+    double finalXpos = fitter.getTrack(0).getX();
+    double finalXneg = fitter.getTrack(1).getX();
 
-      // Rotate to desired alpha
-      pTrack.rotateParam(fitter.getTrack(0).getAlpha());
-      nTrack.rotateParam(fitter.getTrack(1).getAlpha());
+    // Rotate to desired alpha
+    pTrack.rotateParam(fitter.getTrack(0).getAlpha());
+    nTrack.rotateParam(fitter.getTrack(1).getAlpha());
 
-      // Retry closer to minimum with material corrections
-      o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
-      if (useMatCorrType == 1)
-        matCorr = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
-      if (useMatCorrType == 2)
-        matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
+    // Retry closer to minimum with material corrections
+    o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
+    if (useMatCorrType == 1)
+      matCorr = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
+    if (useMatCorrType == 2)
+      matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
 
-      o2::base::Propagator::Instance()->propagateToX(pTrack, finalXpos, d_bz, maxSnp, maxStep, matCorr);
-      o2::base::Propagator::Instance()->propagateToX(nTrack, finalXneg, d_bz, maxSnp, maxStep, matCorr);
+    o2::base::Propagator::Instance()->propagateToX(pTrack, finalXpos, d_bz, maxSnp, maxStep, matCorr);
+    o2::base::Propagator::Instance()->propagateToX(nTrack, finalXneg, d_bz, maxSnp, maxStep, matCorr);
 
-      nCand = fitter.process(pTrack, nTrack);
-      if (nCand == 0) {
-        v0dataLink(-1);
-        continue;
-      }
+    nCand = fitter.process(pTrack, nTrack);
+    if (nCand == 0) {
+      return;
+    }
 
-      // Passes step 2 of V0 fitter
-      registry.fill(HIST("hV0Criteria"), 6.5);
+    // Passes step 2 of V0 fitter
+    candidate.criteria++;
 
-      pTrack.getPxPyPzGlo(pvec0);
-      nTrack.getPxPyPzGlo(pvec1);
+    pTrack.getPxPyPzGlo(candidate.pvec0);
+    nTrack.getPxPyPzGlo(candidate.pvec1);
 
-      const auto& vtx = fitter.getPCACandidate();
-      for (int i = 0; i < 3; i++) {
-        pos[i] = vtx[i];
-      }
+    const auto& vtx = fitter.getPCACandidate();
+    for (int i = 0; i < 3; i++) {
+      candidate.pos[i] = vtx[i];
+    }
+    const auto& pos = candidate.pos;
+    const auto& pvec0 = candidate.pvec0;
+    const auto& pvec1 = candidate.pvec1;
 
-      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "in builder 0: posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
+    MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "in builder 0: posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
 
-      // Apply selections so a skimmed table is created only
-      if (fitter.getChi2AtPCACandidate() > dcav0dau) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack --> " << labelPos << ", negTrack --> " << labelNeg << " will be skipped due to dca cut");
-        v0dataLink(-1);
-        continue;
-      }
+    // Apply selections so a skimmed table is created only
+    if (fitter.getChi2AtPCACandidate() > dcav0dau) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack --> " << labelPos << ", negTrack --> " << labelNeg << " will be skipped due to dca cut");
+      return;
+    }
 
-      // Passes DCA between daughters check
-      registry.fill(HIST("hV0Criteria"), 7.5);
+    // Passes DCA between daughters check
+    candidate.criteria++;
 
-      auto V0CosinePA = RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()}, array{pos[0], pos[1], pos[2]}, array{pvec0[0] + pvec1[0], pvec0[1] + pvec1[1], pvec0[2] + pvec1[2]});
-      if (V0CosinePA < v0cospa) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack --> " << labelPos << ", negTrack --> " << labelNeg << " will be skipped due to CPA cut");
-        v0dataLink(-1);
-        continue;
-      }
+    auto V0CosinePA = RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()}, array{pos[0], pos[1], pos[2]}, array{pvec0[0] + pvec1[0], pvec0[1] + pvec1[1], pvec0[2] + pvec1[2]});
+    if (V0CosinePA < v0cospa) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack --> " << labelPos << ", negTrack --> " << labelNeg << " will be skipped due to CPA cut");
+      return;
+    }
+
+    // Passes CosPA check
+    candidate.criteria++;
+
+    auto V0radius = RecoDecay::sqrtSumOfSquares(pos[0], pos[1]); // probably find better name to differentiate the cut from the variable
+    if (V0radius < v0radius) {
+      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack --> " << labelPos << ", negTrack --> " << labelNeg << " will be skipped due to radius cut");
+      return;
+    }
+
+    // Passes radius check
+    candidate.criteria++;
+
+    MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "in builder 1, keeping K0S candidate: posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
+
+    candidate.accepted = true;
+    candidate.posTrackId = V0.posTrackId();
+    candidate.negTrackId = V0.negTrackId();
+    candidate.collisionId = V0.collisionId();
+    candidate.v0Id = V0.globalIndex();
+    candidate.posX = fitter.getTrack(0).getX();
+    candidate.negX = fitter.getTrack(1).getX();
+    candidate.dcaV0Daughters = fitter.getChi2AtPCACandidate();
+    candidate.dcaPosToPV = posTrackCast.dcaXY();
+    candidate.dcaNegToPV = negTrackCast.dcaXY();
+  }
 
-      // Passes CosPA check
-      registry.fill(HIST("hV0Criteria"), 8.5);
+  void storeV0Candidate(V0Candidate const& candidate)
+  {
+    for (int i = 0; i < candidate.criteria; i++) {
+      registry.fill(HIST("hV0Criteria"), i + 0.5f);
+    }
+    if (candidate.exception >= 0) {
+      registry.fill(HIST("hCatchedExceptions"), candidate.exception + 0.5f);
+    }
+    if (!candidate.accepted) {
+      v0dataLink(-1);
+      return;
+    }
+    v0data(
+      candidate.posTrackId,
+      candidate.negTrackId,
+      candidate.collisionId,
+      candidate.v0Id,
+      candidate.posX, candidate.negX,
+      candidate.pos[0], candidate.pos[1], candidate.pos[2],
+      candidate.pvec0[0], candidate.pvec0[1], candidate.pvec0[2],
+      candidate.pvec1[0], candidate.pvec1[1], candidate.pvec1[2],
+      candidate.dcaV0Daughters,
+      candidate.dcaPosToPV,
+      candidate.dcaNegToPV);
+    v0dataLink(v0data.lastIndex());
+  }
 
-      auto V0radius = RecoDecay::sqrtSumOfSquares(pos[0], pos[1]); // probably find better name to differentiate the cut from the variable
-      if (V0radius < v0radius) {
-        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "posTrack --> " << labelPos << ", negTrack --> " << labelNeg << " will be skipped due to radius cut");
-        v0dataLink(-1);
-        continue;
+  template <class TCascTracksTo>
+  void buildLambdaKZeroTable(aod::Collision const& collision, aod::V0s const& V0s, Bool_t lRun3 = kTRUE)
+  {
+    registry.fill(HIST("hEventCounter"), 0.5);
+
+    const int nV0s = V0s.size();
+    const int nWorkers = std::min<int>(nThreads, nV0s / minV0sPerThread);
+    if (nWorkers < 2) {
+      // Define o2 fitter, 2-prong
+      o2::vertexing::DCAFitterN<2> fitter;
+      configureFitter(fitter);
+      for (auto& V0 : V0s) {
+        V0Candidate candidate;
+        buildV0Candidate<TCascTracksTo>(fitter, collision, V0, lRun3, candidate);
+        storeV0Candidate(candidate);
       }
+      return;
+    }
 
-      // Passes radius check
-      registry.fill(HIST("hV0Criteria"), 9.5);
-
-      MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "in builder 1, keeping K0S candidate: posTrack --> " << labelPos << ", negTrack --> " << labelNeg);
-
-      v0data(
-        V0.posTrackId(),
-        V0.negTrackId(),
-        V0.collisionId(),
-        V0.globalIndex(),
-        fitter.getTrack(0).getX(), fitter.getTrack(1).getX(),
-        pos[0], pos[1], pos[2],
-        pvec0[0], pvec0[1], pvec0[2],
-        pvec1[0], pvec1[1], pvec1[2],
-        fitter.getChi2AtPCACandidate(),
-        posTrackCast.dcaXY(),
-        negTrackCast.dcaXY());
-      v0dataLink(v0data.lastIndex());
+    // build the candidates of contiguous ranges of V0s in parallel, each thread with its own fitter,
+    // then store them in the V0 table order
+    fitters.resize(nWorkers);
+    for (auto& fitter : fitters) {
+      configureFitter(fitter);
+    }
+    v0candidates.assign(nV0s, V0Candidate{});
+    auto work = [&](int worker) {
+      const int first = int64_t(nV0s) * worker / nWorkers;
+      const int last = int64_t(nV0s) * (worker + 1) / nWorkers;
+      auto V0 = V0s.begin() + first;
+      for (int i = first; i < last; ++i, ++V0) {
+        buildV0Candidate<TCascTracksTo>(fitters[worker], collision, V0, lRun3, v0candidates[i]);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int worker = 1; worker < nWorkers; ++worker) {
+      workers.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    for (auto const& candidate : v0candidates) {
+      storeV0Candidate(candidate);
     }
   }
 
@@ -463,6 +560,8 @@ struct lambdakzeroLabelBuilder {
     },
   };
 
+  o2::analysis::McMotherLookup mcMothers; // mothers of the MC particles of the dataframe
+
   void init(InitContext const&) {}
 
   void processDoNotBuildLabels(aod::Collisions::iterator const& collision)
@@ -471,9 +570,10 @@ struct lambdakzeroLabelBuilder {
   }
   PROCESS_SWITCH(lambdakzeroLabelBuilder, processDoNotBuildLabels, "Do not produce MC label tables", true);
 
-  void processBuildLabels(aod::Collisions::iterator const& collision, aod::V0Datas const& v0table, LabeledTracks const&, aod::McParticles const& particlesMC)
-
+  // the whole dataframe is processed at once, so that the mothers of the MC particles are stored only once
+  void processBuildLabels(aod::V0Datas const& v0table, LabeledTracks const&, aod::McParticles const& particlesMC)
   {
+    mcMothers.fill(particlesMC);
     for (auto& v0 : v0table) {
 
       int lLabel = -1;
@@ -485,22 +585,12 @@ struct lambdakzeroLabelBuilder {
       auto lPosTrack = v0.posTrack_as<LabeledTracks>();
 
       // Association check
-      // There might be smarter ways of doing this in the future
       if (lNegTrack.has_mcParticle() && lPosTrack.has_mcParticle()) {
-        auto lMCNegTrack = lNegTrack.mcParticle_as<aod::McParticles>();
-        auto lMCPosTrack = lPosTrack.mcParticle_as<aod::McParticles>();
-        if (lMCNegTrack.has_mothers() && lMCPosTrack.has_mothers()) {
-
-          for (auto& lNegMother : lMCNegTrack.mothers_as<aod::McParticles>()) {
-            for (auto& lPosMother : lMCPosTrack.mothers_as<aod::McParticles>()) {
-              if (lNegMother.globalIndex() == lPosMother.globalIndex()) {
-                lLabel = lNegMother.globalIndex();
-                lPt = lNegMother.pt();
-                lPDG = lNegMother.pdgCode();
-                lFillVal = 1.5f; // v0s with the same mother
-              }
-            }
-          }
+        lLabel = mcMothers.getCommonMother(lNegTrack.mcParticleId(), lPosTrack.mcParticleId());
+        if (lLabel >= 0) {
+          lPt = mcMothers.getPt(lLabel);
+          lPDG = mcMothers.getPdgCode(lLabel);
+          lFillVal = 1.5f; // v0s with the same mother
         }
       } // end association check
       registry.fill(HIST("hLabelCounter"), lFillVal);
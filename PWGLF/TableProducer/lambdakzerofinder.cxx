@@ -34,8 +34,10 @@
 #include "Framework/ASoAHelpers.h"
 #include "DetectorsVertexing/DCAFitterN.h"
 #include "ReconstructionDataFormats/Track.h"
+#include "MathUtils/Primitive2D.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
+#include "Common/Core/TwoProngPrecheck.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "Common/Core/TrackSelection.h"
@@ -56,6 +58,8 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <algorithm>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -144,6 +148,26 @@ struct lambdakzerofinder {
   Configurable<float> dcav0dau{"dcav0dau", 1.0, "DCA V0 Daughters"};
   Configurable<float> v0radius{"v0radius", 5.0, "v0radius"};
 
+  // Pair pre-filtering, only the pairs of daughters close in phi at a reference radius and with crossing helices are fitted
+  Configurable<bool> useSortedWindows{"useSortedWindows", false, "only fit the pairs within the phi window, with sorted daughter lists"};
+  Configurable<float> refRadius{"refRadius", 10.0, "reference radius (cm) for the phi of the daughters"};
+  Configurable<float> phiWindow{"phiWindow", 0.5, "max |delta phi| (rad) of the daughters at the reference radius"};
+  Configurable<float> maxCircleDistance{"maxCircleDistance", 2.0, "max transverse distance (cm) of the daughter helices, negative to disable the check"};
+  Configurable<float> precheckMaxDZ{"precheckMaxDZ", 10., "max z distance (cm) of the daughters at their crossing in xy to run the fitter (0: no z requirement, < 0: no analytic pre-check)"};
+
+  /// Daughter candidate of the sorted finder mode
+  struct FinderTrack {
+    int64_t trackId;
+    int32_t collisionId;
+    float dcaXY;
+    float phiRef; // phi of the track position at the reference radius
+    o2::track::TrackParCov trackParCov;
+    o2::math_utils::CircleXYf_t circle;
+  };
+  std::vector<FinderTrack> posCandidates;
+  std::vector<FinderTrack> negCandidates;
+  o2::analysis::TwoProngPrecheck precheck; // analytic pre-check of the pairs before the fitter
+
   void init(InitContext& context)
   {
     // using namespace analysis::lambdakzerofinder;
@@ -169,6 +193,103 @@ struct lambdakzerofinder {
     return output;
   }
 
+  /// Fits one pair of daughters and stores the V0 if it passes the selections
+  /// \return true if the V0 was stored
+  template <typename TCollision>
+  bool buildV0(TCollision const& collision, o2::vertexing::DCAFitterN<2>& fitter, o2::track::TrackParCov const& posTrack, o2::track::TrackParCov const& negTrack,
+               int64_t posTrackId, int64_t negTrackId, int32_t collisionId, float posDcaXY, float negDcaXY)
+  {
+    // Try to progate to dca, for the pairs passing the analytic pre-check
+    int nCand = precheck.process(fitter, posTrack, negTrack);
+    if (nCand == 0) {
+      return false;
+    }
+    const auto& vtx = fitter.getPCACandidate();
+
+    // Fiducial: min radius
+    auto thisv0radius = TMath::Sqrt(TMath::Power(vtx[0], 2) + TMath::Power(vtx[1], 2));
+    if (thisv0radius < v0radius) {
+      return false;
+    }
+
+    // DCA V0 daughters
+    auto thisdcav0dau = fitter.getChi2AtPCACandidate();
+    if (thisdcav0dau > dcav0dau) {
+      return false;
+    }
+
+    std::array<float, 3> pos = {0.};
+    std::array<float, 3> pvec0;
+    std::array<float, 3> pvec1;
+    for (int i = 0; i < 3; i++) {
+      pos[i] = vtx[i];
+    }
+    fitter.getTrack(0).getPxPyPzGlo(pvec0);
+    fitter.getTrack(1).getPxPyPzGlo(pvec1);
+
+    auto thisv0cospa = RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()},
+                                      array{vtx[0], vtx[1], vtx[2]}, array{pvec0[0] + pvec1[0], pvec0[1] + pvec1[1], pvec0[2] + pvec1[2]});
+    if (thisv0cospa < v0cospa) {
+      return false;
+    }
+
+    v0(collisionId, posTrackId, negTrackId);
+    v0data(posTrackId, negTrackId, collisionId, 0,
+           fitter.getTrack(0).getX(), fitter.getTrack(1).getX(),
+           pos[0], pos[1], pos[2],
+           pvec0[0], pvec0[1], pvec0[2],
+           pvec1[0], pvec1[1], pvec1[2],
+           fitter.getChi2AtPCACandidate(),
+           posDcaXY, negDcaXY);
+    v0datalink(v0data.lastIndex());
+    return true;
+  }
+
+  /// Converts the prefiltered daughters once and computes the quantities of the pair pre-filter
+  template <typename TGoodTracks>
+  void fillCandidates(TGoodTracks const& goodTracks, std::vector<FinderTrack>& candidates, float bz)
+  {
+    candidates.clear();
+    candidates.reserve(goodTracks.size());
+    for (auto& goodTrack : goodTracks) {
+      auto track = goodTrack.template goodTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>();
+      FinderTrack candidate{track.globalIndex(), track.collisionId(), goodTrack.dcaXY(), 0.f, getTrackParCov(track), {}};
+      float sna, csa;
+      candidate.trackParCov.getCircleParams(bz, candidate.circle, sna, csa);
+      candidate.phiRef = getPhiAtRadius(candidate.trackParCov, candidate.circle, refRadius);
+      candidates.push_back(candidate);
+    }
+  }
+
+  /// Azimuth of the position of a primary-like track at radius r, from the chord between the origin and the point at r:
+  /// its direction is the one of the momentum at the origin turned by asin(r / 2R) in the sense of rotation of the track
+  static float getPhiAtRadius(o2::track::TrackParCov const& track, o2::math_utils::CircleXYf_t const& circle, float r)
+  {
+    const float phi0 = track.getPhi();
+    std::array<float, 3> xyz;
+    track.getXYZGlo(xyz);
+    // sense of rotation from the side of the centre with respect to the direction of motion
+    const float cross = std::cos(phi0) * (circle.yC - xyz[1]) - std::sin(phi0) * (circle.xC - xyz[0]);
+    const float turn = std::asin(std::min(1.f, r / (2.f * circle.rC)));
+    float phi = phi0 + (cross > 0.f ? turn : -turn);
+    if (phi >= 2.f * M_PI) {
+      phi -= 2.f * M_PI;
+    } else if (phi < 0.f) {
+      phi += 2.f * M_PI;
+    }
+    return phi;
+  }
+
+  /// Minimum transverse distance between two circles, zero if they cross
+  static float getCircleDistance(o2::math_utils::CircleXYf_t const& c1, o2::math_utils::CircleXYf_t const& c2)
+  {
+    const float d = std::hypot(c1.xC - c2.xC, c1.yC - c2.yC);
+    if (d > c1.rC + c2.rC) {
+      return d - c1.rC - c2.rC;
+    }
+    return std::max(0.f, std::abs(c1.rC - c2.rC) - d);
+  }
+
   void process(aod::Collision const& collision, soa::Join<aod::FullTracks, aod::TracksCov> const& tracks,
                aod::V0GoodPosTracks const& ptracks, aod::V0GoodNegTracks const& ntracks, aod::BCsWithTimestamps const&)
   {
@@ -191,9 +312,49 @@ struct lambdakzerofinder {
     fitter.setMaxDZIni(1e9);
     fitter.setMaxChi2(1e9);
     fitter.setUseAbsDCA(d_UseAbsDCA);
+    precheck.setEnabled(precheckMaxDZ >= 0.f);
+    precheck.setBz(d_bz);
+    precheck.setMaxDZ(precheckMaxDZ);
 
     Long_t lNCand = 0;
 
+    if (useSortedWindows) {
+      fillCandidates(ptracks, posCandidates, d_bz);
+      fillCandidates(ntracks, negCandidates, d_bz);
+      // negative daughters sorted in phi, the window of each positive daughter is searched with a binary search
+      std::sort(negCandidates.begin(), negCandidates.end(), [](const FinderTrack& a, const FinderTrack& b) { return a.phiRef < b.phiRef; });
+      const float window = std::min(static_cast<float>(phiWindow), static_cast<float>(M_PI));
+      auto byPhi = [](const FinderTrack& track, float phi) { return track.phiRef < phi; };
+      auto tryRange = [&](const FinderTrack& pos, float phiMin, float phiMax) {
+        auto neg = std::lower_bound(negCandidates.begin(), negCandidates.end(), phiMin, byPhi);
+        for (; neg != negCandidates.end() && neg->phiRef < phiMax; ++neg) {
+          if (maxCircleDistance >= 0.f && getCircleDistance(pos.circle, neg->circle) > maxCircleDistance) {
+            continue;
+          }
+          if (buildV0(collision, fitter, pos.trackParCov, neg->trackParCov, pos.trackId, neg->trackId, pos.collisionId, pos.dcaXY, neg->dcaXY)) {
+            lNCand++;
+          }
+        }
+      };
+      constexpr float twoPi = 2.f * M_PI;
+      for (const auto& pos : posCandidates) {
+        // phi in [0, 2pi), the window is split in two ranges when it crosses the boundary
+        const float phiMin = pos.phiRef - window;
+        const float phiMax = pos.phiRef + window;
+        if (phiMin < 0.f) {
+          tryRange(pos, 0.f, phiMax);
+          tryRange(pos, phiMin + twoPi, twoPi);
+        } else if (phiMax >= twoPi) {
+          tryRange(pos, phiMin, twoPi);
+          tryRange(pos, 0.f, phiMax - twoPi);
+        } else {
+          tryRange(pos, phiMin, phiMax);
+        }
+      }
+      registry.fill(HIST("hCandPerEvent"), lNCand);
+      return;
+    }
+
     for (auto& t0id : ptracks) { // FIXME: turn into combination(...)
       auto t0 = t0id.goodTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>();
       auto Track1 = getTrackParCov(t0);
@@ -201,50 +362,9 @@ struct lambdakzerofinder {
         auto t1 = t1id.goodTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>();
         auto Track2 = getTrackParCov(t1);
 
-        // Try to progate to dca
-        int nCand = fitter.process(Track1, Track2);
-        if (nCand == 0) {
-          continue;
+        if (buildV0(collision, fitter, Track1, Track2, t0.globalIndex(), t1.globalIndex(), t0.collisionId(), t0id.dcaXY(), t1id.dcaXY())) {
+          lNCand++;
         }
-        const auto& vtx = fitter.getPCACandidate();
-
-        // Fiducial: min radius
-        auto thisv0radius = TMath::Sqrt(TMath::Power(vtx[0], 2) + TMath::Power(vtx[1], 2));
-        if (thisv0radius < v0radius) {
-          continue;
-        }
-
-        // DCA V0 daughters
-        auto thisdcav0dau = fitter.getChi2AtPCACandidate();
-        if (thisdcav0dau > dcav0dau) {
-          continue;
-        }
-
-        std::array<float, 3> pos = {0.};
-        std::array<float, 3> pvec0;
-        std::array<float, 3> pvec1;
-        for (int i = 0; i < 3; i++) {
-          pos[i] = vtx[i];
-        }
-        fitter.getTrack(0).getPxPyPzGlo(pvec0);
-        fitter.getTrack(1).getPxPyPzGlo(pvec1);
-
-        auto thisv0cospa = RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()},
-                                          array{vtx[0], vtx[1], vtx[2]}, array{pvec0[0] + pvec1[0], pvec0[1] + pvec1[1], pvec0[2] + pvec1[2]});
-        if (thisv0cospa < v0cospa) {
-          continue;
-        }
-
-        lNCand++;
-        v0(t0.collisionId(), t0.globalIndex(), t1.globalIndex());
-        v0data(t0.globalIndex(), t1.globalIndex(), t0.collisionId(), 0,
-               fitter.getTrack(0).getX(), fitter.getTrack(1).getX(),
-               pos[0], pos[1], pos[2],
-               pvec0[0], pvec0[1], pvec0[2],
-               pvec1[0], pvec1[1], pvec1[2],
-               fitter.getChi2AtPCACandidate(),
-               t0id.dcaXY(), t1id.dcaXY());
-        v0datalink(v0data.lastIndex());
       }
     }
     registry.fill(HIST("hCandPerEvent"), lNCand);
@@ -0,0 +1,47 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   lfMcGenPrimaries.cxx
+/// \brief  Producer of the generated physical primaries read by the LF spectra tasks for their efficiency denominators
+///
+
+// O2 includes
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/runDataProcessing.h"
+#include "PWGLF/DataModel/LFMcGenPrimaries.h"
+
+#include <cmath>
+
+using namespace o2;
+using namespace o2::framework;
+
+struct LfMcGenPrimaries {
+  Produces<aod::LfMcGenPrimaries> genPrimaries;
+
+  void process(aod::McParticles const& mcParticles)
+  {
+    for (auto const& mcParticle : mcParticles) {
+      if (!mcParticle.isPhysicalPrimary()) {
+        continue;
+      }
+      const float p = std::sqrt(mcParticle.px() * mcParticle.px() + mcParticle.py() * mcParticle.py() + mcParticle.pz() * mcParticle.pz());
+      genPrimaries(mcParticle.mcCollisionId(), mcParticle.globalIndex(), mcParticle.pdgCode(),
+                   mcParticle.pt(), p, mcParticle.eta(), mcParticle.phi(), mcParticle.y());
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<LfMcGenPrimaries>(cfgc, TaskName{"lf-mc-gen-primaries"})};
+}
@@ -35,6 +35,10 @@
 #include "DataFormatsTPC/BetheBlochAleph.h"
 #include "TableHelper.h"
 
+#include <cmath>
+#include <string>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -61,7 +65,8 @@ static constexpr float defaultParameters[nSpecies][nParameters]{{2.f, 2.f, 0.f,
 // Structure to hold the parameters
 struct bbParams {
   const std::string name;
-  bbParams(const std::string& n) : name(n){};
+  const float charge; // charge of the mass hypothesis
+  bbParams(const std::string& n, float z = 1.f) : name(n), charge(z) { tabulate(); };
   // Parameters for the Bethe-Bloch parametrization
   float bb1 = 0.03209809958934784f;    // Aleph Bethe Bloch parameter 1
   float bb2 = 19.9768009185791f;       // Aleph Bethe Bloch parameter 2
@@ -77,6 +82,48 @@ struct bbParams {
   std::string ccdbPath = "";
   int lastRunNumber = 0;
 
+  // Expected signal tabulated versus betagamma each time the parameters are set, evaluated by linear interpolation
+  // The nodes are uniform within each octave of betagamma, so that the interval is found from the float exponent without a log
+  // Below betagamma = 0.0625 the parametrization is too steep for the table and is evaluated directly
+  static constexpr int tableMinExponent = -3; // betagamma >= 2^-4
+  static constexpr int tableOctaves = 19;     // betagamma < 2^15
+  static constexpr int tableNodesPerOctave = 256;
+  bool useTable = true;
+  float chargeFactor = 1.f; // mip * charge^exp
+  std::vector<float> table;
+
+  void tabulate()
+  {
+    chargeFactor = mip * std::pow(charge, exp);
+    table.clear();
+    if (!useTable) {
+      return;
+    }
+    table.resize(tableOctaves * tableNodesPerOctave + 1);
+    for (int j = 0; j < static_cast<int>(table.size()); j++) {
+      const float bg = std::ldexp(0.5f * (1.f + static_cast<float>(j % tableNodesPerOctave) / tableNodesPerOctave), tableMinExponent + j / tableNodesPerOctave);
+      table[j] = chargeFactor * o2::tpc::BetheBlochAleph(bg, bb1, bb2, bb3, bb4, bb5);
+    }
+  }
+
+  /// @brief Expected signal, from the table if betagamma is in its range
+  /// @param bg betagamma of the track
+  float expectedSignal(float bg) const
+  {
+    if (!table.empty()) {
+      int exponent;
+      const float mantissa = std::frexp(bg, &exponent); // bg = mantissa 2^exponent, 0.5 <= mantissa < 1
+      const int octave = exponent - tableMinExponent;
+      if (octave >= 0 && octave < tableOctaves) {
+        const float u = (2.f * mantissa - 1.f) * tableNodesPerOctave;
+        const int node = static_cast<int>(u);
+        const int j = octave * tableNodesPerOctave + node;
+        return table[j] + (u - node) * (table[j + 1] - table[j]);
+      }
+    }
+    return chargeFactor * o2::tpc::BetheBlochAleph(bg, bb1, bb2, bb3, bb4, bb5);
+  }
+
   bool setValues(std::vector<float> v)
   {
     if (v.size() != 8) {
@@ -92,6 +139,7 @@ struct bbParams {
     mip = v[5];
     exp = v[6];
     res = v[7];
+    tabulate();
     LOG(info) << "After: set of parameters -> bb1: " << bb1 << ", bb2: " << bb2 << ", bb3: " << bb3 << ", bb4: " << bb4 << ", bb5: " << bb5 << ", mip: " << mip << ", exp: " << exp << ", resolution " << res;
     return true;
   }
@@ -256,6 +304,7 @@ struct lfTpcPid {
 
   Configurable<std::string> url{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<int64_t> ccdbTimestamp{"ccdb-timestamp", -1, "timestamp of the object used to query in CCDB the detector response. If 0 the object corresponding to the run number is used, if < 0 the latest object is used"};
+  Configurable<bool> useBetheBlochTables{"useBetheBlochTables", true, "evaluate the Bethe-Bloch parametrization from a table computed when the parameters are set"};
 
   bbParams bbEl{"El"};
   bbParams bbMu{"Mu"};
@@ -264,15 +313,14 @@ struct lfTpcPid {
   bbParams bbPr{"Pr"};
   bbParams bbDe{"De"};
   bbParams bbTr{"Tr"};
-  bbParams bbHe{"He"};
-  bbParams bbAl{"Al"};
+  bbParams bbHe{"He", o2::track::pid_constants::sCharges[o2::track::PID::Helium3]};
+  bbParams bbAl{"Al", o2::track::pid_constants::sCharges[o2::track::PID::Alpha]};
 
   template <o2::track::PID::ID id, typename T>
   float BetheBlochLf(const T& track, const bbParams& params)
   {
     static constexpr float invmass = 1.f / o2::track::pid_constants::sMasses2Z[id];
-    static constexpr float charge = o2::track::pid_constants::sCharges[id];
-    return params.mip * o2::tpc::BetheBlochAleph(track.tpcInnerParam() * invmass, params.bb1, params.bb2, params.bb3, params.bb4, params.bb5) * std::pow(charge, params.exp);
+    return params.expectedSignal(track.tpcInnerParam() * invmass);
   }
 
   template <typename T>
@@ -396,6 +444,8 @@ struct lfTpcPid {
 #define InitPerParticle(Particle)                                                                          \
   if (doprocess##Particle || doprocessFull##Particle) {                                                    \
     LOG(info) << "Enabling " << #Particle;                                                                 \
+    bb##Particle.useTable = useBetheBlochTables;                                                           \
+    bb##Particle.tabulate();                                                                               \
     bb##Particle.setValues(#Particle, bbParameters);                                                       \
     bb##Particle.setValues(fileParamBb##Particle, ccdb);                                                   \
   } else {                                                                                                 \
@@ -439,7 +489,8 @@ struct lfTpcPid {
         bb##Particle.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb);                                          \
       }                                                                                                                                     \
       for (auto const& trk : tracks) {                                                                                                      \
-        aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - BetheBloch##Particle(trk)) / BetheBlochRes##Particle(trk), \
+        const float expSignal = BetheBloch##Particle(trk);                                                                                  \
+        aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - expSignal) / (bb##Particle.res * expSignal),               \
                                                               tablePID##Particle);                                                          \
       }                                                                                                                                     \
     }                                                                                                                                       \
@@ -474,11 +525,11 @@ struct lfTpcPid {
       if (bb##Particle.takeFromCcdb) {                                                             \
         bb##Particle.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb); \
       }                                                                                            \
-      float expSigma = 1.f;                                                                        \
       for (auto const& trk : tracks) {                                                             \
-        expSigma = BetheBlochRes##Particle(trk);                                                   \
+        const float expSignal = BetheBloch##Particle(trk);                                         \
+        const float expSigma = bb##Particle.res * expSignal;                                       \
         tablePIDFull##Particle(expSigma,                                                           \
-                               (trk.tpcSignal() - BetheBloch##Particle(trk)) / expSigma);          \
+                               (trk.tpcSignal() - expSignal) / expSigma);                          \
       }                                                                                            \
     }                                                                                              \
   }                                                                                                \
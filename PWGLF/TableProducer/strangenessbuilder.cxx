@@ -0,0 +1,796 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+//  *+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+//  Strangeness builder task, single pass
+//  *+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+//
+//  This task builds the V0s and the cascades of a collision in
+//  one go, producing the same tables as the singlestrangebuilder
+//  and the multistrangebuilder together (V0Datas, V0DataLink,
+//  V0Covs, CascData, CascCovs).
+//
+//  The V0s are fitted once and their fit results are kept in a
+//  pool for the collision: the cascades take their V0 from the
+//  pool instead of reading the V0 tables back, and the CCDB,
+//  the propagator and the material LUT are set up by one device
+//  only.
+//
+//  PERFORMANCE WARNING: this task includes several track
+//  propagation calls that are intrinsically heavy. Please
+//  also be cautious when adjusting selections: these can
+//  increase / decrease CPU consumption quite significantly.
+//
+
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/RunningWorkflowInfo.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ASoAHelpers.h"
+#include "DetectorsVertexing/DCAFitterN.h"
+#include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/RecoDecay.h"
+#include "Common/Core/trackUtilities.h"
+#include "PWGLF/DataModel/LFStrangenessTables.h"
+#include "PWGLF/Utils/mcMotherLookup.h"
+#include "Common/Core/TrackSelection.h"
+#include "Common/DataModel/TrackSelectionTables.h"
+#include "DetectorsBase/Propagator.h"
+#include "DetectorsBase/GeometryManager.h"
+#include "DataFormatsParameters/GRPObject.h"
+#include "DataFormatsParameters/GRPMagField.h"
+#include "CCDB/BasicCCDBManager.h"
+
+#include "TPDGCode.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+using std::array;
+
+// use parameters + cov mat non-propagated, aux info + (extension propagated)
+using FullTracksExt = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksCov, aod::TracksDCA>;
+using FullTracksExtIU = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU, aod::TracksDCA>;
+using LabeledTracks = soa::Join<aod::Tracks, aod::McTrackLabels>;
+
+//*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+// Builder task: builds V0 and cascade candidates in one pass
+struct strangenessBuilder {
+  Produces<aod::StoredV0Datas> v0data;
+  Produces<aod::V0DataLink> v0dataLink;
+  Produces<aod::V0Covs> v0covs;     // if requested by someone
+  Produces<aod::CascData> cascdata;
+  Produces<aod::CascCovs> casccovs; // if requested by someone
+  Service<o2::ccdb::BasicCCDBManager> ccdb;
+
+  // Configurables related to table creation
+  Configurable<int> createV0CovMats{"createV0CovMats", -1, {"Produces V0 cov matrices. -1: auto, 0: don't, 1: yes. Default: auto (-1)"}};
+  Configurable<int> createCascCovMats{"createCascCovMats", -1, {"Produces cascade cov matrices. -1: auto, 0: don't, 1: yes. Default: auto (-1)"}};
+
+  // use auto-detect configuration
+  Configurable<bool> d_UseAutodetectMode{"d_UseAutodetectMode", true, "Autodetect requested topo sels"};
+
+  // Topological selection criteria
+  Configurable<int> mincrossedrows{"mincrossedrows", 70, "min crossed rows"};
+  Configurable<int> tpcrefit{"tpcrefit", 0, "demand TPC refit"};
+
+  Configurable<float> dcanegtopv{"dcanegtopv", .1, "DCA Neg To PV"};
+  Configurable<float> dcapostopv{"dcapostopv", .1, "DCA Pos To PV"};
+  Configurable<double> v0cospa{"v0cospa", 0.995, "V0 CosPA"}; // double -> N.B. dcos(x)/dx = 0 at x=0)
+  Configurable<float> dcav0dau{"dcav0dau", 1.0, "DCA V0 Daughters"};
+  Configurable<float> v0radius{"v0radius", 0.9, "v0radius"};
+
+  Configurable<float> dcabachtopv{"dcabachtopv", .05, "DCA Bach To PV"};
+  Configurable<float> cascradius{"cascradius", 0.9, "cascradius"};
+  Configurable<float> casccospa{"casccospa", 0.95, "casccospa"};
+  Configurable<float> dcacascdau{"dcacascdau", 1.0, "DCA cascade Daughters"};
+  Configurable<float> lambdaMassWindow{"lambdaMassWindow", .01, "Distance from Lambda mass"};
+
+  // Operation and minimisation criteria
+  Configurable<double> d_bz_input{"d_bz", -999, "bz field, -999 is automatic"};
+  Configurable<bool> d_UseAbsDCA{"d_UseAbsDCA", true, "Use Abs DCAs"};
+  Configurable<bool> d_UseWeightedPCA{"d_UseWeightedPCA", false, "Vertices use cov matrices"};
+  Configurable<int> useMatCorrType{"useMatCorrType", 0, "0: none, 1: TGeo, 2: LUT"};
+
+  // CCDB options
+  Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
+  Configurable<std::string> grpPath{"grpPath", "GLO/GRP/GRP", "Path of the grp file"};
+  Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
+  Configurable<std::string> lutPath{"lutPath", "GLO/Param/MatLUT", "Path of the Lut parametrization"};
+  Configurable<std::string> geoPath{"geoPath", "GLO/Config/GeometryAligned", "Path of the geometry file"};
+
+  int mRunNumber;
+  float d_bz;
+  o2::base::MatLayerCylSet* lut = nullptr;
+
+  // Define o2 fitter, 2-prong, active memory (no need to redefine per event)
+  o2::vertexing::DCAFitterN<2> fitter;
+
+  enum v0step { kV0All = 0,
+                kV0TPCrefit,
+                kV0CrossedRows,
+                kV0DCAxy,
+                kV0DCADau,
+                kV0CosPA,
+                kV0Radius,
+                kNV0Steps };
+
+  enum cascstep { kCascAll = 0,
+                  kCascHasV0,
+                  kCascLambdaMass,
+                  kBachTPCrefit,
+                  kBachCrossedRows,
+                  kBachDCAxy,
+                  kCascDCADau,
+                  kCascCosPA,
+                  kCascRadius,
+                  kNCascSteps };
+
+  // Fit result of a V0 of the collision, kept for the cascades
+  struct V0Candidate {
+    int v0DataIndex; // row in the V0Datas table
+    std::array<float, 3> pos;
+    std::array<float, 3> posP;
+    std::array<float, 3> negP;
+    float positionCovariance[6];
+    float momentumCovariance[6];
+    float dcaV0dau;
+    float posDCAxy;
+    float negDCAxy;
+    float lambdaMass;
+    float antiLambdaMass;
+  };
+
+  // V0 pool of the collision, and position of the V0 of each entry of the V0s table in the pool (-1 if not built)
+  std::vector<V0Candidate> v0Pool;
+  std::vector<int> v0PoolIndex;
+
+  // Helper struct to pass cascade information
+  struct {
+    int charge;
+    std::array<float, 3> pos;
+    std::array<float, 3> bachP;
+    float dcacascdau;
+    float bachDCAxy;
+    float cosPA;
+    float cascradius;
+  } cascadecandidate;
+
+  o2::track::TrackParCov lPositiveTrack;
+  o2::track::TrackParCov lNegativeTrack;
+  o2::track::TrackParCov lBachelorTrack;
+  o2::track::TrackParCov lV0Track;
+
+  // Helper struct to do bookkeeping of building parameters
+  struct {
+    std::array<long, kNV0Steps> v0stats;
+    std::array<long, kNCascSteps> cascstats;
+    long exceptions;
+    long eventCounter;
+  } statisticsRegistry;
+
+  HistogramRegistry registry{
+    "registry",
+    {{"hEventCounter", "hEventCounter", {HistType::kTH1F, {{1, 0.0f, 1.0f}}}},
+     {"hCaughtExceptions", "hCaughtExceptions", {HistType::kTH1F, {{1, 0.0f, 1.0f}}}},
+     {"hV0Criteria", "hV0Criteria", {HistType::kTH1F, {{10, -0.5f, 9.5f}}}},
+     {"hCascadeCriteria", "hCascadeCriteria", {HistType::kTH1F, {{10, -0.5f, 9.5f}}}}}};
+
+  void resetHistos()
+  {
+    statisticsRegistry.exceptions = 0;
+    statisticsRegistry.eventCounter = 0;
+    for (Int_t ii = 0; ii < kNV0Steps; ii++)
+      statisticsRegistry.v0stats[ii] = 0;
+    for (Int_t ii = 0; ii < kNCascSteps; ii++)
+      statisticsRegistry.cascstats[ii] = 0;
+  }
+
+  void fillHistos()
+  {
+    registry.fill(HIST("hEventCounter"), 0.0, statisticsRegistry.eventCounter);
+    registry.fill(HIST("hCaughtExceptions"), 0.0, statisticsRegistry.exceptions);
+    for (Int_t ii = 0; ii < kNV0Steps; ii++)
+      registry.fill(HIST("hV0Criteria"), ii, statisticsRegistry.v0stats[ii]);
+    for (Int_t ii = 0; ii < kNCascSteps; ii++)
+      registry.fill(HIST("hCascadeCriteria"), ii, statisticsRegistry.cascstats[ii]);
+  }
+
+  void init(InitContext& context)
+  {
+    resetHistos();
+
+    mRunNumber = 0;
+    d_bz = 0;
+
+    ccdb->setURL(ccdburl);
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    ccdb->setFatalWhenNull(false);
+
+    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
+    if (!o2::base::GeometryManager::isGeometryLoaded()) {
+      ccdb->get<TGeoManager>(geoPath);
+    }
+
+    if (doprocessRun2 == false && doprocessRun3 == false) {
+      LOGF(fatal, "Neither processRun2 nor processRun3 enabled. Please choose one.");
+    }
+    if (doprocessRun2 == true && doprocessRun3 == true) {
+      LOGF(fatal, "Cannot enable processRun2 and processRun3 at the same time. Please choose one.");
+    }
+
+    if (d_UseAutodetectMode) {
+      // Checking for subscriptions to:
+      double loosest_v0cospa = 100;
+      float loosest_dcav0dau = -100;
+      float loosest_dcapostopv = 100;
+      float loosest_dcanegtopv = 100;
+      float loosest_v0radius = 100;
+
+      double loosest_casccospa = 100;
+      float loosest_dcacascdau = -100;
+      float loosest_dcabachtopv = 100;
+      float loosest_cascradius = 100;
+      float loosest_v0masswindow = -100;
+
+      LOGF(info, "*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*");
+      LOGF(info, " Strangeness builder self-configuration");
+      LOGF(info, "*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*");
+      auto& workflows = context.services().get<RunningWorkflowInfo const>();
+      for (DeviceSpec const& device : workflows.devices) {
+        if (device.name.compare("strangeness-initializer") == 0)
+          continue; // don't listen to the initializer, it's just to extend stuff
+        for (auto const& input : device.inputs) {
+          // Step 1: check if this device subscribed to the V0data table
+          if (input.matcher.binding == "V0Datas") {
+            LOGF(info, "Device named %s has subscribed to V0datas table! Will now scan for desired settings...", device.name);
+            for (auto const& option : device.options) {
+              // 5 V0 topological selections
+              if (option.name.compare("v0setting_cospa") == 0) {
+                loosest_v0cospa = std::min(loosest_v0cospa, option.defaultValue.get<double>());
+              }
+              if (option.name.compare("v0setting_dcav0dau") == 0) {
+                loosest_dcav0dau = std::max(loosest_dcav0dau, option.defaultValue.get<float>());
+              }
+              if (option.name.compare("v0setting_dcapostopv") == 0) {
+                loosest_dcapostopv = std::min(loosest_dcapostopv, option.defaultValue.get<float>());
+              }
+              if (option.name.compare("v0setting_dcanegtopv") == 0) {
+                loosest_dcanegtopv = std::min(loosest_dcanegtopv, option.defaultValue.get<float>());
+              }
+              if (option.name.compare("v0setting_radius") == 0) {
+                loosest_v0radius = std::min(loosest_v0radius, option.defaultValue.get<float>());
+              }
+            }
+          }
+          // Step 2: check if this device subscribed to the CascData table
+          if (input.matcher.binding == "CascData" || input.matcher.binding == "CascDataExt") {
+            LOGF(info, "Device named %s has subscribed to CascData table! Will now scan for desired settings...", device.name);
+            for (auto const& option : device.options) {
+              // 4 cascade topological selections + 1 mass
+              if (option.name.compare("cascadesetting_cospa") == 0) {
+                loosest_casccospa = std::min(loosest_casccospa, option.defaultValue.get<double>());
+              }
+              if (option.name.compare("cascadesetting_dcacascdau") == 0) {
+                loosest_dcacascdau = std::max(loosest_dcacascdau, option.defaultValue.get<float>());
+              }
+              if (option.name.compare("cascadesetting_dcabachtopv") == 0) {
+                loosest_dcabachtopv = std::min(loosest_dcabachtopv, option.defaultValue.get<float>());
+              }
+              if (option.name.compare("cascadesetting_cascradius") == 0) {
+                loosest_cascradius = std::min(loosest_cascradius, option.defaultValue.get<float>());
+              }
+              if (option.name.compare("cascadesetting_v0masswindow") == 0) {
+                loosest_v0masswindow = std::max(loosest_v0masswindow, option.defaultValue.get<float>());
+              }
+            }
+          }
+          if (input.matcher.binding == "V0Covs") {
+            LOGF(info, "Device named %s has subscribed to V0Covs table! Enabling.", device.name);
+            createV0CovMats.value = 1;
+          }
+          if (input.matcher.binding == "CascCovs") {
+            LOGF(info, "Device named %s has subscribed to CascCovs table! Enabling.", device.name);
+            createCascCovMats.value = 1;
+          }
+        }
+      }
+      LOGF(info, "Self-configuration finished! Decided on selections:");
+      LOGF(info, " -+*> V0 cospa ..................: %.6f", loosest_v0cospa);
+      LOGF(info, " -+*> DCA V0 daughters ..........: %.6f", loosest_dcav0dau);
+      LOGF(info, " -+*> DCA positive daughter .....: %.6f", loosest_dcapostopv);
+      LOGF(info, " -+*> DCA negative daughter .....: %.6f", loosest_dcanegtopv);
+      LOGF(info, " -+*> Minimum V0 radius .........: %.6f", loosest_v0radius);
+      LOGF(info, " -+*> Cascade cospa .............: %.6f", loosest_casccospa);
+      LOGF(info, " -+*> DCA cascade daughters .....: %.6f", loosest_dcacascdau);
+      LOGF(info, " -+*> DCA bachelor daughter .....: %.6f", loosest_dcabachtopv);
+      LOGF(info, " -+*> Min cascade decay radius ..: %.6f", loosest_cascradius);
+      LOGF(info, " -+*> V0 mass window ............: %.6f", loosest_v0masswindow);
+
+      dcanegtopv.value = loosest_dcanegtopv;
+      dcapostopv.value = loosest_dcapostopv;
+      v0cospa.value = loosest_v0cospa;
+      dcav0dau.value = loosest_dcav0dau;
+      v0radius.value = loosest_v0radius;
+      casccospa.value = loosest_casccospa;
+      dcacascdau.value = loosest_dcacascdau;
+      dcabachtopv.value = loosest_dcabachtopv;
+      cascradius.value = loosest_cascradius;
+      lambdaMassWindow.value = loosest_v0masswindow;
+    }
+
+    //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+    LOGF(info, " -+*> process call configuration:");
+    if (doprocessRun2 == true) {
+      LOGF(info, " ---+*> Run 2 processing enabled. Will subscribe to Tracks table.");
+    };
+    if (doprocessRun3 == true) {
+      LOGF(info, " ---+*> Run 3 processing enabled. Will subscribe to TracksIU table.");
+    };
+    if (createV0CovMats > 0) {
+      LOGF(info, " ---+*> Will produce V0 cov mat table");
+    };
+    if (createCascCovMats > 0) {
+      LOGF(info, " ---+*> Will produce cascade cov mat table");
+    };
+    //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+
+    // initialize O2 2-prong fitter (only once), used for both the V0s and the cascades
+    fitter.setPropagateToPCA(true);
+    fitter.setMaxR(200.);
+    fitter.setMinParamChange(1e-3);
+    fitter.setMinRelChi2Change(0.9);
+    fitter.setMaxDZIni(1e9);
+    fitter.setMaxChi2(1e9);
+    fitter.setUseAbsDCA(d_UseAbsDCA);
+    fitter.setWeightedFinalPCA(d_UseWeightedPCA);
+
+    // Material correction in the DCA fitter
+    o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
+    if (useMatCorrType == 1)
+      matCorr = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
+    if (useMatCorrType == 2)
+      matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
+    fitter.setMatCorrType(matCorr);
+  }
+
+  void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
+  {
+    if (mRunNumber == bc.runNumber()) {
+      return;
+    }
+    auto run3grp_timestamp = bc.timestamp();
+
+    o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(grpPath, run3grp_timestamp);
+    o2::parameters::GRPMagField* grpmag = 0x0;
+    if (grpo) {
+      o2::base::Propagator::initFieldFromGRP(grpo);
+      if (d_bz_input < -990) {
+        // Fetch magnetic field from ccdb for current collision
+        d_bz = grpo->getNominalL3Field();
+        LOG(info) << "Retrieved GRP for timestamp " << run3grp_timestamp << " with magnetic field of " << d_bz << " kZG";
+      } else {
+        d_bz = d_bz_input;
+      }
+    } else {
+      grpmag = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(grpmagPath, run3grp_timestamp);
+      if (!grpmag) {
+        LOG(fatal) << "Got nullptr from CCDB for path " << grpmagPath << " of object GRPMagField and " << grpPath << " of object GRPObject for timestamp " << run3grp_timestamp;
+      }
+      o2::base::Propagator::initFieldFromGRP(grpmag);
+      if (d_bz_input < -990) {
+        // Fetch magnetic field from ccdb for current collision
+        d_bz = std::lround(5.f * grpmag->getL3Current() / 30000.f);
+        LOG(info) << "Retrieved GRP for timestamp " << run3grp_timestamp << " with magnetic field of " << d_bz << " kZG";
+      } else {
+        d_bz = d_bz_input;
+      }
+    }
+    o2::base::Propagator::Instance()->setMatLUT(lut);
+    mRunNumber = bc.runNumber();
+    // Set magnetic field value once known
+    fitter.setBz(d_bz);
+  }
+
+  template <class TTracksTo>
+  bool buildV0Candidate(aod::Collision const& collision, TTracksTo const& posTrack, TTracksTo const& negTrack, V0Candidate& v0candidate)
+  {
+    // value 0.5: any considered V0
+    statisticsRegistry.v0stats[kV0All]++;
+    if (tpcrefit) {
+      if (!(posTrack.trackType() & o2::aod::track::TPCrefit)) {
+        return false;
+      }
+      if (!(negTrack.trackType() & o2::aod::track::TPCrefit)) {
+        return false;
+      }
+    }
+    // Passes TPC refit
+    statisticsRegistry.v0stats[kV0TPCrefit]++;
+    if (posTrack.tpcNClsCrossedRows() < mincrossedrows || negTrack.tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
+    // passes crossed rows
+    statisticsRegistry.v0stats[kV0CrossedRows]++;
+    if (fabs(posTrack.dcaXY()) < dcapostopv || fabs(negTrack.dcaXY()) < dcanegtopv) {
+      return false;
+    }
+    // passes DCAxy
+    statisticsRegistry.v0stats[kV0DCAxy]++;
+    v0candidate.posDCAxy = posTrack.dcaXY();
+    v0candidate.negDCAxy = negTrack.dcaXY();
+
+    lPositiveTrack = getTrackParCov(posTrack);
+    lNegativeTrack = getTrackParCov(negTrack);
+
+    //---/---/---/
+    // Move close to minima
+    int nCand = 0;
+    try {
+      nCand = fitter.process(lPositiveTrack, lNegativeTrack);
+    } catch (...) {
+      statisticsRegistry.exceptions++;
+      LOG(error) << "Exception caught in DCA fitter process call!";
+      return false;
+    }
+    if (nCand == 0) {
+      return false;
+    }
+
+    lPositiveTrack = fitter.getTrack(0);
+    lNegativeTrack = fitter.getTrack(1);
+    lPositiveTrack.getPxPyPzGlo(v0candidate.posP);
+    lNegativeTrack.getPxPyPzGlo(v0candidate.negP);
+
+    // get decay vertex coordinates
+    const auto& vtx = fitter.getPCACandidate();
+    for (int i = 0; i < 3; i++) {
+      v0candidate.pos[i] = vtx[i];
+    }
+
+    v0candidate.dcaV0dau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+
+    // Apply selections so a skimmed table is created only
+    if (v0candidate.dcaV0dau > dcav0dau) {
+      return false;
+    }
+
+    // Passes DCA between daughters check
+    statisticsRegistry.v0stats[kV0DCADau]++;
+
+    auto cosPA = RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()}, array{v0candidate.pos[0], v0candidate.pos[1], v0candidate.pos[2]}, array{v0candidate.posP[0] + v0candidate.negP[0], v0candidate.posP[1] + v0candidate.negP[1], v0candidate.posP[2] + v0candidate.negP[2]});
+    if (cosPA < v0cospa) {
+      return false;
+    }
+
+    // Passes CosPA check
+    statisticsRegistry.v0stats[kV0CosPA]++;
+
+    if (RecoDecay::sqrtSumOfSquares(v0candidate.pos[0], v0candidate.pos[1]) < v0radius) {
+      return false;
+    }
+
+    // Passes radius check
+    statisticsRegistry.v0stats[kV0Radius]++;
+
+    // Covariances, needed by the cascades in any case
+    auto covVtxV = fitter.calcPCACovMatrix(0);
+    v0candidate.positionCovariance[0] = covVtxV(0, 0);
+    v0candidate.positionCovariance[1] = covVtxV(1, 0);
+    v0candidate.positionCovariance[2] = covVtxV(1, 1);
+    v0candidate.positionCovariance[3] = covVtxV(2, 0);
+    v0candidate.positionCovariance[4] = covVtxV(2, 1);
+    v0candidate.positionCovariance[5] = covVtxV(2, 2);
+    std::array<float, 21> covTpositive = {0.};
+    std::array<float, 21> covTnegative = {0.};
+    lPositiveTrack.getCovXYZPxPyPzGlo(covTpositive);
+    lNegativeTrack.getCovXYZPxPyPzGlo(covTnegative);
+    constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
+    for (int i = 0; i < 6; i++) {
+      v0candidate.momentumCovariance[i] = covTpositive[MomInd[i]] + covTnegative[MomInd[i]];
+    }
+
+    v0candidate.lambdaMass = RecoDecay::m(array{v0candidate.posP, v0candidate.negP}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
+    v0candidate.antiLambdaMass = RecoDecay::m(array{v0candidate.posP, v0candidate.negP}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
+
+    // Return OK: passed all v0 candidate selecton criteria
+    return true;
+  }
+
+  template <class TTracksTo>
+  bool buildCascadeCandidate(aod::Collision const& collision, TTracksTo const& bachTrack, V0Candidate const& v0)
+  {
+    // Overall cascade charge
+    cascadecandidate.charge = bachTrack.signed1Pt() > 0 ? +1 : -1;
+    cascadecandidate.bachDCAxy = bachTrack.dcaXY();
+
+    // check also against charge
+    if (cascadecandidate.charge < 0 && TMath::Abs(v0.lambdaMass - 1.116) > lambdaMassWindow)
+      return false;
+    if (cascadecandidate.charge > 0 && TMath::Abs(v0.antiLambdaMass - 1.116) > lambdaMassWindow)
+      return false;
+    statisticsRegistry.cascstats[kCascLambdaMass]++;
+
+    if (tpcrefit) {
+      if (!(bachTrack.trackType() & o2::aod::track::TPCrefit)) {
+        return false;
+      }
+    }
+    statisticsRegistry.cascstats[kBachTPCrefit]++;
+    if (bachTrack.tpcNClsCrossedRows() < mincrossedrows) {
+      return false;
+    }
+    statisticsRegistry.cascstats[kBachCrossedRows]++;
+
+    // bachelor DCA track to PV
+    if (fabs(bachTrack.dcaXY()) < dcabachtopv)
+      return false;
+    statisticsRegistry.cascstats[kBachDCAxy]++;
+
+    // Do actual minimization
+    lBachelorTrack = getTrackParCov(bachTrack);
+
+    // V0 track from the fit results of the pool
+    std::array<float, 21> covV = {0.};
+    constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
+    for (int i = 0; i < 6; i++) {
+      covV[MomInd[i]] = v0.momentumCovariance[i];
+      covV[i] = v0.positionCovariance[i];
+    }
+    const std::array<float, 3> v0P = {v0.posP[0] + v0.negP[0], v0.posP[1] + v0.negP[1], v0.posP[2] + v0.negP[2]};
+    lV0Track = o2::track::TrackParCov(v0.pos, v0P, covV, 0, true);
+    lV0Track.setQ2Pt(0); // No bending, please
+
+    //---/---/---/
+    // Move close to minima
+    int nCand = 0;
+    try {
+      nCand = fitter.process(lV0Track, lBachelorTrack);
+    } catch (...) {
+      statisticsRegistry.exceptions++;
+      LOG(error) << "Exception caught in DCA fitter process call!";
+      return false;
+    }
+    if (nCand == 0)
+      return false;
+
+    // DCA between cascade daughters
+    cascadecandidate.dcacascdau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+    if (cascadecandidate.dcacascdau > dcacascdau)
+      return false;
+    statisticsRegistry.cascstats[kCascDCADau]++;
+
+    fitter.getTrack(1).getPxPyPzGlo(cascadecandidate.bachP);
+    // get decay vertex coordinates
+    const auto& vtx = fitter.getPCACandidate();
+    for (int i = 0; i < 3; i++) {
+      cascadecandidate.pos[i] = vtx[i];
+    }
+
+    cascadecandidate.cosPA = RecoDecay::cpa(
+      array{collision.posX(), collision.posY(), collision.posZ()},
+      array{cascadecandidate.pos[0], cascadecandidate.pos[1], cascadecandidate.pos[2]},
+      array{v0P[0] + cascadecandidate.bachP[0], v0P[1] + cascadecandidate.bachP[1], v0P[2] + cascadecandidate.bachP[2]});
+    if (cascadecandidate.cosPA < casccospa) {
+      return false;
+    }
+    statisticsRegistry.cascstats[kCascCosPA]++;
+
+    // Cascade radius
+    cascadecandidate.cascradius = RecoDecay::sqrtSumOfSquares(cascadecandidate.pos[0], cascadecandidate.pos[1]);
+    if (cascadecandidate.cascradius < cascradius)
+      return false;
+    statisticsRegistry.cascstats[kCascRadius]++;
+
+    return true;
+  }
+
+  template <class TTracksTo>
+  void buildStrangenessTables(aod::Collision const& collision, aod::V0s const& V0s, aod::Cascades const& cascades, TTracksTo const& tracks)
+  {
+    statisticsRegistry.eventCounter++;
+
+    // V0s: fitted once, the results are stored in the tables and in the pool
+    const int64_t v0Offset = V0s.size() > 0 ? V0s.begin().globalIndex() : 0;
+    v0Pool.clear();
+    v0PoolIndex.assign(V0s.size(), -1);
+    V0Candidate v0candidate;
+    for (auto& V0 : V0s) {
+      auto posTrackCast = V0.template posTrack_as<TTracksTo>();
+      auto negTrackCast = V0.template negTrack_as<TTracksTo>();
+
+      if (!buildV0Candidate(collision, posTrackCast, negTrackCast, v0candidate)) {
+        v0dataLink(-1);
+        continue; // doesn't pass selections
+      }
+
+      // populates table for V0 analysis
+      v0data(posTrackCast.globalIndex(),
+             negTrackCast.globalIndex(),
+             V0.collisionId(),
+             V0.globalIndex(),
+             lPositiveTrack.getX(), lNegativeTrack.getX(),
+             v0candidate.pos[0], v0candidate.pos[1], v0candidate.pos[2],
+             v0candidate.posP[0], v0candidate.posP[1], v0candidate.posP[2],
+             v0candidate.negP[0], v0candidate.negP[1], v0candidate.negP[2],
+             v0candidate.dcaV0dau,
+             v0candidate.posDCAxy,
+             v0candidate.negDCAxy);
+      v0dataLink(v0data.lastIndex());
+      if (createV0CovMats) {
+        v0covs(v0candidate.positionCovariance, v0candidate.momentumCovariance);
+      }
+
+      v0candidate.v0DataIndex = v0data.lastIndex();
+      v0PoolIndex[V0.globalIndex() - v0Offset] = v0Pool.size();
+      v0Pool.push_back(v0candidate);
+    }
+
+    // Cascades: the V0 is taken from the pool, without refit
+    for (auto& cascade : cascades) {
+      statisticsRegistry.cascstats[kCascAll]++;
+      const int64_t v0Position = cascade.v0Id() - v0Offset;
+      if (v0Position < 0 || v0Position >= static_cast<int64_t>(v0PoolIndex.size()) || v0PoolIndex[v0Position] < 0) {
+        continue; // skip those cascades for which V0 doesn't exist
+      }
+      statisticsRegistry.cascstats[kCascHasV0]++;
+      const auto& v0 = v0Pool[v0PoolIndex[v0Position]];
+      auto bachTrackCast = cascade.template bachelor_as<TTracksTo>();
+
+      if (!buildCascadeCandidate(collision, bachTrackCast, v0))
+        continue; // doesn't pass cascade selections
+
+      cascdata(cascade.v0Id(),
+               bachTrackCast.globalIndex(),
+               cascade.collisionId(),
+               cascadecandidate.charge,
+               cascadecandidate.pos[0], cascadecandidate.pos[1], cascadecandidate.pos[2],
+               v0.pos[0], v0.pos[1], v0.pos[2],
+               v0.posP[0], v0.posP[1], v0.posP[2],
+               v0.negP[0], v0.negP[1], v0.negP[2],
+               cascadecandidate.bachP[0], cascadecandidate.bachP[1], cascadecandidate.bachP[2],
+               v0.dcaV0dau, cascadecandidate.dcacascdau,
+               v0.posDCAxy, v0.negDCAxy,
+               cascadecandidate.bachDCAxy);
+
+      // populate cascade covariance matrices if required by any other task
+      if (createCascCovMats) {
+        auto covVtxC = fitter.calcPCACovMatrix(0);
+        float positionCovariance[6];
+        positionCovariance[0] = covVtxC(0, 0);
+        positionCovariance[1] = covVtxC(1, 0);
+        positionCovariance[2] = covVtxC(1, 1);
+        positionCovariance[3] = covVtxC(2, 0);
+        positionCovariance[4] = covVtxC(2, 1);
+        positionCovariance[5] = covVtxC(2, 2);
+        std::array<float, 21> covTv0 = {0.};
+        std::array<float, 21> covTbachelor = {0.};
+        float momentumCovariance[6];
+        fitter.getTrack(0).getCovXYZPxPyPzGlo(covTv0);
+        fitter.getTrack(1).getCovXYZPxPyPzGlo(covTbachelor);
+        constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
+        for (int i = 0; i < 6; i++) {
+          momentumCovariance[i] = covTv0[MomInd[i]] + covTbachelor[MomInd[i]];
+        }
+        casccovs(positionCovariance, momentumCovariance);
+      }
+    }
+    // En masse histo filling at end of process call
+    fillHistos();
+    resetHistos();
+  }
+
+  void processRun2(aod::Collision const& collision, aod::V0s const& V0s, aod::Cascades const& cascades, FullTracksExt const& tracks, aod::BCsWithTimestamps const&)
+  {
+    /* check the previous run number */
+    auto bc = collision.bc_as<aod::BCsWithTimestamps>();
+    initCCDB(bc);
+
+    // do v0s and cascades, typecase correctly into tracks (Run 2 use case)
+    buildStrangenessTables<FullTracksExt>(collision, V0s, cascades, tracks);
+  }
+  PROCESS_SWITCH(strangenessBuilder, processRun2, "Produce Run 2 V0 and cascade tables", true);
+
+  void processRun3(aod::Collision const& collision, aod::V0s const& V0s, aod::Cascades const& cascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const&)
+  {
+    /* check the previous run number */
+    auto bc = collision.bc_as<aod::BCsWithTimestamps>();
+    initCCDB(bc);
+
+    // do v0s and cascades, typecase correctly into tracksIU (Run 3 use case)
+    buildStrangenessTables<FullTracksExtIU>(collision, V0s, cascades, tracks);
+  }
+  PROCESS_SWITCH(strangenessBuilder, processRun3, "Produce Run 3 V0 and cascade tables", false);
+};
+
+//*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+struct strangenessLabelBuilder {
+  Produces<aod::McV0Labels> v0labels;     // MC labels for V0s
+  Produces<aod::McCascLabels> casclabels; // MC labels for cascades
+
+  o2::analysis::McMotherLookup mcMothers; // mothers of the MC particles of the dataframe
+
+  void init(InitContext const&) {}
+
+  void processDoNotBuildLabels(aod::Collisions::iterator const& collision)
+  {
+    // dummy process function - should not be required in the future
+  }
+  PROCESS_SWITCH(strangenessLabelBuilder, processDoNotBuildLabels, "Do not produce MC label tables", true);
+
+  //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+  // build V0 and cascade labels if requested to do so
+  // the whole dataframe is processed at once, so that the mothers of the MC particles are stored only once
+  void processBuildLabels(aod::V0Datas const& v0table, aod::CascDataExt const& casctable, aod::V0sLinked const&, LabeledTracks const&, aod::McParticles const& particlesMC)
+  {
+    mcMothers.fill(particlesMC);
+    for (auto& v0 : v0table) {
+      int lLabel = -1;
+
+      auto lNegTrack = v0.negTrack_as<LabeledTracks>();
+      auto lPosTrack = v0.posTrack_as<LabeledTracks>();
+
+      // Association check
+      if (lNegTrack.has_mcParticle() && lPosTrack.has_mcParticle()) {
+        lLabel = mcMothers.getCommonMother(lNegTrack.mcParticleId(), lPosTrack.mcParticleId());
+      } // end association check
+      // Construct label table (note: this will be joinable with V0Datas)
+      v0labels(lLabel);
+    }
+
+    for (auto& casc : casctable) {
+      auto v0 = casc.v0_as<o2::aod::V0sLinked>();
+      int lLabel = -1;
+      if (!(v0.has_v0Data())) {
+        casclabels(lLabel);
+        continue; // cascades are only built with an existing V0
+      }
+      auto v0data = v0.v0Data(); // de-reference index to correct v0data in case it exists
+
+      // Acquire all three daughter tracks, please
+      auto lBachTrack = casc.bachelor_as<LabeledTracks>();
+      auto lNegTrack = v0data.negTrack_as<LabeledTracks>();
+      auto lPosTrack = v0data.posTrack_as<LabeledTracks>();
+
+      // Association check: common mother of the V0 legs, then common mother of the V0 and of the bachelor
+      if (lNegTrack.has_mcParticle() && lPosTrack.has_mcParticle() && lBachTrack.has_mcParticle()) {
+        lLabel = mcMothers.getCascadeMother(lNegTrack.mcParticleId(), lPosTrack.mcParticleId(), lBachTrack.mcParticleId());
+      } // end association check
+      // Construct label table (note: this will be joinable with CascDatas)
+      casclabels(lLabel);
+    }
+  }
+  PROCESS_SWITCH(strangenessLabelBuilder, processBuildLabels, "Produce V0 and cascade MC label tables", false);
+  //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+};
+
+// Extends the v0data and cascdata tables with expression columns
+struct strangenessInitializer {
+  Spawns<aod::V0Datas> v0datas;
+  Spawns<aod::CascDataExt> cascdataext;
+  void init(InitContext const&) {}
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<strangenessBuilder>(cfgc),
+    adaptAnalysisTask<strangenessLabelBuilder>(cfgc),
+    adaptAnalysisTask<strangenessInitializer>(cfgc)};
+}
@@ -20,6 +20,7 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/Centrality.h"
+#include "PWGLF/DataModel/LFMcGenPrimaries.h"
 
 #include "Framework/HistogramRegistry.h"
 
@@ -69,7 +70,7 @@ struct NucleiSpectraEfficiencyGen {
     spectra.add("histGenPt", "generated particles", HistType::kTH1F, {ptAxis});
   }
 
-  void process(aod::McCollision const& mcCollision, aod::McParticles const& mcParticles)
+  void processMcParticles(aod::McCollision const& mcCollision, aod::McParticles const& mcParticles)
   {
     //
     // loop over generated particles and fill generated particles
@@ -87,6 +88,24 @@ struct NucleiSpectraEfficiencyGen {
       spectra.fill(HIST("histGenPt"), mcParticleGen.pt());
     }
   }
+  PROCESS_SWITCH(NucleiSpectraEfficiencyGen, processMcParticles, "Fill the generated particles from the McParticles", true);
+
+  void processGenPrimaries(aod::LfMcGenPrimaries const& genPrimaries)
+  {
+    //
+    // loop over the generated primaries of lf-mc-gen-primaries
+    //
+    for (auto& genPrimary : genPrimaries) {
+      if (genPrimary.pdgCode() != -1000020030) {
+        continue;
+      }
+      if (abs(genPrimary.y()) > 0.5) {
+        continue;
+      }
+      spectra.fill(HIST("histGenPt"), genPrimary.pt());
+    }
+  }
+  PROCESS_SWITCH(NucleiSpectraEfficiencyGen, processGenPrimaries, "Fill the generated particles from the table of lf-mc-gen-primaries", false);
 };
 
 struct NucleiSpectraEfficiencyRec {
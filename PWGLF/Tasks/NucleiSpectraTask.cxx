@@ -30,6 +30,8 @@
 
 #include "DataFormatsTPC/BetheBlochAleph.h"
 
+#include "PWGLF/Utils/betheBlochTable.h"
+
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/ASoAHelpers.h"
@@ -114,6 +116,8 @@ static const std::vector<std::string> binnedVariableNames{"DCAxy", "DCAz", "TPCn
 static const std::vector<std::string> binnedLabelNames{"Maximum value of binned variables"};
 
 float pidCuts[2][4][2];
+o2::analysis::BetheBlochTable betheBlochTables[4];
+float betheBlochResolution[4];
 std::shared_ptr<TH3> hNsigma[2][4][2];
 std::shared_ptr<TH3> hTOFmass[4][2];
 std::shared_ptr<TH3> hDCAxy[2][4][2];
@@ -184,6 +188,9 @@ struct NucleiSpectraTask {
   ConfigurableAxis cfgPtBinsHe3{"cfgPtBinsHe3", {100, 0., 10.}, "Pt binning for He3"};
   ConfigurableAxis cfgPtBinsAlpha{"cfgPtBinsAlpha", {100, 0., 10.}, "Pt binning for Alpha"};
 
+  Configurable<bool> cfgBetheBlochLUT{"cfgBetheBlochLUT", true, "Use the tabulated Bethe-Bloch parameterisation instead of the closed form"};
+  Configurable<int> cfgBetheBlochLUTpoints{"cfgBetheBlochLUTpoints", 4000, "Number of beta*gamma points of the tabulated Bethe-Bloch parameterisation"};
+
   ConfigurableAxis cfgCentralityBins{"cfgCentralityBins", {100, 0., 100.}, "Centrality binning"};
   ConfigurableAxis cfgNsigmaTPCbins{"cfgNsigmaTPCbins", {100, -5., 5.}, "nsigma_TPC binning"};
   ConfigurableAxis cfgNsigmaTOFbins{"cfgNsigmaTOFbins", {100, -5., 5.}, "nsigma_TOF binning"};
@@ -230,6 +237,11 @@ struct NucleiSpectraTask {
         nuclei::pidCuts[0][iS][iMax] = cfgNsigmaTPC->get(iS, iMax);
         nuclei::pidCuts[1][iS][iMax] = cfgNsigmaTOF->get(iS, iMax);
       }
+      nuclei::betheBlochResolution[iS] = cfgBetheBlochParams->get(iS, 5u);
+      if (nuclei::betheBlochResolution[iS] > 0.f && cfgBetheBlochLUT) {
+        const double params[5]{cfgBetheBlochParams->get(iS, 0u), cfgBetheBlochParams->get(iS, 1u), cfgBetheBlochParams->get(iS, 2u), cfgBetheBlochParams->get(iS, 3u), cfgBetheBlochParams->get(iS, 4u)};
+        nuclei::betheBlochTables[iS].init(params, 0.1f, 10.f, cfgBetheBlochLUTpoints);
+      }
     }
   }
 
@@ -264,7 +276,10 @@ struct NucleiSpectraTask {
           continue;
         }
 
-        if (cfgBetheBlochParams->get(iS, 5u) > 0.f) {
+        if (nuclei::betheBlochResolution[iS] > 0.f && nuclei::betheBlochTables[iS].isInitialised()) {
+          float expBethe{nuclei::betheBlochTables[iS].get(track.tpcInnerParam() * nuclei::charges[iS] / nuclei::masses[iS])};
+          nSigma[0][iS] = (track.tpcSignal() - expBethe) / (expBethe * nuclei::betheBlochResolution[iS]);
+        } else if (nuclei::betheBlochResolution[iS] > 0.f) {
           double expBethe{tpc::BetheBlochAleph(static_cast<double>(track.tpcInnerParam() * nuclei::charges[iS] / nuclei::masses[iS]), cfgBetheBlochParams->get(iS, 0u), cfgBetheBlochParams->get(iS, 1u), cfgBetheBlochParams->get(iS, 2u), cfgBetheBlochParams->get(iS, 3u), cfgBetheBlochParams->get(iS, 4u))};
           double expSigma{expBethe * cfgBetheBlochParams->get(iS, 5u)};
           nSigma[0][iS] = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
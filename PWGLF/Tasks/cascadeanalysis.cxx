@@ -41,6 +41,7 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/PIDResponse.h"
+#include "PWGLF/Utils/cascadeSelectionKernel.h"
 
 #include <TFile.h>
 #include <TH2F.h>
@@ -58,6 +59,14 @@ using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using std::array;
+using namespace o2::analysis::strangeness;
+
+namespace
+{
+// default cut variation: the nominal selections
+constexpr float cascadeCutSetsDefault[1][kNCascadeCutVariables]{{0.95f, 1.0f, 0.1f, 0.1f, 0.9f, 0.95f, 1.0f, 0.1f, 0.5f, 0.01f, 0.01f}};
+static const std::vector<std::string> cascadeCutSetsNames{"nominal"};
+} // namespace
 
 //use parameters + cov mat non-propagated, aux info + (extension propagated)
 using FullTracksExt = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksCov, aod::TracksDCA>;
@@ -144,6 +153,34 @@ struct cascadeAnalysis {
       registry.add("h3dMassOmegaMinus", "h3dMassOmegaMinus", {HistType::kTH3F, {centAxis, ptAxis, massAxisOmega}});
       registry.add("h3dMassOmegaPlus", "h3dMassOmegaPlus", {HistType::kTH3F, {centAxis, ptAxis, massAxisOmega}});
     }
+
+    if (doCutVariations) {
+      std::vector<CascadeCutSet> cutSets;
+      const auto& setNames = cascadeCutSets->getLabelsRows();
+      for (auto iSet = 0u; iSet < cascadeCutSets->rows(); ++iSet) {
+        if (static_cast<int>(iSet) == kMaxCascadeCutSets) {
+          LOGF(fatal, "At most %d cascade cut sets can be evaluated at the same time", kMaxCascadeCutSets);
+        }
+        CascadeCutSet cutSet;
+        for (int iVar = 0; iVar < kNCascadeCutVariables; ++iVar) {
+          cutSet[iVar] = cascadeCutSets->get(iSet, iVar);
+        }
+        cutSets.push_back(cutSet);
+        const std::string dir = "CutVariations/" + (iSet < setNames.size() ? setNames[iSet] : std::to_string(iSet)) + "/";
+        std::array<TH1*, 4> hSet;
+        const char* names[4] = {"MassXiMinus", "MassXiPlus", "MassOmegaMinus", "MassOmegaPlus"};
+        for (int iH = 0; iH < 4; ++iH) {
+          const AxisSpec& massAxis = iH < 2 ? massAxisXi : massAxisOmega;
+          if (!doCentralityStudy) {
+            hSet[iH] = std::get<std::shared_ptr<TH2>>(registry.add((dir + "h2d" + names[iH]).c_str(), ("h2d" + std::string(names[iH])).c_str(), {HistType::kTH2F, {ptAxis, massAxis}})).get();
+          } else {
+            hSet[iH] = std::get<std::shared_ptr<TH3>>(registry.add((dir + "h3d" + names[iH]).c_str(), ("h3d" + std::string(names[iH])).c_str(), {HistType::kTH3F, {centAxis, ptAxis, massAxis}})).get();
+          }
+        }
+        hCutVariations.push_back(hSet);
+      }
+      cutKernel.setCutSets(cutSets);
+    }
   }
 
   //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
@@ -178,6 +215,22 @@ struct cascadeAnalysis {
   //Switch for centrality
   Configurable<bool> doCentralityStudy{"doCentralityStudy", false, "do centrality percentile selection (yes/no)"};
 
+  //Systematic variations of the topological selections, evaluated together over the cascades of the collision
+  //N.B.: the preFilter applies the nominal DCA selections, the variations of those can only be tighter
+  Configurable<bool> doCutVariations{"doCutVariations", false, "fill the invariant mass distributions for each set of cascadeCutSets (yes/no)"};
+  Configurable<LabeledArray<float>> cascadeCutSets{"cascadeCutSets", {cascadeCutSetsDefault[0], 1, kNCascadeCutVariables, cascadeCutSetsNames, cascadeCutVariableNames}, "Sets of topological selections, one per row"};
+
+  CascadeSelectionKernel cutKernel;
+  CascadeTopology cascTopology;
+  std::vector<uint32_t> cascMasks;
+  struct CascadeKinematics {
+    int sign;
+    float pt, mXi, mOmega, yXi, yOmega;
+    int pidValue;
+  };
+  std::vector<CascadeKinematics> cascKinematics;
+  std::vector<std::array<TH1*, 4>> hCutVariations; // Xi-, Xi+, Omega-, Omega+ mass distributions per cut set
+
   Filter preFilter =
     nabs(aod::cascdata::dcapostopv) > v0setting_dcapostopv&& nabs(aod::cascdata::dcanegtopv) > v0setting_dcanegtopv&& nabs(aod::cascdata::dcabachtopv) > cascadesetting_dcabachtopv&& aod::cascdata::dcaV0daughters < v0setting_dcav0dau&& aod::cascdata::dcacascdaughters < cascadesetting_dcacascdau;
 
@@ -219,17 +272,9 @@ struct cascadeAnalysis {
     return lConsistentWithLambda * lConsistentWithXi + 2 * lConsistentWithLambda * lConsistentWithOm;
   }
 
-  template <class TCascTracksTo, typename TCascade>
-  void processCascadeCandidate(TCascade const& casc, float const& pvx, float const& pvy, float const& pvz, float lPercentile = 999.0f, int lPIDvalue = 3)
-  //function to process cascades and generate corresponding invariant mass distributions
+  template <class TCascTracksTo, typename TCascade, typename TV0Data>
+  bool hasGoodTrackQuality(TCascade const& casc, TV0Data const& v0data)
   {
-    registry.fill(HIST("hCandidateCounter"), 0.5); //all candidates
-    auto v0 = casc.template v0_as<o2::aod::V0sLinked>();
-    if (!(v0.has_v0Data())) {
-      return; //skip those cascades for which V0 doesn't exist
-    }
-    registry.fill(HIST("hCandidateCounter"), 1.5); //v0data exists
-    auto v0data = v0.v0Data();                     // de-reference index to correct v0data in case it exists
     auto bachTrackCast = casc.template bachelor_as<TCascTracksTo>();
     auto posTrackCast = v0data.template posTrack_as<TCascTracksTo>();
     auto negTrackCast = v0data.template negTrack_as<TCascTracksTo>();
@@ -277,7 +322,21 @@ struct cascadeAnalysis {
         lGoodCandidate = kTRUE;
       }
     }
-    if (!lGoodCandidate)
+    return lGoodCandidate;
+  }
+
+  template <class TCascTracksTo, typename TCascade>
+  void processCascadeCandidate(TCascade const& casc, float const& pvx, float const& pvy, float const& pvz, float lPercentile = 999.0f, int lPIDvalue = 3)
+  //function to process cascades and generate corresponding invariant mass distributions
+  {
+    registry.fill(HIST("hCandidateCounter"), 0.5); //all candidates
+    auto v0 = casc.template v0_as<o2::aod::V0sLinked>();
+    if (!(v0.has_v0Data())) {
+      return; //skip those cascades for which V0 doesn't exist
+    }
+    registry.fill(HIST("hCandidateCounter"), 1.5); //v0data exists
+    auto v0data = v0.v0Data();                     // de-reference index to correct v0data in case it exists
+    if (!hasGoodTrackQuality<TCascTracksTo>(casc, v0data))
       return;
     registry.fill(HIST("hCandidateCounter"), 2.5); //okay track quality
 
@@ -326,6 +385,47 @@ struct cascadeAnalysis {
     }
   }
 
+  template <class TCascTracksTo, typename TCascades>
+  void processCutVariations(TCascades const& Cascades, float pvx, float pvy, float pvz, float lPercentile, bool withPID)
+  //function to fill the invariant mass distributions of all the cut sets from a single pass over the cascades
+  {
+    cascTopology.clear();
+    cascKinematics.clear();
+    for (auto& casc : Cascades) {
+      auto v0 = casc.template v0_as<o2::aod::V0sLinked>();
+      if (!(v0.has_v0Data())) {
+        continue;
+      }
+      if (!hasGoodTrackQuality<TCascTracksTo>(casc, v0.v0Data())) {
+        continue;
+      }
+      cascTopology.push(casc, pvx, pvy, pvz);
+      cascKinematics.push_back({casc.sign(), casc.pt(), casc.mXi(), casc.mOmega(), casc.yXi(), casc.yOmega(), withPID ? checkCascadeTPCPID<TCascTracksTo>(casc) : 3});
+    }
+    cutKernel.evaluate(cascTopology, cascMasks);
+
+    for (size_t i = 0; i < cascKinematics.size(); ++i) {
+      const auto& casc = cascKinematics[i];
+      const bool fillXi = TMath::Abs(casc.yXi) < 0.5 && (casc.pidValue >> 0 & 1);
+      const bool fillOm = TMath::Abs(casc.yOmega) < 0.5 && (casc.pidValue >> 1 & 1);
+      const int iXi = casc.sign < 0 ? 0 : 1;
+      for (uint32_t mask = cascMasks[i]; mask != 0; mask &= mask - 1) {
+        const auto& hSet = hCutVariations[__builtin_ctz(mask)];
+        if (!doCentralityStudy) {
+          if (fillXi)
+            static_cast<TH2*>(hSet[iXi])->Fill(casc.pt, casc.mXi);
+          if (fillOm)
+            static_cast<TH2*>(hSet[iXi + 2])->Fill(casc.pt, casc.mOmega);
+        } else {
+          if (fillXi)
+            static_cast<TH3*>(hSet[iXi])->Fill(lPercentile, casc.pt, casc.mXi);
+          if (fillOm)
+            static_cast<TH3*>(hSet[iXi + 2])->Fill(lPercentile, casc.pt, casc.mOmega);
+        }
+      }
+    }
+  }
+
   void processRun3(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision, soa::Filtered<aod::CascDataExt> const& Cascades, aod::V0sLinked const&, aod::V0Datas const&, FullTracksExtIU const&)
   //process function subscribing to Run 3-like analysis objects
   {
@@ -337,6 +437,9 @@ struct cascadeAnalysis {
     for (auto& casc : Cascades) {
       processCascadeCandidate<FullTracksExtIU>(casc, collision.posX(), collision.posY(), collision.posZ());
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExtIU>(Cascades, collision.posX(), collision.posY(), collision.posZ(), 999.0f, false);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun3, "Process Run 3 data", true);
 
@@ -354,6 +457,9 @@ struct cascadeAnalysis {
     for (auto& casc : Cascades) {
       processCascadeCandidate<FullTracksExt>(casc, collision.posX(), collision.posY(), collision.posZ());
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExt>(Cascades, collision.posX(), collision.posY(), collision.posZ(), 999.0f, false);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun2, "Process Run 2 data", false);
 
@@ -368,6 +474,9 @@ struct cascadeAnalysis {
     for (auto& casc : Cascades) {
       processCascadeCandidate<FullTracksExtIU>(casc, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M());
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExtIU>(Cascades, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M(), false);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun3VsMultiplicity, "Process Run 3 data vs multiplicity", false);
 
@@ -385,6 +494,9 @@ struct cascadeAnalysis {
     for (auto& casc : Cascades) {
       processCascadeCandidate<FullTracksExt>(casc, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M());
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExt>(Cascades, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M(), false);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun2VsMultiplicity, "Process Run 2 data vs multiplicity", false);
 
@@ -400,6 +512,9 @@ struct cascadeAnalysis {
       int lPIDvalue = checkCascadeTPCPID<FullTracksExtWithPID>(casc);
       processCascadeCandidate<FullTracksExtIUWithPID>(casc, collision.posX(), collision.posY(), collision.posZ(), -999, lPIDvalue);
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExtIUWithPID>(Cascades, collision.posX(), collision.posY(), collision.posZ(), -999, true);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun3WithPID, "Process Run 3 data  with PID", false);
 
@@ -418,6 +533,9 @@ struct cascadeAnalysis {
       int lPIDvalue = checkCascadeTPCPID<FullTracksExtWithPID>(casc);
       processCascadeCandidate<FullTracksExtWithPID>(casc, collision.posX(), collision.posY(), collision.posZ(), -999, lPIDvalue);
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExtWithPID>(Cascades, collision.posX(), collision.posY(), collision.posZ(), -999, true);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun2WithPID, "Process Run 2 data  with PID", false);
 
@@ -433,6 +551,9 @@ struct cascadeAnalysis {
       int lPIDvalue = checkCascadeTPCPID<FullTracksExtIUWithPID>(casc);
       processCascadeCandidate<FullTracksExtIUWithPID>(casc, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M(), lPIDvalue);
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExtIUWithPID>(Cascades, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M(), true);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun3VsMultiplicityWithPID, "Process Run 3 data vs multiplicity with PID", false);
 
@@ -451,6 +572,9 @@ struct cascadeAnalysis {
       int lPIDvalue = checkCascadeTPCPID<FullTracksExtWithPID>(casc);
       processCascadeCandidate<FullTracksExtWithPID>(casc, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M(), lPIDvalue);
     }
+    if (doCutVariations) {
+      processCutVariations<FullTracksExtWithPID>(Cascades, collision.posX(), collision.posY(), collision.posZ(), collision.centRun2V0M(), true);
+    }
   }
   PROCESS_SWITCH(cascadeAnalysis, processRun2VsMultiplicityWithPID, "Process Run 2 data vs multiplicity with PID", false);
 };
@@ -31,6 +31,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Framework/AnalysisTask.h"
+#include "PWGLF/DataModel/LFMcGenPrimaries.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -110,8 +111,8 @@ struct identifiedraaTask {
     }
   }
 
-  template <std::size_t i, typename T1, typename T2>
-  void fillHistograms_MC(T1 const& tracks, T2 const& mcParticles)
+  template <std::size_t i, typename T1>
+  void fillTrackHistograms_MC(T1 const& tracks)
   {
     for (auto& track : tracks) {
       const auto mcParticle = track.template mcParticle_as<aod::McParticles_000>();
@@ -182,6 +183,12 @@ struct identifiedraaTask {
         }
       }
     }
+  }
+
+  template <std::size_t i, typename T1, typename T2>
+  void fillHistograms_MC(T1 const& tracks, T2 const& mcParticles)
+  {
+    fillTrackHistograms_MC<i>(tracks);
     for (auto& particle : mcParticles) {
       //if (std::abs(particle.eta()) > 0.8) {
       //   continue;
@@ -217,6 +224,49 @@ struct identifiedraaTask {
 
   PROCESS_SWITCH(identifiedraaTask, processMC, "Process simulation events", false);
 
+  // Same as processMC, with the generated primaries of lf-mc-gen-primaries read once for the six species
+  void processMCGenPrimaries(soa::Join<aod::Tracks, aod::TracksExtra,
+                                       aod::TracksDCA, aod::McTrackLabels,
+                                       aod::pidTOFFullPi, aod::pidTOFFullKa,
+                                       aod::pidTOFFullPr> const& tracks,
+                             const aod::McParticles_000&,
+                             const aod::LfMcGenPrimaries& genPrimaries)
+  {
+    fillTrackHistograms_MC<0>(tracks);
+    fillTrackHistograms_MC<1>(tracks);
+    fillTrackHistograms_MC<2>(tracks);
+    fillTrackHistograms_MC<3>(tracks);
+    fillTrackHistograms_MC<4>(tracks);
+    fillTrackHistograms_MC<5>(tracks);
+    for (auto& particle : genPrimaries) {
+      if (std::abs(particle.y()) > 0.5) {
+        continue;
+      }
+      switch (particle.pdgCode()) {
+        case pdg_num[0]:
+          histos.fill(HIST(pt_den[0]), particle.pt());
+          break;
+        case pdg_num[1]:
+          histos.fill(HIST(pt_den[1]), particle.pt());
+          break;
+        case pdg_num[2]:
+          histos.fill(HIST(pt_den[2]), particle.pt());
+          break;
+        case pdg_num[3]:
+          histos.fill(HIST(pt_den[3]), particle.pt());
+          break;
+        case pdg_num[4]:
+          histos.fill(HIST(pt_den[4]), particle.pt());
+          break;
+        case pdg_num[5]:
+          histos.fill(HIST(pt_den[5]), particle.pt());
+          break;
+      }
+    }
+  }
+
+  PROCESS_SWITCH(identifiedraaTask, processMCGenPrimaries, "Process simulation events, with the generated primaries of lf-mc-gen-primaries", false);
+
   template <std::size_t i, typename T>
   void fillHistogramsData(T const& tracks)
   {
@@ -25,12 +25,14 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resonancePairEngine.h"
 #include "DataFormatsParameters/GRPObject.h"
 
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using namespace o2::soa;
+using namespace o2::analysis::resonance;
 
 struct k892analysis {
   framework::Service<o2::ccdb::BasicCCDBManager> ccdb; /// Accessing the CCDB
@@ -54,6 +56,11 @@ struct k892analysis {
   Configurable<double> cMaxDCAzToPVcut{"cMaxDCAzToPVcut", 2.0, "Track DCAz cut to PV Maximum"};
   Configurable<double> cMinDCAzToPVcut{"cMinDCAzToPVcut", 0.0, "Track DCAz cut to PV Minimum"};
 
+  /// Backgrounds from the same pair pass as the signal
+  Configurable<bool> cfgSinglePassBkg{"cfgSinglePassBkg", false, "Fill the like-sign and rotated backgrounds in the pair loop of the signal"};
+  Configurable<int> cfgNRotations{"cfgNRotations", 3, "Number of rotated-background entries per unlike-sign pair"};
+  Configurable<float> cfgRotationSpread{"cfgRotationSpread", 0.5f, "Spread (rad) of the rotation angles of the second daughter around pi"};
+
   Preslice<aod::Tracks> perCollision = aod::track::collisionId;
 
   void init(o2::framework::InitContext&)
@@ -87,6 +94,14 @@ struct k892analysis {
     histos.add("h3k892invmass", "Invariant mass of K(892)0", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {900, 0.6, 1.5}});
     histos.add("h3k892invmassME", "Invariant mass of K(892)0 mixed event", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {900, 0.6, 1.5}});
 
+    if (cfgSinglePassBkg) {
+      histos.add("k892invmassLS", "Invariant mass of K(892)0 like sign", kTH1F, {{900, 0.6, 1.5, "Invariant Mass (GeV/#it{c}^2)"}});
+      histos.add("k892invmassRot", "Invariant mass of K(892)0 rotated background", kTH1F, {{900, 0.6, 1.5, "Invariant Mass (GeV/#it{c}^2)"}});
+      histos.add("h3k892invmassLS", "Invariant mass of K(892)0 like sign", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {900, 0.6, 1.5}});
+      histos.add("h3k892invmassRot", "Invariant mass of K(892)0 rotated background", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {900, 0.6, 1.5}});
+      pairEngine.setRotations(cfgNRotations, cfgRotationSpread);
+    }
+
     if (doprocessMC) {
       histos.add("h3recok892invmass", "Invariant mass of Reconstructed MC K(892)0", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {900, 0.6, 1.5}});
       histos.add("truek892pt", "pT distribution of True MC K(892)0", kTH1F, {{100, 0, 10, "#it{p}_{T} (GeV/#it{c})"}});
@@ -98,68 +113,106 @@ struct k892analysis {
   double massKa = TDatabasePDG::Instance()->GetParticle(kKPlus)->Mass();
   double massPi = TDatabasePDG::Instance()->GetParticle(kPiPlus)->Mass();
 
+  // Daughter candidates of the collision(s), with the pion and kaon mass hypotheses, and the quantities used in the pair loop besides the kinematics
+  enum Hypotheses { kPion = 0,
+                    kKaon };
+  enum PidBits : uint8_t { kPionTPC = 1,
+                           kKaonTPC = 2 };
+  ResoDaughters daughters, daughtersMixed;
+  ResoPairEngine pairEngine;
+  struct DaughterInfo {
+    float pt, tpcNSigmaPi, tofNSigmaPi, tpcNSigmaKa, tofNSigmaKa;
+    int pdgCode, motherId, motherPDG;
+  };
+  std::vector<DaughterInfo> daughterInfo;
+
+  template <bool IsMC, typename TracksType>
+  void fillDaughters(const TracksType& dTracks, ResoDaughters& buffer, bool withInfo)
+  {
+    if (withInfo) {
+      daughterInfo.clear();
+    }
+    buffer.fill(
+      dTracks, {static_cast<float>(massPi), static_cast<float>(massKa)},
+      [](auto const& trk) -> uint8_t {
+        // pT-dependent TPC PID cut
+        return (passPtDependentTPCnSigma(trk.pt(), trk.tpcNSigmaPi()) ? kPionTPC : 0) | (passPtDependentTPCnSigma(trk.pt(), trk.tpcNSigmaKa()) ? kKaonTPC : 0);
+      },
+      [&](auto const& trk) {
+        if (!withInfo) {
+          return;
+        }
+        DaughterInfo info{trk.pt(), trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcNSigmaKa(), trk.tofNSigmaKa(), 0, -1, 0};
+        if constexpr (IsMC) {
+          info.pdgCode = trk.pdgCode();
+          info.motherId = trk.motherId();
+          info.motherPDG = trk.motherPDG();
+        }
+        daughterInfo.push_back(info);
+      });
+  }
+
   template <bool IsMC, typename CollisionType, typename TracksType>
   void fillHistograms(const CollisionType& collision, const TracksType& dTracks)
   {
-    TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
-    for (auto& [trk1, trk2] : combinations(CombinationsFullIndexPolicy(dTracks, dTracks))) {
-      // Un-like sign pair only
-      if (trk1.sign() * trk2.sign() > 0)
-        continue;
-
-      // Trk1: Pion, Trk2: Kaon
-      // pT-dependent TPC PID cut
-      if ((trk1.pt() < 0.3) && (std::abs(trk1.tpcNSigmaPi()) > 6.0))
-        continue;
-      if ((trk1.pt() >= 0.3) && (trk1.pt() < 0.4) && (std::abs(trk1.tpcNSigmaPi()) > 4.0))
-        continue;
-      if ((trk1.pt() >= 0.4) && (std::abs(trk1.tpcNSigmaPi()) > 2.0))
-        continue;
-
-      if ((trk2.pt() < 0.3) && (std::abs(trk2.tpcNSigmaKa()) > 6.0))
-        continue;
-      if ((trk2.pt() >= 0.3) && (trk2.pt() < 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 4.0))
-        continue;
-      if ((trk2.pt() >= 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 2.0))
-        continue;
-
+    fillDaughters<IsMC>(dTracks, daughters, true);
+    auto fillSignal = [&](int i1, int i2, float mass, float pt, float y) {
+      const auto& trk1 = daughterInfo[i1];
+      const auto& trk2 = daughterInfo[i2];
       //  --- PID QA Pion -
-      histos.fill(HIST("TOF_Nsigma1"), trk1.pt(), trk1.tofNSigmaPi());
-      histos.fill(HIST("TPC_Nsigma1"), trk1.pt(), trk1.tpcNSigmaPi());
-      histos.fill(HIST("TOF_TPC_Map1"), trk1.tofNSigmaPi(), trk1.tpcNSigmaPi());
+      histos.fill(HIST("TOF_Nsigma1"), trk1.pt, trk1.tofNSigmaPi);
+      histos.fill(HIST("TPC_Nsigma1"), trk1.pt, trk1.tpcNSigmaPi);
+      histos.fill(HIST("TOF_TPC_Map1"), trk1.tofNSigmaPi, trk1.tpcNSigmaPi);
       //  --- PID QA Kaon +
-      histos.fill(HIST("TOF_Nsigma2"), trk2.pt(), trk2.tofNSigmaKa());
-      histos.fill(HIST("TPC_Nsigma2"), trk2.pt(), trk2.tpcNSigmaKa());
-      histos.fill(HIST("TOF_TPC_Map2"), trk2.tofNSigmaKa(), trk2.tpcNSigmaKa());
+      histos.fill(HIST("TOF_Nsigma2"), trk2.pt, trk2.tofNSigmaKa);
+      histos.fill(HIST("TPC_Nsigma2"), trk2.pt, trk2.tpcNSigmaKa);
+      histos.fill(HIST("TOF_TPC_Map2"), trk2.tofNSigmaKa, trk2.tpcNSigmaKa);
 
-      lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massPi);
-      lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
+      histos.fill(HIST("trk1pT"), trk1.pt);
+      histos.fill(HIST("trk2pT"), trk2.pt);
 
-      histos.fill(HIST("trk1pT"), trk1.pt());
-      histos.fill(HIST("trk2pT"), trk2.pt());
+      if (y > 0.5 || y < -0.5)
+        return;
 
-      lResonance = lDecayDaughter1 + lDecayDaughter2;
-
-      if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-        continue;
-
-      histos.fill(HIST("k892invmass"), lResonance.M());
-      histos.fill(HIST("h3k892invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+      histos.fill(HIST("k892invmass"), mass);
+      histos.fill(HIST("h3k892invmass"), collision.multV0M(), pt, mass);
 
       if constexpr (IsMC) {
-        if (abs(trk1.pdgCode()) != kPiPlus || abs(trk2.pdgCode()) != kKPlus)
-          continue;
-        auto mother1 = trk1.motherId();
-        auto mother2 = trk2.motherId();
-        if (mother1 == mother2) {             // Same mother
-          if (abs(trk1.motherPDG()) == 313) { // k892(0)
-            histos.fill(HIST("reconk892pt"), lResonance.Pt());
-            histos.fill(HIST("reconk892invmass"), lResonance.M());
-            histos.fill(HIST("h3recok892invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+        if (abs(trk1.pdgCode) != kPiPlus || abs(trk2.pdgCode) != kKPlus)
+          return;
+        if (trk1.motherId == trk2.motherId) { // Same mother
+          if (abs(trk1.motherPDG) == 313) {   // k892(0)
+            histos.fill(HIST("reconk892pt"), pt);
+            histos.fill(HIST("reconk892invmass"), mass);
+            histos.fill(HIST("h3recok892invmass"), collision.multV0M(), pt, mass);
           }
         }
       }
+    };
+
+    if (!cfgSinglePassBkg) {
+      // Un-like sign pairs, Trk1: Pion, Trk2: Kaon
+      pairEngine.loop(daughters, kPion, kPionTPC, daughters, kKaon, kKaonTPC, PairSign::kUnlike, PairOrder::kAll, fillSignal);
+      return;
     }
+    // Un-like sign, like sign and rotated pairs from the same pass, Trk1: Pion, Trk2: Kaon
+    pairEngine.loopWithBackgrounds(daughters, kPion, kPionTPC, daughters, kKaon, kKaonTPC, PairOrder::kAll, true, [&](PairKind kind, int, int i1, int i2, float mass, float pt, float y) {
+      if (kind == PairKind::kUnlikeSign) {
+        fillSignal(i1, i2, mass, pt, y);
+        return;
+      }
+      if (i1 == i2) // same track under both hypotheses
+        return;
+      if (y > 0.5 || y < -0.5)
+        return;
+      if (kind == PairKind::kLikeSign) {
+        histos.fill(HIST("k892invmassLS"), mass);
+        histos.fill(HIST("h3k892invmassLS"), collision.multV0M(), pt, mass);
+      } else {
+        histos.fill(HIST("k892invmassRot"), mass);
+        histos.fill(HIST("h3k892invmassRot"), collision.multV0M(), pt, mass);
+      }
+    });
   }
 
   void processData(aod::ResoCollisions& collisions,
@@ -220,41 +273,22 @@ struct k892analysis {
     BinningTypeVetZTPCtemp colBinning{{CfgVtxBins, CfgMultBins}, true};
     SameKindPair<aod::ResoCollisions, aod::ResoTracks, BinningTypeVetZTPCtemp> pairs{colBinning, 10, -1, collisions, tracksTuple}; // -1 is the number of the bin to skip
 
-    TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
     for (auto& [collision1, tracks1, collision2, tracks2] : pairs) {
       Partition<aod::ResoTracks> selectedTracks1 = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
       selectedTracks1.bindTable(tracks1);
       Partition<aod::ResoTracks> selectedTracks2 = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
       selectedTracks2.bindTable(tracks2);
 
-      for (auto& [trk1, trk2] : combinations(CombinationsFullIndexPolicy(selectedTracks1, selectedTracks2))) {
-        // Un-like sign pair only
-        if (trk1.sign() * trk2.sign() > 0)
-          continue;
-        if ((trk1.pt() < 0.3) && (std::abs(trk1.tpcNSigmaPi()) > 6.0))
-          continue;
-        if ((trk1.pt() >= 0.3) && (trk1.pt() < 0.4) && (std::abs(trk1.tpcNSigmaPi()) > 4.0))
-          continue;
-        if ((trk1.pt() >= 0.4) && (std::abs(trk1.tpcNSigmaPi()) > 2.0))
-          continue;
+      fillDaughters<false>(selectedTracks1, daughters, false);
+      fillDaughters<false>(selectedTracks2, daughtersMixed, false);
+      // Un-like sign pairs, Trk1: Pion, Trk2: Kaon
+      pairEngine.loop(daughters, kPion, kPionTPC, daughtersMixed, kKaon, kKaonTPC, PairSign::kUnlike, PairOrder::kAll, [&](int, int, float mass, float pt, float y) {
+        if (y > 0.5 || y < -0.5)
+          return;
 
-        if ((trk2.pt() < 0.3) && (std::abs(trk2.tpcNSigmaKa()) > 6.0))
-          continue;
-        if ((trk2.pt() >= 0.3) && (trk2.pt() < 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 4.0))
-          continue;
-        if ((trk2.pt() >= 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 2.0))
-          continue;
-
-        lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massPi);
-        lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-        lResonance = lDecayDaughter1 + lDecayDaughter2;
-
-        if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-          continue;
-
-        histos.fill(HIST("k892invmassME"), lResonance.M());
-        histos.fill(HIST("h3k892invmassME"), collision1.multV0M(), lResonance.Pt(), lResonance.M());
-      }
+        histos.fill(HIST("k892invmassME"), mass);
+        histos.fill(HIST("h3k892invmassME"), collision1.multV0M(), pt, mass);
+      });
     }
   };
   PROCESS_SWITCH(k892analysis, processME, "Process EventMixing", false);
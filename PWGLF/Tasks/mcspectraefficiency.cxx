@@ -14,6 +14,7 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
 #include "Common/DataModel/TrackSelectionTables.h"
+#include "PWGLF/DataModel/LFMcGenPrimaries.h"
 
 // ROOT includes
 #include <TH1F.h>
@@ -59,7 +60,20 @@ struct GeneratedTask {
   int particles = 0;
   int primaryparticles = 0;
 
-  void process(aod::McCollision const& mcCollision, aod::McParticles& mcParticles)
+  template <typename TParticle>
+  void fillPrimary(TParticle const& mcParticle, float p)
+  {
+    const auto pdg = Form("%i", mcParticle.pdgCode());
+    pdgH->Fill(pdg, 1);
+    const float pdgbin = pdgH->GetXaxis()->GetBinCenter(pdgH->GetXaxis()->FindBin(pdg));
+    phiH->Fill(mcParticle.phi(), pdgbin);
+    etaH->Fill(mcParticle.eta(), pdgbin);
+    pH->Fill(p, pdgbin);
+    ptH->Fill(mcParticle.pt(), pdgbin);
+    primaryparticles++;
+  }
+
+  void processMcParticles(aod::McCollision const& mcCollision, aod::McParticles& mcParticles)
   {
     LOGF(info, "MC. vtx-z = %f", mcCollision.posZ());
     for (auto& mcParticle : mcParticles) {
@@ -67,14 +81,7 @@ struct GeneratedTask {
         continue;
       }
       if (mcParticle.isPhysicalPrimary()) {
-        const auto pdg = Form("%i", mcParticle.pdgCode());
-        pdgH->Fill(pdg, 1);
-        const float pdgbin = pdgH->GetXaxis()->GetBinCenter(pdgH->GetXaxis()->FindBin(pdg));
-        phiH->Fill(mcParticle.phi(), pdgbin);
-        etaH->Fill(mcParticle.eta(), pdgbin);
-        pH->Fill(sqrt(mcParticle.px() * mcParticle.px() + mcParticle.py() * mcParticle.py() + mcParticle.pz() * mcParticle.pz()), pdgbin);
-        ptH->Fill(mcParticle.pt(), pdgbin);
-        primaryparticles++;
+        fillPrimary(mcParticle, sqrt(mcParticle.px() * mcParticle.px() + mcParticle.py() * mcParticle.py() + mcParticle.pz() * mcParticle.pz()));
       }
       particles++;
     }
@@ -82,6 +89,22 @@ struct GeneratedTask {
     LOGF(info, "Particles %i", particles);
     LOGF(info, "Primaries %i", primaryparticles);
   }
+  PROCESS_SWITCH(GeneratedTask, processMcParticles, "Fill the generated particles from the McParticles", true);
+
+  /// Same histograms from the primaries of lf-mc-gen-primaries, the particle count is not available
+  void processGenPrimaries(aod::McCollision const& mcCollision, aod::LfMcGenPrimaries const& genPrimaries)
+  {
+    LOGF(info, "MC. vtx-z = %f", mcCollision.posZ());
+    for (auto const& genPrimary : genPrimaries) {
+      if (abs(genPrimary.eta()) > 0.8) {
+        continue;
+      }
+      fillPrimary(genPrimary, genPrimary.p());
+    }
+    LOGF(info, "Events %i", events++ + 1);
+    LOGF(info, "Primaries %i", primaryparticles);
+  }
+  PROCESS_SWITCH(GeneratedTask, processGenPrimaries, "Fill the generated particles from the table of lf-mc-gen-primaries", false);
 };
 
 // Access from tracks to MC particle
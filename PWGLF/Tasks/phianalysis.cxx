@@ -25,12 +25,14 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resonancePairEngine.h"
 #include "DataFormatsParameters/GRPObject.h"
 
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using namespace o2::soa;
+using namespace o2::analysis::resonance;
 
 struct phianalysis {
   framework::Service<o2::ccdb::BasicCCDBManager> ccdb; /// Accessing the CCDB
@@ -53,6 +55,11 @@ struct phianalysis {
   Configurable<double> cMaxDCAzToPVcut{"cMaxDCAzToPVcut", 2.0, "Track DCAz cut to PV Maximum"};
   Configurable<double> cMinDCAzToPVcut{"cMinDCAzToPVcut", 0.0, "Track DCAz cut to PV Minimum"};
 
+  /// Backgrounds from the same pair pass as the signal
+  Configurable<bool> cfgSinglePassBkg{"cfgSinglePassBkg", false, "Fill the like-sign and rotated backgrounds in the pair loop of the signal"};
+  Configurable<int> cfgNRotations{"cfgNRotations", 3, "Number of rotated-background entries per unlike-sign pair"};
+  Configurable<float> cfgRotationSpread{"cfgRotationSpread", 0.5f, "Spread (rad) of the rotation angles of the second daughter around pi"};
+
   Preslice<aod::Tracks> perCollision = aod::track::collisionId;
 
   void init(o2::framework::InitContext&)
@@ -86,6 +93,14 @@ struct phianalysis {
     histos.add("h3phiinvmass", "Invariant mass of Phi", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {700, 0.8, 1.5}});
     histos.add("h3phiinvmassME", "Invariant mass of Phi mixed event", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {700, 0.8, 1.5}});
 
+    if (cfgSinglePassBkg) {
+      histos.add("phiinvmassLS", "Invariant mass of Phi like sign", kTH1F, {{700, 0.8, 1.5, "Invariant Mass (GeV/#it{c}^2)"}});
+      histos.add("phiinvmassRot", "Invariant mass of Phi rotated background", kTH1F, {{700, 0.8, 1.5, "Invariant Mass (GeV/#it{c}^2)"}});
+      histos.add("h3phiinvmassLS", "Invariant mass of Phi like sign", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {700, 0.8, 1.5}});
+      histos.add("h3phiinvmassRot", "Invariant mass of Phi rotated background", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {700, 0.8, 1.5}});
+      pairEngine.setRotations(cfgNRotations, cfgRotationSpread);
+    }
+
     if (doprocessMC) {
       histos.add("h3recophiinvmass", "Invariant mass of Reconstructed MC Phi", kTH3F, {{300, 0, 3000}, {100, 0.0f, 10.0f}, {700, 0.8, 1.5}});
       histos.add("truephipt", "pT distribution of True MC Phi", kTH1F, {{100, 0, 10, "#it{p}_{T} (GeV/#it{c})"}});
@@ -96,77 +111,100 @@ struct phianalysis {
 
   double massKa = TDatabasePDG::Instance()->GetParticle(kKPlus)->Mass();
 
+  // Kaon candidates of the collision(s) and the quantities used in the pair loop besides the kinematics
+  enum PidBits : uint8_t { kKaonTPC = 1 };
+  ResoDaughters kaons, kaonsMixed;
+  ResoPairEngine pairEngine;
+  struct KaonInfo {
+    float pt, tpcNSigma, tofNSigma;
+    int pdgCode, motherId, motherPDG;
+  };
+  std::vector<KaonInfo> kaonInfo;
+
+  template <bool IsMC, typename TracksType>
+  void fillKaons(const TracksType& dTracks, ResoDaughters& daughters, bool withInfo)
+  {
+    if (withInfo) {
+      kaonInfo.clear();
+    }
+    daughters.fill(
+      dTracks, {static_cast<float>(massKa)},
+      [](auto const& trk) -> uint8_t { return passPtDependentTPCnSigma(trk.pt(), trk.tpcNSigmaKa()) ? kKaonTPC : 0; },
+      [&](auto const& trk) {
+        if (!withInfo) {
+          return;
+        }
+        KaonInfo info{trk.pt(), trk.tpcNSigmaKa(), trk.tofNSigmaKa(), 0, -1, 0};
+        if constexpr (IsMC) {
+          info.pdgCode = trk.pdgCode();
+          info.motherId = trk.motherId();
+          info.motherPDG = trk.motherPDG();
+        }
+        kaonInfo.push_back(info);
+      });
+  }
+
   template <bool IsMC, typename CollisionType, typename TracksType>
   void fillHistograms(const CollisionType& collision, const TracksType& dTracks)
   {
-    TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
-    for (auto& [trk1, trk2] : combinations(CombinationsUpperIndexPolicy(dTracks, dTracks))) {
-      // Un-like sign pair only
-      if (trk1.sign() * trk2.sign() > 0)
-        continue;
-
-      // pT-dependent TPC PID cut
-      if ((trk1.pt() < 0.3) && (std::abs(trk1.tpcNSigmaKa()) > 6.0))
-        continue;
-      if ((trk1.pt() >= 0.3) && (trk1.pt() < 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 4.0))
-        continue;
-      if ((trk1.pt() >= 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 2.0))
-        continue;
-
-      if ((trk2.pt() < 0.3) && (std::abs(trk2.tpcNSigmaKa()) > 6.0))
-        continue;
-      if ((trk2.pt() >= 0.3) && (trk2.pt() < 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 4.0))
-        continue;
-      if ((trk2.pt() >= 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 2.0))
-        continue;
-
-      if (trk1.sign() > 0) {
-        //  --- PID QA Kaons +
-        histos.fill(HIST("TOF_Nsigma1"), trk1.pt(), trk1.tofNSigmaKa());
-        histos.fill(HIST("TPC_Nsigma1"), trk1.pt(), trk1.tpcNSigmaKa());
-        histos.fill(HIST("TOF_TPC_Map1"), trk1.tofNSigmaKa(), trk1.tpcNSigmaKa());
-        //  --- PID QA Kaons -
-        histos.fill(HIST("TOF_Nsigma2"), trk2.pt(), trk2.tofNSigmaKa());
-        histos.fill(HIST("TPC_Nsigma2"), trk2.pt(), trk2.tpcNSigmaKa());
-        histos.fill(HIST("TOF_TPC_Map2"), trk2.tofNSigmaKa(), trk2.tpcNSigmaKa());
-      } else {
-        //  --- PID QA Kaons +
-        histos.fill(HIST("TOF_Nsigma1"), trk2.pt(), trk2.tofNSigmaKa());
-        histos.fill(HIST("TPC_Nsigma1"), trk2.pt(), trk2.tpcNSigmaKa());
-        histos.fill(HIST("TOF_TPC_Map1"), trk2.tofNSigmaKa(), trk2.tpcNSigmaKa());
-        //  --- PID QA Kaons -
-        histos.fill(HIST("TOF_Nsigma2"), trk1.pt(), trk1.tofNSigmaKa());
-        histos.fill(HIST("TPC_Nsigma2"), trk1.pt(), trk1.tpcNSigmaKa());
-        histos.fill(HIST("TOF_TPC_Map2"), trk1.tofNSigmaKa(), trk1.tpcNSigmaKa());
-      }
-
-      histos.fill(HIST("trk1pT"), trk1.pt());
-      histos.fill(HIST("trk2pT"), trk2.pt());
-
-      lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massKa);
-      lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-      lResonance = lDecayDaughter1 + lDecayDaughter2;
-
-      if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-        continue;
-
-      histos.fill(HIST("phiinvmass"), lResonance.M());
-      histos.fill(HIST("h3phiinvmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+    fillKaons<IsMC>(dTracks, kaons, true);
+    auto fillSignal = [&](int i1, int i2, float mass, float pt, float y) {
+      const auto& pos = kaons.mSign[i1] > 0 ? kaonInfo[i1] : kaonInfo[i2];
+      const auto& neg = kaons.mSign[i1] > 0 ? kaonInfo[i2] : kaonInfo[i1];
+      //  --- PID QA Kaons +
+      histos.fill(HIST("TOF_Nsigma1"), pos.pt, pos.tofNSigma);
+      histos.fill(HIST("TPC_Nsigma1"), pos.pt, pos.tpcNSigma);
+      histos.fill(HIST("TOF_TPC_Map1"), pos.tofNSigma, pos.tpcNSigma);
+      //  --- PID QA Kaons -
+      histos.fill(HIST("TOF_Nsigma2"), neg.pt, neg.tofNSigma);
+      histos.fill(HIST("TPC_Nsigma2"), neg.pt, neg.tpcNSigma);
+      histos.fill(HIST("TOF_TPC_Map2"), neg.tofNSigma, neg.tpcNSigma);
+
+      histos.fill(HIST("trk1pT"), kaonInfo[i1].pt);
+      histos.fill(HIST("trk2pT"), kaonInfo[i2].pt);
+
+      if (y > 0.5 || y < -0.5)
+        return;
+
+      histos.fill(HIST("phiinvmass"), mass);
+      histos.fill(HIST("h3phiinvmass"), collision.multV0M(), pt, mass);
 
       if constexpr (IsMC) {
-        if (abs(trk1.pdgCode()) != kKPlus || abs(trk2.pdgCode()) != kKPlus) // check if the tracks are kaons
-          continue;
-        auto mother1 = trk1.motherId();
-        auto mother2 = trk2.motherId();
-        if (mother1 == mother2) {        // Same mother
-          if (trk1.motherPDG() == 333) { // Phi
-            histos.fill(HIST("reconphiinvmass"), lResonance.M());
-            histos.fill(HIST("reconphipt"), lResonance.Pt());
-            histos.fill(HIST("h3recophiinvmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+        const auto& trk1 = kaonInfo[i1];
+        const auto& trk2 = kaonInfo[i2];
+        if (abs(trk1.pdgCode) != kKPlus || abs(trk2.pdgCode) != kKPlus) // check if the tracks are kaons
+          return;
+        if (trk1.motherId == trk2.motherId) { // Same mother
+          if (trk1.motherPDG == 333) {        // Phi
+            histos.fill(HIST("reconphiinvmass"), mass);
+            histos.fill(HIST("reconphipt"), pt);
+            histos.fill(HIST("h3recophiinvmass"), collision.multV0M(), pt, mass);
           }
         }
       }
+    };
+
+    if (!cfgSinglePassBkg) {
+      // Un-like sign pairs of kaons passing the pT-dependent TPC PID cut
+      pairEngine.loop(kaons, 0, kKaonTPC, kaons, 0, kKaonTPC, PairSign::kUnlike, PairOrder::kUpper, fillSignal);
+      return;
     }
+    // Un-like sign, like sign and rotated pairs from the same pass over the kaons
+    pairEngine.loopWithBackgrounds(kaons, 0, kKaonTPC, kaons, 0, kKaonTPC, PairOrder::kUpper, true, [&](PairKind kind, int, int i1, int i2, float mass, float pt, float y) {
+      if (kind == PairKind::kUnlikeSign) {
+        fillSignal(i1, i2, mass, pt, y);
+        return;
+      }
+      if (y > 0.5 || y < -0.5)
+        return;
+      if (kind == PairKind::kLikeSign) {
+        histos.fill(HIST("phiinvmassLS"), mass);
+        histos.fill(HIST("h3phiinvmassLS"), collision.multV0M(), pt, mass);
+      } else {
+        histos.fill(HIST("phiinvmassRot"), mass);
+        histos.fill(HIST("h3phiinvmassRot"), collision.multV0M(), pt, mass);
+      }
+    });
   }
 
   void processData(aod::ResoCollisions& collisions,
@@ -223,7 +261,6 @@ struct phianalysis {
     BinningTypeVetZTPCtemp colBinning{{CfgVtxBins, CfgMultBins}, true};
     SameKindPair<aod::ResoCollisions, aod::ResoTracks, BinningTypeVetZTPCtemp> pairs{colBinning, 10, -1, collisions, tracksTuple}; // -1 is the number of the bin to skip
 
-    TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
     for (auto& [collision1, tracks1, collision2, tracks2] : pairs) {
       Partition<aod::ResoTracks> selectedTracks1 = requireTOFPIDKaonCutInFilter() && (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
       selectedTracks1.bindTable(tracks1);
@@ -231,34 +268,16 @@ struct phianalysis {
       Partition<aod::ResoTracks> selectedTracks2 = requireTOFPIDKaonCutInFilter() && (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
       selectedTracks2.bindTable(tracks2);
 
-      for (auto& [trk1, trk2] : combinations(CombinationsFullIndexPolicy(selectedTracks1, selectedTracks2))) {
-        // Un-like sign pair only
-        if (trk1.sign() * trk2.sign() > 0)
-          continue;
-        if ((trk1.pt() < 0.3) && (std::abs(trk1.tpcNSigmaKa()) > 6.0))
-          continue;
-        if ((trk1.pt() >= 0.3) && (trk1.pt() < 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 4.0))
-          continue;
-        if ((trk1.pt() >= 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 2.0))
-          continue;
+      fillKaons<false>(selectedTracks1, kaons, false);
+      fillKaons<false>(selectedTracks2, kaonsMixed, false);
+      // Un-like sign pairs of kaons passing the pT-dependent TPC PID cut
+      pairEngine.loop(kaons, 0, kKaonTPC, kaonsMixed, 0, kKaonTPC, PairSign::kUnlike, PairOrder::kAll, [&](int, int, float mass, float pt, float y) {
+        if (y > 0.5 || y < -0.5)
+          return;
 
-        if ((trk2.pt() < 0.3) && (std::abs(trk2.tpcNSigmaKa()) > 6.0))
-          continue;
-        if ((trk2.pt() >= 0.3) && (trk2.pt() < 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 4.0))
-          continue;
-        if ((trk2.pt() >= 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 2.0))
-          continue;
-
-        lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massKa);
-        lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-        lResonance = lDecayDaughter1 + lDecayDaughter2;
-
-        if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-          continue;
-
-        histos.fill(HIST("phiinvmassME"), lResonance.M());
-        histos.fill(HIST("h3phiinvmassME"), collision1.multV0M(), lResonance.Pt(), lResonance.M());
-      }
+        histos.fill(HIST("phiinvmassME"), mass);
+        histos.fill(HIST("h3phiinvmassME"), collision1.multV0M(), pt, mass);
+      });
     }
   };
   PROCESS_SWITCH(phianalysis, processME, "Process EventMixing", false);
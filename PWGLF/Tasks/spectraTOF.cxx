@@ -17,6 +17,11 @@
 ///        Depending on the configuration it can also run on tiny tables.
 ///
 
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+
 // O2 includes
 #include "ReconstructionDataFormats/Track.h"
 #include "Framework/runDataProcessing.h"
@@ -31,6 +36,7 @@
 #include "Framework/StaticFor.h"
 #include "Common/Core/TrackSelectionDefaults.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
+#include "PWGLF/DataModel/LFMcGenPrimaries.h"
 #include "spectraTOF.h"
 
 #include "TPDGCode.h"
@@ -54,10 +60,40 @@ struct tofSpectra {
   ConfigurableAxis binsMultiplicity{"binsMultiplicity", {100, 0, 100}, "Multiplicity"};
   ConfigurableAxis binsMultPercentile{"binsMultPercentile", {100, 0, 100}, "Multiplicity percentile"};
   Configurable<int> multiplicityEstimator{"multiplicityEstimator", 0, "Flag to use a multiplicity estimator: 0 no multiplicity, 1 MultFV0M, 2 MultFT0M, 3 MultFDDM, 4 MultTracklets, 5 MultTPC, 6 MultNTracksPV, 7 MultNTracksPVeta1"};
+  Configurable<int> cfgNThreads{"cfgNThreads", 4, "Number of threads sharing the track loop of the processThreaded functions"};
 
   // Histograms
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
+  // Per-species histograms, resolved once at init instead of looking them up by name for every track
+  // The PID histograms are TH2 without multiplicity estimator and TH3 with it
+  struct SpeciesHistograms {
+    TH1* nsigmatpc = nullptr;
+    TH1* nsigmatof = nullptr;
+    TH1* deltatpc = nullptr;
+    TH1* deltatof = nullptr;
+    TH1* nsigmatpctof = nullptr;
+    TH1* dcaxy = nullptr;
+    TH1* dcaz = nullptr;
+    TH1* dcaxyphi = nullptr;
+  };
+  using SpeciesHistogramSet = std::array<SpeciesHistograms, NpCharge>;
+  SpeciesHistogramSet hSpecies;
+  std::vector<SpeciesHistogramSet> hSpeciesThreads; // copies filled by the additional threads, merged into hSpecies at the end of each dataframe
+  std::vector<std::unique_ptr<TH1>> ownedThreadHistograms;
+
+  static TH1* asTH1(HistPtr histogram)
+  {
+    return std::visit([](auto&& ptr) -> TH1* {
+      if constexpr (std::is_base_of_v<TH1, typename std::decay_t<decltype(ptr)>::element_type>) {
+        return ptr.get();
+      } else {
+        return nullptr;
+      }
+    },
+                      histogram);
+  }
+
   void init(o2::framework::InitContext&)
   {
     // Standard process functions
@@ -201,6 +237,33 @@ struct tofSpectra {
     if (doprocessFullAl == true && doprocessTinyAl == true) {
       LOGF(fatal, "Cannot enable processFullAl and processTinyAl at the same time. Please choose one.");
     }
+    if (doprocessThreadedEl == true && (doprocessFullEl == true || doprocessLfFullEl == true || doprocessTinyEl == true || doprocessLfTinyEl == true)) {
+      LOGF(fatal, "Cannot enable processThreadedEl together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedMu == true && (doprocessFullMu == true || doprocessLfFullMu == true || doprocessTinyMu == true || doprocessLfTinyMu == true)) {
+      LOGF(fatal, "Cannot enable processThreadedMu together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedPi == true && (doprocessFullPi == true || doprocessLfFullPi == true || doprocessTinyPi == true || doprocessLfTinyPi == true)) {
+      LOGF(fatal, "Cannot enable processThreadedPi together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedKa == true && (doprocessFullKa == true || doprocessLfFullKa == true || doprocessTinyKa == true || doprocessLfTinyKa == true)) {
+      LOGF(fatal, "Cannot enable processThreadedKa together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedPr == true && (doprocessFullPr == true || doprocessLfFullPr == true || doprocessTinyPr == true || doprocessLfTinyPr == true)) {
+      LOGF(fatal, "Cannot enable processThreadedPr together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedDe == true && (doprocessFullDe == true || doprocessLfFullDe == true || doprocessTinyDe == true || doprocessLfTinyDe == true)) {
+      LOGF(fatal, "Cannot enable processThreadedDe together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedTr == true && (doprocessFullTr == true || doprocessLfFullTr == true || doprocessTinyTr == true || doprocessLfTinyTr == true)) {
+      LOGF(fatal, "Cannot enable processThreadedTr together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedHe == true && (doprocessFullHe == true || doprocessLfFullHe == true || doprocessTinyHe == true || doprocessLfTinyHe == true)) {
+      LOGF(fatal, "Cannot enable processThreadedHe together with another process function of the same hypothesis. Please choose one.");
+    }
+    if (doprocessThreadedAl == true && (doprocessFullAl == true || doprocessLfFullAl == true || doprocessTinyAl == true || doprocessLfTinyAl == true)) {
+      LOGF(fatal, "Cannot enable processThreadedAl together with another process function of the same hypothesis. Please choose one.");
+    }
 
     const AxisSpec vtxZAxis{100, -20, 20, "Vtx_{z} (cm)"};
     const AxisSpec pAxis{binsPt, "#it{p} (GeV/#it{c})"};
@@ -265,55 +328,55 @@ struct tofSpectra {
       switch (i) {
         case 0:
         case Np:
-          if (doprocessFullEl == false && doprocessLfFullEl == false && doprocessTinyEl == false && doprocessLfTinyEl == false) {
+          if (doprocessFullEl == false && doprocessLfFullEl == false && doprocessTinyEl == false && doprocessLfTinyEl == false && doprocessThreadedEl == false) {
             continue;
           }
           break;
         case 1:
         case Np + 1:
-          if (doprocessFullMu == false && doprocessLfFullMu == false && doprocessTinyMu == false && doprocessLfTinyMu == false) {
+          if (doprocessFullMu == false && doprocessLfFullMu == false && doprocessTinyMu == false && doprocessLfTinyMu == false && doprocessThreadedMu == false) {
             continue;
           }
           break;
         case 2:
         case Np + 2:
-          if (doprocessFullPi == false && doprocessLfFullPi == false && doprocessTinyPi == false && doprocessLfTinyPi == false) {
+          if (doprocessFullPi == false && doprocessLfFullPi == false && doprocessTinyPi == false && doprocessLfTinyPi == false && doprocessThreadedPi == false) {
             continue;
           }
           break;
         case 3:
         case Np + 3:
-          if (doprocessFullKa == false && doprocessLfFullKa == false && doprocessTinyKa == false && doprocessLfTinyKa == false) {
+          if (doprocessFullKa == false && doprocessLfFullKa == false && doprocessTinyKa == false && doprocessLfTinyKa == false && doprocessThreadedKa == false) {
             continue;
           }
           break;
         case 4:
         case Np + 4:
-          if (doprocessFullPr == false && doprocessLfFullPr == false && doprocessTinyPr == false && doprocessLfTinyPr == false) {
+          if (doprocessFullPr == false && doprocessLfFullPr == false && doprocessTinyPr == false && doprocessLfTinyPr == false && doprocessThreadedPr == false) {
             continue;
           }
           break;
         case 5:
         case Np + 5:
-          if (doprocessFullDe == false && doprocessLfFullDe == false && doprocessTinyDe == false && doprocessLfTinyDe == false) {
+          if (doprocessFullDe == false && doprocessLfFullDe == false && doprocessTinyDe == false && doprocessLfTinyDe == false && doprocessThreadedDe == false) {
             continue;
           }
           break;
         case 6:
         case Np + 6:
-          if (doprocessFullTr == false && doprocessLfFullTr == false && doprocessTinyTr == false && doprocessLfTinyTr == false) {
+          if (doprocessFullTr == false && doprocessLfFullTr == false && doprocessTinyTr == false && doprocessLfTinyTr == false && doprocessThreadedTr == false) {
             continue;
           }
           break;
         case 7:
         case Np + 7:
-          if (doprocessFullHe == false && doprocessLfFullHe == false && doprocessTinyHe == false && doprocessLfTinyHe == false) {
+          if (doprocessFullHe == false && doprocessLfFullHe == false && doprocessTinyHe == false && doprocessLfTinyHe == false && doprocessThreadedHe == false) {
             continue;
           }
           break;
         case 8:
         case Np + 8:
-          if (doprocessFullAl == false && doprocessLfFullAl == false && doprocessTinyAl == false && doprocessLfTinyAl == false) {
+          if (doprocessFullAl == false && doprocessLfFullAl == false && doprocessTinyAl == false && doprocessLfTinyAl == false && doprocessThreadedAl == false) {
             continue;
           }
           break;
@@ -324,63 +387,63 @@ struct tofSpectra {
       const AxisSpec deltaTPCAxis{binsdeltaTPC, Form("#Delta^{TPC}(%s)", pTCharge[i])};
       const AxisSpec deltaTOFAxis{binsdeltaTOF, Form("#Delta^{TOF}(%s)", pTCharge[i])};
 
-      histos.add(hnsigmatpctof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, nsigmaTOFAxis});
+      hSpecies[i].nsigmatpctof = asTH1(histos.add(hnsigmatpctof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, nsigmaTOFAxis}));
 
       switch (multiplicityEstimator) {
         case 0:
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH2F, {ptAxis, nsigmaTOFAxis});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH2F, {ptAxis, nsigmaTPCAxis});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH2F, {ptAxis, deltaTOFAxis});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH2F, {ptAxis, deltaTPCAxis});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH2F, {ptAxis, nsigmaTOFAxis}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH2F, {ptAxis, nsigmaTPCAxis}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH2F, {ptAxis, deltaTOFAxis}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH2F, {ptAxis, deltaTPCAxis}));
           break;
         case 1: // MultFV0M
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultPercentile, "MultFV0M"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultPercentile, "MultFV0M"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultPercentile, "MultFV0M"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultPercentile, "MultFV0M"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultPercentile, "MultFV0M"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultPercentile, "MultFV0M"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultPercentile, "MultFV0M"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultPercentile, "MultFV0M"}}));
           break;
         case 2: // MultFT0M
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultPercentile, "MultFT0M"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultPercentile, "MultFT0M"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultPercentile, "MultFT0M"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultPercentile, "MultFT0M"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultPercentile, "MultFT0M"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultPercentile, "MultFT0M"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultPercentile, "MultFT0M"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultPercentile, "MultFT0M"}}));
           break;
         case 3: // MultFDDM
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultPercentile, "MultFDDM"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultPercentile, "MultFDDM"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultPercentile, "MultFDDM"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultPercentile, "MultFDDM"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultPercentile, "MultFDDM"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultPercentile, "MultFDDM"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultPercentile, "MultFDDM"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultPercentile, "MultFDDM"}}));
           break;
         case 4: // MultTracklets
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultTracklets"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultTracklets"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultTracklets"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultTracklets"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultTracklets"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultTracklets"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultTracklets"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultTracklets"}}));
           break;
         case 5: // MultTPC
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultTPC"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultTPC"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultTPC"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultTPC"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultTPC"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultTPC"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultTPC"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultTPC"}}));
           break;
         case 6: // MultNTracksPV
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultNTracksPV"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultNTracksPV"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultNTracksPV"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultNTracksPV"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultNTracksPV"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultNTracksPV"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultNTracksPV"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultNTracksPV"}}));
           break;
         case 7: // MultNTracksPVeta1
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultNTracksPVeta1"}});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultNTracksPVeta1"}});
-          histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultNTracksPVeta1"}});
-          histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultNTracksPVeta1"}});
+          hSpecies[i].nsigmatof = asTH1(histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTOFAxis, {binsMultiplicity, "MultNTracksPVeta1"}}));
+          hSpecies[i].nsigmatpc = asTH1(histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, nsigmaTPCAxis, {binsMultiplicity, "MultNTracksPVeta1"}}));
+          hSpecies[i].deltatof = asTH1(histos.add(hdeltatof[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTOFAxis, {binsMultiplicity, "MultNTracksPVeta1"}}));
+          hSpecies[i].deltatpc = asTH1(histos.add(hdeltatpc[i].data(), pTCharge[i], kTH3F, {ptAxis, deltaTPCAxis, {binsMultiplicity, "MultNTracksPVeta1"}}));
           break;
         default:
           LOG(fatal) << "Unrecognized option for multiplicity " << multiplicityEstimator;
       }
-      histos.add(hdcaxy[i].data(), pTCharge[i], kTH2F, {ptAxis, dcaXyAxis});
-      histos.add(hdcaz[i].data(), pTCharge[i], kTH2F, {ptAxis, dcaZAxis});
-      histos.add(hdcaxyphi[i].data(), Form("%s -- 0.9 < #it{p}_{T} < 1.1 GeV/#it{c}", pTCharge[i]), kTH2F, {phiAxis, dcaXyAxis});
+      hSpecies[i].dcaxy = asTH1(histos.add(hdcaxy[i].data(), pTCharge[i], kTH2F, {ptAxis, dcaXyAxis}));
+      hSpecies[i].dcaz = asTH1(histos.add(hdcaz[i].data(), pTCharge[i], kTH2F, {ptAxis, dcaZAxis}));
+      hSpecies[i].dcaxyphi = asTH1(histos.add(hdcaxyphi[i].data(), Form("%s -- 0.9 < #it{p}_{T} < 1.1 GeV/#it{c}", pTCharge[i]), kTH2F, {phiAxis, dcaXyAxis}));
 
       if (doprocessMC) {
         histos.add(hpt_num_prm[i].data(), pTCharge[i], kTH1F, {ptAxis});
@@ -401,136 +464,75 @@ struct tofSpectra {
     }
   }
 
-  template <bool fillFullInfo, PID::ID id, typename T, typename C>
-  void fillParticleHistos(const T& track, const C& collision)
+  template <typename C>
+  float getMultiplicity(const C& collision)
   {
-    if (abs(track.rapidity(PID::getMass(id))) > cfgCutY) {
-      return;
-    }
-    const auto& nsigmaTOF = o2::aod::pidutils::tofNSigma<id>(track);
-    const auto& nsigmaTPC = o2::aod::pidutils::tpcNSigma<id>(track);
-    // const auto id = track.sign() > 0 ? id : id + Np;
-    float multiplicity = 0.f;
-
     switch (multiplicityEstimator) {
       case 1: // MultFV0M
-        // multiplicity = collision.multFV0M();
-        // multiplicity = collision.multZeqFV0A() + collision.multZeqFV0C();
-        multiplicity = collision.multZeqFV0A();
-        break;
+        // return collision.multFV0M();
+        // return collision.multZeqFV0A() + collision.multZeqFV0C();
+        return collision.multZeqFV0A();
       case 2: // MultFT0M
-        // multiplicity = collision.multFT0M();
-        multiplicity = collision.multZeqFT0A() + collision.multZeqFT0C();
-        break;
+        // return collision.multFT0M();
+        return collision.multZeqFT0A() + collision.multZeqFT0C();
       case 3: // MultFDDM
-        // multiplicity = collision.multFDDM();
-        multiplicity = collision.multZeqFDDA() + collision.multZeqFDDC();
-        break;
+        // return collision.multFDDM();
+        return collision.multZeqFDDA() + collision.multZeqFDDC();
       case 4: // MultTracklets
-        multiplicity = collision.multTracklets();
-        break;
+        return collision.multTracklets();
       case 5: // MultTPC
-        multiplicity = collision.multTPC();
-        break;
+        return collision.multTPC();
       case 6: // MultNTracksPV
-        // multiplicity = collision.multNTracksPV();
-        multiplicity = collision.multZeqNTracksPV();
-        break;
+        // return collision.multNTracksPV();
+        return collision.multZeqNTracksPV();
       case 7: // MultNTracksPVeta1
-        multiplicity = collision.multNTracksPVeta1();
-        break;
+        return collision.multNTracksPVeta1();
     }
+    return 0.f;
+  }
 
+  void fillPID(TH1* h, float pt, float value, float multiplicity)
+  {
     if (multiplicityEstimator == 0) {
-      if (track.sign() > 0) {
-        histos.fill(HIST(hnsigmatpc[id]), track.pt(), nsigmaTPC);
-      } else {
-        histos.fill(HIST(hnsigmatpc[id + Np]), track.pt(), nsigmaTPC);
-      }
+      static_cast<TH2*>(h)->Fill(pt, value);
     } else {
-      if (track.sign() > 0) {
-        histos.fill(HIST(hnsigmatpc[id]), track.pt(), nsigmaTPC, multiplicity);
-      } else {
-        histos.fill(HIST(hnsigmatpc[id + Np]), track.pt(), nsigmaTPC, multiplicity);
-      }
+      static_cast<TH3*>(h)->Fill(pt, value, multiplicity);
+    }
+  }
+
+  template <bool fillFullInfo, PID::ID id, typename T>
+  void fillParticleHistos(const T& track, float multiplicity, SpeciesHistogramSet& hSet)
+  {
+    if (abs(track.rapidity(PID::getMass(id))) > cfgCutY) {
+      return;
     }
+    const auto& nsigmaTOF = o2::aod::pidutils::tofNSigma<id>(track);
+    const auto& nsigmaTPC = o2::aod::pidutils::tpcNSigma<id>(track);
+    const SpeciesHistograms& h = hSet[track.sign() > 0 ? id : id + Np];
 
+    fillPID(h.nsigmatpc, track.pt(), nsigmaTPC, multiplicity);
     if constexpr (fillFullInfo) {
       const auto& deltaTPC = o2::aod::pidutils::tpcExpSignalDiff<id>(track);
-      if (multiplicityEstimator == 0) {
-        if (track.sign() > 0) {
-          histos.fill(HIST(hdeltatpc[id]), track.pt(), deltaTPC);
-        } else {
-          histos.fill(HIST(hdeltatpc[id + Np]), track.pt(), deltaTPC);
-        }
-      } else {
-        if (track.sign() > 0) {
-          histos.fill(HIST(hdeltatpc[id]), track.pt(), deltaTPC, multiplicity);
-        } else {
-          histos.fill(HIST(hdeltatpc[id + Np]), track.pt(), deltaTPC, multiplicity);
-        }
-      }
+      fillPID(h.deltatpc, track.pt(), deltaTPC, multiplicity);
     }
 
     if (!track.hasTOF()) {
       return;
     }
 
-    if (multiplicityEstimator == 0) {
-      if (track.sign() > 0) {
-        histos.fill(HIST(hnsigmatof[id]), track.pt(), nsigmaTOF);
-      } else {
-        histos.fill(HIST(hnsigmatof[id + Np]), track.pt(), nsigmaTOF);
-      }
-    } else {
-      if (track.sign() > 0) {
-        histos.fill(HIST(hnsigmatof[id]), track.pt(), nsigmaTOF, multiplicity);
-      } else {
-        histos.fill(HIST(hnsigmatof[id + Np]), track.pt(), nsigmaTOF, multiplicity);
-      }
-    }
-
-    if (track.sign() > 0) {
-      histos.fill(HIST(hnsigmatpctof[id]), track.pt(), nsigmaTPC, nsigmaTOF);
-    } else {
-      histos.fill(HIST(hnsigmatpctof[id + Np]), track.pt(), nsigmaTPC, nsigmaTOF);
-    }
-
+    fillPID(h.nsigmatof, track.pt(), nsigmaTOF, multiplicity);
+    static_cast<TH3*>(h.nsigmatpctof)->Fill(track.pt(), nsigmaTPC, nsigmaTOF);
     if constexpr (fillFullInfo) {
       const auto& deltaTOF = o2::aod::pidutils::tofExpSignalDiff<id>(track);
-      if (multiplicityEstimator == 0) {
-        if (track.sign() > 0) {
-          histos.fill(HIST(hdeltatof[id]), track.pt(), deltaTOF);
-        } else {
-          histos.fill(HIST(hdeltatof[id + Np]), track.pt(), deltaTOF);
-        }
-      } else {
-        if (track.sign() > 0) {
-          histos.fill(HIST(hdeltatof[id]), track.pt(), deltaTOF, multiplicity);
-        } else {
-          histos.fill(HIST(hdeltatof[id + Np]), track.pt(), deltaTOF, multiplicity);
-        }
-      }
+      fillPID(h.deltatof, track.pt(), deltaTOF, multiplicity);
     }
 
     // Filling DCA info with the TPC+TOF PID
     if (std::sqrt(nsigmaTOF * nsigmaTOF + nsigmaTPC * nsigmaTPC) < 2.f) {
-      if (track.sign() > 0) {
-        histos.fill(HIST(hdcaxy[id]), track.pt(), track.dcaXY());
-      } else {
-        histos.fill(HIST(hdcaxy[id + Np]), track.pt(), track.dcaXY());
-      }
-      if (track.sign() > 0) {
-        histos.fill(HIST(hdcaz[id]), track.pt(), track.dcaZ());
-      } else {
-        histos.fill(HIST(hdcaz[id + Np]), track.pt(), track.dcaZ());
-      }
+      static_cast<TH2*>(h.dcaxy)->Fill(track.pt(), track.dcaXY());
+      static_cast<TH2*>(h.dcaz)->Fill(track.pt(), track.dcaZ());
       if (track.pt() < 1.1 && track.pt() > 0.9) {
-        if (track.sign() > 0) {
-          histos.fill(HIST(hdcaxyphi[id]), track.phi(), track.dcaXY());
-        } else {
-          histos.fill(HIST(hdcaxyphi[id + Np]), track.phi(), track.dcaXY());
-        }
+        static_cast<TH2*>(h.dcaxyphi)->Fill(track.phi(), track.dcaXY());
       }
     }
     if (!track.isGlobalTrack()) {
@@ -675,11 +677,12 @@ struct tofSpectra {
     if (!isEventSelected<false, false>(collision)) {                                           \
       return;                                                                                  \
     }                                                                                          \
+    const float multiplicity = getMultiplicity(collision);                                     \
     for (const auto& track : tracks) {                                                         \
       if (!isTrackSelected<false>(track)) {                                                    \
         continue;                                                                              \
       }                                                                                        \
-      fillParticleHistos<isFull, PID::particleId>(track, collision);                           \
+      fillParticleHistos<isFull, PID::particleId>(track, multiplicity, hSpecies);              \
     }                                                                                          \
   }                                                                                            \
   PROCESS_SWITCH(tofSpectra, process##processorName##inputPid, Form("Process for the %s hypothesis from %s tables", #particleId, #processorName), false);
@@ -740,67 +743,181 @@ struct tofSpectra {
   makeProcessFunctionTiny(Al, Alpha);
 #undef makeProcessFunctionTiny
 
-  template <std::size_t i, typename T1, typename T2>
-  void fillHistograms_MC(T1 const& tracks, T2 const& mcParticles)
+  /// Track loop of a whole dataframe split over cfgNThreads threads
+  /// The event selection and the multiplicity are evaluated once per collision beforehand. The additional threads fill
+  /// their own copies of the histograms of the species, which are added to the registry ones at the end of the dataframe
+  template <bool fillFullInfo, PID::ID id, typename C, typename T>
+  void fillParticleHistosThreaded(C const& collisions, T const& tracks)
   {
+    std::vector<float> multiplicities(collisions.size(), 0.f);
+    std::vector<char> selected(collisions.size(), 0);
+    for (const auto& collision : collisions) {
+      if (isEventSelected<false, false>(collision)) {
+        selected[collision.globalIndex()] = 1;
+        multiplicities[collision.globalIndex()] = getMultiplicity(collision);
+      }
+    }
+
+    const int nThreads = std::max(1, std::min<int>(cfgNThreads, tracks.size()));
+    if (static_cast<int>(hSpeciesThreads.size()) < nThreads - 1) {
+      hSpeciesThreads.resize(nThreads - 1);
+    }
+    for (int thread = 0; thread < nThreads - 1; ++thread) {
+      for (const int i : {static_cast<int>(id), id + Np}) {
+        auto copy = [&](TH1* source, TH1*& target) {
+          if (source != nullptr && target == nullptr) {
+            target = static_cast<TH1*>(source->Clone());
+            target->SetDirectory(nullptr);
+            target->Reset();
+            ownedThreadHistograms.emplace_back(target);
+          }
+        };
+        const auto& h = hSpecies[i];
+        auto& hThread = hSpeciesThreads[thread][i];
+        copy(h.nsigmatpc, hThread.nsigmatpc);
+        copy(h.nsigmatof, hThread.nsigmatof);
+        copy(h.deltatpc, hThread.deltatpc);
+        copy(h.deltatof, hThread.deltatof);
+        copy(h.nsigmatpctof, hThread.nsigmatpctof);
+        copy(h.dcaxy, hThread.dcaxy);
+        copy(h.dcaz, hThread.dcaz);
+        copy(h.dcaxyphi, hThread.dcaxyphi);
+      }
+    }
+
+    const int nTracks = tracks.size();
+    auto work = [&](int thread) {
+      SpeciesHistogramSet& hSet = thread == 0 ? hSpecies : hSpeciesThreads[thread - 1];
+      const int first = int64_t(nTracks) * thread / nThreads;
+      const int last = int64_t(nTracks) * (thread + 1) / nThreads;
+      auto track = tracks.begin() + first;
+      for (int iTrack = first; iTrack < last; ++iTrack, ++track) {
+        if (!track.has_collision() || !selected[track.collisionId()]) {
+          continue;
+        }
+        if (!isTrackSelected<false>(track)) {
+          continue;
+        }
+        fillParticleHistos<fillFullInfo, id>(track, multiplicities[track.collisionId()], hSet);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int thread = 1; thread < nThreads; ++thread) {
+      threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (int thread = 0; thread < nThreads - 1; ++thread) {
+      for (const int i : {static_cast<int>(id), id + Np}) {
+        auto merge = [](TH1* target, TH1* source) {
+          if (source != nullptr) {
+            target->Add(source);
+            source->Reset();
+          }
+        };
+        const auto& h = hSpecies[i];
+        auto& hThread = hSpeciesThreads[thread][i];
+        merge(h.nsigmatpc, hThread.nsigmatpc);
+        merge(h.nsigmatof, hThread.nsigmatof);
+        merge(h.deltatpc, hThread.deltatpc);
+        merge(h.deltatof, hThread.deltatof);
+        merge(h.nsigmatpctof, hThread.nsigmatpctof);
+        merge(h.dcaxy, hThread.dcaxy);
+        merge(h.dcaz, hThread.dcaz);
+        merge(h.dcaxyphi, hThread.dcaxyphi);
+      }
+    }
+  }
 
+// Full tables, whole dataframe with the track loop split over threads
+#define makeProcessFunctionThreaded(inputPid, particleId)                                                                                                \
+  void processThreaded##inputPid(CollisionCandidate const& collisions,                                                                                   \
+                                 soa::Join<TrackCandidates, aod::pidTOFFull##inputPid, aod::pidTPCFull##inputPid> const& tracks)                        \
+  {                                                                                                                                                      \
+    fillParticleHistosThreaded<true, PID::particleId>(collisions, tracks);                                                                               \
+  }                                                                                                                                                      \
+  PROCESS_SWITCH(tofSpectra, processThreaded##inputPid, Form("Process for the %s hypothesis from Full tables, with the track loop on threads", #particleId), false);
+
+  makeProcessFunctionThreaded(El, Electron);
+  makeProcessFunctionThreaded(Mu, Muon);
+  makeProcessFunctionThreaded(Pi, Pion);
+  makeProcessFunctionThreaded(Ka, Kaon);
+  makeProcessFunctionThreaded(Pr, Proton);
+  makeProcessFunctionThreaded(De, Deuteron);
+  makeProcessFunctionThreaded(Tr, Triton);
+  makeProcessFunctionThreaded(He, Helium3);
+  makeProcessFunctionThreaded(Al, Alpha);
+#undef makeProcessFunctionThreaded
+
+  /// \return whether the species of the MC histograms i is processed by one of the data process functions
+  template <std::size_t i>
+  bool isSpeciesEnabledMC()
+  {
     switch (i) {
       case 0:
       case Np:
         if (doprocessFullEl == false && doprocessTinyEl == false) {
-          return;
+          return false;
         }
         break;
       case 1:
       case Np + 1:
         if (doprocessFullMu == false && doprocessTinyMu == false) {
-          return;
+          return false;
         }
         break;
       case 2:
       case Np + 2:
         if (doprocessFullPi == false && doprocessTinyPi == false) {
-          return;
+          return false;
         }
         break;
       case 3:
       case Np + 3:
         if (doprocessFullKa == false && doprocessTinyKa == false) {
-          return;
+          return false;
         }
         break;
       case 4:
       case Np + 4:
         if (doprocessFullPr == false && doprocessTinyPr == false) {
-          return;
+          return false;
         }
         break;
       case 5:
       case Np + 5:
         if (doprocessFullDe == false && doprocessTinyDe == false) {
-          return;
+          return false;
         }
         break;
       case 6:
       case Np + 6:
         if (doprocessFullTr == false && doprocessTinyTr == false) {
-          return;
+          return false;
         }
         break;
       case 7:
       case Np + 7:
         if (doprocessFullHe == false && doprocessTinyHe == false) {
-          return;
+          return false;
         }
         break;
       case 8:
       case Np + 8:
         if (doprocessFullAl == false && doprocessTinyAl == false) {
-          return;
+          return false;
         }
         break;
     }
+    return true;
+  }
 
+  template <std::size_t i, typename T1>
+  void fillTrackHistograms_MC(T1 const& tracks)
+  {
     for (auto& track : tracks) {
       if (!track.isGlobalTrackWoDCA()) {
         continue;
@@ -854,6 +971,15 @@ struct tofSpectra {
         }
       }
     }
+  }
+
+  template <std::size_t i, typename T1, typename T2>
+  void fillHistograms_MC(T1 const& tracks, T2 const& mcParticles)
+  {
+    if (!isSpeciesEnabledMC<i>()) {
+      return;
+    }
+    fillTrackHistograms_MC<i>(tracks);
 
     for (auto& particle : mcParticles) {
       if (std::abs(particle.eta()) > cfgCutEta) {
@@ -894,6 +1020,39 @@ struct tofSpectra {
   }
   PROCESS_SWITCH(tofSpectra, processMC, "Process MC", false);
 
+  // Same as processMC, with the generated primaries of lf-mc-gen-primaries read once for all the species
+  void processMCGenPrimaries(soa::Join<aod::Tracks, aod::TracksExtra,
+                                       aod::TracksDCA, aod::McTrackLabels,
+                                       aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr,
+                                       aod::TrackSelection> const& tracks,
+                             const aod::McParticles&,
+                             const aod::LfMcGenPrimaries& genPrimaries)
+  {
+    std::array<bool, 18> enabled;
+    static_for<0, 17>([&](auto i) {
+      enabled[i] = isSpeciesEnabledMC<i>();
+      if (enabled[i]) {
+        fillTrackHistograms_MC<i>(tracks);
+      }
+    });
+
+    for (const auto& particle : genPrimaries) {
+      if (std::abs(particle.eta()) > cfgCutEta) {
+        continue;
+      }
+      if (std::abs(particle.y()) > cfgCutY) {
+        continue;
+      }
+      const int pdgCode = particle.pdgCode();
+      static_for<0, 17>([&](auto i) {
+        if (enabled[i] && pdgCode == PDGs[i]) {
+          histos.fill(HIST(hpt_den_prm[i]), particle.pt());
+        }
+      });
+    }
+  }
+  PROCESS_SWITCH(tofSpectra, processMCGenPrimaries, "Process MC, with the generated primaries of lf-mc-gen-primaries", false);
+
 }; // end of spectra task
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -0,0 +1,136 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file cascadeSelectionKernel.h
+/// \brief Evaluation of several sets of cascade topological selections in one pass
+///
+/// The topological variables of the cascade candidates (including the ones depending on the primary vertex, like
+/// the cosines of pointing angle) are computed once and stored in columns. Each cut set is then evaluated over the
+/// columns in a branch-free loop and sets its bit in the selection mask of the candidates, so that the systematic
+/// variations do not iterate over the cascade table once per set.
+
+#ifndef PWGLF_UTILS_CASCADESELECTIONKERNEL_H_
+#define PWGLF_UTILS_CASCADESELECTIONKERNEL_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace o2::analysis::strangeness
+{
+
+/// Variables of a cascade cut set, same meaning as the cascadesetting_ and v0setting_ configurables
+enum CascadeCutVariable {
+  kV0CosPA = 0,   ///< minimum V0 cosine of pointing angle
+  kDCAV0Dau,      ///< maximum DCA between the V0 daughters
+  kDCAPosToPV,    ///< minimum |DCA| of the positive track to the PV
+  kDCANegToPV,    ///< minimum |DCA| of the negative track to the PV
+  kV0Radius,      ///< minimum V0 radius
+  kCascCosPA,     ///< minimum cascade cosine of pointing angle
+  kDCACascDau,    ///< maximum DCA between the cascade daughters
+  kDCABachToPV,   ///< minimum |DCA| of the bachelor to the PV
+  kCascRadius,    ///< minimum cascade radius
+  kV0MassWindow,  ///< maximum distance of the V0 mass to the Lambda mass
+  kMinDCAV0ToPV,  ///< minimum DCA of the V0 to the PV
+  kNCascadeCutVariables
+};
+static const std::vector<std::string> cascadeCutVariableNames{"v0cospa", "dcav0dau", "dcapostopv", "dcanegtopv", "v0radius", "casccospa", "dcacascdau", "dcabachtopv", "cascradius", "v0masswindow", "mindcav0topv"};
+
+using CascadeCutSet = std::array<float, kNCascadeCutVariables>;
+
+constexpr int kMaxCascadeCutSets = 32; ///< one bit of the selection mask per cut set
+
+/// Topological variables of the cascade candidates, one entry per candidate
+struct CascadeTopology {
+  std::vector<float> v0cospa;
+  std::vector<float> dcav0dau;
+  std::vector<float> dcapostopv;
+  std::vector<float> dcanegtopv;
+  std::vector<float> v0radius;
+  std::vector<float> casccospa;
+  std::vector<float> dcacascdau;
+  std::vector<float> dcabachtopv;
+  std::vector<float> cascradius;
+  std::vector<float> v0massdiff;
+  std::vector<float> dcav0topv;
+
+  void clear()
+  {
+    for (auto* column : {&v0cospa, &dcav0dau, &dcapostopv, &dcanegtopv, &v0radius, &casccospa, &dcacascdau, &dcabachtopv, &cascradius, &v0massdiff, &dcav0topv}) {
+      column->clear();
+    }
+  }
+
+  int size() const { return v0cospa.size(); }
+
+  /// Adds a candidate of a CascData(Ext) table
+  template <typename TCascade>
+  void push(TCascade const& casc, float pvx, float pvy, float pvz)
+  {
+    v0cospa.push_back(casc.v0cosPA(pvx, pvy, pvz));
+    dcav0dau.push_back(casc.dcaV0daughters());
+    dcapostopv.push_back(std::abs(casc.dcapostopv()));
+    dcanegtopv.push_back(std::abs(casc.dcanegtopv()));
+    v0radius.push_back(casc.v0radius());
+    casccospa.push_back(casc.casccosPA(pvx, pvy, pvz));
+    dcacascdau.push_back(casc.dcacascdaughters());
+    dcabachtopv.push_back(std::abs(casc.dcabachtopv()));
+    cascradius.push_back(casc.cascradius());
+    v0massdiff.push_back(std::abs(casc.mLambda() - 1.115683f));
+    dcav0topv.push_back(casc.dcav0topv(pvx, pvy, pvz));
+  }
+};
+
+class CascadeSelectionKernel
+{
+ public:
+  /// Sets the cut sets, at most kMaxCascadeCutSets, the bit i of the masks corresponds to the set i
+  void setCutSets(std::vector<CascadeCutSet> const& cutSets)
+  {
+    mCutSets.assign(cutSets.begin(), cutSets.begin() + std::min<size_t>(cutSets.size(), kMaxCascadeCutSets));
+  }
+  int getNCutSets() const { return mCutSets.size(); }
+
+  /// Evaluates all the cut sets on the candidates
+  /// \param masks  selection mask of each candidate, bit i set if the candidate passes the set i
+  void evaluate(CascadeTopology const& topology, std::vector<uint32_t>& masks) const
+  {
+    const int n = topology.size();
+    masks.assign(n, 0u);
+    for (int iSet = 0; iSet < getNCutSets(); ++iSet) {
+      const CascadeCutSet& cuts = mCutSets[iSet];
+      for (int i = 0; i < n; ++i) {
+        const bool pass = (topology.v0cospa[i] > cuts[kV0CosPA]) &
+                          (topology.dcav0dau[i] < cuts[kDCAV0Dau]) &
+                          (topology.dcapostopv[i] > cuts[kDCAPosToPV]) &
+                          (topology.dcanegtopv[i] > cuts[kDCANegToPV]) &
+                          (topology.v0radius[i] > cuts[kV0Radius]) &
+                          (topology.casccospa[i] > cuts[kCascCosPA]) &
+                          (topology.dcacascdau[i] < cuts[kDCACascDau]) &
+                          (topology.dcabachtopv[i] > cuts[kDCABachToPV]) &
+                          (topology.cascradius[i] > cuts[kCascRadius]) &
+                          (topology.v0massdiff[i] < cuts[kV0MassWindow]) &
+                          (topology.dcav0topv[i] > cuts[kMinDCAV0ToPV]);
+        masks[i] |= static_cast<uint32_t>(pass) << iSet;
+      }
+    }
+  }
+
+ private:
+  std::vector<CascadeCutSet> mCutSets;
+};
+
+} // namespace o2::analysis::strangeness
+
+#endif // PWGLF_UTILS_CASCADESELECTIONKERNEL_H_
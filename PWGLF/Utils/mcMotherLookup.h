@@ -0,0 +1,107 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file mcMotherLookup.h
+/// \brief Mother indices, PDG codes and pT of the MC particles of a dataframe, for the strangeness label builders
+///
+/// The label builders look for the common mother of the V0 legs and, for cascades, for the common mother of the V0
+/// and the bachelor. Going through mothers_as<aod::McParticles>() builds the mother iterators again for every candidate;
+/// here the mother indices of all the MC particles are stored once per dataframe in flat arrays, so that the matching
+/// is a few array lookups and integer comparisons. Particles with several mothers are handled as in the nested loops
+/// over the mothers: the last common mother is taken.
+
+#ifndef PWGLF_UTILS_MCMOTHERLOOKUP_H_
+#define PWGLF_UTILS_MCMOTHERLOOKUP_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace o2::analysis
+{
+
+class McMotherLookup
+{
+ public:
+  /// Stores the mothers, PDG code and pT of all the MC particles
+  /// \param particlesMC MC particles of the dataframe, not sliced
+  template <typename TMcParticles>
+  void fill(TMcParticles const& particlesMC)
+  {
+    const auto n = particlesMC.size();
+    mFirstMother.assign(1, 0);
+    mFirstMother.reserve(n + 1);
+    mMothers.clear();
+    mMothers.reserve(n);
+    mPdg.resize(n);
+    mPt.resize(n);
+    for (auto const& particle : particlesMC) {
+      const auto index = particle.globalIndex();
+      mPdg[index] = particle.pdgCode();
+      mPt[index] = particle.pt();
+      if (particle.has_mothers()) {
+        for (const auto mother : particle.mothersIds()) {
+          mMothers.push_back(mother);
+        }
+      }
+      mFirstMother.push_back(mMothers.size());
+    }
+  }
+
+  /// \return global index of the common mother of two particles, -1 if there is none or one of the particles is missing
+  int getCommonMother(int particle0, int particle1) const
+  {
+    if (particle0 < 0 || particle1 < 0) {
+      return -1;
+    }
+    int common = -1;
+    for (auto i0 = mFirstMother[particle0]; i0 < mFirstMother[particle0 + 1]; i0++) {
+      for (auto i1 = mFirstMother[particle1]; i1 < mFirstMother[particle1 + 1]; i1++) {
+        if (mMothers[i0] == mMothers[i1]) {
+          common = mMothers[i0];
+        }
+      }
+    }
+    return common;
+  }
+
+  /// \return global index of the common mother of the common mother of the V0 legs and of the bachelor, -1 if there is none
+  int getCascadeMother(int negative, int positive, int bachelor) const
+  {
+    if (negative < 0 || positive < 0 || bachelor < 0) {
+      return -1;
+    }
+    int common = -1;
+    for (auto iNeg = mFirstMother[negative]; iNeg < mFirstMother[negative + 1]; iNeg++) {
+      for (auto iPos = mFirstMother[positive]; iPos < mFirstMother[positive + 1]; iPos++) {
+        if (mMothers[iNeg] == mMothers[iPos] && mMothers[iNeg] >= 0) {
+          if (const int mother = getCommonMother(mMothers[iNeg], bachelor); mother >= 0) {
+            common = mother;
+          }
+        }
+      }
+    }
+    return common;
+  }
+
+  bool hasMothers(int particle) const { return particle >= 0 && mFirstMother[particle + 1] > mFirstMother[particle]; }
+  int getPdgCode(int particle) const { return mPdg[particle]; }
+  float getPt(int particle) const { return mPt[particle]; }
+
+ private:
+  std::vector<uint32_t> mFirstMother; ///< offset of the mothers of each particle in mMothers, one more entry than particles
+  std::vector<int> mMothers;          ///< global indices of the mothers of all the particles
+  std::vector<int> mPdg;              ///< PDG code of each particle
+  std::vector<float> mPt;             ///< pT of each particle
+};
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_MCMOTHERLOOKUP_H_
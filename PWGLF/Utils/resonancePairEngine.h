@@ -0,0 +1,310 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file resonancePairEngine.h
+/// \brief Pair loop of the track-track resonance analyses over structure of arrays
+///
+/// The daughter candidates of a collision are loaded once into contiguous arrays, with the energy under each
+/// mass hypothesis and a bit mask of the passed PID selections. For each first daughter the invariant mass,
+/// pT and rapidity of the pairs with all the second daughters are computed in a branch-free loop, which the
+/// compiler can vectorise, and the pairs passing the PID, charge and ordering requirements are then handed
+/// to the analysis. The same loop serves the same-event, like-sign and mixed-event combinations.
+/// With loopWithBackgrounds the unlike-sign, like-sign and rotated-background pairs of a collision are
+/// produced together from the same pass over the daughters, instead of a separate loop per background.
+
+#ifndef PWGLF_UTILS_RESONANCEPAIRENGINE_H_
+#define PWGLF_UTILS_RESONANCEPAIRENGINE_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace o2::analysis::resonance
+{
+
+constexpr int kMaxHypotheses = 3; ///< maximum number of mass hypotheses per daughter
+
+/// Daughter candidates of one collision
+class ResoDaughters
+{
+ public:
+  /// Load the tracks of a (sliced) table
+  /// \param tracks  tracks, in table order
+  /// \param masses  mass hypotheses, at most kMaxHypotheses, the energy is stored for each of them
+  /// \param pidBits  functor giving the bit mask of the PID selections passed by a track
+  /// \param onStore  functor called for each stored track, e.g. to keep analysis specific quantities aligned with the arrays
+  template <typename T, typename FPid, typename FStore>
+  void fill(T const& tracks, std::vector<float> const& masses, FPid&& pidBits, FStore&& onStore)
+  {
+    clear();
+    mNHypotheses = std::min(static_cast<int>(masses.size()), kMaxHypotheses);
+    for (auto const& track : tracks) {
+      mIndex.push_back(track.globalIndex());
+      mPx.push_back(track.px());
+      mPy.push_back(track.py());
+      mPz.push_back(track.pz());
+      mSign.push_back(track.sign());
+      mPid.push_back(pidBits(track));
+      onStore(track);
+    }
+    const int n = size();
+    for (int h = 0; h < mNHypotheses; ++h) {
+      const float m2 = masses[h] * masses[h];
+      mE[h].resize(n);
+      for (int i = 0; i < n; ++i) {
+        mE[h][i] = std::sqrt(mPx[i] * mPx[i] + mPy[i] * mPy[i] + mPz[i] * mPz[i] + m2);
+      }
+    }
+  }
+
+  template <typename T, typename FPid>
+  void fill(T const& tracks, std::vector<float> const& masses, FPid&& pidBits)
+  {
+    fill(tracks, masses, pidBits, [](auto const&) {});
+  }
+
+  /// Load the tracks of a table with the energies already stored, e.g. aod::ResoTracksWithHypos
+  /// \param nHypotheses  number of mass hypotheses, at most kMaxHypotheses
+  /// \param energy  functor giving the energy of a track under a hypothesis, called as energy(track, h)
+  /// \param pidBits,onStore  as in fill
+  template <typename T, typename FEnergy, typename FPid, typename FStore>
+  void fillWithEnergies(T const& tracks, int nHypotheses, FEnergy&& energy, FPid&& pidBits, FStore&& onStore)
+  {
+    clear();
+    mNHypotheses = std::min(nHypotheses, kMaxHypotheses);
+    for (int h = 0; h < mNHypotheses; ++h) {
+      mE[h].clear();
+    }
+    for (auto const& track : tracks) {
+      mIndex.push_back(track.globalIndex());
+      mPx.push_back(track.px());
+      mPy.push_back(track.py());
+      mPz.push_back(track.pz());
+      mSign.push_back(track.sign());
+      mPid.push_back(pidBits(track));
+      for (int h = 0; h < mNHypotheses; ++h) {
+        mE[h].push_back(energy(track, h));
+      }
+      onStore(track);
+    }
+  }
+
+  void clear()
+  {
+    mIndex.clear();
+    mPx.clear();
+    mPy.clear();
+    mPz.clear();
+    mSign.clear();
+    mPid.clear();
+  }
+
+  int size() const { return mIndex.size(); }
+
+  std::vector<int64_t> mIndex;                          ///< global index of the track
+  std::vector<float> mPx;                               ///< momentum x
+  std::vector<float> mPy;                               ///< momentum y
+  std::vector<float> mPz;                               ///< momentum z
+  std::vector<int8_t> mSign;                            ///< charge sign
+  std::vector<uint8_t> mPid;                            ///< bits of the passed PID selections
+  std::array<std::vector<float>, kMaxHypotheses> mE{}; ///< energy per mass hypothesis
+  int mNHypotheses = 0;                                 ///< number of filled mass hypotheses
+};
+
+/// pT dependent TPC n sigma selection shared by the resonance analyses: 6 sigma below 0.3 GeV/c, 4 sigma up to 0.4 GeV/c, 2 sigma above
+inline bool passPtDependentTPCnSigma(float pt, float nSigma)
+{
+  const float absNSigma = std::abs(nSigma);
+  if (pt < 0.3f) {
+    return absNSigma <= 6.f;
+  }
+  if (pt < 0.4f) {
+    return absNSigma <= 4.f;
+  }
+  return absNSigma <= 2.f;
+}
+
+/// Charge combination of the pairs
+enum class PairSign {
+  kAny,
+  kUnlike,
+  kLike
+};
+
+/// Ordering of the pairs
+enum class PairOrder {
+  kAll,  ///< all the pairs, e.g. different collisions or different species from the same table
+  kUpper ///< only pairs where the second daughter has a larger global index, like CombinationsStrictlyUpperIndexPolicy
+};
+
+/// Type of the pairs given by ResoPairEngine::loopWithBackgrounds
+enum class PairKind {
+  kUnlikeSign,
+  kLikeSign,
+  kRotated ///< unlike-sign pair with the second daughter rotated in the transverse plane
+};
+
+constexpr int kMaxRotations = 16; ///< maximum number of rotated-background entries per pair
+
+class ResoPairEngine
+{
+ public:
+  /// Sets the rotations of the second daughter for the rotated background
+  /// \param nRotations  number of rotated entries per unlike-sign pair, at most kMaxRotations, 0 disables the rotated background
+  /// \param spread  the rotation angles are equally spaced in [pi - spread/2, pi + spread/2]
+  void setRotations(int nRotations, float spread)
+  {
+    mNRotations = std::clamp(nRotations, 0, kMaxRotations);
+    for (int k = 0; k < mNRotations; ++k) {
+      const float angle = static_cast<float>(M_PI) + spread * ((k + 0.5f) / mNRotations - 0.5f);
+      mCosRotation[k] = std::cos(angle);
+      mSinRotation[k] = std::sin(angle);
+    }
+  }
+  int getNRotations() const { return mNRotations; }
+
+  /// Loop over the pairs of daughters
+  /// \param d1,d2  daughters, can be the same object
+  /// \param h1,h2  mass hypothesis of the daughters, index in the masses given to ResoDaughters::fill
+  /// \param pid1,pid2  required PID bits of the daughters, all of them must be set
+  /// \param function  called as function(i1, i2, mass, pt, rapidity) for the accepted pairs, in the order of the nested loops
+  template <typename F>
+  void loop(ResoDaughters const& d1, int h1, uint8_t pid1, ResoDaughters const& d2, int h2, uint8_t pid2, PairSign sign, PairOrder order, F&& function)
+  {
+    const int n1 = d1.size();
+    const int n2 = d2.size();
+    mMass.resize(n2);
+    mPt.resize(n2);
+    mY.resize(n2);
+    const float* px2 = d2.mPx.data();
+    const float* py2 = d2.mPy.data();
+    const float* pz2 = d2.mPz.data();
+    const float* e2 = d2.mE[h2].data();
+    for (int i = 0; i < n1; ++i) {
+      if ((d1.mPid[i] & pid1) != pid1) {
+        continue;
+      }
+      int jBegin = 0;
+      if (order == PairOrder::kUpper) {
+        jBegin = std::upper_bound(d2.mIndex.begin(), d2.mIndex.end(), d1.mIndex[i]) - d2.mIndex.begin();
+      }
+      const float px1 = d1.mPx[i], py1 = d1.mPy[i], pz1 = d1.mPz[i], e1 = d1.mE[h1][i];
+      // pair kinematics for all the partners, without branches
+      for (int j = jBegin; j < n2; ++j) {
+        const float px = px1 + px2[j];
+        const float py = py1 + py2[j];
+        const float pz = pz1 + pz2[j];
+        const float e = e1 + e2[j];
+        const float pt2 = px * px + py * py;
+        mMass[j] = std::sqrt(std::max(e * e - pt2 - pz * pz, 0.f));
+        mPt[j] = std::sqrt(pt2);
+        mY[j] = 0.5f * std::log((e + pz) / (e - pz));
+      }
+      for (int j = jBegin; j < n2; ++j) {
+        if ((d2.mPid[j] & pid2) != pid2) {
+          continue;
+        }
+        const int signProduct = d1.mSign[i] * d2.mSign[j];
+        if ((sign == PairSign::kUnlike && signProduct > 0) || (sign == PairSign::kLike && signProduct <= 0)) {
+          continue;
+        }
+        function(i, j, mMass[j], mPt[j], mY[j]);
+      }
+    }
+  }
+
+  /// Loop over the pairs of daughters, giving the signal and the background pairs in the same pass
+  /// \param likeSign  whether the like-sign pairs are given
+  /// \param function  called as function(kind, iRotation, i1, i2, mass, pt, rapidity), the rotated entries follow their
+  ///                  unlike-sign pair with iRotation in [0, getNRotations()), the rapidity does not change with the rotation
+  template <typename F>
+  void loopWithBackgrounds(ResoDaughters const& d1, int h1, uint8_t pid1, ResoDaughters const& d2, int h2, uint8_t pid2, PairOrder order, bool likeSign, F&& function)
+  {
+    const int n1 = d1.size();
+    const int n2 = d2.size();
+    mMass.resize(n2);
+    mPt.resize(n2);
+    mY.resize(n2);
+    mMassRotated.resize(mNRotations * n2);
+    mPtRotated.resize(mNRotations * n2);
+    const float* px2 = d2.mPx.data();
+    const float* py2 = d2.mPy.data();
+    const float* pz2 = d2.mPz.data();
+    const float* e2 = d2.mE[h2].data();
+    for (int i = 0; i < n1; ++i) {
+      if ((d1.mPid[i] & pid1) != pid1) {
+        continue;
+      }
+      int jBegin = 0;
+      if (order == PairOrder::kUpper) {
+        jBegin = std::upper_bound(d2.mIndex.begin(), d2.mIndex.end(), d1.mIndex[i]) - d2.mIndex.begin();
+      }
+      const float px1 = d1.mPx[i], py1 = d1.mPy[i], pz1 = d1.mPz[i], e1 = d1.mE[h1][i];
+      // pair kinematics for all the partners, without branches
+      for (int j = jBegin; j < n2; ++j) {
+        const float px = px1 + px2[j];
+        const float py = py1 + py2[j];
+        const float pz = pz1 + pz2[j];
+        const float e = e1 + e2[j];
+        const float pt2 = px * px + py * py;
+        mMass[j] = std::sqrt(std::max(e * e - pt2 - pz * pz, 0.f));
+        mPt[j] = std::sqrt(pt2);
+        mY[j] = 0.5f * std::log((e + pz) / (e - pz));
+      }
+      // the rotation keeps the energy and pz of the second daughter, only the transverse components change
+      for (int k = 0; k < mNRotations; ++k) {
+        const float cosRotation = mCosRotation[k], sinRotation = mSinRotation[k];
+        float* massRotated = mMassRotated.data() + k * n2;
+        float* ptRotated = mPtRotated.data() + k * n2;
+        for (int j = jBegin; j < n2; ++j) {
+          const float px = px1 + px2[j] * cosRotation - py2[j] * sinRotation;
+          const float py = py1 + px2[j] * sinRotation + py2[j] * cosRotation;
+          const float pz = pz1 + pz2[j];
+          const float e = e1 + e2[j];
+          const float pt2 = px * px + py * py;
+          massRotated[j] = std::sqrt(std::max(e * e - pt2 - pz * pz, 0.f));
+          ptRotated[j] = std::sqrt(pt2);
+        }
+      }
+      for (int j = jBegin; j < n2; ++j) {
+        if ((d2.mPid[j] & pid2) != pid2) {
+          continue;
+        }
+        if (d1.mSign[i] * d2.mSign[j] > 0) {
+          if (likeSign) {
+            function(PairKind::kLikeSign, 0, i, j, mMass[j], mPt[j], mY[j]);
+          }
+          continue;
+        }
+        function(PairKind::kUnlikeSign, 0, i, j, mMass[j], mPt[j], mY[j]);
+        for (int k = 0; k < mNRotations; ++k) {
+          function(PairKind::kRotated, k, i, j, mMassRotated[k * n2 + j], mPtRotated[k * n2 + j], mY[j]);
+        }
+      }
+    }
+  }
+
+ private:
+  std::vector<float> mMass;                        ///< invariant mass of the pairs of the current first daughter
+  std::vector<float> mPt;                          ///< pT of the pairs of the current first daughter
+  std::vector<float> mY;                           ///< rapidity of the pairs of the current first daughter
+  std::vector<float> mMassRotated;                 ///< invariant mass of the rotated pairs, per rotation
+  std::vector<float> mPtRotated;                   ///< pT of the rotated pairs, per rotation
+  int mNRotations = 0;                             ///< number of rotated entries per unlike-sign pair
+  std::array<float, kMaxRotations> mCosRotation{}; ///< cosine of the rotation angles
+  std::array<float, kMaxRotations> mSinRotation{}; ///< sine of the rotation angles
+};
+
+} // namespace o2::analysis::resonance
+
+#endif // PWGLF_UTILS_RESONANCEPAIRENGINE_H_
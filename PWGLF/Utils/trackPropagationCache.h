@@ -0,0 +1,125 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file trackPropagationCache.h
+/// \brief Memo of the propagations of the daughter tracks in the strangeness builders
+///
+/// A track rotated to a given alpha and propagated to a given X with material corrections always gives the same result.
+/// In the cascade builder the V0 legs are refitted for every cascade sharing the V0, i.e. the same propagation through
+/// the material LUT is done again for each bachelor. The propagated track and the material budget crossed are stored
+/// the first time, keyed by track index, alpha, target X and material correction type, and served from the memo afterwards.
+
+#ifndef PWGLF_UTILS_TRACKPROPAGATIONCACHE_H_
+#define PWGLF_UTILS_TRACKPROPAGATIONCACHE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "ReconstructionDataFormats/Track.h"
+#include "ReconstructionDataFormats/TrackLTIntegral.h"
+#include "DetectorsBase/Propagator.h"
+
+namespace o2::analysis
+{
+
+class TrackPropagationCache
+{
+ public:
+  /// Result of one propagation
+  struct Entry {
+    o2::track::TrackParCov track;      ///< track after the rotation and the propagation
+    o2::track::TrackLTIntegral matBud; ///< material budget (x/X0, x*rho) crossed in the propagation
+    bool ok = false;                   ///< return value of the propagation
+  };
+
+  /// Sets the propagation settings, the memo is cleared if they changed (e.g. new run)
+  void setPropagation(float bz, float maxSnp, float maxStep)
+  {
+    if (bz != mBz || maxSnp != mMaxSnp || maxStep != mMaxStep) {
+      mBz = bz;
+      mMaxSnp = maxSnp;
+      mMaxStep = maxStep;
+      clear();
+    }
+  }
+
+  /// Drops the stored propagations, to be called when the tracks change (new collision or dataframe)
+  void clear() { mEntries.clear(); }
+
+  /// Rotates the track to alpha and propagates it to x, or takes the result of an identical previous request
+  /// \param index  global index of the track, identifying the starting parameters
+  /// \param track  track parameters of the track with this index, replaced by the propagated ones
+  /// \return return value of the propagation
+  bool propagateToX(int64_t index, o2::track::TrackParCov& track, float alpha, float x, o2::base::Propagator::MatCorrType matCorr)
+  {
+    const Key key{index, bits(alpha), bits(x), static_cast<int>(matCorr)};
+    auto stored = mEntries.find(key);
+    if (stored == mEntries.end()) {
+      Entry entry;
+      entry.track = track;
+      entry.track.rotateParam(alpha);
+      entry.ok = o2::base::Propagator::Instance()->propagateToX(entry.track, x, mBz, mMaxSnp, mMaxStep, matCorr, &entry.matBud);
+      stored = mEntries.emplace(key, entry).first;
+      mNMisses++;
+    } else {
+      mNHits++;
+    }
+    track = stored->second.track;
+    return stored->second.ok;
+  }
+
+  /// \return the material budget of a stored propagation, nullptr if it was not done
+  const o2::track::TrackLTIntegral* getMaterialBudget(int64_t index, float alpha, float x, o2::base::Propagator::MatCorrType matCorr) const
+  {
+    auto stored = mEntries.find(Key{index, bits(alpha), bits(x), static_cast<int>(matCorr)});
+    return stored == mEntries.end() ? nullptr : &stored->second.matBud;
+  }
+
+  uint64_t getNHits() const { return mNHits; }
+  uint64_t getNMisses() const { return mNMisses; }
+
+ private:
+  /// The target X is used at float precision, which is the precision of the track parameters
+  struct Key {
+    int64_t index;
+    uint32_t alpha;
+    uint32_t x;
+    int matCorr;
+    bool operator==(const Key& other) const { return index == other.index && alpha == other.alpha && x == other.x && matCorr == other.matCorr; }
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const
+    {
+      uint64_t hash = static_cast<uint64_t>(key.index) * 0x9E3779B97F4A7C15ULL;
+      hash ^= (static_cast<uint64_t>(key.alpha) << 32 | key.x) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+      return hash ^ static_cast<uint64_t>(key.matCorr);
+    }
+  };
+
+  static uint32_t bits(float value)
+  {
+    uint32_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+  }
+
+  float mBz = 0.f;
+  float mMaxSnp = 0.f;
+  float mMaxStep = 0.f;
+  std::unordered_map<Key, Entry, KeyHash> mEntries; ///< stored propagations
+  uint64_t mNHits = 0;                              ///< requests served from the memo
+  uint64_t mNMisses = 0;                            ///< requests that needed a propagation
+};
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_TRACKPROPAGATIONCACHE_H_
@@ -40,6 +40,8 @@
 #include "ReconstructionDataFormats/Vertex.h"
 
 #include "CCDB/BasicCCDBManager.h"
+#include "CommonConstants/LHCConstants.h"
+#include "DataFormatsParameters/GRPLHCIFData.h"
 #include "DataFormatsParameters/GRPObject.h"
 
 #include "DetectorsBase/Propagator.h"
@@ -64,13 +66,17 @@ DECLARE_SOA_COLUMN(VertexXY, vertexXY, double);
 
 DECLARE_SOA_COLUMN(VertexChi2, vertexChi2, double);
 DECLARE_SOA_COLUMN(NContrib, nContrib, int);
+DECLARE_SOA_COLUMN(LocalBC, localBC, int16_t);
+DECLARE_SOA_COLUMN(BcType, bcType, uint8_t); //! Bit 0 (1): beam A, bit 1 (2): beam C, 3: colliding
 } // namespace full
 DECLARE_SOA_TABLE(EventInfo, "AOD", "EventInfo", full::TimeStamp, full::VertexX,
                   full::VertexY, full::VertexZ,
 
                   full::VertexXX, full::VertexYY, full::VertexXY,
 
-                  full::VertexChi2, full::NContrib);
+                  full::VertexChi2, full::NContrib,
+
+                  full::LocalBC, full::BcType);
 } // namespace o2::aod
 
 using namespace o2::framework;
@@ -80,9 +86,23 @@ struct lumiTask {
   Produces<o2::aod::EventInfo> rowEventInfo;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   const char* ccdbpath_grp = "GLO/GRP/GRP";
+  const char* ccdbpath_grplhcif = "GLO/Config/GRPLHCIF";
   const char* ccdburl = "http://alice-ccdb.cern.ch";
   int mRunNumber;
 
+  // BC type from the filling scheme of the run, indexed by the BC in the orbit
+  enum BcTypes : uint8_t {
+    kBcEmpty = 0,
+    kBcBeamA = 1,
+    kBcBeamC = 2,
+    kBcColliding = kBcBeamA | kBcBeamC,
+    kNBcTypes
+  };
+  std::array<uint8_t, o2::constants::lhc::LHCMaxBunches> mBcPattern{};
+
+  // configured once per run and reused for the refit of all the vertices
+  o2::vertexing::PVertexer vertexer;
+
   Configurable<uint64_t> ftts{"ftts", 1530319778000,
                               "First time of time stamp"};
   Configurable<int> nContribMax{"nContribMax", 2500,
@@ -121,7 +141,12 @@ struct lumiTask {
        {HistType::kTH2F, {{1000, -1, 1, "x"}, {1000, -1, 1, "rx"}}}}, //
       {"vertexy_Refitted_vertexy",
        "",
-       {HistType::kTH2F, {{1000, -1, 1, "y"}, {1000, -1, 1, "ry"}}}} //
+       {HistType::kTH2F, {{1000, -1, 1, "y"}, {1000, -1, 1, "ry"}}}}, //
+
+      {"bctype", "", {HistType::kTH1F, {{kNBcTypes, -0.5, kNBcTypes - 0.5, "BC type"}}}}, //
+      {"localbc_bctype",
+       "",
+       {HistType::kTH2F, {{o2::constants::lhc::LHCMaxBunches, -0.5, o2::constants::lhc::LHCMaxBunches - 0.5, "local BC"}, {kNBcTypes, -0.5, kNBcTypes - 0.5, "BC type"}}}} //
     }};
   bool doPVrefit = true;
 
@@ -131,6 +156,47 @@ struct lumiTask {
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
     mRunNumber = 0;
+    auto h = histos.get<TH1>(HIST("bctype"));
+    h->GetXaxis()->SetBinLabel(kBcEmpty + 1, "empty");
+    h->GetXaxis()->SetBinLabel(kBcBeamA + 1, "beam A");
+    h->GetXaxis()->SetBinLabel(kBcBeamC + 1, "beam C");
+    h->GetXaxis()->SetBinLabel(kBcColliding + 1, "colliding");
+  }
+
+  void initRun(aod::BCsWithTimestamps::iterator const& bc)
+  {
+    auto grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(
+      ccdbpath_grp, bc.timestamp());
+    if (grpo != nullptr) {
+      o2::base::Propagator::initFieldFromGRP(grpo);
+    } else {
+      LOGF(fatal,
+           "GRP object is not available in CCDB for run=%d at timestamp=%llu",
+           bc.runNumber(), bc.timestamp());
+    }
+
+    // the filling scheme is loaded once per run, the BC type is then a lookup in a flat array
+    mBcPattern.fill(kBcEmpty);
+    auto grplhcif = ccdb->getForTimeStamp<o2::parameters::GRPLHCIFData>(
+      ccdbpath_grplhcif, bc.timestamp());
+    if (grplhcif != nullptr) {
+      const auto beamPatternA = grplhcif->getBunchFilling().getBeamPattern(0);
+      const auto beamPatternC = grplhcif->getBunchFilling().getBeamPattern(1);
+      for (int i = 0; i < o2::constants::lhc::LHCMaxBunches; i++) {
+        mBcPattern[i] = (beamPatternA[i] ? kBcBeamA : kBcEmpty) | (beamPatternC[i] ? kBcBeamC : kBcEmpty);
+      }
+    } else {
+      LOGF(warning,
+           "GRPLHCIF object is not available in CCDB for run=%d at timestamp=%llu, all BCs are flagged as empty",
+           bc.runNumber(), bc.timestamp());
+    }
+
+    // configure PVertexer
+    o2::conf::ConfigurableParam::updateFromString(
+      "pvertexer.useMeanVertexConstraint=false"); // we want to refit w/o
+                                                  // MeanVertex constraint
+    vertexer.init();
+    mRunNumber = bc.runNumber();
   }
 
   void process(aod::Collision const& collision, aod::BCsWithTimestamps const&,
@@ -143,6 +209,13 @@ struct lumiTask {
 
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     uint64_t relTS = bc.timestamp() - ftts;
+    if (mRunNumber != bc.runNumber()) {
+      initRun(bc);
+    }
+    const int localBC = bc.globalBC() % o2::constants::lhc::LHCMaxBunches;
+    const uint8_t bcType = mBcPattern[localBC];
+    histos.fill(HIST("bctype"), bcType);
+    histos.fill(HIST("localbc_bctype"), localBC, bcType);
 
     std::vector<int64_t> vec_globID_contr = {};
     std::vector<o2::track::TrackParCov> vec_TrkContributos = {};
@@ -165,34 +238,13 @@ struct lumiTask {
 
     std::vector<bool> vec_useTrk_PVrefit(vec_globID_contr.size(), true);
 
-    if (mRunNumber != bc.runNumber()) {
-      auto grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(
-        ccdbpath_grp, bc.timestamp());
-      if (grpo != nullptr) {
-        o2::base::Propagator::initFieldFromGRP(grpo);
-      } else {
-        LOGF(fatal,
-             "GRP object is not available in CCDB for run=%d at timestamp=%llu",
-             bc.runNumber(), bc.timestamp());
-      }
-      mRunNumber = bc.runNumber();
-    }
-
     o2::dataformats::VertexBase Pvtx;
     Pvtx.setX(collision.posX());
     Pvtx.setY(collision.posY());
     Pvtx.setZ(collision.posZ());
     Pvtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(),
                 collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
 
-    o2::dataformats::VertexBase PVbase_recalculated;
-
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString(
-      "pvertexer.useMeanVertexConstraint=false"); // we want to refit w/o
-                                                  // MeanVertex constraint
-    vertexer.init();
     bool PVrefit_doable = vertexer.prepareVertexRefit(vec_TrkContributos, Pvtx);
     double chi2 = -1.;
     double refitX = -9999.;
@@ -214,7 +266,7 @@ struct lumiTask {
     }
 
     rowEventInfo(relTS, refitX, refitY, refitZ, refitXX, refitYY, refitXY, chi2,
-                 nContrib);
+                 nContrib, localBC, bcType);
 
     //    LOGP(info,"chi2: {}, Ncont: {}, nonctr:
     //    {}",chi2,nContrib,nNonContrib);
@@ -12,7 +12,7 @@
 #include <cmath>
 #include <iostream>
 #include <chrono>
-#include "bestCollisionTable.h"
+#include "Common/DataModel/BestCollisionTables.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/DataModel/Centrality.h"
@@ -30,7 +30,7 @@
 #include "TDatabasePDG.h"
 #include "MathUtils/Utils.h"
 
-#include "bestCollisionTable.h"
+#include "Common/DataModel/BestCollisionTables.h"
 
 using namespace o2;
 using namespace o2::framework;
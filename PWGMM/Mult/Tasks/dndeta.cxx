@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include <cmath>
+#include <vector>
 
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/DataModel/EventSelection.h"
@@ -21,7 +22,7 @@
 #include "Index.h"
 #include "TDatabasePDG.h"
 
-#include "bestCollisionTable.h"
+#include "Common/DataModel/BestCollisionTables.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -51,6 +52,42 @@ static constexpr TrackSelectionFlags::flagtype trackSelectionDCA =
 
 using LabeledTracks = soa::Join<aod::Tracks, aod::McTrackLabels>;
 
+/// Collisions of each BC of the data frame, built in one pass over the collisions:
+/// the collisions of the BC with index i are collisions[offsets[i]] ... collisions[offsets[i + 1] - 1]
+/// The BC of a collision is the found BC if available, the assigned one otherwise
+struct BCCollisionIndex {
+  std::vector<int> offsets;
+  std::vector<int> collisions;
+
+  template <typename C>
+  void build(int nBCs, C const& cols)
+  {
+    std::vector<int> bcOfCollision;
+    bcOfCollision.reserve(cols.size());
+    offsets.assign(nBCs + 1, 0);
+    for (auto& collision : cols) {
+      int bcId = collision.has_foundBC() ? collision.foundBCId() : collision.bcId();
+      bcOfCollision.push_back(bcId);
+      if (bcId >= 0 && bcId < nBCs) {
+        ++offsets[bcId + 1];
+      }
+    }
+    for (int i = 0; i < nBCs; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    collisions.resize(offsets[nBCs]);
+    std::vector<int> position(offsets.begin(), offsets.end() - 1);
+    for (auto i = 0u; i < bcOfCollision.size(); ++i) {
+      int bcId = bcOfCollision[i];
+      if (bcId >= 0 && bcId < nBCs) {
+        collisions[position[bcId]++] = i;
+      }
+    }
+  }
+
+  int size(int bcId) const { return offsets[bcId + 1] - offsets[bcId]; }
+};
+
 struct MultiplicityCounter {
   Service<TDatabasePDG> pdg;
 
@@ -84,6 +121,7 @@ struct MultiplicityCounter {
   };
 
   std::vector<int> usedTracksIds;
+  BCCollisionIndex bcCollisions;
 
   void init(InitContext&)
   {
@@ -150,29 +188,21 @@ struct MultiplicityCounter {
     FullBCs const& bcs,
     soa::Join<aod::Collisions, aod::EvSels> const& collisions)
   {
-    std::vector<typename std::decay_t<decltype(collisions)>::iterator> cols;
+    bcCollisions.build(bcs.size(), collisions);
     for (auto& bc : bcs) {
       if (!useEvSel || (bc.selection()[evsel::kIsBBT0A] &
                         bc.selection()[evsel::kIsBBT0C]) != 0) {
         registry.fill(HIST("Events/Selection"), 5.);
-        cols.clear();
-        for (auto& collision : collisions) {
-          if (collision.has_foundBC()) {
-            if (collision.foundBCId() == bc.globalIndex()) {
-              cols.emplace_back(collision);
-            }
-          } else if (collision.bcId() == bc.globalIndex()) {
-            cols.emplace_back(collision);
-          }
-        }
-        LOGP(debug, "BC {} has {} collisions", bc.globalBC(), cols.size());
-        if (!cols.empty()) {
+        auto nCols = bcCollisions.size(bc.globalIndex());
+        LOGP(debug, "BC {} has {} collisions", bc.globalBC(), nCols);
+        if (nCols > 0) {
           registry.fill(HIST("Events/Selection"), 6.);
-          if (cols.size() > 1) {
+          if (nCols > 1) {
             registry.fill(HIST("Events/Selection"), 7.);
           }
         }
-        for (auto& col : cols) {
+        for (auto i = bcCollisions.offsets[bc.globalIndex()]; i < bcCollisions.offsets[bc.globalIndex() + 1]; ++i) {
+          auto col = collisions.iteratorAt(bcCollisions.collisions[i]);
           registry.fill(HIST("Events/Control/Chi2"), col.chi2());
           registry.fill(HIST("Events/Control/TimeResolution"), col.collisionTimeRes());
         }
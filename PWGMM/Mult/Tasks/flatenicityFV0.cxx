@@ -26,7 +26,9 @@
 #include <TH2F.h>
 #include <TGraph.h>
 #include <TRandom.h>
+#include <array>
 #include <cmath>
+#include <memory>
 #include <vector>
 
 using namespace o2;
@@ -44,6 +46,9 @@ struct flatenictyFV0 {
   Configurable<float> cfgTrkEtaCut{"cfgTrkEtaCut", 1.5f,
                                    "Eta range for tracks"};
   Configurable<float> cfgTrkLowPtCut{"cfgTrkLowPtCut", 0.15f, "Minimum  pT"};
+  // per-channel QA histograms
+  Configurable<bool> fillChannelQA{"fillChannelQA", true, "fill the per-channel amplitude histograms"};
+  Configurable<int> nSamplingChannelQA{"nSamplingChannelQA", 1, "fill the per-channel amplitude histograms once every n events"};
 
   HistogramRegistry flatenicity{
     "flatenicity",
@@ -58,6 +63,17 @@ struct flatenictyFV0 {
   static constexpr std::string_view nhPtEst[17] = {
     "ptVsGlobaltrack", "ptVsFDDAFDDCFT0CFV0MFT", "ptVsFDDAFDDCFV0MFT", "ptVsFV0MFT", "ptVsFV0", "ptVsMFTmult", "ptVs1flatencityFV0", "ptVs1flatencitytrkMFT", "ptVs1flatencitytrkMFTFV0", "ptVs1flatencityMFTFV0", "ptVsMFTmultFT0A", "ptVsFT0", "ptVs1flatencityFT0", "ptVs1flatencityMFTFT0A", "ptVsFV0FT0C", "ptVs1flatencityFV0FT0C", "pTVsPtTrig"};
 
+  // FV0 geometry per channel number, computed once in init
+  static constexpr int nCellsFV0 = 48;
+  std::array<int, nCellsFV0> fv0IndexPhi{};
+  std::array<float, nCellsFV0> fv0Eta{};
+  std::array<float, nCellsFV0> fv0Phi{};
+  std::array<float, nCellsFV0> fv0LatticeWeight{}; // outer ring: two channels per cell
+  // calibration vs vtx, built once in init
+  static constexpr int nDetVtx = 6;
+  std::array<std::unique_ptr<TGraph>, nDetVtx> gVtx;
+  uint64_t nProcessedEvents = 0;
+
   void init(o2::framework::InitContext&)
   {
     int nBinsEst[17] = {100, 500, 500, 800, 5000, 500, 102, 102, 102, 102, 400, 400, 102, 102, 600, 102, 600};
@@ -199,6 +215,66 @@ struct flatenictyFV0 {
     flatenicity.add("hAmpFDCvsVtx", "", HistType::kTH2F,
                     {{30, -15.0, +15.0, "Vtx_z"},
                      {6000, -0.5, 7999.5, "Ampl. FDC"}});
+
+    // FV0 channel geometry
+    const int innerFV0 = 32;
+    const float maxEtaFV0 = 5.1;
+    const float minEtaFV0 = 2.2;
+    const float detaFV0 = (maxEtaFV0 - minEtaFV0) / 5.0;
+    for (int iCh = 0; iCh < nCellsFV0; ++iCh) {
+      const int ringindex = getFV0Ring(iCh);
+      fv0IndexPhi[iCh] = getFV0IndexPhi(iCh);
+      fv0Eta[iCh] = maxEtaFV0 - (detaFV0 / 2.0) * (2.0 * ringindex + 1);
+      if (iCh < innerFV0) {
+        fv0Phi[iCh] = (2.0 * (fv0IndexPhi[iCh] - 8 * ringindex) + 1) * M_PI / (8.0);
+        fv0LatticeWeight[iCh] = 1.f;
+      } else {
+        fv0Phi[iCh] = ((2.0 * fv0IndexPhi[iCh]) + 1 - 64.0) * 2.0 * M_PI / (32.0);
+        fv0LatticeWeight[iCh] = 0.5f;
+      }
+    }
+
+    // calibration factor MFT vs vtx
+    float biningVtxt[30] = {-14.5, -13.5, -12.5, -11.5, -10.5, -9.5, -8.5, -7.5, -6.5, -5.5, -4.5, -3.5, -2.5, -1.5, -0.5, 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, 11.5, 12.5, 13.5, 14.5};
+    float calibMFTvtx[30] = {1.27106, 1.239, 1.23555, 1.21115, 1.18538, 1.16585, 1.15052, 1.11002, 1.09909, 1.07341, 1.05511, 1.04538, 1.02291, 1.01254, 0.994646, 0.981465, 0.962609, 0.955254, 0.942117, 0.932826, 0.925284, 0.906386, 0.904621, 0.887349, 0.884237, 0.860509, 0.853699, 0.836858, 0.819485, 0.802514};
+
+    // calibration factor FV0 vs vtx
+    float calibFV0vtx[30] = {0.907962, 0.934607, 0.938929, 0.950987, 0.950817, 0.966362, 0.968509, 0.972741, 0.982412, 0.984872, 0.994543, 0.996003, 0.99435, 1.00266, 0.998245, 1.00584, 1.01078, 1.01003, 1.00726, 1.00872, 1.01726, 1.02015, 1.0193, 1.01106, 1.02229, 1.02104, 1.03435, 1.00822, 1.01921, 1.01736};
+    // calibration FT0A vs vtx
+    float calibFT0Avtx[30] = {0.924334, 0.950988, 0.959604, 0.965607, 0.970016, 0.979057, 0.978384, 0.982005, 0.992825, 0.990048, 0.998588, 0.997338, 1.00102, 1.00385, 0.99492, 1.01083, 1.00703, 1.00494, 1.00063, 1.0013, 1.00777, 1.01238, 1.01179, 1.00577, 1.01028, 1.017, 1.02975, 1.0085, 1.00856, 1.01662};
+    // calibration FT0C vs vtx
+    float calibFT0Cvtx[30] = {1.02096, 1.01245, 1.02148, 1.03605, 1.03561, 1.03667, 1.04229, 1.0327, 1.03674, 1.02764, 1.01828, 1.02331, 1.01864, 1.015, 1.01197, 1.00615, 0.996845, 0.993051, 0.985635, 0.982883, 0.981914, 0.964635, 0.967812, 0.95475, 0.956687, 0.932816, 0.92773, 0.914892, 0.891724, 0.872382};
+    // calibration FDA vs vtx
+    float calibFDAvtx[30] = {1.05852, 1.07943, 1.03542, 1.02851, 1.00617, 1.01377, 0.997411, 1.00899, 0.98556, 0.994506, 0.999267, 0.997915, 0.993361, 0.988509, 0.993386, 0.992661, 0.997844, 1.00428, 0.991939, 0.995139, 0.999882, 1.00976, 1.01239, 0.989125, 1.01432, 1.00652, 1.02114, 1.00582, 0.996546, 1.05708};
+    // calibration FDC vs vtx
+    float calibFDCvtx[30] = {0.965937, 0.924875, 0.903078, 0.901217, 0.914662, 0.933606, 0.899319, 0.912335, 0.900467, 0.928819, 0.943352, 0.955755, 0.954358, 0.939799, 0.973757, 0.972073, 1.00221, 0.997195, 1.01809, 1.02407, 1.02722, 1.05898, 1.09503, 1.13893, 1.12981, 1.15516, 1.17394, 1.28468, 1.37351, 1.24345};
+
+    const char* nameDet[nDetVtx] = {"AmpV0", "AmpT0A", "AmpT0C", "MFT", "AmpFDA", "AmpFDC"};
+    for (int i_d = 0; i_d < nDetVtx; ++i_d) {
+      gVtx[i_d] = std::make_unique<TGraph>();
+    }
+    for (int i_v = 0; i_v < 30; ++i_v) {
+      gVtx[0]->SetPoint(i_v, biningVtxt[i_v], calibFV0vtx[i_v]);
+    }
+    for (int i_v = 0; i_v < 30; ++i_v) {
+      gVtx[1]->SetPoint(i_v, biningVtxt[i_v], calibFT0Avtx[i_v]);
+    }
+    for (int i_v = 0; i_v < 30; ++i_v) {
+      gVtx[2]->SetPoint(i_v, biningVtxt[i_v], calibFT0Cvtx[i_v]);
+    }
+    for (int i_v = 0; i_v < 30; ++i_v) {
+      gVtx[3]->SetPoint(i_v, biningVtxt[i_v], calibMFTvtx[i_v]);
+    }
+    for (int i_v = 0; i_v < 30; ++i_v) {
+      gVtx[4]->SetPoint(i_v, biningVtxt[i_v], calibFDAvtx[i_v]);
+    }
+    for (int i_v = 0; i_v < 30; ++i_v) {
+      gVtx[5]->SetPoint(i_v, biningVtxt[i_v], calibFDCvtx[i_v]);
+    }
+
+    for (int i_d = 0; i_d < nDetVtx; ++i_d) {
+      gVtx[i_d]->SetName(Form("g%s", nameDet[i_d]));
+    }
   }
   int getT0ASector(int i_ch)
   {
@@ -346,7 +422,8 @@ struct flatenictyFV0 {
     // get sigma
     float sRho_tmp = 0;
     for (int iCell = 0; iCell < entries; ++iCell) {
-      sRho_tmp += TMath::Power(1.0 * signals[iCell] - mRho, 2);
+      const float dRho = signals[iCell] - mRho;
+      sRho_tmp += dRho * dRho;
     }
     sRho_tmp /= (1.0 * entries * entries);
     float sRho = TMath::Sqrt(sRho_tmp);
@@ -386,6 +463,8 @@ struct flatenictyFV0 {
     }
 
     flatenicity.fill(HIST("hEv"), 3);
+    const bool doChannelQA = fillChannelQA && (nSamplingChannelQA <= 1 || nProcessedEvents % nSamplingChannelQA == 0);
+    nProcessedEvents++;
     // these values are from equalized pass 4 signals
     const int nEta1 = 5;                                                                 // FDDC + MFTparc + FT0C + FV0 (rings 1-4) + FDDA
     float weigthsEta1[nEta1] = {0.0824071, 0.464187, 0.0490638, 0.00348809, 0.00360993}; // lhc22m
@@ -428,103 +507,48 @@ struct flatenictyFV0 {
     float calibFDA[8] = {0.933485, 1.00743, 0.768484, 0.837354, 1.26397, 1.2159, 0.876259, 1.00434};
     // calibration FDC
     float calibFDC[8] = {0.772909, 1.95841, 0.966258, 0.913508, 0.96176, 0.650286, 0.619638, 0.694932};
-    // calibration factor MFT vs vtx
-    float biningVtxt[30] = {-14.5, -13.5, -12.5, -11.5, -10.5, -9.5, -8.5, -7.5, -6.5, -5.5, -4.5, -3.5, -2.5, -1.5, -0.5, 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, 11.5, 12.5, 13.5, 14.5};
-    float calibMFTvtx[30] = {1.27106, 1.239, 1.23555, 1.21115, 1.18538, 1.16585, 1.15052, 1.11002, 1.09909, 1.07341, 1.05511, 1.04538, 1.02291, 1.01254, 0.994646, 0.981465, 0.962609, 0.955254, 0.942117, 0.932826, 0.925284, 0.906386, 0.904621, 0.887349, 0.884237, 0.860509, 0.853699, 0.836858, 0.819485, 0.802514};
-
-    // calibration factor FV0 vs vtx
-    float calibFV0vtx[30] = {0.907962, 0.934607, 0.938929, 0.950987, 0.950817, 0.966362, 0.968509, 0.972741, 0.982412, 0.984872, 0.994543, 0.996003, 0.99435, 1.00266, 0.998245, 1.00584, 1.01078, 1.01003, 1.00726, 1.00872, 1.01726, 1.02015, 1.0193, 1.01106, 1.02229, 1.02104, 1.03435, 1.00822, 1.01921, 1.01736};
-    // calibration FT0A vs vtx
-    float calibFT0Avtx[30] = {0.924334, 0.950988, 0.959604, 0.965607, 0.970016, 0.979057, 0.978384, 0.982005, 0.992825, 0.990048, 0.998588, 0.997338, 1.00102, 1.00385, 0.99492, 1.01083, 1.00703, 1.00494, 1.00063, 1.0013, 1.00777, 1.01238, 1.01179, 1.00577, 1.01028, 1.017, 1.02975, 1.0085, 1.00856, 1.01662};
-    // calibration FT0C vs vtx
-    float calibFT0Cvtx[30] = {1.02096, 1.01245, 1.02148, 1.03605, 1.03561, 1.03667, 1.04229, 1.0327, 1.03674, 1.02764, 1.01828, 1.02331, 1.01864, 1.015, 1.01197, 1.00615, 0.996845, 0.993051, 0.985635, 0.982883, 0.981914, 0.964635, 0.967812, 0.95475, 0.956687, 0.932816, 0.92773, 0.914892, 0.891724, 0.872382};
-    // calibration FDA vs vtx
-    float calibFDAvtx[30] = {1.05852, 1.07943, 1.03542, 1.02851, 1.00617, 1.01377, 0.997411, 1.00899, 0.98556, 0.994506, 0.999267, 0.997915, 0.993361, 0.988509, 0.993386, 0.992661, 0.997844, 1.00428, 0.991939, 0.995139, 0.999882, 1.00976, 1.01239, 0.989125, 1.01432, 1.00652, 1.02114, 1.00582, 0.996546, 1.05708};
-    // calibration FDC vs vtx
-    float calibFDCvtx[30] = {0.965937, 0.924875, 0.903078, 0.901217, 0.914662, 0.933606, 0.899319, 0.912335, 0.900467, 0.928819, 0.943352, 0.955755, 0.954358, 0.939799, 0.973757, 0.972073, 1.00221, 0.997195, 1.01809, 1.02407, 1.02722, 1.05898, 1.09503, 1.13893, 1.12981, 1.15516, 1.17394, 1.28468, 1.37351, 1.24345};
-
-    const int nDetVtx = 6;
-    TGraph* gVtx[nDetVtx];
-    const char* nameDet[nDetVtx] = {"AmpV0", "AmpT0A", "AmpT0C", "MFT", "AmpFDA", "AmpFDC"};
-    for (int i_d = 0; i_d < nDetVtx; ++i_d) {
-      gVtx[i_d] = 0;
-      gVtx[i_d] = new TGraph();
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[0]->SetPoint(i_v, biningVtxt[i_v], calibFV0vtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[1]->SetPoint(i_v, biningVtxt[i_v], calibFT0Avtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[2]->SetPoint(i_v, biningVtxt[i_v], calibFT0Cvtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[3]->SetPoint(i_v, biningVtxt[i_v], calibMFTvtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[4]->SetPoint(i_v, biningVtxt[i_v], calibFDAvtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[5]->SetPoint(i_v, biningVtxt[i_v], calibFDCvtx[i_v]);
-    }
-
-    for (int i_d = 0; i_d < nDetVtx; ++i_d) {
-      gVtx[i_d]->SetName(Form("g%s", nameDet[i_d]));
-    }
 
     float sumAmpFV0 = 0;
     float sumAmpFV01to4Ch = 0;
-    int innerFV0 = 32;
-    float maxEtaFV0 = 5.1;
-    float minEtaFV0 = 2.2;
-    float detaFV0 = (maxEtaFV0 - minEtaFV0) / 5.0;
 
-    const int nCells = 48; // 48 sectors in FV0
-    float amp_channel[nCells];
-    for (int iCell = 0; iCell < nCells; ++iCell) {
-      amp_channel[iCell] = 0.0;
-    }
-    float amp_channelBefore[nCells];
-    for (int iCell = 0; iCell < nCells; ++iCell) {
-      amp_channelBefore[iCell] = 0.0;
-    }
+    const int nCells = nCellsFV0; // 48 sectors in FV0
+    float amp_channel[nCells] = {0};
+    float amp_channelBefore[nCells] = {0};
 
     if (collision.has_foundFV0()) {
 
-      float RhoLattice[nCells];
-      for (Int_t iCh = 0; iCh < nCells; iCh++) {
-        RhoLattice[iCh] = 0;
-      }
+      float RhoLattice[nCells] = {0};
       auto fv0 = collision.foundFV0();
-      for (std::size_t ich = 0; ich < fv0.amplitude().size(); ich++) {
-        float phiv0 = -999.0;
-        float etav0 = -999.0;
-        int channelv0 = fv0.channel()[ich];
-        float ampl_ch = fv0.amplitude()[ich];
-        int ringindex = getFV0Ring(channelv0);
-        int channelv0phi = getFV0IndexPhi(channelv0);
-        etav0 = maxEtaFV0 - (detaFV0 / 2.0) * (2.0 * ringindex + 1);
-        if (channelv0 < innerFV0) {
-          phiv0 = (2.0 * (channelv0phi - 8 * ringindex) + 1) * M_PI / (8.0);
-        } else {
-          phiv0 = ((2.0 * channelv0phi) + 1 - 64.0) * 2.0 * M_PI / (32.0);
-        }
-        amp_channelBefore[channelv0phi] = ampl_ch;
-        if (applyCalibCh) {
-          ampl_ch *= calib[channelv0phi];
+      const auto& channels = fv0.channel();
+      const auto& amplitudes = fv0.amplitude();
+      for (std::size_t ich = 0; ich < amplitudes.size(); ich++) {
+        int channelv0 = channels[ich];
+        if (channelv0 < 0 || channelv0 >= nCellsFV0) {
+          continue;
         }
+        int channelv0phi = fv0IndexPhi[channelv0];
+        amp_channelBefore[channelv0phi] = amplitudes[ich];
+        RhoLattice[channelv0phi] = amplitudes[ich] * fv0LatticeWeight[channelv0];
+      }
+      // channel sums and calibration on the fixed-size cell arrays
+      for (int iCell = 0; iCell < nCells; ++iCell) {
+        const float ampl_ch = applyCalibCh ? amp_channelBefore[iCell] * calib[iCell] : amp_channelBefore[iCell];
+        amp_channel[iCell] = ampl_ch;
         sumAmpFV0 += ampl_ch;
-
-        if (channelv0 >= 8) { // exclude the 1st ch, eta 2.2,4.52
+        if (iCell >= 8) { // exclude the 1st ch, eta 2.2,4.52
           sumAmpFV01to4Ch += ampl_ch;
         }
-        flatenicity.fill(HIST("fEtaPhiFv0"), phiv0, etav0, ampl_ch);
-        amp_channel[channelv0phi] = ampl_ch;
-        if (channelv0 < innerFV0) {
-          RhoLattice[channelv0phi] = ampl_ch;
-        } else {
-          RhoLattice[channelv0phi] = ampl_ch / 2.0; // two channels per bin
+        if (applyCalibCh) {
+          RhoLattice[iCell] *= calib[iCell];
+        }
+      }
+      if (doChannelQA) {
+        for (std::size_t ich = 0; ich < amplitudes.size(); ich++) {
+          int channelv0 = channels[ich];
+          if (channelv0 < 0 || channelv0 >= nCellsFV0) {
+            continue;
+          }
+          flatenicity.fill(HIST("fEtaPhiFv0"), fv0Phi[channelv0], fv0Eta[channelv0], amp_channel[fv0IndexPhi[channelv0]]);
         }
       }
       flatenicity_fv0 = GetFlatenicity(RhoLattice, nCells);
@@ -655,14 +679,20 @@ struct flatenictyFV0 {
         int sector = getT0ASector(channel);
         if (sector >= 0 && sector < 24) {
           RhoLatticeT0A[sector] += amplitude;
-          flatenicity.fill(HIST("hAmpT0AVsChBeforeCalibration"), sector, amplitude);
+          if (doChannelQA) {
+            flatenicity.fill(HIST("hAmpT0AVsChBeforeCalibration"), sector, amplitude);
+          }
           if (applyCalibCh) {
             amplitude *= calibT0A[sector];
           }
-          flatenicity.fill(HIST("hAmpT0AVsCh"), sector, amplitude);
+          if (doChannelQA) {
+            flatenicity.fill(HIST("hAmpT0AVsCh"), sector, amplitude);
+          }
         }
         sumAmpFT0A += amplitude;
-        flatenicity.fill(HIST("hFT0A"), amplitude);
+        if (doChannelQA) {
+          flatenicity.fill(HIST("hFT0A"), amplitude);
+        }
       }
 
       for (std::size_t i_c = 0; i_c < ft0.amplitudeC().size(); i_c++) {
@@ -672,13 +702,19 @@ struct flatenictyFV0 {
         int sector = getT0CSector(channel);
         if (sector >= 0 && sector < 28) {
           RhoLatticeT0C[sector] += amplitude;
-          flatenicity.fill(HIST("hAmpT0CVsChBeforeCalibration"), sector, amplitude);
+          if (doChannelQA) {
+            flatenicity.fill(HIST("hAmpT0CVsChBeforeCalibration"), sector, amplitude);
+          }
           if (applyCalibCh) {
             amplitude *= calibT0C[sector];
           }
-          flatenicity.fill(HIST("hAmpT0CVsCh"), sector, amplitude);
+          if (doChannelQA) {
+            flatenicity.fill(HIST("hAmpT0CVsCh"), sector, amplitude);
+          }
+        }
+        if (doChannelQA) {
+          flatenicity.fill(HIST("hFT0C"), amplitude);
         }
-        flatenicity.fill(HIST("hFT0C"), amplitude);
       }
       flatenicity.fill(HIST("hAmpT0AvsVtxBeforeCalibration"), vtxZ, sumAmpFT0A);
       flatenicity.fill(HIST("hAmpT0CvsVtxBeforeCalibration"), vtxZ, sumAmpFT0C);
@@ -704,20 +740,28 @@ struct flatenictyFV0 {
       for (std::size_t ich = 0; ich < 8; ich++) {
         float amplitude = fdd.chargeA()[ich];
         sumAmpFDDA += amplitude;
-        flatenicity.fill(HIST("hAmpFDAVsChBeforeCalibration"), ich, amplitude);
+        if (doChannelQA) {
+          flatenicity.fill(HIST("hAmpFDAVsChBeforeCalibration"), ich, amplitude);
+        }
         if (applyCalibCh) {
           amplitude *= calibFDA[ich];
         }
-        flatenicity.fill(HIST("hAmpFDAVsCh"), ich, amplitude);
+        if (doChannelQA) {
+          flatenicity.fill(HIST("hAmpFDAVsCh"), ich, amplitude);
+        }
       }
       for (std::size_t ich = 0; ich < 8; ich++) {
         float amplitude = fdd.chargeC()[ich];
         sumAmpFDDC += amplitude;
-        flatenicity.fill(HIST("hAmpFDCVsChBeforeCalibration"), ich, amplitude);
+        if (doChannelQA) {
+          flatenicity.fill(HIST("hAmpFDCVsChBeforeCalibration"), ich, amplitude);
+        }
         if (applyCalibCh) {
           amplitude *= calibFDC[ich];
         }
-        flatenicity.fill(HIST("hAmpFDCVsCh"), ich, amplitude);
+        if (doChannelQA) {
+          flatenicity.fill(HIST("hAmpFDCVsCh"), ich, amplitude);
+        }
       }
       flatenicity.fill(HIST("hAmpFDAvsVtxBeforeCalibration"), vtxZ, sumAmpFDDA);
       flatenicity.fill(HIST("hAmpFDCvsVtxBeforeCalibration"), vtxZ, sumAmpFDDC);
@@ -931,10 +975,12 @@ struct flatenictyFV0 {
         });
       }
 
-      for (int iCh = 0; iCh < 48; ++iCh) {
-        flatenicity.fill(HIST("hAmpV0VsCh"), iCh, amp_channel[iCh]);
-        flatenicity.fill(HIST("hAmpV0VsChBeforeCalibration"), iCh,
-                         amp_channelBefore[iCh]);
+      if (doChannelQA) {
+        for (int iCh = 0; iCh < 48; ++iCh) {
+          flatenicity.fill(HIST("hAmpV0VsCh"), iCh, amp_channel[iCh]);
+          flatenicity.fill(HIST("hAmpV0VsChBeforeCalibration"), iCh,
+                           amp_channelBefore[iCh]);
+        }
       }
       flatenicity.fill(HIST("fMultFv0"), sumAmpFV0);
       flatenicity.fill(HIST("hFlatFT0CvsFlatFT0A"), flatenicity_t0c, flatenicity_t0a);
@@ -15,11 +15,17 @@
 //
 // \brief This code loops over every ambiguous MFT tracks and associates
 // them to a collision that has the smallest DCAxy
+// The DCAs to the collisions of the BCs of the track are computed with the
+// linear propagation of o2::analysis::fwd, in one batch per track
 
+#include <algorithm>
 #include <cmath>
+#include <utility>
+#include <vector>
 #include "ReconstructionDataFormats/TrackFwd.h"
 #include "Math/MatrixFunctions.h"
 #include "Math/SMatrix.h"
+#include "Common/Core/fwdTrackUtilities.h"
 #include "MathUtils/Utils.h"
 #include "Framework/Configurable.h"
 #include "Framework/AnalysisTask.h"
@@ -52,9 +58,15 @@ struct vertexingfwd {
   /// into different std::vector to easily handle them later outside the loops
   std::vector<int> vecCollForAmb;        // vector for collisions associated to an ambiguous track
   std::vector<double> vecDCACollForAmb;  // vector for dca collision associated to an ambiguous track
-  std::vector<double> vecAmbTrack;       // vector for ambiguous track quantities like chi2 and z
   std::vector<double> vecZposCollForAmb; // vector for z vertex of collisions associated to an ambiguous track
 
+  // collisions of the dataframe and compatible collisions of an ambiguous track, for the batched linear propagation
+  std::vector<std::pair<uint64_t, int64_t>> collisionBCs; // most probable BC and row of the collisions, sorted by BC
+  std::vector<float> collisionX, collisionY, collisionZ;
+  std::vector<int64_t> candidateRows;
+  std::vector<float> candidateX, candidateY, candidateZ;
+  std::vector<float> candidateDCAX, candidateDCAY, candidateDCAXY;
+
   Configurable<float> maxDCAXY{"maxDCAXY", 6.0, "max allowed transverse DCA"}; // To be used when associating ambitrack to collision using best DCA
 
   HistogramRegistry registry{
@@ -114,10 +126,22 @@ struct vertexingfwd {
     registry.fill(HIST("AmbiguousTracksStatus"), 0.0, ntracks);
     registry.fill(HIST("AmbiguousTracksStatus"), 1.0, nambitracks);
 
+    // most probable BC and position of the collisions, read once per dataframe
+    collisionBCs.clear();
+    collisionX.clear();
+    collisionY.clear();
+    collisionZ.clear();
+    for (auto& collision : collisions) {
+      collisionBCs.emplace_back(collision.bc().globalBC(), collisionX.size());
+      collisionX.push_back(collision.posX());
+      collisionY.push_back(collision.posY());
+      collisionZ.push_back(collision.posZ());
+    }
+    std::stable_sort(collisionBCs.begin(), collisionBCs.end(), [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+
     for (auto& ambitrack : ambitracks) {
       vecCollForAmb.clear();
       vecDCACollForAmb.clear();
-      vecAmbTrack.clear();
       vecZposCollForAmb.clear();
 
       double value = 0.0;    // matching value for collision association to an ambiguous track
@@ -141,72 +165,65 @@ struct vertexingfwd {
         registry.fill(HIST("AmbiguousTracksStatus"), 4.0);
       }
 
-      // Fill the std::vector for ambiguous tracks with the quantities needed
-      vecAmbTrack.push_back(track.x());
-      vecAmbTrack.push_back(track.y());
-      vecAmbTrack.push_back(track.phi());
-      vecAmbTrack.push_back(track.tgl());
-      vecAmbTrack.push_back(track.signed1Pt());
-      vecAmbTrack.push_back(track.z());
-      vecAmbTrack.push_back(track.chi2());
-
-      auto bcambis = ambitrack.bc();
-
-      int collCounter = 0;
-      for (auto& collision : collisions) {
-        uint64_t mostProbableBC = collision.bc().globalBC();
-        //uint64_t meanBC = mostProbableBC - std::lround(collision.collisionTime() / (o2::constants::lhc::LHCBunchSpacingNS / 1000));
-        //int deltaBC = std::ceil(collision.collisionTimeRes() / (o2::constants::lhc::LHCBunchSpacingNS / 1000) * 4);
-
-        for (auto& bcambi : bcambis) {
-
-          if (bcambi.globalBC() != mostProbableBC) {
-            continue;
-          }
-          //here the bc of the ambitrack is the bc of the collision we are looking at
-          collCounter++;
-
-          // We compute the DCAxy of this track wrt the primary vertex of the current collision
-          SMatrix5 tpars(vecAmbTrack[0], vecAmbTrack[1], vecAmbTrack[2], vecAmbTrack[3], vecAmbTrack[4]);
-          //            std::vector<double> v1{extAmbiTrack.cXX(), extAmbiTrack.cXY(), extAmbiTrack.cYY(), extAmbiTrack.cPhiX(), extAmbiTrack.cPhiY(),
-          //                                   extAmbiTrack.cPhiPhi(), extAmbiTrack.cTglX(), extAmbiTrack.cTglY(), extAmbiTrack.cTglPhi(), extAmbiTrack.cTglTgl(),
-          //                                   extAmbiTrack.c1PtX(), extAmbiTrack.c1PtY(), extAmbiTrack.c1PtPhi(), extAmbiTrack.c1PtTgl(), extAmbiTrack.c1Pt21Pt2()};
-
-          std::vector<double> v1; // Temporary null vector for the computation of the covariance matrix
-          SMatrix55 tcovs(v1.begin(), v1.end());
-          o2::track::TrackParCovFwd pars1{vecAmbTrack[5], tpars, tcovs, vecAmbTrack[6]};
+      // straight line of the track, propagated linearly to the z of each compatible collision
+      const auto line = o2::analysis::fwd::LinearFwdTrack::fromTrack(track);
 
-          // o2::track::TrackParCovFwd pars1{extAmbiTrack.z(), tpars, tcovs, chi2};
-          pars1.propagateToZlinear(collision.posZ()); // track parameters propagation to the position of the z vertex
-
-          const auto dcaX(pars1.getX() - collision.posX());
-          const auto dcaY(pars1.getY() - collision.posY());
-          auto dcaXY = std::sqrt(dcaX * dcaX + dcaY * dcaY);
-
-          registry.fill(HIST("TracksDCAXY"), dcaXY);
-          registry.fill(HIST("TracksDCAX"), dcaX);
-          registry.fill(HIST("TracksDCAY"), dcaY);
-          registry.fill(HIST("NumberOfContributors"), collision.numContrib());
-
-          if (dcaXY > maxDCAXY) {
-            continue;
-          }
+      // collisions whose most probable BC is one of the BCs of the ambiguous track, in the order of the collision table
+      candidateRows.clear();
+      for (auto& bcambi : ambitrack.bc()) {
+        auto range = std::equal_range(collisionBCs.begin(), collisionBCs.end(), std::make_pair(bcambi.globalBC(), int64_t(-1)),
+                                      [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+        for (auto it = range.first; it != range.second; ++it) {
+          candidateRows.push_back(it->second);
+        }
+      }
+      std::sort(candidateRows.begin(), candidateRows.end());
+      const auto nCandidates = candidateRows.size();
+      candidateX.resize(nCandidates);
+      candidateY.resize(nCandidates);
+      candidateZ.resize(nCandidates);
+      for (std::size_t i = 0; i < nCandidates; i++) {
+        candidateX[i] = collisionX[candidateRows[i]];
+        candidateY[i] = collisionY[candidateRows[i]];
+        candidateZ[i] = collisionZ[candidateRows[i]];
+      }
+      candidateDCAX.resize(nCandidates);
+      candidateDCAY.resize(nCandidates);
+      candidateDCAXY.resize(nCandidates);
+      o2::analysis::fwd::getDCAs(line, candidateX.data(), candidateY.data(), candidateZ.data(), nCandidates,
+                                 candidateDCAX.data(), candidateDCAY.data(), candidateDCAXY.data());
+
+      int collCounter = nCandidates;
+      for (std::size_t i = 0; i < nCandidates; i++) {
+        //here the bc of the ambitrack is the bc of the collision we are looking at
+        auto collision = collisions.iteratorAt(candidateRows[i]);
+
+        // DCAxy of this track wrt the primary vertex of the current collision
+        const auto dcaX = candidateDCAX[i];
+        const auto dcaY = candidateDCAY[i];
+        const auto dcaXY = candidateDCAXY[i];
+
+        registry.fill(HIST("TracksDCAXY"), dcaXY);
+        registry.fill(HIST("TracksDCAX"), dcaX);
+        registry.fill(HIST("TracksDCAY"), dcaY);
+        registry.fill(HIST("NumberOfContributors"), collision.numContrib());
+
+        if (dcaXY > maxDCAXY) {
+          continue;
+        }
 
-          vecDCACollForAmb.push_back(dcaXY);
+        vecDCACollForAmb.push_back(dcaXY);
 
-          if (!collision.has_mcCollision()) {
-            continue;
-          }
+        if (!collision.has_mcCollision()) {
+          continue;
+        }
 
-          int mcCollindex = collision.mcCollision().globalIndex();
-          vecCollForAmb.push_back(mcCollindex);
+        int mcCollindex = collision.mcCollision().globalIndex();
+        vecCollForAmb.push_back(mcCollindex);
 
-          vecZposCollForAmb.push_back(collision.mcCollision().posZ());
+        vecZposCollForAmb.push_back(collision.mcCollision().posZ());
 
-          registry.fill(HIST("DeltaZvtx"), collision.mcCollision().posZ() - zVtxMCAmbi);
-          break; //once we found a bc that corresponds to the bc of the collision we are working on, go out of the bcambi loop
-          //We then look at the next collision
-        }
+        registry.fill(HIST("DeltaZvtx"), collision.mcCollision().posZ() - zVtxMCAmbi);
       }
 
       registry.fill(HIST("NbCollComp"), collCounter);
@@ -9,6 +9,7 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <cmath>
 #include "CommonConstants/PhysicsConstants.h"
 #include "DGPIDSelector.h"
 
@@ -279,6 +280,10 @@ DGParticle::DGParticle(TDatabasePDG* pdg, DGAnaparHolder anaPars, UDTracksFull c
   mtrkinds = comb;
 }
 
+DGParticle::DGParticle(TLorentzVector const& ivm, std::vector<uint> const& comb) : mIVM{ivm}, mtrkinds{comb}
+{
+}
+
 DGParticle::~DGParticle()
 {
   mtrkinds.clear();
@@ -298,6 +303,7 @@ void DGParticle::Print()
 DGPIDSelector::DGPIDSelector()
 {
   fPDG = TDatabasePDG::Instance();
+  cacheAnaPars();
 }
 
 DGPIDSelector::~DGPIDSelector()
@@ -316,6 +322,20 @@ void DGPIDSelector::init(DGAnaparHolder anaPars)
 {
   mAnaPars = anaPars;
   mIVMs.clear();
+  cacheAnaPars();
+}
+
+// -----------------------------------------------------------------------------
+void DGPIDSelector::cacheAnaPars()
+{
+  mPIDs = mAnaPars.PIDs();
+  mMasses.clear();
+  for (auto pid : mPIDs) {
+    mMasses.push_back(particleMass(fPDG, static_cast<int>(pid)));
+  }
+  mPIDCuts = mAnaPars.PIDCuts().Cuts();
+  mNetCharges = mAnaPars.netCharges();
+  mUniquePerms = mAnaPars.uniquePermutations();
 }
 
 // -----------------------------------------------------------------------------
@@ -359,7 +379,7 @@ float DGPIDSelector::getTOFnSigma(UDTrackFull track, int pid)
 }
 
 // -----------------------------------------------------------------------------
-bool DGPIDSelector::isGoodCombination(std::vector<uint> comb, UDTracksFull const& tracks)
+bool DGPIDSelector::isGoodCombination(std::vector<uint> const& comb, UDTracksFull const& tracks)
 {
   // compute net charge of track combination
   int netCharge = 0.;
@@ -369,8 +389,7 @@ bool DGPIDSelector::isGoodCombination(std::vector<uint> comb, UDTracksFull const
   LOGF(debug, "Net charge %i", netCharge);
 
   // is this in the list of accepted net charges?
-  auto netCharges = mAnaPars.netCharges();
-  if (std::find(netCharges.begin(), netCharges.end(), netCharge) != netCharges.end()) {
+  if (std::find(mNetCharges.begin(), mNetCharges.end(), netCharge) != mNetCharges.end()) {
     return true;
   }
   return false;
@@ -380,7 +399,7 @@ bool DGPIDSelector::isGoodCombination(std::vector<uint> comb, UDTracksFull const
 bool DGPIDSelector::isGoodTrack(UDTrackFull track, int cnt)
 {
   // get pid of particle cnt
-  auto pid = mAnaPars.PIDs()[cnt];
+  auto pid = mPIDs[cnt];
 
   // unknown PID
   auto pidhypo = pid2ind(pid);
@@ -399,8 +418,7 @@ bool DGPIDSelector::isGoodTrack(UDTrackFull track, int cnt)
   }
 
   // loop over all PIDCuts and apply the ones which apply to this track
-  auto pidcuts = mAnaPars.PIDCuts().Cuts();
-  for (auto pidcut : pidcuts) {
+  for (auto& pidcut : mPIDCuts) {
 
     // skip cut if it does not apply to this track
     LOGF(debug, "nPart %i %i, Type %i Apply %i", pidcut.nPart(), cnt, pidcut.cutType(), pidcut.cutApply());
@@ -469,35 +487,89 @@ bool DGPIDSelector::isGoodTrack(UDTrackFull track, int cnt)
 }
 
 // -----------------------------------------------------------------------------
+// The PID and the 4-vector of each track are computed once per position in the
+// combination, then the combinations of nCombine tracks are enumerated in
+// lexicographic order, each with its unique permutations, without allocating
+// per combination
 int DGPIDSelector::computeIVMs(UDTracksFull const& tracks)
 {
   // reset
   mIVMs.clear();
 
-  // create combinations including permutations
-  auto combs = combinations(tracks.size());
+  const int nTracks = tracks.size();
+  const int nCombine = mAnaPars.nCombine();
+  if (nCombine <= 0 || nTracks < nCombine) {
+    return 0;
+  }
+
+  // per track quantities
+  mSigns.resize(nTracks);
+  mMomenta.resize(nTracks);
+  mEnergies.resize(nTracks * nCombine);
+  mGoodTracks.resize(nTracks * nCombine);
+  for (auto ind = 0; ind < nTracks; ind++) {
+    auto track = tracks.rawIteratorAt(ind);
+    mSigns[ind] = track.sign();
+    mMomenta[ind] = {track.px(), track.py(), track.pz()};
+    const double p2 = mMomenta[ind][0] * mMomenta[ind][0] + mMomenta[ind][1] * mMomenta[ind][1] + mMomenta[ind][2] * mMomenta[ind][2];
+    for (auto cnt = 0; cnt < nCombine; cnt++) {
+      mEnergies[ind * nCombine + cnt] = std::sqrt(p2 + mMasses[cnt] * mMasses[cnt]);
+      mGoodTracks[ind * nCombine + cnt] = isGoodTrack(track, cnt);
+    }
+  }
 
-  // loop over unique combinations
-  for (auto comb : combs) {
+  // loop over the combinations
+  const int numUniquePerms = mUniquePerms.size() / nCombine;
+  mComb.resize(nCombine);
+  mCope.resize(nCombine);
+  for (auto jj = 0; jj < nCombine; jj++) {
+    mComb[jj] = jj;
+  }
+  while (true) {
     // is combination compatible with netCharge requirements?
-    if (!isGoodCombination(comb, tracks)) {
-      continue;
+    int netCharge = 0;
+    for (auto ind : mComb) {
+      netCharge += mSigns[ind];
     }
-    // is tracks compatible with PID requirements?
-    bool isGoodComb = true;
-    auto cnt = -1;
-    for (auto ind : comb) {
-      cnt++;
-      if (!isGoodTrack(tracks.rawIteratorAt(ind), cnt)) {
-        isGoodComb = false;
-        break;
+    if (std::find(mNetCharges.begin(), mNetCharges.end(), netCharge) != mNetCharges.end()) {
+      for (auto ii = 0; ii < numUniquePerms; ii++) {
+        for (auto jj = 0; jj < nCombine; jj++) {
+          mCope[mUniquePerms[ii * nCombine + jj]] = mComb[jj];
+        }
+
+        // are tracks compatible with PID requirements?
+        bool isGoodComb = true;
+        double px = 0., py = 0., pz = 0., e = 0.;
+        for (auto cnt = 0; cnt < nCombine; cnt++) {
+          const auto ind = mCope[cnt];
+          if (!mGoodTracks[ind * nCombine + cnt]) {
+            isGoodComb = false;
+            break;
+          }
+          px += mMomenta[ind][0];
+          py += mMomenta[ind][1];
+          pz += mMomenta[ind][2];
+          e += mEnergies[ind * nCombine + cnt];
+        }
+
+        // update list of IVMs
+        if (isGoodComb) {
+          mIVMs.emplace_back(TLorentzVector(px, py, pz, e), mCope);
+        }
       }
     }
 
-    // update list of IVMs
-    if (isGoodComb) {
-      DGParticle IVM(fPDG, mAnaPars, tracks, comb);
-      mIVMs.push_back(IVM);
+    // next combination
+    auto kk = nCombine - 1;
+    while (kk >= 0 && static_cast<int>(mComb[kk]) == nTracks - nCombine + kk) {
+      kk--;
+    }
+    if (kk < 0) {
+      break;
+    }
+    mComb[kk]++;
+    for (auto jj = kk + 1; jj < nCombine; jj++) {
+      mComb[jj] = mComb[jj - 1] + 1;
     }
   }
 
@@ -524,96 +596,3 @@ int DGPIDSelector::pid2ind(int pid)
 };
 
 // -----------------------------------------------------------------------------
-// find selections of np out of n0
-void DGPIDSelector::combinations(int n0, std::vector<uint>& pool, int np, std::vector<uint>& inds, int n,
-                                 std::vector<std::vector<uint>>& combs)
-{
-  // loop over pool
-  for (auto ii = 0; ii < n0 - n; ii++) {
-
-    inds[n] = pool[ii];
-
-    // if all inds are defined then print them out
-    // else get next inds
-    if (np == 1) {
-
-      std::vector<uint> comb(n + 1, 0);
-      for (uint ii = 0; ii < inds.size(); ii++) {
-        comb[ii] = inds[ii];
-      }
-      combs.push_back(comb);
-
-    } else {
-
-      auto n0new = n0 - ii;
-      std::vector<uint> newpool(n0new, 0);
-      for (auto kk = 0; kk < n0new; kk++) {
-        newpool[kk] = pool[kk + ii + 1];
-      }
-
-      auto npnew = np - 1;
-      auto nnew = n + 1;
-      combinations(n0new, newpool, npnew, inds, nnew, combs);
-    }
-  }
-}
-
-// -----------------------------------------------------------------------------
-// find all possible selections of np out of n0
-int DGPIDSelector::combinations(int n0, int np, std::vector<std::vector<uint>>& combs)
-{
-  // initialisations
-  combs.clear();
-  if (n0 < np) {
-    return 0;
-  }
-
-  std::vector<uint> pool(n0, 0);
-  for (auto ii = 0; ii < n0; ii++) {
-    pool[ii] = ii;
-  }
-  std::vector<uint> inds(np, 0);
-
-  // iterate recursively
-  combinations(n0, pool, np, inds, 0, combs);
-
-  return combs.size();
-}
-
-// -----------------------------------------------------------------------------
-std::vector<std::vector<uint>> DGPIDSelector::combinations(int nPool)
-{
-  // get the unique permutations
-  auto uniquePerms = mAnaPars.uniquePermutations();
-  auto numUniquePerms = uniquePerms.size() / mAnaPars.nCombine();
-
-  // all selections of nCombine elements from nPool elements
-  std::vector<std::vector<uint>> combs;
-  combinations(nPool, mAnaPars.nCombine(), combs);
-
-  // permute the combinations
-  std::vector<std::vector<uint>> copes;
-  for (auto comb : combs) {
-    for (auto ii = 0u; ii < numUniquePerms; ii++) {
-      std::vector<uint> cope(mAnaPars.nCombine(), 0);
-      for (auto jj = 0; jj < mAnaPars.nCombine(); jj++) {
-        auto ind = ii * mAnaPars.nCombine() + jj;
-        cope[uniquePerms[ind]] = comb[jj];
-      }
-      copes.push_back(cope);
-    }
-  }
-
-  // print copes
-  LOGF(debug, "copes");
-  for (auto cope : copes) {
-    LOGF(debug, "  cope");
-    for (auto ind : cope) {
-      LOGF(debug, "    %i", ind);
-    }
-  }
-
-  return copes;
-}
-
-// -----------------------------------------------------------------------------
@@ -13,6 +13,7 @@
 #define PWGUD_CORE_DGPIDSELECTOR_H_
 
 #include <gandiva/projector.h>
+#include <array>
 #include <string>
 #include <vector>
 #include "TDatabasePDG.h"
@@ -160,13 +161,14 @@ struct DGParticle {
  public:
   DGParticle();
   DGParticle(TDatabasePDG* pdg, DGAnaparHolder anaPars, UDTracksFull const& tracks, std::vector<uint> comb);
+  DGParticle(TLorentzVector const& ivm, std::vector<uint> const& comb);
   ~DGParticle();
 
   // getter
   void Print();
-  std::vector<uint> trkinds() { return mtrkinds; }
-  float M() { return mIVM.M(); }
-  float Perp() { return mIVM.Perp(); }
+  std::vector<uint> const& trkinds() const { return mtrkinds; }
+  float M() const { return mIVM.M(); }
+  float Perp() const { return mIVM.Perp(); }
 
  private:
   // invariant mass
@@ -190,14 +192,14 @@ struct DGPIDSelector {
 
   // getters
   void Print();
-  bool isGoodCombination(std::vector<uint> comb, UDTracksFull const& tracks);
+  bool isGoodCombination(std::vector<uint> const& comb, UDTracksFull const& tracks);
   bool isGoodTrack(UDTrackFull track, int cnt);
   int computeIVMs(UDTracksFull const& tracks);
 
   DGAnaparHolder getAnaPars() { return mAnaPars; }
   float getTPCnSigma(UDTrackFull track, int pid);
   float getTOFnSigma(UDTrackFull track, int pid);
-  std::vector<DGParticle> IVMs() { return mIVMs; }
+  std::vector<DGParticle> const& IVMs() const { return mIVMs; }
 
   int pid2ind(int pid);
 
@@ -211,11 +213,21 @@ struct DGPIDSelector {
   // particle properties
   TDatabasePDG* fPDG;
 
-  // helper functions for computeIVMs
-  void combinations(int n0, std::vector<uint>& pool, int np, std::vector<uint>& inds, int n,
-                    std::vector<std::vector<uint>>& combs);
-  int combinations(int n0, int np, std::vector<std::vector<uint>>& combs);
-  std::vector<std::vector<uint>> combinations(int nPool);
+  // analysis parameters used per track and per combination, copied from mAnaPars in init
+  void cacheAnaPars();
+  std::vector<float> mPIDs;       //!
+  std::vector<float> mMasses;     //!
+  std::vector<DGPIDCut> mPIDCuts; //!
+  std::vector<int> mNetCharges;   //!
+  std::vector<int> mUniquePerms;  //!
+
+  // workspace of computeIVMs, reused for all the candidates
+  std::vector<int> mSigns;                     //! per track
+  std::vector<std::array<double, 3>> mMomenta; //! per track
+  std::vector<double> mEnergies;               //! per track and position in the combination, with the mass of its PID hypothesis
+  std::vector<uint8_t> mGoodTracks;            //! per track and position in the combination, result of isGoodTrack
+  std::vector<uint> mComb;                     //! current combination of nCombine tracks
+  std::vector<uint> mCope;                     //! current permutation of the combination
 
   // ClassDefNV(DGPIDSelector, 1);
 };
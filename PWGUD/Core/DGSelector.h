@@ -12,6 +12,11 @@
 #ifndef PWGUD_CORE_DGSELECTOR_H_
 #define PWGUD_CORE_DGSELECTOR_H_
 
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <vector>
 #include "TDatabasePDG.h"
 #include "TLorentzVector.h"
 #include "Framework/Logger.h"
@@ -19,6 +24,64 @@
 #include "PWGUD/Core/UDHelpers.h"
 #include "PWGUD/Core/DGCutparHolder.h"
 
+// -----------------------------------------------------------------------------
+// DG cuts resolved once, at init, from a DGCutparHolder
+// The values are plain members, the net charges are sorted and the mass of the PID hypothesis is looked up,
+// so that the selection does not call the getters of the DGCutparHolder nor copy its vectors per candidate
+struct DGResolvedCuts {
+  DGResolvedCuts() = default;
+  explicit DGResolvedCuts(DGCutparHolder const& diffCuts)
+    : nDtcoll{diffCuts.NDtcoll()},
+      minNBCs{diffCuts.minNBCs()},
+      globalTracksOnly{diffCuts.globalTracksOnly()},
+      minRgtrwTOF{diffCuts.minRgtrwTOF()},
+      minNTracks{diffCuts.minNTracks()},
+      maxNTracks{diffCuts.maxNTracks()},
+      netCharges{diffCuts.netCharges()},
+      pidHypothesis{diffCuts.pidHypothesis()},
+      minPosz{diffCuts.minPosz()},
+      maxPosz{diffCuts.maxPosz()},
+      minPt{diffCuts.minPt()},
+      maxPt{diffCuts.maxPt()},
+      minEta{diffCuts.minEta()},
+      maxEta{diffCuts.maxEta()},
+      minIVM{diffCuts.minIVM()},
+      maxIVM{diffCuts.maxIVM()},
+      maxNSigmaTPC{diffCuts.maxNSigmaTPC()},
+      maxNSigmaTOF{diffCuts.maxNSigmaTOF()},
+      FITAmpLimits{diffCuts.FITAmpLimits()}
+  {
+    std::sort(netCharges.begin(), netCharges.end());
+    TParticlePDG* pdgparticle = TDatabasePDG::Instance()->GetParticle(pidHypothesis);
+    if (pdgparticle != nullptr) {
+      mass = pdgparticle->Mass();
+    }
+  }
+
+  bool isNetChargeSelected(int netCharge) const { return std::binary_search(netCharges.begin(), netCharges.end(), netCharge); }
+
+  int nDtcoll = 4;
+  int minNBCs = 7;
+  bool globalTracksOnly = false;
+  float minRgtrwTOF = 0.;
+  int minNTracks = 0;
+  int maxNTracks = 10000;
+  std::vector<int> netCharges{0}; // sorted
+  int pidHypothesis = 211;
+  double mass = 0.; // mass of the PID hypothesis
+  float minPosz = -1000.;
+  float maxPosz = 1000.;
+  float minPt = 0.;
+  float maxPt = 1000.;
+  float minEta = -1.;
+  float maxEta = 1.;
+  float minIVM = 0.;
+  float maxIVM = 1000.;
+  float maxNSigmaTPC = 1000.;
+  float maxNSigmaTOF = 1000.;
+  std::vector<float> FITAmpLimits{0., 0., 0., 0., 0.};
+};
+
 // -----------------------------------------------------------------------------
 // add here Selectors for different types of diffractive events
 // Selector for Double Gap events
@@ -38,192 +101,234 @@ class DGSelector
 
   // Function to check if collisions passes DG filter
   template <typename CC, typename BCs, typename TCs, typename FWs>
-  int IsSelected(DGCutparHolder diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  int IsSelected(DGResolvedCuts const& diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
   {
     LOGF(debug, "Collision %f", collision.collisionTime());
     LOGF(debug, "Number of close BCs: %i", bcRange.size());
+    fillFITSummaries(bcRange);
+    fillTrackSummaries(tracks);
+    LOGF(debug, "FwdTracks %i", fwdtracks.size());
 
-    // check that there are no FIT signals in any of the compatible BCs
-    // Double Gap (DG) condition
-    auto lims = diffCuts.FITAmpLimits();
-
-    for (auto const& bc : bcRange) {
-      LOGF(debug, "Amplitudes FV0A %f FT0 %f / %f FDD %i / %i",
-           bc.has_foundFV0() ? udhelpers::FV0AmplitudeA(bc.foundFV0()) : -1.,
-           bc.has_foundFT0() ? udhelpers::FT0AmplitudeA(bc.foundFT0()) : -1.,
-           bc.has_foundFT0() ? udhelpers::FT0AmplitudeC(bc.foundFT0()) : -1.,
-           bc.has_foundFDD() ? udhelpers::FDDAmplitudeA(bc.foundFDD()) : -1,
-           bc.has_foundFDD() ? udhelpers::FDDAmplitudeC(bc.foundFDD()) : -1);
-      LOGF(debug, "  clean FV0A %i FT0 %i FDD %i", udhelpers::cleanFV0(bc, lims[0]), udhelpers::cleanFT0(bc, lims[1], lims[2]), udhelpers::cleanFDD(bc, lims[3], lims[4]));
-
-      if (!udhelpers::cleanFIT(bc, diffCuts.FITAmpLimits())) {
-        return 1;
-      }
-    }
+    return evaluate(diffCuts, true, collision.numContrib(), fwdtracks.size());
+  };
 
-    // no activity in muon arm
+  // Function to check if BC passes DG filter (without associated collision)
+  template <typename BCs, typename TCs, typename FWs>
+  int IsSelected(DGResolvedCuts const& diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  {
+    fillFITSummaries(bcRange);
+    fillTrackSummaries(tracks);
     LOGF(debug, "FwdTracks %i", fwdtracks.size());
-    for (auto& fwdtrack : fwdtracks) {
-      LOGF(debug, "  %i / %f / %f / %f", fwdtrack.trackType(), fwdtrack.eta(), fwdtrack.pt(), fwdtrack.p());
-    }
-    if (fwdtracks.size() > 0) {
-      return 2;
-    }
 
-    // no global tracks which are not vtx tracks
-    // no vtx tracks which are not global tracks
-    auto rgtrwTOF = 0.;
-    for (auto& track : tracks) {
-      if (track.isGlobalTrack() && !track.isPVContributor()) {
-        return 3;
-      }
-      if (diffCuts.globalTracksOnly() && !track.isGlobalTrack() && track.isPVContributor()) {
-        return 4;
-      }
+    return evaluate(diffCuts, false, static_cast<int>(tracks.size()), fwdtracks.size());
+  };
 
-      // update fraction of PV tracks with TOF hit
-      if (track.isPVContributor() && track.hasTOF()) {
-        rgtrwTOF += 1.;
+  // Evaluate several sets of DG cuts on a collision in one pass, bit i of the returned mask is set
+  // if the collision passes the cuts cutSets[i], at most 32 sets are considered
+  // The FIT amplitudes and the track quantities are computed once and shared by all sets
+  template <typename CC, typename BCs, typename TCs, typename FWs>
+  uint32_t SelectionMask(std::vector<DGResolvedCuts> const& cutSets, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  {
+    fillFITSummaries(bcRange);
+    fillTrackSummaries(tracks);
+
+    uint32_t mask = 0;
+    auto nSets = std::min(static_cast<int>(cutSets.size()), 32);
+    for (auto iSet = 0; iSet < nSets; iSet++) {
+      if (evaluate(cutSets[iSet], true, collision.numContrib(), fwdtracks.size()) == 0) {
+        mask |= 1u << iSet;
       }
     }
-    if (collision.numContrib() > 0) {
-      rgtrwTOF /= collision.numContrib();
-    }
-    if (rgtrwTOF < diffCuts.minRgtrwTOF()) {
-      return 5;
-    }
+    return mask;
+  };
 
-    // number of vertex tracks
-    if (collision.numContrib() < diffCuts.minNTracks() || collision.numContrib() > diffCuts.maxNTracks()) {
-      return 6;
+  // same for a BC without associated collision
+  template <typename BCs, typename TCs, typename FWs>
+  uint32_t SelectionMask(std::vector<DGResolvedCuts> const& cutSets, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  {
+    fillFITSummaries(bcRange);
+    fillTrackSummaries(tracks);
+
+    uint32_t mask = 0;
+    auto nSets = std::min(static_cast<int>(cutSets.size()), 32);
+    for (auto iSet = 0; iSet < nSets; iSet++) {
+      if (evaluate(cutSets[iSet], false, static_cast<int>(tracks.size()), fwdtracks.size()) == 0) {
+        mask |= 1u << iSet;
+      }
     }
+    return mask;
+  };
 
-    // PID, pt, and eta of tracks, invariant mass, and net charge
-    // consider only vertex tracks
+ private:
+  // track quality flags
+  enum TrackFlags : uint32_t {
+    kGlobalTrack = 1u << 0,
+    kPVContributor = 1u << 1,
+    kHasTOF = 1u << 2
+  };
 
-    // which particle hypothesis?
-    auto mass2Use = 0.;
-    TParticlePDG* pdgparticle = fPDG->GetParticle(diffCuts.pidHypothesis());
-    if (pdgparticle != nullptr) {
-      mass2Use = pdgparticle->Mass();
+  // cut independent quantities of a track
+  struct TrackSummary {
+    float px;
+    float py;
+    float pz;
+    float pt;
+    float eta;
+    float minNSigmaTPC; // smallest |nSigma| of the TPC PID over El, Mu, Pi, Ka, Pr
+    float minNSigmaTOF; // same for the TOF PID, only used with kHasTOF
+    int8_t sign;
+    uint32_t flags;
+  };
+
+  template <typename BCs>
+  void fillFITSummaries(BCs& bcRange)
+  {
+    fFITs.clear();
+    for (auto const& bc : bcRange) {
+      auto fit = udhelpers::fitAmplitudes(bc);
+      LOGF(debug, "Amplitudes FV0A %f FT0 %f / %f FDD %f / %f",
+           fit.hasFV0 ? fit.fv0A : -1., fit.hasFT0 ? fit.ft0A : -1., fit.hasFT0 ? fit.ft0C : -1.,
+           fit.hasFDD ? fit.fddA : -1., fit.hasFDD ? fit.fddC : -1.);
+      fFITs.push_back(fit);
     }
+  }
 
-    auto netCharge = 0;
+  template <typename TCs>
+  void fillTrackSummaries(TCs& tracks)
+  {
+    fTracks.clear();
     auto lvtmp = TLorentzVector();
-    auto ivm = TLorentzVector();
     for (auto& track : tracks) {
-      if (track.isPVContributor()) {
-
-        // PID
-        if (!udhelpers::hasGoodPID(diffCuts, track)) {
-          return 7;
-        }
-
-        // pt
-        lvtmp.SetXYZM(track.px(), track.py(), track.pz(), mass2Use);
-        if (lvtmp.Perp() < diffCuts.minPt() || lvtmp.Perp() > diffCuts.maxPt()) {
-          return 8;
-        }
-
-        // eta
-        if (lvtmp.Eta() < diffCuts.minEta() || lvtmp.Eta() > diffCuts.maxEta()) {
-          return 9;
-        }
-        netCharge += track.sign();
-        ivm += lvtmp;
-      }
-    }
-
-    // net charge
-    auto netChargeValues = diffCuts.netCharges();
-    if (std::find(netChargeValues.begin(), netChargeValues.end(), netCharge) == netChargeValues.end()) {
-      return 10;
-    }
-    // invariant mass
-    if (ivm.M() < diffCuts.minIVM() || ivm.M() > diffCuts.maxIVM()) {
-      return 11;
+      TrackSummary summary;
+      summary.px = track.px();
+      summary.py = track.py();
+      summary.pz = track.pz();
+
+      // pt and eta do not depend on the mass hypothesis
+      lvtmp.SetXYZM(track.px(), track.py(), track.pz(), 0.);
+      summary.pt = lvtmp.Perp();
+      summary.eta = lvtmp.Eta();
+      summary.minNSigmaTPC = minAbs({track.tpcNSigmaEl(), track.tpcNSigmaMu(), track.tpcNSigmaPi(), track.tpcNSigmaKa(), track.tpcNSigmaPr()});
+      summary.minNSigmaTOF = track.hasTOF() ? minAbs({track.tofNSigmaEl(), track.tofNSigmaMu(), track.tofNSigmaPi(), track.tofNSigmaKa(), track.tofNSigmaPr()}) : 0.f;
+      summary.sign = track.sign();
+      summary.flags = (track.isGlobalTrack() ? kGlobalTrack : 0u) | (track.isPVContributor() ? kPVContributor : 0u) | (track.hasTOF() ? kHasTOF : 0u);
+      fTracks.push_back(summary);
     }
+  }
 
-    // if we arrive here then the event is good!
-    return 0;
-  };
-
-  // Function to check if BC passes DG filter (without associated collision)
-  template <typename BCs, typename TCs, typename FWs>
-  int IsSelected(DGCutparHolder diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  // apply the DG cuts to the stored FIT and track summaries
+  // withCollision: the tracks are the tracks of a collision and only the vertex tracks are considered
+  // nTracks: number of vertex tracks (with collision) or of tracks (without collision)
+  int evaluate(DGResolvedCuts const& diffCuts, bool withCollision, int nTracks, int nFwdTracks)
   {
-    // check that there are no FIT signals in bcRange
+    // check that there are no FIT signals in any of the compatible BCs
     // Double Gap (DG) condition
-    for (auto const& bc : bcRange) {
-      if (!udhelpers::cleanFIT(bc, diffCuts.FITAmpLimits())) {
+    for (auto const& fit : fFITs) {
+      if (!udhelpers::cleanFIT(fit, diffCuts.FITAmpLimits)) {
         return 1;
       }
     }
 
     // no activity in muon arm
-    LOGF(debug, "FwdTracks %i", fwdtracks.size());
-    for (auto& fwdtrack : fwdtracks) {
-      LOGF(debug, "  %i / %f / %f / %f", fwdtrack.trackType(), fwdtrack.eta(), fwdtrack.pt(), fwdtrack.p());
-    }
-    if (fwdtracks.size() > 0) {
+    if (nFwdTracks > 0) {
       return 2;
     }
 
-    // number of tracks
-    if (static_cast<int>(tracks.size()) < diffCuts.minNTracks() || static_cast<int>(tracks.size()) > diffCuts.maxNTracks()) {
-      return 6;
+    if (withCollision) {
+      // no global tracks which are not vtx tracks
+      // no vtx tracks which are not global tracks
+      auto rgtrwTOF = 0.;
+      for (auto const& track : fTracks) {
+        if ((track.flags & (kGlobalTrack | kPVContributor)) == kGlobalTrack) {
+          return 3;
+        }
+        if (diffCuts.globalTracksOnly && (track.flags & (kGlobalTrack | kPVContributor)) == kPVContributor) {
+          return 4;
+        }
+
+        // update fraction of PV tracks with TOF hit
+        if ((track.flags & (kPVContributor | kHasTOF)) == (kPVContributor | kHasTOF)) {
+          rgtrwTOF += 1.;
+        }
+      }
+      if (nTracks > 0) {
+        rgtrwTOF /= nTracks;
+      }
+      if (rgtrwTOF < diffCuts.minRgtrwTOF) {
+        return 5;
+      }
     }
 
-    // PID, pt, and eta of tracks, invariant mass, and net charge
-    // which particle hypothesis?
-    auto mass2Use = 0.;
-    TParticlePDG* pdgparticle = fPDG->GetParticle(diffCuts.pidHypothesis());
-    if (pdgparticle != nullptr) {
-      mass2Use = pdgparticle->Mass();
+    // number of (vertex) tracks
+    if (nTracks < diffCuts.minNTracks || nTracks > diffCuts.maxNTracks) {
+      return 6;
     }
 
+    // PID, pt, and eta of tracks, invariant mass, and net charge
+    // with collision consider only vertex tracks
+    auto mass2Use = diffCuts.mass;
     auto netCharge = 0;
-    auto lvtmp = TLorentzVector();
-    auto ivm = TLorentzVector();
-    for (auto& track : tracks) {
-      // PID
-      if (!udhelpers::hasGoodPID(diffCuts, track)) {
+    double px = 0., py = 0., pz = 0., e = 0.;
+    for (auto const& track : fTracks) {
+      if (withCollision && !(track.flags & kPVContributor)) {
+        continue;
+      }
+
+      // PID, see udhelpers::hasGoodPID
+      if (!(track.minNSigmaTPC < diffCuts.maxNSigmaTPC || ((track.flags & kHasTOF) && track.minNSigmaTOF < diffCuts.maxNSigmaTOF))) {
         return 7;
       }
 
       // pt
-      lvtmp.SetXYZM(track.px(), track.py(), track.pz(), mass2Use);
-      if (lvtmp.Perp() < diffCuts.minPt() || lvtmp.Perp() > diffCuts.maxPt()) {
+      if (track.pt < diffCuts.minPt || track.pt > diffCuts.maxPt) {
         return 8;
       }
 
       // eta
-      if (lvtmp.Eta() < diffCuts.minEta() || lvtmp.Eta() > diffCuts.maxEta()) {
+      if (track.eta < diffCuts.minEta || track.eta > diffCuts.maxEta) {
         return 9;
       }
-      netCharge += track.sign();
-      ivm += lvtmp;
+      netCharge += track.sign;
+      px += track.px;
+      py += track.py;
+      pz += track.pz;
+      e += std::sqrt(track.px * track.px + track.py * track.py + track.pz * track.pz + mass2Use * mass2Use);
     }
 
     // net charge
-    auto netChargeValues = diffCuts.netCharges();
-    if (std::find(netChargeValues.begin(), netChargeValues.end(), netCharge) == netChargeValues.end()) {
+    if (!diffCuts.isNetChargeSelected(netCharge)) {
       return 10;
     }
 
     // invariant mass
-    if (ivm.M() < diffCuts.minIVM() || ivm.M() > diffCuts.maxIVM()) {
+    auto ivm = TLorentzVector(px, py, pz, e);
+    if (ivm.M() < diffCuts.minIVM || ivm.M() > diffCuts.maxIVM) {
       return 11;
     }
 
     // if we arrive here then the event is good!
     return 0;
-  };
+  }
+
+  // smallest absolute value, NaN values are ignored as in udhelpers::hasGoodPID
+  static float minAbs(std::initializer_list<float> values)
+  {
+    auto result = std::numeric_limits<float>::max();
+    for (auto value : values) {
+      if (std::abs(value) < result) {
+        result = std::abs(value);
+      }
+    }
+    return result;
+  }
 
- private:
   TDatabasePDG* fPDG;
 
-  ClassDefNV(DGSelector, 1);
+  // summaries of the BCs and tracks of the candidate under selection
+  std::vector<udhelpers::FITAmplitudes> fFITs;
+  std::vector<TrackSummary> fTracks;
+
+  ClassDefNV(DGSelector, 3);
 };
 
 #endif // PWGUD_CORE_DGSELECTOR_H_
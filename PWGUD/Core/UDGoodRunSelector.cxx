@@ -32,6 +32,7 @@ UDGoodRunSelector::~UDGoodRunSelector()
 void UDGoodRunSelector::clear()
 {
   mgoodRuns.clear();
+  mgoodRunFlags.clear();
   mrunMap.clear();
   mrnMin = -1;
   mrnMax = -1;
@@ -53,16 +54,6 @@ void UDGoodRunSelector::Print()
   }
 }
 
-bool UDGoodRunSelector::isGoodRun(int runNumber)
-{
-  // search for runNumber in mgoodRuns
-  if (!misActive) {
-    return true;
-  } else {
-    return std::find(mgoodRuns.begin(), mgoodRuns.end(), runNumber) != mgoodRuns.end();
-  }
-}
-
 std::vector<int> UDGoodRunSelector::goodRuns(std::string runPeriod)
 {
   auto it = mrunMap.find(runPeriod.c_str());
@@ -158,11 +149,6 @@ bool UDGoodRunSelector::init(std::string const& goodRunsFile)
       // update goodRuns and mrunMap
       for (auto& item2 : item1[itemName].GetArray()) {
         runNumber = item2.GetInt();
-        if (runNumber < mrnMin) {
-          mrnMin = runNumber;
-        } else if (runNumber > mrnMax) {
-          mrnMax = runNumber;
-        }
         mgoodRuns.push_back(runNumber);
         mrunMap[runPeriod].push_back(runNumber);
         misActive = true;
@@ -174,6 +160,16 @@ bool UDGoodRunSelector::init(std::string const& goodRunsFile)
   auto last = std::unique(mgoodRuns.begin(), mgoodRuns.end());
   mgoodRuns.erase(last, mgoodRuns.end());
 
+  // run range and flags of the good runs
+  if (!mgoodRuns.empty()) {
+    mrnMin = mgoodRuns.front();
+    mrnMax = mgoodRuns.back();
+    mgoodRunFlags.assign(mrnMax - mrnMin + 1, false);
+    for (const auto& goodRun : mgoodRuns) {
+      mgoodRunFlags[goodRun - mrnMin] = true;
+    }
+  }
+
   // clean up
   fclose(fjson);
 
@@ -31,17 +31,28 @@ struct UDGoodRunSelector {
 
   // getters
   void Print();
-  bool isGoodRun(int runNumber);
+  // O(1) lookup in the flags of the run range, filled at init
+  bool isGoodRun(int runNumber) const
+  {
+    if (!misActive) {
+      return true;
+    }
+    if (runNumber < mrnMin || runNumber > mrnMax) {
+      return false;
+    }
+    return mgoodRunFlags[runNumber - mrnMin];
+  }
   std::vector<int> goodRuns() { return mgoodRuns; }
   std::vector<int> goodRuns(std::string runPeriod);
   int rnumMin() { return mrnMin; }
   int rnumMax() { return mrnMax; }
 
  private:
-  bool misActive;
+  bool misActive = false;
   std::string mgoodRunsFile;
   int mrnMin = -1, mrnMax = -1;
   std::vector<int> mgoodRuns;
+  std::vector<bool> mgoodRunFlags; // flag of the run numbers mrnMin to mrnMax
   std::map<std::string, std::vector<int>> mrunMap;
 };
 
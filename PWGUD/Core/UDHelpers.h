@@ -16,6 +16,8 @@
 #ifndef PWGUD_CORE_UDHELPERS_H_
 #define PWGUD_CORE_UDHELPERS_H_
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include "Framework/Logger.h"
 #include "CommonConstants/LHCConstants.h"
@@ -204,6 +206,82 @@ T compatibleBCs(uint64_t meanBC, int deltaBC, T const& bcs)
   return compatibleBCs(bcIter, meanBC, deltaBC, bcs);
 }
 
+// -----------------------------------------------------------------------------
+// Index of the global BCs of the BCs table of a dataframe.
+// The rows of the BCs table are ordered in globalBC. The global BCs are copied once per dataframe and the rows
+// with globalBC in [minBC, maxBC] are then found with a binary search, instead of walking the table from a
+// starting BC. update() can be called for every collision, it only rebuilds the index when the table changed.
+class BCIndex
+{
+ public:
+  template <typename T>
+  void update(T const& bcs)
+  {
+    auto nBCs = bcs.size();
+    if (nBCs > 0 && (std::size_t)nBCs == fGlobalBCs.size() &&
+        bcs.iteratorAt(0).globalBC() == fGlobalBCs.front() &&
+        bcs.iteratorAt(nBCs - 1).globalBC() == fGlobalBCs.back()) {
+      return;
+    }
+    fGlobalBCs.clear();
+    fGlobalBCs.reserve(nBCs);
+    for (auto const& bc : bcs) {
+      fGlobalBCs.push_back(bc.globalBC());
+    }
+  }
+
+  // first row and number of rows with globalBC in [minBC, maxBC]
+  std::pair<int64_t, int64_t> range(uint64_t minBC, uint64_t maxBC) const
+  {
+    auto first = std::lower_bound(fGlobalBCs.begin(), fGlobalBCs.end(), minBC);
+    auto last = std::upper_bound(first, fGlobalBCs.end(), maxBC);
+    return {first - fGlobalBCs.begin(), last - first};
+  }
+
+ private:
+  std::vector<uint64_t> fGlobalBCs;
+};
+
+// -----------------------------------------------------------------------------
+// Same as compatibleBCs(bcIter, meanBC, deltaBC, bcs), with the slice found in the BC index of bcs.
+// An empty slice is returned if no BC is within meanBC +- deltaBC.
+template <typename T>
+T compatibleBCs(BCIndex const& bcIndex, uint64_t meanBC, int deltaBC, T const& bcs)
+{
+  uint64_t minBC = (uint64_t)deltaBC < meanBC ? meanBC - (uint64_t)deltaBC : 0;
+  uint64_t maxBC = meanBC + (uint64_t)deltaBC;
+  auto [minBCId, nBCs] = bcIndex.range(minBC, maxBC);
+  LOGF(debug, "  BC range: %i (%d) - %i (%d)", minBC, minBCId, maxBC, minBCId + nBCs - 1);
+
+  T slice{{bcs.asArrowTable()->Slice(minBCId, nBCs)}, (uint64_t)minBCId};
+  bcs.copyIndexBindings(slice);
+  return slice;
+}
+
+// -----------------------------------------------------------------------------
+// Same as compatibleBCs(collision, ndt, bcs, nMinBCs) and MCcompatibleBCs(collision, ndt, bcs, nMinBCs),
+// with the slice found in the BC index of bcs
+template <typename T, typename C>
+T compatibleBCs(C const& collision, int ndt, T const& bcs, BCIndex const& bcIndex, int nMinBCs = 7)
+{
+  // return if collisions has no associated BC
+  if (!collision.has_foundBC()) {
+    return T{{bcs.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
+  }
+
+  // due to the filling scheme the most probable BC may not be the one estimated from the collision time
+  uint64_t mostProbableBC = collision.template foundBC_as<T>().globalBC();
+  uint64_t meanBC = mostProbableBC + std::lround(collision.collisionTime() / o2::constants::lhc::LHCBunchSpacingNS);
+
+  // enforce minimum number for deltaBC
+  int deltaBC = std::ceil(collision.collisionTimeRes() / o2::constants::lhc::LHCBunchSpacingNS * ndt);
+  if (deltaBC < nMinBCs) {
+    deltaBC = nMinBCs;
+  }
+
+  return compatibleBCs(bcIndex, meanBC, deltaBC, bcs);
+}
+
 // -----------------------------------------------------------------------------
 // function to check if track provides good PID information
 // Checks the nSigma for any particle assumption to be within limits.
@@ -354,6 +432,50 @@ bool cleanFIT(T& bc, std::vector<float> lims)
 {
   return cleanFV0(bc, lims[0]) && cleanFT0(bc, lims[1], lims[2]) && cleanFDD(bc, lims[3], lims[4]);
 }
+
+// -----------------------------------------------------------------------------
+// summed FIT amplitudes of a BC
+struct FITAmplitudes {
+  bool hasFV0 = false;
+  bool hasFT0 = false;
+  bool hasFDD = false;
+  float fv0A = 0.;
+  float ft0A = 0.;
+  float ft0C = 0.;
+  float fddA = 0.;
+  float fddC = 0.;
+};
+
+template <typename T>
+FITAmplitudes fitAmplitudes(T& bc)
+{
+  FITAmplitudes amps;
+  if (bc.has_foundFV0()) {
+    amps.hasFV0 = true;
+    amps.fv0A = FV0AmplitudeA(bc.foundFV0());
+  }
+  if (bc.has_foundFT0()) {
+    amps.hasFT0 = true;
+    amps.ft0A = FT0AmplitudeA(bc.foundFT0());
+    amps.ft0C = FT0AmplitudeC(bc.foundFT0());
+  }
+  if (bc.has_foundFDD()) {
+    amps.hasFDD = true;
+    amps.fddA = FDDAmplitudeA(bc.foundFDD());
+    amps.fddC = FDDAmplitudeC(bc.foundFDD());
+  }
+  return amps;
+}
+
+// same as cleanFIT(bc, lims) with amplitudes computed with fitAmplitudes(bc)
+inline bool cleanFIT(FITAmplitudes const& amps, std::vector<float> const& lims)
+{
+  return (!amps.hasFV0 || amps.fv0A < lims[0]) &&
+         (!amps.hasFT0 || (amps.ft0A < lims[1] && amps.ft0C < lims[2])) &&
+         (!amps.hasFDD || (amps.fddA < lims[3] && amps.fddC < lims[4]));
+}
+
+// -----------------------------------------------------------------------------
 template <typename T>
 bool cleanFITCollision(T& col, std::vector<float> lims)
 {
@@ -44,37 +44,3 @@ void UPCCutparHolder::setRequireTOF(bool requireTOF) { fRequireTOF = requireTOF;
 void UPCCutparHolder::setRequireITSTPC(bool requireITSTPC) { fRequireITSTPC = requireITSTPC; }
 void UPCCutparHolder::setMaxNContrib(int maxNContrib) { fMaxNContrib = maxNContrib; }
 void UPCCutparHolder::setAmbigSwitch(int ambigSwitch) { fAmbigSwitch = ambigSwitch; }
-
-// getters
-bool UPCCutparHolder::getUseFwdCuts() const { return fUseFwdCuts; }
-int UPCCutparHolder::getTrackType() const { return fTrackType; }
-float UPCCutparHolder::getFwdPtLow() const { return fFwdPtLow; }
-float UPCCutparHolder::getFwdPtHigh() const { return fFwdPtHigh; }
-float UPCCutparHolder::getFwdEtaLow() const { return fFwdEtaLow; }
-float UPCCutparHolder::getFwdEtaHigh() const { return fFwdEtaHigh; }
-float UPCCutparHolder::getMuonRAtAbsorberEndLow() const { return fMuonRAtAbsorberEndLow; }
-float UPCCutparHolder::getMuonRAtAbsorberEndHigh() const { return fMuonRAtAbsorberEndHigh; }
-float UPCCutparHolder::getMuonPDcaHighFirst() const { return fMuonPDcaHighFirst; }
-float UPCCutparHolder::getMuonPDcaHighSecond() const { return fMuonPDcaHighSecond; }
-float UPCCutparHolder::getFwdChi2Low() const { return fFwdChi2Low; }
-float UPCCutparHolder::getFwdChi2High() const { return fFwdChi2High; }
-bool UPCCutparHolder::getUseBarCuts() const { return fUseBarCuts; }
-float UPCCutparHolder::getBarPtLow() const { return fBarPtLow; }
-float UPCCutparHolder::getBarPtHigh() const { return fBarPtHigh; }
-float UPCCutparHolder::getBarEtaLow() const { return fBarEtaLow; }
-float UPCCutparHolder::getBarEtaHigh() const { return fBarEtaHigh; }
-int UPCCutparHolder::getITSNClusLow() const { return fITSNClusLow; }
-int UPCCutparHolder::getITSNClusHigh() const { return fITSNClusHigh; }
-float UPCCutparHolder::getITSChi2Low() const { return fITSChi2Low; }
-float UPCCutparHolder::getITSChi2High() const { return fITSChi2High; }
-int UPCCutparHolder::getTPCNClusCRLow() const { return fTPCNClusCRLow; }
-int UPCCutparHolder::getTPCNClusCRHigh() const { return fTPCNClusCRHigh; }
-float UPCCutparHolder::getTPCChi2Low() const { return fTPCChi2Low; }
-float UPCCutparHolder::getTPCChi2High() const { return fTPCChi2High; }
-bool UPCCutparHolder::getCheckMaxDcaXY() const { return fCheckMaxDcaXY; }
-float UPCCutparHolder::getDcaZLow() const { return fDcaZLow; }
-float UPCCutparHolder::getDcaZHigh() const { return fDcaZHigh; }
-bool UPCCutparHolder::getRequireTOF() const { return fRequireTOF; }
-bool UPCCutparHolder::getRequireITSTPC() const { return fRequireITSTPC; }
-int UPCCutparHolder::getMaxNContrib() const { return fMaxNContrib; }
-int UPCCutparHolder::getAmbigSwitch() const { return fAmbigSwitch; }
@@ -119,39 +119,39 @@ class UPCCutparHolder
   void setMaxNContrib(int maxNContrib);
   void setAmbigSwitch(int ambigSwitch);
 
-  // getters
-  bool getUseFwdCuts() const;
-  int getTrackType() const;
-  float getFwdPtLow() const;
-  float getFwdPtHigh() const;
-  float getFwdEtaLow() const;
-  float getFwdEtaHigh() const;
-  float getMuonRAtAbsorberEndLow() const;
-  float getMuonRAtAbsorberEndHigh() const;
-  float getMuonPDcaHighFirst() const;
-  float getMuonPDcaHighSecond() const;
-  float getFwdChi2Low() const;
-  float getFwdChi2High() const;
-  bool getUseBarCuts() const;
-  float getBarPtLow() const;
-  float getBarPtHigh() const;
-  float getBarEtaLow() const;
-  float getBarEtaHigh() const;
-  int getITSNClusLow() const;
-  int getITSNClusHigh() const;
-  float getITSChi2Low() const;
-  float getITSChi2High() const;
-  int getTPCNClusCRLow() const;
-  int getTPCNClusCRHigh() const;
-  float getTPCChi2Low() const;
-  float getTPCChi2High() const;
-  bool getCheckMaxDcaXY() const;
-  float getDcaZLow() const;
-  float getDcaZHigh() const;
-  bool getRequireTOF() const;
-  bool getRequireITSTPC() const;
-  int getMaxNContrib() const;
-  int getAmbigSwitch() const;
+  // getters, inline for the per-track selections
+  bool getUseFwdCuts() const { return fUseFwdCuts; }
+  int getTrackType() const { return fTrackType; }
+  float getFwdPtLow() const { return fFwdPtLow; }
+  float getFwdPtHigh() const { return fFwdPtHigh; }
+  float getFwdEtaLow() const { return fFwdEtaLow; }
+  float getFwdEtaHigh() const { return fFwdEtaHigh; }
+  float getMuonRAtAbsorberEndLow() const { return fMuonRAtAbsorberEndLow; }
+  float getMuonRAtAbsorberEndHigh() const { return fMuonRAtAbsorberEndHigh; }
+  float getMuonPDcaHighFirst() const { return fMuonPDcaHighFirst; }
+  float getMuonPDcaHighSecond() const { return fMuonPDcaHighSecond; }
+  float getFwdChi2Low() const { return fFwdChi2Low; }
+  float getFwdChi2High() const { return fFwdChi2High; }
+  bool getUseBarCuts() const { return fUseBarCuts; }
+  float getBarPtLow() const { return fBarPtLow; }
+  float getBarPtHigh() const { return fBarPtHigh; }
+  float getBarEtaLow() const { return fBarEtaLow; }
+  float getBarEtaHigh() const { return fBarEtaHigh; }
+  int getITSNClusLow() const { return fITSNClusLow; }
+  int getITSNClusHigh() const { return fITSNClusHigh; }
+  float getITSChi2Low() const { return fITSChi2Low; }
+  float getITSChi2High() const { return fITSChi2High; }
+  int getTPCNClusCRLow() const { return fTPCNClusCRLow; }
+  int getTPCNClusCRHigh() const { return fTPCNClusCRHigh; }
+  float getTPCChi2Low() const { return fTPCChi2Low; }
+  float getTPCChi2High() const { return fTPCChi2High; }
+  bool getCheckMaxDcaXY() const { return fCheckMaxDcaXY; }
+  float getDcaZLow() const { return fDcaZLow; }
+  float getDcaZHigh() const { return fDcaZHigh; }
+  bool getRequireTOF() const { return fRequireTOF; }
+  bool getRequireITSTPC() const { return fRequireITSTPC; }
+  int getMaxNContrib() const { return fMaxNContrib; }
+  int getAmbigSwitch() const { return fAmbigSwitch; }
 
  private:
   bool fUseFwdCuts{true}; // Use cuts for forward tracks
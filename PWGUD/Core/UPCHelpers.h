@@ -89,7 +89,7 @@ struct FITInfo {
 };
 
 template <typename TSelectorsArray>
-void applyFwdCuts(UPCCutparHolder& upcCuts, const ForwardTracks::iterator& track, TSelectorsArray& fwdSelectors)
+void applyFwdCuts(UPCCutparHolder const& upcCuts, const ForwardTracks::iterator& track, TSelectorsArray& fwdSelectors)
 {
   fwdSelectors[kFwdSelPt] = track.pt() > upcCuts.getFwdPtLow() && track.pt() < upcCuts.getFwdPtHigh();                                                     // check pt
   fwdSelectors[kFwdSelEta] = track.eta() > upcCuts.getFwdEtaLow() && track.eta() < upcCuts.getFwdEtaHigh();                                                // check pseudorapidity
@@ -99,7 +99,7 @@ void applyFwdCuts(UPCCutparHolder& upcCuts, const ForwardTracks::iterator& track
 }
 
 template <typename TSelectorsArray>
-void applyBarrelCuts(UPCCutparHolder& upcCuts, const BarrelTracks::iterator& track, TSelectorsArray& barrelSelectors)
+void applyBarrelCuts(UPCCutparHolder const& upcCuts, const BarrelTracks::iterator& track, TSelectorsArray& barrelSelectors)
 {
   barrelSelectors[kBarrelSelHasTOF] = true;
   if (upcCuts.getRequireTOF())
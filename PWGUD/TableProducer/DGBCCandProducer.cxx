@@ -46,6 +46,49 @@ struct tracksWGTInBCs {
   Preslice<aod::AmbiguousTracks> perTrack = aod::ambiguous::trackId;
   Preslice<aod::AmbiguousFwdTracks> perFwdTrack = aod::ambiguous::fwdtrackId;
 
+  // tracks with good timing grouped by BC in compressed sparse row layout: the tracks of the BC
+  // bcsWithTracks[i] are trackIdsInBCs[offsets[i]] ... trackIdsInBCs[offsets[i + 1] - 1]
+  std::vector<std::pair<uint64_t, int32_t>> bcTrackPairs;
+  std::vector<uint64_t> bcsWithTracks;
+  std::vector<std::size_t> offsets;
+  std::vector<int32_t> trackIdsInBCs;
+  std::vector<int32_t> trackIdsInBC;
+
+  // groups bcTrackPairs by BC and fills one row per BC into table, with the index of the BC in bcs
+  // (-1 if the BC is not in bcs) found by a merge of the sorted BCs with the BCs table
+  template <typename T>
+  void fillTracksInBCs(BCs const& bcs, int rnum, T& table)
+  {
+    // sorting the pairs also keeps the tracks of a BC in increasing order of index
+    std::sort(bcTrackPairs.begin(), bcTrackPairs.end());
+    bcsWithTracks.clear();
+    offsets.clear();
+    trackIdsInBCs.clear();
+    trackIdsInBCs.reserve(bcTrackPairs.size());
+    for (auto const& [bcnum, trackId] : bcTrackPairs) {
+      if (bcsWithTracks.empty() || bcsWithTracks.back() != bcnum) {
+        bcsWithTracks.push_back(bcnum);
+        offsets.push_back(trackIdsInBCs.size());
+      }
+      trackIdsInBCs.push_back(trackId);
+    }
+    offsets.push_back(trackIdsInBCs.size());
+    bcTrackPairs.clear();
+
+    int64_t ind = 0;
+    int64_t nBCs = bcs.size();
+    for (std::size_t ibc = 0; ibc < bcsWithTracks.size(); ibc++) {
+      auto bcnum = bcsWithTracks[ibc];
+      while (ind < nBCs && bcs.rawIteratorAt(ind).globalBC() < bcnum) {
+        ind++;
+      }
+      int indBCToSave = (ind < nBCs && bcs.rawIteratorAt(ind).globalBC() == bcnum) ? ind : -1;
+      trackIdsInBC.assign(trackIdsInBCs.begin() + offsets[ibc], trackIdsInBCs.begin() + offsets[ibc + 1]);
+      table(indBCToSave, rnum, bcnum, trackIdsInBC);
+      LOGF(debug, " BC %i/%u with %i tracks with good timing", indBCToSave, bcnum, trackIdsInBC.size());
+    }
+  }
+
   void init(InitContext& context)
   {
     if (context.mOptions.get<bool>("processBarrel")) {
@@ -61,11 +104,12 @@ struct tracksWGTInBCs {
     // run number
     int rnum = bcs.iteratorAt(0).runNumber();
 
-    // container to sort tracks with good timing according to their matching/closest BC
-    std::map<uint64_t, std::vector<int32_t>> tracksInBCList{};
+    // (BC, track index) pairs of the tracks with good timing, with their matching/closest BC
+    bcTrackPairs.clear();
+    bcTrackPairs.reserve(tracks.size());
     uint64_t closestBC = 0;
 
-    // loop over all tracks and fill tracksInBCList
+    // loop over all tracks and fill bcTrackPairs
     for (auto const& track : tracks) {
       registry.get<TH1>(HIST("barrelTracks"))->Fill(0., 1.);
       auto ambTracksSlice = ambTracks.sliceBy(perTrack, track.globalIndex());
@@ -95,33 +139,13 @@ struct tracksWGTInBCs {
           closestBC = track.collision_as<CCs>().foundBC_as<BCs>().globalBC();
         }
 
-        // update tracksInBCList
-        tracksInBCList[closestBC].emplace_back((int32_t)track.globalIndex());
+        // update bcTrackPairs
+        bcTrackPairs.emplace_back(closestBC, (int32_t)track.globalIndex());
       }
     }
 
     // fill tracksWGTInBCs
-    int indBCToStart = 0;
-    int indBCToSave;
-    for (auto const& tracksInBC : tracksInBCList) {
-      indBCToSave = -1;
-      if (tracksInBC.second.size() > 0) {
-        // find corresponding BC
-        for (auto ind = indBCToStart; ind < bcs.size(); ind++) {
-          auto bc = bcs.rawIteratorAt(ind);
-          if (bc.globalBC() == tracksInBC.first) {
-            indBCToSave = ind;
-            indBCToStart = ind;
-            break;
-          }
-          if (bc.globalBC() > tracksInBC.first) {
-            break;
-          }
-        }
-        tracksWGTInBCs(indBCToSave, rnum, tracksInBC.first, tracksInBC.second);
-        LOGF(debug, " BC %i/%u with %i tracks with good timing", indBCToSave, tracksInBC.first, tracksInBC.second.size());
-      }
-    }
+    fillTracksInBCs(bcs, rnum, tracksWGTInBCs);
   }
   PROCESS_SWITCH(tracksWGTInBCs, processBarrel, "Process barrel tracks", true);
 
@@ -130,11 +154,12 @@ struct tracksWGTInBCs {
     // run number
     int rnum = bcs.iteratorAt(0).runNumber();
 
-    // container to sort forward tracks according to their matching/closest BC
-    std::map<uint64_t, std::vector<int32_t>> fwdTracksWGTInBCList{};
+    // (BC, forward track index) pairs of the forward tracks with good timing, with their matching/closest BC
+    bcTrackPairs.clear();
+    bcTrackPairs.reserve(fwdTracks.size());
     uint64_t closestBC = 0;
 
-    // loop over all forward tracks and fill fwdTracksWGTInBCList
+    // loop over all forward tracks and fill bcTrackPairs
     for (auto const& fwdTrack : fwdTracks) {
       registry.get<TH1>(HIST("forwardTracks"))->Fill(0., 1.);
       auto ambFwdTracksSlice = ambFwdTracks.sliceBy(perFwdTrack, fwdTrack.globalIndex());
@@ -165,33 +190,13 @@ struct tracksWGTInBCs {
           closestBC = fwdTrack.collision_as<CCs>().bc_as<BCs>().globalBC();
         }
 
-        // update tracksInBCList
-        fwdTracksWGTInBCList[closestBC].emplace_back((int32_t)fwdTrack.globalIndex());
+        // update bcTrackPairs
+        bcTrackPairs.emplace_back(closestBC, (int32_t)fwdTrack.globalIndex());
       }
     }
 
     // fill fwdTracksWGTInBCs
-    int indBCToStart = 0;
-    int indBCToSave;
-    for (auto const& fwdTracksWGTInBC : fwdTracksWGTInBCList) {
-      indBCToSave = -1;
-      if (fwdTracksWGTInBC.second.size() > 0) {
-        // find corresponding BC
-        for (auto ind = indBCToStart; ind < bcs.size(); ind++) {
-          auto bc = bcs.rawIteratorAt(ind);
-          if (bc.globalBC() == fwdTracksWGTInBC.first) {
-            indBCToSave = ind;
-            indBCToStart = ind;
-            break;
-          }
-          if (bc.globalBC() > fwdTracksWGTInBC.first) {
-            break;
-          }
-        }
-        fwdTracksWGTInBCs(indBCToSave, rnum, fwdTracksWGTInBC.first, fwdTracksWGTInBC.second);
-        LOGF(debug, " BC %i/%u with %i forward tracks with good timing", indBCToSave, fwdTracksWGTInBC.first, fwdTracksWGTInBC.second.size());
-      }
-    }
+    fillTracksInBCs(bcs, rnum, fwdTracksWGTInBCs);
   }
   PROCESS_SWITCH(tracksWGTInBCs, processForward, "Process forward tracks", true);
 };
@@ -211,10 +216,14 @@ struct DGBCCandProducer {
   // get a DGCutparHolder
   DGCutparHolder diffCuts = DGCutparHolder();
   Configurable<DGCutparHolder> DGCuts{"DGCuts", {}, "DG event cuts"};
+  DGResolvedCuts dgCuts; // diffCuts resolved at init, used in the loops
 
   // DG selector
   DGSelector dgSelector = DGSelector();
 
+  // global BCs of the BCs table, for the BC lookups
+  udhelpers::BCIndex bcIndex;
+
   HistogramRegistry registry{
     "registry",
     {}};
@@ -275,12 +284,11 @@ struct DGBCCandProducer {
     uint64_t minbc = bcnum > 15 ? bcnum - 15 : 0;
 
     // find bc with globalBC = bcnum
-    Partition<BCs> selbc = aod::bc::globalBC == bcnum;
-    selbc.bindTable(bcs);
+    auto [bcId, nSelBCs] = bcIndex.range(bcnum, bcnum);
 
     // if BC exists then update FIT information for this BC
-    if (selbc.size() > 0) {
-      auto bc = bcs.iteratorAt(selbc.begin().globalIndex());
+    if (nSelBCs > 0) {
+      auto bc = bcs.iteratorAt(bcId);
 
       // FT0
       if (bc.has_foundFT0()) {
@@ -330,10 +338,10 @@ struct DGBCCandProducer {
         info.triggerMaskFDD = fdd.triggerMask();
       }
 
-      auto bcrange = udhelpers::compatibleBCs(bc, bcnum, 15, bcs);
+      auto bcrange = udhelpers::compatibleBCs(bcIndex, bcnum, 15, bcs);
       fillBGBBFlags(info, minbc, bcrange);
     } else {
-      auto bcrange = udhelpers::compatibleBCs(bcnum, 15, bcs);
+      auto bcrange = udhelpers::compatibleBCs(bcIndex, bcnum, 15, bcs);
       fillBGBBFlags(info, minbc, bcrange);
     }
     return info;
@@ -406,6 +414,7 @@ struct DGBCCandProducer {
   void init(InitContext& context)
   {
     diffCuts = (DGCutparHolder)DGCuts;
+    dgCuts = DGResolvedCuts(diffCuts);
 
     if (context.mOptions.get<bool>("processData") || context.mOptions.get<bool>("processMC")) {
       registry.add("bcFlag", "#bcFlag", {HistType::kTH1F, {{64, -0.5, 63.5}}});
@@ -423,6 +432,7 @@ struct DGBCCandProducer {
                     aod::Zdcs const& zdcs, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
   {
     // fill FITInfo
+    bcIndex.update(bcs);
     auto bcnum = tibc.bcnum();
     upchelpers::FITInfo fitInfo = getFITinfo(bcnum, bcs, ft0s, fv0as, fdds);
 
@@ -447,8 +457,8 @@ struct DGBCCandProducer {
         auto col = colSlize.rawIteratorAt(0);
         auto colTracks = tracks.sliceBy(TCperCollision, col.globalIndex());
         auto colFwdTracks = fwdtracks.sliceBy(FWperCollision, col.globalIndex());
-        auto bcRange = udhelpers::compatibleBCs(col, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
-        isDG = dgSelector.IsSelected(diffCuts, col, bcRange, colTracks, colFwdTracks);
+        auto bcRange = udhelpers::compatibleBCs(col, dgCuts.nDtcoll, bcs, bcIndex, dgCuts.minNBCs);
+        isDG = dgSelector.IsSelected(dgCuts, col, bcRange, colTracks, colFwdTracks);
 
         // update UDTables
         if (isDG == 0) {
@@ -479,21 +489,21 @@ struct DGBCCandProducer {
       } else {
         LOGF(debug, "  2. BC has NO collision");
         auto tracksArray = tibc.track_as<TCs>();
-        auto bcRange = udhelpers::compatibleBCs(bc, bc.globalBC(), diffCuts.minNBCs(), bcs);
+        auto bcRange = udhelpers::compatibleBCs(bcIndex, bc.globalBC(), dgCuts.minNBCs, bcs);
 
         // does BC have fwdTracks?
         if (ftibcs.size() > 0) {
           auto ftibcSlice = ftibcs.sliceBy(FTIBCperBC, bc.globalIndex());
           if (ftibcSlice.size() > 0) {
             auto fwdTracksArray = ftibcSlice.begin().fwdtrack_as<FTCs>();
-            isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+            isDG = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
           } else {
             auto fwdTracksArray = FTCs{{fwdtracks.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
-            isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+            isDG = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
           }
         } else {
           auto fwdTracksArray = FTCs{{fwdtracks.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
-          isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
         }
 
         // update UDTables
@@ -526,7 +536,7 @@ struct DGBCCandProducer {
 
       // the BC is not contained in the BCs table
       auto tracksArray = tibc.track_as<TCs>();
-      auto bcRange = udhelpers::compatibleBCs(bcnum, diffCuts.minNBCs(), bcs);
+      auto bcRange = udhelpers::compatibleBCs(bcIndex, bcnum, dgCuts.minNBCs, bcs);
 
       // does BC have fwdTracks?
       if (ftibcs.size() > 0) {
@@ -535,14 +545,14 @@ struct DGBCCandProducer {
 
         if (ftibcPart.size() > 0) {
           auto fwdTracksArray = ftibcPart.begin().fwdtrack_as<FTCs>();
-          isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
         } else {
           auto fwdTracksArray = FTCs{{fwdtracks.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
-          isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
         }
       } else {
         auto fwdTracksArray = FTCs{{fwdtracks.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
-        isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+        isDG = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
       }
 
       // update UDTables
@@ -593,6 +603,7 @@ struct DGBCCandProducer {
     if (bcs.size() <= 0) {
       return;
     }
+    bcIndex.update(bcs);
 
     // run over globalBC [minGlobalBC, maxGlobalBC] ...
     uint64_t minGlobalBC = bcs.iteratorAt(0).globalBC();
@@ -630,8 +641,8 @@ struct DGBCCandProducer {
           ntr1 = col.numContrib();
           auto colTracks = tracks.sliceBy(TCperCollision, col.globalIndex());
           auto colFwdTracks = fwdtracks.sliceBy(FWperCollision, col.globalIndex());
-          auto bcRange = udhelpers::compatibleBCs(col, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
-          isDG1 = dgSelector.IsSelected(diffCuts, col, bcRange, colTracks, colFwdTracks);
+          auto bcRange = udhelpers::compatibleBCs(col, dgCuts.nDtcoll, bcs, bcIndex, dgCuts.minNBCs);
+          isDG1 = dgSelector.IsSelected(dgCuts, col, bcRange, colTracks, colFwdTracks);
           if (isDG1 == 0) {
             // this is a DG candidate with proper collision vertex
             SETBIT(bcFlag, 3);
@@ -653,7 +664,7 @@ struct DGBCCandProducer {
       if (tibc.bcnum() == bcnum) {
         SETBIT(bcFlag, 4);
 
-        auto bcRange = udhelpers::compatibleBCs(bc, bcnum, diffCuts.minNBCs(), bcs);
+        auto bcRange = udhelpers::compatibleBCs(bcIndex, bcnum, dgCuts.minNBCs, bcs);
         auto tracksArray = tibc.track_as<TCs>();
         ntr2 = tracksArray.size();
 
@@ -663,10 +674,10 @@ struct DGBCCandProducer {
         }
         if (ftibc.bcnum() == bcnum) {
           auto fwdTracksArray = ftibc.fwdtrack_as<FTCs>();
-          isDG2 = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG2 = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
         } else {
           auto fwdTracksArray = FTCs{{fwdtracks.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
-          isDG2 = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG2 = dgSelector.IsSelected(dgCuts, bcRange, tracksArray, fwdTracksArray);
         }
         if (isDG2 == 0) {
           // this is a DG candidate with tracks-in-BC
@@ -38,6 +38,7 @@
 //           o2-analysis-multiplicity-table $copts |
 //           o2-analysis-ft0-corrected-table $copts |
 //           o2-analysis-event-selection $copts |
+//           o2-analysis-bc-fit-activity $copts |
 //           o2-analysis-trackextension $copts |
 //           o2-analysis-trackselection $copts |
 //           o2-analysis-pid-tpc-full $copts |
@@ -50,6 +51,7 @@
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
+#include "Common/DataModel/BcFITActivity.h"
 #include "PWGUD/DataModel/UDTables.h"
 #include "PWGUD/Core/UPCHelpers.h"
 #include "PWGUD/Core/DGSelector.h"
@@ -63,13 +65,18 @@ struct DGCandProducer {
   // get a DGCutparHolder
   DGCutparHolder diffCuts = DGCutparHolder();
   Configurable<DGCutparHolder> DGCuts{"DGCuts", {}, "DG event cuts"};
+  DGResolvedCuts dgCuts; // diffCuts resolved at init, used in the loops
 
   // DG selector
   DGSelector dgSelector;
 
+  // global BCs of the BCs table, for the BC lookups
+  udhelpers::BCIndex bcIndex;
+
   void init(InitContext&)
   {
     diffCuts = (DGCutparHolder)DGCuts;
+    dgCuts = DGResolvedCuts(diffCuts);
   }
 
   // data tables
@@ -90,7 +97,7 @@ struct DGCandProducer {
   // data inputs
   using CCs = soa::Join<aod::Collisions, aod::EvSels>;
   using CC = CCs::iterator;
-  using BCs = soa::Join<aod::BCsWithTimestamps, aod::BcSels, aod::Run3MatchedToBCSparse>;
+  using BCs = soa::Join<aod::BCsWithTimestamps, aod::BcSels, aod::Run3MatchedToBCSparse, aod::BcFITActivities>;
   using BC = BCs::iterator;
   using TCs = soa::Join<aod::Tracks, /*aod::TracksCov,*/ aod::TracksExtra, aod::TracksDCA, aod::TrackSelection,
                         aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
@@ -107,102 +114,71 @@ struct DGCandProducer {
   using MCTC = MCTCs::iterator;
 
   // extract FIT information
-  upchelpers::FITInfo getFITinfo(uint64_t const& bcnum, BCs const& bcs, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
+  upchelpers::FITInfo getFITinfo(BC const& bc, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
   {
     // FITinfo
     upchelpers::FITInfo info{};
 
-    // find bc with globalBC = bcnum
-    Partition<BCs> selbc = aod::bc::globalBC == bcnum;
-    selbc.bindTable(bcs);
-
-    // if BC exists then update FIT information for this BC
-    if (selbc.size() > 0) {
-      auto bc = selbc.begin();
-
-      // FT0
-      if (bc.has_foundFT0()) {
-        auto ft0 = ft0s.iteratorAt(bc.foundFT0Id());
-        info.timeFT0A = ft0.timeA();
-        info.timeFT0C = ft0.timeC();
-        const auto& ampsA = ft0.amplitudeA();
-        const auto& ampsC = ft0.amplitudeC();
-        info.ampFT0A = 0.;
-        for (auto amp : ampsA) {
-          info.ampFT0A += amp;
-        }
-        info.ampFT0C = 0.;
-        for (auto amp : ampsC) {
-          info.ampFT0C += amp;
-        }
-        info.triggerMaskFT0 = ft0.triggerMask();
+    // FT0
+    if (bc.has_foundFT0()) {
+      auto ft0 = ft0s.iteratorAt(bc.foundFT0Id());
+      info.timeFT0A = ft0.timeA();
+      info.timeFT0C = ft0.timeC();
+      const auto& ampsA = ft0.amplitudeA();
+      const auto& ampsC = ft0.amplitudeC();
+      info.ampFT0A = 0.;
+      for (auto amp : ampsA) {
+        info.ampFT0A += amp;
       }
-
-      // FV0A
-      if (bc.has_foundFV0()) {
-        auto fv0a = fv0as.iteratorAt(bc.foundFV0Id());
-        info.timeFV0A = fv0a.time();
-        const auto& amps = fv0a.amplitude();
-        info.ampFV0A = 0.;
-        for (auto amp : amps) {
-          info.ampFV0A += amp;
-        }
-        info.triggerMaskFV0A = fv0a.triggerMask();
+      info.ampFT0C = 0.;
+      for (auto amp : ampsC) {
+        info.ampFT0C += amp;
       }
+      info.triggerMaskFT0 = ft0.triggerMask();
+    }
 
-      // FDD
-      if (bc.has_foundFDD()) {
-        auto fdd = fdds.iteratorAt(bc.foundFDDId());
-        info.timeFDDA = fdd.timeA();
-        info.timeFDDC = fdd.timeC();
-        const auto& ampsA = fdd.chargeA();
-        const auto& ampsC = fdd.chargeC();
-        info.ampFDDA = 0.;
-        for (auto amp : ampsA) {
-          info.ampFDDA += amp;
-        }
-        info.ampFDDC = 0.;
-        for (auto amp : ampsC) {
-          info.ampFDDC += amp;
-        }
-        info.triggerMaskFDD = fdd.triggerMask();
+    // FV0A
+    if (bc.has_foundFV0()) {
+      auto fv0a = fv0as.iteratorAt(bc.foundFV0Id());
+      info.timeFV0A = fv0a.time();
+      const auto& amps = fv0a.amplitude();
+      info.ampFV0A = 0.;
+      for (auto amp : amps) {
+        info.ampFV0A += amp;
       }
+      info.triggerMaskFV0A = fv0a.triggerMask();
     }
 
-    // fill BG and BB flags in adjacent BCs [-15, 15]
-    // compute range to check
-    auto minbc = bcnum - 15;
-    auto maxbc = bcnum + 15;
-    Partition<BCs> bcrange = aod::bc::globalBC >= minbc && aod::bc::globalBC <= maxbc;
-    bcrange.bindTable(bcs);
-
-    // loop over bcrange and check
-    for (auto const& bc2u : bcrange) {
-
-      // 0 <= bit <= 31
-      auto bit = bc2u.globalBC() - minbc;
-      if (!bc2u.selection()[evsel::kNoBGT0A])
-        SETBIT(info.BGFT0Apf, bit);
-      if (!bc2u.selection()[evsel::kNoBGT0C])
-        SETBIT(info.BGFT0Cpf, bit);
-      if (bc2u.selection()[evsel::kIsBBT0A])
-        SETBIT(info.BBFT0Apf, bit);
-      if (bc2u.selection()[evsel::kIsBBT0C])
-        SETBIT(info.BBFT0Cpf, bit);
-      if (!bc2u.selection()[evsel::kNoBGV0A])
-        SETBIT(info.BGFV0Apf, bit);
-      if (bc2u.selection()[evsel::kIsBBV0A])
-        SETBIT(info.BBFV0Apf, bit);
-      if (!bc2u.selection()[evsel::kNoBGFDA])
-        SETBIT(info.BGFDDApf, bit);
-      if (!bc2u.selection()[evsel::kNoBGFDC])
-        SETBIT(info.BGFDDCpf, bit);
-      if (bc2u.selection()[evsel::kIsBBFDA])
-        SETBIT(info.BBFDDApf, bit);
-      if (bc2u.selection()[evsel::kIsBBFDC])
-        SETBIT(info.BBFDDCpf, bit);
+    // FDD
+    if (bc.has_foundFDD()) {
+      auto fdd = fdds.iteratorAt(bc.foundFDDId());
+      info.timeFDDA = fdd.timeA();
+      info.timeFDDC = fdd.timeC();
+      const auto& ampsA = fdd.chargeA();
+      const auto& ampsC = fdd.chargeC();
+      info.ampFDDA = 0.;
+      for (auto amp : ampsA) {
+        info.ampFDDA += amp;
+      }
+      info.ampFDDC = 0.;
+      for (auto amp : ampsC) {
+        info.ampFDDC += amp;
+      }
+      info.triggerMaskFDD = fdd.triggerMask();
     }
 
+    // BG and BB flags in adjacent BCs [-15, 15], from the bc-fit-activity task
+    info.BBFT0Apf = bc.bbFT0Apf();
+    info.BBFT0Cpf = bc.bbFT0Cpf();
+    info.BGFT0Apf = bc.bgFT0Apf();
+    info.BGFT0Cpf = bc.bgFT0Cpf();
+    info.BBFV0Apf = bc.bbFV0Apf();
+    info.BGFV0Apf = bc.bgFV0Apf();
+    info.BBFDDApf = bc.bbFDDApf();
+    info.BBFDDCpf = bc.bbFDDCpf();
+    info.BGFDDApf = bc.bgFDDApf();
+    info.BGFDDCpf = bc.bgFDDCpf();
+
     return info;
   }
 
@@ -324,17 +300,18 @@ struct DGCandProducer {
     auto bc = collision.bc_as<BCs>();
 
     // obtain slice of compatible BCs
-    auto bcRange = udhelpers::compatibleBCs(collision, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
+    bcIndex.update(bcs);
+    auto bcRange = udhelpers::compatibleBCs(collision, dgCuts.nDtcoll, bcs, bcIndex, dgCuts.minNBCs);
 
     // apply DG selection
-    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks);
+    auto isDGEvent = dgSelector.IsSelected(dgCuts, collision, bcRange, tracks, fwdtracks);
 
     // save DG candidates
     if (isDGEvent == 0) {
       LOGF(debug, "  Data: good collision!");
 
       // fill FITInfo
-      upchelpers::FITInfo fitInfo = getFITinfo(bc.globalBC(), bcs, ft0s, fv0as, fdds);
+      upchelpers::FITInfo fitInfo = getFITinfo(bc, ft0s, fv0as, fdds);
 
       // update DG candidates tables
       auto rtrwTOF = udhelpers::rPVtrwTOF<true>(tracks, collision.numContrib());
@@ -421,10 +398,11 @@ struct DGCandProducer {
 
       // is this a collision to be saved?
       // obtain slice of compatible BCs
-      auto bcRange = udhelpers::MCcompatibleBCs(collision, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
+      bcIndex.update(bcs);
+      auto bcRange = udhelpers::compatibleBCs(collision, dgCuts.nDtcoll, bcs, bcIndex, dgCuts.minNBCs);
 
       // apply DG selection
-      auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, collisionTracks, collisionFwdTracks);
+      auto isDGEvent = dgSelector.IsSelected(dgCuts, collision, bcRange, collisionTracks, collisionFwdTracks);
       LOGF(debug, "  isDG %i", (int)isDGEvent);
 
       // save information of DG events
@@ -13,6 +13,7 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Common/CCDB/EventSelectionParams.h"
+#include "Common/Core/DataFrameArena.h"
 #include "Common/DataModel/EventSelection.h"
 #include "CommonConstants/LHCConstants.h"
 #include "PWGUD/Core/UPCCutparHolder.h"
@@ -152,6 +153,9 @@ struct UpcCandProducer {
   std::map<int32_t, int32_t> fNewPartIDs;
   uint64_t fMaxBC{0}; // max BC for ITS-TPC search
 
+  // memory of the temporary track ID vectors of a process call, released at once at the next call
+  o2::analysis::DataFrameArena fArena;
+
   Produces<o2::aod::UDMcCollisions> udMCCollisions;
   Produces<o2::aod::UDMcParticles> udMCParticles;
 
@@ -199,7 +203,10 @@ struct UpcCandProducer {
                                      o2::aod::pidTPCFullEl, o2::aod::pidTPCFullMu, o2::aod::pidTPCFullPi, o2::aod::pidTPCFullKa, o2::aod::pidTPCFullPr,
                                      o2::aod::TOFSignal, o2::aod::pidTOFFullEl, o2::aod::pidTOFFullMu, o2::aod::pidTOFFullPi, o2::aod::pidTOFFullKa, o2::aod::pidTOFFullPr>;
 
-  typedef std::pair<uint64_t, std::vector<int64_t>> BCTracksPair;
+  using TrackIDs = o2::analysis::ArenaVector<int64_t>;
+  typedef std::pair<uint64_t, TrackIDs> BCTracksPair;
+  using BCTracksPairs = o2::analysis::ArenaVector<BCTracksPair>;
+  using BCTrackIDPairs = o2::analysis::ArenaVector<std::pair<uint64_t, int64_t>>;
 
   void init(InitContext&)
   {
@@ -330,6 +337,7 @@ struct UpcCandProducer {
     }
 
     // storing MC particles
+    std::vector<int32_t> newMotherIDs;
     for (const auto& item : fNewPartIDs) {
       int32_t mcPartID = item.first;
       const auto& mcPart = mcParticles.iteratorAt(mcPartID);
@@ -337,8 +345,7 @@ struct UpcCandProducer {
       int32_t newEventID = newEventIDs[mcEventID];
       // collecting new mother IDs
       const auto& motherIDs = mcPart.mothersIds();
-      std::vector<int32_t> newMotherIDs;
-      newMotherIDs.reserve(motherIDs.size());
+      newMotherIDs.clear();
       for (auto motherID : motherIDs) {
         if (motherID >= nMCParticles) {
           continue;
@@ -405,7 +412,7 @@ struct UpcCandProducer {
   }
 
   void fillFwdTracks(ForwardTracks const& tracks,
-                     std::vector<int64_t> const& trackIDs,
+                     TrackIDs const& trackIDs,
                      int32_t candID,
                      uint64_t bc,
                      const o2::aod::McFwdTrackLabels* mcTrackLabels)
@@ -430,7 +437,7 @@ struct UpcCandProducer {
   }
 
   void fillBarrelTracks(BarrelTracks const& tracks,
-                        std::vector<int64_t> const& trackIDs,
+                        TrackIDs const& trackIDs,
                         int32_t candID,
                         uint64_t bc,
                         const o2::aod::McTrackLabels* mcTrackLabels,
@@ -488,9 +495,12 @@ struct UpcCandProducer {
     return hasNoFT0;
   }
 
+  // the candidates are processed in increasing BC order: the position of the first BC with FIT info
+  // in the window of the previous candidate is kept in firstBC, and only moved forward
   void processFITInfo(upchelpers::FITInfo& fitInfo,
                       uint64_t midbc,
                       std::vector<std::pair<uint64_t, int64_t>>& v,
+                      std::size_t& firstBC,
                       BCsWithBcSels const& bcs,
                       o2::aod::FT0s const& ft0s,
                       o2::aod::FDDs const& fdds,
@@ -500,9 +510,9 @@ struct UpcCandProducer {
     uint64_t left = midbc >= range ? midbc - range : 0;
     uint64_t right = fMaxBC >= midbc + range ? midbc + range : fMaxBC;
 
-    std::pair<uint64_t, int64_t> dummyPair(left, 0);
-    auto curit = std::lower_bound(v.begin(), v.end(), dummyPair,
-                                  [](const std::pair<uint64_t, int64_t>& left, const std::pair<uint64_t, int64_t>& right) { return left.first < right.first; });
+    while (firstBC < v.size() && v[firstBC].first < left)
+      ++firstBC;
+    auto curit = v.begin() + firstBC;
 
     if (curit == v.end()) // no BCs with FT0 info at all
       return;
@@ -601,24 +611,38 @@ struct UpcCandProducer {
     }
   }
 
-  void addTrack(std::vector<BCTracksPair>& v, uint64_t bc, int64_t trkId)
+  // groups the (BC, track ID) pairs by BC: the pairs are sorted by BC, keeping the order
+  // of the tracks within a BC, and each run of equal BCs becomes one entry of v, in increasing BC order
+  void groupTracksByBC(BCTrackIDPairs& bcTrIds, BCTracksPairs& v)
   {
-    auto it = std::find_if(v.begin(), v.end(),
-                           [bc](const BCTracksPair& element) { return element.first == bc; });
-    if (it != v.end())
-      it->second.push_back(trkId);
-    else
-      v.emplace_back(std::make_pair(bc, std::vector<int64_t>({trkId})));
+    std::stable_sort(bcTrIds.begin(), bcTrIds.end(),
+                     [](const auto& left, const auto& right) { return left.first < right.first; });
+    for (std::size_t i = 0; i < bcTrIds.size();) {
+      uint64_t bc = bcTrIds[i].first;
+      std::size_t j = i;
+      while (j < bcTrIds.size() && bcTrIds[j].first == bc)
+        ++j;
+      TrackIDs trkIds(fArena);
+      trkIds.reserve(j - i);
+      for (std::size_t k = i; k < j; ++k)
+        trkIds.push_back(bcTrIds[k].second);
+      v.emplace_back(bc, std::move(trkIds));
+      i = j;
+    }
+    bcTrIds.clear();
   }
 
-  void collectBarrelTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsTOF,
-                           std::vector<BCTracksPair>& bcsMatchedTrIdsITSTPC,
+  void collectBarrelTracks(BCTracksPairs& bcsMatchedTrIdsTOF,
+                           BCTracksPairs& bcsMatchedTrIdsITSTPC,
                            BCsWithBcSels const& bcs,
                            o2::aod::Collisions const& collisions,
                            BarrelTracks const& barrelTracks,
                            o2::aod::AmbiguousTracks const& ambBarrelTracks,
                            std::unordered_map<int64_t, int64_t>& ambBarrelTrIds)
   {
+    // (BC, track ID) pairs, grouped by BC after the loop over the tracks
+    BCTrackIDPairs bcTrIdsTOF(fArena);
+    BCTrackIDPairs bcTrIdsITSTPC(fArena);
     for (const auto& trk : barrelTracks) {
       if (!applyBarCuts(trk))
         continue;
@@ -636,21 +660,25 @@ struct UpcCandProducer {
       if (bc > fMaxBC)
         continue;
       if (!upcCuts.getRequireITSTPC() && trk.hasTOF() && nContrib <= upcCuts.getMaxNContrib())
-        addTrack(bcsMatchedTrIdsTOF, bc, trkId);
+        bcTrIdsTOF.emplace_back(bc, trkId);
       if (upcCuts.getRequireITSTPC() && trk.hasTOF() && trk.hasITS() && trk.hasTPC() && nContrib <= upcCuts.getMaxNContrib())
-        addTrack(bcsMatchedTrIdsTOF, bc, trkId);
+        bcTrIdsTOF.emplace_back(bc, trkId);
       if (fSearchITSTPC == 1 && !trk.hasTOF() && trk.hasITS() && trk.hasTPC())
-        addTrack(bcsMatchedTrIdsITSTPC, bc, trkId);
+        bcTrIdsITSTPC.emplace_back(bc, trkId);
     }
+    groupTracksByBC(bcTrIdsTOF, bcsMatchedTrIdsTOF);
+    groupTracksByBC(bcTrIdsITSTPC, bcsMatchedTrIdsITSTPC);
   }
 
-  void collectForwardTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsMID,
+  void collectForwardTracks(BCTracksPairs& bcsMatchedTrIdsMID,
                             BCsWithBcSels const& bcs,
                             o2::aod::Collisions const& collisions,
                             ForwardTracks const& fwdTracks,
                             o2::aod::AmbiguousFwdTracks const& ambFwdTracks,
                             std::unordered_map<int64_t, int64_t>& ambFwdTrIds)
   {
+    // (BC, track ID) pairs, grouped by BC after the loop over the tracks
+    BCTrackIDPairs bcTrIdsMID(fArena);
     for (const auto& trk : fwdTracks) {
       if (!applyFwdCuts(trk))
         continue;
@@ -669,20 +697,20 @@ struct UpcCandProducer {
         continue;
       auto trkType = trk.trackType();
       if (trkType == o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack && nContrib <= upcCuts.getMaxNContrib())
-        addTrack(bcsMatchedTrIdsMID, bc, trkId);
+        bcTrIdsMID.emplace_back(bc, trkId);
     }
+    groupTracksByBC(bcTrIdsMID, bcsMatchedTrIdsMID);
   }
 
   int32_t searchTracks(uint64_t midbc, uint64_t range, uint32_t tracksToFind,
                        std::vector<int64_t>& tracks,
-                       std::vector<BCTracksPair>& v)
+                       BCTracksPairs& v)
   {
     uint32_t count = 0;
     uint64_t left = midbc >= range ? midbc - range : 0;
     uint64_t right = fMaxBC >= midbc + range ? midbc + range : fMaxBC;
-    BCTracksPair dummyPair(left, {});
-    auto curit = std::lower_bound(v.begin(), v.end(), dummyPair,
-                                  [](const BCTracksPair& left, const BCTracksPair& right) { return left.first < right.first; });
+    auto curit = std::lower_bound(v.begin(), v.end(), left,
+                                  [](const BCTracksPair& pair, uint64_t bc) { return pair.first < bc; });
     if (curit == v.end()) // no ITS-TPC tracks nearby at all -> near last BCs
       return -1;
     uint64_t curbc = curit->first;
@@ -713,11 +741,12 @@ struct UpcCandProducer {
                                o2::aod::FV0As const& fv0as,
                                const o2::aod::McTrackLabels* mcBarrelTrackLabels)
   {
+    fArena.reset(); // the temporaries of the previous call are out of scope
     fMaxBC = bcs.iteratorAt(bcs.size() - 1).globalBC(); // restrict ITS-TPC track search to [0, fMaxBC]
 
     // pairs of global BCs and vectors of matched track IDs:
-    std::vector<BCTracksPair> bcsMatchedTrIdsTOF;
-    std::vector<BCTracksPair> bcsMatchedTrIdsITSTPC;
+    BCTracksPairs bcsMatchedTrIdsTOF(fArena);
+    BCTracksPairs bcsMatchedTrIdsITSTPC(fArena);
 
     // trackID -> index in amb. track table
     std::unordered_map<int64_t, int64_t> ambBarrelTrIds;
@@ -727,13 +756,9 @@ struct UpcCandProducer {
                         bcs, collisions,
                         barrelTracks, ambBarrelTracks, ambBarrelTrIds);
 
+    // the collected BCs are sorted
     uint32_t nBCsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
 
-    std::sort(bcsMatchedTrIdsTOF.begin(), bcsMatchedTrIdsTOF.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
     if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
       for (auto& pair : bcsMatchedTrIdsTOF) {
         uint64_t bc = pair.first;
@@ -780,6 +805,7 @@ struct UpcCandProducer {
 
     // storing n-prong matches
     int32_t candID = 0;
+    std::size_t firstFITBC = 0;
     for (const auto& item : bcsMatchedTrIdsTOF) {
       auto& barrelTrackIDs = item.second;
       uint16_t numContrib = barrelTrackIDs.size();
@@ -790,7 +816,7 @@ struct UpcCandProducer {
       // if there is no relevant signal, dummy info will be used
       uint64_t bc = item.first;
       upchelpers::FITInfo fitInfo{};
-      processFITInfo(fitInfo, bc, indexBCglId, bcs, ft0s, fdds, fv0as);
+      processFITInfo(fitInfo, bc, indexBCglId, firstFITBC, bcs, ft0s, fdds, fv0as);
       if (fFilterFT0) {
         if (!checkFT0(fitInfo, true))
           continue;
@@ -834,12 +860,13 @@ struct UpcCandProducer {
                                const o2::aod::McTrackLabels* mcBarrelTrackLabels,
                                const o2::aod::McFwdTrackLabels* mcFwdTrackLabels)
   {
+    fArena.reset(); // the temporaries of the previous call are out of scope
     fMaxBC = bcs.iteratorAt(bcs.size() - 1).globalBC(); // restrict ITS-TPC track search to [0, fMaxBC]
 
     // pairs of global BCs and vectors of matched track IDs:
-    std::vector<BCTracksPair> bcsMatchedTrIdsTOF;
-    std::vector<BCTracksPair> bcsMatchedTrIdsITSTPC;
-    std::vector<BCTracksPair> bcsMatchedTrIdsMID;
+    BCTracksPairs bcsMatchedTrIdsTOF(fArena);
+    BCTracksPairs bcsMatchedTrIdsITSTPC(fArena);
+    BCTracksPairs bcsMatchedTrIdsMID(fArena);
 
     // trackID -> index in amb. track table
     std::unordered_map<int64_t, int64_t> ambBarrelTrIds;
@@ -865,7 +892,7 @@ struct UpcCandProducer {
       bcsWithMID.insert(pair.first);
     }
 
-    std::vector<BCTracksPair> bcsMatchedTrIdsTOFTagged;
+    BCTracksPairs bcsMatchedTrIdsTOFTagged(fArena);
     bcsMatchedTrIdsTOFTagged.reserve(nBCsWithMID);
     for (const auto& pair : bcsMatchedTrIdsTOF) {
       if (bcsWithMID.find(pair.first) != bcsWithMID.end())
@@ -875,12 +902,7 @@ struct UpcCandProducer {
     bcsWithMID.clear();
     bcsMatchedTrIdsTOF.clear();
 
-    std::sort(bcsMatchedTrIdsTOFTagged.begin(), bcsMatchedTrIdsTOFTagged.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-    std::sort(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
+    // the collected BCs are sorted, and so are the tagged ones
 
     if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
       for (uint32_t ibc = 0; ibc < nBCsWithMID; ++ibc) {
@@ -932,6 +954,7 @@ struct UpcCandProducer {
 
     // storing n-prong matches
     int32_t candID = 0;
+    std::size_t firstFITBC = 0;
     for (uint32_t ibc = 0; ibc < nBCsWithMID; ++ibc) {
       auto& pairMID = bcsMatchedTrIdsMID[ibc];
       auto& pairTOF = bcsMatchedTrIdsTOFTagged[ibc];
@@ -947,7 +970,7 @@ struct UpcCandProducer {
       // if there is no relevant signal, dummy info will be used
       uint64_t bc = pairMID.first;
       upchelpers::FITInfo fitInfo{};
-      processFITInfo(fitInfo, bc, indexBCglId, bcs, ft0s, fdds, fv0as);
+      processFITInfo(fitInfo, bc, indexBCglId, firstFITBC, bcs, ft0s, fdds, fv0as);
       if (fFilterFT0) {
         if (!checkFT0(fitInfo, false))
           continue;
@@ -92,7 +92,7 @@ struct DGCandAnalyzer {
       {"nSigmaTPCPtPr", "#nSigmaTPCPtPr", {HistType::kTH2F, {{250, 0.0, 2.5}, {100, -20.0, 20.0}}}},
     }};
 
-  void fillSignalHists(DGParticle ivm, UDTracksFull dgtracks, DGPIDSelector pidsel)
+  void fillSignalHists(DGParticle const& ivm, UDTracksFull const& dgtracks, DGPIDSelector const& pidsel)
   {
     // process only events with 2 tracks
     if (ivm.trkinds().size() != 2) {
@@ -213,7 +213,7 @@ struct DGCandAnalyzer {
 
     // update histograms
     registry.get<TH1>(HIST("nIVMs"))->Fill(nIVMs, 1.);
-    for (auto ivm : pidsel.IVMs()) {
+    for (auto const& ivm : pidsel.IVMs()) {
 
       registry.get<TH2>(HIST("IVMptSysDG"))->Fill(ivm.M(), ivm.Perp());
       for (auto ind : ivm.trkinds()) {
@@ -16,6 +16,9 @@
 
 #include "TLorentzVector.h"
 
+#include <array>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -52,6 +55,11 @@ struct UpcCandAnalyzer {
     kNSelectors
   };
 
+  using SelFlags = std::array<bool, kNSelectors>;
+
+  // IDs of the two tracks of each candidate, reused for all the dataframes
+  std::vector<std::array<int32_t, 2>> fTracksPerCand;
+
   std::vector<std::vector<std::vector<float>>> fMeansSigmas;
 
   Configurable<int32_t> fPrimaryPdg{"primaryPdg", 13, "Set 'primary' PDG code: e.g. 15 for ditau production"};
@@ -271,7 +279,7 @@ struct UpcCandAnalyzer {
     return pass;
   }
 
-  void fillMassDistr(float m, float mmc, std::unordered_map<int32_t, bool>& selFlags)
+  void fillMassDistr(float m, float mmc, SelFlags const& selFlags)
   {
     if (mmc < 0) { // just fill reco mass, if not using MC
       mmc = m;
@@ -322,7 +330,7 @@ struct UpcCandAnalyzer {
     }
   }
 
-  void fillPtDistr(float pt, float ptmc, std::unordered_map<int32_t, bool>& selFlags)
+  void fillPtDistr(float pt, float ptmc, SelFlags const& selFlags)
   {
     if (ptmc < 0) { // just fill reco pt, if not using MC
       ptmc = pt;
@@ -393,7 +401,7 @@ struct UpcCandAnalyzer {
   void processCandidate(Candidates::iterator const& cand, TTrack1& tr1, TTrack2& tr2,
                         o2::aod::UDMcParticles* mcParticles, o2::aod::UDMcTrackLabels* mcTrackLabels, o2::aod::UDMcFwdTrackLabels* mcFwdTrackLabels)
   {
-    std::unordered_map<int32_t, bool> selFlags; // holder of selection flags
+    SelFlags selFlags{}; // holder of selection flags
     float mmc = -1;
     float pt1mc = -1;
     float pt2mc = -1;
@@ -563,18 +571,29 @@ struct UpcCandAnalyzer {
     }
   }
 
+  // the first two tracks of each candidate are kept, in the order of the calls
   template <typename TTracks>
-  void collectCandIDs(std::unordered_map<int32_t, std::vector<int32_t>>& tracksPerCand, TTracks& tracks)
+  void collectCandIDs(TTracks& tracks)
   {
     for (const auto& tr : tracks) {
       int32_t candId = tr.udCollisionId();
       if (candId < 0) {
         continue;
       }
-      tracksPerCand[candId].push_back(tr.globalIndex());
+      auto& ids = fTracksPerCand[candId];
+      if (ids[0] < 0) {
+        ids[0] = tr.globalIndex();
+      } else if (ids[1] < 0) {
+        ids[1] = tr.globalIndex();
+      }
     }
   }
 
+  void resetCandIDs(Candidates const& eventCandidates)
+  {
+    fTracksPerCand.assign(eventCandidates.size(), {-1, -1});
+  }
+
   // process candidates with 2 muon tracks
   void processFwdMC(Candidates const& eventCandidates,
                     FwdTracks const& fwdTracks,
@@ -586,14 +605,16 @@ struct UpcCandAnalyzer {
 
     processMCParts(mcCollisions, mcParticles);
 
-    std::unordered_map<int32_t, std::vector<int32_t>> tracksPerCand;
-    collectCandIDs(tracksPerCand, fwdTracks);
+    resetCandIDs(eventCandidates);
+    collectCandIDs(fwdTracks);
 
     // assuming that candidates have exatly 2 muon tracks and 0 barrel tracks
-    for (const auto& item : tracksPerCand) {
-      int32_t trId1 = item.second[0];
-      int32_t trId2 = item.second[1];
-      int32_t candID = item.first;
+    for (int32_t candID = 0; candID < static_cast<int32_t>(fTracksPerCand.size()); candID++) {
+      int32_t trId1 = fTracksPerCand[candID][0];
+      int32_t trId2 = fTracksPerCand[candID][1];
+      if (trId1 < 0 || trId2 < 0) {
+        continue;
+      }
       const auto& cand = eventCandidates.iteratorAt(candID);
       const auto& tr1 = fwdTracks.iteratorAt(trId1);
       const auto& tr2 = fwdTracks.iteratorAt(trId2);
@@ -607,14 +628,16 @@ struct UpcCandAnalyzer {
   {
     fIsMC = false;
 
-    std::unordered_map<int32_t, std::vector<int32_t>> tracksPerCand;
-    collectCandIDs(tracksPerCand, fwdTracks);
+    resetCandIDs(eventCandidates);
+    collectCandIDs(fwdTracks);
 
     // assuming that candidates have exatly 2 muon tracks and 0 barrel tracks
-    for (const auto& item : tracksPerCand) {
-      int32_t trId1 = item.second[0];
-      int32_t trId2 = item.second[1];
-      int32_t candID = item.first;
+    for (int32_t candID = 0; candID < static_cast<int32_t>(fTracksPerCand.size()); candID++) {
+      int32_t trId1 = fTracksPerCand[candID][0];
+      int32_t trId2 = fTracksPerCand[candID][1];
+      if (trId1 < 0 || trId2 < 0) {
+        continue;
+      }
       const auto& cand = eventCandidates.iteratorAt(candID);
       const auto& tr1 = fwdTracks.iteratorAt(trId1);
       const auto& tr2 = fwdTracks.iteratorAt(trId2);
@@ -638,15 +661,17 @@ struct UpcCandAnalyzer {
     // "value" = vectors of track IDs
     //  first track -> forward
     //  second track -> central barrel
-    std::unordered_map<int32_t, std::vector<int32_t>> tracksPerCand;
-    collectCandIDs(tracksPerCand, fwdTracks);
-    collectCandIDs(tracksPerCand, barTracks);
+    resetCandIDs(eventCandidates);
+    collectCandIDs(fwdTracks);
+    collectCandIDs(barTracks);
 
     // assuming that candidates have exatly 1 muon track and 1 barrel track
-    for (const auto& item : tracksPerCand) {
-      int32_t trId1 = item.second[0];
-      int32_t trId2 = item.second[1];
-      int32_t candID = item.first;
+    for (int32_t candID = 0; candID < static_cast<int32_t>(fTracksPerCand.size()); candID++) {
+      int32_t trId1 = fTracksPerCand[candID][0];
+      int32_t trId2 = fTracksPerCand[candID][1];
+      if (trId1 < 0 || trId2 < 0) {
+        continue;
+      }
       const auto& cand = eventCandidates.iteratorAt(candID);
       const auto& tr1 = fwdTracks.iteratorAt(trId1);
       const auto& tr2 = barTracks.iteratorAt(trId2);
@@ -664,15 +689,17 @@ struct UpcCandAnalyzer {
     // "value" = vectors of track IDs
     //  first track -> forward
     //  second track -> central barrel
-    std::unordered_map<int32_t, std::vector<int32_t>> tracksPerCand;
-    collectCandIDs(tracksPerCand, fwdTracks);
-    collectCandIDs(tracksPerCand, barTracks);
+    resetCandIDs(eventCandidates);
+    collectCandIDs(fwdTracks);
+    collectCandIDs(barTracks);
 
     // assuming that candidates have exatly 1 muon track and 1 barrel track
-    for (const auto& item : tracksPerCand) {
-      int32_t trId1 = item.second[0];
-      int32_t trId2 = item.second[1];
-      int32_t candID = item.first;
+    for (int32_t candID = 0; candID < static_cast<int32_t>(fTracksPerCand.size()); candID++) {
+      int32_t trId1 = fTracksPerCand[candID][0];
+      int32_t trId2 = fTracksPerCand[candID][1];
+      if (trId1 < 0 || trId2 < 0) {
+        continue;
+      }
       const auto& cand = eventCandidates.iteratorAt(candID);
       const auto& tr1 = fwdTracks.iteratorAt(trId1);
       const auto& tr2 = barTracks.iteratorAt(trId2);
@@ -691,14 +718,16 @@ struct UpcCandAnalyzer {
 
     processMCParts(mcCollisions, mcParticles);
 
-    std::unordered_map<int32_t, std::vector<int32_t>> tracksPerCand;
-    collectCandIDs(tracksPerCand, barTracks);
+    resetCandIDs(eventCandidates);
+    collectCandIDs(barTracks);
 
     // assuming that candidates have exatly 2 central barrel tracks
-    for (const auto& item : tracksPerCand) {
-      int32_t trId1 = item.second[0];
-      int32_t trId2 = item.second[1];
-      int32_t candID = item.first;
+    for (int32_t candID = 0; candID < static_cast<int32_t>(fTracksPerCand.size()); candID++) {
+      int32_t trId1 = fTracksPerCand[candID][0];
+      int32_t trId2 = fTracksPerCand[candID][1];
+      if (trId1 < 0 || trId2 < 0) {
+        continue;
+      }
       const auto& cand = eventCandidates.iteratorAt(candID);
       const auto& tr1 = barTracks.iteratorAt(trId1);
       const auto& tr2 = barTracks.iteratorAt(trId2);
@@ -712,14 +741,16 @@ struct UpcCandAnalyzer {
   {
     fIsMC = false;
 
-    std::unordered_map<int32_t, std::vector<int32_t>> tracksPerCand;
-    collectCandIDs(tracksPerCand, barTracks);
+    resetCandIDs(eventCandidates);
+    collectCandIDs(barTracks);
 
     // assuming that candidates have exatly 2 central barrel tracks
-    for (const auto& item : tracksPerCand) {
-      int32_t trId1 = item.second[0];
-      int32_t trId2 = item.second[1];
-      int32_t candID = item.first;
+    for (int32_t candID = 0; candID < static_cast<int32_t>(fTracksPerCand.size()); candID++) {
+      int32_t trId1 = fTracksPerCand[candID][0];
+      int32_t trId2 = fTracksPerCand[candID][1];
+      if (trId1 < 0 || trId2 < 0) {
+        continue;
+      }
       const auto& cand = eventCandidates.iteratorAt(candID);
       const auto& tr1 = barTracks.iteratorAt(trId1);
       const auto& tr2 = barTracks.iteratorAt(trId2);
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+# Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+# See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+# All rights not expressly granted are reserved.
+#
+# This software is distributed under the terms of the GNU General Public
+# License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+#
+# In applying this license CERN does not waive the privileges and immunities
+# granted to it by virtue of its status as an Intergovernmental Organization
+# or submit itself to any jurisdiction.
+
+"""
+Script to measure the throughput of chains of analysis workflows on a synthetic AO2D.
+The chains are declared in the CMakeLists.txt of the PWGs with o2physics_add_throughput_benchmark
+and installed in share/benchmarks/throughput-benchmarks.json.
+The AO2D is written by o2-aod-synthetic-generator, unless an existing file is given.
+For each chain the events per second, the peak RSS summed over all the devices and the bytes read
+by the devices are measured. The results are printed and can be appended to a JSON file, e.g. to
+follow the throughput of a PWG over the commits.
+Linux only: the memory and the I/O are sampled from /proc.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import time
+
+
+def get_children(pid):
+    """
+    Returns the pids of all the descendants of the process 'pid'
+    """
+    children = {}
+    for entry in os.listdir("/proc"):
+        if not entry.isdigit():
+            continue
+        try:
+            with open(f"/proc/{entry}/stat") as f:
+                # the name of the process is in parentheses and can contain spaces
+                ppid = int(f.read().rsplit(")", 1)[1].split()[1])
+        except (OSError, IndexError, ValueError):
+            continue
+        children.setdefault(ppid, []).append(int(entry))
+    descendants = []
+    todo = [pid]
+    while todo:
+        p = todo.pop()
+        for c in children.get(p, []):
+            descendants.append(c)
+            todo.append(c)
+    return descendants
+
+
+def read_proc(pid):
+    """
+    Returns the RSS (bytes) and the number of bytes read by the process 'pid'
+    """
+    rss = 0
+    read = 0
+    try:
+        with open(f"/proc/{pid}/statm") as f:
+            rss = int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+        with open(f"/proc/{pid}/io") as f:
+            for line in f:
+                if line.startswith("rchar:"):
+                    read = int(line.split()[1])
+    except (OSError, IndexError, ValueError):
+        pass
+    return rss, read
+
+
+def resolve_chain(name, chains):
+    """
+    Returns the workflows of the chain 'name', with the ones of its dependencies first
+    """
+    if name not in chains:
+        raise ValueError(f"Unknown chain {name}, available: {', '.join(chains)}")
+    workflows = []
+    for dependency in chains[name].get("depends", []):
+        for workflow in resolve_chain(dependency, chains):
+            if workflow not in workflows:
+                workflows.append(workflow)
+    for workflow in chains[name]["workflows"]:
+        if workflow not in workflows:
+            workflows.append(workflow)
+    return workflows
+
+
+def run_chain(workflows, aod_file, configuration, extra_args, log_file, sampling=0.2):
+    """
+    Runs the workflows piped together on the AO2D and returns the wall time, the peak RSS and the bytes read
+    """
+    options = "-b"
+    if configuration:
+        options += f" --configuration json://{configuration}"
+    if extra_args:
+        options += f" {extra_args}"
+    cmd = " | ".join(f"{w} {options}" for w in workflows) + f" --aod-file {aod_file}"
+    print("Running:", cmd)
+    peak_rss = 0
+    bytes_read = {}
+    start = time.time()
+    with open(log_file, "w") as log:
+        process = subprocess.Popen(cmd, shell=True, stdout=log, stderr=subprocess.STDOUT)
+        while process.poll() is None:
+            rss = 0
+            for pid in get_children(process.pid):
+                rss_pid, read_pid = read_proc(pid)
+                rss += rss_pid
+                bytes_read[pid] = max(bytes_read.get(pid, 0), read_pid)
+            peak_rss = max(peak_rss, rss)
+            time.sleep(sampling)
+    wall_time = time.time() - start
+    return process.returncode, wall_time, peak_rss, sum(bytes_read.values())
+
+
+def generate_aod(generator, output, args):
+    """
+    Writes the synthetic AO2D and returns its number of collisions
+    """
+    cmd = [generator, "--output", output] + args.split()
+    print("Running:", " ".join(cmd))
+    result = subprocess.run(cmd, check=True, capture_output=True, text=True)
+    match = re.search(r"with (\d+) collisions", result.stdout)
+    if not match:
+        raise RuntimeError(f"Could not read the number of collisions from the generator output: {result.stdout}")
+    return int(match.group(1))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    default_chains = os.path.join(os.environ.get("O2PHYSICS_ROOT", ""), "share", "benchmarks", "throughput-benchmarks.json")
+    parser.add_argument("chains", nargs="*", help="Chains to run, all if empty")
+    parser.add_argument("--chain-file", default=default_chains, help="JSON file with the declared chains")
+    parser.add_argument("--aod-file", default=None, help="Existing AO2D to use instead of a synthetic one")
+    parser.add_argument("--collisions", type=int, default=None, help="Number of collisions of the existing AO2D, for the events per second")
+    parser.add_argument("--generator", default="o2-aod-synthetic-generator", help="Synthetic AO2D generator")
+    parser.add_argument("--generator-args", default="", help="Options of the generator, e.g. \"--multiplicity 500 --pileup 0.2 --v0s 5\"")
+    parser.add_argument("--configuration", default=None, help="JSON configuration of the workflows")
+    parser.add_argument("--extra-args", default="", help="Additional options of all the workflows")
+    parser.add_argument("--output", default=None, help="JSON file where the results are appended")
+    parser.add_argument("--label", default="", help="Label of the results, e.g. the commit")
+    args = parser.parse_args()
+
+    with open(args.chain_file) as f:
+        chains = {chain["name"]: chain for chain in json.load(f)}
+
+    aod_file = args.aod_file
+    n_collisions = args.collisions
+    if aod_file is None:
+        aod_file = "AO2D_synthetic.root"
+        n_collisions = generate_aod(args.generator, aod_file, args.generator_args)
+    aod_size = os.path.getsize(aod_file)
+
+    results = []
+    for name in args.chains if args.chains else chains:
+        workflows = resolve_chain(name, chains)
+        code, wall_time, peak_rss, bytes_read = run_chain(workflows, aod_file, args.configuration, args.extra_args, f"benchmark_{name}.log")
+        result = {
+            "label": args.label,
+            "chain": name,
+            "workflows": workflows,
+            "returncode": code,
+            "wallTime": wall_time,
+            "collisionsPerSecond": n_collisions / wall_time if n_collisions and wall_time > 0 else None,
+            "peakRSS": peak_rss,
+            "bytesRead": bytes_read,
+            "aodSize": aod_size,
+        }
+        results.append(result)
+        print(
+            f"{name}: return code {code}, {wall_time:.1f} s,",
+            f"{result['collisionsPerSecond'] or 0:.1f} collisions/s,",
+            f"peak RSS {peak_rss / 1024**2:.0f} MB, read {bytes_read / 1024**2:.0f} MB (AO2D {aod_size / 1024**2:.0f} MB)",
+        )
+
+    if args.output:
+        previous = []
+        if os.path.exists(args.output):
+            with open(args.output) as f:
+                previous = json.load(f)
+        with open(args.output, "w") as f:
+            json.dump(previous + results, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
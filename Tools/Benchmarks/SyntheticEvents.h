@@ -0,0 +1,153 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   SyntheticEvents.h
+/// \brief  Generators of synthetic collisions and tracks for the benchmarks of the core kernels
+///
+/// The tracks provide the getters of the AO2D tracks used by the kernels (kinematics, TPC and ITS
+/// quality, PID signals), so that the templated helpers can be run without a DPL workflow.
+/// The same seed always gives the same events, so that the results of two builds can be compared.
+///
+
+#ifndef TOOLS_BENCHMARKS_SYNTHETICEVENTS_H_
+#define TOOLS_BENCHMARKS_SYNTHETICEVENTS_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::benchmarks
+{
+
+struct SyntheticCollision {
+  float posX = 0.f;
+  float posY = 0.f;
+  float posZ = 0.f;
+  float mult = 0.f;
+
+  float multTPC() const { return mult; }
+};
+
+struct SyntheticTrack {
+  float mPt, mEta, mPhi, mSign;
+  float mTpcInnerParam, mTpcSignal, mTofSignal, mLength;
+  float mDcaXY, mDcaZ, mTpcChi2NCl, mItsChi2NCl, mTpcCrossedRowsOverFindableCls;
+  int16_t mTpcNClsFound, mTpcNClsCrossedRows;
+  uint8_t mItsClusterMap, mTrackType;
+  uint32_t mFlags;
+
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  float sign() const { return mSign; }
+  float signed1Pt() const { return mSign / mPt; }
+  float tgl() const { return std::sinh(mEta); }
+  float px() const { return mPt * std::cos(mPhi); }
+  float py() const { return mPt * std::sin(mPhi); }
+  float pz() const { return mPt * tgl(); }
+  float p() const { return mPt * std::cosh(mEta); }
+  std::array<float, 3> pVector() const { return {px(), py(), pz()}; }
+
+  float tpcInnerParam() const { return mTpcInnerParam; }
+  float tpcSignal() const { return mTpcSignal; }
+  float tofSignal() const { return mTofSignal; }
+  float length() const { return mLength; }
+  float dcaXY() const { return mDcaXY; }
+  float dcaZ() const { return mDcaZ; }
+  int16_t tpcNClsFound() const { return mTpcNClsFound; }
+  int16_t tpcNClsCrossedRows() const { return mTpcNClsCrossedRows; }
+  float tpcCrossedRowsOverFindableCls() const { return mTpcCrossedRowsOverFindableCls; }
+  float tpcChi2NCl() const { return mTpcChi2NCl; }
+  float itsChi2NCl() const { return mItsChi2NCl; }
+  uint8_t itsClusterMap() const { return mItsClusterMap; }
+  uint8_t itsNCls() const
+  {
+    uint8_t n = 0;
+    for (int layer = 0; layer < 7; layer++) {
+      n += (mItsClusterMap >> layer) & 1;
+    }
+    return n;
+  }
+  uint8_t trackType() const { return mTrackType; }
+  uint32_t flags() const { return mFlags; }
+  bool hasTPC() const { return mTpcNClsFound > 0; }
+  bool hasITS() const { return mItsClusterMap != 0; }
+  bool hasTOF() const { return mTofSignal > 0.f; }
+};
+
+/// Generator of events with a flat multiplicity distribution and exponential pT spectra
+class SyntheticEventGenerator
+{
+ public:
+  explicit SyntheticEventGenerator(uint32_t seed = 42) : mEngine(seed) {}
+
+  SyntheticCollision generateCollision(int mult)
+  {
+    SyntheticCollision collision;
+    collision.posX = mGaus(mEngine) * 0.01f;
+    collision.posY = mGaus(mEngine) * 0.01f;
+    collision.posZ = mGaus(mEngine) * 6.f;
+    collision.mult = mult;
+    return collision;
+  }
+
+  SyntheticTrack generateTrack()
+  {
+    SyntheticTrack track;
+    track.mPt = 0.1f + mExp(mEngine);
+    track.mEta = 1.8f * (mUniform(mEngine) - 0.5f);
+    track.mPhi = 2.f * static_cast<float>(M_PI) * mUniform(mEngine);
+    track.mSign = mUniform(mEngine) < 0.5f ? -1.f : 1.f;
+    track.mTpcInnerParam = track.p() * (1.f + 0.01f * mGaus(mEngine));
+    track.mTpcSignal = 50.f / std::pow(std::min(track.mTpcInnerParam, 1.f), 1.5f) * (1.f + 0.07f * mGaus(mEngine));
+    track.mTofSignal = mUniform(mEngine) < 0.6f ? 13000.f * (1.f + 0.1f * mUniform(mEngine)) : -999.f;
+    track.mLength = 400.f;
+    track.mDcaXY = 0.05f * mGaus(mEngine);
+    track.mDcaZ = 0.1f * mGaus(mEngine);
+    track.mTpcNClsFound = 60 + static_cast<int16_t>(100 * mUniform(mEngine));
+    track.mTpcNClsCrossedRows = track.mTpcNClsFound + static_cast<int16_t>(5 * mUniform(mEngine));
+    track.mTpcCrossedRowsOverFindableCls = 0.7f + 0.4f * mUniform(mEngine);
+    track.mTpcChi2NCl = 5.f * mUniform(mEngine);
+    track.mItsChi2NCl = 40.f * mUniform(mEngine);
+    track.mItsClusterMap = static_cast<uint8_t>(mEngine() & 0x7f);
+    track.mTrackType = o2::aod::track::Track;
+    track.mFlags = 0;
+    return track;
+  }
+
+  /// \param nTracks Number of tracks of the event
+  void generateTracks(int nTracks, std::vector<SyntheticTrack>& tracks)
+  {
+    tracks.clear();
+    tracks.reserve(nTracks);
+    for (int i = 0; i < nTracks; i++) {
+      tracks.push_back(generateTrack());
+    }
+  }
+
+  float uniform() { return mUniform(mEngine); }
+
+ private:
+  std::mt19937 mEngine;
+  std::uniform_real_distribution<float> mUniform{0.f, 1.f};
+  std::normal_distribution<float> mGaus{0.f, 1.f};
+  std::exponential_distribution<float> mExp{1.f / 0.6f};
+};
+
+} // namespace o2::benchmarks
+
+#endif // TOOLS_BENCHMARKS_SYNTHETICEVENTS_H_
@@ -0,0 +1,158 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   benchmarkCommonCore.cxx
+/// \brief  Benchmarks of the kernels of Common/Core: RecoDecay, TrackSelection, TPC PID response and event mixing binning
+///         The argument of each benchmark is the number of tracks (or events) per iteration.
+///
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <vector>
+
+#include "CommonConstants/PhysicsConstants.h"
+#include "Common/Core/EventMixing.h"
+#include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Core/RecoDecay.h"
+#include "Common/Core/TrackSelection.h"
+#include "Common/Core/TrackSelectionDefaults.h"
+#include "Tools/Benchmarks/SyntheticEvents.h"
+
+using namespace o2::benchmarks;
+
+// Invariant mass and pointing angle of all the opposite-sign pairs of an event, as in the HF 2-prong combinatorics
+static void BM_RecoDecayPairs(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  const auto collision = generator.generateCollision(state.range(0));
+  const std::array<float, 3> posPV{collision.posX, collision.posY, collision.posZ};
+  const std::array<float, 3> posSV{collision.posX + 0.01f, collision.posY + 0.01f, collision.posZ + 0.02f};
+  const std::array<double, 2> masses{o2::constants::physics::MassPionCharged, o2::constants::physics::MassKaonCharged};
+  uint64_t nPairs = 0;
+  for (auto _ : state) {
+    for (const auto& pos : tracks) {
+      if (pos.sign() < 0) {
+        continue;
+      }
+      for (const auto& neg : tracks) {
+        if (neg.sign() > 0) {
+          continue;
+        }
+        const auto arrMom = std::array{pos.pVector(), neg.pVector()};
+        benchmark::DoNotOptimize(RecoDecay::m(arrMom, masses));
+        benchmark::DoNotOptimize(RecoDecay::cpa(posPV, posSV, RecoDecay::pVec(pos.pVector(), neg.pVector())));
+        nPairs++;
+      }
+    }
+  }
+  state.counters["pairs"] = benchmark::Counter(nPairs, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RecoDecayPairs)->Arg(100)->Arg(1000);
+
+// Global track selection, track by track
+static void BM_TrackSelectionIsSelected(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  auto selection = getGlobalTrackSelection();
+  selection.SetTrackType(o2::aod::track::Track);
+  for (auto _ : state) {
+    for (const auto& track : tracks) {
+      benchmark::DoNotOptimize(selection.IsSelectedMask(track));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_TrackSelectionIsSelected)->Arg(1000)->Arg(10000);
+
+// Global track selection, one pass per cut over the columns of the tracks
+static void BM_TrackSelectionFillMasks(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  auto selection = getGlobalTrackSelection();
+  selection.SetTrackType(o2::aod::track::Track);
+  TrackSelection::TrackColumns columns;
+  std::vector<uint16_t> masks;
+  for (auto _ : state) {
+    columns.fill(tracks);
+    selection.FillMasks(columns, masks);
+    benchmark::DoNotOptimize(masks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_TrackSelectionFillMasks)->Arg(1000)->Arg(10000);
+
+// TPC n-sigmas of all the mass hypotheses, one hypothesis at a time
+static void BM_TPCResponsePerSpecies(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  const auto collision = generator.generateCollision(state.range(0));
+  o2::pid::tpc::Response response;
+  for (auto _ : state) {
+    for (const auto& track : tracks) {
+      for (int id = 0; id < o2::track::PID::NIDs; id++) {
+        benchmark::DoNotOptimize(response.GetNumberOfSigma(collision, track, id));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_TPCResponsePerSpecies)->Arg(1000)->Arg(10000);
+
+// TPC n-sigmas of all the mass hypotheses at once
+static void BM_TPCResponseAllSpecies(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  const auto collision = generator.generateCollision(state.range(0));
+  o2::pid::tpc::Response response;
+  float expSignal[o2::track::PID::NIDs];
+  float expSigma[o2::track::PID::NIDs];
+  float nSigma[o2::track::PID::NIDs];
+  for (auto _ : state) {
+    for (const auto& track : tracks) {
+      response.GetResponseAllSpecies(collision, track, expSignal, expSigma, nSigma, (1u << o2::track::PID::NIDs) - 1);
+      benchmark::DoNotOptimize(nSigma);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_TPCResponseAllSpecies)->Arg(1000)->Arg(10000);
+
+// Mixing bin of events in (z-vertex, multiplicity), with uniform and non-uniform binnings
+static void BM_EventMixingHash(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<std::array<float, 2>> events(state.range(0));
+  for (auto& event : events) {
+    event = {generator.generateCollision(0).posZ, 3000.f * generator.uniform()};
+  }
+  eventmixing::MixingBinning binning;
+  binning.addAxis(std::vector<float>{-10.f, -7.5f, -5.f, -2.5f, 0.f, 2.5f, 5.f, 7.5f, 10.f});
+  binning.addAxis(std::vector<float>{0.f, 20.f, 50.f, 100.f, 200.f, 400.f, 800.f, 1500.f, 3000.f});
+  for (auto _ : state) {
+    for (const auto& event : events) {
+      benchmark::DoNotOptimize(binning.getHash(event.data()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(BM_EventMixingHash)->Arg(10000);
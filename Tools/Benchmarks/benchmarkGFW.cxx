@@ -0,0 +1,88 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   benchmarkGFW.cxx
+/// \brief  Benchmarks of the generic framework of the flow analyses: filling of the Q-vectors and calculation of the correlators
+///         The regions and correlators are the ones of PWGCF/Tasks/flowGenericFramework.cxx.
+///         The argument of each benchmark is the number of tracks of the event.
+///
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "PWGCF/GenericFramework/GFW.h"
+#include "Tools/Benchmarks/SyntheticEvents.h"
+
+using namespace o2::benchmarks;
+
+namespace
+{
+void setupGFW(GFW& gfw, std::vector<GFW::CorrConfig>& corrconfigs)
+{
+  int pows[] = {3, 0, 2, 2, 3, 3, 3};
+  int powsFull[] = {5, 0, 4, 4, 3, 3, 3};
+  gfw.AddRegion("refN", 7, pows, -0.8, -0.4, 1, 1);
+  gfw.AddRegion("refP", 7, pows, 0.4, 0.8, 1, 1);
+  gfw.AddRegion("full", 7, powsFull, -0.8, 0.8, 1, 2);
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("refP {2} refN {-2}", "ChGap22", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("refP {2 2} refN {-2 -2}", "ChGap24", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("full {2 -2}", "ChFull22", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("full {2 2 -2 -2}", "ChFull24", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("refP {3} refN {-3}", "ChGap32", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("refP {4} refN {-4}", "ChGap42", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("refP {2 4} refN {-2 -4}", "ChSC244", kFALSE));
+  corrconfigs.push_back(gfw.GetCorrelatorConfig("refP {2 3} refN {-2 -3}", "ChSC234", kFALSE));
+  gfw.BuildPlan(corrconfigs);
+}
+} // namespace
+
+// Filling of the Q-vectors of an event, track by track
+static void BM_GFWFill(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  GFW gfw;
+  std::vector<GFW::CorrConfig> corrconfigs;
+  setupGFW(gfw, corrconfigs);
+  for (auto _ : state) {
+    gfw.Clear();
+    for (const auto& track : tracks) {
+      gfw.Fill(track.eta(), 0, track.phi(), 1., 3);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * tracks.size());
+}
+BENCHMARK(BM_GFWFill)->Arg(100)->Arg(2000);
+
+// Calculation of all the correlators of an event, with the denominators as in the flow task
+static void BM_GFWCalculate(benchmark::State& state)
+{
+  SyntheticEventGenerator generator;
+  std::vector<SyntheticTrack> tracks;
+  generator.generateTracks(state.range(0), tracks);
+  GFW gfw;
+  std::vector<GFW::CorrConfig> corrconfigs;
+  setupGFW(gfw, corrconfigs);
+  for (const auto& track : tracks) {
+    gfw.Fill(track.eta(), 0, track.phi(), 1., 3);
+  }
+  for (auto _ : state) {
+    for (const auto& corrconf : corrconfigs) {
+      benchmark::DoNotOptimize(gfw.Calculate(corrconf, 0, kTRUE).Re());
+      benchmark::DoNotOptimize(gfw.Calculate(corrconf, 0, kFALSE).Re());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corrconfigs.size());
+}
+BENCHMARK(BM_GFWCalculate)->Arg(100)->Arg(2000);
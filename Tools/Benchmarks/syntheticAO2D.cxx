@@ -0,0 +1,441 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   syntheticAO2D.cxx
+/// \brief  Generator of synthetic AO2D files for the throughput benchmarks of the analysis workflows
+///
+/// Writes the BCs, collisions, tracks (at the innermost update, with covariance and extra information),
+/// V0s and cascades of a configurable number of dataframes. The multiplicity, the pileup (collisions
+/// sharing a BC and tracks not assigned to any collision) and the number of V0s and cascades per
+/// collision are options. The tracks are straight lines from their origin, which is enough to load the
+/// workflows but not to reproduce physics distributions. The same seed always gives the same file.
+/// The trees follow the data model of the converted Run 3 AO2Ds (O2track_iu, O2v0_001, ...): if it
+/// changes, the branch lists below have to be updated.
+///
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TString.h"
+#include "TTree.h"
+#include "TDirectory.h"
+
+namespace
+{
+constexpr float kITSInnerRadius = 2.3f; // radius of the innermost update of the tracks (cm)
+constexpr float kPionMass = 0.13957f;
+constexpr uint8_t kTrackIU = 2; // o2::aod::track::TrackIU
+
+struct BCRow {
+  int runNumber = 0;
+  ULong64_t globalBC = 0;
+  ULong64_t triggerMask = 0;
+};
+
+struct CollisionRow {
+  int bcId = 0;
+  float posX = 0.f, posY = 0.f, posZ = 0.f;
+  float covXX = 0.f, covXY = 0.f, covYY = 0.f, covXZ = 0.f, covYZ = 0.f, covZZ = 0.f;
+  UShort_t flags = 0;
+  float chi2 = 0.f;
+  UShort_t numContrib = 0;
+  float collisionTime = 0.f;
+  float collisionTimeRes = 0.f;
+};
+
+struct TrackRow {
+  int collisionId = -1;
+  uint8_t trackType = kTrackIU;
+  float x = 0.f, alpha = 0.f, y = 0.f, z = 0.f, snp = 0.f, tgl = 0.f, signed1Pt = 0.f;
+  // covariance
+  float sigmaY = 0.f, sigmaZ = 0.f, sigmaSnp = 0.f, sigmaTgl = 0.f, sigma1Pt = 0.f;
+  std::array<Char_t, 10> rho{}; // ZY, SnpY, SnpZ, TglY, TglZ, TglSnp, 1PtY, 1PtZ, 1PtSnp, 1PtTgl
+  // extra
+  float tpcInnerParam = 0.f;
+  uint32_t flags = 0;
+  uint8_t itsClusterMap = 0;
+  uint8_t tpcNClsFindable = 0;
+  int8_t tpcNClsFindableMinusFound = 0;
+  int8_t tpcNClsFindableMinusCrossedRows = 0;
+  uint8_t tpcNClsShared = 0;
+  uint8_t trdPattern = 0;
+  float itsChi2NCl = 0.f, tpcChi2NCl = 0.f, trdChi2 = 0.f, tofChi2 = 0.f;
+  float tpcSignal = 0.f, trdSignal = 0.f, length = 0.f, tofExpMom = 0.f;
+  float trackEtaEMCAL = -999.f, trackPhiEMCAL = -999.f, trackTime = 0.f, trackTimeRes = 0.f;
+};
+
+struct V0Row {
+  int collisionId = -1;
+  int posTrackId = -1;
+  int negTrackId = -1;
+};
+
+struct CascadeRow {
+  int collisionId = -1;
+  int v0Id = -1;
+  int bachelorId = -1;
+};
+
+/// Trees of one dataframe, with their branches bound to the rows
+struct DataFrameTrees {
+  BCRow bc;
+  CollisionRow collision;
+  TrackRow track;
+  V0Row v0;
+  CascadeRow cascade;
+  TTree* bcs = nullptr;
+  TTree* collisions = nullptr;
+  TTree* tracks = nullptr;
+  TTree* tracksCov = nullptr;
+  TTree* tracksExtra = nullptr;
+  TTree* v0s = nullptr;
+  TTree* cascades = nullptr;
+
+  void create()
+  {
+    bcs = new TTree("O2bc", "O2bc");
+    bcs->Branch("fRunNumber", &bc.runNumber, "fRunNumber/I");
+    bcs->Branch("fGlobalBC", &bc.globalBC, "fGlobalBC/l");
+    bcs->Branch("fTriggerMask", &bc.triggerMask, "fTriggerMask/l");
+
+    collisions = new TTree("O2collision", "O2collision");
+    collisions->Branch("fIndexBCs", &collision.bcId, "fIndexBCs/I");
+    collisions->Branch("fPosX", &collision.posX, "fPosX/F");
+    collisions->Branch("fPosY", &collision.posY, "fPosY/F");
+    collisions->Branch("fPosZ", &collision.posZ, "fPosZ/F");
+    collisions->Branch("fCovXX", &collision.covXX, "fCovXX/F");
+    collisions->Branch("fCovXY", &collision.covXY, "fCovXY/F");
+    collisions->Branch("fCovYY", &collision.covYY, "fCovYY/F");
+    collisions->Branch("fCovXZ", &collision.covXZ, "fCovXZ/F");
+    collisions->Branch("fCovYZ", &collision.covYZ, "fCovYZ/F");
+    collisions->Branch("fCovZZ", &collision.covZZ, "fCovZZ/F");
+    collisions->Branch("fFlags", &collision.flags, "fFlags/s");
+    collisions->Branch("fChi2", &collision.chi2, "fChi2/F");
+    collisions->Branch("fNumContrib", &collision.numContrib, "fNumContrib/s");
+    collisions->Branch("fCollisionTime", &collision.collisionTime, "fCollisionTime/F");
+    collisions->Branch("fCollisionTimeRes", &collision.collisionTimeRes, "fCollisionTimeRes/F");
+
+    tracks = new TTree("O2track_iu", "O2track_iu");
+    tracks->Branch("fIndexCollisions", &track.collisionId, "fIndexCollisions/I");
+    tracks->Branch("fTrackType", &track.trackType, "fTrackType/b");
+    tracks->Branch("fX", &track.x, "fX/F");
+    tracks->Branch("fAlpha", &track.alpha, "fAlpha/F");
+    tracks->Branch("fY", &track.y, "fY/F");
+    tracks->Branch("fZ", &track.z, "fZ/F");
+    tracks->Branch("fSnp", &track.snp, "fSnp/F");
+    tracks->Branch("fTgl", &track.tgl, "fTgl/F");
+    tracks->Branch("fSigned1Pt", &track.signed1Pt, "fSigned1Pt/F");
+
+    tracksCov = new TTree("O2trackcov_iu", "O2trackcov_iu");
+    tracksCov->Branch("fSigmaY", &track.sigmaY, "fSigmaY/F");
+    tracksCov->Branch("fSigmaZ", &track.sigmaZ, "fSigmaZ/F");
+    tracksCov->Branch("fSigmaSnp", &track.sigmaSnp, "fSigmaSnp/F");
+    tracksCov->Branch("fSigmaTgl", &track.sigmaTgl, "fSigmaTgl/F");
+    tracksCov->Branch("fSigma1Pt", &track.sigma1Pt, "fSigma1Pt/F");
+    const char* rhoNames[10] = {"fRhoZY", "fRhoSnpY", "fRhoSnpZ", "fRhoTglY", "fRhoTglZ", "fRhoTglSnp", "fRho1PtY", "fRho1PtZ", "fRho1PtSnp", "fRho1PtTgl"};
+    for (int i = 0; i < 10; i++) {
+      tracksCov->Branch(rhoNames[i], &track.rho[i], Form("%s/B", rhoNames[i]));
+    }
+
+    tracksExtra = new TTree("O2trackextra", "O2trackextra");
+    tracksExtra->Branch("fTPCInnerParam", &track.tpcInnerParam, "fTPCInnerParam/F");
+    tracksExtra->Branch("fFlags", &track.flags, "fFlags/i");
+    tracksExtra->Branch("fITSClusterMap", &track.itsClusterMap, "fITSClusterMap/b");
+    tracksExtra->Branch("fTPCNClsFindable", &track.tpcNClsFindable, "fTPCNClsFindable/b");
+    tracksExtra->Branch("fTPCNClsFindableMinusFound", &track.tpcNClsFindableMinusFound, "fTPCNClsFindableMinusFound/B");
+    tracksExtra->Branch("fTPCNClsFindableMinusCrossedRows", &track.tpcNClsFindableMinusCrossedRows, "fTPCNClsFindableMinusCrossedRows/B");
+    tracksExtra->Branch("fTPCNClsShared", &track.tpcNClsShared, "fTPCNClsShared/b");
+    tracksExtra->Branch("fTRDPattern", &track.trdPattern, "fTRDPattern/b");
+    tracksExtra->Branch("fITSChi2NCl", &track.itsChi2NCl, "fITSChi2NCl/F");
+    tracksExtra->Branch("fTPCChi2NCl", &track.tpcChi2NCl, "fTPCChi2NCl/F");
+    tracksExtra->Branch("fTRDChi2", &track.trdChi2, "fTRDChi2/F");
+    tracksExtra->Branch("fTOFChi2", &track.tofChi2, "fTOFChi2/F");
+    tracksExtra->Branch("fTPCSignal", &track.tpcSignal, "fTPCSignal/F");
+    tracksExtra->Branch("fTRDSignal", &track.trdSignal, "fTRDSignal/F");
+    tracksExtra->Branch("fLength", &track.length, "fLength/F");
+    tracksExtra->Branch("fTOFExpMom", &track.tofExpMom, "fTOFExpMom/F");
+    tracksExtra->Branch("fTrackEtaEMCAL", &track.trackEtaEMCAL, "fTrackEtaEMCAL/F");
+    tracksExtra->Branch("fTrackPhiEMCAL", &track.trackPhiEMCAL, "fTrackPhiEMCAL/F");
+    tracksExtra->Branch("fTrackTime", &track.trackTime, "fTrackTime/F");
+    tracksExtra->Branch("fTrackTimeRes", &track.trackTimeRes, "fTrackTimeRes/F");
+
+    v0s = new TTree("O2v0_001", "O2v0_001");
+    v0s->Branch("fIndexCollisions", &v0.collisionId, "fIndexCollisions/I");
+    v0s->Branch("fIndexTracks_Pos", &v0.posTrackId, "fIndexTracks_Pos/I");
+    v0s->Branch("fIndexTracks_Neg", &v0.negTrackId, "fIndexTracks_Neg/I");
+
+    cascades = new TTree("O2cascade_001", "O2cascade_001");
+    cascades->Branch("fIndexCollisions", &cascade.collisionId, "fIndexCollisions/I");
+    cascades->Branch("fIndexV0s", &cascade.v0Id, "fIndexV0s/I");
+    cascades->Branch("fIndexTracks", &cascade.bachelorId, "fIndexTracks/I");
+  }
+
+  void write()
+  {
+    for (auto* tree : {bcs, collisions, tracks, tracksCov, tracksExtra, v0s, cascades}) {
+      tree->Write();
+      delete tree;
+    }
+  }
+};
+
+class Generator
+{
+ public:
+  Generator(uint32_t seed, double meanMult, double pileup, double unassigned, double v0sPerCollision, double cascadesPerCollision)
+    : mEngine(seed), mMult(meanMult), mPileup(pileup), mUnassigned(unassigned), mV0s(v0sPerCollision), mCascades(cascadesPerCollision) {}
+
+  /// Fills the tree of one dataframe
+  /// \param nBCs number of BCs with at least one collision
+  /// \return number of collisions
+  long fill(DataFrameTrees& df, int nBCs, int runNumber)
+  {
+    long nCollisions = 0;
+    int nTracks = 0;
+    int nV0s = 0;
+    std::vector<std::array<float, 3>> unassigned; // origins of the tracks not assigned to any collision
+    for (int iBC = 0; iBC < nBCs; iBC++) {
+      mGlobalBC += 1 + static_cast<ULong64_t>(mExp(mEngine) * 1000.);
+      df.bc.runNumber = runNumber;
+      df.bc.globalBC = mGlobalBC;
+      df.bc.triggerMask = 0;
+      df.bcs->Fill();
+      // pileup: additional collisions in the same BC
+      int nInBC = 1 + std::poisson_distribution<int>(mPileup)(mEngine);
+      for (int iColl = 0; iColl < nInBC; iColl++, nCollisions++) {
+        const int collisionId = df.collisions->GetEntries();
+        const int mult = std::poisson_distribution<int>(mMult)(mEngine);
+        auto& coll = df.collision;
+        coll = CollisionRow();
+        coll.bcId = df.bcs->GetEntries() - 1;
+        coll.posX = 0.01f * mGaus(mEngine);
+        coll.posY = 0.01f * mGaus(mEngine);
+        coll.posZ = 6.f * mGaus(mEngine);
+        coll.covXX = coll.covYY = 1.e-4f;
+        coll.covZZ = 4.e-4f;
+        coll.chi2 = 1.f + mUniform(mEngine);
+        coll.numContrib = mult;
+        coll.collisionTime = 10.f * mGaus(mEngine);
+        coll.collisionTimeRes = 10.f;
+        df.collisions->Fill();
+        const std::array<float, 3> vertex{coll.posX, coll.posY, coll.posZ};
+
+        for (int i = 0; i < mult; i++) {
+          if (mUniform(mEngine) < mUnassigned) {
+            unassigned.push_back(vertex);
+            continue;
+          }
+          fillTrack(df, collisionId, vertex, 0.15f + mExpPt(mEngine), mUniform(mEngine) < 0.5f ? -1.f : 1.f);
+          nTracks++;
+        }
+        // V0s from displaced opposite-sign pairs
+        const int nV0sColl = std::poisson_distribution<int>(mV0s)(mEngine);
+        const int firstV0 = nV0s;
+        for (int i = 0; i < nV0sColl; i++, nV0s++) {
+          const float radius = 0.5f + mExp(mEngine) * 5.f;
+          const float phi = 2.f * M_PI * mUniform(mEngine);
+          const float tglV0 = 1.6f * (mUniform(mEngine) - 0.5f);
+          const std::array<float, 3> decay{vertex[0] + radius * std::cos(phi), vertex[1] + radius * std::sin(phi), vertex[2] + radius * tglV0};
+          const float ptV0 = 0.3f + mExpPt(mEngine);
+          fillTrack(df, collisionId, decay, 0.5f * ptV0, 1.f, phi + 0.1f, tglV0);
+          fillTrack(df, collisionId, decay, 0.5f * ptV0, -1.f, phi - 0.1f, tglV0);
+          df.v0.collisionId = collisionId;
+          df.v0.posTrackId = nTracks;
+          df.v0.negTrackId = nTracks + 1;
+          df.v0s->Fill();
+          nTracks += 2;
+        }
+        // cascades from the V0s of the collision and one more displaced track
+        const int nCascadesColl = nV0sColl > 0 ? std::poisson_distribution<int>(mCascades)(mEngine) : 0;
+        for (int i = 0; i < nCascadesColl; i++, nTracks++) {
+          const float phi = 2.f * M_PI * mUniform(mEngine);
+          fillTrack(df, collisionId, {vertex[0] + 2.f * std::cos(phi), vertex[1] + 2.f * std::sin(phi), vertex[2]}, 0.3f + mExpPt(mEngine), -1.f, phi);
+          df.cascade.collisionId = collisionId;
+          df.cascade.v0Id = firstV0 + static_cast<int>(mUniform(mEngine) * nV0sColl) % nV0sColl;
+          df.cascade.bachelorId = nTracks;
+          df.cascades->Fill();
+        }
+      }
+    }
+    // the tracks not assigned to any collision are stored at the end of the dataframe, as in the reconstructed AO2Ds
+    for (const auto& vertex : unassigned) {
+      fillTrack(df, -1, vertex, 0.15f + mExpPt(mEngine), mUniform(mEngine) < 0.5f ? -1.f : 1.f);
+    }
+    return nCollisions;
+  }
+
+ private:
+  /// Straight track from the origin, parametrised at the innermost update radius in the frame of its azimuth
+  void fillTrack(DataFrameTrees& df, int collisionId, const std::array<float, 3>& origin, float pt, float sign, float phi = -999.f, float tgl = -999.f)
+  {
+    auto& t = df.track;
+    t = TrackRow();
+    phi = phi > -999.f ? phi : 2.f * M_PI * mUniform(mEngine);
+    tgl = tgl > -999.f ? tgl : std::sinh(1.8f * (mUniform(mEngine) - 0.5f));
+    t.collisionId = collisionId;
+    t.alpha = phi;
+    // origin in the local frame, then moved along the direction up to the innermost update radius
+    const float xLocal = origin[0] * std::cos(phi) + origin[1] * std::sin(phi);
+    const float yLocal = -origin[0] * std::sin(phi) + origin[1] * std::cos(phi);
+    t.x = std::max(xLocal, kITSInnerRadius);
+    t.y = yLocal;
+    t.z = origin[2] + (t.x - xLocal) * tgl;
+    t.snp = 0.f;
+    t.tgl = tgl;
+    t.signed1Pt = sign / pt;
+    t.sigmaY = 0.005f;
+    t.sigmaZ = 0.005f;
+    t.sigmaSnp = 0.001f;
+    t.sigmaTgl = 0.001f;
+    t.sigma1Pt = 0.01f * std::abs(t.signed1Pt);
+    const float p = pt * std::sqrt(1.f + tgl * tgl);
+    t.tpcInnerParam = p;
+    t.itsClusterMap = 0x7f & static_cast<uint8_t>(mEngine());
+    t.tpcNClsFindable = 130 + static_cast<uint8_t>(30 * mUniform(mEngine));
+    t.tpcNClsFindableMinusFound = static_cast<int8_t>(20 * mUniform(mEngine));
+    t.tpcNClsFindableMinusCrossedRows = static_cast<int8_t>(10 * mUniform(mEngine));
+    t.itsChi2NCl = 5.f * mUniform(mEngine);
+    t.tpcChi2NCl = 2.f * mUniform(mEngine);
+    const float betaGamma = p / kPionMass;
+    t.tpcSignal = 50.f * (1.f + 1.f / (betaGamma * betaGamma)) * (1.f + 0.07f * mGaus(mEngine));
+    if (mUniform(mEngine) < 0.6f) { // TOF matched
+      t.length = 400.f;
+      t.tofExpMom = p;
+      t.tofChi2 = mUniform(mEngine);
+    } else {
+      t.length = -999.f;
+      t.tofExpMom = -999.f;
+      t.tofChi2 = -999.f;
+    }
+    t.trackTime = 100.f * mGaus(mEngine);
+    t.trackTimeRes = 10.f;
+    df.tracks->Fill();
+    df.tracksCov->Fill();
+    df.tracksExtra->Fill();
+  }
+
+  std::mt19937 mEngine;
+  std::uniform_real_distribution<float> mUniform{0.f, 1.f};
+  std::normal_distribution<float> mGaus{0.f, 1.f};
+  std::exponential_distribution<float> mExp{1.f};
+  std::exponential_distribution<float> mExpPt{1.f / 0.6f};
+  double mMult;
+  double mPileup;
+  double mUnassigned;
+  double mV0s;
+  double mCascades;
+  ULong64_t mGlobalBC = 0;
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  std::string outputFileName("AO2D.root");
+  int nDataFrames = 10;
+  int nBCsPerDataFrame = 1000;
+  double meanMult = 30.;
+  double pileup = 0.;
+  double unassigned = 0.;
+  double v0sPerCollision = 1.;
+  double cascadesPerCollision = 0.1;
+  int runNumber = 300000;
+  uint32_t seed = 42;
+
+  int option_index = 0;
+  static struct option long_options[] = {
+    {"output", required_argument, nullptr, 0},
+    {"dataframes", required_argument, nullptr, 1},
+    {"bcs", required_argument, nullptr, 2},
+    {"multiplicity", required_argument, nullptr, 3},
+    {"pileup", required_argument, nullptr, 4},
+    {"unassigned", required_argument, nullptr, 5},
+    {"v0s", required_argument, nullptr, 6},
+    {"cascades", required_argument, nullptr, 7},
+    {"run", required_argument, nullptr, 8},
+    {"seed", required_argument, nullptr, 9},
+    {"help", no_argument, nullptr, 10},
+    {nullptr, 0, nullptr, 0}};
+
+  while (true) {
+    int c = getopt_long(argc, argv, "", long_options, &option_index);
+    if (c == -1) {
+      break;
+    } else if (c == 0) {
+      outputFileName = optarg;
+    } else if (c == 1) {
+      nDataFrames = atoi(optarg);
+    } else if (c == 2) {
+      nBCsPerDataFrame = atoi(optarg);
+    } else if (c == 3) {
+      meanMult = atof(optarg);
+    } else if (c == 4) {
+      pileup = atof(optarg);
+    } else if (c == 5) {
+      unassigned = atof(optarg);
+    } else if (c == 6) {
+      v0sPerCollision = atof(optarg);
+    } else if (c == 7) {
+      cascadesPerCollision = atof(optarg);
+    } else if (c == 8) {
+      runNumber = atoi(optarg);
+    } else if (c == 9) {
+      seed = strtoul(optarg, nullptr, 0);
+    } else if (c == 10) {
+      printf("Synthetic AO2D generator. Options: \n");
+      printf("  --output <file.root>   Output file. Default: %s\n", outputFileName.c_str());
+      printf("  --dataframes <n>       Number of dataframes. Default: %d\n", nDataFrames);
+      printf("  --bcs <n>              Number of BCs with collisions per dataframe. Default: %d\n", nBCsPerDataFrame);
+      printf("  --multiplicity <x>     Mean number of primary tracks per collision. Default: %g\n", meanMult);
+      printf("  --pileup <x>           Mean number of additional collisions per BC. Default: %g\n", pileup);
+      printf("  --unassigned <x>       Fraction of the primary tracks not assigned to a collision. Default: %g\n", unassigned);
+      printf("  --v0s <x>              Mean number of V0s per collision. Default: %g\n", v0sPerCollision);
+      printf("  --cascades <x>         Mean number of cascades per collision with V0s. Default: %g\n", cascadesPerCollision);
+      printf("  --run <n>              Run number of the BCs. Default: %d\n", runNumber);
+      printf("  --seed <n>             Seed of the random numbers. Default: %u\n", seed);
+      return -1;
+    } else {
+      return -2;
+    }
+  }
+
+  auto outputFile = TFile::Open(outputFileName.c_str(), "RECREATE", "", 505);
+  if (outputFile == nullptr || outputFile->IsZombie()) {
+    printf("Error: could not open %s\n", outputFileName.c_str());
+    return 1;
+  }
+
+  Generator generator(seed, meanMult, pileup, unassigned, v0sPerCollision, cascadesPerCollision);
+  long nCollisions = 0;
+  for (int iDF = 0; iDF < nDataFrames; iDF++) {
+    auto dir = outputFile->mkdir(Form("DF_%d", iDF + 1));
+    dir->cd();
+    DataFrameTrees df;
+    df.create();
+    nCollisions += generator.fill(df, nBCsPerDataFrame, runNumber);
+    df.write();
+  }
+  outputFile->Close();
+  delete outputFile;
+
+  // the number of collisions is parsed by the benchmark driver
+  printf("Written %d dataframes with %ld collisions to %s\n", nDataFrames, nCollisions, outputFileName.c_str());
+  return 0;
+}
@@ -18,10 +18,12 @@
 #define O2_ANALYSIS_PIDONNXMODEL_H_
 
 #include "CCDB/CcdbApi.h"
+#include "Common/Core/ONNXSessionRegistry.h"
 
 #include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
+#include <array>
 #include <string>
 
 enum PidMLDetector {
@@ -31,6 +33,34 @@ enum PidMLDetector {
   kNDetectors ///< number of available detectors configurations
 };
 
+// Model inputs, in the order expected by the network
+enum PidMLInput {
+  kInputPx = 0,
+  kInputPy,
+  kInputPz,
+  kInputSign,
+  kInputX,
+  kInputY,
+  kInputZ,
+  kInputAlpha,
+  kInputTrackType,
+  kInputTPCNClsShared,
+  kInputDcaXY,
+  kInputDcaZ,
+  kInputP,
+  kInputTPCSignal,
+  kNInputsTPC, ///< number of inputs of TPC-only models
+  kInputTOFSignal = kNInputsTPC,
+  kInputBeta,
+  kNInputsTPCTOF, ///< number of inputs of TPC+TOF models
+  kInputTRDSignal = kNInputsTPCTOF,
+  kInputTRDPattern,
+  kNInputs ///< number of inputs of TPC+TOF+TRD models
+};
+
+// Names of the inputs in the scaling parameters file, empty for inputs without scaling
+static constexpr const char* pidMLInputScalingNames[kNInputs] = {"", "", "", "", "fX", "fY", "fZ", "fAlpha", "", "fTPCNClsShared", "fDcaXY", "fDcaZ", "", "fTPCSignal", "fTOFSignal", "fBeta", "fTRDSignal", "fTRDPattern"};
+
 // TODO: Copied from cefpTask, shall we put it in some common utils code?
 namespace
 {
@@ -58,10 +88,9 @@ struct PidONNXModel {
     std::string modelFile;
     loadInputFiles(localPath, ccdbPath, useCCDB, ccdbApi, timestamp, pid, modelFile);
 
-    Ort::SessionOptions sessionOptions;
-    mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "pid-onnx-inferer");
-    LOG(info) << "Loading ONNX model from file: " << modelFile;
-    mSession.reset(new Ort::Experimental::Session{*mEnv, modelFile, sessionOptions});
+    // the session is shared with the other tasks of the process using the same model
+    auto sessionKey = o2::analysis::ONNXSessionRegistry::makeKey(modelFile, useCCDB ? timestamp : 0);
+    mSession = o2::analysis::ONNXSessionRegistry::instance().getSession(sessionKey, modelFile);
     LOG(info) << "ONNX model loaded";
 
     mInputNames = mSession->GetInputNames();
@@ -101,6 +130,14 @@ struct PidONNXModel {
     return getModelOutput(track) >= mMinCertainty;
   }
 
+  // Evaluates the model for all the tracks of a table in a single inference call.
+  // Returns the certainties in the order of the tracks in the table.
+  template <typename T>
+  std::vector<float> applyModelBatch(const T& tracks)
+  {
+    return getModelOutputBatch(tracks);
+  }
+
   PidMLDetector mDetector;
   int mPid;
   double mMinCertainty;
@@ -171,39 +208,82 @@ struct PidONNXModel {
         mScalingParams[param[0].GetString()] = std::make_pair(param[1].GetFloat(), param[2].GetFloat());
       }
     }
+    resolveScalingParams();
   }
 
+  // Converts the scaling parameters to (offset, 1 / scale) pairs indexed by model input, so that no lookup by name is needed per track
+  void resolveScalingParams()
+  {
+    for (std::size_t i = 0; i < kNInputs; i++) {
+      mInputOffsets[i] = 0.f;
+      mInputInvScales[i] = 1.f;
+      std::string name = pidMLInputScalingNames[i];
+      if (name.empty() || i >= getNumberOfInputs()) {
+        continue;
+      }
+      auto param = mScalingParams.find(name);
+      if (param == mScalingParams.end()) {
+        LOG(fatal) << "Missing scaling parameters for model input " << name;
+      }
+      mInputOffsets[i] = param->second.first;
+      mInputInvScales[i] = 1.f / param->second.second;
+    }
+  }
+
+  // Number of model inputs for the detector configuration
+  std::size_t getNumberOfInputs() const
+  {
+    if (mDetector >= kTPCTOFTRD) {
+      return kNInputs;
+    }
+    if (mDetector >= kTPCTOF) {
+      return kNInputsTPCTOF;
+    }
+    return kNInputsTPC;
+  }
+
+  // Writes the scaled model inputs of a track to inputValues, which must hold getNumberOfInputs() elements
   template <typename T>
-  std::vector<float> createInputsSingle(const T& track)
+  void fillInputs(const T& track, float* inputValues)
   {
     // TODO: Hardcoded for now. Planning to implement RowView extension to get runtime access to selected columns
     // sign is short, trackType and tpcNClsShared uint8_t
-    float scaledX = (track.x() - mScalingParams.at("fX").first) / mScalingParams.at("fX").second;
-    float scaledY = (track.y() - mScalingParams.at("fY").first) / mScalingParams.at("fY").second;
-    float scaledZ = (track.z() - mScalingParams.at("fZ").first) / mScalingParams.at("fZ").second;
-    float scaledAlpha = (track.alpha() - mScalingParams.at("fAlpha").first) / mScalingParams.at("fAlpha").second;
-    float scaledTPCNClsShared = ((float)track.tpcNClsShared() - mScalingParams.at("fTPCNClsShared").first) / mScalingParams.at("fTPCNClsShared").second;
-    float scaledDcaXY = (track.dcaXY() - mScalingParams.at("fDcaXY").first) / mScalingParams.at("fDcaXY").second;
-    float scaledDcaZ = (track.dcaZ() - mScalingParams.at("fDcaZ").first) / mScalingParams.at("fDcaZ").second;
-
-    float scaledTPCSignal = (track.tpcSignal() - mScalingParams.at("fTPCSignal").first) / mScalingParams.at("fTPCSignal").second;
-
-    std::vector<float> inputValues{track.px(), track.py(), track.pz(), (float)track.sign(), scaledX, scaledY, scaledZ, scaledAlpha, (float)track.trackType(), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal};
+    inputValues[kInputPx] = track.px();
+    inputValues[kInputPy] = track.py();
+    inputValues[kInputPz] = track.pz();
+    inputValues[kInputSign] = (float)track.sign();
+    inputValues[kInputX] = track.x();
+    inputValues[kInputY] = track.y();
+    inputValues[kInputZ] = track.z();
+    inputValues[kInputAlpha] = track.alpha();
+    inputValues[kInputTrackType] = (float)track.trackType();
+    inputValues[kInputTPCNClsShared] = (float)track.tpcNClsShared();
+    inputValues[kInputDcaXY] = track.dcaXY();
+    inputValues[kInputDcaZ] = track.dcaZ();
+    inputValues[kInputP] = track.p();
+    inputValues[kInputTPCSignal] = track.tpcSignal();
 
     if (mDetector >= kTPCTOF) {
-      float scaledTOFSignal = (track.tofSignal() - mScalingParams.at("fTOFSignal").first) / mScalingParams.at("fTOFSignal").second;
-      float scaledBeta = (track.beta() - mScalingParams.at("fBeta").first) / mScalingParams.at("fBeta").second;
-      inputValues.push_back(scaledTOFSignal);
-      inputValues.push_back(scaledBeta);
+      inputValues[kInputTOFSignal] = track.tofSignal();
+      inputValues[kInputBeta] = track.beta();
     }
 
     if (mDetector >= kTPCTOFTRD) {
-      float scaledTRDSignal = (track.trdSignal() - mScalingParams.at("fTRDSignal").first) / mScalingParams.at("fTRDSignal").second;
-      float scaledTRDPattern = (track.trdPattern() - mScalingParams.at("fTRDPattern").first) / mScalingParams.at("fTRDPattern").second;
-      inputValues.push_back(scaledTRDSignal);
-      inputValues.push_back(scaledTRDPattern);
+      inputValues[kInputTRDSignal] = track.trdSignal();
+      inputValues[kInputTRDPattern] = track.trdPattern();
+    }
+
+    const std::size_t nInputs = getNumberOfInputs();
+    for (std::size_t i = 0; i < nInputs; i++) {
+      inputValues[i] = (inputValues[i] - mInputOffsets[i]) * mInputInvScales[i];
     }
+  }
 
+  template <typename T>
+  std::vector<float> createInputsSingle(const T& track)
+  {
+    std::vector<float> inputValues(getNumberOfInputs());
+    fillInputs(track, inputValues.data());
     return inputValues;
   }
 
@@ -218,6 +298,9 @@ struct PidONNXModel {
   float getModelOutput(const T& track)
   {
     auto input_shape = mInputShapes[0];
+    if (!input_shape.empty() && input_shape[0] < 0) {
+      input_shape[0] = 1; // model exported with a dynamic batch size
+    }
     std::vector<float> inputTensorValues = createInputsSingle(track);
     std::vector<Ort::Value> inputTensors;
     inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), input_shape));
@@ -244,6 +327,52 @@ struct PidONNXModel {
     return false; // unreachable code
   }
 
+  template <typename T>
+  std::vector<float> getModelOutputBatch(const T& tracks)
+  {
+    std::vector<float> certainties;
+    const std::size_t nTracks = tracks.size();
+    certainties.reserve(nTracks);
+    if (nTracks == 0) {
+      return certainties;
+    }
+
+    // Models exported with a fixed batch size can only be evaluated track by track
+    if (mInputShapes[0].empty() || mInputShapes[0][0] > 0) {
+      for (const auto& track : tracks) {
+        certainties.push_back(getModelOutput(track));
+      }
+      return certainties;
+    }
+
+    const std::size_t nInputs = getNumberOfInputs();
+    std::vector<int64_t> inputShape{static_cast<int64_t>(nTracks), static_cast<int64_t>(nInputs)};
+    mBatchInputValues.resize(nTracks * nInputs);
+    std::size_t iTrack = 0;
+    for (const auto& track : tracks) {
+      fillInputs(track, mBatchInputValues.data() + iTrack * nInputs);
+      iTrack++;
+    }
+    std::vector<Ort::Value> inputTensors;
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(mBatchInputValues.data(), mBatchInputValues.size(), inputShape));
+    LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+
+    try {
+      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+      assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
+      LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+
+      const float* outputValues = outputTensors[0].GetTensorData<float>();
+      for (std::size_t i = 0; i < nTracks; i++) {
+        certainties.push_back(sigmoid(outputValues[i])); // FIXME: Temporary, sigmoid will be added as network layer
+      }
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+      certainties.assign(nTracks, 0.f);
+    }
+    return certainties;
+  }
+
   // Pretty prints a shape dimension vector
   std::string printShape(const std::vector<int64_t>& v)
   {
@@ -256,8 +385,9 @@ struct PidONNXModel {
 
   std::vector<std::string> mTrainColumns;
   std::map<std::string, std::pair<float, float>> mScalingParams;
+  std::array<float, kNInputs> mInputOffsets;   // scaling offset of each model input
+  std::array<float, kNInputs> mInputInvScales; // inverse of the scaling factor of each model input
 
-  std::shared_ptr<Ort::Env> mEnv = nullptr;
   // No empty constructors for Session, we need a pointer
   std::shared_ptr<Ort::Experimental::Session> mSession = nullptr;
 
@@ -265,6 +395,8 @@ struct PidONNXModel {
   std::vector<std::vector<int64_t>> mInputShapes;
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
+
+  std::vector<float> mBatchInputValues; // [nTracks x nInputs] input tensor of the batch inference, reused between calls
 };
 
 #endif // O2_ANALYSIS_PIDONNXMODEL_H_
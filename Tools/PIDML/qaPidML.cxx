@@ -21,7 +21,12 @@
 #include "Common/DataModel/PIDResponse.h"
 #include <TParameter.h>
 #include "Tools/PIDML/pidOnnxModel.h"
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -323,19 +328,17 @@ struct pidml {
   }
 
   template <std::size_t i, typename T>
-  void pidML(const T& track, const int pdgCodeMC)
+  void pidML(const T& track, const int pdgCodeMC, const std::size_t iTrack)
   {
     float pidCertainties[3];
-    if (track.p() < pSwitchValue[i]) {
-      pidCertainties[0] = model211TPC.applyModel(track);
-      pidCertainties[1] = model2212TPC.applyModel(track);
-      pidCertainties[2] = model321TPC.applyModel(track);
-    } else {
-      pidCertainties[0] = model211All.applyModel(track);
-      pidCertainties[1] = model2212All.applyModel(track);
-      pidCertainties[2] = model321All.applyModel(track);
+    const auto& certainties = (track.p() < pSwitchValue[i]) ? certaintiesTPC : certaintiesAll;
+    for (int j = 0; j < numParticles; j++) {
+      pidCertainties[j] = certainties[j][iTrack];
     }
     int pid = getParticlePdg(pidCertainties);
+    if (track.sign() == 1) {
+      trackScores[i].emplace_back(pidCertainties[i], pdgCodeMC == particlesPdgCode[i]);
+    }
     // condition for sign: we want to work only with pi, p and K, without antiparticles
     if (pid == particlesPdgCode[i] && track.sign() == 1) {
       if (pdgCodeMC == particlesPdgCode[i]) {
@@ -346,6 +349,32 @@ struct pidml {
     }
   }
 
+  // fill the number of tracks with a certainty of the i-th model above the threshold of each bin,
+  // from the certainties sorted once, with the counts accumulated while the thresholds are lowered
+  void fillCertaintyCurves(int i)
+  {
+    auto& scores = trackScores[i];
+    std::sort(scores.begin(), scores.end(), [](auto const& a, auto const& b) { return a.first > b.first; });
+    const auto* axis = hCertaintySelected[i]->GetXaxis();
+    std::size_t iScore = 0;
+    double nSelected = 0.;
+    double nSelectedTrue = 0.;
+    for (int bin = axis->GetNbins(); bin >= 1; bin--) {
+      const double threshold = axis->GetBinLowEdge(bin);
+      for (; iScore < scores.size() && scores[iScore].first >= threshold; iScore++) {
+        nSelected += 1.;
+        if (scores[iScore].second) {
+          nSelectedTrue += 1.;
+        }
+      }
+      hCertaintySelected[i]->AddBinContent(bin, nSelected);
+      hCertaintySelectedTrue[i]->AddBinContent(bin, nSelectedTrue);
+    }
+    hCertaintySelected[i]->SetEntries(hCertaintySelected[i]->GetEntries() + nSelected);
+    hCertaintySelectedTrue[i]->SetEntries(hCertaintySelectedTrue[i]->GetEntries() + nSelectedTrue);
+    scores.clear();
+  }
+
   // one model for one particle; Model with all TPC and TOF signal
   PidONNXModel model211All;
   PidONNXModel model2212All;
@@ -354,17 +383,34 @@ struct pidml {
   PidONNXModel model211TPC;
   PidONNXModel model2212TPC;
   PidONNXModel model321TPC;
+  // certainties of the models for the tracks of the current dataframe, [particle][track]
+  std::array<std::vector<float>, 3> certaintiesAll;
+  std::array<std::vector<float>, 3> certaintiesTPC;
+  // certainty of the positive tracks of the current dataframe and whether they are of the particle, [particle][track]
+  std::array<std::vector<std::pair<float, bool>>, numParticles> trackScores;
+
+  // positive tracks with a certainty above the low edge of the bin, all and of the particle, for the i-th particle
+  // efficiency: selected true / selected true of the first bin, purity: selected true / selected
+  std::array<std::shared_ptr<TH1>, numParticles> hCertaintySelected;
+  std::array<std::shared_ptr<TH1>, numParticles> hCertaintySelectedTrue;
 
   Configurable<std::string> cfgPathCCDB{"ccdb-path", "Users/m/mkabus/PIDML", "base path to the CCDB directory with ONNX models"};
   Configurable<std::string> cfgCCDBURL{"ccdb-url", "http://alice-ccdb.cern.ch", "URL of the CCDB repository"};
   Configurable<bool> cfgUseCCDB{"useCCDB", true, "Whether to autofetch ML model from CCDB. If false, local file will be used."};
   Configurable<std::string> cfgPathLocal{"local-path", "/home/mkabus/PIDML/", "base path to the local directory with ONNX models"};
+  Configurable<int> cfgNCertaintyThresholds{"nCertaintyThresholds", 100, "Number of certainty thresholds, between 0 and 1, of the efficiency and purity curves"};
 
   o2::ccdb::CcdbApi ccdbApi;
   int currentRunNumber = -1;
 
   void init(InitContext const&)
   {
+    const AxisSpec axisThreshold{cfgNCertaintyThresholds, 0., 1., "certainty threshold"};
+    for (int i = 0; i < numParticles; i++) {
+      hCertaintySelected[i] = histReg.add<TH1>(Form("certaintySelected/%d", particlesPdgCode[i]), "Tracks with a certainty above the threshold;certainty threshold;Counts", HistType::kTH1D, {axisThreshold});
+      hCertaintySelectedTrue[i] = histReg.add<TH1>(Form("certaintySelectedTrue/%d", particlesPdgCode[i]), "PID true tracks with a certainty above the threshold;certainty threshold;Counts", HistType::kTH1D, {axisThreshold});
+    }
+
     if (cfgUseCCDB) {
       ccdbApi.init(cfgCCDBURL);
     } else {
@@ -393,6 +439,11 @@ struct pidml {
       model321TPC = PidONNXModel(cfgPathLocal.value, cfgPathCCDB.value, cfgUseCCDB.value, ccdbApi, bc.timestamp(), 321, kTPCOnly, 0.5f);
     }
 
+    // one inference per model for all the tracks
+    certaintiesAll = {model211All.applyModelBatch(tracks), model2212All.applyModelBatch(tracks), model321All.applyModelBatch(tracks)};
+    certaintiesTPC = {model211TPC.applyModelBatch(tracks), model2212TPC.applyModelBatch(tracks), model321TPC.applyModelBatch(tracks)};
+
+    std::size_t iTrack = 0;
     for (auto& track : tracks) {
       auto particle = track.mcParticle_as<aod::McParticles_000>();
       int pdgCodeMC = particle.pdgCode();
@@ -401,8 +452,13 @@ struct pidml {
 
       // only 3 particles can be predicted by model
       static_for<0, 2>([&](auto i) {
-        pidML<i>(track, pdgCodeMC);
+        pidML<i>(track, pdgCodeMC, iTrack);
       });
+      iTrack++;
+    }
+
+    for (int i = 0; i < numParticles; i++) {
+      fillCertaintyCurves(i);
     }
   }
 };
@@ -80,8 +80,10 @@ struct SimpleApplyOnnxModel {
       pidModel = PidONNXModel(cfgPathLocal.value, cfgPathCCDB.value, cfgUseCCDB.value, ccdbApi, timestamp, cfgPid.value, static_cast<PidMLDetector>(cfgDetector.value), cfgCertainty.value);
     }
 
+    auto certainties = pidModel.applyModelBatch(tracks);
+    std::size_t iTrack = 0;
     for (auto& track : tracks) {
-      bool accepted = pidModel.applyModelBoolean(track);
+      bool accepted = certainties[iTrack++] >= pidModel.mMinCertainty;
       LOGF(info, "collision id: %d track id: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
            track.collisionId(), track.index(), accepted, track.p(), track.x(), track.y(), track.z());
       pidMLResults(track.index(), cfgPid.value, accepted);
@@ -91,8 +93,10 @@ struct SimpleApplyOnnxModel {
 
   void processTracksOnly(BigTracks const& tracks)
   {
+    auto certainties = pidModel.applyModelBatch(tracks);
+    std::size_t iTrack = 0;
     for (auto& track : tracks) {
-      bool accepted = pidModel.applyModelBoolean(track);
+      bool accepted = certainties[iTrack++] >= pidModel.mMinCertainty;
       LOGF(info, "collision id: %d track id: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
            track.collisionId(), track.index(), accepted, track.p(), track.x(), track.y(), track.z());
       pidMLResults(track.index(), cfgPid.value, accepted);
@@ -0,0 +1,59 @@
+# Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+# See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+# All rights not expressly granted are reserved.
+#
+# This software is distributed under the terms of the GNU General Public
+# License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+#
+# In applying this license CERN does not waive the privileges and immunities
+# granted to it by virtue of its status as an Intergovernmental Organization
+# or submit itself to any jurisdiction.
+
+
+include_guard()
+
+#
+# o2physics_add_throughput_benchmark(name WORKFLOWS ... [DEPENDS ...]) declares a
+# chain of workflows (executable names) whose throughput is measured by
+# Scripts/benchmarkThroughput.py on a synthetic AO2D.
+#
+# * DEPENDS (optional): names of other chains whose workflows are run in front
+#   of the ones of this chain (e.g. the common event, track and PID chain)
+#
+# The chains of all the PWGs are written by o2physics_write_throughput_benchmarks
+# in a JSON file, installed under share/benchmarks, that is read by the driver.
+#
+function(o2physics_add_throughput_benchmark name)
+
+  cmake_parse_arguments(PARSE_ARGV 1 A "" "" "WORKFLOWS;DEPENDS")
+
+  if(A_UNPARSED_ARGUMENTS)
+    message(FATAL_ERROR "Got trailing arguments ${A_UNPARSED_ARGUMENTS}")
+  endif()
+  if(NOT A_WORKFLOWS)
+    message(FATAL_ERROR "No workflows given for the throughput benchmark ${name}")
+  endif()
+
+  list(JOIN A_WORKFLOWS "\", \"" workflows)
+  set(entry "{\"name\": \"${name}\", \"workflows\": [\"${workflows}\"]")
+  if(A_DEPENDS)
+    list(JOIN A_DEPENDS "\", \"" depends)
+    string(APPEND entry ", \"depends\": [\"${depends}\"]")
+  endif()
+  string(APPEND entry "}")
+  set_property(GLOBAL APPEND PROPERTY O2PHYSICS_THROUGHPUT_BENCHMARKS "${entry}")
+
+endfunction()
+
+#
+# o2physics_write_throughput_benchmarks(file) writes the chains declared so far
+# in file and installs it
+#
+function(o2physics_write_throughput_benchmarks file)
+
+  get_property(entries GLOBAL PROPERTY O2PHYSICS_THROUGHPUT_BENCHMARKS)
+  list(JOIN entries ",\n  " content)
+  file(WRITE ${file} "[\n  ${content}\n]\n")
+  install(FILES ${file} DESTINATION ${CMAKE_INSTALL_DATADIR}/benchmarks)
+
+endfunction()
@@ -26,4 +26,7 @@ set_package_properties(fjcontrib PROPERTIES TYPE REQUIRED)
 
 find_package(ONNXRuntime::ONNXRuntime)
 
+find_package(benchmark CONFIG)
+set_package_properties(benchmark PROPERTIES TYPE OPTIONAL PURPOSE "Benchmarks of the core kernels")
+
 feature_summary(WHAT ALL FATAL_ON_MISSING_REQUIRED_PACKAGES)